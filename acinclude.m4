@@ -3,6 +3,16 @@ AC_DEFUN([AX_LIBQCOW_CHECK_LOCAL],
   [dnl Check for internationalization functions in libqcow/libqcow_i18n.c
   AC_CHECK_FUNCS([bindtextdomain])
 
+  dnl Check for hardware accelerated AES support in libqcow/libqcow_hardware_aes.c
+  AC_CHECK_HEADERS([arm_neon.h cpuid.h sys/auxv.h wmmintrin.h])
+
+  dnl Check for SIMD byte swap support in libqcow/libqcow_byte_swap.c
+  AC_CHECK_HEADERS([immintrin.h])
+
+  dnl Check for the monotonic clock used to time decompression and decryption in libqcow/libqcow_statistics.c
+  AC_SEARCH_LIBS([clock_gettime], [rt])
+  AC_CHECK_FUNCS([clock_gettime])
+
   dnl Check if library should be build with verbose output
   AX_COMMON_CHECK_ENABLE_VERBOSE_OUTPUT
 
@@ -0,0 +1,644 @@
+/*
+ * C++ wrapper of the Library to access the QEMU Copy-On-Write (QCOW) image file format
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_HPP )
+#define _LIBQCOW_HPP
+
+#include <libqcow.h>
+
+#if !defined( __cplusplus ) || ( __cplusplus < 201703L )
+#error libqcow.hpp requires C++17 or later
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+#if defined( __has_include )
+#if __has_include( <version> )
+#include <version>
+#endif
+#endif
+
+#if defined( __cpp_lib_span )
+#include <span>
+#endif
+
+#if defined( __cpp_impl_coroutine ) && defined( __cpp_lib_coroutine )
+#include <coroutine>
+
+#define LIBQCOW_HPP_HAVE_COROUTINES	1
+#endif
+
+/* The wrapper only calls the C API, it does not allocate memory or copy data
+ * itself. Errors are reported as libqcow::error exceptions.
+ */
+namespace libqcow
+{
+
+/* The error exception
+ * The error message is copied from the C error, which is freed
+ */
+class error : public std::exception
+{
+	public:
+		explicit error(
+		          libqcow_error_t *c_error ) noexcept
+		{
+			message_[ 0 ] = 0;
+
+			if( c_error != NULL )
+			{
+				if( libqcow_error_sprint(
+				     c_error,
+				     message_,
+				     sizeof( message_ ) ) < 0 )
+				{
+					message_[ 0 ] = 0;
+				}
+				libqcow_error_free(
+				 &c_error );
+			}
+			if( message_[ 0 ] == 0 )
+			{
+				std::strncpy(
+				 message_,
+				 "libqcow error",
+				 sizeof( message_ ) - 1 );
+
+				message_[ sizeof( message_ ) - 1 ] = 0;
+			}
+		}
+
+		const char *what() const noexcept override
+		{
+			return( message_ );
+		}
+
+	private:
+		char message_[ 512 ];
+};
+
+/* Throws the error exception if the C API returned an error
+ */
+inline void check_result(
+             int result,
+             libqcow_error_t *c_error )
+{
+	if( result == -1 )
+	{
+		throw error( c_error );
+	}
+}
+
+/* An extent of the media data
+ */
+struct extent
+{
+	/* The media offset of the extent
+	 */
+	off64_t offset;
+
+	/* The size of the extent
+	 */
+	size64_t size;
+
+	/* The file offset of the extent, only valid if the extent is not sparse
+	 */
+	off64_t file_offset;
+
+	/* The extent flags, LIBQCOW_EXTENT_FLAG_*
+	 */
+	uint32_t flags;
+
+	bool is_sparse() const noexcept
+	{
+		return( ( flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 );
+	}
+
+	bool is_compressed() const noexcept
+	{
+		return( ( flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 );
+	}
+
+	bool is_zero() const noexcept
+	{
+		return( ( flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) != 0 );
+	}
+};
+
+/* Input iterator over the extents of the media data
+ * A default constructed iterator represents the end of the media
+ */
+class extent_iterator
+{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type        = extent;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = const extent *;
+		using reference         = const extent &;
+
+		extent_iterator() noexcept = default;
+
+		extent_iterator(
+		 libqcow_file_t *c_file,
+		 off64_t offset )
+		 : c_file_( c_file )
+		{
+			retrieve( offset );
+		}
+
+		reference operator*() const noexcept
+		{
+			return( extent_ );
+		}
+
+		pointer operator->() const noexcept
+		{
+			return( &extent_ );
+		}
+
+		extent_iterator &operator++()
+		{
+			retrieve( extent_.offset + (off64_t) extent_.size );
+
+			return( *this );
+		}
+
+		extent_iterator operator++( int )
+		{
+			extent_iterator previous_iterator = *this;
+
+			++( *this );
+
+			return( previous_iterator );
+		}
+
+		friend bool operator==(
+		             const extent_iterator &first_iterator,
+		             const extent_iterator &second_iterator ) noexcept
+		{
+			if( ( first_iterator.c_file_ == NULL )
+			 || ( second_iterator.c_file_ == NULL ) )
+			{
+				return( first_iterator.c_file_ == second_iterator.c_file_ );
+			}
+			return( first_iterator.extent_.offset == second_iterator.extent_.offset );
+		}
+
+		friend bool operator!=(
+		             const extent_iterator &first_iterator,
+		             const extent_iterator &second_iterator ) noexcept
+		{
+			return( !( first_iterator == second_iterator ) );
+		}
+
+	private:
+		void retrieve(
+		      off64_t offset )
+		{
+			libqcow_error_t *c_error = NULL;
+			int result               = 0;
+
+			result = libqcow_file_get_extent_at_offset(
+			          c_file_,
+			          offset,
+			          &( extent_.offset ),
+			          &( extent_.size ),
+			          &( extent_.file_offset ),
+			          &( extent_.flags ),
+			          &c_error );
+
+			check_result(
+			 result,
+			 c_error );
+
+			if( ( result == 0 )
+			 || ( extent_.size == 0 ) )
+			{
+				c_file_ = NULL;
+			}
+		}
+
+		libqcow_file_t *c_file_ = NULL;
+
+		extent extent_ = { 0, 0, 0, 0 };
+};
+
+/* Range of the extents of the media data, starting at a specific offset
+ */
+class extent_range
+{
+	public:
+		extent_range(
+		 libqcow_file_t *c_file,
+		 off64_t offset ) noexcept
+		 : c_file_( c_file ), offset_( offset )
+		{
+		}
+
+		extent_iterator begin() const
+		{
+			return( extent_iterator( c_file_, offset_ ) );
+		}
+
+		extent_iterator end() const noexcept
+		{
+			return( extent_iterator() );
+		}
+
+	private:
+		libqcow_file_t *c_file_;
+
+		off64_t offset_;
+};
+
+#if defined( LIBQCOW_HPP_HAVE_COROUTINES )
+
+/* Awaitable of an asynchronous read
+ * The scheduler must provide: void schedule( std::coroutine_handle<> handle )
+ * The scheduler is called on the read request thread and must resume
+ * the coroutine elsewhere, e.g. by posting it to an event loop, since
+ * the read request can only be freed after its callback has returned
+ * The awaitable must remain alive until it is resumed
+ */
+template<typename Scheduler>
+class read_awaitable
+{
+	public:
+		read_awaitable(
+		 libqcow_file_t *c_file,
+		 void *buffer,
+		 size_t buffer_size,
+		 off64_t offset,
+		 int priority,
+		 Scheduler &scheduler ) noexcept
+		 : c_file_( c_file ), buffer_( buffer ), buffer_size_( buffer_size ),
+		   offset_( offset ), priority_( priority ), scheduler_( &scheduler )
+		{
+		}
+
+		read_awaitable(
+		 const read_awaitable & ) = delete;
+
+		read_awaitable &operator=(
+		                 const read_awaitable & ) = delete;
+
+		~read_awaitable()
+		{
+			if( c_request_ != NULL )
+			{
+				/* Waits for the read request to finish
+				 */
+				libqcow_read_request_free(
+				 &c_request_,
+				 NULL );
+			}
+		}
+
+		bool await_ready() const noexcept
+		{
+			return( false );
+		}
+
+		bool await_suspend(
+		      std::coroutine_handle<> handle )
+		{
+			libqcow_error_t *c_error = NULL;
+
+			handle_ = handle;
+
+			if( libqcow_file_read_async_with_priority(
+			     c_file_,
+			     buffer_,
+			     buffer_size_,
+			     offset_,
+			     priority_,
+			     &read_awaitable::callback,
+			     this,
+			     &c_request_,
+			     &c_error ) != 1 )
+			{
+				throw error( c_error );
+			}
+			/* The coroutine is resumed by whichever of await_suspend and
+			 * the callback finishes last, so that the read request is set
+			 */
+			if( number_of_finished_.fetch_add(
+			     1,
+			     std::memory_order_acq_rel ) == 1 )
+			{
+				return( false );
+			}
+			return( true );
+		}
+
+		/* Returns the number of bytes read
+		 */
+		size_t await_resume() const
+		{
+			if( ( status_ != LIBQCOW_READ_REQUEST_STATUS_COMPLETED )
+			 || ( read_count_ < 0 ) )
+			{
+				throw error( NULL );
+			}
+			return( (size_t) read_count_ );
+		}
+
+	private:
+		static void callback(
+		             libqcow_read_request_t *c_request,
+		             int status,
+		             ssize_t read_count,
+		             void *user_data ) noexcept
+		{
+			read_awaitable *awaitable = static_cast<read_awaitable *>( user_data );
+
+			(void) c_request;
+
+			awaitable->status_     = status;
+			awaitable->read_count_ = read_count;
+
+			if( awaitable->number_of_finished_.fetch_add(
+			     1,
+			     std::memory_order_acq_rel ) == 1 )
+			{
+				awaitable->scheduler_->schedule(
+				 awaitable->handle_ );
+			}
+		}
+
+		libqcow_file_t *c_file_;
+
+		void *buffer_;
+
+		size_t buffer_size_;
+
+		off64_t offset_;
+
+		int priority_;
+
+		Scheduler *scheduler_;
+
+		std::coroutine_handle<> handle_ = nullptr;
+
+		libqcow_read_request_t *c_request_ = NULL;
+
+		std::atomic<int> number_of_finished_ { 0 };
+
+		int status_ = LIBQCOW_READ_REQUEST_STATUS_PENDING;
+
+		ssize_t read_count_ = 0;
+};
+
+#endif /* defined( LIBQCOW_HPP_HAVE_COROUTINES ) */
+
+/* Move-only handle of a file or a reader of a file
+ * A reader must be destroyed before the file it was created from is closed
+ */
+class file
+{
+	public:
+		file()
+		{
+			libqcow_error_t *c_error = NULL;
+
+			check_result(
+			 libqcow_file_initialize(
+			  &c_file_,
+			  &c_error ),
+			 c_error );
+		}
+
+		file(
+		 const char *filename,
+		 int access_flags = LIBQCOW_OPEN_READ )
+		 : file()
+		{
+			open(
+			 filename,
+			 access_flags );
+		}
+
+		file(
+		 const file & ) = delete;
+
+		file &operator=(
+		       const file & ) = delete;
+
+		file(
+		 file &&other_file ) noexcept
+		 : c_file_( std::exchange( other_file.c_file_, nullptr ) )
+		{
+		}
+
+		file &operator=(
+		       file &&other_file ) noexcept
+		{
+			if( this != &other_file )
+			{
+				release();
+
+				c_file_ = std::exchange( other_file.c_file_, nullptr );
+			}
+			return( *this );
+		}
+
+		~file()
+		{
+			release();
+		}
+
+		/* Retrieves the underlying C file, which remains owned by the handle
+		 */
+		libqcow_file_t *get() const noexcept
+		{
+			return( c_file_ );
+		}
+
+		void open(
+		      const char *filename,
+		      int access_flags = LIBQCOW_OPEN_READ )
+		{
+			libqcow_error_t *c_error = NULL;
+
+			check_result(
+			 libqcow_file_open(
+			  c_file_,
+			  filename,
+			  access_flags,
+			  &c_error ),
+			 c_error );
+		}
+
+		void close()
+		{
+			libqcow_error_t *c_error = NULL;
+
+			check_result(
+			 libqcow_file_close(
+			  c_file_,
+			  &c_error ),
+			 c_error );
+		}
+
+		/* Creates a reader that has its own current offset and file IO handle
+		 */
+		file clone_reader() const
+		{
+			libqcow_error_t *c_error = NULL;
+			libqcow_file_t *c_reader = NULL;
+
+			check_result(
+			 libqcow_file_clone_reader(
+			  c_file_,
+			  &c_reader,
+			  &c_error ),
+			 c_error );
+
+			return( file( c_reader ) );
+		}
+
+		size64_t media_size() const
+		{
+			libqcow_error_t *c_error = NULL;
+			size64_t media_size      = 0;
+
+			check_result(
+			 libqcow_file_get_media_size(
+			  c_file_,
+			  &media_size,
+			  &c_error ),
+			 c_error );
+
+			return( media_size );
+		}
+
+		/* Reads media data at a specific offset directly into the buffer
+		 * Returns the number of bytes read
+		 */
+		size_t read_at(
+		        void *buffer,
+		        size_t buffer_size,
+		        off64_t offset ) const
+		{
+			libqcow_error_t *c_error = NULL;
+			ssize_t read_count       = 0;
+
+			read_count = libqcow_file_read_buffer_at_offset(
+			              c_file_,
+			              buffer,
+			              buffer_size,
+			              offset,
+			              &c_error );
+
+			if( read_count < 0 )
+			{
+				throw error( c_error );
+			}
+			return( (size_t) read_count );
+		}
+
+#if defined( __cpp_lib_span )
+		size_t read_at(
+		        std::span<std::byte> buffer,
+		        off64_t offset ) const
+		{
+			return( read_at(
+			         buffer.data(),
+			         buffer.size(),
+			         offset ) );
+		}
+#endif
+
+		/* Retrieves the extents of the media data starting at a specific offset
+		 */
+		extent_range extents(
+		              off64_t offset = 0 ) const noexcept
+		{
+			return( extent_range( c_file_, offset ) );
+		}
+
+#if defined( LIBQCOW_HPP_HAVE_COROUTINES )
+		template<typename Scheduler>
+		read_awaitable<Scheduler> read_async(
+		                           void *buffer,
+		                           size_t buffer_size,
+		                           off64_t offset,
+		                           Scheduler &scheduler,
+		                           int priority = LIBQCOW_IO_PRIORITY_NORMAL ) const noexcept
+		{
+			return( read_awaitable<Scheduler>(
+			         c_file_,
+			         buffer,
+			         buffer_size,
+			         offset,
+			         priority,
+			         scheduler ) );
+		}
+
+#if defined( __cpp_lib_span )
+		template<typename Scheduler>
+		read_awaitable<Scheduler> read_async(
+		                           std::span<std::byte> buffer,
+		                           off64_t offset,
+		                           Scheduler &scheduler,
+		                           int priority = LIBQCOW_IO_PRIORITY_NORMAL ) const noexcept
+		{
+			return( read_awaitable<Scheduler>(
+			         c_file_,
+			         buffer.data(),
+			         buffer.size(),
+			         offset,
+			         priority,
+			         scheduler ) );
+		}
+#endif
+#endif /* defined( LIBQCOW_HPP_HAVE_COROUTINES ) */
+
+	private:
+		explicit file(
+		          libqcow_file_t *c_file ) noexcept
+		 : c_file_( c_file )
+		{
+		}
+
+		void release() noexcept
+		{
+			if( c_file_ != NULL )
+			{
+				libqcow_file_free(
+				 &c_file_,
+				 NULL );
+			}
+		}
+
+		libqcow_file_t *c_file_ = NULL;
+};
+
+} /* namespace libqcow */
+
+#endif /* !defined( _LIBQCOW_HPP ) */
+
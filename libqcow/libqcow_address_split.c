@@ -0,0 +1,175 @@
+/*
+ * Address split functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_address_split.h"
+#include "libqcow_definitions.h"
+#include "libqcow_io_handle.h"
+#include "libqcow_libcerror.h"
+
+/* Splits an offset into its level 1 table, level 2 table and cluster block parts
+ * When the bit values are constants the compiler reduces the split
+ * to constant shifts and masks
+ */
+#define LIBQCOW_ADDRESS_SPLIT_OFFSET( offset, number_of_cluster_block_bits, number_of_level2_table_bits, number_of_level2_table_entry_bits, number_of_level2_table_slice_bits, address_split ) \
+	( address_split )->level1_table_index                 = ( offset ) >> ( ( number_of_cluster_block_bits ) + ( number_of_level2_table_bits ) ); \
+	( address_split )->level2_table_index                 = ( ( offset ) >> ( number_of_cluster_block_bits ) ) & ~( (uint64_t) -1 << ( number_of_level2_table_bits ) ); \
+	( address_split )->level2_table_slice_index           = ( address_split )->level2_table_index & ~( (uint64_t) -1 << ( number_of_level2_table_slice_bits ) ); \
+	( address_split )->level2_table_slice_offset          = ( ( address_split )->level2_table_index - ( address_split )->level2_table_slice_index ) << ( number_of_level2_table_entry_bits ); \
+	( address_split )->level2_table_slice_reference_index = ( address_split )->level2_table_slice_index << ( ( number_of_level2_table_entry_bits ) - 3 ); \
+	( address_split )->cluster_block_data_offset          = ( offset ) & ~( (uint64_t) -1 << ( number_of_cluster_block_bits ) );
+
+/* The number of level 2 table slice bits of a standard level 2 table entry layout
+ */
+#define LIBQCOW_ADDRESS_SPLIT_LEVEL2_TABLE_SLICE_BITS( number_of_level2_table_bits ) \
+	( ( ( number_of_level2_table_bits ) > LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS ) ? LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS : ( number_of_level2_table_bits ) )
+
+/* Defines an address split function specialized for a cluster block size
+ * with standard level 2 table entries
+ */
+#define LIBQCOW_ADDRESS_SPLIT_DEFINE_FUNCTION( layout_name, number_of_cluster_block_bits ) \
+static void libqcow_address_split_offset_##layout_name( \
+             uint64_t offset, \
+             libqcow_address_split_t *address_split ) \
+{ \
+	LIBQCOW_ADDRESS_SPLIT_OFFSET( \
+	 offset, \
+	 number_of_cluster_block_bits, \
+	 ( number_of_cluster_block_bits ) - 3, \
+	 3, \
+	 LIBQCOW_ADDRESS_SPLIT_LEVEL2_TABLE_SLICE_BITS( ( number_of_cluster_block_bits ) - 3 ), \
+	 address_split ) \
+}
+
+LIBQCOW_ADDRESS_SPLIT_DEFINE_FUNCTION( 64k, 16 )
+
+LIBQCOW_ADDRESS_SPLIT_DEFINE_FUNCTION( 2m, 21 )
+
+/* Determines the address split layout
+ * Returns a LIBQCOW_ADDRESS_SPLIT_LAYOUT value
+ */
+int libqcow_address_split_get_layout(
+     uint32_t number_of_cluster_block_bits,
+     uint32_t number_of_level2_table_bits,
+     uint32_t number_of_level2_table_entry_bits,
+     uint32_t number_of_level2_table_slice_bits )
+{
+	/* Extended level 2 table entries and version 1 level 2 tables that
+	 * are not a single cluster block in size use the generic split
+	 */
+	if( ( number_of_level2_table_entry_bits != 3 )
+	 || ( ( number_of_level2_table_bits + 3 ) != number_of_cluster_block_bits ) )
+	{
+		return( LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+	}
+	if( number_of_level2_table_slice_bits != LIBQCOW_ADDRESS_SPLIT_LEVEL2_TABLE_SLICE_BITS( number_of_cluster_block_bits - 3 ) )
+	{
+		return( LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+	}
+	switch( number_of_cluster_block_bits )
+	{
+		case 16:
+			return( LIBQCOW_ADDRESS_SPLIT_LAYOUT_64K );
+
+		case 21:
+			return( LIBQCOW_ADDRESS_SPLIT_LAYOUT_2M );
+
+		default:
+			break;
+	}
+	return( LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+}
+
+/* Splits an offset into its level 1 table, level 2 table and cluster block parts
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_address_split_offset(
+     libqcow_io_handle_t *io_handle,
+     uint64_t offset,
+     libqcow_address_split_t *address_split,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_address_split_offset";
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( address_split == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid address split.",
+		 function );
+
+		return( -1 );
+	}
+	switch( io_handle->address_split_layout )
+	{
+		case LIBQCOW_ADDRESS_SPLIT_LAYOUT_64K:
+			libqcow_address_split_offset_64k(
+			 offset,
+			 address_split );
+			break;
+
+		case LIBQCOW_ADDRESS_SPLIT_LAYOUT_2M:
+			libqcow_address_split_offset_2m(
+			 offset,
+			 address_split );
+			break;
+
+		default:
+			if( ( io_handle->number_of_level2_table_entry_bits < 3 )
+			 || ( ( io_handle->number_of_cluster_block_bits + io_handle->number_of_level2_table_bits ) >= 64 ) )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid IO handle - bit values out of bounds.",
+				 function );
+
+				return( -1 );
+			}
+			LIBQCOW_ADDRESS_SPLIT_OFFSET(
+			 offset,
+			 io_handle->number_of_cluster_block_bits,
+			 io_handle->number_of_level2_table_bits,
+			 io_handle->number_of_level2_table_entry_bits,
+			 io_handle->number_of_level2_table_slice_bits,
+			 address_split )
+
+			break;
+	}
+	return( 1 );
+}
+
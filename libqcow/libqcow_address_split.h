@@ -0,0 +1,94 @@
+/*
+ * Address split functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_ADDRESS_SPLIT_H )
+#define _LIBQCOW_ADDRESS_SPLIT_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_io_handle.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+enum LIBQCOW_ADDRESS_SPLIT_LAYOUTS
+{
+	LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC	= 0,
+
+	/* 64 KiB cluster blocks with standard level 2 table entries
+	 */
+	LIBQCOW_ADDRESS_SPLIT_LAYOUT_64K	= 1,
+
+	/* 2 MiB cluster blocks with standard level 2 table entries
+	 */
+	LIBQCOW_ADDRESS_SPLIT_LAYOUT_2M		= 2
+};
+
+typedef struct libqcow_address_split libqcow_address_split_t;
+
+struct libqcow_address_split
+{
+	/* The level 1 table index
+	 */
+	uint64_t level1_table_index;
+
+	/* The level 2 table index
+	 */
+	uint64_t level2_table_index;
+
+	/* The level 2 table slice index, which is the index of the entry within the slice
+	 */
+	uint64_t level2_table_slice_index;
+
+	/* The offset of the level 2 table slice relative to the start of the level 2 table
+	 */
+	uint64_t level2_table_slice_offset;
+
+	/* The index of the first 64-bit reference of the entry within the level 2 table slice
+	 */
+	uint64_t level2_table_slice_reference_index;
+
+	/* The offset of the data relative to the start of the cluster block
+	 */
+	uint64_t cluster_block_data_offset;
+};
+
+int libqcow_address_split_get_layout(
+     uint32_t number_of_cluster_block_bits,
+     uint32_t number_of_level2_table_bits,
+     uint32_t number_of_level2_table_entry_bits,
+     uint32_t number_of_level2_table_slice_bits );
+
+int libqcow_address_split_offset(
+     libqcow_io_handle_t *io_handle,
+     uint64_t offset,
+     libqcow_address_split_t *address_split,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_ADDRESS_SPLIT_H ) */
+
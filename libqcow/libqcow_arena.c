@@ -0,0 +1,669 @@
+/*
+ * Arena functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( WINAPI )
+#include <windows.h>
+#endif
+
+#if defined( HAVE_SYS_MMAN_H )
+#include <sys/mman.h>
+#endif
+
+#include "libqcow_arena.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+
+#if defined( HAVE_LIBQCOW_ARENA_MEMORY_MAP ) && !defined( MAP_ANONYMOUS ) && defined( MAP_ANON )
+#define MAP_ANONYMOUS	MAP_ANON
+#endif
+
+/* Maps the data of the arena
+ * Explicit huge pages are tried first, then transparent huge pages and then regular pages
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_arena_map_data(
+            libqcow_arena_t *arena,
+            libcerror_error_t **error )
+{
+#if defined( HAVE_LIBQCOW_ARENA_MEMORY_MAP ) && defined( MAP_ANONYMOUS )
+	uint8_t *mapped_data     = NULL;
+	static char *function    = "libqcow_arena_map_data";
+	size_t mapped_data_size  = 0;
+	size_t unused_size       = 0;
+	intptr_t address         = 0;
+
+#if defined( MAP_HUGETLB )
+	/* Explicit huge pages are only available if the system has reserved them
+	 */
+	mapped_data = (uint8_t *) mmap(
+	                           NULL,
+	                           arena->data_size,
+	                           PROT_READ | PROT_WRITE,
+	                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+	                           -1,
+	                           0 );
+
+	if( mapped_data != (uint8_t *) MAP_FAILED )
+	{
+		arena->data      = mapped_data;
+		arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_HUGE_PAGES;
+
+		return( 1 );
+	}
+#endif /* defined( MAP_HUGETLB ) */
+
+	/* The data is mapped one huge page larger than needed, so that it can
+	 * be aligned to a huge page, which transparent huge pages requires
+	 */
+	mapped_data_size = arena->data_size + LIBQCOW_ARENA_HUGE_PAGE_SIZE;
+
+	mapped_data = (uint8_t *) mmap(
+	                           NULL,
+	                           mapped_data_size,
+	                           PROT_READ | PROT_WRITE,
+	                           MAP_PRIVATE | MAP_ANONYMOUS,
+	                           -1,
+	                           0 );
+
+	if( mapped_data == (uint8_t *) MAP_FAILED )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to map data.",
+		 function );
+
+		return( -1 );
+	}
+	address  = (intptr_t) ( mapped_data + LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 );
+	address &= ~( (intptr_t) LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 );
+
+	arena->data = (uint8_t *) address;
+
+	unused_size = (size_t) ( arena->data - mapped_data );
+
+	if( unused_size > 0 )
+	{
+		munmap(
+		 mapped_data,
+		 unused_size );
+	}
+	unused_size = LIBQCOW_ARENA_HUGE_PAGE_SIZE - unused_size;
+
+	if( unused_size > 0 )
+	{
+		munmap(
+		 &( arena->data[ arena->data_size ] ),
+		 unused_size );
+	}
+	arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_DEFAULT;
+
+#if defined( HAVE_MADVISE ) && defined( MADV_HUGEPAGE )
+	if( madvise(
+	     arena->data,
+	     arena->data_size,
+	     MADV_HUGEPAGE ) == 0 )
+	{
+		arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_TRANSPARENT_HUGE_PAGES;
+	}
+#endif
+	return( 1 );
+
+#elif defined( WINAPI )
+	static char *function       = "libqcow_arena_map_data";
+
+#if WINVER >= 0x0502
+	size_t large_page_data_size = 0;
+	SIZE_T large_page_size      = 0;
+
+	/* Large pages require the lock pages in memory privilege of the user
+	 */
+	large_page_size = GetLargePageMinimum();
+
+	if( large_page_size != 0 )
+	{
+		large_page_data_size = ( ( arena->data_size + large_page_size - 1 ) / large_page_size ) * large_page_size;
+
+		arena->data = (uint8_t *) VirtualAlloc(
+		                           NULL,
+		                           large_page_data_size,
+		                           MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+		                           PAGE_READWRITE );
+
+		if( arena->data != NULL )
+		{
+			arena->data_size = large_page_data_size;
+			arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_HUGE_PAGES;
+
+			return( 1 );
+		}
+	}
+#endif /* WINVER >= 0x0502 */
+
+	arena->data = (uint8_t *) VirtualAlloc(
+	                           NULL,
+	                           arena->data_size,
+	                           MEM_RESERVE | MEM_COMMIT,
+	                           PAGE_READWRITE );
+
+	if( arena->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to allocate data.",
+		 function );
+
+		return( -1 );
+	}
+	arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_DEFAULT;
+
+	return( 1 );
+
+#else
+	static char *function = "libqcow_arena_map_data";
+	intptr_t address      = 0;
+
+	/* Huge pages are not supported, the data is allocated aligned to a huge page
+	 */
+	arena->allocation = (uint8_t *) memory_allocate(
+	                                 arena->data_size + LIBQCOW_ARENA_HUGE_PAGE_SIZE );
+
+	if( arena->allocation == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to allocate data.",
+		 function );
+
+		return( -1 );
+	}
+	address  = (intptr_t) ( arena->allocation + LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 );
+	address &= ~( (intptr_t) LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 );
+
+	arena->data      = (uint8_t *) address;
+	arena->page_type = LIBQCOW_ARENA_PAGE_TYPE_DEFAULT;
+
+	return( 1 );
+
+#endif /* defined( HAVE_LIBQCOW_ARENA_MEMORY_MAP ) && defined( MAP_ANONYMOUS ) */
+}
+
+/* Unmaps the data of the arena
+ */
+static void libqcow_arena_unmap_data(
+             libqcow_arena_t *arena )
+{
+#if defined( HAVE_LIBQCOW_ARENA_MEMORY_MAP ) && defined( MAP_ANONYMOUS )
+	munmap(
+	 arena->data,
+	 arena->data_size );
+
+#elif defined( WINAPI )
+	VirtualFree(
+	 arena->data,
+	 0,
+	 MEM_RELEASE );
+
+#else
+	memory_free(
+	 arena->allocation );
+
+	arena->allocation = NULL;
+
+#endif /* defined( HAVE_LIBQCOW_ARENA_MEMORY_MAP ) && defined( MAP_ANONYMOUS ) */
+
+	arena->data = NULL;
+}
+
+/* Creates an arena
+ * An arena is a single region of memory, backed by huge pages where supported,
+ * which is divided in a number of fixed size slots
+ * The arena itself is not multi-thread safe, its users serialize access
+ * Make sure the value arena is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_arena_initialize(
+     libqcow_arena_t **arena,
+     size_t slot_size,
+     size_t slot_alignment,
+     int number_of_slots,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_initialize";
+	size_t array_size     = 0;
+	size_t data_size      = 0;
+	int slot_index        = 0;
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( *arena != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid arena value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( slot_alignment == 0 )
+	 || ( slot_alignment > LIBQCOW_ARENA_HUGE_PAGE_SIZE )
+	 || ( ( slot_alignment & ( slot_alignment - 1 ) ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid slot alignment value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( slot_size == 0 )
+	 || ( slot_size > ( (size_t) SSIZE_MAX - slot_alignment ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid slot size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The slots are aligned by rounding up the slot size to the alignment
+	 */
+	slot_size = ( slot_size + slot_alignment - 1 ) & ~( slot_alignment - 1 );
+
+	if( ( number_of_slots <= 0 )
+	 || ( (size_t) number_of_slots > ( ( (size_t) SSIZE_MAX - LIBQCOW_ARENA_HUGE_PAGE_SIZE ) / slot_size ) )
+	 || ( (size_t) number_of_slots > ( (size_t) SSIZE_MAX / sizeof( int ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of slots value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The data size is rounded up to a multitude of the huge page size
+	 */
+	data_size = slot_size * (size_t) number_of_slots;
+	data_size = ( data_size + LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 ) & ~( (size_t) LIBQCOW_ARENA_HUGE_PAGE_SIZE - 1 );
+
+	*arena = memory_allocate_structure(
+	          libqcow_arena_t );
+
+	if( *arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create arena.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *arena,
+	     0,
+	     sizeof( libqcow_arena_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear arena.",
+		 function );
+
+		memory_free(
+		 *arena );
+
+		*arena = NULL;
+
+		return( -1 );
+	}
+	array_size = sizeof( int ) * (size_t) number_of_slots;
+
+	( *arena )->free_slots = (int *) memory_allocate(
+	                                  array_size );
+
+	if( ( *arena )->free_slots == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create free slots array.",
+		 function );
+
+		goto on_error;
+	}
+	( *arena )->data_size = data_size;
+
+	if( libqcow_arena_map_data(
+	     *arena,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to map data.",
+		 function );
+
+		goto on_error;
+	}
+	/* The free slots are stored in reverse so that the slots are handed out
+	 * from the start of the arena
+	 */
+	for( slot_index = 0;
+	     slot_index < number_of_slots;
+	     slot_index++ )
+	{
+		( *arena )->free_slots[ slot_index ] = number_of_slots - ( slot_index + 1 );
+	}
+	( *arena )->slot_size            = slot_size;
+	( *arena )->number_of_slots      = number_of_slots;
+	( *arena )->number_of_free_slots = number_of_slots;
+
+	return( 1 );
+
+on_error:
+	if( *arena != NULL )
+	{
+		if( ( *arena )->free_slots != NULL )
+		{
+			memory_free(
+			 ( *arena )->free_slots );
+		}
+		memory_free(
+		 *arena );
+
+		*arena = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees an arena
+ * Slots that are still in use are no longer valid after the arena is freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_arena_free(
+     libqcow_arena_t **arena,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_free";
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( *arena != NULL )
+	{
+		if( ( *arena )->data != NULL )
+		{
+			libqcow_arena_unmap_data(
+			 *arena );
+		}
+		memory_free(
+		 ( *arena )->free_slots );
+
+		memory_free(
+		 *arena );
+
+		*arena = NULL;
+	}
+	return( 1 );
+}
+
+/* Determines if a slot is part of the arena
+ * Returns 1 if the slot is part of the arena or 0 if not
+ */
+int libqcow_arena_contains(
+     libqcow_arena_t *arena,
+     const uint8_t *slot )
+{
+	if( ( arena == NULL )
+	 || ( slot == NULL ) )
+	{
+		return( 0 );
+	}
+	if( ( slot < arena->data )
+	 || ( slot >= &( arena->data[ arena->slot_size * (size_t) arena->number_of_slots ] ) ) )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Retrieves a free slot
+ * Returns 1 if successful, 0 if no free slot is available or -1 on error
+ */
+int libqcow_arena_get_slot(
+     libqcow_arena_t *arena,
+     uint8_t **slot,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_get_slot";
+	int slot_index        = 0;
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( slot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid slot.",
+		 function );
+
+		return( -1 );
+	}
+	if( arena->number_of_free_slots == 0 )
+	{
+		return( 0 );
+	}
+	arena->number_of_free_slots -= 1;
+
+	slot_index = arena->free_slots[ arena->number_of_free_slots ];
+
+	*slot = &( arena->data[ arena->slot_size * (size_t) slot_index ] );
+
+	return( 1 );
+}
+
+/* Releases a slot back into the arena
+ * Returns 1 if successful, 0 if the slot is not part of the arena or -1 on error
+ */
+int libqcow_arena_release_slot(
+     libqcow_arena_t *arena,
+     uint8_t *slot,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_release_slot";
+	size_t slot_offset    = 0;
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_arena_contains(
+	     arena,
+	     slot ) == 0 )
+	{
+		return( 0 );
+	}
+	slot_offset = (size_t) ( slot - arena->data );
+
+	if( ( slot_offset % arena->slot_size ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid slot value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( arena->number_of_free_slots >= arena->number_of_slots )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid arena - number of free slots value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	arena->free_slots[ arena->number_of_free_slots ] = (int) ( slot_offset / arena->slot_size );
+
+	arena->number_of_free_slots += 1;
+
+	return( 1 );
+}
+
+/* Retrieves the page type
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_arena_get_page_type(
+     libqcow_arena_t *arena,
+     int *page_type,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_get_page_type";
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( page_type == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page type.",
+		 function );
+
+		return( -1 );
+	}
+	*page_type = arena->page_type;
+
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the arena and its free slots in bytes,
+ * the slots that are in use are accounted for by their users
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_arena_get_memory_usage(
+     libqcow_arena_t *arena,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_arena_get_memory_usage";
+
+	if( arena == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid arena.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_arena_t )
+	              + ( sizeof( int ) * (size_t) arena->number_of_slots )
+	              + ( arena->slot_size * (size_t) arena->number_of_free_slots );
+
+	return( 1 );
+}
+
@@ -0,0 +1,115 @@
+/*
+ * Arena functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_ARENA_H )
+#define _LIBQCOW_ARENA_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if !defined( WINAPI ) && defined( HAVE_SYS_MMAN_H ) && defined( HAVE_MMAP ) && defined( HAVE_MUNMAP )
+#define HAVE_LIBQCOW_ARENA_MEMORY_MAP
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_arena libqcow_arena_t;
+
+struct libqcow_arena
+{
+	/* The data
+	 */
+	uint8_t *data;
+
+	/* The data size
+	 */
+	size_t data_size;
+
+	/* The allocation, which contains the data when the arena is not mapped
+	 */
+	uint8_t *allocation;
+
+	/* The page type
+	 */
+	int page_type;
+
+	/* The slot size
+	 */
+	size_t slot_size;
+
+	/* The number of slots
+	 */
+	int number_of_slots;
+
+	/* The number of free slots
+	 */
+	int number_of_free_slots;
+
+	/* The indexes of the free slots
+	 */
+	int *free_slots;
+};
+
+int libqcow_arena_initialize(
+     libqcow_arena_t **arena,
+     size_t slot_size,
+     size_t slot_alignment,
+     int number_of_slots,
+     libcerror_error_t **error );
+
+int libqcow_arena_free(
+     libqcow_arena_t **arena,
+     libcerror_error_t **error );
+
+int libqcow_arena_contains(
+     libqcow_arena_t *arena,
+     const uint8_t *slot );
+
+int libqcow_arena_get_slot(
+     libqcow_arena_t *arena,
+     uint8_t **slot,
+     libcerror_error_t **error );
+
+int libqcow_arena_release_slot(
+     libqcow_arena_t *arena,
+     uint8_t *slot,
+     libcerror_error_t **error );
+
+int libqcow_arena_get_page_type(
+     libqcow_arena_t *arena,
+     int *page_type,
+     libcerror_error_t **error );
+
+int libqcow_arena_get_memory_usage(
+     libqcow_arena_t *arena,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_ARENA_H ) */
+
@@ -0,0 +1,1323 @@
+/*
+ * Batch functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#include "libqcow_batch.h"
+#include "libqcow_cache.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+/* Creates a batch
+ * Make sure the value batch is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_initialize(
+     libqcow_batch_t **batch,
+     int number_of_threads,
+     int maximum_number_of_open_images,
+     size64_t maximum_cache_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_initialize";
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	if( *batch != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid batch value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_number_of_open_images < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid maximum number of open images value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = memory_allocate_structure(
+	                  libqcow_internal_batch_t );
+
+	if( internal_batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create batch.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_batch,
+	     0,
+	     sizeof( libqcow_internal_batch_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear batch.",
+		 function );
+
+		memory_free(
+		 internal_batch );
+
+		return( -1 );
+	}
+	internal_batch->number_of_threads             = number_of_threads;
+	internal_batch->maximum_number_of_open_images = maximum_number_of_open_images;
+
+	/* The images share a single cache so that the memory used for level 2 tables
+	 * and cluster blocks is bounded by the batch instead of by the number of images
+	 */
+	if( maximum_cache_size > 0 )
+	{
+		if( libqcow_cache_initialize(
+		     &( internal_batch->cache ),
+		     maximum_cache_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create cache.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( internal_batch->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	*batch = (libqcow_batch_t *) internal_batch;
+
+	return( 1 );
+
+on_error:
+	if( internal_batch != NULL )
+	{
+		if( internal_batch->cache != NULL )
+		{
+			libqcow_cache_free(
+			 &( internal_batch->cache ),
+			 NULL );
+		}
+		memory_free(
+		 internal_batch );
+	}
+	return( -1 );
+}
+
+/* Frees a batch
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_free(
+     libqcow_batch_t **batch,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_free";
+	int image_index                          = 0;
+	int result                               = 1;
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	if( *batch != NULL )
+	{
+		internal_batch = (libqcow_internal_batch_t *) *batch;
+		*batch         = NULL;
+
+		for( image_index = 0;
+		     image_index < internal_batch->number_of_images;
+		     image_index++ )
+		{
+			if( internal_batch->images[ image_index ].filename != NULL )
+			{
+				memory_free(
+				 internal_batch->images[ image_index ].filename );
+			}
+			if( internal_batch->images[ image_index ].request_indexes != NULL )
+			{
+				memory_free(
+				 internal_batch->images[ image_index ].request_indexes );
+			}
+		}
+		if( internal_batch->images != NULL )
+		{
+			memory_free(
+			 internal_batch->images );
+		}
+		if( internal_batch->requests != NULL )
+		{
+			memory_free(
+			 internal_batch->requests );
+		}
+		/* The images are freed by libqcow_batch_run before the cache
+		 */
+		if( internal_batch->cache != NULL )
+		{
+			if( libqcow_cache_free(
+			     &( internal_batch->cache ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( internal_batch->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 internal_batch );
+	}
+	return( result );
+}
+
+/* Appends a request to read a range of the (media) data of an image
+ * The image is identified by its filename, requests with the same filename
+ * are read from a single open file in order of offset
+ * The buffer must remain valid until libqcow_batch_run returns
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_append_request(
+     libqcow_batch_t *batch,
+     const char *filename,
+     uint8_t *buffer,
+     size_t size,
+     off64_t offset,
+     int *request_index,
+     libcerror_error_t **error )
+{
+	libqcow_batch_image_t *image             = NULL;
+	libqcow_batch_request_t *request         = NULL;
+	libqcow_internal_batch_t *internal_batch = NULL;
+	void *reallocation                       = NULL;
+	static char *function                    = "libqcow_batch_append_request";
+	size_t filename_length                   = 0;
+	int number_of_allocated_entries          = 0;
+	int position                             = 0;
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) batch;
+
+	if( internal_batch->has_run != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid batch - batch has already been run.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	filename_length = narrow_string_length(
+	                   filename );
+
+	if( filename_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid filename length value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( request_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid request index.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_batch->number_of_requests >= internal_batch->number_of_allocated_requests )
+	{
+		if( internal_batch->number_of_allocated_requests > ( INT_MAX / 2 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid batch - number of requests value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		number_of_allocated_entries = internal_batch->number_of_allocated_requests * 2;
+
+		if( number_of_allocated_entries == 0 )
+		{
+			number_of_allocated_entries = 16;
+		}
+		reallocation = memory_reallocate(
+		                internal_batch->requests,
+		                sizeof( libqcow_batch_request_t ) * number_of_allocated_entries );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize requests.",
+			 function );
+
+			return( -1 );
+		}
+		internal_batch->requests                     = (libqcow_batch_request_t *) reallocation;
+		internal_batch->number_of_allocated_requests = number_of_allocated_entries;
+	}
+	if( libqcow_internal_batch_get_image(
+	     internal_batch,
+	     filename,
+	     filename_length,
+	     &image,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve image.",
+		 function );
+
+		return( -1 );
+	}
+	if( image->number_of_requests >= image->number_of_allocated_request_indexes )
+	{
+		number_of_allocated_entries = image->number_of_allocated_request_indexes * 2;
+
+		if( number_of_allocated_entries == 0 )
+		{
+			number_of_allocated_entries = 4;
+		}
+		reallocation = memory_reallocate(
+		                image->request_indexes,
+		                sizeof( int ) * number_of_allocated_entries );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize request indexes.",
+			 function );
+
+			return( -1 );
+		}
+		image->request_indexes                     = (int *) reallocation;
+		image->number_of_allocated_request_indexes = number_of_allocated_entries;
+	}
+	request = &( internal_batch->requests[ internal_batch->number_of_requests ] );
+
+	request->buffer     = buffer;
+	request->size       = size;
+	request->offset     = offset;
+	request->read_count = -1;
+
+	/* The requests of an image are kept in order of offset so that they are
+	 * read front to back, requests are commonly appended in this order
+	 */
+	position = image->number_of_requests;
+
+	while( ( position > 0 )
+	    && ( internal_batch->requests[ image->request_indexes[ position - 1 ] ].offset > offset ) )
+	{
+		image->request_indexes[ position ] = image->request_indexes[ position - 1 ];
+
+		position--;
+	}
+	image->request_indexes[ position ] = internal_batch->number_of_requests;
+
+	image->number_of_requests += 1;
+
+	*request_index = internal_batch->number_of_requests;
+
+	internal_batch->number_of_requests += 1;
+
+	return( 1 );
+}
+
+/* Retrieves the image of a specific filename
+ * The image is appended if the batch does not contain it
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_batch_get_image(
+     libqcow_internal_batch_t *internal_batch,
+     const char *filename,
+     size_t filename_length,
+     libqcow_batch_image_t **image,
+     libcerror_error_t **error )
+{
+	libqcow_batch_image_t *safe_image = NULL;
+	void *reallocation                = NULL;
+	static char *function             = "libqcow_internal_batch_get_image";
+	int image_index                   = 0;
+	int number_of_allocated_images    = 0;
+
+	if( internal_batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename_length > (size_t) ( SSIZE_MAX - 1 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid filename length value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( image == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid image.",
+		 function );
+
+		return( -1 );
+	}
+	/* Search backwards since the requests of an image are commonly appended together
+	 */
+	for( image_index = internal_batch->number_of_images - 1;
+	     image_index >= 0;
+	     image_index-- )
+	{
+		safe_image = &( internal_batch->images[ image_index ] );
+
+		if( ( safe_image->filename_size == ( filename_length + 1 ) )
+		 && ( narrow_string_compare(
+		       safe_image->filename,
+		       filename,
+		       filename_length ) == 0 ) )
+		{
+			*image = safe_image;
+
+			return( 1 );
+		}
+	}
+	if( internal_batch->number_of_images >= internal_batch->number_of_allocated_images )
+	{
+		if( internal_batch->number_of_allocated_images > ( INT_MAX / 2 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid batch - number of images value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		number_of_allocated_images = internal_batch->number_of_allocated_images * 2;
+
+		if( number_of_allocated_images == 0 )
+		{
+			number_of_allocated_images = 16;
+		}
+		reallocation = memory_reallocate(
+		                internal_batch->images,
+		                sizeof( libqcow_batch_image_t ) * number_of_allocated_images );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize images.",
+			 function );
+
+			return( -1 );
+		}
+		internal_batch->images                     = (libqcow_batch_image_t *) reallocation;
+		internal_batch->number_of_allocated_images = number_of_allocated_images;
+	}
+	safe_image = &( internal_batch->images[ internal_batch->number_of_images ] );
+
+	if( memory_set(
+	     safe_image,
+	     0,
+	     sizeof( libqcow_batch_image_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear image.",
+		 function );
+
+		return( -1 );
+	}
+	safe_image->filename = narrow_string_allocate(
+	                        filename_length + 1 );
+
+	if( safe_image->filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( narrow_string_copy(
+	     safe_image->filename,
+	     filename,
+	     filename_length ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy filename.",
+		 function );
+
+		memory_free(
+		 safe_image->filename );
+
+		safe_image->filename = NULL;
+
+		return( -1 );
+	}
+	safe_image->filename[ filename_length ] = 0;
+	safe_image->filename_size               = filename_length + 1;
+
+	internal_batch->number_of_images += 1;
+
+	*image = safe_image;
+
+	return( 1 );
+}
+
+/* Retrieves the number of requests
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_get_number_of_requests(
+     libqcow_batch_t *batch,
+     int *number_of_requests,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_get_number_of_requests";
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) batch;
+
+	if( number_of_requests == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of requests.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_requests = internal_batch->number_of_requests;
+
+	return( 1 );
+}
+
+/* Retrieves the number of images
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_get_number_of_images(
+     libqcow_batch_t *batch,
+     int *number_of_images,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_get_number_of_images";
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) batch;
+
+	if( number_of_images == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of images.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_images = internal_batch->number_of_images;
+
+	return( 1 );
+}
+
+/* Runs the requests of a batch
+ * Returns 1 if successful, 0 if one or more requests could not be read or -1 on error
+ */
+int libqcow_batch_run(
+     libqcow_batch_t *batch,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_run";
+	int number_of_failed_requests            = 0;
+	int number_of_workers                    = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_t **threads           = NULL;
+	int result                               = 1;
+	int worker_index                         = 0;
+#endif
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) batch;
+
+	if( internal_batch->has_run != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid batch - batch has already been run.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch->has_run = 1;
+
+	/* Every worker has at most one image open at a time
+	 */
+	number_of_workers = internal_batch->number_of_threads;
+
+	if( ( internal_batch->maximum_number_of_open_images > 0 )
+	 && ( number_of_workers > internal_batch->maximum_number_of_open_images ) )
+	{
+		number_of_workers = internal_batch->maximum_number_of_open_images;
+	}
+	if( number_of_workers > internal_batch->number_of_images )
+	{
+		number_of_workers = internal_batch->number_of_images;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_workers > 0 )
+	{
+		threads = (libcthreads_thread_t **) memory_allocate(
+		                                     sizeof( libcthreads_thread_t * ) * number_of_workers );
+
+		if( threads == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create threads.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_set(
+		     threads,
+		     0,
+		     sizeof( libcthreads_thread_t * ) * number_of_workers ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear threads.",
+			 function );
+
+			memory_free(
+			 threads );
+
+			return( -1 );
+		}
+		for( worker_index = 0;
+		     worker_index < number_of_workers;
+		     worker_index++ )
+		{
+			if( libcthreads_thread_create(
+			     &( threads[ worker_index ] ),
+			     NULL,
+			     &libqcow_batch_thread_function,
+			     (void *) internal_batch,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create thread: %d.",
+				 function,
+				 worker_index );
+
+				/* The threads that were created are stopped after their current image
+				 */
+				internal_batch->abort = 1;
+
+				result = -1;
+
+				break;
+			}
+		}
+		for( worker_index = 0;
+		     worker_index < number_of_workers;
+		     worker_index++ )
+		{
+			if( threads[ worker_index ] != NULL )
+			{
+				/* The images and buffers cannot be released safely if the thread has not stopped
+				 */
+				if( libcthreads_thread_join(
+				     &( threads[ worker_index ] ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to join thread: %d.",
+					 function,
+					 worker_index );
+
+					return( -1 );
+				}
+			}
+		}
+		memory_free(
+		 threads );
+
+		if( result != 1 )
+		{
+			return( -1 );
+		}
+		if( internal_batch->abort != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to process images.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+	{
+		/* Without worker threads the images are processed in the calling thread
+		 */
+		while( internal_batch->next_image_index < internal_batch->number_of_images )
+		{
+			if( libqcow_internal_batch_process_image(
+			     internal_batch,
+			     &( internal_batch->images[ internal_batch->next_image_index ] ),
+			     &number_of_failed_requests,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to process image: %d.",
+				 function,
+				 internal_batch->next_image_index );
+
+				return( -1 );
+			}
+			internal_batch->next_image_index += 1;
+
+			internal_batch->number_of_failed_requests += number_of_failed_requests;
+		}
+	}
+	if( internal_batch->number_of_failed_requests > 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Processes the requests of an image
+ * The image is opened, its requests are read in order of offset and it is closed,
+ * requests that cannot be read are not considered an error
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_batch_process_image(
+     libqcow_internal_batch_t *internal_batch,
+     libqcow_batch_image_t *image,
+     int *number_of_failed_requests,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *request_error = NULL;
+	libqcow_batch_request_t *request = NULL;
+	libqcow_file_t *file             = NULL;
+	static char *function            = "libqcow_internal_batch_process_image";
+	int number_of_failures           = 0;
+	int request_index                = 0;
+	int result                       = 0;
+
+	if( internal_batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	if( image == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid image.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_failed_requests == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of failed requests.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_initialize(
+	     &file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_batch->cache != NULL )
+	{
+		if( libqcow_file_set_cache(
+		     file,
+		     internal_batch->cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set cache.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	/* An image that cannot be opened fails its requests but not the batch
+	 */
+	result = libqcow_file_open(
+	          file,
+	          image->filename,
+	          LIBQCOW_OPEN_READ,
+	          &request_error );
+
+	if( result == 1 )
+	{
+		for( request_index = 0;
+		     request_index < image->number_of_requests;
+		     request_index++ )
+		{
+			request = &( internal_batch->requests[ image->request_indexes[ request_index ] ] );
+
+			request->read_count = libqcow_file_read_buffer_at_offset(
+			                       file,
+			                       request->buffer,
+			                       request->size,
+			                       request->offset,
+			                       &request_error );
+
+			if( request->read_count == -1 )
+			{
+#if defined( HAVE_DEBUG_OUTPUT )
+				if( libcnotify_verbose != 0 )
+				{
+					libcnotify_printf(
+					 "%s: unable to read request: %d of image: %s.\n",
+					 function,
+					 image->request_indexes[ request_index ],
+					 image->filename );
+
+					libcnotify_print_error_backtrace(
+					 request_error );
+				}
+#endif
+				libcerror_error_free(
+				 &request_error );
+
+				number_of_failures++;
+			}
+		}
+		if( libqcow_file_close(
+		     file,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: unable to open image: %s.\n",
+			 function,
+			 image->filename );
+
+			libcnotify_print_error_backtrace(
+			 request_error );
+		}
+#endif
+		libcerror_error_free(
+		 &request_error );
+
+		number_of_failures = image->number_of_requests;
+	}
+	if( libqcow_file_free(
+	     &file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file.",
+		 function );
+
+		goto on_error;
+	}
+	*number_of_failed_requests = number_of_failures;
+
+	return( 1 );
+
+on_error:
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_batch_image_t *image             = NULL;
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_thread_function";
+	int number_of_failed_requests            = 0;
+	int result                               = 1;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) arguments;
+
+	do
+	{
+		if( libcthreads_mutex_grab(
+		     internal_batch->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			goto on_error;
+		}
+		internal_batch->number_of_failed_requests += number_of_failed_requests;
+
+		number_of_failed_requests = 0;
+
+		image = NULL;
+
+		if( ( internal_batch->abort == 0 )
+		 && ( internal_batch->next_image_index < internal_batch->number_of_images ) )
+		{
+			image = &( internal_batch->images[ internal_batch->next_image_index ] );
+
+			internal_batch->next_image_index += 1;
+		}
+		if( libcthreads_mutex_release(
+		     internal_batch->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			goto on_error;
+		}
+		if( image == NULL )
+		{
+			break;
+		}
+		result = libqcow_internal_batch_process_image(
+		          internal_batch,
+		          image,
+		          &number_of_failed_requests,
+		          &error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to process image.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	while( result == 1 );
+
+	return( 1 );
+
+on_error:
+	/* The other workers stop after their current image and libqcow_batch_run fails
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_batch->mutex,
+	     NULL ) == 1 )
+	{
+		internal_batch->abort = 1;
+
+		libcthreads_mutex_release(
+		 internal_batch->mutex,
+		 NULL );
+	}
+	if( error != NULL )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Retrieves the result of a specific request
+ * The read count is the number of bytes read, which is less than the size of the
+ * request if it extends beyond the media size, or -1 if the request could not be read
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_batch_get_request_result(
+     libqcow_batch_t *batch,
+     int request_index,
+     ssize_t *read_count,
+     libcerror_error_t **error )
+{
+	libqcow_internal_batch_t *internal_batch = NULL;
+	static char *function                    = "libqcow_batch_get_request_result";
+
+	if( batch == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid batch.",
+		 function );
+
+		return( -1 );
+	}
+	internal_batch = (libqcow_internal_batch_t *) batch;
+
+	if( internal_batch->has_run == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid batch - batch has not been run.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( request_index < 0 )
+	 || ( request_index >= internal_batch->number_of_requests ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid request index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( read_count == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read count.",
+		 function );
+
+		return( -1 );
+	}
+	*read_count = internal_batch->requests[ request_index ].read_count;
+
+	return( 1 );
+}
+
@@ -0,0 +1,224 @@
+/*
+ * Batch functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_INTERNAL_BATCH_H )
+#define _LIBQCOW_INTERNAL_BATCH_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_extern.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_internal_batch libqcow_internal_batch_t;
+typedef struct libqcow_batch_image libqcow_batch_image_t;
+typedef struct libqcow_batch_request libqcow_batch_request_t;
+
+/* A request reads a range of the (media) data of an image into a buffer of the caller
+ */
+struct libqcow_batch_request
+{
+	/* The buffer
+	 */
+	uint8_t *buffer;
+
+	/* The size
+	 */
+	size_t size;
+
+	/* The (storage media) offset
+	 */
+	off64_t offset;
+
+	/* The number of bytes read, where -1 represents the request could not be read
+	 */
+	ssize_t read_count;
+};
+
+/* An image is opened once for all its requests
+ */
+struct libqcow_batch_image
+{
+	/* The filename
+	 */
+	char *filename;
+
+	/* The filename size
+	 */
+	size_t filename_size;
+
+	/* The indexes of the requests in order of offset
+	 */
+	int *request_indexes;
+
+	/* The number of requests
+	 */
+	int number_of_requests;
+
+	/* The number of allocated request indexes
+	 */
+	int number_of_allocated_request_indexes;
+};
+
+/* The images are processed by workers that each open one image at a time,
+ * which bounds the number of open images and the number of concurrent reads
+ * and lets the reads of different images overlap
+ */
+struct libqcow_internal_batch
+{
+	/* The requests
+	 */
+	libqcow_batch_request_t *requests;
+
+	/* The number of requests
+	 */
+	int number_of_requests;
+
+	/* The number of allocated requests
+	 */
+	int number_of_allocated_requests;
+
+	/* The images
+	 */
+	libqcow_batch_image_t *images;
+
+	/* The number of images
+	 */
+	int number_of_images;
+
+	/* The number of allocated images
+	 */
+	int number_of_allocated_images;
+
+	/* The number of threads
+	 */
+	int number_of_threads;
+
+	/* The maximum number of open images, where 0 represents no limit
+	 */
+	int maximum_number_of_open_images;
+
+	/* The (shared) cache of the images
+	 */
+	libqcow_cache_t *cache;
+
+	/* The index of the next image to process
+	 */
+	int next_image_index;
+
+	/* The number of requests that could not be read
+	 */
+	int number_of_failed_requests;
+
+	/* Value to indicate the batch has been run
+	 */
+	uint8_t has_run;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+LIBQCOW_EXTERN \
+int libqcow_batch_initialize(
+     libqcow_batch_t **batch,
+     int number_of_threads,
+     int maximum_number_of_open_images,
+     size64_t maximum_cache_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_batch_free(
+     libqcow_batch_t **batch,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_batch_append_request(
+     libqcow_batch_t *batch,
+     const char *filename,
+     uint8_t *buffer,
+     size_t size,
+     off64_t offset,
+     int *request_index,
+     libcerror_error_t **error );
+
+int libqcow_internal_batch_get_image(
+     libqcow_internal_batch_t *internal_batch,
+     const char *filename,
+     size_t filename_length,
+     libqcow_batch_image_t **image,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_batch_get_number_of_requests(
+     libqcow_batch_t *batch,
+     int *number_of_requests,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_batch_get_number_of_images(
+     libqcow_batch_t *batch,
+     int *number_of_images,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_batch_run(
+     libqcow_batch_t *batch,
+     libcerror_error_t **error );
+
+int libqcow_internal_batch_process_image(
+     libqcow_internal_batch_t *internal_batch,
+     libqcow_batch_image_t *image,
+     int *number_of_failed_requests,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_batch_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+LIBQCOW_EXTERN \
+int libqcow_batch_get_request_result(
+     libqcow_batch_t *batch,
+     int request_index,
+     ssize_t *read_count,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_INTERNAL_BATCH_H ) */
+
@@ -0,0 +1,1065 @@
+/*
+ * Bitmap values functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_bitmap_values.h"
+#include "libqcow_byte_swap.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libuna.h"
+
+#include "qcow_bitmap.h"
+
+/* Creates bitmap values
+ * Make sure the value bitmap_values is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_bitmap_values_initialize(
+     libqcow_bitmap_values_t **bitmap_values,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_bitmap_values_initialize";
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( *bitmap_values != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid bitmap values value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*bitmap_values = memory_allocate_structure(
+	                    libqcow_bitmap_values_t );
+
+	if( *bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create bitmap values.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *bitmap_values,
+	     0,
+	     sizeof( libqcow_bitmap_values_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear bitmap values.",
+		 function );
+
+		goto on_error;
+	}
+	( *bitmap_values )->cluster_data_table_index = -1;
+
+	return( 1 );
+
+on_error:
+	if( *bitmap_values != NULL )
+	{
+		memory_free(
+		 *bitmap_values );
+
+		*bitmap_values = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees bitmap values
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_bitmap_values_free(
+     libqcow_bitmap_values_t **bitmap_values,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_bitmap_values_free";
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( *bitmap_values != NULL )
+	{
+		if( ( *bitmap_values )->cluster_data != NULL )
+		{
+			memory_free(
+			 ( *bitmap_values )->cluster_data );
+		}
+		if( ( *bitmap_values )->bitmap_table != NULL )
+		{
+			memory_free(
+			 ( *bitmap_values )->bitmap_table );
+		}
+		if( ( *bitmap_values )->name != NULL )
+		{
+			memory_free(
+			 ( *bitmap_values )->name );
+		}
+		memory_free(
+		 *bitmap_values );
+
+		*bitmap_values = NULL;
+	}
+	return( 1 );
+}
+
+/* Reads the bitmap values from a bitmap directory entry
+ * The entry size is the size of the bitmap directory entry including padding
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_bitmap_values_read_data(
+     libqcow_bitmap_values_t *bitmap_values,
+     const uint8_t *data,
+     size_t data_size,
+     size_t *entry_size,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_bitmap_values_read_data";
+	size_t data_offset       = 0;
+	size_t safe_entry_size   = 0;
+	uint32_t extra_data_size = 0;
+	uint16_t name_size       = 0;
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( bitmap_values->name != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid bitmap values - name value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size < sizeof( qcow_bitmap_directory_entry_t ) )
+	 || ( data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid entry size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: bitmap directory entry data:\n",
+		 function );
+		libcnotify_print_data(
+		 data,
+		 sizeof( qcow_bitmap_directory_entry_t ),
+		 0 );
+	}
+#endif
+	byte_stream_copy_to_uint64_big_endian(
+	 ( (qcow_bitmap_directory_entry_t *) data )->bitmap_table_offset,
+	 bitmap_values->bitmap_table_offset );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_bitmap_directory_entry_t *) data )->number_of_bitmap_table_entries,
+	 bitmap_values->number_of_bitmap_table_entries );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_bitmap_directory_entry_t *) data )->flags,
+	 bitmap_values->flags );
+
+	bitmap_values->bitmap_type                = ( (qcow_bitmap_directory_entry_t *) data )->bitmap_type;
+	bitmap_values->number_of_granularity_bits = ( (qcow_bitmap_directory_entry_t *) data )->number_of_granularity_bits;
+
+	byte_stream_copy_to_uint16_big_endian(
+	 ( (qcow_bitmap_directory_entry_t *) data )->name_size,
+	 name_size );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_bitmap_directory_entry_t *) data )->extra_data_size,
+	 extra_data_size );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: bitmap table offset\t\t: 0x%08" PRIx64 "\n",
+		 function,
+		 bitmap_values->bitmap_table_offset );
+
+		libcnotify_printf(
+		 "%s: number of bitmap table entries\t: %" PRIu32 "\n",
+		 function,
+		 bitmap_values->number_of_bitmap_table_entries );
+
+		libcnotify_printf(
+		 "%s: flags\t\t\t\t: 0x%08" PRIx32 "\n",
+		 function,
+		 bitmap_values->flags );
+
+		libcnotify_printf(
+		 "%s: bitmap type\t\t\t: %" PRIu8 "\n",
+		 function,
+		 bitmap_values->bitmap_type );
+
+		libcnotify_printf(
+		 "%s: number of granularity bits\t: %" PRIu8 "\n",
+		 function,
+		 bitmap_values->number_of_granularity_bits );
+
+		libcnotify_printf(
+		 "%s: name size\t\t\t\t: %" PRIu16 "\n",
+		 function,
+		 name_size );
+
+		libcnotify_printf(
+		 "%s: extra data size\t\t\t: %" PRIu32 "\n",
+		 function,
+		 extra_data_size );
+	}
+#endif
+	if( bitmap_values->number_of_granularity_bits > 63 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of granularity bits value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	data_offset = sizeof( qcow_bitmap_directory_entry_t );
+
+	if( (size_t) extra_data_size > ( data_size - data_offset ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid extra data size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	data_offset += (size_t) extra_data_size;
+
+	if( ( name_size == 0 )
+	 || ( (size_t) name_size > ( data_size - data_offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid name size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	bitmap_values->name = (uint8_t *) memory_allocate(
+	                                   sizeof( uint8_t ) * name_size );
+
+	if( bitmap_values->name == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create name.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_copy(
+	     bitmap_values->name,
+	     &( data[ data_offset ] ),
+	     (size_t) name_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy name.",
+		 function );
+
+		goto on_error;
+	}
+	bitmap_values->name_size = (size_t) name_size;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: name:\n",
+		 function );
+		libcnotify_print_data(
+		 bitmap_values->name,
+		 bitmap_values->name_size,
+		 0 );
+	}
+#endif
+	/* The bitmap directory entry is padded to a multitude of 8 bytes
+	 */
+	safe_entry_size = data_offset + (size_t) name_size;
+
+	if( ( safe_entry_size % 8 ) != 0 )
+	{
+		safe_entry_size += 8 - ( safe_entry_size % 8 );
+	}
+	*entry_size = safe_entry_size;
+
+	return( 1 );
+
+on_error:
+	if( bitmap_values->name != NULL )
+	{
+		memory_free(
+		 bitmap_values->name );
+
+		bitmap_values->name = NULL;
+	}
+	bitmap_values->name_size = 0;
+
+	return( -1 );
+}
+
+/* Reads the bitmap table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_bitmap_values_read_bitmap_table(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_bitmap_values_read_bitmap_table";
+	size_t bitmap_table_size = 0;
+	ssize_t read_count       = 0;
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( bitmap_values->bitmap_table != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid bitmap values - bitmap table value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( bitmap_values->number_of_bitmap_table_entries == 0 )
+	{
+		return( 1 );
+	}
+	if( (size64_t) bitmap_values->number_of_bitmap_table_entries > (size64_t) ( SSIZE_MAX / 8 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap values - number of bitmap table entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( bitmap_values->bitmap_table_offset <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap values - bitmap table offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	bitmap_table_size = (size_t) bitmap_values->number_of_bitmap_table_entries * 8;
+
+	bitmap_values->bitmap_table = (uint64_t *) memory_allocate(
+	                                            bitmap_table_size );
+
+	if( bitmap_values->bitmap_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create bitmap table.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) bitmap_values->bitmap_table,
+	              bitmap_table_size,
+	              bitmap_values->bitmap_table_offset,
+	              error );
+
+	if( read_count != (ssize_t) bitmap_table_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read bitmap table at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 bitmap_values->bitmap_table_offset,
+		 bitmap_values->bitmap_table_offset );
+
+		goto on_error;
+	}
+	/* The bitmap table entries are converted in place
+	 */
+	if( libqcow_byte_swap_uint64_big_endian(
+	     bitmap_values->bitmap_table,
+	     (size_t) bitmap_values->number_of_bitmap_table_entries,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to convert bitmap table entries.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( bitmap_values->bitmap_table != NULL )
+	{
+		memory_free(
+		 bitmap_values->bitmap_table );
+
+		bitmap_values->bitmap_table = NULL;
+	}
+	return( -1 );
+}
+
+/* Retrieves the size of the UTF-8 encoded name
+ * The returned size includes the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_bitmap_values_get_utf8_name_size(
+     libqcow_bitmap_values_t *bitmap_values,
+     size_t *utf8_string_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_bitmap_values_get_utf8_name_size";
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( bitmap_values->name == NULL )
+	 || ( bitmap_values->name_size == 0 ) )
+	{
+		return( 0 );
+	}
+	if( libuna_utf8_string_size_from_utf8_stream(
+	     bitmap_values->name,
+	     bitmap_values->name_size,
+	     utf8_string_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 string size.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the UTF-8 encoded name
+ * The size should include the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_bitmap_values_get_utf8_name(
+     libqcow_bitmap_values_t *bitmap_values,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_bitmap_values_get_utf8_name";
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( bitmap_values->name == NULL )
+	 || ( bitmap_values->name_size == 0 ) )
+	{
+		return( 0 );
+	}
+	if( libuna_utf8_string_copy_from_utf8_stream(
+	     utf8_string,
+	     utf8_string_size,
+	     bitmap_values->name,
+	     bitmap_values->name_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy name to UTF-8 string.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Compares the name with an UTF-8 encoded string
+ * Returns 1 if equal, 0 if not or -1 on error
+ */
+int libqcow_bitmap_values_compare_name_with_utf8_string(
+     libqcow_bitmap_values_t *bitmap_values,
+     const uint8_t *utf8_string,
+     size_t utf8_string_length,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_bitmap_values_compare_name_with_utf8_string";
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( utf8_string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid UTF-8 string.",
+		 function );
+
+		return( -1 );
+	}
+	if( utf8_string_length > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid UTF-8 string length value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	/* The name is stored without an end of string character
+	 */
+	if( ( bitmap_values->name == NULL )
+	 || ( bitmap_values->name_size != utf8_string_length ) )
+	{
+		return( 0 );
+	}
+	if( memory_compare(
+	     bitmap_values->name,
+	     utf8_string,
+	     utf8_string_length ) != 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Finds the first granule from a specific granule index that is dirty or clean
+ * The bitmap table must be read before calling this function
+ * Granules beyond the end of the bitmap table are clean
+ * Returns 1 if successful, 0 if no such granule was found or -1 on error
+ */
+int libqcow_bitmap_values_find_granule(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     uint64_t granule_index,
+     uint64_t number_of_granules,
+     uint8_t dirty,
+     uint64_t *found_granule_index,
+     libcerror_error_t **error )
+{
+	static char *function         = "libqcow_bitmap_values_find_granule";
+	off64_t cluster_offset        = 0;
+	ssize_t read_count            = 0;
+	uint64_t bit_index            = 0;
+	uint64_t first_granule_index  = 0;
+	uint64_t granules_per_cluster = 0;
+	uint64_t last_bit_index       = 0;
+	uint64_t last_granule_index   = 0;
+	uint64_t table_entry          = 0;
+	uint64_t table_index          = 0;
+	uint8_t byte_value            = 0;
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( bitmap_values->bitmap_table == NULL )
+	 && ( bitmap_values->number_of_bitmap_table_entries != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid bitmap values - missing bitmap table.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( found_granule_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid found granule index.",
+		 function );
+
+		return( -1 );
+	}
+	/* Every bitmap cluster contains 8 granules per byte
+	 */
+	granules_per_cluster = (uint64_t) cluster_block_size * 8;
+
+	while( granule_index < number_of_granules )
+	{
+		table_index = granule_index / granules_per_cluster;
+
+		if( table_index >= (uint64_t) bitmap_values->number_of_bitmap_table_entries )
+		{
+			if( dirty != 0 )
+			{
+				return( 0 );
+			}
+			*found_granule_index = granule_index;
+
+			return( 1 );
+		}
+		first_granule_index = table_index * granules_per_cluster;
+		last_granule_index  = first_granule_index + granules_per_cluster;
+
+		if( last_granule_index > number_of_granules )
+		{
+			last_granule_index = number_of_granules;
+		}
+		table_entry    = bitmap_values->bitmap_table[ table_index ];
+		cluster_offset = (off64_t) ( table_entry & 0x00fffffffffffe00ULL );
+
+		/* A bitmap table entry without a cluster marks all its granules
+		 * either dirty (bit 0 set) or clean
+		 */
+		if( cluster_offset == 0 )
+		{
+			if( (uint8_t) ( table_entry & 0x01 ) == dirty )
+			{
+				*found_granule_index = granule_index;
+
+				return( 1 );
+			}
+			granule_index = last_granule_index;
+
+			continue;
+		}
+		if( bitmap_values->cluster_data_table_index != (int64_t) table_index )
+		{
+			if( bitmap_values->cluster_data == NULL )
+			{
+				bitmap_values->cluster_data = (uint8_t *) memory_allocate(
+				                                           sizeof( uint8_t ) * cluster_block_size );
+
+				if( bitmap_values->cluster_data == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+					 "%s: unable to create bitmap cluster data.",
+					 function );
+
+					return( -1 );
+				}
+			}
+			bitmap_values->cluster_data_table_index = -1;
+
+			read_count = libbfio_handle_read_buffer_at_offset(
+			              file_io_handle,
+			              bitmap_values->cluster_data,
+			              cluster_block_size,
+			              cluster_offset,
+			              error );
+
+			if( read_count != (ssize_t) cluster_block_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read bitmap cluster: %" PRIu64 " at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 table_index,
+				 cluster_offset,
+				 cluster_offset );
+
+				return( -1 );
+			}
+			bitmap_values->cluster_data_table_index = (int64_t) table_index;
+		}
+		bit_index      = granule_index - first_granule_index;
+		last_bit_index = last_granule_index - first_granule_index;
+
+		/* The bits are stored least significant bit first
+		 */
+		while( bit_index < last_bit_index )
+		{
+			byte_value = bitmap_values->cluster_data[ bit_index / 8 ];
+
+			if( ( bit_index % 8 ) == 0 )
+			{
+				if( ( ( dirty != 0 )
+				  &&  ( byte_value == 0x00 ) )
+				 || ( ( dirty == 0 )
+				  &&  ( byte_value == 0xff ) ) )
+				{
+					bit_index += 8;
+
+					continue;
+				}
+			}
+			if( (uint8_t) ( ( byte_value >> ( bit_index % 8 ) ) & 0x01 ) == dirty )
+			{
+				*found_granule_index = first_granule_index + bit_index;
+
+				return( 1 );
+			}
+			bit_index++;
+		}
+		granule_index = last_granule_index;
+	}
+	return( 0 );
+}
+
+/* Retrieves the next dirty range at or after a specific offset
+ * The range is the contiguous run of dirty granules, clamped to the offset and the media size
+ * Returns 1 if successful, 0 if no more dirty ranges or -1 on error
+ */
+int libqcow_bitmap_values_get_next_dirty_range(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     size64_t media_size,
+     off64_t offset,
+     off64_t *range_offset,
+     size64_t *range_size,
+     libcerror_error_t **error )
+{
+	static char *function        = "libqcow_bitmap_values_get_next_dirty_range";
+	uint64_t clean_granule_index = 0;
+	uint64_t dirty_granule_index = 0;
+	uint64_t number_of_granules  = 0;
+	uint64_t range_end_offset    = 0;
+	uint64_t range_start_offset  = 0;
+	int result                   = 0;
+
+	if( bitmap_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap values.",
+		 function );
+
+		return( -1 );
+	}
+	if( bitmap_values->bitmap_type != LIBQCOW_BITMAP_TYPE_DIRTY_TRACKING )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported bitmap type: %" PRIu8 ".",
+		 function,
+		 bitmap_values->bitmap_type );
+
+		return( -1 );
+	}
+	/* A bitmap that is in use was not stored consistently when the image was closed
+	 */
+	if( ( bitmap_values->flags & LIBQCOW_BITMAP_FLAG_IN_USE ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported bitmap - bitmap is in use and can be inconsistent.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( range_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid range offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( range_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid range size.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= media_size )
+	{
+		return( 0 );
+	}
+	if( ( bitmap_values->bitmap_table == NULL )
+	 && ( bitmap_values->number_of_bitmap_table_entries != 0 ) )
+	{
+		if( libqcow_bitmap_values_read_bitmap_table(
+		     bitmap_values,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read bitmap table.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	number_of_granules = ( ( media_size - 1 ) >> bitmap_values->number_of_granularity_bits ) + 1;
+
+	result = libqcow_bitmap_values_find_granule(
+	          bitmap_values,
+	          file_io_handle,
+	          cluster_block_size,
+	          (uint64_t) offset >> bitmap_values->number_of_granularity_bits,
+	          number_of_granules,
+	          1,
+	          &dirty_granule_index,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to find dirty granule.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		return( 0 );
+	}
+	result = libqcow_bitmap_values_find_granule(
+	          bitmap_values,
+	          file_io_handle,
+	          cluster_block_size,
+	          dirty_granule_index + 1,
+	          number_of_granules,
+	          0,
+	          &clean_granule_index,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to find clean granule.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		clean_granule_index = number_of_granules;
+	}
+	range_start_offset = dirty_granule_index << bitmap_values->number_of_granularity_bits;
+
+	if( range_start_offset < (uint64_t) offset )
+	{
+		range_start_offset = (uint64_t) offset;
+	}
+	if( clean_granule_index >= number_of_granules )
+	{
+		range_end_offset = (uint64_t) media_size;
+	}
+	else
+	{
+		range_end_offset = clean_granule_index << bitmap_values->number_of_granularity_bits;
+	}
+	*range_offset = (off64_t) range_start_offset;
+	*range_size   = (size64_t) ( range_end_offset - range_start_offset );
+
+	return( 1 );
+}
+
@@ -0,0 +1,146 @@
+/*
+ * Bitmap values functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_BITMAP_VALUES_H )
+#define _LIBQCOW_BITMAP_VALUES_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_bitmap_values libqcow_bitmap_values_t;
+
+struct libqcow_bitmap_values
+{
+	/* The bitmap table offset
+	 */
+	off64_t bitmap_table_offset;
+
+	/* The number of bitmap table entries
+	 */
+	uint32_t number_of_bitmap_table_entries;
+
+	/* The flags
+	 */
+	uint32_t flags;
+
+	/* The bitmap type
+	 */
+	uint8_t bitmap_type;
+
+	/* The number of granularity bits
+	 * Every bit of the bitmap covers 2^granularity bits bytes of the media data
+	 */
+	uint8_t number_of_granularity_bits;
+
+	/* The name
+	 */
+	uint8_t *name;
+
+	/* The name size
+	 */
+	size_t name_size;
+
+	/* The bitmap table
+	 * Contains the bitmap table entries, read on demand
+	 */
+	uint64_t *bitmap_table;
+
+	/* The bitmap cluster data
+	 * Contains the most recently read bitmap cluster
+	 */
+	uint8_t *cluster_data;
+
+	/* The bitmap table index of the bitmap cluster data
+	 * Contains -1 if no bitmap cluster has been read
+	 */
+	int64_t cluster_data_table_index;
+};
+
+int libqcow_bitmap_values_initialize(
+     libqcow_bitmap_values_t **bitmap_values,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_free(
+     libqcow_bitmap_values_t **bitmap_values,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_read_data(
+     libqcow_bitmap_values_t *bitmap_values,
+     const uint8_t *data,
+     size_t data_size,
+     size_t *entry_size,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_read_bitmap_table(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_get_utf8_name_size(
+     libqcow_bitmap_values_t *bitmap_values,
+     size_t *utf8_string_size,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_get_utf8_name(
+     libqcow_bitmap_values_t *bitmap_values,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_compare_name_with_utf8_string(
+     libqcow_bitmap_values_t *bitmap_values,
+     const uint8_t *utf8_string,
+     size_t utf8_string_length,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_find_granule(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     uint64_t granule_index,
+     uint64_t number_of_granules,
+     uint8_t dirty,
+     uint64_t *found_granule_index,
+     libcerror_error_t **error );
+
+int libqcow_bitmap_values_get_next_dirty_range(
+     libqcow_bitmap_values_t *bitmap_values,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     size64_t media_size,
+     off64_t offset,
+     off64_t *range_offset,
+     size64_t *range_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_BITMAP_VALUES_H ) */
+
@@ -0,0 +1,911 @@
+/*
+ * Block cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_block_cache.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+
+/* Determines the set of an offset
+ * The offset is hashed so that offsets that are a multiple of the cluster block size
+ * or of the number of sets are spread over all the sets
+ * Returns the set index
+ */
+static int libqcow_block_cache_get_set_index(
+            libqcow_block_cache_t *block_cache,
+            off64_t offset )
+{
+	uint64_t hash = 0;
+
+	hash = (uint64_t) offset * LIBQCOW_BLOCK_CACHE_HASH_MULTIPLIER;
+
+	return( (int) ( ( hash >> 32 ) % (uint64_t) block_cache->number_of_sets ) );
+}
+
+/* Creates a block cache
+ * The values are stored in sets of LIBQCOW_BLOCK_CACHE_NUMBER_OF_WAYS entries and
+ * the least recently used value of a set is replaced when the set is full
+ * Make sure the value block_cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_initialize(
+     libqcow_block_cache_t **block_cache,
+     int maximum_number_of_values,
+     int (*free_value)(
+            intptr_t **value,
+            libcerror_error_t **error ),
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_initialize";
+	size_t entries_size   = 0;
+	int number_of_sets    = 0;
+	int number_of_ways    = 0;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *block_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid block cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_values <= 0 )
+	 || ( maximum_number_of_values > ( INT_MAX - LIBQCOW_BLOCK_CACHE_NUMBER_OF_WAYS ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of values value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( free_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid free value function.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_ways = LIBQCOW_BLOCK_CACHE_NUMBER_OF_WAYS;
+
+	if( number_of_ways > maximum_number_of_values )
+	{
+		number_of_ways = maximum_number_of_values;
+	}
+	number_of_sets = ( maximum_number_of_values + number_of_ways - 1 ) / number_of_ways;
+
+	entries_size = sizeof( libqcow_block_cache_entry_t ) * (size_t) number_of_sets * (size_t) number_of_ways;
+
+	if( entries_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid entries size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	*block_cache = memory_allocate_structure(
+	                libqcow_block_cache_t );
+
+	if( *block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create block cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *block_cache,
+	     0,
+	     sizeof( libqcow_block_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear block cache.",
+		 function );
+
+		memory_free(
+		 *block_cache );
+
+		*block_cache = NULL;
+
+		return( -1 );
+	}
+	( *block_cache )->entries = (libqcow_block_cache_entry_t *) memory_allocate(
+	                                                             entries_size );
+
+	if( ( *block_cache )->entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entries.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *block_cache )->entries,
+	     0,
+	     entries_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear entries.",
+		 function );
+
+		goto on_error;
+	}
+	( *block_cache )->number_of_sets = number_of_sets;
+	( *block_cache )->number_of_ways = number_of_ways;
+	( *block_cache )->free_value     = free_value;
+
+	return( 1 );
+
+on_error:
+	if( *block_cache != NULL )
+	{
+		if( ( *block_cache )->entries != NULL )
+		{
+			memory_free(
+			 ( *block_cache )->entries );
+		}
+		memory_free(
+		 *block_cache );
+
+		*block_cache = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a block cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_free(
+     libqcow_block_cache_t **block_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_free";
+	int result            = 1;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *block_cache != NULL )
+	{
+		if( libqcow_block_cache_clear(
+		     *block_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to clear block cache.",
+			 function );
+
+			result = -1;
+		}
+		memory_free(
+		 ( *block_cache )->entries );
+
+		memory_free(
+		 *block_cache );
+
+		*block_cache = NULL;
+	}
+	return( result );
+}
+
+/* Clears a block cache
+ * This frees all the values in the cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_clear(
+     libqcow_block_cache_t *block_cache,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry = NULL;
+	static char *function              = "libqcow_block_cache_clear";
+	int entry_index                    = 0;
+	int number_of_entries              = 0;
+	int result                         = 1;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_entries = block_cache->number_of_sets * block_cache->number_of_ways;
+
+	for( entry_index = 0;
+	     entry_index < number_of_entries;
+	     entry_index++ )
+	{
+		entry = &( block_cache->entries[ entry_index ] );
+
+		if( entry->value != NULL )
+		{
+			if( block_cache->free_value(
+			     &( entry->value ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free value: %d.",
+				 function,
+				 entry_index );
+
+				result = -1;
+			}
+			entry->value = NULL;
+		}
+		entry->offset      = 0;
+		entry->access_time = 0;
+	}
+	block_cache->number_of_values = 0;
+	block_cache->access_time      = 0;
+
+	return( result );
+}
+
+/* Retrieves the number of entries
+ * The number of entries is the maximum number of values the cache can contain
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_get_number_of_entries(
+     libqcow_block_cache_t *block_cache,
+     int *number_of_entries,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_get_number_of_entries";
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of entries.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_entries = block_cache->number_of_sets * block_cache->number_of_ways;
+
+	return( 1 );
+}
+
+/* Retrieves the number of values
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_get_number_of_values(
+     libqcow_block_cache_t *block_cache,
+     int *number_of_values,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_get_number_of_values";
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of values.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_values = block_cache->number_of_values;
+
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the block cache and its entries in bytes,
+ * the memory used by the values is not included
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_get_memory_usage(
+     libqcow_block_cache_t *block_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_get_memory_usage";
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_block_cache_t )
+	              + ( sizeof( libqcow_block_cache_entry_t ) * (size_t) block_cache->number_of_sets * (size_t) block_cache->number_of_ways );
+
+	return( 1 );
+}
+
+/* Retrieves the value of a specific offset
+ * A value that is found becomes the most recently used value of its set
+ * and a low priority value that is found becomes a normal priority value
+ * Returns 1 if successful, 0 if no such value or -1 on error
+ */
+int libqcow_block_cache_get_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     intptr_t **value,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry = NULL;
+	static char *function              = "libqcow_block_cache_get_value_by_offset";
+	int set_index                      = 0;
+	int way_index                      = 0;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value.",
+		 function );
+
+		return( -1 );
+	}
+	set_index = libqcow_block_cache_get_set_index(
+	             block_cache,
+	             offset );
+
+	entry = &( block_cache->entries[ set_index * block_cache->number_of_ways ] );
+
+	for( way_index = 0;
+	     way_index < block_cache->number_of_ways;
+	     way_index++ )
+	{
+		if( ( entry->value != NULL )
+		 && ( entry->offset == offset ) )
+		{
+			block_cache->access_time += 1;
+
+			entry->access_time = block_cache->access_time;
+
+			if( entry->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+			{
+				entry->priority = LIBQCOW_CACHE_PRIORITY_NORMAL;
+			}
+			*value = entry->value;
+
+			return( 1 );
+		}
+		entry++;
+	}
+	*value = NULL;
+
+	return( 0 );
+}
+
+/* Determines if the cache contains a value of a specific offset
+ * This function does not change the order of use
+ * Returns 1 if the cache contains the value, 0 if not or -1 on error
+ */
+int libqcow_block_cache_has_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry = NULL;
+	static char *function              = "libqcow_block_cache_has_value_by_offset";
+	int set_index                      = 0;
+	int way_index                      = 0;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	set_index = libqcow_block_cache_get_set_index(
+	             block_cache,
+	             offset );
+
+	entry = &( block_cache->entries[ set_index * block_cache->number_of_ways ] );
+
+	for( way_index = 0;
+	     way_index < block_cache->number_of_ways;
+	     way_index++ )
+	{
+		if( ( entry->value != NULL )
+		 && ( entry->offset == offset ) )
+		{
+			return( 1 );
+		}
+		entry++;
+	}
+	return( 0 );
+}
+
+/* Retrieves a specific value
+ * This function is intended to iterate the values, it does not change the order of use
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_get_value_by_index(
+     libqcow_block_cache_t *block_cache,
+     int entry_index,
+     intptr_t **value,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_block_cache_get_value_by_index";
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( entry_index < 0 )
+	 || ( entry_index >= ( block_cache->number_of_sets * block_cache->number_of_ways ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value.",
+		 function );
+
+		return( -1 );
+	}
+	*value = block_cache->entries[ entry_index ].value;
+
+	return( 1 );
+}
+
+/* Sets the value of a specific offset
+ * The cache takes over management of the value if successful
+ * A value with the same offset is replaced, otherwise the value is stored in
+ * an empty entry of its set or replaces the least recently used value of the set
+ * A low priority value replaces the least recently used low priority value of the set
+ * if the set already contains its share of low priority values, so that a scan
+ * does not replace the other values of the set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_set_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     intptr_t *value,
+     uint8_t priority,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry                     = NULL;
+	libqcow_block_cache_entry_t *least_recent              = NULL;
+	libqcow_block_cache_entry_t *least_recent_low_priority = NULL;
+	libqcow_block_cache_entry_t *set_entries               = NULL;
+	static char *function                                  = "libqcow_block_cache_set_value_by_offset";
+	int maximum_number_of_low_priority_values              = 0;
+	int number_of_low_priority_values                      = 0;
+	int set_index                                          = 0;
+	int way_index                                          = 0;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value.",
+		 function );
+
+		return( -1 );
+	}
+	set_index = libqcow_block_cache_get_set_index(
+	             block_cache,
+	             offset );
+
+	set_entries = &( block_cache->entries[ set_index * block_cache->number_of_ways ] );
+
+	for( way_index = 0;
+	     way_index < block_cache->number_of_ways;
+	     way_index++ )
+	{
+		entry = &( set_entries[ way_index ] );
+
+		if( entry->value == NULL )
+		{
+			if( ( least_recent == NULL )
+			 || ( least_recent->value != NULL ) )
+			{
+				least_recent = entry;
+			}
+		}
+		else if( entry->offset == offset )
+		{
+			least_recent = entry;
+
+			break;
+		}
+		else
+		{
+			if( entry->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+			{
+				if( ( least_recent_low_priority == NULL )
+				 || ( entry->access_time < least_recent_low_priority->access_time ) )
+				{
+					least_recent_low_priority = entry;
+				}
+				number_of_low_priority_values++;
+			}
+			if( ( least_recent == NULL )
+			 || ( ( least_recent->value != NULL )
+			  &&  ( entry->access_time < least_recent->access_time ) ) )
+			{
+				least_recent = entry;
+			}
+		}
+	}
+	if( ( way_index >= block_cache->number_of_ways )
+	 && ( least_recent->value != NULL )
+	 && ( priority == LIBQCOW_CACHE_PRIORITY_LOW ) )
+	{
+		maximum_number_of_low_priority_values = block_cache->number_of_ways / LIBQCOW_CACHE_LOW_PRIORITY_SHARE;
+
+		if( maximum_number_of_low_priority_values < 1 )
+		{
+			maximum_number_of_low_priority_values = 1;
+		}
+		if( number_of_low_priority_values >= maximum_number_of_low_priority_values )
+		{
+			least_recent = least_recent_low_priority;
+		}
+	}
+	if( least_recent->value != NULL )
+	{
+		if( least_recent->value != value )
+		{
+			if( block_cache->free_value(
+			     &( least_recent->value ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free value of set: %d.",
+				 function,
+				 set_index );
+
+				return( -1 );
+			}
+		}
+		block_cache->number_of_values -= 1;
+	}
+	block_cache->access_time += 1;
+
+	least_recent->offset      = offset;
+	least_recent->value       = value;
+	least_recent->access_time = block_cache->access_time;
+	least_recent->priority    = priority;
+
+	block_cache->number_of_values += 1;
+
+	return( 1 );
+}
+
+/* Retrieves the index of the entry with the value that is evicted first
+ * This is the least recently used value of the lowest priority
+ * Returns 1 if successful, 0 if the cache contains no values or -1 on error
+ */
+int libqcow_block_cache_get_eviction_index(
+     libqcow_block_cache_t *block_cache,
+     int *entry_index,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry       = NULL;
+	libqcow_block_cache_entry_t *evict_entry = NULL;
+	static char *function                    = "libqcow_block_cache_get_eviction_index";
+	int evict_entry_index                    = 0;
+	int number_of_entries                    = 0;
+	int safe_entry_index                     = 0;
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid entry index.",
+		 function );
+
+		return( -1 );
+	}
+	if( block_cache->number_of_values == 0 )
+	{
+		return( 0 );
+	}
+	number_of_entries = block_cache->number_of_sets * block_cache->number_of_ways;
+
+	for( safe_entry_index = 0;
+	     safe_entry_index < number_of_entries;
+	     safe_entry_index++ )
+	{
+		entry = &( block_cache->entries[ safe_entry_index ] );
+
+		if( entry->value == NULL )
+		{
+			continue;
+		}
+		if( ( evict_entry == NULL )
+		 || ( entry->priority < evict_entry->priority )
+		 || ( ( entry->priority == evict_entry->priority )
+		  &&  ( entry->access_time < evict_entry->access_time ) ) )
+		{
+			evict_entry       = entry;
+			evict_entry_index = safe_entry_index;
+		}
+	}
+	if( evict_entry == NULL )
+	{
+		return( 0 );
+	}
+	*entry_index = evict_entry_index;
+
+	return( 1 );
+}
+
+/* Removes a specific value
+ * This frees the value
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_block_cache_remove_value_by_index(
+     libqcow_block_cache_t *block_cache,
+     int entry_index,
+     libcerror_error_t **error )
+{
+	libqcow_block_cache_entry_t *entry = NULL;
+	static char *function              = "libqcow_block_cache_remove_value_by_index";
+
+	if( block_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( entry_index < 0 )
+	 || ( entry_index >= ( block_cache->number_of_sets * block_cache->number_of_ways ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	entry = &( block_cache->entries[ entry_index ] );
+
+	if( entry->value == NULL )
+	{
+		return( 1 );
+	}
+	if( block_cache->free_value(
+	     &( entry->value ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free value: %d.",
+		 function,
+		 entry_index );
+
+		return( -1 );
+	}
+	entry->value       = NULL;
+	entry->offset      = 0;
+	entry->access_time = 0;
+
+	block_cache->number_of_values -= 1;
+
+	return( 1 );
+}
+
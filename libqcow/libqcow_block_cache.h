@@ -0,0 +1,156 @@
+/*
+ * Block cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_BLOCK_CACHE_H )
+#define _LIBQCOW_BLOCK_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_block_cache_entry libqcow_block_cache_entry_t;
+
+struct libqcow_block_cache_entry
+{
+	/* The (file) offset that identifies the value
+	 */
+	off64_t offset;
+
+	/* The value
+	 */
+	intptr_t *value;
+
+	/* The last access time, used to determine the least recently used entry of a set
+	 */
+	uint64_t access_time;
+
+	/* The priority
+	 */
+	uint8_t priority;
+};
+
+typedef struct libqcow_block_cache libqcow_block_cache_t;
+
+struct libqcow_block_cache
+{
+	/* The number of sets
+	 */
+	int number_of_sets;
+
+	/* The number of entries (ways) per set
+	 */
+	int number_of_ways;
+
+	/* The entries
+	 */
+	libqcow_block_cache_entry_t *entries;
+
+	/* The number of values
+	 */
+	int number_of_values;
+
+	/* The access time, which is incremented on every access
+	 */
+	uint64_t access_time;
+
+	/* The value free function
+	 */
+	int (*free_value)(
+	       intptr_t **value,
+	       libcerror_error_t **error );
+};
+
+int libqcow_block_cache_initialize(
+     libqcow_block_cache_t **block_cache,
+     int maximum_number_of_values,
+     int (*free_value)(
+            intptr_t **value,
+            libcerror_error_t **error ),
+     libcerror_error_t **error );
+
+int libqcow_block_cache_free(
+     libqcow_block_cache_t **block_cache,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_clear(
+     libqcow_block_cache_t *block_cache,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_number_of_entries(
+     libqcow_block_cache_t *block_cache,
+     int *number_of_entries,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_number_of_values(
+     libqcow_block_cache_t *block_cache,
+     int *number_of_values,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_memory_usage(
+     libqcow_block_cache_t *block_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     intptr_t **value,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_has_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_value_by_index(
+     libqcow_block_cache_t *block_cache,
+     int entry_index,
+     intptr_t **value,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_set_value_by_offset(
+     libqcow_block_cache_t *block_cache,
+     off64_t offset,
+     intptr_t *value,
+     uint8_t priority,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_get_eviction_index(
+     libqcow_block_cache_t *block_cache,
+     int *entry_index,
+     libcerror_error_t **error );
+
+int libqcow_block_cache_remove_value_by_index(
+     libqcow_block_cache_t *block_cache,
+     int entry_index,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_BLOCK_CACHE_H ) */
+
@@ -0,0 +1,363 @@
+/*
+ * Byte swap functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <types.h>
+
+#include "libqcow_byte_swap.h"
+#include "libqcow_libcerror.h"
+
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_X86 )
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <immintrin.h>
+
+#if defined( __GNUC__ ) && !defined( __SSSE3__ )
+#define LIBQCOW_BYTE_SWAP_SSSE3_TARGET		__attribute__((target("ssse3")))
+#else
+#define LIBQCOW_BYTE_SWAP_SSSE3_TARGET
+#endif
+
+#if defined( __GNUC__ ) && !defined( __AVX2__ )
+#define LIBQCOW_BYTE_SWAP_AVX2_TARGET		__attribute__((target("avx2")))
+#else
+#define LIBQCOW_BYTE_SWAP_AVX2_TARGET
+#endif
+
+#endif /* defined( HAVE_LIBQCOW_BYTE_SWAP_X86 ) */
+
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_NEON )
+#include <arm_neon.h>
+#endif
+
+/* The detected backend, -1 if not detected yet
+ */
+static int libqcow_byte_swap_backend = -1;
+
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_X86 )
+
+/* Determines the x86 byte swap backend supported by the CPU
+ * Returns a LIBQCOW_BYTE_SWAP_BACKEND value
+ */
+static int libqcow_byte_swap_x86_get_backend(
+            void )
+{
+	unsigned int extended_features = 0;
+	unsigned int features          = 0;
+	uint64_t extended_state        = 0;
+
+#if defined( _MSC_VER )
+	int cpu_information[ 4 ];
+
+	__cpuid(
+	 cpu_information,
+	 0 );
+
+	if( cpu_information[ 0 ] >= 7 )
+	{
+		__cpuidex(
+		 cpu_information,
+		 7,
+		 0 );
+
+		extended_features = (unsigned int) cpu_information[ 1 ];
+	}
+	__cpuid(
+	 cpu_information,
+	 1 );
+
+	features = (unsigned int) cpu_information[ 2 ];
+
+	/* Bit 27 of ECX indicates the operating system uses XSAVE
+	 */
+	if( ( features & ( 1 << 27 ) ) != 0 )
+	{
+		extended_state = (uint64_t) _xgetbv(
+		                             0 );
+	}
+#else
+	unsigned int eax = 0;
+	unsigned int ebx = 0;
+	unsigned int ecx = 0;
+	unsigned int edx = 0;
+
+	if( __get_cpuid(
+	     1,
+	     &eax,
+	     &ebx,
+	     &ecx,
+	     &edx ) == 0 )
+	{
+		return( LIBQCOW_BYTE_SWAP_BACKEND_NONE );
+	}
+	features = ecx;
+
+	if( __get_cpuid_max(
+	     0,
+	     NULL ) >= 7 )
+	{
+		__cpuid_count(
+		 7,
+		 0,
+		 eax,
+		 ebx,
+		 ecx,
+		 edx );
+
+		extended_features = ebx;
+	}
+	/* Bit 27 of ECX indicates the operating system uses XSAVE
+	 */
+	if( ( features & ( 1 << 27 ) ) != 0 )
+	{
+		__asm__ __volatile__ (
+		 "xgetbv"
+		 : "=a" ( eax ), "=d" ( edx )
+		 : "c" ( 0 ) );
+
+		extended_state = ( (uint64_t) edx << 32 ) | eax;
+	}
+#endif
+	/* Bit 5 of the extended features EBX indicates AVX2, bit 28 of ECX
+	 * indicates AVX and the operating system must save the SSE and AVX state
+	 */
+	if( ( ( extended_features & ( 1 << 5 ) ) != 0 )
+	 && ( ( features & ( 1 << 28 ) ) != 0 )
+	 && ( ( extended_state & 0x06 ) == 0x06 ) )
+	{
+		return( LIBQCOW_BYTE_SWAP_BACKEND_AVX2 );
+	}
+	/* Bit 9 of ECX indicates SSSE3
+	 */
+	if( ( features & ( 1 << 9 ) ) != 0 )
+	{
+		return( LIBQCOW_BYTE_SWAP_BACKEND_SSSE3 );
+	}
+	return( LIBQCOW_BYTE_SWAP_BACKEND_NONE );
+}
+
+/* Converts big-endian 64-bit values to host byte order in place using SSSE3
+ * 2 values are converted at a time
+ * Returns the number of values converted
+ */
+static LIBQCOW_BYTE_SWAP_SSSE3_TARGET size_t libqcow_byte_swap_ssse3_uint64_big_endian(
+                                              uint64_t *values,
+                                              size_t number_of_values )
+{
+	__m128i shuffle_mask = _mm_set_epi8(
+	                        8, 9, 10, 11, 12, 13, 14, 15,
+	                        0, 1, 2, 3, 4, 5, 6, 7 );
+	__m128i block;
+
+	size_t value_index   = 0;
+
+	while( ( value_index + 2 ) <= number_of_values )
+	{
+		block = _mm_loadu_si128(
+		         (__m128i *) &( values[ value_index ] ) );
+
+		block = _mm_shuffle_epi8(
+		         block,
+		         shuffle_mask );
+
+		_mm_storeu_si128(
+		 (__m128i *) &( values[ value_index ] ),
+		 block );
+
+		value_index += 2;
+	}
+	return( value_index );
+}
+
+/* Converts big-endian 64-bit values to host byte order in place using AVX2
+ * 4 values are converted at a time
+ * Returns the number of values converted
+ */
+static LIBQCOW_BYTE_SWAP_AVX2_TARGET size_t libqcow_byte_swap_avx2_uint64_big_endian(
+                                             uint64_t *values,
+                                             size_t number_of_values )
+{
+	__m256i shuffle_mask = _mm256_set_epi8(
+	                        8, 9, 10, 11, 12, 13, 14, 15,
+	                        0, 1, 2, 3, 4, 5, 6, 7,
+	                        8, 9, 10, 11, 12, 13, 14, 15,
+	                        0, 1, 2, 3, 4, 5, 6, 7 );
+	__m256i block;
+
+	size_t value_index   = 0;
+
+	while( ( value_index + 4 ) <= number_of_values )
+	{
+		block = _mm256_loadu_si256(
+		         (__m256i *) &( values[ value_index ] ) );
+
+		block = _mm256_shuffle_epi8(
+		         block,
+		         shuffle_mask );
+
+		_mm256_storeu_si256(
+		 (__m256i *) &( values[ value_index ] ),
+		 block );
+
+		value_index += 4;
+	}
+	return( value_index );
+}
+
+#endif /* defined( HAVE_LIBQCOW_BYTE_SWAP_X86 ) */
+
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_NEON )
+
+/* Converts big-endian 64-bit values to host byte order in place using NEON
+ * 2 values are converted at a time
+ * Returns the number of values converted
+ */
+static size_t libqcow_byte_swap_neon_uint64_big_endian(
+               uint64_t *values,
+               size_t number_of_values )
+{
+	uint8x16_t block;
+
+	size_t value_index = 0;
+
+	while( ( value_index + 2 ) <= number_of_values )
+	{
+		block = vld1q_u8(
+		         (uint8_t *) &( values[ value_index ] ) );
+
+		block = vrev64q_u8(
+		         block );
+
+		vst1q_u8(
+		 (uint8_t *) &( values[ value_index ] ),
+		 block );
+
+		value_index += 2;
+	}
+	return( value_index );
+}
+
+#endif /* defined( HAVE_LIBQCOW_BYTE_SWAP_NEON ) */
+
+/* Retrieves the byte swap backend supported by the CPU
+ * Returns a LIBQCOW_BYTE_SWAP_BACKEND value
+ */
+int libqcow_byte_swap_get_backend(
+     void )
+{
+	int backend = libqcow_byte_swap_backend;
+
+	/* Detecting the backend more than once yields the same result
+	 * hence it does not need to be protected against concurrent access
+	 */
+	if( backend == -1 )
+	{
+		backend = LIBQCOW_BYTE_SWAP_BACKEND_NONE;
+
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_X86 )
+		backend = libqcow_byte_swap_x86_get_backend();
+#endif
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_NEON )
+		backend = LIBQCOW_BYTE_SWAP_BACKEND_NEON;
+#endif
+		libqcow_byte_swap_backend = backend;
+	}
+	return( backend );
+}
+
+/* Converts big-endian 64-bit values to host byte order in place
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_byte_swap_uint64_big_endian(
+     uint64_t *values,
+     size_t number_of_values,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_byte_swap_uint64_big_endian";
+	size_t value_index    = 0;
+	uint64_t value_64bit  = 0;
+
+	if( values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid values.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_values > (size_t) ( SSIZE_MAX / 8 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid number of values value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	switch( libqcow_byte_swap_get_backend() )
+	{
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_X86 )
+		case LIBQCOW_BYTE_SWAP_BACKEND_AVX2:
+			value_index = libqcow_byte_swap_avx2_uint64_big_endian(
+			               values,
+			               number_of_values );
+			break;
+
+		case LIBQCOW_BYTE_SWAP_BACKEND_SSSE3:
+			value_index = libqcow_byte_swap_ssse3_uint64_big_endian(
+			               values,
+			               number_of_values );
+			break;
+#endif
+#if defined( HAVE_LIBQCOW_BYTE_SWAP_NEON )
+		case LIBQCOW_BYTE_SWAP_BACKEND_NEON:
+			value_index = libqcow_byte_swap_neon_uint64_big_endian(
+			               values,
+			               number_of_values );
+			break;
+#endif
+		default:
+			break;
+	}
+	/* The remaining values are converted byte by byte, which is correct
+	 * regardless of the host byte order
+	 */
+	while( value_index < number_of_values )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 (uint8_t *) &( values[ value_index ] ),
+		 value_64bit );
+
+		values[ value_index++ ] = value_64bit;
+	}
+	return( 1 );
+}
+
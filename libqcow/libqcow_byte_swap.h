@@ -0,0 +1,67 @@
+/*
+ * Byte swap functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_BYTE_SWAP_H )
+#define _LIBQCOW_BYTE_SWAP_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_CPUID_H ) && defined( HAVE_IMMINTRIN_H ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_LIBQCOW_BYTE_SWAP_X86		1
+
+#elif defined( _MSC_VER ) && ( _MSC_VER >= 1700 ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#define HAVE_LIBQCOW_BYTE_SWAP_X86		1
+
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_ARM_NEON_H ) && defined( __aarch64__ ) && !defined( __AARCH64EB__ )
+#define HAVE_LIBQCOW_BYTE_SWAP_NEON		1
+#endif
+
+enum LIBQCOW_BYTE_SWAP_BACKENDS
+{
+	LIBQCOW_BYTE_SWAP_BACKEND_NONE		= 0,
+	LIBQCOW_BYTE_SWAP_BACKEND_SSSE3		= 1,
+	LIBQCOW_BYTE_SWAP_BACKEND_AVX2		= 2,
+	LIBQCOW_BYTE_SWAP_BACKEND_NEON		= 3
+};
+
+int libqcow_byte_swap_get_backend(
+     void );
+
+int libqcow_byte_swap_uint64_big_endian(
+     uint64_t *values,
+     size_t number_of_values,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_BYTE_SWAP_H ) */
+
@@ -0,0 +1,2343 @@
+/*
+ * Shared cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cache.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_trace.h"
+#include "libqcow_types.h"
+
+/* Determines the hash of a value
+ * Returns the hash
+ */
+static uint64_t libqcow_cache_get_hash(
+                 intptr_t *owner,
+                 uint8_t value_type,
+                 off64_t offset )
+{
+	uint64_t hash = 0;
+
+	hash  = ( (uint64_t) offset + value_type ) * LIBQCOW_BLOCK_CACHE_HASH_MULTIPLIER;
+	hash ^= (uint64_t) (uintptr_t) owner;
+	hash *= LIBQCOW_BLOCK_CACHE_HASH_MULTIPLIER;
+
+	return( hash >> 32 );
+}
+
+/* Determines the shard of a value
+ * Returns the shard
+ */
+static libqcow_cache_shard_t *libqcow_cache_get_shard(
+                               libqcow_internal_cache_t *internal_cache,
+                               uint64_t hash )
+{
+	return( &( internal_cache->shards[ hash & (uint64_t) ( internal_cache->number_of_shards - 1 ) ] ) );
+}
+
+/* Determines the hash bucket of a value within its shard
+ * The bits of the hash that determine the shard are not used to determine the bucket
+ * Returns the bucket index
+ */
+static int libqcow_cache_get_bucket_index(
+            libqcow_internal_cache_t *internal_cache,
+            libqcow_cache_shard_t *shard,
+            uint64_t hash )
+{
+	return( (int) ( ( hash / (uint64_t) internal_cache->number_of_shards ) % (uint64_t) shard->number_of_buckets ) );
+}
+
+/* Removes a value from the hash bucket and the list of values of its shard
+ * This function does not free the value
+ */
+static void libqcow_cache_unlink_value(
+             libqcow_internal_cache_t *internal_cache,
+             libqcow_cache_shard_t *shard,
+             libqcow_cache_value_t *cache_value )
+{
+	libqcow_cache_value_t **bucket_value = NULL;
+	int bucket_index                     = 0;
+
+	bucket_index = libqcow_cache_get_bucket_index(
+	                internal_cache,
+	                shard,
+	                libqcow_cache_get_hash(
+	                 cache_value->owner,
+	                 cache_value->value_type,
+	                 cache_value->offset ) );
+
+	bucket_value = &( shard->buckets[ bucket_index ] );
+
+	while( *bucket_value != NULL )
+	{
+		if( *bucket_value == cache_value )
+		{
+			*bucket_value = cache_value->next_bucket_value;
+
+			break;
+		}
+		bucket_value = &( ( *bucket_value )->next_bucket_value );
+	}
+	if( cache_value->previous_value != NULL )
+	{
+		cache_value->previous_value->next_value = cache_value->next_value;
+	}
+	else
+	{
+		shard->first_value = cache_value->next_value;
+	}
+	if( cache_value->next_value != NULL )
+	{
+		cache_value->next_value->previous_value = cache_value->previous_value;
+	}
+	else
+	{
+		shard->last_value = cache_value->previous_value;
+	}
+	cache_value->previous_value    = NULL;
+	cache_value->next_value        = NULL;
+	cache_value->next_bucket_value = NULL;
+
+	shard->memory_size      -= cache_value->value_size;
+	shard->number_of_values -= 1;
+
+	if( cache_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+	{
+		shard->low_priority_memory_size -= cache_value->value_size;
+	}
+}
+
+/* Marks a value as the most recently used value of its shard
+ */
+static void libqcow_cache_use_value(
+             libqcow_cache_shard_t *shard,
+             libqcow_cache_value_t *cache_value )
+{
+	if( shard->first_value == cache_value )
+	{
+		return;
+	}
+	/* A value that is not the first value is only part of the list
+	 * if it has a previous value, otherwise it is a new value
+	 */
+	if( cache_value->previous_value != NULL )
+	{
+		cache_value->previous_value->next_value = cache_value->next_value;
+
+		if( cache_value->next_value != NULL )
+		{
+			cache_value->next_value->previous_value = cache_value->previous_value;
+		}
+		else
+		{
+			shard->last_value = cache_value->previous_value;
+		}
+	}
+	cache_value->previous_value = NULL;
+	cache_value->next_value     = shard->first_value;
+
+	if( shard->first_value != NULL )
+	{
+		shard->first_value->previous_value = cache_value;
+	}
+	shard->first_value = cache_value;
+
+	if( shard->last_value == NULL )
+	{
+		shard->last_value = cache_value;
+	}
+}
+
+/* Frees a value that is no longer part of the cache
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_cache_free_value(
+            libqcow_cache_value_t **cache_value,
+            libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_free_value";
+	int result            = 1;
+
+	if( ( *cache_value )->value != NULL )
+	{
+		if( ( *cache_value )->free_value(
+		     &( ( *cache_value )->value ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free value: 0x%08" PRIx64 ".",
+			 function,
+			 ( *cache_value )->offset );
+
+			result = -1;
+		}
+	}
+	memory_free(
+	 *cache_value );
+
+	*cache_value = NULL;
+
+	return( result );
+}
+
+/* Evicts the least recently used values of a shard that are not referenced
+ * until the memory size plus the additional size fits the maximum memory size
+ * Low priority values are evicted first while they use more than their share
+ * of the maximum memory size, so that a scan does not evict the values that are used again
+ * A value with eviction credits spends a credit and becomes the most recently used value
+ * instead of being evicted
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_cache_evict_values(
+            libqcow_internal_cache_t *internal_cache,
+            libqcow_cache_shard_t *shard,
+            size64_t maximum_memory_size,
+            size_t additional_size,
+            uint8_t additional_priority,
+            libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value        = NULL;
+	libqcow_cache_value_t *previous_value     = NULL;
+	static char *function                     = "libqcow_cache_evict_values";
+	size64_t maximum_low_priority_memory_size = 0;
+	size_t additional_low_priority_size       = 0;
+	int result                                = 1;
+	int spent_eviction_credits                = 0;
+
+	maximum_low_priority_memory_size = maximum_memory_size / LIBQCOW_CACHE_LOW_PRIORITY_SHARE;
+
+	if( additional_priority == LIBQCOW_CACHE_PRIORITY_LOW )
+	{
+		additional_low_priority_size = additional_size;
+	}
+	cache_value = shard->last_value;
+
+	while( ( cache_value != NULL )
+	    && ( ( shard->memory_size + additional_size ) > maximum_memory_size )
+	    && ( ( shard->low_priority_memory_size + additional_low_priority_size ) > maximum_low_priority_memory_size ) )
+	{
+		previous_value = cache_value->previous_value;
+
+		if( ( cache_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+		 && ( cache_value->number_of_references == 0 ) )
+		{
+			libqcow_cache_unlink_value(
+			 internal_cache,
+			 shard,
+			 cache_value );
+
+			if( libqcow_cache_free_value(
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free evicted value.",
+				 function );
+
+				result = -1;
+			}
+		}
+		cache_value = previous_value;
+	}
+	cache_value = shard->last_value;
+
+	while( ( cache_value != NULL )
+	    && ( ( shard->memory_size + additional_size ) > maximum_memory_size ) )
+	{
+		previous_value = cache_value->previous_value;
+
+		if( cache_value->number_of_references == 0 )
+		{
+			if( cache_value->eviction_credits > 0 )
+			{
+				cache_value->eviction_credits -= 1;
+
+				libqcow_cache_use_value(
+				 shard,
+				 cache_value );
+
+				spent_eviction_credits = 1;
+			}
+			else
+			{
+				libqcow_cache_unlink_value(
+				 internal_cache,
+				 shard,
+				 cache_value );
+
+				if( libqcow_cache_free_value(
+				     &cache_value,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free evicted value.",
+					 function );
+
+					result = -1;
+				}
+			}
+		}
+		cache_value = previous_value;
+
+		/* Every pass that spends eviction credits reduces the remaining credits
+		 * hence the values that have spent their credits are evicted by another pass
+		 */
+		if( ( cache_value == NULL )
+		 && ( spent_eviction_credits != 0 ) )
+		{
+			cache_value            = shard->last_value;
+			spent_eviction_credits = 0;
+		}
+	}
+	return( result );
+}
+
+/* Creates a cache
+ * The cache can be shared by multiple files, the level 2 tables and cluster blocks
+ * of these files are evicted in least recently used order when the memory size
+ * of the cached values exceeds the maximum memory size, where cluster blocks read
+ * by a scan are evicted first and level 2 tables are evicted last
+ * A cache of at least twice LIBQCOW_CACHE_MINIMUM_SHARD_MEMORY_SIZE is split in shards
+ * that each use an equal part of the maximum memory size, the order of eviction
+ * applies per shard
+ * Make sure the value cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_initialize(
+     libqcow_cache_t **cache,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard             = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	static char *function                    = "libqcow_cache_initialize";
+	size64_t number_of_buckets               = 0;
+	size_t buckets_size                      = 0;
+	int number_of_shards                     = 1;
+	int shard_index                          = 0;
+
+	if( cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_memory_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid maximum memory size value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	/* The number of shards is a power of 2
+	 */
+	while( ( number_of_shards < LIBQCOW_CACHE_MAXIMUM_NUMBER_OF_SHARDS )
+	    && ( ( maximum_memory_size / (size64_t) ( number_of_shards * 2 ) ) >= LIBQCOW_CACHE_MINIMUM_SHARD_MEMORY_SIZE ) )
+	{
+		number_of_shards *= 2;
+	}
+	number_of_buckets = ( maximum_memory_size / (size64_t) number_of_shards ) / LIBQCOW_CACHE_BUCKET_MEMORY_SIZE;
+
+	if( number_of_buckets < LIBQCOW_CACHE_MINIMUM_NUMBER_OF_BUCKETS )
+	{
+		number_of_buckets = LIBQCOW_CACHE_MINIMUM_NUMBER_OF_BUCKETS;
+	}
+	else if( number_of_buckets > LIBQCOW_CACHE_MAXIMUM_NUMBER_OF_BUCKETS )
+	{
+		number_of_buckets = LIBQCOW_CACHE_MAXIMUM_NUMBER_OF_BUCKETS;
+	}
+	buckets_size = sizeof( libqcow_cache_value_t * ) * (size_t) number_of_buckets;
+
+	internal_cache = memory_allocate_structure(
+	                  libqcow_internal_cache_t );
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_cache,
+	     0,
+	     sizeof( libqcow_internal_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cache.",
+		 function );
+
+		memory_free(
+		 internal_cache );
+
+		return( -1 );
+	}
+	internal_cache->shards = (libqcow_cache_shard_t *) memory_allocate(
+	                                                    sizeof( libqcow_cache_shard_t ) * (size_t) number_of_shards );
+
+	if( internal_cache->shards == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create shards.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_cache->shards,
+	     0,
+	     sizeof( libqcow_cache_shard_t ) * (size_t) number_of_shards ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear shards.",
+		 function );
+
+		memory_free(
+		 internal_cache->shards );
+
+		internal_cache->shards = NULL;
+
+		goto on_error;
+	}
+	internal_cache->number_of_shards = number_of_shards;
+
+	for( shard_index = 0;
+	     shard_index < number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+		shard->buckets = (libqcow_cache_value_t **) memory_allocate(
+		                                             buckets_size );
+
+		if( shard->buckets == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create buckets of shard: %d.",
+			 function,
+			 shard_index );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     shard->buckets,
+		     0,
+		     buckets_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear buckets of shard: %d.",
+			 function,
+			 shard_index );
+
+			goto on_error;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_initialize(
+		     &( shard->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			goto on_error;
+		}
+#endif
+		shard->maximum_memory_size = maximum_memory_size / (size64_t) number_of_shards;
+		shard->number_of_buckets   = (int) number_of_buckets;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( internal_cache->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	internal_cache->maximum_memory_size = maximum_memory_size;
+
+	*cache = (libqcow_cache_t *) internal_cache;
+
+	return( 1 );
+
+on_error:
+	if( internal_cache != NULL )
+	{
+		if( internal_cache->shards != NULL )
+		{
+			for( shard_index = 0;
+			     shard_index < number_of_shards;
+			     shard_index++ )
+			{
+				shard = &( internal_cache->shards[ shard_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+				if( shard->mutex != NULL )
+				{
+					libcthreads_mutex_free(
+					 &( shard->mutex ),
+					 NULL );
+				}
+#endif
+				if( shard->buckets != NULL )
+				{
+					memory_free(
+					 shard->buckets );
+				}
+			}
+			memory_free(
+			 internal_cache->shards );
+		}
+		memory_free(
+		 internal_cache );
+	}
+	return( -1 );
+}
+
+/* Frees a cache
+ * The cache cannot be freed while it is set on a file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_free(
+     libqcow_cache_t **cache,
+     libcerror_error_t **error )
+{
+	libqcow_cache_image_t *cache_image       = NULL;
+	libqcow_cache_image_t *next_image        = NULL;
+	libqcow_cache_shard_t *shard             = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_cache_value_t *next_value        = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	static char *function                    = "libqcow_cache_free";
+	int result                               = 1;
+	int shard_index                          = 0;
+
+	if( cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache == NULL )
+	{
+		return( 1 );
+	}
+	internal_cache = (libqcow_internal_cache_t *) *cache;
+
+	if( internal_cache->number_of_files != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cache - still set on: %d files.",
+		 function,
+		 internal_cache->number_of_files );
+
+		return( -1 );
+	}
+	*cache = NULL;
+
+	for( shard_index = 0;
+	     shard_index < internal_cache->number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+		cache_value = shard->first_value;
+
+		while( cache_value != NULL )
+		{
+			next_value = cache_value->next_value;
+
+			if( libqcow_cache_free_value(
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free value.",
+				 function );
+
+				result = -1;
+			}
+			cache_value = next_value;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( shard->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 shard->buckets );
+	}
+	cache_image = internal_cache->first_image;
+
+	while( cache_image != NULL )
+	{
+		next_image = cache_image->next_image;
+
+		memory_free(
+		 cache_image->identifier );
+		memory_free(
+		 cache_image );
+
+		cache_image = next_image;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_free(
+	     &( internal_cache->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free mutex.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	memory_free(
+	 internal_cache->shards );
+
+	memory_free(
+	 internal_cache );
+
+	return( result );
+}
+
+/* Retrieves the maximum memory size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_get_maximum_memory_size(
+     libqcow_cache_t *cache,
+     size64_t *maximum_memory_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_cache_t *internal_cache = NULL;
+	static char *function                    = "libqcow_cache_get_maximum_memory_size";
+
+	if( cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	if( maximum_memory_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum memory size.",
+		 function );
+
+		return( -1 );
+	}
+	*maximum_memory_size = internal_cache->maximum_memory_size;
+
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the number of bytes used by the cached values of all the files
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_get_memory_usage(
+     libqcow_cache_t *cache,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard             = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	static char *function                    = "libqcow_cache_get_memory_usage";
+	size64_t safe_memory_usage               = 0;
+	int shard_index                          = 0;
+
+	if( cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	for( shard_index = 0;
+	     shard_index < internal_cache->number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+		safe_memory_usage += shard->memory_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+	}
+	*memory_usage = safe_memory_usage;
+
+	return( 1 );
+}
+
+/* Trims the cache
+ * Evicts the least recently used values of all the files until the memory usage
+ * is at most the maximum memory size, values that are in use are not evicted
+ * The maximum memory size is divided equally over the shards
+ * This can be used to release memory when the system is under memory pressure,
+ * the maximum memory size of the cache itself does not change
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_trim(
+     libqcow_cache_t *cache,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard             = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	static char *function                    = "libqcow_cache_trim";
+	int result                               = 1;
+	int shard_index                          = 0;
+
+	if( cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	for( shard_index = 0;
+	     shard_index < internal_cache->number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+		if( libqcow_cache_evict_values(
+		     internal_cache,
+		     shard,
+		     maximum_memory_size / (size64_t) internal_cache->number_of_shards,
+		     0,
+		     LIBQCOW_CACHE_PRIORITY_NORMAL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to evict values of shard: %d.",
+			 function,
+			 shard_index );
+
+			result = -1;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+	}
+	return( result );
+}
+
+/* Attaches a file to the cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_attach_file(
+     libqcow_internal_cache_t *internal_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_cache_attach_file";
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_cache->number_of_files += 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Detaches a file from the cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_detach_file(
+     libqcow_internal_cache_t *internal_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_cache_detach_file";
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( internal_cache->number_of_files > 0 )
+	{
+		internal_cache->number_of_files -= 1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves a value
+ * The value is referenced and is not evicted until it is released
+ * using libqcow_internal_cache_release_value
+ * A low priority value that is retrieved becomes a normal priority value
+ * and a high priority value that is retrieved regains its eviction credits
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_cache_get_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard        = NULL;
+	libqcow_cache_value_t *bucket_value = NULL;
+	static char *function               = "libqcow_internal_cache_get_value";
+	uint64_t hash                       = 0;
+	int bucket_index                    = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	hash = libqcow_cache_get_hash(
+	        owner,
+	        value_type,
+	        offset );
+
+	shard = libqcow_cache_get_shard(
+	         internal_cache,
+	         hash );
+
+	bucket_index = libqcow_cache_get_bucket_index(
+	                internal_cache,
+	                shard,
+	                hash );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_mutex_grab(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	bucket_value = shard->buckets[ bucket_index ];
+
+	while( bucket_value != NULL )
+	{
+		if( ( bucket_value->owner == owner )
+		 && ( bucket_value->value_type == value_type )
+		 && ( bucket_value->offset == offset ) )
+		{
+			break;
+		}
+		bucket_value = bucket_value->next_bucket_value;
+	}
+	if( bucket_value != NULL )
+	{
+		bucket_value->number_of_references += 1;
+
+		if( bucket_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+		{
+			shard->low_priority_memory_size -= bucket_value->value_size;
+
+			bucket_value->priority = LIBQCOW_CACHE_PRIORITY_NORMAL;
+		}
+		else if( bucket_value->priority == LIBQCOW_CACHE_PRIORITY_HIGH )
+		{
+			bucket_value->eviction_credits = LIBQCOW_CACHE_HIGH_PRIORITY_EVICTION_CREDITS;
+		}
+		libqcow_cache_use_value(
+		 shard,
+		 bucket_value );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*cache_value = bucket_value;
+
+	if( bucket_value == NULL )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Determines if the cache contains a value
+ * The value is not referenced and its order of use and priority do not change
+ * Returns 1 if the cache contains the value, 0 if not or -1 on error
+ */
+int libqcow_internal_cache_has_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard        = NULL;
+	libqcow_cache_value_t *bucket_value = NULL;
+	static char *function               = "libqcow_internal_cache_has_value";
+	uint64_t hash                       = 0;
+	int bucket_index                    = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	hash = libqcow_cache_get_hash(
+	        owner,
+	        value_type,
+	        offset );
+
+	shard = libqcow_cache_get_shard(
+	         internal_cache,
+	         hash );
+
+	bucket_index = libqcow_cache_get_bucket_index(
+	                internal_cache,
+	                shard,
+	                hash );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	bucket_value = shard->buckets[ bucket_index ];
+
+	while( bucket_value != NULL )
+	{
+		if( ( bucket_value->owner == owner )
+		 && ( bucket_value->value_type == value_type )
+		 && ( bucket_value->offset == offset ) )
+		{
+			break;
+		}
+		bucket_value = bucket_value->next_bucket_value;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( bucket_value == NULL )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Sets a value
+ * The cache takes over management of the value if successful, the value
+ * is referenced and must be released using libqcow_internal_cache_release_value
+ * A value of the same owner, type and offset is replaced
+ * The priority determines how the value is evicted, refer to libqcow_cache_evict_values
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_set_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t *value,
+     uint8_t priority,
+     int (*free_value)(
+            intptr_t **value,
+            libcerror_error_t **error ),
+     int (*get_value_size)(
+            intptr_t *value,
+            size_t *value_size,
+            libcerror_error_t **error ),
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard        = NULL;
+	libqcow_cache_value_t *bucket_value = NULL;
+	libqcow_cache_value_t *new_value    = NULL;
+	static char *function               = "libqcow_internal_cache_set_value";
+	size_t value_size                   = 0;
+	uint64_t hash                       = 0;
+	int bucket_index                    = 0;
+	int result                          = 1;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value.",
+		 function );
+
+		return( -1 );
+	}
+	if( priority > LIBQCOW_CACHE_PRIORITY_HIGH )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported priority.",
+		 function );
+
+		return( -1 );
+	}
+	if( free_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid free value function.",
+		 function );
+
+		return( -1 );
+	}
+	if( get_value_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid get value size function.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	if( get_value_size(
+	     value,
+	     &value_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve value size.",
+		 function );
+
+		return( -1 );
+	}
+	new_value = memory_allocate_structure(
+	             libqcow_cache_value_t );
+
+	if( new_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cache value.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     new_value,
+	     0,
+	     sizeof( libqcow_cache_value_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cache value.",
+		 function );
+
+		memory_free(
+		 new_value );
+
+		return( -1 );
+	}
+	new_value->owner                = owner;
+	new_value->value_type           = value_type;
+	new_value->offset               = offset;
+	new_value->value                = value;
+	new_value->free_value           = free_value;
+	new_value->get_value_size       = get_value_size;
+	new_value->value_size           = sizeof( libqcow_cache_value_t ) + value_size;
+	new_value->number_of_references = 1;
+	new_value->priority             = priority;
+
+	if( priority == LIBQCOW_CACHE_PRIORITY_HIGH )
+	{
+		new_value->eviction_credits = LIBQCOW_CACHE_HIGH_PRIORITY_EVICTION_CREDITS;
+	}
+
+	hash = libqcow_cache_get_hash(
+	        owner,
+	        value_type,
+	        offset );
+
+	shard = libqcow_cache_get_shard(
+	         internal_cache,
+	         hash );
+
+	bucket_index = libqcow_cache_get_bucket_index(
+	                internal_cache,
+	                shard,
+	                hash );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_mutex_grab(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		memory_free(
+		 new_value );
+
+		return( -1 );
+	}
+#endif
+	bucket_value = shard->buckets[ bucket_index ];
+
+	while( bucket_value != NULL )
+	{
+		if( ( bucket_value->owner == owner )
+		 && ( bucket_value->value_type == value_type )
+		 && ( bucket_value->offset == offset ) )
+		{
+			break;
+		}
+		bucket_value = bucket_value->next_bucket_value;
+	}
+	if( bucket_value != NULL )
+	{
+		libqcow_cache_unlink_value(
+		 internal_cache,
+		 shard,
+		 bucket_value );
+
+		/* A value that is still referenced is freed when it is released
+		 */
+		if( bucket_value->number_of_references > 0 )
+		{
+			bucket_value->is_removed = 1;
+		}
+		else if( libqcow_cache_free_value(
+		          &bucket_value,
+		          error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free replaced value.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( result == 1 )
+	{
+		result = libqcow_cache_evict_values(
+		          internal_cache,
+		          shard,
+		          shard->maximum_memory_size,
+		          new_value->value_size,
+		          new_value->priority,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to evict values.",
+			 function );
+		}
+	}
+	if( result == 1 )
+	{
+		new_value->next_bucket_value   = shard->buckets[ bucket_index ];
+		shard->buckets[ bucket_index ] = new_value;
+
+		libqcow_cache_use_value(
+		 shard,
+		 new_value );
+
+		shard->memory_size      += new_value->value_size;
+		shard->number_of_values += 1;
+
+		if( new_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+		{
+			shard->low_priority_memory_size += new_value->value_size;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		if( result == 1 )
+		{
+			*cache_value = new_value;
+		}
+		return( -1 );
+	}
+#endif
+	if( result != 1 )
+	{
+		memory_free(
+		 new_value );
+
+		return( -1 );
+	}
+	*cache_value = new_value;
+
+	return( 1 );
+}
+
+/* Releases a value
+ * The size of the value is determined again since it can have changed while
+ * it was referenced, e.g. when it was decrypted
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_release_value(
+     libqcow_internal_cache_t *internal_cache,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard            = NULL;
+	libqcow_cache_value_t *safe_cache_value = NULL;
+	static char *function                   = "libqcow_internal_cache_release_value";
+	size_t value_size                       = 0;
+	int result                              = 1;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache_value == NULL )
+	{
+		return( 1 );
+	}
+	safe_cache_value = *cache_value;
+	*cache_value     = NULL;
+
+	shard = libqcow_cache_get_shard(
+	         internal_cache,
+	         libqcow_cache_get_hash(
+	          safe_cache_value->owner,
+	          safe_cache_value->value_type,
+	          safe_cache_value->offset ) );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_mutex_grab(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( safe_cache_value->number_of_references > 0 )
+	{
+		safe_cache_value->number_of_references -= 1;
+	}
+	if( safe_cache_value->number_of_references == 0 )
+	{
+		if( safe_cache_value->is_removed != 0 )
+		{
+			if( libqcow_cache_free_value(
+			     &safe_cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free removed value.",
+				 function );
+
+				result = -1;
+			}
+		}
+		else
+		{
+			if( safe_cache_value->get_value_size(
+			     safe_cache_value->value,
+			     &value_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve value size.",
+				 function );
+
+				result = -1;
+			}
+			else
+			{
+				shard->memory_size -= safe_cache_value->value_size;
+
+				if( safe_cache_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+				{
+					shard->low_priority_memory_size -= safe_cache_value->value_size;
+				}
+				safe_cache_value->value_size = sizeof( libqcow_cache_value_t ) + value_size;
+
+				shard->memory_size += safe_cache_value->value_size;
+
+				if( safe_cache_value->priority == LIBQCOW_CACHE_PRIORITY_LOW )
+				{
+					shard->low_priority_memory_size += safe_cache_value->value_size;
+				}
+			}
+			if( libqcow_cache_evict_values(
+			     internal_cache,
+			     shard,
+			     shard->maximum_memory_size,
+			     0,
+			     LIBQCOW_CACHE_PRIORITY_NORMAL,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to evict values.",
+				 function );
+
+				result = -1;
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     shard->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Removes the values of a specific owner
+ * This function is used when a file is closed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_remove_values(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_cache_remove_values";
+
+	if( libqcow_internal_cache_remove_values_by_type(
+	     internal_cache,
+	     owner,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+		 "%s: unable to remove values.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Removes the values of a specific owner and value type
+ * A value type of 0 removes the values of all types
+ * Values that are in use are freed when they are released
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_remove_values_by_type(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard       = NULL;
+	libqcow_cache_value_t *cache_value = NULL;
+	libqcow_cache_value_t *next_value  = NULL;
+	static char *function              = "libqcow_internal_cache_remove_values_by_type";
+	int result                         = 1;
+	int shard_index                    = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	for( shard_index = 0;
+	     shard_index < internal_cache->number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+		cache_value = shard->first_value;
+
+		while( cache_value != NULL )
+		{
+			next_value = cache_value->next_value;
+
+			if( ( cache_value->owner == owner )
+			 && ( ( value_type == 0 )
+			  ||  ( cache_value->value_type == value_type ) ) )
+			{
+				libqcow_cache_unlink_value(
+				 internal_cache,
+				 shard,
+				 cache_value );
+
+				if( cache_value->number_of_references > 0 )
+				{
+					cache_value->is_removed = 1;
+				}
+				else if( libqcow_cache_free_value(
+				          &cache_value,
+				          error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free value.",
+					 function );
+
+					result = -1;
+				}
+			}
+			cache_value = next_value;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+	}
+	return( result );
+}
+
+/* Retrieves the memory usage of the values of a specific owner
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_cache_get_memory_usage_by_owner(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	libqcow_cache_shard_t *shard       = NULL;
+	libqcow_cache_value_t *cache_value = NULL;
+	static char *function              = "libqcow_internal_cache_get_memory_usage_by_owner";
+	size64_t safe_memory_usage         = 0;
+	int shard_index                    = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	for( shard_index = 0;
+	     shard_index < internal_cache->number_of_shards;
+	     shard_index++ )
+	{
+		shard = &( internal_cache->shards[ shard_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+		cache_value = shard->first_value;
+
+		while( cache_value != NULL )
+		{
+			if( cache_value->owner == owner )
+			{
+				safe_memory_usage += cache_value->value_size;
+			}
+			cache_value = cache_value->next_value;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     shard->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex of shard: %d.",
+			 function,
+			 shard_index );
+
+			return( -1 );
+		}
+#endif
+	}
+	*memory_usage = safe_memory_usage;
+
+	return( 1 );
+}
+
+
+/* Retrieves an image by its identifier
+ * The image is referenced and must be released using libqcow_internal_cache_release_image
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_cache_get_image(
+     libqcow_internal_cache_t *internal_cache,
+     const uint8_t *identifier,
+     size_t identifier_size,
+     intptr_t **image,
+     libcerror_error_t **error )
+{
+	libqcow_cache_image_t *cache_image = NULL;
+	static char *function              = "libqcow_internal_cache_get_image";
+	int result                         = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( identifier == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid identifier.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( identifier_size == 0 )
+	 || ( identifier_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid identifier size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( image == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid image.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	cache_image = internal_cache->first_image;
+
+	while( cache_image != NULL )
+	{
+		if( ( cache_image->identifier_size == identifier_size )
+		 && ( memory_compare(
+		       cache_image->identifier,
+		       identifier,
+		       identifier_size ) == 0 ) )
+		{
+			cache_image->number_of_references += 1;
+
+			*image = cache_image->image;
+
+			result = 1;
+
+			break;
+		}
+		cache_image = cache_image->next_image;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Sets an image by its identifier
+ * The image is referenced once and must be released using libqcow_internal_cache_release_image
+ * Returns 1 if successful, 0 if an image with the same identifier is already set or -1 on error
+ */
+int libqcow_internal_cache_set_image(
+     libqcow_internal_cache_t *internal_cache,
+     const uint8_t *identifier,
+     size_t identifier_size,
+     intptr_t *image,
+     libcerror_error_t **error )
+{
+	libqcow_cache_image_t *cache_image = NULL;
+	libqcow_cache_image_t *new_image   = NULL;
+	static char *function              = "libqcow_internal_cache_set_image";
+	int result                         = 1;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( identifier == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid identifier.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( identifier_size == 0 )
+	 || ( identifier_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid identifier size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( image == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid image.",
+		 function );
+
+		return( -1 );
+	}
+	new_image = memory_allocate_structure(
+	             libqcow_cache_image_t );
+
+	if( new_image == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create image.",
+		 function );
+
+		return( -1 );
+	}
+	new_image->identifier = (uint8_t *) memory_allocate(
+	                                     sizeof( uint8_t ) * identifier_size );
+
+	if( new_image->identifier == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create identifier.",
+		 function );
+
+		memory_free(
+		 new_image );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     new_image->identifier,
+	     identifier,
+	     identifier_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy identifier.",
+		 function );
+
+		memory_free(
+		 new_image->identifier );
+		memory_free(
+		 new_image );
+
+		return( -1 );
+	}
+	new_image->identifier_size      = identifier_size;
+	new_image->image                = image;
+	new_image->number_of_references = 1;
+	new_image->next_image           = NULL;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		memory_free(
+		 new_image->identifier );
+		memory_free(
+		 new_image );
+
+		return( -1 );
+	}
+#endif
+	/* Another file could have set the same image after it was looked up
+	 */
+	cache_image = internal_cache->first_image;
+
+	while( cache_image != NULL )
+	{
+		if( ( cache_image->identifier_size == identifier_size )
+		 && ( memory_compare(
+		       cache_image->identifier,
+		       identifier,
+		       identifier_size ) == 0 ) )
+		{
+			result = 0;
+
+			break;
+		}
+		cache_image = cache_image->next_image;
+	}
+	if( result == 1 )
+	{
+		new_image->next_image       = internal_cache->first_image;
+		internal_cache->first_image = new_image;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result == 0 )
+	{
+		memory_free(
+		 new_image->identifier );
+		memory_free(
+		 new_image );
+	}
+	return( result );
+}
+
+/* Releases a reference to an image
+ * The image is removed from the cache when its last reference is released,
+ * the image itself is not freed since it is managed by the caller
+ * Returns 1 if successful, 0 if the image is not set or -1 on error
+ */
+int libqcow_internal_cache_release_image(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *image,
+     int *number_of_references,
+     libcerror_error_t **error )
+{
+	libqcow_cache_image_t *cache_image    = NULL;
+	libqcow_cache_image_t *previous_image = NULL;
+	libqcow_cache_image_t *removed_image  = NULL;
+	static char *function                 = "libqcow_internal_cache_release_image";
+	int result                            = 0;
+
+	if( internal_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of references.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	cache_image = internal_cache->first_image;
+
+	while( cache_image != NULL )
+	{
+		if( cache_image->image == image )
+		{
+			cache_image->number_of_references -= 1;
+
+			*number_of_references = cache_image->number_of_references;
+
+			if( cache_image->number_of_references <= 0 )
+			{
+				if( previous_image == NULL )
+				{
+					internal_cache->first_image = cache_image->next_image;
+				}
+				else
+				{
+					previous_image->next_image = cache_image->next_image;
+				}
+				removed_image = cache_image;
+			}
+			result = 1;
+
+			break;
+		}
+		previous_image = cache_image;
+		cache_image    = cache_image->next_image;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_cache->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( removed_image != NULL )
+	{
+		memory_free(
+		 removed_image->identifier );
+		memory_free(
+		 removed_image );
+	}
+	return( result );
+}
@@ -0,0 +1,327 @@
+/*
+ * Shared cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_INTERNAL_CACHE_H )
+#define _LIBQCOW_INTERNAL_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_extern.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_cache_value libqcow_cache_value_t;
+
+struct libqcow_cache_value
+{
+	/* The owner, which identifies the file the value belongs to
+	 */
+	intptr_t *owner;
+
+	/* The value type
+	 */
+	uint8_t value_type;
+
+	/* The (file) offset that identifies the value
+	 */
+	off64_t offset;
+
+	/* The value
+	 */
+	intptr_t *value;
+
+	/* The value free function
+	 */
+	int (*free_value)(
+	       intptr_t **value,
+	       libcerror_error_t **error );
+
+	/* The value size function
+	 */
+	int (*get_value_size)(
+	       intptr_t *value,
+	       size_t *value_size,
+	       libcerror_error_t **error );
+
+	/* The value size, which is the size of the value at the time it was last released
+	 */
+	size_t value_size;
+
+	/* The number of references, a value that is referenced is not evicted
+	 */
+	int number_of_references;
+
+	/* Value to indicate the value was removed from the cache while it was referenced
+	 */
+	uint8_t is_removed;
+
+	/* The priority
+	 */
+	uint8_t priority;
+
+	/* The number of eviction credits, which is the number of times the value
+	 * is passed over before it is evicted
+	 */
+	uint8_t eviction_credits;
+
+	/* The previous (more recently used) value
+	 */
+	libqcow_cache_value_t *previous_value;
+
+	/* The next (less recently used) value
+	 */
+	libqcow_cache_value_t *next_value;
+
+	/* The next value in the same hash bucket
+	 */
+	libqcow_cache_value_t *next_bucket_value;
+};
+
+typedef struct libqcow_cache_image libqcow_cache_image_t;
+
+struct libqcow_cache_image
+{
+	/* The identifier, which is the path the image was opened by
+	 */
+	uint8_t *identifier;
+
+	/* The identifier size
+	 */
+	size_t identifier_size;
+
+	/* The image, which is a file opened by the library
+	 */
+	intptr_t *image;
+
+	/* The number of references, the image is removed when the last reference is released
+	 */
+	int number_of_references;
+
+	/* The next image
+	 */
+	libqcow_cache_image_t *next_image;
+};
+
+typedef struct libqcow_cache_shard libqcow_cache_shard_t;
+
+struct libqcow_cache_shard
+{
+	/* The maximum memory size
+	 */
+	size64_t maximum_memory_size;
+
+	/* The memory size of the values
+	 */
+	size64_t memory_size;
+
+	/* The memory size of the low priority values
+	 */
+	size64_t low_priority_memory_size;
+
+	/* The number of hash buckets
+	 */
+	int number_of_buckets;
+
+	/* The hash buckets
+	 */
+	libqcow_cache_value_t **buckets;
+
+	/* The most recently used value
+	 */
+	libqcow_cache_value_t *first_value;
+
+	/* The least recently used value
+	 */
+	libqcow_cache_value_t *last_value;
+
+	/* The number of values
+	 */
+	int number_of_values;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+
+	/* The padding, so that the values above of adjacent shards do not share a cache line
+	 */
+	uint8_t padding[ LIBQCOW_CACHE_SHARD_PADDING_SIZE ];
+};
+
+typedef struct libqcow_internal_cache libqcow_internal_cache_t;
+
+struct libqcow_internal_cache
+{
+	/* The maximum memory size
+	 */
+	size64_t maximum_memory_size;
+
+	/* The number of shards, which is a power of 2
+	 */
+	int number_of_shards;
+
+	/* The shards, where each shard caches the values that hash onto it with its own
+	 * mutex and least recently used list, so that threads that read different
+	 * (host) offsets do not contend for a single mutex
+	 */
+	libqcow_cache_shard_t *shards;
+
+	/* The number of files the cache is attached to
+	 */
+	int number_of_files;
+
+	/* The images, which are the backing files opened by the library that are
+	 * shared by the files the cache is attached to
+	 */
+	libqcow_cache_image_t *first_image;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex, which protects the number of files and the images
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+LIBQCOW_EXTERN \
+int libqcow_cache_initialize(
+     libqcow_cache_t **cache,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_cache_free(
+     libqcow_cache_t **cache,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_cache_get_maximum_memory_size(
+     libqcow_cache_t *cache,
+     size64_t *maximum_memory_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_cache_get_memory_usage(
+     libqcow_cache_t *cache,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_cache_trim(
+     libqcow_cache_t *cache,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_attach_file(
+     libqcow_internal_cache_t *internal_cache,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_detach_file(
+     libqcow_internal_cache_t *internal_cache,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_get_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_has_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_set_value(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t *value,
+     uint8_t priority,
+     int (*free_value)(
+            intptr_t **value,
+            libcerror_error_t **error ),
+     int (*get_value_size)(
+            intptr_t *value,
+            size_t *value_size,
+            libcerror_error_t **error ),
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_release_value(
+     libqcow_internal_cache_t *internal_cache,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_remove_values(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_remove_values_by_type(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     uint8_t value_type,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_get_memory_usage_by_owner(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *owner,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_get_image(
+     libqcow_internal_cache_t *internal_cache,
+     const uint8_t *identifier,
+     size_t identifier_size,
+     intptr_t **image,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_set_image(
+     libqcow_internal_cache_t *internal_cache,
+     const uint8_t *identifier,
+     size_t identifier_size,
+     intptr_t *image,
+     libcerror_error_t **error );
+
+int libqcow_internal_cache_release_image(
+     libqcow_internal_cache_t *internal_cache,
+     intptr_t *image,
+     int *number_of_references,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_INTERNAL_CACHE_H ) */
+
@@ -0,0 +1,733 @@
+/*
+ * Cache state functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cache_state.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+
+#include "qcow_cache_state.h"
+
+const uint8_t qcow_cache_state_signature[ 8 ] = { 'q', 'c', 'o', 'w', 'w', 'a', 'r', 'm' };
+
+/* Creates a cache state
+ * Make sure the value cache_state is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_initialize(
+     libqcow_cache_state_t **cache_state,
+     size64_t media_size,
+     size_t cluster_block_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_initialize";
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache_state != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cache state value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size_t) UINT32_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*cache_state = memory_allocate_structure(
+	                libqcow_cache_state_t );
+
+	if( *cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     *cache_state,
+	     0,
+	     sizeof( libqcow_cache_state_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cache state.",
+		 function );
+
+		memory_free(
+		 *cache_state );
+
+		*cache_state = NULL;
+
+		return( -1 );
+	}
+	( *cache_state )->media_size         = media_size;
+	( *cache_state )->cluster_block_size = cluster_block_size;
+
+	return( 1 );
+}
+
+/* Frees a cache state
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_free(
+     libqcow_cache_state_t **cache_state,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_free";
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache_state != NULL )
+	{
+		if( ( *cache_state )->cluster_block_offsets != NULL )
+		{
+			memory_free(
+			 ( *cache_state )->cluster_block_offsets );
+		}
+		if( ( *cache_state )->level2_table_offsets != NULL )
+		{
+			memory_free(
+			 ( *cache_state )->level2_table_offsets );
+		}
+		memory_free(
+		 *cache_state );
+
+		*cache_state = NULL;
+	}
+	return( 1 );
+}
+
+/* Appends a (media) offset of a specific type
+ * The offset type is a LIBQCOW_CACHE_STATE_OFFSET_TYPE_ value, a level 2 table
+ * is identified by the offset of the first cluster block it maps
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_append_offset(
+     libqcow_cache_state_t *cache_state,
+     uint8_t offset_type,
+     off64_t offset,
+     libcerror_error_t **error )
+{
+	off64_t **offsets                    = NULL;
+	void *reallocation                   = NULL;
+	static char *function                = "libqcow_cache_state_append_offset";
+	int *number_of_allocated_offsets     = NULL;
+	int *number_of_offsets               = NULL;
+	int safe_number_of_allocated_offsets = 0;
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset_type == LIBQCOW_CACHE_STATE_OFFSET_TYPE_LEVEL2_TABLE )
+	{
+		offsets                     = &( cache_state->level2_table_offsets );
+		number_of_offsets           = &( cache_state->number_of_level2_table_offsets );
+		number_of_allocated_offsets = &( cache_state->number_of_allocated_level2_table_offsets );
+	}
+	else if( offset_type == LIBQCOW_CACHE_STATE_OFFSET_TYPE_CLUSTER_BLOCK )
+	{
+		offsets                     = &( cache_state->cluster_block_offsets );
+		number_of_offsets           = &( cache_state->number_of_cluster_block_offsets );
+		number_of_allocated_offsets = &( cache_state->number_of_allocated_cluster_block_offsets );
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported offset type: %" PRIu8 ".",
+		 function,
+		 offset_type );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= cache_state->media_size )
+	 || ( ( (uint64_t) offset % cache_state->cluster_block_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The total number of offsets must fit in a signed 32-bit integer
+	 */
+	if( ( cache_state->number_of_level2_table_offsets + cache_state->number_of_cluster_block_offsets ) >= INT32_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of offsets value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( *number_of_offsets >= *number_of_allocated_offsets )
+	{
+		if( *number_of_allocated_offsets == 0 )
+		{
+			safe_number_of_allocated_offsets = 256;
+		}
+		else if( *number_of_allocated_offsets > ( INT32_MAX / 2 ) )
+		{
+			safe_number_of_allocated_offsets = INT32_MAX;
+		}
+		else
+		{
+			safe_number_of_allocated_offsets = *number_of_allocated_offsets * 2;
+		}
+		reallocation = memory_reallocate(
+		                *offsets,
+		                sizeof( off64_t ) * safe_number_of_allocated_offsets );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize offsets.",
+			 function );
+
+			return( -1 );
+		}
+		*offsets                     = (off64_t *) reallocation;
+		*number_of_allocated_offsets = safe_number_of_allocated_offsets;
+	}
+	( *offsets )[ *number_of_offsets ] = offset;
+
+	*number_of_offsets += 1;
+
+	return( 1 );
+}
+
+/* Retrieves the number of offsets
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_get_number_of_offsets(
+     libqcow_cache_state_t *cache_state,
+     int *number_of_offsets,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_get_number_of_offsets";
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_offsets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of offsets.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_offsets = cache_state->number_of_level2_table_offsets
+	                   + cache_state->number_of_cluster_block_offsets;
+
+	return( 1 );
+}
+
+/* Retrieves a specific offset
+ * The level 2 table offsets precede the cluster block offsets, so that
+ * the level 2 tables are read before the cluster blocks they map
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_get_offset_by_index(
+     libqcow_cache_state_t *cache_state,
+     int offset_index,
+     uint8_t *offset_type,
+     off64_t *offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_get_offset_by_index";
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset_index < 0 )
+	 || ( offset_index >= ( cache_state->number_of_level2_table_offsets + cache_state->number_of_cluster_block_offsets ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset_type == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offset type.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset_index < cache_state->number_of_level2_table_offsets )
+	{
+		*offset_type = LIBQCOW_CACHE_STATE_OFFSET_TYPE_LEVEL2_TABLE;
+		*offset      = cache_state->level2_table_offsets[ offset_index ];
+	}
+	else
+	{
+		offset_index -= cache_state->number_of_level2_table_offsets;
+
+		*offset_type = LIBQCOW_CACHE_STATE_OFFSET_TYPE_CLUSTER_BLOCK;
+		*offset      = cache_state->cluster_block_offsets[ offset_index ];
+	}
+	return( 1 );
+}
+
+/* Retrieves the size of the cache state data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_get_data_size(
+     libqcow_cache_state_t *cache_state,
+     size_t *data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_get_data_size";
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data size.",
+		 function );
+
+		return( -1 );
+	}
+	*data_size = sizeof( qcow_cache_state_header_t )
+	           + ( 8 * (size_t) cache_state->number_of_level2_table_offsets )
+	           + ( 8 * (size_t) cache_state->number_of_cluster_block_offsets );
+
+	return( 1 );
+}
+
+/* Reads the cache state data
+ * The cache state must be empty and is only read if the data was exported from
+ * an image with the same media size and cluster block size
+ * Returns 1 if successful, 0 if the data does not match the image or -1 on error
+ */
+int libqcow_cache_state_read_data(
+     libqcow_cache_state_t *cache_state,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function             = "libqcow_cache_state_read_data";
+	size64_t media_size               = 0;
+	size_t data_offset                = 0;
+	uint64_t offset                   = 0;
+	uint32_t cluster_block_size       = 0;
+	uint32_t format_version           = 0;
+	uint32_t number_of_cluster_blocks = 0;
+	uint32_t number_of_level2_tables  = 0;
+	uint32_t offset_index             = 0;
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cache_state->number_of_level2_table_offsets != 0 )
+	 || ( cache_state->number_of_cluster_block_offsets != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cache state - offsets already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size < sizeof( qcow_cache_state_header_t ) )
+	 || ( data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_compare(
+	     ( (qcow_cache_state_header_t *) data )->signature,
+	     qcow_cache_state_signature,
+	     8 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported cache state signature.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->format_version,
+	 format_version );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->cluster_block_size,
+	 cluster_block_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->media_size,
+	 media_size );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->number_of_level2_tables,
+	 number_of_level2_tables );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->number_of_cluster_blocks,
+	 number_of_cluster_blocks );
+
+	if( format_version != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported cache state format version: %" PRIu32 ".",
+		 function,
+		 format_version );
+
+		return( -1 );
+	}
+	if( ( number_of_level2_tables > (uint32_t) INT32_MAX )
+	 || ( number_of_cluster_blocks > ( (uint32_t) INT32_MAX - number_of_level2_tables ) )
+	 || ( ( (uint64_t) number_of_level2_tables + number_of_cluster_blocks ) != ( (uint64_t) ( data_size - sizeof( qcow_cache_state_header_t ) ) / 8 ) )
+	 || ( ( ( data_size - sizeof( qcow_cache_state_header_t ) ) % 8 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of offsets value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The working set of another image, or of the image before it was resized, is ignored
+	 */
+	if( ( (size_t) cluster_block_size != cache_state->cluster_block_size )
+	 || ( media_size != cache_state->media_size ) )
+	{
+		return( 0 );
+	}
+	data_offset = sizeof( qcow_cache_state_header_t );
+
+	for( offset_index = 0;
+	     offset_index < ( number_of_level2_tables + number_of_cluster_blocks );
+	     offset_index++ )
+	{
+		byte_stream_copy_to_uint64_little_endian(
+		 &( data[ data_offset ] ),
+		 offset );
+
+		data_offset += 8;
+
+		if( offset > (uint64_t) INT64_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid offset: %" PRIu32 " value out of bounds.",
+			 function,
+			 offset_index );
+
+			goto on_error;
+		}
+		if( libqcow_cache_state_append_offset(
+		     cache_state,
+		     ( offset_index < number_of_level2_tables ) ? LIBQCOW_CACHE_STATE_OFFSET_TYPE_LEVEL2_TABLE : LIBQCOW_CACHE_STATE_OFFSET_TYPE_CLUSTER_BLOCK,
+		     (off64_t) offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to append offset: %" PRIu32 ".",
+			 function,
+			 offset_index );
+
+			goto on_error;
+		}
+	}
+	return( 1 );
+
+on_error:
+	cache_state->number_of_level2_table_offsets  = 0;
+	cache_state->number_of_cluster_block_offsets = 0;
+
+	return( -1 );
+}
+
+/* Writes the cache state data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cache_state_write_data(
+     libqcow_cache_state_t *cache_state,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cache_state_write_data";
+	size_t data_offset    = 0;
+	size_t safe_data_size = 0;
+	int offset_index      = 0;
+
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cache_state_get_data_size(
+	     cache_state,
+	     &safe_data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve data size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size < safe_data_size )
+	 || ( data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     ( (qcow_cache_state_header_t *) data )->signature,
+	     qcow_cache_state_signature,
+	     8 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy signature.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_from_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->format_version,
+	 1 );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->cluster_block_size,
+	 (uint32_t) cache_state->cluster_block_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->media_size,
+	 cache_state->media_size );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->number_of_level2_tables,
+	 (uint32_t) cache_state->number_of_level2_table_offsets );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 ( (qcow_cache_state_header_t *) data )->number_of_cluster_blocks,
+	 (uint32_t) cache_state->number_of_cluster_block_offsets );
+
+	data_offset = sizeof( qcow_cache_state_header_t );
+
+	for( offset_index = 0;
+	     offset_index < cache_state->number_of_level2_table_offsets;
+	     offset_index++ )
+	{
+		byte_stream_copy_from_uint64_little_endian(
+		 &( data[ data_offset ] ),
+		 (uint64_t) cache_state->level2_table_offsets[ offset_index ] );
+
+		data_offset += 8;
+	}
+	for( offset_index = 0;
+	     offset_index < cache_state->number_of_cluster_block_offsets;
+	     offset_index++ )
+	{
+		byte_stream_copy_from_uint64_little_endian(
+		 &( data[ data_offset ] ),
+		 (uint64_t) cache_state->cluster_block_offsets[ offset_index ] );
+
+		data_offset += 8;
+	}
+	return( 1 );
+}
+
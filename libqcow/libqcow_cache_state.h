@@ -0,0 +1,126 @@
+/*
+ * Cache state functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CACHE_STATE_H )
+#define _LIBQCOW_CACHE_STATE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_cache_state libqcow_cache_state_t;
+
+/* The cache state is the working set of a file, which consists of the (media)
+ * offsets of the cached level 2 tables and cluster blocks
+ * It is exported before a process exits and imported after it restarts
+ * to read the working set into the caches again
+ */
+struct libqcow_cache_state
+{
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The level 2 table (media) offsets
+	 */
+	off64_t *level2_table_offsets;
+
+	/* The number of level 2 table offsets
+	 */
+	int number_of_level2_table_offsets;
+
+	/* The number of allocated level 2 table offsets
+	 */
+	int number_of_allocated_level2_table_offsets;
+
+	/* The cluster block (media) offsets
+	 */
+	off64_t *cluster_block_offsets;
+
+	/* The number of cluster block offsets
+	 */
+	int number_of_cluster_block_offsets;
+
+	/* The number of allocated cluster block offsets
+	 */
+	int number_of_allocated_cluster_block_offsets;
+};
+
+int libqcow_cache_state_initialize(
+     libqcow_cache_state_t **cache_state,
+     size64_t media_size,
+     size_t cluster_block_size,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_free(
+     libqcow_cache_state_t **cache_state,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_append_offset(
+     libqcow_cache_state_t *cache_state,
+     uint8_t offset_type,
+     off64_t offset,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_get_number_of_offsets(
+     libqcow_cache_state_t *cache_state,
+     int *number_of_offsets,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_get_offset_by_index(
+     libqcow_cache_state_t *cache_state,
+     int offset_index,
+     uint8_t *offset_type,
+     off64_t *offset,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_get_data_size(
+     libqcow_cache_state_t *cache_state,
+     size_t *data_size,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_read_data(
+     libqcow_cache_state_t *cache_state,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_cache_state_write_data(
+     libqcow_cache_state_t *cache_state,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CACHE_STATE_H ) */
+
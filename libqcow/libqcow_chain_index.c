@@ -0,0 +1,971 @@
+/*
+ * Chain index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_chain_index.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+
+#include "qcow_chain_index.h"
+
+/* The number of references that are read or written at once
+ */
+#define LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK	4096
+
+const uint8_t qcow_chain_index_file_signature[ 8 ] = { 'q', 'c', 'o', 'w', 'c', 'i', 'd', 'x' };
+
+/* Calculates the Adler-32 of data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_calculate_checksum(
+     uint32_t *checksum,
+     const uint8_t *data,
+     size_t data_size,
+     uint32_t initial_value,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_chain_index_calculate_checksum";
+	size_t data_offset    = 0;
+	size_t block_size     = 0;
+	uint32_t lower_word   = 0;
+	uint32_t upper_word   = 0;
+
+	if( checksum == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid checksum.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	lower_word = initial_value & 0xffff;
+	upper_word = ( initial_value >> 16 ) & 0xffff;
+
+	while( data_offset < data_size )
+	{
+		/* 5552 is the largest number of bytes for which the sums cannot overflow
+		 */
+		block_size = data_size - data_offset;
+
+		if( block_size > 5552 )
+		{
+			block_size = 5552;
+		}
+		while( block_size > 0 )
+		{
+			lower_word += data[ data_offset++ ];
+			upper_word += lower_word;
+
+			block_size--;
+		}
+		lower_word %= 65521;
+		upper_word %= 65521;
+	}
+	*checksum = ( upper_word << 16 ) | lower_word;
+
+	return( 1 );
+}
+
+/* Creates a chain index
+ * Make sure the value chain_index is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_initialize(
+     libqcow_chain_index_t **chain_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_chain_index_initialize";
+	size64_t number_of_entries = 0;
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *chain_index != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid chain index value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_entries = media_size / cluster_block_size;
+
+	if( ( media_size % cluster_block_size ) != 0 )
+	{
+		number_of_entries += 1;
+	}
+	if( ( number_of_entries == 0 )
+	 || ( number_of_entries > (size64_t) ( SSIZE_MAX / sizeof( uint64_t ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*chain_index = memory_allocate_structure(
+	                libqcow_chain_index_t );
+
+	if( *chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create chain index.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *chain_index,
+	     0,
+	     sizeof( libqcow_chain_index_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear chain index.",
+		 function );
+
+		memory_free(
+		 *chain_index );
+
+		*chain_index = NULL;
+
+		return( -1 );
+	}
+	( *chain_index )->layers = (uint8_t *) memory_allocate(
+	                                        sizeof( uint8_t ) * (size_t) number_of_entries );
+
+	if( ( *chain_index )->layers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create layers.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *chain_index )->layers,
+	     0,
+	     sizeof( uint8_t ) * (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear layers.",
+		 function );
+
+		goto on_error;
+	}
+	( *chain_index )->references = (uint64_t *) memory_allocate(
+	                                             sizeof( uint64_t ) * (size_t) number_of_entries );
+
+	if( ( *chain_index )->references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create references.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *chain_index )->references,
+	     0,
+	     sizeof( uint64_t ) * (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear references.",
+		 function );
+
+		goto on_error;
+	}
+	( *chain_index )->media_size         = media_size;
+	( *chain_index )->cluster_block_size = cluster_block_size;
+	( *chain_index )->number_of_entries  = (size_t) number_of_entries;
+
+	return( 1 );
+
+on_error:
+	if( *chain_index != NULL )
+	{
+		if( ( *chain_index )->references != NULL )
+		{
+			memory_free(
+			 ( *chain_index )->references );
+		}
+		if( ( *chain_index )->layers != NULL )
+		{
+			memory_free(
+			 ( *chain_index )->layers );
+		}
+		memory_free(
+		 *chain_index );
+
+		*chain_index = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a chain index
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_free(
+     libqcow_chain_index_t **chain_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_chain_index_free";
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *chain_index != NULL )
+	{
+		if( ( *chain_index )->references != NULL )
+		{
+			memory_free(
+			 ( *chain_index )->references );
+		}
+		if( ( *chain_index )->layers != NULL )
+		{
+			memory_free(
+			 ( *chain_index )->layers );
+		}
+		memory_free(
+		 *chain_index );
+
+		*chain_index = NULL;
+	}
+	return( 1 );
+}
+
+/* Retrieves the entry of the cluster block at a specific offset
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_get_entry_at_offset(
+     libqcow_chain_index_t *chain_index,
+     off64_t offset,
+     uint8_t *layer,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_chain_index_get_entry_at_offset";
+	size_t entry_index    = 0;
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= chain_index->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( layer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layer.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+	entry_index = (size_t) ( (size64_t) offset / chain_index->cluster_block_size );
+
+	*layer                   = chain_index->layers[ entry_index ];
+	*cluster_block_reference = chain_index->references[ entry_index ];
+
+	return( 1 );
+}
+
+/* Sets the entry of the cluster block at a specific offset
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_set_entry_at_offset(
+     libqcow_chain_index_t *chain_index,
+     off64_t offset,
+     uint8_t layer,
+     uint64_t cluster_block_reference,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_chain_index_set_entry_at_offset";
+	size_t entry_index    = 0;
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= chain_index->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	entry_index = (size_t) ( (size64_t) offset / chain_index->cluster_block_size );
+
+	chain_index->layers[ entry_index ]     = layer;
+	chain_index->references[ entry_index ] = cluster_block_reference;
+
+	return( 1 );
+}
+
+/* Reads the chain index from a chain index file
+ * Returns 1 if successful, 0 if the chain index file does not match the chain index or -1 on error
+ */
+int libqcow_chain_index_read_file_io_handle(
+     libqcow_chain_index_t *chain_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_chain_index_file_header_t file_header;
+
+	uint8_t *references_data     = NULL;
+	static char *function        = "libqcow_chain_index_read_file_io_handle";
+	size64_t cluster_block_size  = 0;
+	size64_t media_size          = 0;
+	size64_t number_of_entries   = 0;
+	size_t data_offset           = 0;
+	size_t entry_index           = 0;
+	size_t number_of_references  = 0;
+	size_t read_size             = 0;
+	ssize_t read_count           = 0;
+	uint32_t calculated_checksum = 1;
+	uint32_t format_version      = 0;
+	uint32_t stored_checksum     = 0;
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) &file_header,
+	              sizeof( qcow_chain_index_file_header_t ),
+	              0,
+	              error );
+
+	if( read_count != (ssize_t) sizeof( qcow_chain_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_compare(
+	     file_header.signature,
+	     qcow_chain_index_file_signature,
+	     8 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported chain index file signature.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.format_version,
+	 format_version );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.checksum,
+	 stored_checksum );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 cluster_block_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.media_size,
+	 media_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.number_of_entries,
+	 number_of_entries );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: format version\t\t: %" PRIu32 "\n",
+		 function,
+		 format_version );
+
+		libcnotify_printf(
+		 "%s: checksum\t\t\t: 0x%08" PRIx32 "\n",
+		 function,
+		 stored_checksum );
+
+		libcnotify_printf(
+		 "%s: cluster block size\t\t: %" PRIu64 "\n",
+		 function,
+		 cluster_block_size );
+
+		libcnotify_printf(
+		 "%s: media size\t\t\t: %" PRIu64 "\n",
+		 function,
+		 media_size );
+
+		libcnotify_printf(
+		 "%s: number of entries\t\t: %" PRIu64 "\n",
+		 function,
+		 number_of_entries );
+
+		libcnotify_printf(
+		 "\n" );
+	}
+#endif
+	if( format_version != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported chain index file format version: %" PRIu32 ".",
+		 function,
+		 format_version );
+
+		goto on_error;
+	}
+	/* A chain index file of another image cannot be used
+	 */
+	if( ( cluster_block_size != (size64_t) chain_index->cluster_block_size )
+	 || ( media_size != chain_index->media_size )
+	 || ( number_of_entries != (size64_t) chain_index->number_of_entries ) )
+	{
+		return( 0 );
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              chain_index->layers,
+	              chain_index->number_of_entries,
+	              (off64_t) sizeof( qcow_chain_index_file_header_t ),
+	              error );
+
+	if( read_count != (ssize_t) chain_index->number_of_entries )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read layers.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_chain_index_calculate_checksum(
+	     &calculated_checksum,
+	     chain_index->layers,
+	     chain_index->number_of_entries,
+	     calculated_checksum,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate checksum.",
+		 function );
+
+		goto on_error;
+	}
+	references_data = (uint8_t *) memory_allocate(
+	                               sizeof( uint64_t ) * LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK );
+
+	if( references_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create references data.",
+		 function );
+
+		goto on_error;
+	}
+	while( entry_index < chain_index->number_of_entries )
+	{
+		number_of_references = chain_index->number_of_entries - entry_index;
+
+		if( number_of_references > LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK )
+		{
+			number_of_references = LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK;
+		}
+		read_size = sizeof( uint64_t ) * number_of_references;
+
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              references_data,
+		              read_size,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read references.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     references_data,
+		     read_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			goto on_error;
+		}
+		for( data_offset = 0;
+		     data_offset < read_size;
+		     data_offset += 8 )
+		{
+			byte_stream_copy_to_uint64_little_endian(
+			 &( references_data[ data_offset ] ),
+			 chain_index->references[ entry_index ] );
+
+			entry_index++;
+		}
+	}
+	memory_free(
+	 references_data );
+
+	references_data = NULL;
+
+	if( stored_checksum != calculated_checksum )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_INPUT,
+		 LIBCERROR_INPUT_ERROR_CHECKSUM_MISMATCH,
+		 "%s: mismatch in checksum ( 0x%08" PRIx32 " != 0x%08" PRIx32 " ).",
+		 function,
+		 stored_checksum,
+		 calculated_checksum );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( references_data != NULL )
+	{
+		memory_free(
+		 references_data );
+	}
+	/* Do not leave a partially read chain index behind
+	 */
+	memory_set(
+	 chain_index->layers,
+	 0,
+	 sizeof( uint8_t ) * chain_index->number_of_entries );
+
+	memory_set(
+	 chain_index->references,
+	 0,
+	 sizeof( uint64_t ) * chain_index->number_of_entries );
+
+	return( -1 );
+}
+
+/* Writes the chain index to a chain index file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_write_file_io_handle(
+     libqcow_chain_index_t *chain_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_chain_index_file_header_t file_header;
+
+	uint8_t *references_data     = NULL;
+	static char *function        = "libqcow_chain_index_write_file_io_handle";
+	size_t data_offset           = 0;
+	size_t entry_index           = 0;
+	size_t number_of_references  = 0;
+	size_t write_size            = 0;
+	ssize_t write_count          = 0;
+	uint32_t calculated_checksum = 1;
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               chain_index->layers,
+	               chain_index->number_of_entries,
+	               (off64_t) sizeof( qcow_chain_index_file_header_t ),
+	               error );
+
+	if( write_count != (ssize_t) chain_index->number_of_entries )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write layers.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_chain_index_calculate_checksum(
+	     &calculated_checksum,
+	     chain_index->layers,
+	     chain_index->number_of_entries,
+	     calculated_checksum,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate checksum.",
+		 function );
+
+		goto on_error;
+	}
+	references_data = (uint8_t *) memory_allocate(
+	                               sizeof( uint64_t ) * LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK );
+
+	if( references_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create references data.",
+		 function );
+
+		goto on_error;
+	}
+	while( entry_index < chain_index->number_of_entries )
+	{
+		number_of_references = chain_index->number_of_entries - entry_index;
+
+		if( number_of_references > LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK )
+		{
+			number_of_references = LIBQCOW_CHAIN_INDEX_REFERENCES_PER_BLOCK;
+		}
+		write_size = sizeof( uint64_t ) * number_of_references;
+
+		for( data_offset = 0;
+		     data_offset < write_size;
+		     data_offset += 8 )
+		{
+			byte_stream_copy_from_uint64_little_endian(
+			 &( references_data[ data_offset ] ),
+			 chain_index->references[ entry_index ] );
+
+			entry_index++;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     references_data,
+		     write_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			goto on_error;
+		}
+		write_count = libbfio_handle_write_buffer(
+		               file_io_handle,
+		               references_data,
+		               write_size,
+		               error );
+
+		if( write_count != (ssize_t) write_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write references.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 references_data );
+
+	references_data = NULL;
+
+	/* The file header is written last so that an incomplete chain index file
+	 * is not recognized
+	 */
+	if( memory_copy(
+	     file_header.signature,
+	     qcow_chain_index_file_signature,
+	     8 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy signature.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.format_version,
+	 1 );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.checksum,
+	 calculated_checksum );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 (uint64_t) chain_index->cluster_block_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.media_size,
+	 chain_index->media_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.number_of_entries,
+	 (uint64_t) chain_index->number_of_entries );
+
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               (uint8_t *) &file_header,
+	               sizeof( qcow_chain_index_file_header_t ),
+	               0,
+	               error );
+
+	if( write_count != (ssize_t) sizeof( qcow_chain_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( references_data != NULL )
+	{
+		memory_free(
+		 references_data );
+	}
+	return( -1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the chain index and its entries in bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_chain_index_get_memory_usage(
+     libqcow_chain_index_t *chain_index,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_chain_index_get_memory_usage";
+
+	if( chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chain index.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_chain_index_t )
+	              + ( ( sizeof( uint8_t ) + sizeof( uint64_t ) ) * chain_index->number_of_entries );
+
+	return( 1 );
+}
+
@@ -0,0 +1,116 @@
+/*
+ * Chain index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CHAIN_INDEX_H )
+#define _LIBQCOW_CHAIN_INDEX_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_chain_index libqcow_chain_index_t;
+
+/* The chain index is a flattened view of a backing file chain
+ * It contains per cluster block of the media the layer, which is the depth
+ * of the backing file relative to the file, and the cluster block reference
+ * in that layer
+ */
+struct libqcow_chain_index
+{
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The number of entries
+	 */
+	size_t number_of_entries;
+
+	/* The layers
+	 */
+	uint8_t *layers;
+
+	/* The cluster block references
+	 */
+	uint64_t *references;
+};
+
+int libqcow_chain_index_calculate_checksum(
+     uint32_t *checksum,
+     const uint8_t *data,
+     size_t data_size,
+     uint32_t initial_value,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_initialize(
+     libqcow_chain_index_t **chain_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_free(
+     libqcow_chain_index_t **chain_index,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_get_entry_at_offset(
+     libqcow_chain_index_t *chain_index,
+     off64_t offset,
+     uint8_t *layer,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_set_entry_at_offset(
+     libqcow_chain_index_t *chain_index,
+     off64_t offset,
+     uint8_t layer,
+     uint64_t cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_read_file_io_handle(
+     libqcow_chain_index_t *chain_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_write_file_io_handle(
+     libqcow_chain_index_t *chain_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_chain_index_get_memory_usage(
+     libqcow_chain_index_t *chain_index,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CHAIN_INDEX_H ) */
+
@@ -25,21 +25,28 @@
 #include <types.h>
 
 #include "libqcow_cluster_block.h"
+#include "libqcow_cluster_block_pool.h"
+#include "libqcow_compression.h"
 #include "libqcow_definitions.h"
+#include "libqcow_encryption.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libcnotify.h"
+#include "libqcow_trace.h"
 
 /* Creates a cluster block
  * Make sure the value cluster_block is referencing, is set to NULL
+ * The pool is optional and used for the data buffers of the size of its buffers
  * Returns 1 if successful or -1 on error
  */
 int libqcow_cluster_block_initialize(
      libqcow_cluster_block_t **cluster_block,
      size_t data_size,
+     libqcow_cluster_block_pool_t *pool,
      libcerror_error_t **error )
 {
 	static char *function = "libqcow_cluster_block_initialize";
+	uint8_t is_pooled     = 0;
 
 	if( cluster_block == NULL )
 	{
@@ -107,12 +114,16 @@ int libqcow_cluster_block_initialize(
 
 		return( -1 );
 	}
+	( *cluster_block )->pool = pool;
+
 	if( data_size > 0 )
 	{
-		( *cluster_block )->data = (uint8_t *) memory_allocate(
-		                                        sizeof( uint8_t ) * data_size );
-
-		if( ( *cluster_block )->data == NULL )
+		if( libqcow_cluster_block_allocate_buffer(
+		     *cluster_block,
+		     data_size,
+		     &( ( *cluster_block )->data ),
+		     &is_pooled,
+		     error ) != 1 )
 		{
 			libcerror_error_set(
 			 error,
@@ -123,6 +134,10 @@ int libqcow_cluster_block_initialize(
 
 			goto on_error;
 		}
+		if( is_pooled != 0 )
+		{
+			( *cluster_block )->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA;
+		}
 		( *cluster_block )->data_size = data_size;
 	}
 	return( 1 );
@@ -161,15 +176,53 @@ int libqcow_cluster_block_free(
 	}
 	if( *cluster_block != NULL )
 	{
-		if( ( *cluster_block )->compressed_data != NULL )
+		if( libqcow_cluster_block_free_buffer(
+		     *cluster_block,
+		     &( ( *cluster_block )->compressed_data ),
+		     ( *cluster_block )->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA,
+		     error ) != 1 )
 		{
-			memory_free(
-			 ( *cluster_block )->compressed_data );
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free compressed data.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_cluster_block_free_buffer(
+		     *cluster_block,
+		     &( ( *cluster_block )->encrypted_data ),
+		     ( *cluster_block )->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free encrypted data.",
+			 function );
+
+			result = -1;
 		}
-		if( ( *cluster_block )->encrypted_data != NULL )
+		if( ( *cluster_block )->decrypted_sectors_bitmap != NULL )
 		{
 			memory_free(
-			 ( *cluster_block )->encrypted_data );
+			 ( *cluster_block )->decrypted_sectors_bitmap );
+		}
+		if( libqcow_decompression_state_free(
+		     &( ( *cluster_block )->decompression_state ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free decompression state.",
+			 function );
+
+			result = -1;
 		}
 		if( ( *cluster_block )->data != NULL )
 		{
@@ -187,8 +240,21 @@ int libqcow_cluster_block_free(
 
 				result = -1;
 			}
-			memory_free(
-			 ( *cluster_block )->data );
+			if( libqcow_cluster_block_free_buffer(
+			     *cluster_block,
+			     &( ( *cluster_block )->data ),
+			     ( *cluster_block )->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free data.",
+				 function );
+
+				result = -1;
+			}
 		}
 		memory_free(
 		 *cluster_block );
@@ -198,6 +264,169 @@ int libqcow_cluster_block_free(
 	return( result );
 }
 
+/* Allocates a data buffer
+ * The buffer is retrieved from the pool if its size matches the pool buffer size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_allocate_buffer(
+     libqcow_cluster_block_t *cluster_block,
+     size_t buffer_size,
+     uint8_t **buffer,
+     uint8_t *is_pooled,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_allocate_buffer";
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( buffer_size == 0 )
+	 || ( buffer_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid buffer size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( is_pooled == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid is pooled.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->pool != NULL )
+	 && ( cluster_block->pool->buffer_size == buffer_size ) )
+	{
+		if( libqcow_cluster_block_pool_get_buffer(
+		     cluster_block->pool,
+		     buffer,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve buffer from pool.",
+			 function );
+
+			return( -1 );
+		}
+		*is_pooled = 1;
+	}
+	else
+	{
+		*buffer = (uint8_t *) memory_allocate(
+		                       sizeof( uint8_t ) * buffer_size );
+
+		if( *buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create buffer.",
+			 function );
+
+			return( -1 );
+		}
+		*is_pooled = 0;
+	}
+	return( 1 );
+}
+
+/* Frees a data buffer
+ * The buffer is released to the pool if it was retrieved from the pool
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_free_buffer(
+     libqcow_cluster_block_t *cluster_block,
+     uint8_t **buffer,
+     uint8_t is_pooled,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_free_buffer";
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( *buffer == NULL )
+	{
+		return( 1 );
+	}
+	if( is_pooled != 0 )
+	{
+		if( libqcow_cluster_block_pool_release_buffer(
+		     cluster_block->pool,
+		     buffer,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release buffer to pool.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		memory_free(
+		 *buffer );
+	}
+	*buffer = NULL;
+
+	return( 1 );
+}
+
 /* Reads cluster block
  * Returns 1 if successful or -1 on error
  */
@@ -207,8 +436,9 @@ int libqcow_cluster_block_read(
      off64_t cluster_block_offset,
      libcerror_error_t **error )
 {
-	static char *function = "libqcow_cluster_block_read";
-	ssize_t read_count    = 0;
+	static char *function    = "libqcow_cluster_block_read";
+	uint64_t start_timestamp = 0;
+	ssize_t read_count       = 0;
 
 	if( cluster_block == NULL )
 	{
@@ -259,6 +489,18 @@ int libqcow_cluster_block_read(
 
 		return( -1 );
 	}
+	if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed )
+	 || LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	LIBQCOW_TRACE(
+	 host_read_issued,
+	 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+	 cluster_block_offset,
+	 cluster_block->data_size,
+	 0 );
+
 	read_count = libbfio_handle_read_buffer(
 		      file_io_handle,
 		      cluster_block->data,
@@ -276,6 +518,29 @@ int libqcow_cluster_block_read(
 
 		return( -1 );
 	}
+	if( cluster_block->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->number_of_host_reads, 1 );
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->host_bytes_read, read_count );
+
+		if( ( start_timestamp != 0 )
+		 && LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 cluster_block->statistics,
+			 LIBQCOW_LATENCY_OPERATION_CLUSTER_BLOCK_READ,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 host_read_completed,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+		 cluster_block_offset,
+		 read_count,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
 #if defined( HAVE_DEBUG_OUTPUT )
 	if( libcnotify_verbose != 0 )
 	{
@@ -291,3 +556,1008 @@ int libqcow_cluster_block_read(
 	return( 1 );
 }
 
+/* Retrieves the memory usage
+ * The memory usage is the size of the cluster block and its data buffers in bytes
+ * including the padding used to align pooled buffers
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_get_memory_usage(
+     libqcow_cluster_block_t *cluster_block,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function        = "libqcow_cluster_block_get_memory_usage";
+	size_t pooled_buffer_padding = 0;
+	size_t safe_usage            = 0;
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->pool != NULL )
+	{
+		pooled_buffer_padding = cluster_block->pool->buffer_alignment + sizeof( uint8_t * );
+	}
+	safe_usage = sizeof( libqcow_cluster_block_t );
+
+	if( cluster_block->data != NULL )
+	{
+		safe_usage += cluster_block->data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA ) != 0 )
+		{
+			safe_usage += pooled_buffer_padding;
+		}
+	}
+	if( cluster_block->compressed_data != NULL )
+	{
+		safe_usage += cluster_block->compressed_data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA ) != 0 )
+		{
+			safe_usage += pooled_buffer_padding;
+		}
+	}
+	if( cluster_block->decrypted_sectors_bitmap != NULL )
+	{
+		safe_usage += ( ( cluster_block->data_size / 512 ) + 7 ) / 8;
+	}
+	if( cluster_block->decompression_state != NULL )
+	{
+		safe_usage += sizeof( libqcow_decompression_state_t );
+	}
+	if( cluster_block->encrypted_data != NULL )
+	{
+		safe_usage += cluster_block->encrypted_data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA ) != 0 )
+		{
+			safe_usage += pooled_buffer_padding;
+		}
+	}
+	*memory_usage = safe_usage;
+
+	return( 1 );
+}
+
+/* Decompresses the cluster block data
+ * The compressed data is retained in compressed_data and the data is replaced by the uncompressed data
+ * unless LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA is set, in which case the compressed data is freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_decompress(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_decompression_context_t *decompression_context,
+     size_t uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	uint8_t *uncompressed_data = NULL;
+	static char *function      = "libqcow_cluster_block_decompress";
+	size_t data_size           = 0;
+	uint64_t start_timestamp   = 0;
+	uint8_t is_pooled          = 0;
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster block - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block - data already decompressed.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( uncompressed_data_size == 0 )
+	 || ( uncompressed_data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid uncompressed data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_block_allocate_buffer(
+	     cluster_block,
+	     uncompressed_data_size,
+	     &uncompressed_data,
+	     &is_pooled,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create uncompressed data.",
+		 function );
+
+		return( -1 );
+	}
+	data_size = uncompressed_data_size;
+
+	if( ( cluster_block->statistics != NULL )
+	 || LIBQCOW_TRACE_IS_ENABLED( decompress ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	if( libqcow_decompression_context_decompress_data(
+	     decompression_context,
+	     cluster_block->data,
+	     cluster_block->data_size,
+	     uncompressed_data,
+	     &data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress data.",
+		 function );
+
+		libqcow_cluster_block_free_buffer(
+		 cluster_block,
+		 &uncompressed_data,
+		 is_pooled,
+		 NULL );
+
+		return( -1 );
+	}
+	if( cluster_block->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->number_of_decompressions, 1 );
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->decompression_time, libqcow_statistics_get_timestamp() - start_timestamp );
+
+		if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 cluster_block->statistics,
+			 LIBQCOW_LATENCY_OPERATION_DECOMPRESS,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 decompress,
+		 LIBQCOW_TRACE_EVENT_DECOMPRESS,
+		 0,
+		 data_size,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+	{
+		if( libqcow_cluster_block_free_buffer(
+		     cluster_block,
+		     &( cluster_block->data ),
+		     cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free compressed data.",
+			 function );
+
+			libqcow_cluster_block_free_buffer(
+			 cluster_block,
+			 &uncompressed_data,
+			 is_pooled,
+			 NULL );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		cluster_block->compressed_data      = cluster_block->data;
+		cluster_block->compressed_data_size = cluster_block->data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA ) != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA;
+		}
+	}
+	cluster_block->data       = uncompressed_data;
+	cluster_block->data_size  = uncompressed_data_size;
+	cluster_block->flags     |= LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED;
+
+	cluster_block->pooled_data_flags &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA );
+
+	if( is_pooled != 0 )
+	{
+		cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA;
+	}
+	return( 1 );
+}
+
+/* Decompresses the cluster block data up to and including a specific range
+ * The decompression is resumed where a previous call stopped, hence data that
+ * was decompressed before is not decompressed again
+ * The compressed data is retained in compressed_data until all the data is decompressed,
+ * after which LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED is set and the compressed data
+ * is freed if LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA is set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_decompress_range(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_decompression_context_t *decompression_context,
+     size_t uncompressed_data_size,
+     size_t data_offset,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	uint8_t *uncompressed_data = NULL;
+	static char *function      = "libqcow_cluster_block_decompress_range";
+	size_t start_data_offset   = 0;
+	size_t stop_data_offset    = 0;
+	uint64_t start_timestamp   = 0;
+	uint8_t is_pooled          = 0;
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster block - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block - data already decompressed.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( uncompressed_data_size == 0 )
+	 || ( uncompressed_data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid uncompressed data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size == 0 )
+	 || ( data_offset >= uncompressed_data_size )
+	 || ( data_size > ( uncompressed_data_size - data_offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data range value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->decompression_state == NULL )
+	{
+		if( libqcow_decompression_context_get_state(
+		     decompression_context,
+		     &( cluster_block->decompression_state ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve decompression state.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_cluster_block_allocate_buffer(
+		     cluster_block,
+		     uncompressed_data_size,
+		     &uncompressed_data,
+		     &is_pooled,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create uncompressed data.",
+			 function );
+
+			goto on_error;
+		}
+		/* The compressed data is retained until all the data is decompressed
+		 */
+		cluster_block->compressed_data      = cluster_block->data;
+		cluster_block->compressed_data_size = cluster_block->data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA ) != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA;
+		}
+		cluster_block->data      = uncompressed_data;
+		cluster_block->data_size = uncompressed_data_size;
+
+		cluster_block->pooled_data_flags &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA );
+
+		if( is_pooled != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA;
+		}
+		if( cluster_block->statistics != NULL )
+		{
+			LIBQCOW_STATISTICS_ADD( cluster_block->statistics->number_of_decompressions, 1 );
+		}
+	}
+	else if( uncompressed_data_size != cluster_block->data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid uncompressed data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	stop_data_offset = data_offset + data_size;
+
+	if( stop_data_offset <= cluster_block->decompression_state->uncompressed_data_offset )
+	{
+		return( 1 );
+	}
+	start_data_offset = cluster_block->decompression_state->uncompressed_data_offset;
+
+	if( ( cluster_block->statistics != NULL )
+	 || LIBQCOW_TRACE_IS_ENABLED( decompress ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	if( libqcow_decompression_state_decompress_data(
+	     cluster_block->decompression_state,
+	     decompression_context,
+	     cluster_block->compressed_data,
+	     cluster_block->compressed_data_size,
+	     cluster_block->data,
+	     cluster_block->data_size,
+	     stop_data_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress data.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->decompression_time, libqcow_statistics_get_timestamp() - start_timestamp );
+
+		if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 cluster_block->statistics,
+			 LIBQCOW_LATENCY_OPERATION_DECOMPRESS,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 decompress,
+		 LIBQCOW_TRACE_EVENT_DECOMPRESS,
+		 start_data_offset,
+		 cluster_block->decompression_state->uncompressed_data_offset - start_data_offset,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( cluster_block->decompression_state->is_complete == 0 )
+	{
+		return( 1 );
+	}
+	/* Data beyond the end of the compressed data is not left uninitialized
+	 */
+	if( cluster_block->decompression_state->uncompressed_data_offset < cluster_block->data_size )
+	{
+		if( memory_set(
+		     &( cluster_block->data[ cluster_block->decompression_state->uncompressed_data_offset ] ),
+		     0,
+		     cluster_block->data_size - cluster_block->decompression_state->uncompressed_data_offset ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear remainder of uncompressed data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	/* The decompression state is retained by the context for the next cluster block
+	 */
+	if( libqcow_decompression_context_release_state(
+	     decompression_context,
+	     &( cluster_block->decompression_state ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+	{
+		if( libqcow_cluster_block_free_buffer(
+		     cluster_block,
+		     &( cluster_block->compressed_data ),
+		     cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free compressed data.",
+			 function );
+
+			return( -1 );
+		}
+		cluster_block->compressed_data_size = 0;
+
+		cluster_block->pooled_data_flags &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_COMPRESSED_DATA );
+	}
+	cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED;
+
+	return( 1 );
+
+on_error:
+	libqcow_decompression_context_release_state(
+	 decompression_context,
+	 &( cluster_block->decompression_state ),
+	 NULL );
+
+	return( -1 );
+}
+
+/* Decrypts the cluster block data
+ * The encrypted data is retained in encrypted_data and the data is replaced by the decrypted data
+ * unless LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA is set, in which case the encrypted data is freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_decrypt(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_encryption_context_t *encryption_context,
+     uint64_t block_key,
+     libcerror_error_t **error )
+{
+	uint8_t *decrypted_data  = NULL;
+	static char *function    = "libqcow_cluster_block_decrypt";
+	uint64_t start_timestamp = 0;
+	uint8_t is_pooled        = 0;
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster block - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block - data already decrypted.",
+		 function );
+
+		return( -1 );
+	}
+	/* Decrypt the remaining sectors if the data was partially decrypted
+	 */
+	if( cluster_block->decrypted_sectors_bitmap != NULL )
+	{
+		if( libqcow_cluster_block_decrypt_sectors(
+		     cluster_block,
+		     encryption_context,
+		     block_key,
+		     0,
+		     cluster_block->data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to decrypt remaining sectors.",
+			 function );
+
+			return( -1 );
+		}
+		return( 1 );
+	}
+	if( libqcow_cluster_block_allocate_buffer(
+	     cluster_block,
+	     cluster_block->data_size,
+	     &decrypted_data,
+	     &is_pooled,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create decrypted data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->statistics != NULL )
+	 || LIBQCOW_TRACE_IS_ENABLED( decrypt ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	if( libqcow_encryption_crypt(
+	     encryption_context,
+	     LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT,
+	     cluster_block->data,
+	     cluster_block->data_size,
+	     decrypted_data,
+	     cluster_block->data_size,
+	     block_key,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+		 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+		 "%s: unable to decrypt data.",
+		 function );
+
+		libqcow_cluster_block_free_buffer(
+		 cluster_block,
+		 &decrypted_data,
+		 is_pooled,
+		 NULL );
+
+		return( -1 );
+	}
+	if( cluster_block->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->number_of_decryptions, 1 );
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->decryption_time, libqcow_statistics_get_timestamp() - start_timestamp );
+
+		if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 cluster_block->statistics,
+			 LIBQCOW_LATENCY_OPERATION_DECRYPT,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 decrypt,
+		 LIBQCOW_TRACE_EVENT_DECRYPT,
+		 0,
+		 cluster_block->data_size,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+	{
+		if( libqcow_cluster_block_free_buffer(
+		     cluster_block,
+		     &( cluster_block->data ),
+		     cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free encrypted data.",
+			 function );
+
+			libqcow_cluster_block_free_buffer(
+			 cluster_block,
+			 &decrypted_data,
+			 is_pooled,
+			 NULL );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		cluster_block->encrypted_data      = cluster_block->data;
+		cluster_block->encrypted_data_size = cluster_block->data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA ) != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA;
+		}
+	}
+	cluster_block->data   = decrypted_data;
+	cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED;
+
+	cluster_block->pooled_data_flags &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA );
+
+	if( is_pooled != 0 )
+	{
+		cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA;
+	}
+	return( 1 );
+}
+
+/* Decrypts the sectors of the cluster block data that contain a specific range
+ * Sectors that were decrypted before are not decrypted again
+ * The encrypted data is retained in encrypted_data until all the sectors are decrypted,
+ * after which LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED is set and the encrypted data
+ * is freed if LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA is set
+ * The block key is the key of the first sector of the cluster block
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_decrypt_sectors(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_encryption_context_t *encryption_context,
+     uint64_t block_key,
+     size_t data_offset,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	uint8_t *decrypted_data    = NULL;
+	static char *function      = "libqcow_cluster_block_decrypt_sectors";
+	size_t first_sector_index  = 0;
+	size_t last_sector_index   = 0;
+	size_t number_of_sectors   = 0;
+	size_t sector_index        = 0;
+	size_t sectors_start_index = 0;
+	uint64_t start_timestamp   = 0;
+	uint8_t is_pooled          = 0;
+
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster block - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->data_size == 0 )
+	 || ( ( cluster_block->data_size % 512 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid cluster block - unsupported data size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block - data already decrypted.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size == 0 )
+	 || ( data_offset >= cluster_block->data_size )
+	 || ( data_size > ( cluster_block->data_size - data_offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data range value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_sectors = cluster_block->data_size / 512;
+
+	if( cluster_block->decrypted_sectors_bitmap == NULL )
+	{
+		cluster_block->decrypted_sectors_bitmap = (uint8_t *) memory_allocate(
+		                                                       sizeof( uint8_t ) * ( ( number_of_sectors + 7 ) / 8 ) );
+
+		if( cluster_block->decrypted_sectors_bitmap == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create decrypted sectors bitmap.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_set(
+		     cluster_block->decrypted_sectors_bitmap,
+		     0,
+		     sizeof( uint8_t ) * ( ( number_of_sectors + 7 ) / 8 ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear decrypted sectors bitmap.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_block_allocate_buffer(
+		     cluster_block,
+		     cluster_block->data_size,
+		     &decrypted_data,
+		     &is_pooled,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create decrypted data.",
+			 function );
+
+			goto on_error;
+		}
+		/* The encrypted data is retained until all the sectors are decrypted
+		 */
+		cluster_block->encrypted_data      = cluster_block->data;
+		cluster_block->encrypted_data_size = cluster_block->data_size;
+
+		if( ( cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA ) != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA;
+		}
+		cluster_block->data = decrypted_data;
+
+		cluster_block->pooled_data_flags &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA );
+
+		if( is_pooled != 0 )
+		{
+			cluster_block->pooled_data_flags |= LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_DATA;
+		}
+		cluster_block->number_of_decrypted_sectors = 0;
+	}
+	if( ( cluster_block->statistics != NULL )
+	 || LIBQCOW_TRACE_IS_ENABLED( decrypt ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	first_sector_index = data_offset / 512;
+	last_sector_index  = ( data_offset + data_size - 1 ) / 512;
+
+	/* Consecutive sectors that have not been decrypted are decrypted at once
+	 */
+	sector_index = first_sector_index;
+
+	while( sector_index <= last_sector_index )
+	{
+		if( ( cluster_block->decrypted_sectors_bitmap[ sector_index / 8 ] & ( 1 << ( sector_index % 8 ) ) ) != 0 )
+		{
+			sector_index++;
+
+			continue;
+		}
+		sectors_start_index = sector_index;
+
+		while( ( sector_index <= last_sector_index )
+		    && ( ( cluster_block->decrypted_sectors_bitmap[ sector_index / 8 ] & ( 1 << ( sector_index % 8 ) ) ) == 0 ) )
+		{
+			cluster_block->decrypted_sectors_bitmap[ sector_index / 8 ] |= (uint8_t) ( 1 << ( sector_index % 8 ) );
+
+			sector_index++;
+		}
+		if( libqcow_encryption_crypt(
+		     encryption_context,
+		     LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT,
+		     &( cluster_block->encrypted_data[ sectors_start_index * 512 ] ),
+		     ( sector_index - sectors_start_index ) * 512,
+		     &( cluster_block->data[ sectors_start_index * 512 ] ),
+		     ( sector_index - sectors_start_index ) * 512,
+		     block_key + sectors_start_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to decrypt sectors: %" PRIzd " - %" PRIzd ".",
+			 function,
+			 sectors_start_index,
+			 sector_index - 1 );
+
+			/* Clear the bits of the sectors that failed to decrypt
+			 */
+			while( sectors_start_index < sector_index )
+			{
+				cluster_block->decrypted_sectors_bitmap[ sectors_start_index / 8 ] &= (uint8_t) ~( 1 << ( sectors_start_index % 8 ) );
+
+				sectors_start_index++;
+			}
+			return( -1 );
+		}
+		cluster_block->number_of_decrypted_sectors += sector_index - sectors_start_index;
+	}
+	if( cluster_block->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->number_of_decryptions, 1 );
+		LIBQCOW_STATISTICS_ADD( cluster_block->statistics->decryption_time, libqcow_statistics_get_timestamp() - start_timestamp );
+
+		if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( cluster_block->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 cluster_block->statistics,
+			 LIBQCOW_LATENCY_OPERATION_DECRYPT,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 decrypt,
+		 LIBQCOW_TRACE_EVENT_DECRYPT,
+		 data_offset,
+		 data_size,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( cluster_block->number_of_decrypted_sectors == number_of_sectors )
+	{
+		memory_free(
+		 cluster_block->decrypted_sectors_bitmap );
+
+		cluster_block->decrypted_sectors_bitmap = NULL;
+
+		cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED;
+
+		if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+		{
+			if( libqcow_cluster_block_free_buffer(
+			     cluster_block,
+			     &( cluster_block->encrypted_data ),
+			     cluster_block->pooled_data_flags & LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free encrypted data.",
+				 function );
+
+				return( -1 );
+			}
+			cluster_block->encrypted_data_size = 0;
+			cluster_block->pooled_data_flags  &= ~( LIBQCOW_CLUSTER_BLOCK_POOLED_DATA_FLAG_ENCRYPTED_DATA );
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( cluster_block->decrypted_sectors_bitmap != NULL )
+	{
+		memory_free(
+		 cluster_block->decrypted_sectors_bitmap );
+
+		cluster_block->decrypted_sectors_bitmap = NULL;
+	}
+	return( -1 );
+}
+
@@ -25,8 +25,12 @@
 #include <common.h>
 #include <types.h>
 
+#include "libqcow_cluster_block_pool.h"
+#include "libqcow_compression.h"
+#include "libqcow_encryption.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
+#include "libqcow_statistics.h"
 
 #if defined( __cplusplus )
 extern "C" {
@@ -40,10 +44,32 @@ struct libqcow_cluster_block
 	 */
 	uint8_t *compressed_data;
 
+	/* The compressed data size
+	 */
+	size_t compressed_data_size;
+
 	/* The encrypted data
 	 */
 	uint8_t *encrypted_data;
 
+	/* The encrypted data size
+	 */
+	size_t encrypted_data_size;
+
+	/* The decrypted sectors bitmap, which is set while
+	 * the data is decrypted per sector
+	 */
+	uint8_t *decrypted_sectors_bitmap;
+
+	/* The number of decrypted sectors
+	 */
+	size_t number_of_decrypted_sectors;
+
+	/* The decompression state, which is set while the data is decompressed
+	 * up to the part that was requested
+	 */
+	libqcow_decompression_state_t *decompression_state;
+
 	/* The data
 	 */
 	uint8_t *data;
@@ -51,23 +77,86 @@ struct libqcow_cluster_block
 	/* The data size
 	 */
 	size_t data_size;
+
+	/* The pool the data buffers are retrieved from and released to
+	 */
+	libqcow_cluster_block_pool_t *pool;
+
+	/* The pooled data flags, which indicate which buffers belong to the pool
+	 */
+	uint8_t pooled_data_flags;
+
+	/* The statistics, this value is not managed by the cluster block
+	 */
+	libqcow_statistics_t *statistics;
+
+	/* The flags
+	 */
+	uint8_t flags;
 };
 
 int libqcow_cluster_block_initialize(
      libqcow_cluster_block_t **cluster_block,
      size_t data_size,
+     libqcow_cluster_block_pool_t *pool,
      libcerror_error_t **error );
 
 int libqcow_cluster_block_free(
      libqcow_cluster_block_t **cluster_block,
      libcerror_error_t **error );
 
+int libqcow_cluster_block_allocate_buffer(
+     libqcow_cluster_block_t *cluster_block,
+     size_t buffer_size,
+     uint8_t **buffer,
+     uint8_t *is_pooled,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_free_buffer(
+     libqcow_cluster_block_t *cluster_block,
+     uint8_t **buffer,
+     uint8_t is_pooled,
+     libcerror_error_t **error );
+
 int libqcow_cluster_block_read(
      libqcow_cluster_block_t *cluster_block,
      libbfio_handle_t *file_io_handle,
      off64_t cluster_offset,
      libcerror_error_t **error );
 
+int libqcow_cluster_block_get_memory_usage(
+     libqcow_cluster_block_t *cluster_block,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_decompress(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_decompression_context_t *decompression_context,
+     size_t uncompressed_data_size,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_decompress_range(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_decompression_context_t *decompression_context,
+     size_t uncompressed_data_size,
+     size_t data_offset,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_decrypt(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_encryption_context_t *encryption_context,
+     uint64_t block_key,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_decrypt_sectors(
+     libqcow_cluster_block_t *cluster_block,
+     libqcow_encryption_context_t *encryption_context,
+     uint64_t block_key,
+     size_t data_offset,
+     size_t data_size,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
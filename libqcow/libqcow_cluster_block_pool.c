@@ -0,0 +1,798 @@
+/*
+ * Cluster block pool functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_arena.h"
+#include "libqcow_cluster_block_pool.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+/* Allocates an aligned buffer
+ * The buffer is over allocated and the original allocation is stored
+ * directly in front of the aligned buffer
+ * Returns a pointer to the buffer or NULL on error
+ */
+static uint8_t *libqcow_cluster_block_pool_allocate_buffer(
+                 libqcow_cluster_block_pool_t *cluster_block_pool )
+{
+	uint8_t *allocation = NULL;
+	uint8_t *buffer     = NULL;
+	intptr_t address    = 0;
+
+	allocation = (uint8_t *) memory_allocate(
+	                          cluster_block_pool->buffer_size + cluster_block_pool->buffer_alignment + sizeof( uint8_t * ) );
+
+	if( allocation == NULL )
+	{
+		return( NULL );
+	}
+	address  = (intptr_t) ( allocation + sizeof( uint8_t * ) + cluster_block_pool->buffer_alignment - 1 );
+	address &= ~( (intptr_t) cluster_block_pool->buffer_alignment - 1 );
+	buffer   = (uint8_t *) address;
+
+	( (uint8_t **) buffer )[ -1 ] = allocation;
+
+	return( buffer );
+}
+
+/* Frees an aligned buffer
+ */
+static void libqcow_cluster_block_pool_free_buffer(
+             uint8_t *buffer )
+{
+	memory_free(
+	 ( (uint8_t **) buffer )[ -1 ] );
+}
+
+/* Creates a cluster block pool
+ * Make sure the value cluster_block_pool is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_initialize(
+     libqcow_cluster_block_pool_t **cluster_block_pool,
+     size_t buffer_size,
+     int maximum_number_of_buffers,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_initialize";
+	size_t array_size     = 0;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_block_pool != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block pool value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( buffer_size == 0 )
+	 || ( buffer_size > ( (size_t) SSIZE_MAX - LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE - sizeof( uint8_t * ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid buffer size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_buffers <= 0 )
+	 || ( (size_t) maximum_number_of_buffers > ( (size_t) SSIZE_MAX / sizeof( uint8_t * ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of buffers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*cluster_block_pool = memory_allocate_structure(
+	                       libqcow_cluster_block_pool_t );
+
+	if( *cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block pool.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *cluster_block_pool,
+	     0,
+	     sizeof( libqcow_cluster_block_pool_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cluster block pool.",
+		 function );
+
+		memory_free(
+		 *cluster_block_pool );
+
+		*cluster_block_pool = NULL;
+
+		return( -1 );
+	}
+	array_size = sizeof( uint8_t * ) * (size_t) maximum_number_of_buffers;
+
+	( *cluster_block_pool )->buffers = (uint8_t **) memory_allocate(
+	                                                 array_size );
+
+	if( ( *cluster_block_pool )->buffers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buffers array.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *cluster_block_pool )->buffers,
+	     0,
+	     array_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear buffers array.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *cluster_block_pool )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	/* Buffers of a page or more are page aligned, smaller buffers are aligned
+	 * to a cache line so that different buffers do not share cache lines
+	 */
+	if( buffer_size >= LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE )
+	{
+		( *cluster_block_pool )->buffer_alignment = LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE;
+	}
+	else
+	{
+		( *cluster_block_pool )->buffer_alignment = LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_CACHE_LINE;
+	}
+	( *cluster_block_pool )->buffer_size               = buffer_size;
+	( *cluster_block_pool )->maximum_number_of_buffers = maximum_number_of_buffers;
+
+	return( 1 );
+
+on_error:
+	if( *cluster_block_pool != NULL )
+	{
+		if( ( *cluster_block_pool )->buffers != NULL )
+		{
+			memory_free(
+			 ( *cluster_block_pool )->buffers );
+		}
+		memory_free(
+		 *cluster_block_pool );
+
+		*cluster_block_pool = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a cluster block pool and the buffers it holds
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_free(
+     libqcow_cluster_block_pool_t **cluster_block_pool,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_free";
+	int buffer_index      = 0;
+	int result            = 1;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_block_pool != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *cluster_block_pool )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		for( buffer_index = 0;
+		     buffer_index < ( *cluster_block_pool )->number_of_buffers;
+		     buffer_index++ )
+		{
+			if( libqcow_arena_contains(
+			     ( *cluster_block_pool )->arena,
+			     ( *cluster_block_pool )->buffers[ buffer_index ] ) == 0 )
+			{
+				libqcow_cluster_block_pool_free_buffer(
+				 ( *cluster_block_pool )->buffers[ buffer_index ] );
+			}
+		}
+		memory_free(
+		 ( *cluster_block_pool )->buffers );
+
+		if( libqcow_arena_free(
+		     &( ( *cluster_block_pool )->arena ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free arena.",
+			 function );
+
+			result = -1;
+		}
+
+		memory_free(
+		 *cluster_block_pool );
+
+		*cluster_block_pool = NULL;
+	}
+	return( result );
+}
+
+/* Creates the arena of the pool
+ * The arena provides the buffers in a single region of memory, backed by huge pages
+ * where supported, before buffers are allocated individually
+ * This function should be called before the pool is used
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_initialize_arena(
+     libqcow_cluster_block_pool_t *cluster_block_pool,
+     int number_of_buffers,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_initialize_arena";
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_pool->arena != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block pool - arena value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_arena_initialize(
+	     &( cluster_block_pool->arena ),
+	     cluster_block_pool->buffer_size,
+	     cluster_block_pool->buffer_alignment,
+	     number_of_buffers,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create arena.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Clears the pool
+ * Frees the pooled buffers, buffers that are in use are not affected
+ * Pooled buffers of the arena are released back into the arena
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_clear(
+     libqcow_cluster_block_pool_t *cluster_block_pool,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_clear";
+	int buffer_index      = 0;
+	int release_result    = 0;
+	int result            = 1;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	for( buffer_index = 0;
+	     buffer_index < cluster_block_pool->number_of_buffers;
+	     buffer_index++ )
+	{
+		release_result = 0;
+
+		if( cluster_block_pool->arena != NULL )
+		{
+			release_result = libqcow_arena_release_slot(
+			                  cluster_block_pool->arena,
+			                  cluster_block_pool->buffers[ buffer_index ],
+			                  error );
+		}
+		if( release_result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release buffer: %d to arena.",
+			 function,
+			 buffer_index );
+
+			result = -1;
+		}
+		else if( release_result == 0 )
+		{
+			libqcow_cluster_block_pool_free_buffer(
+			 cluster_block_pool->buffers[ buffer_index ] );
+		}
+		cluster_block_pool->buffers[ buffer_index ] = NULL;
+	}
+	cluster_block_pool->number_of_buffers = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves a buffer from the pool
+ * The buffer is taken from the arena when the pool is empty
+ * and allocated when there is no arena or the arena is full
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_get_buffer(
+     libqcow_cluster_block_pool_t *cluster_block_pool,
+     uint8_t **buffer,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_get_buffer";
+	int result            = 1;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	*buffer = NULL;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( cluster_block_pool->number_of_buffers > 0 )
+	{
+		cluster_block_pool->number_of_buffers -= 1;
+
+		*buffer = cluster_block_pool->buffers[ cluster_block_pool->number_of_buffers ];
+
+		cluster_block_pool->buffers[ cluster_block_pool->number_of_buffers ] = NULL;
+	}
+	else if( cluster_block_pool->arena != NULL )
+	{
+		if( libqcow_arena_get_slot(
+		     cluster_block_pool->arena,
+		     buffer,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve buffer from arena.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( result != 1 )
+	{
+		return( -1 );
+	}
+	if( *buffer == NULL )
+	{
+		*buffer = libqcow_cluster_block_pool_allocate_buffer(
+		           cluster_block_pool );
+
+		if( *buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create buffer.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+on_error:
+	/* A buffer of the arena can only be released back into the arena
+	 * while holding the mutex, hence it is left unused
+	 */
+	if( ( *buffer != NULL )
+	 && ( libqcow_arena_contains(
+	       cluster_block_pool->arena,
+	       *buffer ) == 0 ) )
+	{
+		libqcow_cluster_block_pool_free_buffer(
+		 *buffer );
+	}
+	*buffer = NULL;
+
+	return( -1 );
+#endif
+}
+
+/* Releases a buffer back into the pool
+ * The buffer is released back into the arena or freed when the pool is full
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_release_buffer(
+     libqcow_cluster_block_pool_t *cluster_block_pool,
+     uint8_t **buffer,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_pool_release_buffer";
+	int result            = 0;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( *buffer == NULL )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( cluster_block_pool->number_of_buffers < cluster_block_pool->maximum_number_of_buffers )
+	{
+		cluster_block_pool->buffers[ cluster_block_pool->number_of_buffers ] = *buffer;
+
+		cluster_block_pool->number_of_buffers += 1;
+
+		*buffer = NULL;
+	}
+	else if( cluster_block_pool->arena != NULL )
+	{
+		result = libqcow_arena_release_slot(
+		          cluster_block_pool->arena,
+		          *buffer,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release buffer to arena.",
+			 function );
+		}
+		else if( result == 1 )
+		{
+			*buffer = NULL;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result == -1 )
+	{
+		return( -1 );
+	}
+	if( *buffer != NULL )
+	{
+		libqcow_cluster_block_pool_free_buffer(
+		 *buffer );
+
+		*buffer = NULL;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the pool, its pooled buffers and the free slots
+ * of its arena in bytes including the padding used to align the buffers
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_pool_get_memory_usage(
+     libqcow_cluster_block_pool_t *cluster_block_pool,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function     = "libqcow_cluster_block_pool_get_memory_usage";
+	size_t arena_memory_usage = 0;
+	int result                = 1;
+
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*memory_usage = sizeof( libqcow_cluster_block_pool_t )
+	              + ( sizeof( uint8_t * ) * cluster_block_pool->maximum_number_of_buffers )
+	              + ( ( cluster_block_pool->buffer_size + cluster_block_pool->buffer_alignment + sizeof( uint8_t * ) ) * cluster_block_pool->number_of_buffers );
+
+	if( cluster_block_pool->arena != NULL )
+	{
+		if( libqcow_arena_get_memory_usage(
+		     cluster_block_pool->arena,
+		     &arena_memory_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of arena.",
+			 function );
+
+			result = -1;
+		}
+		else
+		{
+			*memory_usage += arena_memory_usage;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_block_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
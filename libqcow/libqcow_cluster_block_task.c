@@ -0,0 +1,447 @@
+/*
+ * Cluster block task functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cluster_block.h"
+#include "libqcow_cluster_block_task.h"
+#include "libqcow_compression.h"
+#include "libqcow_definitions.h"
+#include "libqcow_encryption.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_numa.h"
+
+/* Creates a cluster block task
+ * Make sure the value cluster_block_task is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_task_initialize(
+     libqcow_cluster_block_task_t **cluster_block_task,
+     libqcow_cluster_block_t *cluster_block,
+     size_t uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_task_initialize";
+
+	if( cluster_block_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block task.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_block_task != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster block task value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid uncompressed data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	*cluster_block_task = memory_allocate_structure(
+	                       libqcow_cluster_block_task_t );
+
+	if( *cluster_block_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block task.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *cluster_block_task,
+	     0,
+	     sizeof( libqcow_cluster_block_task_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cluster block task.",
+		 function );
+
+		goto on_error;
+	}
+	( *cluster_block_task )->cluster_block          = cluster_block;
+	( *cluster_block_task )->uncompressed_data_size = uncompressed_data_size;
+
+	return( 1 );
+
+on_error:
+	if( *cluster_block_task != NULL )
+	{
+		memory_free(
+		 *cluster_block_task );
+
+		*cluster_block_task = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a cluster block task
+ * The cluster block is not freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_task_free(
+     libqcow_cluster_block_task_t **cluster_block_task,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_block_task_free";
+
+	if( cluster_block_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block task.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_block_task != NULL )
+	{
+		memory_free(
+		 *cluster_block_task );
+
+		*cluster_block_task = NULL;
+	}
+	return( 1 );
+}
+
+/* Processes a cluster block task
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_task_process(
+     libqcow_cluster_block_task_t *cluster_block_task,
+     libcerror_error_t **error )
+{
+	libqcow_encryption_context_t *encryption_context = NULL;
+	static char *function                            = "libqcow_cluster_block_task_process";
+
+	if( cluster_block_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block task.",
+		 function );
+
+		return( -1 );
+	}
+	/* The encryption context of the file is used if it can be used by multiple
+	 * threads at the same time, otherwise the encryption context is created per
+	 * task since the (AES) contexts can maintain state between calls
+	 */
+	if( cluster_block_task->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		if( ( cluster_block_task->encryption_context != NULL )
+		 && ( cluster_block_task->encryption_context->is_thread_safe != 0 ) )
+		{
+			if( libqcow_encryption_reference(
+			     cluster_block_task->encryption_context,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to reference encryption context.",
+				 function );
+
+				goto on_error;
+			}
+			encryption_context = cluster_block_task->encryption_context;
+		}
+		else
+		{
+			if( libqcow_encryption_initialize(
+			     &encryption_context,
+			     cluster_block_task->encryption_method,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create encryption context.",
+				 function );
+
+				goto on_error;
+			}
+			if( libqcow_encryption_set_keys(
+			     encryption_context,
+			     cluster_block_task->key_data,
+			     cluster_block_task->key_data_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set key data in encryption context.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		if( libqcow_cluster_block_decrypt(
+		     cluster_block_task->cluster_block,
+		     encryption_context,
+		     cluster_block_task->block_key,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to decrypt cluster block.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_encryption_free(
+		     &encryption_context,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free encryption context.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( cluster_block_task->uncompressed_data_size != 0 )
+	{
+		if( libqcow_cluster_block_decompress(
+		     cluster_block_task->cluster_block,
+		     cluster_block_task->decompression_context,
+		     cluster_block_task->uncompressed_data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: unable to decompress cluster block.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( encryption_context != NULL )
+	{
+		libqcow_encryption_free(
+		 &encryption_context,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Processes a cluster block task from a thread pool
+ * A decompression context is taken from the decompression context queue for
+ * the duration of the task, since the queue contains a decompression context
+ * per thread this does not block
+ * The result is stored in the task and the task is pushed onto the completed queue
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_block_task_thread_pool_callback(
+     libqcow_cluster_block_task_t *cluster_block_task,
+     libcthreads_queue_t *decompression_context_queue )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "libqcow_cluster_block_task_thread_pool_callback";
+	int node_index           = 0;
+
+	if( cluster_block_task == NULL )
+	{
+		return( -1 );
+	}
+	cluster_block_task->result = 1;
+
+	/* The worker threads of a NUMA node are bound to the node when they process their first task,
+	 * so that the buffers they write first are placed in the memory of the node
+	 */
+	if( cluster_block_task->numa_topology != NULL )
+	{
+		if( libqcow_numa_topology_get_current_node(
+		     cluster_block_task->numa_topology,
+		     &node_index,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve current NUMA node.",
+			 function );
+
+			cluster_block_task->result = -1;
+		}
+		else if( node_index != cluster_block_task->numa_node )
+		{
+			if( libqcow_numa_topology_bind_thread(
+			     cluster_block_task->numa_topology,
+			     cluster_block_task->numa_node,
+			     &error ) == -1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to bind thread to NUMA node: %d.",
+				 function,
+				 cluster_block_task->numa_node );
+
+				cluster_block_task->result = -1;
+			}
+		}
+	}
+	if( ( cluster_block_task->result == 1 )
+	 && ( cluster_block_task->uncompressed_data_size != 0 )
+	 && ( decompression_context_queue != NULL ) )
+	{
+		if( libcthreads_queue_pop(
+		     decompression_context_queue,
+		     (intptr_t **) &( cluster_block_task->decompression_context ),
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to pop decompression context from queue.",
+			 function );
+
+			cluster_block_task->result = -1;
+		}
+	}
+	if( cluster_block_task->result == 1 )
+	{
+		cluster_block_task->result = libqcow_cluster_block_task_process(
+		                              cluster_block_task,
+		                              &error );
+	}
+	if( cluster_block_task->decompression_context != NULL )
+	{
+		if( libcthreads_queue_push(
+		     decompression_context_queue,
+		     (intptr_t *) cluster_block_task->decompression_context,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to push decompression context onto queue.",
+			 function );
+
+			cluster_block_task->result = -1;
+		}
+		cluster_block_task->decompression_context = NULL;
+	}
+	if( cluster_block_task->result != 1 )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+	}
+	if( libcthreads_queue_push(
+	     cluster_block_task->completed_queue,
+	     (intptr_t *) cluster_block_task,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+		 "%s: unable to push cluster block task onto completed queue.",
+		 function );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
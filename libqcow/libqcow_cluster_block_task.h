@@ -0,0 +1,122 @@
+/*
+ * Cluster block task functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CLUSTER_BLOCK_TASK_H )
+#define _LIBQCOW_CLUSTER_BLOCK_TASK_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_cluster_block.h"
+#include "libqcow_compression.h"
+#include "libqcow_encryption.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_numa.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_cluster_block_task libqcow_cluster_block_task_t;
+
+struct libqcow_cluster_block_task
+{
+	/* The cluster block
+	 */
+	libqcow_cluster_block_t *cluster_block;
+
+	/* The uncompressed data size, 0 if the cluster block is not compressed
+	 */
+	size_t uncompressed_data_size;
+
+	/* The decompression context
+	 */
+	libqcow_decompression_context_t *decompression_context;
+
+	/* The encryption method
+	 */
+	uint32_t encryption_method;
+
+	/* The encryption context of the file, which is used by the task if it
+	 * can be used by multiple threads
+	 */
+	libqcow_encryption_context_t *encryption_context;
+
+	/* The key data, which is used to create an encryption context per task otherwise
+	 */
+	const uint8_t *key_data;
+
+	/* The key data size
+	 */
+	size_t key_data_size;
+
+	/* The block key of the first sector of the cluster block
+	 */
+	uint64_t block_key;
+
+	/* The result of the task
+	 */
+	int result;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The queue the task is pushed onto when it has been processed
+	 */
+	libcthreads_queue_t *completed_queue;
+
+	/* The NUMA topology, which is set when the task is processed by a worker thread of a specific node
+	 */
+	libqcow_numa_topology_t *numa_topology;
+
+	/* The NUMA node the task is processed on
+	 */
+	int numa_node;
+#endif
+};
+
+int libqcow_cluster_block_task_initialize(
+     libqcow_cluster_block_task_t **cluster_block_task,
+     libqcow_cluster_block_t *cluster_block,
+     size_t uncompressed_data_size,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_task_free(
+     libqcow_cluster_block_task_t **cluster_block_task,
+     libcerror_error_t **error );
+
+int libqcow_cluster_block_task_process(
+     libqcow_cluster_block_task_t *cluster_block_task,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_cluster_block_task_thread_pool_callback(
+     libqcow_cluster_block_task_t *cluster_block_task,
+     libcthreads_queue_t *decompression_context_queue );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CLUSTER_BLOCK_TASK_H ) */
+
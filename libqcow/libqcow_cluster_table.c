@@ -24,7 +24,9 @@
 #include <memory.h>
 #include <types.h>
 
+#include "libqcow_byte_swap.h"
 #include "libqcow_cluster_table.h"
+#include "libqcow_cluster_table_pool.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libcnotify.h"
@@ -110,6 +112,7 @@ int libqcow_cluster_table_free(
      libcerror_error_t **error )
 {
 	static char *function = "libqcow_cluster_table_free";
+	int result            = 1;
 
 	if( cluster_table == NULL )
 	{
@@ -124,17 +127,25 @@ int libqcow_cluster_table_free(
 	}
 	if( *cluster_table != NULL )
 	{
-		if( ( *cluster_table )->references != NULL )
+		if( libqcow_cluster_table_free_references(
+		     *cluster_table,
+		     error ) != 1 )
 		{
-			memory_free(
-			 ( *cluster_table )->references );
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free references.",
+			 function );
+
+			result = -1;
 		}
 		memory_free(
 		 *cluster_table );
 
 		*cluster_table = NULL;
 	}
-	return( 1 );
+	return( result );
 }
 
 /* Retrieves the number of references in the cluster table
@@ -175,6 +186,7 @@ int libqcow_cluster_table_get_number_of_references(
 }
 
 /* Retrieves a specific reference from the cluster table
+ * A reference that is decoded on access is converted to host byte order
  * Returns 1 if successful or -1 on error
  */
 int libqcow_cluster_table_get_reference_by_index(
@@ -230,26 +242,31 @@ int libqcow_cluster_table_get_reference_by_index(
 
 		return( -1 );
 	}
-	*reference = cluster_table->references[ reference_index ];
-
+	if( cluster_table->decode_on_access != 0 )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 (uint8_t *) &( cluster_table->references[ reference_index ] ),
+		 *reference );
+	}
+	else
+	{
+		*reference = cluster_table->references[ reference_index ];
+	}
 	return( 1 );
 }
 
-/* Reads the cluster table
+/* Retrieves the memory usage
+ * The memory usage is the size of the cluster table and its references in bytes
  * Returns 1 if successful or -1 on error
  */
-int libqcow_cluster_table_read(
+int libqcow_cluster_table_get_memory_usage(
      libqcow_cluster_table_t *cluster_table,
-     libbfio_handle_t *file_io_handle,
-     off64_t file_offset,
-     size_t cluster_table_size,
+     size_t *memory_usage,
      libcerror_error_t **error )
 {
-	uint8_t *cluster_table_data      = NULL;
-	static char *function            = "libqcow_cluster_table_read";
-	size_t cluster_table_data_offset = 0;
-	ssize_t read_count               = 0;
-	int cluster_table_index          = 0;
+	static char *function   = "libqcow_cluster_table_get_memory_usage";
+	size_t page_data_offset = 0;
+	int page_index          = 0;
 
 	if( cluster_table == NULL )
 	{
@@ -262,7 +279,73 @@ int libqcow_cluster_table_read(
 
 		return( -1 );
 	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_cluster_table_t );
+
 	if( cluster_table->references != NULL )
+	{
+		*memory_usage += sizeof( uint64_t ) * (size_t) cluster_table->number_of_references;
+	}
+	if( cluster_table->pages != NULL )
+	{
+		*memory_usage += sizeof( uint64_t * ) * (size_t) cluster_table->number_of_pages;
+
+		for( page_index = 0;
+		     page_index < cluster_table->number_of_pages;
+		     page_index++ )
+		{
+			if( cluster_table->pages[ page_index ] != NULL )
+			{
+				page_data_offset = (size_t) page_index * cluster_table->page_size;
+
+				if( cluster_table->page_size > ( cluster_table->table_size - page_data_offset ) )
+				{
+					*memory_usage += cluster_table->table_size - page_data_offset;
+				}
+				else
+				{
+					*memory_usage += cluster_table->page_size;
+				}
+			}
+		}
+	}
+	return( 1 );
+}
+
+/* Allocates the references
+ * The references are retrieved from the pool if set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_allocate_references(
+     libqcow_cluster_table_t *cluster_table,
+     size_t references_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_allocate_references";
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_table->references != NULL )
+	 || ( cluster_table->pages != NULL ) )
 	{
 		libcerror_error_set(
 		 error,
@@ -273,29 +356,29 @@ int libqcow_cluster_table_read(
 
 		return( -1 );
 	}
-	if( cluster_table_size > (size_t) SSIZE_MAX )
+	if( references_size > (size_t) SSIZE_MAX )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid cluster table size value exceeds maximum.",
+		 "%s: invalid references size value exceeds maximum.",
 		 function );
 
 		return( -1 );
 	}
-	if( ( cluster_table_size % 8 ) != 0 )
+	if( ( references_size % 8 ) != 0 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: unsupported cluster table size value - value not a multitude of 8.",
+		 "%s: unsupported references size value - value not a multitude of 8.",
 		 function );
 
 		return( -1 );
 	}
-	if( ( cluster_table_size / 8 ) > (size_t) INT_MAX )
+	if( ( references_size / 8 ) > (size_t) INT_MAX )
 	{
 		libcerror_error_set(
 		 error,
@@ -306,78 +389,80 @@ int libqcow_cluster_table_read(
 
 		return( -1 );
 	}
-	cluster_table->number_of_references = (int) ( cluster_table_size / 8 );
-
-	cluster_table->references = (uint64_t *) memory_allocate(
-	                                          cluster_table_size );
-
-	if( cluster_table->references == NULL )
+	if( cluster_table->pool != NULL )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
-		 "%s: unable to create references.",
-		 function );
+		if( libqcow_cluster_table_pool_get_references(
+		     cluster_table->pool,
+		     references_size,
+		     &( cluster_table->references ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve references from pool.",
+			 function );
 
-		goto on_error;
-	}
-#if defined( HAVE_DEBUG_OUTPUT )
-	if( libcnotify_verbose != 0 )
-	{
-		libcnotify_printf(
-		 "%s: reading cluster table at offset: %" PRIi64 " (0x%08" PRIx64 ")\n",
-		 function,
-		 file_offset,
-		 file_offset );
+			return( -1 );
+		}
 	}
-#endif
-	if( libbfio_handle_seek_offset(
-	     file_io_handle,
-	     file_offset,
-	     SEEK_SET,
-	     error ) == -1 )
+	else
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek cluster table offset: %" PRIi64 ".",
-		 function,
-		 file_offset );
+		cluster_table->references = libqcow_cluster_table_pool_allocate_references(
+		                             references_size );
 
-		goto on_error;
+		if( cluster_table->references == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create references.",
+			 function );
+
+			return( -1 );
+		}
 	}
-	cluster_table_data = (uint8_t *) memory_allocate(
-	                                  cluster_table_size );
+	cluster_table->number_of_references = (int) ( references_size / 8 );
+
+	return( 1 );
+}
+
+/* Decodes the references that were stored in big-endian in place
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_decode_references(
+     libqcow_cluster_table_t *cluster_table,
+     libcerror_error_t **error )
+{
+	static char *function   = "libqcow_cluster_table_decode_references";
 
-	if( cluster_table_data == NULL )
+#if defined( HAVE_DEBUG_OUTPUT )
+	int cluster_table_index = 0;
+#endif
+
+	if( cluster_table == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
-		 "%s: unable to create cluster table data.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	read_count = libbfio_handle_read_buffer(
-	              file_io_handle,
-	              cluster_table_data,
-	              cluster_table_size,
-	              error );
-
-	if( read_count != (ssize_t) cluster_table_size )
+	if( cluster_table->references == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read cluster table.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster table - missing references.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
 #if defined( HAVE_DEBUG_OUTPUT )
 	if( libcnotify_verbose != 0 )
@@ -386,23 +471,31 @@ int libqcow_cluster_table_read(
 		 "%s: cluster table data:\n",
 		 function );
 		libcnotify_print_data(
-		 cluster_table_data,
-		 cluster_table_size,
+		 (uint8_t *) cluster_table->references,
+		 (size_t) cluster_table->number_of_references * 8,
 		 LIBCNOTIFY_PRINT_DATA_FLAG_GROUP_DATA );
 	}
 #endif
-	for( cluster_table_index = 0;
-	     cluster_table_index < cluster_table->number_of_references;
-	     cluster_table_index++ )
+	if( libqcow_byte_swap_uint64_big_endian(
+	     cluster_table->references,
+	     (size_t) cluster_table->number_of_references,
+	     error ) != 1 )
 	{
-		byte_stream_copy_to_uint64_big_endian(
-		 &( cluster_table_data[ cluster_table_data_offset ] ),
-		 ( cluster_table->references )[ cluster_table_index ] );
-
-		cluster_table_data_offset += 8;
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to convert references to host byte order.",
+		 function );
 
+		return( -1 );
+	}
 #if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
+	if( libcnotify_verbose != 0 )
+	{
+		for( cluster_table_index = 0;
+		     cluster_table_index < cluster_table->number_of_references;
+		     cluster_table_index++ )
 		{
 			libcnotify_printf(
 			 "%s: cluster table reference: %03d\t\t: 0x%08" PRIx64 "\n",
@@ -410,35 +503,900 @@ int libqcow_cluster_table_read(
 			 cluster_table_index,
 			 ( cluster_table->references )[ cluster_table_index ] );
 		}
-#endif
-	}
-#if defined( HAVE_DEBUG_OUTPUT )
-	if( libcnotify_verbose != 0 )
-	{
 		libcnotify_printf(
 		 "\n" );
 	}
 #endif
-	memory_free(
-	 cluster_table_data );
+	return( 1 );
+}
 
-	cluster_table_data = NULL;
+/* Frees the references
+ * The references are released to the pool if set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_free_references(
+     libqcow_cluster_table_t *cluster_table,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_free_references";
+	int page_index        = 0;
+	int result            = 1;
 
-	return( 1 );
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
 
-on_error:
-	if( cluster_table_data != NULL )
+		return( -1 );
+	}
+	if( cluster_table->references != NULL )
+	{
+		if( cluster_table->pool != NULL )
+		{
+			if( libqcow_cluster_table_pool_release_references(
+			     cluster_table->pool,
+			     &( cluster_table->references ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to release references.",
+				 function );
+
+				result = -1;
+			}
+		}
+		else
+		{
+			libqcow_cluster_table_pool_free_references(
+			 cluster_table->references );
+		}
+		cluster_table->references = NULL;
+	}
+	if( cluster_table->pages != NULL )
 	{
+		for( page_index = 0;
+		     page_index < cluster_table->number_of_pages;
+		     page_index++ )
+		{
+			if( cluster_table->pages[ page_index ] != NULL )
+			{
+				libqcow_cluster_table_pool_free_references(
+				 cluster_table->pages[ page_index ] );
+			}
+		}
 		memory_free(
-		 cluster_table_data );
+		 cluster_table->pages );
+
+		cluster_table->pages = NULL;
+	}
+	cluster_table->number_of_references = 0;
+	cluster_table->file_offset          = 0;
+	cluster_table->table_size           = 0;
+	cluster_table->page_size            = 0;
+	cluster_table->number_of_pages      = 0;
+
+	return( result );
+}
+
+/* Reads the cluster table data
+ * The references are decoded unless decode_on_access is set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read_data(
+     libqcow_cluster_table_t *cluster_table,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_read_data";
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
 	}
 	if( cluster_table->references != NULL )
 	{
-		memory_free(
-		 cluster_table->references );
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table - references already set.",
+		 function );
 
-		cluster_table->references = NULL;
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_allocate_references(
+	     cluster_table,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create references.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     cluster_table->references,
+	     data,
+	     data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy cluster table data.",
+		 function );
+
+		goto on_error;
+	}
+	/* References that are decoded on access are retained as stored
+	 */
+	if( ( cluster_table->decode_on_access == 0 )
+	 && ( libqcow_cluster_table_decode_references(
+	       cluster_table,
+	       error ) != 1 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to decode references.",
+		 function );
+
+		goto on_error;
 	}
+	return( 1 );
+
+on_error:
+	libqcow_cluster_table_free_references(
+	 cluster_table,
+	 NULL );
+
 	return( -1 );
 }
 
+/* Reads the cluster table
+ * The cluster table is read directly into the references and decoded in place
+ * unless decode_on_access is set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size_t cluster_table_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_read";
+	ssize_t read_count    = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->references != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table - references already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid cluster table size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: reading cluster table at offset: %" PRIi64 " (0x%08" PRIx64 ")\n",
+		 function,
+		 file_offset,
+		 file_offset );
+	}
+#endif
+	if( libbfio_handle_seek_offset(
+	     file_io_handle,
+	     file_offset,
+	     SEEK_SET,
+	     error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek cluster table offset: %" PRIi64 ".",
+		 function,
+		 file_offset );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_allocate_references(
+	     cluster_table,
+	     cluster_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create references.",
+		 function );
+
+		return( -1 );
+	}
+	read_count = libbfio_handle_read_buffer(
+	              file_io_handle,
+	              (uint8_t *) cluster_table->references,
+	              cluster_table_size,
+	              error );
+
+	if( read_count != (ssize_t) cluster_table_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster table.",
+		 function );
+
+		goto on_error;
+	}
+	/* References that are decoded on access are retained as stored
+	 */
+	if( ( cluster_table->decode_on_access == 0 )
+	 && ( libqcow_cluster_table_decode_references(
+	       cluster_table,
+	       error ) != 1 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to decode references.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	libqcow_cluster_table_free_references(
+	 cluster_table,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Sets up the cluster table to be read on demand
+ * The references are read in pages of page size on their first use
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read_on_demand(
+     libqcow_cluster_table_t *cluster_table,
+     off64_t file_offset,
+     size_t cluster_table_size,
+     size_t page_size,
+     libcerror_error_t **error )
+{
+	static char *function  = "libqcow_cluster_table_read_on_demand";
+	size_t number_of_pages = 0;
+	size_t pages_size      = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_table->references != NULL )
+	 || ( cluster_table->pages != NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table - references already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid cluster table size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_table_size % 8 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported cluster table size value - value not a multitude of 8.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_table_size / 8 ) > (size_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid number of references value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( page_size == 0 )
+	 || ( ( page_size % 8 ) != 0 )
+	 || ( page_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported page size.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table_size == 0 )
+	{
+		return( 1 );
+	}
+	number_of_pages = cluster_table_size / page_size;
+
+	if( ( cluster_table_size % page_size ) != 0 )
+	{
+		number_of_pages++;
+	}
+	pages_size = sizeof( uint64_t * ) * number_of_pages;
+
+	cluster_table->pages = (uint64_t **) memory_allocate(
+	                                      pages_size );
+
+	if( cluster_table->pages == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create pages.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     cluster_table->pages,
+	     0,
+	     pages_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear pages.",
+		 function );
+
+		memory_free(
+		 cluster_table->pages );
+
+		cluster_table->pages = NULL;
+
+		return( -1 );
+	}
+	cluster_table->file_offset          = file_offset;
+	cluster_table->table_size           = cluster_table_size;
+	cluster_table->page_size            = page_size;
+	cluster_table->number_of_pages      = (int) number_of_pages;
+	cluster_table->number_of_references = (int) ( cluster_table_size / 8 );
+
+	return( 1 );
+}
+
+/* Reads a specific page of a cluster table that is read on demand
+ * The page is read directly into its references and decoded in place
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read_page(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     int page_index,
+     libcerror_error_t **error )
+{
+	uint64_t *page_references = NULL;
+	static char *function     = "libqcow_cluster_table_read_page";
+	size_t page_data_offset   = 0;
+	size_t page_data_size     = 0;
+	ssize_t read_count        = 0;
+	off64_t page_file_offset  = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster table - missing pages.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( page_index < 0 )
+	 || ( page_index >= cluster_table->number_of_pages ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid page index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages[ page_index ] != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table - page: %d already set.",
+		 function,
+		 page_index );
+
+		return( -1 );
+	}
+	page_data_offset = (size_t) page_index * cluster_table->page_size;
+	page_data_size   = cluster_table->page_size;
+
+	/* The last page is smaller when the cluster table size is not a multitude of the page size
+	 */
+	if( page_data_size > ( cluster_table->table_size - page_data_offset ) )
+	{
+		page_data_size = cluster_table->table_size - page_data_offset;
+	}
+	page_file_offset = cluster_table->file_offset + (off64_t) page_data_offset;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: reading cluster table page: %d at offset: %" PRIi64 " (0x%08" PRIx64 ")\n",
+		 function,
+		 page_index,
+		 page_file_offset,
+		 page_file_offset );
+	}
+#endif
+	page_references = libqcow_cluster_table_pool_allocate_references(
+	                   page_data_size );
+
+	if( page_references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create page references.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) page_references,
+	              page_data_size,
+	              page_file_offset,
+	              error );
+
+	if( read_count != (ssize_t) page_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster table page: %d at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 page_index,
+		 page_file_offset,
+		 page_file_offset );
+
+		goto on_error;
+	}
+	if( libqcow_byte_swap_uint64_big_endian(
+	     page_references,
+	     page_data_size / 8,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to convert page references to host byte order.",
+		 function );
+
+		goto on_error;
+	}
+	cluster_table->pages[ page_index ] = page_references;
+
+	return( 1 );
+
+on_error:
+	if( page_references != NULL )
+	{
+		libqcow_cluster_table_pool_free_references(
+		 page_references );
+	}
+	return( -1 );
+}
+
+/* Retrieves a specific reference from the cluster table
+ * The page containing the reference is read first when the cluster table is read on demand
+ * This function is not multi-thread safe, the pages are read without locking
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     int reference_index,
+     uint64_t *reference,
+     libcerror_error_t **error )
+{
+	static char *function       = "libqcow_cluster_table_read_reference_by_index";
+	size_t page_reference_index = 0;
+	size_t references_per_page  = 0;
+	int page_index              = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages == NULL )
+	{
+		return( libqcow_cluster_table_get_reference_by_index(
+		         cluster_table,
+		         reference_index,
+		         reference,
+		         error ) );
+	}
+	if( ( reference_index < 0 )
+	 || ( reference_index >= cluster_table->number_of_references ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid reference index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference.",
+		 function );
+
+		return( -1 );
+	}
+	references_per_page  = cluster_table->page_size / 8;
+	page_index           = (int) ( (size_t) reference_index / references_per_page );
+	page_reference_index = (size_t) reference_index % references_per_page;
+
+	if( cluster_table->pages[ page_index ] == NULL )
+	{
+		if( libqcow_cluster_table_read_page(
+		     cluster_table,
+		     file_io_handle,
+		     page_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read page: %d.",
+			 function,
+			 page_index );
+
+			return( -1 );
+		}
+	}
+	*reference = ( cluster_table->pages[ page_index ] )[ page_reference_index ];
+
+	return( 1 );
+}
+
+/* Retrieves a specific reference from the cluster table without reading it
+ * When the cluster table is read on demand the page containing the reference must have been read
+ * Returns 1 if successful, 0 if the page containing the reference has not been read or -1 on error
+ */
+int libqcow_cluster_table_get_cached_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     int reference_index,
+     uint64_t *reference,
+     libcerror_error_t **error )
+{
+	static char *function       = "libqcow_cluster_table_get_cached_reference_by_index";
+	size_t page_reference_index = 0;
+	size_t references_per_page  = 0;
+	int page_index              = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages == NULL )
+	{
+		return( libqcow_cluster_table_get_reference_by_index(
+		         cluster_table,
+		         reference_index,
+		         reference,
+		         error ) );
+	}
+	if( ( reference_index < 0 )
+	 || ( reference_index >= cluster_table->number_of_references ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid reference index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference.",
+		 function );
+
+		return( -1 );
+	}
+	references_per_page  = cluster_table->page_size / 8;
+	page_index           = (int) ( (size_t) reference_index / references_per_page );
+	page_reference_index = (size_t) reference_index % references_per_page;
+
+	if( cluster_table->pages[ page_index ] == NULL )
+	{
+		return( 0 );
+	}
+	*reference = ( cluster_table->pages[ page_index ] )[ page_reference_index ];
+
+	return( 1 );
+}
+
+/* Sets a specific reference in the cluster table
+ * When the cluster table is read on demand a page that has not been read is left
+ * as is, the reference is read when the page is read
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_set_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     int reference_index,
+     uint64_t reference,
+     libcerror_error_t **error )
+{
+	static char *function       = "libqcow_cluster_table_set_reference_by_index";
+	size_t page_reference_index = 0;
+	size_t references_per_page  = 0;
+	int page_index              = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_table->references == NULL )
+	 && ( cluster_table->pages == NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster table - missing references.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( reference_index < 0 )
+	 || ( reference_index >= cluster_table->number_of_references ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid reference index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages == NULL )
+	{
+		if( cluster_table->decode_on_access != 0 )
+		{
+			byte_stream_copy_from_uint64_big_endian(
+			 (uint8_t *) &( cluster_table->references[ reference_index ] ),
+			 reference );
+		}
+		else
+		{
+			cluster_table->references[ reference_index ] = reference;
+		}
+		return( 1 );
+	}
+	references_per_page  = cluster_table->page_size / 8;
+	page_index           = (int) ( (size_t) reference_index / references_per_page );
+	page_reference_index = (size_t) reference_index % references_per_page;
+
+	if( cluster_table->pages[ page_index ] != NULL )
+	{
+		( cluster_table->pages[ page_index ] )[ page_reference_index ] = reference;
+	}
+	return( 1 );
+}
+
+/* Reads the pages of a cluster table that is read on demand that have not been read
+ * After this the cluster table is no longer modified on use and can be read
+ * by multiple threads without locking
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_read_all_pages(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_read_all_pages";
+	int page_index        = 0;
+
+	if( cluster_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table->pages == NULL )
+	{
+		return( 1 );
+	}
+	for( page_index = 0;
+	     page_index < cluster_table->number_of_pages;
+	     page_index++ )
+	{
+		if( cluster_table->pages[ page_index ] != NULL )
+		{
+			continue;
+		}
+		if( libqcow_cluster_table_read_page(
+		     cluster_table,
+		     file_io_handle,
+		     page_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read page: %d.",
+			 function,
+			 page_index );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
@@ -25,6 +25,7 @@
 #include <common.h>
 #include <types.h>
 
+#include "libqcow_cluster_table_pool.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 
@@ -43,6 +44,36 @@ struct libqcow_cluster_table
 	/* The references
 	 */
 	uint64_t *references;
+
+	/* The pool the references are retrieved from and released to
+	 */
+	libqcow_cluster_table_pool_t *pool;
+
+	/* Value to indicate the references are retained in their big-endian
+	 * on-disk form and decoded on access
+	 */
+	uint8_t decode_on_access;
+
+	/* The file offset of a cluster table that is read on demand
+	 */
+	off64_t file_offset;
+
+	/* The size of a cluster table that is read on demand
+	 */
+	size_t table_size;
+
+	/* The page size of a cluster table that is read on demand
+	 * or 0 if the cluster table is read at once
+	 */
+	size_t page_size;
+
+	/* The number of pages
+	 */
+	int number_of_pages;
+
+	/* The pages of references that have been read, a page is NULL until its first use
+	 */
+	uint64_t **pages;
 };
 
 int libqcow_cluster_table_initialize(
@@ -64,6 +95,30 @@ int libqcow_cluster_table_get_reference_by_index(
      uint64_t *reference,
      libcerror_error_t **error );
 
+int libqcow_cluster_table_get_memory_usage(
+     libqcow_cluster_table_t *cluster_table,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_allocate_references(
+     libqcow_cluster_table_t *cluster_table,
+     size_t references_size,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_free_references(
+     libqcow_cluster_table_t *cluster_table,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_decode_references(
+     libqcow_cluster_table_t *cluster_table,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_read_data(
+     libqcow_cluster_table_t *cluster_table,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
 int libqcow_cluster_table_read(
      libqcow_cluster_table_t *cluster_table,
      libbfio_handle_t *file_io_handle,
@@ -71,6 +126,43 @@ int libqcow_cluster_table_read(
      size_t cluster_table_size,
      libcerror_error_t **error );
 
+int libqcow_cluster_table_read_on_demand(
+     libqcow_cluster_table_t *cluster_table,
+     off64_t file_offset,
+     size_t cluster_table_size,
+     size_t page_size,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_read_page(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     int page_index,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_read_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     int reference_index,
+     uint64_t *reference,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_get_cached_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     int reference_index,
+     uint64_t *reference,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_set_reference_by_index(
+     libqcow_cluster_table_t *cluster_table,
+     int reference_index,
+     uint64_t reference,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_read_all_pages(
+     libqcow_cluster_table_t *cluster_table,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
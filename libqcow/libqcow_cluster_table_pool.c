@@ -0,0 +1,832 @@
+/*
+ * Cluster table pool functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_arena.h"
+#include "libqcow_cluster_table_pool.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+/* Retrieves the alignment of references of a specific size
+ * References of at least a page are aligned to a page so that they can be
+ * read into directly with unbuffered IO, other references to a cache line
+ * Returns the alignment
+ */
+size_t libqcow_cluster_table_pool_get_references_alignment(
+        size_t references_size )
+{
+	if( references_size >= LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE )
+	{
+		return( LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE );
+	}
+	return( LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_CACHE_LINE );
+}
+
+/* Allocates aligned references
+ * The references are over allocated and the original allocation is stored
+ * directly in front of the aligned references
+ * Returns a pointer to the references or NULL on error
+ */
+uint64_t *libqcow_cluster_table_pool_allocate_references(
+           size_t references_size )
+{
+	uint8_t *allocation = NULL;
+	uint8_t *references = NULL;
+	intptr_t address    = 0;
+	size_t alignment    = 0;
+
+	if( ( references_size == 0 )
+	 || ( references_size > ( (size_t) SSIZE_MAX - LIBQCOW_CLUSTER_BLOCK_BUFFER_ALIGNMENT_PAGE - sizeof( uint8_t * ) ) ) )
+	{
+		return( NULL );
+	}
+	alignment = libqcow_cluster_table_pool_get_references_alignment(
+	             references_size );
+
+	allocation = (uint8_t *) memory_allocate(
+	                          references_size + alignment + sizeof( uint8_t * ) );
+
+	if( allocation == NULL )
+	{
+		return( NULL );
+	}
+	address    = (intptr_t) ( allocation + sizeof( uint8_t * ) + alignment - 1 );
+	address   &= ~( (intptr_t) alignment - 1 );
+	references = (uint8_t *) address;
+
+	( (uint8_t **) references )[ -1 ] = allocation;
+
+	return( (uint64_t *) references );
+}
+
+/* Frees aligned references
+ */
+void libqcow_cluster_table_pool_free_references(
+      uint64_t *references )
+{
+	if( references != NULL )
+	{
+		memory_free(
+		 ( (uint8_t **) references )[ -1 ] );
+	}
+}
+
+/* Creates a cluster table pool
+ * Make sure the value cluster_table_pool is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_initialize(
+     libqcow_cluster_table_pool_t **cluster_table_pool,
+     size_t references_size,
+     int maximum_number_of_references,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_initialize";
+	size_t array_size     = 0;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_table_pool != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table pool value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( references_size == 0 )
+	 || ( references_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid references size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_references <= 0 )
+	 || ( (size_t) maximum_number_of_references > ( (size_t) SSIZE_MAX / sizeof( uint64_t * ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of references value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*cluster_table_pool = memory_allocate_structure(
+	                       libqcow_cluster_table_pool_t );
+
+	if( *cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster table pool.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *cluster_table_pool,
+	     0,
+	     sizeof( libqcow_cluster_table_pool_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear cluster table pool.",
+		 function );
+
+		memory_free(
+		 *cluster_table_pool );
+
+		*cluster_table_pool = NULL;
+
+		return( -1 );
+	}
+	array_size = sizeof( uint64_t * ) * (size_t) maximum_number_of_references;
+
+	( *cluster_table_pool )->references = (uint64_t **) memory_allocate(
+	                                                     array_size );
+
+	if( ( *cluster_table_pool )->references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create references array.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *cluster_table_pool )->references,
+	     0,
+	     array_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear references array.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *cluster_table_pool )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	( *cluster_table_pool )->references_size              = references_size;
+	( *cluster_table_pool )->maximum_number_of_references = maximum_number_of_references;
+
+	return( 1 );
+
+on_error:
+	if( *cluster_table_pool != NULL )
+	{
+		if( ( *cluster_table_pool )->references != NULL )
+		{
+			memory_free(
+			 ( *cluster_table_pool )->references );
+		}
+		memory_free(
+		 *cluster_table_pool );
+
+		*cluster_table_pool = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a cluster table pool and the references it holds
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_free(
+     libqcow_cluster_table_pool_t **cluster_table_pool,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_free";
+	int references_index  = 0;
+	int result            = 1;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cluster_table_pool != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *cluster_table_pool )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		for( references_index = 0;
+		     references_index < ( *cluster_table_pool )->number_of_references;
+		     references_index++ )
+		{
+			if( libqcow_arena_contains(
+			     ( *cluster_table_pool )->arena,
+			     (uint8_t *) ( *cluster_table_pool )->references[ references_index ] ) == 0 )
+			{
+				libqcow_cluster_table_pool_free_references(
+				 ( *cluster_table_pool )->references[ references_index ] );
+			}
+		}
+		memory_free(
+		 ( *cluster_table_pool )->references );
+
+		if( libqcow_arena_free(
+		     &( ( *cluster_table_pool )->arena ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free arena.",
+			 function );
+
+			result = -1;
+		}
+
+		memory_free(
+		 *cluster_table_pool );
+
+		*cluster_table_pool = NULL;
+	}
+	return( result );
+}
+
+/* Creates the arena of the pool
+ * The arena provides the references in a single region of memory, backed by huge pages
+ * where supported, before references are allocated individually
+ * This function should be called before the pool is used
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_initialize_arena(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     int number_of_references,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_initialize_arena";
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_table_pool->arena != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid cluster table pool - arena value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_arena_initialize(
+	     &( cluster_table_pool->arena ),
+	     cluster_table_pool->references_size,
+	     libqcow_cluster_table_pool_get_references_alignment(
+	      cluster_table_pool->references_size ),
+	     number_of_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create arena.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Clears the pool
+ * Frees the pooled references, references that are in use are not affected
+ * Pooled references of the arena are released back into the arena
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_clear(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_clear";
+	int references_index  = 0;
+	int release_result    = 0;
+	int result            = 1;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	for( references_index = 0;
+	     references_index < cluster_table_pool->number_of_references;
+	     references_index++ )
+	{
+		release_result = 0;
+
+		if( cluster_table_pool->arena != NULL )
+		{
+			release_result = libqcow_arena_release_slot(
+			                  cluster_table_pool->arena,
+			                  (uint8_t *) cluster_table_pool->references[ references_index ],
+			                  error );
+		}
+		if( release_result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release references: %d to arena.",
+			 function,
+			 references_index );
+
+			result = -1;
+		}
+		else if( release_result == 0 )
+		{
+			libqcow_cluster_table_pool_free_references(
+			 cluster_table_pool->references[ references_index ] );
+		}
+		cluster_table_pool->references[ references_index ] = NULL;
+	}
+	cluster_table_pool->number_of_references = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves references from the pool
+ * The references are taken from the arena when the pool is empty
+ * and allocated when there is no arena or the arena is full
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_get_references(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     size_t references_size,
+     uint64_t **references,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_get_references";
+	uint8_t *slot         = NULL;
+	int result            = 1;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( references_size != cluster_table_pool->references_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported references size value does not match pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid references.",
+		 function );
+
+		return( -1 );
+	}
+	*references = NULL;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( cluster_table_pool->number_of_references > 0 )
+	{
+		cluster_table_pool->number_of_references -= 1;
+
+		*references = cluster_table_pool->references[ cluster_table_pool->number_of_references ];
+
+		cluster_table_pool->references[ cluster_table_pool->number_of_references ] = NULL;
+	}
+	else if( cluster_table_pool->arena != NULL )
+	{
+		result = libqcow_arena_get_slot(
+		          cluster_table_pool->arena,
+		          &slot,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve references from arena.",
+			 function );
+		}
+		else if( result == 1 )
+		{
+			*references = (uint64_t *) slot;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( result == -1 )
+	{
+		return( -1 );
+	}
+	if( *references == NULL )
+	{
+		*references = libqcow_cluster_table_pool_allocate_references(
+		               references_size );
+
+		if( *references == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create references.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+on_error:
+	/* References of the arena can only be released back into the arena
+	 * while holding the mutex, hence they are left unused
+	 */
+	if( ( *references != NULL )
+	 && ( libqcow_arena_contains(
+	       cluster_table_pool->arena,
+	       (uint8_t *) *references ) == 0 ) )
+	{
+		libqcow_cluster_table_pool_free_references(
+		 *references );
+	}
+	*references = NULL;
+
+	return( -1 );
+#endif
+}
+
+/* Releases references back into the pool
+ * The references are released back into the arena or freed when the pool is full
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_release_references(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     uint64_t **references,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_cluster_table_pool_release_references";
+	int result            = 0;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( references == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid references.",
+		 function );
+
+		return( -1 );
+	}
+	if( *references == NULL )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( cluster_table_pool->number_of_references < cluster_table_pool->maximum_number_of_references )
+	{
+		cluster_table_pool->references[ cluster_table_pool->number_of_references ] = *references;
+
+		cluster_table_pool->number_of_references += 1;
+
+		*references = NULL;
+	}
+	else if( cluster_table_pool->arena != NULL )
+	{
+		result = libqcow_arena_release_slot(
+		          cluster_table_pool->arena,
+		          (uint8_t *) *references,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release references to arena.",
+			 function );
+		}
+		else if( result == 1 )
+		{
+			*references = NULL;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result == -1 )
+	{
+		return( -1 );
+	}
+	if( *references != NULL )
+	{
+		libqcow_cluster_table_pool_free_references(
+		 *references );
+
+		*references = NULL;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the pool, its pooled references and the free
+ * slots of its arena in bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_cluster_table_pool_get_memory_usage(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function     = "libqcow_cluster_table_pool_get_memory_usage";
+	size_t arena_memory_usage = 0;
+	int result                = 1;
+
+	if( cluster_table_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster table pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*memory_usage = sizeof( libqcow_cluster_table_pool_t )
+	              + ( sizeof( uint64_t * ) * cluster_table_pool->maximum_number_of_references )
+	              + ( cluster_table_pool->references_size * cluster_table_pool->number_of_references );
+
+	if( cluster_table_pool->arena != NULL )
+	{
+		if( libqcow_arena_get_memory_usage(
+		     cluster_table_pool->arena,
+		     &arena_memory_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of arena.",
+			 function );
+
+			result = -1;
+		}
+		else
+		{
+			*memory_usage += arena_memory_usage;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     cluster_table_pool->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
@@ -0,0 +1,116 @@
+/*
+ * Cluster table pool functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CLUSTER_TABLE_POOL_H )
+#define _LIBQCOW_CLUSTER_TABLE_POOL_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_arena.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_cluster_table_pool libqcow_cluster_table_pool_t;
+
+struct libqcow_cluster_table_pool
+{
+	/* The references size
+	 */
+	size_t references_size;
+
+	/* The maximum number of pooled references
+	 */
+	int maximum_number_of_references;
+
+	/* The number of pooled references
+	 */
+	int number_of_references;
+
+	/* The pooled references
+	 */
+	uint64_t **references;
+
+	/* The arena, which provides the references before they are allocated individually
+	 */
+	libqcow_arena_t *arena;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+size_t libqcow_cluster_table_pool_get_references_alignment(
+        size_t references_size );
+
+uint64_t *libqcow_cluster_table_pool_allocate_references(
+           size_t references_size );
+
+void libqcow_cluster_table_pool_free_references(
+      uint64_t *references );
+
+int libqcow_cluster_table_pool_initialize(
+     libqcow_cluster_table_pool_t **cluster_table_pool,
+     size_t references_size,
+     int maximum_number_of_references,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_free(
+     libqcow_cluster_table_pool_t **cluster_table_pool,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_initialize_arena(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     int number_of_references,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_clear(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_get_references(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     size_t references_size,
+     uint64_t **references,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_release_references(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     uint64_t **references,
+     libcerror_error_t **error );
+
+int libqcow_cluster_table_pool_get_memory_usage(
+     libqcow_cluster_table_pool_t *cluster_table_pool,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CLUSTER_TABLE_POOL_H ) */
+
@@ -29,103 +29,1482 @@
 #include <stdlib.h>
 #endif
 
-#if defined( HAVE_ZLIB ) || defined( ZLIB_DLL )
-#include <zlib.h>
+#include "libqcow_compression.h"
+#include "libqcow_definitions.h"
+#include "libqcow_deflate.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG )
+#define libqcow_zlib_inflate_init2	zng_inflateInit2
+#define libqcow_zlib_inflate_reset	zng_inflateReset
+#define libqcow_zlib_inflate		zng_inflate
+#define libqcow_zlib_inflate_end	zng_inflateEnd
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+#if defined( HAVE_ZLIB_INFLATE_INIT2 ) || defined( ZLIB_DLL )
+#define libqcow_zlib_inflate_init2	inflateInit2
+#else
+#define libqcow_zlib_inflate_init2	_inflateInit2
+#endif
+#define libqcow_zlib_inflate_reset	inflateReset
+#define libqcow_zlib_inflate		inflate
+#define libqcow_zlib_inflate_end	inflateEnd
+
+#endif
+
+/* Retrieves the name of the inflate backend
+ * Returns a string containing the name
+ */
+const char *libqcow_compression_get_inflate_backend_name(
+             void )
+{
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+	return( "libdeflate" );
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	return( "ISA-L" );
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG )
+	return( "zlib-ng" );
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	return( "zlib" );
+
+#else
+	return( "built-in" );
+
+#endif
+}
+
+/* Creates a decompression context
+ * Make sure the value decompression_context is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_context_initialize(
+     libqcow_decompression_context_t **decompression_context,
+     uint16_t compression_method,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_context_initialize";
+
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_context != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid decompression context value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compression_method != LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+#if defined( HAVE_ZSTD )
+	 && ( compression_method != LIBQCOW_COMPRESSION_METHOD_ZSTD )
+#endif
+	 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported compression method.",
+		 function );
+
+		return( -1 );
+	}
+	*decompression_context = memory_allocate_structure(
+	                          libqcow_decompression_context_t );
+
+	if( *decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create decompression context.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *decompression_context,
+	     0,
+	     sizeof( libqcow_decompression_context_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear decompression context.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+	if( compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	{
+		( *decompression_context )->libdeflate_decompressor = libdeflate_alloc_decompressor();
+
+		if( ( *decompression_context )->libdeflate_decompressor == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create libdeflate decompressor.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	if( compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	{
+		( *decompression_context )->isal_inflate_state = memory_allocate_structure(
+		                                                  struct inflate_state );
+
+		if( ( *decompression_context )->isal_inflate_state == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create ISA-L inflate state.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#endif
+#if defined( HAVE_ZSTD )
+	if( compression_method == LIBQCOW_COMPRESSION_METHOD_ZSTD )
+	{
+		( *decompression_context )->zstd_context = ZSTD_createDCtx();
+
+		if( ( *decompression_context )->zstd_context == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create zstd decompression context.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#endif
+	( *decompression_context )->compression_method = compression_method;
+
+	return( 1 );
+
+on_error:
+	if( *decompression_context != NULL )
+	{
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+		if( ( *decompression_context )->libdeflate_decompressor != NULL )
+		{
+			libdeflate_free_decompressor(
+			 ( *decompression_context )->libdeflate_decompressor );
+		}
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+		if( ( *decompression_context )->isal_inflate_state != NULL )
+		{
+			memory_free(
+			 ( *decompression_context )->isal_inflate_state );
+		}
+#endif
+		memory_free(
+		 *decompression_context );
+
+		*decompression_context = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a decompression context
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_context_free(
+     libqcow_decompression_context_t **decompression_context,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_context_free";
+	int result            = 1;
+
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_context != NULL )
+	{
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+		if( ( *decompression_context )->libdeflate_decompressor != NULL )
+		{
+			libdeflate_free_decompressor(
+			 ( *decompression_context )->libdeflate_decompressor );
+		}
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+		if( ( *decompression_context )->isal_inflate_state != NULL )
+		{
+			memory_free(
+			 ( *decompression_context )->isal_inflate_state );
+		}
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+		if( ( *decompression_context )->zlib_stream_initialized != 0 )
+		{
+			if( libqcow_zlib_inflate_end(
+			     &( ( *decompression_context )->zlib_stream ) ) != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to finalize zlib stream.",
+				 function );
+
+				result = -1;
+			}
+		}
+#endif
+#if defined( HAVE_ZSTD )
+		if( ( *decompression_context )->zstd_context != NULL )
+		{
+			ZSTD_freeDCtx(
+			 ( *decompression_context )->zstd_context );
+		}
+#endif
+		if( ( *decompression_context )->spare_decompression_state != NULL )
+		{
+			if( libqcow_decompression_state_free(
+			     &( ( *decompression_context )->spare_decompression_state ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free spare decompression state.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *decompression_context );
+
+		*decompression_context = NULL;
+	}
+	return( result );
+}
+
+/* Decompresses data using the decompression context
+ * The backend state of the context is reused instead of reinitialized
+ * Returns 1 on success, 0 on failure or -1 on error
+ */
+int libqcow_decompression_context_decompress_data(
+     libqcow_decompression_context_t *decompression_context,
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t *uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	static char *function                = "libqcow_decompression_context_decompress_data";
+	int result                           = 0;
+
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+	size_t actual_uncompressed_data_size = 0;
+#endif
+#if defined( HAVE_ZSTD )
+	ZSTD_inBuffer zstd_input_buffer;
+	ZSTD_outBuffer zstd_output_buffer;
+
+	size_t zstd_result                   = 0;
+#endif
+
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed data buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid uncompressed data buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data == compressed_data )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed data buffer equals uncompressed data buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid uncompressed data size.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_context->compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	{
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+		result = libdeflate_deflate_decompress(
+		          decompression_context->libdeflate_decompressor,
+		          compressed_data,
+		          compressed_data_size,
+		          uncompressed_data,
+		          *uncompressed_data_size,
+		          &actual_uncompressed_data_size );
+
+		if( result == LIBDEFLATE_SUCCESS )
+		{
+			*uncompressed_data_size = actual_uncompressed_data_size;
+
+			result = 1;
+		}
+		else if( result == LIBDEFLATE_INSUFFICIENT_SPACE )
+		{
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				"%s: unable to read compressed data: target buffer too small.\n",
+				 function );
+			}
+#endif
+			/* Estimate that a factor 2 enlargement should suffice
+			 */
+			*uncompressed_data_size *= 2;
+
+			result = 0;
+		}
+		else
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: libdeflate returned error: %d.",
+			 function,
+			 result );
+
+			*uncompressed_data_size = 0;
+
+			result = -1;
+		}
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+		if( compressed_data_size > (size_t) UINT32_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid compressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		if( *uncompressed_data_size > (size_t) UINT32_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid uncompressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		isal_inflate_init(
+		 decompression_context->isal_inflate_state );
+
+		decompression_context->isal_inflate_state->next_in   = (uint8_t *) compressed_data;
+		decompression_context->isal_inflate_state->avail_in  = (uint32_t) compressed_data_size;
+		decompression_context->isal_inflate_state->next_out  = uncompressed_data;
+		decompression_context->isal_inflate_state->avail_out = (uint32_t) *uncompressed_data_size;
+		decompression_context->isal_inflate_state->crc_flag  = ISAL_DEFLATE;
+
+		result = isal_inflate_stateless(
+		          decompression_context->isal_inflate_state );
+
+		if( result == ISAL_DECOMP_OK )
+		{
+			*uncompressed_data_size = (size_t) decompression_context->isal_inflate_state->total_out;
+
+			result = 1;
+		}
+		else if( result == ISAL_OUT_OVERFLOW )
+		{
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				"%s: unable to read compressed data: target buffer too small.\n",
+				 function );
+			}
+#endif
+			/* Estimate that a factor 2 enlargement should suffice
+			 */
+			*uncompressed_data_size *= 2;
+
+			result = 0;
+		}
+		else
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: ISA-L returned error: %d.",
+			 function,
+			 result );
+
+			*uncompressed_data_size = 0;
+
+			result = -1;
+		}
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+		if( compressed_data_size > (size_t) ULONG_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid compressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		if( *uncompressed_data_size > (size_t) ULONG_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid uncompressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		if( decompression_context->zlib_stream_initialized == 0 )
+		{
+			if( memory_set(
+			     &( decompression_context->zlib_stream ),
+			     0,
+			     sizeof( decompression_context->zlib_stream ) ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to clear zlib stream.",
+				 function );
+
+				return( -1 );
+			}
+			result = libqcow_zlib_inflate_init2(
+			          &( decompression_context->zlib_stream ),
+			          -12 );
+
+			if( result != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to initialize zlib stream.",
+				 function );
+
+				return( -1 );
+			}
+			decompression_context->zlib_stream_initialized = 1;
+		}
+		else
+		{
+			/* The window size does not change hence resetting
+			 * the stream retains the allocated window
+			 */
+			if( libqcow_zlib_inflate_reset(
+			     &( decompression_context->zlib_stream ) ) != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to reset zlib stream.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		decompression_context->zlib_stream.next_in   = (uint8_t *) compressed_data;
+		decompression_context->zlib_stream.avail_in  = (uint32_t) compressed_data_size;
+		decompression_context->zlib_stream.next_out  = (uint8_t *) uncompressed_data;
+		decompression_context->zlib_stream.avail_out = (uint32_t) *uncompressed_data_size;
+
+		result = libqcow_zlib_inflate(
+		          &( decompression_context->zlib_stream ),
+		          Z_FINISH );
+
+		if( result == Z_STREAM_END )
+		{
+			*uncompressed_data_size = (size_t) decompression_context->zlib_stream.total_out;
+
+			result = 1;
+		}
+		else if( result == Z_DATA_ERROR )
+		{
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: unable to read compressed data: data error.\n",
+				 function );
+			}
+#endif
+			*uncompressed_data_size = 0;
+
+			result = -1;
+		}
+		else if( result == Z_BUF_ERROR )
+		{
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				"%s: unable to read compressed data: target buffer too small.\n",
+				 function );
+			}
+#endif
+			/* Estimate that a factor 2 enlargement should suffice
+			 */
+			*uncompressed_data_size *= 2;
+
+			result = 0;
+		}
+		else if( result == Z_MEM_ERROR )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to read compressed data: insufficient memory.",
+			 function );
+
+			*uncompressed_data_size = 0;
+
+			result = -1;
+		}
+		else
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: zlib returned undefined error: %d.",
+			 function,
+			 result );
+
+			*uncompressed_data_size = 0;
+
+			result = -1;
+		}
+#else
+		result = libqcow_deflate_decompress(
+		          compressed_data,
+		          compressed_data_size,
+		          uncompressed_data,
+		          uncompressed_data_size,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to decompress deflate compressed data.",
+			 function );
+
+			return( -1 );
+		}
+#endif /* defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE ) */
+	}
+#if defined( HAVE_ZSTD )
+	else if( decompression_context->compression_method == LIBQCOW_COMPRESSION_METHOD_ZSTD )
+	{
+		zstd_result = ZSTD_DCtx_reset(
+		               decompression_context->zstd_context,
+		               ZSTD_reset_session_only );
+
+		if( ZSTD_isError( zstd_result ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to reset zstd decompression context.",
+			 function );
+
+			return( -1 );
+		}
+		zstd_input_buffer.src   = compressed_data;
+		zstd_input_buffer.size  = compressed_data_size;
+		zstd_input_buffer.pos   = 0;
+
+		zstd_output_buffer.dst  = uncompressed_data;
+		zstd_output_buffer.size = *uncompressed_data_size;
+		zstd_output_buffer.pos  = 0;
+
+		/* The compressed data can contain multiple zstd frames and can be followed
+		 * by trailing data, hence decompress until the uncompressed data is filled
+		 */
+		while( zstd_output_buffer.pos < zstd_output_buffer.size )
+		{
+			zstd_result = ZSTD_decompressStream(
+			               decompression_context->zstd_context,
+			               &zstd_output_buffer,
+			               &zstd_input_buffer );
+
+			if( ZSTD_isError( zstd_result ) )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+				 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+				 "%s: unable to decompress zstd compressed data: %s.",
+				 function,
+				 ZSTD_getErrorName( zstd_result ) );
+
+				*uncompressed_data_size = 0;
+
+				return( -1 );
+			}
+			if( zstd_input_buffer.pos >= zstd_input_buffer.size )
+			{
+				break;
+			}
+		}
+		if( ( zstd_output_buffer.pos < zstd_output_buffer.size )
+		 && ( zstd_result != 0 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: unable to decompress zstd compressed data: truncated frame.",
+			 function );
+
+			*uncompressed_data_size = 0;
+
+			return( -1 );
+		}
+		*uncompressed_data_size = zstd_output_buffer.pos;
+
+		result = 1;
+	}
+#endif /* defined( HAVE_ZSTD ) */
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported compression method.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Retrieves a decompression state for a resumable decompression
+ * The spare decompression state of the context is handed out when available,
+ * otherwise a new decompression state is created
+ * Make sure the value decompression_state is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_context_get_state(
+     libqcow_decompression_context_t *decompression_context,
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_context_get_state";
+
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_state != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid decompression state value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_context->spare_decompression_state != NULL )
+	{
+		*decompression_state = decompression_context->spare_decompression_state;
+
+		decompression_context->spare_decompression_state = NULL;
+
+		return( 1 );
+	}
+	if( libqcow_decompression_state_initialize(
+	     decompression_state,
+	     decompression_context->compression_method,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Releases a decompression state retrieved by libqcow_decompression_context_get_state
+ * The decompression state is reset and retained as the spare decompression state
+ * of the context if the context has none, otherwise it is freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_context_release_state(
+     libqcow_decompression_context_t *decompression_context,
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_context_release_state";
+
+	if( decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_state == NULL )
+	{
+		return( 1 );
+	}
+	if( ( decompression_context->spare_decompression_state == NULL )
+	 && ( ( *decompression_state )->compression_method == decompression_context->compression_method ) )
+	{
+		if( libqcow_decompression_state_reset(
+		     *decompression_state,
+		     error ) == 1 )
+		{
+			decompression_context->spare_decompression_state = *decompression_state;
+
+			*decompression_state = NULL;
+
+			return( 1 );
+		}
+		/* A decompression state that cannot be reset is not reused
+		 */
+		libcerror_error_free(
+		 error );
+	}
+	if( libqcow_decompression_state_free(
+	     decompression_state,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Creates a decompression state
+ * Make sure the value decompression_state is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_state_initialize(
+     libqcow_decompression_state_t **decompression_state,
+     uint16_t compression_method,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_state_initialize";
+
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_state != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid decompression state value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*decompression_state = memory_allocate_structure(
+	                        libqcow_decompression_state_t );
+
+	if( *decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     *decompression_state,
+	     0,
+	     sizeof( libqcow_decompression_state_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear decompression state.",
+		 function );
+
+		memory_free(
+		 *decompression_state );
+
+		*decompression_state = NULL;
+
+		return( -1 );
+	}
+	( *decompression_state )->compression_method = compression_method;
+
+	return( 1 );
+}
+
+/* Frees a decompression state
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_state_free(
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_state_free";
+	int result            = 1;
+
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( *decompression_state != NULL )
+	{
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+		if( ( *decompression_state )->zlib_stream_initialized != 0 )
+		{
+			if( libqcow_zlib_inflate_end(
+			     &( ( *decompression_state )->zlib_stream ) ) != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to finalize zlib stream.",
+				 function );
+
+				result = -1;
+			}
+		}
+#endif
+		memory_free(
+		 *decompression_state );
+
+		*decompression_state = NULL;
+	}
+	return( result );
+}
+
+/* Resets a decompression state to the start of new compressed data
+ * The backend state, such as the zlib stream, is retained
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_decompression_state_reset(
+     libqcow_decompression_state_t *decompression_state,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_state_reset";
+
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	if( ( decompression_state->zlib_stream_initialized != 0 )
+	 && ( decompression_state->is_started != 0 ) )
+	{
+		/* inflateReset retains the allocated window of the zlib stream
+		 */
+		if( libqcow_zlib_inflate_reset(
+		     &( decompression_state->zlib_stream ) ) != Z_OK )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to reset zlib stream.",
+			 function );
+
+			return( -1 );
+		}
+	}
+#elif !defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE ) && !defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	if( memory_set(
+	     &( decompression_state->deflate_state ),
+	     0,
+	     sizeof( libqcow_deflate_state_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear deflate state.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	decompression_state->uncompressed_data_offset = 0;
+	decompression_state->is_complete              = 0;
+	decompression_state->is_started               = 0;
+
+	return( 1 );
+}
+
+/* Decompresses data using the decompression state up to a specific offset
+ * The compressed and uncompressed data must be the same for every call on the same state,
+ * since the decompression is resumed where the previous call stopped
+ * Decompression stops once at least stop data offset bytes are produced,
+ * where a stop data offset of 0 decompresses the remainder of the compressed data
+ * Backends that cannot resume a decompression decompress the compressed data at once
+ * using the decompression context
+ * Returns 1 on success or -1 on error
+ */
+int libqcow_decompression_state_decompress_data(
+     libqcow_decompression_state_t *decompression_state,
+     libqcow_decompression_context_t *decompression_context,
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t uncompressed_data_size,
+     size_t stop_data_offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_decompression_state_decompress_data";
+	size_t data_size      = 0;
+	int result            = 0;
+
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	int flush             = 0;
+#endif
+
+	if( decompression_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid decompression state.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed data buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid uncompressed data buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid uncompressed data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( decompression_state->is_complete != 0 )
+	{
+		return( 1 );
+	}
+	if( stop_data_offset >= uncompressed_data_size )
+	{
+		stop_data_offset = 0;
+	}
+	if( ( stop_data_offset != 0 )
+	 && ( stop_data_offset <= decompression_state->uncompressed_data_offset ) )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	if( decompression_state->compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	{
+		if( compressed_data_size > (size_t) ULONG_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid compressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		if( uncompressed_data_size > (size_t) ULONG_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid uncompressed data size value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		if( decompression_state->zlib_stream_initialized == 0 )
+		{
+			if( memory_set(
+			     &( decompression_state->zlib_stream ),
+			     0,
+			     sizeof( decompression_state->zlib_stream ) ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to clear zlib stream.",
+				 function );
+
+				return( -1 );
+			}
+			result = libqcow_zlib_inflate_init2(
+			          &( decompression_state->zlib_stream ),
+			          -12 );
+
+			if( result != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to initialize zlib stream.",
+				 function );
+
+				return( -1 );
+			}
+			decompression_state->zlib_stream_initialized = 1;
+		}
+		if( decompression_state->is_started == 0 )
+		{
+			/* The position in the compressed data is retained by the zlib stream
+			 */
+			decompression_state->zlib_stream.next_in  = (uint8_t *) compressed_data;
+			decompression_state->zlib_stream.avail_in = (uint32_t) compressed_data_size;
+
+			decompression_state->is_started = 1;
+		}
+		decompression_state->zlib_stream.next_out = &( uncompressed_data[ decompression_state->uncompressed_data_offset ] );
+
+		if( stop_data_offset == 0 )
+		{
+			decompression_state->zlib_stream.avail_out = (uint32_t) ( uncompressed_data_size - decompression_state->uncompressed_data_offset );
+
+			flush = Z_FINISH;
+		}
+		else
+		{
+			decompression_state->zlib_stream.avail_out = (uint32_t) ( stop_data_offset - decompression_state->uncompressed_data_offset );
+
+			flush = Z_NO_FLUSH;
+		}
+		result = libqcow_zlib_inflate(
+		          &( decompression_state->zlib_stream ),
+		          flush );
+
+		decompression_state->uncompressed_data_offset = (size_t) decompression_state->zlib_stream.total_out;
+
+		if( result == Z_STREAM_END )
+		{
+			decompression_state->is_complete = 1;
+		}
+		else if( ( ( result == Z_OK )
+		       || ( result == Z_BUF_ERROR ) )
+		      && ( flush == Z_NO_FLUSH )
+		      && ( decompression_state->zlib_stream.avail_out == 0 ) )
+		{
+			/* The uncompressed data up to the stop data offset is available
+			 */
+		}
+		else if( result == Z_MEM_ERROR )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to read compressed data: insufficient memory.",
+			 function );
+
+			return( -1 );
+		}
+		else
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: unable to decompress deflate compressed data, zlib returned: %d.",
+			 function,
+			 result );
+
+			return( -1 );
+		}
+		/* The zlib stream is retained when the compressed data was decompressed
+		 * so that it can be reset and reused by libqcow_decompression_state_reset
+		 */
+		return( 1 );
+	}
+#elif !defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE ) && !defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	if( decompression_state->compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	{
+		if( libqcow_deflate_decompress_partial(
+		     &( decompression_state->deflate_state ),
+		     compressed_data,
+		     compressed_data_size,
+		     uncompressed_data,
+		     uncompressed_data_size,
+		     stop_data_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: unable to decompress deflate compressed data.",
+			 function );
+
+			return( -1 );
+		}
+		decompression_state->uncompressed_data_offset = decompression_state->deflate_state.uncompressed_data_offset;
+		decompression_state->is_complete              = decompression_state->deflate_state.is_complete;
+
+		return( 1 );
+	}
 #endif
+	data_size = uncompressed_data_size;
 
-#include "libqcow_compression.h"
-#include "libqcow_definitions.h"
-#include "libqcow_deflate.h"
-#include "libqcow_libcerror.h"
-#include "libqcow_libcnotify.h"
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          compressed_data,
+	          compressed_data_size,
+	          uncompressed_data,
+	          &data_size,
+	          error );
 
-/* Decompresses data using the compression method
- * Returns 1 on success, 0 on failure or -1 on error
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress data.",
+		 function );
+
+		return( -1 );
+	}
+	decompression_state->uncompressed_data_offset = data_size;
+	decompression_state->is_complete              = 1;
+
+	return( 1 );
+}
+
+/* Compresses data using the compression method
+ * A compression level of -1 represents the default level of the compression method
+ * The compressed data size contains the size of the compressed data buffer and
+ * is set to the size of the compressed data
+ * Returns 1 on success, 0 if the compressed data does not fit in the compressed data buffer or -1 on error
  */
-int libqcow_decompress_data(
-     const uint8_t *compressed_data,
-     size_t compressed_data_size,
+int libqcow_compress_data(
+     uint8_t *compressed_data,
+     size_t *compressed_data_size,
      uint16_t compression_method,
-     uint8_t *uncompressed_data,
-     size_t *uncompressed_data_size,
+     int8_t compression_level,
+     const uint8_t *uncompressed_data,
+     size_t uncompressed_data_size,
      libcerror_error_t **error )
 {
-	static char *function              = "libqcow_decompress_data";
-	int result                         = 0;
-
-#if ( defined( HAVE_ZLIB ) && defined( HAVE_ZLIB_INFLATE ) ) || defined( ZLIB_DLL )
+#if defined( HAVE_LIBQCOW_DEFLATE_LIBDEFLATE )
+	struct libdeflate_compressor *libdeflate_compressor = NULL;
+#elif defined( HAVE_LIBQCOW_DEFLATE_ZLIB )
 	z_stream zlib_stream;
 #endif
 
+	static char *function                               = "libqcow_compress_data";
+	size_t safe_compressed_data_size                    = 0;
+
+#if defined( HAVE_ZSTD )
+	size_t zstd_result                                  = 0;
+#endif
+#if defined( HAVE_LIBQCOW_DEFLATE_LIBDEFLATE ) || defined( HAVE_LIBQCOW_DEFLATE_ZLIB ) || defined( HAVE_ZSTD )
+	int result                                          = 0;
+#endif
+
 	if( compressed_data == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid compressed data buffer.",
+		 "%s: invalid compressed data.",
 		 function );
 
 		return( -1 );
 	}
-	if( uncompressed_data == NULL )
+	if( compressed_data_size == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid uncompressed data buffer.",
+		 "%s: invalid compressed data size.",
 		 function );
 
 		return( -1 );
 	}
-	if( uncompressed_data == compressed_data )
+	safe_compressed_data_size = *compressed_data_size;
+
+	if( ( safe_compressed_data_size == 0 )
+	 || ( safe_compressed_data_size > (size_t) UINT32_MAX ) )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid compressed data buffer equals uncompressed data buffer.",
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid compressed data size value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
-	if( uncompressed_data_size == NULL )
+	if( uncompressed_data == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid uncompressed data size.",
+		 "%s: invalid uncompressed data.",
+		 function );
+
+		return( -1 );
+	}
+	if( uncompressed_data_size > (size_t) UINT32_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid uncompressed data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compression_level < -1 )
+	 || ( compression_level > 22 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid compression level value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
+#if defined( HAVE_LIBQCOW_DEFLATE_LIBDEFLATE ) || defined( HAVE_LIBQCOW_DEFLATE_ZLIB )
 	if( compression_method == LIBQCOW_COMPRESSION_METHOD_DEFLATE )
 	{
-#if ( defined( HAVE_ZLIB ) && defined( HAVE_ZLIB_INFLATE ) ) || defined( ZLIB_DLL )
-		if( compressed_data_size > (size_t) ULONG_MAX )
+		if( compression_level > 9 )
 		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-			 "%s: invalid compressed data size value exceeds maximum.",
-			 function );
-
-			return( -1 );
+			compression_level = 9;
 		}
-		if( *uncompressed_data_size > (size_t) ULONG_MAX )
+#if defined( HAVE_LIBQCOW_DEFLATE_LIBDEFLATE )
+		if( compression_level == -1 )
+		{
+			compression_level = 6;
+		}
+		libdeflate_compressor = libdeflate_alloc_compressor(
+		                         (int) compression_level );
+
+		if( libdeflate_compressor == NULL )
 		{
 			libcerror_error_set(
 			 error,
-			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-			 "%s: invalid uncompressed data size value exceeds maximum.",
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create libdeflate compressor.",
 			 function );
 
 			return( -1 );
 		}
+		/* QCOW uses a raw deflate stream, libdeflate returns 0 if the compressed data does not fit
+		 */
+		*compressed_data_size = libdeflate_deflate_compress(
+		                         libdeflate_compressor,
+		                         uncompressed_data,
+		                         uncompressed_data_size,
+		                         compressed_data,
+		                         safe_compressed_data_size );
+
+		libdeflate_free_compressor(
+		 libdeflate_compressor );
+
+		if( *compressed_data_size != 0 )
+		{
+			result = 1;
+		}
+#else
 		if( memory_set(
 		     &zlib_stream,
 		     0,
@@ -140,150 +1519,157 @@ int libqcow_decompress_data(
 
 			return( -1 );
 		}
-		zlib_stream.next_in   = (Bytef *) compressed_data;
-		zlib_stream.avail_in  = (uInt) compressed_data_size;
-		zlib_stream.next_out  = (Bytef *) uncompressed_data;
-		zlib_stream.avail_out = (uInt) *uncompressed_data_size;
-
-#if defined( HAVE_ZLIB_INFLATE_INIT2 ) || defined( ZLIB_DLL )
-		result = inflateInit2(
-		          &zlib_stream,
-		          -12 );
-#else
-		result = _inflateInit2(
-		          &zlib_stream,
-		          -12 );
-#endif
-		if( result != Z_OK )
+		/* QCOW uses a raw deflate stream with a window of 4 KiB
+		 */
+		if( deflateInit2(
+		     &zlib_stream,
+		     (int) compression_level,
+		     Z_DEFLATED,
+		     -12,
+		     9,
+		     Z_DEFAULT_STRATEGY ) != Z_OK )
 		{
 			libcerror_error_set(
 			 error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
 			 "%s: unable to initialize zlib stream.",
 			 function );
 
 			return( -1 );
 		}
-		result = inflate(
-		          &zlib_stream,
-		          Z_FINISH );
+		zlib_stream.next_in   = (Bytef *) uncompressed_data;
+		zlib_stream.avail_in  = (uInt) uncompressed_data_size;
+		zlib_stream.next_out  = (Bytef *) compressed_data;
+		zlib_stream.avail_out = (uInt) safe_compressed_data_size;
 
-		if( result == Z_STREAM_END )
+		/* The stream is not complete if the compressed data does not fit
+		 */
+		if( deflate(
+		     &zlib_stream,
+		     Z_FINISH ) == Z_STREAM_END )
 		{
-			*uncompressed_data_size = (size_t) zlib_stream.total_out;
+			*compressed_data_size = (size_t) zlib_stream.total_out;
 
 			result = 1;
 		}
-		else if( result == Z_DATA_ERROR )
-		{
-#if defined( HAVE_DEBUG_OUTPUT )
-			if( libcnotify_verbose != 0 )
-			{
-				libcnotify_printf(
-				 "%s: unable to read compressed data: data error.\n",
-				 function );
-			}
+		deflateEnd(
+		 &zlib_stream );
 #endif
-			*uncompressed_data_size = 0;
+		return( result );
+	}
+#endif /* defined( HAVE_LIBQCOW_DEFLATE_LIBDEFLATE ) || defined( HAVE_LIBQCOW_DEFLATE_ZLIB ) */
 
-			result = -1;
-		}
-		else if( result == Z_BUF_ERROR )
+#if defined( HAVE_ZSTD )
+	if( compression_method == LIBQCOW_COMPRESSION_METHOD_ZSTD )
+	{
+		if( compression_level == -1 )
 		{
-#if defined( HAVE_DEBUG_OUTPUT )
-			if( libcnotify_verbose != 0 )
-			{
-				libcnotify_printf(
-				"%s: unable to read compressed data: target buffer too small.\n",
-				 function );
-			}
-#endif
-			/* Estimate that a factor 2 enlargement should suffice
-			 */
-			*uncompressed_data_size *= 2;
-
-			result = 0;
+			compression_level = ZSTD_CLEVEL_DEFAULT;
 		}
-		else if( result == Z_MEM_ERROR )
-		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_MEMORY,
-			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
-			 "%s: unable to read compressed data: insufficient memory.",
-			 function );
+		zstd_result = ZSTD_compress(
+		               compressed_data,
+		               safe_compressed_data_size,
+		               uncompressed_data,
+		               uncompressed_data_size,
+		               (int) compression_level );
 
-			*uncompressed_data_size = 0;
+		if( !ZSTD_isError( zstd_result ) )
+		{
+			*compressed_data_size = zstd_result;
 
-			result = -1;
+			result = 1;
 		}
-		else
+		else if( ZSTD_getErrorCode( zstd_result ) != ZSTD_error_dstSize_tooSmall )
 		{
 			libcerror_error_set(
 			 error,
 			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
-			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
-			 "%s: zlib returned undefined error: %d.",
+			 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+			 "%s: unable to compress data with error: %s.",
 			 function,
-			 result );
-
-			*uncompressed_data_size = 0;
+			 ZSTD_getErrorName( zstd_result ) );
 
-			result = -1;
-		}
-		if( result == -1 )
-		{
-			inflateEnd(
-			 &zlib_stream );
+			return( -1 );
 		}
-		else
-		{
-			if( inflateEnd(
-			     &zlib_stream ) != Z_OK )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-				 "%s: unable to finalize zlib stream.",
-				 function );
+		return( result );
+	}
+#endif /* defined( HAVE_ZSTD ) */
 
-				return( -1 );
-			}
-		}
-#else
-		result = libqcow_deflate_decompress(
-		          compressed_data,
-		          compressed_data_size,
-		          uncompressed_data,
-		          uncompressed_data_size,
-		          error );
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+	 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+	 "%s: unsupported compression method.",
+	 function );
 
-		if( result != 1 )
-		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
-			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
-			 "%s: unable to decompress deflate compressed data.",
-			 function );
+	return( -1 );
+}
 
-			return( -1 );
-		}
-#endif /* ( defined( HAVE_ZLIB ) && defined( HAVE_ZLIB_INFLATE ) ) || defined( ZLIB_DLL ) */
+/* Decompresses data using the compression method
+ * Returns 1 on success, 0 on failure or -1 on error
+ */
+int libqcow_decompress_data(
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint16_t compression_method,
+     uint8_t *uncompressed_data,
+     size_t *uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	libqcow_decompression_context_t *decompression_context = NULL;
+	static char *function                                  = "libqcow_decompress_data";
+	int result                                             = 0;
+
+	if( libqcow_decompression_context_initialize(
+	     &decompression_context,
+	     compression_method,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create decompression context.",
+		 function );
+
+		return( -1 );
 	}
-	else
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          compressed_data,
+	          compressed_data_size,
+	          uncompressed_data,
+	          uncompressed_data_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress data.",
+		 function );
+
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libqcow_decompression_context_free(
+	     &decompression_context,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
-		 "%s: unsupported compression method.",
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free decompression context.",
 		 function );
 
 		return( -1 );
 	}
 	return( result );
 }
-
@@ -25,12 +25,200 @@
 #include <common.h>
 #include <types.h>
 
+/* The inflate backend is selected in order of preference
+ */
+#if defined( HAVE_LIBDEFLATE )
+#define HAVE_LIBQCOW_INFLATE_LIBDEFLATE		1
+
+#elif defined( HAVE_ISAL )
+#define HAVE_LIBQCOW_INFLATE_ISAL		1
+
+#elif defined( HAVE_ZLIB_NG )
+#define HAVE_LIBQCOW_INFLATE_ZLIB_NG		1
+
+#elif ( defined( HAVE_ZLIB ) && defined( HAVE_ZLIB_INFLATE ) ) || defined( ZLIB_DLL )
+#define HAVE_LIBQCOW_INFLATE_ZLIB		1
+
+#endif
+
+/* The deflate backend, which is used to compress data, is selected in order of preference
+ */
+#if defined( HAVE_LIBDEFLATE )
+#define HAVE_LIBQCOW_DEFLATE_LIBDEFLATE		1
+
+#elif ( defined( HAVE_ZLIB ) && defined( HAVE_ZLIB_DEFLATE ) ) || defined( ZLIB_DLL )
+#define HAVE_LIBQCOW_DEFLATE_ZLIB		1
+
+#endif
+
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+#include <libdeflate.h>
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+#include <isa-l/igzip_lib.h>
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG )
+#include <zlib-ng.h>
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+#include <zlib.h>
+
+#endif
+
+#if defined( HAVE_LIBQCOW_DEFLATE_ZLIB ) && !defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+#include <zlib.h>
+#endif
+
+#if defined( HAVE_ZSTD )
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+#include "libqcow_deflate.h"
 #include "libqcow_libcerror.h"
 
 #if defined( __cplusplus )
 extern "C" {
 #endif
 
+typedef struct libqcow_decompression_context libqcow_decompression_context_t;
+typedef struct libqcow_decompression_state libqcow_decompression_state_t;
+
+struct libqcow_decompression_context
+{
+	/* The compression method
+	 */
+	uint16_t compression_method;
+
+#if defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE )
+	/* The libdeflate decompressor
+	 */
+	struct libdeflate_decompressor *libdeflate_decompressor;
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	/* The ISA-L inflate state
+	 */
+	struct inflate_state *isal_inflate_state;
+
+#elif defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	/* The zlib stream
+	 */
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG )
+	zng_stream zlib_stream;
+#else
+	z_stream zlib_stream;
+#endif
+
+	/* Value to indicate the zlib stream was initialized
+	 */
+	uint8_t zlib_stream_initialized;
+#endif
+
+#if defined( HAVE_ZSTD )
+	/* The zstd decompression context
+	 */
+	ZSTD_DCtx *zstd_context;
+#endif
+
+	/* The spare decompression state, which is retained with its backend state
+	 * so that the next resumable decompression does not allocate a new one
+	 */
+	libqcow_decompression_state_t *spare_decompression_state;
+};
+
+/* The state of a resumable decompression of a single compressed data buffer
+ */
+struct libqcow_decompression_state
+{
+	/* The compression method
+	 */
+	uint16_t compression_method;
+
+	/* The uncompressed data offset, which is the number of bytes decompressed so far
+	 */
+	size_t uncompressed_data_offset;
+
+	/* Value to indicate the end of the compressed data was reached
+	 */
+	uint8_t is_complete;
+
+	/* Value to indicate the decompression of the compressed data was started
+	 */
+	uint8_t is_started;
+
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG ) || defined( HAVE_LIBQCOW_INFLATE_ZLIB )
+	/* The zlib stream
+	 */
+#if defined( HAVE_LIBQCOW_INFLATE_ZLIB_NG )
+	zng_stream zlib_stream;
+#else
+	z_stream zlib_stream;
+#endif
+
+	/* Value to indicate the zlib stream was initialized
+	 */
+	uint8_t zlib_stream_initialized;
+
+#elif !defined( HAVE_LIBQCOW_INFLATE_LIBDEFLATE ) && !defined( HAVE_LIBQCOW_INFLATE_ISAL )
+	/* The deflate state
+	 */
+	libqcow_deflate_state_t deflate_state;
+#endif
+};
+
+const char *libqcow_compression_get_inflate_backend_name(
+             void );
+
+int libqcow_decompression_context_initialize(
+     libqcow_decompression_context_t **decompression_context,
+     uint16_t compression_method,
+     libcerror_error_t **error );
+
+int libqcow_decompression_context_free(
+     libqcow_decompression_context_t **decompression_context,
+     libcerror_error_t **error );
+
+int libqcow_decompression_context_decompress_data(
+     libqcow_decompression_context_t *decompression_context,
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t *uncompressed_data_size,
+     libcerror_error_t **error );
+
+int libqcow_decompression_context_get_state(
+     libqcow_decompression_context_t *decompression_context,
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error );
+
+int libqcow_decompression_context_release_state(
+     libqcow_decompression_context_t *decompression_context,
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error );
+
+int libqcow_decompression_state_initialize(
+     libqcow_decompression_state_t **decompression_state,
+     uint16_t compression_method,
+     libcerror_error_t **error );
+
+int libqcow_decompression_state_free(
+     libqcow_decompression_state_t **decompression_state,
+     libcerror_error_t **error );
+
+int libqcow_decompression_state_reset(
+     libqcow_decompression_state_t *decompression_state,
+     libcerror_error_t **error );
+
+int libqcow_decompression_state_decompress_data(
+     libqcow_decompression_state_t *decompression_state,
+     libqcow_decompression_context_t *decompression_context,
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t uncompressed_data_size,
+     size_t stop_data_offset,
+     libcerror_error_t **error );
+
 int libqcow_compress_data(
      uint8_t *compressed_data,
      size_t *compressed_data_size,
@@ -0,0 +1,2028 @@
+/*
+ * Consistency check functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cluster_table.h"
+#include "libqcow_compression.h"
+#include "libqcow_consistency_check.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_handle.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_reference_count_table.h"
+#include "libqcow_snapshot_values.h"
+#include "libqcow_types.h"
+
+/* Creates a consistency check
+ * Make sure the value consistency_check is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_initialize(
+     libqcow_consistency_check_t **consistency_check,
+     libqcow_file_t *file,
+     int flags,
+     int number_of_workers,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_consistency_check_initialize";
+	size_t workers_size   = 0;
+	int worker_index      = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( *consistency_check != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid consistency check value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_workers <= 0 )
+	 || ( number_of_workers > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of workers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*consistency_check = memory_allocate_structure(
+	                      libqcow_consistency_check_t );
+
+	if( *consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create consistency check.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *consistency_check,
+	     0,
+	     sizeof( libqcow_consistency_check_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear consistency check.",
+		 function );
+
+		memory_free(
+		 *consistency_check );
+
+		*consistency_check = NULL;
+
+		return( -1 );
+	}
+	( *consistency_check )->file   = file;
+	( *consistency_check )->flags  = flags;
+	( *consistency_check )->result = 1;
+
+	workers_size = sizeof( libqcow_consistency_check_worker_t ) * number_of_workers;
+
+	( *consistency_check )->workers = (libqcow_consistency_check_worker_t *) memory_allocate(
+	                                                                          workers_size );
+
+	if( ( *consistency_check )->workers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create workers.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *consistency_check )->workers,
+	     0,
+	     workers_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear workers.",
+		 function );
+
+		goto on_error;
+	}
+	( *consistency_check )->number_of_workers = number_of_workers;
+
+	for( worker_index = 0;
+	     worker_index < number_of_workers;
+	     worker_index++ )
+	{
+		( *consistency_check )->workers[ worker_index ].consistency_check = *consistency_check;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *consistency_check )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( *consistency_check != NULL )
+	{
+		if( ( *consistency_check )->workers != NULL )
+		{
+			memory_free(
+			 ( *consistency_check )->workers );
+		}
+		memory_free(
+		 *consistency_check );
+
+		*consistency_check = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a consistency check
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_free(
+     libqcow_consistency_check_t **consistency_check,
+     libcerror_error_t **error )
+{
+	libqcow_consistency_check_worker_t *worker = NULL;
+	static char *function                      = "libqcow_consistency_check_free";
+	int result                                 = 1;
+	int worker_index                           = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( *consistency_check != NULL )
+	{
+		for( worker_index = 0;
+		     worker_index < ( *consistency_check )->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( ( *consistency_check )->workers[ worker_index ] );
+
+			if( ( worker->reader != NULL )
+			 && ( worker->reader != ( *consistency_check )->file ) )
+			{
+				if( libqcow_file_free(
+				     &( worker->reader ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free reader: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+			if( worker->decompression_context != NULL )
+			{
+				if( libqcow_decompression_context_free(
+				     &( worker->decompression_context ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free decompression context: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+			if( worker->uncompressed_data != NULL )
+			{
+				memory_free(
+				 worker->uncompressed_data );
+			}
+			if( worker->compressed_data != NULL )
+			{
+				memory_free(
+				 worker->compressed_data );
+			}
+			if( worker->host_ranges != NULL )
+			{
+				memory_free(
+				 worker->host_ranges );
+			}
+			if( worker->level2_tables_data != NULL )
+			{
+				memory_free(
+				 worker->level2_tables_data );
+			}
+		}
+		memory_free(
+		 ( *consistency_check )->workers );
+
+		if( ( *consistency_check )->level2_table_offsets != NULL )
+		{
+			memory_free(
+			 ( *consistency_check )->level2_table_offsets );
+		}
+		if( ( *consistency_check )->reference_map != NULL )
+		{
+			memory_free(
+			 ( *consistency_check )->reference_map );
+		}
+		if( ( *consistency_check )->worker_error != NULL )
+		{
+			libcerror_error_free(
+			 &( ( *consistency_check )->worker_error ) );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *consistency_check )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *consistency_check );
+
+		*consistency_check = NULL;
+	}
+	return( result );
+}
+
+/* Appends the offset of a level 2 table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_append_level2_table_offset(
+     libqcow_consistency_check_t *consistency_check,
+     uint64_t level2_table_offset,
+     libcerror_error_t **error )
+{
+	void *reallocation                           = NULL;
+	static char *function                        = "libqcow_consistency_check_append_level2_table_offset";
+	int number_of_allocated_level2_table_offsets = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( consistency_check->number_of_level2_table_offsets >= consistency_check->number_of_allocated_level2_table_offsets )
+	{
+		if( consistency_check->number_of_allocated_level2_table_offsets == 0 )
+		{
+			number_of_allocated_level2_table_offsets = 256;
+		}
+		else if( consistency_check->number_of_allocated_level2_table_offsets > ( INT_MAX / 2 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid number of level 2 table offsets value out of bounds.",
+			 function );
+
+			return( -1 );
+		}
+		else
+		{
+			number_of_allocated_level2_table_offsets = consistency_check->number_of_allocated_level2_table_offsets * 2;
+		}
+		reallocation = memory_reallocate(
+		                consistency_check->level2_table_offsets,
+		                sizeof( uint64_t ) * number_of_allocated_level2_table_offsets );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize level 2 table offsets.",
+			 function );
+
+			return( -1 );
+		}
+		consistency_check->level2_table_offsets                     = (uint64_t *) reallocation;
+		consistency_check->number_of_allocated_level2_table_offsets = number_of_allocated_level2_table_offsets;
+	}
+	consistency_check->level2_table_offsets[ consistency_check->number_of_level2_table_offsets ] = level2_table_offset;
+
+	consistency_check->number_of_level2_table_offsets += 1;
+
+	return( 1 );
+}
+
+/* Reads a level 1 table
+ * The level 2 tables it references are checked against the bounds of the file,
+ * marked as referenced and appended to the level 2 tables that are checked by the workers
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_read_level1_table(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     off64_t level1_table_offset,
+     size_t level1_table_size,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_table  = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_consistency_check_read_level1_table";
+	uint64_t level2_table_offset           = 0;
+	int level1_table_index                 = 0;
+	int number_of_level1_table_references  = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) consistency_check->file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid consistency check - invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( level1_table_offset <= 0 )
+	 || ( level1_table_size == 0 ) )
+	{
+		return( 1 );
+	}
+	if( ( (size64_t) level1_table_offset >= consistency_check->file_size )
+	 || ( (size64_t) level1_table_size > ( consistency_check->file_size - (size64_t) level1_table_offset ) )
+	 || ( ( internal_file->io_handle->format_version != 1 )
+	  && ( ( (uint64_t) level1_table_offset & internal_file->io_handle->cluster_block_bit_mask ) != 0 ) ) )
+	{
+		consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+		return( 1 );
+	}
+	if( consistency_check->reference_map != NULL )
+	{
+		if( libqcow_internal_file_mark_referenced_clusters(
+		     internal_file,
+		     consistency_check->reference_map,
+		     consistency_check->number_of_host_clusters,
+		     level1_table_offset,
+		     (size64_t) level1_table_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark level 1 table clusters.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_cluster_table_initialize(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_read(
+	     level1_table,
+	     file_io_handle,
+	     level1_table_offset,
+	     level1_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		goto on_error;
+	}
+	for( level1_table_index = 0;
+	     level1_table_index < number_of_level1_table_references;
+	     level1_table_index++ )
+	{
+		if( libqcow_cluster_table_get_reference_by_index(
+		     level1_table,
+		     level1_table_index,
+		     &level2_table_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 1 table reference: %d.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		level2_table_offset &= internal_file->io_handle->offset_bit_mask;
+
+		if( level2_table_offset == 0 )
+		{
+			continue;
+		}
+		if( ( level2_table_offset >= consistency_check->file_size )
+		 || ( (size64_t) internal_file->io_handle->level2_table_size > ( consistency_check->file_size - level2_table_offset ) )
+		 || ( ( internal_file->io_handle->format_version != 1 )
+		  && ( ( level2_table_offset & internal_file->io_handle->cluster_block_bit_mask ) != 0 ) ) )
+		{
+			consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+			continue;
+		}
+		if( consistency_check->reference_map != NULL )
+		{
+			if( libqcow_internal_file_mark_referenced_clusters(
+			     internal_file,
+			     consistency_check->reference_map,
+			     consistency_check->number_of_host_clusters,
+			     (off64_t) level2_table_offset,
+			     (size64_t) internal_file->io_handle->level2_table_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to mark level 2 table: %d clusters.",
+				 function,
+				 level1_table_index );
+
+				goto on_error;
+			}
+		}
+		if( libqcow_consistency_check_append_level2_table_offset(
+		     consistency_check,
+		     level2_table_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to append level 2 table: %d offset.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_cluster_table_free(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( level1_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &level1_table,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads the metadata of the file
+ * The host cluster blocks that contain metadata other than the level 2 tables
+ * are marked as referenced and the level 1 tables of the file and its snapshots
+ * are read. The level 2 tables are sorted by offset afterwards
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_read_metadata(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file     = NULL;
+	libqcow_snapshot_values_t *snapshot_values = NULL;
+	static char *function                      = "libqcow_consistency_check_read_metadata";
+	uint64_t level2_table_offset               = 0;
+	int gap                                    = 0;
+	int index                                  = 0;
+	int snapshot_index                         = 0;
+	int sort_index                             = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) consistency_check->file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid consistency check - invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( consistency_check->reference_map != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid consistency check - reference map value already set.",
+		 function );
+
+		return( -1 );
+	}
+	consistency_check->file_size               = internal_file->size;
+	consistency_check->number_of_host_clusters = internal_file->size >> internal_file->io_handle->number_of_cluster_block_bits;
+
+	if( ( internal_file->size & internal_file->io_handle->cluster_block_bit_mask ) != 0 )
+	{
+		consistency_check->number_of_host_clusters += 1;
+	}
+	/* Version 1 does not define reference counts
+	 */
+	if( ( internal_file->io_handle->format_version != 1 )
+	 && ( internal_file->io_handle->reference_count_table_offset != 0 ) )
+	{
+		if( consistency_check->number_of_host_clusters > (uint64_t) SSIZE_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid number of host clusters value out of bounds.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_internal_file_read_reference_count_table(
+		     internal_file,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read reference count table.",
+			 function );
+
+			return( -1 );
+		}
+		consistency_check->reference_map = (uint8_t *) memory_allocate(
+		                                                sizeof( uint8_t ) * (size_t) consistency_check->number_of_host_clusters );
+
+		if( consistency_check->reference_map == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create reference map.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_set(
+		     consistency_check->reference_map,
+		     0,
+		     sizeof( uint8_t ) * (size_t) consistency_check->number_of_host_clusters ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear reference map.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_internal_file_mark_metadata_clusters(
+		     internal_file,
+		     file_io_handle,
+		     consistency_check->reference_map,
+		     consistency_check->number_of_host_clusters,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark metadata clusters.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( libqcow_consistency_check_read_level1_table(
+	     consistency_check,
+	     file_io_handle,
+	     internal_file->io_handle->level1_table_offset,
+	     (size_t) internal_file->io_handle->level1_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
+		 function );
+
+		return( -1 );
+	}
+	for( snapshot_index = 0;
+	     snapshot_index < internal_file->number_of_snapshots;
+	     snapshot_index++ )
+	{
+		snapshot_values = internal_file->snapshot_values_array[ snapshot_index ];
+
+		if( libqcow_consistency_check_read_level1_table(
+		     consistency_check,
+		     file_io_handle,
+		     snapshot_values->level1_table_offset,
+		     (size_t) snapshot_values->level1_table_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read snapshot: %d level 1 table.",
+			 function,
+			 snapshot_index );
+
+			return( -1 );
+		}
+	}
+	/* A level 2 table that is shared by multiple level 1 tables is kept once per reference
+	 * so that the cluster blocks it references are counted once per reference
+	 */
+	for( gap = consistency_check->number_of_level2_table_offsets / 2;
+	     gap > 0;
+	     gap /= 2 )
+	{
+		for( index = gap;
+		     index < consistency_check->number_of_level2_table_offsets;
+		     index++ )
+		{
+			level2_table_offset = consistency_check->level2_table_offsets[ index ];
+
+			for( sort_index = index;
+			     sort_index >= gap;
+			     sort_index -= gap )
+			{
+				if( consistency_check->level2_table_offsets[ sort_index - gap ] <= level2_table_offset )
+				{
+					break;
+				}
+				consistency_check->level2_table_offsets[ sort_index ] = consistency_check->level2_table_offsets[ sort_index - gap ];
+			}
+			consistency_check->level2_table_offsets[ sort_index ] = level2_table_offset;
+		}
+	}
+	consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_LEVEL2_TABLES ] = (uint64_t) consistency_check->number_of_level2_table_offsets;
+
+	return( 1 );
+}
+
+/* Retrieves the next run of level 2 tables to check
+ * A run consists of the same or adjacent level 2 tables, that are read at once,
+ * of up to LIBQCOW_CONSISTENCY_CHECK_MAXIMUM_READ_SIZE bytes
+ * Returns 1 if successful, 0 if no level 2 tables are left or -1 on error
+ */
+int libqcow_consistency_check_get_next_level2_tables(
+     libqcow_consistency_check_t *consistency_check,
+     int *level2_table_index,
+     int *number_of_level2_tables,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_consistency_check_get_next_level2_tables";
+	size_t level2_table_size               = 0;
+	size_t read_size                       = 0;
+	int end_index                          = 0;
+	int result                             = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( level2_table_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 2 table index.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_level2_tables == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file     = (libqcow_internal_file_t *) consistency_check->file;
+	level2_table_size = internal_file->io_handle->level2_table_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( ( consistency_check->abort == 0 )
+	 && ( consistency_check->next_level2_table_index < consistency_check->number_of_level2_table_offsets ) )
+	{
+		end_index = consistency_check->next_level2_table_index + 1;
+		read_size = level2_table_size;
+
+		while( end_index < consistency_check->number_of_level2_table_offsets )
+		{
+			if( consistency_check->level2_table_offsets[ end_index ] == consistency_check->level2_table_offsets[ end_index - 1 ] )
+			{
+				end_index++;
+			}
+			else if( ( consistency_check->level2_table_offsets[ end_index ] == ( consistency_check->level2_table_offsets[ end_index - 1 ] + level2_table_size ) )
+			      && ( ( read_size + level2_table_size ) <= (size_t) LIBQCOW_CONSISTENCY_CHECK_MAXIMUM_READ_SIZE ) )
+			{
+				read_size += level2_table_size;
+
+				end_index++;
+			}
+			else
+			{
+				break;
+			}
+		}
+		*level2_table_index      = consistency_check->next_level2_table_index;
+		*number_of_level2_tables = end_index - consistency_check->next_level2_table_index;
+
+		consistency_check->next_level2_table_index = end_index;
+
+		result = 1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Verifies that a compressed cluster block decompresses to the cluster block size
+ * Returns 1 if the compressed cluster block is valid, 0 if not or -1 on error
+ */
+int libqcow_consistency_check_verify_compressed_cluster_block(
+     libqcow_consistency_check_worker_t *worker,
+     libbfio_handle_t *file_io_handle,
+     uint64_t compressed_cluster_block_offset,
+     size_t compressed_cluster_block_size,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *decompression_error = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_consistency_check_verify_compressed_cluster_block";
+	size_t uncompressed_data_size          = 0;
+	ssize_t read_count                     = 0;
+	int result                             = 0;
+
+	if( worker == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid worker.",
+		 function );
+
+		return( -1 );
+	}
+	if( worker->consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid worker - missing consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( worker->decompression_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid worker - missing decompression context.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) worker->consistency_check->file;
+
+	/* The compressed data of a cluster block does not exceed 2 cluster blocks
+	 */
+	if( ( compressed_cluster_block_size == 0 )
+	 || ( compressed_cluster_block_size > ( 2 * internal_file->io_handle->cluster_block_size ) ) )
+	{
+		return( 0 );
+	}
+	result = libqcow_io_scheduler_acquire(
+	          worker->io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          compressed_cluster_block_size,
+	          &( worker->consistency_check->abort ),
+	          error );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to acquire IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              worker->compressed_data,
+	              compressed_cluster_block_size,
+	              (off64_t) compressed_cluster_block_offset,
+	              error );
+
+	if( read_count != (ssize_t) compressed_cluster_block_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read compressed data at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+		 function,
+		 compressed_cluster_block_offset,
+		 compressed_cluster_block_offset );
+
+		return( -1 );
+	}
+	uncompressed_data_size = internal_file->io_handle->cluster_block_size;
+
+	result = libqcow_decompression_context_decompress_data(
+	          worker->decompression_context,
+	          worker->compressed_data,
+	          compressed_cluster_block_size,
+	          worker->uncompressed_data,
+	          &uncompressed_data_size,
+	          &decompression_error );
+
+	/* Compressed data that cannot be decompressed is corrupt and not an error of the check
+	 */
+	if( decompression_error != NULL )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 decompression_error );
+		}
+#endif
+		libcerror_error_free(
+		 &decompression_error );
+	}
+	if( ( result != 1 )
+	 || ( uncompressed_data_size != internal_file->io_handle->cluster_block_size ) )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Checks a level 2 table
+ * The number of references is the number of level 1 table references to the level 2 table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_check_level2_table(
+     libqcow_consistency_check_worker_t *worker,
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *level2_table_data,
+     int number_of_references,
+     libcerror_error_t **error )
+{
+	libqcow_consistency_check_t *consistency_check = NULL;
+	libqcow_internal_file_t *internal_file         = NULL;
+	static char *function                          = "libqcow_consistency_check_check_level2_table";
+	uint64_t cluster_block_file_offset             = 0;
+	uint64_t cluster_block_reference               = 0;
+	uint64_t compressed_cluster_block_offset       = 0;
+	size_t compressed_cluster_block_size           = 0;
+	int host_range_index                           = 0;
+	int level2_table_index                         = 0;
+	int number_of_level2_table_references          = 0;
+	int reference_index                            = 0;
+	int result                                     = 0;
+
+	if( worker == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid worker.",
+		 function );
+
+		return( -1 );
+	}
+	if( worker->consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid worker - missing consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( level2_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 2 table data.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_references <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of references value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	consistency_check = worker->consistency_check;
+	internal_file     = (libqcow_internal_file_t *) consistency_check->file;
+
+	number_of_level2_table_references = (int) ( internal_file->io_handle->level2_table_size / 8 );
+
+	worker->number_of_host_ranges = 0;
+
+	/* An extended level 2 table entry is followed by its subcluster bitmap
+	 */
+	for( level2_table_index = 0;
+	     level2_table_index < number_of_level2_table_references;
+	     level2_table_index += 1 << ( internal_file->io_handle->number_of_level2_table_entry_bits - 3 ) )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 &( level2_table_data[ level2_table_index * 8 ] ),
+		 cluster_block_reference );
+
+		if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+		{
+			worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_COMPRESSED_CLUSTERS ] += 1;
+
+			compressed_cluster_block_offset = ( cluster_block_reference & internal_file->io_handle->offset_bit_mask )
+			                                & internal_file->io_handle->compression_bit_mask;
+
+			if( compressed_cluster_block_offset >= consistency_check->file_size )
+			{
+				worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+				continue;
+			}
+			if( libqcow_internal_file_get_compressed_cluster_block_range(
+			     internal_file,
+			     cluster_block_reference & internal_file->io_handle->offset_bit_mask,
+			     &compressed_cluster_block_offset,
+			     &compressed_cluster_block_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve compressed cluster block range.",
+				 function );
+
+				return( -1 );
+			}
+			if( (size64_t) compressed_cluster_block_size > ( consistency_check->file_size - compressed_cluster_block_offset ) )
+			{
+				worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+				continue;
+			}
+			worker->host_ranges[ worker->number_of_host_ranges * 2 ]       = compressed_cluster_block_offset;
+			worker->host_ranges[ ( worker->number_of_host_ranges * 2 ) + 1 ] = (uint64_t) compressed_cluster_block_size;
+
+			worker->number_of_host_ranges += 1;
+
+			if( ( consistency_check->flags & LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA ) != 0 )
+			{
+				result = libqcow_consistency_check_verify_compressed_cluster_block(
+				          worker,
+				          file_io_handle,
+				          compressed_cluster_block_offset,
+				          compressed_cluster_block_size,
+				          error );
+
+				if( result == -1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GENERIC,
+					 "%s: unable to verify compressed cluster block at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+					 function,
+					 compressed_cluster_block_offset,
+					 compressed_cluster_block_offset );
+
+					return( -1 );
+				}
+				else if( result == 0 )
+				{
+					worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_CORRUPT_COMPRESSED_CLUSTERS ] += 1;
+				}
+			}
+			continue;
+		}
+		cluster_block_file_offset = cluster_block_reference
+		                          & internal_file->io_handle->offset_bit_mask
+		                          & ~( internal_file->io_handle->cluster_block_bit_mask );
+
+		if( cluster_block_file_offset == 0 )
+		{
+			continue;
+		}
+		worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_DATA_CLUSTERS ] += 1;
+
+		/* Bit 0 of a version 2 and 3 level 2 table entry is the zero flag
+		 * the other bits below the cluster block size must not be set
+		 */
+		if( ( internal_file->io_handle->format_version != 1 )
+		 && ( ( cluster_block_reference & internal_file->io_handle->offset_bit_mask & internal_file->io_handle->cluster_block_bit_mask & ~( (uint64_t) 1 ) ) != 0 ) )
+		{
+			worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+			continue;
+		}
+		/* The clusters of an external data file are not part of the file
+		 */
+		if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+		{
+			continue;
+		}
+		if( cluster_block_file_offset >= consistency_check->file_size )
+		{
+			worker->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+			continue;
+		}
+		worker->host_ranges[ worker->number_of_host_ranges * 2 ]       = cluster_block_file_offset;
+		worker->host_ranges[ ( worker->number_of_host_ranges * 2 ) + 1 ] = (uint64_t) internal_file->io_handle->cluster_block_size;
+
+		worker->number_of_host_ranges += 1;
+	}
+	if( ( consistency_check->reference_map == NULL )
+	 || ( worker->number_of_host_ranges == 0 ) )
+	{
+		return( 1 );
+	}
+	/* The reference map is shared by the workers, the host ranges are marked at once
+	 * to limit the number of times the mutex is grabbed
+	 */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	result = 1;
+
+	for( host_range_index = 0;
+	     host_range_index < worker->number_of_host_ranges;
+	     host_range_index++ )
+	{
+		for( reference_index = 0;
+		     reference_index < number_of_references;
+		     reference_index++ )
+		{
+			if( libqcow_internal_file_mark_referenced_clusters(
+			     internal_file,
+			     consistency_check->reference_map,
+			     consistency_check->number_of_host_clusters,
+			     (off64_t) worker->host_ranges[ host_range_index * 2 ],
+			     (size64_t) worker->host_ranges[ ( host_range_index * 2 ) + 1 ],
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to mark host range: %d clusters.",
+				 function,
+				 host_range_index );
+
+				result = -1;
+
+				break;
+			}
+		}
+		if( result != 1 )
+		{
+			break;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Runs a worker of a consistency check
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_worker_run(
+     libqcow_consistency_check_t *consistency_check,
+     int worker_index,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle           = NULL;
+	libqcow_consistency_check_worker_t *worker = NULL;
+	libqcow_internal_file_t *internal_file     = NULL;
+	static char *function                      = "libqcow_consistency_check_worker_run";
+	size_t level2_table_size                   = 0;
+	size_t read_size                           = 0;
+	ssize_t read_count                         = 0;
+	uint64_t first_level2_table_offset         = 0;
+	uint64_t level2_table_offset               = 0;
+	int index                                  = 0;
+	int level2_table_index                     = 0;
+	int number_of_level2_tables                = 0;
+	int number_of_references                   = 0;
+	int result                                 = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( worker_index < 0 )
+	 || ( worker_index >= consistency_check->number_of_workers ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid worker index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	worker            = &( consistency_check->workers[ worker_index ] );
+	internal_file     = (libqcow_internal_file_t *) consistency_check->file;
+	file_io_handle    = ( (libqcow_internal_file_t *) worker->reader )->file_io_handle;
+	level2_table_size = internal_file->io_handle->level2_table_size;
+
+	if( libqcow_internal_file_get_io_scheduler(
+	     (libqcow_internal_file_t *) worker->reader,
+	     &( worker->io_scheduler ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	do
+	{
+		if( internal_file->abort != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_ABORT_REQUESTED,
+			 "%s: abort requested.",
+			 function );
+
+			goto on_error;
+		}
+		result = libqcow_consistency_check_get_next_level2_tables(
+		          consistency_check,
+		          &level2_table_index,
+		          &number_of_level2_tables,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve next level 2 tables.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		first_level2_table_offset = consistency_check->level2_table_offsets[ level2_table_index ];
+
+		read_size = (size_t) ( consistency_check->level2_table_offsets[ level2_table_index + number_of_level2_tables - 1 ]
+		          - first_level2_table_offset ) + level2_table_size;
+
+		/* The level 2 tables are background IO, they yield to queued read requests
+		 * and are subject to the IO limits of the background IO priority
+		 */
+		result = libqcow_io_scheduler_acquire(
+		          worker->io_scheduler,
+		          LIBQCOW_IO_PRIORITY_BACKGROUND,
+		          read_size,
+		          &( consistency_check->abort ),
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to acquire IO scheduler.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              worker->level2_tables_data,
+		              read_size,
+		              (off64_t) first_level2_table_offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 tables at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+			 function,
+			 first_level2_table_offset,
+			 first_level2_table_offset );
+
+			goto on_error;
+		}
+		index = 0;
+
+		while( index < number_of_level2_tables )
+		{
+			level2_table_offset  = consistency_check->level2_table_offsets[ level2_table_index + index ];
+			number_of_references = 1;
+
+			while( ( ( index + number_of_references ) < number_of_level2_tables )
+			    && ( consistency_check->level2_table_offsets[ level2_table_index + index + number_of_references ] == level2_table_offset ) )
+			{
+				number_of_references++;
+			}
+			if( libqcow_consistency_check_check_level2_table(
+			     worker,
+			     file_io_handle,
+			     &( worker->level2_tables_data[ level2_table_offset - first_level2_table_offset ] ),
+			     number_of_references,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to check level 2 table at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+				 function,
+				 level2_table_offset,
+				 level2_table_offset );
+
+				goto on_error;
+			}
+			index += number_of_references;
+		}
+	}
+	while( result == 1 );
+
+	return( 1 );
+
+on_error:
+	libqcow_consistency_check_stop(
+	 consistency_check,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Stops the workers of a consistency check because of an error
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_stop(
+     libqcow_consistency_check_t *consistency_check,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_consistency_check_stop";
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	consistency_check->abort  = 1;
+	consistency_check->result = -1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     consistency_check->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Keeps the error of the first worker that failed
+ * The error is freed if the error of another worker was kept
+ */
+void libqcow_consistency_check_set_worker_error(
+      libqcow_consistency_check_t *consistency_check,
+      libcerror_error_t **worker_error )
+{
+	if( ( consistency_check == NULL )
+	 || ( worker_error == NULL )
+	 || ( *worker_error == NULL ) )
+	{
+		return;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 *worker_error );
+	}
+#endif
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     consistency_check->mutex,
+	     NULL ) != 1 )
+	{
+		libcerror_error_free(
+		 worker_error );
+
+		return;
+	}
+#endif
+	if( consistency_check->worker_error == NULL )
+	{
+		consistency_check->worker_error = *worker_error;
+		*worker_error                   = NULL;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_mutex_release(
+	 consistency_check->mutex,
+	 NULL );
+#endif
+	if( *worker_error != NULL )
+	{
+		libcerror_error_free(
+		 worker_error );
+	}
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error                   = NULL;
+	libqcow_consistency_check_worker_t *worker = NULL;
+	int result                                 = 0;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	worker = (libqcow_consistency_check_worker_t *) arguments;
+
+	result = libqcow_consistency_check_worker_run(
+	          worker->consistency_check,
+	          (int) ( worker - worker->consistency_check->workers ),
+	          &error );
+
+	if( result != 1 )
+	{
+		libqcow_consistency_check_set_worker_error(
+		 worker->consistency_check,
+		 &error );
+	}
+	return( result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Runs the workers of a consistency check
+ * Every worker reads using its own reader of the file, the first worker
+ * runs in the calling thread and the other workers in their own thread
+ * The values determined by the workers are added to the values of the consistency check
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_run(
+     libqcow_consistency_check_t *consistency_check,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *worker_error            = NULL;
+	libqcow_consistency_check_worker_t *worker = NULL;
+	libqcow_internal_file_t *internal_file     = NULL;
+	static char *function                      = "libqcow_consistency_check_run";
+	size_t level2_tables_data_size             = 0;
+	int value_index                            = 0;
+	int worker_index                           = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int number_of_threads                      = 0;
+#endif
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( consistency_check->number_of_level2_table_offsets == 0 )
+	{
+		return( 1 );
+	}
+	internal_file = (libqcow_internal_file_t *) consistency_check->file;
+
+	level2_tables_data_size = (size_t) LIBQCOW_CONSISTENCY_CHECK_MAXIMUM_READ_SIZE;
+
+	if( level2_tables_data_size < internal_file->io_handle->level2_table_size )
+	{
+		level2_tables_data_size = internal_file->io_handle->level2_table_size;
+	}
+	/* Every level 2 table is checked by a single worker, there is no use
+	 * for more workers than level 2 tables
+	 */
+	if( consistency_check->number_of_workers > consistency_check->number_of_level2_table_offsets )
+	{
+		consistency_check->number_of_workers = consistency_check->number_of_level2_table_offsets;
+	}
+	for( worker_index = 0;
+	     worker_index < consistency_check->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( consistency_check->workers[ worker_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libqcow_file_clone_reader(
+		     consistency_check->file,
+		     &( worker->reader ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create reader: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+#else
+		worker->reader = consistency_check->file;
+#endif
+		worker->level2_tables_data = (uint8_t *) memory_allocate(
+		                                          sizeof( uint8_t ) * level2_tables_data_size );
+
+		if( worker->level2_tables_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create level 2 tables data: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+		/* Every level 2 table entry references at most one host range of an offset and size
+		 */
+		worker->host_ranges = (uint64_t *) memory_allocate(
+		                                    sizeof( uint64_t ) * ( internal_file->io_handle->level2_table_size / 8 ) * 2 );
+
+		if( worker->host_ranges == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create host ranges: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+		if( ( consistency_check->flags & LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA ) != 0 )
+		{
+			worker->compressed_data = (uint8_t *) memory_allocate(
+			                                       sizeof( uint8_t ) * ( 2 * internal_file->io_handle->cluster_block_size ) );
+
+			if( worker->compressed_data == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create compressed data: %d.",
+				 function,
+				 worker_index );
+
+				return( -1 );
+			}
+			worker->uncompressed_data = (uint8_t *) memory_allocate(
+			                                         sizeof( uint8_t ) * internal_file->io_handle->cluster_block_size );
+
+			if( worker->uncompressed_data == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create uncompressed data: %d.",
+				 function,
+				 worker_index );
+
+				return( -1 );
+			}
+			if( libqcow_decompression_context_initialize(
+			     &( worker->decompression_context ),
+			     internal_file->io_handle->compression_method,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create decompression context: %d.",
+				 function,
+				 worker_index );
+
+				return( -1 );
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( number_of_threads = 1;
+	     number_of_threads < consistency_check->number_of_workers;
+	     number_of_threads++ )
+	{
+		worker = &( consistency_check->workers[ number_of_threads ] );
+
+		if( libcthreads_thread_create(
+		     &( worker->thread ),
+		     NULL,
+		     &libqcow_consistency_check_thread_function,
+		     (void *) worker,
+		     &worker_error ) != 1 )
+		{
+			libcerror_error_set(
+			 &worker_error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread: %d.",
+			 function,
+			 number_of_threads );
+
+			libqcow_consistency_check_set_worker_error(
+			 consistency_check,
+			 &worker_error );
+
+			libqcow_consistency_check_stop(
+			 consistency_check,
+			 NULL );
+
+			break;
+		}
+	}
+#endif
+	if( libqcow_consistency_check_worker_run(
+	     consistency_check,
+	     0,
+	     &worker_error ) != 1 )
+	{
+		libqcow_consistency_check_set_worker_error(
+		 consistency_check,
+		 &worker_error );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( worker_index = 1;
+	     worker_index < number_of_threads;
+	     worker_index++ )
+	{
+		worker = &( consistency_check->workers[ worker_index ] );
+
+		if( libcthreads_thread_join(
+		     &( worker->thread ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread: %d.",
+			 function,
+			 worker_index );
+
+			consistency_check->result = -1;
+		}
+	}
+#endif
+	if( consistency_check->result == -1 )
+	{
+		/* The error of the worker that failed is passed to the caller
+		 */
+		if( ( error != NULL )
+		 && ( *error == NULL ) )
+		{
+			*error                          = consistency_check->worker_error;
+			consistency_check->worker_error = NULL;
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to check level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	for( worker_index = 0;
+	     worker_index < consistency_check->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( consistency_check->workers[ worker_index ] );
+
+		for( value_index = 0;
+		     value_index < LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES;
+		     value_index++ )
+		{
+			consistency_check->values[ value_index ] += worker->values[ value_index ];
+		}
+	}
+	return( 1 );
+}
+
+/* Compares the reference count of every host cluster block with the number of references
+ * A reference count lower than the number of references is an error, since the cluster
+ * block can be reallocated while it is in use, and a reference count higher than the
+ * number of references is a leak
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_consistency_check_compare_reference_counts(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_consistency_check_compare_reference_counts";
+	uint64_t cluster_block_index           = 0;
+	uint64_t number_of_references          = 0;
+	uint64_t reference_count               = 0;
+
+	if( consistency_check == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid consistency check.",
+		 function );
+
+		return( -1 );
+	}
+	if( consistency_check->reference_map == NULL )
+	{
+		return( 1 );
+	}
+	internal_file = (libqcow_internal_file_t *) consistency_check->file;
+
+	for( cluster_block_index = 0;
+	     cluster_block_index < consistency_check->number_of_host_clusters;
+	     cluster_block_index++ )
+	{
+		if( internal_file->abort != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_ABORT_REQUESTED,
+			 "%s: abort requested.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_reference_count_table_get_reference_count(
+		     internal_file->reference_count_table,
+		     file_io_handle,
+		     cluster_block_index,
+		     &reference_count,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve reference count of cluster block: %" PRIu64 ".",
+			 function,
+			 cluster_block_index );
+
+			return( -1 );
+		}
+		number_of_references = (uint64_t) consistency_check->reference_map[ cluster_block_index ];
+
+		/* The reference map saturates at 255 references
+		 */
+		if( number_of_references == 0xff )
+		{
+			if( reference_count < 0xff )
+			{
+				consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_REFERENCE_COUNT_ERRORS ] += 1;
+			}
+		}
+		else if( reference_count < number_of_references )
+		{
+			consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_REFERENCE_COUNT_ERRORS ] += 1;
+		}
+		else if( reference_count > number_of_references )
+		{
+			consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_LEAKED_CLUSTERS ] += 1;
+		}
+	}
+	return( 1 );
+}
+
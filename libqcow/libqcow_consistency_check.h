@@ -0,0 +1,252 @@
+/*
+ * Consistency check functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CONSISTENCY_CHECK_H )
+#define _LIBQCOW_CONSISTENCY_CHECK_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_compression.h"
+#include "libqcow_definitions.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_consistency_check libqcow_consistency_check_t;
+typedef struct libqcow_consistency_check_worker libqcow_consistency_check_worker_t;
+
+/* A worker checks level 2 tables using its own reader of the file
+ */
+struct libqcow_consistency_check_worker
+{
+	/* The consistency check
+	 */
+	libqcow_consistency_check_t *consistency_check;
+
+	/* The reader
+	 */
+	libqcow_file_t *reader;
+
+	/* The IO scheduler of the reader
+	 */
+	libqcow_io_scheduler_t *io_scheduler;
+
+	/* The data of the level 2 tables that are read at once
+	 */
+	uint8_t *level2_tables_data;
+
+	/* The referenced host ranges of a level 2 table, stored as pairs of offset and size
+	 */
+	uint64_t *host_ranges;
+
+	/* The number of referenced host ranges
+	 */
+	int number_of_host_ranges;
+
+	/* The compressed data
+	 */
+	uint8_t *compressed_data;
+
+	/* The uncompressed data
+	 */
+	uint8_t *uncompressed_data;
+
+	/* The decompression context
+	 */
+	libqcow_decompression_context_t *decompression_context;
+
+	/* The values determined by the worker
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES ];
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+#endif
+};
+
+/* The level 1 tables are read first, the level 2 tables they reference are
+ * sorted by offset and taken by the workers in runs of adjacent tables, so
+ * that the metadata is read in large sequential reads. The references found
+ * by the workers are counted in the reference map, which is compared with the
+ * reference counts of the file afterwards
+ */
+struct libqcow_consistency_check
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The flags
+	 */
+	int flags;
+
+	/* The size of the file
+	 */
+	size64_t file_size;
+
+	/* The reference map, which contains a saturating reference counter per host cluster block
+	 * NULL if the file does not define reference counts
+	 */
+	uint8_t *reference_map;
+
+	/* The number of host cluster blocks
+	 */
+	uint64_t number_of_host_clusters;
+
+	/* The offsets of the level 2 tables, one per level 1 table reference
+	 */
+	uint64_t *level2_table_offsets;
+
+	/* The number of level 2 table offsets
+	 */
+	int number_of_level2_table_offsets;
+
+	/* The number of allocated level 2 table offsets
+	 */
+	int number_of_allocated_level2_table_offsets;
+
+	/* The index of the next level 2 table offset to take
+	 */
+	int next_level2_table_index;
+
+	/* The values
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES ];
+
+	/* The workers
+	 */
+	libqcow_consistency_check_worker_t *workers;
+
+	/* The number of workers
+	 */
+	int number_of_workers;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+	/* The result, 1 if completed or -1 on error
+	 */
+	int result;
+
+	/* The error of the first worker that failed
+	 */
+	libcerror_error_t *worker_error;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+int libqcow_consistency_check_initialize(
+     libqcow_consistency_check_t **consistency_check,
+     libqcow_file_t *file,
+     int flags,
+     int number_of_workers,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_free(
+     libqcow_consistency_check_t **consistency_check,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_append_level2_table_offset(
+     libqcow_consistency_check_t *consistency_check,
+     uint64_t level2_table_offset,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_read_level1_table(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     off64_t level1_table_offset,
+     size_t level1_table_size,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_read_metadata(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_get_next_level2_tables(
+     libqcow_consistency_check_t *consistency_check,
+     int *level2_table_index,
+     int *number_of_level2_tables,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_verify_compressed_cluster_block(
+     libqcow_consistency_check_worker_t *worker,
+     libbfio_handle_t *file_io_handle,
+     uint64_t compressed_cluster_block_offset,
+     size_t compressed_cluster_block_size,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_check_level2_table(
+     libqcow_consistency_check_worker_t *worker,
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *level2_table_data,
+     int number_of_references,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_worker_run(
+     libqcow_consistency_check_t *consistency_check,
+     int worker_index,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_stop(
+     libqcow_consistency_check_t *consistency_check,
+     libcerror_error_t **error );
+
+void libqcow_consistency_check_set_worker_error(
+      libqcow_consistency_check_t *consistency_check,
+      libcerror_error_t **worker_error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_consistency_check_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_consistency_check_run(
+     libqcow_consistency_check_t *consistency_check,
+     libcerror_error_t **error );
+
+int libqcow_consistency_check_compare_reference_counts(
+     libqcow_consistency_check_t *consistency_check,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CONSISTENCY_CHECK_H ) */
+
@@ -0,0 +1,2915 @@
+/*
+ * Creator functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#include "libqcow_compression.h"
+#include "libqcow_creator.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_unused.h"
+#include "libqcow_zero_block.h"
+
+#include "qcow_file_header.h"
+
+/* Creates a creator task
+ * Make sure the value creator_task is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_task_initialize(
+     libqcow_creator_task_t **creator_task,
+     size_t cluster_block_size,
+     uint16_t compression_method,
+     int8_t compression_level,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_task_initialize";
+
+	if( creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator task.",
+		 function );
+
+		return( -1 );
+	}
+	if( *creator_task != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid creator task value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size <= 512 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*creator_task = memory_allocate_structure(
+	                 libqcow_creator_task_t );
+
+	if( *creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create creator task.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *creator_task,
+	     0,
+	     sizeof( libqcow_creator_task_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear creator task.",
+		 function );
+
+		memory_free(
+		 *creator_task );
+
+		*creator_task = NULL;
+
+		return( -1 );
+	}
+	( *creator_task )->data = (uint8_t *) memory_allocate(
+	                                       sizeof( uint8_t ) * cluster_block_size );
+
+	if( ( *creator_task )->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create data.",
+		 function );
+
+		goto on_error;
+	}
+	/* Compressed data is only stored if it saves at least one 512-byte sector
+	 */
+	( *creator_task )->compressed_data = (uint8_t *) memory_allocate(
+	                                                  sizeof( uint8_t ) * ( cluster_block_size - 512 ) );
+
+	if( ( *creator_task )->compressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create compressed data.",
+		 function );
+
+		goto on_error;
+	}
+	( *creator_task )->cluster_block_size = cluster_block_size;
+	( *creator_task )->compression_method = compression_method;
+	( *creator_task )->compression_level  = compression_level;
+
+	return( 1 );
+
+on_error:
+	if( *creator_task != NULL )
+	{
+		if( ( *creator_task )->data != NULL )
+		{
+			memory_free(
+			 ( *creator_task )->data );
+		}
+		memory_free(
+		 *creator_task );
+
+		*creator_task = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a creator task
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_task_free(
+     libqcow_creator_task_t **creator_task,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_task_free";
+
+	if( creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator task.",
+		 function );
+
+		return( -1 );
+	}
+	if( *creator_task != NULL )
+	{
+		memory_free(
+		 ( *creator_task )->compressed_data );
+
+		memory_free(
+		 ( *creator_task )->data );
+
+		memory_free(
+		 *creator_task );
+
+		*creator_task = NULL;
+	}
+	return( 1 );
+}
+
+/* Processes a creator task
+ * The compressed data size is set to 0 if the cluster block does not compress
+ * to less than the cluster block size minus one 512-byte sector
+ * Cluster blocks that contain only 0-byte values are not compressed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_task_process(
+     libqcow_creator_task_t *creator_task,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_task_process";
+	int result            = 0;
+
+	if( creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator task.",
+		 function );
+
+		return( -1 );
+	}
+	creator_task->compressed_data_size = 0;
+
+	result = libqcow_zero_block_is_zero(
+	          creator_task->data,
+	          creator_task->cluster_block_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to determine if cluster block: %" PRIu64 " is zero.",
+		 function,
+		 creator_task->cluster_block_index );
+
+		return( -1 );
+	}
+	creator_task->is_zero = (uint8_t) result;
+
+	if( creator_task->is_zero != 0 )
+	{
+		return( 1 );
+	}
+	creator_task->compressed_data_size = creator_task->cluster_block_size - 512;
+
+	result = libqcow_compress_data(
+	          creator_task->compressed_data,
+	          &( creator_task->compressed_data_size ),
+	          creator_task->compression_method,
+	          creator_task->compression_level,
+	          creator_task->data,
+	          creator_task->cluster_block_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+		 "%s: unable to compress cluster block: %" PRIu64 ".",
+		 function,
+		 creator_task->cluster_block_index );
+
+		creator_task->compressed_data_size = 0;
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		creator_task->compressed_data_size = 0;
+	}
+	return( 1 );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Callback function that is called by the creator thread pool to process a task
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_task_thread_pool_callback(
+     libqcow_creator_task_t *creator_task,
+     void *arguments LIBQCOW_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "libqcow_creator_task_thread_pool_callback";
+
+	LIBQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( creator_task == NULL )
+	{
+		return( -1 );
+	}
+	creator_task->result = libqcow_creator_task_process(
+	                        creator_task,
+	                        &error );
+
+	if( creator_task->result != 1 )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+	}
+	if( libcthreads_queue_push(
+	     creator_task->completed_queue,
+	     (intptr_t *) creator_task,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+		 "%s: unable to push creator task onto completed queue.",
+		 function );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Creates a creator
+ * The cluster block size must be a power of 2 between 1024 and 2 MiB
+ * A number of threads of 0 compresses the cluster blocks in the calling thread
+ * Make sure the value creator is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_initialize(
+     libqcow_creator_t **creator,
+     libbfio_handle_t *file_io_handle,
+     size64_t media_size,
+     size_t cluster_block_size,
+     uint16_t compression_method,
+     int8_t compression_level,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	static char *function           = "libqcow_creator_initialize";
+	size_t level2_tables_data_size  = 0;
+	uint64_t level2_table_entries   = 0;
+	uint8_t number_of_block_bits    = 0;
+	int task_index                  = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( *creator != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid creator value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( media_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid media size value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	for( number_of_block_bits = 10;
+	     number_of_block_bits <= 21;
+	     number_of_block_bits++ )
+	{
+		if( cluster_block_size == ( (size_t) 1 << number_of_block_bits ) )
+		{
+			break;
+		}
+	}
+	if( number_of_block_bits > 21 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported cluster block size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compression_method != LIBQCOW_COMPRESSION_METHOD_DEFLATE )
+	 && ( compression_method != LIBQCOW_COMPRESSION_METHOD_ZSTD ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported compression method.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > 256 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_threads > 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: multi-threading not supported.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	/* Every level 2 table contains the references of a cluster block of references
+	 */
+	level2_table_entries = (uint64_t) cluster_block_size / 8;
+
+	*creator = memory_allocate_structure(
+	            libqcow_creator_t );
+
+	if( *creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create creator.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *creator,
+	     0,
+	     sizeof( libqcow_creator_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear creator.",
+		 function );
+
+		memory_free(
+		 *creator );
+
+		*creator = NULL;
+
+		return( -1 );
+	}
+	( *creator )->number_of_cluster_blocks = ( media_size + cluster_block_size - 1 ) >> number_of_block_bits;
+	( *creator )->level1_table_size        = ( ( *creator )->number_of_cluster_blocks + level2_table_entries - 1 ) / level2_table_entries;
+
+	if( ( *creator )->level1_table_size > (uint64_t) ( ( SSIZE_MAX / cluster_block_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	level2_tables_data_size = (size_t) ( ( *creator )->level1_table_size * cluster_block_size );
+
+	( *creator )->level2_tables_data = (uint8_t *) memory_allocate(
+	                                                sizeof( uint8_t ) * level2_tables_data_size );
+
+	if( ( *creator )->level2_tables_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 tables data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *creator )->level2_tables_data,
+	     0,
+	     level2_tables_data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear level 2 tables data.",
+		 function );
+
+		goto on_error;
+	}
+	( *creator )->write_buffer = (uint8_t *) memory_allocate(
+	                                          sizeof( uint8_t ) * LIBQCOW_CREATOR_WRITE_BUFFER_SIZE );
+
+	if( ( *creator )->write_buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create write buffer.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_threads == 0 )
+	{
+		( *creator )->number_of_tasks = 1;
+	}
+	else
+	{
+		( *creator )->number_of_tasks = number_of_threads * LIBQCOW_CREATOR_NUMBER_OF_TASKS_PER_THREAD;
+	}
+	( *creator )->tasks = (libqcow_creator_task_t **) memory_allocate(
+	                                                   sizeof( libqcow_creator_task_t * ) * ( *creator )->number_of_tasks );
+
+	if( ( *creator )->tasks == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create tasks.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *creator )->tasks,
+	     0,
+	     sizeof( libqcow_creator_task_t * ) * ( *creator )->number_of_tasks ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear tasks.",
+		 function );
+
+		goto on_error;
+	}
+	for( task_index = 0;
+	     task_index < ( *creator )->number_of_tasks;
+	     task_index++ )
+	{
+		if( libqcow_creator_task_initialize(
+		     &( ( ( *creator )->tasks )[ task_index ] ),
+		     cluster_block_size,
+		     compression_method,
+		     compression_level,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create task: %d.",
+			 function,
+			 task_index );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_threads > 0 )
+	{
+		if( libcthreads_queue_initialize(
+		     &( ( *creator )->completed_queue ),
+		     ( *creator )->number_of_tasks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create completed queue.",
+			 function );
+
+			goto on_error;
+		}
+		for( task_index = 0;
+		     task_index < ( *creator )->number_of_tasks;
+		     task_index++ )
+		{
+			( ( *creator )->tasks )[ task_index ]->completed_queue = ( *creator )->completed_queue;
+		}
+		if( libcthreads_thread_pool_create(
+		     &( ( *creator )->thread_pool ),
+		     NULL,
+		     number_of_threads,
+		     ( *creator )->number_of_tasks,
+		     (int (*)(intptr_t *, void *)) &libqcow_creator_task_thread_pool_callback,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread pool.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	/* The file header is stored in the first cluster followed by the cluster blocks
+	 */
+	( *creator )->file_io_handle               = file_io_handle;
+	( *creator )->media_size                   = media_size;
+	( *creator )->cluster_block_size           = cluster_block_size;
+	( *creator )->number_of_cluster_block_bits = number_of_block_bits;
+	( *creator )->compression_method           = compression_method;
+	( *creator )->compression_level            = compression_level;
+	( *creator )->write_buffer_offset          = (off64_t) cluster_block_size;
+
+	return( 1 );
+
+on_error:
+	if( *creator != NULL )
+	{
+		libqcow_creator_free(
+		 creator,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Frees a creator
+ * The file IO handle is not closed or freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_free(
+     libqcow_creator_t **creator,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_free";
+	int result            = 1;
+	int task_index        = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( *creator != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( ( *creator )->thread_pool != NULL )
+		{
+			if( libcthreads_thread_pool_join(
+			     &( ( *creator )->thread_pool ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to join thread pool.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( ( *creator )->completed_queue != NULL )
+		{
+			if( libcthreads_queue_free(
+			     &( ( *creator )->completed_queue ),
+			     NULL,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free completed queue.",
+				 function );
+
+				result = -1;
+			}
+		}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+		if( ( *creator )->tasks != NULL )
+		{
+			for( task_index = 0;
+			     task_index < ( *creator )->number_of_tasks;
+			     task_index++ )
+			{
+				if( libqcow_creator_task_free(
+				     &( ( ( *creator )->tasks )[ task_index ] ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free task: %d.",
+					 function,
+					 task_index );
+
+					result = -1;
+				}
+			}
+			memory_free(
+			 ( *creator )->tasks );
+		}
+		if( ( *creator )->write_buffer != NULL )
+		{
+			memory_free(
+			 ( *creator )->write_buffer );
+		}
+		if( ( *creator )->data_reference_counts != NULL )
+		{
+			memory_free(
+			 ( *creator )->data_reference_counts );
+		}
+		if( ( *creator )->level2_tables_data != NULL )
+		{
+			memory_free(
+			 ( *creator )->level2_tables_data );
+		}
+		if( ( *creator )->backing_filename != NULL )
+		{
+			memory_free(
+			 ( *creator )->backing_filename );
+		}
+		memory_free(
+		 *creator );
+
+		*creator = NULL;
+	}
+	return( result );
+}
+
+/* Sets the backing filename
+ * The backing filename is stored in the first cluster after the file header,
+ * hence it must fit in the remainder of the first cluster
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_set_backing_filename(
+     libqcow_creator_t *creator,
+     const uint8_t *backing_filename,
+     size_t backing_filename_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_set_backing_filename";
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator->backing_filename != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid creator - backing filename value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( backing_filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid backing filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( backing_filename_size == 0 )
+	 || ( backing_filename_size > ( creator->cluster_block_size - ( sizeof( qcow_file_header_v3_t ) + 8 ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid backing filename size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	creator->backing_filename = (uint8_t *) memory_allocate(
+	                                         sizeof( uint8_t ) * backing_filename_size );
+
+	if( creator->backing_filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create backing filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     creator->backing_filename,
+	     backing_filename,
+	     backing_filename_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy backing filename.",
+		 function );
+
+		memory_free(
+		 creator->backing_filename );
+
+		creator->backing_filename = NULL;
+
+		return( -1 );
+	}
+	creator->backing_filename_size = backing_filename_size;
+
+	return( 1 );
+}
+
+/* Writes the data in the write buffer to the file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_flush_write_buffer(
+     libqcow_creator_t *creator,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_flush_write_buffer";
+	ssize_t write_count   = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator->write_buffer_data_size == 0 )
+	{
+		return( 1 );
+	}
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               creator->file_io_handle,
+	               creator->write_buffer,
+	               creator->write_buffer_data_size,
+	               creator->write_buffer_offset,
+	               error );
+
+	if( write_count != (ssize_t) creator->write_buffer_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write buffer at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 creator->write_buffer_offset,
+		 creator->write_buffer_offset );
+
+		return( -1 );
+	}
+	creator->write_buffer_offset   += (off64_t) creator->write_buffer_data_size;
+	creator->write_buffer_data_size = 0;
+
+	return( 1 );
+}
+
+/* Appends data to the write buffer
+ * The write buffer is flushed when it is full
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_append_data(
+     libqcow_creator_t *creator,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_append_data";
+	size_t copy_size      = 0;
+	size_t data_offset    = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	while( data_offset < data_size )
+	{
+		copy_size = LIBQCOW_CREATOR_WRITE_BUFFER_SIZE - creator->write_buffer_data_size;
+
+		if( copy_size > ( data_size - data_offset ) )
+		{
+			copy_size = data_size - data_offset;
+		}
+		/* A NULL data appends 0-byte values
+		 */
+		if( data == NULL )
+		{
+			if( memory_set(
+			     &( creator->write_buffer[ creator->write_buffer_data_size ] ),
+			     0,
+			     copy_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to clear write buffer.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		else if( memory_copy(
+		          &( creator->write_buffer[ creator->write_buffer_data_size ] ),
+		          &( data[ data_offset ] ),
+		          copy_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy data to write buffer.",
+			 function );
+
+			return( -1 );
+		}
+		creator->write_buffer_data_size += copy_size;
+		data_offset                     += copy_size;
+
+		if( creator->write_buffer_data_size == LIBQCOW_CREATOR_WRITE_BUFFER_SIZE )
+		{
+			if( libqcow_creator_flush_write_buffer(
+			     creator,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to flush write buffer.",
+				 function );
+
+				return( -1 );
+			}
+		}
+	}
+	return( 1 );
+}
+
+/* Appends 0-byte values to the write buffer up to the next multitude of the alignment
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_align_data(
+     libqcow_creator_t *creator,
+     size_t alignment,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_align_data";
+	uint64_t file_offset  = 0;
+	size_t padding_size   = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( alignment == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid alignment value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	file_offset = (uint64_t) creator->write_buffer_offset + creator->write_buffer_data_size;
+
+	if( ( file_offset % alignment ) != 0 )
+	{
+		padding_size = alignment - (size_t) ( file_offset % alignment );
+
+		if( libqcow_creator_append_data(
+		     creator,
+		     NULL,
+		     padding_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to append padding.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Adds a reference to the host clusters that contain data at a specific file offset
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_add_data_reference(
+     libqcow_creator_t *creator,
+     uint64_t file_offset,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	uint16_t *reallocation                   = NULL;
+	static char *function                    = "libqcow_creator_add_data_reference";
+	uint64_t host_cluster_index              = 0;
+	uint64_t last_host_cluster_index         = 0;
+	uint64_t maximum_number_of_data_clusters = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size == 0 )
+	 || ( file_offset < (uint64_t) creator->cluster_block_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The data host clusters start after the file header in the first cluster
+	 */
+	host_cluster_index      = ( file_offset >> creator->number_of_cluster_block_bits ) - 1;
+	last_host_cluster_index = ( ( file_offset + data_size - 1 ) >> creator->number_of_cluster_block_bits ) - 1;
+
+	if( last_host_cluster_index >= creator->maximum_number_of_data_clusters )
+	{
+		maximum_number_of_data_clusters = creator->maximum_number_of_data_clusters;
+
+		if( maximum_number_of_data_clusters == 0 )
+		{
+			maximum_number_of_data_clusters = 1024;
+		}
+		while( last_host_cluster_index >= maximum_number_of_data_clusters )
+		{
+			maximum_number_of_data_clusters *= 2;
+		}
+		if( maximum_number_of_data_clusters > (uint64_t) ( SSIZE_MAX / sizeof( uint16_t ) ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid maximum number of data clusters value out of bounds.",
+			 function );
+
+			return( -1 );
+		}
+		reallocation = (uint16_t *) memory_reallocate(
+		                             creator->data_reference_counts,
+		                             sizeof( uint16_t ) * (size_t) maximum_number_of_data_clusters );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize data reference counts.",
+			 function );
+
+			return( -1 );
+		}
+		creator->data_reference_counts = reallocation;
+
+		if( memory_set(
+		     &( creator->data_reference_counts[ creator->maximum_number_of_data_clusters ] ),
+		     0,
+		     sizeof( uint16_t ) * (size_t) ( maximum_number_of_data_clusters - creator->maximum_number_of_data_clusters ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear data reference counts.",
+			 function );
+
+			return( -1 );
+		}
+		creator->maximum_number_of_data_clusters = maximum_number_of_data_clusters;
+	}
+	while( host_cluster_index <= last_host_cluster_index )
+	{
+		creator->data_reference_counts[ host_cluster_index ] += 1;
+
+		host_cluster_index++;
+	}
+	if( last_host_cluster_index >= creator->number_of_data_clusters )
+	{
+		creator->number_of_data_clusters = last_host_cluster_index + 1;
+	}
+	return( 1 );
+}
+
+/* Compresses the cluster blocks of a number of tasks
+ * The tasks are processed by the thread pool if available
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_compress_cluster_blocks(
+     libqcow_creator_t *creator,
+     int number_of_tasks,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_compress_cluster_blocks";
+	int task_index        = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libqcow_creator_task_t *creator_task = NULL;
+	int number_of_completed_tasks        = 0;
+	int number_of_pushed_tasks           = 0;
+#endif
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_tasks < 0 )
+	 || ( number_of_tasks > creator->number_of_tasks ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of tasks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( creator->thread_pool != NULL )
+	{
+		for( task_index = 0;
+		     task_index < number_of_tasks;
+		     task_index++ )
+		{
+			if( libcthreads_thread_pool_push(
+			     creator->thread_pool,
+			     (intptr_t *) creator->tasks[ task_index ],
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to push task: %d onto thread pool.",
+				 function,
+				 task_index );
+
+				break;
+			}
+			number_of_pushed_tasks++;
+		}
+		/* The pushed tasks must complete before the tasks can be reused
+		 */
+		while( number_of_completed_tasks < number_of_pushed_tasks )
+		{
+			if( libcthreads_queue_pop(
+			     creator->completed_queue,
+			     (intptr_t **) &creator_task,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to pop task from completed queue.",
+				 function );
+
+				return( -1 );
+			}
+			number_of_completed_tasks++;
+		}
+		if( number_of_pushed_tasks < number_of_tasks )
+		{
+			return( -1 );
+		}
+		for( task_index = 0;
+		     task_index < number_of_tasks;
+		     task_index++ )
+		{
+			if( creator->tasks[ task_index ]->result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+				 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+				 "%s: unable to compress cluster block: %" PRIu64 ".",
+				 function,
+				 creator->tasks[ task_index ]->cluster_block_index );
+
+				return( -1 );
+			}
+		}
+		return( 1 );
+	}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	for( task_index = 0;
+	     task_index < number_of_tasks;
+	     task_index++ )
+	{
+		if( libqcow_creator_task_process(
+		     creator->tasks[ task_index ],
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to process task: %d.",
+			 function,
+			 task_index );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Writes the cluster block of a task
+ * Compressed data is packed at the next 512-byte sector and uncompressed data
+ * is stored at the next cluster boundary
+ * Cluster blocks that contain only 0-byte values are left unallocated, since
+ * without a backing file these read as 0-byte values. With a backing file
+ * the level 2 table entry is marked as a zero cluster block instead
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_write_cluster_block(
+     libqcow_creator_t *creator,
+     libqcow_creator_task_t *creator_task,
+     libcerror_error_t **error )
+{
+	const uint8_t *data              = NULL;
+	static char *function            = "libqcow_creator_write_cluster_block";
+	size_t data_size                 = 0;
+	uint64_t cluster_block_reference = 0;
+	uint64_t file_offset             = 0;
+	uint64_t number_of_sectors       = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator task.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator_task->cluster_block_index >= creator->number_of_cluster_blocks )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid creator task - cluster block index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator_task->is_zero != 0 )
+	{
+		if( creator->backing_filename != NULL )
+		{
+			byte_stream_copy_from_uint64_big_endian(
+			 &( creator->level2_tables_data[ creator_task->cluster_block_index * 8 ] ),
+			 LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_ZERO );
+		}
+		creator->number_of_zero_cluster_blocks += 1;
+
+		return( 1 );
+	}
+	if( creator_task->compressed_data_size > 0 )
+	{
+		if( libqcow_creator_align_data(
+		     creator,
+		     512,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to align data to sector.",
+			 function );
+
+			return( -1 );
+		}
+		data      = creator_task->compressed_data;
+		data_size = creator_task->compressed_data_size;
+
+		file_offset = (uint64_t) creator->write_buffer_offset + creator->write_buffer_data_size;
+
+		/* The number of additional 512-byte sectors that contain compressed data
+		 */
+		number_of_sectors = ( (uint64_t) data_size - 1 ) >> 9;
+
+		cluster_block_reference = ( (uint64_t) 1 << 62 )
+		                        | ( number_of_sectors << ( 62 - ( creator->number_of_cluster_block_bits - 8 ) ) )
+		                        | file_offset;
+
+		creator->number_of_compressed_cluster_blocks += 1;
+	}
+	else
+	{
+		if( libqcow_creator_align_data(
+		     creator,
+		     creator->cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to align data to cluster.",
+			 function );
+
+			return( -1 );
+		}
+		data      = creator_task->data;
+		data_size = creator->cluster_block_size;
+
+		file_offset = (uint64_t) creator->write_buffer_offset + creator->write_buffer_data_size;
+
+		cluster_block_reference = file_offset | LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED;
+	}
+	if( libqcow_creator_add_data_reference(
+	     creator,
+	     file_offset,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to add data reference.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_creator_append_data(
+	     creator,
+	     data,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write cluster block: %" PRIu64 ".",
+		 function,
+		 creator_task->cluster_block_index );
+
+		return( -1 );
+	}
+	byte_stream_copy_from_uint64_big_endian(
+	 &( creator->level2_tables_data[ creator_task->cluster_block_index * 8 ] ),
+	 cluster_block_reference );
+
+	return( 1 );
+}
+
+/* Writes data at a specific file offset
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_write_at_offset(
+     libqcow_creator_t *creator,
+     const uint8_t *data,
+     size_t data_size,
+     off64_t file_offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_creator_write_at_offset";
+	ssize_t write_count   = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               creator->file_io_handle,
+	               data,
+	               data_size,
+	               file_offset,
+	               error );
+
+	if( write_count != (ssize_t) data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Writes the reference count blocks and table after the clusters
+ * Every host cluster has a reference count of 1 except for the clusters that contain
+ * compressed data, which are counted per compressed cluster block
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_write_reference_counts(
+     libqcow_creator_t *creator,
+     uint64_t number_of_clusters,
+     uint64_t *reference_count_table_offset,
+     uint32_t *reference_count_table_clusters,
+     libcerror_error_t **error )
+{
+	uint8_t *reference_count_blocks_data       = NULL;
+	uint8_t *reference_count_table_data        = NULL;
+	static char *function                      = "libqcow_creator_write_reference_counts";
+	size_t reference_count_block_entries       = 0;
+	uint64_t block_index                       = 0;
+	uint64_t cluster_index                     = 0;
+	uint64_t number_of_blocks                  = 1;
+	uint64_t number_of_table_clusters          = 1;
+	uint64_t required_number_of_blocks         = 0;
+	uint64_t required_number_of_table_clusters = 0;
+	uint64_t total_number_of_clusters          = 0;
+	uint16_t reference_count                   = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count_table_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count_table_clusters == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table clusters.",
+		 function );
+
+		return( -1 );
+	}
+	/* A reference count order of 4 corresponds to 16-bit reference counts
+	 */
+	reference_count_block_entries = creator->cluster_block_size / 2;
+
+	/* The reference count blocks and table are stored after the clusters
+	 * and need to cover themselves
+	 */
+	do
+	{
+		total_number_of_clusters = number_of_clusters + number_of_blocks + number_of_table_clusters;
+
+		required_number_of_blocks         = ( total_number_of_clusters + reference_count_block_entries - 1 ) / reference_count_block_entries;
+		required_number_of_table_clusters = ( ( required_number_of_blocks * 8 ) + creator->cluster_block_size - 1 ) / creator->cluster_block_size;
+
+		if( ( required_number_of_blocks <= number_of_blocks )
+		 && ( required_number_of_table_clusters <= number_of_table_clusters ) )
+		{
+			break;
+		}
+		number_of_blocks         = required_number_of_blocks;
+		number_of_table_clusters = required_number_of_table_clusters;
+	}
+	while( 1 );
+
+	if( ( number_of_table_clusters > (uint64_t) UINT32_MAX )
+	 || ( number_of_blocks > (uint64_t) ( SSIZE_MAX / creator->cluster_block_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of reference count blocks value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	reference_count_blocks_data = (uint8_t *) memory_allocate(
+	                                           (size_t) ( number_of_blocks * creator->cluster_block_size ) );
+
+	if( reference_count_blocks_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count blocks data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     reference_count_blocks_data,
+	     0,
+	     (size_t) ( number_of_blocks * creator->cluster_block_size ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count blocks data.",
+		 function );
+
+		goto on_error;
+	}
+	reference_count_table_data = (uint8_t *) memory_allocate(
+	                                          (size_t) ( number_of_table_clusters * creator->cluster_block_size ) );
+
+	if( reference_count_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     reference_count_table_data,
+	     0,
+	     (size_t) ( number_of_table_clusters * creator->cluster_block_size ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count table data.",
+		 function );
+
+		goto on_error;
+	}
+	/* The host cluster index of the data reference counts is relative to the first cluster after the file header
+	 */
+	for( cluster_index = 0;
+	     cluster_index < total_number_of_clusters;
+	     cluster_index++ )
+	{
+		if( ( cluster_index >= 1 )
+		 && ( cluster_index <= creator->number_of_data_clusters ) )
+		{
+			reference_count = creator->data_reference_counts[ cluster_index - 1 ];
+		}
+		else
+		{
+			reference_count = 1;
+		}
+		byte_stream_copy_from_uint16_big_endian(
+		 &( reference_count_blocks_data[ cluster_index * 2 ] ),
+		 reference_count );
+	}
+	for( block_index = 0;
+	     block_index < number_of_blocks;
+	     block_index++ )
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 &( reference_count_table_data[ block_index * 8 ] ),
+		 ( number_of_clusters + block_index ) << creator->number_of_cluster_block_bits );
+	}
+	if( libqcow_creator_write_at_offset(
+	     creator,
+	     reference_count_blocks_data,
+	     (size_t) ( number_of_blocks * creator->cluster_block_size ),
+	     (off64_t) ( number_of_clusters << creator->number_of_cluster_block_bits ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reference count blocks.",
+		 function );
+
+		goto on_error;
+	}
+	*reference_count_table_offset   = ( number_of_clusters + number_of_blocks ) << creator->number_of_cluster_block_bits;
+	*reference_count_table_clusters = (uint32_t) number_of_table_clusters;
+
+	if( libqcow_creator_write_at_offset(
+	     creator,
+	     reference_count_table_data,
+	     (size_t) ( number_of_table_clusters * creator->cluster_block_size ),
+	     (off64_t) *reference_count_table_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 reference_count_table_data );
+
+	memory_free(
+	 reference_count_blocks_data );
+
+	return( 1 );
+
+on_error:
+	if( reference_count_table_data != NULL )
+	{
+		memory_free(
+		 reference_count_table_data );
+	}
+	if( reference_count_blocks_data != NULL )
+	{
+		memory_free(
+		 reference_count_blocks_data );
+	}
+	return( -1 );
+}
+
+/* Writes the (version 3) file header in the first cluster
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_write_file_header(
+     libqcow_creator_t *creator,
+     uint64_t level1_table_offset,
+     uint64_t reference_count_table_offset,
+     uint32_t reference_count_table_clusters,
+     libcerror_error_t **error )
+{
+	uint8_t file_header_data[ sizeof( qcow_file_header_v3_t ) + 8 ];
+
+	static char *function               = "libqcow_creator_write_file_header";
+	uint64_t incompatible_feature_flags = 0;
+	uint8_t compression_type            = LIBQCOW_COMPRESSION_TYPE_DEFLATE;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	/* The 8 bytes after the file header contain the header extension that marks
+	 * the end of the header extensions
+	 */
+	if( memory_set(
+	     file_header_data,
+	     0,
+	     sizeof( qcow_file_header_v3_t ) + 8 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear file header data.",
+		 function );
+
+		return( -1 );
+	}
+	/* A compression type other than deflate requires the compression type feature flag
+	 */
+	if( creator->compression_method == LIBQCOW_COMPRESSION_METHOD_ZSTD )
+	{
+		compression_type           = LIBQCOW_COMPRESSION_TYPE_ZSTD;
+		incompatible_feature_flags = LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_COMPRESSION_TYPE;
+	}
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->signature,
+	 0x514649fbUL );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->format_version,
+	 3 );
+
+	if( creator->backing_filename != NULL )
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v3_t *) file_header_data )->backing_filename_offset,
+		 (uint64_t) ( sizeof( qcow_file_header_v3_t ) + 8 ) );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v3_t *) file_header_data )->backing_filename_size,
+		 (uint32_t) creator->backing_filename_size );
+	}
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->number_of_cluster_block_bits,
+	 (uint32_t) creator->number_of_cluster_block_bits );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->media_size,
+	 creator->media_size );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->number_of_level1_table_references,
+	 (uint32_t) creator->level1_table_size );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->level1_table_offset,
+	 level1_table_offset );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->reference_count_table_offset,
+	 reference_count_table_offset );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->reference_count_table_clusters,
+	 reference_count_table_clusters );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->incompatible_feature_flags,
+	 incompatible_feature_flags );
+
+	/* A reference count order of 4 corresponds to 16-bit reference counts
+	 */
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->reference_count_order,
+	 4 );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v3_t *) file_header_data )->header_size,
+	 (uint32_t) sizeof( qcow_file_header_v3_t ) );
+
+	( (qcow_file_header_v3_t *) file_header_data )->compression_type = compression_type;
+
+	if( libqcow_creator_write_at_offset(
+	     creator,
+	     file_header_data,
+	     sizeof( qcow_file_header_v3_t ) + 8,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator->backing_filename != NULL )
+	{
+		if( libqcow_creator_write_at_offset(
+		     creator,
+		     creator->backing_filename,
+		     creator->backing_filename_size,
+		     (off64_t) ( sizeof( qcow_file_header_v3_t ) + 8 ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write backing filename.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Writes the level 2 tables, level 1 table, reference counts and file header
+ * after the cluster blocks have been written
+ * The file header is written last so that an incomplete image is not recognized as QCOW
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_write_metadata(
+     libqcow_creator_t *creator,
+     libcerror_error_t **error )
+{
+	uint8_t *level1_table_data              = NULL;
+	uint8_t *level2_table_data              = NULL;
+	static char *function                   = "libqcow_creator_write_metadata";
+	size_t level1_table_data_size           = 0;
+	uint64_t level1_table_index             = 0;
+	uint64_t level1_table_offset            = 0;
+	uint64_t number_of_clusters             = 0;
+	uint64_t reference_count_table_offset   = 0;
+	uint32_t reference_count_table_clusters = 0;
+	int result                              = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	level1_table_data_size = (size_t) ( creator->level1_table_size * 8 );
+
+	level1_table_data = (uint8_t *) memory_allocate(
+	                                 sizeof( uint8_t ) * level1_table_data_size );
+
+	if( level1_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 1 table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     level1_table_data,
+	     0,
+	     level1_table_data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear level 1 table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_align_data(
+	     creator,
+	     creator->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to align data to cluster.",
+		 function );
+
+		goto on_error;
+	}
+	/* The level 2 tables are written consecutively after the cluster blocks,
+	 * level 2 tables without allocated cluster blocks are not stored
+	 */
+	for( level1_table_index = 0;
+	     level1_table_index < creator->level1_table_size;
+	     level1_table_index++ )
+	{
+		level2_table_data = &( creator->level2_tables_data[ level1_table_index * creator->cluster_block_size ] );
+
+		result = libqcow_zero_block_is_zero(
+		          level2_table_data,
+		          creator->cluster_block_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to determine if level 2 table: %" PRIu64 " is empty.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			continue;
+		}
+		byte_stream_copy_from_uint64_big_endian(
+		 &( level1_table_data[ level1_table_index * 8 ] ),
+		 ( (uint64_t) creator->write_buffer_offset + creator->write_buffer_data_size ) | LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED );
+
+		if( libqcow_creator_append_data(
+		     creator,
+		     level2_table_data,
+		     creator->cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write level 2 table: %" PRIu64 ".",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+	}
+	level1_table_offset = (uint64_t) creator->write_buffer_offset + creator->write_buffer_data_size;
+
+	if( libqcow_creator_append_data(
+	     creator,
+	     level1_table_data,
+	     level1_table_data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_align_data(
+	     creator,
+	     creator->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to align level 1 table to cluster.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_flush_write_buffer(
+	     creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to flush write buffer.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 level1_table_data );
+
+	level1_table_data = NULL;
+
+	number_of_clusters = (uint64_t) creator->write_buffer_offset >> creator->number_of_cluster_block_bits;
+
+	if( libqcow_creator_write_reference_counts(
+	     creator,
+	     number_of_clusters,
+	     &reference_count_table_offset,
+	     &reference_count_table_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reference counts.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_write_file_header(
+	     creator,
+	     level1_table_offset,
+	     reference_count_table_offset,
+	     reference_count_table_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( level1_table_data != NULL )
+	{
+		memory_free(
+		 level1_table_data );
+	}
+	return( -1 );
+}
+
+/* Creates the image from the (media) data of a source file IO handle
+ * The cluster blocks are read in batches of the number of tasks, compressed
+ * in parallel and written in media order
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_creator_create_from_file_io_handle(
+     libqcow_creator_t *creator,
+     libbfio_handle_t *source_file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_creator_task_t *creator_task = NULL;
+	static char *function                = "libqcow_creator_create_from_file_io_handle";
+	size_t read_size                     = 0;
+	ssize_t read_count                   = 0;
+	uint64_t cluster_block_index         = 0;
+	off64_t source_offset                = 0;
+	int number_of_tasks                  = 0;
+	int task_index                       = 0;
+
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( source_file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	while( cluster_block_index < creator->number_of_cluster_blocks )
+	{
+		number_of_tasks = creator->number_of_tasks;
+
+		if( (uint64_t) number_of_tasks > ( creator->number_of_cluster_blocks - cluster_block_index ) )
+		{
+			number_of_tasks = (int) ( creator->number_of_cluster_blocks - cluster_block_index );
+		}
+		for( task_index = 0;
+		     task_index < number_of_tasks;
+		     task_index++ )
+		{
+			creator_task = creator->tasks[ task_index ];
+
+			source_offset = (off64_t) ( ( cluster_block_index + task_index ) << creator->number_of_cluster_block_bits );
+			read_size     = creator->cluster_block_size;
+
+			if( (size64_t) read_size > ( creator->media_size - source_offset ) )
+			{
+				read_size = (size_t) ( creator->media_size - source_offset );
+
+				/* The last cluster block is padded with 0-byte values
+				 */
+				if( memory_set(
+				     &( creator_task->data[ read_size ] ),
+				     0,
+				     creator->cluster_block_size - read_size ) == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+					 "%s: unable to clear cluster block data.",
+					 function );
+
+					return( -1 );
+				}
+			}
+			read_count = libbfio_handle_read_buffer_at_offset(
+			              source_file_io_handle,
+			              creator_task->data,
+			              read_size,
+			              source_offset,
+			              error );
+
+			if( read_count != (ssize_t) read_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read source data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 source_offset,
+				 source_offset );
+
+				return( -1 );
+			}
+			creator_task->cluster_block_index = cluster_block_index + task_index;
+		}
+		if( libqcow_creator_compress_cluster_blocks(
+		     creator,
+		     number_of_tasks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+			 "%s: unable to compress cluster blocks.",
+			 function );
+
+			return( -1 );
+		}
+		/* The tasks are written in order of the cluster block index
+		 */
+		for( task_index = 0;
+		     task_index < number_of_tasks;
+		     task_index++ )
+		{
+			if( libqcow_creator_write_cluster_block(
+			     creator,
+			     creator->tasks[ task_index ],
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index + task_index );
+
+				return( -1 );
+			}
+		}
+		cluster_block_index += number_of_tasks;
+	}
+	if( libqcow_creator_write_metadata(
+	     creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write metadata.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Creates a QCOW image with compressed cluster blocks from the data of a source file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_create_compressed_image(
+     const char *source_filename,
+     const char *filename,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *source_file_io_handle = NULL;
+	static char *function                   = "libqcow_create_compressed_image";
+	size_t filename_length                  = 0;
+	size_t source_filename_length           = 0;
+
+	if( source_filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	source_filename_length = narrow_string_length(
+	                          source_filename );
+
+	filename_length = narrow_string_length(
+	                   filename );
+
+	if( ( source_filename_length == 0 )
+	 || ( filename_length == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     source_file_io_handle,
+	     source_filename,
+	     source_filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_create_compressed_image_file_io_handle(
+	     source_file_io_handle,
+	     file_io_handle,
+	     cluster_block_size,
+	     compression_method,
+	     compression_level,
+	     number_of_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to create compressed image using a file handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( source_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &source_file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Creates a QCOW image with compressed cluster blocks from the data of a source file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_create_compressed_image_wide(
+     const wchar_t *source_filename,
+     const wchar_t *filename,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *source_file_io_handle = NULL;
+	static char *function                   = "libqcow_create_compressed_image_wide";
+	size_t filename_length                  = 0;
+	size_t source_filename_length           = 0;
+
+	if( source_filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	source_filename_length = wide_string_length(
+	                          source_filename );
+
+	filename_length = wide_string_length(
+	                   filename );
+
+	if( ( source_filename_length == 0 )
+	 || ( filename_length == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name_wide(
+	     source_file_io_handle,
+	     source_filename,
+	     source_filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name_wide(
+	     file_io_handle,
+	     filename,
+	     filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_create_compressed_image_file_io_handle(
+	     source_file_io_handle,
+	     file_io_handle,
+	     cluster_block_size,
+	     compression_method,
+	     compression_level,
+	     number_of_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to create compressed image using a file handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free source file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( source_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &source_file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Creates a QCOW image with compressed cluster blocks from the data of a source file IO handle
+ * The file IO handles are opened if they are not open, where the destination is truncated
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_create_compressed_image_file_io_handle(
+     libbfio_handle_t *source_file_io_handle,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	libqcow_creator_t *creator        = NULL;
+	static char *function             = "libqcow_create_compressed_image_file_io_handle";
+	size64_t media_size               = 0;
+	int file_io_handle_is_open        = 0;
+	int source_file_io_handle_is_open = 0;
+
+	if( source_file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compression_method < 0 )
+	 || ( compression_method > (int) UINT16_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported compression method.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compression_level < -1 )
+	 || ( compression_level > 22 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid compression level value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_size == 0 )
+	{
+		cluster_block_size = LIBQCOW_CREATOR_DEFAULT_CLUSTER_BLOCK_SIZE;
+	}
+	source_file_io_handle_is_open = libbfio_handle_is_open(
+	                                 source_file_io_handle,
+	                                 error );
+
+	if( source_file_io_handle_is_open == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to determine if source file is open.",
+		 function );
+
+		goto on_error;
+	}
+	else if( source_file_io_handle_is_open == 0 )
+	{
+		if( libbfio_handle_open(
+		     source_file_io_handle,
+		     LIBBFIO_OPEN_READ,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open source file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	file_io_handle_is_open = libbfio_handle_is_open(
+	                          file_io_handle,
+	                          error );
+
+	if( file_io_handle_is_open == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to determine if file is open.",
+		 function );
+
+		goto on_error;
+	}
+	else if( file_io_handle_is_open == 0 )
+	{
+		if( libbfio_handle_open(
+		     file_io_handle,
+		     LIBBFIO_OPEN_WRITE_TRUNCATE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libbfio_handle_get_size(
+	     source_file_io_handle,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve source size.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_initialize(
+	     &creator,
+	     file_io_handle,
+	     media_size,
+	     cluster_block_size,
+	     (uint16_t) compression_method,
+	     (int8_t) compression_level,
+	     number_of_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create creator.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_create_from_file_io_handle(
+	     creator,
+	     source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to create image.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_free(
+	     &creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free creator.",
+		 function );
+
+		goto on_error;
+	}
+	if( file_io_handle_is_open == 0 )
+	{
+		file_io_handle_is_open = 1;
+
+		if( libbfio_handle_close(
+		     file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( source_file_io_handle_is_open == 0 )
+	{
+		source_file_io_handle_is_open = 1;
+
+		if( libbfio_handle_close(
+		     source_file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close source file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( creator != NULL )
+	{
+		libqcow_creator_free(
+		 &creator,
+		 NULL );
+	}
+	if( file_io_handle_is_open == 0 )
+	{
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+	}
+	if( source_file_io_handle_is_open == 0 )
+	{
+		libbfio_handle_close(
+		 source_file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
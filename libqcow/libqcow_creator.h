@@ -0,0 +1,333 @@
+/*
+ * Creator functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_CREATOR_H )
+#define _LIBQCOW_CREATOR_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_extern.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_creator libqcow_creator_t;
+typedef struct libqcow_creator_task libqcow_creator_task_t;
+
+/* A task compresses a single cluster block
+ */
+struct libqcow_creator_task
+{
+	/* The cluster block index
+	 */
+	uint64_t cluster_block_index;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The (uncompressed) data
+	 */
+	uint8_t *data;
+
+	/* The compressed data
+	 */
+	uint8_t *compressed_data;
+
+	/* The compressed data size, 0 if the cluster block is stored uncompressed
+	 */
+	size_t compressed_data_size;
+
+	/* Value to indicate the cluster block contains only 0-byte values
+	 */
+	uint8_t is_zero;
+
+	/* The compression method
+	 */
+	uint16_t compression_method;
+
+	/* The compression level
+	 */
+	int8_t compression_level;
+
+	/* The result of the task
+	 */
+	int result;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The queue the task is pushed onto when it has been processed
+	 */
+	libcthreads_queue_t *completed_queue;
+#endif
+};
+
+/* The creator writes a QCOW version 3 image with compressed cluster blocks,
+ * the cluster blocks are compressed by the tasks and written in media order,
+ * where the level 1, level 2 and reference count tables are kept in memory
+ * and written after the cluster blocks
+ */
+struct libqcow_creator
+{
+	/* The (destination) file IO handle
+	 */
+	libbfio_handle_t *file_io_handle;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The number of cluster block bits
+	 */
+	uint8_t number_of_cluster_block_bits;
+
+	/* The compression method
+	 */
+	uint16_t compression_method;
+
+	/* The compression level
+	 */
+	int8_t compression_level;
+
+	/* The number of cluster blocks
+	 */
+	uint64_t number_of_cluster_blocks;
+
+	/* The level 1 table size, which is the number of level 2 tables
+	 */
+	uint64_t level1_table_size;
+
+	/* The level 2 tables data, which contains the big-endian level 2 table entries
+	 * of all the cluster blocks with the level 2 tables stored consecutively
+	 */
+	uint8_t *level2_tables_data;
+
+	/* The reference counts of the host clusters that contain cluster block data
+	 */
+	uint16_t *data_reference_counts;
+
+	/* The number of host clusters that contain cluster block data
+	 */
+	uint64_t number_of_data_clusters;
+
+	/* The maximum number of host clusters of the data reference counts
+	 */
+	uint64_t maximum_number_of_data_clusters;
+
+	/* The write buffer
+	 */
+	uint8_t *write_buffer;
+
+	/* The size of the data in the write buffer
+	 */
+	size_t write_buffer_data_size;
+
+	/* The file offset of the start of the write buffer
+	 */
+	off64_t write_buffer_offset;
+
+	/* The tasks
+	 */
+	libqcow_creator_task_t **tasks;
+
+	/* The number of tasks
+	 */
+	int number_of_tasks;
+
+	/* The number of compressed cluster blocks
+	 */
+	uint64_t number_of_compressed_cluster_blocks;
+
+	/* The number of cluster blocks that contain only 0-byte values, which are not stored
+	 */
+	uint64_t number_of_zero_cluster_blocks;
+
+	/* The backing filename, which is stored after the file header
+	 */
+	uint8_t *backing_filename;
+
+	/* The backing filename size
+	 */
+	size_t backing_filename_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread pool that compresses the cluster blocks
+	 */
+	libcthreads_thread_pool_t *thread_pool;
+
+	/* The queue of the tasks that have been processed
+	 */
+	libcthreads_queue_t *completed_queue;
+#endif
+};
+
+int libqcow_creator_task_initialize(
+     libqcow_creator_task_t **creator_task,
+     size_t cluster_block_size,
+     uint16_t compression_method,
+     int8_t compression_level,
+     libcerror_error_t **error );
+
+int libqcow_creator_task_free(
+     libqcow_creator_task_t **creator_task,
+     libcerror_error_t **error );
+
+int libqcow_creator_task_process(
+     libqcow_creator_task_t *creator_task,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_creator_task_thread_pool_callback(
+     libqcow_creator_task_t *creator_task,
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_creator_initialize(
+     libqcow_creator_t **creator,
+     libbfio_handle_t *file_io_handle,
+     size64_t media_size,
+     size_t cluster_block_size,
+     uint16_t compression_method,
+     int8_t compression_level,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+int libqcow_creator_free(
+     libqcow_creator_t **creator,
+     libcerror_error_t **error );
+
+int libqcow_creator_set_backing_filename(
+     libqcow_creator_t *creator,
+     const uint8_t *backing_filename,
+     size_t backing_filename_size,
+     libcerror_error_t **error );
+
+int libqcow_creator_flush_write_buffer(
+     libqcow_creator_t *creator,
+     libcerror_error_t **error );
+
+int libqcow_creator_append_data(
+     libqcow_creator_t *creator,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_creator_align_data(
+     libqcow_creator_t *creator,
+     size_t alignment,
+     libcerror_error_t **error );
+
+int libqcow_creator_add_data_reference(
+     libqcow_creator_t *creator,
+     uint64_t file_offset,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_creator_compress_cluster_blocks(
+     libqcow_creator_t *creator,
+     int number_of_tasks,
+     libcerror_error_t **error );
+
+int libqcow_creator_write_cluster_block(
+     libqcow_creator_t *creator,
+     libqcow_creator_task_t *creator_task,
+     libcerror_error_t **error );
+
+int libqcow_creator_write_at_offset(
+     libqcow_creator_t *creator,
+     const uint8_t *data,
+     size_t data_size,
+     off64_t file_offset,
+     libcerror_error_t **error );
+
+int libqcow_creator_write_reference_counts(
+     libqcow_creator_t *creator,
+     uint64_t number_of_clusters,
+     uint64_t *reference_count_table_offset,
+     uint32_t *reference_count_table_clusters,
+     libcerror_error_t **error );
+
+int libqcow_creator_write_file_header(
+     libqcow_creator_t *creator,
+     uint64_t level1_table_offset,
+     uint64_t reference_count_table_offset,
+     uint32_t reference_count_table_clusters,
+     libcerror_error_t **error );
+
+int libqcow_creator_write_metadata(
+     libqcow_creator_t *creator,
+     libcerror_error_t **error );
+
+int libqcow_creator_create_from_file_io_handle(
+     libqcow_creator_t *creator,
+     libbfio_handle_t *source_file_io_handle,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_create_compressed_image(
+     const char *source_filename,
+     const char *filename,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+LIBQCOW_EXTERN \
+int libqcow_create_compressed_image_wide(
+     const wchar_t *source_filename,
+     const wchar_t *filename,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+LIBQCOW_EXTERN \
+int libqcow_create_compressed_image_file_io_handle(
+     libbfio_handle_t *source_file_io_handle,
+     libbfio_handle_t *file_io_handle,
+     size_t cluster_block_size,
+     int compression_method,
+     int compression_level,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_CREATOR_H ) */
+
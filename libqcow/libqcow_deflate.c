@@ -25,8 +25,87 @@
 #include <types.h>
 
 #include "libqcow_deflate.h"
+#include "libqcow_deflate_fixed_huffman_tables.h"
 #include "libqcow_libcerror.h"
 
+/* Reads bits from the byte stream into the bit buffer
+ * The bit buffer is filled with whole bytes upto its capacity of 64 bits or
+ * until the end of the byte stream is reached. If at least 8 bytes
+ * remain in the byte stream they are read at once.
+ * Returns 1 on success, 0 if less than number of bits are available or -1 on error
+ */
+int libqcow_deflate_bit_stream_read(
+     libqcow_deflate_bit_stream_t *bit_stream,
+     uint8_t number_of_bits,
+     libcerror_error_t **error )
+{
+	static char *function   = "libqcow_deflate_bit_stream_read";
+	uint64_t value_64bit    = 0;
+	uint8_t number_of_bytes = 0;
+
+	if( bit_stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bit stream.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_bits > (uint8_t) 56 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid number of bits value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( bit_stream->bit_buffer_size >= number_of_bits )
+	{
+		return( 1 );
+	}
+	number_of_bytes = (uint8_t) ( ( 64 - bit_stream->bit_buffer_size ) / 8 );
+
+	if( ( bit_stream->byte_stream_size - bit_stream->byte_stream_offset ) >= 8 )
+	{
+		byte_stream_copy_to_uint64_little_endian(
+		 &( bit_stream->byte_stream[ bit_stream->byte_stream_offset ] ),
+		 value_64bit );
+
+		if( number_of_bytes < 8 )
+		{
+			value_64bit &= ( (uint64_t) 1 << ( number_of_bytes * 8 ) ) - 1;
+		}
+		bit_stream->bit_buffer         |= value_64bit << bit_stream->bit_buffer_size;
+		bit_stream->bit_buffer_size    += number_of_bytes * 8;
+		bit_stream->byte_stream_offset += number_of_bytes;
+	}
+	else
+	{
+		while( ( number_of_bytes > 0 )
+		    && ( bit_stream->byte_stream_offset < bit_stream->byte_stream_size ) )
+		{
+			value_64bit   = bit_stream->byte_stream[ bit_stream->byte_stream_offset++ ];
+			value_64bit <<= bit_stream->bit_buffer_size;
+
+			bit_stream->bit_buffer      |= value_64bit;
+			bit_stream->bit_buffer_size += 8;
+
+			number_of_bytes--;
+		}
+	}
+	if( bit_stream->bit_buffer_size < number_of_bits )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
 /* Retrieves a value from the bit stream
  * Returns 1 on success or -1 on error
  */
@@ -37,6 +116,7 @@ int libqcow_deflate_bit_stream_get_value(
      libcerror_error_t **error )
 {
 	static char *function = "libqcow_deflate_bit_stream_get_value";
+	int result            = 0;
 
 	if( bit_stream == NULL )
 	{
@@ -77,9 +157,25 @@ int libqcow_deflate_bit_stream_get_value(
 
 		return( 1 );
 	}
-	while( bit_stream->bit_buffer_size < number_of_bits )
+	if( bit_stream->bit_buffer_size < number_of_bits )
 	{
-		if( bit_stream->byte_stream_offset >= bit_stream->byte_stream_size )
+		result = libqcow_deflate_bit_stream_read(
+		          bit_stream,
+		          number_of_bits,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read bits.",
+			 function );
+
+			return( -1 );
+		}
+		else if( result == 0 )
 		{
 			libcerror_error_set(
 			 error,
@@ -90,13 +186,8 @@ int libqcow_deflate_bit_stream_get_value(
 
 			return( -1 );
 		}
-		*value_32bit   = bit_stream->byte_stream[ bit_stream->byte_stream_offset++ ];
-		*value_32bit <<= bit_stream->bit_buffer_size;
-
-		bit_stream->bit_buffer      |= *value_32bit;
-		bit_stream->bit_buffer_size += 8;
 	}
-	*value_32bit = bit_stream->bit_buffer & ~( -1L << number_of_bits );
+	*value_32bit = (uint32_t) ( bit_stream->bit_buffer & ( ( (uint64_t) 1 << number_of_bits ) - 1 ) );
 
 	bit_stream->bit_buffer     >>= number_of_bits;
 	bit_stream->bit_buffer_size -= number_of_bits;
@@ -115,12 +206,18 @@ int libqcow_deflate_huffman_table_construct(
 {
 	int code_offsets_array[ 16 ];
 
-	static char *function = "libqcow_deflate_huffman_table_construct";
-	uint16_t code_size    = 0;
-	uint8_t bit_index     = 0;
-	int code_offset       = 0;
-	int left_value        = 0;
-	int symbol            = 0;
+	static char *function    = "libqcow_deflate_huffman_table_construct";
+	uint16_t code_size       = 0;
+	uint16_t lookup_value    = 0;
+	uint8_t bit_index        = 0;
+	uint8_t last_code_size   = 0;
+	int code_offset          = 0;
+	int huffman_code         = 0;
+	int left_value           = 0;
+	int lookup_index         = 0;
+	int number_of_used_codes = 0;
+	int reversed_code        = 0;
+	int symbol               = 0;
 
 	if( table == NULL )
 	{
@@ -290,6 +387,60 @@ int libqcow_deflate_huffman_table_construct(
 		code_offsets_array[ code_size ]  += 1;
 		table->codes_array[ code_offset ] = symbol;
 	}
+	/* Fill the lookup table with the codes that fit into it
+	 * The codes are assigned in order of the sorted symbols and are stored
+	 * most significant bit first in the bit stream, hence the lookup table
+	 * is indexed by the bit reversed code
+	 */
+	if( memory_set(
+	     &( table->lookup_table ),
+	     0,
+	     sizeof( uint16_t ) * ( 1 << LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear lookup table.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_used_codes = number_of_code_sizes - table->code_counts_array[ 0 ];
+
+	for( code_offset = 0;
+	     code_offset < number_of_used_codes;
+	     code_offset++ )
+	{
+		symbol    = table->codes_array[ code_offset ];
+		code_size = code_sizes_array[ symbol ];
+
+		if( code_size > LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS )
+		{
+			break;
+		}
+		huffman_code <<= code_size - last_code_size;
+		last_code_size = (uint8_t) code_size;
+
+		reversed_code = 0;
+
+		for( bit_index = 0;
+		     bit_index < code_size;
+		     bit_index++ )
+		{
+			reversed_code <<= 1;
+			reversed_code  |= ( huffman_code >> bit_index ) & 0x00000001UL;
+		}
+		lookup_value = (uint16_t) ( ( symbol << 4 ) | code_size );
+
+		for( lookup_index = reversed_code;
+		     lookup_index < ( 1 << LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS );
+		     lookup_index += 1 << code_size )
+		{
+			table->lookup_table[ lookup_index ] = lookup_value;
+		}
+		huffman_code++;
+	}
 /* TODO only used by dynamic Huffman
 	if( left_value > 0 )
 	{
@@ -311,12 +462,13 @@ int libqcow_deflate_huffman_table_construct(
  */
 int libqcow_deflate_bit_stream_get_huffman_encoded_value(
      libqcow_deflate_bit_stream_t *bit_stream,
-     libqcow_deflate_huffman_table_t *table,
+     const libqcow_deflate_huffman_table_t *table,
      uint32_t *value_32bit,
      libcerror_error_t **error )
 {
 	static char *function  = "libqcow_deflate_bit_stream_get_huffman_encoded_value";
-	uint32_t bit_buffer    = 0;
+	uint64_t bit_buffer    = 0;
+	uint16_t lookup_value  = 0;
 	uint8_t bit_index      = 0;
 	uint8_t number_of_bits = 0;
 	int code_size_count    = 0;
@@ -360,17 +512,39 @@ int libqcow_deflate_bit_stream_get_huffman_encoded_value(
 	}
 	/* Try to fill the bit buffer with the maximum number of bits
 	 */
-	while( bit_stream->bit_buffer_size < table->maximum_number_of_bits )
+	if( bit_stream->bit_buffer_size < table->maximum_number_of_bits )
 	{
-		if( bit_stream->byte_stream_offset >= bit_stream->byte_stream_size )
+		if( libqcow_deflate_bit_stream_read(
+		     bit_stream,
+		     table->maximum_number_of_bits,
+		     error ) == -1 )
 		{
-			break;
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read bits.",
+			 function );
+
+			return( -1 );
 		}
-		*value_32bit   = bit_stream->byte_stream[ bit_stream->byte_stream_offset++ ];
-		*value_32bit <<= bit_stream->bit_buffer_size;
+	}
+	/* Most codes are decoded with a single lookup, larger codes are decoded
+	 * by walking the code counts
+	 */
+	lookup_value = table->lookup_table[ bit_stream->bit_buffer & ( ( 1 << LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS ) - 1 ) ];
 
-		bit_stream->bit_buffer      |= *value_32bit;
-		bit_stream->bit_buffer_size += 8;
+	number_of_bits = (uint8_t) ( lookup_value & 0x000f );
+
+	if( ( number_of_bits != 0 )
+	 && ( number_of_bits <= bit_stream->bit_buffer_size ) )
+	{
+		*value_32bit = (uint32_t) ( lookup_value >> 4 );
+
+		bit_stream->bit_buffer     >>= number_of_bits;
+		bit_stream->bit_buffer_size -= number_of_bits;
+
+		return( 1 );
 	}
 	if( table->maximum_number_of_bits < bit_stream->bit_buffer_size )
 	{
@@ -704,6 +878,8 @@ int libqcow_deflate_initialize_dynamic_huffman_tables(
 }
 
 /* Initializes the fixed Huffman tables
+ * The decoder uses the precomputed tables in libqcow_deflate_fixed_huffman_tables.c
+ * which must match the tables constructed by this function
  * Returns 1 on success or -1 on error
  */
 int libqcow_deflate_initialize_fixed_huffman_tables(
@@ -775,15 +951,18 @@ int libqcow_deflate_initialize_fixed_huffman_tables(
 }
 
 /* Decodes a Huffman compressed block
- * Returns 1 on success or -1 on error
+ * Decoding stops at the first symbol boundary at or beyond the stop data offset,
+ * where a stop data offset of 0 decodes up to the end of the block
+ * Returns 1 if the end of the block was reached, 0 if decoding stopped or -1 on error
  */
 int libqcow_deflate_decode_huffman(
      libqcow_deflate_bit_stream_t *bit_stream,
-     libqcow_deflate_huffman_table_t *literals_table,
-     libqcow_deflate_huffman_table_t *distances_table,
+     const libqcow_deflate_huffman_table_t *literals_table,
+     const libqcow_deflate_huffman_table_t *distances_table,
      uint8_t *uncompressed_data,
      size_t uncompressed_data_size,
      size_t *uncompressed_data_offset,
+     size_t stop_data_offset,
      libcerror_error_t **error )
 {
 	uint16_t literal_codes_base[ 29 ] = {
@@ -803,7 +982,11 @@ int libqcow_deflate_decode_huffman(
 		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
 		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
 
+	uint8_t *match_data           = NULL;
+	uint8_t *output_data          = NULL;
 	static char *function         = "libqcow_deflate_decode_huffman";
+	size_t copy_distance          = 0;
+	size_t copy_index             = 0;
 	size_t data_offset            = 0;
 	uint32_t code_value           = 0;
 	uint32_t extra_bits           = 0;
@@ -846,8 +1029,18 @@ int libqcow_deflate_decode_huffman(
 	}
 	data_offset = *uncompressed_data_offset;
 
+	if( stop_data_offset == 0 )
+	{
+		stop_data_offset = uncompressed_data_size + 1;
+	}
 	do
 	{
+		if( data_offset >= stop_data_offset )
+		{
+			*uncompressed_data_offset = data_offset;
+
+			return( 0 );
+		}
 		if( libqcow_deflate_bit_stream_get_huffman_encoded_value(
 		     bit_stream,
 		     literals_table,
@@ -958,12 +1151,81 @@ int libqcow_deflate_decode_huffman(
 
 				return( -1 );
 			}
-			while( compression_size > 0 )
+			output_data = &( uncompressed_data[ data_offset ] );
+			match_data  = &( uncompressed_data[ data_offset - compression_offset ] );
+
+			data_offset += compression_size;
+
+			if( ( uncompressed_data_size - data_offset ) < LIBQCOW_DEFLATE_MATCH_COPY_SLACK )
+			{
+				/* Near the end of the uncompressed data the match is copied byte by byte
+				 */
+				while( compression_size > 0 )
+				{
+					*output_data++ = *match_data++;
+
+					compression_size--;
+				}
+			}
+			else if( compression_offset == 1 )
 			{
-				uncompressed_data[ data_offset ] = uncompressed_data[ data_offset - compression_offset ];
+				/* A distance of 1 repeats the preceding byte
+				 */
+				memory_set(
+				 output_data,
+				 *match_data,
+				 (size_t) compression_size );
+			}
+			else
+			{
+				copy_distance = (size_t) compression_offset;
+
+				if( copy_distance < 8 )
+				{
+					/* For a distance of less than 8 the first 8 bytes are copied byte by byte,
+					 * after which the pattern repeats at the first multiple of the distance
+					 * of 8 or more, from which 8 bytes do not overlap
+					 */
+					for( copy_index = 0;
+					     copy_index < 8;
+					     copy_index++ )
+					{
+						output_data[ copy_index ] = match_data[ copy_index ];
+					}
+					copy_distance = ( ( 8 + copy_distance - 1 ) / copy_distance ) * copy_distance;
+
+					output_data += 8;
+					match_data   = output_data - copy_distance;
+
+					compression_size = ( compression_size > 8 ) ? compression_size - 8 : 0;
+				}
+				else if( copy_distance >= 16 )
+				{
+					while( compression_size > 8 )
+					{
+						memory_copy(
+						 output_data,
+						 match_data,
+						 16 );
+
+						output_data += 16;
+						match_data  += 16;
+
+						compression_size = ( compression_size > 16 ) ? compression_size - 16 : 0;
+					}
+				}
+				while( compression_size > 0 )
+				{
+					memory_copy(
+					 output_data,
+					 match_data,
+					 8 );
 
-				data_offset++;
-				compression_size--;
+					output_data += 8;
+					match_data  += 8;
+
+					compression_size = ( compression_size > 8 ) ? compression_size - 8 : 0;
+				}
 			}
 		}
 		else if( code_value != 256 )
@@ -986,32 +1248,43 @@ int libqcow_deflate_decode_huffman(
 	return( 1 );
 }
 
-/* Decompresses data using zlib compression
+/* Decompresses data using zlib compression up to a specific offset
+ * The state and uncompressed data must be the same for every call on the same compressed data,
+ * since the decompression is resumed where the previous call stopped
+ * Decompression stops once at least stop data offset bytes are produced,
+ * where a stop data offset of 0 decompresses the remainder of the compressed data
  * Returns 1 on success or -1 on error
  */
-int libqcow_deflate_decompress(
+int libqcow_deflate_decompress_partial(
+     libqcow_deflate_state_t *state,
      const uint8_t *compressed_data,
      size_t compressed_data_size,
      uint8_t *uncompressed_data,
-     size_t *uncompressed_data_size,
+     size_t uncompressed_data_size,
+     size_t stop_data_offset,
      libcerror_error_t **error )
 {
-	libqcow_deflate_bit_stream_t bit_stream;
-	libqcow_deflate_huffman_table_t dynamic_huffman_distances_table;
-	libqcow_deflate_huffman_table_t dynamic_huffman_literals_table;
-	libqcow_deflate_huffman_table_t fixed_huffman_distances_table;
-	libqcow_deflate_huffman_table_t fixed_huffman_literals_table;
-
-	static char *function           = "libqcow_deflate_decompress";
-	size_t compressed_data_offset   = 0;
-	size_t uncompressed_data_offset = 0;
-	uint32_t block_size             = 0;
-	uint32_t block_size_copy        = 0;
-	uint32_t value_32bit            = 0;
-	uint8_t block_type              = 0;
-	uint8_t last_block_flag         = 0;
-	uint8_t skip_bits               = 0;
+	libqcow_deflate_bit_stream_t *bit_stream                = NULL;
+	const libqcow_deflate_huffman_table_t *distances_table = NULL;
+	const libqcow_deflate_huffman_table_t *literals_table  = NULL;
+	static char *function                                  = "libqcow_deflate_decompress_partial";
+	uint32_t block_size                                    = 0;
+	uint32_t block_size_copy                               = 0;
+	uint32_t value_32bit                                   = 0;
+	uint8_t skip_bits                                      = 0;
+	int result                                             = 0;
+
+	if( state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid state.",
+		 function );
 
+		return( -1 );
+	}
 	if( compressed_data == NULL )
 	{
 		libcerror_error_set(
@@ -1045,95 +1318,125 @@ int libqcow_deflate_decompress(
 
 		return( -1 );
 	}
-	if( uncompressed_data_size == NULL )
+	if( uncompressed_data_size > (size_t) SSIZE_MAX )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid uncompressed data size.",
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid uncompressed data size value exceeds maximum.",
 		 function );
 
 		return( -1 );
 	}
-	if( *uncompressed_data_size > (size_t) SSIZE_MAX )
+	if( state->uncompressed_data_offset > uncompressed_data_size )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid uncompressed data size value exceeds maximum.",
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid state - uncompressed data offset value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
-	if( compressed_data_offset >= compressed_data_size )
+	bit_stream = &( state->bit_stream );
+
+	if( bit_stream->byte_stream == NULL )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
-		 "%s: invalid compressed data value too small.",
-		 function );
+		if( compressed_data_size == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+			 "%s: invalid compressed data value too small.",
+			 function );
 
-		return( -1 );
+			return( -1 );
+		}
+		bit_stream->byte_stream_offset = 0;
+		bit_stream->bit_buffer         = 0;
+		bit_stream->bit_buffer_size    = 0;
 	}
-	bit_stream.byte_stream        = compressed_data;
-	bit_stream.byte_stream_size   = compressed_data_size;
-	bit_stream.byte_stream_offset = compressed_data_offset;
-	bit_stream.bit_buffer         = 0;
-	bit_stream.bit_buffer_size    = 0;
-
-	if( libqcow_deflate_initialize_fixed_huffman_tables(
-	     &fixed_huffman_literals_table,
-	     &fixed_huffman_distances_table,
-	     error ) != 1 )
+	else if( bit_stream->byte_stream_offset > compressed_data_size )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to construct fixed Huffman tables.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid state - byte stream offset value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
+	bit_stream->byte_stream      = compressed_data;
+	bit_stream->byte_stream_size = compressed_data_size;
 
-/* TODO find optimized solution to read bit stream from bytes */
-	while( bit_stream.byte_stream_offset < bit_stream.byte_stream_size )
+	while( state->is_complete == 0 )
 	{
-		if( libqcow_deflate_bit_stream_get_value(
-		     &bit_stream,
-		     3,
-		     &value_32bit,
-		     error ) != 1 )
+		if( ( stop_data_offset != 0 )
+		 && ( state->uncompressed_data_offset >= stop_data_offset ) )
 		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-			 "%s: unable to retrieve value from bit stream.",
-			 function );
-
-			return( -1 );
+			break;
 		}
-		last_block_flag = (uint8_t) ( value_32bit & 0x00000001UL );
-		value_32bit   >>= 1;
-		block_type      = (uint8_t) value_32bit;
-
-		switch( block_type )
+		if( state->block_is_open == 0 )
 		{
-			case LIBQCOW_DEFLATE_BLOCK_TYPE_UNCOMPRESSED:
-				/* Ignore the bits in the buffer upto the next byte
-				 */
-				skip_bits = bit_stream.bit_buffer_size & 0x07;
+			if( ( bit_stream->byte_stream_offset >= bit_stream->byte_stream_size )
+			 && ( bit_stream->bit_buffer_size < 3 ) )
+			{
+				state->is_complete = 1;
 
-				if( skip_bits > 0 )
-				{
+				break;
+			}
+			if( libqcow_deflate_bit_stream_get_value(
+			     bit_stream,
+			     3,
+			     &value_32bit,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve value from bit stream.",
+				 function );
+
+				return( -1 );
+			}
+			state->last_block_flag = (uint8_t) ( value_32bit & 0x00000001UL );
+			value_32bit          >>= 1;
+			state->block_type      = (uint8_t) value_32bit;
+
+			switch( state->block_type )
+			{
+				case LIBQCOW_DEFLATE_BLOCK_TYPE_UNCOMPRESSED:
+					/* Ignore the bits in the buffer upto the next byte
+					 */
+					skip_bits = bit_stream->bit_buffer_size & 0x07;
+
+					if( skip_bits > 0 )
+					{
+						if( libqcow_deflate_bit_stream_get_value(
+						     bit_stream,
+						     skip_bits,
+						     &value_32bit,
+						     error ) != 1 )
+						{
+							libcerror_error_set(
+							 error,
+							 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+							 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+							 "%s: unable to retrieve value from bit stream.",
+							 function );
+
+							return( -1 );
+						}
+					}
 					if( libqcow_deflate_bit_stream_get_value(
-					     &bit_stream,
-					     skip_bits,
-					     &value_32bit,
+					     bit_stream,
+					     32,
+					     &block_size,
 					     error ) != 1 )
 					{
 						libcerror_error_set(
@@ -1145,157 +1448,218 @@ int libqcow_deflate_decompress(
 
 						return( -1 );
 					}
-				}
-				if( libqcow_deflate_bit_stream_get_value(
-				     &bit_stream,
-				     32,
-				     &block_size,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-					 "%s: unable to retrieve value from bit stream.",
-					 function );
+					/* The bit buffer can contain bytes read ahead of the uncompressed data
+					 * hence these are returned to the byte stream
+					 */
+					bit_stream->byte_stream_offset -= bit_stream->bit_buffer_size / 8;
+					bit_stream->bit_buffer          = 0;
+					bit_stream->bit_buffer_size     = 0;
 
-					return( -1 );
-				}
-				block_size_copy = ( block_size >> 16 ) ^ 0x0000ffffUL;
-				block_size     &= 0x0000ffffUL;
+					block_size_copy = ( block_size >> 16 ) ^ 0x0000ffffUL;
+					block_size     &= 0x0000ffffUL;
 
-				if( block_size != block_size_copy )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_INPUT,
-					 LIBCERROR_INPUT_ERROR_VALUE_MISMATCH,
-					 "%s: mismatch in block size ( %" PRIu32 " != %" PRIu32 " ).",
-					 function,
-					 block_size,
-					 block_size_copy );
+					if( block_size != block_size_copy )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_INPUT,
+						 LIBCERROR_INPUT_ERROR_VALUE_MISMATCH,
+						 "%s: mismatch in block size ( %" PRIu32 " != %" PRIu32 " ).",
+						 function,
+						 block_size,
+						 block_size_copy );
 
-					return( -1 );
-				}
-				if( block_size == 0 )
-				{
-					break;
-				}
-				if( (size_t) block_size > ( bit_stream.byte_stream_size - bit_stream.byte_stream_offset ) )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-					 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
-					 "%s: invalid compressed data value too small.",
-					 function );
+						return( -1 );
+					}
+					if( block_size == 0 )
+					{
+						break;
+					}
+					if( (size_t) block_size > ( bit_stream->byte_stream_size - bit_stream->byte_stream_offset ) )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+						 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+						 "%s: invalid compressed data value too small.",
+						 function );
 
-					return( -1 );
-				}
-				if( (size_t) block_size > ( *uncompressed_data_size - uncompressed_data_offset ) )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-					 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
-					 "%s: invalid uncompressed data value too small.",
-					 function );
+						return( -1 );
+					}
+					if( (size_t) block_size > ( uncompressed_data_size - state->uncompressed_data_offset ) )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+						 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+						 "%s: invalid uncompressed data value too small.",
+						 function );
 
-					return( -1 );
-				}
-				if( memory_copy(
-				     &( uncompressed_data[ uncompressed_data_offset ] ),
-				     &( compressed_data[ bit_stream.byte_stream_offset ] ),
-				     (size_t) block_size ) == NULL )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_MEMORY,
-					 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-					 "%s: unable to initialize lz buffer.",
-					 function );
+						return( -1 );
+					}
+					/* An uncompressed block is copied at once
+					 */
+					if( memory_copy(
+					     &( uncompressed_data[ state->uncompressed_data_offset ] ),
+					     &( compressed_data[ bit_stream->byte_stream_offset ] ),
+					     (size_t) block_size ) == NULL )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_MEMORY,
+						 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+						 "%s: unable to initialize lz buffer.",
+						 function );
 
-					return( -1 );
-				}
-				bit_stream.byte_stream_offset += block_size;
-				uncompressed_data_offset      += block_size;
+						return( -1 );
+					}
+					bit_stream->byte_stream_offset  += block_size;
+					state->uncompressed_data_offset += block_size;
 
-				break;
+					break;
 
-			case LIBQCOW_DEFLATE_BLOCK_TYPE_HUFFMAN_FIXED:
-				if( libqcow_deflate_decode_huffman(
-				     &bit_stream,
-				     &fixed_huffman_literals_table,
-				     &fixed_huffman_distances_table,
-				     uncompressed_data,
-				     *uncompressed_data_size,
-				     &uncompressed_data_offset,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-					 "%s: unable to decode fixed Huffman encoded bit stream.",
-					 function );
+				case LIBQCOW_DEFLATE_BLOCK_TYPE_HUFFMAN_FIXED:
+					state->block_is_open = 1;
 
-					return( -1 );
-				}
-				break;
+					break;
 
-			case LIBQCOW_DEFLATE_BLOCK_TYPE_HUFFMAN_DYNAMIC:
-				if( libqcow_deflate_initialize_dynamic_huffman_tables(
-				     &bit_stream,
-				     &dynamic_huffman_literals_table,
-				     &dynamic_huffman_distances_table,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-					 "%s: unable to construct dynamic Huffman tables.",
-					 function );
+				case LIBQCOW_DEFLATE_BLOCK_TYPE_HUFFMAN_DYNAMIC:
+					if( libqcow_deflate_initialize_dynamic_huffman_tables(
+					     bit_stream,
+					     &( state->dynamic_huffman_literals_table ),
+					     &( state->dynamic_huffman_distances_table ),
+					     error ) != 1 )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+						 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+						 "%s: unable to construct dynamic Huffman tables.",
+						 function );
 
-					return( -1 );
-				}
-				if( libqcow_deflate_decode_huffman(
-				     &bit_stream,
-				     &dynamic_huffman_literals_table,
-				     &dynamic_huffman_distances_table,
-				     uncompressed_data,
-				     *uncompressed_data_size,
-				     &uncompressed_data_offset,
-				     error ) != 1 )
-				{
+						return( -1 );
+					}
+					state->block_is_open = 1;
+
+					break;
+
+				case LIBQCOW_DEFLATE_BLOCK_TYPE_RESERVED:
+				default:
 					libcerror_error_set(
 					 error,
 					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-					 "%s: unable to decode dynamic Huffman encoded bit stream.",
+					 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+					 "%s: unsupported block type.",
 					 function );
 
 					return( -1 );
-				}
-				break;
-
-			case LIBQCOW_DEFLATE_BLOCK_TYPE_RESERVED:
-			default:
+			}
+		}
+		if( state->block_is_open != 0 )
+		{
+			if( state->block_type == LIBQCOW_DEFLATE_BLOCK_TYPE_HUFFMAN_FIXED )
+			{
+				literals_table  = &libqcow_deflate_fixed_huffman_literals_table;
+				distances_table = &libqcow_deflate_fixed_huffman_distances_table;
+			}
+			else
+			{
+				literals_table  = &( state->dynamic_huffman_literals_table );
+				distances_table = &( state->dynamic_huffman_distances_table );
+			}
+			result = libqcow_deflate_decode_huffman(
+			          bit_stream,
+			          literals_table,
+			          distances_table,
+			          uncompressed_data,
+			          uncompressed_data_size,
+			          &( state->uncompressed_data_offset ),
+			          stop_data_offset,
+			          error );
+
+			if( result == -1 )
+			{
 				libcerror_error_set(
 				 error,
 				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
-				 "%s: unsupported block type.",
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to decode Huffman encoded bit stream.",
 				 function );
 
 				return( -1 );
+			}
+			else if( result == 0 )
+			{
+				break;
+			}
+			state->block_is_open = 0;
 		}
-		if( last_block_flag != 0 )
+		if( state->last_block_flag != 0 )
 		{
-			break;
+			state->is_complete = 1;
 		}
 	}
-	*uncompressed_data_size = uncompressed_data_offset;
+	return( 1 );
+}
+
+/* Decompresses data using zlib compression
+ * Returns 1 on success or -1 on error
+ */
+int libqcow_deflate_decompress(
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t *uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	libqcow_deflate_state_t state;
+
+	static char *function = "libqcow_deflate_decompress";
+
+	if( uncompressed_data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid uncompressed data size.",
+		 function );
+
+		return( -1 );
+	}
+	/* The Huffman tables of the state are constructed before use
+	 * hence only the other values are cleared
+	 */
+	state.bit_stream.byte_stream        = NULL;
+	state.bit_stream.byte_stream_size   = 0;
+	state.bit_stream.byte_stream_offset = 0;
+	state.bit_stream.bit_buffer         = 0;
+	state.bit_stream.bit_buffer_size    = 0;
+	state.uncompressed_data_offset      = 0;
+	state.block_type                    = 0;
+	state.block_is_open                 = 0;
+	state.last_block_flag               = 0;
+	state.is_complete                   = 0;
+
+	if( libqcow_deflate_decompress_partial(
+	     &state,
+	     compressed_data,
+	     compressed_data_size,
+	     uncompressed_data,
+	     *uncompressed_data_size,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress data.",
+		 function );
+
+		return( -1 );
+	}
+	*uncompressed_data_size = state.uncompressed_data_offset;
 
 	return( 1 );
 }
@@ -41,6 +41,16 @@ enum LIBQCOW_DEFLATE_BLOCK_TYPES
 	LIBQCOW_DEFLATE_BLOCK_TYPE_RESERVED		= 0x03
 };
 
+/* The number of bits used to index the Huffman lookup table
+ * Codes that are larger are decoded by walking the code counts
+ */
+#define LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS	10
+
+/* The number of bytes that must remain in the uncompressed data after a match
+ * for it to be copied with wide copies, which write up to 7 bytes beyond the match
+ */
+#define LIBQCOW_DEFLATE_MATCH_COPY_SLACK			8
+
 typedef struct libqcow_deflate_bit_stream libqcow_deflate_bit_stream_t;
 
 struct libqcow_deflate_bit_stream
@@ -59,7 +69,7 @@ struct libqcow_deflate_bit_stream
 
 	/* The bit buffer
 	 */
-	uint32_t bit_buffer;
+	uint64_t bit_buffer;
 
 	/* The number of bits remaining in the bit buffer
 	 */
@@ -86,8 +96,59 @@ struct libqcow_deflate_huffman_table
 	/* The number of codes
 	 */
 	int number_of_codes;
+
+	/* The lookup table
+	 * Every entry contains the symbol in the upper 12 bits and the code size
+	 * in the lower 4 bits, a code size of 0 indicates the code is not in the table
+	 */
+	uint16_t lookup_table[ 1 << LIBQCOW_DEFLATE_HUFFMAN_LOOKUP_TABLE_NUMBER_OF_BITS ];
+};
+
+typedef struct libqcow_deflate_state libqcow_deflate_state_t;
+
+/* The state of a resumable decompression
+ * A state that is cleared to 0 represents the start of the compressed data
+ */
+struct libqcow_deflate_state
+{
+	/* The bit stream
+	 */
+	libqcow_deflate_bit_stream_t bit_stream;
+
+	/* The uncompressed data offset
+	 */
+	size_t uncompressed_data_offset;
+
+	/* The dynamic Huffman literals table
+	 */
+	libqcow_deflate_huffman_table_t dynamic_huffman_literals_table;
+
+	/* The dynamic Huffman distances table
+	 */
+	libqcow_deflate_huffman_table_t dynamic_huffman_distances_table;
+
+	/* The type of the block that is being decoded
+	 */
+	uint8_t block_type;
+
+	/* Value to indicate the Huffman encoded symbols of a block are being decoded
+	 */
+	uint8_t block_is_open;
+
+	/* The last block flag
+	 */
+	uint8_t last_block_flag;
+
+	/* Value to indicate the end of the compressed data was reached
+	 */
+	uint8_t is_complete;
 };
 
+int libqcow_deflate_bit_stream_read(
+     libqcow_deflate_bit_stream_t *bit_stream,
+     uint8_t number_of_bits,
+     libcerror_error_t **error );
+
 int libqcow_deflate_bit_stream_get_value(
      libqcow_deflate_bit_stream_t *bit_stream,
      uint8_t number_of_bits,
@@ -102,13 +163,7 @@ int libqcow_deflate_huffman_table_construct(
 
 int libqcow_deflate_bit_stream_get_huffman_encoded_value(
      libqcow_deflate_bit_stream_t *bit_stream,
-     libqcow_deflate_huffman_table_t *table,
-     uint32_t *value_32bit,
-     libcerror_error_t **error );
-
-int libqcow_deflate_bit_stream_get_huffman_encoded_value(
-     libqcow_deflate_bit_stream_t *bit_stream,
-     libqcow_deflate_huffman_table_t *table,
+     const libqcow_deflate_huffman_table_t *table,
      uint32_t *value_32bit,
      libcerror_error_t **error );
 
@@ -120,6 +175,20 @@ int libqcow_deflate_bit_stream_get_huffman_encoded_codes_array(
      uint32_t number_of_codes,
      libcerror_error_t **error );
 
+int libqcow_deflate_initialize_fixed_huffman_tables(
+     libqcow_deflate_huffman_table_t *literals_table,
+     libqcow_deflate_huffman_table_t *distances_table,
+     libcerror_error_t **error );
+
+int libqcow_deflate_decompress_partial(
+     libqcow_deflate_state_t *state,
+     const uint8_t *compressed_data,
+     size_t compressed_data_size,
+     uint8_t *uncompressed_data,
+     size_t uncompressed_data_size,
+     size_t stop_data_offset,
+     libcerror_error_t **error );
+
 int libqcow_deflate_decompress(
      const uint8_t *compressed_data,
      size_t compressed_data_size,
@@ -0,0 +1,352 @@
+/*
+ * The fixed Huffman tables of the deflate (zlib) decompression
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_deflate.h"
+#include "libqcow_deflate_fixed_huffman_tables.h"
+
+/* The fixed Huffman tables are the tables constructed by
+ * libqcow_deflate_initialize_fixed_huffman_tables, precomputed so that
+ * decoding a fixed Huffman block does not require constructing them
+ */
+
+/* The fixed Huffman literals table
+ */
+const libqcow_deflate_huffman_table_t libqcow_deflate_fixed_huffman_literals_table = {
+	/* The maximum number of bits
+	 */
+	15,
+
+	/* The codes array
+	 */
+	{ 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 270, 271,
+	  272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2, 3, 4, 5, 6, 7,
+	  8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+	  24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+	  40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+	  56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+	  72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87,
+	  88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103,
+	  104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+	  120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135,
+	  136, 137, 138, 139, 140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287,
+	  144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+	  160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+	  176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+	  192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+	  208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+	  224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+	  240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255 },
+
+	/* The code counts array
+	 */
+	{ 0, 0, 0, 0, 0, 0, 0, 24, 152, 112 },
+
+	/* The number of codes
+	 */
+	16,
+
+	/* The lookup table
+	 */
+	{ 0x1007, 0x0508, 0x0108, 0x1188, 0x1107, 0x0708, 0x0308, 0x0c09,
+	  0x1087, 0x0608, 0x0208, 0x0a09, 0x0008, 0x0808, 0x0408, 0x0e09,
+	  0x1047, 0x0588, 0x0188, 0x0909, 0x1147, 0x0788, 0x0388, 0x0d09,
+	  0x10c7, 0x0688, 0x0288, 0x0b09, 0x0088, 0x0888, 0x0488, 0x0f09,
+	  0x1027, 0x0548, 0x0148, 0x11c8, 0x1127, 0x0748, 0x0348, 0x0c89,
+	  0x10a7, 0x0648, 0x0248, 0x0a89, 0x0048, 0x0848, 0x0448, 0x0e89,
+	  0x1067, 0x05c8, 0x01c8, 0x0989, 0x1167, 0x07c8, 0x03c8, 0x0d89,
+	  0x10e7, 0x06c8, 0x02c8, 0x0b89, 0x00c8, 0x08c8, 0x04c8, 0x0f89,
+	  0x1017, 0x0528, 0x0128, 0x11a8, 0x1117, 0x0728, 0x0328, 0x0c49,
+	  0x1097, 0x0628, 0x0228, 0x0a49, 0x0028, 0x0828, 0x0428, 0x0e49,
+	  0x1057, 0x05a8, 0x01a8, 0x0949, 0x1157, 0x07a8, 0x03a8, 0x0d49,
+	  0x10d7, 0x06a8, 0x02a8, 0x0b49, 0x00a8, 0x08a8, 0x04a8, 0x0f49,
+	  0x1037, 0x0568, 0x0168, 0x11e8, 0x1137, 0x0768, 0x0368, 0x0cc9,
+	  0x10b7, 0x0668, 0x0268, 0x0ac9, 0x0068, 0x0868, 0x0468, 0x0ec9,
+	  0x1077, 0x05e8, 0x01e8, 0x09c9, 0x1177, 0x07e8, 0x03e8, 0x0dc9,
+	  0x10f7, 0x06e8, 0x02e8, 0x0bc9, 0x00e8, 0x08e8, 0x04e8, 0x0fc9,
+	  0x1007, 0x0518, 0x0118, 0x1198, 0x1107, 0x0718, 0x0318, 0x0c29,
+	  0x1087, 0x0618, 0x0218, 0x0a29, 0x0018, 0x0818, 0x0418, 0x0e29,
+	  0x1047, 0x0598, 0x0198, 0x0929, 0x1147, 0x0798, 0x0398, 0x0d29,
+	  0x10c7, 0x0698, 0x0298, 0x0b29, 0x0098, 0x0898, 0x0498, 0x0f29,
+	  0x1027, 0x0558, 0x0158, 0x11d8, 0x1127, 0x0758, 0x0358, 0x0ca9,
+	  0x10a7, 0x0658, 0x0258, 0x0aa9, 0x0058, 0x0858, 0x0458, 0x0ea9,
+	  0x1067, 0x05d8, 0x01d8, 0x09a9, 0x1167, 0x07d8, 0x03d8, 0x0da9,
+	  0x10e7, 0x06d8, 0x02d8, 0x0ba9, 0x00d8, 0x08d8, 0x04d8, 0x0fa9,
+	  0x1017, 0x0538, 0x0138, 0x11b8, 0x1117, 0x0738, 0x0338, 0x0c69,
+	  0x1097, 0x0638, 0x0238, 0x0a69, 0x0038, 0x0838, 0x0438, 0x0e69,
+	  0x1057, 0x05b8, 0x01b8, 0x0969, 0x1157, 0x07b8, 0x03b8, 0x0d69,
+	  0x10d7, 0x06b8, 0x02b8, 0x0b69, 0x00b8, 0x08b8, 0x04b8, 0x0f69,
+	  0x1037, 0x0578, 0x0178, 0x11f8, 0x1137, 0x0778, 0x0378, 0x0ce9,
+	  0x10b7, 0x0678, 0x0278, 0x0ae9, 0x0078, 0x0878, 0x0478, 0x0ee9,
+	  0x1077, 0x05f8, 0x01f8, 0x09e9, 0x1177, 0x07f8, 0x03f8, 0x0de9,
+	  0x10f7, 0x06f8, 0x02f8, 0x0be9, 0x00f8, 0x08f8, 0x04f8, 0x0fe9,
+	  0x1007, 0x0508, 0x0108, 0x1188, 0x1107, 0x0708, 0x0308, 0x0c19,
+	  0x1087, 0x0608, 0x0208, 0x0a19, 0x0008, 0x0808, 0x0408, 0x0e19,
+	  0x1047, 0x0588, 0x0188, 0x0919, 0x1147, 0x0788, 0x0388, 0x0d19,
+	  0x10c7, 0x0688, 0x0288, 0x0b19, 0x0088, 0x0888, 0x0488, 0x0f19,
+	  0x1027, 0x0548, 0x0148, 0x11c8, 0x1127, 0x0748, 0x0348, 0x0c99,
+	  0x10a7, 0x0648, 0x0248, 0x0a99, 0x0048, 0x0848, 0x0448, 0x0e99,
+	  0x1067, 0x05c8, 0x01c8, 0x0999, 0x1167, 0x07c8, 0x03c8, 0x0d99,
+	  0x10e7, 0x06c8, 0x02c8, 0x0b99, 0x00c8, 0x08c8, 0x04c8, 0x0f99,
+	  0x1017, 0x0528, 0x0128, 0x11a8, 0x1117, 0x0728, 0x0328, 0x0c59,
+	  0x1097, 0x0628, 0x0228, 0x0a59, 0x0028, 0x0828, 0x0428, 0x0e59,
+	  0x1057, 0x05a8, 0x01a8, 0x0959, 0x1157, 0x07a8, 0x03a8, 0x0d59,
+	  0x10d7, 0x06a8, 0x02a8, 0x0b59, 0x00a8, 0x08a8, 0x04a8, 0x0f59,
+	  0x1037, 0x0568, 0x0168, 0x11e8, 0x1137, 0x0768, 0x0368, 0x0cd9,
+	  0x10b7, 0x0668, 0x0268, 0x0ad9, 0x0068, 0x0868, 0x0468, 0x0ed9,
+	  0x1077, 0x05e8, 0x01e8, 0x09d9, 0x1177, 0x07e8, 0x03e8, 0x0dd9,
+	  0x10f7, 0x06e8, 0x02e8, 0x0bd9, 0x00e8, 0x08e8, 0x04e8, 0x0fd9,
+	  0x1007, 0x0518, 0x0118, 0x1198, 0x1107, 0x0718, 0x0318, 0x0c39,
+	  0x1087, 0x0618, 0x0218, 0x0a39, 0x0018, 0x0818, 0x0418, 0x0e39,
+	  0x1047, 0x0598, 0x0198, 0x0939, 0x1147, 0x0798, 0x0398, 0x0d39,
+	  0x10c7, 0x0698, 0x0298, 0x0b39, 0x0098, 0x0898, 0x0498, 0x0f39,
+	  0x1027, 0x0558, 0x0158, 0x11d8, 0x1127, 0x0758, 0x0358, 0x0cb9,
+	  0x10a7, 0x0658, 0x0258, 0x0ab9, 0x0058, 0x0858, 0x0458, 0x0eb9,
+	  0x1067, 0x05d8, 0x01d8, 0x09b9, 0x1167, 0x07d8, 0x03d8, 0x0db9,
+	  0x10e7, 0x06d8, 0x02d8, 0x0bb9, 0x00d8, 0x08d8, 0x04d8, 0x0fb9,
+	  0x1017, 0x0538, 0x0138, 0x11b8, 0x1117, 0x0738, 0x0338, 0x0c79,
+	  0x1097, 0x0638, 0x0238, 0x0a79, 0x0038, 0x0838, 0x0438, 0x0e79,
+	  0x1057, 0x05b8, 0x01b8, 0x0979, 0x1157, 0x07b8, 0x03b8, 0x0d79,
+	  0x10d7, 0x06b8, 0x02b8, 0x0b79, 0x00b8, 0x08b8, 0x04b8, 0x0f79,
+	  0x1037, 0x0578, 0x0178, 0x11f8, 0x1137, 0x0778, 0x0378, 0x0cf9,
+	  0x10b7, 0x0678, 0x0278, 0x0af9, 0x0078, 0x0878, 0x0478, 0x0ef9,
+	  0x1077, 0x05f8, 0x01f8, 0x09f9, 0x1177, 0x07f8, 0x03f8, 0x0df9,
+	  0x10f7, 0x06f8, 0x02f8, 0x0bf9, 0x00f8, 0x08f8, 0x04f8, 0x0ff9,
+	  0x1007, 0x0508, 0x0108, 0x1188, 0x1107, 0x0708, 0x0308, 0x0c09,
+	  0x1087, 0x0608, 0x0208, 0x0a09, 0x0008, 0x0808, 0x0408, 0x0e09,
+	  0x1047, 0x0588, 0x0188, 0x0909, 0x1147, 0x0788, 0x0388, 0x0d09,
+	  0x10c7, 0x0688, 0x0288, 0x0b09, 0x0088, 0x0888, 0x0488, 0x0f09,
+	  0x1027, 0x0548, 0x0148, 0x11c8, 0x1127, 0x0748, 0x0348, 0x0c89,
+	  0x10a7, 0x0648, 0x0248, 0x0a89, 0x0048, 0x0848, 0x0448, 0x0e89,
+	  0x1067, 0x05c8, 0x01c8, 0x0989, 0x1167, 0x07c8, 0x03c8, 0x0d89,
+	  0x10e7, 0x06c8, 0x02c8, 0x0b89, 0x00c8, 0x08c8, 0x04c8, 0x0f89,
+	  0x1017, 0x0528, 0x0128, 0x11a8, 0x1117, 0x0728, 0x0328, 0x0c49,
+	  0x1097, 0x0628, 0x0228, 0x0a49, 0x0028, 0x0828, 0x0428, 0x0e49,
+	  0x1057, 0x05a8, 0x01a8, 0x0949, 0x1157, 0x07a8, 0x03a8, 0x0d49,
+	  0x10d7, 0x06a8, 0x02a8, 0x0b49, 0x00a8, 0x08a8, 0x04a8, 0x0f49,
+	  0x1037, 0x0568, 0x0168, 0x11e8, 0x1137, 0x0768, 0x0368, 0x0cc9,
+	  0x10b7, 0x0668, 0x0268, 0x0ac9, 0x0068, 0x0868, 0x0468, 0x0ec9,
+	  0x1077, 0x05e8, 0x01e8, 0x09c9, 0x1177, 0x07e8, 0x03e8, 0x0dc9,
+	  0x10f7, 0x06e8, 0x02e8, 0x0bc9, 0x00e8, 0x08e8, 0x04e8, 0x0fc9,
+	  0x1007, 0x0518, 0x0118, 0x1198, 0x1107, 0x0718, 0x0318, 0x0c29,
+	  0x1087, 0x0618, 0x0218, 0x0a29, 0x0018, 0x0818, 0x0418, 0x0e29,
+	  0x1047, 0x0598, 0x0198, 0x0929, 0x1147, 0x0798, 0x0398, 0x0d29,
+	  0x10c7, 0x0698, 0x0298, 0x0b29, 0x0098, 0x0898, 0x0498, 0x0f29,
+	  0x1027, 0x0558, 0x0158, 0x11d8, 0x1127, 0x0758, 0x0358, 0x0ca9,
+	  0x10a7, 0x0658, 0x0258, 0x0aa9, 0x0058, 0x0858, 0x0458, 0x0ea9,
+	  0x1067, 0x05d8, 0x01d8, 0x09a9, 0x1167, 0x07d8, 0x03d8, 0x0da9,
+	  0x10e7, 0x06d8, 0x02d8, 0x0ba9, 0x00d8, 0x08d8, 0x04d8, 0x0fa9,
+	  0x1017, 0x0538, 0x0138, 0x11b8, 0x1117, 0x0738, 0x0338, 0x0c69,
+	  0x1097, 0x0638, 0x0238, 0x0a69, 0x0038, 0x0838, 0x0438, 0x0e69,
+	  0x1057, 0x05b8, 0x01b8, 0x0969, 0x1157, 0x07b8, 0x03b8, 0x0d69,
+	  0x10d7, 0x06b8, 0x02b8, 0x0b69, 0x00b8, 0x08b8, 0x04b8, 0x0f69,
+	  0x1037, 0x0578, 0x0178, 0x11f8, 0x1137, 0x0778, 0x0378, 0x0ce9,
+	  0x10b7, 0x0678, 0x0278, 0x0ae9, 0x0078, 0x0878, 0x0478, 0x0ee9,
+	  0x1077, 0x05f8, 0x01f8, 0x09e9, 0x1177, 0x07f8, 0x03f8, 0x0de9,
+	  0x10f7, 0x06f8, 0x02f8, 0x0be9, 0x00f8, 0x08f8, 0x04f8, 0x0fe9,
+	  0x1007, 0x0508, 0x0108, 0x1188, 0x1107, 0x0708, 0x0308, 0x0c19,
+	  0x1087, 0x0608, 0x0208, 0x0a19, 0x0008, 0x0808, 0x0408, 0x0e19,
+	  0x1047, 0x0588, 0x0188, 0x0919, 0x1147, 0x0788, 0x0388, 0x0d19,
+	  0x10c7, 0x0688, 0x0288, 0x0b19, 0x0088, 0x0888, 0x0488, 0x0f19,
+	  0x1027, 0x0548, 0x0148, 0x11c8, 0x1127, 0x0748, 0x0348, 0x0c99,
+	  0x10a7, 0x0648, 0x0248, 0x0a99, 0x0048, 0x0848, 0x0448, 0x0e99,
+	  0x1067, 0x05c8, 0x01c8, 0x0999, 0x1167, 0x07c8, 0x03c8, 0x0d99,
+	  0x10e7, 0x06c8, 0x02c8, 0x0b99, 0x00c8, 0x08c8, 0x04c8, 0x0f99,
+	  0x1017, 0x0528, 0x0128, 0x11a8, 0x1117, 0x0728, 0x0328, 0x0c59,
+	  0x1097, 0x0628, 0x0228, 0x0a59, 0x0028, 0x0828, 0x0428, 0x0e59,
+	  0x1057, 0x05a8, 0x01a8, 0x0959, 0x1157, 0x07a8, 0x03a8, 0x0d59,
+	  0x10d7, 0x06a8, 0x02a8, 0x0b59, 0x00a8, 0x08a8, 0x04a8, 0x0f59,
+	  0x1037, 0x0568, 0x0168, 0x11e8, 0x1137, 0x0768, 0x0368, 0x0cd9,
+	  0x10b7, 0x0668, 0x0268, 0x0ad9, 0x0068, 0x0868, 0x0468, 0x0ed9,
+	  0x1077, 0x05e8, 0x01e8, 0x09d9, 0x1177, 0x07e8, 0x03e8, 0x0dd9,
+	  0x10f7, 0x06e8, 0x02e8, 0x0bd9, 0x00e8, 0x08e8, 0x04e8, 0x0fd9,
+	  0x1007, 0x0518, 0x0118, 0x1198, 0x1107, 0x0718, 0x0318, 0x0c39,
+	  0x1087, 0x0618, 0x0218, 0x0a39, 0x0018, 0x0818, 0x0418, 0x0e39,
+	  0x1047, 0x0598, 0x0198, 0x0939, 0x1147, 0x0798, 0x0398, 0x0d39,
+	  0x10c7, 0x0698, 0x0298, 0x0b39, 0x0098, 0x0898, 0x0498, 0x0f39,
+	  0x1027, 0x0558, 0x0158, 0x11d8, 0x1127, 0x0758, 0x0358, 0x0cb9,
+	  0x10a7, 0x0658, 0x0258, 0x0ab9, 0x0058, 0x0858, 0x0458, 0x0eb9,
+	  0x1067, 0x05d8, 0x01d8, 0x09b9, 0x1167, 0x07d8, 0x03d8, 0x0db9,
+	  0x10e7, 0x06d8, 0x02d8, 0x0bb9, 0x00d8, 0x08d8, 0x04d8, 0x0fb9,
+	  0x1017, 0x0538, 0x0138, 0x11b8, 0x1117, 0x0738, 0x0338, 0x0c79,
+	  0x1097, 0x0638, 0x0238, 0x0a79, 0x0038, 0x0838, 0x0438, 0x0e79,
+	  0x1057, 0x05b8, 0x01b8, 0x0979, 0x1157, 0x07b8, 0x03b8, 0x0d79,
+	  0x10d7, 0x06b8, 0x02b8, 0x0b79, 0x00b8, 0x08b8, 0x04b8, 0x0f79,
+	  0x1037, 0x0578, 0x0178, 0x11f8, 0x1137, 0x0778, 0x0378, 0x0cf9,
+	  0x10b7, 0x0678, 0x0278, 0x0af9, 0x0078, 0x0878, 0x0478, 0x0ef9,
+	  0x1077, 0x05f8, 0x01f8, 0x09f9, 0x1177, 0x07f8, 0x03f8, 0x0df9,
+	  0x10f7, 0x06f8, 0x02f8, 0x0bf9, 0x00f8, 0x08f8, 0x04f8, 0x0ff9 }
+};
+
+/* The fixed Huffman distances table
+ */
+const libqcow_deflate_huffman_table_t libqcow_deflate_fixed_huffman_distances_table = {
+	/* The maximum number of bits
+	 */
+	15,
+
+	/* The codes array
+	 */
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29 },
+
+	/* The code counts array
+	 */
+	{ 0, 0, 0, 0, 0, 30 },
+
+	/* The number of codes
+	 */
+	16,
+
+	/* The lookup table
+	 */
+	{ 0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000,
+	  0x0005, 0x0105, 0x0085, 0x0185, 0x0045, 0x0145, 0x00c5, 0x01c5,
+	  0x0025, 0x0125, 0x00a5, 0x01a5, 0x0065, 0x0165, 0x00e5, 0x0000,
+	  0x0015, 0x0115, 0x0095, 0x0195, 0x0055, 0x0155, 0x00d5, 0x01d5,
+	  0x0035, 0x0135, 0x00b5, 0x01b5, 0x0075, 0x0175, 0x00f5, 0x0000 }
+};
+
@@ -0,0 +1,43 @@
+/*
+ * The fixed Huffman tables of the deflate (zlib) decompression
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_DEFLATE_FIXED_HUFFMAN_TABLES_H )
+#define _LIBQCOW_DEFLATE_FIXED_HUFFMAN_TABLES_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_deflate.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+extern const libqcow_deflate_huffman_table_t libqcow_deflate_fixed_huffman_literals_table;
+
+extern const libqcow_deflate_huffman_table_t libqcow_deflate_fixed_huffman_distances_table;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_DEFLATE_FIXED_HUFFMAN_TABLES_H ) */
+
@@ -0,0 +1,1294 @@
+/*
+ * Digest index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_chain_index.h"
+#include "libqcow_digest_index.h"
+#include "libqcow_hash.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_statistics.h"
+
+#include "qcow_digest_index.h"
+
+/* The number of entries that are read or written at once
+ */
+#define LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK		1024
+
+const uint8_t qcow_digest_index_file_signature[ 8 ] = { 'q', 'c', 'o', 'w', 'd', 'i', 'd', 'x' };
+
+/* Creates a digest index
+ * Make sure the value digest_index is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_initialize(
+     libqcow_digest_index_t **digest_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     int hash_type,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_digest_index_initialize";
+	size64_t number_of_entries = 0;
+	size_t digest_size         = 0;
+	size_t entry_size          = 0;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *digest_index != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid digest index value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_get_digest_size(
+	     hash_type,
+	     &digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve digest size.",
+		 function );
+
+		return( -1 );
+	}
+	entry_size = 16 + digest_size;
+
+	number_of_entries = media_size / cluster_block_size;
+
+	if( ( media_size % cluster_block_size ) != 0 )
+	{
+		number_of_entries += 1;
+	}
+	if( ( number_of_entries == 0 )
+	 || ( number_of_entries > (size64_t) ( SSIZE_MAX / entry_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*digest_index = memory_allocate_structure(
+	                 libqcow_digest_index_t );
+
+	if( *digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create digest index.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *digest_index,
+	     0,
+	     sizeof( libqcow_digest_index_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear digest index.",
+		 function );
+
+		memory_free(
+		 *digest_index );
+
+		*digest_index = NULL;
+
+		return( -1 );
+	}
+	( *digest_index )->entries_data = (uint8_t *) memory_allocate(
+	                                               entry_size * (size_t) number_of_entries );
+
+	if( ( *digest_index )->entries_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entries data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *digest_index )->entries_data,
+	     0,
+	     entry_size * (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear entries data.",
+		 function );
+
+		goto on_error;
+	}
+	( *digest_index )->entry_flags = (uint8_t *) memory_allocate(
+	                                              sizeof( uint8_t ) * (size_t) number_of_entries );
+
+	if( ( *digest_index )->entry_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entry flags.",
+		 function );
+
+		goto on_error;
+	}
+	/* Without a digest index file the digests of all entries need to be calculated
+	 */
+	if( memory_set(
+	     ( *digest_index )->entry_flags,
+	     LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE,
+	     sizeof( uint8_t ) * (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to set entry flags.",
+		 function );
+
+		goto on_error;
+	}
+	( *digest_index )->media_size         = media_size;
+	( *digest_index )->cluster_block_size = cluster_block_size;
+	( *digest_index )->hash_type          = hash_type;
+	( *digest_index )->digest_size        = digest_size;
+	( *digest_index )->entry_size         = entry_size;
+	( *digest_index )->number_of_entries  = (size_t) number_of_entries;
+
+	return( 1 );
+
+on_error:
+	if( *digest_index != NULL )
+	{
+		if( ( *digest_index )->entry_flags != NULL )
+		{
+			memory_free(
+			 ( *digest_index )->entry_flags );
+		}
+		if( ( *digest_index )->entries_data != NULL )
+		{
+			memory_free(
+			 ( *digest_index )->entries_data );
+		}
+		memory_free(
+		 *digest_index );
+
+		*digest_index = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a digest index
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_free(
+     libqcow_digest_index_t **digest_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_digest_index_free";
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *digest_index != NULL )
+	{
+		if( ( *digest_index )->entry_flags != NULL )
+		{
+			memory_free(
+			 ( *digest_index )->entry_flags );
+		}
+		if( ( *digest_index )->entries_data != NULL )
+		{
+			memory_free(
+			 ( *digest_index )->entries_data );
+		}
+		memory_free(
+		 *digest_index );
+
+		*digest_index = NULL;
+	}
+	return( 1 );
+}
+
+/* Sets the level 2 table entry values of a specific entry
+ * The entry is marked stale if it was not read from a digest index file
+ * or if the values differ from the stored values
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_set_entry_values(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     uint64_t cluster_descriptor,
+     uint64_t subcluster_bitmap,
+     libcerror_error_t **error )
+{
+	uint8_t *entry_data        = NULL;
+	static char *function      = "libqcow_digest_index_set_entry_values";
+	uint64_t stored_bitmap     = 0;
+	uint64_t stored_descriptor = 0;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_index >= digest_index->number_of_entries )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	entry_data = &( digest_index->entries_data[ entry_index * digest_index->entry_size ] );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 entry_data,
+	 stored_descriptor );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 &( entry_data[ 8 ] ),
+	 stored_bitmap );
+
+	if( ( ( digest_index->entry_flags[ entry_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED ) == 0 )
+	 || ( cluster_descriptor != stored_descriptor )
+	 || ( subcluster_bitmap != stored_bitmap ) )
+	{
+		digest_index->entry_flags[ entry_index ] |= LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE;
+	}
+	byte_stream_copy_from_uint64_little_endian(
+	 entry_data,
+	 cluster_descriptor );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 &( entry_data[ 8 ] ),
+	 subcluster_bitmap );
+
+	return( 1 );
+}
+
+/* Retrieves the first range of consecutive stale entries at or after a specific entry
+ * Returns 1 if successful, 0 if there are no more stale entries or -1 on error
+ */
+int libqcow_digest_index_get_stale_range(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     size_t *range_entry_index,
+     size_t *range_number_of_entries,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_digest_index_get_stale_range";
+	size_t last_index     = 0;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( range_entry_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid range entry index.",
+		 function );
+
+		return( -1 );
+	}
+	if( range_number_of_entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid range number of entries.",
+		 function );
+
+		return( -1 );
+	}
+	while( entry_index < digest_index->number_of_entries )
+	{
+		if( ( digest_index->entry_flags[ entry_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE ) != 0 )
+		{
+			break;
+		}
+		entry_index++;
+	}
+	if( entry_index >= digest_index->number_of_entries )
+	{
+		return( 0 );
+	}
+	last_index = entry_index + 1;
+
+	while( last_index < digest_index->number_of_entries )
+	{
+		if( ( digest_index->entry_flags[ last_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE ) == 0 )
+		{
+			break;
+		}
+		last_index++;
+	}
+	*range_entry_index       = entry_index;
+	*range_number_of_entries = last_index - entry_index;
+
+	return( 1 );
+}
+
+/* Sets the digest of a specific entry
+ * A NULL data sets the digest of a cluster block that contains no data
+ * This function can be called concurrently for different entries
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_set_digest_from_data(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	uint8_t digest[ LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ];
+
+	uint8_t *entry_digest = NULL;
+	static char *function = "libqcow_digest_index_set_digest_from_data";
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_index >= digest_index->number_of_entries )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > digest_index->cluster_block_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		if( memory_set(
+		     digest,
+		     0,
+		     digest_index->digest_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear digest.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else if( libqcow_hash_calculate(
+	          digest_index->hash_type,
+	          data,
+	          data_size,
+	          digest,
+	          digest_index->digest_size,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate digest.",
+		 function );
+
+		return( -1 );
+	}
+	entry_digest = &( digest_index->entries_data[ ( entry_index * digest_index->entry_size ) + 16 ] );
+
+	if( ( digest_index->entry_flags[ entry_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED ) != 0 )
+	{
+		if( memory_compare(
+		     entry_digest,
+		     digest,
+		     digest_index->digest_size ) != 0 )
+		{
+			LIBQCOW_STATISTICS_ADD(
+			 digest_index->number_of_mismatches,
+			 1 );
+		}
+	}
+	if( memory_copy(
+	     entry_digest,
+	     digest,
+	     digest_index->digest_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy digest.",
+		 function );
+
+		return( -1 );
+	}
+	digest_index->entry_flags[ entry_index ] &= (uint8_t) ~( LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE );
+
+	return( 1 );
+}
+
+/* Sets the digests of the entries that are still stale as cluster blocks that contain no data
+ * Holes are not passed to the parallel read callback function, hence the remaining stale
+ * entries after all stale ranges have been read are holes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_set_stale_entries_as_holes(
+     libqcow_digest_index_t *digest_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_digest_index_set_stale_entries_as_holes";
+	size_t entry_index    = 0;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	for( entry_index = 0;
+	     entry_index < digest_index->number_of_entries;
+	     entry_index++ )
+	{
+		if( ( digest_index->entry_flags[ entry_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE ) == 0 )
+		{
+			continue;
+		}
+		if( libqcow_digest_index_set_digest_from_data(
+		     digest_index,
+		     entry_index,
+		     NULL,
+		     0,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set digest of entry: %" PRIzd ".",
+			 function,
+			 entry_index );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Calculates the digest of a cluster block read by libqcow_file_read_parallel
+ * The chunk size of the parallel read must be the cluster block size
+ * Returns 1 to continue or -1 on error
+ */
+int libqcow_digest_index_read_parallel_callback(
+     off64_t chunk_offset,
+     const uint8_t *chunk_data,
+     size_t chunk_size,
+     void *user_data )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_digest_index_t *digest_index = NULL;
+	static char *function                = "libqcow_digest_index_read_parallel_callback";
+
+	digest_index = (libqcow_digest_index_t *) user_data;
+
+	if( digest_index == NULL )
+	{
+		return( -1 );
+	}
+	if( ( chunk_offset < 0 )
+	 || ( ( (size64_t) chunk_offset % digest_index->cluster_block_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid chunk offset value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_digest_index_set_digest_from_data(
+	     digest_index,
+	     (size_t) ( (size64_t) chunk_offset / digest_index->cluster_block_size ),
+	     chunk_data,
+	     chunk_size,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set digest of cluster block at offset: %" PRIi64 ".",
+		 function,
+		 chunk_offset );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+	}
+#endif
+	libcerror_error_free(
+	 &error );
+
+	return( -1 );
+}
+
+/* Reads the file header of a digest index file
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_digest_index_read_file_header(
+            libbfio_handle_t *file_io_handle,
+            qcow_digest_index_file_header_t *file_header,
+            libcerror_error_t **error )
+{
+	static char *function   = "libqcow_digest_index_read_file_header";
+	ssize_t read_count      = 0;
+	uint32_t format_version = 0;
+
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) file_header,
+	              sizeof( qcow_digest_index_file_header_t ),
+	              0,
+	              error );
+
+	if( read_count != (ssize_t) sizeof( qcow_digest_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_compare(
+	     file_header->signature,
+	     qcow_digest_index_file_signature,
+	     8 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported digest index file signature.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header->format_version,
+	 format_version );
+
+	if( format_version != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported digest index file format version: %" PRIu32 ".",
+		 function,
+		 format_version );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads the digest index from a digest index file
+ * Unlike the metadata index, the digest index file remains usable after the image
+ * was modified, the level 2 table entries determine which digests are stale
+ * Returns 1 if successful, 0 if the digest index file does not match the digest index or -1 on error
+ */
+int libqcow_digest_index_read_file_io_handle(
+     libqcow_digest_index_t *digest_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_digest_index_file_header_t file_header;
+
+	static char *function        = "libqcow_digest_index_read_file_io_handle";
+	size64_t cluster_block_size  = 0;
+	size64_t media_size          = 0;
+	size64_t number_of_entries   = 0;
+	size_t data_offset           = 0;
+	size_t data_size             = 0;
+	size_t read_size             = 0;
+	ssize_t read_count           = 0;
+	uint32_t calculated_checksum = 1;
+	uint32_t digest_size         = 0;
+	uint32_t entry_size          = 0;
+	uint32_t hash_type           = 0;
+	uint32_t stored_checksum     = 0;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_digest_index_read_file_header(
+	     file_io_handle,
+	     &file_header,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.checksum,
+	 stored_checksum );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.hash_type,
+	 hash_type );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.digest_size,
+	 digest_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 cluster_block_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.media_size,
+	 media_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.number_of_entries,
+	 number_of_entries );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.entry_size,
+	 entry_size );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: checksum\t\t\t: 0x%08" PRIx32 "\n",
+		 function,
+		 stored_checksum );
+
+		libcnotify_printf(
+		 "%s: hash type\t\t\t: %" PRIu32 "\n",
+		 function,
+		 hash_type );
+
+		libcnotify_printf(
+		 "%s: digest size\t\t\t: %" PRIu32 "\n",
+		 function,
+		 digest_size );
+
+		libcnotify_printf(
+		 "%s: cluster block size\t\t: %" PRIu64 "\n",
+		 function,
+		 cluster_block_size );
+
+		libcnotify_printf(
+		 "%s: media size\t\t\t: %" PRIu64 "\n",
+		 function,
+		 media_size );
+
+		libcnotify_printf(
+		 "%s: number of entries\t\t: %" PRIu64 "\n",
+		 function,
+		 number_of_entries );
+
+		libcnotify_printf(
+		 "%s: entry size\t\t\t: %" PRIu32 "\n",
+		 function,
+		 entry_size );
+
+		libcnotify_printf(
+		 "\n" );
+	}
+#endif
+	/* A digest index file of an image with another geometry or of another hash type cannot be used
+	 */
+	if( ( hash_type != (uint32_t) digest_index->hash_type )
+	 || ( digest_size != (uint32_t) digest_index->digest_size )
+	 || ( cluster_block_size != (size64_t) digest_index->cluster_block_size )
+	 || ( media_size != digest_index->media_size )
+	 || ( number_of_entries != (size64_t) digest_index->number_of_entries )
+	 || ( entry_size != (uint32_t) digest_index->entry_size ) )
+	{
+		return( 0 );
+	}
+	data_size = digest_index->number_of_entries * digest_index->entry_size;
+
+	while( data_offset < data_size )
+	{
+		read_size = data_size - data_offset;
+
+		if( read_size > ( LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK * digest_index->entry_size ) )
+		{
+			read_size = LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK * digest_index->entry_size;
+		}
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              &( digest_index->entries_data[ data_offset ] ),
+		              read_size,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read entries.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     &( digest_index->entries_data[ data_offset ] ),
+		     read_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			goto on_error;
+		}
+		data_offset += read_size;
+	}
+	if( stored_checksum != calculated_checksum )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_INPUT,
+		 LIBCERROR_INPUT_ERROR_CHECKSUM_MISMATCH,
+		 "%s: mismatch in checksum ( 0x%08" PRIx32 " != 0x%08" PRIx32 " ).",
+		 function,
+		 stored_checksum,
+		 calculated_checksum );
+
+		goto on_error;
+	}
+	/* The stored entries are only stale if the level 2 table entries changed
+	 */
+	memory_set(
+	 digest_index->entry_flags,
+	 LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED,
+	 digest_index->number_of_entries );
+
+	digest_index->number_of_mismatches = 0;
+
+	return( 1 );
+
+on_error:
+	/* Do not leave a partially read digest index behind
+	 */
+	memory_set(
+	 digest_index->entries_data,
+	 0,
+	 data_size );
+
+	return( -1 );
+}
+
+/* Writes the digest index to a digest index file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_digest_index_write_file_io_handle(
+     libqcow_digest_index_t *digest_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_digest_index_file_header_t file_header;
+
+	static char *function        = "libqcow_digest_index_write_file_io_handle";
+	size_t data_offset           = 0;
+	size_t data_size             = 0;
+	size_t write_size            = 0;
+	ssize_t write_count          = 0;
+	uint32_t calculated_checksum = 1;
+
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_handle_seek_offset(
+	     file_io_handle,
+	     (off64_t) sizeof( qcow_digest_index_file_header_t ),
+	     SEEK_SET,
+	     error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek entries offset.",
+		 function );
+
+		return( -1 );
+	}
+	data_size = digest_index->number_of_entries * digest_index->entry_size;
+
+	while( data_offset < data_size )
+	{
+		write_size = data_size - data_offset;
+
+		if( write_size > ( LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK * digest_index->entry_size ) )
+		{
+			write_size = LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK * digest_index->entry_size;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     &( digest_index->entries_data[ data_offset ] ),
+		     write_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			return( -1 );
+		}
+		write_count = libbfio_handle_write_buffer(
+		               file_io_handle,
+		               &( digest_index->entries_data[ data_offset ] ),
+		               write_size,
+		               error );
+
+		if( write_count != (ssize_t) write_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write entries.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += write_size;
+	}
+	/* The file header is written last so that an incomplete digest index file
+	 * is not recognized
+	 */
+	if( memory_set(
+	     &file_header,
+	     0,
+	     sizeof( qcow_digest_index_file_header_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear file header.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     file_header.signature,
+	     qcow_digest_index_file_signature,
+	     8 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy signature.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.format_version,
+	 1 );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.checksum,
+	 calculated_checksum );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.hash_type,
+	 (uint32_t) digest_index->hash_type );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.digest_size,
+	 (uint32_t) digest_index->digest_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 (uint64_t) digest_index->cluster_block_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.media_size,
+	 digest_index->media_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.number_of_entries,
+	 (uint64_t) digest_index->number_of_entries );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.entry_size,
+	 (uint32_t) digest_index->entry_size );
+
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               (uint8_t *) &file_header,
+	               sizeof( qcow_digest_index_file_header_t ),
+	               0,
+	               error );
+
+	if( write_count != (ssize_t) sizeof( qcow_digest_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Finds the first cluster block with a specific digest in a digest index file
+ * The entries are scanned sequentially without reading the image
+ * Returns 1 if successful, 0 if no such cluster block was found or -1 on error
+ */
+int libqcow_digest_index_find_digest_in_file_io_handle(
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *digest,
+     size_t digest_size,
+     off64_t *offset,
+     libcerror_error_t **error )
+{
+	qcow_digest_index_file_header_t file_header;
+
+	uint8_t *entries_data          = NULL;
+	static char *function          = "libqcow_digest_index_find_digest_in_file_io_handle";
+	size64_t cluster_block_size    = 0;
+	size64_t number_of_entries     = 0;
+	size64_t entry_index           = 0;
+	size_t block_entry_index       = 0;
+	size_t number_of_block_entries = 0;
+	size_t read_size               = 0;
+	ssize_t read_count             = 0;
+	uint32_t entry_size            = 0;
+	uint32_t stored_digest_size    = 0;
+	int result                     = 0;
+
+	if( digest == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( digest_size == 0 )
+	 || ( digest_size > LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid digest size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_digest_index_read_file_header(
+	     file_io_handle,
+	     &file_header,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.digest_size,
+	 stored_digest_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 cluster_block_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.number_of_entries,
+	 number_of_entries );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.entry_size,
+	 entry_size );
+
+	/* A digest of another hash type cannot be contained in the digest index file
+	 */
+	if( stored_digest_size != (uint32_t) digest_size )
+	{
+		return( 0 );
+	}
+	if( ( entry_size != ( 16 + stored_digest_size ) )
+	 || ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size64_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid digest index file header.",
+		 function );
+
+		goto on_error;
+	}
+	entries_data = (uint8_t *) memory_allocate(
+	                            LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK * (size_t) entry_size );
+
+	if( entries_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entries data.",
+		 function );
+
+		goto on_error;
+	}
+	while( entry_index < number_of_entries )
+	{
+		number_of_block_entries = LIBQCOW_DIGEST_INDEX_ENTRIES_PER_BLOCK;
+
+		if( (size64_t) number_of_block_entries > ( number_of_entries - entry_index ) )
+		{
+			number_of_block_entries = (size_t) ( number_of_entries - entry_index );
+		}
+		read_size = number_of_block_entries * (size_t) entry_size;
+
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              entries_data,
+		              read_size,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read entries.",
+			 function );
+
+			goto on_error;
+		}
+		for( block_entry_index = 0;
+		     block_entry_index < number_of_block_entries;
+		     block_entry_index++ )
+		{
+			if( memory_compare(
+			     &( entries_data[ ( block_entry_index * entry_size ) + 16 ] ),
+			     digest,
+			     digest_size ) == 0 )
+			{
+				*offset = (off64_t) ( ( entry_index + block_entry_index ) * cluster_block_size );
+
+				result = 1;
+
+				break;
+			}
+		}
+		if( result != 0 )
+		{
+			break;
+		}
+		entry_index += number_of_block_entries;
+	}
+	memory_free(
+	 entries_data );
+
+	return( result );
+
+on_error:
+	if( entries_data != NULL )
+	{
+		memory_free(
+		 entries_data );
+	}
+	return( -1 );
+}
+
@@ -0,0 +1,156 @@
+/*
+ * Digest index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_DIGEST_INDEX_H )
+#define _LIBQCOW_DIGEST_INDEX_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+enum LIBQCOW_DIGEST_INDEX_ENTRY_FLAGS
+{
+	/* The digest of the entry was read from a digest index file
+	 */
+	LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED	= 0x01,
+
+	/* The digest of the entry needs to be (re)calculated
+	 */
+	LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE	= 0x02
+};
+
+typedef struct libqcow_digest_index libqcow_digest_index_t;
+
+/* The digest index contains per cluster block of the media the level 2 table
+ * entry and the digest of the cluster block data. The level 2 table entry is
+ * used to determine which cluster blocks were reallocated since the digest
+ * index was written, so that only the digests of these need to be recalculated
+ */
+struct libqcow_digest_index
+{
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The hash type
+	 */
+	int hash_type;
+
+	/* The digest size
+	 */
+	size_t digest_size;
+
+	/* The entry size
+	 */
+	size_t entry_size;
+
+	/* The number of entries
+	 */
+	size_t number_of_entries;
+
+	/* The entries data, which is stored as in the digest index file
+	 */
+	uint8_t *entries_data;
+
+	/* The entry flags
+	 */
+	uint8_t *entry_flags;
+
+	/* The number of entries of which the calculated digest differs from the stored digest
+	 */
+	uint64_t number_of_mismatches;
+};
+
+int libqcow_digest_index_initialize(
+     libqcow_digest_index_t **digest_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     int hash_type,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_free(
+     libqcow_digest_index_t **digest_index,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_set_entry_values(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     uint64_t cluster_descriptor,
+     uint64_t subcluster_bitmap,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_get_stale_range(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     size_t *range_entry_index,
+     size_t *range_number_of_entries,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_set_digest_from_data(
+     libqcow_digest_index_t *digest_index,
+     size_t entry_index,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_set_stale_entries_as_holes(
+     libqcow_digest_index_t *digest_index,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_read_parallel_callback(
+     off64_t chunk_offset,
+     const uint8_t *chunk_data,
+     size_t chunk_size,
+     void *user_data );
+
+int libqcow_digest_index_read_file_io_handle(
+     libqcow_digest_index_t *digest_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_write_file_io_handle(
+     libqcow_digest_index_t *digest_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_digest_index_find_digest_in_file_io_handle(
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *digest,
+     size_t digest_size,
+     off64_t *offset,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_DIGEST_INDEX_H ) */
+
@@ -0,0 +1,1283 @@
+/*
+ * Direct (unbuffered) file functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* O_DIRECT is only defined by glibc when _GNU_SOURCE is defined
+ */
+#if !defined( _GNU_SOURCE )
+#define _GNU_SOURCE
+#endif
+
+#include <common.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_ERRNO_H )
+#include <errno.h>
+#endif
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_SYS_STAT_H )
+#include <sys/stat.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_direct_file.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_unused.h"
+
+/* Allocates an aligned buffer
+ * The buffer is over allocated and the original allocation is stored
+ * directly in front of the aligned buffer
+ * Returns a pointer to the buffer or NULL on error
+ */
+static uint8_t *libqcow_direct_file_allocate_buffer(
+                 void )
+{
+	uint8_t *allocation = NULL;
+	uint8_t *buffer     = NULL;
+	intptr_t address    = 0;
+
+	allocation = (uint8_t *) memory_allocate(
+	                          LIBQCOW_DIRECT_FILE_BUFFER_SIZE + LIBQCOW_DIRECT_FILE_ALIGNMENT + sizeof( uint8_t * ) );
+
+	if( allocation == NULL )
+	{
+		return( NULL );
+	}
+	address  = (intptr_t) ( allocation + sizeof( uint8_t * ) + LIBQCOW_DIRECT_FILE_ALIGNMENT - 1 );
+	address &= ~( (intptr_t) LIBQCOW_DIRECT_FILE_ALIGNMENT - 1 );
+	buffer   = (uint8_t *) address;
+
+	( (uint8_t **) buffer )[ -1 ] = allocation;
+
+	return( buffer );
+}
+
+/* Frees an aligned buffer
+ */
+static void libqcow_direct_file_free_buffer(
+             uint8_t *buffer )
+{
+	memory_free(
+	 ( (uint8_t **) buffer )[ -1 ] );
+}
+
+/* Creates a direct file
+ * Make sure the value direct_file is referencing, is set to NULL
+ * The direct file takes over the (named) file IO handle, which is freed with the direct file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_initialize(
+     libqcow_direct_file_t **direct_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_initialize";
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *direct_file != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid direct file value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	*direct_file = memory_allocate_structure(
+	                libqcow_direct_file_t );
+
+	if( *direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create direct file.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *direct_file,
+	     0,
+	     sizeof( libqcow_direct_file_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear direct file.",
+		 function );
+
+		memory_free(
+		 *direct_file );
+
+		*direct_file = NULL;
+
+		return( -1 );
+	}
+	( *direct_file )->file_io_handle  = file_io_handle;
+#if defined( WINAPI )
+	( *direct_file )->file_handle     = INVALID_HANDLE_VALUE;
+#else
+	( *direct_file )->file_descriptor = -1;
+#endif
+
+	return( 1 );
+
+on_error:
+	if( *direct_file != NULL )
+	{
+		memory_free(
+		 *direct_file );
+
+		*direct_file = NULL;
+	}
+	return( -1 );
+}
+
+/* Creates a file IO handle that reads the file of a (named) file IO handle bypassing the page cache
+ * Make sure the value handle is referencing, is set to NULL
+ * The file IO handle is freed with the handle
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_direct_file_t *direct_file = NULL;
+	static char *function              = "libqcow_direct_file_initialize_handle";
+
+	if( handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_direct_file_initialize(
+	     &direct_file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create direct file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_initialize(
+	     handle,
+	     (intptr_t *) direct_file,
+	     (int (*)(intptr_t **, libcerror_error_t **)) libqcow_direct_file_free,
+	     (int (*)(intptr_t **, intptr_t *, libcerror_error_t **)) libqcow_direct_file_clone,
+	     (int (*)(intptr_t *, int, libcerror_error_t **)) libqcow_direct_file_open,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_direct_file_close,
+	     (ssize_t (*)(intptr_t *, uint8_t *, size_t, libcerror_error_t **)) libqcow_direct_file_read,
+	     (ssize_t (*)(intptr_t *, const uint8_t *, size_t, libcerror_error_t **)) libqcow_direct_file_write,
+	     (off64_t (*)(intptr_t *, off64_t, int, libcerror_error_t **)) libqcow_direct_file_seek_offset,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_direct_file_exists,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_direct_file_is_open,
+	     (int (*)(intptr_t *, size64_t *, libcerror_error_t **)) libqcow_direct_file_get_size,
+	     LIBBFIO_FLAG_IO_HANDLE_MANAGED | LIBBFIO_FLAG_IO_HANDLE_CLONE_BY_FUNCTION,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( direct_file != NULL )
+	{
+		/* The file IO handle remains owned by the caller on error
+		 */
+		direct_file->file_io_handle = NULL;
+
+		libqcow_direct_file_free(
+		 &direct_file,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Frees a direct file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_free(
+     libqcow_direct_file_t **direct_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_free";
+	int result            = 1;
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *direct_file != NULL )
+	{
+#if defined( WINAPI )
+		if( ( *direct_file )->file_handle != INVALID_HANDLE_VALUE )
+#else
+		if( ( *direct_file )->file_descriptor != -1 )
+#endif
+		{
+			if( libqcow_direct_file_close(
+			     *direct_file,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close direct file.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( ( *direct_file )->file_io_handle != NULL )
+		{
+			if( libbfio_handle_free(
+			     &( ( *direct_file )->file_io_handle ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free file IO handle.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( ( *direct_file )->buffer != NULL )
+		{
+			libqcow_direct_file_free_buffer(
+			 ( *direct_file )->buffer );
+		}
+		memory_free(
+		 *direct_file );
+
+		*direct_file = NULL;
+	}
+	return( result );
+}
+
+/* Clones (duplicates) the direct file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_clone(
+     libqcow_direct_file_t **destination_direct_file,
+     libqcow_direct_file_t *source_direct_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *destination_file_io_handle = NULL;
+	static char *function                        = "libqcow_direct_file_clone";
+
+	if( destination_direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid destination direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *destination_direct_file != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: destination direct file already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( source_direct_file == NULL )
+	{
+		*destination_direct_file = NULL;
+
+		return( 1 );
+	}
+	if( libbfio_handle_clone(
+	     &destination_file_io_handle,
+	     source_direct_file->file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create destination file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_direct_file_initialize(
+	     destination_direct_file,
+	     destination_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create destination direct file.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( destination_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &destination_file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Opens the direct file
+ * The file is opened by the filename of the (named) file IO handle
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_open(
+     libqcow_direct_file_t *direct_file,
+     int access_flags,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_direct_file_open";
+
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+#if defined( WINAPI )
+	LARGE_INTEGER large_integer_size;
+
+	HANDLE file_handle         = INVALID_HANDLE_VALUE;
+	HANDLE read_event          = NULL;
+	DWORD flags_and_attributes = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED;
+#else
+	struct stat file_statistics;
+
+	int file_descriptor        = -1;
+	int open_flags             = O_RDONLY;
+#endif
+	char *filename             = NULL;
+	size_t filename_size       = 0;
+#endif
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( direct_file->file_handle != INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid direct file - file handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+#else
+	if( direct_file->file_descriptor != -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid direct file - file descriptor value already set.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( ( access_flags & LIBBFIO_ACCESS_FLAG_WRITE ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access currently not supported.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	if( libbfio_file_get_name_size(
+	     direct_file->file_io_handle,
+	     &filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename size.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( filename_size == 0 )
+	 || ( filename_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid filename size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	filename = narrow_string_allocate(
+	            filename_size );
+
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_get_name(
+	     direct_file->file_io_handle,
+	     filename,
+	     filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( WINAPI )
+	file_handle = CreateFileA(
+	               (LPCSTR) filename,
+	               GENERIC_READ,
+	               FILE_SHARE_READ | FILE_SHARE_WRITE,
+	               NULL,
+	               OPEN_EXISTING,
+	               flags_and_attributes,
+	               NULL );
+
+	/* File systems without unbuffered IO support, such as some network redirectors,
+	 * reject FILE_FLAG_NO_BUFFERING in which case the file is read with aligned reads
+	 * through the system cache
+	 */
+	if( ( file_handle == INVALID_HANDLE_VALUE )
+	 && ( GetLastError() == ERROR_INVALID_PARAMETER ) )
+	{
+		flags_and_attributes &= ~( FILE_FLAG_NO_BUFFERING );
+
+		file_handle = CreateFileA(
+		               (LPCSTR) filename,
+		               GENERIC_READ,
+		               FILE_SHARE_READ | FILE_SHARE_WRITE,
+		               NULL,
+		               OPEN_EXISTING,
+		               flags_and_attributes,
+		               NULL );
+	}
+	if( file_handle == INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	direct_file->is_unbuffered = (uint8_t) ( ( flags_and_attributes & FILE_FLAG_NO_BUFFERING ) != 0 );
+
+	if( GetFileSizeEx(
+	     file_handle,
+	     &large_integer_size ) == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file size.",
+		 function );
+
+		goto on_error;
+	}
+	/* The event is manual reset since GetOverlappedResult expects it to be
+	 */
+	read_event = CreateEvent(
+	              NULL,
+	              TRUE,
+	              FALSE,
+	              NULL );
+
+	if( read_event == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create read event.",
+		 function );
+
+		goto on_error;
+	}
+#else
+#if defined( O_DIRECT )
+	open_flags |= O_DIRECT;
+#endif
+	file_descriptor = open(
+	                   filename,
+	                   open_flags );
+
+#if defined( O_DIRECT ) && defined( EINVAL )
+	/* File systems without direct IO support, such as tmpfs, reject O_DIRECT
+	 * in which case the file is read with aligned reads through the page cache
+	 */
+	if( ( file_descriptor == -1 )
+	 && ( errno == EINVAL ) )
+	{
+		open_flags &= ~( O_DIRECT );
+
+		file_descriptor = open(
+		                   filename,
+		                   open_flags );
+	}
+#endif
+	if( file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+#if defined( O_DIRECT )
+	direct_file->is_unbuffered = (uint8_t) ( ( open_flags & O_DIRECT ) != 0 );
+
+#elif defined( F_NOCACHE )
+	/* Mac OS X has no O_DIRECT but can disable caching of a file descriptor
+	 */
+	direct_file->is_unbuffered = (uint8_t) ( fcntl(
+	                                          file_descriptor,
+	                                          F_NOCACHE,
+	                                          1 ) != -1 );
+#else
+	direct_file->is_unbuffered = 0;
+#endif
+	if( fstat(
+	     file_descriptor,
+	     &file_statistics ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file statistics.",
+		 function );
+
+		goto on_error;
+	}
+#endif /* defined( WINAPI ) */
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: file: %s opened %s page cache.\n",
+		 function,
+		 filename,
+		 direct_file->is_unbuffered != 0 ? "bypassing" : "using" );
+	}
+#endif
+	memory_free(
+	 filename );
+
+#if defined( WINAPI )
+	direct_file->file_handle     = file_handle;
+	direct_file->read_event      = read_event;
+	direct_file->size            = (size64_t) large_integer_size.QuadPart;
+#else
+	direct_file->file_descriptor = file_descriptor;
+	direct_file->size            = (size64_t) file_statistics.st_size;
+#endif
+	direct_file->current_offset  = 0;
+	direct_file->access_flags    = access_flags;
+
+	return( 1 );
+
+on_error:
+#if defined( WINAPI )
+	if( read_event != NULL )
+	{
+		CloseHandle(
+		 read_event );
+	}
+	if( file_handle != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle(
+		 file_handle );
+	}
+#else
+	if( file_descriptor != -1 )
+	{
+		close(
+		 file_descriptor );
+	}
+#endif
+	if( filename != NULL )
+	{
+		memory_free(
+		 filename );
+	}
+	return( -1 );
+#else
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: unbuffered IO not supported.",
+	 function );
+
+	return( -1 );
+#endif /* defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT ) */
+}
+
+/* Closes the direct file
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_direct_file_close(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_close";
+	int result            = 0;
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( direct_file->read_event != NULL )
+	{
+		if( CloseHandle(
+		     direct_file->read_event ) == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to close read event.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( direct_file->file_handle != INVALID_HANDLE_VALUE )
+	{
+		if( CloseHandle(
+		     direct_file->file_handle ) == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file handle.",
+			 function );
+
+			result = -1;
+		}
+	}
+	direct_file->file_handle     = INVALID_HANDLE_VALUE;
+	direct_file->read_event      = NULL;
+
+#else
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	if( direct_file->file_descriptor != -1 )
+	{
+		if( close(
+		     direct_file->file_descriptor ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file descriptor.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	direct_file->file_descriptor = -1;
+#endif
+	direct_file->is_unbuffered   = 0;
+	direct_file->access_flags    = 0;
+
+	return( result );
+}
+
+/* Reads a buffer from the direct file
+ * Reads of aligned buffers at aligned offsets are read directly into the buffer,
+ * other reads are read in aligned blocks into the aligned buffer of the direct file
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_direct_file_read(
+         libqcow_direct_file_t *direct_file,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error )
+{
+#if defined( WINAPI ) && defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	OVERLAPPED overlapped;
+
+	DWORD last_error           = 0;
+	DWORD number_of_bytes_read = 0;
+#endif
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	uint8_t *read_buffer  = NULL;
+	size_t block_offset   = 0;
+	size_t read_size      = 0;
+	ssize_t read_count    = 0;
+	off64_t read_offset   = 0;
+#endif
+	static char *function = "libqcow_direct_file_read";
+	size_t buffer_offset  = 0;
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( direct_file->file_handle == INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid direct file - missing file handle.",
+		 function );
+
+		return( -1 );
+	}
+#else
+	if( direct_file->file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid direct file - missing file descriptor.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	while( buffer_offset < size )
+	{
+		if( direct_file->current_offset >= (off64_t) direct_file->size )
+		{
+			break;
+		}
+		block_offset = (size_t) ( direct_file->current_offset % LIBQCOW_DIRECT_FILE_ALIGNMENT );
+		read_offset  = direct_file->current_offset - (off64_t) block_offset;
+		read_size    = size - buffer_offset;
+
+		/* Whole blocks read into an aligned buffer, such as the cluster block buffers
+		 * of the cluster block pool, are not copied
+		 */
+		if( ( block_offset == 0 )
+		 && ( read_size >= LIBQCOW_DIRECT_FILE_ALIGNMENT )
+		 && ( ( (intptr_t) &( buffer[ buffer_offset ] ) % LIBQCOW_DIRECT_FILE_ALIGNMENT ) == 0 ) )
+		{
+			read_size  -= read_size % LIBQCOW_DIRECT_FILE_ALIGNMENT;
+			read_buffer = &( buffer[ buffer_offset ] );
+		}
+		else
+		{
+			if( direct_file->buffer == NULL )
+			{
+				direct_file->buffer = libqcow_direct_file_allocate_buffer();
+
+				if( direct_file->buffer == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+					 "%s: unable to create buffer.",
+					 function );
+
+					return( -1 );
+				}
+			}
+			read_size += block_offset;
+
+			if( ( read_size % LIBQCOW_DIRECT_FILE_ALIGNMENT ) != 0 )
+			{
+				read_size += LIBQCOW_DIRECT_FILE_ALIGNMENT - ( read_size % LIBQCOW_DIRECT_FILE_ALIGNMENT );
+			}
+			if( read_size > LIBQCOW_DIRECT_FILE_BUFFER_SIZE )
+			{
+				read_size = LIBQCOW_DIRECT_FILE_BUFFER_SIZE;
+			}
+			read_buffer = direct_file->buffer;
+		}
+#if defined( WINAPI )
+		/* The file handle is opened for overlapped IO, hence the offset is passed
+		 * in the overlapped structure and the read is waited for to complete
+		 */
+		if( memory_set(
+		     &overlapped,
+		     0,
+		     sizeof( OVERLAPPED ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear overlapped.",
+			 function );
+
+			return( -1 );
+		}
+		overlapped.Offset     = (DWORD) ( (uint64_t) read_offset & 0xffffffffUL );
+		overlapped.OffsetHigh = (DWORD) ( (uint64_t) read_offset >> 32 );
+		overlapped.hEvent     = direct_file->read_event;
+
+		read_count = 0;
+
+		if( ReadFile(
+		     direct_file->file_handle,
+		     read_buffer,
+		     (DWORD) read_size,
+		     &number_of_bytes_read,
+		     &overlapped ) == 0 )
+		{
+			last_error = GetLastError();
+
+			if( last_error == ERROR_IO_PENDING )
+			{
+				if( GetOverlappedResult(
+				     direct_file->file_handle,
+				     &overlapped,
+				     &number_of_bytes_read,
+				     TRUE ) == 0 )
+				{
+					last_error = GetLastError();
+				}
+				else
+				{
+					last_error = ERROR_SUCCESS;
+				}
+			}
+			if( last_error == ERROR_HANDLE_EOF )
+			{
+				number_of_bytes_read = 0;
+			}
+			else if( last_error != ERROR_SUCCESS )
+			{
+				read_count = -1;
+			}
+		}
+		if( read_count != -1 )
+		{
+			read_count = (ssize_t) number_of_bytes_read;
+		}
+#else
+		read_count = pread(
+		              direct_file->file_descriptor,
+		              read_buffer,
+		              read_size,
+		              (off_t) read_offset );
+#endif
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read from file at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 read_offset,
+			 read_offset );
+
+			return( -1 );
+		}
+		if( read_count <= (ssize_t) block_offset )
+		{
+			break;
+		}
+		read_count -= (ssize_t) block_offset;
+
+		if( read_buffer == direct_file->buffer )
+		{
+			if( (size_t) read_count > ( size - buffer_offset ) )
+			{
+				read_count = (ssize_t) ( size - buffer_offset );
+			}
+			if( memory_copy(
+			     &( buffer[ buffer_offset ] ),
+			     &( read_buffer[ block_offset ] ),
+			     (size_t) read_count ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy data to buffer.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		buffer_offset               += (size_t) read_count;
+		direct_file->current_offset += (off64_t) read_count;
+	}
+#endif /* defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT ) */
+
+	return( (ssize_t) buffer_offset );
+}
+
+/* Writes a buffer to the direct file
+ * Returns the number of bytes written if successful, or -1 on error
+ */
+ssize_t libqcow_direct_file_write(
+         libqcow_direct_file_t *direct_file,
+         const uint8_t *buffer LIBQCOW_ATTRIBUTE_UNUSED,
+         size_t size LIBQCOW_ATTRIBUTE_UNUSED,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_write";
+
+	LIBQCOW_UNREFERENCED_PARAMETER( buffer )
+	LIBQCOW_UNREFERENCED_PARAMETER( size )
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: write access currently not supported.",
+	 function );
+
+	return( -1 );
+}
+
+/* Seeks a certain offset in the direct file
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_direct_file_seek_offset(
+         libqcow_direct_file_t *direct_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_seek_offset";
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_SET ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
+		 function );
+
+		return( -1 );
+	}
+	if( whence == SEEK_CUR )
+	{
+		offset += direct_file->current_offset;
+	}
+	else if( whence == SEEK_END )
+	{
+		offset += (off64_t) direct_file->size;
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	direct_file->current_offset = offset;
+
+	return( offset );
+}
+
+/* Function to determine if the direct file exists
+ * Returns 1 if the direct file exists, 0 if not or -1 on error
+ */
+int libqcow_direct_file_exists(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_exists";
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( direct_file->file_io_handle == NULL )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Check if the direct file is open
+ * Returns 1 if open, 0 if not or -1 on error
+ */
+int libqcow_direct_file_is_open(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_is_open";
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( direct_file->file_handle == INVALID_HANDLE_VALUE )
+#else
+	if( direct_file->file_descriptor == -1 )
+#endif
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the size of the direct file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_direct_file_get_size(
+     libqcow_direct_file_t *direct_file,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_direct_file_get_size";
+
+	if( direct_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid direct file.",
+		 function );
+
+		return( -1 );
+	}
+	if( size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid size.",
+		 function );
+
+		return( -1 );
+	}
+	*size = direct_file->size;
+
+	return( 1 );
+}
+
@@ -0,0 +1,158 @@
+/*
+ * Direct (unbuffered) file functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_DIRECT_FILE_H )
+#define _LIBQCOW_DIRECT_FILE_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( WINAPI )
+#include <windows.h>
+#endif
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( WINAPI )
+#define HAVE_LIBQCOW_DIRECT_FILE_SUPPORT
+
+#elif defined( HAVE_FCNTL_H ) && defined( HAVE_SYS_STAT_H ) && defined( HAVE_UNISTD_H ) && defined( HAVE_PREAD )
+#define HAVE_LIBQCOW_DIRECT_FILE_SUPPORT
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_direct_file libqcow_direct_file_t;
+
+/* The direct file is a file IO handle that reads the file of a (named) file IO handle
+ * bypassing the page cache of the operating system, using aligned reads
+ * On Windows the reads are overlapped reads that specify the offset, hence
+ * reads of different direct files of the same file are not serialized
+ */
+struct libqcow_direct_file
+{
+	/* The file IO handle that holds the filename
+	 */
+	libbfio_handle_t *file_io_handle;
+
+#if defined( WINAPI )
+	/* The file handle
+	 */
+	HANDLE file_handle;
+
+	/* The event that is signalled when an overlapped read has completed
+	 */
+	HANDLE read_event;
+#else
+	/* The file descriptor
+	 */
+	int file_descriptor;
+#endif
+
+	/* Value to indicate the page cache is bypassed
+	 */
+	uint8_t is_unbuffered;
+
+	/* The aligned buffer used for unaligned reads
+	 */
+	uint8_t *buffer;
+
+	/* The size of the file
+	 */
+	size64_t size;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* The access flags
+	 */
+	int access_flags;
+};
+
+int libqcow_direct_file_initialize(
+     libqcow_direct_file_t **direct_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_free(
+     libqcow_direct_file_t **direct_file,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_clone(
+     libqcow_direct_file_t **destination_direct_file,
+     libqcow_direct_file_t *source_direct_file,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_open(
+     libqcow_direct_file_t *direct_file,
+     int access_flags,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_close(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error );
+
+ssize_t libqcow_direct_file_read(
+         libqcow_direct_file_t *direct_file,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_direct_file_write(
+         libqcow_direct_file_t *direct_file,
+         const uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+off64_t libqcow_direct_file_seek_offset(
+         libqcow_direct_file_t *direct_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error );
+
+int libqcow_direct_file_exists(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_is_open(
+     libqcow_direct_file_t *direct_file,
+     libcerror_error_t **error );
+
+int libqcow_direct_file_get_size(
+     libqcow_direct_file_t *direct_file,
+     size64_t *size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_DIRECT_FILE_H ) */
+
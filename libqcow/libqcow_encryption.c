@@ -24,9 +24,21 @@
 #include <memory.h>
 #include <types.h>
 
+#include "libqcow_definitions.h"
 #include "libqcow_encryption.h"
+#include "libqcow_hardware_aes.h"
+#include "libqcow_hash.h"
 #include "libqcow_libcaes.h"
 #include "libqcow_libcerror.h"
+#include "libqcow_spin_lock.h"
+
+/* The contexts that can be used by multiple threads are shared by files,
+ * readers and worker threads that use the same key, so that the key is only
+ * expanded once
+ */
+static libqcow_encryption_context_t *libqcow_encryption_shared_contexts = NULL;
+
+static libqcow_spin_lock_t libqcow_encryption_shared_contexts_lock = 0;
 
 /* Creates an encryption context
  * Make sure the value context is referencing, is set to NULL
@@ -61,6 +73,18 @@ int libqcow_encryption_initialize(
 
 		return( -1 );
 	}
+	if( ( method != LIBQCOW_ENCRYPTION_METHOD_AES_128_CBC )
+	 && ( method != LIBQCOW_ENCRYPTION_METHOD_LUKS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported method.",
+		 function );
+
+		return( -1 );
+	}
 	*context = memory_allocate_structure(
 	            libqcow_encryption_context_t );
 
@@ -94,45 +118,137 @@ int libqcow_encryption_initialize(
 
 		return( -1 );
 	}
-	if( libcaes_context_initialize(
-	     &( ( *context )->decryption_context ),
-	     error ) != 1 )
+	/* Use hardware accelerated AES if the CPU supports it
+	 */
+	if( libqcow_hardware_aes_get_backend() != LIBQCOW_HARDWARE_AES_BACKEND_NONE )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable initialize decryption context.",
-		 function );
+		if( libqcow_hardware_aes_context_initialize(
+		     &( ( *context )->hardware_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable initialize hardware AES context.",
+			 function );
 
-		goto on_error;
+			goto on_error;
+		}
+		if( method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+		{
+			if( libqcow_hardware_aes_context_initialize(
+			     &( ( *context )->tweak_hardware_context ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable initialize hardware AES tweak context.",
+				 function );
+
+				goto on_error;
+			}
+		}
 	}
-	if( libcaes_context_initialize(
-	     &( ( *context )->encryption_context ),
-	     error ) != 1 )
+	else if( method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable initialize encryption context.",
-		 function );
+		if( libcaes_tweaked_context_initialize(
+		     &( ( *context )->decryption_tweaked_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable initialize decryption tweaked context.",
+			 function );
 
-		goto on_error;
+			goto on_error;
+		}
+		if( libcaes_tweaked_context_initialize(
+		     &( ( *context )->encryption_tweaked_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable initialize encryption tweaked context.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+	{
+		if( libcaes_context_initialize(
+		     &( ( *context )->decryption_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable initialize decryption context.",
+			 function );
+
+			goto on_error;
+		}
+		if( libcaes_context_initialize(
+		     &( ( *context )->encryption_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable initialize encryption context.",
+			 function );
+
+			goto on_error;
+		}
 	}
-	( *context )->method = method;
+	( *context )->method               = method;
+	( *context )->is_thread_safe       = (uint8_t) ( ( *context )->hardware_context != NULL );
+	( *context )->number_of_references = 1;
 
 	return( 1 );
 
 on_error:
 	if( *context != NULL )
 	{
+		if( ( *context )->encryption_tweaked_context != NULL )
+		{
+			libcaes_tweaked_context_free(
+			 &( ( *context )->encryption_tweaked_context ),
+			 NULL );
+		}
+		if( ( *context )->decryption_tweaked_context != NULL )
+		{
+			libcaes_tweaked_context_free(
+			 &( ( *context )->decryption_tweaked_context ),
+			 NULL );
+		}
 		if( ( *context )->decryption_context != NULL )
 		{
 			libcaes_context_free(
 			 &( ( *context )->decryption_context ),
 			 NULL );
 		}
+		if( ( *context )->tweak_hardware_context != NULL )
+		{
+			libqcow_hardware_aes_context_free(
+			 &( ( *context )->tweak_hardware_context ),
+			 NULL );
+		}
+		if( ( *context )->hardware_context != NULL )
+		{
+			libqcow_hardware_aes_context_free(
+			 &( ( *context )->hardware_context ),
+			 NULL );
+		}
 		memory_free(
 		 *context );
 
@@ -142,14 +258,17 @@ on_error:
 }
 
 /* Frees an encryption context
+ * This releases a reference, the context is freed when the last reference is released
  * Returns 1 if successful or -1 on error
  */
 int libqcow_encryption_free(
      libqcow_encryption_context_t **context,
      libcerror_error_t **error )
 {
-	static char *function = "libqcow_encryption_free";
-	int result            = 1;
+	libqcow_encryption_context_t *shared_context = NULL;
+	static char *function                        = "libqcow_encryption_free";
+	int number_of_references                     = 0;
+	int result                                   = 1;
 
 	if( context == NULL )
 	{
@@ -164,6 +283,43 @@ int libqcow_encryption_free(
 	}
 	if( *context != NULL )
 	{
+		LIBQCOW_SPIN_LOCK_GRAB( libqcow_encryption_shared_contexts_lock );
+
+		( *context )->number_of_references -= 1;
+
+		number_of_references = ( *context )->number_of_references;
+
+		if( ( number_of_references == 0 )
+		 && ( ( *context )->is_shared != 0 ) )
+		{
+			if( libqcow_encryption_shared_contexts == *context )
+			{
+				libqcow_encryption_shared_contexts = ( *context )->next_shared_context;
+			}
+			else
+			{
+				shared_context = libqcow_encryption_shared_contexts;
+
+				while( ( shared_context != NULL )
+				    && ( shared_context->next_shared_context != *context ) )
+				{
+					shared_context = shared_context->next_shared_context;
+				}
+				if( shared_context != NULL )
+				{
+					shared_context->next_shared_context = ( *context )->next_shared_context;
+				}
+			}
+			( *context )->is_shared = 0;
+		}
+		LIBQCOW_SPIN_LOCK_RELEASE( libqcow_encryption_shared_contexts_lock );
+
+		if( number_of_references > 0 )
+		{
+			*context = NULL;
+
+			return( 1 );
+		}
 		if( libcaes_context_free(
 		     &( ( *context )->decryption_context ),
 		     error ) != 1 )
@@ -190,6 +346,63 @@ int libqcow_encryption_free(
 
 			result = -1;
 		}
+		if( libcaes_tweaked_context_free(
+		     &( ( *context )->decryption_tweaked_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable free decryption tweaked context.",
+			 function );
+
+			result = -1;
+		}
+		if( libcaes_tweaked_context_free(
+		     &( ( *context )->encryption_tweaked_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable free encryption tweaked context.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_hardware_aes_context_free(
+		     &( ( *context )->hardware_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable free hardware AES context.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_hardware_aes_context_free(
+		     &( ( *context )->tweak_hardware_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable free hardware AES tweak context.",
+			 function );
+
+			result = -1;
+		}
+		memory_set(
+		 ( *context )->key_identifier,
+		 0,
+		 32 );
+
 		memory_free(
 		 *context );
 
@@ -198,113 +411,146 @@ int libqcow_encryption_free(
 	return( result );
 }
 
-/* Sets the de- and encryption keys
+/* Determines the key identifier of a method and a key
  * Returns 1 if successful or -1 on error
  */
-int libqcow_encryption_set_keys(
-     libqcow_encryption_context_t *context,
+int libqcow_encryption_get_key_identifier(
+     uint32_t method,
      const uint8_t *key,
      size_t key_size,
+     uint8_t *key_identifier,
      libcerror_error_t **error )
 {
-	static char *function = "libqcow_encryption_set_keys";
+	libqcow_hash_context_t hash_context;
 
-	if( context == NULL )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid context.",
-		 function );
+	uint8_t method_data[ 4 ];
 
-		return( -1 );
-	}
-	if( key == NULL )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid key.",
-		 function );
+	static char *function = "libqcow_encryption_get_key_identifier";
+	int result            = -1;
 
-		return( -1 );
-	}
-	if( key_size > (size_t) SSIZE_MAX )
+	byte_stream_copy_from_uint32_big_endian(
+	 method_data,
+	 method );
+
+	if( libqcow_hash_context_reset(
+	     &hash_context,
+	     LIBQCOW_HASH_TYPE_SHA256,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid key size value exceeds maximum.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize hash context.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	if( key_size < 16 )
+	if( libqcow_hash_context_update(
+	     &hash_context,
+	     method_data,
+	     4,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
-		 "%s: invalid key value too small.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to hash method.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	if( libcaes_context_set_key(
-	     context->decryption_context,
-	     LIBCAES_CRYPT_MODE_DECRYPT,
+	if( libqcow_hash_context_update(
+	     &hash_context,
 	     key,
-	     128,
+	     key_size,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to set key in decryption context.",
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to hash key.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	if( libcaes_context_set_key(
-	     context->encryption_context,
-	     LIBCAES_CRYPT_MODE_ENCRYPT,
-	     key,
-	     128,
+	if( libqcow_hash_context_finalize(
+	     &hash_context,
+	     key_identifier,
+	     32,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to set key in encryption context.",
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to finalize hash context.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	return( 1 );
+	result = 1;
+
+on_error:
+	memory_set(
+	 &hash_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	return( result );
 }
 
-/* De- or encrypts a block of data
+/* Retrieves a reference to the shared context of a method and key from the list
+ * of shared contexts
+ * Returns the context if available or NULL otherwise
+ */
+static libqcow_encryption_context_t *libqcow_encryption_reference_shared_context(
+                                      uint32_t method,
+                                      const uint8_t *key_identifier )
+{
+	libqcow_encryption_context_t *shared_context = NULL;
+
+	for( shared_context = libqcow_encryption_shared_contexts;
+	     shared_context != NULL;
+	     shared_context = shared_context->next_shared_context )
+	{
+		if( ( shared_context->method == method )
+		 && ( memory_compare(
+		       shared_context->key_identifier,
+		       key_identifier,
+		       32 ) == 0 ) )
+		{
+			shared_context->number_of_references += 1;
+
+			break;
+		}
+	}
+	return( shared_context );
+}
+
+/* Retrieves an encryption context for a method and key
+ * A context that can be used by multiple threads is shared by everything that
+ * uses the same method and key, the de- and encryption keys of a shared context
+ * must not be changed
+ * Otherwise a new context is created
+ * The context must be released with libqcow_encryption_free
  * Returns 1 if successful or -1 on error
  */
-int libqcow_encryption_crypt(
-     libqcow_encryption_context_t *context,
-     int mode,
-     const uint8_t *input_data,
-     size_t input_data_size,
-     uint8_t *output_data,
-     size_t output_data_size,
-     uint64_t block_key,
+int libqcow_encryption_get_shared_context(
+     libqcow_encryption_context_t **context,
+     uint32_t method,
+     const uint8_t *key,
+     size_t key_size,
      libcerror_error_t **error )
 {
-	uint8_t initialization_vector[ 16 ];
+	uint8_t key_identifier[ 32 ];
 
-	static char *function = "libqcow_encryption_crypt";
-	size_t data_index     = 0;
+	libqcow_encryption_context_t *new_context    = NULL;
+	libqcow_encryption_context_t *shared_context = NULL;
+	static char *function                        = "libqcow_encryption_get_shared_context";
+	int result                                   = -1;
 
 	if( context == NULL )
 	{
@@ -317,51 +563,526 @@ int libqcow_encryption_crypt(
 
 		return( -1 );
 	}
-	if( ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT )
-	 && ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) )
+	if( *context != NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: unsupported mode.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid context value already set.",
 		 function );
 
 		return( -1 );
 	}
-	if( ( input_data_size % 512 ) != 0 )
+	if( key == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
-		 "%s: invalid input data size value of bounds.",
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
 		 function );
 
 		return( -1 );
 	}
-	if( output_data_size < input_data_size )
+	if( key_size > (size_t) SSIZE_MAX )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
-		 "%s: invalid output data size value of bounds.",
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid key size value exceeds maximum.",
 		 function );
 
 		return( -1 );
 	}
-	while( data_index < input_data_size )
+	if( libqcow_encryption_get_key_identifier(
+	     method,
+	     key,
+	     key_size,
+	     key_identifier,
+	     error ) != 1 )
 	{
-		if( memory_set(
-		     initialization_vector,
-		     0,
-		     16 ) == NULL )
-		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_MEMORY,
-			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine key identifier.",
+		 function );
+
+		goto on_error;
+	}
+	LIBQCOW_SPIN_LOCK_GRAB( libqcow_encryption_shared_contexts_lock );
+
+	shared_context = libqcow_encryption_reference_shared_context(
+	                  method,
+	                  key_identifier );
+
+	LIBQCOW_SPIN_LOCK_RELEASE( libqcow_encryption_shared_contexts_lock );
+
+	if( shared_context == NULL )
+	{
+		/* The key is expanded without holding the lock
+		 */
+		if( libqcow_encryption_initialize(
+		     &new_context,
+		     method,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create context.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_encryption_set_keys(
+		     new_context,
+		     key,
+		     key_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set keys in context.",
+			 function );
+
+			goto on_error;
+		}
+		if( new_context->is_thread_safe != 0 )
+		{
+			memory_copy(
+			 new_context->key_identifier,
+			 key_identifier,
+			 32 );
+
+			LIBQCOW_SPIN_LOCK_GRAB( libqcow_encryption_shared_contexts_lock );
+
+			/* Another thread could have added a context with the same key in the meantime
+			 */
+			shared_context = libqcow_encryption_reference_shared_context(
+			                  method,
+			                  key_identifier );
+
+			if( shared_context == NULL )
+			{
+				new_context->is_shared           = 1;
+				new_context->next_shared_context = libqcow_encryption_shared_contexts;
+
+				libqcow_encryption_shared_contexts = new_context;
+			}
+			LIBQCOW_SPIN_LOCK_RELEASE( libqcow_encryption_shared_contexts_lock );
+		}
+		if( shared_context != NULL )
+		{
+			if( libqcow_encryption_free(
+			     &new_context,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free context.",
+				 function );
+
+				libqcow_encryption_free(
+				 &shared_context,
+				 NULL );
+
+				goto on_error;
+			}
+		}
+	}
+	if( shared_context != NULL )
+	{
+		*context = shared_context;
+	}
+	else
+	{
+		*context = new_context;
+	}
+	result = 1;
+
+on_error:
+	if( ( result != 1 )
+	 && ( new_context != NULL ) )
+	{
+		libqcow_encryption_free(
+		 &new_context,
+		 NULL );
+	}
+	memory_set(
+	 key_identifier,
+	 0,
+	 32 );
+
+	return( result );
+}
+
+/* Adds a reference to an encryption context
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_encryption_reference(
+     libqcow_encryption_context_t *context,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_encryption_reference";
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	LIBQCOW_SPIN_LOCK_GRAB( libqcow_encryption_shared_contexts_lock );
+
+	context->number_of_references += 1;
+
+	LIBQCOW_SPIN_LOCK_RELEASE( libqcow_encryption_shared_contexts_lock );
+
+	return( 1 );
+}
+
+/* Sets the de- and encryption keys
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_encryption_set_keys(
+     libqcow_encryption_context_t *context,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_encryption_set_keys";
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( key_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid key size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( context->method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+	{
+		return( libqcow_encryption_set_xts_keys(
+		         context,
+		         key,
+		         key_size,
+		         error ) );
+	}
+	if( key_size < 16 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+		 "%s: invalid key value too small.",
+		 function );
+
+		return( -1 );
+	}
+	if( context->hardware_context != NULL )
+	{
+		if( libqcow_hardware_aes_context_set_key(
+		     context->hardware_context,
+		     key,
+		     128,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set key in hardware AES context.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		if( libcaes_context_set_key(
+		     context->decryption_context,
+		     LIBCAES_CRYPT_MODE_DECRYPT,
+		     key,
+		     128,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set key in decryption context.",
+			 function );
+
+			return( -1 );
+		}
+		if( libcaes_context_set_key(
+		     context->encryption_context,
+		     LIBCAES_CRYPT_MODE_ENCRYPT,
+		     key,
+		     128,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set key in encryption context.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Sets the AES-XTS de- and encryption keys
+ * The key consists of the data key followed by the tweak key of the same size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_encryption_set_xts_keys(
+     libqcow_encryption_context_t *context,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_encryption_set_xts_keys";
+	size_t key_bit_size   = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( key_size != 32 )
+	 && ( key_size != 64 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported key size.",
+		 function );
+
+		return( -1 );
+	}
+	key_bit_size = ( key_size / 2 ) * 8;
+
+	if( context->hardware_context != NULL )
+	{
+		if( libqcow_hardware_aes_context_set_key(
+		     context->hardware_context,
+		     key,
+		     key_bit_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set key in hardware AES context.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_hardware_aes_context_set_key(
+		     context->tweak_hardware_context,
+		     &( key[ key_size / 2 ] ),
+		     key_bit_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set key in hardware AES tweak context.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		if( libcaes_tweaked_context_set_keys(
+		     context->decryption_tweaked_context,
+		     LIBCAES_CRYPT_MODE_DECRYPT,
+		     key,
+		     key_bit_size,
+		     &( key[ key_size / 2 ] ),
+		     key_bit_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set keys in decryption tweaked context.",
+			 function );
+
+			return( -1 );
+		}
+		if( libcaes_tweaked_context_set_keys(
+		     context->encryption_tweaked_context,
+		     LIBCAES_CRYPT_MODE_ENCRYPT,
+		     key,
+		     key_bit_size,
+		     &( key[ key_size / 2 ] ),
+		     key_bit_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set keys in encryption tweaked context.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* De- or encrypts a block of data
+ * The block key is the sector number of the first 512-byte sector
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_encryption_crypt(
+     libqcow_encryption_context_t *context,
+     int mode,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     uint64_t block_key,
+     libcerror_error_t **error )
+{
+	uint8_t initialization_vector[ 16 ];
+
+	static char *function = "libqcow_encryption_crypt";
+	size_t data_index     = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT )
+	 && ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported mode.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_data_size % 512 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input data size value of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data_size < input_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid output data size value of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( context->method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+	{
+		return( libqcow_encryption_crypt_xts(
+		         context,
+		         mode,
+		         input_data,
+		         input_data_size,
+		         output_data,
+		         output_data_size,
+		         block_key,
+		         error ) );
+	}
+	while( data_index < input_data_size )
+	{
+		if( memory_set(
+		     initialization_vector,
+		     0,
+		     16 ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
 			 "%s: unable to clear initialization vector.",
 			 function );
 
@@ -371,7 +1092,30 @@ int libqcow_encryption_crypt(
 		 initialization_vector,
 		 block_key );
 
-		if( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT )
+		if( context->hardware_context != NULL )
+		{
+			if( libqcow_hardware_aes_crypt_cbc(
+			     context->hardware_context,
+			     ( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) ? LIBCAES_CRYPT_MODE_ENCRYPT : LIBCAES_CRYPT_MODE_DECRYPT,
+			     initialization_vector,
+			     16,
+			     &( input_data[ data_index ] ),
+			     512,
+			     &( output_data[ data_index ] ),
+			     512,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+				 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+				 "%s: unable to AES-CBC de- or encrypt output data.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		else if( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT )
 		{
 			if( libcaes_crypt_cbc(
 			     context->encryption_context,
@@ -423,3 +1167,150 @@ int libqcow_encryption_crypt(
 	return( 1 );
 }
 
+/* De- or encrypts a block of data using AES-XTS with plain64 tweaks
+ * The block key is the sector number of the first 512-byte sector
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_encryption_crypt_xts(
+     libqcow_encryption_context_t *context,
+     int mode,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     uint64_t block_key,
+     libcerror_error_t **error )
+{
+	uint8_t tweak_value[ 16 ];
+
+	libcaes_tweaked_context_t *tweaked_context = NULL;
+	static char *function                      = "libqcow_encryption_crypt_xts";
+	size_t data_index                          = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT )
+	 && ( mode != LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported mode.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_data_size % 512 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input data size value of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data_size < input_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid output data size value of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The hardware accelerated AES-XTS processes all the sectors in a single call
+	 * which allows it to interleave the blocks of a sector
+	 */
+	if( context->hardware_context != NULL )
+	{
+		if( libqcow_hardware_aes_crypt_xts(
+		     context->hardware_context,
+		     context->tweak_hardware_context,
+		     ( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) ? LIBCAES_CRYPT_MODE_ENCRYPT : LIBCAES_CRYPT_MODE_DECRYPT,
+		     block_key,
+		     512,
+		     input_data,
+		     input_data_size,
+		     output_data,
+		     output_data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to AES-XTS de- or encrypt output data.",
+			 function );
+
+			return( -1 );
+		}
+		return( 1 );
+	}
+	if( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT )
+	{
+		tweaked_context = context->encryption_tweaked_context;
+	}
+	else
+	{
+		tweaked_context = context->decryption_tweaked_context;
+	}
+	while( data_index < input_data_size )
+	{
+		if( memory_set(
+		     tweak_value,
+		     0,
+		     16 ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear tweak value.",
+			 function );
+
+			return( -1 );
+		}
+		byte_stream_copy_from_uint64_little_endian(
+		 tweak_value,
+		 block_key );
+
+		if( libcaes_crypt_xts(
+		     tweaked_context,
+		     ( mode == LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT ) ? LIBCAES_CRYPT_MODE_ENCRYPT : LIBCAES_CRYPT_MODE_DECRYPT,
+		     tweak_value,
+		     16,
+		     &( input_data[ data_index ] ),
+		     512,
+		     &( output_data[ data_index ] ),
+		     512,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: unable to AES-XTS de- or encrypt output data.",
+			 function );
+
+			return( -1 );
+		}
+		data_index += 512;
+		block_key  += 1;
+	}
+	return( 1 );
+}
+
@@ -25,6 +25,7 @@
 #include <common.h>
 #include <types.h>
 
+#include "libqcow_hardware_aes.h"
 #include "libqcow_libcaes.h"
 #include "libqcow_libcerror.h"
 
@@ -53,6 +54,45 @@ struct libqcow_encryption_context
 	/* The (AES) encryption context
 	 */
 	libcaes_context_t *encryption_context;
+
+	/* The (AES-XTS) decryption context
+	 */
+	libcaes_tweaked_context_t *decryption_tweaked_context;
+
+	/* The (AES-XTS) encryption context
+	 */
+	libcaes_tweaked_context_t *encryption_tweaked_context;
+
+	/* The hardware accelerated AES context, which is used instead
+	 * of the (AES) de- and encryption contexts if set
+	 */
+	libqcow_hardware_aes_context_t *hardware_context;
+
+	/* The hardware accelerated AES-XTS tweak context
+	 */
+	libqcow_hardware_aes_context_t *tweak_hardware_context;
+
+	/* Value to indicate the context can be used by multiple threads at the same time
+	 * The hardware accelerated AES contexts only contain the expanded keys, while
+	 * the (AES) contexts can maintain state between calls
+	 */
+	uint8_t is_thread_safe;
+
+	/* The number of references, the context is freed when the last reference is released
+	 */
+	int number_of_references;
+
+	/* The key identifier, which is a SHA-256 of the method and the key
+	 */
+	uint8_t key_identifier[ 32 ];
+
+	/* Value to indicate the context is in the list of shared contexts
+	 */
+	uint8_t is_shared;
+
+	/* The next context in the list of shared contexts
+	 */
+	libqcow_encryption_context_t *next_shared_context;
 };
 
 int libqcow_encryption_initialize(
@@ -64,12 +104,36 @@ int libqcow_encryption_free(
      libqcow_encryption_context_t **context,
      libcerror_error_t **error );
 
+int libqcow_encryption_get_key_identifier(
+     uint32_t method,
+     const uint8_t *key,
+     size_t key_size,
+     uint8_t *key_identifier,
+     libcerror_error_t **error );
+
+int libqcow_encryption_get_shared_context(
+     libqcow_encryption_context_t **context,
+     uint32_t method,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error );
+
+int libqcow_encryption_reference(
+     libqcow_encryption_context_t *context,
+     libcerror_error_t **error );
+
 int libqcow_encryption_set_keys(
      libqcow_encryption_context_t *context,
      const uint8_t *key,
      size_t key_size,
      libcerror_error_t **error );
 
+int libqcow_encryption_set_xts_keys(
+     libqcow_encryption_context_t *context,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error );
+
 int libqcow_encryption_crypt(
      libqcow_encryption_context_t *context,
      int mode,
@@ -80,6 +144,16 @@ int libqcow_encryption_crypt(
      uint64_t block_key,
      libcerror_error_t **error );
 
+int libqcow_encryption_crypt_xts(
+     libqcow_encryption_context_t *context,
+     int mode,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     uint64_t block_key,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
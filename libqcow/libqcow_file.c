@@ -20,28 +20,71 @@
  */
 
 #include <common.h>
+#include <byte_stream.h>
 #include <memory.h>
 #include <narrow_string.h>
 #include <types.h>
 #include <wide_string.h>
 
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_address_split.h"
+#include "libqcow_chain_index.h"
+#include "libqcow_bitmap_values.h"
+#include "libqcow_cache_state.h"
 #include "libqcow_cluster_block.h"
+#include "libqcow_cluster_block_task.h"
 #include "libqcow_cluster_table.h"
 #include "libqcow_codepage.h"
 #include "libqcow_compression.h"
+#include "libqcow_consistency_check.h"
+#include "libqcow_creator.h"
 #include "libqcow_debug.h"
 #include "libqcow_definitions.h"
+#include "libqcow_digest_index.h"
+#include "libqcow_direct_file.h"
 #include "libqcow_encryption.h"
 #include "libqcow_i18n.h"
 #include "libqcow_io_handle.h"
+#include "libqcow_io_scheduler.h"
 #include "libqcow_file.h"
+#include "libqcow_file_cache_state.h"
+#include "libqcow_file_compaction.h"
+#include "libqcow_file_write.h"
+#include "libqcow_host_cache.h"
+#include "libqcow_layout_scan.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libcnotify.h"
 #include "libqcow_libcthreads.h"
-#include "libqcow_libfcache.h"
-#include "libqcow_libfdata.h"
 #include "libqcow_libuna.h"
+#include "libqcow_luks_header.h"
+#include "libqcow_metadata_index.h"
+#include "libqcow_numa.h"
+#include "libqcow_page_cache.h"
+#include "libqcow_parallel_read.h"
+#include "libqcow_pooled_file.h"
+#include "libqcow_reference_count_table.h"
+#include "libqcow_sampler.h"
+#include "libqcow_scratch_overlay.h"
+#include "libqcow_snapshot.h"
+#include "libqcow_snapshot_values.h"
+#include "libqcow_trace.h"
+#include "libqcow_write_cache.h"
+#include "libqcow_zero_block.h"
+#include "qcow_file_header.h"
+
+/* Not every C library defines the whence values to seek data and holes
+ */
+#if !defined( SEEK_DATA )
+#define SEEK_DATA	3
+#endif
+
+#if !defined( SEEK_HOLE )
+#define SEEK_HOLE	4
+#endif
 
 /* Creates a file
  * Make sure the value file is referencing, is set to NULL
@@ -107,6 +150,11 @@ int libqcow_file_initialize(
 
 		return( -1 );
 	}
+	internal_file->maximum_number_of_level2_table_cache_entries  = LIBQCOW_MAXIMUM_CACHE_ENTRIES_LEVEL2_TABLES;
+	internal_file->maximum_number_of_cluster_block_cache_entries = LIBQCOW_MAXIMUM_CACHE_ENTRIES_CLUSTER_BLOCKS;
+	internal_file->cache_owner                                   = (intptr_t *) internal_file;
+	internal_file->read_cluster_block_data                       = &libqcow_internal_file_read_cluster_block_data;
+
 	if( libqcow_io_handle_initialize(
 	     &( internal_file->io_handle ),
 	     error ) != 1 )
@@ -120,6 +168,32 @@ int libqcow_file_initialize(
 
 		goto on_error;
 	}
+	if( libqcow_statistics_initialize(
+	     &( internal_file->statistics ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create statistics.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_io_scheduler_initialize(
+	     &( internal_file->io_scheduler ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
 	if( libqcow_i18n_initialize(
 	     error ) != 1 )
 	{
@@ -146,6 +220,32 @@ int libqcow_file_initialize(
 
 		goto on_error;
 	}
+	if( libcthreads_mutex_initialize(
+	     &( internal_file->cache_mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to intialize cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( internal_file->read_ahead_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to intialize read-ahead condition.",
+		 function );
+
+		goto on_error;
+	}
 #endif
 	*file = (libqcow_file_t *) internal_file;
 
@@ -154,6 +254,32 @@ int libqcow_file_initialize(
 on_error:
 	if( internal_file != NULL )
 	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( internal_file->cache_mutex != NULL )
+		{
+			libcthreads_mutex_free(
+			 &( internal_file->cache_mutex ),
+			 NULL );
+		}
+		if( internal_file->read_write_lock != NULL )
+		{
+			libcthreads_read_write_lock_free(
+			 &( internal_file->read_write_lock ),
+			 NULL );
+		}
+#endif
+		if( internal_file->io_scheduler != NULL )
+		{
+			libqcow_io_scheduler_free(
+			 &( internal_file->io_scheduler ),
+			 NULL );
+		}
+		if( internal_file->statistics != NULL )
+		{
+			libqcow_statistics_free(
+			 &( internal_file->statistics ),
+			 NULL );
+		}
 		if( internal_file->io_handle != NULL )
 		{
 			libqcow_io_handle_free(
@@ -175,7 +301,7 @@ int libqcow_file_free(
 {
 	libqcow_internal_file_t *internal_file = NULL;
 	static char *function                  = "libqcow_file_free";
-	int result                             = 1;
+	int result                              = 1;
 
 	if( file == NULL )
 	{
@@ -210,6 +336,23 @@ int libqcow_file_free(
 		}
 		*file = NULL;
 
+		if( internal_file->shared_cache != NULL )
+		{
+			if( libqcow_internal_cache_detach_file(
+			     (libqcow_internal_cache_t *) internal_file->shared_cache,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to detach file from shared cache.",
+				 function );
+
+				result = -1;
+			}
+			internal_file->shared_cache = NULL;
+		}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 		if( libcthreads_read_write_lock_free(
 		     &( internal_file->read_write_lock ),
@@ -224,6 +367,32 @@ int libqcow_file_free(
 
 			result = -1;
 		}
+		if( libcthreads_mutex_free(
+		     &( internal_file->cache_mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cache mutex.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_condition_free(
+		     &( internal_file->read_ahead_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free read-ahead condition.",
+			 function );
+
+			result = -1;
+		}
 #endif
 		if( libqcow_io_handle_free(
 		     &( internal_file->io_handle ),
@@ -238,10 +407,49 @@ int libqcow_file_free(
 
 			result = -1;
 		}
+		if( libqcow_statistics_free(
+		     &( internal_file->statistics ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free statistics.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_io_scheduler_free(
+		     &( internal_file->io_scheduler ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free IO scheduler.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_decompression_context_free(
+		     &( internal_file->decompression_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free decompression context.",
+			 function );
+
+			result = -1;
+		}
 		if( memory_set(
 		     internal_file->key_data,
 		     0,
-		     16 ) == NULL )
+		     LIBQCOW_LUKS_MAXIMUM_KEY_SIZE ) == NULL )
 		{
 			libcerror_error_set(
 			 error,
@@ -252,6 +460,16 @@ int libqcow_file_free(
 
 			result = -1;
 		}
+		if( internal_file->password != NULL )
+		{
+			memory_set(
+			 internal_file->password,
+			 0,
+			 internal_file->password_size );
+
+			memory_free(
+			 internal_file->password );
+		}
 		memory_free(
 		 internal_file );
 	}
@@ -295,9 +513,15 @@ int libqcow_file_open(
      int access_flags,
      libcerror_error_t **error )
 {
-	libbfio_handle_t *file_io_handle       = NULL;
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_open";
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	libbfio_handle_t *direct_file_io_handle = NULL;
+#endif
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *named_file_io_handle  = NULL;
+	libbfio_handle_t *pooled_file_io_handle = NULL;
+	libqcow_internal_file_t *internal_file  = NULL;
+	static char *function                   = "libqcow_file_open";
+	int result                             = 1;
 
 	if( file == NULL )
 	{
@@ -333,17 +557,6 @@ int libqcow_file_open(
 
 		return( -1 );
 	}
-	if( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: write access currently not supported.",
-		 function );
-
-		return( -1 );
-	}
 	internal_file = (libqcow_internal_file_t *) file;
 
 	if( libbfio_file_initialize(
@@ -391,6 +604,56 @@ int libqcow_file_open(
 
 		goto on_error;
 	}
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	/* With unbuffered IO the file is read bypassing the page cache of the operating system
+	 * the direct file IO handle takes over the (named) file IO handle
+	 */
+	if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_UNBUFFERED_IO ) != 0 )
+	{
+		if( libqcow_direct_file_initialize_handle(
+		     &direct_file_io_handle,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create direct file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		named_file_io_handle = file_io_handle;
+		file_io_handle       = direct_file_io_handle;
+	}
+#endif
+	/* With a file IO pool the file IO handle is added to the pool, which bounds the number
+	 * of open handles, the pooled file IO handle takes over the (direct) file IO handle
+	 */
+	if( internal_file->file_io_pool != NULL )
+	{
+		if( libqcow_pooled_file_initialize_handle(
+		     &pooled_file_io_handle,
+		     internal_file->file_io_pool,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create pooled file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		if( named_file_io_handle == NULL )
+		{
+			named_file_io_handle = file_io_handle;
+		}
+		file_io_handle = pooled_file_io_handle;
+	}
 	if( libqcow_file_open_file_io_handle(
 	     file,
 	     file_io_handle,
@@ -423,7 +686,82 @@ int libqcow_file_open(
 	}
 #endif
 	internal_file->file_io_handle_created_in_library = 1;
+	internal_file->named_file_io_handle              = named_file_io_handle;
+
+	/* The barriers of the write cache synchronize the file to storage
+	 */
+	if( internal_file->write_cache != NULL )
+	{
+		if( libqcow_write_cache_open_barrier_file(
+		     internal_file->write_cache,
+		     filename,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open barrier file of write cache: %s.",
+			 function,
+			 filename );
+
+			result = -1;
+		}
+	}
+	/* The memory map is only used when requested and is not available
+	 * when the file is opened using a file IO handle, metadata only, for writing,
+	 * using unbuffered IO, since the memory map reads through the page cache,
+	 * or through a file IO pool, since the memory map keeps the file open
+	 */
+	if( ( result == 1 )
+	 && ( internal_file->data_path_is_initialized != 0 )
+	 && ( internal_file->write_cache == NULL )
+	 && ( internal_file->named_file_io_handle == NULL )
+	 && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_USE_MEMORY_MAP ) != 0 ) )
+	{
+		if( libqcow_internal_file_open_memory_map(
+		     internal_file,
+		     filename,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open memory map of file: %s.",
+			 function,
+			 filename );
+
+			result = -1;
+		}
+	}
+	/* The asynchronous IO engine is not used when the file is memory mapped,
+	 * opened metadata only, for writing, read using unbuffered IO or through
+	 * a file IO pool
+	 */
+	if( ( result == 1 )
+	 && ( internal_file->data_path_is_initialized != 0 )
+	 && ( internal_file->write_cache == NULL )
+	 && ( internal_file->memory_map == NULL )
+	 && ( internal_file->named_file_io_handle == NULL )
+	 && ( internal_file->io_queue_depth > 0 ) )
+	{
+		if( libqcow_internal_file_open_io_uring(
+		     internal_file,
+		     filename,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open io_uring of file: %s.",
+			 function,
+			 filename );
 
+			result = -1;
+		}
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_release_for_write(
 	     internal_file->read_write_lock,
@@ -439,7 +777,13 @@ int libqcow_file_open(
 		return( -1 );
 	}
 #endif
-	return( 1 );
+	if( result != 1 )
+	{
+		libqcow_file_close(
+		 file,
+		 NULL );
+	}
+	return( result );
 
 on_error:
 	if( file_io_handle != NULL )
@@ -462,9 +806,15 @@ int libqcow_file_open_wide(
      int access_flags,
      libcerror_error_t **error )
 {
-	libbfio_handle_t *file_io_handle       = NULL;
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_open_wide";
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	libbfio_handle_t *direct_file_io_handle = NULL;
+#endif
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *named_file_io_handle  = NULL;
+	libbfio_handle_t *pooled_file_io_handle = NULL;
+	libqcow_internal_file_t *internal_file  = NULL;
+	static char *function                   = "libqcow_file_open_wide";
+	int result                              = 1;
 
 	if( file == NULL )
 	{
@@ -500,17 +850,6 @@ int libqcow_file_open_wide(
 
 		return( -1 );
 	}
-	if( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: write access currently not supported.",
-		 function );
-
-		return( -1 );
-	}
 	internal_file = (libqcow_internal_file_t *) file;
 
 	if( libbfio_file_initialize(
@@ -558,6 +897,56 @@ int libqcow_file_open_wide(
 
 		goto on_error;
 	}
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+	/* With unbuffered IO the file is read bypassing the page cache of the operating system
+	 * the direct file IO handle takes over the (named) file IO handle
+	 */
+	if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_UNBUFFERED_IO ) != 0 )
+	{
+		if( libqcow_direct_file_initialize_handle(
+		     &direct_file_io_handle,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create direct file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		named_file_io_handle = file_io_handle;
+		file_io_handle       = direct_file_io_handle;
+	}
+#endif
+	/* With a file IO pool the file IO handle is added to the pool, which bounds the number
+	 * of open handles, the pooled file IO handle takes over the (direct) file IO handle
+	 */
+	if( internal_file->file_io_pool != NULL )
+	{
+		if( libqcow_pooled_file_initialize_handle(
+		     &pooled_file_io_handle,
+		     internal_file->file_io_pool,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create pooled file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		if( named_file_io_handle == NULL )
+		{
+			named_file_io_handle = file_io_handle;
+		}
+		file_io_handle = pooled_file_io_handle;
+	}
 	if( libqcow_file_open_file_io_handle(
 	     file,
 	     file_io_handle,
@@ -590,13 +979,63 @@ int libqcow_file_open_wide(
 	}
 #endif
 	internal_file->file_io_handle_created_in_library = 1;
+	internal_file->named_file_io_handle              = named_file_io_handle;
 
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
-	     internal_file->read_write_lock,
-	     error ) != 1 )
+	/* The barriers of the write cache synchronize the file to storage
+	 */
+	if( internal_file->write_cache != NULL )
 	{
-		libcerror_error_set(
+		result = libqcow_write_cache_open_barrier_file_wide(
+		          internal_file->write_cache,
+		          filename,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open barrier file of write cache: %ls.",
+			 function,
+			 filename );
+		}
+		else
+		{
+			result = 1;
+		}
+	}
+	/* The asynchronous IO engine is not used when the file is opened metadata only,
+	 * for writing, read using unbuffered IO or through a file IO pool
+	 */
+	if( ( result == 1 )
+	 && ( internal_file->data_path_is_initialized != 0 )
+	 && ( internal_file->write_cache == NULL )
+	 && ( internal_file->named_file_io_handle == NULL )
+	 && ( internal_file->io_queue_depth > 0 ) )
+	{
+		if( libqcow_internal_file_open_io_uring_wide(
+		     internal_file,
+		     filename,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open asynchronous IO of file: %ls.",
+			 function,
+			 filename );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
@@ -606,7 +1045,13 @@ int libqcow_file_open_wide(
 		return( -1 );
 	}
 #endif
-	return( 1 );
+	if( result != 1 )
+	{
+		libqcow_file_close(
+		 file,
+		 NULL );
+	}
+	return( result );
 
 on_error:
 	if( file_io_handle != NULL )
@@ -629,11 +1074,13 @@ int libqcow_file_open_file_io_handle(
      int access_flags,
      libcerror_error_t **error )
 {
+	libbfio_handle_t *host_cache_io_handle = NULL;
 	libqcow_internal_file_t *internal_file = NULL;
 	static char *function                  = "libqcow_file_open_file_io_handle";
 	int bfio_access_flags                  = 0;
 	int file_io_handle_is_open             = 0;
 	int file_io_handle_opened_in_library   = 0;
+	int number_of_read_ahead_blocks        = 0;
 	int result                             = 0;
 
 	if( file == NULL )
@@ -683,13 +1130,29 @@ int libqcow_file_open_file_io_handle(
 
 		return( -1 );
 	}
-	if( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
+	if( ( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
+	 && ( ( access_flags & LIBQCOW_ACCESS_FLAG_READ ) == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write only access currently not supported.",
+		 function );
+
+		return( -1 );
+	}
+	/* The host cache and the file IO pool only support reading
+	 */
+	if( ( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
+	 && ( ( internal_file->host_cache_block_size != 0 )
+	  || ( internal_file->file_io_pool != NULL ) ) )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: write access currently not supported.",
+		 "%s: write access not supported with host cache or file IO pool.",
 		 function );
 
 		return( -1 );
@@ -698,6 +1161,10 @@ int libqcow_file_open_file_io_handle(
 	{
 		bfio_access_flags = LIBBFIO_ACCESS_FLAG_READ;
 	}
+	if( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
+	{
+		bfio_access_flags |= LIBBFIO_ACCESS_FLAG_WRITE;
+	}
 	file_io_handle_is_open = libbfio_handle_is_open(
 	                          file_io_handle,
 	                          error );
@@ -731,6 +1198,47 @@ int libqcow_file_open_file_io_handle(
 		}
 		file_io_handle_opened_in_library = 1;
 	}
+	/* With a host cache the file IO handle is read in large aligned blocks
+	 * which reduces the number of reads of remote storage
+	 */
+	if( internal_file->host_cache_block_size != 0 )
+	{
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_READ_AHEAD ) == 0 )
+		{
+			number_of_read_ahead_blocks = LIBQCOW_HOST_CACHE_NUMBER_OF_READ_AHEAD_BLOCKS;
+		}
+		if( libqcow_host_cache_initialize_handle(
+		     &host_cache_io_handle,
+		     file_io_handle,
+		     internal_file->host_cache_block_size,
+		     internal_file->host_cache_number_of_blocks,
+		     number_of_read_ahead_blocks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create host cache IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		if( libbfio_handle_open(
+		     host_cache_io_handle,
+		     bfio_access_flags,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open host cache IO handle.",
+			 function );
+
+			goto on_error;
+		}
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
@@ -743,14 +1251,25 @@ int libqcow_file_open_file_io_handle(
 		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
 #endif
-	result = libqcow_internal_file_open_read(
-	          internal_file,
-	          file_io_handle,
-	          error );
-
+	if( host_cache_io_handle != NULL )
+	{
+		result = libqcow_internal_file_open_read(
+		          internal_file,
+		          host_cache_io_handle,
+		          access_flags,
+		          error );
+	}
+	else
+	{
+		result = libqcow_internal_file_open_read(
+		          internal_file,
+		          file_io_handle,
+		          access_flags,
+		          error );
+	}
 	if( result != 1 )
 	{
 		libcerror_error_set(
@@ -760,6 +1279,14 @@ int libqcow_file_open_file_io_handle(
 		 "%s: unable to read from file handle.",
 		 function );
 	}
+	else if( host_cache_io_handle != NULL )
+	{
+		internal_file->file_io_handle                   = host_cache_io_handle;
+		internal_file->host_file_io_handle              = file_io_handle;
+		internal_file->file_io_handle_opened_in_library = file_io_handle_opened_in_library;
+
+		host_cache_io_handle = NULL;
+	}
 	else
 	{
 		internal_file->file_io_handle                   = file_io_handle;
@@ -780,9 +1307,21 @@ int libqcow_file_open_file_io_handle(
 		return( -1 );
 	}
 #endif
+	if( host_cache_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &host_cache_io_handle,
+		 NULL );
+	}
 	return( result );
 
 on_error:
+	if( host_cache_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &host_cache_io_handle,
+		 NULL );
+	}
 	if( file_io_handle_opened_in_library != 0 )
 	{
 		libbfio_handle_close(
@@ -801,7 +1340,10 @@ int libqcow_file_close(
 {
 	libqcow_internal_file_t *internal_file = NULL;
 	static char *function                  = "libqcow_file_close";
+	int bitmap_index                       = 0;
+	int number_of_parent_file_references   = 0;
 	int result                             = 0;
+	int snapshot_index                     = 0;
 
 	if( file == NULL )
 	{
@@ -828,6 +1370,21 @@ int libqcow_file_close(
 		return( -1 );
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The pending read requests are completed before the file is closed
+	 */
+	if( libqcow_internal_file_stop_read_request_thread_pool(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to stop read request thread pool.",
+		 function );
+
+		return( -1 );
+	}
 	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
@@ -841,7 +1398,117 @@ int libqcow_file_close(
 
 		return( -1 );
 	}
+	if( libqcow_internal_file_stop_read_ahead(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to stop read-ahead.",
+		 function );
+
+		result = -1;
+	}
+	if( libqcow_internal_file_stop_worker_thread_pool(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to stop worker thread pool.",
+		 function );
+
+		result = -1;
+	}
 #endif
+	/* The clusters that are no longer used are freed before the file is closed
+	 */
+	if( internal_file->write_cache != NULL )
+	{
+		if( libqcow_write_cache_flush(
+		     internal_file->write_cache,
+		     internal_file->file_io_handle,
+		     1,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to flush write cache.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_write_cache_free(
+		     &( internal_file->write_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free write cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	/* The data written to the scratch overlay is discarded when the file is closed
+	 */
+	if( internal_file->scratch_overlay != NULL )
+	{
+		if( libqcow_scratch_overlay_free(
+		     &( internal_file->scratch_overlay ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free scratch overlay.",
+			 function );
+
+			result = -1;
+		}
+	}
+	/* The file IO handle of the host cache is replaced by the (host) file IO handle it reads
+	 */
+	if( internal_file->host_file_io_handle != NULL )
+	{
+		if( libbfio_handle_close(
+		     internal_file->file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close host cache IO handle.",
+			 function );
+
+			result = -1;
+		}
+		if( libbfio_handle_free(
+		     &( internal_file->file_io_handle ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free host cache IO handle.",
+			 function );
+
+			result = -1;
+		}
+		internal_file->file_io_handle      = internal_file->host_file_io_handle;
+		internal_file->host_file_io_handle = NULL;
+	}
 #if defined( HAVE_DEBUG_OUTPUT )
 	if( libcnotify_verbose != 0 )
 	{
@@ -861,8 +1528,92 @@ int libqcow_file_close(
 				result = -1;
 			}
 		}
+		libcnotify_printf(
+		 "%s: compressed cluster block cache hits\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->statistics->compressed_cluster_block_cache_hits );
+
+		libcnotify_printf(
+		 "%s: compressed cluster block cache misses\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->statistics->compressed_cluster_block_cache_misses );
+
+		libcnotify_printf(
+		 "%s: cluster block cache lookups\t\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->statistics->cluster_block_cache_lookups );
+
+		libcnotify_printf(
+		 "%s: cluster block cache misses\t\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->statistics->cluster_block_cache_misses );
 	}
 #endif
+	if( libqcow_statistics_clear(
+	     internal_file->statistics,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to clear statistics.",
+		 function );
+
+		result = -1;
+	}
+	if( internal_file->memory_map != NULL )
+	{
+		internal_file->io_handle->memory_map = NULL;
+
+		if( libqcow_memory_map_free(
+		     &( internal_file->memory_map ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free memory map.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->io_uring != NULL )
+	{
+		if( libqcow_io_uring_free(
+		     &( internal_file->io_uring ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free io_uring.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->page_cache != NULL )
+	{
+		if( libqcow_page_cache_free(
+		     &( internal_file->page_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free page cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	internal_file->access_advice = LIBQCOW_ADVICE_NORMAL;
+
 	if( internal_file->file_io_handle_opened_in_library != 0 )
 	{
 		if( libbfio_handle_close(
@@ -897,15 +1648,66 @@ int libqcow_file_close(
 		}
 		internal_file->file_io_handle_created_in_library = 0;
 	}
-	internal_file->file_io_handle = NULL;
+	internal_file->file_io_handle       = NULL;
+	internal_file->named_file_io_handle = NULL;
 
-	if( libqcow_io_handle_clear(
-	     internal_file->io_handle,
-	     error ) != 1 )
+	if( internal_file->data_file_io_handle_created_in_library != 0 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		if( libbfio_handle_close(
+		     internal_file->data_file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close data file IO handle.",
+			 function );
+
+			result = -1;
+		}
+		if( libbfio_handle_free(
+		     &( internal_file->data_file_io_handle ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free data file IO handle.",
+			 function );
+
+			result = -1;
+		}
+		internal_file->data_file_io_handle_created_in_library = 0;
+	}
+	internal_file->data_file_io_handle = NULL;
+
+	/* The values that a reader shares with its source file are managed by the source file
+	 */
+	if( internal_file->source_file != NULL )
+	{
+		if( libqcow_internal_file_release_shared_values(
+		     internal_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to release values shared with source file.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( libqcow_io_handle_clear(
+	     internal_file->io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
 		 "%s: unable to clear IO handle.",
 		 function );
@@ -925,71 +1727,222 @@ int libqcow_file_close(
 
 		result = -1;
 	}
-	if( libfdata_vector_free(
-	     &( internal_file->level2_table_vector ),
+	if( internal_file->snapshot_values_array != NULL )
+	{
+		for( snapshot_index = 0;
+		     snapshot_index < internal_file->number_of_snapshots;
+		     snapshot_index++ )
+		{
+			if( libqcow_snapshot_values_free(
+			     &( internal_file->snapshot_values_array[ snapshot_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free snapshot values: %d.",
+				 function,
+				 snapshot_index );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 internal_file->snapshot_values_array );
+
+		internal_file->snapshot_values_array = NULL;
+	}
+	internal_file->number_of_snapshots = 0;
+	internal_file->snapshot_table_size = 0;
+
+	if( internal_file->bitmap_values_array != NULL )
+	{
+		for( bitmap_index = 0;
+		     bitmap_index < internal_file->number_of_bitmaps;
+		     bitmap_index++ )
+		{
+			if( libqcow_bitmap_values_free(
+			     &( internal_file->bitmap_values_array[ bitmap_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free bitmap values: %d.",
+				 function,
+				 bitmap_index );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 internal_file->bitmap_values_array );
+
+		internal_file->bitmap_values_array = NULL;
+	}
+	internal_file->number_of_bitmaps = 0;
+
+	if( internal_file->reference_count_table != NULL )
+	{
+		if( libqcow_reference_count_table_free(
+		     &( internal_file->reference_count_table ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free reference count table.",
+			 function );
+
+			result = -1;
+		}
+	}
+	internal_file->host_allocation_statistics_determined = 0;
+	internal_file->host_allocation_statistics_available  = 0;
+
+	/* The values in the shared cache are removed before the pools are freed
+	 * since the cached values release their buffers to the pools of the file
+	 */
+	if( internal_file->shared_cache != NULL )
+	{
+		if( libqcow_internal_cache_remove_values(
+		     (libqcow_internal_cache_t *) internal_file->shared_cache,
+		     (intptr_t *) internal_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to remove values from shared cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( libqcow_block_cache_free(
+	     &( internal_file->level2_table_cache ),
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-		 "%s: unable to free level2 table vector.",
+		 "%s: unable to free level2 table cache.",
 		 function );
 
 		result = -1;
 	}
-	if( libfcache_cache_free(
-	     &( internal_file->level2_table_cache ),
+	if( libqcow_translation_cache_free(
+	     &( internal_file->translation_cache ),
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-		 "%s: unable to free level2 table cache.",
+		 "%s: unable to free translation cache.",
 		 function );
 
 		result = -1;
 	}
-	if( libfdata_vector_free(
-	     &( internal_file->cluster_block_vector ),
+	/* The level2 table pool is freed after the level2 table cache since
+	 * the cached level2 tables release their references to the pool
+	 */
+	if( internal_file->level2_table_pool != NULL )
+	{
+		if( libqcow_cluster_table_pool_free(
+		     &( internal_file->level2_table_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level2 table pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( libqcow_block_cache_free(
+	     &( internal_file->cluster_block_cache ),
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-		 "%s: unable to free cluster block vector.",
+		 "%s: unable to free cluster block cache.",
 		 function );
 
 		result = -1;
 	}
-	if( libfcache_cache_free(
-	     &( internal_file->cluster_block_cache ),
+	if( libqcow_block_cache_free(
+	     &( internal_file->compressed_cluster_block_cache ),
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-		 "%s: unable to free cluster block cache.",
+		 "%s: unable to free compressed cluster block cache.",
 		 function );
 
 		result = -1;
 	}
-	if( libfcache_cache_free(
-	     &( internal_file->compressed_cluster_block_cache ),
+	/* The cluster block pool is freed after the cluster block caches since
+	 * the cached cluster blocks release their buffers to the pool
+	 */
+	if( internal_file->cluster_block_pool != NULL )
+	{
+		if( libqcow_cluster_block_pool_free(
+		     &( internal_file->cluster_block_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cluster block pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_internal_file_free_numa_placement(
+	     internal_file,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-		 "%s: unable to free compressed cluster block cache.",
+		 "%s: unable to free NUMA placement.",
 		 function );
 
 		result = -1;
 	}
+#endif
+	if( internal_file->compressed_read_window != NULL )
+	{
+		memory_free(
+		 internal_file->compressed_read_window );
+
+		internal_file->compressed_read_window = NULL;
+	}
+	internal_file->data_path_is_initialized         = 0;
+	internal_file->partial_read_end_offset          = 0;
+	internal_file->level2_table_read_end_offset     = 0;
+	internal_file->compressed_read_window_offset    = 0;
+	internal_file->compressed_read_window_data_size = 0;
+	internal_file->compressed_read_offset           = 0;
+	internal_file->compressed_read_end_offset       = 0;
+
 	if( libqcow_encryption_free(
 	     &( internal_file->encryption_context ),
 	     error ) != 1 )
@@ -1003,6 +1956,90 @@ int libqcow_file_close(
 
 		result = -1;
 	}
+	if( libqcow_decompression_context_free(
+	     &( internal_file->decompression_context ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free decompression context.",
+		 function );
+
+		result = -1;
+	}
+	if( internal_file->parent_file_created_in_library != 0 )
+	{
+		/* A backing file that is shared with other files is freed
+		 * when the last of these files releases it
+		 */
+		number_of_parent_file_references = 0;
+
+		if( internal_file->shared_cache != NULL )
+		{
+			if( libqcow_internal_cache_release_image(
+			     (libqcow_internal_cache_t *) internal_file->shared_cache,
+			     (intptr_t *) internal_file->parent_file,
+			     &number_of_parent_file_references,
+			     error ) == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release parent file in shared cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( number_of_parent_file_references == 0 )
+		{
+			if( libqcow_file_free(
+			     &( internal_file->parent_file ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free parent file.",
+				 function );
+
+				result = -1;
+			}
+		}
+		internal_file->parent_file_created_in_library = 0;
+	}
+	internal_file->parent_file = NULL;
+
+	if( libqcow_chain_index_free(
+	     &( internal_file->chain_index ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free chain index.",
+		 function );
+
+		result = -1;
+	}
+	if( libqcow_metadata_index_free(
+	     &( internal_file->metadata_index ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free metadata index.",
+		 function );
+
+		result = -1;
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_release_for_write(
 	     internal_file->read_write_lock,
@@ -1021,18 +2058,24 @@ int libqcow_file_close(
 	return( result );
 }
 
-/* Opens a file for reading
+/* Creates a reader of an opened file
+ * The reader shares the level 1 table, the encryption context, the snapshot and
+ * bitmap values, the pools and the shared cache of the file but has its own
+ * current offset, file IO handle, caches and locks
+ * The reader must be freed before the file is closed
+ * Make sure the value reader is referencing, is set to NULL
  * Returns 1 if successful or -1 on error
  */
-int libqcow_internal_file_open_read(
-     libqcow_internal_file_t *internal_file,
-     libbfio_handle_t *file_io_handle,
+int libqcow_file_clone_reader(
+     libqcow_file_t *file,
+     libqcow_file_t **reader,
      libcerror_error_t **error )
 {
-	static char *function = "libqcow_internal_file_open_read";
-	int entry_index       = 0;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_clone_reader";
+	int result                             = 0;
 
-	if( internal_file == NULL )
+	if( file == NULL )
 	{
 		libcerror_error_set(
 		 error,
@@ -1043,1044 +2086,24477 @@ int libqcow_internal_file_open_read(
 
 		return( -1 );
 	}
-	if( internal_file->io_handle == NULL )
+	internal_file = (libqcow_internal_file_t *) file;
+
+	/* A reader of a reader is a reader of its source file
+	 */
+	if( internal_file->source_file != NULL )
+	{
+		internal_file = (libqcow_internal_file_t *) internal_file->source_file;
+	}
+	if( internal_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing IO handle.",
+		 "%s: invalid file - missing file IO handle.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->level1_table != NULL )
+	if( reader == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - level 1 table already set.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reader.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->level2_table_vector != NULL )
+	if( *reader != NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - level2 table vector already set.",
+		 "%s: invalid reader value already set.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->level2_table_cache != NULL )
+	if( libqcow_file_initialize(
+	     reader,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - level2 table cache already set.",
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create reader.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	if( internal_file->cluster_block_vector != NULL )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The write lock is held since the level 1 table is read completely
+	 * before it is shared with the reader
+	 */
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - cluster block vector already set.",
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-	if( internal_file->cluster_block_cache != NULL )
+#endif
+	result = libqcow_internal_file_open_reader(
+	          (libqcow_internal_file_t *) *reader,
+	          internal_file,
+	          error );
+
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - cluster block cache already set.",
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open reader.",
 		 function );
-
-		return( -1 );
 	}
-	if( internal_file->compressed_cluster_block_cache != NULL )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - compressed cluster block cache already set.",
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		result = -1;
 	}
-	if( libbfio_handle_get_size(
-	     file_io_handle,
-	     &( internal_file->size ),
-	     error ) != 1 )
+#endif
+	if( result != 1 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-		 "%s: unable to retrieve file size.",
-		 function );
-
 		goto on_error;
 	}
-	if( internal_file->size == 0 )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file size.",
-		 function );
+	return( 1 );
 
-		goto on_error;
-	}
-#if defined( HAVE_DEBUG_OUTPUT )
-	if( libcnotify_verbose != 0 )
+on_error:
+	if( *reader != NULL )
 	{
-		libcnotify_printf(
-		 "Reading file header:\n" );
+		libqcow_file_free(
+		 reader,
+		 NULL );
 	}
-#endif
-	if( libqcow_io_handle_read_file_header(
-	     internal_file->io_handle,
-	     file_io_handle,
-	     &( internal_file->encryption_method ),
-	     error ) != 1 )
+	return( -1 );
+}
+
+/* Opens a reader of a source file
+ * On error the reader is cleaned up by closing it
+ * This function is not multi-thread safe acquire the write lock of the source file before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_open_reader(
+     libqcow_internal_file_t *internal_reader,
+     libqcow_internal_file_t *internal_source_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_internal_file_open_reader";
+	int file_io_handle_is_open       = 0;
+
+	if( internal_reader == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read file header.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reader.",
 		 function );
 
-		goto on_error;
-	}
-	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
-	{
-		if( libqcow_encryption_initialize(
-		     &( internal_file->encryption_context ),
-		     internal_file->encryption_method,
-		     error ) != 1 )
-		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-			 "%s: unable to create encryption context.",
-			 function );
-
-			goto on_error;
-		}
-#if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
-		{
-			libcnotify_printf(
-			 "%s: key:\n",
-			 function );
-			libcnotify_print_data(
-			 internal_file->key_data,
-			 16,
-			 0 );
-		}
-#endif
-		if( libqcow_encryption_set_keys(
-		     internal_file->encryption_context,
-		     internal_file->key_data,
-		     16,
-		     error ) != 1 )
-		{
-			libcerror_error_set(
-			 error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-			 "%s: unable to set key data in encryption context.",
-			 function );
-
-			goto on_error;
-		}
-	}
-#if defined( HAVE_DEBUG_OUTPUT )
-	if( libcnotify_verbose != 0 )
-	{
-		libcnotify_printf(
-		 "Reading level 1 table:\n" );
+		return( -1 );
 	}
-#endif
-	if( libqcow_cluster_table_initialize(
-	     &( internal_file->level1_table ),
-	     error ) != 1 )
+	if( internal_reader->file_io_handle != NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create level 1 table.",
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid reader - file IO handle already set.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libqcow_cluster_table_read(
-	     internal_file->level1_table,
-	     file_io_handle,
-	     internal_file->io_handle->level1_table_offset,
-	     (size_t) internal_file->io_handle->level1_table_size,
-	     error ) != 1 )
+	if( internal_source_file == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read level 1 table.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source file.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-/* TODO clone function ? */
-	if( libfdata_vector_initialize(
-	     &( internal_file->level2_table_vector ),
-	     (size64_t) internal_file->io_handle->level2_table_size,
-	     (intptr_t *) internal_file->io_handle,
-	     NULL,
-	     NULL,
-	     (int (*)(intptr_t *, intptr_t *, libfdata_vector_t *, libfcache_cache_t *, int, int, off64_t, size64_t, uint32_t, uint8_t, libcerror_error_t **)) &libqcow_io_handle_read_level2_table,
-	     NULL,
-	     LIBFDATA_DATA_HANDLE_FLAG_NON_MANAGED,
-	     error ) != 1 )
+	if( internal_source_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create level2 table vector.",
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid source file - missing file IO handle.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfdata_vector_append_segment(
-	     internal_file->level2_table_vector,
-	     &entry_index,
-	     0,
-	     0,
-	     internal_file->size,
-	     0,
-	     error ) != 1 )
+	/* A reader shares the metadata of the source file, which is modified by writes
+	 */
+	if( internal_source_file->write_cache != NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
-		 "%s: unable to append segment to level2 table vector.",
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported source file - opened for writing.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfcache_cache_initialize(
-	     &( internal_file->level2_table_cache ),
-	     LIBQCOW_MAXIMUM_CACHE_ENTRIES_LEVEL2_TABLES,
-	     error ) != 1 )
+	/* A reader does not see the data in the scratch overlay of the source file
+	 */
+	if( internal_source_file->scratch_overlay != NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create level2 table cache.",
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported source file - scratch overlay set.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-/* TODO clone function ? */
-	if( libfdata_vector_initialize(
-	     &( internal_file->cluster_block_vector ),
-	     (size64_t) internal_file->io_handle->cluster_block_size,
-	     (intptr_t *) internal_file->io_handle,
-	     NULL,
-	     NULL,
-	     (int (*)(intptr_t *, intptr_t *, libfdata_vector_t *, libfcache_cache_t *, int, int, off64_t, size64_t, uint32_t, uint8_t, libcerror_error_t **)) &libqcow_io_handle_read_cluster_block,
-	     NULL,
-	     LIBFDATA_DATA_HANDLE_FLAG_NON_MANAGED,
-	     error ) != 1 )
+	if( internal_source_file->data_path_is_initialized == 0 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create cluster block vector.",
-		 function );
+		if( libqcow_internal_file_initialize_data_path(
+		     internal_source_file,
+		     internal_source_file->file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path of source file.",
+			 function );
 
-		goto on_error;
+			return( -1 );
+		}
 	}
-	if( libfdata_vector_append_segment(
-	     internal_file->cluster_block_vector,
-	     &entry_index,
-	     0,
-	     0,
-	     internal_file->size,
-	     0,
+	/* The level 1 table is no longer modified on use once all its pages have been read
+	 */
+	if( libqcow_cluster_table_read_all_pages(
+	     internal_source_file->level1_table,
+	     internal_source_file->file_io_handle,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
-		 "%s: unable to append segment to cluster block vector.",
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfcache_cache_initialize(
-	     &( internal_file->cluster_block_cache ),
-	     LIBQCOW_MAXIMUM_CACHE_ENTRIES_CLUSTER_BLOCKS,
+	/* The IO handle references the pools and statistics of its file
+	 * hence the reader has a copy of the IO handle values
+	 */
+	if( libqcow_io_handle_copy(
+	     internal_reader->io_handle,
+	     internal_source_file->io_handle,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create cluster block cache.",
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy IO handle.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfcache_cache_initialize(
-	     &( internal_file->compressed_cluster_block_cache ),
-	     LIBQCOW_MAXIMUM_CACHE_ENTRIES_CLUSTER_BLOCKS,
+	/* The file IO handle of the host cache is not cloned but the (host) file IO handle it reads
+	 */
+	if( internal_source_file->host_file_io_handle != NULL )
+	{
+		file_io_handle = internal_source_file->host_file_io_handle;
+	}
+	else
+	{
+		file_io_handle = internal_source_file->file_io_handle;
+	}
+	if( libbfio_handle_clone(
+	     &( internal_reader->file_io_handle ),
+	     file_io_handle,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create compressed cluster block cache.",
+		 "%s: unable to create file IO handle.",
 		 function );
 
-		goto on_error;
-	}
-	return( 1 );
-
-on_error:
-	if( internal_file->cluster_block_cache != NULL )
-	{
-		libfcache_cache_free(
-		 &( internal_file->cluster_block_cache ),
-		 NULL );
-	}
-	if( internal_file->cluster_block_vector != NULL )
-	{
-		libfdata_vector_free(
-		 &( internal_file->cluster_block_vector ),
-		 NULL );
-	}
-	if( internal_file->level2_table_cache != NULL )
-	{
-		libfcache_cache_free(
-		 &( internal_file->level2_table_cache ),
-		 NULL );
-	}
-	if( internal_file->level2_table_vector != NULL )
-	{
-		libfdata_vector_free(
-		 &( internal_file->level2_table_vector ),
-		 NULL );
-	}
-	if( internal_file->level1_table != NULL )
-	{
-		libqcow_cluster_table_free(
-		 &( internal_file->level1_table ),
-		 NULL );
+		return( -1 );
 	}
-	return( -1 );
-}
+	internal_reader->file_io_handle_created_in_library = 1;
 
-/* Reads (media) data from the current offset into a buffer using a Basic File IO (bfio) handle
- * This function is not multi-thread safe acquire write lock before call
- * Returns the number of bytes read or -1 on error
- */
-ssize_t libqcow_internal_file_read_buffer_from_file_io_handle(
-         libqcow_internal_file_t *internal_file,
-         libbfio_handle_t *file_io_handle,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error )
-{
-	libqcow_cluster_block_t *cluster_block       = NULL;
-	libqcow_cluster_table_t *level2_table        = NULL;
-	static char *function                        = "libqcow_internal_file_read_buffer_from_file_io_handle";
-	off64_t element_data_offset                  = 0;
-	size_t buffer_offset                         = 0;
-	size_t cluster_block_data_size               = 0;
-	size_t compressed_cluster_block_size         = 0;
-	size_t read_size                             = 0;
-	uint64_t cluster_block_file_offset           = 0;
-	uint64_t compressed_cluster_block_offset     = 0;
-	uint64_t compressed_cluster_block_end_offset = 0;
-	uint64_t cluster_block_offset                = 0;
-	uint64_t level1_table_index                  = 0;
-	uint64_t level2_table_file_offset            = 0;
-	uint64_t level2_table_index                  = 0;
-	int cache_entry_index                        = 0;
-	int cluster_block_is_compressed              = 0;
+	file_io_handle_is_open = libbfio_handle_is_open(
+	                          internal_reader->file_io_handle,
+	                          error );
 
-	if( internal_file == NULL )
+	if( file_io_handle_is_open == -1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid file.",
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to determine if file IO handle is open.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->io_handle == NULL )
+	else if( file_io_handle_is_open == 0 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing IO handle.",
-		 function );
+		if( libbfio_handle_open(
+		     internal_reader->file_io_handle,
+		     LIBBFIO_OPEN_READ,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open file IO handle.",
+			 function );
 
-		return( -1 );
+			return( -1 );
+		}
 	}
-	if( internal_file->current_offset < 0 )
+	internal_reader->file_io_handle_opened_in_library = 1;
+
+	if( internal_source_file->data_file_io_handle != NULL )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
-		 "%s: invalid file - current offset value out of bounds.",
-		 function );
+		if( libbfio_handle_clone(
+		     &( internal_reader->data_file_io_handle ),
+		     internal_source_file->data_file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create data file IO handle.",
+			 function );
 
-		return( -1 );
-	}
-	if( buffer == NULL )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid buffer.",
-		 function );
+			return( -1 );
+		}
+		internal_reader->data_file_io_handle_created_in_library = 1;
 
-		return( -1 );
+		file_io_handle_is_open = libbfio_handle_is_open(
+		                          internal_reader->data_file_io_handle,
+		                          error );
+
+		if( file_io_handle_is_open == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to determine if data file IO handle is open.",
+			 function );
+
+			return( -1 );
+		}
+		else if( file_io_handle_is_open == 0 )
+		{
+			if( libbfio_handle_open(
+			     internal_reader->data_file_io_handle,
+			     LIBBFIO_OPEN_READ,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_OPEN_FAILED,
+				 "%s: unable to open data file IO handle.",
+				 function );
+
+				return( -1 );
+			}
+		}
 	}
-	if( buffer_size > (size_t) SSIZE_MAX )
+	internal_reader->source_file = (libqcow_file_t *) internal_source_file;
+	internal_reader->cache_owner = internal_source_file->cache_owner;
+
+	internal_reader->size                                         = internal_source_file->size;
+	internal_reader->encryption_method                            = internal_source_file->encryption_method;
+	internal_reader->key_data_size                                = internal_source_file->key_data_size;
+	internal_reader->key_data_is_set                              = internal_source_file->key_data_is_set;
+	internal_reader->backing_file_chain_depth                     = internal_source_file->backing_file_chain_depth;
+	internal_reader->snapshot_values_array                        = internal_source_file->snapshot_values_array;
+	internal_reader->number_of_snapshots                          = internal_source_file->number_of_snapshots;
+	internal_reader->snapshot_table_size                          = internal_source_file->snapshot_table_size;
+	internal_reader->bitmap_values_array                          = internal_source_file->bitmap_values_array;
+	internal_reader->number_of_bitmaps                            = internal_source_file->number_of_bitmaps;
+	internal_reader->maximum_number_of_level2_table_cache_entries  = internal_source_file->maximum_number_of_level2_table_cache_entries;
+	internal_reader->maximum_number_of_cluster_block_cache_entries = internal_source_file->maximum_number_of_cluster_block_cache_entries;
+	internal_reader->maximum_memory_size                          = internal_source_file->maximum_memory_size;
+	internal_reader->read_flags                                   = internal_source_file->read_flags;
+	internal_reader->read_cluster_block_data                      = internal_source_file->read_cluster_block_data;
+
+	LIBQCOW_STATISTICS_SET(
+	 internal_reader->statistics->latency_histograms_enabled,
+	 ( internal_reader->read_flags & LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS ) != 0 );
+
+	if( memory_copy(
+	     internal_reader->key_data,
+	     internal_source_file->key_data,
+	     LIBQCOW_LUKS_MAXIMUM_KEY_SIZE ) == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid element data size value exceeds maximum.",
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy key data.",
 		 function );
 
 		return( -1 );
 	}
-	if( (size64_t) internal_file->current_offset >= internal_file->io_handle->media_size )
-	{
-		return( 0 );
-	}
-	while( buffer_offset < buffer_size )
+	/* A reader shares the encryption context of its source file if it can be
+	 * used by multiple threads, otherwise the reader gets its own context
+	 */
+	if( internal_source_file->encryption_context != NULL )
 	{
-#if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
+		if( libqcow_encryption_get_shared_context(
+		     &( internal_reader->encryption_context ),
+		     internal_source_file->encryption_method,
+		     internal_source_file->key_data,
+		     internal_source_file->key_data_size,
+		     error ) != 1 )
 		{
-			libcnotify_printf(
-			 "%s: current offset\t\t\t\t: 0x%08" PRIx64 "\n",
-			 function,
-			 internal_file->current_offset );
-		}
-#endif
-		level1_table_index = internal_file->current_offset >> internal_file->io_handle->level1_index_bit_shift;
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create encryption context.",
+			 function );
 
-#if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
-		{
-			libcnotify_printf(
-			 "%s: level 1 table index\t\t\t: %" PRIu64 "\n",
-			 function,
-			 level1_table_index );
+			return( -1 );
 		}
-#endif
-		if( level1_table_index > (uint64_t) INT_MAX )
+	}
+	if( internal_source_file->shared_cache != NULL )
+	{
+		if( libqcow_internal_cache_attach_file(
+		     (libqcow_internal_cache_t *) internal_source_file->shared_cache,
+		     error ) != 1 )
 		{
 			libcerror_error_set(
 			 error,
 			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
-			 "%s: invalid level 1 table index value out of bounds.",
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to attach reader to shared cache.",
 			 function );
 
 			return( -1 );
 		}
-		if( libqcow_cluster_table_get_reference_by_index(
-		     internal_file->level1_table,
-		     (int) level1_table_index,
-		     &level2_table_file_offset,
+		internal_reader->shared_cache = internal_source_file->shared_cache;
+	}
+	if( libqcow_internal_file_initialize_data_path(
+	     internal_reader,
+	     internal_reader->file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_source_file->parent_file != NULL )
+	{
+		if( libqcow_file_clone_reader(
+		     internal_source_file->parent_file,
+		     &( internal_reader->parent_file ),
 		     error ) != 1 )
 		{
 			libcerror_error_set(
 			 error,
 			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-			 "%s: unable to retrieve level 2 table offset: %" PRIi64 " from level 1 table.",
-			 function,
-			 level1_table_index );
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create reader of parent file.",
+			 function );
 
 			return( -1 );
 		}
+		internal_reader->parent_file_created_in_library = 1;
+	}
+	return( 1 );
+}
+
+/* Releases the values that a reader shares with its source file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_release_shared_values(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_release_shared_values";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle != NULL )
+	{
+		internal_file->io_handle->level2_table_pool        = NULL;
+		internal_file->io_handle->cluster_block_pool       = NULL;
+		internal_file->io_handle->numa_topology            = NULL;
+		internal_file->io_handle->numa_cluster_block_pools = NULL;
+	}
+	internal_file->level1_table          = NULL;
+	internal_file->snapshot_values_array = NULL;
+	internal_file->number_of_snapshots   = 0;
+	internal_file->bitmap_values_array   = NULL;
+	internal_file->number_of_bitmaps     = 0;
+	internal_file->source_file           = NULL;
+	internal_file->cache_owner           = (intptr_t *) internal_file;
+
+	return( 1 );
+}
+
+/* Opens a file for reading
+ * The data path structures are not created on open when the metadata only access flag is set
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_open_read(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     int access_flags,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_open_read";
+	size_t key_data_size  = 0;
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->data_path_is_initialized != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - data path already initialized.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_handle_get_size(
+	     file_io_handle,
+	     &( internal_file->size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file size.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_file->size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file size.",
+		 function );
+
+		goto on_error;
+	}
 #if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
-		{
-			libcnotify_printf(
-			 "%s: level 2 table file offset\t\t: 0x%08" PRIx64 "\n",
-			 function,
-			 level1_table_index );
-		}
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "Reading file header:\n" );
+	}
 #endif
-		level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+	if( libqcow_io_handle_read_file_header(
+	     internal_file->io_handle,
+	     file_io_handle,
+	     &( internal_file->encryption_method ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		goto on_error;
+	}
+	/* Only a raw external data file is supported where the (media) offset
+	 * equals the offset in the data file
+	 */
+	if( ( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+	 && ( ( internal_file->io_handle->autoclear_feature_flags & LIBQCOW_AUTOCLEAR_FEATURE_FLAG_RAW_EXTERNAL_DATA ) == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported external data file that is not raw.",
+		 function );
 
-		if( level2_table_file_offset > 0 )
+		goto on_error;
+	}
+	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
 		{
-			if( libfdata_vector_get_element_value_at_offset(
-			     internal_file->level2_table_vector,
-			     (intptr_t *) file_io_handle,
-			     internal_file->level2_table_cache,
-			     (off64_t) level2_table_file_offset,
-			     &element_data_offset,
-			     (intptr_t **) &level2_table,
-			     0,
-			     error ) != 1 )
+			result = libqcow_internal_file_unlock_luks_encryption(
+			          internal_file,
+			          file_io_handle,
+			          error );
+
+			if( result == -1 )
 			{
 				libcerror_error_set(
 				 error,
 				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-				 "%s: unable to retrieve level2 table at offset: 0x%08" PRIx64 ".",
-				 function,
-				 level2_table_file_offset );
-
-				return( -1 );
-			}
-			level2_table_index = ( internal_file->current_offset >> internal_file->io_handle->number_of_cluster_block_bits )
-			                   & internal_file->io_handle->level2_index_bit_mask;
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to unlock LUKS encryption.",
+				 function );
 
-#if defined( HAVE_DEBUG_OUTPUT )
-			if( libcnotify_verbose != 0 )
-			{
-				libcnotify_printf(
-				 "%s: level 2 table index\t\t\t: %" PRIu64 "\n",
-				 function,
-				 level2_table_index );
+				goto on_error;
 			}
-#endif
-			if( level2_table_index > (uint64_t) INT_MAX )
+			/* Without a password or key only the metadata can be read
+			 */
+			else if( ( result == 0 )
+			      && ( ( access_flags & LIBQCOW_ACCESS_FLAG_METADATA_ONLY ) == 0 ) )
 			{
 				libcerror_error_set(
 				 error,
 				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
-				 "%s: invalid level 2 table index value out of bounds.",
+				 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+				 "%s: missing password or key to unlock LUKS encryption.",
 				 function );
 
-				return( -1 );
-			}
-			if( libqcow_cluster_table_get_reference_by_index(
-			     level2_table,
-			     (int) level2_table_index,
-			     &cluster_block_file_offset,
-			     error ) != 1 )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-				 "%s: unable to retrieve cluster block offset: 0x%08" PRIx64 " from level 2 table.",
-				 function,
-				 level2_table_index );
-
-				return( -1 );
+				goto on_error;
 			}
 		}
 		else
 		{
-			/* Handle sparse level 2 table
+			/* The AES-CBC key consists of the first 16 bytes of the password
+			 * if no key was set
 			 */
-			cluster_block_file_offset = 0;
-		}
+			if( ( internal_file->key_data_is_set == 0 )
+			 && ( internal_file->password != NULL ) )
+			{
+				key_data_size = internal_file->password_size;
+
+				if( key_data_size > 16 )
+				{
+					key_data_size = 16;
+				}
+				if( memory_copy(
+				     internal_file->key_data,
+				     internal_file->password,
+				     key_data_size ) == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+					 "%s: unable to copy password to key data.",
+					 function );
+
+					goto on_error;
+				}
+			}
+			internal_file->key_data_size = 16;
+
 #if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
-		{
-			libcnotify_printf(
-			 "%s: cluster block file offset\t\t: 0x%08" PRIx64 "\n",
-			 function,
-			 cluster_block_file_offset );
-		}
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: key:\n",
+				 function );
+				libcnotify_print_data(
+				 internal_file->key_data,
+				 16,
+				 0 );
+			}
 #endif
-		if( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
-		{
-			if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+			if( libqcow_encryption_get_shared_context(
+			     &( internal_file->encryption_context ),
+			     internal_file->encryption_method,
+			     internal_file->key_data,
+			     internal_file->key_data_size,
+			     error ) != 1 )
 			{
 				libcerror_error_set(
 				 error,
-				 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-				 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-				 "%s: simultaneous encryption and compression not supported.",
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create encryption context.",
 				 function );
 
-				return( -1 );
+				goto on_error;
 			}
-			cluster_block_is_compressed = 1;
 		}
-		else
-		{
-			cluster_block_is_compressed = 0;
-		}
-		cluster_block_file_offset &= internal_file->io_handle->offset_bit_mask;
-		cluster_block_offset       = internal_file->current_offset & internal_file->io_handle->cluster_block_bit_mask;
-
-		read_size = internal_file->io_handle->cluster_block_size - (size_t) cluster_block_offset;
+	}
+	if( libqcow_internal_file_select_read_function(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to select read function.",
+		 function );
 
-		if( ( (size64_t) internal_file->current_offset + read_size ) > internal_file->io_handle->media_size )
-		{
-			read_size = (size_t) ( internal_file->io_handle->media_size - internal_file->current_offset );
-		}
-		if( ( buffer_offset + read_size ) > buffer_size )
+		goto on_error;
+	}
+	/* The data path structures are created on the first read of the media data
+	 * when only the metadata is read on open
+	 */
+	if( ( access_flags & LIBQCOW_ACCESS_FLAG_METADATA_ONLY ) == 0 )
+	{
+		if( libqcow_internal_file_initialize_data_path(
+		     internal_file,
+		     file_io_handle,
+		     error ) != 1 )
 		{
-			read_size = buffer_size - buffer_offset;
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path.",
+			 function );
+
+			goto on_error;
 		}
-		if( cluster_block_file_offset == 0 )
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_PRELOAD_LEVEL2_TABLES ) != 0 )
 		{
-			/* Handle sparse cluster block
-			 */
-			if( memory_set(
-			     &( ( (uint8_t *) buffer )[ buffer_offset ] ),
-			     0,
-			     read_size ) == NULL )
+			if( libqcow_internal_file_preload_level2_tables(
+			     internal_file,
+			     file_io_handle,
+			     error ) != 1 )
 			{
 				libcerror_error_set(
 				 error,
-				 LIBCERROR_ERROR_DOMAIN_MEMORY,
-				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
-				 "%s: unable to set sparse data in buffer.",
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to preload level 2 tables.",
 				 function );
 
-				return( -1 );
+				goto on_error;
 			}
 		}
-		else if( cluster_block_is_compressed != 0 )
-		{
-			/* Handle compressed cluster block
-			 */
-			compressed_cluster_block_size   = (size_t) ( cluster_block_file_offset >> internal_file->io_handle->compression_bit_shift );
-			compressed_cluster_block_offset = cluster_block_file_offset & internal_file->io_handle->compression_bit_mask;
+	}
+	if( libqcow_internal_file_read_snapshot_table(
+	     internal_file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read snapshot table.",
+		 function );
 
-			if( ( internal_file->io_handle->format_version == 2 )
-			 || ( internal_file->io_handle->format_version == 3 ) )
-			{
-				compressed_cluster_block_size += 1;
-				compressed_cluster_block_size *= 512;
+		goto on_error;
+	}
+	if( libqcow_internal_file_read_bitmap_directory(
+	     internal_file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read bitmap directory.",
+		 function );
 
-				/* Make sure the compressed block size stays within the bounds
-				 * of the cluster block size and the size of the file
-				 */
-				compressed_cluster_block_end_offset = compressed_cluster_block_offset / internal_file->io_handle->cluster_block_size;
+		goto on_error;
+	}
+	if( ( access_flags & LIBQCOW_ACCESS_FLAG_WRITE ) != 0 )
+	{
+		if( ( access_flags & LIBQCOW_ACCESS_FLAG_METADATA_ONLY ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: write access not supported with metadata only.",
+			 function );
 
-				if( ( compressed_cluster_block_offset % internal_file->io_handle->cluster_block_size ) != 0 )
-				{
-					compressed_cluster_block_end_offset += 1;
-				}
-				compressed_cluster_block_end_offset += 1;
-				compressed_cluster_block_end_offset *= internal_file->io_handle->cluster_block_size;
+			goto on_error;
+		}
+		if( libqcow_internal_file_open_write(
+		     internal_file,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open file for writing.",
+			 function );
 
-				if( compressed_cluster_block_end_offset > internal_file->size )
-				{
-					compressed_cluster_block_end_offset = internal_file->size;
-				}
-				if( ( compressed_cluster_block_offset + compressed_cluster_block_size ) > compressed_cluster_block_end_offset )
-				{
-					compressed_cluster_block_size = (size_t) ( compressed_cluster_block_end_offset - compressed_cluster_block_offset );
-				}
-			}
-			cache_entry_index = ( compressed_cluster_block_offset & internal_file->io_handle->cluster_block_bit_mask )
-			                  % LIBQCOW_MAXIMUM_CACHE_ENTRIES_CLUSTER_BLOCKS;
+			goto on_error;
+		}
+	}
+	return( 1 );
 
-#if defined( HAVE_DEBUG_OUTPUT )
-			if( libcnotify_verbose != 0 )
-			{
-				libcnotify_printf(
-				 "%s: compressed cluster block offset\t\t: 0x%08" PRIx64 "\n",
-				 function,
-				 compressed_cluster_block_offset );
+on_error:
+	if( internal_file->write_cache != NULL )
+	{
+		libqcow_write_cache_free(
+		 &( internal_file->write_cache ),
+		 NULL );
+	}
+	libqcow_internal_file_free_data_path(
+	 internal_file,
+	 NULL );
 
-				libcnotify_printf(
-				 "%s: compressed cluster block size\t\t: %" PRIzd "\n",
-				 function,
-				 compressed_cluster_block_size );
-			}
-#endif
-/* TODO check cache */
-			{
-				cluster_block = NULL;
+	return( -1 );
+}
 
-				if( libqcow_cluster_block_initialize(
-				     &cluster_block,
-				     compressed_cluster_block_size,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-					 "%s: unable to create cluster block.",
-					 function );
+/* Unlocks the LUKS encryption of a file
+ * Uses the key if set, which must be the master key, otherwise the key slots
+ * are unlocked with the password after which the master key is stored as key
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful, 0 if neither a password nor a key is set or -1 on error
+ */
+int libqcow_internal_file_unlock_luks_encryption(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_luks_header_t *luks_header = NULL;
+	static char *function              = "libqcow_internal_file_unlock_luks_encryption";
+	int result                         = 0;
 
-					return( -1 );
-				}
-				if( libqcow_cluster_block_read(
-				     cluster_block,
-				     file_io_handle,
-				     compressed_cluster_block_offset,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_IO,
-					 LIBCERROR_IO_ERROR_READ_FAILED,
-					 "%s: unable to read compressed cluster block at offset: 0x%08" PRIx64".",
-					 function,
-					 compressed_cluster_block_offset );
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
 
-					libqcow_cluster_block_free(
-					 &cluster_block,
-					 NULL );
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
 
-					return( -1 );
-				}
-				if( libfcache_cache_set_value_by_index(
-				     internal_file->compressed_cluster_block_cache,
-				     cache_entry_index,
-				     0,
-				     compressed_cluster_block_offset,
-				     0,
-				     (intptr_t *) cluster_block,
-				     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free,
-				     LIBFCACHE_CACHE_VALUE_FLAG_MANAGED,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-					 "%s: unable to set value in cache entry: %d.",
-					 function,
-					 cache_entry_index );
+		return( -1 );
+	}
+	if( ( internal_file->key_data_is_set == 0 )
+	 && ( internal_file->password == NULL ) )
+	{
+		return( 0 );
+	}
+	if( ( internal_file->io_handle->encryption_header_offset <= 0 )
+	 || ( internal_file->io_handle->encryption_header_size == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing full disk encryption header extension.",
+		 function );
 
-					libqcow_cluster_block_free(
-					 &cluster_block,
-					 NULL );
+		return( -1 );
+	}
+	if( libqcow_luks_header_initialize(
+	     &luks_header,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create LUKS header.",
+		 function );
 
-					return( -1 );
-				}
-				cluster_block->compressed_data = cluster_block->data;
-				cluster_block->data_size       = internal_file->io_handle->cluster_block_size;
+		goto on_error;
+	}
+	if( libqcow_luks_header_read_file_io_handle(
+	     luks_header,
+	     file_io_handle,
+	     internal_file->io_handle->encryption_header_offset,
+	     (size64_t) internal_file->io_handle->encryption_header_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read LUKS header.",
+		 function );
 
-				cluster_block->data = (uint8_t *) memory_allocate(
-								   sizeof( uint8_t ) * cluster_block->data_size );
+		goto on_error;
+	}
+	if( internal_file->key_data_is_set != 0 )
+	{
+		result = libqcow_luks_header_verify_master_key(
+		          luks_header,
+		          internal_file->key_data,
+		          internal_file->key_data_size,
+		          error );
 
-				if( cluster_block->data == NULL )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_MEMORY,
-					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
-					 "%s: unable to create cluster block data.",
-					 function );
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to verify master key.",
+			 function );
 
-					return( -1 );
-				}
-				cluster_block_data_size = cluster_block->data_size;
-
-				if( libqcow_decompress_data(
-				     cluster_block->compressed_data,
-				     compressed_cluster_block_size,
-				     LIBQCOW_COMPRESSION_METHOD_DEFLATE,
-				     cluster_block->data,
-				     &cluster_block_data_size,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: key does not match master key digest.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+	{
+		result = libqcow_luks_header_unlock(
+		          luks_header,
+		          internal_file->password,
+		          internal_file->password_size,
+		          internal_file->key_data,
+		          LIBQCOW_LUKS_MAXIMUM_KEY_SIZE,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to unlock LUKS header.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+			 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+			 "%s: password does not unlock any key slot.",
+			 function );
+
+			goto on_error;
+		}
+		internal_file->key_data_size   = (size_t) luks_header->key_size;
+		internal_file->key_data_is_set = 1;
+	}
+	if( libqcow_encryption_get_shared_context(
+	     &( internal_file->encryption_context ),
+	     internal_file->encryption_method,
+	     internal_file->key_data,
+	     internal_file->key_data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create encryption context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_luks_header_free(
+	     &luks_header,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free LUKS header.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( luks_header != NULL )
+	{
+		libqcow_luks_header_free(
+		 &luks_header,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Creates the data path structures of a file
+ * These are the decompression context, the level 1 table, the pools and the caches
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_initialize_data_path(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_source_file  = NULL;
+	static char *function                          = "libqcow_internal_file_initialize_data_path";
+	size_t maximum_number_of_arena_slots           = 0;
+	size_t maximum_number_of_pooled_cluster_blocks = 0;
+	int maximum_number_of_level2_table_slices      = 0;
+	int number_of_level2_table_slices              = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->decompression_context != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - decompression context already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->level1_table != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - level 1 table already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->level2_table_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - level2 table cache already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->translation_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - translation cache already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->level2_table_pool != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - level2 table pool already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->cluster_block_pool != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - cluster block pool already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->cluster_block_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - cluster block cache already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->compressed_cluster_block_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - compressed cluster block cache already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_decompression_context_initialize(
+	     &( internal_file->decompression_context ),
+	     internal_file->io_handle->compression_method,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create decompression context.",
+		 function );
+
+		goto on_error;
+	}
+	/* A reader uses the level 1 table and the pools of its source file
+	 */
+	if( internal_file->source_file != NULL )
+	{
+		internal_source_file = (libqcow_internal_file_t *) internal_file->source_file;
+
+		internal_file->level1_table = internal_source_file->level1_table;
+	}
+	else
+	{
+		if( libqcow_cluster_table_initialize(
+		     &( internal_file->level1_table ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create level 1 table.",
+			 function );
+
+			goto on_error;
+		}
+		/* The level 1 table is read in pages of the cluster block size on first use
+		 * so that the time to open a file does not depend on the media size
+		 */
+		if( libqcow_cluster_table_read_on_demand(
+		     internal_file->level1_table,
+		     internal_file->io_handle->level1_table_offset,
+		     (size_t) internal_file->io_handle->level1_table_size,
+		     internal_file->io_handle->cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set level 1 table to be read on demand.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	/* The level 2 table cache holds level 2 table slices, each cache entry
+	 * is worth a limited number of slices so that the memory used by the cache
+	 * does not grow with the cluster block size
+	 */
+	number_of_level2_table_slices = (int) internal_file->io_handle->number_of_level2_table_slices;
+
+	if( number_of_level2_table_slices > LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY )
+	{
+		number_of_level2_table_slices = LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY;
+	}
+	if( internal_file->maximum_number_of_level2_table_cache_entries > ( INT_MAX / number_of_level2_table_slices ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - maximum number of level 2 table cache entries value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	maximum_number_of_level2_table_slices = internal_file->maximum_number_of_level2_table_cache_entries
+	                                      * number_of_level2_table_slices;
+
+	if( libqcow_block_cache_initialize(
+	     &( internal_file->level2_table_cache ),
+	     maximum_number_of_level2_table_slices,
+	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_table_free,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level2 table cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_translation_cache_initialize(
+	     &( internal_file->translation_cache ),
+	     LIBQCOW_TRANSLATION_CACHE_NUMBER_OF_ENTRIES,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create translation cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_source_file != NULL )
+	{
+		internal_file->io_handle->level2_table_pool = internal_source_file->level2_table_pool;
+	}
+	else
+	{
+		if( libqcow_cluster_table_pool_initialize(
+		     &( internal_file->level2_table_pool ),
+		     internal_file->io_handle->level2_table_slice_size,
+		     LIBQCOW_MAXIMUM_NUMBER_OF_POOLED_LEVEL2_TABLES,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create level2 table pool.",
+			 function );
+
+			goto on_error;
+		}
+		/* The arena holds the level 2 table slices of the cache and of the pool
+		 */
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_USE_HUGE_PAGES ) != 0 )
+		{
+			maximum_number_of_arena_slots = LIBQCOW_MAXIMUM_LEVEL2_TABLE_ARENA_SIZE / internal_file->io_handle->level2_table_slice_size;
+
+			if( maximum_number_of_arena_slots > (size_t) ( maximum_number_of_level2_table_slices + LIBQCOW_MAXIMUM_NUMBER_OF_POOLED_LEVEL2_TABLES ) )
+			{
+				maximum_number_of_arena_slots = (size_t) ( maximum_number_of_level2_table_slices + LIBQCOW_MAXIMUM_NUMBER_OF_POOLED_LEVEL2_TABLES );
+			}
+			else if( maximum_number_of_arena_slots == 0 )
+			{
+				maximum_number_of_arena_slots = 1;
+			}
+			if( libqcow_cluster_table_pool_initialize_arena(
+			     internal_file->level2_table_pool,
+			     (int) maximum_number_of_arena_slots,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create level2 table pool arena.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		internal_file->io_handle->level2_table_pool = internal_file->level2_table_pool;
+	}
+	internal_file->io_handle->statistics = internal_file->statistics;
+
+	if( libqcow_block_cache_initialize(
+	     &( internal_file->cluster_block_cache ),
+	     internal_file->maximum_number_of_cluster_block_cache_entries,
+	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create cluster block cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_block_cache_initialize(
+	     &( internal_file->compressed_cluster_block_cache ),
+	     internal_file->maximum_number_of_cluster_block_cache_entries,
+	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create compressed cluster block cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_source_file != NULL )
+	{
+		internal_file->io_handle->cluster_block_pool = internal_source_file->cluster_block_pool;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		internal_file->io_handle->numa_topology            = internal_source_file->io_handle->numa_topology;
+		internal_file->io_handle->numa_cluster_block_pools = internal_source_file->io_handle->numa_cluster_block_pools;
+#endif
+	}
+	else
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_NUMA_PLACEMENT ) == 0 )
+		{
+			if( libqcow_internal_file_initialize_numa_placement(
+			     internal_file,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to initialize NUMA placement.",
+				 function );
+
+				goto on_error;
+			}
+		}
+#endif
+		maximum_number_of_pooled_cluster_blocks = LIBQCOW_MAXIMUM_CLUSTER_BLOCK_POOL_SIZE / internal_file->io_handle->cluster_block_size;
+
+		if( maximum_number_of_pooled_cluster_blocks > LIBQCOW_MAXIMUM_NUMBER_OF_POOLED_CLUSTER_BLOCKS )
+		{
+			maximum_number_of_pooled_cluster_blocks = LIBQCOW_MAXIMUM_NUMBER_OF_POOLED_CLUSTER_BLOCKS;
+		}
+		else if( maximum_number_of_pooled_cluster_blocks == 0 )
+		{
+			maximum_number_of_pooled_cluster_blocks = 1;
+		}
+		/* The arena holds the cluster blocks of both cluster block caches and of the pool
+		 */
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_USE_HUGE_PAGES ) != 0 )
+		{
+			maximum_number_of_arena_slots = LIBQCOW_MAXIMUM_CLUSTER_BLOCK_ARENA_SIZE / internal_file->io_handle->cluster_block_size;
+
+			if( maximum_number_of_arena_slots > ( ( 2 * (size_t) internal_file->maximum_number_of_cluster_block_cache_entries ) + maximum_number_of_pooled_cluster_blocks ) )
+			{
+				maximum_number_of_arena_slots = ( 2 * (size_t) internal_file->maximum_number_of_cluster_block_cache_entries ) + maximum_number_of_pooled_cluster_blocks;
+			}
+			else if( maximum_number_of_arena_slots == 0 )
+			{
+				maximum_number_of_arena_slots = 1;
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		/* With NUMA placement the buffers are divided over a pool per node
+		 */
+		if( internal_file->number_of_numa_nodes > 1 )
+		{
+			maximum_number_of_pooled_cluster_blocks /= (size_t) internal_file->number_of_numa_nodes;
+
+			if( maximum_number_of_pooled_cluster_blocks == 0 )
+			{
+				maximum_number_of_pooled_cluster_blocks = 1;
+			}
+			maximum_number_of_arena_slots /= (size_t) internal_file->number_of_numa_nodes;
+
+			if( ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_USE_HUGE_PAGES ) != 0 )
+			 && ( maximum_number_of_arena_slots == 0 ) )
+			{
+				maximum_number_of_arena_slots = 1;
+			}
+		}
+#endif
+		if( libqcow_cluster_block_pool_initialize(
+		     &( internal_file->cluster_block_pool ),
+		     internal_file->io_handle->cluster_block_size,
+		     (int) maximum_number_of_pooled_cluster_blocks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create cluster block pool.",
+			 function );
+
+			goto on_error;
+		}
+		if( maximum_number_of_arena_slots > 0 )
+		{
+			if( libqcow_cluster_block_pool_initialize_arena(
+			     internal_file->cluster_block_pool,
+			     (int) maximum_number_of_arena_slots,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create cluster block pool arena.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		internal_file->io_handle->cluster_block_pool = internal_file->cluster_block_pool;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( internal_file->number_of_numa_nodes > 1 )
+		{
+			if( libqcow_internal_file_initialize_numa_cluster_block_pools(
+			     internal_file,
+			     (int) maximum_number_of_pooled_cluster_blocks,
+			     (int) maximum_number_of_arena_slots,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create NUMA node cluster block pools.",
+				 function );
+
+				goto on_error;
+			}
+			internal_file->io_handle->numa_topology            = internal_file->numa_topology;
+			internal_file->io_handle->numa_cluster_block_pools = internal_file->numa_cluster_block_pools;
+		}
+#endif
+	}
+	internal_file->data_path_is_initialized = 1;
+
+	return( 1 );
+
+on_error:
+	libqcow_internal_file_free_data_path(
+	 internal_file,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Frees the data path structures of a file
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_free_data_path(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_free_data_path";
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->compressed_cluster_block_cache != NULL )
+	{
+		if( libqcow_block_cache_free(
+		     &( internal_file->compressed_cluster_block_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free compressed cluster block cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->cluster_block_cache != NULL )
+	{
+		if( libqcow_block_cache_free(
+		     &( internal_file->cluster_block_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cluster block cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->cluster_block_pool != NULL )
+	{
+		if( internal_file->io_handle != NULL )
+		{
+			internal_file->io_handle->cluster_block_pool = NULL;
+		}
+		if( libqcow_cluster_block_pool_free(
+		     &( internal_file->cluster_block_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cluster block pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_internal_file_free_numa_placement(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free NUMA placement.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( internal_file->level2_table_cache != NULL )
+	{
+		if( libqcow_block_cache_free(
+		     &( internal_file->level2_table_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level2 table cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->translation_cache != NULL )
+	{
+		if( libqcow_translation_cache_free(
+		     &( internal_file->translation_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free translation cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->level2_table_pool != NULL )
+	{
+		if( internal_file->io_handle != NULL )
+		{
+			internal_file->io_handle->level2_table_pool = NULL;
+		}
+		if( libqcow_cluster_table_pool_free(
+		     &( internal_file->level2_table_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level2 table pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+	/* The level 1 table of a reader is managed by its source file
+	 */
+	if( internal_file->source_file != NULL )
+	{
+		internal_file->level1_table = NULL;
+	}
+	else if( internal_file->level1_table != NULL )
+	{
+		if( libqcow_cluster_table_free(
+		     &( internal_file->level1_table ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level 1 table.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->decompression_context != NULL )
+	{
+		if( libqcow_decompression_context_free(
+		     &( internal_file->decompression_context ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free decompression context.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->compressed_read_window != NULL )
+	{
+		memory_free(
+		 internal_file->compressed_read_window );
+
+		internal_file->compressed_read_window = NULL;
+	}
+	internal_file->data_path_is_initialized         = 0;
+	internal_file->level2_table_read_end_offset     = 0;
+	internal_file->compressed_read_window_offset    = 0;
+	internal_file->compressed_read_window_data_size = 0;
+	internal_file->compressed_read_offset           = 0;
+	internal_file->compressed_read_end_offset       = 0;
+
+	return( result );
+}
+
+/* Creates the data path structures of a file that was opened metadata only
+ * This function is called with the read lock held, the lock is upgraded
+ * to the write lock while the data path structures are created
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_initialize_data_path_for_reading(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_initialize_data_path_for_reading";
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->data_path_is_initialized != 0 )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		libcthreads_read_write_lock_grab_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	/* Another thread could have created the data path structures
+	 * while the lock was released
+	 */
+	if( internal_file->data_path_is_initialized == 0 )
+	{
+		if( libqcow_internal_file_initialize_data_path(
+		     internal_file,
+		     internal_file->file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Maps the file into memory for reading
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful, 0 if the file cannot be memory mapped or -1 on error
+ */
+int libqcow_internal_file_open_memory_map(
+     libqcow_internal_file_t *internal_file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_open_memory_map";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->memory_map != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - memory map value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_memory_map_initialize(
+	     &( internal_file->memory_map ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create memory map.",
+		 function );
+
+		goto on_error;
+	}
+	result = libqcow_memory_map_open(
+	          internal_file->memory_map,
+	          filename,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open memory map.",
+		 function );
+
+		goto on_error;
+	}
+	/* If the file cannot be mapped or has changed since it was opened
+	 * the data is read using the file IO handle
+	 */
+	if( ( result == 0 )
+	 || ( (size64_t) internal_file->memory_map->data_size != internal_file->size ) )
+	{
+		if( libqcow_memory_map_free(
+		     &( internal_file->memory_map ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free memory map.",
+			 function );
+
+			goto on_error;
+		}
+		return( 0 );
+	}
+	internal_file->io_handle->memory_map = internal_file->memory_map;
+
+	return( 1 );
+
+on_error:
+	if( internal_file->memory_map != NULL )
+	{
+		libqcow_memory_map_free(
+		 &( internal_file->memory_map ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Opens the file for asynchronous reading using io_uring
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful, 0 if io_uring is not available or -1 on error
+ */
+int libqcow_internal_file_open_io_uring(
+     libqcow_internal_file_t *internal_file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_open_io_uring";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_uring != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - io_uring value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_uring_initialize(
+	     &( internal_file->io_uring ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create io_uring.",
+		 function );
+
+		goto on_error;
+	}
+	result = libqcow_io_uring_open(
+	          internal_file->io_uring,
+	          filename,
+	          internal_file->io_queue_depth,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open io_uring.",
+		 function );
+
+		goto on_error;
+	}
+	/* If io_uring is not available the data is read using the file IO handle
+	 */
+	else if( result == 0 )
+	{
+		if( libqcow_io_uring_free(
+		     &( internal_file->io_uring ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free io_uring.",
+			 function );
+
+			goto on_error;
+		}
+		return( 0 );
+	}
+	return( 1 );
+
+on_error:
+	if( internal_file->io_uring != NULL )
+	{
+		libqcow_io_uring_free(
+		 &( internal_file->io_uring ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Opens the file for asynchronous reading
+ * On Windows the file is read using overlapped IO and an IO completion port
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful, 0 if io_uring is not available or -1 on error
+ */
+int libqcow_internal_file_open_io_uring_wide(
+     libqcow_internal_file_t *internal_file,
+     const wchar_t *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_open_io_uring_wide";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_uring != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - io_uring value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_uring_initialize(
+	     &( internal_file->io_uring ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create io_uring.",
+		 function );
+
+		goto on_error;
+	}
+	result = libqcow_io_uring_open_wide(
+	          internal_file->io_uring,
+	          filename,
+	          internal_file->io_queue_depth,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open io_uring.",
+		 function );
+
+		goto on_error;
+	}
+	/* If asynchronous reading is not available the data is read using the file IO handle
+	 */
+	else if( result == 0 )
+	{
+		if( libqcow_io_uring_free(
+		     &( internal_file->io_uring ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free io_uring.",
+			 function );
+
+			goto on_error;
+		}
+		return( 0 );
+	}
+	return( 1 );
+
+on_error:
+	if( internal_file->io_uring != NULL )
+	{
+		libqcow_io_uring_free(
+		 &( internal_file->io_uring ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Reads the snapshot table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_snapshot_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_snapshot_values_t *snapshot_values = NULL;
+	static char *function                      = "libqcow_internal_file_read_snapshot_table";
+	size_t entry_size                          = 0;
+	off64_t file_offset                        = 0;
+	int snapshot_index                         = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->snapshot_values_array != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - snapshot values array already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle->number_of_snapshots == 0 )
+	{
+		return( 1 );
+	}
+	if( internal_file->io_handle->number_of_snapshots > (uint32_t) LIBQCOW_MAXIMUM_NUMBER_OF_SNAPSHOTS )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of snapshots value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "Reading snapshot table:\n" );
+	}
+#endif
+	internal_file->snapshot_values_array = (libqcow_snapshot_values_t **) memory_allocate(
+	                                                                       sizeof( libqcow_snapshot_values_t * ) * internal_file->io_handle->number_of_snapshots );
+
+	if( internal_file->snapshot_values_array == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create snapshot values array.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_file->snapshot_values_array,
+	     0,
+	     sizeof( libqcow_snapshot_values_t * ) * internal_file->io_handle->number_of_snapshots ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear snapshot values array.",
+		 function );
+
+		goto on_error;
+	}
+	file_offset = internal_file->io_handle->snapshots_offset;
+
+	for( snapshot_index = 0;
+	     snapshot_index < (int) internal_file->io_handle->number_of_snapshots;
+	     snapshot_index++ )
+	{
+		if( libqcow_snapshot_values_initialize(
+		     &snapshot_values,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create snapshot values: %d.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		if( libqcow_snapshot_values_read_file_io_handle(
+		     snapshot_values,
+		     file_io_handle,
+		     file_offset,
+		     &entry_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read snapshot values: %d.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		internal_file->snapshot_values_array[ snapshot_index ] = snapshot_values;
+		internal_file->number_of_snapshots                    += 1;
+
+		snapshot_values = NULL;
+		file_offset    += (off64_t) entry_size;
+	}
+	internal_file->snapshot_table_size = (size64_t) ( file_offset - internal_file->io_handle->snapshots_offset );
+
+	return( 1 );
+
+on_error:
+	if( snapshot_values != NULL )
+	{
+		libqcow_snapshot_values_free(
+		 &snapshot_values,
+		 NULL );
+	}
+	if( internal_file->snapshot_values_array != NULL )
+	{
+		for( snapshot_index = 0;
+		     snapshot_index < internal_file->number_of_snapshots;
+		     snapshot_index++ )
+		{
+			libqcow_snapshot_values_free(
+			 &( internal_file->snapshot_values_array[ snapshot_index ] ),
+			 NULL );
+		}
+		memory_free(
+		 internal_file->snapshot_values_array );
+
+		internal_file->snapshot_values_array = NULL;
+	}
+	internal_file->number_of_snapshots = 0;
+
+	return( -1 );
+}
+
+/* Reads the bitmap directory
+ * The bitmaps are only read when the bitmaps extension is marked consistent
+ * by the bitmaps auto-clear feature flag
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_bitmap_directory(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_bitmap_values_t *bitmap_values = NULL;
+	uint8_t *directory_data                = NULL;
+	static char *function                  = "libqcow_internal_file_read_bitmap_directory";
+	size_t data_offset                     = 0;
+	size_t directory_size                  = 0;
+	size_t entry_size                      = 0;
+	ssize_t read_count                     = 0;
+	int bitmap_index                       = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->bitmap_values_array != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - bitmap values array already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_handle->number_of_bitmaps == 0 )
+	 || ( ( internal_file->io_handle->autoclear_feature_flags & LIBQCOW_AUTOCLEAR_FEATURE_FLAG_BITMAPS ) == 0 ) )
+	{
+		return( 1 );
+	}
+	if( internal_file->io_handle->number_of_bitmaps > (uint32_t) LIBQCOW_MAXIMUM_NUMBER_OF_BITMAPS )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of bitmaps value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_handle->bitmap_directory_size == 0 )
+	 || ( internal_file->io_handle->bitmap_directory_size > (uint64_t) LIBQCOW_MAXIMUM_BITMAP_DIRECTORY_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap directory size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	directory_size = (size_t) internal_file->io_handle->bitmap_directory_size;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "Reading bitmap directory:\n" );
+	}
+#endif
+	directory_data = (uint8_t *) memory_allocate(
+	                              sizeof( uint8_t ) * directory_size );
+
+	if( directory_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create bitmap directory data.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              directory_data,
+	              directory_size,
+	              internal_file->io_handle->bitmap_directory_offset,
+	              error );
+
+	if( read_count != (ssize_t) directory_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read bitmap directory at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 internal_file->io_handle->bitmap_directory_offset,
+		 internal_file->io_handle->bitmap_directory_offset );
+
+		goto on_error;
+	}
+	internal_file->bitmap_values_array = (libqcow_bitmap_values_t **) memory_allocate(
+	                                                                   sizeof( libqcow_bitmap_values_t * ) * internal_file->io_handle->number_of_bitmaps );
+
+	if( internal_file->bitmap_values_array == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create bitmap values array.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_file->bitmap_values_array,
+	     0,
+	     sizeof( libqcow_bitmap_values_t * ) * internal_file->io_handle->number_of_bitmaps ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear bitmap values array.",
+		 function );
+
+		goto on_error;
+	}
+	for( bitmap_index = 0;
+	     bitmap_index < (int) internal_file->io_handle->number_of_bitmaps;
+	     bitmap_index++ )
+	{
+		if( data_offset >= directory_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid bitmap directory size value too small for bitmap: %d.",
+			 function,
+			 bitmap_index );
+
+			goto on_error;
+		}
+		if( libqcow_bitmap_values_initialize(
+		     &bitmap_values,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create bitmap values: %d.",
+			 function,
+			 bitmap_index );
+
+			goto on_error;
+		}
+		if( libqcow_bitmap_values_read_data(
+		     bitmap_values,
+		     &( directory_data[ data_offset ] ),
+		     directory_size - data_offset,
+		     &entry_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read bitmap values: %d.",
+			 function,
+			 bitmap_index );
+
+			goto on_error;
+		}
+		internal_file->bitmap_values_array[ bitmap_index ] = bitmap_values;
+		internal_file->number_of_bitmaps                  += 1;
+
+		bitmap_values = NULL;
+		data_offset  += entry_size;
+	}
+	memory_free(
+	 directory_data );
+
+	return( 1 );
+
+on_error:
+	if( bitmap_values != NULL )
+	{
+		libqcow_bitmap_values_free(
+		 &bitmap_values,
+		 NULL );
+	}
+	if( internal_file->bitmap_values_array != NULL )
+	{
+		for( bitmap_index = 0;
+		     bitmap_index < internal_file->number_of_bitmaps;
+		     bitmap_index++ )
+		{
+			libqcow_bitmap_values_free(
+			 &( internal_file->bitmap_values_array[ bitmap_index ] ),
+			 NULL );
+		}
+		memory_free(
+		 internal_file->bitmap_values_array );
+
+		internal_file->bitmap_values_array = NULL;
+	}
+	internal_file->number_of_bitmaps = 0;
+
+	if( directory_data != NULL )
+	{
+		memory_free(
+		 directory_data );
+	}
+	return( -1 );
+}
+
+/* Marks the host cluster blocks of a specific range as referenced
+ * The reference map contains a saturating reference counter per host cluster block
+ * Ranges beyond the end of the file are ignored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_mark_referenced_clusters(
+     libqcow_internal_file_t *internal_file,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     off64_t file_offset,
+     size64_t size,
+     libcerror_error_t **error )
+{
+	static char *function        = "libqcow_internal_file_mark_referenced_clusters";
+	uint64_t cluster_block_index = 0;
+	uint64_t last_cluster_index  = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference map.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( file_offset < 0 )
+	 || ( size == 0 ) )
+	{
+		return( 1 );
+	}
+	cluster_block_index = (uint64_t) file_offset >> internal_file->io_handle->number_of_cluster_block_bits;
+	last_cluster_index  = ( (uint64_t) file_offset + size - 1 ) >> internal_file->io_handle->number_of_cluster_block_bits;
+
+	while( ( cluster_block_index <= last_cluster_index )
+	    && ( cluster_block_index < number_of_host_clusters ) )
+	{
+		if( reference_map[ cluster_block_index ] < 0xff )
+		{
+			reference_map[ cluster_block_index ] += 1;
+		}
+		cluster_block_index++;
+	}
+	return( 1 );
+}
+
+/* Marks the host cluster blocks referenced by a level 1 table as referenced
+ * This includes the level 2 tables and the cluster blocks they reference
+ * A level 2 table that was already marked, for example because it is shared
+ * with a snapshot, is not read again unless the data fragments are counted
+ * If number_of_data_clusters and number_of_data_fragments are not NULL the
+ * uncompressed data cluster blocks and the number of runs of consecutively
+ * stored data cluster blocks are counted in media order
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_mark_level1_table_clusters(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     off64_t level1_table_offset,
+     size_t level1_table_size,
+     uint64_t *number_of_data_clusters,
+     uint64_t *number_of_data_fragments,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_table    = NULL;
+	libqcow_cluster_table_t *level2_table    = NULL;
+	static char *function                    = "libqcow_internal_file_mark_level1_table_clusters";
+	uint64_t cluster_block_file_offset       = 0;
+	uint64_t cluster_block_reference         = 0;
+	uint64_t compressed_cluster_block_offset = 0;
+	uint64_t level2_table_file_offset        = 0;
+	uint64_t previous_cluster_block_offset   = 0;
+	size_t compressed_cluster_block_size     = 0;
+	int level1_table_index                   = 0;
+	int level2_table_index                   = 0;
+	int number_of_level1_table_references    = 0;
+	int number_of_level2_table_references    = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference map.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_data_clusters == NULL )
+	 != ( number_of_data_fragments == NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of data clusters and fragments - both values must be set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( level1_table_offset <= 0 )
+	 || ( level1_table_size == 0 ) )
+	{
+		return( 1 );
+	}
+	if( libqcow_internal_file_mark_referenced_clusters(
+	     internal_file,
+	     reference_map,
+	     number_of_host_clusters,
+	     level1_table_offset,
+	     (size64_t) level1_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark level 1 table clusters.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_initialize(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_read(
+	     level1_table,
+	     file_io_handle,
+	     level1_table_offset,
+	     level1_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		goto on_error;
+	}
+	for( level1_table_index = 0;
+	     level1_table_index < number_of_level1_table_references;
+	     level1_table_index++ )
+	{
+		if( internal_file->abort != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_ABORT_REQUESTED,
+			 "%s: abort requested.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_table_get_reference_by_index(
+		     level1_table,
+		     level1_table_index,
+		     &level2_table_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 1 table reference: %d.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+		if( ( level2_table_file_offset == 0 )
+		 || ( level2_table_file_offset >= internal_file->size ) )
+		{
+			continue;
+		}
+		if( ( number_of_data_clusters == NULL )
+		 && ( reference_map[ level2_table_file_offset >> internal_file->io_handle->number_of_cluster_block_bits ] != 0 ) )
+		{
+			continue;
+		}
+		if( libqcow_internal_file_mark_referenced_clusters(
+		     internal_file,
+		     reference_map,
+		     number_of_host_clusters,
+		     (off64_t) level2_table_file_offset,
+		     (size64_t) internal_file->io_handle->level2_table_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark level 2 table: %d clusters.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_table_initialize(
+		     &level2_table,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create level 2 table.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_table_read(
+		     level2_table,
+		     file_io_handle,
+		     (off64_t) level2_table_file_offset,
+		     internal_file->io_handle->level2_table_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 table: %d.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_table_get_number_of_references(
+		     level2_table,
+		     &number_of_level2_table_references,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve number of level 2 table references.",
+			 function );
+
+			goto on_error;
+		}
+		/* An extended level 2 table entry is followed by its subcluster bitmap
+		 */
+		for( level2_table_index = 0;
+		     level2_table_index < number_of_level2_table_references;
+		     level2_table_index += 1 << ( internal_file->io_handle->number_of_level2_table_entry_bits - 3 ) )
+		{
+			if( libqcow_cluster_table_get_reference_by_index(
+			     level2_table,
+			     level2_table_index,
+			     &cluster_block_reference,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve level 2 table reference: %d.",
+				 function,
+				 level2_table_index );
+
+				goto on_error;
+			}
+			if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+			{
+				if( libqcow_internal_file_get_compressed_cluster_block_range(
+				     internal_file,
+				     cluster_block_reference & internal_file->io_handle->offset_bit_mask,
+				     &compressed_cluster_block_offset,
+				     &compressed_cluster_block_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve compressed cluster block range.",
+					 function );
+
+					goto on_error;
+				}
+				if( libqcow_internal_file_mark_referenced_clusters(
+				     internal_file,
+				     reference_map,
+				     number_of_host_clusters,
+				     (off64_t) compressed_cluster_block_offset,
+				     (size64_t) compressed_cluster_block_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to mark compressed cluster block clusters.",
+					 function );
+
+					goto on_error;
+				}
+				continue;
+			}
+			cluster_block_file_offset = cluster_block_reference
+			                          & internal_file->io_handle->offset_bit_mask
+			                          & ~( internal_file->io_handle->cluster_block_bit_mask );
+
+			if( cluster_block_file_offset == 0 )
+			{
+				continue;
+			}
+			/* The clusters of an external data file are not part of the file
+			 */
+			if( ( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) == 0 )
+			 && ( libqcow_internal_file_mark_referenced_clusters(
+			       internal_file,
+			       reference_map,
+			       number_of_host_clusters,
+			       (off64_t) cluster_block_file_offset,
+			       (size64_t) internal_file->io_handle->cluster_block_size,
+			       error ) != 1 ) )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to mark cluster block clusters.",
+				 function );
+
+				goto on_error;
+			}
+			if( number_of_data_clusters != NULL )
+			{
+				if( ( *number_of_data_clusters == 0 )
+				 || ( cluster_block_file_offset != ( previous_cluster_block_offset + internal_file->io_handle->cluster_block_size ) ) )
+				{
+					*number_of_data_fragments += 1;
+				}
+				*number_of_data_clusters += 1;
+
+				previous_cluster_block_offset = cluster_block_file_offset;
+			}
+		}
+		if( libqcow_cluster_table_free(
+		     &level2_table,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level 2 table.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_cluster_table_free(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( level2_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &level2_table,
+		 NULL );
+	}
+	if( level1_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &level1_table,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads the reference count table
+ * The reference count table is read once and kept for subsequent use
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_reference_count_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_read_reference_count_table";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->reference_count_table != NULL )
+	{
+		return( 1 );
+	}
+	if( libqcow_reference_count_table_initialize(
+	     &( internal_file->reference_count_table ),
+	     internal_file->io_handle->cluster_block_size,
+	     internal_file->io_handle->reference_count_order,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_reference_count_table_read_file_io_handle(
+	     internal_file->reference_count_table,
+	     file_io_handle,
+	     internal_file->io_handle->reference_count_table_offset,
+	     internal_file->io_handle->reference_count_table_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( internal_file->reference_count_table != NULL )
+	{
+		libqcow_reference_count_table_free(
+		 &( internal_file->reference_count_table ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Marks the host cluster blocks that contain metadata as referenced
+ * This includes the file header, the reference count table and blocks,
+ * the snapshot table and the bitmap directory, tables and data but not
+ * the level 1 and 2 tables
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_mark_metadata_clusters(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     libcerror_error_t **error )
+{
+	libqcow_bitmap_values_t *bitmap_values = NULL;
+	static char *function                  = "libqcow_internal_file_mark_metadata_clusters";
+	off64_t block_offset                   = 0;
+	uint64_t bitmap_table_entry            = 0;
+	uint32_t table_index                   = 0;
+	int bitmap_index                       = 0;
+	int block_index                        = 0;
+	int number_of_blocks                   = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	/* The file header, the header extensions and the backing filename are stored in the first cluster block
+	 */
+	if( libqcow_internal_file_mark_referenced_clusters(
+	     internal_file,
+	     reference_map,
+	     number_of_host_clusters,
+	     0,
+	     (size64_t) internal_file->io_handle->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark file header clusters.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_mark_referenced_clusters(
+	     internal_file,
+	     reference_map,
+	     number_of_host_clusters,
+	     internal_file->io_handle->reference_count_table_offset,
+	     (size64_t) internal_file->io_handle->reference_count_table_clusters * internal_file->io_handle->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark reference count table clusters.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_reference_count_table_get_number_of_blocks(
+	     internal_file->reference_count_table,
+	     &number_of_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of reference count blocks.",
+		 function );
+
+		return( -1 );
+	}
+	for( block_index = 0;
+	     block_index < number_of_blocks;
+	     block_index++ )
+	{
+		if( libqcow_reference_count_table_get_block_offset_by_index(
+		     internal_file->reference_count_table,
+		     block_index,
+		     &block_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve offset of reference count block: %d.",
+			 function,
+			 block_index );
+
+			return( -1 );
+		}
+		if( libqcow_internal_file_mark_referenced_clusters(
+		     internal_file,
+		     reference_map,
+		     number_of_host_clusters,
+		     block_offset,
+		     (size64_t) internal_file->io_handle->cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark reference count block: %d clusters.",
+			 function,
+			 block_index );
+
+			return( -1 );
+		}
+	}
+	if( libqcow_internal_file_mark_referenced_clusters(
+	     internal_file,
+	     reference_map,
+	     number_of_host_clusters,
+	     internal_file->io_handle->snapshots_offset,
+	     internal_file->snapshot_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark snapshot table clusters.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->number_of_bitmaps > 0 )
+	{
+		if( libqcow_internal_file_mark_referenced_clusters(
+		     internal_file,
+		     reference_map,
+		     number_of_host_clusters,
+		     internal_file->io_handle->bitmap_directory_offset,
+		     (size64_t) internal_file->io_handle->bitmap_directory_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark bitmap directory clusters.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	for( bitmap_index = 0;
+	     bitmap_index < internal_file->number_of_bitmaps;
+	     bitmap_index++ )
+	{
+		bitmap_values = internal_file->bitmap_values_array[ bitmap_index ];
+
+		if( bitmap_values->number_of_bitmap_table_entries == 0 )
+		{
+			continue;
+		}
+		if( bitmap_values->bitmap_table == NULL )
+		{
+			if( libqcow_bitmap_values_read_bitmap_table(
+			     bitmap_values,
+			     file_io_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read bitmap: %d table.",
+				 function,
+				 bitmap_index );
+
+				return( -1 );
+			}
+		}
+		if( libqcow_internal_file_mark_referenced_clusters(
+		     internal_file,
+		     reference_map,
+		     number_of_host_clusters,
+		     bitmap_values->bitmap_table_offset,
+		     (size64_t) bitmap_values->number_of_bitmap_table_entries * 8,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark bitmap: %d table clusters.",
+			 function,
+			 bitmap_index );
+
+			return( -1 );
+		}
+		for( table_index = 0;
+		     table_index < bitmap_values->number_of_bitmap_table_entries;
+		     table_index++ )
+		{
+			bitmap_table_entry = bitmap_values->bitmap_table[ table_index ] & 0x00fffffffffffe00ULL;
+
+			if( bitmap_table_entry == 0 )
+			{
+				continue;
+			}
+			if( libqcow_internal_file_mark_referenced_clusters(
+			     internal_file,
+			     reference_map,
+			     number_of_host_clusters,
+			     (off64_t) bitmap_table_entry,
+			     (size64_t) internal_file->io_handle->cluster_block_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to mark bitmap: %d data clusters.",
+				 function,
+				 bitmap_index );
+
+				return( -1 );
+			}
+		}
+	}
+	return( 1 );
+}
+
+/* Determines the host allocation statistics
+ * The reference count of every host cluster block is compared with the references
+ * from the file header, the reference count table, the snapshot table and
+ * the level 1 tables of the file and its snapshots
+ * The data cluster blocks themselves are not read
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_determine_host_allocation_statistics(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_snapshot_values_t *snapshot_values = NULL;
+	uint8_t *reference_map                     = NULL;
+	static char *function                      = "libqcow_internal_file_determine_host_allocation_statistics";
+	uint64_t cluster_block_index               = 0;
+	uint64_t number_of_data_clusters           = 0;
+	uint64_t number_of_data_fragments          = 0;
+	uint64_t number_of_host_clusters           = 0;
+	uint64_t reference_count                   = 0;
+	int snapshot_index                         = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	/* Version 1 does not define reference counts
+	 */
+	if( ( internal_file->io_handle->format_version == 1 )
+	 || ( internal_file->io_handle->reference_count_table_offset == 0 ) )
+	{
+		return( 0 );
+	}
+	number_of_host_clusters = internal_file->size >> internal_file->io_handle->number_of_cluster_block_bits;
+
+	if( ( internal_file->size & internal_file->io_handle->cluster_block_bit_mask ) != 0 )
+	{
+		number_of_host_clusters += 1;
+	}
+	if( number_of_host_clusters > (uint64_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of host clusters value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_read_reference_count_table(
+	     internal_file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	reference_map = (uint8_t *) memory_allocate(
+	                             sizeof( uint8_t ) * (size_t) number_of_host_clusters );
+
+	if( reference_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference map.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     reference_map,
+	     0,
+	     sizeof( uint8_t ) * (size_t) number_of_host_clusters ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference map.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_mark_metadata_clusters(
+	     internal_file,
+	     file_io_handle,
+	     reference_map,
+	     number_of_host_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark metadata clusters.",
+		 function );
+
+		goto on_error;
+	}
+	/* The level 1 table of the file is marked first so that the data fragments
+	 * are counted for all the data cluster blocks of the current media
+	 */
+	if( libqcow_internal_file_mark_level1_table_clusters(
+	     internal_file,
+	     file_io_handle,
+	     reference_map,
+	     number_of_host_clusters,
+	     internal_file->io_handle->level1_table_offset,
+	     (size_t) internal_file->io_handle->level1_table_size,
+	     &number_of_data_clusters,
+	     &number_of_data_fragments,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to mark level 1 table clusters.",
+		 function );
+
+		goto on_error;
+	}
+	for( snapshot_index = 0;
+	     snapshot_index < internal_file->number_of_snapshots;
+	     snapshot_index++ )
+	{
+		snapshot_values = internal_file->snapshot_values_array[ snapshot_index ];
+
+		if( libqcow_internal_file_mark_level1_table_clusters(
+		     internal_file,
+		     file_io_handle,
+		     reference_map,
+		     number_of_host_clusters,
+		     snapshot_values->level1_table_offset,
+		     (size_t) snapshot_values->level1_table_size,
+		     NULL,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to mark snapshot: %d level 1 table clusters.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+	}
+	internal_file->number_of_used_clusters   = 0;
+	internal_file->number_of_leaked_clusters = 0;
+	internal_file->number_of_shared_clusters = 0;
+
+	for( cluster_block_index = 0;
+	     cluster_block_index < number_of_host_clusters;
+	     cluster_block_index++ )
+	{
+		if( libqcow_reference_count_table_get_reference_count(
+		     internal_file->reference_count_table,
+		     file_io_handle,
+		     cluster_block_index,
+		     &reference_count,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve reference count of cluster block: %" PRIu64 ".",
+			 function,
+			 cluster_block_index );
+
+			goto on_error;
+		}
+		if( reference_count == 0 )
+		{
+			continue;
+		}
+		internal_file->number_of_used_clusters += 1;
+
+		if( reference_count > 1 )
+		{
+			internal_file->number_of_shared_clusters += 1;
+		}
+		if( reference_map[ cluster_block_index ] == 0 )
+		{
+			internal_file->number_of_leaked_clusters += 1;
+		}
+	}
+	/* The fragmentation ratio is the fraction of the transitions between
+	 * consecutive data cluster blocks that are not stored consecutively
+	 */
+	if( number_of_data_clusters > 1 )
+	{
+		internal_file->fragmentation_ratio = (double) ( number_of_data_fragments - 1 )
+		                                   / (double) ( number_of_data_clusters - 1 );
+	}
+	else
+	{
+		internal_file->fragmentation_ratio = 0.0;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: number of host clusters\t: %" PRIu64 "\n",
+		 function,
+		 number_of_host_clusters );
+
+		libcnotify_printf(
+		 "%s: number of used clusters\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->number_of_used_clusters );
+
+		libcnotify_printf(
+		 "%s: number of leaked clusters\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->number_of_leaked_clusters );
+
+		libcnotify_printf(
+		 "%s: number of shared clusters\t: %" PRIu64 "\n",
+		 function,
+		 internal_file->number_of_shared_clusters );
+
+		libcnotify_printf(
+		 "%s: number of data clusters\t: %" PRIu64 "\n",
+		 function,
+		 number_of_data_clusters );
+
+		libcnotify_printf(
+		 "%s: number of data fragments\t: %" PRIu64 "\n",
+		 function,
+		 number_of_data_fragments );
+
+		libcnotify_printf(
+		 "\n" );
+	}
+#endif
+	memory_free(
+	 reference_map );
+
+	return( 1 );
+
+on_error:
+	if( reference_map != NULL )
+	{
+		memory_free(
+		 reference_map );
+	}
+	return( -1 );
+}
+
+/* Retrieves the host allocation statistics
+ * The statistics are determined the first time they are requested
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_get_host_allocation_statistics(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_get_host_allocation_statistics";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->host_allocation_statistics_determined != 0 )
+	{
+		return( (int) internal_file->host_allocation_statistics_available );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The file IO handle is shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	result = libqcow_internal_file_determine_host_allocation_statistics(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine host allocation statistics.",
+		 function );
+	}
+	else
+	{
+		internal_file->host_allocation_statistics_determined = 1;
+		internal_file->host_allocation_statistics_available  = (uint8_t) result;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the memory usage of the values in a cache
+ * The memory usage of each cached value is determined by the get_memory_usage function
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cache_values_memory_usage(
+     libqcow_block_cache_t *cache,
+     int (*get_memory_usage)(
+            intptr_t *value,
+            size_t *memory_usage,
+            libcerror_error_t **error ),
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	intptr_t *value             = NULL;
+	static char *function       = "libqcow_internal_file_get_cache_values_memory_usage";
+	size_t value_memory_usage   = 0;
+	int cache_entry_index       = 0;
+	int number_of_cache_entries = 0;
+
+	if( get_memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid get memory usage function.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache == NULL )
+	{
+		return( 1 );
+	}
+	if( libqcow_block_cache_get_number_of_entries(
+	     cache,
+	     &number_of_cache_entries,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of cache entries.",
+		 function );
+
+		return( -1 );
+	}
+	for( cache_entry_index = 0;
+	     cache_entry_index < number_of_cache_entries;
+	     cache_entry_index++ )
+	{
+		if( libqcow_block_cache_get_value_by_index(
+		     cache,
+		     cache_entry_index,
+		     &value,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cache value: %d.",
+			 function,
+			 cache_entry_index );
+
+			return( -1 );
+		}
+		if( value == NULL )
+		{
+			continue;
+		}
+		if( get_memory_usage(
+		     value,
+		     &value_memory_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of cache value: %d.",
+			 function,
+			 cache_entry_index );
+
+			return( -1 );
+		}
+		*memory_usage += value_memory_usage;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage of the caches and pools
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cache_memory_usage(
+     libqcow_internal_file_t *internal_file,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_get_cache_memory_usage";
+	size64_t cache_usage  = 0;
+	size64_t safe_usage   = 0;
+	size_t pool_usage     = 0;
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int node_index        = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cache_values_memory_usage(
+	     internal_file->level2_table_cache,
+	     (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_table_get_memory_usage,
+	     &safe_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage of level2 table cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cache_values_memory_usage(
+	     internal_file->cluster_block_cache,
+	     (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_block_get_memory_usage,
+	     &safe_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage of cluster block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cache_values_memory_usage(
+	     internal_file->compressed_cluster_block_cache,
+	     (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_block_get_memory_usage,
+	     &safe_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage of compressed cluster block cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->shared_cache != NULL )
+	{
+		if( libqcow_internal_cache_get_memory_usage_by_owner(
+		     (libqcow_internal_cache_t *) internal_file->shared_cache,
+		     internal_file->cache_owner,
+		     &cache_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of shared cache.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += cache_usage;
+	}
+	if( internal_file->level2_table_pool != NULL )
+	{
+		if( libqcow_cluster_table_pool_get_memory_usage(
+		     internal_file->level2_table_pool,
+		     &pool_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of level2 table pool.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += pool_usage;
+	}
+	if( internal_file->cluster_block_pool != NULL )
+	{
+		if( libqcow_cluster_block_pool_get_memory_usage(
+		     internal_file->cluster_block_pool,
+		     &pool_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of cluster block pool.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += pool_usage;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( internal_file->numa_cluster_block_pools != NULL )
+	{
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( libqcow_cluster_block_pool_get_memory_usage(
+			     internal_file->numa_cluster_block_pools[ node_index ],
+			     &pool_usage,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve memory usage of cluster block pool of NUMA node: %d.",
+				 function,
+				 node_index );
+
+				return( -1 );
+			}
+			safe_usage += pool_usage;
+		}
+	}
+#endif
+	if( internal_file->compressed_read_window != NULL )
+	{
+		safe_usage += LIBQCOW_COMPRESSED_READ_WINDOW_SIZE;
+	}
+	if( internal_file->metadata_index != NULL )
+	{
+		if( libqcow_metadata_index_get_memory_usage(
+		     internal_file->metadata_index,
+		     &pool_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of metadata index.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += pool_usage;
+	}
+	*memory_usage = safe_usage;
+
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the number of bytes allocated by the library for the file,
+ * which consists of the file and IO handle, the level 1 table, the snapshot and
+ * bitmap values, the caches and their cached values, the pools, the indexes, and
+ * the write cache and scratch overlay
+ * The values a reader shares with its source file are accounted for by the source file
+ * This function is not multi-thread safe acquire write lock and cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_memory_usage(
+     libqcow_internal_file_t *internal_file,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	libqcow_bitmap_values_t *bitmap_values     = NULL;
+	libqcow_block_cache_t *block_cache         = NULL;
+	libqcow_snapshot_values_t *snapshot_values = NULL;
+	static char *function                      = "libqcow_internal_file_get_memory_usage";
+	size64_t cache_usage                       = 0;
+	size64_t safe_usage                        = 0;
+	size_t value_usage                         = 0;
+	int cache_index                            = 0;
+	int value_index                            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cache_memory_usage(
+	     internal_file,
+	     &cache_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cache memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	safe_usage = sizeof( libqcow_internal_file_t ) + cache_usage + internal_file->password_size;
+
+	if( internal_file->io_handle != NULL )
+	{
+		safe_usage += sizeof( libqcow_io_handle_t );
+	}
+	if( internal_file->statistics != NULL )
+	{
+		safe_usage += sizeof( libqcow_statistics_t );
+	}
+	for( cache_index = 0;
+	     cache_index < 3;
+	     cache_index++ )
+	{
+		switch( cache_index )
+		{
+			case 0:
+				block_cache = internal_file->level2_table_cache;
+				break;
+
+			case 1:
+				block_cache = internal_file->cluster_block_cache;
+				break;
+
+			default:
+				block_cache = internal_file->compressed_cluster_block_cache;
+				break;
+		}
+		if( block_cache == NULL )
+		{
+			continue;
+		}
+		if( libqcow_block_cache_get_memory_usage(
+		     block_cache,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of block cache: %d.",
+			 function,
+			 cache_index );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	if( internal_file->translation_cache != NULL )
+	{
+		if( libqcow_translation_cache_get_memory_usage(
+		     internal_file->translation_cache,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of translation cache.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	if( internal_file->chain_index != NULL )
+	{
+		if( libqcow_chain_index_get_memory_usage(
+		     internal_file->chain_index,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of chain index.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	if( internal_file->reference_count_table != NULL )
+	{
+		if( libqcow_reference_count_table_get_memory_usage(
+		     internal_file->reference_count_table,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of reference count table.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	if( internal_file->write_cache != NULL )
+	{
+		if( libqcow_write_cache_get_memory_usage(
+		     internal_file->write_cache,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of write cache.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	if( internal_file->scratch_overlay != NULL )
+	{
+		if( libqcow_scratch_overlay_get_memory_usage(
+		     internal_file->scratch_overlay,
+		     &value_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of scratch overlay.",
+			 function );
+
+			return( -1 );
+		}
+		safe_usage += value_usage;
+	}
+	/* The level 1 table, the snapshot values and the bitmap values
+	 * of a reader are managed by its source file
+	 */
+	if( internal_file->source_file == NULL )
+	{
+		if( internal_file->level1_table != NULL )
+		{
+			if( libqcow_cluster_table_get_memory_usage(
+			     internal_file->level1_table,
+			     &value_usage,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve memory usage of level 1 table.",
+				 function );
+
+				return( -1 );
+			}
+			safe_usage += value_usage;
+		}
+		if( internal_file->snapshot_values_array != NULL )
+		{
+			for( value_index = 0;
+			     value_index < internal_file->number_of_snapshots;
+			     value_index++ )
+			{
+				safe_usage += sizeof( libqcow_snapshot_values_t * );
+
+				snapshot_values = internal_file->snapshot_values_array[ value_index ];
+
+				if( snapshot_values != NULL )
+				{
+					safe_usage += sizeof( libqcow_snapshot_values_t )
+					            + snapshot_values->identifier_size
+					            + snapshot_values->name_size;
+				}
+			}
+		}
+		if( internal_file->bitmap_values_array != NULL )
+		{
+			for( value_index = 0;
+			     value_index < internal_file->number_of_bitmaps;
+			     value_index++ )
+			{
+				safe_usage += sizeof( libqcow_bitmap_values_t * );
+
+				bitmap_values = internal_file->bitmap_values_array[ value_index ];
+
+				if( bitmap_values != NULL )
+				{
+					safe_usage += sizeof( libqcow_bitmap_values_t ) + bitmap_values->name_size;
+
+					if( bitmap_values->bitmap_table != NULL )
+					{
+						safe_usage += sizeof( uint64_t ) * (size64_t) bitmap_values->number_of_bitmap_table_entries;
+					}
+					if( ( bitmap_values->cluster_data != NULL )
+					 && ( internal_file->io_handle != NULL ) )
+					{
+						safe_usage += internal_file->io_handle->cluster_block_size;
+					}
+				}
+			}
+		}
+	}
+	*memory_usage = safe_usage;
+
+	return( 1 );
+}
+
+/* Releases the buffers kept in the pools for reuse
+ * This function is not multi-thread safe acquire write lock and cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_clear_pools(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_clear_pools";
+	int result            = 1;
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int node_index        = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->level2_table_pool != NULL )
+	{
+		if( libqcow_cluster_table_pool_clear(
+		     internal_file->level2_table_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to clear level2 table pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->cluster_block_pool != NULL )
+	{
+		if( libqcow_cluster_block_pool_clear(
+		     internal_file->cluster_block_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to clear cluster block pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( internal_file->numa_cluster_block_pools != NULL )
+	{
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( libqcow_cluster_block_pool_clear(
+			     internal_file->numa_cluster_block_pools[ node_index ],
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear cluster block pool of NUMA node: %d.",
+				 function,
+				 node_index );
+
+				result = -1;
+			}
+		}
+	}
+#endif
+	return( result );
+}
+
+/* Evicts values from the caches until the memory usage of the file, including a value
+ * that is about to be cached, does not exceed the maximum memory size
+ * The buffers kept in the pools for reuse are released first, after that the least
+ * recently used compressed cluster blocks, cluster blocks and level 2 tables are evicted
+ * The memory reserved by the pool arenas cannot be released and the values in the
+ * shared cache are limited by the maximum memory size of the shared cache
+ * This function is not multi-thread safe acquire write lock and cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_enforce_maximum_memory_size(
+     libqcow_internal_file_t *internal_file,
+     size_t value_memory_usage,
+     libcerror_error_t **error )
+{
+	int (*get_value_memory_usage)(
+	       intptr_t *value,
+	       size_t *memory_usage,
+	       libcerror_error_t **error ) = NULL;
+
+	libqcow_block_cache_t *block_cache = NULL;
+	intptr_t *value                    = NULL;
+	static char *function              = "libqcow_internal_file_enforce_maximum_memory_size";
+	size64_t memory_usage              = 0;
+	size_t evicted_memory_usage        = 0;
+	int cache_index                    = 0;
+	int entry_index                    = 0;
+	int number_of_evicted_values       = 0;
+	int result                         = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->maximum_memory_size == 0 )
+	{
+		return( 1 );
+	}
+	if( libqcow_internal_file_get_memory_usage(
+	     internal_file,
+	     &memory_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( memory_usage + value_memory_usage ) <= internal_file->maximum_memory_size )
+	{
+		return( 1 );
+	}
+	if( libqcow_internal_file_clear_pools(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+		 "%s: unable to clear pools.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_memory_usage(
+	     internal_file,
+	     &memory_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	memory_usage += value_memory_usage;
+
+	for( cache_index = 0;
+	     cache_index < 3;
+	     cache_index++ )
+	{
+		switch( cache_index )
+		{
+			case 0:
+				block_cache            = internal_file->compressed_cluster_block_cache;
+				get_value_memory_usage = (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_block_get_memory_usage;
+				break;
+
+			case 1:
+				block_cache            = internal_file->cluster_block_cache;
+				get_value_memory_usage = (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_block_get_memory_usage;
+				break;
+
+			default:
+				block_cache            = internal_file->level2_table_cache;
+				get_value_memory_usage = (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_table_get_memory_usage;
+				break;
+		}
+		if( block_cache == NULL )
+		{
+			continue;
+		}
+		while( memory_usage > internal_file->maximum_memory_size )
+		{
+			result = libqcow_block_cache_get_eviction_index(
+			          block_cache,
+			          &entry_index,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve eviction index of block cache: %d.",
+				 function,
+				 cache_index );
+
+				return( -1 );
+			}
+			else if( result == 0 )
+			{
+				break;
+			}
+			if( libqcow_block_cache_get_value_by_index(
+			     block_cache,
+			     entry_index,
+			     &value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve value: %d from block cache: %d.",
+				 function,
+				 entry_index,
+				 cache_index );
+
+				return( -1 );
+			}
+			if( get_value_memory_usage(
+			     value,
+			     &evicted_memory_usage,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve memory usage of value: %d from block cache: %d.",
+				 function,
+				 entry_index,
+				 cache_index );
+
+				return( -1 );
+			}
+			if( libqcow_block_cache_remove_value_by_index(
+			     block_cache,
+			     entry_index,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to remove value: %d from block cache: %d.",
+				 function,
+				 entry_index,
+				 cache_index );
+
+				return( -1 );
+			}
+			if( evicted_memory_usage > memory_usage )
+			{
+				evicted_memory_usage = (size_t) memory_usage;
+			}
+			memory_usage -= evicted_memory_usage;
+
+			number_of_evicted_values++;
+		}
+	}
+	/* The buffers of the evicted values are kept in the pools for reuse
+	 */
+	if( number_of_evicted_values > 0 )
+	{
+		if( libqcow_internal_file_clear_pools(
+		     internal_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to clear pools.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Drops the cached level 2 tables and (compressed) cluster blocks
+ * The flags, see LIBQCOW_CACHE_FLAGS, determine which caches are dropped
+ * The buffers kept in the pools for reuse are released as well
+ * This function is not multi-thread safe acquire write lock and cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_drop_caches(
+     libqcow_internal_file_t *internal_file,
+     int flags,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_drop_caches";
+	int result            = 1;
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int node_index        = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( flags & ~( LIBQCOW_CACHE_FLAG_ALL ) ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported flags: 0x%02x.",
+		 function,
+		 flags );
+
+		return( -1 );
+	}
+	if( ( flags & LIBQCOW_CACHE_FLAG_LEVEL2_TABLES ) != 0 )
+	{
+		if( internal_file->level2_table_cache != NULL )
+		{
+			if( libqcow_block_cache_clear(
+			     internal_file->level2_table_cache,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear level2 table cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( internal_file->translation_cache != NULL )
+		{
+			if( libqcow_translation_cache_clear(
+			     internal_file->translation_cache,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear translation cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( internal_file->shared_cache != NULL )
+		{
+			if( libqcow_internal_cache_remove_values_by_type(
+			     (libqcow_internal_cache_t *) internal_file->shared_cache,
+			     internal_file->cache_owner,
+			     LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to remove level2 tables from shared cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( internal_file->level2_table_pool != NULL )
+		{
+			if( libqcow_cluster_table_pool_clear(
+			     internal_file->level2_table_pool,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear level2 table pool.",
+				 function );
+
+				result = -1;
+			}
+		}
+	}
+	if( ( flags & LIBQCOW_CACHE_FLAG_CLUSTER_BLOCKS ) != 0 )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		/* Stop the read-ahead from filling the cache again
+		 */
+		internal_file->read_ahead_window             = 0;
+		internal_file->read_ahead_end_offset         = internal_file->read_ahead_offset;
+		internal_file->read_ahead_advised_end_offset = 0;
+#endif
+		if( internal_file->cluster_block_cache != NULL )
+		{
+			if( libqcow_block_cache_clear(
+			     internal_file->cluster_block_cache,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear cluster block cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( internal_file->shared_cache != NULL )
+		{
+			if( libqcow_internal_cache_remove_values_by_type(
+			     (libqcow_internal_cache_t *) internal_file->shared_cache,
+			     internal_file->cache_owner,
+			     LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to remove cluster blocks from shared cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+	}
+	if( ( flags & LIBQCOW_CACHE_FLAG_COMPRESSED_CLUSTER_BLOCKS ) != 0 )
+	{
+		if( internal_file->compressed_cluster_block_cache != NULL )
+		{
+			if( libqcow_block_cache_clear(
+			     internal_file->compressed_cluster_block_cache,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear compressed cluster block cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( internal_file->shared_cache != NULL )
+		{
+			if( libqcow_internal_cache_remove_values_by_type(
+			     (libqcow_internal_cache_t *) internal_file->shared_cache,
+			     internal_file->cache_owner,
+			     LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to remove compressed cluster blocks from shared cache.",
+				 function );
+
+				result = -1;
+			}
+		}
+	}
+	/* The cluster block pool is shared by the cluster block caches
+	 */
+	if( ( ( flags & ( LIBQCOW_CACHE_FLAG_CLUSTER_BLOCKS | LIBQCOW_CACHE_FLAG_COMPRESSED_CLUSTER_BLOCKS ) ) != 0 )
+	 && ( internal_file->cluster_block_pool != NULL ) )
+	{
+		if( libqcow_cluster_block_pool_clear(
+		     internal_file->cluster_block_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to clear cluster block pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( ( ( flags & ( LIBQCOW_CACHE_FLAG_CLUSTER_BLOCKS | LIBQCOW_CACHE_FLAG_COMPRESSED_CLUSTER_BLOCKS ) ) != 0 )
+	 && ( internal_file->numa_cluster_block_pools != NULL ) )
+	{
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( libqcow_cluster_block_pool_clear(
+			     internal_file->numa_cluster_block_pools[ node_index ],
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+				 "%s: unable to clear cluster block pool of NUMA node: %d.",
+				 function,
+				 node_index );
+
+				result = -1;
+			}
+		}
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves a level 2 table or cluster block from a cache
+ * The value is retrieved from the shared cache if set on the file, otherwise from the block cache
+ * A value retrieved from the shared cache must be released using
+ * libqcow_internal_file_release_cached_value
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_get_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t **value,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_get_cached_value";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	*cache_value = NULL;
+
+	if( internal_file->shared_cache != NULL )
+	{
+		result = libqcow_internal_cache_get_value(
+		          (libqcow_internal_cache_t *) internal_file->shared_cache,
+		          internal_file->cache_owner,
+		          value_type,
+		          offset,
+		          cache_value,
+		          error );
+
+		if( result == 1 )
+		{
+			*value = ( *cache_value )->value;
+		}
+	}
+	else
+	{
+		result = libqcow_block_cache_get_value_by_offset(
+		          block_cache,
+		          offset,
+		          value,
+		          error );
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve value: 0x%08" PRIx64 " from cache.",
+		 function,
+		 offset );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Sets a level 2 table or cluster block in a cache
+ * The value is stored in the shared cache if set on the file, otherwise in the block cache
+ * Level 2 tables are stored with a high priority, cluster blocks with a low priority
+ * when they are read by a sequential scan or read ahead, otherwise with a normal priority
+ * The cache takes over management of the value, the value is freed on error
+ * A value stored in the shared cache must be released using
+ * libqcow_internal_file_release_cached_value
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_set_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t *value,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	int (*free_value)(
+	       intptr_t **value,
+	       libcerror_error_t **error ) = NULL;
+
+	int (*get_value_size)(
+	       intptr_t *value,
+	       size_t *value_size,
+	       libcerror_error_t **error ) = NULL;
+
+	libqcow_cluster_block_t *cluster_block = NULL;
+	static char *function                  = "libqcow_internal_file_set_cached_value";
+	size_t value_size                      = 0;
+	uint8_t priority                       = LIBQCOW_CACHE_PRIORITY_NORMAL;
+	int result                             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	if( value_type == LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE )
+	{
+		free_value     = (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_table_free;
+		get_value_size = (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_table_get_memory_usage;
+		priority       = LIBQCOW_CACHE_PRIORITY_HIGH;
+	}
+	else
+	{
+		free_value     = (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free;
+		get_value_size = (int (*)(intptr_t *, size_t *, libcerror_error_t **)) &libqcow_cluster_block_get_memory_usage;
+
+		/* The data of an encrypted cluster block is decrypted after it is cached
+		 */
+		if( ( value_type == LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK )
+		 && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_DETECT_ZERO_CLUSTER_BLOCKS ) != 0 )
+		 && ( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE ) )
+		{
+			cluster_block = (libqcow_cluster_block_t *) value;
+
+			if( ( cluster_block != NULL )
+			 && ( cluster_block->data != NULL ) )
+			{
+				result = libqcow_zero_block_is_zero(
+				          cluster_block->data,
+				          cluster_block->data_size,
+				          error );
+
+				if( result == -1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to determine if cluster block: 0x%08" PRIx64 " is zero.",
+					 function,
+					 offset );
+
+					free_value(
+					 &value,
+					 NULL );
+
+					return( -1 );
+				}
+				else if( result != 0 )
+				{
+					cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_IS_ZERO;
+				}
+			}
+		}
+		if( internal_file->access_advice == LIBQCOW_ADVICE_SEQUENTIAL )
+		{
+			priority = LIBQCOW_CACHE_PRIORITY_LOW;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		else if( internal_file->is_reading_ahead != 0 )
+		{
+			priority = LIBQCOW_CACHE_PRIORITY_LOW;
+		}
+#endif
+	}
+	*cache_value = NULL;
+
+	if( internal_file->shared_cache != NULL )
+	{
+		result = libqcow_internal_cache_set_value(
+		          (libqcow_internal_cache_t *) internal_file->shared_cache,
+		          internal_file->cache_owner,
+		          value_type,
+		          offset,
+		          value,
+		          priority,
+		          free_value,
+		          get_value_size,
+		          cache_value,
+		          error );
+	}
+	else
+	{
+		/* Make room for the value when the file has a maximum memory size
+		 */
+		if( internal_file->maximum_memory_size != 0 )
+		{
+			result = get_value_size(
+			          value,
+			          &value_size,
+			          error );
+
+			if( result == 1 )
+			{
+				result = libqcow_internal_file_enforce_maximum_memory_size(
+				          internal_file,
+				          value_size,
+				          error );
+			}
+		}
+		else
+		{
+			result = 1;
+		}
+		if( result == 1 )
+		{
+			result = libqcow_block_cache_set_value_by_offset(
+			          block_cache,
+			          offset,
+			          value,
+			          priority,
+			          error );
+		}
+	}
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set value: 0x%08" PRIx64 " in cache.",
+		 function,
+		 offset );
+
+		/* The shared cache manages the value once it is referenced
+		 */
+		if( *cache_value == NULL )
+		{
+			free_value(
+			 &value,
+			 NULL );
+		}
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Releases a value retrieved from or stored in the shared cache
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_release_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_release_cached_value";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_value == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache value.",
+		 function );
+
+		return( -1 );
+	}
+	if( *cache_value == NULL )
+	{
+		return( 1 );
+	}
+	if( libqcow_internal_cache_release_value(
+	     (libqcow_internal_cache_t *) internal_file->shared_cache,
+	     cache_value,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release value in shared cache.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the cluster block reference for a specific offset
+ * The cluster block reference is the level 2 table entry including the flags
+ * or 0 if the cluster block is sparse
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cluster_block_reference(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	static char *function       = "libqcow_internal_file_get_cluster_block_reference";
+	uint64_t cluster_descriptor = 0;
+	uint64_t subcluster_bitmap  = 0;
+	uint64_t translation_index  = 0;
+	int result                  = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	/* The metadata index contains the level 2 table entries of the level 1 table of the file
+	 */
+	if( ( internal_file->metadata_index != NULL )
+	 && ( offset >= 0 )
+	 && ( (size64_t) offset < internal_file->metadata_index->media_size ) )
+	{
+		if( cluster_block_reference == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+			 "%s: invalid cluster block reference.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_metadata_index_get_entry_at_offset(
+		     internal_file->metadata_index,
+		     offset,
+		     &cluster_descriptor,
+		     &subcluster_bitmap,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve entry: 0x%08" PRIx64 " from metadata index.",
+			 function,
+			 offset );
+
+			return( -1 );
+		}
+		if( ( internal_file->metadata_index->entry_size == 16 )
+		 && ( ( cluster_descriptor & internal_file->io_handle->compression_flag_bit_mask ) == 0 ) )
+		{
+			if( libqcow_internal_file_get_subcluster_reference(
+			     internal_file,
+			     offset,
+			     cluster_descriptor,
+			     subcluster_bitmap,
+			     cluster_block_reference,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve subcluster reference.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		else
+		{
+			*cluster_block_reference = cluster_descriptor;
+		}
+		return( 1 );
+	}
+	/* The translation cache is consulted first so that a (sub)cluster that was
+	 * recently looked up does not require the level 1 and level 2 table lookups
+	 */
+	if( ( internal_file->translation_cache != NULL )
+	 && ( offset >= 0 ) )
+	{
+		if( internal_file->io_handle->number_of_level2_table_entry_bits > 3 )
+		{
+			translation_index = (uint64_t) offset >> internal_file->io_handle->number_of_subcluster_bits;
+		}
+		else
+		{
+			translation_index = (uint64_t) offset >> internal_file->io_handle->number_of_cluster_block_bits;
+		}
+		result = libqcow_translation_cache_get_reference(
+		          internal_file->translation_cache,
+		          translation_index,
+		          cluster_block_reference,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference from translation cache.",
+			 function );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			return( 1 );
+		}
+	}
+	if( libqcow_internal_file_get_cluster_block_reference_from_level1_table(
+	     internal_file,
+	     file_io_handle,
+	     internal_file->level1_table,
+	     offset,
+	     cluster_block_reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block reference from level 1 table.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->translation_cache != NULL )
+	 && ( offset >= 0 ) )
+	{
+		if( libqcow_translation_cache_set_reference(
+		     internal_file->translation_cache,
+		     translation_index,
+		     *cluster_block_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set cluster block reference in translation cache.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves the reference of the subcluster at a specific offset from an extended level 2 table entry
+ * The reference of an allocated subcluster is returned as if it were a cluster block,
+ * the reference of an unallocated subcluster as 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_subcluster_reference(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t cluster_descriptor,
+     uint64_t subcluster_bitmap,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	static char *function         = "libqcow_internal_file_get_subcluster_reference";
+	uint64_t cluster_block_offset = 0;
+	uint64_t subcluster_index     = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+	cluster_block_offset = cluster_descriptor;
+
+	subcluster_index = ( offset & internal_file->io_handle->cluster_block_bit_mask )
+	                 >> internal_file->io_handle->number_of_subcluster_bits;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: subcluster bitmap\t\t\t: 0x%08" PRIx64 "\n",
+		 function,
+		 subcluster_bitmap );
+
+		libcnotify_printf(
+		 "%s: subcluster index\t\t\t: %" PRIu64 "\n",
+		 function,
+		 subcluster_index );
+	}
+#endif
+	/* The upper 32 bits of the subcluster bitmap contain the zero flags
+	 * and the lower 32 bits the allocation flags. The reference of
+	 * the subcluster is returned as if it were a cluster block
+	 */
+	if( ( subcluster_bitmap & ( (uint64_t) 1 << ( 32 + subcluster_index ) ) ) != 0 )
+	{
+		cluster_block_offset = internal_file->io_handle->zero_flag_bit_mask;
+	}
+	else if( ( subcluster_bitmap & ( (uint64_t) 1 << subcluster_index ) ) != 0 )
+	{
+		cluster_block_offset &= internal_file->io_handle->offset_bit_mask
+		                      & ~( internal_file->io_handle->cluster_block_bit_mask );
+
+		if( cluster_block_offset == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid allocated subcluster: %" PRIu64 " without cluster block offset.",
+			 function,
+			 subcluster_index );
+
+			return( -1 );
+		}
+		cluster_block_offset += subcluster_index << internal_file->io_handle->number_of_subcluster_bits;
+	}
+	else
+	{
+		cluster_block_offset = 0;
+	}
+	*cluster_block_reference = cluster_block_offset;
+
+	return( 1 );
+}
+
+/* Retrieves the cluster block reference for a specific offset using a specific level 1 table
+ * The cluster block reference is the level 2 table entry including the flags
+ * or 0 if the cluster block is sparse
+ * The level 2 tables are shared by all level 1 tables of the file
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cluster_block_reference_from_level1_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	libqcow_address_split_t address_split;
+
+	libqcow_cache_value_t *cache_value      = NULL;
+	libqcow_cluster_table_t *level2_table   = NULL;
+	static char *function                   = "libqcow_internal_file_get_cluster_block_reference_from_level1_table";
+	uint64_t cluster_block_file_offset      = 0;
+	uint64_t level1_table_index             = 0;
+	uint64_t level2_table_file_offset       = 0;
+	uint64_t level2_table_index             = 0;
+	uint64_t level2_table_slice_file_offset = 0;
+	uint64_t level2_table_slice_index       = 0;
+	uint64_t subcluster_bitmap              = 0;
+	int entry_index                         = 0;
+	int number_of_level2_tables             = 0;
+	int result                              = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: offset\t\t\t\t\t: 0x%08" PRIx64 "\n",
+		 function,
+		 offset );
+	}
+#endif
+	if( libqcow_address_split_offset(
+	     internal_file->io_handle,
+	     (uint64_t) offset,
+	     &address_split,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to split offset.",
+		 function );
+
+		return( -1 );
+	}
+	level1_table_index = address_split.level1_table_index;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: level 1 table index\t\t\t: %" PRIu64 "\n",
+		 function,
+		 level1_table_index );
+	}
+#endif
+	if( level1_table_index > (uint64_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_read_reference_by_index(
+	     level1_table,
+	     file_io_handle,
+	     (int) level1_table_index,
+	     &level2_table_file_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve level 2 table offset: %" PRIi64 " from level 1 table.",
+		 function,
+		 level1_table_index );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: level 2 table file offset\t\t: 0x%08" PRIx64 "\n",
+		 function,
+		 level1_table_index );
+	}
+#endif
+	level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+	if( level2_table_file_offset > 0 )
+	{
+		level2_table_index = address_split.level2_table_index;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: level 2 table index\t\t\t: %" PRIu64 "\n",
+			 function,
+			 level2_table_index );
+		}
+#endif
+		if( level2_table_index > (uint64_t) INT_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid level 2 table index value out of bounds.",
+			 function );
+
+			return( -1 );
+		}
+		/* The level 2 table is cached in slices, the slice is identified
+		 * by its file offset
+		 */
+		level2_table_slice_index       = address_split.level2_table_slice_index;
+		level2_table_slice_file_offset = level2_table_file_offset + address_split.level2_table_slice_offset;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: level 2 table slice file offset\t: 0x%08" PRIx64 "\n",
+			 function,
+			 level2_table_slice_file_offset );
+		}
+#endif
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->level2_table_cache_lookups, 1 );
+
+		result = libqcow_internal_file_get_cached_value(
+		          internal_file,
+		          internal_file->level2_table_cache,
+		          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+		          (off64_t) level2_table_slice_file_offset,
+		          (intptr_t **) &level2_table,
+		          &cache_value,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level2 table: 0x%08" PRIx64 " from cache.",
+			 function,
+			 level2_table_slice_file_offset );
+
+			return( -1 );
+		}
+		/* When the level 2 table slice follows the previously read level 2 table slice
+		 * the adjacent level 2 table slices are read at once
+		 */
+		if( ( result == 0 )
+		 && ( internal_file->io_handle->memory_map == NULL )
+		 && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_READ_AHEAD ) == 0 )
+		 && ( (off64_t) level2_table_slice_file_offset == internal_file->level2_table_read_end_offset ) )
+		{
+			if( libqcow_internal_file_read_level2_tables(
+			     internal_file,
+			     file_io_handle,
+			     level1_table,
+			     (int) level1_table_index,
+			     level2_table_file_offset,
+			     level2_table_slice_file_offset,
+			     &number_of_level2_tables,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read level2 tables at offset: 0x%08" PRIx64 ".",
+				 function,
+				 level2_table_slice_file_offset );
+
+				return( -1 );
+			}
+			result = libqcow_internal_file_get_cached_value(
+			          internal_file,
+			          internal_file->level2_table_cache,
+			          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+			          (off64_t) level2_table_slice_file_offset,
+			          (intptr_t **) &level2_table,
+			          &cache_value,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve level2 table: 0x%08" PRIx64 " from cache.",
+				 function,
+				 level2_table_slice_file_offset );
+
+				return( -1 );
+			}
+		}
+		if( result == 0 )
+		{
+			LIBQCOW_TRACE(
+			 level2_table_miss,
+			 LIBQCOW_TRACE_EVENT_LEVEL2_TABLE_MISS,
+			 level2_table_slice_file_offset,
+			 internal_file->io_handle->level2_table_slice_size,
+			 0 );
+
+			level2_table = NULL;
+
+			if( libqcow_io_handle_read_level2_table(
+			     internal_file->io_handle,
+			     file_io_handle,
+			     (off64_t) level2_table_slice_file_offset,
+			     &level2_table,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read level2 table at offset: 0x%08" PRIx64 ".",
+				 function,
+				 level2_table_slice_file_offset );
+
+				return( -1 );
+			}
+			internal_file->level2_table_read_end_offset = (off64_t) ( level2_table_slice_file_offset + internal_file->io_handle->level2_table_slice_size );
+
+			if( libqcow_internal_file_set_cached_value(
+			     internal_file,
+			     internal_file->level2_table_cache,
+			     LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+			     (off64_t) level2_table_slice_file_offset,
+			     (intptr_t *) level2_table,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set level2 table: 0x%08" PRIx64 " in cache.",
+				 function,
+				 level2_table_slice_file_offset );
+
+				goto on_error;
+			}
+		}
+		/* The level 2 table is read as 64-bit references, an extended level 2
+		 * table entry consist of the cluster descriptor and the subcluster bitmap
+		 */
+		entry_index = (int) address_split.level2_table_slice_reference_index;
+
+		if( libqcow_cluster_table_get_reference_by_index(
+		     level2_table,
+		     entry_index,
+		     &cluster_block_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block offset: 0x%08" PRIx64 " from level 2 table.",
+			 function,
+			 level2_table_slice_index );
+
+			goto on_error;
+		}
+		if( ( internal_file->io_handle->number_of_level2_table_entry_bits > 3 )
+		 && ( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) == 0 ) )
+		{
+			if( libqcow_cluster_table_get_reference_by_index(
+			     level2_table,
+			     entry_index + 1,
+			     &subcluster_bitmap,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve subcluster bitmap: 0x%08" PRIx64 " from level 2 table.",
+				 function,
+				 level2_table_slice_index );
+
+				goto on_error;
+			}
+			if( libqcow_internal_file_get_subcluster_reference(
+			     internal_file,
+			     offset,
+			     cluster_block_file_offset,
+			     subcluster_bitmap,
+			     &cluster_block_file_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve subcluster reference.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		if( libqcow_internal_file_release_cached_value(
+		     internal_file,
+		     &cache_value,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release level2 table: 0x%08" PRIx64 " in cache.",
+			 function,
+			 level2_table_slice_file_offset );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		/* Handle sparse level 2 table
+		 */
+		cluster_block_file_offset = 0;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: cluster block file offset\t\t: 0x%08" PRIx64 "\n",
+		 function,
+		 cluster_block_file_offset );
+	}
+#endif
+	*cluster_block_reference = cluster_block_file_offset;
+
+	return( 1 );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Retrieves the cluster block reference for a specific offset without reading from the file
+ * The reference is looked up in the metadata index, the translation cache, the level 1 table
+ * and the level 2 table slices that are cached, none of these are read when not available
+ * The cluster block reference is the level 2 table entry including the flags
+ * or 0 if the cluster block is sparse
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if not available without reading or -1 on error
+ */
+int libqcow_internal_file_get_cached_cluster_block_reference(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	libqcow_address_split_t address_split;
+
+	libqcow_cache_value_t *cache_value      = NULL;
+	libqcow_cluster_table_t *level2_table   = NULL;
+	static char *function                   = "libqcow_internal_file_get_cached_cluster_block_reference";
+	uint64_t cluster_block_file_offset      = 0;
+	uint64_t level2_table_file_offset       = 0;
+	uint64_t level2_table_slice_file_offset = 0;
+	uint64_t translation_index              = 0;
+	int result                              = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+	/* The metadata index is kept in memory and never requires a read
+	 */
+	if( ( internal_file->metadata_index != NULL )
+	 && ( (size64_t) offset < internal_file->metadata_index->media_size ) )
+	{
+		return( libqcow_internal_file_get_cluster_block_reference(
+		         internal_file,
+		         NULL,
+		         offset,
+		         cluster_block_reference,
+		         error ) );
+	}
+	if( internal_file->translation_cache != NULL )
+	{
+		if( internal_file->io_handle->number_of_level2_table_entry_bits > 3 )
+		{
+			translation_index = (uint64_t) offset >> internal_file->io_handle->number_of_subcluster_bits;
+		}
+		else
+		{
+			translation_index = (uint64_t) offset >> internal_file->io_handle->number_of_cluster_block_bits;
+		}
+		result = libqcow_translation_cache_get_reference(
+		          internal_file->translation_cache,
+		          translation_index,
+		          cluster_block_reference,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference from translation cache.",
+			 function );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			return( 1 );
+		}
+	}
+	if( libqcow_address_split_offset(
+	     internal_file->io_handle,
+	     (uint64_t) offset,
+	     &address_split,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to split offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( address_split.level1_table_index > (uint64_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_cluster_table_get_cached_reference_by_index(
+	          internal_file->level1_table,
+	          (int) address_split.level1_table_index,
+	          &level2_table_file_offset,
+	          error );
+
+	if( result != 1 )
+	{
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %" PRIu64 " from level 1 table.",
+			 function,
+			 address_split.level1_table_index );
+		}
+		return( result );
+	}
+	level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+	/* Handle sparse level 2 table
+	 */
+	if( level2_table_file_offset == 0 )
+	{
+		*cluster_block_reference = 0;
+
+		return( 1 );
+	}
+	level2_table_slice_file_offset = level2_table_file_offset + address_split.level2_table_slice_offset;
+
+	result = libqcow_internal_file_get_cached_value(
+	          internal_file,
+	          internal_file->level2_table_cache,
+	          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+	          (off64_t) level2_table_slice_file_offset,
+	          (intptr_t **) &level2_table,
+	          &cache_value,
+	          error );
+
+	if( result != 1 )
+	{
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level2 table: 0x%08" PRIx64 " from cache.",
+			 function,
+			 level2_table_slice_file_offset );
+		}
+		return( result );
+	}
+	/* The subcluster bitmap of an extended level 2 table entry is not needed
+	 * since the cluster descriptor contains the offset of the cluster block
+	 */
+	if( libqcow_cluster_table_get_reference_by_index(
+	     level2_table,
+	     (int) address_split.level2_table_slice_reference_index,
+	     &cluster_block_file_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block offset from level 2 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_release_cached_value(
+	     internal_file,
+	     &cache_value,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release level2 table: 0x%08" PRIx64 " in cache.",
+		 function,
+		 level2_table_slice_file_offset );
+
+		return( -1 );
+	}
+	*cluster_block_reference = cluster_block_file_offset;
+
+	return( 1 );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads the level 2 table slices of adjacent level 2 tables at once into the level 2 table cache
+ * The level 2 table file offset is the offset of the level 2 table referenced by the level 1 table index
+ * and the level 2 table slice file offset the offset of the first slice to read
+ * The subsequent level 2 tables are read as long as they are stored directly after
+ * each other in the file, up to LIBQCOW_MAXIMUM_LEVEL2_TABLE_BATCH_SIZE bytes
+ * The number of level 2 tables is set to the number of level 2 tables that were read completely
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_level2_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table,
+     int level1_table_index,
+     uint64_t level2_table_file_offset,
+     uint64_t level2_table_slice_file_offset,
+     int *number_of_level2_tables,
+     libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value    = NULL;
+	libqcow_cluster_table_t *level2_table = NULL;
+	uint8_t *level2_tables_data           = NULL;
+	static char *function                 = "libqcow_internal_file_read_level2_tables";
+	size_t data_offset                    = 0;
+	size_t level2_tables_data_size        = 0;
+	size_t maximum_data_size              = 0;
+	uint64_t end_offset                   = 0;
+	uint64_t level2_table_reference       = 0;
+	int number_of_level1_table_references = 0;
+	int number_of_level2_table_slices     = 0;
+	int safe_number_of_level2_tables      = 1;
+	int result                            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_handle->level2_table_slice_size == 0 )
+	 || ( internal_file->io_handle->level2_table_size < internal_file->io_handle->level2_table_slice_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - invalid IO handle - level 2 table slice size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( level2_table_slice_file_offset < level2_table_file_offset )
+	 || ( level2_table_slice_file_offset >= ( level2_table_file_offset + internal_file->io_handle->level2_table_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 2 table slice file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_level2_tables == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		return( -1 );
+	}
+	/* Do not read more level 2 table slices at once than half of the level 2 table cache
+	 * can hold, otherwise the slices read first would be evicted by the slices read last
+	 */
+	number_of_level2_table_slices = (int) internal_file->io_handle->number_of_level2_table_slices;
+
+	if( number_of_level2_table_slices > LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY )
+	{
+		number_of_level2_table_slices = LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY;
+	}
+	maximum_data_size = (size_t) number_of_level2_table_slices
+	                  * (size_t) ( internal_file->maximum_number_of_level2_table_cache_entries / 2 )
+	                  * internal_file->io_handle->level2_table_slice_size;
+
+	if( maximum_data_size > LIBQCOW_MAXIMUM_LEVEL2_TABLE_BATCH_SIZE )
+	{
+		maximum_data_size = LIBQCOW_MAXIMUM_LEVEL2_TABLE_BATCH_SIZE;
+	}
+	if( maximum_data_size < internal_file->io_handle->level2_table_slice_size )
+	{
+		maximum_data_size = internal_file->io_handle->level2_table_slice_size;
+	}
+	end_offset = level2_table_file_offset + internal_file->io_handle->level2_table_size;
+
+	while( ( level1_table_index + safe_number_of_level2_tables ) < number_of_level1_table_references )
+	{
+		if( ( end_offset - level2_table_slice_file_offset + internal_file->io_handle->level2_table_size ) > maximum_data_size )
+		{
+			break;
+		}
+		if( libqcow_cluster_table_read_reference_by_index(
+		     level1_table,
+		     file_io_handle,
+		     level1_table_index + safe_number_of_level2_tables,
+		     &level2_table_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %d from level 1 table.",
+			 function,
+			 level1_table_index + safe_number_of_level2_tables );
+
+			goto on_error;
+		}
+		if( ( level2_table_reference & internal_file->io_handle->offset_bit_mask ) != end_offset )
+		{
+			break;
+		}
+		end_offset += internal_file->io_handle->level2_table_size;
+
+		safe_number_of_level2_tables++;
+	}
+	if( ( end_offset - level2_table_slice_file_offset ) > maximum_data_size )
+	{
+		end_offset = level2_table_slice_file_offset + maximum_data_size
+		           - ( maximum_data_size % internal_file->io_handle->level2_table_slice_size );
+	}
+	/* The level 2 table slices beyond the end of the file are read
+	 * when their cluster block references are looked up
+	 */
+	if( end_offset > internal_file->size )
+	{
+		if( internal_file->size > ( level2_table_slice_file_offset + internal_file->io_handle->level2_table_slice_size ) )
+		{
+			end_offset = internal_file->size
+			           - ( ( internal_file->size - level2_table_slice_file_offset ) % internal_file->io_handle->level2_table_slice_size );
+		}
+		else
+		{
+			end_offset = level2_table_slice_file_offset + internal_file->io_handle->level2_table_slice_size;
+		}
+	}
+	level2_tables_data_size = (size_t) ( end_offset - level2_table_slice_file_offset );
+
+	level2_tables_data = (uint8_t *) memory_allocate(
+	                                  sizeof( uint8_t ) * level2_tables_data_size );
+
+	if( level2_tables_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 tables data.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_io_handle_read_level2_tables_data(
+	     internal_file->io_handle,
+	     file_io_handle,
+	     (off64_t) level2_table_slice_file_offset,
+	     level2_tables_data,
+	     level2_tables_data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 2 tables data at offset: 0x%08" PRIx64 ".",
+		 function,
+		 level2_table_slice_file_offset );
+
+		goto on_error;
+	}
+	for( data_offset = 0;
+	     data_offset < level2_tables_data_size;
+	     data_offset += internal_file->io_handle->level2_table_slice_size )
+	{
+		/* Level 2 table slices that are already cached are kept
+		 */
+		result = libqcow_internal_file_get_cached_value(
+		          internal_file,
+		          internal_file->level2_table_cache,
+		          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+		          (off64_t) ( level2_table_slice_file_offset + data_offset ),
+		          (intptr_t **) &level2_table,
+		          &cache_value,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level2 table: 0x%08" PRIx64 " from cache.",
+			 function,
+			 level2_table_slice_file_offset + data_offset );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			level2_table = NULL;
+
+			if( libqcow_io_handle_read_level2_table_data(
+			     internal_file->io_handle,
+			     &( level2_tables_data[ data_offset ] ),
+			     internal_file->io_handle->level2_table_slice_size,
+			     &level2_table,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read level2 table: 0x%08" PRIx64 ".",
+				 function,
+				 level2_table_slice_file_offset + data_offset );
+
+				goto on_error;
+			}
+			if( libqcow_internal_file_set_cached_value(
+			     internal_file,
+			     internal_file->level2_table_cache,
+			     LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+			     (off64_t) ( level2_table_slice_file_offset + data_offset ),
+			     (intptr_t *) level2_table,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set level2 table: 0x%08" PRIx64 " in cache.",
+				 function,
+				 level2_table_slice_file_offset + data_offset );
+
+				goto on_error;
+			}
+		}
+		if( libqcow_internal_file_release_cached_value(
+		     internal_file,
+		     &cache_value,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release level2 table: 0x%08" PRIx64 " in cache.",
+			 function,
+			 level2_table_slice_file_offset + data_offset );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 level2_tables_data );
+
+	internal_file->level2_table_read_end_offset = (off64_t) end_offset;
+
+	/* The last level 2 table can be read in part
+	 */
+	*number_of_level2_tables = (int) ( ( end_offset - level2_table_file_offset ) / internal_file->io_handle->level2_table_size );
+
+	return( 1 );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	if( level2_tables_data != NULL )
+	{
+		memory_free(
+		 level2_tables_data );
+	}
+	return( -1 );
+}
+
+/* Reads the level 2 tables referenced by the level 1 table into the level 2 table cache
+ * Adjacent level 2 tables are read at once, the level 2 tables are read until
+ * the level 2 table cache is full
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_preload_level2_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function                   = "libqcow_internal_file_preload_level2_tables";
+	uint64_t level2_table_file_offset       = 0;
+	uint64_t level2_table_slice_file_offset = 0;
+	size_t maximum_data_size                = 0;
+	size_t preloaded_data_size              = 0;
+	int level1_table_index                  = 0;
+	int number_of_level1_table_references   = 0;
+	int number_of_level2_table_slices       = 0;
+	int number_of_level2_tables             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     internal_file->level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_level2_table_slices = (int) internal_file->io_handle->number_of_level2_table_slices;
+
+	if( number_of_level2_table_slices > LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY )
+	{
+		number_of_level2_table_slices = LIBQCOW_MAXIMUM_LEVEL2_TABLE_SLICES_PER_CACHE_ENTRY;
+	}
+	maximum_data_size = (size_t) number_of_level2_table_slices
+	                  * (size_t) internal_file->maximum_number_of_level2_table_cache_entries
+	                  * internal_file->io_handle->level2_table_slice_size;
+
+	while( ( level1_table_index < number_of_level1_table_references )
+	    && ( preloaded_data_size < maximum_data_size ) )
+	{
+		if( libqcow_cluster_table_read_reference_by_index(
+		     internal_file->level1_table,
+		     file_io_handle,
+		     level1_table_index,
+		     &level2_table_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %d from level 1 table.",
+			 function,
+			 level1_table_index );
+
+			return( -1 );
+		}
+		level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+		if( level2_table_file_offset == 0 )
+		{
+			level1_table_index++;
+
+			continue;
+		}
+		/* Continue with the remainder of a level 2 table that was read in part
+		 */
+		if( level2_table_slice_file_offset == 0 )
+		{
+			level2_table_slice_file_offset = level2_table_file_offset;
+		}
+		if( libqcow_internal_file_read_level2_tables(
+		     internal_file,
+		     file_io_handle,
+		     internal_file->level1_table,
+		     level1_table_index,
+		     level2_table_file_offset,
+		     level2_table_slice_file_offset,
+		     &number_of_level2_tables,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 tables at offset: 0x%08" PRIx64 ".",
+			 function,
+			 level2_table_slice_file_offset );
+
+			return( -1 );
+		}
+		/* The level 2 tables beyond the end of the file are not preloaded
+		 */
+		if( (size64_t) internal_file->level2_table_read_end_offset >= internal_file->size )
+		{
+			break;
+		}
+		preloaded_data_size += (size_t) ( (uint64_t) internal_file->level2_table_read_end_offset - level2_table_slice_file_offset );
+		level1_table_index  += number_of_level2_tables;
+
+		if( ( ( (uint64_t) internal_file->level2_table_read_end_offset - level2_table_file_offset ) % internal_file->io_handle->level2_table_size ) != 0 )
+		{
+			level2_table_slice_file_offset = (uint64_t) internal_file->level2_table_read_end_offset;
+		}
+		else
+		{
+			level2_table_slice_file_offset = 0;
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves the extent values of a cluster block reference
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cluster_block_extent_values(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_reference,
+     uint64_t *cluster_block_file_offset,
+     uint32_t *cluster_block_flags,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_get_cluster_block_extent_values";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_file_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block file offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block flags.",
+		 function );
+
+		return( -1 );
+	}
+	*cluster_block_flags = 0;
+
+	if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+	{
+		*cluster_block_file_offset = cluster_block_reference
+		                           & internal_file->io_handle->offset_bit_mask
+		                           & internal_file->io_handle->compression_bit_mask;
+		*cluster_block_flags      |= LIBQCOW_EXTENT_FLAG_IS_COMPRESSED;
+	}
+	else
+	{
+		if( ( cluster_block_reference & internal_file->io_handle->zero_flag_bit_mask ) != 0 )
+		{
+			*cluster_block_flags |= LIBQCOW_EXTENT_FLAG_IS_ZERO;
+		}
+		*cluster_block_file_offset = cluster_block_reference
+		                           & internal_file->io_handle->offset_bit_mask
+		                           & ~( internal_file->io_handle->subcluster_bit_mask );
+	}
+	if( *cluster_block_file_offset == 0 )
+	{
+		*cluster_block_flags |= LIBQCOW_EXTENT_FLAG_IS_SPARSE;
+	}
+	/* An allocated cluster block that was detected to contain only zero bytes
+	 * when it was cached is treated as a zero cluster block
+	 */
+	else if( ( *cluster_block_flags == 0 )
+	      && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_DETECT_ZERO_CLUSTER_BLOCKS ) != 0 ) )
+	{
+		result = libqcow_internal_file_cluster_block_is_detected_zero(
+		          internal_file,
+		          *cluster_block_file_offset,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to determine if cluster block: 0x%08" PRIx64 " is zero.",
+			 function,
+			 *cluster_block_file_offset );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			*cluster_block_flags |= LIBQCOW_EXTENT_FLAG_IS_ZERO;
+		}
+	}
+	return( 1 );
+}
+
+/* Determines if an allocated cluster block was detected to contain only zero bytes
+ * when it was stored in the cluster block cache
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if the cluster block is cached and zero, 0 if not or -1 on error
+ */
+int libqcow_internal_file_cluster_block_is_detected_zero(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_file_offset,
+     libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value     = NULL;
+	libqcow_cluster_block_t *cluster_block = NULL;
+	static char *function                  = "libqcow_internal_file_cluster_block_is_detected_zero";
+	int is_zero                            = 0;
+	int result                             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_internal_file_get_cached_value(
+	          internal_file,
+	          internal_file->cluster_block_cache,
+	          LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+	          (off64_t) cluster_block_file_offset,
+	          (intptr_t **) &cluster_block,
+	          &cache_value,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block: 0x%08" PRIx64 " from cache.",
+		 function,
+		 cluster_block_file_offset );
+
+		return( -1 );
+	}
+	else if( ( result != 0 )
+	      && ( cluster_block != NULL ) )
+	{
+		if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_ZERO ) != 0 )
+		{
+			is_zero = 1;
+		}
+	}
+	if( libqcow_internal_file_release_cached_value(
+	     internal_file,
+	     &cache_value,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cluster block in cache.",
+		 function );
+
+		return( -1 );
+	}
+	return( is_zero );
+}
+
+/* Retrieves the extent at a specific offset
+ * The extent starts at the cluster block that contains the offset and
+ * covers the consecutive cluster blocks of the same type. For allocated
+ * cluster blocks the extent ends where the data is no longer stored
+ * consecutively in the file. Compressed extents cover a single cluster block
+ * The extent file offset is 0 if the extent is sparse
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the offset is beyond the media size or -1 on error
+ */
+int libqcow_internal_file_get_extent_at_offset(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     off64_t *extent_file_offset,
+     uint32_t *extent_flags,
+     libcerror_error_t **error )
+{
+	static char *function                    = "libqcow_internal_file_get_extent_at_offset";
+	uint64_t cluster_block_file_offset       = 0;
+	uint64_t cluster_block_reference         = 0;
+	uint64_t first_cluster_block_file_offset = 0;
+	uint64_t level1_table_index              = 0;
+	uint64_t level2_table_file_offset        = 0;
+	uint32_t cluster_block_flags             = 0;
+	uint32_t first_cluster_block_flags       = 0;
+	off64_t first_cluster_block_offset       = 0;
+	off64_t next_offset                      = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( extent_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid extent offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( extent_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid extent size.",
+		 function );
+
+		return( -1 );
+	}
+	if( extent_file_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid extent file offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( extent_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid extent flags.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= internal_file->io_handle->media_size )
+	{
+		return( 0 );
+	}
+	/* With extended level 2 table entries the extent is tracked per subcluster
+	 */
+	first_cluster_block_offset = offset & ~( (off64_t) internal_file->io_handle->subcluster_bit_mask );
+	next_offset                = first_cluster_block_offset;
+
+	while( (size64_t) next_offset < internal_file->io_handle->media_size )
+	{
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     file_io_handle,
+		     next_offset,
+		     &cluster_block_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 next_offset,
+			 next_offset );
+
+			return( -1 );
+		}
+		if( libqcow_internal_file_get_cluster_block_extent_values(
+		     internal_file,
+		     cluster_block_reference,
+		     &cluster_block_file_offset,
+		     &cluster_block_flags,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve extent values for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 next_offset,
+			 next_offset );
+
+			return( -1 );
+		}
+		if( next_offset == first_cluster_block_offset )
+		{
+			/* A compressed cluster block has no subclusters
+			 */
+			if( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+			{
+				first_cluster_block_offset = offset & ~( (off64_t) internal_file->io_handle->cluster_block_bit_mask );
+				next_offset                = first_cluster_block_offset;
+			}
+			first_cluster_block_file_offset = cluster_block_file_offset;
+			first_cluster_block_flags       = cluster_block_flags;
+		}
+		else if( cluster_block_flags != first_cluster_block_flags )
+		{
+			break;
+		}
+		else if( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) == 0 )
+		{
+			if( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+			{
+				break;
+			}
+			if( cluster_block_file_offset != ( first_cluster_block_file_offset + (uint64_t) ( next_offset - first_cluster_block_offset ) ) )
+			{
+				break;
+			}
+		}
+		if( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+		{
+			next_offset += internal_file->io_handle->cluster_block_size;
+
+			break;
+		}
+		next_offset += internal_file->io_handle->subcluster_size;
+
+		/* Skip the remainder of a sparse level 2 table
+		 */
+		if( ( cluster_block_flags == LIBQCOW_EXTENT_FLAG_IS_SPARSE )
+		 && ( (size64_t) next_offset < internal_file->io_handle->media_size )
+		 && ( ( (uint64_t) next_offset & ~( (uint64_t) -1 << internal_file->io_handle->level1_index_bit_shift ) ) != 0 ) )
+		{
+			level1_table_index = (uint64_t) next_offset >> internal_file->io_handle->level1_index_bit_shift;
+
+			if( level1_table_index > (uint64_t) INT_MAX )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid level 1 table index value out of bounds.",
+				 function );
+
+				return( -1 );
+			}
+			if( libqcow_cluster_table_read_reference_by_index(
+			     internal_file->level1_table,
+			     file_io_handle,
+			     (int) level1_table_index,
+			     &level2_table_file_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve level 2 table offset: %" PRIi64 " from level 1 table.",
+				 function,
+				 level1_table_index );
+
+				return( -1 );
+			}
+			level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+			if( level2_table_file_offset == 0 )
+			{
+				next_offset = (off64_t) ( ( level1_table_index + 1 ) << internal_file->io_handle->level1_index_bit_shift );
+			}
+		}
+	}
+	if( (size64_t) next_offset > internal_file->io_handle->media_size )
+	{
+		next_offset = (off64_t) internal_file->io_handle->media_size;
+	}
+	*extent_offset      = first_cluster_block_offset;
+	*extent_size        = (size64_t) ( next_offset - first_cluster_block_offset );
+	*extent_file_offset = (off64_t) first_cluster_block_file_offset;
+	*extent_flags       = first_cluster_block_flags;
+
+	return( 1 );
+}
+
+/* Passes advice about a range of the data in the (host) file to the operating system
+ * The range is advised in the memory map if the image file is memory mapped
+ * and otherwise in the page cache of the file that contains the data
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_advise_host_range(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_internal_file_advise_host_range";
+	int memory_map_advice            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( advice != LIBQCOW_ADVICE_WILLNEED )
+	 && ( advice != LIBQCOW_ADVICE_DONTNEED ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported advice: %d.",
+		 function,
+		 advice );
+
+		return( -1 );
+	}
+	if( size == 0 )
+	{
+		return( 1 );
+	}
+	if( ( internal_file->memory_map != NULL )
+	 && ( internal_file->data_file_io_handle == NULL ) )
+	{
+		if( advice == LIBQCOW_ADVICE_WILLNEED )
+		{
+			memory_map_advice = LIBQCOW_MEMORY_MAP_ADVICE_WILLNEED;
+		}
+		else
+		{
+			memory_map_advice = LIBQCOW_MEMORY_MAP_ADVICE_DONTNEED;
+		}
+		if( libqcow_memory_map_advise_range(
+		     internal_file->memory_map,
+		     offset,
+		     size,
+		     memory_map_advice,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to advise memory map range.",
+			 function );
+
+			return( -1 );
+		}
+		return( 1 );
+	}
+	/* Unbuffered reads do not use the page cache
+	 */
+	if( internal_file->named_file_io_handle != NULL )
+	{
+		return( 1 );
+	}
+	if( internal_file->page_cache == NULL )
+	{
+		/* The page cache requires the name of the file, which is only known
+		 * for file IO handles created inside the library
+		 */
+		if( internal_file->data_file_io_handle != NULL )
+		{
+			if( internal_file->data_file_io_handle_created_in_library == 0 )
+			{
+				return( 1 );
+			}
+			file_io_handle = internal_file->data_file_io_handle;
+		}
+		else
+		{
+			if( internal_file->file_io_handle_created_in_library == 0 )
+			{
+				return( 1 );
+			}
+			if( internal_file->host_file_io_handle != NULL )
+			{
+				file_io_handle = internal_file->host_file_io_handle;
+			}
+			else
+			{
+				file_io_handle = internal_file->file_io_handle;
+			}
+		}
+		if( libqcow_page_cache_initialize(
+		     &( internal_file->page_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create page cache.",
+			 function );
+
+			return( -1 );
+		}
+		/* If the page cache cannot be opened it remains closed and the advice is ignored
+		 */
+		if( libqcow_page_cache_open(
+		     internal_file->page_cache,
+		     file_io_handle,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open page cache.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( libqcow_page_cache_advise(
+	     internal_file->page_cache,
+	     offset,
+	     size,
+	     advice,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to advise page cache range.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Passes advice about the access pattern of the (media) data
+ * The sequential, random and normal advice apply to the entire file and control
+ * the read-ahead of the library and the memory map
+ * The will need and do not need advice apply to a range of the (media) data,
+ * which is translated into the ranges of the (host) file that contain the data
+ * using the level 1 and level 2 tables. Sparse ranges are advised in the backing file
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_advise(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error )
+{
+	static char *function       = "libqcow_internal_file_advise";
+	size64_t extent_size        = 0;
+	size64_t host_range_size    = 0;
+	size64_t range_size         = 0;
+	off64_t end_offset          = 0;
+	off64_t extent_end_offset   = 0;
+	off64_t extent_file_offset  = 0;
+	off64_t extent_offset       = 0;
+	off64_t host_range_offset   = 0;
+	off64_t range_offset        = 0;
+	uint32_t extent_flags       = 0;
+	int memory_map_advice       = 0;
+	int result                  = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	off64_t read_ahead_end_offset = 0;
+	int maximum_window            = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	switch( advice )
+	{
+		case LIBQCOW_ADVICE_NORMAL:
+		case LIBQCOW_ADVICE_SEQUENTIAL:
+		case LIBQCOW_ADVICE_RANDOM:
+			internal_file->access_advice = advice;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( advice == LIBQCOW_ADVICE_RANDOM )
+			{
+				internal_file->read_ahead_window             = 0;
+				internal_file->read_ahead_end_offset         = internal_file->read_ahead_offset;
+				internal_file->read_ahead_advised_end_offset = 0;
+			}
+#endif
+			if( internal_file->memory_map != NULL )
+			{
+				if( advice == LIBQCOW_ADVICE_SEQUENTIAL )
+				{
+					memory_map_advice = LIBQCOW_MEMORY_MAP_ADVICE_SEQUENTIAL;
+				}
+				else if( advice == LIBQCOW_ADVICE_RANDOM )
+				{
+					memory_map_advice = LIBQCOW_MEMORY_MAP_ADVICE_RANDOM;
+				}
+				else
+				{
+					memory_map_advice = LIBQCOW_MEMORY_MAP_ADVICE_NORMAL;
+				}
+				if( libqcow_memory_map_set_advice(
+				     internal_file->memory_map,
+				     memory_map_advice,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set memory map advice.",
+					 function );
+
+					return( -1 );
+				}
+				/* Advice other than normal overrides the access pattern detection of the memory map
+				 */
+				internal_file->memory_map->advice_is_fixed = (uint8_t) ( advice != LIBQCOW_ADVICE_NORMAL );
+			}
+			return( 1 );
+
+		case LIBQCOW_ADVICE_WILLNEED:
+		case LIBQCOW_ADVICE_DONTNEED:
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported advice: %d.",
+			 function,
+			 advice );
+
+			return( -1 );
+	}
+	if( ( size == 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		return( 1 );
+	}
+	if( size > ( internal_file->io_handle->media_size - (size64_t) offset ) )
+	{
+		size = internal_file->io_handle->media_size - (size64_t) offset;
+	}
+	end_offset   = offset + (off64_t) size;
+	range_offset = offset;
+
+	while( range_offset < end_offset )
+	{
+		result = libqcow_internal_file_get_extent_at_offset(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          range_offset,
+		          &extent_offset,
+		          &extent_size,
+		          &extent_file_offset,
+		          &extent_flags,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		extent_end_offset = extent_offset + (off64_t) extent_size;
+
+		if( extent_end_offset > end_offset )
+		{
+			extent_end_offset = end_offset;
+		}
+		range_size = (size64_t) ( extent_end_offset - range_offset );
+
+		if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 )
+		{
+			/* The data of a sparse range is read from the backing file, if any
+			 */
+			if( internal_file->parent_file != NULL )
+			{
+				if( libqcow_file_advise(
+				     internal_file->parent_file,
+				     range_offset,
+				     range_size,
+				     advice,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to advise parent file.",
+					 function );
+
+					return( -1 );
+				}
+			}
+		}
+		else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) == 0 )
+		{
+			/* A compressed cluster block is advised in full since the size
+			 * of the compressed data is not exactly known
+			 */
+			if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+			{
+				range_offset = extent_file_offset;
+				range_size   = internal_file->io_handle->cluster_block_size;
+			}
+			else
+			{
+				range_offset = extent_file_offset + ( range_offset - extent_offset );
+			}
+			/* Adjacent host ranges are advised at once
+			 */
+			if( ( host_range_size != 0 )
+			 && ( range_offset == ( host_range_offset + (off64_t) host_range_size ) ) )
+			{
+				host_range_size += range_size;
+			}
+			else
+			{
+				if( libqcow_internal_file_advise_host_range(
+				     internal_file,
+				     host_range_offset,
+				     host_range_size,
+				     advice,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to advise host range.",
+					 function );
+
+					return( -1 );
+				}
+				host_range_offset = range_offset;
+				host_range_size   = range_size;
+			}
+		}
+		range_offset = extent_end_offset;
+	}
+	if( libqcow_internal_file_advise_host_range(
+	     internal_file,
+	     host_range_offset,
+	     host_range_size,
+	     advice,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to advise host range.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( advice == LIBQCOW_ADVICE_DONTNEED )
+	{
+		/* Stop a read-ahead of data that is no longer needed
+		 */
+		if( ( internal_file->read_ahead_offset < end_offset )
+		 && ( internal_file->read_ahead_end_offset > offset ) )
+		{
+			internal_file->read_ahead_end_offset         = internal_file->read_ahead_offset;
+			internal_file->read_ahead_advised_end_offset = 0;
+		}
+		return( 1 );
+	}
+	/* The cluster block caches are filled by the read-ahead thread
+	 */
+	if( ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_CACHE ) != 0 )
+	 || ( internal_file->memory_map != NULL ) )
+	{
+		return( 1 );
+	}
+	/* Do not read ahead more cluster blocks than half of the cache can hold
+	 * so that the read-ahead does not evict the data it has read ahead
+	 */
+	maximum_window = internal_file->maximum_number_of_cluster_block_cache_entries / 2;
+
+	if( maximum_window > LIBQCOW_MAXIMUM_READ_AHEAD_CLUSTER_BLOCKS )
+	{
+		maximum_window = LIBQCOW_MAXIMUM_READ_AHEAD_CLUSTER_BLOCKS;
+	}
+	if( maximum_window < 1 )
+	{
+		return( 1 );
+	}
+	internal_file->read_ahead_expected_offset = offset;
+
+	offset &= ~( (off64_t) internal_file->io_handle->cluster_block_bit_mask );
+
+	read_ahead_end_offset = offset
+	                      + ( (off64_t) maximum_window * internal_file->io_handle->cluster_block_size );
+
+	if( read_ahead_end_offset > end_offset )
+	{
+		read_ahead_end_offset = end_offset;
+	}
+	internal_file->read_ahead_offset             = offset;
+	internal_file->read_ahead_end_offset         = read_ahead_end_offset;
+	internal_file->read_ahead_advised_end_offset = read_ahead_end_offset;
+
+	if( libqcow_internal_file_start_read_ahead(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to start read-ahead.",
+		 function );
+
+		return( -1 );
+	}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	return( 1 );
+}
+
+/* Compares the mappings of two level 1 tables at a specific offset
+ * The level 1 tables must refer to the level 2 tables of the same file
+ * If level 1 table B is NULL the mapping of level 1 table A is compared with
+ * the backing file, where only the ranges that are mapped by A differ
+ * The size is the size of the range from the offset for which the result applies,
+ * which covers the rest of the level 2 table if both level 1 table entries are the same
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_compare_level1_tables_at_offset(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table_a,
+     libqcow_cluster_table_t *level1_table_b,
+     off64_t offset,
+     uint8_t *differs,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_tables[ 2 ];
+	uint64_t cluster_block_references[ 2 ];
+	uint64_t level2_table_file_offsets[ 2 ];
+
+	static char *function       = "libqcow_internal_file_compare_level1_tables_at_offset";
+	uint64_t level1_table_index = 0;
+	uint64_t level1_table_span  = 0;
+	int table_index             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( level1_table_a == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 1 table A.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( differs == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid differs.",
+		 function );
+
+		return( -1 );
+	}
+	if( size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid size.",
+		 function );
+
+		return( -1 );
+	}
+	level1_tables[ 0 ] = level1_table_a;
+	level1_tables[ 1 ] = level1_table_b;
+
+	level1_table_index = (uint64_t) offset >> internal_file->io_handle->level1_index_bit_shift;
+	level1_table_span  = (uint64_t) 1 << internal_file->io_handle->level1_index_bit_shift;
+
+	/* A level 1 table entry beyond the end of the level 1 table is not mapped
+	 */
+	for( table_index = 0;
+	     table_index < 2;
+	     table_index++ )
+	{
+		level2_table_file_offsets[ table_index ] = 0;
+		cluster_block_references[ table_index ]  = 0;
+
+		if( ( level1_tables[ table_index ] == NULL )
+		 || ( level1_table_index >= (uint64_t) level1_tables[ table_index ]->number_of_references ) )
+		{
+			continue;
+		}
+		if( libqcow_cluster_table_read_reference_by_index(
+		     level1_tables[ table_index ],
+		     file_io_handle,
+		     (int) level1_table_index,
+		     &( level2_table_file_offsets[ table_index ] ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %" PRIu64 " from level 1 table: %d.",
+			 function,
+			 level1_table_index,
+			 table_index );
+
+			return( -1 );
+		}
+		level2_table_file_offsets[ table_index ] &= internal_file->io_handle->offset_bit_mask;
+	}
+	/* Level 1 table entries that refer to the same level 2 table map the same data,
+	 * which is the case for the level 2 tables a snapshot shares with the file
+	 */
+	if( level2_table_file_offsets[ 0 ] == level2_table_file_offsets[ 1 ] )
+	{
+		*differs = 0;
+		*size    = (size64_t) ( level1_table_span - ( (uint64_t) offset & ( level1_table_span - 1 ) ) );
+
+		return( 1 );
+	}
+	for( table_index = 0;
+	     table_index < 2;
+	     table_index++ )
+	{
+		if( level2_table_file_offsets[ table_index ] == 0 )
+		{
+			continue;
+		}
+		if( libqcow_internal_file_get_cluster_block_reference_from_level1_table(
+		     internal_file,
+		     file_io_handle,
+		     level1_tables[ table_index ],
+		     offset,
+		     &( cluster_block_references[ table_index ] ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ") from level 1 table: %d.",
+			 function,
+			 offset,
+			 offset,
+			 table_index );
+
+			return( -1 );
+		}
+		/* Zero cluster blocks read the same regardless of a preallocated cluster block
+		 */
+		if( ( cluster_block_references[ table_index ] & internal_file->io_handle->zero_flag_bit_mask ) != 0 )
+		{
+			cluster_block_references[ table_index ] = internal_file->io_handle->zero_flag_bit_mask;
+		}
+	}
+	if( cluster_block_references[ 0 ] != cluster_block_references[ 1 ] )
+	{
+		*differs = 1;
+	}
+	else
+	{
+		*differs = 0;
+	}
+	*size = (size64_t) ( internal_file->io_handle->subcluster_size - ( (uint64_t) offset & internal_file->io_handle->subcluster_bit_mask ) );
+
+	return( 1 );
+}
+
+/* Walks the mappings of two level 1 tables and calls the callback function
+ * for every range of the media data where the mappings differ
+ * The level 1 tables must refer to the level 2 tables of the same file
+ * If level 1 table B is NULL the ranges that are mapped by level 1 table A are reported
+ * The level 1 table entries that refer to the same level 2 table are skipped without
+ * reading the level 2 table, so the walk is proportional to the size of the changes
+ * The callback function returns 1 to continue, 0 to stop or -1 on error
+ * The cache mutex is grabbed for the lookups and released while the callback function is called
+ * This function is not multi-thread safe acquire the read lock before call
+ * Returns 1 if successful, 0 if stopped by the callback function or -1 on error
+ */
+int libqcow_internal_file_diff_level1_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table_a,
+     libqcow_cluster_table_t *level1_table_b,
+     size64_t media_size,
+     int (*callback)(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_diff_level1_tables";
+	size64_t range_size   = 0;
+	size64_t size         = 0;
+	off64_t offset        = 0;
+	off64_t range_offset  = 0;
+	uint8_t differs       = 0;
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( callback == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid callback.",
+		 function );
+
+		return( -1 );
+	}
+	while( (size64_t) offset <= media_size )
+	{
+		differs = 0;
+		size    = 0;
+
+		if( (size64_t) offset < media_size )
+		{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( libcthreads_mutex_grab(
+			     internal_file->cache_mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to grab cache mutex.",
+				 function );
+
+				return( -1 );
+			}
+#endif
+			result = libqcow_internal_file_compare_level1_tables_at_offset(
+			          internal_file,
+			          file_io_handle,
+			          level1_table_a,
+			          level1_table_b,
+			          offset,
+			          &differs,
+			          &size,
+			          error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( libcthreads_mutex_release(
+			     internal_file->cache_mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release cache mutex.",
+				 function );
+
+				return( -1 );
+			}
+#endif
+			if( result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to compare level 1 tables at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			if( size > ( media_size - (size64_t) offset ) )
+			{
+				size = media_size - (size64_t) offset;
+			}
+		}
+		if( differs != 0 )
+		{
+			if( range_size == 0 )
+			{
+				range_offset = offset;
+			}
+			range_size += size;
+		}
+		else if( range_size > 0 )
+		{
+			result = callback(
+			          range_offset,
+			          range_size,
+			          user_data );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: callback failed for range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+			else if( result == 0 )
+			{
+				return( 0 );
+			}
+			range_size = 0;
+		}
+		/* The end of the media data is processed once to report the last range
+		 */
+		if( size == 0 )
+		{
+			break;
+		}
+		offset += (off64_t) size;
+	}
+	return( 1 );
+}
+
+/* Retrieves the offset and size of the compressed data of a cluster block
+ * The cluster block file offset is the level 2 table entry without the compression flag
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_compressed_cluster_block_range(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_file_offset,
+     uint64_t *compressed_cluster_block_offset,
+     size_t *compressed_cluster_block_size,
+     libcerror_error_t **error )
+{
+	static char *function                        = "libqcow_internal_file_get_compressed_cluster_block_range";
+	uint64_t compressed_cluster_block_end_offset = 0;
+	uint64_t compressed_offset                   = 0;
+	size_t compressed_size                       = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_cluster_block_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed cluster block offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_cluster_block_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed cluster block size.",
+		 function );
+
+		return( -1 );
+	}
+	compressed_size   = (size_t) ( cluster_block_file_offset >> internal_file->io_handle->compression_bit_shift );
+	compressed_offset = cluster_block_file_offset & internal_file->io_handle->compression_bit_mask;
+
+	if( ( internal_file->io_handle->format_version == 2 )
+	 || ( internal_file->io_handle->format_version == 3 ) )
+	{
+		compressed_size += 1;
+		compressed_size *= 512;
+
+		/* Make sure the compressed block size stays within the bounds
+		 * of the cluster block size and the size of the file
+		 */
+		compressed_cluster_block_end_offset = compressed_offset / internal_file->io_handle->cluster_block_size;
+
+		if( ( compressed_offset % internal_file->io_handle->cluster_block_size ) != 0 )
+		{
+			compressed_cluster_block_end_offset += 1;
+		}
+		compressed_cluster_block_end_offset += 1;
+		compressed_cluster_block_end_offset *= internal_file->io_handle->cluster_block_size;
+
+		if( compressed_cluster_block_end_offset > internal_file->size )
+		{
+			compressed_cluster_block_end_offset = internal_file->size;
+		}
+		if( ( compressed_offset + compressed_size ) > compressed_cluster_block_end_offset )
+		{
+			compressed_size = (size_t) ( compressed_cluster_block_end_offset - compressed_offset );
+		}
+	}
+	*compressed_cluster_block_offset = compressed_offset;
+	*compressed_cluster_block_size   = compressed_size;
+
+	return( 1 );
+}
+
+/* Bounds the size of the compressed data of a cluster block by the start of the data
+ * of the next cluster block in the same level 2 table
+ * The compressed size in the level 2 table entry is rounded up to 512-byte sectors,
+ * while the compressed data of the next cluster block commonly directly follows it
+ * hence the bound reduces how much of the next compressed data is read twice
+ * The reference of the next cluster block is only looked up in the caches, if it is
+ * not available without reading from the file the compressed size is left as is
+ * The offset is the (media) offset of the cluster block
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_bound_compressed_cluster_block_size(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t compressed_cluster_block_offset,
+     size_t *compressed_cluster_block_size,
+     libcerror_error_t **error )
+{
+	static char *function                 = "libqcow_internal_file_bound_compressed_cluster_block_size";
+	uint64_t next_cluster_block_offset    = 0;
+	uint64_t next_cluster_block_reference = 0;
+	off64_t next_offset                   = 0;
+	int result                            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_cluster_block_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed cluster block size.",
+		 function );
+
+		return( -1 );
+	}
+	/* The compressed size of version 1 is exact
+	 */
+	if( ( internal_file->io_handle->format_version != 2 )
+	 && ( internal_file->io_handle->format_version != 3 ) )
+	{
+		return( 1 );
+	}
+	offset     -= offset & internal_file->io_handle->cluster_block_bit_mask;
+	next_offset = offset + internal_file->io_handle->cluster_block_size;
+
+	/* Only the next cluster block in the same level 2 table is considered
+	 */
+	if( ( (size64_t) next_offset >= internal_file->io_handle->media_size )
+	 || ( ( (uint64_t) offset >> internal_file->io_handle->level1_index_bit_shift ) != ( (uint64_t) next_offset >> internal_file->io_handle->level1_index_bit_shift ) ) )
+	{
+		return( 1 );
+	}
+	/* The reference of the next cluster block is only used when it is available
+	 * without reading, the next cluster block can be in a level 2 table slice
+	 * that is not cached, in which case the compressed size is not bounded
+	 */
+	result = libqcow_internal_file_get_cached_cluster_block_reference(
+	          internal_file,
+	          next_offset,
+	          &next_cluster_block_reference,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cached cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 next_offset,
+		 next_offset );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		return( 1 );
+	}
+	next_cluster_block_offset = next_cluster_block_reference & internal_file->io_handle->offset_bit_mask;
+
+	if( ( next_cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+	{
+		next_cluster_block_offset &= internal_file->io_handle->compression_bit_mask;
+	}
+	else
+	{
+		next_cluster_block_offset &= ~( internal_file->io_handle->cluster_block_bit_mask );
+	}
+	/* The data of another cluster block cannot overlap the compressed data,
+	 * hence it ends the compressed data if it starts within its range
+	 */
+	if( ( next_cluster_block_offset > compressed_cluster_block_offset )
+	 && ( next_cluster_block_offset < ( compressed_cluster_block_offset + *compressed_cluster_block_size ) ) )
+	{
+		*compressed_cluster_block_size = (size_t) ( next_cluster_block_offset - compressed_cluster_block_offset );
+	}
+	return( 1 );
+}
+
+/* Reads the compressed data of a cluster block
+ * The compressed data of subsequent compressed cluster blocks is commonly stored
+ * adjacent in the file, hence if the compressed data follows that of the previous read
+ * a read window of up to LIBQCOW_COMPRESSED_READ_WINDOW_SIZE bytes is read, from which
+ * the compressed data of the following compressed cluster blocks is copied
+ * If the compressed data starts in the read window but extends beyond it, the part
+ * in the read window is kept and only the remainder is read
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_compressed_cluster_block(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_block_t *cluster_block,
+     uint64_t compressed_cluster_block_offset,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_internal_file_read_compressed_cluster_block";
+	size_t read_size           = 0;
+	size_t retained_size       = 0;
+	ssize_t read_count         = 0;
+	uint64_t read_offset       = 0;
+	uint64_t start_timestamp   = 0;
+	uint64_t window_end_offset = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid cluster block - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_cluster_block_offset > (uint64_t) INT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid compressed cluster block offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->compressed_read_window != NULL )
+	 && ( (off64_t) compressed_cluster_block_offset >= internal_file->compressed_read_window_offset )
+	 && ( ( compressed_cluster_block_offset + cluster_block->data_size ) <= ( (uint64_t) internal_file->compressed_read_window_offset + internal_file->compressed_read_window_data_size ) ) )
+	{
+		if( memory_copy(
+		     cluster_block->data,
+		     &( internal_file->compressed_read_window[ compressed_cluster_block_offset - (uint64_t) internal_file->compressed_read_window_offset ] ),
+		     cluster_block->data_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy compressed data from read window.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else if( ( internal_file->memory_map == NULL )
+	      && ( cluster_block->data_size <= LIBQCOW_COMPRESSED_READ_WINDOW_SIZE )
+	      && ( ( ( internal_file->compressed_read_window_data_size > 0 )
+	          && ( (off64_t) compressed_cluster_block_offset >= internal_file->compressed_read_window_offset )
+	          && ( compressed_cluster_block_offset < ( (uint64_t) internal_file->compressed_read_window_offset + internal_file->compressed_read_window_data_size ) ) )
+	       || ( ( (off64_t) compressed_cluster_block_offset > internal_file->compressed_read_offset )
+	         && ( (off64_t) compressed_cluster_block_offset <= internal_file->compressed_read_end_offset ) ) ) )
+	{
+		if( internal_file->compressed_read_window == NULL )
+		{
+			internal_file->compressed_read_window = (uint8_t *) memory_allocate(
+			                                                     sizeof( uint8_t ) * LIBQCOW_COMPRESSED_READ_WINDOW_SIZE );
+
+			if( internal_file->compressed_read_window == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create compressed read window.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		/* The data at the end of the read window that was already read is kept
+		 * and moved to the start of the read window, hence only the data
+		 * that follows it is read
+		 */
+		window_end_offset = (uint64_t) internal_file->compressed_read_window_offset + internal_file->compressed_read_window_data_size;
+
+		if( ( internal_file->compressed_read_window_data_size > 0 )
+		 && ( (off64_t) compressed_cluster_block_offset >= internal_file->compressed_read_window_offset )
+		 && ( compressed_cluster_block_offset < window_end_offset ) )
+		{
+			retained_size = (size_t) ( window_end_offset - compressed_cluster_block_offset );
+
+			memmove(
+			 internal_file->compressed_read_window,
+			 &( internal_file->compressed_read_window[ compressed_cluster_block_offset - (uint64_t) internal_file->compressed_read_window_offset ] ),
+			 retained_size );
+		}
+		internal_file->compressed_read_window_offset    = 0;
+		internal_file->compressed_read_window_data_size = 0;
+
+		read_offset = compressed_cluster_block_offset + retained_size;
+		read_size   = LIBQCOW_COMPRESSED_READ_WINDOW_SIZE - retained_size;
+
+		if( read_offset >= internal_file->size )
+		{
+			read_size = 0;
+		}
+		else if( ( read_offset + read_size ) > internal_file->size )
+		{
+			read_size = (size_t) ( internal_file->size - read_offset );
+		}
+		if( ( retained_size + read_size ) < cluster_block->data_size )
+		{
+			read_size = cluster_block->data_size - retained_size;
+		}
+		if( read_size > 0 )
+		{
+			if( libbfio_handle_seek_offset(
+			     file_io_handle,
+			     (off64_t) read_offset,
+			     SEEK_SET,
+			     error ) == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_SEEK_FAILED,
+				 "%s: unable to seek compressed read window offset: 0x%08" PRIx64 ".",
+				 function,
+				 read_offset );
+
+				return( -1 );
+			}
+			if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+			{
+				start_timestamp = libqcow_statistics_get_timestamp();
+			}
+			LIBQCOW_TRACE(
+			 host_read_issued,
+			 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+			 read_offset,
+			 read_size,
+			 0 );
+
+			read_count = libbfio_handle_read_buffer(
+			              file_io_handle,
+			              &( internal_file->compressed_read_window[ retained_size ] ),
+			              read_size,
+			              error );
+
+			if( ( read_count < 0 )
+			 || ( ( retained_size + (size_t) read_count ) < cluster_block->data_size ) )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read compressed read window.",
+				 function );
+
+				return( -1 );
+			}
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_host_reads, 1 );
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->host_bytes_read, read_count );
+
+			if( start_timestamp != 0 )
+			{
+				LIBQCOW_TRACE(
+				 host_read_completed,
+				 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+				 read_offset,
+				 read_count,
+				 libqcow_statistics_get_timestamp() - start_timestamp );
+			}
+		}
+		internal_file->compressed_read_window_offset    = (off64_t) compressed_cluster_block_offset;
+		internal_file->compressed_read_window_data_size = retained_size + (size_t) read_count;
+
+		if( memory_copy(
+		     cluster_block->data,
+		     internal_file->compressed_read_window,
+		     cluster_block->data_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy compressed data from read window.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else if( internal_file->memory_map != NULL )
+	{
+		read_count = libqcow_memory_map_read_buffer_at_offset(
+		              internal_file->memory_map,
+		              cluster_block->data,
+		              cluster_block->data_size,
+		              (off64_t) compressed_cluster_block_offset,
+		              error );
+
+		if( read_count != (ssize_t) cluster_block->data_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read compressed cluster block from memory map.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		if( libqcow_cluster_block_read(
+		     cluster_block,
+		     file_io_handle,
+		     (off64_t) compressed_cluster_block_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read compressed cluster block.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	internal_file->compressed_read_offset     = (off64_t) compressed_cluster_block_offset;
+	internal_file->compressed_read_end_offset = (off64_t) ( compressed_cluster_block_offset + cluster_block->data_size );
+
+	return( 1 );
+}
+
+/* Reads the data of contiguous cluster blocks directly into a buffer
+ * A run of cluster blocks that are stored consecutively in the file,
+ * that are not compressed and not encrypted is read using a single read
+ * bypassing the cluster block cache
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read, 0 if there is no run of multiple cluster blocks or -1 on error
+ */
+ssize_t libqcow_internal_file_read_contiguous_cluster_blocks(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint64_t cluster_block_file_offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	static char *function              = "libqcow_internal_file_read_contiguous_cluster_blocks";
+	size_t read_size                   = 0;
+	size_t run_size                    = 0;
+	ssize_t read_count                 = 0;
+	uint64_t cluster_block_offset      = 0;
+	uint64_t cluster_block_reference   = 0;
+	uint64_t next_cluster_block_offset = 0;
+	uint64_t start_timestamp           = 0;
+	off64_t next_offset                = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		return( 0 );
+	}
+	if( ( cluster_block_file_offset + internal_file->io_handle->subcluster_size ) > internal_file->size )
+	{
+		return( 0 );
+	}
+	cluster_block_offset = offset & internal_file->io_handle->subcluster_bit_mask;
+
+	run_size = internal_file->io_handle->subcluster_size - (size_t) cluster_block_offset;
+
+	if( ( (size64_t) offset + run_size ) >= internal_file->io_handle->media_size )
+	{
+		return( 0 );
+	}
+	if( run_size >= buffer_size )
+	{
+		return( 0 );
+	}
+	next_offset               = offset + (off64_t) run_size;
+	next_cluster_block_offset = cluster_block_file_offset + internal_file->io_handle->subcluster_size;
+
+	while( run_size < buffer_size )
+	{
+		if( (size64_t) next_offset >= internal_file->io_handle->media_size )
+		{
+			break;
+		}
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     file_io_handle,
+		     next_offset,
+		     &cluster_block_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 next_offset,
+			 next_offset );
+
+			return( -1 );
+		}
+		/* Zero cluster blocks are served without reading their preallocated data
+		 */
+		if( ( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+		 || ( ( cluster_block_reference & internal_file->io_handle->zero_flag_bit_mask ) != 0 ) )
+		{
+			break;
+		}
+		cluster_block_reference &= internal_file->io_handle->offset_bit_mask
+		                         & ~( internal_file->io_handle->subcluster_bit_mask );
+
+		if( cluster_block_reference != next_cluster_block_offset )
+		{
+			break;
+		}
+		if( ( next_cluster_block_offset + internal_file->io_handle->subcluster_size ) > internal_file->size )
+		{
+			break;
+		}
+		read_size = internal_file->io_handle->subcluster_size;
+
+		if( ( (size64_t) next_offset + read_size ) > internal_file->io_handle->media_size )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - next_offset );
+		}
+		if( read_size > ( buffer_size - run_size ) )
+		{
+			read_size = buffer_size - run_size;
+		}
+		run_size                  += read_size;
+		next_offset               += (off64_t) read_size;
+		next_cluster_block_offset += internal_file->io_handle->subcluster_size;
+	}
+	if( next_offset == ( offset + (off64_t) ( internal_file->io_handle->subcluster_size - (size_t) cluster_block_offset ) ) )
+	{
+		return( 0 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: contiguous cluster blocks offset\t: 0x%08" PRIx64 "\n",
+		 function,
+		 cluster_block_file_offset + cluster_block_offset );
+
+		libcnotify_printf(
+		 "%s: contiguous cluster blocks size\t\t: %" PRIzd "\n",
+		 function,
+		 run_size );
+	}
+#endif
+	if( internal_file->memory_map != NULL )
+	{
+		read_count = libqcow_memory_map_read_buffer_at_offset(
+		              internal_file->memory_map,
+		              buffer,
+		              run_size,
+		              (off64_t) ( cluster_block_file_offset + cluster_block_offset ),
+		              error );
+	}
+	else
+	{
+		if( libbfio_handle_seek_offset(
+		     file_io_handle,
+		     (off64_t) ( cluster_block_file_offset + cluster_block_offset ),
+		     SEEK_SET,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_SEEK_FAILED,
+			 "%s: unable to seek cluster block offset: 0x%08" PRIx64 ".",
+			 function,
+			 cluster_block_file_offset + cluster_block_offset );
+
+			return( -1 );
+		}
+		if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+		{
+			start_timestamp = libqcow_statistics_get_timestamp();
+		}
+		LIBQCOW_TRACE(
+		 host_read_issued,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+		 cluster_block_file_offset + cluster_block_offset,
+		 run_size,
+		 0 );
+
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              buffer,
+		              run_size,
+		              error );
+
+		if( ( start_timestamp != 0 )
+		 && ( read_count >= 0 ) )
+		{
+			LIBQCOW_TRACE(
+			 host_read_completed,
+			 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+			 cluster_block_file_offset + cluster_block_offset,
+			 read_count,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+
+	if( read_count != (ssize_t) run_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read contiguous cluster blocks.",
+		 function );
+
+		return( -1 );
+	}
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_host_reads, 1 );
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->host_bytes_read, read_count );
+
+	return( read_count );
+}
+
+/* Reads the data of a single cluster block directly into a buffer bypassing the cluster block cache
+ * If the cluster block is encrypted only the sectors that contain the data are read and decrypted
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the data cannot be read directly or -1 on error
+ */
+int libqcow_internal_file_read_cluster_block_data_directly(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     uint64_t cluster_block_file_offset,
+     uint8_t *buffer,
+     size_t read_size,
+     libcerror_error_t **error )
+{
+	uint8_t sector_data[ 512 ];
+
+	uint8_t *read_data            = NULL;
+	uint8_t *sectors_data         = NULL;
+	static char *function         = "libqcow_internal_file_read_cluster_block_data_directly";
+	size_t data_offset            = 0;
+	size_t sectors_data_offset    = 0;
+	size_t sectors_data_size      = 0;
+	ssize_t read_count            = 0;
+	uint64_t block_key            = 0;
+	uint64_t cluster_block_offset = 0;
+	uint64_t start_timestamp      = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( read_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid read size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	/* The last cluster block can be smaller than the cluster block size
+	 */
+	if( ( cluster_block_file_offset + internal_file->io_handle->subcluster_size ) > internal_file->size )
+	{
+		return( 0 );
+	}
+	cluster_block_offset = offset & internal_file->io_handle->subcluster_bit_mask;
+	read_data            = buffer;
+	sectors_data_size    = read_size;
+
+	/* Encrypted data can only be decrypted per sector, if the data is not sector aligned
+	 * the sectors that contain the data are read into a separate buffer
+	 */
+	if( ( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	 && ( ( ( cluster_block_offset % 512 ) != 0 )
+	  ||  ( ( read_size % 512 ) != 0 ) ) )
+	{
+		sectors_data_offset   = (size_t) ( cluster_block_offset % 512 );
+		sectors_data_size     = ( ( sectors_data_offset + read_size + 511 ) / 512 ) * 512;
+		cluster_block_offset -= sectors_data_offset;
+
+		sectors_data = (uint8_t *) memory_allocate(
+		                            sizeof( uint8_t ) * sectors_data_size );
+
+		if( sectors_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create sectors data.",
+			 function );
+
+			goto on_error;
+		}
+		read_data = sectors_data;
+	}
+	if( internal_file->memory_map != NULL )
+	{
+		read_count = libqcow_memory_map_read_buffer_at_offset(
+		              internal_file->memory_map,
+		              read_data,
+		              sectors_data_size,
+		              (off64_t) ( cluster_block_file_offset + cluster_block_offset ),
+		              error );
+	}
+	else
+	{
+		if( libbfio_handle_seek_offset(
+		     file_io_handle,
+		     (off64_t) ( cluster_block_file_offset + cluster_block_offset ),
+		     SEEK_SET,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_SEEK_FAILED,
+			 "%s: unable to seek cluster block offset: 0x%08" PRIx64 ".",
+			 function,
+			 cluster_block_file_offset + cluster_block_offset );
+
+			goto on_error;
+		}
+		if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+		{
+			start_timestamp = libqcow_statistics_get_timestamp();
+		}
+		LIBQCOW_TRACE(
+		 host_read_issued,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+		 cluster_block_file_offset + cluster_block_offset,
+		 sectors_data_size,
+		 0 );
+
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              read_data,
+		              sectors_data_size,
+		              error );
+
+		if( ( start_timestamp != 0 )
+		 && ( read_count >= 0 ) )
+		{
+			LIBQCOW_TRACE(
+			 host_read_completed,
+			 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+			 cluster_block_file_offset + cluster_block_offset,
+			 read_count,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+
+	if( read_count != (ssize_t) sectors_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block data.",
+		 function );
+
+		goto on_error;
+	}
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_host_reads, 1 );
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->host_bytes_read, read_count );
+
+	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+
+		/* The sector is copied so that it can be decrypted into the buffer
+		 */
+		for( data_offset = 0;
+		     data_offset < sectors_data_size;
+		     data_offset += 512 )
+		{
+			if( memory_copy(
+			     sector_data,
+			     &( read_data[ data_offset ] ),
+			     512 ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy encrypted sector data.",
+				 function );
+
+				goto on_error;
+			}
+			/* LUKS uses the sector number in the file instead of the media
+			 */
+			if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+			{
+				block_key = ( cluster_block_file_offset + cluster_block_offset + data_offset ) / 512;
+			}
+			else
+			{
+				block_key = (uint64_t) ( offset - sectors_data_offset + data_offset ) / 512;
+			}
+			if( libqcow_encryption_crypt(
+			     internal_file->encryption_context,
+			     LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT,
+			     sector_data,
+			     512,
+			     &( read_data[ data_offset ] ),
+			     512,
+			     block_key,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+				 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
+				 "%s: unable to decrypt sector data.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		if( memory_set(
+		     sector_data,
+		     0,
+		     512 ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear sector data.",
+			 function );
+
+			goto on_error;
+		}
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_decryptions, 1 );
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->decryption_time, libqcow_statistics_get_timestamp() - start_timestamp );
+
+		if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( internal_file->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 internal_file->statistics,
+			 LIBQCOW_LATENCY_OPERATION_DECRYPT,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+
+		LIBQCOW_TRACE(
+		 decrypt,
+		 LIBQCOW_TRACE_EVENT_DECRYPT,
+		 cluster_block_offset,
+		 sectors_data_size,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( sectors_data != NULL )
+	{
+		if( memory_copy(
+		     buffer,
+		     &( sectors_data[ sectors_data_offset ] ),
+		     read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy sectors data to buffer.",
+			 function );
+
+			goto on_error;
+		}
+		memory_set(
+		 sectors_data,
+		 0,
+		 sectors_data_size );
+
+		memory_free(
+		 sectors_data );
+	}
+	return( 1 );
+
+on_error:
+	memory_set(
+	 sector_data,
+	 0,
+	 512 );
+
+	if( sectors_data != NULL )
+	{
+		memory_set(
+		 sectors_data,
+		 0,
+		 sectors_data_size );
+
+		memory_free(
+		 sectors_data );
+	}
+	return( -1 );
+}
+
+/* Reads the data of consecutive allocated cluster blocks into a buffer using io_uring or overlapped IO
+ * The reads of the cluster blocks are submitted as a batch and complete directly
+ * into the buffer, cluster blocks that are stored contiguously in the file are read
+ * using a single request
+ * This stops at the first cluster block that is not allocated, compressed or encrypted,
+ * these are handled by the caller
+ * Returns the number of bytes read, 0 if the cluster blocks cannot be read asynchronously or -1 on error
+ */
+ssize_t libqcow_internal_file_read_cluster_blocks_asynchronously(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_io_uring_request_t requests[ LIBQCOW_MAXIMUM_NUMBER_OF_ASYNCHRONOUS_CLUSTER_BLOCKS ];
+
+	static char *function              = "libqcow_internal_file_read_cluster_blocks_asynchronously";
+	size_t buffer_offset               = 0;
+	size_t read_size                   = 0;
+	uint64_t cluster_block_file_offset = 0;
+	uint64_t cluster_block_offset      = 0;
+	uint64_t start_timestamp           = 0;
+	int number_of_cluster_blocks       = 0;
+	int number_of_requests             = 0;
+	int request_index                  = 0;
+	int result                         = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_uring == NULL )
+	 || ( internal_file->io_uring->ring_is_initialized == 0 )
+	 || ( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE ) )
+	{
+		return( 0 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	while( ( number_of_cluster_blocks < LIBQCOW_MAXIMUM_NUMBER_OF_ASYNCHRONOUS_CLUSTER_BLOCKS )
+	    && ( buffer_offset < buffer_size )
+	    && ( (size64_t) offset < internal_file->io_handle->media_size ) )
+	{
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     file_io_handle,
+		     offset,
+		     &cluster_block_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			result = -1;
+
+			break;
+		}
+		/* Compressed, zero and sparse cluster blocks and cluster blocks
+		 * that extend beyond the end of the file are handled by the caller
+		 */
+		if( ( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+		 || ( ( cluster_block_file_offset & internal_file->io_handle->zero_flag_bit_mask ) != 0 ) )
+		{
+			break;
+		}
+		cluster_block_file_offset &= internal_file->io_handle->offset_bit_mask
+		                           & ~( internal_file->io_handle->subcluster_bit_mask );
+
+		if( ( cluster_block_file_offset == 0 )
+		 || ( ( cluster_block_file_offset + internal_file->io_handle->subcluster_size ) > internal_file->size ) )
+		{
+			break;
+		}
+		cluster_block_offset = offset & internal_file->io_handle->subcluster_bit_mask;
+
+		read_size = internal_file->io_handle->subcluster_size - (size_t) cluster_block_offset;
+
+		if( ( (size64_t) offset + read_size ) > internal_file->io_handle->media_size )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+		}
+		if( read_size > ( buffer_size - buffer_offset ) )
+		{
+			read_size = buffer_size - buffer_offset;
+		}
+		cluster_block_file_offset += cluster_block_offset;
+
+		if( ( number_of_requests > 0 )
+		 && ( (uint64_t) ( requests[ number_of_requests - 1 ].file_offset + requests[ number_of_requests - 1 ].buffer_size ) == cluster_block_file_offset ) )
+		{
+			requests[ number_of_requests - 1 ].buffer_size += read_size;
+		}
+		else
+		{
+			requests[ number_of_requests ].buffer      = &( buffer[ buffer_offset ] );
+			requests[ number_of_requests ].buffer_size = read_size;
+			requests[ number_of_requests ].file_offset = (off64_t) cluster_block_file_offset;
+			requests[ number_of_requests ].read_size   = 0;
+
+			number_of_requests++;
+		}
+		number_of_cluster_blocks++;
+
+		offset        += (off64_t) read_size;
+		buffer_offset += read_size;
+	}
+	if( ( result == 0 )
+	 && ( number_of_requests > 0 ) )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: reading %d cluster blocks using %d requests\n",
+			 function,
+			 number_of_cluster_blocks,
+			 number_of_requests );
+		}
+#endif
+		if( LIBQCOW_TRACE_IS_ENABLED( host_read_issued )
+		 || LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+		{
+			start_timestamp = libqcow_statistics_get_timestamp();
+
+			for( request_index = 0;
+			     request_index < number_of_requests;
+			     request_index++ )
+			{
+				LIBQCOW_TRACE(
+				 host_read_issued,
+				 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+				 requests[ request_index ].file_offset,
+				 requests[ request_index ].buffer_size,
+				 0 );
+			}
+		}
+		if( libqcow_io_uring_read_requests(
+		     internal_file->io_uring,
+		     requests,
+		     number_of_requests,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster blocks.",
+			 function );
+
+			result = -1;
+		}
+		else
+		{
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_host_reads, number_of_requests );
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->host_bytes_read, buffer_offset );
+
+			/* The requests are submitted at once, hence they share the start timestamp
+			 */
+			if( start_timestamp != 0 )
+			{
+				for( request_index = 0;
+				     request_index < number_of_requests;
+				     request_index++ )
+				{
+					LIBQCOW_TRACE(
+					 host_read_completed,
+					 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+					 requests[ request_index ].file_offset,
+					 requests[ request_index ].read_size,
+					 libqcow_statistics_get_timestamp() - start_timestamp );
+				}
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result == -1 )
+	{
+		return( -1 );
+	}
+	return( (ssize_t) buffer_offset );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Reads the data of consecutive compressed or encrypted cluster blocks into a buffer
+ * The data is read from the file while holding the cache mutex and decompressed
+ * or decrypted in parallel by the worker thread pool
+ * The decompressed cluster blocks are stored in the compressed cluster block cache
+ * Returns the number of bytes read, 0 if there is no compressed or encrypted cluster block at the offset or -1 on error
+ */
+ssize_t libqcow_internal_file_read_cluster_blocks_in_parallel(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_cluster_block_t *cluster_blocks[ LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS ];
+	libqcow_cluster_block_task_t *cluster_block_tasks[ LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS ];
+	uint64_t cluster_block_offsets[ LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS ];
+	uint64_t block_keys[ LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS ];
+
+	libcthreads_queue_t *completed_queue             = NULL;
+	libcthreads_thread_pool_t *worker_thread_pool    = NULL;
+	libqcow_cache_value_t *cache_value               = NULL;
+	libqcow_cluster_block_t *cluster_block           = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	libqcow_cluster_block_task_t *cluster_block_task = NULL;
+	static char *function                            = "libqcow_internal_file_read_cluster_blocks_in_parallel";
+	size_t buffer_offset                             = 0;
+	size_t cluster_block_size                        = 0;
+	size_t read_size                                 = 0;
+	uint64_t cluster_block_file_offset               = 0;
+	uint64_t cluster_block_offset                    = 0;
+	uint64_t compressed_cluster_block_offset         = 0;
+	off64_t cluster_block_data_offset                = 0;
+	int cache_mutex_grabbed                          = 0;
+	int maximum_number_of_tasks                      = 0;
+	int number_of_completed_tasks                    = 0;
+	int number_of_pushed_tasks                       = 0;
+	int number_of_tasks                              = 0;
+	int numa_node                                    = 0;
+	int result                                       = 0;
+	int task_index                                   = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->number_of_worker_threads <= 0 )
+	{
+		return( 0 );
+	}
+	/* Queue twice the number of threads so that the threads remain busy
+	 */
+	maximum_number_of_tasks = internal_file->number_of_worker_threads * 2;
+
+	if( maximum_number_of_tasks > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS )
+	{
+		maximum_number_of_tasks = LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS;
+	}
+	/* The cluster blocks are allocated from the pool of the NUMA node of the reading thread
+	 */
+	if( libqcow_io_handle_get_cluster_block_pool(
+	     internal_file->io_handle,
+	     &cluster_block_pool,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+	cache_mutex_grabbed = 1;
+
+	/* Read the compressed data of the cluster blocks, this stops at the first
+	 * cluster block that is not compressed or that is already cached
+	 */
+	while( ( number_of_tasks < maximum_number_of_tasks )
+	    && ( buffer_offset < buffer_size )
+	    && ( (size64_t) offset < internal_file->io_handle->media_size ) )
+	{
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     file_io_handle,
+		     offset,
+		     &cluster_block_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			goto on_error;
+		}
+		cluster_block_offset = offset & internal_file->io_handle->cluster_block_bit_mask;
+
+		if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			/* Simultaneous encryption and compression is not supported
+			 * and zero, sparse and last cluster blocks and subclusters
+			 * of extended level 2 table entries are handled by the caller
+			 */
+			if( ( internal_file->io_handle->number_of_level2_table_entry_bits > 3 )
+			 || ( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+			 || ( ( cluster_block_file_offset & internal_file->io_handle->zero_flag_bit_mask ) != 0 ) )
+			{
+				break;
+			}
+			cluster_block_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+			if( ( cluster_block_file_offset == 0 )
+			 || ( ( cluster_block_file_offset + internal_file->io_handle->cluster_block_size ) > internal_file->size ) )
+			{
+				break;
+			}
+			cluster_block_size = internal_file->io_handle->cluster_block_size;
+
+			/* LUKS uses the sector number in the file instead of the media
+			 */
+			if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+			{
+				block_keys[ number_of_tasks ] = cluster_block_file_offset / 512;
+			}
+			else
+			{
+				block_keys[ number_of_tasks ] = (uint64_t) ( offset - cluster_block_offset ) / 512;
+			}
+		}
+		else
+		{
+			if( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) == 0 )
+			{
+				break;
+			}
+			cluster_block_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+			if( libqcow_internal_file_get_compressed_cluster_block_range(
+			     internal_file,
+			     cluster_block_file_offset,
+			     &compressed_cluster_block_offset,
+			     &cluster_block_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve compressed cluster block range.",
+				 function );
+
+				goto on_error;
+			}
+			if( libqcow_internal_file_bound_compressed_cluster_block_size(
+			     internal_file,
+			     offset,
+			     compressed_cluster_block_offset,
+			     &cluster_block_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to bound compressed cluster block size.",
+				 function );
+
+				goto on_error;
+			}
+			cluster_block_file_offset = compressed_cluster_block_offset;
+
+			cluster_block = NULL;
+
+			result = libqcow_internal_file_get_cached_value(
+			          internal_file,
+			          internal_file->compressed_cluster_block_cache,
+			          LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+			          (off64_t) cluster_block_file_offset,
+			          (intptr_t **) &cluster_block,
+			          &cache_value,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve compressed cluster block: 0x%08" PRIx64 " from cache.",
+				 function,
+				 cluster_block_file_offset );
+
+				goto on_error;
+			}
+			else if( result != 0 )
+			{
+				/* The cached cluster block is read by the caller
+				 */
+				if( libqcow_internal_file_release_cached_value(
+				     internal_file,
+				     &cache_value,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to release compressed cluster block: 0x%08" PRIx64 " in cache.",
+					 function,
+					 cluster_block_file_offset );
+
+					goto on_error;
+				}
+				break;
+			}
+			block_keys[ number_of_tasks ] = 0;
+		}
+		cluster_block = NULL;
+
+		if( libqcow_cluster_block_initialize(
+		     &cluster_block,
+		     cluster_block_size,
+		     cluster_block_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create cluster block.",
+			 function );
+
+			goto on_error;
+		}
+		cluster_block->statistics = internal_file->statistics;
+
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+		{
+			cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA;
+		}
+		cluster_blocks[ number_of_tasks ]        = cluster_block;
+		cluster_block_offsets[ number_of_tasks ] = cluster_block_file_offset;
+		cluster_block_tasks[ number_of_tasks ]   = NULL;
+
+		number_of_tasks++;
+
+		/* The compressed data is read using the compressed read window,
+		 * so that the compressed data of adjacent cluster blocks is read once
+		 */
+		if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			result = libqcow_internal_file_read_compressed_cluster_block(
+			          internal_file,
+			          file_io_handle,
+			          cluster_block,
+			          cluster_block_file_offset,
+			          error );
+		}
+		else
+		{
+			result = libqcow_cluster_block_read(
+			          cluster_block,
+			          file_io_handle,
+			          cluster_block_file_offset,
+			          error );
+		}
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block at offset: 0x%08" PRIx64".",
+			 function,
+			 cluster_block_file_offset );
+
+			goto on_error;
+		}
+
+		read_size = internal_file->io_handle->cluster_block_size - (size_t) cluster_block_offset;
+
+		if( ( (size64_t) offset + read_size ) > internal_file->io_handle->media_size )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+		}
+		if( read_size > ( buffer_size - buffer_offset ) )
+		{
+			read_size = buffer_size - buffer_offset;
+		}
+		offset        += (off64_t) read_size;
+		buffer_offset += read_size;
+	}
+	if( libqcow_internal_file_start_worker_thread_pool(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to start worker thread pool.",
+		 function );
+
+		goto on_error;
+	}
+	cache_mutex_grabbed = 0;
+
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_tasks == 0 )
+	{
+		return( 0 );
+	}
+	/* The cluster blocks are processed by the worker threads of the NUMA node of the reading thread
+	 */
+	worker_thread_pool = internal_file->worker_thread_pool;
+
+	if( internal_file->numa_worker_thread_pools != NULL )
+	{
+		if( libqcow_numa_topology_get_current_node(
+		     internal_file->numa_topology,
+		     &numa_node,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve current NUMA node.",
+			 function );
+
+			goto on_error;
+		}
+		if( numa_node > 0 )
+		{
+			worker_thread_pool = internal_file->numa_worker_thread_pools[ numa_node ];
+		}
+	}
+	/* Decompress or decrypt the cluster blocks in parallel
+	 */
+	if( libcthreads_queue_initialize(
+	     &completed_queue,
+	     number_of_tasks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create completed queue.",
+		 function );
+
+		goto on_error;
+	}
+	for( task_index = 0;
+	     task_index < number_of_tasks;
+	     task_index++ )
+	{
+		if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			cluster_block_size = 0;
+		}
+		else
+		{
+			cluster_block_size = internal_file->io_handle->cluster_block_size;
+		}
+		if( libqcow_cluster_block_task_initialize(
+		     &( cluster_block_tasks[ task_index ] ),
+		     cluster_blocks[ task_index ],
+		     cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create cluster block task: %d.",
+			 function,
+			 task_index );
+
+			goto on_error;
+		}
+		if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			cluster_block_tasks[ task_index ]->encryption_method  = internal_file->encryption_method;
+			cluster_block_tasks[ task_index ]->encryption_context = internal_file->encryption_context;
+			cluster_block_tasks[ task_index ]->key_data           = internal_file->key_data;
+			cluster_block_tasks[ task_index ]->key_data_size      = internal_file->key_data_size;
+			cluster_block_tasks[ task_index ]->block_key          = block_keys[ task_index ];
+		}
+		if( internal_file->numa_worker_thread_pools != NULL )
+		{
+			cluster_block_tasks[ task_index ]->numa_topology = internal_file->numa_topology;
+			cluster_block_tasks[ task_index ]->numa_node     = numa_node;
+		}
+		cluster_block_tasks[ task_index ]->completed_queue = completed_queue;
+
+		if( libcthreads_thread_pool_push(
+		     worker_thread_pool,
+		     (intptr_t *) cluster_block_tasks[ task_index ],
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to push cluster block task: %d onto worker thread pool.",
+			 function,
+			 task_index );
+
+			goto on_error;
+		}
+		number_of_pushed_tasks++;
+	}
+	while( number_of_completed_tasks < number_of_pushed_tasks )
+	{
+		if( libcthreads_queue_pop(
+		     completed_queue,
+		     (intptr_t **) &cluster_block_task,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to pop cluster block task from completed queue.",
+			 function );
+
+			/* The pushed tasks cannot be freed safely when they are still being processed
+			 */
+			return( -1 );
+		}
+		number_of_completed_tasks++;
+	}
+	/* Copy the decompressed data into the buffer
+	 */
+	offset       -= (off64_t) buffer_offset;
+	buffer_offset = 0;
+
+	for( task_index = 0;
+	     task_index < number_of_tasks;
+	     task_index++ )
+	{
+		if( cluster_block_tasks[ task_index ]->result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to process cluster block data at offset: 0x%08" PRIx64".",
+			 function,
+			 cluster_block_offsets[ task_index ] );
+
+			goto on_error;
+		}
+		cluster_block_data_offset = offset & internal_file->io_handle->cluster_block_bit_mask;
+
+		read_size = internal_file->io_handle->cluster_block_size - (size_t) cluster_block_data_offset;
+
+		if( ( (size64_t) offset + read_size ) > internal_file->io_handle->media_size )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+		}
+		if( read_size > ( buffer_size - buffer_offset ) )
+		{
+			read_size = buffer_size - buffer_offset;
+		}
+		if( memory_copy(
+		     &( buffer[ buffer_offset ] ),
+		     &( ( cluster_blocks[ task_index ]->data )[ cluster_block_data_offset ] ),
+		     read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy cluster block data.",
+			 function );
+
+			goto on_error;
+		}
+		offset        += (off64_t) read_size;
+		buffer_offset += read_size;
+	}
+	for( task_index = 0;
+	     task_index < number_of_tasks;
+	     task_index++ )
+	{
+		if( libqcow_cluster_block_task_free(
+		     &( cluster_block_tasks[ task_index ] ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cluster block task: %d.",
+			 function,
+			 task_index );
+
+			goto on_error;
+		}
+	}
+	if( libcthreads_queue_free(
+	     &completed_queue,
+	     NULL,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free completed queue.",
+		 function );
+
+		goto on_error;
+	}
+	/* Store the decompressed cluster blocks in the cache so that a subsequent
+	 * read of the remainder of a cluster block does not decompress it again
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	cache_mutex_grabbed = 1;
+
+	for( task_index = 0;
+	     task_index < number_of_tasks;
+	     task_index++ )
+	{
+		/* Decrypted cluster blocks are not stored since they are cached
+		 * by the cluster block vector
+		 */
+		if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->compressed_cluster_block_cache_misses, 1 );
+		}
+		if( ( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		 || ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_CACHE ) != 0 ) )
+		{
+			if( libqcow_cluster_block_free(
+			     &( cluster_blocks[ task_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free cluster block: %d.",
+				 function,
+				 task_index );
+
+				goto on_error;
+			}
+			continue;
+		}
+		cluster_block = cluster_blocks[ task_index ];
+
+		cluster_blocks[ task_index ] = NULL;
+
+		if( libqcow_internal_file_set_cached_value(
+		     internal_file,
+		     internal_file->compressed_cluster_block_cache,
+		     LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+		     (off64_t) cluster_block_offsets[ task_index ],
+		     (intptr_t *) cluster_block,
+		     &cache_value,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set cluster block: 0x%08" PRIx64 " in cache.",
+			 function,
+			 cluster_block_offsets[ task_index ] );
+
+			goto on_error;
+		}
+		if( libqcow_internal_file_release_cached_value(
+		     internal_file,
+		     &cache_value,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cluster block: 0x%08" PRIx64 " in cache.",
+			 function,
+			 cluster_block_offsets[ task_index ] );
+
+			goto on_error;
+		}
+	}
+	cache_mutex_grabbed = 0;
+
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+	return( (ssize_t) buffer_offset );
+
+on_error:
+	/* Wait for the pushed tasks to complete before freeing them
+	 */
+	while( number_of_completed_tasks < number_of_pushed_tasks )
+	{
+		if( libcthreads_queue_pop(
+		     completed_queue,
+		     (intptr_t **) &cluster_block_task,
+		     NULL ) != 1 )
+		{
+			break;
+		}
+		number_of_completed_tasks++;
+	}
+	if( cache_mutex_grabbed != 0 )
+	{
+		libcthreads_mutex_release(
+		 internal_file->cache_mutex,
+		 NULL );
+	}
+	if( number_of_completed_tasks == number_of_pushed_tasks )
+	{
+		for( task_index = 0;
+		     task_index < number_of_tasks;
+		     task_index++ )
+		{
+			if( cluster_block_tasks[ task_index ] != NULL )
+			{
+				libqcow_cluster_block_task_free(
+				 &( cluster_block_tasks[ task_index ] ),
+				 NULL );
+			}
+			if( cluster_blocks[ task_index ] != NULL )
+			{
+				libqcow_cluster_block_free(
+				 &( cluster_blocks[ task_index ] ),
+				 NULL );
+			}
+		}
+		if( completed_queue != NULL )
+		{
+			libcthreads_queue_free(
+			 &completed_queue,
+			 NULL,
+			 NULL );
+		}
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Retrieves the path of a file relative to the directory that contains the file
+ * The file must be opened by filename, an absolute name is used as-is
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_relative_file_path(
+     libqcow_internal_file_t *internal_file,
+     const uint8_t *name,
+     size_t name_size,
+     char **path,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	char *filename                   = NULL;
+	char *safe_path                  = NULL;
+	char *separator                  = NULL;
+	static char *function            = "libqcow_internal_file_get_relative_file_path";
+	size_t directory_name_length     = 0;
+	size_t filename_size             = 0;
+	size_t path_size                 = 0;
+	int is_absolute_path             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( name == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid name.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( name_size == 0 )
+	 || ( name_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid name size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		return( -1 );
+	}
+	/* The name is that of the (host) file IO handle read through the host cache
+	 * or that of the (named) file IO handle read using unbuffered IO
+	 */
+	file_io_handle = internal_file->file_io_handle;
+
+	if( internal_file->named_file_io_handle != NULL )
+	{
+		file_io_handle = internal_file->named_file_io_handle;
+	}
+	else if( internal_file->host_file_io_handle != NULL )
+	{
+		file_io_handle = internal_file->host_file_io_handle;
+	}
+	if( libbfio_file_get_name_size(
+	     file_io_handle,
+	     &filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename size.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( filename_size == 0 )
+	 || ( filename_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid filename size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	filename = narrow_string_allocate(
+	            filename_size );
+
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_get_name(
+	     file_io_handle,
+	     filename,
+	     filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( name[ 0 ] == (uint8_t) LIBQCOW_SEPARATOR )
+	{
+		is_absolute_path = 1;
+	}
+#if defined( WINAPI )
+	else if( ( name_size >= 2 )
+	      && ( name[ 1 ] == (uint8_t) ':' ) )
+	{
+		is_absolute_path = 1;
+	}
+#endif
+	/* A relative name is relative to the directory that contains the file
+	 */
+	if( is_absolute_path == 0 )
+	{
+		separator = narrow_string_search_character_reverse(
+		             filename,
+		             (int) LIBQCOW_SEPARATOR,
+		             filename_size );
+
+		if( separator != NULL )
+		{
+			directory_name_length = (size_t) ( separator - filename ) + 1;
+		}
+	}
+	path_size = directory_name_length + name_size + 1;
+
+	safe_path = narrow_string_allocate(
+	             path_size );
+
+	if( safe_path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create path.",
+		 function );
+
+		goto on_error;
+	}
+	if( directory_name_length > 0 )
+	{
+		if( narrow_string_copy(
+		     safe_path,
+		     filename,
+		     directory_name_length ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy directory name to path.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( memory_copy(
+	     &( safe_path[ directory_name_length ] ),
+	     name,
+	     name_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy name to path.",
+		 function );
+
+		goto on_error;
+	}
+	safe_path[ path_size - 1 ] = 0;
+
+	memory_free(
+	 filename );
+
+	*path = safe_path;
+
+	return( 1 );
+
+on_error:
+	if( safe_path != NULL )
+	{
+		memory_free(
+		 safe_path );
+	}
+	if( filename != NULL )
+	{
+		memory_free(
+		 filename );
+	}
+	return( -1 );
+}
+
+/* Retrieves the parent (backing) file
+ * The parent file is opened on first use if the file was opened by filename
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_get_parent_file(
+     libqcow_internal_file_t *internal_file,
+     libqcow_file_t **parent_file,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *backing_file         = NULL;
+	char *backing_file_path              = NULL;
+	static char *function                = "libqcow_internal_file_get_parent_file";
+	size_t backing_file_path_size        = 0;
+	int maximum_number_of_cluster_blocks = 0;
+	int maximum_number_of_level2_tables  = 0;
+	int result                           = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( parent_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parent file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->parent_file != NULL )
+	{
+		*parent_file = internal_file->parent_file;
+
+		return( 1 );
+	}
+	/* The backing file can only be located relative to a file that was opened by filename
+	 */
+	if( ( internal_file->io_handle->backing_filename == NULL )
+	 || ( internal_file->io_handle->backing_filename_size == 0 )
+	 || ( internal_file->file_io_handle_created_in_library == 0 ) )
+	{
+		return( 0 );
+	}
+	if( internal_file->backing_file_chain_depth >= LIBQCOW_MAXIMUM_BACKING_FILE_CHAIN_DEPTH )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid file - backing file chain depth value exceeds maximum.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_get_relative_file_path(
+	     internal_file,
+	     internal_file->io_handle->backing_filename,
+	     internal_file->io_handle->backing_filename_size,
+	     &backing_file_path,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve backing file path.",
+		 function );
+
+		goto on_error;
+	}
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: opening backing file: %s\n",
+		 function,
+		 backing_file_path );
+	}
+#endif
+	/* A backing file that is opened by another file with the same shared cache is reused,
+	 * so that the level 2 tables and cluster blocks of an image that is the backing file of
+	 * multiple files are cached once, by the host offset in the image. A backing file with
+	 * a password or keys is not reused since its data is decrypted in the cache
+	 */
+	backing_file_path_size = narrow_string_length(
+	                          backing_file_path ) + 1;
+
+	if( ( internal_file->shared_cache != NULL )
+	 && ( internal_file->password == NULL )
+	 && ( internal_file->key_data_is_set == 0 ) )
+	{
+		result = libqcow_internal_cache_get_image(
+		          (libqcow_internal_cache_t *) internal_file->shared_cache,
+		          (uint8_t *) backing_file_path,
+		          backing_file_path_size,
+		          (intptr_t **) &backing_file,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve backing file from shared cache.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			memory_free(
+			 backing_file_path );
+
+			internal_file->parent_file                    = backing_file;
+			internal_file->parent_file_created_in_library = 1;
+
+			*parent_file = backing_file;
+
+			return( 1 );
+		}
+	}
+	/* The backing files share the cache budget of the file, each backing file
+	 * gets half of the cache entries of its child
+	 */
+	maximum_number_of_level2_tables = internal_file->maximum_number_of_level2_table_cache_entries / 2;
+
+	if( maximum_number_of_level2_tables < LIBQCOW_MINIMUM_CACHE_ENTRIES_BACKING_FILE )
+	{
+		maximum_number_of_level2_tables = LIBQCOW_MINIMUM_CACHE_ENTRIES_BACKING_FILE;
+	}
+	maximum_number_of_cluster_blocks = internal_file->maximum_number_of_cluster_block_cache_entries / 2;
+
+	if( maximum_number_of_cluster_blocks < LIBQCOW_MINIMUM_CACHE_ENTRIES_BACKING_FILE )
+	{
+		maximum_number_of_cluster_blocks = LIBQCOW_MINIMUM_CACHE_ENTRIES_BACKING_FILE;
+	}
+	if( libqcow_file_initialize(
+	     &backing_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create backing file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_set_cache_limits(
+	     backing_file,
+	     maximum_number_of_level2_tables,
+	     maximum_number_of_cluster_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set backing file cache limits.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_set_read_flags(
+	     backing_file,
+	     internal_file->read_flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set backing file read flags.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_set_io_queue_depth(
+	     backing_file,
+	     internal_file->io_queue_depth,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set backing file IO queue depth.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_file->shared_cache != NULL )
+	{
+		if( libqcow_file_set_cache(
+		     backing_file,
+		     internal_file->shared_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing file shared cache.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( internal_file->file_io_pool != NULL )
+	{
+		if( libqcow_file_set_file_io_pool(
+		     backing_file,
+		     internal_file->file_io_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing file file IO pool.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	/* The password is passed on instead of the key since the key can be
+	 * the LUKS master key of this file
+	 */
+	if( internal_file->password != NULL )
+	{
+		if( libqcow_file_set_utf8_password(
+		     backing_file,
+		     internal_file->password,
+		     internal_file->password_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing file password.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else if( internal_file->key_data_is_set != 0 )
+	{
+		if( libqcow_file_set_keys(
+		     backing_file,
+		     internal_file->key_data,
+		     internal_file->key_data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing file keys.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	( (libqcow_internal_file_t *) backing_file )->backing_file_chain_depth = internal_file->backing_file_chain_depth + 1;
+
+	if( libqcow_file_open(
+	     backing_file,
+	     backing_file_path,
+	     LIBQCOW_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open backing file: %s.",
+		 function,
+		 backing_file_path );
+
+		goto on_error;
+	}
+	if( ( internal_file->shared_cache != NULL )
+	 && ( internal_file->password == NULL )
+	 && ( internal_file->key_data_is_set == 0 ) )
+	{
+		/* If another file set the same backing file in the meantime
+		 * this backing file is not shared
+		 */
+		if( libqcow_internal_cache_set_image(
+		     (libqcow_internal_cache_t *) internal_file->shared_cache,
+		     (uint8_t *) backing_file_path,
+		     backing_file_path_size,
+		     (intptr_t *) backing_file,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing file in shared cache.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 backing_file_path );
+
+	internal_file->parent_file                    = backing_file;
+	internal_file->parent_file_created_in_library = 1;
+
+	*parent_file = backing_file;
+
+	return( 1 );
+
+on_error:
+	if( backing_file != NULL )
+	{
+		libqcow_file_free(
+		 &backing_file,
+		 NULL );
+	}
+	if( backing_file_path != NULL )
+	{
+		memory_free(
+		 backing_file_path );
+	}
+	return( -1 );
+}
+
+/* Retrieves the external data file IO handle
+ * The external data file is opened on first use if the file was opened by filename
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_get_data_file_io_handle(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t **data_file_io_handle,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *pooled_file_io_handle    = NULL;
+	libbfio_handle_t *safe_data_file_io_handle = NULL;
+	char *data_file_path                       = NULL;
+	static char *function                      = "libqcow_internal_file_get_data_file_io_handle";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->data_file_io_handle != NULL )
+	{
+		*data_file_io_handle = internal_file->data_file_io_handle;
+
+		return( 1 );
+	}
+	/* The external data file can only be located relative to a file that was opened by filename
+	 */
+	if( ( internal_file->io_handle->data_filename == NULL )
+	 || ( internal_file->io_handle->data_filename_size == 0 )
+	 || ( internal_file->file_io_handle_created_in_library == 0 ) )
+	{
+		return( 0 );
+	}
+	if( libqcow_internal_file_get_relative_file_path(
+	     internal_file,
+	     internal_file->io_handle->data_filename,
+	     internal_file->io_handle->data_filename_size,
+	     &data_file_path,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve data file path.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: opening data file: %s\n",
+		 function,
+		 data_file_path );
+	}
+#endif
+	if( libbfio_file_initialize(
+	     &safe_data_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create data file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     safe_data_file_io_handle,
+	     data_file_path,
+	     narrow_string_length(
+	      data_file_path ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in data file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_file->file_io_pool != NULL )
+	{
+		if( libqcow_pooled_file_initialize_handle(
+		     &pooled_file_io_handle,
+		     internal_file->file_io_pool,
+		     safe_data_file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create pooled data file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		safe_data_file_io_handle = pooled_file_io_handle;
+	}
+	if( libbfio_handle_open(
+	     safe_data_file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open data file: %s.",
+		 function,
+		 data_file_path );
+
+		goto on_error;
+	}
+	memory_free(
+	 data_file_path );
+
+	internal_file->data_file_io_handle                    = safe_data_file_io_handle;
+	internal_file->data_file_io_handle_created_in_library = 1;
+
+	*data_file_io_handle = safe_data_file_io_handle;
+
+	return( 1 );
+
+on_error:
+	if( safe_data_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &safe_data_file_io_handle,
+		 NULL );
+	}
+	if( data_file_path != NULL )
+	{
+		memory_free(
+		 data_file_path );
+	}
+	return( -1 );
+}
+
+/* Retrieves the backing file at a specific depth in the backing file chain
+ * The backing files are opened on first use
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_internal_file_get_backing_file_by_depth(
+     libqcow_internal_file_t *internal_file,
+     int backing_file_depth,
+     libqcow_file_t **backing_file,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *parent_file                   = NULL;
+	libqcow_internal_file_t *internal_parent_file = NULL;
+	static char *function                         = "libqcow_internal_file_get_backing_file_by_depth";
+	int depth                                     = 0;
+	int result                                    = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( backing_file_depth <= 0 )
+	 || ( backing_file_depth > LIBQCOW_MAXIMUM_BACKING_FILE_CHAIN_DEPTH ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid backing file depth value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( backing_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid backing file.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_internal_file_get_parent_file(
+	          internal_file,
+	          &parent_file,
+	          error );
+
+	for( depth = 1;
+	     ( result == 1 ) && ( depth < backing_file_depth );
+	     depth++ )
+	{
+		internal_parent_file = (libqcow_internal_file_t *) parent_file;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     internal_parent_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab backing file cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		result = libqcow_internal_file_get_parent_file(
+		          internal_parent_file,
+		          &parent_file,
+		          error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_parent_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release backing file cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve backing file at depth: %d.",
+		 function,
+		 depth );
+
+		return( -1 );
+	}
+	else if( result != 0 )
+	{
+		*backing_file = parent_file;
+	}
+	return( result );
+}
+
+/* Retrieves the backing file that contains the data of a cluster block at a specific offset
+ * The cluster block is expected to be unallocated in the file itself
+ * The cluster block reference is the level 2 table entry in the backing file
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the cluster block reads as zero or -1 on error
+ */
+int libqcow_internal_file_get_backing_file_at_offset(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     libqcow_file_t **backing_file,
+     int *backing_file_depth,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *parent_file                   = NULL;
+	libqcow_internal_file_t *internal_parent_file = NULL;
+	static char *function                         = "libqcow_internal_file_get_backing_file_at_offset";
+	uint64_t parent_cluster_block_reference       = 0;
+	int depth                                     = 0;
+	int result                                    = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( backing_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid backing file.",
+		 function );
+
+		return( -1 );
+	}
+	if( backing_file_depth == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid backing file depth.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_internal_file_get_parent_file(
+	          internal_file,
+	          &parent_file,
+	          error );
+
+	while( result == 1 )
+	{
+		depth++;
+
+		internal_parent_file = (libqcow_internal_file_t *) parent_file;
+
+		if( ( internal_parent_file->io_handle == NULL )
+		 || ( (size64_t) offset >= internal_parent_file->io_handle->media_size ) )
+		{
+			/* The data beyond the media size of a backing file reads as zero
+			 */
+			return( 0 );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     internal_parent_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab backing file cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		result = libqcow_internal_file_get_cluster_block_reference(
+		          internal_parent_file,
+		          internal_parent_file->file_io_handle,
+		          offset,
+		          &parent_cluster_block_reference,
+		          error );
+
+		if( result == 1 )
+		{
+			if( ( parent_cluster_block_reference & internal_parent_file->io_handle->compression_flag_bit_mask ) == 0 )
+			{
+				if( ( parent_cluster_block_reference & internal_parent_file->io_handle->zero_flag_bit_mask ) != 0 )
+				{
+					/* A zero cluster block does not fall through to the next backing file
+					 */
+					result = 0;
+				}
+				else if( ( parent_cluster_block_reference & internal_parent_file->io_handle->offset_bit_mask ) == 0 )
+				{
+					/* Continue with the next backing file
+					 */
+					result = 2;
+				}
+			}
+		}
+		if( result == 2 )
+		{
+			result = libqcow_internal_file_get_parent_file(
+			          internal_parent_file,
+			          &parent_file,
+			          error );
+		}
+		else if( result == 1 )
+		{
+			result = 3;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_parent_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release backing file cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve backing file for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	else if( result == 3 )
+	{
+		*backing_file            = parent_file;
+		*backing_file_depth      = depth;
+		*cluster_block_reference = parent_cluster_block_reference;
+
+		return( 1 );
+	}
+	return( 0 );
+}
+
+/* Reads the data of an unallocated cluster block from the backing files
+ * The data reads as zero if none of the backing files contains the cluster block
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_backing_file_data(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t read_size,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *backing_file                   = NULL;
+	libqcow_internal_file_t *internal_backing_file = NULL;
+	static char *function                          = "libqcow_internal_file_read_backing_file_data";
+	ssize_t read_count                             = 0;
+	uint64_t cluster_block_reference               = 0;
+	uint8_t layer                                  = 0;
+	int backing_file_depth                         = 0;
+	int result                                     = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( read_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid read size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->chain_index == NULL )
+	 && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_USE_CHAIN_INDEX ) != 0 ) )
+	{
+		if( libqcow_chain_index_initialize(
+		     &( internal_file->chain_index ),
+		     internal_file->io_handle->media_size,
+		     internal_file->io_handle->cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create chain index.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( internal_file->chain_index == NULL )
+	{
+		/* Without a chain index the backing file resolves the cluster block itself
+		 */
+		result = libqcow_internal_file_get_parent_file(
+		          internal_file,
+		          &backing_file,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve parent file.",
+			 function );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			read_count = libqcow_file_read_buffer_at_offset(
+			              backing_file,
+			              buffer,
+			              read_size,
+			              offset,
+			              error );
+
+			if( read_count < 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read buffer from parent file at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+		}
+	}
+	else
+	{
+		if( libqcow_chain_index_get_entry_at_offset(
+		     internal_file->chain_index,
+		     offset,
+		     &layer,
+		     &cluster_block_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve chain index entry for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		if( layer == LIBQCOW_CHAIN_INDEX_LAYER_UNRESOLVED )
+		{
+			result = libqcow_internal_file_get_backing_file_at_offset(
+			          internal_file,
+			          offset,
+			          &backing_file,
+			          &backing_file_depth,
+			          &cluster_block_reference,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve backing file for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			else if( result == 0 )
+			{
+				layer                   = LIBQCOW_CHAIN_INDEX_LAYER_ZERO;
+				cluster_block_reference = 0;
+			}
+			else
+			{
+				layer = (uint8_t) backing_file_depth;
+			}
+			if( libqcow_chain_index_set_entry_at_offset(
+			     internal_file->chain_index,
+			     offset,
+			     layer,
+			     cluster_block_reference,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set chain index entry for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+		}
+		else if( layer != LIBQCOW_CHAIN_INDEX_LAYER_ZERO )
+		{
+			result = libqcow_internal_file_get_backing_file_by_depth(
+			          internal_file,
+			          (int) layer,
+			          &backing_file,
+			          error );
+
+			if( result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve backing file at depth: %" PRIu8 ".",
+				 function,
+				 layer );
+
+				return( -1 );
+			}
+		}
+		if( layer != LIBQCOW_CHAIN_INDEX_LAYER_ZERO )
+		{
+			/* The cluster block is read from the layer that contains it
+			 * without looking it up in the other layers
+			 */
+			internal_backing_file = (libqcow_internal_file_t *) backing_file;
+
+			if( ( internal_backing_file->io_handle == NULL )
+			 || ( (size64_t) offset >= internal_backing_file->io_handle->media_size ) )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid backing file - offset value out of bounds.",
+				 function );
+
+				return( -1 );
+			}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( libcthreads_mutex_grab(
+			     internal_backing_file->cache_mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to grab backing file cache mutex.",
+				 function );
+
+				return( -1 );
+			}
+#endif
+			read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+			              internal_backing_file,
+			              internal_backing_file->file_io_handle,
+			              offset,
+			              cluster_block_reference,
+			              buffer,
+			              read_size,
+			              error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( libcthreads_mutex_release(
+			     internal_backing_file->cache_mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release backing file cache mutex.",
+				 function );
+
+				return( -1 );
+			}
+#endif
+			if( read_count < 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block data from backing file at depth: %" PRIu8 ".",
+				 function,
+				 layer );
+
+				return( -1 );
+			}
+		}
+	}
+	/* The data beyond the media size of the backing file reads as zero
+	 */
+	if( (size_t) read_count < read_size )
+	{
+		if( memory_set(
+		     &( buffer[ read_count ] ),
+		     0,
+		     read_size - (size_t) read_count ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to set sparse data in buffer.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Reads (media) data from a raw external data file at a specific offset into a buffer
+ * The offset in the raw external data file equals the (media) offset, hence the data
+ * is read without looking up the cluster blocks in the level 2 tables
+ * Data beyond the end of the data file is read as zero bytes
+ * This function does not change the current offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_raw_data_file_data(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libbfio_handle_t *data_file_io_handle = NULL;
+	static char *function                 = "libqcow_internal_file_read_raw_data_file_data";
+	size_t read_size                      = 0;
+	ssize_t read_count                    = 0;
+	uint64_t start_timestamp              = 0;
+	int result                            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_internal_file_get_data_file_io_handle(
+	          internal_file,
+	          &data_file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve data file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing data file.",
+		 function );
+
+		return( -1 );
+	}
+	read_size = buffer_size;
+
+	if( ( (size64_t) offset + read_size ) > internal_file->io_handle->media_size )
+	{
+		read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+	}
+	if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	LIBQCOW_TRACE(
+	 host_read_issued,
+	 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+	 offset,
+	 read_size,
+	 0 );
+
+	/* The data of the whole buffer is read using a single read
+	 */
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              data_file_io_handle,
+	              buffer,
+	              read_size,
+	              offset,
+	              error );
+
+	if( read_count < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read data file data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->number_of_host_reads, 1 );
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->host_bytes_read, read_count );
+
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 host_read_completed,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+		 offset,
+		 read_count,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	if( (size_t) read_count < read_size )
+	{
+		if( memory_set(
+		     &( buffer[ read_count ] ),
+		     0,
+		     read_size - (size_t) read_count ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to set zero data in buffer.",
+			 function );
+
+			return( -1 );
+		}
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->sparse_bytes, read_size - (size_t) read_count );
+	}
+	return( (ssize_t) read_size );
+}
+
+/* Reads (media) data of a single cluster block at a specific offset into a buffer using a Basic File IO (bfio) handle
+ * The data is read up to the end of the cluster block, the end of the media or the end of the buffer
+ * This function does not change the current offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	static char *function            = "libqcow_internal_file_read_cluster_block_data";
+	ssize_t read_count               = 0;
+	uint64_t cluster_block_reference = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The data of a raw external data file is read without a level 2 table lookup
+	 */
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+	{
+		read_count = libqcow_internal_file_read_raw_data_file_data(
+		              internal_file,
+		              offset,
+		              buffer,
+		              buffer_size,
+		              error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read data file data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		return( read_count );
+	}
+	if( libqcow_internal_file_get_cluster_block_reference(
+	     internal_file,
+	     file_io_handle,
+	     offset,
+	     &cluster_block_reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+	              internal_file,
+	              file_io_handle,
+	              offset,
+	              cluster_block_reference,
+	              buffer,
+	              buffer_size,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	return( read_count );
+}
+
+/* Reads (media) data of a single cluster block at a specific offset into a buffer using a Basic File IO (bfio) handle
+ * The cluster block reference is the level 2 table entry of the cluster block
+ * The data is read up to the end of the cluster block, the end of the media or the end of the buffer
+ * This function does not change the current offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_cluster_block_data_by_reference(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint64_t cluster_block_reference,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value               = NULL;
+	libqcow_cluster_block_t *cluster_block           = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	static char *function                            = "libqcow_internal_file_read_cluster_block_data_by_reference";
+	size_t cluster_block_size                        = 0;
+	size_t compressed_cluster_block_size             = 0;
+	size_t read_size                                 = 0;
+	ssize_t read_count                               = 0;
+	uint64_t block_key                               = 0;
+	uint64_t cluster_block_file_offset               = 0;
+	uint64_t compressed_cluster_block_offset         = 0;
+	uint64_t cluster_block_offset                    = 0;
+	int cluster_block_is_compressed                  = 0;
+	int cluster_block_is_zero                        = 0;
+	int result                                       = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	/* The data of a raw external data file is stored at the (media) offset
+	 */
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+	{
+		read_count = libqcow_internal_file_read_raw_data_file_data(
+		              internal_file,
+		              offset,
+		              buffer,
+		              buffer_size,
+		              error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read data file data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		return( read_count );
+	}
+	cluster_block_file_offset = cluster_block_reference;
+
+	if( ( cluster_block_file_offset & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+	{
+		if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: simultaneous encryption and compression not supported.",
+			 function );
+
+			return( -1 );
+		}
+		cluster_block_is_compressed = 1;
+	}
+	else
+	{
+		cluster_block_is_compressed = 0;
+	}
+	if( ( cluster_block_is_compressed == 0 )
+	 && ( ( cluster_block_file_offset & internal_file->io_handle->zero_flag_bit_mask ) != 0 ) )
+	{
+		cluster_block_is_zero = 1;
+	}
+	else
+	{
+		cluster_block_is_zero = 0;
+	}
+	cluster_block_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+	/* The flags of a standard level 2 table entry, such as the zero flag, are stored
+	 * in the bits below the cluster block size and are not part of the offset
+	 */
+	if( cluster_block_is_compressed == 0 )
+	{
+		cluster_block_file_offset &= ~( internal_file->io_handle->subcluster_bit_mask );
+	}
+	/* With extended level 2 table entries the reference of a cluster block
+	 * that is not compressed refers to the subcluster that contains the offset
+	 */
+	if( cluster_block_is_compressed == 0 )
+	{
+		cluster_block_offset = offset & internal_file->io_handle->subcluster_bit_mask;
+
+		read_size = internal_file->io_handle->subcluster_size - (size_t) cluster_block_offset;
+	}
+	else
+	{
+		cluster_block_offset = offset & internal_file->io_handle->cluster_block_bit_mask;
+
+		read_size = internal_file->io_handle->cluster_block_size - (size_t) cluster_block_offset;
+	}
+
+	if( ( (size64_t) offset + read_size ) > internal_file->io_handle->media_size )
+	{
+		read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+	}
+	if( read_size > buffer_size )
+	{
+		read_size = buffer_size;
+	}
+	if( cluster_block_is_zero != 0 )
+	{
+		/* Handle zero cluster block, which does not fall through to the backing file
+		 */
+		if( memory_set(
+		     buffer,
+		     0,
+		     read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to set zero data in buffer.",
+			 function );
+
+			return( -1 );
+		}
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->sparse_bytes, read_size );
+	}
+	else if( cluster_block_file_offset == 0 )
+	{
+		/* Handle sparse cluster block
+		 */
+		if( libqcow_internal_file_read_backing_file_data(
+		     internal_file,
+		     offset,
+		     buffer,
+		     read_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read sparse cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->sparse_bytes, read_size );
+	}
+	else if( cluster_block_is_compressed != 0 )
+	{
+		/* Handle compressed cluster block
+		 */
+		if( libqcow_internal_file_get_compressed_cluster_block_range(
+		     internal_file,
+		     cluster_block_file_offset,
+		     &compressed_cluster_block_offset,
+		     &compressed_cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve compressed cluster block range.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_internal_file_bound_compressed_cluster_block_size(
+		     internal_file,
+		     offset,
+		     compressed_cluster_block_offset,
+		     &compressed_cluster_block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to bound compressed cluster block size.",
+			 function );
+
+			return( -1 );
+		}
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: compressed cluster block offset\t\t: 0x%08" PRIx64 "\n",
+			 function,
+			 compressed_cluster_block_offset );
+
+			libcnotify_printf(
+			 "%s: compressed cluster block size\t\t: %" PRIzd "\n",
+			 function,
+			 compressed_cluster_block_size );
+		}
+#endif
+		result = libqcow_internal_file_get_cached_value(
+		          internal_file,
+		          internal_file->compressed_cluster_block_cache,
+		          LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+		          (off64_t) compressed_cluster_block_offset,
+		          (intptr_t **) &cluster_block,
+		          &cache_value,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve compressed cluster block: 0x%08" PRIx64 " from cache.",
+			 function,
+			 compressed_cluster_block_offset );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->compressed_cluster_block_cache_hits, 1 );
+
+			if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECOMPRESSED ) == 0 )
+			{
+				/* Resume the decompression of a partially decompressed cluster block
+				 */
+				if( libqcow_cluster_block_decompress_range(
+				     cluster_block,
+				     internal_file->decompression_context,
+				     internal_file->io_handle->cluster_block_size,
+				     (size_t) cluster_block_offset,
+				     read_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+					 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+					 "%s: unable to decompress cluster block data at offset: 0x%08" PRIx64".",
+					 function,
+					 compressed_cluster_block_offset );
+
+					goto on_error;
+				}
+			}
+		}
+		else
+		{
+			LIBQCOW_STATISTICS_ADD( internal_file->statistics->compressed_cluster_block_cache_misses, 1 );
+
+			LIBQCOW_TRACE(
+			 cluster_block_miss,
+			 LIBQCOW_TRACE_EVENT_CLUSTER_BLOCK_MISS,
+			 compressed_cluster_block_offset,
+			 compressed_cluster_block_size,
+			 0 );
+
+			cluster_block = NULL;
+
+			if( libqcow_io_handle_get_cluster_block_pool(
+			     internal_file->io_handle,
+			     &cluster_block_pool,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve cluster block pool.",
+				 function );
+
+				return( -1 );
+			}
+			if( libqcow_cluster_block_initialize(
+			     &cluster_block,
+			     compressed_cluster_block_size,
+			     cluster_block_pool,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create cluster block.",
+				 function );
+
+				return( -1 );
+			}
+			cluster_block->statistics = internal_file->statistics;
+
+			if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+			{
+				cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA;
+			}
+			if( libqcow_internal_file_read_compressed_cluster_block(
+			     internal_file,
+			     file_io_handle,
+			     cluster_block,
+			     compressed_cluster_block_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read compressed cluster block at offset: 0x%08" PRIx64".",
+				 function,
+				 compressed_cluster_block_offset );
+
+				libqcow_cluster_block_free(
+				 &cluster_block,
+				 NULL );
+
+				return( -1 );
+			}
+			/* Only the data up to and including the requested data is decompressed,
+			 * the remainder is decompressed when it is requested
+			 */
+			if( libqcow_cluster_block_decompress_range(
+			     cluster_block,
+			     internal_file->decompression_context,
+			     internal_file->io_handle->cluster_block_size,
+			     (size_t) cluster_block_offset,
+			     read_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+				 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+				 "%s: unable to decompress cluster block data at offset: 0x%08" PRIx64".",
+				 function,
+				 compressed_cluster_block_offset );
+
+				libqcow_cluster_block_free(
+				 &cluster_block,
+				 NULL );
+
+				return( -1 );
+			}
+			/* Only cache the cluster block after it was successfully decompressed
+			 * so that a failed decompression is not served from the cache
+			 */
+			if( libqcow_internal_file_set_cached_value(
+			     internal_file,
+			     internal_file->compressed_cluster_block_cache,
+			     LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+			     (off64_t) compressed_cluster_block_offset,
+			     (intptr_t *) cluster_block,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set compressed cluster block: 0x%08" PRIx64 " in cache.",
+				 function,
+				 compressed_cluster_block_offset );
+
+				goto on_error;
+			}
+		}
+		if( memory_copy(
+		     buffer,
+		     &( cluster_block->data[ cluster_block_offset ] ),
+		     read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy cluster block data to buffer.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else if( cluster_block_file_offset > 0 )
+	{
+		read_count = libqcow_internal_file_read_contiguous_cluster_blocks(
+		              internal_file,
+		              file_io_handle,
+		              offset,
+		              cluster_block_file_offset,
+		              buffer,
+		              buffer_size,
+		              error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read contiguous cluster blocks at offset: 0x%08" PRIx64 ".",
+			 function,
+			 cluster_block_file_offset );
+
+			return( -1 );
+		}
+		else if( read_count > 0 )
+		{
+			return( read_count );
+		}
+		if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_CACHE ) != 0 )
+		{
+			result = libqcow_internal_file_read_cluster_block_data_directly(
+			          internal_file,
+			          file_io_handle,
+			          offset,
+			          cluster_block_file_offset,
+			          buffer,
+			          read_size,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block data directly at offset: 0x%08" PRIx64 ".",
+				 function,
+				 cluster_block_file_offset );
+
+				return( -1 );
+			}
+			else if( result != 0 )
+			{
+				return( (ssize_t) read_size );
+			}
+		}
+		/* With extended level 2 table entries the subcluster is read and cached
+		 */
+		cluster_block_size = internal_file->io_handle->subcluster_size;
+
+		/* For version 2 make sure the sure the last cluster block size
+		 * stays within the bounds of the size of the file
+		 */
+		if( ( ( internal_file->io_handle->format_version == 2 )
+		  ||  ( internal_file->io_handle->format_version == 3 ) )
+		 && ( ( cluster_block_file_offset + cluster_block_size ) > internal_file->size ) )
+		{
+			cluster_block_size = (size_t) ( internal_file->size - cluster_block_file_offset );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: last cluster block offset\t\t: 0x%08" PRIx64 "\n",
+				 function,
+				 cluster_block_file_offset );
+
+				libcnotify_printf(
+				 "%s: last cluster block size\t\t\t: %" PRIzd "\n",
+				 function,
+				 cluster_block_size );
+			}
+#endif
+		}
+		LIBQCOW_STATISTICS_ADD( internal_file->statistics->cluster_block_cache_lookups, 1 );
+
+		result = libqcow_internal_file_get_cached_value(
+		          internal_file,
+		          internal_file->cluster_block_cache,
+		          LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+		          (off64_t) cluster_block_file_offset,
+		          (intptr_t **) &cluster_block,
+		          &cache_value,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block: 0x%08" PRIx64 " from cache.",
+			 function,
+			 cluster_block_file_offset );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			/* A small read of a large cluster block that is not in the cache only reads
+			 * the requested data, unless it continues where the previous partial read ended
+			 */
+			if( ( cluster_block_size >= LIBQCOW_PARTIAL_READ_MINIMUM_CLUSTER_BLOCK_SIZE )
+			 && ( read_size <= LIBQCOW_PARTIAL_READ_MAXIMUM_READ_SIZE )
+			 && ( offset != internal_file->partial_read_end_offset ) )
+			{
+				result = libqcow_internal_file_read_cluster_block_data_directly(
+				          internal_file,
+				          file_io_handle,
+				          offset,
+				          cluster_block_file_offset,
+				          buffer,
+				          read_size,
+				          error );
+
+				if( result == -1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_READ_FAILED,
+					 "%s: unable to read partial cluster block data at offset: 0x%08" PRIx64 ".",
+					 function,
+					 cluster_block_file_offset );
+
+					return( -1 );
+				}
+				else if( result != 0 )
+				{
+					LIBQCOW_STATISTICS_ADD( internal_file->statistics->cluster_block_cache_misses, 1 );
+
+					LIBQCOW_TRACE(
+					 cluster_block_miss,
+					 LIBQCOW_TRACE_EVENT_CLUSTER_BLOCK_MISS,
+					 cluster_block_file_offset,
+					 read_size,
+					 0 );
+
+					internal_file->partial_read_end_offset = offset + (off64_t) read_size;
+
+					return( (ssize_t) read_size );
+				}
+			}
+			cluster_block = NULL;
+
+			if( libqcow_io_handle_read_cluster_block(
+			     internal_file->io_handle,
+			     file_io_handle,
+			     (off64_t) cluster_block_file_offset,
+			     cluster_block_size,
+			     &cluster_block,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block at offset: 0x%08" PRIx64 ".",
+				 function,
+				 cluster_block_file_offset );
+
+				return( -1 );
+			}
+			if( libqcow_internal_file_set_cached_value(
+			     internal_file,
+			     internal_file->cluster_block_cache,
+			     LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+			     (off64_t) cluster_block_file_offset,
+			     (intptr_t *) cluster_block,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set cluster block: 0x%08" PRIx64 " in cache.",
+				 function,
+				 cluster_block_file_offset );
+
+				goto on_error;
+			}
+		}
+		if( cluster_block == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: invalid cluster block.",
+			 function );
+
+			goto on_error;
+		}
+		if( cluster_block->data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: invalid cluster block - missing data.",
+			 function );
+
+			goto on_error;
+		}
+		if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+		{
+			if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_DECRYPTED ) == 0 )
+			{
+				if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_DISCARD_SOURCE_DATA ) != 0 )
+				{
+					cluster_block->flags |= LIBQCOW_CLUSTER_BLOCK_FLAG_DISCARD_SOURCE_DATA;
+				}
+				/* LUKS uses the sector number in the file instead of the media
+				 */
+				if( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_LUKS )
+				{
+					block_key = cluster_block_file_offset / 512;
+				}
+				else
+				{
+					block_key = (uint64_t) ( offset - cluster_block_offset ) / 512;
+				}
+				/* Only the sectors that contain the requested data are decrypted
+				 */
+				if( libqcow_cluster_block_decrypt_sectors(
+				     cluster_block,
+				     internal_file->encryption_context,
+				     block_key,
+				     (size_t) cluster_block_offset,
+				     read_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
 					 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
-					 "%s: unable to decompress cluster block data at offset: 0x%08" PRIx64".",
+					 "%s: unable to decrypt cluster block data.",
+					 function );
+
+					goto on_error;
+				}
+			}
+		}
+		if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_ZERO ) != 0 )
+		{
+			if( memory_set(
+			     buffer,
+			     0,
+			     read_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to set zero data in buffer.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		else if( memory_copy(
+		          buffer,
+		          &( cluster_block->data[ cluster_block_offset ] ),
+		          read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy cluster block data to buffer.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_internal_file_release_cached_value(
+	     internal_file,
+	     &cache_value,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cluster block in cache.",
+		 function );
+
+		return( -1 );
+	}
+	return( (ssize_t) read_size );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads (media) data of a single cluster block at a specific offset into a buffer using a Basic File IO (bfio) handle
+ * This function is used for files without encryption and external data file, where
+ * a read within an allocated cluster block that is in the cache is a lookup and a copy,
+ * other cluster blocks are read by libqcow_internal_file_read_cluster_block_data_by_reference
+ * The data is read up to the end of the cluster block, the end of the media or the end of the buffer
+ * This function does not change the current offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_plaintext_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value     = NULL;
+	libqcow_cluster_block_t *cluster_block = NULL;
+	libqcow_io_handle_t *io_handle         = NULL;
+	static char *function                  = "libqcow_internal_file_read_plaintext_cluster_block_data";
+	size_t read_size                       = 0;
+	ssize_t read_count                     = 0;
+	uint64_t cluster_block_file_offset     = 0;
+	uint64_t cluster_block_offset          = 0;
+	uint64_t cluster_block_reference       = 0;
+	int result                             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	io_handle = internal_file->io_handle;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cluster_block_reference(
+	     internal_file,
+	     file_io_handle,
+	     offset,
+	     &cluster_block_reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	if( ( cluster_block_reference & ( io_handle->compression_flag_bit_mask | io_handle->zero_flag_bit_mask ) ) == 0 )
+	{
+		cluster_block_file_offset = cluster_block_reference & io_handle->offset_bit_mask & ~( io_handle->subcluster_bit_mask );
+		cluster_block_offset      = offset & io_handle->subcluster_bit_mask;
+
+		read_size = io_handle->subcluster_size - (size_t) cluster_block_offset;
+
+		/* A read that continues in the next cluster block is left to the contiguous read
+		 */
+		if( ( cluster_block_file_offset != 0 )
+		 && ( buffer_size <= read_size ) )
+		{
+			read_size = buffer_size;
+
+			if( ( (size64_t) offset + read_size ) > io_handle->media_size )
+			{
+				read_size = (size_t) ( io_handle->media_size - offset );
+			}
+			result = libqcow_internal_file_get_cached_value(
+			          internal_file,
+			          internal_file->cluster_block_cache,
+			          LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+			          (off64_t) cluster_block_file_offset,
+			          (intptr_t **) &cluster_block,
+			          &cache_value,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve cluster block: 0x%08" PRIx64 " from cache.",
+				 function,
+				 cluster_block_file_offset );
+
+				return( -1 );
+			}
+			else if( ( result != 0 )
+			      && ( cluster_block != NULL )
+			      && ( cluster_block->data != NULL ) )
+			{
+				LIBQCOW_STATISTICS_ADD( internal_file->statistics->cluster_block_cache_lookups, 1 );
+
+				if( ( cluster_block->flags & LIBQCOW_CLUSTER_BLOCK_FLAG_IS_ZERO ) != 0 )
+				{
+					if( memory_set(
+					     buffer,
+					     0,
+					     read_size ) == NULL )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_MEMORY,
+						 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+						 "%s: unable to set zero data in buffer.",
+						 function );
+
+						goto on_error;
+					}
+				}
+				else if( memory_copy(
+				          buffer,
+				          &( cluster_block->data[ cluster_block_offset ] ),
+				          read_size ) == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+					 "%s: unable to copy cluster block data to buffer.",
+					 function );
+
+					goto on_error;
+				}
+				if( libqcow_internal_file_release_cached_value(
+				     internal_file,
+				     &cache_value,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to release cluster block in cache.",
+					 function );
+
+					return( -1 );
+				}
+				return( (ssize_t) read_size );
+			}
+			if( libqcow_internal_file_release_cached_value(
+			     internal_file,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release cluster block in cache.",
+				 function );
+
+				return( -1 );
+			}
+		}
+	}
+	read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+	              internal_file,
+	              file_io_handle,
+	              offset,
+	              cluster_block_reference,
+	              buffer,
+	              buffer_size,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	return( read_count );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Selects the function that reads the data of a single cluster block
+ * The checks that only depend on the configuration of the file, such as
+ * the encryption method and the external data file, are done once here
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_select_read_function(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_select_read_function";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file->read_cluster_block_data = &libqcow_internal_file_read_cluster_block_data;
+
+	/* The cache is bypassed when the no cache read flag is set
+	 */
+	if( ( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE )
+	 && ( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) == 0 )
+	 && ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_NO_CACHE ) == 0 ) )
+	{
+		internal_file->read_cluster_block_data = &libqcow_internal_file_read_plaintext_cluster_block_data;
+	}
+	return( 1 );
+}
+
+/* Replaces the (media) data that was read at a specific offset with the data in the scratch overlay
+ * The scratch overlay is protected by the cache mutex since reading the scratch file is not
+ * multi-thread safe
+ * The zero bitmap is optional
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_scratch_overlay(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_read_scratch_overlay";
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->scratch_overlay == NULL )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_scratch_overlay_read_buffer_at_offset(
+	     internal_file->scratch_overlay,
+	     offset,
+	     buffer,
+	     buffer_size,
+	     zero_bitmap,
+	     zero_bitmap_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read scratch overlay at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Reads (media) data of a single cluster block at a specific offset from the memory map
+ * without holding the cache mutex
+ * This function is used for memory mapped files without encryption and external data file,
+ * which are opened read-only, where the cluster block reference is looked up in
+ * the translation cache, which can be read without a lock, and the data is copied
+ * from the memory map, which does not change while the file is open
+ * The data is read up to the end of the cluster block, the end of the media or the end of the buffer
+ * This function does not change the current offset
+ * Returns the number of bytes read, 0 if the data cannot be read without the cache mutex or -1 on error
+ */
+ssize_t libqcow_internal_file_read_mapped_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_io_handle_t *io_handle     = NULL;
+	static char *function              = "libqcow_internal_file_read_mapped_cluster_block_data";
+	size_t read_size                   = 0;
+	uint64_t cluster_block_file_offset = 0;
+	uint64_t cluster_block_offset      = 0;
+	uint64_t cluster_block_reference   = 0;
+	uint64_t translation_index         = 0;
+	int result                         = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	io_handle = internal_file->io_handle;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->memory_map == NULL )
+	 || ( internal_file->memory_map->data == NULL )
+	 || ( internal_file->translation_cache == NULL ) )
+	{
+		return( 0 );
+	}
+	if( io_handle->number_of_level2_table_entry_bits > 3 )
+	{
+		translation_index = (uint64_t) offset >> io_handle->number_of_subcluster_bits;
+	}
+	else
+	{
+		translation_index = (uint64_t) offset >> io_handle->number_of_cluster_block_bits;
+	}
+	result = libqcow_translation_cache_get_reference(
+	          internal_file->translation_cache,
+	          translation_index,
+	          &cluster_block_reference,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block reference from translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		return( 0 );
+	}
+	/* Compressed, zero and unallocated cluster blocks are left to the read that holds the cache mutex
+	 */
+	if( ( cluster_block_reference & ( io_handle->compression_flag_bit_mask | io_handle->zero_flag_bit_mask ) ) != 0 )
+	{
+		return( 0 );
+	}
+	cluster_block_file_offset = cluster_block_reference & io_handle->offset_bit_mask & ~( io_handle->subcluster_bit_mask );
+	cluster_block_offset      = offset & io_handle->subcluster_bit_mask;
+
+	if( cluster_block_file_offset == 0 )
+	{
+		return( 0 );
+	}
+	read_size = io_handle->subcluster_size - (size_t) cluster_block_offset;
+
+	if( read_size > buffer_size )
+	{
+		read_size = buffer_size;
+	}
+	if( ( (size64_t) offset + read_size ) > io_handle->media_size )
+	{
+		read_size = (size_t) ( io_handle->media_size - offset );
+	}
+	/* A cluster block beyond the end of the file is left to the read that holds
+	 * the cache mutex, which reports the error
+	 */
+	if( ( cluster_block_file_offset + cluster_block_offset ) > (uint64_t) internal_file->memory_map->data_size )
+	{
+		return( 0 );
+	}
+	if( read_size > ( internal_file->memory_map->data_size - (size_t) ( cluster_block_file_offset + cluster_block_offset ) ) )
+	{
+		return( 0 );
+	}
+	if( memory_copy(
+	     buffer,
+	     &( internal_file->memory_map->data[ cluster_block_file_offset + cluster_block_offset ] ),
+	     read_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy cluster block data to buffer.",
+		 function );
+
+		return( -1 );
+	}
+	return( (ssize_t) read_size );
+}
+
+/* Reads (media) data at a specific offset into a buffer using a Basic File IO (bfio) handle
+ * This function does not change the current offset
+ * The caches are protected by the cache mutex so that this function can be
+ * called concurrently while holding the read/write lock for reading, except
+ * for cluster blocks that are read from the memory map without a lock
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	static char *function     = "libqcow_internal_file_read_buffer_at_offset_from_file_io_handle";
+	size64_t media_size       = 0;
+	size_t buffer_offset      = 0;
+	size_t cluster_block_size = 0;
+	ssize_t read_count        = 0;
+	int use_io_uring          = 0;
+	int use_memory_map        = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int result                = 0;
+	int use_worker_threads    = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	/* The values that do not change during the read are determined once
+	 */
+	media_size         = internal_file->io_handle->media_size;
+	cluster_block_size = internal_file->io_handle->cluster_block_size;
+
+	/* Only read asynchronously or in parallel if the data is not stored in an external data file
+	 */
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) == 0 )
+	{
+		/* The memory map is only available when the file is opened read-only
+		 */
+		if( ( internal_file->memory_map != NULL )
+		 && ( internal_file->metadata_index == NULL )
+		 && ( internal_file->encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE ) )
+		{
+			use_memory_map = 1;
+		}
+		if( internal_file->io_uring != NULL )
+		{
+			use_io_uring = 1;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( internal_file->number_of_worker_threads > 0 )
+		{
+			use_worker_threads = 1;
+		}
+#endif
+	}
+	while( buffer_offset < buffer_size )
+	{
+		if( (size64_t) offset >= media_size )
+		{
+			break;
+		}
+		/* A cluster block that was recently looked up is copied from the memory map
+		 * without holding the cache mutex
+		 */
+		if( use_memory_map != 0 )
+		{
+			read_count = libqcow_internal_file_read_mapped_cluster_block_data(
+			              internal_file,
+			              offset,
+			              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+			              buffer_size - buffer_offset,
+			              error );
+
+			if( read_count == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read mapped cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			else if( read_count > 0 )
+			{
+				offset        += (off64_t) read_count;
+				buffer_offset += (size_t) read_count;
+
+				continue;
+			}
+		}
+		/* Only read asynchronously if the read spans multiple cluster blocks
+		 */
+		if( ( use_io_uring != 0 )
+		 && ( ( buffer_size - buffer_offset ) > cluster_block_size ) )
+		{
+			read_count = libqcow_internal_file_read_cluster_blocks_asynchronously(
+			              internal_file,
+			              file_io_handle,
+			              offset,
+			              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+			              buffer_size - buffer_offset,
+			              error );
+
+			if( read_count == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster blocks asynchronously at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			else if( read_count > 0 )
+			{
+				offset        += (off64_t) read_count;
+				buffer_offset += (size_t) read_count;
+
+				continue;
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		/* Only decompress or decrypt in parallel if the read spans multiple cluster blocks
+		 */
+		if( ( use_worker_threads != 0 )
+		 && ( ( buffer_size - buffer_offset ) > cluster_block_size ) )
+		{
+			read_count = libqcow_internal_file_read_cluster_blocks_in_parallel(
+			              internal_file,
+			              file_io_handle,
+			              offset,
+			              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+			              buffer_size - buffer_offset,
+			              error );
+
+			if( read_count == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster blocks in parallel at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			else if( read_count > 0 )
+			{
+				offset        += (off64_t) read_count;
+				buffer_offset += (size_t) read_count;
+
+				continue;
+			}
+		}
+		if( libqcow_trace_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		read_count = internal_file->read_cluster_block_data(
+		              internal_file,
+		              file_io_handle,
+		              offset,
+		              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+		              buffer_size - buffer_offset,
+		              error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		else if( read_count == 0 )
+		{
+			break;
+		}
+		offset        += (off64_t) read_count;
+		buffer_offset += (size_t) read_count;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "\n" );
+		}
+#endif
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The data is not read ahead when the file is memory mapped
+	 */
+	if( ( buffer_offset > 0 )
+	 && ( internal_file->memory_map == NULL ) )
+	{
+		if( libqcow_trace_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+		result = libqcow_internal_file_update_read_ahead(
+		          internal_file,
+		          offset - (off64_t) buffer_offset,
+		          buffer_offset,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update read-ahead.",
+			 function );
+		}
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+		if( result != 1 )
+		{
+			return( -1 );
+		}
+	}
+#endif
+	if( ( internal_file->scratch_overlay != NULL )
+	 && ( buffer_offset > 0 ) )
+	{
+		if( libqcow_internal_file_read_scratch_overlay(
+		     internal_file,
+		     offset - (off64_t) buffer_offset,
+		     (uint8_t *) buffer,
+		     buffer_offset,
+		     NULL,
+		     0,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read scratch overlay.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->bytes_returned, buffer_offset );
+
+	return( (ssize_t) buffer_offset );
+}
+
+/* Marks the sectors of a zero bitmap that are fully contained in a range of the buffer
+ * The range start and end are relative to the start of the buffer
+ * The last sector of the data that was read can be smaller than the sector size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_set_zero_bitmap_range(
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     size_t range_start,
+     size_t range_end,
+     size_t read_size,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_internal_file_set_zero_bitmap_range";
+	size_t last_sector_index = 0;
+	size_t sector_index      = 0;
+
+	if( zero_bitmap == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid zero bitmap.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( range_start > range_end )
+	 || ( range_end > read_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid range value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	sector_index      = ( range_start + LIBQCOW_ZERO_BITMAP_SECTOR_SIZE - 1 ) / LIBQCOW_ZERO_BITMAP_SECTOR_SIZE;
+	last_sector_index = range_end / LIBQCOW_ZERO_BITMAP_SECTOR_SIZE;
+
+	if( ( range_end == read_size )
+	 && ( ( range_end % LIBQCOW_ZERO_BITMAP_SECTOR_SIZE ) != 0 ) )
+	{
+		last_sector_index += 1;
+	}
+	if( ( ( last_sector_index + 7 ) / 8 ) > zero_bitmap_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+		 "%s: invalid zero bitmap size value too small.",
+		 function );
+
+		return( -1 );
+	}
+	while( sector_index < last_sector_index )
+	{
+		zero_bitmap[ sector_index / 8 ] |= (uint8_t) ( 1 << ( sector_index % 8 ) );
+
+		sector_index++;
+	}
+	return( 1 );
+}
+
+/* Reads (media) data at a specific offset into a buffer using a Basic File IO (bfio) handle
+ * and marks the sectors of the buffer that read as zero in the zero bitmap
+ * The level 2 table entry of a cluster block is looked up once and used both
+ * to read the data and to determine if the data reads as zero
+ * The zero bitmap is optional and must be cleared by the caller
+ * This function does not change the current offset
+ * The caches are protected by the cache mutex so that this function can be
+ * called concurrently while holding the read/write lock for reading
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_buffer_at_offset_with_zero_bitmap_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         uint8_t *zero_bitmap,
+         size_t zero_bitmap_size,
+         libcerror_error_t **error )
+{
+	static char *function              = "libqcow_internal_file_read_buffer_at_offset_with_zero_bitmap_from_file_io_handle";
+	size64_t media_size                = 0;
+	size_t buffer_offset               = 0;
+	size_t zero_range_start            = 0;
+	ssize_t read_count                 = 0;
+	uint64_t cluster_block_file_offset = 0;
+	uint64_t cluster_block_reference   = 0;
+	uint32_t cluster_block_flags       = 0;
+	int has_backing_file               = 0;
+	int has_data_file                  = 0;
+	int in_zero_range                  = 0;
+	int is_zero                        = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	media_size = internal_file->io_handle->media_size;
+
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+	{
+		has_data_file = 1;
+	}
+	/* Unallocated cluster blocks only read as zero if there is no backing file
+	 */
+	if( ( internal_file->parent_file != NULL )
+	 || ( internal_file->io_handle->backing_filename != NULL ) )
+	{
+		has_backing_file = 1;
+	}
+	while( buffer_offset < buffer_size )
+	{
+		if( (size64_t) offset >= media_size )
+		{
+			break;
+		}
+		is_zero = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libqcow_trace_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		/* The data of a raw external data file has no zero or unallocated cluster blocks
+		 */
+		if( has_data_file != 0 )
+		{
+			read_count = internal_file->read_cluster_block_data(
+			              internal_file,
+			              file_io_handle,
+			              offset,
+			              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+			              buffer_size - buffer_offset,
+			              error );
+		}
+		else
+		{
+			read_count = -1;
+
+			if( libqcow_internal_file_get_cluster_block_reference(
+			     internal_file,
+			     file_io_handle,
+			     offset,
+			     &cluster_block_reference,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+			}
+			else
+			{
+				read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+				              internal_file,
+				              file_io_handle,
+				              offset,
+				              cluster_block_reference,
+				              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+				              buffer_size - buffer_offset,
+				              error );
+			}
+			/* The extent values are determined after the read so that a cluster block
+			 * that was detected to be zero when it was cached by the read is included
+			 */
+			if( read_count > 0 )
+			{
+				if( libqcow_internal_file_get_cluster_block_extent_values(
+				     internal_file,
+				     cluster_block_reference,
+				     &cluster_block_file_offset,
+				     &cluster_block_flags,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve extent values for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+					 function,
+					 offset,
+					 offset );
+
+					read_count = -1;
+				}
+				else if( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) != 0 )
+				{
+					is_zero = 1;
+				}
+				else if( ( has_backing_file == 0 )
+				      && ( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) == 0 )
+				      && ( ( cluster_block_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 ) )
+				{
+					is_zero = 1;
+				}
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+		else if( read_count == 0 )
+		{
+			break;
+		}
+		/* Consecutive zero cluster blocks are combined into a single range
+		 * so that sectors that span cluster blocks are marked as well
+		 */
+		if( is_zero != 0 )
+		{
+			if( in_zero_range == 0 )
+			{
+				zero_range_start = buffer_offset;
+				in_zero_range    = 1;
+			}
+		}
+		else if( in_zero_range != 0 )
+		{
+			if( zero_bitmap != NULL )
+			{
+				if( libqcow_internal_file_set_zero_bitmap_range(
+				     zero_bitmap,
+				     zero_bitmap_size,
+				     zero_range_start,
+				     buffer_offset,
+				     buffer_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set zero bitmap range.",
+					 function );
+
+					return( -1 );
+				}
+			}
+			in_zero_range = 0;
+		}
+		offset        += (off64_t) read_count;
+		buffer_offset += (size_t) read_count;
+	}
+	if( ( in_zero_range != 0 )
+	 && ( zero_bitmap != NULL ) )
+	{
+		if( libqcow_internal_file_set_zero_bitmap_range(
+		     zero_bitmap,
+		     zero_bitmap_size,
+		     zero_range_start,
+		     buffer_offset,
+		     buffer_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set zero bitmap range.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	/* The sectors that were written to the scratch overlay no longer read as zero
+	 */
+	if( ( internal_file->scratch_overlay != NULL )
+	 && ( buffer_offset > 0 ) )
+	{
+		if( libqcow_internal_file_read_scratch_overlay(
+		     internal_file,
+		     offset - (off64_t) buffer_offset,
+		     (uint8_t *) buffer,
+		     buffer_offset,
+		     zero_bitmap,
+		     zero_bitmap_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read scratch overlay.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	LIBQCOW_STATISTICS_ADD( internal_file->statistics->bytes_returned, buffer_offset );
+
+	return( (ssize_t) buffer_offset );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The read-ahead thread function
+ * Reads the cluster blocks that were requested by libqcow_internal_file_update_read_ahead
+ * and the level 2 tables and cluster blocks of an imported cache state
+ * into the caches until the read-ahead is stopped
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_ahead_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error               = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_io_scheduler_t *io_scheduler   = NULL;
+	uint8_t *cluster_block_data            = NULL;
+	static char *function                  = "libqcow_internal_file_read_ahead_thread_function";
+	ssize_t read_count                     = 0;
+	off64_t offset                         = 0;
+	uint8_t offset_type                    = 0;
+	int is_pending                         = 0;
+	int number_of_offsets                  = 0;
+	int result                             = 1;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) arguments;
+
+	if( libqcow_internal_file_get_io_scheduler(
+	     internal_file,
+	     &io_scheduler,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	cluster_block_data = (uint8_t *) memory_allocate(
+	                                  sizeof( uint8_t ) * internal_file->io_handle->cluster_block_size );
+
+	if( cluster_block_data == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block data.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	while( internal_file->abort_read_ahead == 0 )
+	{
+		if( ( internal_file->read_ahead_offset >= internal_file->read_ahead_end_offset )
+		 && ( internal_file->prefetch_cache_state == NULL ) )
+		{
+			if( libcthreads_condition_wait(
+			     internal_file->read_ahead_condition,
+			     internal_file->cache_mutex,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to wait for read-ahead condition.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+			continue;
+		}
+		/* The read-ahead of sequential reads precedes the cache state
+		 * imported by libqcow_file_import_cache_state
+		 */
+		if( internal_file->read_ahead_offset < internal_file->read_ahead_end_offset )
+		{
+			offset = internal_file->read_ahead_offset;
+
+			internal_file->read_ahead_offset += internal_file->io_handle->cluster_block_size;
+
+			/* Cluster blocks that are read ahead are cached with a low priority
+			 * unless they were requested by libqcow_file_advise
+			 */
+			if( offset >= internal_file->read_ahead_advised_end_offset )
+			{
+				internal_file->is_reading_ahead = 1;
+			}
+			read_count = internal_file->read_cluster_block_data(
+			              internal_file,
+			              internal_file->file_io_handle,
+			              offset,
+			              cluster_block_data,
+			              internal_file->io_handle->cluster_block_size,
+			              &error );
+
+			internal_file->is_reading_ahead = 0;
+
+			if( read_count == -1 )
+			{
+				/* Reading ahead is best effort, a read error is reported by the read itself
+				 */
+				libcerror_error_free(
+				 &error );
+
+				internal_file->read_ahead_end_offset = internal_file->read_ahead_offset;
+			}
+		}
+		else
+		{
+			if( libqcow_cache_state_get_number_of_offsets(
+			     internal_file->prefetch_cache_state,
+			     &number_of_offsets,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve number of prefetch offsets.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+			if( internal_file->prefetch_offset_index < number_of_offsets )
+			{
+				if( libqcow_cache_state_get_offset_by_index(
+				     internal_file->prefetch_cache_state,
+				     internal_file->prefetch_offset_index,
+				     &offset_type,
+				     &offset,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve prefetch offset: %d.",
+					 function,
+					 internal_file->prefetch_offset_index );
+
+					result = -1;
+
+					break;
+				}
+				internal_file->prefetch_offset_index += 1;
+
+				/* The cluster blocks of the cache state were read before
+				 * and are cached with a normal priority
+				 */
+				if( libqcow_internal_file_read_cache_state_offset(
+				     internal_file,
+				     offset_type,
+				     offset,
+				     cluster_block_data,
+				     &error ) != 1 )
+				{
+					libcerror_error_free(
+					 &error );
+				}
+			}
+			if( internal_file->prefetch_offset_index >= number_of_offsets )
+			{
+				if( libqcow_cache_state_free(
+				     &( internal_file->prefetch_cache_state ),
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free prefetch cache state.",
+					 function );
+
+					result = -1;
+
+					break;
+				}
+				internal_file->prefetch_offset_index = 0;
+			}
+		}
+		is_pending = (int) ( ( internal_file->read_ahead_offset < internal_file->read_ahead_end_offset )
+		                  || ( internal_file->prefetch_cache_state != NULL ) );
+
+		/* Give a pending read the opportunity to grab the cache mutex
+		 */
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			goto on_error;
+		}
+		/* Reading ahead is background IO, it yields to queued read requests
+		 * and is subject to the IO limits of the background IO priority
+		 */
+		if( is_pending != 0 )
+		{
+			if( libqcow_io_scheduler_acquire(
+			     io_scheduler,
+			     LIBQCOW_IO_PRIORITY_BACKGROUND,
+			     internal_file->io_handle->cluster_block_size,
+			     &( internal_file->abort_read_ahead ),
+			     &error ) == -1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to acquire IO scheduler.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 cluster_block_data );
+
+	if( error != NULL )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+	}
+	return( result );
+
+on_error:
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+	}
+#endif
+	libcerror_error_free(
+	 &error );
+
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+	return( -1 );
+}
+
+/* Updates the read-ahead after a read of the (media) data
+ * A read that starts where the previous read ended is considered sequential,
+ * the read-ahead window doubles with every sequential read up to a maximum
+ * and any other read stops the read-ahead
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_update_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size_t read_size,
+     libcerror_error_t **error )
+{
+	static char *function         = "libqcow_internal_file_update_read_ahead";
+	off64_t end_offset            = 0;
+	off64_t read_ahead_end_offset = 0;
+	int maximum_window            = 0;
+	int is_sequential             = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( read_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid read size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	/* Read-ahead only makes sense when the data is cached
+	 */
+	if( ( internal_file->read_flags & ( LIBQCOW_READ_FLAG_NO_CACHE | LIBQCOW_READ_FLAG_NO_READ_AHEAD ) ) != 0 )
+	{
+		return( 1 );
+	}
+	/* When the file is memory mapped read-ahead is left to the operating system
+	 */
+	if( internal_file->memory_map != NULL )
+	{
+		return( 1 );
+	}
+	/* When random access was advised reading ahead would only evict cached data
+	 */
+	if( internal_file->access_advice == LIBQCOW_ADVICE_RANDOM )
+	{
+		return( 1 );
+	}
+	is_sequential = (int) ( offset == internal_file->read_ahead_expected_offset );
+	end_offset    = offset + (off64_t) read_size;
+
+	internal_file->read_ahead_expected_offset = end_offset;
+
+	if( is_sequential == 0 )
+	{
+		internal_file->read_ahead_window = 0;
+
+		/* A read-ahead that was requested by advice is not stopped by a non-sequential read
+		 */
+		if( internal_file->read_ahead_offset >= internal_file->read_ahead_advised_end_offset )
+		{
+			internal_file->read_ahead_end_offset = internal_file->read_ahead_offset;
+		}
+		return( 1 );
+	}
+	/* Do not read ahead more cluster blocks than half of the cache can hold
+	 * so that the read-ahead does not evict the data it has read ahead
+	 */
+	maximum_window = internal_file->maximum_number_of_cluster_block_cache_entries / 2;
+
+	if( maximum_window > LIBQCOW_MAXIMUM_READ_AHEAD_CLUSTER_BLOCKS )
+	{
+		maximum_window = LIBQCOW_MAXIMUM_READ_AHEAD_CLUSTER_BLOCKS;
+	}
+	if( maximum_window < 1 )
+	{
+		return( 1 );
+	}
+	/* When sequential access was advised the read-ahead window starts at the maximum
+	 */
+	if( internal_file->access_advice == LIBQCOW_ADVICE_SEQUENTIAL )
+	{
+		internal_file->read_ahead_window = maximum_window;
+	}
+	else if( internal_file->read_ahead_window == 0 )
+	{
+		internal_file->read_ahead_window = 1;
+	}
+	else if( internal_file->read_ahead_window < maximum_window )
+	{
+		internal_file->read_ahead_window *= 2;
+	}
+	if( internal_file->read_ahead_window > maximum_window )
+	{
+		internal_file->read_ahead_window = maximum_window;
+	}
+	end_offset &= ~( (off64_t) internal_file->io_handle->cluster_block_bit_mask );
+
+	if( internal_file->read_ahead_offset < end_offset )
+	{
+		internal_file->read_ahead_offset = end_offset;
+	}
+	read_ahead_end_offset = end_offset
+	                      + ( (off64_t) internal_file->read_ahead_window * internal_file->io_handle->cluster_block_size );
+
+	if( (size64_t) read_ahead_end_offset > internal_file->io_handle->media_size )
+	{
+		read_ahead_end_offset = (off64_t) internal_file->io_handle->media_size;
+	}
+	if( internal_file->read_ahead_end_offset >= read_ahead_end_offset )
+	{
+		return( 1 );
+	}
+	internal_file->read_ahead_end_offset = read_ahead_end_offset;
+
+	if( libqcow_internal_file_start_read_ahead(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to start read-ahead.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Starts the read-ahead thread, if not already running, and signals it
+ * to read the cluster blocks up to the read-ahead end offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_start_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_start_read_ahead";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	/* The read-ahead thread reads the file IO handle without the read/write lock
+	 * and therefore is not used when the file is opened for writing
+	 */
+	if( internal_file->write_cache != NULL )
+	{
+		return( 1 );
+	}
+	if( internal_file->read_ahead_thread == NULL )
+	{
+		if( libcthreads_thread_create(
+		     &( internal_file->read_ahead_thread ),
+		     NULL,
+		     &libqcow_internal_file_read_ahead_thread_function,
+		     (void *) internal_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create read-ahead thread.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( libcthreads_condition_signal(
+	     internal_file->read_ahead_condition,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to signal read-ahead condition.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Stops the read-ahead thread and resets the read-ahead
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_stop_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_stop_read_ahead";
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->read_ahead_thread != NULL )
+	{
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+		internal_file->abort_read_ahead = 1;
+
+		if( libcthreads_condition_broadcast(
+		     internal_file->read_ahead_condition,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to broadcast read-ahead condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+		if( libcthreads_thread_join(
+		     &( internal_file->read_ahead_thread ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join read-ahead thread.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( internal_file->prefetch_cache_state != NULL )
+	{
+		if( libqcow_cache_state_free(
+		     &( internal_file->prefetch_cache_state ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free prefetch cache state.",
+			 function );
+
+			result = -1;
+		}
+	}
+	internal_file->read_ahead_expected_offset    = 0;
+	internal_file->read_ahead_offset             = 0;
+	internal_file->read_ahead_end_offset         = 0;
+	internal_file->read_ahead_advised_end_offset = 0;
+	internal_file->read_ahead_window             = 0;
+	internal_file->abort_read_ahead              = 0;
+	internal_file->prefetch_offset_index         = 0;
+
+	return( result );
+}
+
+/* Determines the NUMA topology used to place the worker threads and cluster block buffers
+ * The topology is only retained if the system has more than one NUMA node
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_initialize_numa_placement(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_initialize_numa_placement";
+	int number_of_nodes   = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->numa_topology != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - NUMA topology value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_numa_topology_initialize(
+	     &( internal_file->numa_topology ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create NUMA topology.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_numa_topology_get_number_of_nodes(
+	     internal_file->numa_topology,
+	     &number_of_nodes,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of NUMA nodes.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_nodes <= 1 )
+	{
+		if( libqcow_numa_topology_free(
+		     &( internal_file->numa_topology ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free NUMA topology.",
+			 function );
+
+			goto on_error;
+		}
+		number_of_nodes = 0;
+	}
+	internal_file->number_of_numa_nodes = number_of_nodes;
+
+	return( 1 );
+
+on_error:
+	if( internal_file->numa_topology != NULL )
+	{
+		libqcow_numa_topology_free(
+		 &( internal_file->numa_topology ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Creates the cluster block pools of the NUMA nodes other than the first node
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_initialize_numa_cluster_block_pools(
+     libqcow_internal_file_t *internal_file,
+     int maximum_number_of_buffers,
+     int maximum_number_of_arena_slots,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_initialize_numa_cluster_block_pools";
+	int node_index        = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->numa_cluster_block_pools != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - NUMA cluster block pools value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->number_of_numa_nodes <= 1 )
+	 || ( internal_file->number_of_numa_nodes > LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_NODES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - number of NUMA nodes value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file->numa_cluster_block_pools = (libqcow_cluster_block_pool_t **) memory_allocate(
+	                                                                             sizeof( libqcow_cluster_block_pool_t * ) * internal_file->number_of_numa_nodes );
+
+	if( internal_file->numa_cluster_block_pools == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create NUMA cluster block pools.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_file->numa_cluster_block_pools,
+	     0,
+	     sizeof( libqcow_cluster_block_pool_t * ) * internal_file->number_of_numa_nodes ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear NUMA cluster block pools.",
+		 function );
+
+		goto on_error;
+	}
+	for( node_index = 1;
+	     node_index < internal_file->number_of_numa_nodes;
+	     node_index++ )
+	{
+		if( libqcow_cluster_block_pool_initialize(
+		     &( internal_file->numa_cluster_block_pools[ node_index ] ),
+		     internal_file->io_handle->cluster_block_size,
+		     maximum_number_of_buffers,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create cluster block pool of NUMA node: %d.",
+			 function,
+			 node_index );
+
+			goto on_error;
+		}
+		if( maximum_number_of_arena_slots > 0 )
+		{
+			if( libqcow_cluster_block_pool_initialize_arena(
+			     internal_file->numa_cluster_block_pools[ node_index ],
+			     maximum_number_of_arena_slots,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create cluster block pool arena of NUMA node: %d.",
+				 function,
+				 node_index );
+
+				goto on_error;
+			}
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( internal_file->numa_cluster_block_pools != NULL )
+	{
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( internal_file->numa_cluster_block_pools[ node_index ] != NULL )
+			{
+				libqcow_cluster_block_pool_free(
+				 &( internal_file->numa_cluster_block_pools[ node_index ] ),
+				 NULL );
+			}
+		}
+		memory_free(
+		 internal_file->numa_cluster_block_pools );
+
+		internal_file->numa_cluster_block_pools = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees the NUMA topology and the cluster block pools of the NUMA nodes
+ * The cluster block pools are freed after the cluster block caches since
+ * the cached cluster blocks release their buffers to the pools
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_free_numa_placement(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_free_numa_placement";
+	int node_index        = 0;
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->numa_cluster_block_pools != NULL )
+	{
+		if( ( internal_file->io_handle != NULL )
+		 && ( internal_file->io_handle->numa_cluster_block_pools == internal_file->numa_cluster_block_pools ) )
+		{
+			internal_file->io_handle->numa_topology            = NULL;
+			internal_file->io_handle->numa_cluster_block_pools = NULL;
+		}
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( internal_file->numa_cluster_block_pools[ node_index ] != NULL )
+			{
+				if( libqcow_cluster_block_pool_free(
+				     &( internal_file->numa_cluster_block_pools[ node_index ] ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free cluster block pool of NUMA node: %d.",
+					 function,
+					 node_index );
+
+					result = -1;
+				}
+			}
+		}
+		memory_free(
+		 internal_file->numa_cluster_block_pools );
+
+		internal_file->numa_cluster_block_pools = NULL;
+	}
+	if( internal_file->numa_topology != NULL )
+	{
+		if( libqcow_numa_topology_free(
+		     &( internal_file->numa_topology ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free NUMA topology.",
+			 function );
+
+			result = -1;
+		}
+	}
+	internal_file->number_of_numa_nodes = 0;
+
+	return( result );
+}
+
+/* Starts the worker thread pool if not already started
+ * Every worker thread is provided with a decompression context by
+ * the decompression context queue
+ * With NUMA placement the worker threads are divided over a thread pool per node
+ * This function is not multi-thread safe acquire cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_start_worker_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	libcthreads_thread_pool_t **thread_pool                = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	static char *function                                  = "libqcow_internal_file_start_worker_thread_pool";
+	int node_index                                         = 0;
+	int number_of_thread_pools                             = 1;
+	int number_of_threads                                  = 0;
+	int thread_index                                       = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->worker_thread_pool != NULL )
+	{
+		return( 1 );
+	}
+	if( internal_file->worker_decompression_context_queue != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - worker decompression context queue value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_queue_initialize(
+	     &( internal_file->worker_decompression_context_queue ),
+	     internal_file->number_of_worker_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create worker decompression context queue.",
+		 function );
+
+		goto on_error;
+	}
+	for( thread_index = 0;
+	     thread_index < internal_file->number_of_worker_threads;
+	     thread_index++ )
+	{
+		if( libqcow_decompression_context_initialize(
+		     &decompression_context,
+		     internal_file->io_handle->compression_method,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create decompression context: %d.",
+			 function,
+			 thread_index );
+
+			goto on_error;
+		}
+		if( libcthreads_queue_push(
+		     internal_file->worker_decompression_context_queue,
+		     (intptr_t *) decompression_context,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to push decompression context: %d onto queue.",
+			 function,
+			 thread_index );
+
+			goto on_error;
+		}
+		decompression_context = NULL;
+	}
+	/* A thread pool per NUMA node requires at least one worker thread per node
+	 */
+	if( ( internal_file->numa_topology != NULL )
+	 && ( internal_file->number_of_numa_nodes > 1 )
+	 && ( internal_file->number_of_worker_threads >= internal_file->number_of_numa_nodes ) )
+	{
+		number_of_thread_pools = internal_file->number_of_numa_nodes;
+
+		internal_file->numa_worker_thread_pools = (libcthreads_thread_pool_t **) memory_allocate(
+		                                                                          sizeof( libcthreads_thread_pool_t * ) * number_of_thread_pools );
+
+		if( internal_file->numa_worker_thread_pools == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create NUMA worker thread pools.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     internal_file->numa_worker_thread_pools,
+		     0,
+		     sizeof( libcthreads_thread_pool_t * ) * number_of_thread_pools ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear NUMA worker thread pools.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	/* The thread pool of the first node is created last since it indicates
+	 * that the worker thread pool has been started
+	 */
+	for( node_index = number_of_thread_pools - 1;
+	     node_index >= 0;
+	     node_index-- )
+	{
+		if( node_index == 0 )
+		{
+			thread_pool = &( internal_file->worker_thread_pool );
+		}
+		else
+		{
+			thread_pool = &( internal_file->numa_worker_thread_pools[ node_index ] );
+		}
+		number_of_threads = internal_file->number_of_worker_threads / number_of_thread_pools;
+
+		if( node_index < ( internal_file->number_of_worker_threads % number_of_thread_pools ) )
+		{
+			number_of_threads += 1;
+		}
+		if( libcthreads_thread_pool_create(
+		     thread_pool,
+		     NULL,
+		     number_of_threads,
+		     LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_TASKS,
+		     (int (*)(intptr_t *, void *)) &libqcow_cluster_block_task_thread_pool_callback,
+		     (void *) internal_file->worker_decompression_context_queue,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create worker thread pool of NUMA node: %d.",
+			 function,
+			 node_index );
+
+			goto on_error;
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	/* Stopping the worker thread pool also joins the thread pools of the NUMA nodes
+	 * and frees the worker decompression context queue
+	 */
+	libqcow_internal_file_stop_worker_thread_pool(
+	 internal_file,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Stops the worker thread pool and frees the worker decompression contexts
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_stop_worker_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_stop_worker_thread_pool";
+	int node_index        = 0;
+	int result            = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->numa_worker_thread_pools != NULL )
+	{
+		for( node_index = 1;
+		     node_index < internal_file->number_of_numa_nodes;
+		     node_index++ )
+		{
+			if( internal_file->numa_worker_thread_pools[ node_index ] != NULL )
+			{
+				if( libcthreads_thread_pool_join(
+				     &( internal_file->numa_worker_thread_pools[ node_index ] ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to join worker thread pool of NUMA node: %d.",
+					 function,
+					 node_index );
+
+					result = -1;
+				}
+			}
+		}
+		/* The thread pools that could not be joined are still referenced
+		 */
+		if( result == 1 )
+		{
+			memory_free(
+			 internal_file->numa_worker_thread_pools );
+
+			internal_file->numa_worker_thread_pools = NULL;
+		}
+	}
+	if( internal_file->worker_thread_pool != NULL )
+	{
+		if( libcthreads_thread_pool_join(
+		     &( internal_file->worker_thread_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join worker thread pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+	/* The decompression contexts are only freed after the worker threads
+	 * have been joined since the threads can still be using them
+	 */
+	if( ( result == 1 )
+	 && ( internal_file->worker_decompression_context_queue != NULL ) )
+	{
+		if( libcthreads_queue_free(
+		     &( internal_file->worker_decompression_context_queue ),
+		     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_decompression_context_free,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free worker decompression context queue.",
+			 function );
+
+			result = -1;
+		}
+	}
+	return( result );
+}
+
+/* Starts the read request thread pool if not already started
+ * The number of threads is the number of worker threads, with a minimum of 1
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_start_read_request_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	static char *function                = "libqcow_internal_file_start_read_request_thread_pool";
+	int number_of_threads                = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->read_request_thread_pool != NULL )
+	{
+		return( 1 );
+	}
+	if( internal_file->number_of_worker_threads > 1 )
+	{
+		number_of_threads = internal_file->number_of_worker_threads;
+	}
+	if( libqcow_internal_file_get_io_scheduler(
+	     internal_file,
+	     &io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	/* The read requests are queued by the IO scheduler, the thread pool callback
+	 * processes the read request of the highest IO priority
+	 */
+	if( libcthreads_thread_pool_create(
+	     &( internal_file->read_request_thread_pool ),
+	     NULL,
+	     number_of_threads,
+	     LIBQCOW_MAXIMUM_NUMBER_OF_QUEUED_READ_REQUESTS,
+	     (int (*)(intptr_t *, void *)) &libqcow_read_request_thread_pool_callback,
+	     (void *) io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create read request thread pool.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Stops the read request thread pool
+ * The read requests that are still queued are processed before the threads are joined
+ * This function is not multi-thread safe, do not hold the read/write lock when calling
+ * since the read requests need it to complete
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_stop_read_request_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_stop_read_request_thread_pool";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->read_request_thread_pool != NULL )
+	{
+		if( libcthreads_thread_pool_join(
+		     &( internal_file->read_request_thread_pool ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join read request thread pool.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Retrieves the IO scheduler
+ * A reader uses the IO scheduler of its source file, so that the IO priorities
+ * and limits apply to all the reads of the file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_io_scheduler(
+     libqcow_internal_file_t *internal_file,
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_get_io_scheduler";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->source_file != NULL )
+	{
+		internal_file = (libqcow_internal_file_t *) internal_file->source_file;
+	}
+	if( internal_file->io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	*io_scheduler = internal_file->io_scheduler;
+
+	return( 1 );
+}
+
+/* Reads (media) data from the current offset into a buffer using a Basic File IO (bfio) handle
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_buffer_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_read_buffer_from_file_io_handle";
+	ssize_t read_count    = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->current_offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - current offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->data_path_is_initialized == 0 )
+	{
+		if( libqcow_internal_file_initialize_data_path(
+		     internal_file,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	read_count = libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+	              internal_file,
+	              file_io_handle,
+	              buffer,
+	              buffer_size,
+	              internal_file->current_offset,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer at current offset.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file->current_offset += (off64_t) read_count;
+
+	return( read_count );
+}
+
+/* Reads (media) data from the current offset into a buffer
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_file_read_buffer(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_read_buffer";
+	ssize_t read_count                     = 0;
+	uint64_t start_timestamp               = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	/* The latency includes waiting for the lock
+	 */
+	if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( internal_file->statistics ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	read_count = libqcow_internal_file_read_buffer_from_file_io_handle(
+		      internal_file,
+		      internal_file->file_io_handle,
+		      buffer,
+		      buffer_size,
+		      error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer.",
+		 function );
+
+		read_count = -1;
+	}
+	else if( start_timestamp != 0 )
+	{
+		libqcow_statistics_add_latency(
+		 internal_file->statistics,
+		 LIBQCOW_LATENCY_OPERATION_READ_BUFFER,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( read_count );
+}
+
+/* Reads (media) data at a specific offset
+ * This function does not change the current offset and can be called concurrently
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_file_read_buffer_at_offset(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_read_buffer_at_offset";
+	ssize_t read_count                     = 0;
+	uint64_t start_timestamp               = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	/* The latency includes waiting for the lock
+	 */
+	if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( internal_file->statistics ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+		      internal_file,
+		      internal_file->file_io_handle,
+		      buffer,
+		      buffer_size,
+		      offset,
+		      error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer.",
+		 function );
+
+		goto on_error;
+	}
+	if( start_timestamp != 0 )
+	{
+		libqcow_statistics_add_latency(
+		 internal_file->statistics,
+		 LIBQCOW_LATENCY_OPERATION_READ_BUFFER,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( read_count );
+
+on_error:
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_read(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Reads (media) data at a specific offset and marks the sectors that read as zero
+ * The zero bitmap is optional and contains a bit per LIBQCOW_ZERO_BITMAP_SECTOR_SIZE
+ * bytes of the buffer, where the least significant bit of the first byte represents
+ * the first sector of the buffer. A bit is set if the sector is part of a zero cluster
+ * block or of an unallocated cluster block that is not read from a backing file
+ * This function does not change the current offset and can be called concurrently
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         uint8_t *zero_bitmap,
+         size_t zero_bitmap_size,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_read_buffer_at_offset_with_zero_bitmap";
+	size_t required_zero_bitmap_size       = 0;
+	ssize_t read_count                     = 0;
+	uint64_t start_timestamp               = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( zero_bitmap != NULL )
+	{
+		required_zero_bitmap_size = ( ( buffer_size / LIBQCOW_ZERO_BITMAP_SECTOR_SIZE ) + 8 ) / 8;
+
+		if( zero_bitmap_size < required_zero_bitmap_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+			 "%s: invalid zero bitmap size value too small.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_set(
+		     zero_bitmap,
+		     0,
+		     required_zero_bitmap_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear zero bitmap.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	/* The latency includes waiting for the lock
+	 */
+	if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( internal_file->statistics ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libqcow_internal_file_read_buffer_at_offset_with_zero_bitmap_from_file_io_handle(
+		      internal_file,
+		      internal_file->file_io_handle,
+		      buffer,
+		      buffer_size,
+		      offset,
+		      zero_bitmap,
+		      zero_bitmap_size,
+		      error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer.",
+		 function );
+
+		goto on_error;
+	}
+	if( start_timestamp != 0 )
+	{
+		libqcow_statistics_add_latency(
+		 internal_file->statistics,
+		 LIBQCOW_LATENCY_OPERATION_READ_BUFFER,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( read_count );
+
+on_error:
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_read(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Sorts vector segments by file offset and (media) offset
+ */
+void libqcow_internal_file_sort_vector_segments(
+      libqcow_vector_segment_t *segments,
+      int number_of_segments )
+{
+	libqcow_vector_segment_t segment;
+
+	int gap        = 0;
+	int index      = 0;
+	int sort_index = 0;
+
+	if( segments == NULL )
+	{
+		return;
+	}
+	for( gap = number_of_segments / 2;
+	     gap > 0;
+	     gap /= 2 )
+	{
+		for( index = gap;
+		     index < number_of_segments;
+		     index++ )
+		{
+			segment = segments[ index ];
+
+			for( sort_index = index;
+			     sort_index >= gap;
+			     sort_index -= gap )
+			{
+				if( ( segments[ sort_index - gap ].sort_offset < segment.sort_offset )
+				 || ( ( segments[ sort_index - gap ].sort_offset == segment.sort_offset )
+				  && ( segments[ sort_index - gap ].offset <= segment.offset ) ) )
+				{
+					break;
+				}
+				segments[ sort_index ] = segments[ sort_index - gap ];
+			}
+			segments[ sort_index ] = segment;
+		}
+	}
+}
+
+/* Reads (media) data at specific offsets into multiple buffers in ascending order of file offset
+ * The buffers are split into segments of a single cluster block, the level 2 tables are
+ * looked up in order of their file offset and the cluster blocks are read in order of their
+ * file offset, hence a file that is slow to seek is read mostly sequentially
+ * The buffers serve as the staging area of the data that is read out of (media) order
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the total number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_file_read_vector_in_host_order(
+         libqcow_internal_file_t *internal_file,
+         void **buffers,
+         size_t *buffer_sizes,
+         off64_t *offsets,
+         int number_of_buffers,
+         libcerror_error_t **error )
+{
+	libqcow_vector_segment_t *segment  = NULL;
+	libqcow_vector_segment_t *segments = NULL;
+	static char *function              = "libqcow_internal_file_read_vector_in_host_order";
+	size64_t number_of_segments        = 0;
+	size_t buffer_offset               = 0;
+	size_t read_size                   = 0;
+	size_t total_read_size             = 0;
+	ssize_t read_count                 = 0;
+	uint64_t level2_table_file_offset  = 0;
+	off64_t offset                     = 0;
+	int buffer_index                   = 0;
+	int segment_index                  = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle->cluster_block_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - invalid IO handle - cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( buffers == NULL )
+	 || ( buffer_sizes == NULL )
+	 || ( offsets == NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffers.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_buffers <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of buffers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	/* The part of a buffer beyond the end of the media is not read
+	 */
+	for( buffer_index = 0;
+	     buffer_index < number_of_buffers;
+	     buffer_index++ )
+	{
+		offset = offsets[ buffer_index ];
+
+		if( (size64_t) offset >= internal_file->io_handle->media_size )
+		{
+			continue;
+		}
+		read_size = buffer_sizes[ buffer_index ];
+
+		if( (size64_t) read_size > ( internal_file->io_handle->media_size - (size64_t) offset ) )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - (size64_t) offset );
+		}
+		if( read_size == 0 )
+		{
+			continue;
+		}
+		number_of_segments += ( ( (size64_t) offset + read_size - 1 ) / internal_file->io_handle->cluster_block_size )
+		                    - ( (size64_t) offset / internal_file->io_handle->cluster_block_size ) + 1;
+	}
+	if( number_of_segments == 0 )
+	{
+		return( 0 );
+	}
+	if( ( number_of_segments > (size64_t) INT_MAX )
+	 || ( number_of_segments > ( (size64_t) SSIZE_MAX / sizeof( libqcow_vector_segment_t ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of segments value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	segments = (libqcow_vector_segment_t *) memory_allocate(
+	                                         sizeof( libqcow_vector_segment_t ) * (size_t) number_of_segments );
+
+	if( segments == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create segments.",
+		 function );
+
+		return( -1 );
+	}
+	/* The segments are first sorted by the file offset of their level 2 table
+	 * so that the level 2 tables that are not cached are read in file order.
+	 * The level 2 table entries in the metadata index are already in memory
+	 */
+	segment_index = 0;
+
+	for( buffer_index = 0;
+	     buffer_index < number_of_buffers;
+	     buffer_index++ )
+	{
+		offset = offsets[ buffer_index ];
+
+		if( (size64_t) offset >= internal_file->io_handle->media_size )
+		{
+			continue;
+		}
+		read_size = buffer_sizes[ buffer_index ];
+
+		if( (size64_t) read_size > ( internal_file->io_handle->media_size - (size64_t) offset ) )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - (size64_t) offset );
+		}
+		buffer_offset = 0;
+
+		while( buffer_offset < read_size )
+		{
+			segment = &( segments[ segment_index++ ] );
+
+			segment->buffer_index            = buffer_index;
+			segment->buffer_offset           = buffer_offset;
+			segment->offset                  = offset;
+			segment->size                    = internal_file->io_handle->cluster_block_size - (size_t) ( offset & internal_file->io_handle->cluster_block_bit_mask );
+			segment->cluster_block_reference = 0;
+			segment->sort_offset             = 0;
+
+			if( segment->size > ( read_size - buffer_offset ) )
+			{
+				segment->size = read_size - buffer_offset;
+			}
+			if( internal_file->metadata_index == NULL )
+			{
+				if( libqcow_cluster_table_read_reference_by_index(
+				     internal_file->level1_table,
+				     internal_file->file_io_handle,
+				     (int) ( (uint64_t) offset >> internal_file->io_handle->level1_index_bit_shift ),
+				     &level2_table_file_offset,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve level 2 table offset of segment: %d from level 1 table.",
+					 function,
+					 segment_index - 1 );
+
+					goto on_error;
+				}
+				segment->sort_offset = level2_table_file_offset & internal_file->io_handle->offset_bit_mask;
+			}
+			offset        += (off64_t) segment->size;
+			buffer_offset += segment->size;
+		}
+	}
+	libqcow_internal_file_sort_vector_segments(
+	 segments,
+	 (int) number_of_segments );
+
+	/* The cluster block references are looked up in level 2 table order
+	 * after which the segments are sorted by the file offset of their cluster block
+	 */
+	for( segment_index = 0;
+	     segment_index < (int) number_of_segments;
+	     segment_index++ )
+	{
+		segment = &( segments[ segment_index ] );
+
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     internal_file->file_io_handle,
+		     segment->offset,
+		     &( segment->cluster_block_reference ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 segment->offset,
+			 segment->offset );
+
+			goto on_error;
+		}
+		segment->sort_offset = segment->cluster_block_reference & internal_file->io_handle->offset_bit_mask;
+
+		if( ( segment->cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+		{
+			segment->sort_offset &= internal_file->io_handle->compression_bit_mask;
+		}
+		else
+		{
+			segment->sort_offset &= ~( internal_file->io_handle->cluster_block_bit_mask );
+		}
+	}
+	libqcow_internal_file_sort_vector_segments(
+	 segments,
+	 (int) number_of_segments );
+
+	for( segment_index = 0;
+	     segment_index < (int) number_of_segments;
+	     segment_index++ )
+	{
+		segment = &( segments[ segment_index ] );
+
+		buffer_offset = 0;
+
+		while( buffer_offset < segment->size )
+		{
+			read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+			              internal_file,
+			              internal_file->file_io_handle,
+			              segment->offset + (off64_t) buffer_offset,
+			              segment->cluster_block_reference,
+			              &( ( (uint8_t *) buffers[ segment->buffer_index ] )[ segment->buffer_offset + buffer_offset ] ),
+			              segment->size - buffer_offset,
+			              error );
+
+			if( read_count <= 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read buffer: %d at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 segment->buffer_index,
+				 segment->offset,
+				 segment->offset );
+
+				goto on_error;
+			}
+			buffer_offset += (size_t) read_count;
+		}
+		total_read_size += segment->size;
+	}
+	memory_free(
+	 segments );
+
+	segments = NULL;
+
+	if( internal_file->scratch_overlay != NULL )
+	{
+		for( buffer_index = 0;
+		     buffer_index < number_of_buffers;
+		     buffer_index++ )
+		{
+			offset = offsets[ buffer_index ];
+
+			if( (size64_t) offset >= internal_file->io_handle->media_size )
+			{
+				continue;
+			}
+			read_size = buffer_sizes[ buffer_index ];
+
+			if( (size64_t) read_size > ( internal_file->io_handle->media_size - (size64_t) offset ) )
+			{
+				read_size = (size_t) ( internal_file->io_handle->media_size - (size64_t) offset );
+			}
+			if( read_size == 0 )
+			{
+				continue;
+			}
+			if( libqcow_scratch_overlay_read_buffer_at_offset(
+			     internal_file->scratch_overlay,
+			     offset,
+			     (uint8_t *) buffers[ buffer_index ],
+			     read_size,
+			     NULL,
+			     0,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read scratch overlay of buffer: %d.",
+				 function,
+				 buffer_index );
+
+				goto on_error;
+			}
+		}
+	}
+	return( (ssize_t) total_read_size );
+
+on_error:
+	if( segments != NULL )
+	{
+		memory_free(
+		 segments );
+	}
+	return( -1 );
+}
+
+/* Reads (media) data at specific offsets into multiple buffers
+ * The buffers are read in order of offset while holding the locks once
+ * With the sequential access read flag the buffers are read in order of file offset
+ * This function does not change the current offset and can be called concurrently
+ * Returns the total number of bytes read or -1 on error
+ */
+ssize_t libqcow_file_read_vector(
+         libqcow_file_t *file,
+         void **buffers,
+         size_t *buffer_sizes,
+         off64_t *offsets,
+         int number_of_buffers,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	int *sorted_indexes                    = NULL;
+	static char *function                  = "libqcow_file_read_vector";
+	size_t buffer_offset                   = 0;
+	size_t total_read_size                 = 0;
+	ssize_t read_count                     = 0;
+	off64_t offset                         = 0;
+	int buffer_index                       = 0;
+	int gap                                = 0;
+	int index                              = 0;
+	int sorted_index                       = 0;
+	int sort_index                         = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int cache_mutex_grabbed                = 0;
+#endif
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffers.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_sizes == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer sizes.",
+		 function );
+
+		return( -1 );
+	}
+	if( offsets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offsets.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_buffers <= 0 )
+	 || ( (size_t) number_of_buffers > ( (size_t) SSIZE_MAX / sizeof( int ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of buffers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	for( buffer_index = 0;
+	     buffer_index < number_of_buffers;
+	     buffer_index++ )
+	{
+		if( buffers[ buffer_index ] == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+			 "%s: invalid buffer: %d.",
+			 function,
+			 buffer_index );
+
+			return( -1 );
+		}
+		if( buffer_sizes[ buffer_index ] > ( (size_t) SSIZE_MAX - total_read_size ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid buffer size: %d value exceeds maximum.",
+			 function,
+			 buffer_index );
+
+			return( -1 );
+		}
+		if( offsets[ buffer_index ] < 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid offset: %d value out of bounds.",
+			 function,
+			 buffer_index );
+
+			return( -1 );
+		}
+		total_read_size += buffer_sizes[ buffer_index ];
+	}
+	sorted_indexes = (int *) memory_allocate(
+	                          sizeof( int ) * number_of_buffers );
+
+	if( sorted_indexes == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create sorted indexes.",
+		 function );
+
+		return( -1 );
+	}
+	/* Sort the buffers by offset so that consecutive reads of the same
+	 * cluster block are served from the cache
+	 */
+	for( buffer_index = 0;
+	     buffer_index < number_of_buffers;
+	     buffer_index++ )
+	{
+		sorted_indexes[ buffer_index ] = buffer_index;
+	}
+	for( gap = number_of_buffers / 2;
+	     gap > 0;
+	     gap /= 2 )
+	{
+		for( index = gap;
+		     index < number_of_buffers;
+		     index++ )
+		{
+			sorted_index = sorted_indexes[ index ];
+
+			for( sort_index = index;
+			     sort_index >= gap;
+			     sort_index -= gap )
+			{
+				if( offsets[ sorted_indexes[ sort_index - gap ] ] <= offsets[ sorted_index ] )
+				{
+					break;
+				}
+				sorted_indexes[ sort_index ] = sorted_indexes[ sort_index - gap ];
+			}
+			sorted_indexes[ sort_index ] = sorted_index;
+		}
+	}
+	total_read_size = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		memory_free(
+		 sorted_indexes );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libqcow_trace_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	cache_mutex_grabbed = 1;
+#endif
+	/* A file that is slow to seek, such as a file object of a compressed archive
+	 * or a network stream, is read in order of file offset instead of (media) offset
+	 */
+	if( ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_SEQUENTIAL_ACCESS ) != 0 )
+	 && ( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) == 0 ) )
+	{
+		read_count = libqcow_internal_file_read_vector_in_host_order(
+		              internal_file,
+		              buffers,
+		              buffer_sizes,
+		              offsets,
+		              number_of_buffers,
+		              error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read buffers in order of file offset.",
+			 function );
+
+			goto on_error;
+		}
+		total_read_size = (size_t) read_count;
+	}
+	else
+	{
+		for( index = 0;
+		     index < number_of_buffers;
+		     index++ )
+		{
+			buffer_index  = sorted_indexes[ index ];
+			buffer_offset = 0;
+			offset        = offsets[ buffer_index ];
+
+			while( buffer_offset < buffer_sizes[ buffer_index ] )
+			{
+				if( (size64_t) offset >= internal_file->io_handle->media_size )
+				{
+					break;
+				}
+				read_count = internal_file->read_cluster_block_data(
+				              internal_file,
+				              internal_file->file_io_handle,
+				              offset,
+				              &( ( (uint8_t *) buffers[ buffer_index ] )[ buffer_offset ] ),
+				              buffer_sizes[ buffer_index ] - buffer_offset,
+				              error );
+
+				if( read_count == -1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_READ_FAILED,
+					 "%s: unable to read buffer: %d at offset: %" PRIi64 " (0x%08" PRIx64 ").",
 					 function,
-					 compressed_cluster_block_offset );
+					 buffer_index,
+					 offset,
+					 offset );
+
+					goto on_error;
+				}
+				else if( read_count == 0 )
+				{
+					break;
+				}
+				offset        += (off64_t) read_count;
+				buffer_offset += (size_t) read_count;
+			}
+			if( ( internal_file->scratch_overlay != NULL )
+			 && ( buffer_offset > 0 ) )
+			{
+				if( libqcow_scratch_overlay_read_buffer_at_offset(
+				     internal_file->scratch_overlay,
+				     offsets[ buffer_index ],
+				     (uint8_t *) buffers[ buffer_index ],
+				     buffer_offset,
+				     NULL,
+				     0,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_READ_FAILED,
+					 "%s: unable to read scratch overlay of buffer: %d.",
+					 function,
+					 buffer_index );
+
+					goto on_error;
+				}
+			}
+			total_read_size += buffer_offset;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	cache_mutex_grabbed = 0;
+
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		memory_free(
+		 sorted_indexes );
+
+		return( -1 );
+	}
+#endif
+	memory_free(
+	 sorted_indexes );
+
+	return( (ssize_t) total_read_size );
+
+on_error:
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( cache_mutex_grabbed != 0 )
+	{
+		libcthreads_mutex_release(
+		 internal_file->cache_mutex,
+		 NULL );
+	}
+	libcthreads_read_write_lock_release_for_read(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	memory_free(
+	 sorted_indexes );
+
+	return( -1 );
+}
+
+/* Reads (media) data at a specific offset into a buffer asynchronously
+ * The callback function is called from a read request thread when the read request has finished
+ * Without multi-thread support the read request is processed before this function returns
+ * The buffer must remain available until the read request has finished
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_read_async(
+     libqcow_file_t *file,
+     void *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_file_read_async";
+
+	if( libqcow_file_read_async_with_priority(
+	     file,
+	     buffer,
+	     buffer_size,
+	     offset,
+	     LIBQCOW_IO_PRIORITY_NORMAL,
+	     callback,
+	     user_data,
+	     request,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read asynchronously.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads (media) data at a specific offset into a buffer asynchronously with an IO priority
+ * The read request is queued by the IO scheduler of the file
+ * The callback function is called from a read request thread when the read request has finished
+ * Without multi-thread support the read request is processed before this function returns
+ * The buffer must remain available until the read request has finished
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_read_async_with_priority(
+     libqcow_file_t *file,
+     void *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     int priority,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *read_error          = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_io_scheduler_t *io_scheduler   = NULL;
+	libqcow_read_request_t *read_request   = NULL;
+	static char *function                  = "libqcow_file_read_async_with_priority";
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libqcow_read_request_t *queued_request = NULL;
+	int result                             = 1;
+#endif
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( priority < 0 )
+	 || ( priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	if( *request != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid read request value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_read_request_initialize(
+	     &read_request,
+	     file,
+	     (uint8_t *) buffer,
+	     buffer_size,
+	     offset,
+	     callback,
+	     user_data,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create read request.",
+		 function );
+
+		goto on_error;
+	}
+	( (libqcow_internal_read_request_t *) read_request )->priority = (uint8_t) priority;
+
+	if( libqcow_internal_file_get_io_scheduler(
+	     internal_file,
+	     &io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_start_read_request_thread_pool(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to start read request thread pool.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+	if( result != 1 )
+	{
+		goto on_error;
+	}
+	if( libqcow_io_scheduler_push_request(
+	     io_scheduler,
+	     read_request,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+		 "%s: unable to push read request onto IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	/* The read/write lock is not held while pushing since the push blocks
+	 * when the queue is full and the read requests need the lock to complete
+	 * Every read request that is pushed onto the thread pool signals that one
+	 * read request of the IO scheduler is to be processed
+	 */
+	if( libcthreads_thread_pool_push(
+	     internal_file->read_request_thread_pool,
+	     (intptr_t *) read_request,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+		 "%s: unable to push read request onto read request thread pool.",
+		 function );
+
+		result = libqcow_io_scheduler_remove_request(
+		          io_scheduler,
+		          read_request,
+		          NULL );
+
+		if( result == 1 )
+		{
+			goto on_error;
+		}
+		/* The read request was already taken by a thread on behalf of another read request,
+		 * process a queued read request here instead so that none is left behind
+		 */
+		libcerror_error_free(
+		 error );
+
+		if( libqcow_io_scheduler_pop_request(
+		     io_scheduler,
+		     &queued_request,
+		     &read_error ) == 1 )
+		{
+			if( libqcow_read_request_process(
+			     queued_request,
+			     &read_error ) != 1 )
+			{
+#if defined( HAVE_DEBUG_OUTPUT )
+				if( libcnotify_verbose != 0 )
+				{
+					libcnotify_print_error_backtrace(
+					 read_error );
+				}
+#endif
+				libcerror_error_free(
+				 &read_error );
+			}
+		}
+		else if( read_error != NULL )
+		{
+			libcerror_error_free(
+			 &read_error );
+		}
+	}
+#else
+	if( libqcow_io_scheduler_acquire(
+	     io_scheduler,
+	     priority,
+	     buffer_size,
+	     NULL,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to acquire IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	/* A failed read is reported by the callback function
+	 */
+	if( libqcow_read_request_process(
+	     read_request,
+	     &read_error ) != 1 )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 read_error );
+		}
+#endif
+		libcerror_error_free(
+		 &read_error );
+	}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	*request = read_request;
+
+	return( 1 );
+
+on_error:
+	if( read_request != NULL )
+	{
+		/* The read request was not queued, mark it as finished so that freeing it does not wait for it
+		 */
+		( (libqcow_internal_read_request_t *) read_request )->is_finished = 1;
+
+		libqcow_read_request_free(
+		 &read_request,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads (media) data of a specific range in parallel
+ * The range is read in chunks by multiple workers, each with its own reader
+ * of the file, the callback function is called for every chunk that was read
+ * Chunks are aligned to the chunk size, where the first and last chunk can
+ * be smaller. Without the ordered flag the callback function can be called
+ * concurrently and in any order
+ * Chunks that contain no data are not passed to the callback function unless
+ * the include holes flag is set
+ * With the sequential access read flag the range is read by a single worker
+ * in order of file offset
+ * The callback function returns 1 to continue, 0 to stop or -1 on error
+ * Returns 1 if successful, 0 if stopped by the callback function or -1 on error
+ */
+int libqcow_file_read_parallel(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     int (*callback)(
+            off64_t chunk_offset,
+            const uint8_t *chunk_data,
+            size_t chunk_size,
+            void *user_data ),
+     void *user_data,
+     int number_of_threads,
+     int flags,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_parallel_read_t *parallel_read = NULL;
+	static char *function                  = "libqcow_file_read_parallel";
+	size64_t media_size                    = 0;
+	size64_t partition_size                = 0;
+	size_t cluster_block_size              = 0;
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_size > (size_t) LIBQCOW_PARALLEL_READ_MAXIMUM_CHUNK_SIZE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid chunk size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( callback == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid callback function.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( flags & ~( LIBQCOW_PARALLEL_READ_FLAG_ORDERED | LIBQCOW_PARALLEL_READ_FLAG_INCLUDE_HOLES ) ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported flags: 0x%08x.",
+		 function,
+		 flags );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_media_size(
+	     file,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( size == 0 )
+	 || ( (size64_t) offset >= media_size ) )
+	{
+		return( 1 );
+	}
+	if( size > ( media_size - (size64_t) offset ) )
+	{
+		size = media_size - (size64_t) offset;
+	}
+	/* Chunks consist of whole cluster blocks so that workers do not read
+	 * the same cluster block
+	 */
+	cluster_block_size = internal_file->io_handle->cluster_block_size;
+
+	if( chunk_size == 0 )
+	{
+		chunk_size = (size_t) LIBQCOW_PARALLEL_READ_DEFAULT_CHUNK_SIZE;
+	}
+	if( ( cluster_block_size != 0 )
+	 && ( ( chunk_size % cluster_block_size ) != 0 ) )
+	{
+		chunk_size = ( ( chunk_size / cluster_block_size ) + 1 ) * cluster_block_size;
+	}
+	if( chunk_size > (size_t) LIBQCOW_PARALLEL_READ_MAXIMUM_CHUNK_SIZE )
+	{
+		chunk_size = (size_t) LIBQCOW_PARALLEL_READ_MAXIMUM_CHUNK_SIZE;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_threads == 0 )
+	{
+		if( libqcow_file_get_number_of_worker_threads(
+		     file,
+		     &number_of_threads,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve number of worker threads.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( number_of_threads == 0 )
+	{
+		number_of_threads = 1;
+	}
+	else if( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS )
+	{
+		number_of_threads = LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS;
+	}
+#else
+	number_of_threads = 1;
+#endif
+	/* A file that is slow to seek is read by a single worker in order of file offset
+	 */
+	if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_SEQUENTIAL_ACCESS ) != 0 )
+	{
+		number_of_threads = 1;
+	}
+	/* A partition is the range of media data that is mapped by a level 2 table
+	 */
+	partition_size = (size64_t) 1 << internal_file->io_handle->level1_index_bit_shift;
+
+	if( libqcow_parallel_read_initialize(
+	     &parallel_read,
+	     file,
+	     offset,
+	     size,
+	     chunk_size,
+	     partition_size,
+	     number_of_threads,
+	     flags,
+	     callback,
+	     user_data,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create parallel read.",
+		 function );
+
+		goto on_error;
+	}
+	parallel_read->read_in_file_order = (int) ( ( internal_file->read_flags & LIBQCOW_READ_FLAG_SEQUENTIAL_ACCESS ) != 0 );
+
+	result = libqcow_parallel_read_run(
+	          parallel_read,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read data in parallel.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_parallel_read_free(
+	     &parallel_read,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free parallel read.",
+		 function );
+
+		goto on_error;
+	}
+	return( result );
+
+on_error:
+	if( parallel_read != NULL )
+	{
+		libqcow_parallel_read_free(
+		 &parallel_read,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Retrieves the extent at a specific offset
+ * Returns 1 if successful, 0 if the offset is beyond the media size or -1 on error
+ */
+int libqcow_file_get_extent_at_offset(
+     libqcow_file_t *file,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     off64_t *extent_file_offset,
+     uint32_t *extent_flags,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_extent_at_offset";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+#endif
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	result = libqcow_internal_file_get_extent_at_offset(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          offset,
+	          extent_offset,
+	          extent_size,
+	          extent_file_offset,
+	          extent_flags,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Calls the callback function for every range of the media data of file A
+ * that differs from file B, where file B is the backing file of file A
+ * The ranges are determined from the level 1 and 2 tables only, a range
+ * differs if file A maps it instead of reading it from the backing file
+ * If file B is NULL the backing file of file A is assumed
+ * The callback function returns 1 to continue, 0 to stop or -1 on error
+ * and must not call functions of the file
+ * Returns 1 if successful, 0 if stopped by the callback function or -1 on error
+ */
+int libqcow_file_diff_extents(
+     libqcow_file_t *file_a,
+     libqcow_file_t *file_b,
+     int (*callback)(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_table_b = NULL;
+	libqcow_internal_file_t *internal_file  = NULL;
+	static char *function                   = "libqcow_file_diff_extents";
+	int result                              = 0;
+
+	if( file_a == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file A.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file_a;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file A - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( callback == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid callback.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		/* A file does not differ from itself
+		 */
+		if( file_b == file_a )
+		{
+			level1_table_b = internal_file->level1_table;
+		}
+		result = libqcow_internal_file_diff_level1_tables(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          internal_file->level1_table,
+		          level1_table_b,
+		          internal_file->io_handle->media_size,
+		          callback,
+		          user_data,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to diff level 1 tables.",
+			 function );
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Compacts the file into a new file
+ * The new file contains the cluster blocks in media order followed by
+ * consecutively stored level 2 tables, compressed cluster blocks remain compressed
+ * The file is overwritten if it exists
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_compact(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_file_compact";
+	size_t filename_length           = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	filename_length = narrow_string_length(
+	                   filename );
+
+	if( filename_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_compact_file_io_handle(
+	     file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to compact file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Compacts the file into a new file
+ * The file is overwritten if it exists
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_compact_wide(
+     libqcow_file_t *file,
+     const wchar_t *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_file_compact_wide";
+	size_t filename_length           = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	filename_length = wide_string_length(
+	                   filename );
+
+	if( filename_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name_wide(
+	     file_io_handle,
+	     filename,
+	     filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_compact_file_io_handle(
+	     file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to compact file: %ls.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Compacts the file into a new file using a Basic File IO (bfio) handle
+ * The file IO handle is opened if it is not open, where the file is truncated
+ * The new file is a version 3 image with the cluster block size, compression method
+ * and backing filename of the file. Snapshots, bitmaps and other header extensions
+ * are not copied. Encrypted files are not supported
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_compact_file_io_handle(
+     libqcow_file_t *file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_compact_file_io_handle";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported file - encrypted files cannot be compacted.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == internal_file->file_io_handle )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle - cannot compact file into itself.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_compact_file_io_handle(
+	     internal_file,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to compact file.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+
+on_error:
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_read(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Passes advice about the access pattern of the (media) data
+ * LIBQCOW_ADVICE_NORMAL, LIBQCOW_ADVICE_SEQUENTIAL and LIBQCOW_ADVICE_RANDOM
+ * apply to the entire file, the offset and size are ignored
+ * LIBQCOW_ADVICE_WILLNEED and LIBQCOW_ADVICE_DONTNEED apply to the range
+ * of the (media) data and are passed to the operating system for the parts
+ * of the (host) file that contain the data. Data that will be needed is also
+ * read into the cluster block caches in the background
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_advise(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_advise";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+#endif
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	result = libqcow_internal_file_advise(
+	          internal_file,
+	          offset,
+	          size,
+	          advice,
+	          error );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to advise range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Writes (media) data at the current offset
+ * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
+ */
+ssize_t libqcow_file_write_buffer(
+         libqcow_file_t *file,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_write_buffer";
+	ssize_t write_count                    = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	write_count = libqcow_internal_file_write_buffer_to_file_io_handle(
+	               internal_file,
+	               internal_file->file_io_handle,
+	               buffer,
+	               buffer_size,
+	               error );
+
+	if( write_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write buffer.",
+		 function );
+
+		write_count = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( write_count );
+}
+
+/* Writes (media) data at a specific offset
+ * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
+ */
+ssize_t libqcow_file_write_buffer_at_offset(
+         libqcow_file_t *file,
+         const void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_write_buffer_at_offset";
+	ssize_t write_count                    = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_seek_offset(
+	     internal_file,
+	     offset,
+	     SEEK_SET,
+	     error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek offset.",
+		 function );
+
+		goto on_error;
+	}
+	write_count = libqcow_internal_file_write_buffer_to_file_io_handle(
+	               internal_file,
+	               internal_file->file_io_handle,
+	               buffer,
+	               buffer_size,
+	               error );
+
+	if( write_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write buffer.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( write_count );
+
+on_error:
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_write(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Flushes the data written to the file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_flush(
+     libqcow_file_t *file,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_flush";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_flush(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to flush file.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Sets the scratch overlay
+ * The data written to a file with a scratch overlay is stored in the scratch overlay
+ * instead of the file, which allows writes to a file that is opened for reading only.
+ * The scratch overlay is stored in memory or, if filename is set, in a scratch file
+ * that is created or truncated. The data in the scratch overlay is discarded when
+ * the file is closed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_scratch_overlay(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_scratch_overlay";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename != NULL )
+	{
+		if( libbfio_file_initialize(
+		     &file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		if( libbfio_file_set_name(
+		     file_io_handle,
+		     filename,
+		     narrow_string_length(
+		      filename ) + 1,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set filename in file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+		if( libbfio_handle_open(
+		     file_io_handle,
+		     LIBBFIO_OPEN_READ_WRITE_TRUNCATE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open scratch file: %s.",
+			 function,
+			 filename );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( internal_file->write_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported file - opened for writing.",
+		 function );
+
+		result = -1;
+	}
+	else if( internal_file->scratch_overlay != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - scratch overlay value already set.",
+		 function );
+
+		result = -1;
+	}
+	else if( libqcow_scratch_overlay_initialize(
+	          &( internal_file->scratch_overlay ),
+	          internal_file->io_handle->cluster_block_size,
+	          file_io_handle,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create scratch overlay.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		/* The scratch overlay now manages the scratch file IO handle
+		 */
+		file_io_handle = NULL;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( result != 1 )
+	{
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Seeks a certain offset of the (media) data
+ * SEEK_DATA seeks the first offset at or after offset that contains data
+ * SEEK_HOLE seeks the first offset at or after offset that is sparse or zero,
+ * where the end of the media data is considered a hole
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_internal_file_seek_offset(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	static char *function      = "libqcow_internal_file_seek_offset";
+	size64_t extent_size       = 0;
+	off64_t extent_file_offset = 0;
+	off64_t extent_offset      = 0;
+	uint32_t extent_flags      = 0;
+	int is_hole                = 0;
+	int result                 = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_DATA )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_HOLE )
+	 && ( whence != SEEK_SET ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
+		 function );
+
+		return( -1 );
+	}
+	if( whence == SEEK_CUR )
+	{
+		offset += internal_file->current_offset;
+	}
+	else if( whence == SEEK_END )
+	{
+		offset += (off64_t) internal_file->io_handle->media_size;
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( whence == SEEK_DATA )
+	 || ( whence == SEEK_HOLE ) )
+	{
+		if( (size64_t) offset >= internal_file->io_handle->media_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid offset value out of bounds.",
+			 function );
+
+			return( -1 );
+		}
+		if( internal_file->data_path_is_initialized == 0 )
+		{
+			if( libqcow_internal_file_initialize_data_path(
+			     internal_file,
+			     internal_file->file_io_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to initialize data path.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		/* The cluster block tables are walked by extent so that unallocated
+		 * level 2 tables are skipped without looking up every cluster block
+		 */
+		while( (size64_t) offset < internal_file->io_handle->media_size )
+		{
+			result = libqcow_internal_file_get_extent_at_offset(
+			          internal_file,
+			          internal_file->file_io_handle,
+			          offset,
+			          &extent_offset,
+			          &extent_size,
+			          &extent_file_offset,
+			          &extent_flags,
+			          error );
+
+			if( result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				return( -1 );
+			}
+			is_hole = (int) ( ( extent_flags & ( LIBQCOW_EXTENT_FLAG_IS_SPARSE | LIBQCOW_EXTENT_FLAG_IS_ZERO ) ) != 0 );
+
+			/* An unallocated cluster block of a file with a backing file can contain data of the backing file
+			 */
+			if( ( is_hole != 0 )
+			 && ( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) == 0 )
+			 && ( ( internal_file->parent_file != NULL )
+			  || ( internal_file->io_handle->backing_filename != NULL ) ) )
+			{
+				is_hole = 0;
+			}
+			if( is_hole == (int) ( whence == SEEK_HOLE ) )
+			{
+				break;
+			}
+			offset = extent_offset + (off64_t) extent_size;
+		}
+		if( (size64_t) offset >= internal_file->io_handle->media_size )
+		{
+			if( whence == SEEK_DATA )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: no data after offset.",
+				 function );
+
+				return( -1 );
+			}
+			offset = (off64_t) internal_file->io_handle->media_size;
+		}
+	}
+	internal_file->current_offset = offset;
+
+	return( offset );
+}
+
+/* Seeks a certain offset of the (media) data
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_file_seek_offset(
+         libqcow_file_t *file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_seek_offset";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* Seeking data or holes uses the level 2 table cache
+	 * that is shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	offset = libqcow_internal_file_seek_offset(
+	          internal_file,
+	          offset,
+	          whence,
+	          error );
+
+	if( offset == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek offset.",
+		 function );
+
+		offset = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( offset );
+}
+
+/* Retrieves the current offset of the (media) data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_offset(
+     libqcow_file_t *file,
+     off64_t *offset,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_offset";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offset.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*offset = internal_file->current_offset;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Set the keys
+ * The key is either a 128-bit AES-CBC key or a 256-bit or 512-bit LUKS master key
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_keys(
+     libqcow_file_t *file,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_keys";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( key_size != 16 )
+	 && ( key_size != 32 )
+	 && ( key_size != 64 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported key size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( memory_copy(
+	     internal_file->key_data,
+	     key,
+	     key_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy key.",
+		 function );
+
+		goto on_error;
+	}
+	internal_file->key_data_size   = key_size;
+	internal_file->key_data_is_set = 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+
+on_error:
+	memory_set(
+	 internal_file->key_data,
+	 0,
+	 LIBQCOW_LUKS_MAXIMUM_KEY_SIZE );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_write(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Sets an UTF-8 formatted password
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful, 0 if password is invalid or -1 on error
+ */
+int libqcow_file_set_utf8_password(
+     libqcow_file_t *file,
+     const uint8_t *utf8_string,
+     size_t utf8_string_length,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_utf8_password";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( utf8_string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid UTF-8 string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( utf8_string_length == 0 )
+	 || ( utf8_string_length > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid UTF-8 string length value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( internal_file->password != NULL )
+	{
+		memory_set(
+		 internal_file->password,
+		 0,
+		 internal_file->password_size );
+
+		memory_free(
+		 internal_file->password );
+
+		internal_file->password      = NULL;
+		internal_file->password_size = 0;
+	}
+	internal_file->password = (uint8_t *) memory_allocate(
+	                                       sizeof( uint8_t ) * utf8_string_length );
+
+	if( internal_file->password == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create password.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_copy(
+	     internal_file->password,
+	     utf8_string,
+	     utf8_string_length ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy password.",
+		 function );
+
+		goto on_error;
+	}
+	internal_file->password_size = utf8_string_length;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( internal_file->password != NULL )
+	{
+		memory_set(
+		 internal_file->password,
+		 0,
+		 internal_file->password_size );
+
+		memory_free(
+		 internal_file->password );
+
+		internal_file->password      = NULL;
+		internal_file->password_size = 0;
+	}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_write(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Sets an UTF-16 formatted password
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful, 0 if password is invalid or -1 on error
+ */
+int libqcow_file_set_utf16_password(
+     libqcow_file_t *file,
+     const uint16_t *utf16_string,
+     size_t utf16_string_length,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_utf16_password";
+	size_t utf8_string_size                = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( internal_file->password != NULL )
+	{
+		memory_set(
+		 internal_file->password,
+		 0,
+		 internal_file->password_size );
+
+		memory_free(
+		 internal_file->password );
+
+		internal_file->password      = NULL;
+		internal_file->password_size = 0;
+	}
+	/* The password is stored UTF-8 formatted
+	 */
+	if( libuna_utf8_string_size_from_utf16(
+	     utf16_string,
+	     utf16_string_length,
+	     &utf8_string_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine password size.",
+		 function );
+
+		goto on_error;
+	}
+	internal_file->password = (uint8_t *) memory_allocate(
+	                                       sizeof( uint8_t ) * utf8_string_size );
+
+	if( internal_file->password == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create password.",
+		 function );
+
+		goto on_error;
+	}
+	if( libuna_utf8_string_copy_from_utf16(
+	     internal_file->password,
+	     utf8_string_size,
+	     utf16_string,
+	     utf16_string_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to copy password.",
+		 function );
+
+		memory_free(
+		 internal_file->password );
+
+		internal_file->password = NULL;
+
+		goto on_error;
+	}
+	/* The end-of-string character is not part of the password
+	 */
+	internal_file->password_size = narrow_string_length(
+	                                (char *) internal_file->password );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( internal_file->password != NULL )
+	{
+		memory_set(
+		 internal_file->password,
+		 0,
+		 internal_file->password_size );
+
+		memory_free(
+		 internal_file->password );
+
+		internal_file->password      = NULL;
+		internal_file->password_size = 0;
+	}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_read_write_lock_release_for_write(
+	 internal_file->read_write_lock,
+	 NULL );
+#endif
+	return( -1 );
+}
+
+/* Sets the maximum number of cache entries
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_cache_limits(
+     libqcow_file_t *file,
+     int maximum_number_of_level2_tables,
+     int maximum_number_of_cluster_blocks,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_cache_limits";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_number_of_level2_tables <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid maximum number of level 2 tables value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_number_of_cluster_blocks <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid maximum number of cluster blocks value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_file->maximum_number_of_level2_table_cache_entries  = maximum_number_of_level2_tables;
+	internal_file->maximum_number_of_cluster_block_cache_entries = maximum_number_of_cluster_blocks;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the maximum number of cache entries
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_cache_limits(
+     libqcow_file_t *file,
+     int *maximum_number_of_level2_tables,
+     int *maximum_number_of_cluster_blocks,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_cache_limits";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( maximum_number_of_level2_tables == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum number of level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_number_of_cluster_blocks == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum number of cluster blocks.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*maximum_number_of_level2_tables  = internal_file->maximum_number_of_level2_table_cache_entries;
+	*maximum_number_of_cluster_blocks = internal_file->maximum_number_of_cluster_block_cache_entries;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Sets the (shared) cache
+ * The level 2 tables and cluster blocks of the file are stored in the cache instead
+ * of in caches of the file itself, the cache can be set on multiple files
+ * The cache must not be freed before the files it is set on, use NULL to unset the cache
+ * A backing file opened by the library uses the same cache and is opened once
+ * for all the unencrypted files with the same cache that refer to its path
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_cache(
+     libqcow_file_t *file,
+     libqcow_cache_t *cache,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_cache";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache == internal_file->shared_cache )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( cache != NULL )
+	{
+		if( libqcow_internal_cache_attach_file(
+		     (libqcow_internal_cache_t *) cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to attach file to shared cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( ( result == 1 )
+	 && ( internal_file->shared_cache != NULL ) )
+	{
+		if( libqcow_internal_cache_detach_file(
+		     (libqcow_internal_cache_t *) internal_file->shared_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to detach file from shared cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( result == 1 )
+	{
+		internal_file->shared_cache = cache;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Sets the (shared) file IO pool
+ * The file IO handles of the file, its backing files and external data file opened
+ * by the library by filename are added to the pool, which keeps at most its maximum
+ * number of open handles open by closing the least recently used handles, that are
+ * reopened on demand. The pool can be set on multiple files
+ * The pool must not be freed before the files it is set on, use NULL to unset the pool
+ * This function needs to be used before one of the open functions
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_file_io_pool(
+     libqcow_file_t *file,
+     libbfio_pool_t *file_io_pool,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_file_io_pool";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - file IO handle already set.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_file->file_io_pool = file_io_pool;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the memory usage of the caches
+ * The memory usage is the number of bytes used by the cached level 2 tables and
+ * cluster blocks, including retained compressed and encrypted data, and the buffers
+ * kept in the pools for reuse
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_cache_memory_usage(
+     libqcow_file_t *file,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_cache_memory_usage";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_get_cache_memory_usage(
+	     internal_file,
+	     memory_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cache memory usage.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the number of bytes allocated by the library for the file,
+ * including the caches, see libqcow_file_get_cache_memory_usage, the level 1 table,
+ * the snapshot and bitmap values, the indexes and the write cache
+ * The values a reader shares with its source file are included in the memory usage
+ * of the source file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_memory_usage(
+     libqcow_file_t *file,
+     size64_t *memory_usage,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_memory_usage";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_get_memory_usage(
+	     internal_file,
+	     memory_usage,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve memory usage.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Sets the maximum memory size
+ * The values in the caches are evicted when caching a value would make the memory usage
+ * of the file exceed the maximum memory size, 0 represents no maximum
+ * The memory needed by the file outside the caches, such as the level 1 table, is not
+ * evicted and counts towards the maximum memory size
+ * The values in a shared cache are limited by the maximum memory size of the shared cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_maximum_memory_size(
+     libqcow_file_t *file,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_maximum_memory_size";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	internal_file->maximum_memory_size = maximum_memory_size;
+
+	/* Evict the values that no longer fit
+	 */
+	if( libqcow_internal_file_enforce_maximum_memory_size(
+	     internal_file,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+		 "%s: unable to enforce maximum memory size.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the maximum memory size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_maximum_memory_size(
+     libqcow_file_t *file,
+     size64_t *maximum_memory_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_maximum_memory_size";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( maximum_memory_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum memory size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*maximum_memory_size = internal_file->maximum_memory_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Drops the cached level 2 tables and (compressed) cluster blocks
+ * The flags, see LIBQCOW_CACHE_FLAGS, determine which caches are dropped
+ * The caches are filled again by subsequent reads
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_drop_caches(
+     libqcow_file_t *file,
+     int flags,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_drop_caches";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_drop_caches(
+	     internal_file,
+	     flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+		 "%s: unable to drop caches.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the size of the cache state data
+ * The size can change when the file is read before the cache state is exported
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_cache_state_size(
+     libqcow_file_t *file,
+     size_t *data_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_cache_state_size";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_export_cache_state(
+	     internal_file,
+	     NULL,
+	     0,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cache state size.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Exports the cache state
+ * The cache state contains the media offsets of the cached level 2 tables
+ * and cluster blocks, the working set of the file, and not the cached data
+ * Use libqcow_file_get_cache_state_size to determine the size of the data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_export_cache_state(
+     libqcow_file_t *file,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_export_cache_state";
+	size_t cache_state_size                = 0;
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_export_cache_state(
+	     internal_file,
+	     data,
+	     data_size,
+	     &cache_state_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to export cache state.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Imports a cache state that was exported by libqcow_file_export_cache_state
+ * The level 2 tables and cluster blocks of the cache state are read into the caches
+ * in the background with the background IO priority, so that they do not delay other reads
+ * Without multi-thread support they are read before the function returns
+ * The cache state is ignored when the file is opened for writing
+ * Returns 1 if successful, 0 if the cache state does not match the file or -1 on error
+ */
+int libqcow_file_import_cache_state(
+     libqcow_file_t *file,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_import_cache_state";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+#endif
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The caches are shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	result = libqcow_internal_file_import_cache_state(
+	          internal_file,
+	          data,
+	          data_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to import cache state.",
+		 function );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the read statistics
+ * The values are stored by statistic type, see LIBQCOW_STATISTICS, up to number of values
+ * The statistics are updated atomically hence no lock is grabbed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_statistics(
+     libqcow_file_t *file,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_statistics";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( libqcow_statistics_get_values(
+	     internal_file->statistics,
+	     values,
+	     number_of_values,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve statistics values.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Resets the read statistics
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_reset_statistics(
+     libqcow_file_t *file,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_reset_statistics";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( libqcow_statistics_clear(
+	     internal_file->statistics,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to clear statistics.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the latency histogram of an operation
+ * The histograms are updated atomically hence no lock is grabbed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_latency_histogram(
+     libqcow_file_t *file,
+     int operation,
+     uint64_t *counts,
+     int number_of_counts,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_latency_histogram";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( libqcow_statistics_get_latency_histogram(
+	     internal_file->statistics,
+	     operation,
+	     counts,
+	     number_of_counts,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve latency histogram.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves a latency percentile of an operation
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_latency_percentile(
+     libqcow_file_t *file,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_latency_percentile";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( libqcow_statistics_get_latency_percentile(
+	     internal_file->statistics,
+	     operation,
+	     percentile,
+	     number_of_values,
+	     latency,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve latency percentile.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the IO limits of an IO priority
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_io_limits(
+     libqcow_file_t *file,
+     int priority,
+     size64_t maximum_bytes_per_second,
+     uint64_t maximum_requests_per_second,
+     libcerror_error_t **error )
+{
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	static char *function                = "libqcow_file_set_io_limits";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_io_scheduler(
+	     (libqcow_internal_file_t *) file,
+	     &io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_scheduler_set_limits(
+	     io_scheduler,
+	     priority,
+	     maximum_bytes_per_second,
+	     maximum_requests_per_second,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set IO limits.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the IO limits of an IO priority
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_io_limits(
+     libqcow_file_t *file,
+     int priority,
+     size64_t *maximum_bytes_per_second,
+     uint64_t *maximum_requests_per_second,
+     libcerror_error_t **error )
+{
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	static char *function                = "libqcow_file_get_io_limits";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_io_scheduler(
+	     (libqcow_internal_file_t *) file,
+	     &io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_scheduler_get_limits(
+	     io_scheduler,
+	     priority,
+	     maximum_bytes_per_second,
+	     maximum_requests_per_second,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO limits.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the read flags
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_read_flags(
+     libqcow_file_t *file,
+     int read_flags,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_read_flags";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( ( read_flags & ~( LIBQCOW_READ_FLAG_NO_CACHE | LIBQCOW_READ_FLAG_NO_READ_AHEAD | LIBQCOW_READ_FLAG_USE_CHAIN_INDEX | LIBQCOW_READ_FLAG_USE_MEMORY_MAP | LIBQCOW_READ_FLAG_DISCARD_SOURCE_DATA | LIBQCOW_READ_FLAG_PRELOAD_LEVEL2_TABLES | LIBQCOW_READ_FLAG_UNBUFFERED_IO | LIBQCOW_READ_FLAG_USE_HUGE_PAGES | LIBQCOW_READ_FLAG_NO_NUMA_PLACEMENT | LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS | LIBQCOW_READ_FLAG_DETECT_ZERO_CLUSTER_BLOCKS | LIBQCOW_READ_FLAG_SEQUENTIAL_ACCESS ) ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported read flags: 0x%02x.",
+		 function,
+		 read_flags );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_file->read_flags = read_flags;
+
+	LIBQCOW_STATISTICS_SET(
+	 internal_file->statistics->latency_histograms_enabled,
+	 ( read_flags & LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS ) != 0 );
+
+	/* The no cache read flag affects which read function is used
+	 */
+	if( libqcow_internal_file_select_read_function(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to select read function.",
+		 function );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the read flags
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_read_flags(
+     libqcow_file_t *file,
+     int *read_flags,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_read_flags";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( read_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read flags.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*read_flags = internal_file->read_flags;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Sets the number of worker threads
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_number_of_worker_threads(
+     libqcow_file_t *file,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_number_of_worker_threads";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_threads != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: multi-thread support not enabled.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	/* The thread pool is created with the new number of threads on the next read
+	 */
+	if( number_of_threads != internal_file->number_of_worker_threads )
+	{
+		if( libqcow_internal_file_stop_worker_thread_pool(
+		     internal_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to stop worker thread pool.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	if( result == 1 )
+	{
+		internal_file->number_of_worker_threads = number_of_threads;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the number of worker threads
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_number_of_worker_threads(
+     libqcow_file_t *file,
+     int *number_of_threads,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_number_of_worker_threads";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( number_of_threads == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of threads.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*number_of_threads = internal_file->number_of_worker_threads;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Sets the asynchronous IO queue depth
+ * A queue depth of 0 disables asynchronous IO
+ * The queue depth is applied when the file is opened
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_io_queue_depth(
+     libqcow_file_t *file,
+     int queue_depth,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_io_queue_depth";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( ( queue_depth < 0 )
+	 || ( queue_depth > LIBQCOW_MAXIMUM_IO_QUEUE_DEPTH ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid queue depth value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_file->io_queue_depth = queue_depth;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the asynchronous IO queue depth
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_io_queue_depth(
+     libqcow_file_t *file,
+     int *queue_depth,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_io_queue_depth";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( queue_depth == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid queue depth.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*queue_depth = internal_file->io_queue_depth;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Sets the host cache
+ * The host cache reads the file IO handle in blocks of block size, which are cached,
+ * with read-ahead of blocks on sequential reads, which reduces the number of reads
+ * of remote (object) storage. A block size of 0 disables the host cache
+ * The host cache is applied when the file is opened
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_host_cache(
+     libqcow_file_t *file,
+     size_t block_size,
+     int number_of_blocks,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_host_cache";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( ( block_size != 0 )
+	 && ( ( block_size < LIBQCOW_MINIMUM_HOST_CACHE_BLOCK_SIZE )
+	  || ( block_size > LIBQCOW_MAXIMUM_HOST_CACHE_BLOCK_SIZE )
+	  || ( ( block_size % 512 ) != 0 ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( block_size != 0 )
+	 && ( ( number_of_blocks <= 0 )
+	  || ( number_of_blocks > LIBQCOW_MAXIMUM_HOST_CACHE_NUMBER_OF_BLOCKS ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of blocks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_file->host_cache_block_size       = block_size;
+	internal_file->host_cache_number_of_blocks = number_of_blocks;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the number of media size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_media_size(
+     libqcow_file_t *file,
+     size64_t *media_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_media_size";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( media_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid media size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*media_size = internal_file->io_handle->media_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the format version
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_format_version(
+     libqcow_file_t *file,
+     uint32_t *format_version,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_format_version";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( format_version == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid format version.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*format_version = internal_file->io_handle->format_version;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the encryption method
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_encryption_method(
+     libqcow_file_t *file,
+     uint32_t *encryption_method,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_encryption_method";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( encryption_method == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid encryption method.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*encryption_method = internal_file->encryption_method;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the size of the UTF-8 encoded backing filename
+ * The returned size includes the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_file_get_utf8_backing_filename_size(
+     libqcow_file_t *file,
+     size_t *utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_utf8_backing_filename_size";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( utf8_string_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid UTF-8 string size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( ( internal_file->io_handle->backing_filename != NULL )
+	 && ( internal_file->io_handle->backing_filename_size > 0 ) )
+	{
+		result = libuna_utf8_string_size_from_utf8_stream(
+		          internal_file->io_handle->backing_filename,
+		          internal_file->io_handle->backing_filename_size,
+		          utf8_string_size,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve UTF-8 string size.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the UTF-8 encoded backing filename
+ * The size should include the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_file_get_utf8_backing_filename(
+     libqcow_file_t *file,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_utf8_backing_filename";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( utf8_string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid UTF-8 string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( utf8_string_size == 0 )
+	 || ( utf8_string_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid UTF-8 string size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( ( internal_file->io_handle->backing_filename != NULL )
+	 && ( internal_file->io_handle->backing_filename_size > 0 ) )
+	{
+		result = libuna_utf8_string_copy_from_utf8_stream(
+		          utf8_string,
+		          utf8_string_size,
+		          internal_file->io_handle->backing_filename,
+		          internal_file->io_handle->backing_filename_size,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+			 "%s: unable to copy backing filename to UTF-8 string.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Sets the parent (backing) file
+ * The parent file is not managed by the library and must remain open
+ * while the file is open. This is needed for files that were not opened
+ * by filename, otherwise the parent file is opened on first use
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_parent_file(
+     libqcow_file_t *file,
+     libqcow_file_t *parent_file,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file        = NULL;
+	libqcow_internal_file_t *internal_parent_file = NULL;
+	static char *function                         = "libqcow_file_set_parent_file";
+	int result                                    = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( parent_file == NULL )
+	 || ( parent_file == file ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parent file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_parent_file = (libqcow_internal_file_t *) parent_file;
+
+	/* The backing file data is read without the read/write lock of the parent file
+	 * hence the data path structures of a parent file opened metadata only are created here
+	 */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_parent_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab parent file read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( ( internal_parent_file->file_io_handle != NULL )
+	 && ( internal_parent_file->data_path_is_initialized == 0 ) )
+	{
+		if( libqcow_internal_file_initialize_data_path(
+		     internal_parent_file,
+		     internal_parent_file->file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path of parent file.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_parent_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release parent file read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result != 1 )
+	{
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( internal_file->parent_file != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - parent file value already set.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		internal_file->parent_file = parent_file;
+
+		/* The entries of the chain index are resolved against the parent file
+		 */
+		if( libqcow_chain_index_free(
+		     &( internal_file->chain_index ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free chain index.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Retrieves the parent (backing) file
+ * The parent file is opened on first use if the file was opened by filename
+ * A parent file that is opened by the library is managed by the library and
+ * remains valid until the file is closed
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_file_get_parent_file(
+     libqcow_file_t *file,
+     libqcow_file_t **parent_file,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_parent_file";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( parent_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parent file.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	result = libqcow_internal_file_get_parent_file(
+	          internal_file,
+	          parent_file,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve parent file.",
+		 function );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Sets the external data file using a Basic File IO (bfio) handle
+ * The data file IO handle is not managed by the library and must remain open
+ * while the file is open
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_set_data_file_io_handle(
+     libqcow_file_t *file,
+     libbfio_handle_t *data_file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_set_data_file_io_handle";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid file - file does not use an external data file.",
+		 function );
+
+		result = -1;
+	}
+	else if( internal_file->data_file_io_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - data file IO handle value already set.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		internal_file->data_file_io_handle = data_file_io_handle;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Reads the chain index from a chain index (sidecar) file
+ * The chain index file is only valid for the same file and backing files
+ * Returns 1 if successful, 0 if the chain index file does not match the file or -1 on error
+ */
+int libqcow_file_read_chain_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_read_chain_index";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open chain index file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
+	}
+#endif
+	result = 1;
+
+	if( internal_file->chain_index == NULL )
+	{
+		result = libqcow_chain_index_initialize(
+		          &( internal_file->chain_index ),
+		          internal_file->io_handle->media_size,
+		          internal_file->io_handle->cluster_block_size,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create chain index.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( result == 1 )
+	{
+		result = libqcow_chain_index_read_file_io_handle(
+		          internal_file->chain_index,
+		          file_io_handle,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read chain index.",
+			 function );
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( result == -1 )
+	{
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close chain index file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( result );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Writes the chain index to a chain index (sidecar) file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_write_chain_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_write_chain_index";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_read(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
+	}
+#endif
+	if( internal_file->chain_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing chain index.",
+		 function );
+
+		result = -1;
+	}
+	else if( libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_WRITE_TRUNCATE,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open chain index file: %s.",
+		 function,
+		 filename );
+
+		result = -1;
+	}
+	else
+	{
+		if( libqcow_chain_index_write_file_io_handle(
+		     internal_file->chain_index,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write chain index.",
+			 function );
+
+			result = -1;
+		}
+		if( libbfio_handle_close(
+		     file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close chain index file.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		result = -1;
+	}
+	return( result );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Creates a metadata index for the file
+ * The metadata index is keyed by the Adler-32 of the file header and of the level 1 table
+ * This function is not multi-thread safe acquire the write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_initialize_metadata_index(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_metadata_index_t **metadata_index,
+     libcerror_error_t **error )
+{
+	uint8_t *data                  = NULL;
+	static char *function          = "libqcow_internal_file_initialize_metadata_index";
+	size_t data_offset             = 0;
+	size_t read_size               = 0;
+	size_t table_size              = 0;
+	ssize_t read_count             = 0;
+	uint32_t file_header_checksum  = 1;
+	uint32_t level1_table_checksum = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	data = (uint8_t *) memory_allocate(
+	                    sizeof( uint8_t ) * LIBQCOW_METADATA_INDEX_READ_SIZE );
+
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create data.",
+		 function );
+
+		goto on_error;
+	}
+	/* The header size of a version 1 file is not stored in the file header
+	 */
+	read_size = (size_t) internal_file->io_handle->header_size;
+
+	if( read_size == 0 )
+	{
+		read_size = sizeof( qcow_file_header_v1_t );
+	}
+	if( read_size > LIBQCOW_METADATA_INDEX_READ_SIZE )
+	{
+		read_size = LIBQCOW_METADATA_INDEX_READ_SIZE;
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              data,
+	              read_size,
+	              0,
+	              error );
+
+	if( read_count != (ssize_t) read_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header data.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_chain_index_calculate_checksum(
+	     &file_header_checksum,
+	     data,
+	     read_size,
+	     file_header_checksum,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate file header checksum.",
+		 function );
+
+		goto on_error;
+	}
+	table_size = (size_t) internal_file->io_handle->level1_table_size;
+
+	while( data_offset < table_size )
+	{
+		read_size = table_size - data_offset;
+
+		if( read_size > LIBQCOW_METADATA_INDEX_READ_SIZE )
+		{
+			read_size = LIBQCOW_METADATA_INDEX_READ_SIZE;
+		}
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              data,
+		              read_size,
+		              internal_file->io_handle->level1_table_offset + (off64_t) data_offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 1 table data.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &level1_table_checksum,
+		     data,
+		     read_size,
+		     level1_table_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate level 1 table checksum.",
+			 function );
+
+			goto on_error;
+		}
+		data_offset += read_size;
+	}
+	memory_free(
+	 data );
+
+	data = NULL;
+
+	if( libqcow_metadata_index_initialize(
+	     metadata_index,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     (size_t) 1 << internal_file->io_handle->number_of_level2_table_entry_bits,
+	     internal_file->size,
+	     file_header_checksum,
+	     level1_table_checksum,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create metadata index.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( data != NULL )
+	{
+		memory_free(
+		 data );
+	}
+	return( -1 );
+}
+
+/* Fills a metadata index with the level 2 table entries of the level 1 table of the file
+ * This function is not multi-thread safe acquire the write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_build_metadata_index(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_metadata_index_t *metadata_index,
+     libcerror_error_t **error )
+{
+	uint8_t *level2_table_data            = NULL;
+	static char *function                 = "libqcow_internal_file_build_metadata_index";
+	size_t entry_index                    = 0;
+	size_t number_of_level2_table_entries = 0;
+	ssize_t read_count                    = 0;
+	uint64_t level2_table_file_offset     = 0;
+	int level1_table_index                = 0;
+	int number_of_level1_table_references = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_handle->level2_table_size == 0 )
+	 || ( internal_file->io_handle->level2_table_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - invalid IO handle - level 2 table size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     internal_file->level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		goto on_error;
+	}
+	level2_table_data = (uint8_t *) memory_allocate(
+	                                 sizeof( uint8_t ) * internal_file->io_handle->level2_table_size );
+
+	if( level2_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 table data.",
+		 function );
+
+		goto on_error;
+	}
+	number_of_level2_table_entries = internal_file->io_handle->level2_table_size / metadata_index->entry_size;
+
+	for( level1_table_index = 0;
+	     level1_table_index < number_of_level1_table_references;
+	     level1_table_index++ )
+	{
+		entry_index = (size_t) level1_table_index * number_of_level2_table_entries;
+
+		if( entry_index >= metadata_index->number_of_entries )
+		{
+			break;
+		}
+		if( libqcow_cluster_table_read_reference_by_index(
+		     internal_file->level1_table,
+		     file_io_handle,
+		     level1_table_index,
+		     &level2_table_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %d from level 1 table.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+		/* The entries of a sparse level 2 table remain 0
+		 */
+		if( level2_table_file_offset == 0 )
+		{
+			continue;
+		}
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              level2_table_data,
+		              internal_file->io_handle->level2_table_size,
+		              (off64_t) level2_table_file_offset,
+		              error );
+
+		if( read_count != (ssize_t) internal_file->io_handle->level2_table_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 table at offset: 0x%08" PRIx64 ".",
+			 function,
+			 level2_table_file_offset );
+
+			goto on_error;
+		}
+		if( libqcow_metadata_index_set_level2_table_data(
+		     metadata_index,
+		     entry_index,
+		     level2_table_data,
+		     internal_file->io_handle->level2_table_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set level 2 table: %d in metadata index.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 level2_table_data );
+
+	return( 1 );
+
+on_error:
+	if( level2_table_data != NULL )
+	{
+		memory_free(
+		 level2_table_data );
+	}
+	return( -1 );
+}
+
+/* Reads the metadata index from a metadata index (sidecar) file
+ * The metadata index file is only valid for the same file header, level 1 table and file size
+ * Returns 1 if successful, 0 if the metadata index file does not match the file or -1 on error
+ */
+int libqcow_file_read_metadata_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle         = NULL;
+	libqcow_internal_file_t *internal_file   = NULL;
+	libqcow_metadata_index_t *metadata_index = NULL;
+	static char *function                    = "libqcow_file_read_metadata_index";
+	int result                               = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open metadata index file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
+	}
+#endif
+	result = libqcow_internal_file_initialize_metadata_index(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          &metadata_index,
+	          error );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create metadata index.",
+		 function );
+
+		result = -1;
+	}
+	if( result == 1 )
+	{
+		result = libqcow_metadata_index_read_file_io_handle(
+		          metadata_index,
+		          file_io_handle,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read metadata index.",
+			 function );
+		}
+	}
+	/* A metadata index that does not match the file is ignored
+	 */
+	if( result == 1 )
+	{
+		if( libqcow_metadata_index_free(
+		     &( internal_file->metadata_index ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free metadata index.",
+			 function );
+
+			result = -1;
+		}
+		else
+		{
+			internal_file->metadata_index = metadata_index;
+
+			metadata_index = NULL;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( metadata_index != NULL )
+	{
+		if( libqcow_metadata_index_free(
+		     &metadata_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free metadata index.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( result == -1 )
+	{
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close metadata index file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( result );
+
+on_error:
+	if( metadata_index != NULL )
+	{
+		libqcow_metadata_index_free(
+		 &metadata_index,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Writes the metadata index to a metadata index (sidecar) file
+ * The metadata index is built from the level 1 and 2 tables of the file if not already available
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_write_metadata_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_write_metadata_index";
+	int result                             = 1;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
+	}
+#endif
+	if( internal_file->metadata_index == NULL )
+	{
+		if( libqcow_internal_file_initialize_metadata_index(
+		     internal_file,
+		     internal_file->file_io_handle,
+		     &( internal_file->metadata_index ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create metadata index.",
+			 function );
+
+			result = -1;
+		}
+		else if( libqcow_internal_file_build_metadata_index(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          internal_file->metadata_index,
+		          error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to build metadata index.",
+			 function );
+
+			libqcow_metadata_index_free(
+			 &( internal_file->metadata_index ),
+			 NULL );
+
+			result = -1;
+		}
+	}
+	if( result == 1 )
+	{
+		if( libbfio_handle_open(
+		     file_io_handle,
+		     LIBBFIO_OPEN_WRITE_TRUNCATE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open metadata index file: %s.",
+			 function,
+			 filename );
+
+			result = -1;
+		}
+		else
+		{
+			if( libqcow_metadata_index_write_file_io_handle(
+			     internal_file->metadata_index,
+			     file_io_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write metadata index.",
+				 function );
+
+				result = -1;
+			}
+			if( libbfio_handle_close(
+			     file_io_handle,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close metadata index file.",
+				 function );
+
+				result = -1;
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		result = -1;
+	}
+	return( result );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Updates the stale digests of a digest index
+ * The level 2 table entries of the file are compared with those stored in the digest index,
+ * only the cluster blocks of which the level 2 table entry changed are read and hashed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_update_digest_index(
+     libqcow_internal_file_t *internal_file,
+     libqcow_digest_index_t *digest_index,
+     int number_of_threads,
+     uint64_t *number_of_stale_entries,
+     libcerror_error_t **error )
+{
+	libqcow_metadata_index_t *metadata_index = NULL;
+	static char *function                    = "libqcow_internal_file_update_digest_index";
+	size64_t range_size                      = 0;
+	size_t entry_index                       = 0;
+	size_t range_entry_index                 = 0;
+	size_t range_number_of_entries           = 0;
+	off64_t range_offset                     = 0;
+	uint64_t cluster_descriptor              = 0;
+	uint64_t subcluster_bitmap               = 0;
+	int result                               = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( digest_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest index.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_stale_entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of stale entries.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_stale_entries = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		return( -1 );
+	}
+#endif
+	/* The level 2 table entries are retrieved from the metadata index, a temporary
+	 * metadata index is built if the file does not have one
+	 */
+	if( internal_file->metadata_index != NULL )
+	{
+		metadata_index = internal_file->metadata_index;
+	}
+	else if( libqcow_internal_file_initialize_metadata_index(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          &metadata_index,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create metadata index.",
+		 function );
+
+		result = -1;
+	}
+	else if( libqcow_internal_file_build_metadata_index(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          metadata_index,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to build metadata index.",
+		 function );
+
+		result = -1;
+	}
+	if( ( result == 1 )
+	 && ( metadata_index->number_of_entries != digest_index->number_of_entries ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: mismatch in number of entries of metadata and digest index.",
+		 function );
+
+		result = -1;
+	}
+	if( result == 1 )
+	{
+		for( entry_index = 0;
+		     entry_index < digest_index->number_of_entries;
+		     entry_index++ )
+		{
+			if( libqcow_metadata_index_get_entry_at_offset(
+			     metadata_index,
+			     (off64_t) entry_index * (off64_t) digest_index->cluster_block_size,
+			     &cluster_descriptor,
+			     &subcluster_bitmap,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve metadata index entry: %" PRIzd ".",
+				 function,
+				 entry_index );
+
+				result = -1;
+
+				break;
+			}
+			if( libqcow_digest_index_set_entry_values(
+			     digest_index,
+			     entry_index,
+			     cluster_descriptor,
+			     subcluster_bitmap,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set digest index entry: %" PRIzd " values.",
+				 function,
+				 entry_index );
+
+				result = -1;
+
+				break;
+			}
+			if( ( digest_index->entry_flags[ entry_index ] & LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STALE ) != 0 )
+			{
+				*number_of_stale_entries += 1;
+			}
+		}
+	}
+	if( ( metadata_index != NULL )
+	 && ( metadata_index != internal_file->metadata_index ) )
+	{
+		if( libqcow_metadata_index_free(
+		     &metadata_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free metadata index.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		result = -1;
+	}
+#endif
+	if( result != 1 )
+	{
+		return( -1 );
+	}
+	/* The stale cluster blocks are read in parallel without holding the file locks,
+	 * holes are not passed to the callback function and remain stale
+	 */
+	entry_index = 0;
+
+	while( entry_index < digest_index->number_of_entries )
+	{
+		result = libqcow_digest_index_get_stale_range(
+		          digest_index,
+		          entry_index,
+		          &range_entry_index,
+		          &range_number_of_entries,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve stale range.",
+			 function );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		range_offset = (off64_t) range_entry_index * (off64_t) digest_index->cluster_block_size;
+		range_size   = (size64_t) range_number_of_entries * digest_index->cluster_block_size;
+
+		if( range_size > ( digest_index->media_size - (size64_t) range_offset ) )
+		{
+			range_size = digest_index->media_size - (size64_t) range_offset;
+		}
+		if( libqcow_file_read_parallel(
+		     (libqcow_file_t *) internal_file,
+		     range_offset,
+		     range_size,
+		     digest_index->cluster_block_size,
+		     &libqcow_digest_index_read_parallel_callback,
+		     (void *) digest_index,
+		     number_of_threads,
+		     0,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster blocks at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		entry_index = range_entry_index + range_number_of_entries;
+	}
+	if( libqcow_digest_index_set_stale_entries_as_holes(
+	     digest_index,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set digests of holes.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Writes a digest index (sidecar) file that contains the SHA-256 of every cluster block of the media
+ * The digests are calculated in parallel by the number of threads, where 0 represents the default,
+ * cluster blocks that contain no data are not read and have a digest of 0-byte values
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_write_digest_index(
+     libqcow_file_t *file,
+     const char *filename,
+     int number_of_threads,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_digest_index_t *digest_index   = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_write_digest_index";
+	uint64_t number_of_stale_entries       = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_digest_index_initialize(
+	     &digest_index,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     LIBQCOW_HASH_TYPE_SHA256,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create digest index.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_update_digest_index(
+	     internal_file,
+	     digest_index,
+	     number_of_threads,
+	     &number_of_stale_entries,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to calculate digests.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_WRITE_TRUNCATE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open digest index file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( libqcow_digest_index_write_file_io_handle(
+	     digest_index,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write digest index.",
+		 function );
 
-					return( -1 );
-				}
-/* TODO check cluster_block_data_size
-				if( cluster_block_data_size != cluster_block->data_size )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-					 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
-					 "%s: invalid cluster block size value out of bounds.",
-					 function );
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close digest index file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_digest_index_free(
+	     &digest_index,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free digest index.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Verifies a digest index (sidecar) file against the file
+ * Only the cluster blocks of which the level 2 table entry changed since the digest index
+ * file was written are read and hashed, the number of changed cluster blocks is the number
+ * of these cluster blocks and the number of mismatches the number of these cluster blocks
+ * of which the data differs from the data at the time the digest index file was written
+ * Data that was overwritten without reallocating the cluster block is not detected
+ * Returns 1 if successful, 0 if the digest index file does not match the file or -1 on error
+ */
+int libqcow_file_verify_digest_index(
+     libqcow_file_t *file,
+     const char *filename,
+     int number_of_threads,
+     uint64_t *number_of_changed_cluster_blocks,
+     uint64_t *number_of_mismatches,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_digest_index_t *digest_index   = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_verify_digest_index";
+	int result                             = 0;
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_changed_cluster_blocks == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of changed cluster blocks.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_mismatches == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of mismatches.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_changed_cluster_blocks = 0;
+	*number_of_mismatches             = 0;
+
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open digest index file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( libqcow_digest_index_initialize(
+	     &digest_index,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     LIBQCOW_HASH_TYPE_SHA256,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create digest index.",
+		 function );
+
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+
+		goto on_error;
+	}
+	result = libqcow_digest_index_read_file_io_handle(
+	          digest_index,
+	          file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read digest index.",
+		 function );
+
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close digest index file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( result == 1 )
+	{
+		if( libqcow_internal_file_update_digest_index(
+		     internal_file,
+		     digest_index,
+		     number_of_threads,
+		     number_of_changed_cluster_blocks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to calculate digests.",
+			 function );
+
+			goto on_error;
+		}
+		*number_of_mismatches = digest_index->number_of_mismatches;
+	}
+	if( libqcow_digest_index_free(
+	     &digest_index,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free digest index.",
+		 function );
+
+		goto on_error;
+	}
+	return( result );
+
+on_error:
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Retrieves the number of snapshots
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_number_of_snapshots(
+     libqcow_file_t *file,
+     int *number_of_snapshots,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_number_of_snapshots";
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
 
-					return( -1 );
-				}
-*/
-			}
-			if( memory_copy(
-			     &( ( (uint8_t *) buffer )[ buffer_offset ] ),
-			     &( cluster_block->data[ cluster_block_offset ] ),
-			     read_size ) == NULL )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_MEMORY,
-				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-				 "%s: unable to copy cluster block data to buffer.",
-				 function );
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
 
-				return( -1 );
-			}
-		}
-		else if( cluster_block_file_offset > 0 )
-		{
-			/* For version 2 make sure the sure the last cluster block size
-			 * stays within the bounds of the size of the file
-			 */
-			if( ( ( internal_file->io_handle->format_version == 2 )
-			  ||  ( internal_file->io_handle->format_version == 3 ) )
-			 && ( ( cluster_block_file_offset + internal_file->io_handle->cluster_block_size ) > internal_file->size ) )
-			{
-				compressed_cluster_block_size = (size_t) ( internal_file->size - cluster_block_file_offset );
+	if( number_of_snapshots == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of snapshots.",
+		 function );
 
-#if defined( HAVE_DEBUG_OUTPUT )
-				if( libcnotify_verbose != 0 )
-				{
-					libcnotify_printf(
-					 "%s: last cluster block offset\t\t: 0x%08" PRIx64 "\n",
-					 function,
-					 cluster_block_file_offset );
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
 
-					libcnotify_printf(
-					 "%s: last cluster block size\t\t\t: %" PRIzd "\n",
-					 function,
-					 compressed_cluster_block_size );
-				}
+		return( -1 );
+	}
 #endif
-				cache_entry_index = cluster_block_file_offset % LIBQCOW_MAXIMUM_CACHE_ENTRIES_CLUSTER_BLOCKS;
+	*number_of_snapshots = internal_file->number_of_snapshots;
 
-/* TODO check cache */
-				{
-					cluster_block = NULL;
-
-					if( libqcow_cluster_block_initialize(
-					     &cluster_block,
-					     compressed_cluster_block_size,
-					     error ) != 1 )
-					{
-						libcerror_error_set(
-						 error,
-						 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-						 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-						 "%s: unable to create cluster block.",
-						 function );
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
 
-						return( -1 );
-					}
-					if( libqcow_cluster_block_read(
-					     cluster_block,
-					     file_io_handle,
-					     cluster_block_file_offset,
-					     error ) != 1 )
-					{
-						libcerror_error_set(
-						 error,
-						 LIBCERROR_ERROR_DOMAIN_IO,
-						 LIBCERROR_IO_ERROR_READ_FAILED,
-						 "%s: unable to read compressed cluster block.",
-						 function );
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
 
-						libqcow_cluster_block_free(
-						 &cluster_block,
-						 NULL );
+/* Retrieves a specific snapshot
+ * The snapshot is a read-only view of the media data at the time the snapshot was created
+ * It shares the level 2 table and cluster block caches with the file
+ * The snapshot must be freed before the file is closed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_snapshot_by_index(
+     libqcow_file_t *file,
+     int snapshot_index,
+     libqcow_snapshot_t **snapshot,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_snapshot_by_index";
+	int result                             = 1;
 
-						return( -1 );
-					}
-					if( libfcache_cache_set_value_by_index(
-					     internal_file->compressed_cluster_block_cache,
-					     cache_entry_index,
-					     0,
-					     cluster_block_file_offset,
-					     0,
-					     (intptr_t *) cluster_block,
-					     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free,
-					     LIBFCACHE_CACHE_VALUE_FLAG_MANAGED,
-					     error ) != 1 )
-					{
-						libcerror_error_set(
-						 error,
-						 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-						 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-						 "%s: unable to set value in cache entry: %d.",
-						 function,
-						 cache_entry_index );
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
 
-						libqcow_cluster_block_free(
-						 &cluster_block,
-						 NULL );
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
 
-						return( -1 );
-					}
-				}
-			}
-			else
-			{
-				if( libfdata_vector_get_element_value_at_offset(
-				     internal_file->cluster_block_vector,
-				     (intptr_t *) file_io_handle,
-				     internal_file->cluster_block_cache,
-				     (off64_t) cluster_block_file_offset,
-				     &element_data_offset,
-				     (intptr_t **) &cluster_block,
-				     0,
-				     error ) != 1 )
-				{
-					libcerror_error_set(
-					 error,
-					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-					 "%s: unable to retrieve cluster block at offset: 0x%08" PRIx64 ".",
-					 function,
-					 cluster_block_file_offset );
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
 
-					return( -1 );
-				}
-			}
-			if( cluster_block == NULL )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-				 "%s: invalid cluster block.",
-				 function );
+		return( -1 );
+	}
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
 
-				return( -1 );
-			}
-			if( cluster_block->data == NULL )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-				 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-				 "%s: invalid cluster block - missing data.",
-				 function );
+		return( -1 );
+	}
+	if( *snapshot != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid snapshot value already set.",
+		 function );
 
-				return( -1 );
-			}
-			if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
-			{
-				if( cluster_block->encrypted_data == NULL )
-				{
-					cluster_block->encrypted_data = cluster_block->data;
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
 
-					cluster_block->data = (uint8_t *) memory_allocate(
-									   sizeof( uint8_t ) * cluster_block->data_size );
+		return( -1 );
+	}
+#endif
+	if( ( snapshot_index < 0 )
+	 || ( snapshot_index >= internal_file->number_of_snapshots ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid snapshot index value out of bounds.",
+		 function );
 
-					if( cluster_block->data == NULL )
-					{
-						libcerror_error_set(
-						 error,
-						 LIBCERROR_ERROR_DOMAIN_MEMORY,
-						 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
-						 "%s: unable to create cluster block data.",
-						 function );
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The level 1 table of the snapshot is read using the file IO handle
+	 * that is shared with the read-ahead thread
+	 */
+	if( result == 1 )
+	{
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
 
-						return( -1 );
-					}
-					if( libqcow_encryption_crypt(
-					     internal_file->encryption_context,
-					     LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT,
-					     cluster_block->encrypted_data,
-					     cluster_block->data_size,
-					     cluster_block->data,
-					     cluster_block->data_size,
-					     (uint64_t) ( internal_file->current_offset - cluster_block_offset ) / 512,
-					     error ) != 1 )
-					{
-						libcerror_error_set(
-						 error,
-						 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
-						 LIBCERROR_ENCRYPTION_ERROR_GENERIC,
-						 "%s: unable to decrypt cluster block data.",
-						 function );
+			result = -1;
+		}
+	}
+#endif
+	if( result == 1 )
+	{
+		if( libqcow_snapshot_initialize(
+		     snapshot,
+		     internal_file,
+		     internal_file->snapshot_values_array[ snapshot_index ],
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create snapshot: %d.",
+			 function,
+			 snapshot_index );
 
-						return( -1 );
-					}
-				}
-			}
-			if( memory_copy(
-			     &( ( (uint8_t *) buffer )[ buffer_offset ] ),
-			     &( cluster_block->data[ cluster_block_offset ] ),
-			     read_size ) == NULL )
-			{
-				libcerror_error_set(
-				 error,
-				 LIBCERROR_ERROR_DOMAIN_MEMORY,
-				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-				 "%s: unable to copy cluster block data to buffer.",
-				 function );
+			result = -1;
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
 
-				return( -1 );
-			}
+			result = -1;
 		}
-		internal_file->current_offset += read_size;
-		buffer_offset                 += read_size;
+#endif
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
 
-#if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
-		{
-			libcnotify_printf(
-			 "\n" );
-		}
+		result = -1;
+	}
 #endif
-		if( (size64_t) internal_file->current_offset >= internal_file->io_handle->media_size )
-		{
-			break;
-		}
+	if( ( result != 1 )
+	 && ( *snapshot != NULL ) )
+	{
+		libqcow_snapshot_free(
+		 snapshot,
+		 NULL );
 	}
-	return( (ssize_t) buffer_offset );
+	return( result );
 }
 
-/* Reads (media) data from the current offset into a buffer
- * Returns the number of bytes read or -1 on error
+/* Retrieves the number of bitmaps
+ * Returns 1 if successful or -1 on error
  */
-ssize_t libqcow_file_read_buffer(
-         libqcow_file_t *file,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error )
+int libqcow_file_get_number_of_bitmaps(
+     libqcow_file_t *file,
+     int *number_of_bitmaps,
+     libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_read_buffer";
-	ssize_t read_count                     = 0;
+	static char *function                  = "libqcow_file_get_number_of_bitmaps";
 
 	if( file == NULL )
 	{
@@ -2095,19 +26571,36 @@ ssize_t libqcow_file_read_buffer(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->file_io_handle == NULL )
+	if( number_of_bitmaps == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of bitmaps.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
+#endif
+	*number_of_bitmaps = internal_file->number_of_bitmaps;
+
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_write(
+	if( libcthreads_read_write_lock_release_for_read(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2115,32 +26608,44 @@ ssize_t libqcow_file_read_buffer(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for writing.",
+		 "%s: unable to release read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	read_count = libqcow_internal_file_read_buffer_from_file_io_handle(
-		      internal_file,
-		      internal_file->file_io_handle,
-		      buffer,
-		      buffer_size,
-		      error );
+	return( 1 );
+}
 
-	if( read_count == -1 )
+/* Retrieves the size of the UTF-8 encoded name of a specific bitmap
+ * The returned size includes the end of string character
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_file_get_utf8_bitmap_name_size(
+     libqcow_file_t *file,
+     int bitmap_index,
+     size_t *utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_utf8_bitmap_name_size";
+	int result                             = 1;
+
+	if( file == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read buffer.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
 		 function );
 
-		read_count = -1;
+		return( -1 );
 	}
+	internal_file = (libqcow_internal_file_t *) file;
+
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
+	if( libcthreads_read_write_lock_grab_for_read(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2148,28 +26653,71 @@ ssize_t libqcow_file_read_buffer(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for writing.",
+		 "%s: unable to grab read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	return( read_count );
+	if( ( bitmap_index < 0 )
+	 || ( bitmap_index >= internal_file->number_of_bitmaps ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap index value out of bounds.",
+		 function );
+
+		result = -1;
+	}
+	else if( libqcow_bitmap_values_get_utf8_name_size(
+	          internal_file->bitmap_values_array[ bitmap_index ],
+	          utf8_string_size,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 name size of bitmap: %d.",
+		 function,
+		 bitmap_index );
+
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
 }
 
-/* Reads (media) data at a specific offset
- * Returns the number of bytes read or -1 on error
+/* Retrieves the UTF-8 encoded name of a specific bitmap
+ * The size should include the end of string character
+ * Returns 1 if successful or -1 on error
  */
-ssize_t libqcow_file_read_buffer_at_offset(
-         libqcow_file_t *file,
-         void *buffer,
-         size_t buffer_size,
-         off64_t offset,
-         libcerror_error_t **error )
+int libqcow_file_get_utf8_bitmap_name(
+     libqcow_file_t *file,
+     int bitmap_index,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_read_buffer_at_offset";
-	ssize_t read_count                     = 0;
+	static char *function                  = "libqcow_file_get_utf8_bitmap_name";
+	int result                             = 1;
 
 	if( file == NULL )
 	{
@@ -2184,19 +26732,51 @@ ssize_t libqcow_file_read_buffer_at_offset(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->file_io_handle == NULL )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
+#endif
+	if( ( bitmap_index < 0 )
+	 || ( bitmap_index >= internal_file->number_of_bitmaps ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap index value out of bounds.",
+		 function );
+
+		result = -1;
+	}
+	else if( libqcow_bitmap_values_get_utf8_name(
+	          internal_file->bitmap_values_array[ bitmap_index ],
+	          utf8_string,
+	          utf8_string_size,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 name of bitmap: %d.",
+		 function,
+		 bitmap_index );
+
+		result = -1;
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_write(
+	if( libcthreads_read_write_lock_release_for_read(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2204,47 +26784,56 @@ ssize_t libqcow_file_read_buffer_at_offset(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for writing.",
+		 "%s: unable to release read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	if( libqcow_internal_file_seek_offset(
-	     internal_file,
-	     offset,
-	     SEEK_SET,
-	     error ) == -1 )
+	return( result );
+}
+
+/* Retrieves the index of the bitmap with a specific UTF-8 encoded name
+ * Returns 1 if successful, 0 if no such bitmap or -1 on error
+ */
+int libqcow_file_get_bitmap_index_by_utf8_name(
+     libqcow_file_t *file,
+     const uint8_t *utf8_string,
+     size_t utf8_string_length,
+     int *bitmap_index,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_bitmap_index_by_utf8_name";
+	int result                             = 0;
+	int safe_bitmap_index                  = 0;
+
+	if( file == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	read_count = libqcow_internal_file_read_buffer_from_file_io_handle(
-		      internal_file,
-		      internal_file->file_io_handle,
-		      buffer,
-		      buffer_size,
-		      error );
+	internal_file = (libqcow_internal_file_t *) file;
 
-	if( read_count == -1 )
+	if( bitmap_index == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read buffer.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid bitmap index.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
+	if( libcthreads_read_write_lock_grab_for_read(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2252,56 +26841,75 @@ ssize_t libqcow_file_read_buffer_at_offset(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for writing.",
+		 "%s: unable to grab read/write lock for reading.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	return( read_count );
+	for( safe_bitmap_index = 0;
+	     safe_bitmap_index < internal_file->number_of_bitmaps;
+	     safe_bitmap_index++ )
+	{
+		result = libqcow_bitmap_values_compare_name_with_utf8_string(
+		          internal_file->bitmap_values_array[ safe_bitmap_index ],
+		          utf8_string,
+		          utf8_string_length,
+		          error );
 
-on_error:
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	libcthreads_read_write_lock_release_for_write(
-	 internal_file->read_write_lock,
-	 NULL );
-#endif
-	return( -1 );
-}
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to compare name of bitmap: %d with UTF-8 string.",
+			 function,
+			 safe_bitmap_index );
 
-#ifdef TODO_WRITE_SUPPORT
+			break;
+		}
+		else if( result != 0 )
+		{
+			*bitmap_index = safe_bitmap_index;
 
-/* Writes (media) data at the current offset from a buffer using a Basic File IO (bfio) handle
- * the necessary settings of the write values must have been made
- * Will initialize write if necessary
- * This function is not multi-thread safe acquire write lock before call
- * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
- */
-ssize_t libqcow_internal_file_write_buffer_to_file_io_handle(
-         libqcow_internal_file_t *internal_file,
-         libbfio_handle_t *file_io_handle,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error )
-{
-/* TODO implement */
-	return( -1 );
+			break;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
 }
 
-/* Writes (media) data at the current offset
- * the necessary settings of the write values must have been made
- * Will initialize write if necessary
- * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
+/* Retrieves the next dirty range of a specific bitmap at or after a specific offset
+ * The range is a contiguous run of media data that is marked dirty by the bitmap
+ * The bitmap table and data are read on demand
+ * Returns 1 if successful, 0 if no more dirty ranges or -1 on error
  */
-ssize_t libqcow_file_write_buffer(
-         libqcow_file_t *file,
-         const void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error )
+int libqcow_file_get_next_dirty_range(
+     libqcow_file_t *file,
+     int bitmap_index,
+     off64_t offset,
+     off64_t *range_offset,
+     size64_t *range_size,
+     libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_write_buffer";
-	ssize_t write_count                    = 0;
+	static char *function                  = "libqcow_file_get_next_dirty_range";
+	int result                             = 0;
 
 	if( file == NULL )
 	{
@@ -2316,6 +26924,17 @@ ssize_t libqcow_file_write_buffer(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
 	if( internal_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
@@ -2328,6 +26947,8 @@ ssize_t libqcow_file_write_buffer(
 		return( -1 );
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The bitmap values cache the most recently read bitmap cluster
+	 */
 	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
@@ -2342,23 +26963,76 @@ ssize_t libqcow_file_write_buffer(
 		return( -1 );
 	}
 #endif
-	write_count = libqcow_internal_file_write_buffer_to_file_io_handle(
-	               internal_file,
-	               internal_file->file_io_handle,
-	               buffer,
-	               buffer_size,
-	               error );
-
-	if( write_count == -1 )
+	if( ( bitmap_index < 0 )
+	 || ( bitmap_index >= internal_file->number_of_bitmaps ) )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to write buffer.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bitmap index value out of bounds.",
 		 function );
 
-		write_count = -1;
+		result = -1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The bitmap is read using the file IO handle
+	 * that is shared with the read-ahead thread
+	 */
+	if( result == 0 )
+	{
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	if( result == 0 )
+	{
+		result = libqcow_bitmap_values_get_next_dirty_range(
+		          internal_file->bitmap_values_array[ bitmap_index ],
+		          internal_file->file_io_handle,
+		          internal_file->io_handle->cluster_block_size,
+		          internal_file->io_handle->media_size,
+		          offset,
+		          range_offset,
+		          range_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve next dirty range of bitmap: %d.",
+			 function,
+			 bitmap_index );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_release_for_write(
@@ -2375,24 +27049,22 @@ ssize_t libqcow_file_write_buffer(
 		return( -1 );
 	}
 #endif
-	return( write_count );
+	return( result );
 }
 
-/* Writes (media) data at a specific offset,
- * the necessary settings of the write values must have been made
- * Will initialize write if necessary
- * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
+/* Retrieves the number of used host cluster blocks
+ * A host cluster block is used if its reference count is not 0
+ * The host allocation statistics are not available for format version 1
+ * Returns 1 if successful, 0 if not available or -1 on error
  */
-ssize_t libqcow_file_write_buffer_at_offset(
-         libqcow_file_t *file,
-         const void *buffer,
-         size_t buffer_size,
-         off64_t offset,
-         libcerror_error_t **error )
+int libqcow_file_get_number_of_used_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_used_clusters,
+     libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_write_buffer_at_offset";
-	ssize_t write_count                    = 0;
+	static char *function                  = "libqcow_file_get_number_of_used_clusters";
+	int result                             = 0;
 
 	if( file == NULL )
 	{
@@ -2407,13 +27079,13 @@ ssize_t libqcow_file_write_buffer_at_offset(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->file_io_handle == NULL )
+	if( number_of_used_clusters == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of used clusters.",
 		 function );
 
 		return( -1 );
@@ -2433,38 +27105,22 @@ ssize_t libqcow_file_write_buffer_at_offset(
 		return( -1 );
 	}
 #endif
-	if( libqcow_internal_file_seek_offset(
-	     internal_file,
-	     offset,
-	     SEEK_SET,
-	     error ) == -1 )
+	result = libqcow_internal_file_get_host_allocation_statistics(
+	          internal_file,
+	          error );
+
+	if( result == -1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve host allocation statistics.",
 		 function );
-
-		goto on_error;
 	}
-	write_count = libqcow_internal_file_write_buffer_to_file_io_handle(
-	               internal_file,
-	               internal_file->file_io_handle,
-	               buffer,
-	               buffer_size,
-	               error );
-
-	if( write_count == -1 )
+	else if( result != 0 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to write buffer.",
-		 function );
-
-		goto on_error;
+		*number_of_used_clusters = internal_file->number_of_used_clusters;
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_release_for_write(
@@ -2481,32 +27137,24 @@ ssize_t libqcow_file_write_buffer_at_offset(
 		return( -1 );
 	}
 #endif
-	return( write_count );
-
-on_error:
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	libcthreads_read_write_lock_release_for_write(
-	 internal_file->read_write_lock,
-	 NULL );
-#endif
-	return( -1 );
+	return( result );
 }
 
-#endif /* TODO_WRITE_SUPPORT */
-
-/* Seeks a certain offset of the (media) data
- * This function is not multi-thread safe acquire write lock before call
- * Returns the offset if seek is successful or -1 on error
+/* Retrieves the number of leaked host cluster blocks
+ * A host cluster block is leaked if it is used but not referenced by any of
+ * the metadata or the level 1 tables of the file or its snapshots
+ * Returns 1 if successful, 0 if not available or -1 on error
  */
-off64_t libqcow_internal_file_seek_offset(
-         libqcow_internal_file_t *internal_file,
-         off64_t offset,
-         int whence,
-         libcerror_error_t **error )
+int libqcow_file_get_number_of_leaked_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_leaked_clusters,
+     libcerror_error_t **error )
 {
-	static char *function = "libqcow_internal_file_seek_offset";
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_file_get_number_of_leaked_clusters";
+	int result                             = 0;
 
-	if( internal_file == NULL )
+	if( file == NULL )
 	{
 		libcerror_error_set(
 		 error,
@@ -2517,65 +27165,82 @@ off64_t libqcow_internal_file_seek_offset(
 
 		return( -1 );
 	}
-	if( internal_file->io_handle == NULL )
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( number_of_leaked_clusters == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of leaked clusters.",
 		 function );
 
 		return( -1 );
 	}
-	if( ( whence != SEEK_CUR )
-	 && ( whence != SEEK_END )
-	 && ( whence != SEEK_SET ) )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: unsupported whence.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
 		return( -1 );
 	}
-	if( whence == SEEK_CUR )
+#endif
+	result = libqcow_internal_file_get_host_allocation_statistics(
+	          internal_file,
+	          error );
+
+	if( result == -1 )
 	{
-		offset += internal_file->current_offset;
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve host allocation statistics.",
+		 function );
 	}
-	else if( whence == SEEK_END )
+	else if( result != 0 )
 	{
-		offset += (off64_t) internal_file->io_handle->media_size;
+		*number_of_leaked_clusters = internal_file->number_of_leaked_clusters;
 	}
-	if( offset < 0 )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
-		 "%s: invalid offset value out of bounds.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
 		return( -1 );
 	}
-	internal_file->current_offset = offset;
-
-	return( offset );
+#endif
+	return( result );
 }
 
-/* Seeks a certain offset of the (media) data
- * Returns the offset if seek is successful or -1 on error
+/* Retrieves the number of shared host cluster blocks
+ * A host cluster block is shared if its reference count is larger than 1,
+ * for example when it is referenced by a snapshot
+ * Returns 1 if successful, 0 if not available or -1 on error
  */
-off64_t libqcow_file_seek_offset(
-         libqcow_file_t *file,
-         off64_t offset,
-         int whence,
-         libcerror_error_t **error )
+int libqcow_file_get_number_of_shared_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_shared_clusters,
+     libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_seek_offset";
+	static char *function                  = "libqcow_file_get_number_of_shared_clusters";
+	int result                             = 0;
 
 	if( file == NULL )
 	{
@@ -2590,13 +27255,13 @@ off64_t libqcow_file_seek_offset(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->file_io_handle == NULL )
+	if( number_of_shared_clusters == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of shared clusters.",
 		 function );
 
 		return( -1 );
@@ -2616,22 +27281,22 @@ off64_t libqcow_file_seek_offset(
 		return( -1 );
 	}
 #endif
-	offset = libqcow_internal_file_seek_offset(
+	result = libqcow_internal_file_get_host_allocation_statistics(
 	          internal_file,
-	          offset,
-	          whence,
 	          error );
 
-	if( offset == -1 )
+	if( result == -1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve host allocation statistics.",
 		 function );
-
-		offset = -1;
+	}
+	else if( result != 0 )
+	{
+		*number_of_shared_clusters = internal_file->number_of_shared_clusters;
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
 	if( libcthreads_read_write_lock_release_for_write(
@@ -2648,57 +27313,50 @@ off64_t libqcow_file_seek_offset(
 		return( -1 );
 	}
 #endif
-	return( offset );
+	return( result );
 }
 
-/* Retrieves the current offset of the (media) data
- * Returns 1 if successful or -1 on error
+/* Retrieves the fragmentation ratio
+ * The fragmentation ratio is the fraction of consecutive data cluster blocks
+ * of the media that are not stored consecutively in the file, where 0.0
+ * indicates the data is stored fully contiguous
+ * Returns 1 if successful, 0 if not available or -1 on error
  */
-int libqcow_file_get_offset(
+int libqcow_file_get_fragmentation_ratio(
      libqcow_file_t *file,
-     off64_t *offset,
+     double *fragmentation_ratio,
      libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_get_offset";
+	static char *function                  = "libqcow_file_get_fragmentation_ratio";
+	int result                             = 0;
 
 	if( file == NULL )
 	{
 		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid file.",
-		 function );
-
-		return( -1 );
-	}
-	internal_file = (libqcow_internal_file_t *) file;
-
-	if( internal_file->file_io_handle == NULL )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
 		 function );
 
 		return( -1 );
 	}
-	if( offset == NULL )
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( fragmentation_ratio == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid offset.",
+		 "%s: invalid fragmentation ratio.",
 		 function );
 
 		return( -1 );
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_read(
+	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2706,16 +27364,31 @@ int libqcow_file_get_offset(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for reading.",
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	*offset = internal_file->current_offset;
+	result = libqcow_internal_file_get_host_allocation_statistics(
+	          internal_file,
+	          error );
 
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve host allocation statistics.",
+		 function );
+	}
+	else if( result != 0 )
+	{
+		*fragmentation_ratio = internal_file->fragmentation_ratio;
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_read(
+	if( libcthreads_read_write_lock_release_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2723,27 +27396,37 @@ int libqcow_file_get_offset(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for reading.",
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
 		return( -1 );
 	}
 #endif
-	return( 1 );
+	return( result );
 }
 
-/* Set the keys
- * This function needs to be used before one of the open functions
- * Returns 1 if successful or -1 on error
+/* Checks the consistency of the metadata of the file
+ * The level 1 and level 2 tables of the file and its snapshots are checked
+ * against the bounds of the file and the number of references to every host
+ * cluster block is compared with its reference count. The level 2 tables are
+ * checked by a pool of number_of_threads workers, where 0 represents the
+ * number of worker threads of the file
+ * The values are stored in the array by LIBQCOW_CONSISTENCY_CHECK_VALUES index
+ * Returns 1 if the file is consistent, 0 if not or -1 on error
  */
-int libqcow_file_set_keys(
+int libqcow_file_check_consistency(
      libqcow_file_t *file,
-     const uint8_t *key,
-     size_t key_size,
+     int flags,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
      libcerror_error_t **error )
 {
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_set_keys";
+	libqcow_consistency_check_t *consistency_check = NULL;
+	libqcow_internal_file_t *internal_file         = NULL;
+	static char *function                          = "libqcow_file_check_consistency";
+	int result                                     = 0;
+	int value_index                                = 0;
 
 	if( file == NULL )
 	{
@@ -2758,72 +27441,94 @@ int libqcow_file_set_keys(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->file_io_handle != NULL )
+	if( internal_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - file IO handle already set.",
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
 		 function );
 
 		return( -1 );
 	}
-	if( key == NULL )
+	if( ( flags & ~( LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA ) ) != 0 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid key.",
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported flags: 0x%08x.",
+		 function,
+		 flags );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
-	if( key_size != 16 )
+	if( values == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
-		 "%s: unsupported key size.",
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid values.",
 		 function );
 
 		return( -1 );
 	}
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_write(
-	     internal_file->read_write_lock,
-	     error ) != 1 )
+	if( number_of_values <= 0 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for writing.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of values value zero or less.",
 		 function );
 
 		return( -1 );
 	}
+	if( number_of_threads == 0 )
+	{
+		number_of_threads = internal_file->number_of_worker_threads;
+	}
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* Without multi-thread support all level 2 tables are checked in the calling thread
+	 */
+	number_of_threads = 1;
 #endif
-	if( memory_copy(
-	     internal_file->key_data,
-	     key,
-	     key_size ) == NULL )
+	if( number_of_threads <= 0 )
+	{
+		number_of_threads = 1;
+	}
+	if( libqcow_consistency_check_initialize(
+	     &consistency_check,
+	     file,
+	     flags,
+	     number_of_threads,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-		 "%s: unable to copy key.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create consistency check.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	internal_file->key_data_is_set = 1;
-
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
+	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2831,67 +27536,60 @@ int libqcow_file_set_keys(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for writing.",
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-#endif
-	return( 1 );
+	/* The file IO handle is shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
 
-on_error:
-	memory_set(
-	 internal_file->key_data,
-	 0,
-	 16 );
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
 
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	libcthreads_read_write_lock_release_for_write(
-	 internal_file->read_write_lock,
-	 NULL );
+		goto on_error;
+	}
 #endif
-	return( -1 );
-}
-
-/* Sets an UTF-8 formatted password
- * This function needs to be used before one of the open functions
- * Returns 1 if successful, 0 if password is invalid or -1 on error
- */
-int libqcow_file_set_utf8_password(
-     libqcow_file_t *file,
-     const uint8_t *utf8_string,
-     size_t utf8_string_length,
-     libcerror_error_t **error )
-{
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_set_utf8_password";
+	result = libqcow_consistency_check_read_metadata(
+	          consistency_check,
+	          internal_file->file_io_handle,
+	          error );
 
-	if( file == NULL )
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid file.",
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read metadata.",
 		 function );
-
-		return( -1 );
 	}
-	internal_file = (libqcow_internal_file_t *) file;
-
-	if( internal_file->file_io_handle != NULL )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - file IO handle already set.",
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
 		 function );
 
-		return( -1 );
+		result = -1;
 	}
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_write(
+	if( libcthreads_read_write_lock_release_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2899,47 +27597,34 @@ int libqcow_file_set_utf8_password(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for writing.",
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		result = -1;
 	}
 #endif
-	if( memory_set(
-	     internal_file->key_data,
-	     0,
-	     16 ) == NULL )
+	if( result != 1 )
 	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
-		 "%s: unable to clear key data.",
-		 function );
-
 		goto on_error;
 	}
-	if( libuna_byte_stream_copy_from_utf8(
-	     internal_file->key_data,
-	     16,
-	     LIBQCOW_CODEPAGE_US_ASCII,
-	     utf8_string,
-	     utf8_string_length,
+	/* The level 2 tables are checked without holding the locks of the file,
+	 * since the workers read using their own readers
+	 */
+	if( libqcow_consistency_check_run(
+	     consistency_check,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to copy password.",
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to run consistency check.",
 		 function );
 
 		goto on_error;
 	}
-	internal_file->key_data_is_set = 1;
-
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
+	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -2947,154 +27632,145 @@ int libqcow_file_set_utf8_password(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for writing.",
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-#endif
-	return( 1 );
-
-on_error:
-	memory_set(
-	 internal_file->key_data,
-	 0,
-	 16 );
-
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	libcthreads_read_write_lock_release_for_write(
-	 internal_file->read_write_lock,
-	 NULL );
-#endif
-	return( -1 );
-}
-
-/* Sets an UTF-16 formatted password
- * This function needs to be used before one of the open functions
- * Returns 1 if successful, 0 if password is invalid or -1 on error
- */
-int libqcow_file_set_utf16_password(
-     libqcow_file_t *file,
-     const uint16_t *utf16_string,
-     size_t utf16_string_length,
-     libcerror_error_t **error )
-{
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_set_utf16_password";
-
-	if( file == NULL )
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid file.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
 		 function );
 
-		return( -1 );
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
 	}
-	internal_file = (libqcow_internal_file_t *) file;
+#endif
+	result = libqcow_consistency_check_compare_reference_counts(
+	          consistency_check,
+	          internal_file->file_io_handle,
+	          error );
 
-	if( internal_file->file_io_handle != NULL )
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
-		 "%s: invalid file - file IO handle already set.",
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to compare reference counts.",
 		 function );
-
-		return( -1 );
 	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_write(
-	     internal_file->read_write_lock,
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for writing.",
-		 function );
-
-		return( -1 );
-	}
-#endif
-	if( memory_set(
-	     internal_file->key_data,
-	     0,
-	     16 ) == NULL )
-	{
-		libcerror_error_set(
-		 error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
-		 "%s: unable to clear key data.",
+		 "%s: unable to release cache mutex.",
 		 function );
 
-		goto on_error;
+		result = -1;
 	}
-	if( libuna_byte_stream_copy_from_utf16(
-	     internal_file->key_data,
-	     16,
-	     LIBQCOW_CODEPAGE_US_ASCII,
-	     utf16_string,
-	     utf16_string_length,
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to copy password.",
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
+		result = -1;
+	}
+#endif
+	if( result != 1 )
+	{
 		goto on_error;
 	}
-	internal_file->key_data_is_set = 1;
-
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_write(
-	     internal_file->read_write_lock,
+	for( value_index = 0;
+	     value_index < number_of_values;
+	     value_index++ )
+	{
+		if( value_index < LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES )
+		{
+			values[ value_index ] = consistency_check->values[ value_index ];
+		}
+		else
+		{
+			values[ value_index ] = 0;
+		}
+	}
+	if( ( consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] != 0 )
+	 || ( consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_CORRUPT_COMPRESSED_CLUSTERS ] != 0 )
+	 || ( consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_REFERENCE_COUNT_ERRORS ] != 0 )
+	 || ( consistency_check->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_LEAKED_CLUSTERS ] != 0 ) )
+	{
+		result = 0;
+	}
+	if( libqcow_consistency_check_free(
+	     &consistency_check,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for writing.",
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free consistency check.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-#endif
-	return( 1 );
+	return( result );
 
 on_error:
-	memory_set(
-	 internal_file->key_data,
-	 0,
-	 16 );
-
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	libcthreads_read_write_lock_release_for_write(
-	 internal_file->read_write_lock,
-	 NULL );
-#endif
+	if( consistency_check != NULL )
+	{
+		libqcow_consistency_check_free(
+		 &consistency_check,
+		 NULL );
+	}
 	return( -1 );
 }
 
-/* Retrieves the number of media size
+/* Samples the cluster blocks of the media to estimate its composition
+ * The media is divided into strata of cluster blocks and one cluster block
+ * per stratum is sampled, the number of samples is the sampling fraction
+ * of the number of cluster blocks. Only the level 2 table slices of the
+ * sampled cluster blocks are read. Unless LIBQCOW_SAMPLE_FLAG_METADATA_ONLY
+ * is set the data of the sampled allocated and compressed cluster blocks is
+ * read to determine their entropy. The cluster blocks are sampled by a pool
+ * of number_of_threads workers, where 0 represents the number of worker
+ * threads of the file
+ * The values are stored in the array by LIBQCOW_SAMPLE_VALUES index
  * Returns 1 if successful or -1 on error
  */
-int libqcow_file_get_media_size(
+int libqcow_file_sample(
      libqcow_file_t *file,
-     size64_t *media_size,
+     int flags,
+     double sampling_fraction,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
      libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_get_media_size";
+	libqcow_sampler_t *sampler             = NULL;
+	static char *function                  = "libqcow_file_sample";
+	int value_index                        = 0;
 
 	if( file == NULL )
 	{
@@ -3109,84 +27785,168 @@ int libqcow_file_get_media_size(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->io_handle == NULL )
+	if( internal_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing IO handle.",
+		 "%s: invalid file - missing file IO handle.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->file_io_handle == NULL )
+	if( ( flags & ~( LIBQCOW_SAMPLE_FLAG_METADATA_ONLY ) ) != 0 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported flags: 0x%08x.",
+		 function,
+		 flags );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
-	if( media_size == NULL )
+	if( values == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid media size.",
+		 "%s: invalid values.",
 		 function );
 
 		return( -1 );
 	}
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_read(
-	     internal_file->read_write_lock,
+	if( number_of_values <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of values value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_threads == 0 )
+	{
+		number_of_threads = internal_file->number_of_worker_threads;
+	}
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* Without multi-thread support all cluster blocks are sampled in the calling thread
+	 */
+	number_of_threads = 1;
+#endif
+	if( number_of_threads <= 0 )
+	{
+		number_of_threads = 1;
+	}
+	if( libqcow_sampler_initialize(
+	     &sampler,
+	     file,
+	     flags,
+	     sampling_fraction,
+	     number_of_threads,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for reading.",
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create sampler.",
 		 function );
 
 		return( -1 );
 	}
-#endif
-	*media_size = internal_file->io_handle->media_size;
+	/* The cluster blocks are sampled without holding the locks of the file,
+	 * since the workers read using their own readers
+	 */
+	if( libqcow_sampler_run(
+	     sampler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to run sampler.",
+		 function );
 
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_read(
-	     internal_file->read_write_lock,
+		goto on_error;
+	}
+	for( value_index = 0;
+	     value_index < number_of_values;
+	     value_index++ )
+	{
+		if( value_index < LIBQCOW_NUMBER_OF_SAMPLE_VALUES )
+		{
+			values[ value_index ] = sampler->values[ value_index ];
+		}
+		else
+		{
+			values[ value_index ] = 0;
+		}
+	}
+	if( libqcow_sampler_free(
+	     &sampler,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for reading.",
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free sampler.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-#endif
 	return( 1 );
+
+on_error:
+	if( sampler != NULL )
+	{
+		libqcow_sampler_free(
+		 &sampler,
+		 NULL );
+	}
+	return( -1 );
 }
 
-/* Retrieves the format version
+/* Scans the level 2 tables of the active level 1 table to determine the layout of the media
+ * The allocated, compressed, zero and sparse parts of the media and the number of
+ * host runs, which are the ranges of adjacent allocated cluster blocks that are
+ * stored adjacently in the file, are determined. The level 2 tables are scanned
+ * by a pool of number_of_threads workers, where 0 represents the number of worker
+ * threads of the file
+ * The values are stored in the array by LIBQCOW_LAYOUT_VALUES index
  * Returns 1 if successful or -1 on error
  */
-int libqcow_file_get_format_version(
+int libqcow_file_scan_layout(
      libqcow_file_t *file,
-     uint32_t *format_version,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
      libcerror_error_t **error )
 {
 	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_get_format_version";
+	libqcow_layout_scan_t *layout_scan     = NULL;
+	static char *function                  = "libqcow_file_scan_layout";
+	int result                             = 0;
+	int value_index                        = 0;
 
 	if( file == NULL )
 	{
@@ -3201,58 +27961,81 @@ int libqcow_file_get_format_version(
 	}
 	internal_file = (libqcow_internal_file_t *) file;
 
-	if( internal_file->io_handle == NULL )
+	if( internal_file->file_io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing IO handle.",
+		 "%s: invalid file - missing file IO handle.",
 		 function );
 
 		return( -1 );
 	}
-	if( internal_file->file_io_handle == NULL )
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
 		 function );
 
 		return( -1 );
 	}
-	if( format_version == NULL )
+	if( values == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
 		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid format version.",
+		 "%s: invalid values.",
 		 function );
 
 		return( -1 );
 	}
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_read(
-	     internal_file->read_write_lock,
-	     error ) != 1 )
+	if( number_of_values <= 0 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for reading.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of values value zero or less.",
 		 function );
 
 		return( -1 );
 	}
+	if( number_of_threads == 0 )
+	{
+		number_of_threads = internal_file->number_of_worker_threads;
+	}
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* Without multi-thread support all level 2 tables are scanned in the calling thread
+	 */
+	number_of_threads = 1;
 #endif
-	*format_version = internal_file->io_handle->format_version;
+	if( number_of_threads <= 0 )
+	{
+		number_of_threads = 1;
+	}
+	if( libqcow_layout_scan_initialize(
+	     &layout_scan,
+	     file,
+	     number_of_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create layout scan.",
+		 function );
 
+		return( -1 );
+	}
 #if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_read(
+	if( libcthreads_read_write_lock_grab_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -3260,63 +28043,60 @@ int libqcow_file_get_format_version(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for reading.",
+		 "%s: unable to grab read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		goto on_error;
 	}
-#endif
-	return( 1 );
-}
-
-/* Retrieves the encryption method
- * Returns 1 if successful or -1 on error
- */
-int libqcow_file_get_encryption_method(
-     libqcow_file_t *file,
-     uint32_t *encryption_method,
-     libcerror_error_t **error )
-{
-	libqcow_internal_file_t *internal_file = NULL;
-	static char *function                  = "libqcow_file_get_encryption_method";
-
-	if( file == NULL )
+	/* The file IO handle is shared with the read-ahead thread
+	 */
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid file.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
 		 function );
 
-		return( -1 );
+		libcthreads_read_write_lock_release_for_write(
+		 internal_file->read_write_lock,
+		 NULL );
+
+		goto on_error;
 	}
-	internal_file = (libqcow_internal_file_t *) file;
+#endif
+	result = libqcow_layout_scan_read_metadata(
+	          layout_scan,
+	          internal_file->file_io_handle,
+	          error );
 
-	if( internal_file->file_io_handle == NULL )
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
-		 "%s: invalid file - missing file IO handle.",
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read metadata.",
 		 function );
-
-		return( -1 );
 	}
-	if( encryption_method == NULL )
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
-		 "%s: invalid encryption method.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
 		 function );
 
-		return( -1 );
+		result = -1;
 	}
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_grab_for_read(
+	if( libcthreads_read_write_lock_release_for_write(
 	     internal_file->read_write_lock,
 	     error ) != 1 )
 	{
@@ -3324,29 +28104,80 @@ int libqcow_file_get_encryption_method(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to grab read/write lock for reading.",
+		 "%s: unable to release read/write lock for writing.",
 		 function );
 
-		return( -1 );
+		result = -1;
 	}
 #endif
-	*encryption_method = internal_file->encryption_method;
+	if( result != 1 )
+	{
+		goto on_error;
+	}
+	/* The level 2 tables are scanned without holding the locks of the file,
+	 * since the workers read using their own readers
+	 */
+	if( libqcow_layout_scan_run(
+	     layout_scan,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to run layout scan.",
+		 function );
 
-#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
-	if( libcthreads_read_write_lock_release_for_read(
-	     internal_file->read_write_lock,
+		goto on_error;
+	}
+	if( libqcow_layout_scan_merge_host_runs(
+	     layout_scan,
 	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to release read/write lock for reading.",
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to merge host runs.",
 		 function );
 
-		return( -1 );
+		goto on_error;
+	}
+	for( value_index = 0;
+	     value_index < number_of_values;
+	     value_index++ )
+	{
+		if( value_index < LIBQCOW_NUMBER_OF_LAYOUT_VALUES )
+		{
+			values[ value_index ] = layout_scan->values[ value_index ];
+		}
+		else
+		{
+			values[ value_index ] = 0;
+		}
+	}
+	if( libqcow_layout_scan_free(
+	     &layout_scan,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free layout scan.",
+		 function );
+
+		goto on_error;
 	}
-#endif
 	return( 1 );
+
+on_error:
+	if( layout_scan != NULL )
+	{
+		libqcow_layout_scan_free(
+		 &layout_scan,
+		 NULL );
+	}
+	return( -1 );
 }
 
@@ -25,21 +25,73 @@
 #include <common.h>
 #include <types.h>
 
+#include "libqcow_bitmap_values.h"
+#include "libqcow_block_cache.h"
+#include "libqcow_cache.h"
+#include "libqcow_cache_state.h"
+#include "libqcow_chain_index.h"
+#include "libqcow_cluster_block.h"
+#include "libqcow_cluster_block_pool.h"
 #include "libqcow_cluster_table.h"
+#include "libqcow_compression.h"
+#include "libqcow_creator.h"
+#include "libqcow_definitions.h"
+#include "libqcow_digest_index.h"
 #include "libqcow_encryption.h"
 #include "libqcow_extern.h"
 #include "libqcow_io_handle.h"
+#include "libqcow_io_scheduler.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libcthreads.h"
-#include "libqcow_libfcache.h"
-#include "libqcow_libfdata.h"
+#include "libqcow_io_uring.h"
+#include "libqcow_memory_map.h"
+#include "libqcow_metadata_index.h"
+#include "libqcow_numa.h"
+#include "libqcow_page_cache.h"
+#include "libqcow_read_request.h"
+#include "libqcow_reference_count_table.h"
+#include "libqcow_scratch_overlay.h"
+#include "libqcow_snapshot_values.h"
+#include "libqcow_statistics.h"
+#include "libqcow_translation_cache.h"
+#include "libqcow_write_cache.h"
 
 #if defined( __cplusplus )
 extern "C" {
 #endif
 
 typedef struct libqcow_internal_file libqcow_internal_file_t;
+typedef struct libqcow_vector_segment libqcow_vector_segment_t;
+
+/* A segment is the part of a buffer of a vectored read that is within a single cluster block
+ */
+struct libqcow_vector_segment
+{
+	/* The index of the buffer
+	 */
+	int buffer_index;
+
+	/* The offset of the segment relative to the start of the buffer
+	 */
+	size_t buffer_offset;
+
+	/* The (media) offset
+	 */
+	off64_t offset;
+
+	/* The size
+	 */
+	size_t size;
+
+	/* The cluster block reference
+	 */
+	uint64_t cluster_block_reference;
+
+	/* The file offset by which the segments are sorted
+	 */
+	uint64_t sort_offset;
+};
 
 struct libqcow_internal_file
 {
@@ -63,6 +115,26 @@ struct libqcow_internal_file
 	 */
 	uint8_t file_io_handle_opened_in_library;
 
+	/* The external data file IO handle
+	 */
+	libbfio_handle_t *data_file_io_handle;
+
+	/* Value to indicate if the external data file IO handle was created inside the library
+	 */
+	uint8_t data_file_io_handle_created_in_library;
+
+	/* The memory map
+	 */
+	libqcow_memory_map_t *memory_map;
+
+	/* The io_uring used for asynchronous reads
+	 */
+	libqcow_io_uring_t *io_uring;
+
+	/* The page cache used to pass access advice to the operating system
+	 */
+	libqcow_page_cache_t *page_cache;
+
 	/* The (file) size
 	 */
 	size64_t size;
@@ -75,37 +147,250 @@ struct libqcow_internal_file
 	 */
 	libqcow_encryption_context_t *encryption_context;
 
-	/* The key data
+	/* The key data, which contains the (LUKS) master key for LUKS encryption
+	 */
+	uint8_t key_data[ LIBQCOW_LUKS_MAXIMUM_KEY_SIZE ];
+
+	/* The key data size
 	 */
-	uint8_t key_data[ 16 ];
+	size_t key_data_size;
 
 	/* Value to indicate the key data is set
 	 */
 	uint8_t key_data_is_set;
 
+	/* The (UTF-8 formatted) password, which is used to unlock the LUKS key slots
+	 */
+	uint8_t *password;
+
+	/* The password size
+	 */
+	size_t password_size;
+
+	/* The decompression context
+	 */
+	libqcow_decompression_context_t *decompression_context;
+
+	/* The parent (backing) file
+	 */
+	libqcow_file_t *parent_file;
+
+	/* Value to indicate if the parent file was created inside the library
+	 */
+	uint8_t parent_file_created_in_library;
+
+	/* The depth of the file in the backing file chain
+	 */
+	int backing_file_chain_depth;
+
+	/* The chain index
+	 */
+	libqcow_chain_index_t *chain_index;
+
+	/* The metadata index
+	 */
+	libqcow_metadata_index_t *metadata_index;
+
+	/* The snapshot values array
+	 */
+	libqcow_snapshot_values_t **snapshot_values_array;
+
+	/* The number of snapshots
+	 */
+	int number_of_snapshots;
+
+	/* The snapshot table size
+	 */
+	size64_t snapshot_table_size;
+
+	/* The bitmap values array
+	 */
+	libqcow_bitmap_values_t **bitmap_values_array;
+
+	/* The number of bitmaps
+	 */
+	int number_of_bitmaps;
+
+	/* The reference count table
+	 */
+	libqcow_reference_count_table_t *reference_count_table;
+
+	/* Value to indicate the host allocation statistics were determined
+	 */
+	uint8_t host_allocation_statistics_determined;
+
+	/* Value to indicate the host allocation statistics are available
+	 */
+	uint8_t host_allocation_statistics_available;
+
+	/* The number of used host cluster blocks
+	 */
+	uint64_t number_of_used_clusters;
+
+	/* The number of leaked host cluster blocks
+	 */
+	uint64_t number_of_leaked_clusters;
+
+	/* The number of shared host cluster blocks
+	 */
+	uint64_t number_of_shared_clusters;
+
+	/* The fragmentation ratio
+	 */
+	double fragmentation_ratio;
+
+	/* Value to indicate the data path structures, such as the level 1 table
+	 * and the caches, were created
+	 */
+	uint8_t data_path_is_initialized;
+
 	/* The level 1 table
 	 */
 	libqcow_cluster_table_t *level1_table;
 
-	/* The level 2 table vector
+	/* The level2 table cache
 	 */
-	libfdata_vector_t *level2_table_vector;
+	libqcow_block_cache_t *level2_table_cache;
 
-	/* The level2 table cache
+	/* The translation cache, which maps the (sub)clusters that were recently
+	 * looked up directly onto their cluster block reference
+	 */
+	libqcow_translation_cache_t *translation_cache;
+
+	/* The level2 table pool
 	 */
-	libfcache_cache_t *level2_table_cache;
+	libqcow_cluster_table_pool_t *level2_table_pool;
 
-	/* The cluster block vector
+	/* The cluster block pool
 	 */
-	libfdata_vector_t *cluster_block_vector;
+	libqcow_cluster_block_pool_t *cluster_block_pool;
 
 	/* The cluster block cache
 	 */
-	libfcache_cache_t *cluster_block_cache;
+	libqcow_block_cache_t *cluster_block_cache;
+
+	/* The maximum number of level 2 table cache entries
+	 */
+	int maximum_number_of_level2_table_cache_entries;
+
+	/* The maximum number of cluster block cache entries
+	 */
+	int maximum_number_of_cluster_block_cache_entries;
+
+	/* The maximum memory size, 0 represents no maximum
+	 */
+	size64_t maximum_memory_size;
+
+	/* The read flags
+	 */
+	int read_flags;
+
+	/* The function that reads the data of a single cluster block, this function
+	 * is selected for the configuration of the file when the file is opened
+	 */
+	ssize_t (*read_cluster_block_data)(
+	           libqcow_internal_file_t *internal_file,
+	           libbfio_handle_t *file_io_handle,
+	           off64_t offset,
+	           uint8_t *buffer,
+	           size_t buffer_size,
+	           libcerror_error_t **error );
+
+	/* The advised access pattern
+	 */
+	int access_advice;
+
+	/* The offset at which the last partial cluster block read ended
+	 */
+	off64_t partial_read_end_offset;
+
+	/* The offset at which the last level 2 table slice read ended
+	 */
+	off64_t level2_table_read_end_offset;
+
+	/* The compressed read window, which contains the compressed data
+	 * of adjacent compressed cluster blocks
+	 */
+	uint8_t *compressed_read_window;
+
+	/* The offset of the compressed read window in the file
+	 */
+	off64_t compressed_read_window_offset;
+
+	/* The size of the data in the compressed read window
+	 */
+	size_t compressed_read_window_data_size;
+
+	/* The offset of the compressed data of the last compressed cluster block read
+	 */
+	off64_t compressed_read_offset;
+
+	/* The offset at which the compressed data of the last compressed cluster block read ended
+	 */
+	off64_t compressed_read_end_offset;
+
+	/* The number of worker threads
+	 */
+	int number_of_worker_threads;
+
+	/* The asynchronous IO queue depth, 0 if disabled
+	 */
+	int io_queue_depth;
+
+	/* The host cache block size, 0 if disabled
+	 */
+	size_t host_cache_block_size;
+
+	/* The host cache number of blocks
+	 */
+	int host_cache_number_of_blocks;
+
+	/* The (host) file IO handle that is read through the host cache
+	 */
+	libbfio_handle_t *host_file_io_handle;
+
+	/* The (named) file IO handle that holds the filename when the file is read using unbuffered IO
+	 */
+	libbfio_handle_t *named_file_io_handle;
 
 	/* The compressed cluster block cache
 	 */
-	libfcache_cache_t *compressed_cluster_block_cache;
+	libqcow_block_cache_t *compressed_cluster_block_cache;
+
+	/* The shared cache, which is used instead of the level2 table and cluster block caches when set
+	 * this value is not managed by the file
+	 */
+	libqcow_cache_t *shared_cache;
+
+	/* The (shared) file IO pool, which the file IO handles of files opened by filename are added to
+	 * this value is not managed by the file
+	 */
+	libbfio_pool_t *file_io_pool;
+
+	/* The owner of the values in the shared cache, which is the source file for a reader
+	 */
+	intptr_t *cache_owner;
+
+	/* The source file of a reader, which manages the values that are shared with the reader
+	 * this value is not managed by the file
+	 */
+	libqcow_file_t *source_file;
+
+	/* The statistics
+	 */
+	libqcow_statistics_t *statistics;
+
+	/* The write cache, which is only set when the file is opened for writing
+	 */
+	libqcow_write_cache_t *write_cache;
+
+	/* The scratch overlay, which contains the data written to a file that is not opened for writing
+	 */
+	libqcow_scratch_overlay_t *scratch_overlay;
+
+	/* The IO scheduler, a reader uses the IO scheduler of its source file
+	 */
+	libqcow_io_scheduler_t *io_scheduler;
 
 	/* Value to indicate if abort was signalled
 	 */
@@ -115,6 +400,84 @@ struct libqcow_internal_file
 	/* The read/write lock
 	 */
 	libcthreads_read_write_lock_t *read_write_lock;
+
+	/* The cache mutex
+	 */
+	libcthreads_mutex_t *cache_mutex;
+
+	/* The read-ahead thread
+	 */
+	libcthreads_thread_t *read_ahead_thread;
+
+	/* The read-ahead condition
+	 */
+	libcthreads_condition_t *read_ahead_condition;
+
+	/* The offset at which the next sequential read is expected
+	 */
+	off64_t read_ahead_expected_offset;
+
+	/* The offset of the next cluster block to read ahead
+	 */
+	off64_t read_ahead_offset;
+
+	/* The offset up to which cluster blocks are read ahead
+	 */
+	off64_t read_ahead_end_offset;
+
+	/* The offset up to which cluster blocks are read ahead on request of libqcow_file_advise
+	 */
+	off64_t read_ahead_advised_end_offset;
+
+	/* The read-ahead window in number of cluster blocks
+	 */
+	int read_ahead_window;
+
+	/* Value to indicate if the read-ahead thread should stop
+	 */
+	int abort_read_ahead;
+
+	/* Value to indicate the read-ahead thread is reading a cluster block
+	 * that was not requested by libqcow_file_advise
+	 */
+	int is_reading_ahead;
+
+	/* The cache state that is read into the caches by the read-ahead thread
+	 */
+	libqcow_cache_state_t *prefetch_cache_state;
+
+	/* The index of the next offset of the cache state to read
+	 */
+	int prefetch_offset_index;
+
+	/* The worker thread pool
+	 */
+	libcthreads_thread_pool_t *worker_thread_pool;
+
+	/* The NUMA topology, which is used to place the worker threads and
+	 * cluster block buffers on the node of the reading thread
+	 */
+	libqcow_numa_topology_t *numa_topology;
+
+	/* The number of NUMA nodes, where a value of 0 or 1 represents no NUMA placement
+	 */
+	int number_of_numa_nodes;
+
+	/* The cluster block pools per NUMA node, the first node uses the cluster block pool
+	 */
+	libqcow_cluster_block_pool_t **numa_cluster_block_pools;
+
+	/* The worker thread pools per NUMA node, the first node uses the worker thread pool
+	 */
+	libcthreads_thread_pool_t **numa_worker_thread_pools;
+
+	/* The queue of decompression contexts used by the worker threads
+	 */
+	libcthreads_queue_t *worker_decompression_context_queue;
+
+	/* The thread pool that processes the asynchronous read requests
+	 */
+	libcthreads_thread_pool_t *read_request_thread_pool;
 #endif
 };
 
@@ -163,81 +526,722 @@ int libqcow_file_close(
      libqcow_file_t *file,
      libcerror_error_t **error );
 
+LIBQCOW_EXTERN \
+int libqcow_file_clone_reader(
+     libqcow_file_t *file,
+     libqcow_file_t **reader,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_open_reader(
+     libqcow_internal_file_t *internal_reader,
+     libqcow_internal_file_t *internal_source_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_release_shared_values(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
 int libqcow_internal_file_open_read(
      libqcow_internal_file_t *internal_file,
      libbfio_handle_t *file_io_handle,
+     int access_flags,
      libcerror_error_t **error );
 
-ssize_t libqcow_internal_file_read_buffer_from_file_io_handle(
-         libqcow_internal_file_t *internal_file,
-         libbfio_handle_t *file_io_handle,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error );
+int libqcow_internal_file_unlock_luks_encryption(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-ssize_t libqcow_file_read_buffer(
-         libqcow_file_t *file,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error );
+int libqcow_internal_file_initialize_data_path(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-ssize_t libqcow_file_read_buffer_at_offset(
-         libqcow_file_t *file,
-         void *buffer,
-         size_t buffer_size,
-         off64_t offset,
-         libcerror_error_t **error );
+int libqcow_internal_file_free_data_path(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
 
-#ifdef TODO_WRITE_SUPPORT
+int libqcow_internal_file_initialize_data_path_for_reading(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
 
-ssize_t libqcow_internal_file_write_buffer_to_file_io_handle(
-         libqcow_internal_file_t *internal_file,
-         libbfio_handle_t *file_io_handle,
-         void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error );
+int libqcow_internal_file_open_memory_map(
+     libqcow_internal_file_t *internal_file,
+     const char *filename,
+     libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-ssize_t libqcow_file_write_buffer(
-         libqcow_file_t *file,
-         const void *buffer,
-         size_t buffer_size,
-         libcerror_error_t **error );
+int libqcow_internal_file_open_io_uring(
+     libqcow_internal_file_t *internal_file,
+     const char *filename,
+     libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-ssize_t libqcow_file_write_buffer_at_offset(
-         libqcow_file_t *file,
-         const void *buffer,
-         size_t buffer_size,
-         off64_t offset,
-         libcerror_error_t **error );
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
 
-#endif /* TODO_WRITE_SUPPORT */
+int libqcow_internal_file_open_io_uring_wide(
+     libqcow_internal_file_t *internal_file,
+     const wchar_t *filename,
+     libcerror_error_t **error );
 
-off64_t libqcow_internal_file_seek_offset(
-         libqcow_internal_file_t *internal_file,
-         off64_t offset,
-         int whence,
-         libcerror_error_t **error );
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
 
-LIBQCOW_EXTERN \
-off64_t libqcow_file_seek_offset(
-         libqcow_file_t *file,
-         off64_t offset,
-         int whence,
-         libcerror_error_t **error );
+int libqcow_internal_file_read_snapshot_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-int libqcow_file_get_offset(
-     libqcow_file_t *file,
-     off64_t *offset,
+int libqcow_internal_file_read_bitmap_directory(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
      libcerror_error_t **error );
 
-LIBQCOW_EXTERN \
-int libqcow_file_set_keys(
-     libqcow_file_t *file,
+int libqcow_internal_file_mark_referenced_clusters(
+     libqcow_internal_file_t *internal_file,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     off64_t file_offset,
+     size64_t size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_mark_level1_table_clusters(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     off64_t level1_table_offset,
+     size_t level1_table_size,
+     uint64_t *number_of_data_clusters,
+     uint64_t *number_of_data_fragments,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_reference_count_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_mark_metadata_clusters(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     uint8_t *reference_map,
+     uint64_t number_of_host_clusters,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_determine_host_allocation_statistics(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_host_allocation_statistics(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cache_values_memory_usage(
+     libqcow_block_cache_t *cache,
+     int (*get_memory_usage)(
+            intptr_t *value,
+            size_t *memory_usage,
+            libcerror_error_t **error ),
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cache_memory_usage(
+     libqcow_internal_file_t *internal_file,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_memory_usage(
+     libqcow_internal_file_t *internal_file,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_clear_pools(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_enforce_maximum_memory_size(
+     libqcow_internal_file_t *internal_file,
+     size_t value_memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_drop_caches(
+     libqcow_internal_file_t *internal_file,
+     int flags,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t **value,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_set_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     intptr_t *value,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_release_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_cache_value_t **cache_value,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cluster_block_reference(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_subcluster_reference(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t cluster_descriptor,
+     uint64_t subcluster_bitmap,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cluster_block_reference_from_level1_table(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cached_cluster_block_reference(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_level2_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table,
+     int level1_table_index,
+     uint64_t level2_table_file_offset,
+     uint64_t level2_table_slice_file_offset,
+     int *number_of_level2_tables,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_preload_level2_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_initialize_metadata_index(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_metadata_index_t **metadata_index,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_build_metadata_index(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_metadata_index_t *metadata_index,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_update_digest_index(
+     libqcow_internal_file_t *internal_file,
+     libqcow_digest_index_t *digest_index,
+     int number_of_threads,
+     uint64_t *number_of_stale_entries,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cluster_block_extent_values(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_reference,
+     uint64_t *cluster_block_file_offset,
+     uint32_t *cluster_block_flags,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_cluster_block_is_detected_zero(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_file_offset,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_extent_at_offset(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     off64_t *extent_file_offset,
+     uint32_t *extent_flags,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_advise_host_range(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_advise(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_compare_level1_tables_at_offset(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table_a,
+     libqcow_cluster_table_t *level1_table_b,
+     off64_t offset,
+     uint8_t *differs,
+     size64_t *size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_diff_level1_tables(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_table_t *level1_table_a,
+     libqcow_cluster_table_t *level1_table_b,
+     size64_t media_size,
+     int (*callback)(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_compressed_cluster_block_range(
+     libqcow_internal_file_t *internal_file,
+     uint64_t cluster_block_file_offset,
+     uint64_t *compressed_cluster_block_offset,
+     size_t *compressed_cluster_block_size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_bound_compressed_cluster_block_size(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint64_t compressed_cluster_block_offset,
+     size_t *compressed_cluster_block_size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_compressed_cluster_block(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libqcow_cluster_block_t *cluster_block,
+     uint64_t compressed_cluster_block_offset,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_contiguous_cluster_blocks(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint64_t cluster_block_file_offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+int libqcow_internal_file_read_cluster_block_data_directly(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     uint64_t cluster_block_file_offset,
+     uint8_t *buffer,
+     size_t read_size,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_cluster_blocks_asynchronously(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+ssize_t libqcow_internal_file_read_cluster_blocks_in_parallel(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_internal_file_get_relative_file_path(
+     libqcow_internal_file_t *internal_file,
+     const uint8_t *name,
+     size_t name_size,
+     char **path,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_parent_file(
+     libqcow_internal_file_t *internal_file,
+     libqcow_file_t **parent_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_data_file_io_handle(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t **data_file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_backing_file_by_depth(
+     libqcow_internal_file_t *internal_file,
+     int backing_file_depth,
+     libqcow_file_t **backing_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_backing_file_at_offset(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     libqcow_file_t **backing_file,
+     int *backing_file_depth,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_backing_file_data(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t read_size,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_raw_data_file_data(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_cluster_block_data_by_reference(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint64_t cluster_block_reference,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_plaintext_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+int libqcow_internal_file_select_read_function(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_scratch_overlay(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_mapped_cluster_block_data(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         uint8_t *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error );
+
+int libqcow_internal_file_set_zero_bitmap_range(
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     size_t range_start,
+     size_t range_end,
+     size_t read_size,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_buffer_at_offset_with_zero_bitmap_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         uint8_t *zero_bitmap,
+         size_t zero_bitmap_size,
+         libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_internal_file_read_ahead_thread_function(
+     void *arguments );
+
+int libqcow_internal_file_update_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     off64_t offset,
+     size_t read_size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_start_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_stop_read_ahead(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_initialize_numa_placement(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_initialize_numa_cluster_block_pools(
+     libqcow_internal_file_t *internal_file,
+     int maximum_number_of_buffers,
+     int maximum_number_of_arena_slots,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_free_numa_placement(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_start_worker_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_stop_worker_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_start_read_request_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_stop_read_request_thread_pool(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_internal_file_get_io_scheduler(
+     libqcow_internal_file_t *internal_file,
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_read_buffer_from_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_read_buffer(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_read_buffer_at_offset(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+         libqcow_file_t *file,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         uint8_t *zero_bitmap,
+         size_t zero_bitmap_size,
+         libcerror_error_t **error );
+
+void libqcow_internal_file_sort_vector_segments(
+      libqcow_vector_segment_t *segments,
+      int number_of_segments );
+
+ssize_t libqcow_internal_file_read_vector_in_host_order(
+         libqcow_internal_file_t *internal_file,
+         void **buffers,
+         size_t *buffer_sizes,
+         off64_t *offsets,
+         int number_of_buffers,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_read_vector(
+         libqcow_file_t *file,
+         void **buffers,
+         size_t *buffer_sizes,
+         off64_t *offsets,
+         int number_of_buffers,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_read_async(
+     libqcow_file_t *file,
+     void *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_read_async_with_priority(
+     libqcow_file_t *file,
+     void *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     int priority,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_read_parallel(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     int (*callback)(
+            off64_t chunk_offset,
+            const uint8_t *chunk_data,
+            size_t chunk_size,
+            void *user_data ),
+     void *user_data,
+     int number_of_threads,
+     int flags,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_extent_at_offset(
+     libqcow_file_t *file,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     off64_t *extent_file_offset,
+     uint32_t *extent_flags,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_diff_extents(
+     libqcow_file_t *file_a,
+     libqcow_file_t *file_b,
+     int (*callback)(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_compact(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+LIBQCOW_EXTERN \
+int libqcow_file_compact_wide(
+     libqcow_file_t *file,
+     const wchar_t *filename,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+LIBQCOW_EXTERN \
+int libqcow_file_compact_file_io_handle(
+     libqcow_file_t *file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_advise(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_write_buffer(
+         libqcow_file_t *file,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+ssize_t libqcow_file_write_buffer_at_offset(
+         libqcow_file_t *file,
+         const void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_flush(
+     libqcow_file_t *file,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_scratch_overlay(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+off64_t libqcow_internal_file_seek_offset(
+         libqcow_internal_file_t *internal_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+off64_t libqcow_file_seek_offset(
+         libqcow_file_t *file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_offset(
+     libqcow_file_t *file,
+     off64_t *offset,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_keys(
+     libqcow_file_t *file,
      const uint8_t *key,
      size_t key_size,
      libcerror_error_t **error );
@@ -256,6 +1260,170 @@ int libqcow_file_set_utf16_password(
      size_t utf16_string_length,
      libcerror_error_t **error );
 
+LIBQCOW_EXTERN \
+int libqcow_file_set_cache_limits(
+     libqcow_file_t *file,
+     int maximum_number_of_level2_tables,
+     int maximum_number_of_cluster_blocks,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_cache_limits(
+     libqcow_file_t *file,
+     int *maximum_number_of_level2_tables,
+     int *maximum_number_of_cluster_blocks,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_cache(
+     libqcow_file_t *file,
+     libqcow_cache_t *cache,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_file_io_pool(
+     libqcow_file_t *file,
+     libbfio_pool_t *file_io_pool,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_cache_memory_usage(
+     libqcow_file_t *file,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_memory_usage(
+     libqcow_file_t *file,
+     size64_t *memory_usage,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_maximum_memory_size(
+     libqcow_file_t *file,
+     size64_t maximum_memory_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_maximum_memory_size(
+     libqcow_file_t *file,
+     size64_t *maximum_memory_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_drop_caches(
+     libqcow_file_t *file,
+     int flags,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_cache_state_size(
+     libqcow_file_t *file,
+     size_t *data_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_export_cache_state(
+     libqcow_file_t *file,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_import_cache_state(
+     libqcow_file_t *file,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_statistics(
+     libqcow_file_t *file,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_reset_statistics(
+     libqcow_file_t *file,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_latency_histogram(
+     libqcow_file_t *file,
+     int operation,
+     uint64_t *counts,
+     int number_of_counts,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_latency_percentile(
+     libqcow_file_t *file,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_io_limits(
+     libqcow_file_t *file,
+     int priority,
+     size64_t maximum_bytes_per_second,
+     uint64_t maximum_requests_per_second,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_io_limits(
+     libqcow_file_t *file,
+     int priority,
+     size64_t *maximum_bytes_per_second,
+     uint64_t *maximum_requests_per_second,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_read_flags(
+     libqcow_file_t *file,
+     int read_flags,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_read_flags(
+     libqcow_file_t *file,
+     int *read_flags,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_number_of_worker_threads(
+     libqcow_file_t *file,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_worker_threads(
+     libqcow_file_t *file,
+     int *number_of_threads,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_io_queue_depth(
+     libqcow_file_t *file,
+     int queue_depth,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_io_queue_depth(
+     libqcow_file_t *file,
+     int *queue_depth,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_host_cache(
+     libqcow_file_t *file,
+     size_t block_size,
+     int number_of_blocks,
+     libcerror_error_t **error );
+
 LIBQCOW_EXTERN \
 int libqcow_file_get_media_size(
      libqcow_file_t *file,
@@ -274,6 +1442,179 @@ int libqcow_file_get_encryption_method(
      uint32_t *encryption_method,
      libcerror_error_t **error );
 
+LIBQCOW_EXTERN \
+int libqcow_file_get_utf8_backing_filename_size(
+     libqcow_file_t *file,
+     size_t *utf8_string_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_utf8_backing_filename(
+     libqcow_file_t *file,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_parent_file(
+     libqcow_file_t *file,
+     libqcow_file_t *parent_file,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_parent_file(
+     libqcow_file_t *file,
+     libqcow_file_t **parent_file,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_set_data_file_io_handle(
+     libqcow_file_t *file,
+     libbfio_handle_t *data_file_io_handle,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_read_chain_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_write_chain_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_read_metadata_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_write_metadata_index(
+     libqcow_file_t *file,
+     const char *filename,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_write_digest_index(
+     libqcow_file_t *file,
+     const char *filename,
+     int number_of_threads,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_verify_digest_index(
+     libqcow_file_t *file,
+     const char *filename,
+     int number_of_threads,
+     uint64_t *number_of_changed_cluster_blocks,
+     uint64_t *number_of_mismatches,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_snapshots(
+     libqcow_file_t *file,
+     int *number_of_snapshots,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_snapshot_by_index(
+     libqcow_file_t *file,
+     int snapshot_index,
+     libqcow_snapshot_t **snapshot,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_bitmaps(
+     libqcow_file_t *file,
+     int *number_of_bitmaps,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_utf8_bitmap_name_size(
+     libqcow_file_t *file,
+     int bitmap_index,
+     size_t *utf8_string_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_utf8_bitmap_name(
+     libqcow_file_t *file,
+     int bitmap_index,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_bitmap_index_by_utf8_name(
+     libqcow_file_t *file,
+     const uint8_t *utf8_string,
+     size_t utf8_string_length,
+     int *bitmap_index,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_next_dirty_range(
+     libqcow_file_t *file,
+     int bitmap_index,
+     off64_t offset,
+     off64_t *range_offset,
+     size64_t *range_size,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_used_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_used_clusters,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_leaked_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_leaked_clusters,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_number_of_shared_clusters(
+     libqcow_file_t *file,
+     uint64_t *number_of_shared_clusters,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_get_fragmentation_ratio(
+     libqcow_file_t *file,
+     double *fragmentation_ratio,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_check_consistency(
+     libqcow_file_t *file,
+     int flags,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_sample(
+     libqcow_file_t *file,
+     int flags,
+     double sampling_fraction,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_file_scan_layout(
+     libqcow_file_t *file,
+     int number_of_threads,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
@@ -0,0 +1,880 @@
+/*
+ * File cache state functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_block_cache.h"
+#include "libqcow_cache.h"
+#include "libqcow_cache_state.h"
+#include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_file_cache_state.h"
+#include "libqcow_libcerror.h"
+
+/* Determines if a level 2 table or cluster block is in a cache
+ * The value is looked up in the shared cache if set on the file, otherwise in the block cache
+ * This function does not change the order of use of the value
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if the value is in the cache, 0 if not or -1 on error
+ */
+int libqcow_internal_file_has_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_has_cached_value";
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->shared_cache != NULL )
+	{
+		result = libqcow_internal_cache_has_value(
+		          (libqcow_internal_cache_t *) internal_file->shared_cache,
+		          internal_file->cache_owner,
+		          value_type,
+		          offset,
+		          error );
+	}
+	else if( block_cache != NULL )
+	{
+		result = libqcow_block_cache_has_value_by_offset(
+		          block_cache,
+		          offset,
+		          error );
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine if value: 0x%08" PRIx64 " is in cache.",
+		 function,
+		 offset );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Retrieves the cache state, which are the (media) offsets of the cached level 2 tables
+ * and cluster blocks of the file
+ * The level 1 table is used to map the file offsets of the cached level 2 tables
+ * to the (media) data they map and the entries of the cached level 2 tables to map
+ * the file offsets of the cached cluster blocks. Cluster blocks of which the level 2 table
+ * is no longer cached are not part of the cache state
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_get_cache_state(
+     libqcow_internal_file_t *internal_file,
+     libqcow_cache_state_t *cache_state,
+     libcerror_error_t **error )
+{
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_cluster_table_t *level2_table    = NULL;
+	static char *function                    = "libqcow_internal_file_get_cache_state";
+	size_t compressed_cluster_block_size     = 0;
+	uint64_t cluster_block_file_offset       = 0;
+	uint64_t cluster_block_reference         = 0;
+	uint64_t compressed_cluster_block_offset = 0;
+	uint64_t level2_table_file_offset        = 0;
+	uint64_t level2_table_media_offset       = 0;
+	uint64_t level2_table_slice_file_offset  = 0;
+	uint64_t media_offset                    = 0;
+	int entry_index                          = 0;
+	int level1_table_index                   = 0;
+	int number_of_level1_table_references    = 0;
+	int number_of_level2_table_entries       = 0;
+	int number_of_subclusters                = 0;
+	int result                               = 0;
+	int slice_index                          = 0;
+	int subcluster_index                     = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_state == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state.",
+		 function );
+
+		return( -1 );
+	}
+	/* Nothing is cached before the data path is initialized and the data
+	 * of a raw external data file is read without the level 2 tables
+	 */
+	if( ( internal_file->data_path_is_initialized == 0 )
+	 || ( internal_file->level1_table == NULL )
+	 || ( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 ) )
+	{
+		return( 1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     internal_file->level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_level2_table_entries = 1 << internal_file->io_handle->number_of_level2_table_slice_bits;
+	number_of_subclusters          = (int) ( internal_file->io_handle->cluster_block_size / internal_file->io_handle->subcluster_size );
+
+	for( level1_table_index = 0;
+	     level1_table_index < number_of_level1_table_references;
+	     level1_table_index++ )
+	{
+		if( libqcow_cluster_table_read_reference_by_index(
+		     internal_file->level1_table,
+		     internal_file->file_io_handle,
+		     level1_table_index,
+		     &level2_table_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table offset: %d from level 1 table.",
+			 function,
+			 level1_table_index );
+
+			return( -1 );
+		}
+		level2_table_file_offset &= internal_file->io_handle->offset_bit_mask;
+
+		if( level2_table_file_offset == 0 )
+		{
+			continue;
+		}
+		for( slice_index = 0;
+		     slice_index < (int) internal_file->io_handle->number_of_level2_table_slices;
+		     slice_index++ )
+		{
+			level2_table_media_offset = ( (uint64_t) level1_table_index << internal_file->io_handle->level1_index_bit_shift )
+			                          + ( (uint64_t) slice_index * number_of_level2_table_entries * internal_file->io_handle->cluster_block_size );
+
+			if( level2_table_media_offset >= internal_file->io_handle->media_size )
+			{
+				break;
+			}
+			level2_table_slice_file_offset = level2_table_file_offset
+			                               + ( (uint64_t) slice_index * internal_file->io_handle->level2_table_slice_size );
+
+			result = libqcow_internal_file_has_cached_value(
+			          internal_file,
+			          internal_file->level2_table_cache,
+			          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+			          (off64_t) level2_table_slice_file_offset,
+			          error );
+
+			if( result == 1 )
+			{
+				result = libqcow_internal_file_get_cached_value(
+				          internal_file,
+				          internal_file->level2_table_cache,
+				          LIBQCOW_CACHE_VALUE_TYPE_LEVEL2_TABLE,
+				          (off64_t) level2_table_slice_file_offset,
+				          (intptr_t **) &level2_table,
+				          &cache_value,
+				          error );
+			}
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve level2 table: 0x%08" PRIx64 " from cache.",
+				 function,
+				 level2_table_slice_file_offset );
+
+				return( -1 );
+			}
+			else if( result == 0 )
+			{
+				continue;
+			}
+			if( libqcow_cache_state_append_offset(
+			     cache_state,
+			     LIBQCOW_CACHE_STATE_OFFSET_TYPE_LEVEL2_TABLE,
+			     (off64_t) level2_table_media_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to append level 2 table offset to cache state.",
+				 function );
+
+				goto on_error;
+			}
+			for( entry_index = 0;
+			     entry_index < number_of_level2_table_entries;
+			     entry_index++ )
+			{
+				media_offset = level2_table_media_offset
+				             + ( (uint64_t) entry_index * internal_file->io_handle->cluster_block_size );
+
+				if( media_offset >= internal_file->io_handle->media_size )
+				{
+					break;
+				}
+				/* The level 2 table is read as 64-bit references, of an extended level 2
+				 * table entry only the cluster descriptor is needed
+				 */
+				if( libqcow_cluster_table_get_reference_by_index(
+				     level2_table,
+				     entry_index << ( internal_file->io_handle->number_of_level2_table_entry_bits - 3 ),
+				     &cluster_block_reference,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve cluster block reference: %d from level 2 table.",
+					 function,
+					 entry_index );
+
+					goto on_error;
+				}
+				cluster_block_file_offset = cluster_block_reference & internal_file->io_handle->offset_bit_mask;
+
+				if( cluster_block_file_offset == 0 )
+				{
+					continue;
+				}
+				result = 0;
+
+				if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+				{
+					if( libqcow_internal_file_get_compressed_cluster_block_range(
+					     internal_file,
+					     cluster_block_file_offset,
+					     &compressed_cluster_block_offset,
+					     &compressed_cluster_block_size,
+					     error ) != 1 )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+						 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+						 "%s: unable to retrieve compressed cluster block range.",
+						 function );
+
+						goto on_error;
+					}
+					result = libqcow_internal_file_has_cached_value(
+					          internal_file,
+					          internal_file->compressed_cluster_block_cache,
+					          LIBQCOW_CACHE_VALUE_TYPE_COMPRESSED_CLUSTER_BLOCK,
+					          (off64_t) compressed_cluster_block_offset,
+					          error );
+				}
+				else
+				{
+					/* With extended level 2 table entries every subcluster is cached separately
+					 */
+					cluster_block_file_offset &= ~( internal_file->io_handle->cluster_block_bit_mask );
+
+					for( subcluster_index = 0;
+					     subcluster_index < number_of_subclusters;
+					     subcluster_index++ )
+					{
+						result = libqcow_internal_file_has_cached_value(
+						          internal_file,
+						          internal_file->cluster_block_cache,
+						          LIBQCOW_CACHE_VALUE_TYPE_CLUSTER_BLOCK,
+						          (off64_t) ( cluster_block_file_offset + ( (uint64_t) subcluster_index * internal_file->io_handle->subcluster_size ) ),
+						          error );
+
+						if( result != 0 )
+						{
+							break;
+						}
+					}
+				}
+				if( result == -1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to determine if cluster block: 0x%08" PRIx64 " is in cache.",
+					 function,
+					 cluster_block_file_offset );
+
+					goto on_error;
+				}
+				else if( result != 0 )
+				{
+					if( libqcow_cache_state_append_offset(
+					     cache_state,
+					     LIBQCOW_CACHE_STATE_OFFSET_TYPE_CLUSTER_BLOCK,
+					     (off64_t) media_offset,
+					     error ) != 1 )
+					{
+						libcerror_error_set(
+						 error,
+						 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+						 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+						 "%s: unable to append cluster block offset to cache state.",
+						 function );
+
+						goto on_error;
+					}
+				}
+			}
+			if( libqcow_internal_file_release_cached_value(
+			     internal_file,
+			     &cache_value,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release level2 table: 0x%08" PRIx64 " in cache.",
+				 function,
+				 level2_table_slice_file_offset );
+
+				return( -1 );
+			}
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( cache_value != NULL )
+	{
+		libqcow_internal_file_release_cached_value(
+		 internal_file,
+		 &cache_value,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads an offset of a cache state into the caches
+ * A level 2 table offset reads the level 2 table that maps the offset,
+ * a cluster block offset reads the cluster block into the cluster block cache
+ * The cluster block data is used as the buffer of the read and must be cluster block size
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_cache_state_offset(
+     libqcow_internal_file_t *internal_file,
+     uint8_t offset_type,
+     off64_t offset,
+     uint8_t *cluster_block_data,
+     libcerror_error_t **error )
+{
+	static char *function            = "libqcow_internal_file_read_cache_state_offset";
+	uint64_t cluster_block_reference = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset_type == LIBQCOW_CACHE_STATE_OFFSET_TYPE_LEVEL2_TABLE )
+	{
+		if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+		{
+			return( 1 );
+		}
+		if( libqcow_internal_file_get_cluster_block_reference(
+		     internal_file,
+		     internal_file->file_io_handle,
+		     offset,
+		     &cluster_block_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			return( -1 );
+		}
+	}
+	else if( internal_file->read_cluster_block_data(
+	          internal_file,
+	          internal_file->file_io_handle,
+	          offset,
+	          cluster_block_data,
+	          internal_file->io_handle->cluster_block_size,
+	          error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Exports the cache state of the file
+ * The cache state size is set to the size of the cache state data,
+ * which is only written when data is not NULL
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_export_cache_state(
+     libqcow_internal_file_t *internal_file,
+     uint8_t *data,
+     size_t data_size,
+     size_t *cache_state_size,
+     libcerror_error_t **error )
+{
+	libqcow_cache_state_t *cache_state = NULL;
+	static char *function              = "libqcow_internal_file_export_cache_state";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cache_state_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cache state size.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cache_state_initialize(
+	     &cache_state,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create cache state.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_internal_file_get_cache_state(
+	     internal_file,
+	     cache_state,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cache state.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cache_state_get_data_size(
+	     cache_state,
+	     cache_state_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cache state size.",
+		 function );
+
+		goto on_error;
+	}
+	if( data != NULL )
+	{
+		if( libqcow_cache_state_write_data(
+		     cache_state,
+		     data,
+		     data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write cache state.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_cache_state_free(
+	     &cache_state,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free cache state.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( cache_state != NULL )
+	{
+		libqcow_cache_state_free(
+		 &cache_state,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Imports a cache state that was exported by libqcow_internal_file_export_cache_state
+ * The level 2 tables and cluster blocks of the cache state are read into the caches
+ * by the read-ahead thread, with the background IO priority. Without multi-thread
+ * support they are read before this function returns
+ * The cache state is not read when the file is opened for writing
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the cache state does not match the file or -1 on error
+ */
+int libqcow_internal_file_import_cache_state(
+     libqcow_internal_file_t *internal_file,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	libqcow_cache_state_t *cache_state = NULL;
+	static char *function              = "libqcow_internal_file_import_cache_state";
+	int result                         = 0;
+
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcerror_error_t *read_error      = NULL;
+	uint8_t *cluster_block_data        = NULL;
+	off64_t offset                     = 0;
+	uint8_t offset_type                = 0;
+	int number_of_offsets              = 0;
+	int offset_index                   = 0;
+#endif
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cache_state_initialize(
+	     &cache_state,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create cache state.",
+		 function );
+
+		goto on_error;
+	}
+	result = libqcow_cache_state_read_data(
+	          cache_state,
+	          data,
+	          data_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cache state.",
+		 function );
+
+		goto on_error;
+	}
+	else if( ( result == 0 )
+	      || ( internal_file->write_cache != NULL ) )
+	{
+		if( libqcow_cache_state_free(
+		     &cache_state,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free cache state.",
+			 function );
+
+			goto on_error;
+		}
+		return( result );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* A cache state that is still being read is replaced
+	 */
+	if( internal_file->prefetch_cache_state != NULL )
+	{
+		if( libqcow_cache_state_free(
+		     &( internal_file->prefetch_cache_state ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free prefetch cache state.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	internal_file->prefetch_cache_state  = cache_state;
+	internal_file->prefetch_offset_index = 0;
+
+	cache_state = NULL;
+
+	if( libqcow_internal_file_start_read_ahead(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to start read-ahead.",
+		 function );
+
+		goto on_error;
+	}
+#else
+	if( libqcow_cache_state_get_number_of_offsets(
+	     cache_state,
+	     &number_of_offsets,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of offsets.",
+		 function );
+
+		goto on_error;
+	}
+	cluster_block_data = (uint8_t *) memory_allocate(
+	                                  sizeof( uint8_t ) * internal_file->io_handle->cluster_block_size );
+
+	if( cluster_block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block data.",
+		 function );
+
+		goto on_error;
+	}
+	for( offset_index = 0;
+	     offset_index < number_of_offsets;
+	     offset_index++ )
+	{
+		if( libqcow_cache_state_get_offset_by_index(
+		     cache_state,
+		     offset_index,
+		     &offset_type,
+		     &offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve offset: %d.",
+			 function,
+			 offset_index );
+
+			goto on_error;
+		}
+		/* Reading the cache state is best effort, a read error is reported by the read itself
+		 */
+		if( libqcow_internal_file_read_cache_state_offset(
+		     internal_file,
+		     offset_type,
+		     offset,
+		     cluster_block_data,
+		     &read_error ) != 1 )
+		{
+			libcerror_error_free(
+			 &read_error );
+		}
+	}
+	memory_free(
+	 cluster_block_data );
+
+	cluster_block_data = NULL;
+
+	if( libqcow_cache_state_free(
+	     &cache_state,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free cache state.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+#if !defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+#endif
+	if( cache_state != NULL )
+	{
+		libqcow_cache_state_free(
+		 &cache_state,
+		 NULL );
+	}
+	return( -1 );
+}
+
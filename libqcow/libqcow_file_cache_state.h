@@ -0,0 +1,73 @@
+/*
+ * File cache state functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_FILE_CACHE_STATE_H )
+#define _LIBQCOW_FILE_CACHE_STATE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_block_cache.h"
+#include "libqcow_cache_state.h"
+#include "libqcow_file.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+int libqcow_internal_file_has_cached_value(
+     libqcow_internal_file_t *internal_file,
+     libqcow_block_cache_t *block_cache,
+     uint8_t value_type,
+     off64_t offset,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_get_cache_state(
+     libqcow_internal_file_t *internal_file,
+     libqcow_cache_state_t *cache_state,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_read_cache_state_offset(
+     libqcow_internal_file_t *internal_file,
+     uint8_t offset_type,
+     off64_t offset,
+     uint8_t *cluster_block_data,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_export_cache_state(
+     libqcow_internal_file_t *internal_file,
+     uint8_t *data,
+     size_t data_size,
+     size_t *cache_state_size,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_import_cache_state(
+     libqcow_internal_file_t *internal_file,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_FILE_CACHE_STATE_H ) */
@@ -0,0 +1,794 @@
+/*
+ * File compaction functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_creator.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_file_compaction.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_zero_block.h"
+
+/* Copies the compressed data of a cluster block at a specific offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the compressed data does not fit in the buffer or -1 on error
+ */
+int libqcow_internal_file_copy_compressed_cluster_block_data(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t offset,
+     uint8_t *compressed_data,
+     size_t compressed_data_size,
+     size_t *copied_data_size,
+     libcerror_error_t **error )
+{
+	static char *function                    = "libqcow_internal_file_copy_compressed_cluster_block_data";
+	size_t compressed_cluster_block_size     = 0;
+	ssize_t read_count                       = 0;
+	uint64_t cluster_block_reference         = 0;
+	uint64_t compressed_cluster_block_offset = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compressed data.",
+		 function );
+
+		return( -1 );
+	}
+	if( compressed_data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid compressed data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( copied_data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid copied data size.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_cluster_block_reference(
+	     internal_file,
+	     file_io_handle,
+	     offset,
+	     &cluster_block_reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported cluster block at offset: %" PRIi64 " (0x%08" PRIx64 ") - not compressed.",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	if( libqcow_internal_file_get_compressed_cluster_block_range(
+	     internal_file,
+	     cluster_block_reference & internal_file->io_handle->offset_bit_mask,
+	     &compressed_cluster_block_offset,
+	     &compressed_cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve compressed cluster block range.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( compressed_cluster_block_size == 0 )
+	 || ( compressed_cluster_block_size > compressed_data_size ) )
+	{
+		return( 0 );
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              compressed_data,
+	              compressed_cluster_block_size,
+	              (off64_t) compressed_cluster_block_offset,
+	              error );
+
+	if( read_count != (ssize_t) compressed_cluster_block_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read compressed data at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+		 function,
+		 compressed_cluster_block_offset,
+		 compressed_cluster_block_offset );
+
+		return( -1 );
+	}
+	*copied_data_size = compressed_cluster_block_size;
+
+	return( 1 );
+}
+
+/* Reads the (media) data of a cluster block into the task of a creator
+ * The data of the last cluster block is padded with 0-byte values
+ * This function is not multi-thread safe acquire the read/write lock for reading before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_read_cluster_block_into_task(
+     libqcow_internal_file_t *internal_file,
+     libqcow_creator_task_t *creator_task,
+     off64_t offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_read_cluster_block_into_task";
+	size_t read_size      = 0;
+	ssize_t read_count    = 0;
+	int result            = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator_task == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator task.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	read_size = creator_task->cluster_block_size;
+
+	if( (size64_t) read_size > ( internal_file->io_handle->media_size - offset ) )
+	{
+		read_size = (size_t) ( internal_file->io_handle->media_size - offset );
+
+		if( memory_set(
+		     &( creator_task->data[ read_size ] ),
+		     0,
+		     creator_task->cluster_block_size - read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear cluster block data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	read_count = libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+	              internal_file,
+	              internal_file->file_io_handle,
+	              creator_task->data,
+	              read_size,
+	              offset,
+	              error );
+
+	if( read_count != (ssize_t) read_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 offset,
+		 offset );
+
+		return( -1 );
+	}
+	result = libqcow_zero_block_is_zero(
+	          creator_task->data,
+	          creator_task->cluster_block_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to determine if cluster block data is zero.",
+		 function );
+
+		return( -1 );
+	}
+	creator_task->compressed_data_size = 0;
+	creator_task->is_zero              = (uint8_t) result;
+
+	return( 1 );
+}
+
+/* Writes the (media) data of the file as a compacted image using a creator
+ * The cluster blocks are written in media order followed by the level 2 tables.
+ * Compressed cluster blocks are copied without being decompressed, unallocated
+ * cluster blocks stay unallocated and the data of other cluster blocks, including
+ * cluster blocks with subclusters, is stored uncompressed
+ * This function is not multi-thread safe acquire the read/write lock for reading before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_write_compacted_image(
+     libqcow_internal_file_t *internal_file,
+     libqcow_creator_t *creator,
+     libcerror_error_t **error )
+{
+	libqcow_creator_task_t *creator_task = NULL;
+	static char *function                = "libqcow_internal_file_write_compacted_image";
+	size64_t extent_size                 = 0;
+	uint64_t cluster_block_index         = 0;
+	uint64_t number_of_cluster_blocks    = 0;
+	uint64_t extent_end_offset           = 0;
+	uint32_t extent_flags                = 0;
+	off64_t extent_file_offset           = 0;
+	off64_t extent_offset                = 0;
+	off64_t offset                       = 0;
+	int result                           = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( creator == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid creator.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( creator->cluster_block_size != internal_file->io_handle->cluster_block_size )
+	 || ( creator->media_size != internal_file->io_handle->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported creator - cluster block size or media size does not match file.",
+		 function );
+
+		return( -1 );
+	}
+	/* The cluster blocks are copied one at a time, hence a single task is used
+	 */
+	creator_task = creator->tasks[ 0 ];
+
+	while( cluster_block_index < creator->number_of_cluster_blocks )
+	{
+		offset = (off64_t) ( cluster_block_index << creator->number_of_cluster_block_bits );
+
+		creator_task->cluster_block_index  = cluster_block_index;
+		creator_task->compressed_data_size = 0;
+		creator_task->is_zero              = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		result = libqcow_internal_file_get_extent_at_offset(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          offset,
+		          &extent_offset,
+		          &extent_size,
+		          &extent_file_offset,
+		          &extent_flags,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			result = -1;
+		}
+		else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+		{
+			/* The compressed data must fit in the compressed data of the task,
+			 * otherwise the cluster block is stored uncompressed
+			 */
+			result = libqcow_internal_file_copy_compressed_cluster_block_data(
+			          internal_file,
+			          internal_file->file_io_handle,
+			          offset,
+			          creator_task->compressed_data,
+			          creator_task->cluster_block_size - 512,
+			          &( creator_task->compressed_data_size ),
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+				 "%s: unable to copy compressed cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		if( result == -1 )
+		{
+			return( -1 );
+		}
+		number_of_cluster_blocks = 1;
+
+		if( ( extent_flags & ( LIBQCOW_EXTENT_FLAG_IS_SPARSE | LIBQCOW_EXTENT_FLAG_IS_ZERO ) ) != 0 )
+		{
+			/* Only cluster blocks that are entirely sparse or zero are not stored,
+			 * partially sparse cluster blocks with subclusters are copied
+			 */
+			extent_end_offset = (uint64_t) extent_offset + extent_size;
+
+			if( extent_end_offset >= creator->media_size )
+			{
+				number_of_cluster_blocks = creator->number_of_cluster_blocks - cluster_block_index;
+			}
+			else
+			{
+				number_of_cluster_blocks = ( extent_end_offset >> creator->number_of_cluster_block_bits ) - cluster_block_index;
+			}
+		}
+		if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+		{
+			if( result == 0 )
+			{
+				if( libqcow_internal_file_read_cluster_block_into_task(
+				     internal_file,
+				     creator_task,
+				     offset,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_READ_FAILED,
+					 "%s: unable to read cluster block: %" PRIu64 ".",
+					 function,
+					 cluster_block_index );
+
+					return( -1 );
+				}
+			}
+		}
+		else if( number_of_cluster_blocks == 0 )
+		{
+			if( libqcow_internal_file_read_cluster_block_into_task(
+			     internal_file,
+			     creator_task,
+			     offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+
+				return( -1 );
+			}
+			number_of_cluster_blocks = 1;
+		}
+		else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) != 0 )
+		{
+			/* Zero cluster blocks take precedence over the backing file
+			 */
+			creator_task->is_zero = 1;
+		}
+		else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 )
+		{
+			/* Unallocated cluster blocks are left unallocated so that they
+			 * are read from the backing file if there is one
+			 */
+			cluster_block_index += number_of_cluster_blocks;
+
+			continue;
+		}
+		else
+		{
+			if( libqcow_internal_file_read_cluster_block_into_task(
+			     internal_file,
+			     creator_task,
+			     offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+
+				return( -1 );
+			}
+		}
+		while( number_of_cluster_blocks > 0 )
+		{
+			creator_task->cluster_block_index = cluster_block_index;
+
+			if( libqcow_creator_write_cluster_block(
+			     creator,
+			     creator_task,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+
+				return( -1 );
+			}
+			cluster_block_index      += 1;
+			number_of_cluster_blocks -= 1;
+		}
+	}
+	if( libqcow_creator_write_metadata(
+	     creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write metadata.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Compacts the file into a new file using a Basic File IO (bfio) handle
+ * This function is not multi-thread safe acquire the read lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_compact_file_io_handle(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_creator_t *creator  = NULL;
+	static char *function       = "libqcow_internal_file_compact_file_io_handle";
+	uint16_t compression_method = LIBQCOW_COMPRESSION_METHOD_DEFLATE;
+	int file_io_handle_is_open  = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle->compression_method == LIBQCOW_COMPRESSION_METHOD_ZSTD )
+	{
+		compression_method = LIBQCOW_COMPRESSION_METHOD_ZSTD;
+	}
+	file_io_handle_is_open = libbfio_handle_is_open(
+	                          file_io_handle,
+	                          error );
+
+	if( file_io_handle_is_open == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to determine if file is open.",
+		 function );
+
+		file_io_handle_is_open = 1;
+
+		goto on_error;
+	}
+	else if( file_io_handle_is_open == 0 )
+	{
+		if( libbfio_handle_open(
+		     file_io_handle,
+		     LIBBFIO_OPEN_WRITE_TRUNCATE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open file.",
+			 function );
+
+			file_io_handle_is_open = 1;
+
+			goto on_error;
+		}
+	}
+	if( libqcow_creator_initialize(
+	     &creator,
+	     file_io_handle,
+	     internal_file->io_handle->media_size,
+	     internal_file->io_handle->cluster_block_size,
+	     compression_method,
+	     -1,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create creator.",
+		 function );
+
+		goto on_error;
+	}
+	if( internal_file->io_handle->backing_filename != NULL )
+	{
+		if( libqcow_creator_set_backing_filename(
+		     creator,
+		     internal_file->io_handle->backing_filename,
+		     internal_file->io_handle->backing_filename_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set backing filename in creator.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_internal_file_write_compacted_image(
+	     internal_file,
+	     creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write compacted image.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_creator_free(
+	     &creator,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free creator.",
+		 function );
+
+		goto on_error;
+	}
+	if( file_io_handle_is_open == 0 )
+	{
+		file_io_handle_is_open = 1;
+
+		if( libbfio_handle_close(
+		     file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( creator != NULL )
+	{
+		libqcow_creator_free(
+		 &creator,
+		 NULL );
+	}
+	if( file_io_handle_is_open == 0 )
+	{
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
@@ -0,0 +1,1336 @@
+/*
+ * File write functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_chain_index.h"
+#include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_file_write.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_metadata_index.h"
+#include "libqcow_scratch_overlay.h"
+#include "libqcow_write_cache.h"
+
+/* Prepares a file for writing
+ * Only unencrypted version 2 and 3 files without incompatible features that affect
+ * the cluster allocation can be written
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_open_write(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function        = "libqcow_internal_file_open_write";
+	int maximum_number_of_blocks = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->write_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid file - write cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->io_handle->format_version != 2 )
+	 && ( internal_file->io_handle->format_version != 3 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access not supported for format version: %" PRIu32 ".",
+		 function,
+		 internal_file->io_handle->format_version );
+
+		return( -1 );
+	}
+	if( internal_file->encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access not supported for encrypted file.",
+		 function );
+
+		return( -1 );
+	}
+	/* The reference counts of a dirty or corrupt file cannot be relied on
+	 * and the cluster allocation does not support external data files
+	 * or extended level 2 table entries
+	 */
+	if( ( internal_file->io_handle->incompatible_feature_flags & ( LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_DIRTY | LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_CORRUPT | LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE | LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTENDED_L2 ) ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access not supported for incompatible feature flags: 0x%08" PRIx64 ".",
+		 function,
+		 internal_file->io_handle->incompatible_feature_flags );
+
+		return( -1 );
+	}
+	if( ( internal_file->read_flags & LIBQCOW_READ_FLAG_UNBUFFERED_IO ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access not supported with unbuffered IO.",
+		 function );
+
+		return( -1 );
+	}
+	/* Cache at most 16 MiB of modified level 2 tables and reference count blocks
+	 */
+	maximum_number_of_blocks = (int) ( LIBQCOW_WRITE_CACHE_MAXIMUM_SIZE / internal_file->io_handle->cluster_block_size );
+
+	if( maximum_number_of_blocks < 4 )
+	{
+		maximum_number_of_blocks = 4;
+	}
+	else if( maximum_number_of_blocks > LIBQCOW_MAXIMUM_CACHE_ENTRIES_WRITE_CACHE )
+	{
+		maximum_number_of_blocks = LIBQCOW_MAXIMUM_CACHE_ENTRIES_WRITE_CACHE;
+	}
+	if( libqcow_write_cache_initialize(
+	     &( internal_file->write_cache ),
+	     internal_file->io_handle->cluster_block_size,
+	     internal_file->io_handle->reference_count_order,
+	     maximum_number_of_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create write cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_write_cache_read_reference_count_table(
+	     internal_file->write_cache,
+	     file_io_handle,
+	     internal_file->io_handle->reference_count_table_offset,
+	     internal_file->io_handle->reference_count_table_clusters,
+	     internal_file->size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( internal_file->write_cache != NULL )
+	{
+		libqcow_write_cache_free(
+		 &( internal_file->write_cache ),
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Writes (media) data of a single cluster block using a Basic File IO (bfio) handle
+ * A cluster block that is only referenced by the active level 2 table is overwritten
+ * in place otherwise the data is written to a newly allocated cluster block.
+ * The cluster blocks that are no longer referenced are released and freed on flush
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_write_cluster_block(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t cluster_block_offset,
+     size_t data_offset,
+     const uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *metadata_was_modified,
+     libcerror_error_t **error )
+{
+	uint8_t level1_table_entry_data[ 8 ];
+
+	libqcow_write_cache_block_t *level2_table_block = NULL;
+	uint8_t *cluster_block_data                     = NULL;
+	static char *function                           = "libqcow_internal_file_write_cluster_block";
+	size_t read_size                                = 0;
+	ssize_t read_count                              = 0;
+	ssize_t write_count                             = 0;
+	off64_t new_cluster_block_file_offset           = 0;
+	off64_t new_level2_table_file_offset            = 0;
+	uint64_t cluster_block_file_offset              = 0;
+	uint64_t cluster_block_reference                = 0;
+	uint64_t cluster_index                          = 0;
+	uint64_t compressed_data_end_offset             = 0;
+	uint64_t compressed_data_offset                 = 0;
+	uint64_t level1_table_index                     = 0;
+	uint64_t level1_table_reference                 = 0;
+	uint64_t level2_table_file_offset               = 0;
+	uint64_t level2_table_index                     = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_offset < 0 )
+	 || ( ( (uint64_t) cluster_block_offset & internal_file->io_handle->cluster_block_bit_mask ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( buffer_size == 0 )
+	 || ( data_offset >= internal_file->io_handle->cluster_block_size )
+	 || ( buffer_size > ( internal_file->io_handle->cluster_block_size - data_offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid buffer size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( metadata_was_modified == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata was modified.",
+		 function );
+
+		return( -1 );
+	}
+	level1_table_index = (uint64_t) cluster_block_offset >> internal_file->io_handle->level1_index_bit_shift;
+
+	if( level1_table_index > (uint64_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_read_reference_by_index(
+	     internal_file->level1_table,
+	     file_io_handle,
+	     (int) level1_table_index,
+	     &level1_table_reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to retrieve level 1 table reference: %" PRIu64 ".",
+		 function,
+		 level1_table_index );
+
+		goto on_error;
+	}
+	level2_table_file_offset = level1_table_reference
+	                         & internal_file->io_handle->offset_bit_mask
+	                         & ~( (uint64_t) internal_file->io_handle->cluster_block_bit_mask );
+
+	if( level2_table_file_offset == 0 )
+	{
+		/* The new level 2 table is stored before the level 1 table references it
+		 */
+		if( libqcow_write_cache_allocate_cluster(
+		     internal_file->write_cache,
+		     file_io_handle,
+		     &new_level2_table_file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to allocate level 2 table.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_write_cache_get_block(
+		     internal_file->write_cache,
+		     file_io_handle,
+		     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE,
+		     new_level2_table_file_offset,
+		     0,
+		     &level2_table_block,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table: 0x%08" PRIx64 " from write cache.",
+			 function,
+			 new_level2_table_file_offset );
+
+			goto on_error;
+		}
+		if( libqcow_write_cache_write_block(
+		     internal_file->write_cache,
+		     file_io_handle,
+		     level2_table_block,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write level 2 table: 0x%08" PRIx64 ".",
+			 function,
+			 new_level2_table_file_offset );
+
+			goto on_error;
+		}
+		if( libqcow_write_cache_barrier(
+		     internal_file->write_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write barrier.",
+			 function );
+
+			goto on_error;
+		}
+		level1_table_reference = (uint64_t) new_level2_table_file_offset
+		                       | LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED;
+
+		byte_stream_copy_from_uint64_big_endian(
+		 level1_table_entry_data,
+		 level1_table_reference );
+
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               file_io_handle,
+		               level1_table_entry_data,
+		               8,
+		               internal_file->io_handle->level1_table_offset + (off64_t) ( level1_table_index * 8 ),
+		               error );
+
+		if( write_count != (ssize_t) 8 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write level 1 table entry: %" PRIu64 ".",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		if( libqcow_cluster_table_set_reference_by_index(
+		     internal_file->level1_table,
+		     (int) level1_table_index,
+		     level1_table_reference,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set level 1 table reference: %" PRIu64 ".",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		level2_table_file_offset = (uint64_t) new_level2_table_file_offset;
+
+		*metadata_was_modified = 1;
+	}
+	else if( ( level1_table_reference & LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED ) == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported level 2 table: 0x%08" PRIx64 " shared with a snapshot.",
+		 function,
+		 level2_table_file_offset );
+
+		goto on_error;
+	}
+	level2_table_index = ( (uint64_t) cluster_block_offset >> internal_file->io_handle->number_of_cluster_block_bits )
+	                   & internal_file->io_handle->level2_index_bit_mask;
+
+	if( libqcow_write_cache_get_block(
+	     internal_file->write_cache,
+	     file_io_handle,
+	     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE,
+	     (off64_t) level2_table_file_offset,
+	     1,
+	     &level2_table_block,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve level 2 table: 0x%08" PRIx64 " from write cache.",
+		 function,
+		 level2_table_file_offset );
+
+		goto on_error;
+	}
+	byte_stream_copy_to_uint64_big_endian(
+	 &( level2_table_block->data[ level2_table_index * 8 ] ),
+	 cluster_block_reference );
+
+	/* A cluster block that is not compressed, not marked as zero and only
+	 * referenced by the active level 2 table can be overwritten in place
+	 */
+	if( ( ( cluster_block_reference & LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED ) != 0 )
+	 && ( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) == 0 )
+	 && ( ( cluster_block_reference & internal_file->io_handle->zero_flag_bit_mask ) == 0 ) )
+	{
+		cluster_block_file_offset = cluster_block_reference
+		                          & internal_file->io_handle->offset_bit_mask
+		                          & ~( (uint64_t) internal_file->io_handle->cluster_block_bit_mask );
+	}
+	if( cluster_block_file_offset != 0 )
+	{
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               file_io_handle,
+		               buffer,
+		               buffer_size,
+		               (off64_t) ( cluster_block_file_offset + data_offset ),
+		               error );
+
+		if( write_count != (ssize_t) buffer_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write cluster block data at offset: 0x%08" PRIx64 ".",
+			 function,
+			 cluster_block_file_offset );
+
+			goto on_error;
+		}
+		return( 1 );
+	}
+	/* Otherwise the cluster block is copied on write
+	 */
+	if( libqcow_write_cache_allocate_cluster(
+	     internal_file->write_cache,
+	     file_io_handle,
+	     &new_cluster_block_file_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to allocate cluster block.",
+		 function );
+
+		goto on_error;
+	}
+	if( buffer_size != internal_file->io_handle->cluster_block_size )
+	{
+		/* The part of the cluster block that is not written is filled
+		 * with the data currently visible at the media offset
+		 */
+		cluster_block_data = (uint8_t *) memory_allocate(
+		                                  internal_file->io_handle->cluster_block_size );
+
+		if( cluster_block_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create cluster block data.",
+			 function );
+
+			goto on_error;
+		}
+		read_size = internal_file->io_handle->cluster_block_size;
+
+		if( read_size > ( internal_file->io_handle->media_size - (size64_t) cluster_block_offset ) )
+		{
+			read_size = (size_t) ( internal_file->io_handle->media_size - (size64_t) cluster_block_offset );
+		}
+		read_count = libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+		              internal_file,
+		              file_io_handle,
+		              cluster_block_data,
+		              read_size,
+		              cluster_block_offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 cluster_block_offset,
+			 cluster_block_offset );
+
+			goto on_error;
+		}
+		if( read_size < internal_file->io_handle->cluster_block_size )
+		{
+			if( memory_set(
+			     &( cluster_block_data[ read_size ] ),
+			     0,
+			     internal_file->io_handle->cluster_block_size - read_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to clear cluster block data.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		if( memory_copy(
+		     &( cluster_block_data[ data_offset ] ),
+		     buffer,
+		     buffer_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy buffer to cluster block data.",
+			 function );
+
+			goto on_error;
+		}
+		buffer = cluster_block_data;
+	}
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               buffer,
+	               internal_file->io_handle->cluster_block_size,
+	               new_cluster_block_file_offset,
+	               error );
+
+	if( write_count != (ssize_t) internal_file->io_handle->cluster_block_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write cluster block data at offset: 0x%08" PRIx64 ".",
+		 function,
+		 new_cluster_block_file_offset );
+
+		goto on_error;
+	}
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+
+		cluster_block_data = NULL;
+	}
+	/* The allocation can evict the level 2 table from the write cache
+	 */
+	if( libqcow_write_cache_get_block(
+	     internal_file->write_cache,
+	     file_io_handle,
+	     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE,
+	     (off64_t) level2_table_file_offset,
+	     1,
+	     &level2_table_block,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve level 2 table: 0x%08" PRIx64 " from write cache.",
+		 function,
+		 level2_table_file_offset );
+
+		goto on_error;
+	}
+	byte_stream_copy_from_uint64_big_endian(
+	 &( level2_table_block->data[ level2_table_index * 8 ] ),
+	 (uint64_t) new_cluster_block_file_offset | LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_COPIED );
+
+	level2_table_block->is_dirty = 1;
+
+	*metadata_was_modified = 1;
+
+	/* The clusters of the previous data are released once the level 2 table
+	 * no longer references them
+	 */
+	if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+	{
+		cluster_block_reference &= internal_file->io_handle->offset_bit_mask;
+
+		compressed_data_offset     = cluster_block_reference & internal_file->io_handle->compression_bit_mask;
+		compressed_data_end_offset = ( compressed_data_offset & ~( (uint64_t) 511 ) )
+		                           + ( ( ( cluster_block_reference >> internal_file->io_handle->compression_bit_shift ) + 1 ) * 512 );
+
+		for( cluster_index = compressed_data_offset >> internal_file->io_handle->number_of_cluster_block_bits;
+		     cluster_index <= ( ( compressed_data_end_offset - 1 ) >> internal_file->io_handle->number_of_cluster_block_bits );
+		     cluster_index++ )
+		{
+			if( libqcow_write_cache_release_cluster(
+			     internal_file->write_cache,
+			     cluster_index,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release cluster: %" PRIu64 ".",
+				 function,
+				 cluster_index );
+
+				goto on_error;
+			}
+		}
+	}
+	else
+	{
+		cluster_block_file_offset = cluster_block_reference
+		                          & internal_file->io_handle->offset_bit_mask
+		                          & ~( (uint64_t) internal_file->io_handle->cluster_block_bit_mask );
+
+		if( cluster_block_file_offset != 0 )
+		{
+			cluster_index = cluster_block_file_offset >> internal_file->io_handle->number_of_cluster_block_bits;
+
+			if( libqcow_write_cache_release_cluster(
+			     internal_file->write_cache,
+			     cluster_index,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release cluster: %" PRIu64 ".",
+				 function,
+				 cluster_index );
+
+				goto on_error;
+			}
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+	return( -1 );
+}
+
+/* Writes (media) data at the current offset from a buffer to the scratch overlay
+ * A cluster block that is not yet in the scratch overlay is read from the file
+ * when it is partially written, the file itself is not modified
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns the number of input bytes written or -1 on error
+ */
+ssize_t libqcow_internal_file_write_buffer_to_scratch_overlay(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	uint8_t *cluster_block_data  = NULL;
+	static char *function        = "libqcow_internal_file_write_buffer_to_scratch_overlay";
+	size_t buffer_offset         = 0;
+	size_t cluster_block_size    = 0;
+	size_t data_offset           = 0;
+	size_t write_size            = 0;
+	ssize_t read_count           = 0;
+	off64_t cluster_block_offset = 0;
+	uint64_t block_index         = 0;
+	int entry_index              = 0;
+	int result                   = 0;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	cluster_block_size = internal_file->io_handle->cluster_block_size;
+
+	while( buffer_offset < buffer_size )
+	{
+		data_offset          = (size_t) ( internal_file->current_offset & internal_file->io_handle->cluster_block_bit_mask );
+		cluster_block_offset = internal_file->current_offset - (off64_t) data_offset;
+		block_index          = (uint64_t) cluster_block_offset >> internal_file->scratch_overlay->number_of_block_bits;
+
+		write_size = cluster_block_size - data_offset;
+
+		if( write_size > ( buffer_size - buffer_offset ) )
+		{
+			write_size = buffer_size - buffer_offset;
+		}
+		result = libqcow_scratch_overlay_get_entry_index(
+		          internal_file->scratch_overlay,
+		          block_index,
+		          &entry_index,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve scratch overlay entry of cluster block: %" PRIu64 ".",
+			 function,
+			 block_index );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			result = libqcow_scratch_overlay_write_entry_data(
+			          internal_file->scratch_overlay,
+			          entry_index,
+			          data_offset,
+			          &( ( (const uint8_t *) buffer )[ buffer_offset ] ),
+			          write_size,
+			          error );
+		}
+		else if( write_size == cluster_block_size )
+		{
+			result = libqcow_scratch_overlay_append_block(
+			          internal_file->scratch_overlay,
+			          block_index,
+			          &( ( (const uint8_t *) buffer )[ buffer_offset ] ),
+			          error );
+		}
+		else
+		{
+			/* The data of a partially written cluster block is read from the file,
+			 * the cluster block is not yet in the scratch overlay so the data is not replaced
+			 */
+			if( cluster_block_data == NULL )
+			{
+				cluster_block_data = (uint8_t *) memory_allocate(
+				                                  cluster_block_size );
+
+				if( cluster_block_data == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+					 "%s: unable to create cluster block data.",
+					 function );
+
+					goto on_error;
+				}
+			}
+			if( memory_set(
+			     cluster_block_data,
+			     0,
+			     cluster_block_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+				 "%s: unable to clear cluster block data.",
+				 function );
+
+				goto on_error;
+			}
+			read_count = libqcow_internal_file_read_buffer_at_offset_from_file_io_handle(
+			              internal_file,
+			              file_io_handle,
+			              cluster_block_data,
+			              cluster_block_size,
+			              cluster_block_offset,
+			              error );
+
+			if( read_count == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 cluster_block_offset,
+				 cluster_block_offset );
+
+				goto on_error;
+			}
+			if( memory_copy(
+			     &( cluster_block_data[ data_offset ] ),
+			     &( ( (const uint8_t *) buffer )[ buffer_offset ] ),
+			     write_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy data to cluster block data.",
+				 function );
+
+				goto on_error;
+			}
+			result = libqcow_scratch_overlay_append_block(
+			          internal_file->scratch_overlay,
+			          block_index,
+			          cluster_block_data,
+			          error );
+		}
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write cluster block: %" PRIu64 " to scratch overlay.",
+			 function,
+			 block_index );
+
+			goto on_error;
+		}
+		buffer_offset                 += write_size;
+		internal_file->current_offset += (off64_t) write_size;
+	}
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+	return( (ssize_t) buffer_offset );
+
+on_error:
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+	return( -1 );
+}
+
+/* Writes (media) data at the current offset from a buffer using a Basic File IO (bfio) handle
+ * The modified level 2 tables and reference count blocks are written back at the end of the write
+ * or, when the scratch overlay is set, the data is written to the scratch overlay
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns the number of input bytes written, 0 when no longer bytes can be written or -1 on error
+ */
+ssize_t libqcow_internal_file_write_buffer_to_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	uint8_t autoclear_feature_flags_data[ 8 ];
+
+	static char *function         = "libqcow_internal_file_write_buffer_to_file_io_handle";
+	size_t buffer_offset          = 0;
+	size_t data_offset            = 0;
+	size_t write_size             = 0;
+	ssize_t write_count           = 0;
+	off64_t cluster_block_offset  = 0;
+	uint8_t metadata_was_modified = 0;
+	int cache_flags               = 0;
+	int result                    = 1;
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_file->write_cache == NULL )
+	 && ( internal_file->scratch_overlay == NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing write cache, file not opened for writing.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->current_offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file - current offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) internal_file->current_offset >= internal_file->io_handle->media_size )
+	{
+		return( 0 );
+	}
+	if( (size64_t) buffer_size > ( internal_file->io_handle->media_size - internal_file->current_offset ) )
+	{
+		buffer_size = (size_t) ( internal_file->io_handle->media_size - internal_file->current_offset );
+	}
+	if( buffer_size == 0 )
+	{
+		return( 0 );
+	}
+	if( internal_file->scratch_overlay != NULL )
+	{
+		return( libqcow_internal_file_write_buffer_to_scratch_overlay(
+		         internal_file,
+		         file_io_handle,
+		         buffer,
+		         buffer_size,
+		         error ) );
+	}
+	/* The autoclear feature flags indicate that the header extensions, such as the bitmaps,
+	 * are consistent with the data and are cleared before the data is modified
+	 */
+	if( internal_file->io_handle->autoclear_feature_flags != 0 )
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 autoclear_feature_flags_data,
+		 (uint64_t) 0 );
+
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               file_io_handle,
+		               autoclear_feature_flags_data,
+		               8,
+		               88,
+		               error );
+
+		if( write_count != (ssize_t) 8 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write autoclear feature flags.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_write_cache_barrier(
+		     internal_file->write_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to synchronize autoclear feature flags.",
+			 function );
+
+			return( -1 );
+		}
+		internal_file->io_handle->autoclear_feature_flags = 0;
+	}
+	while( buffer_offset < buffer_size )
+	{
+		data_offset          = (size_t) ( internal_file->current_offset & internal_file->io_handle->cluster_block_bit_mask );
+		cluster_block_offset = internal_file->current_offset - (off64_t) data_offset;
+
+		write_size = internal_file->io_handle->cluster_block_size - data_offset;
+
+		if( write_size > ( buffer_size - buffer_offset ) )
+		{
+			write_size = buffer_size - buffer_offset;
+		}
+		if( libqcow_internal_file_write_cluster_block(
+		     internal_file,
+		     file_io_handle,
+		     cluster_block_offset,
+		     data_offset,
+		     &( ( (const uint8_t *) buffer )[ buffer_offset ] ),
+		     write_size,
+		     &metadata_was_modified,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write cluster block at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 cluster_block_offset,
+			 cluster_block_offset );
+
+			result = -1;
+
+			break;
+		}
+		buffer_offset                 += write_size;
+		internal_file->current_offset += (off64_t) write_size;
+	}
+	/* The modified metadata is also written back when the write failed
+	 * so that the clusters written so far remain referenced
+	 */
+	if( libqcow_write_cache_write_dirty_blocks(
+	     internal_file->write_cache,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write modified metadata.",
+		 function );
+
+		result = -1;
+	}
+	if( libbfio_handle_get_size(
+	     file_io_handle,
+	     &( internal_file->size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to retrieve file size.",
+		 function );
+
+		result = -1;
+	}
+	/* The cached data is no longer valid after a write and the cached metadata
+	 * after a write that modified the level 1 or 2 tables
+	 */
+	if( metadata_was_modified != 0 )
+	{
+		cache_flags = LIBQCOW_CACHE_FLAG_ALL;
+	}
+	else
+	{
+		cache_flags = LIBQCOW_CACHE_FLAG_CLUSTER_BLOCKS;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( libqcow_internal_file_drop_caches(
+	     internal_file,
+	     cache_flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+		 "%s: unable to drop caches.",
+		 function );
+
+		result = -1;
+	}
+	if( metadata_was_modified != 0 )
+	{
+		if( libqcow_metadata_index_free(
+		     &( internal_file->metadata_index ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free metadata index.",
+			 function );
+
+			result = -1;
+		}
+		if( libqcow_chain_index_free(
+		     &( internal_file->chain_index ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free chain index.",
+			 function );
+
+			result = -1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_file->cache_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release cache mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result != 1 )
+	{
+		return( -1 );
+	}
+	return( (ssize_t) buffer_offset );
+}
+
+/* Flushes the data written to the file
+ * This function is not multi-thread safe acquire write lock before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_file_flush(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_file_flush";
+
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	/* A file that was not opened for writing has nothing to flush
+	 */
+	if( internal_file->write_cache == NULL )
+	{
+		return( 1 );
+	}
+	if( libqcow_write_cache_flush(
+	     internal_file->write_cache,
+	     internal_file->file_io_handle,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to flush write cache.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,73 @@
+/*
+ * File write functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_FILE_WRITE_H )
+#define _LIBQCOW_FILE_WRITE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_file.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+int libqcow_internal_file_open_write(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_internal_file_write_cluster_block(
+     libqcow_internal_file_t *internal_file,
+     libbfio_handle_t *file_io_handle,
+     off64_t cluster_block_offset,
+     size_t data_offset,
+     const uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *metadata_was_modified,
+     libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_write_buffer_to_scratch_overlay(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_internal_file_write_buffer_to_file_io_handle(
+         libqcow_internal_file_t *internal_file,
+         libbfio_handle_t *file_io_handle,
+         const void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error );
+
+int libqcow_internal_file_flush(
+     libqcow_internal_file_t *internal_file,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_FILE_WRITE_H ) */
@@ -0,0 +1,1723 @@
+/*
+ * Hardware accelerated AES functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_hardware_aes.h"
+#include "libqcow_libcerror.h"
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI )
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <wmmintrin.h>
+
+#if defined( __GNUC__ ) && !defined( __AES__ )
+#define LIBQCOW_HARDWARE_AES_NI_TARGET		__attribute__((target("aes,sse2")))
+#else
+#define LIBQCOW_HARDWARE_AES_NI_TARGET
+#endif
+
+#endif /* defined( HAVE_LIBQCOW_HARDWARE_AES_NI ) */
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+#include <arm_neon.h>
+
+#if defined( HAVE_SYS_AUXV_H )
+#include <sys/auxv.h>
+#endif
+
+#if !defined( HWCAP_AES )
+#define HWCAP_AES				( 1 << 3 )
+#endif
+
+#if defined( __ARM_FEATURE_CRYPTO ) || defined( __ARM_FEATURE_AES )
+#define LIBQCOW_HARDWARE_AES_ARMV8_TARGET
+#elif defined( __clang__ )
+#define LIBQCOW_HARDWARE_AES_ARMV8_TARGET	__attribute__((target("crypto")))
+#else
+#define LIBQCOW_HARDWARE_AES_ARMV8_TARGET	__attribute__((target("+crypto")))
+#endif
+
+#endif /* defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 ) */
+
+/* The AES substitution box (S-box)
+ */
+static const uint8_t libqcow_hardware_aes_substitution_box[ 256 ] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
+	0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+	0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc,
+	0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a,
+	0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+	0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b,
+	0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85,
+	0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+	0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17,
+	0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88,
+	0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+	0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9,
+	0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6,
+	0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+	0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94,
+	0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68,
+	0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+/* The AES key expansion round constants
+ */
+static const uint8_t libqcow_hardware_aes_round_constants[ 10 ] = {
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+/* The detected backend, -1 if not detected yet
+ */
+static int libqcow_hardware_aes_backend = -1;
+
+/* Multiplies a value by 2 in the AES Galois field GF(2^8)
+ */
+#define libqcow_hardware_aes_multiply_by_2( value ) \
+	(uint8_t) ( ( ( value ) << 1 ) ^ ( ( ( value ) & 0x80 ) != 0 ? 0x1b : 0x00 ) )
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI ) || defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+
+/* Multiplies a XTS tweak by the primitive element alpha in GF(2^128)
+ * The tweak is stored as 2 64-bit values, the least significant first
+ */
+static void libqcow_hardware_aes_xts_multiply_tweak(
+             uint64_t *tweak_values )
+{
+	uint64_t carry = tweak_values[ 1 ] >> 63;
+
+	tweak_values[ 1 ] = ( tweak_values[ 1 ] << 1 ) | ( tweak_values[ 0 ] >> 63 );
+	tweak_values[ 0 ] = ( tweak_values[ 0 ] << 1 ) ^ ( (uint64_t) 0x87UL & ( (uint64_t) 0 - carry ) );
+}
+
+#endif /* defined( HAVE_LIBQCOW_HARDWARE_AES_NI ) || defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 ) */
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI )
+
+/* Determines if the CPU supports the AES-NI instructions
+ * Returns 1 if supported or 0 if not
+ */
+static int libqcow_hardware_aes_ni_is_supported(
+            void )
+{
+#if defined( _MSC_VER )
+	int cpu_information[ 4 ];
+
+	__cpuid(
+	 cpu_information,
+	 1 );
+
+	if( ( cpu_information[ 2 ] & ( 1 << 25 ) ) != 0 )
+	{
+		return( 1 );
+	}
+#else
+	unsigned int eax = 0;
+	unsigned int ebx = 0;
+	unsigned int ecx = 0;
+	unsigned int edx = 0;
+
+	if( __get_cpuid(
+	     1,
+	     &eax,
+	     &ebx,
+	     &ecx,
+	     &edx ) == 0 )
+	{
+		return( 0 );
+	}
+	/* Bit 25 of ECX indicates AES-NI, bit 26 of EDX indicates SSE2
+	 */
+	if( ( ( ecx & ( 1 << 25 ) ) != 0 )
+	 && ( ( edx & ( 1 << 26 ) ) != 0 ) )
+	{
+		return( 1 );
+	}
+#endif
+	return( 0 );
+}
+
+/* Decrypts AES-CBC data using the AES-NI instructions
+ * The number of rounds depends on the key size and the data size must be a multiple of 16, 4 blocks are decrypted at a time
+ * since CBC decryption of the individual blocks does not depend on each other
+ */
+static LIBQCOW_HARDWARE_AES_NI_TARGET void libqcow_hardware_aes_ni_decrypt_cbc(
+                                            const uint8_t *round_keys,
+                                            int number_of_rounds,
+                                            const uint8_t *initialization_vector,
+                                            const uint8_t *input_data,
+                                            uint8_t *output_data,
+                                            size_t data_size )
+{
+	__m128i keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+
+	__m128i block1        = _mm_setzero_si128();
+	__m128i block2        = _mm_setzero_si128();
+	__m128i block3        = _mm_setzero_si128();
+	__m128i block4        = _mm_setzero_si128();
+	__m128i cipher_block1 = _mm_setzero_si128();
+	__m128i cipher_block2 = _mm_setzero_si128();
+	__m128i cipher_block3 = _mm_setzero_si128();
+	__m128i cipher_block4 = _mm_setzero_si128();
+	__m128i previous      = _mm_setzero_si128();
+	size_t data_offset    = 0;
+	int round_index       = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = _mm_loadu_si128(
+		                       (const __m128i *) &( round_keys[ round_index * 16 ] ) );
+	}
+	previous = _mm_loadu_si128(
+	            (const __m128i *) initialization_vector );
+
+	while( ( data_offset + 64 ) <= data_size )
+	{
+		cipher_block1 = _mm_loadu_si128(
+		                 (const __m128i *) &( input_data[ data_offset ] ) );
+		cipher_block2 = _mm_loadu_si128(
+		                 (const __m128i *) &( input_data[ data_offset + 16 ] ) );
+		cipher_block3 = _mm_loadu_si128(
+		                 (const __m128i *) &( input_data[ data_offset + 32 ] ) );
+		cipher_block4 = _mm_loadu_si128(
+		                 (const __m128i *) &( input_data[ data_offset + 48 ] ) );
+
+		block1 = _mm_xor_si128(
+		          cipher_block1,
+		          keys[ 0 ] );
+		block2 = _mm_xor_si128(
+		          cipher_block2,
+		          keys[ 0 ] );
+		block3 = _mm_xor_si128(
+		          cipher_block3,
+		          keys[ 0 ] );
+		block4 = _mm_xor_si128(
+		          cipher_block4,
+		          keys[ 0 ] );
+
+		for( round_index = 1;
+		     round_index < number_of_rounds;
+		     round_index++ )
+		{
+			block1 = _mm_aesdec_si128(
+			          block1,
+			          keys[ round_index ] );
+			block2 = _mm_aesdec_si128(
+			          block2,
+			          keys[ round_index ] );
+			block3 = _mm_aesdec_si128(
+			          block3,
+			          keys[ round_index ] );
+			block4 = _mm_aesdec_si128(
+			          block4,
+			          keys[ round_index ] );
+		}
+		block1 = _mm_aesdeclast_si128(
+		          block1,
+		          keys[ number_of_rounds ] );
+		block2 = _mm_aesdeclast_si128(
+		          block2,
+		          keys[ number_of_rounds ] );
+		block3 = _mm_aesdeclast_si128(
+		          block3,
+		          keys[ number_of_rounds ] );
+		block4 = _mm_aesdeclast_si128(
+		          block4,
+		          keys[ number_of_rounds ] );
+
+		block1 = _mm_xor_si128(
+		          block1,
+		          previous );
+		block2 = _mm_xor_si128(
+		          block2,
+		          cipher_block1 );
+		block3 = _mm_xor_si128(
+		          block3,
+		          cipher_block2 );
+		block4 = _mm_xor_si128(
+		          block4,
+		          cipher_block3 );
+
+		previous = cipher_block4;
+
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset ] ),
+		 block1 );
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset + 16 ] ),
+		 block2 );
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset + 32 ] ),
+		 block3 );
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset + 48 ] ),
+		 block4 );
+
+		data_offset += 64;
+	}
+	while( data_offset < data_size )
+	{
+		cipher_block1 = _mm_loadu_si128(
+		                 (const __m128i *) &( input_data[ data_offset ] ) );
+
+		block1 = _mm_xor_si128(
+		          cipher_block1,
+		          keys[ 0 ] );
+
+		for( round_index = 1;
+		     round_index < number_of_rounds;
+		     round_index++ )
+		{
+			block1 = _mm_aesdec_si128(
+			          block1,
+			          keys[ round_index ] );
+		}
+		block1 = _mm_aesdeclast_si128(
+		          block1,
+		          keys[ number_of_rounds ] );
+		block1 = _mm_xor_si128(
+		          block1,
+		          previous );
+
+		previous = cipher_block1;
+
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset ] ),
+		 block1 );
+
+		data_offset += 16;
+	}
+}
+
+/* Encrypts AES-CBC data using the AES-NI instructions
+ * The number of rounds depends on the key size and the data size must be a multiple of 16
+ */
+static LIBQCOW_HARDWARE_AES_NI_TARGET void libqcow_hardware_aes_ni_encrypt_cbc(
+                                            const uint8_t *round_keys,
+                                            int number_of_rounds,
+                                            const uint8_t *initialization_vector,
+                                            const uint8_t *input_data,
+                                            uint8_t *output_data,
+                                            size_t data_size )
+{
+	__m128i keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+
+	__m128i block      = _mm_setzero_si128();
+	size_t data_offset = 0;
+	int round_index    = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = _mm_loadu_si128(
+		                       (const __m128i *) &( round_keys[ round_index * 16 ] ) );
+	}
+	block = _mm_loadu_si128(
+	         (const __m128i *) initialization_vector );
+
+	while( data_offset < data_size )
+	{
+		block = _mm_xor_si128(
+		         block,
+		         _mm_loadu_si128(
+		          (const __m128i *) &( input_data[ data_offset ] ) ) );
+		block = _mm_xor_si128(
+		         block,
+		         keys[ 0 ] );
+
+		for( round_index = 1;
+		     round_index < number_of_rounds;
+		     round_index++ )
+		{
+			block = _mm_aesenc_si128(
+			         block,
+			         keys[ round_index ] );
+		}
+		block = _mm_aesenclast_si128(
+		         block,
+		         keys[ number_of_rounds ] );
+
+		_mm_storeu_si128(
+		 (__m128i *) &( output_data[ data_offset ] ),
+		 block );
+
+		data_offset += 16;
+	}
+}
+
+/* De- or encrypts blocks of data in place using the AES-NI instructions
+ */
+static LIBQCOW_HARDWARE_AES_NI_TARGET void libqcow_hardware_aes_ni_crypt_xts_blocks(
+                                            const __m128i *keys,
+                                            int number_of_rounds,
+                                            int mode,
+                                            __m128i *blocks,
+                                            int number_of_blocks )
+{
+	int block_index = 0;
+	int round_index = 0;
+
+	for( block_index = 0;
+	     block_index < number_of_blocks;
+	     block_index++ )
+	{
+		blocks[ block_index ] = _mm_xor_si128(
+		                         blocks[ block_index ],
+		                         keys[ 0 ] );
+	}
+	if( mode == LIBCAES_CRYPT_MODE_DECRYPT )
+	{
+		for( round_index = 1;
+		     round_index < number_of_rounds;
+		     round_index++ )
+		{
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				blocks[ block_index ] = _mm_aesdec_si128(
+				                         blocks[ block_index ],
+				                         keys[ round_index ] );
+			}
+		}
+		for( block_index = 0;
+		     block_index < number_of_blocks;
+		     block_index++ )
+		{
+			blocks[ block_index ] = _mm_aesdeclast_si128(
+			                         blocks[ block_index ],
+			                         keys[ number_of_rounds ] );
+		}
+	}
+	else
+	{
+		for( round_index = 1;
+		     round_index < number_of_rounds;
+		     round_index++ )
+		{
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				blocks[ block_index ] = _mm_aesenc_si128(
+				                         blocks[ block_index ],
+				                         keys[ round_index ] );
+			}
+		}
+		for( block_index = 0;
+		     block_index < number_of_blocks;
+		     block_index++ )
+		{
+			blocks[ block_index ] = _mm_aesenclast_si128(
+			                         blocks[ block_index ],
+			                         keys[ number_of_rounds ] );
+		}
+	}
+}
+
+/* De- or encrypts AES-XTS data using the AES-NI instructions
+ * The data consists of consecutive sectors, where the tweak of a sector is
+ * its sector number encrypted with the tweak key (plain64), 4 blocks are
+ * de- or encrypted at a time since the blocks do not depend on each other
+ */
+static LIBQCOW_HARDWARE_AES_NI_TARGET void libqcow_hardware_aes_ni_crypt_xts(
+                                            const uint8_t *round_keys,
+                                            int number_of_rounds,
+                                            const uint8_t *tweak_round_keys,
+                                            int tweak_number_of_rounds,
+                                            int mode,
+                                            uint64_t sector_number,
+                                            size_t sector_size,
+                                            const uint8_t *input_data,
+                                            uint8_t *output_data,
+                                            size_t data_size )
+{
+	__m128i keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+	__m128i tweak_keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+	__m128i blocks[ 4 ];
+	__m128i tweaks[ 4 ];
+	uint64_t tweak_values[ 2 ];
+
+	size_t data_offset       = 0;
+	size_t sector_end_offset = 0;
+	int block_index          = 0;
+	int number_of_blocks     = 0;
+	int round_index          = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = _mm_loadu_si128(
+		                       (const __m128i *) &( round_keys[ round_index * 16 ] ) );
+	}
+	for( round_index = 0;
+	     round_index <= tweak_number_of_rounds;
+	     round_index++ )
+	{
+		tweak_keys[ round_index ] = _mm_loadu_si128(
+		                             (const __m128i *) &( tweak_round_keys[ round_index * 16 ] ) );
+	}
+	while( data_offset < data_size )
+	{
+		tweak_values[ 0 ] = sector_number;
+		tweak_values[ 1 ] = 0;
+
+		tweaks[ 0 ] = _mm_loadu_si128(
+		               (const __m128i *) tweak_values );
+
+		libqcow_hardware_aes_ni_crypt_xts_blocks(
+		 tweak_keys,
+		 tweak_number_of_rounds,
+		 LIBCAES_CRYPT_MODE_ENCRYPT,
+		 tweaks,
+		 1 );
+
+		_mm_storeu_si128(
+		 (__m128i *) tweak_values,
+		 tweaks[ 0 ] );
+
+		sector_end_offset = data_offset + sector_size;
+
+		while( data_offset < sector_end_offset )
+		{
+			if( ( data_offset + 64 ) <= sector_end_offset )
+			{
+				number_of_blocks = 4;
+			}
+			else
+			{
+				number_of_blocks = 1;
+			}
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				tweaks[ block_index ] = _mm_loadu_si128(
+				                         (const __m128i *) tweak_values );
+
+				libqcow_hardware_aes_xts_multiply_tweak(
+				 tweak_values );
+
+				blocks[ block_index ] = _mm_xor_si128(
+				                         _mm_loadu_si128(
+				                          (const __m128i *) &( input_data[ data_offset + ( block_index * 16 ) ] ) ),
+				                         tweaks[ block_index ] );
+			}
+			libqcow_hardware_aes_ni_crypt_xts_blocks(
+			 keys,
+			 number_of_rounds,
+			 mode,
+			 blocks,
+			 number_of_blocks );
+
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				_mm_storeu_si128(
+				 (__m128i *) &( output_data[ data_offset + ( block_index * 16 ) ] ),
+				 _mm_xor_si128(
+				  blocks[ block_index ],
+				  tweaks[ block_index ] ) );
+			}
+			data_offset += (size_t) number_of_blocks * 16;
+		}
+		sector_number++;
+	}
+}
+
+#endif /* defined( HAVE_LIBQCOW_HARDWARE_AES_NI ) */
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+
+/* Determines if the CPU supports the ARMv8 Cryptography Extensions
+ * Returns 1 if supported or 0 if not
+ */
+static int libqcow_hardware_aes_armv8_is_supported(
+            void )
+{
+#if defined( __APPLE__ )
+	return( 1 );
+
+#elif defined( HAVE_SYS_AUXV_H ) && defined( AT_HWCAP )
+	if( ( getauxval( AT_HWCAP ) & HWCAP_AES ) != 0 )
+	{
+		return( 1 );
+	}
+	return( 0 );
+
+#else
+	return( 0 );
+
+#endif
+}
+
+/* Decrypts AES-CBC data using the ARMv8 Cryptography Extensions
+ * The number of rounds depends on the key size and the data size must be a multiple of 16, 4 blocks are decrypted at a time
+ * since CBC decryption of the individual blocks does not depend on each other
+ */
+static LIBQCOW_HARDWARE_AES_ARMV8_TARGET void libqcow_hardware_aes_armv8_decrypt_cbc(
+                                               const uint8_t *round_keys,
+                                               int number_of_rounds,
+                                               const uint8_t *initialization_vector,
+                                               const uint8_t *input_data,
+                                               uint8_t *output_data,
+                                               size_t data_size )
+{
+	uint8x16_t keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+
+	uint8x16_t block1        = vdupq_n_u8( 0 );
+	uint8x16_t block2        = vdupq_n_u8( 0 );
+	uint8x16_t block3        = vdupq_n_u8( 0 );
+	uint8x16_t block4        = vdupq_n_u8( 0 );
+	uint8x16_t cipher_block1 = vdupq_n_u8( 0 );
+	uint8x16_t cipher_block2 = vdupq_n_u8( 0 );
+	uint8x16_t cipher_block3 = vdupq_n_u8( 0 );
+	uint8x16_t cipher_block4 = vdupq_n_u8( 0 );
+	uint8x16_t previous      = vdupq_n_u8( 0 );
+	size_t data_offset       = 0;
+	int round_index          = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = vld1q_u8(
+		                       &( round_keys[ round_index * 16 ] ) );
+	}
+	previous = vld1q_u8(
+	            initialization_vector );
+
+	while( ( data_offset + 64 ) <= data_size )
+	{
+		cipher_block1 = vld1q_u8(
+		                 &( input_data[ data_offset ] ) );
+		cipher_block2 = vld1q_u8(
+		                 &( input_data[ data_offset + 16 ] ) );
+		cipher_block3 = vld1q_u8(
+		                 &( input_data[ data_offset + 32 ] ) );
+		cipher_block4 = vld1q_u8(
+		                 &( input_data[ data_offset + 48 ] ) );
+
+		block1 = cipher_block1;
+		block2 = cipher_block2;
+		block3 = cipher_block3;
+		block4 = cipher_block4;
+
+		for( round_index = 0;
+		     round_index < ( number_of_rounds - 1 );
+		     round_index++ )
+		{
+			block1 = vaesimcq_u8(
+			          vaesdq_u8(
+			           block1,
+			           keys[ round_index ] ) );
+			block2 = vaesimcq_u8(
+			          vaesdq_u8(
+			           block2,
+			           keys[ round_index ] ) );
+			block3 = vaesimcq_u8(
+			          vaesdq_u8(
+			           block3,
+			           keys[ round_index ] ) );
+			block4 = vaesimcq_u8(
+			          vaesdq_u8(
+			           block4,
+			           keys[ round_index ] ) );
+		}
+		block1 = veorq_u8(
+		          vaesdq_u8(
+		           block1,
+		           keys[ number_of_rounds - 1 ] ),
+		          keys[ number_of_rounds ] );
+		block2 = veorq_u8(
+		          vaesdq_u8(
+		           block2,
+		           keys[ number_of_rounds - 1 ] ),
+		          keys[ number_of_rounds ] );
+		block3 = veorq_u8(
+		          vaesdq_u8(
+		           block3,
+		           keys[ number_of_rounds - 1 ] ),
+		          keys[ number_of_rounds ] );
+		block4 = veorq_u8(
+		          vaesdq_u8(
+		           block4,
+		           keys[ number_of_rounds - 1 ] ),
+		          keys[ number_of_rounds ] );
+
+		block1 = veorq_u8(
+		          block1,
+		          previous );
+		block2 = veorq_u8(
+		          block2,
+		          cipher_block1 );
+		block3 = veorq_u8(
+		          block3,
+		          cipher_block2 );
+		block4 = veorq_u8(
+		          block4,
+		          cipher_block3 );
+
+		previous = cipher_block4;
+
+		vst1q_u8(
+		 &( output_data[ data_offset ] ),
+		 block1 );
+		vst1q_u8(
+		 &( output_data[ data_offset + 16 ] ),
+		 block2 );
+		vst1q_u8(
+		 &( output_data[ data_offset + 32 ] ),
+		 block3 );
+		vst1q_u8(
+		 &( output_data[ data_offset + 48 ] ),
+		 block4 );
+
+		data_offset += 64;
+	}
+	while( data_offset < data_size )
+	{
+		cipher_block1 = vld1q_u8(
+		                 &( input_data[ data_offset ] ) );
+
+		block1 = cipher_block1;
+
+		for( round_index = 0;
+		     round_index < ( number_of_rounds - 1 );
+		     round_index++ )
+		{
+			block1 = vaesimcq_u8(
+			          vaesdq_u8(
+			           block1,
+			           keys[ round_index ] ) );
+		}
+		block1 = veorq_u8(
+		          vaesdq_u8(
+		           block1,
+		           keys[ number_of_rounds - 1 ] ),
+		          keys[ number_of_rounds ] );
+		block1 = veorq_u8(
+		          block1,
+		          previous );
+
+		previous = cipher_block1;
+
+		vst1q_u8(
+		 &( output_data[ data_offset ] ),
+		 block1 );
+
+		data_offset += 16;
+	}
+}
+
+/* Encrypts AES-CBC data using the ARMv8 Cryptography Extensions
+ * The number of rounds depends on the key size and the data size must be a multiple of 16
+ */
+static LIBQCOW_HARDWARE_AES_ARMV8_TARGET void libqcow_hardware_aes_armv8_encrypt_cbc(
+                                               const uint8_t *round_keys,
+                                               int number_of_rounds,
+                                               const uint8_t *initialization_vector,
+                                               const uint8_t *input_data,
+                                               uint8_t *output_data,
+                                               size_t data_size )
+{
+	uint8x16_t keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+
+	uint8x16_t block   = vdupq_n_u8( 0 );
+	size_t data_offset = 0;
+	int round_index    = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = vld1q_u8(
+		                       &( round_keys[ round_index * 16 ] ) );
+	}
+	block = vld1q_u8(
+	         initialization_vector );
+
+	while( data_offset < data_size )
+	{
+		block = veorq_u8(
+		         block,
+		         vld1q_u8(
+		          &( input_data[ data_offset ] ) ) );
+
+		for( round_index = 0;
+		     round_index < ( number_of_rounds - 1 );
+		     round_index++ )
+		{
+			block = vaesmcq_u8(
+			         vaeseq_u8(
+			          block,
+			          keys[ round_index ] ) );
+		}
+		block = veorq_u8(
+		         vaeseq_u8(
+		          block,
+		          keys[ number_of_rounds - 1 ] ),
+		         keys[ number_of_rounds ] );
+
+		vst1q_u8(
+		 &( output_data[ data_offset ] ),
+		 block );
+
+		data_offset += 16;
+	}
+}
+
+/* De- or encrypts blocks of data in place using the ARMv8 Cryptography Extensions
+ */
+static LIBQCOW_HARDWARE_AES_ARMV8_TARGET void libqcow_hardware_aes_armv8_crypt_xts_blocks(
+                                               const uint8x16_t *keys,
+                                               int number_of_rounds,
+                                               int mode,
+                                               uint8x16_t *blocks,
+                                               int number_of_blocks )
+{
+	int block_index = 0;
+	int round_index = 0;
+
+	if( mode == LIBCAES_CRYPT_MODE_DECRYPT )
+	{
+		for( round_index = 0;
+		     round_index < ( number_of_rounds - 1 );
+		     round_index++ )
+		{
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				blocks[ block_index ] = vaesimcq_u8(
+				                         vaesdq_u8(
+				                          blocks[ block_index ],
+				                          keys[ round_index ] ) );
+			}
+		}
+		for( block_index = 0;
+		     block_index < number_of_blocks;
+		     block_index++ )
+		{
+			blocks[ block_index ] = veorq_u8(
+			                         vaesdq_u8(
+			                          blocks[ block_index ],
+			                          keys[ number_of_rounds - 1 ] ),
+			                         keys[ number_of_rounds ] );
+		}
+	}
+	else
+	{
+		for( round_index = 0;
+		     round_index < ( number_of_rounds - 1 );
+		     round_index++ )
+		{
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				blocks[ block_index ] = vaesmcq_u8(
+				                         vaeseq_u8(
+				                          blocks[ block_index ],
+				                          keys[ round_index ] ) );
+			}
+		}
+		for( block_index = 0;
+		     block_index < number_of_blocks;
+		     block_index++ )
+		{
+			blocks[ block_index ] = veorq_u8(
+			                         vaeseq_u8(
+			                          blocks[ block_index ],
+			                          keys[ number_of_rounds - 1 ] ),
+			                         keys[ number_of_rounds ] );
+		}
+	}
+}
+
+/* De- or encrypts AES-XTS data using the ARMv8 Cryptography Extensions
+ * The data consists of consecutive sectors, where the tweak of a sector is
+ * its sector number encrypted with the tweak key (plain64), 4 blocks are
+ * de- or encrypted at a time since the blocks do not depend on each other
+ */
+static LIBQCOW_HARDWARE_AES_ARMV8_TARGET void libqcow_hardware_aes_armv8_crypt_xts(
+                                               const uint8_t *round_keys,
+                                               int number_of_rounds,
+                                               const uint8_t *tweak_round_keys,
+                                               int tweak_number_of_rounds,
+                                               int mode,
+                                               uint64_t sector_number,
+                                               size_t sector_size,
+                                               const uint8_t *input_data,
+                                               uint8_t *output_data,
+                                               size_t data_size )
+{
+	uint8x16_t keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+	uint8x16_t tweak_keys[ LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ];
+	uint8x16_t blocks[ 4 ];
+	uint8x16_t tweaks[ 4 ];
+	uint64_t tweak_values[ 2 ];
+
+	size_t data_offset       = 0;
+	size_t sector_end_offset = 0;
+	int block_index          = 0;
+	int number_of_blocks     = 0;
+	int round_index          = 0;
+
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		keys[ round_index ] = vld1q_u8(
+		                       &( round_keys[ round_index * 16 ] ) );
+	}
+	for( round_index = 0;
+	     round_index <= tweak_number_of_rounds;
+	     round_index++ )
+	{
+		tweak_keys[ round_index ] = vld1q_u8(
+		                             &( tweak_round_keys[ round_index * 16 ] ) );
+	}
+	while( data_offset < data_size )
+	{
+		tweak_values[ 0 ] = sector_number;
+		tweak_values[ 1 ] = 0;
+
+		tweaks[ 0 ] = vld1q_u8(
+		               (const uint8_t *) tweak_values );
+
+		libqcow_hardware_aes_armv8_crypt_xts_blocks(
+		 tweak_keys,
+		 tweak_number_of_rounds,
+		 LIBCAES_CRYPT_MODE_ENCRYPT,
+		 tweaks,
+		 1 );
+
+		vst1q_u8(
+		 (uint8_t *) tweak_values,
+		 tweaks[ 0 ] );
+
+		sector_end_offset = data_offset + sector_size;
+
+		while( data_offset < sector_end_offset )
+		{
+			if( ( data_offset + 64 ) <= sector_end_offset )
+			{
+				number_of_blocks = 4;
+			}
+			else
+			{
+				number_of_blocks = 1;
+			}
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				tweaks[ block_index ] = vld1q_u8(
+				                         (const uint8_t *) tweak_values );
+
+				libqcow_hardware_aes_xts_multiply_tweak(
+				 tweak_values );
+
+				blocks[ block_index ] = veorq_u8(
+				                         vld1q_u8(
+				                          &( input_data[ data_offset + ( block_index * 16 ) ] ) ),
+				                         tweaks[ block_index ] );
+			}
+			libqcow_hardware_aes_armv8_crypt_xts_blocks(
+			 keys,
+			 number_of_rounds,
+			 mode,
+			 blocks,
+			 number_of_blocks );
+
+			for( block_index = 0;
+			     block_index < number_of_blocks;
+			     block_index++ )
+			{
+				vst1q_u8(
+				 &( output_data[ data_offset + ( block_index * 16 ) ] ),
+				 veorq_u8(
+				  blocks[ block_index ],
+				  tweaks[ block_index ] ) );
+			}
+			data_offset += (size_t) number_of_blocks * 16;
+		}
+		sector_number++;
+	}
+}
+
+#endif /* defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 ) */
+
+/* Retrieves the hardware AES backend supported by the CPU
+ * Returns a LIBQCOW_HARDWARE_AES_BACKEND value
+ */
+int libqcow_hardware_aes_get_backend(
+     void )
+{
+	int backend = libqcow_hardware_aes_backend;
+
+	/* Detecting the backend more than once yields the same result
+	 * hence it does not need to be protected against concurrent access
+	 */
+	if( backend == -1 )
+	{
+		backend = LIBQCOW_HARDWARE_AES_BACKEND_NONE;
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI )
+		if( libqcow_hardware_aes_ni_is_supported() != 0 )
+		{
+			backend = LIBQCOW_HARDWARE_AES_BACKEND_AES_NI;
+		}
+#endif
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+		if( libqcow_hardware_aes_armv8_is_supported() != 0 )
+		{
+			backend = LIBQCOW_HARDWARE_AES_BACKEND_ARMV8;
+		}
+#endif
+		libqcow_hardware_aes_backend = backend;
+	}
+	return( backend );
+}
+
+/* Retrieves the name of a hardware AES backend
+ * Returns a string containing the name
+ */
+const char *libqcow_hardware_aes_get_backend_name(
+             int backend )
+{
+	switch( backend )
+	{
+		case LIBQCOW_HARDWARE_AES_BACKEND_AES_NI:
+			return( "AES-NI" );
+
+		case LIBQCOW_HARDWARE_AES_BACKEND_ARMV8:
+			return( "ARMv8 Cryptography Extensions" );
+
+		default:
+			break;
+	}
+	return( "libcaes" );
+}
+
+/* Creates a hardware AES context
+ * Make sure the value context is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hardware_aes_context_initialize(
+     libqcow_hardware_aes_context_t **context,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hardware_aes_context_initialize";
+	int backend           = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( *context != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid context value already set.",
+		 function );
+
+		return( -1 );
+	}
+	backend = libqcow_hardware_aes_get_backend();
+
+	if( backend == LIBQCOW_HARDWARE_AES_BACKEND_NONE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: hardware AES not supported.",
+		 function );
+
+		return( -1 );
+	}
+	*context = memory_allocate_structure(
+	            libqcow_hardware_aes_context_t );
+
+	if( *context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create context.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     *context,
+	     0,
+	     sizeof( libqcow_hardware_aes_context_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear context.",
+		 function );
+
+		memory_free(
+		 *context );
+
+		*context = NULL;
+
+		return( -1 );
+	}
+	( *context )->backend = backend;
+
+	return( 1 );
+}
+
+/* Frees a hardware AES context
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hardware_aes_context_free(
+     libqcow_hardware_aes_context_t **context,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hardware_aes_context_free";
+	int result            = 1;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( *context != NULL )
+	{
+		/* Clear the round keys since they contain the key material
+		 */
+		if( memory_set(
+		     *context,
+		     0,
+		     sizeof( libqcow_hardware_aes_context_t ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear context.",
+			 function );
+
+			result = -1;
+		}
+		memory_free(
+		 *context );
+
+		*context = NULL;
+	}
+	return( result );
+}
+
+/* Sets the key
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hardware_aes_context_set_key(
+     libqcow_hardware_aes_context_t *context,
+     const uint8_t *key,
+     size_t key_bit_size,
+     libcerror_error_t **error )
+{
+	uint8_t word[ 4 ];
+
+	uint8_t *round_key    = NULL;
+	static char *function = "libqcow_hardware_aes_context_set_key";
+	size_t byte_index     = 0;
+	size_t key_size       = 0;
+	uint8_t value0        = 0;
+	uint8_t value1        = 0;
+	uint8_t value2        = 0;
+	uint8_t value3        = 0;
+	int number_of_rounds  = 0;
+	int round_index       = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	switch( key_bit_size )
+	{
+		case 128:
+			number_of_rounds = 10;
+			break;
+
+		case 192:
+			number_of_rounds = 12;
+			break;
+
+		case 256:
+			number_of_rounds = 14;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported key bit size.",
+			 function );
+
+			return( -1 );
+	}
+	key_size = key_bit_size / 8;
+
+	/* Expand the key into the encryption round keys as defined in FIPS-197
+	 */
+	if( memory_copy(
+	     context->encryption_round_keys,
+	     key,
+	     key_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy key.",
+		 function );
+
+		return( -1 );
+	}
+	for( byte_index = key_size;
+	     byte_index < (size_t) ( ( number_of_rounds + 1 ) * 16 );
+	     byte_index += 4 )
+	{
+		word[ 0 ] = context->encryption_round_keys[ byte_index - 4 ];
+		word[ 1 ] = context->encryption_round_keys[ byte_index - 3 ];
+		word[ 2 ] = context->encryption_round_keys[ byte_index - 2 ];
+		word[ 3 ] = context->encryption_round_keys[ byte_index - 1 ];
+
+		if( ( byte_index % key_size ) == 0 )
+		{
+			/* Rotate the word, substitute its bytes and apply the round constant
+			 */
+			value0 = word[ 0 ];
+
+			word[ 0 ] = libqcow_hardware_aes_substitution_box[ word[ 1 ] ]
+			          ^ libqcow_hardware_aes_round_constants[ ( byte_index / key_size ) - 1 ];
+			word[ 1 ] = libqcow_hardware_aes_substitution_box[ word[ 2 ] ];
+			word[ 2 ] = libqcow_hardware_aes_substitution_box[ word[ 3 ] ];
+			word[ 3 ] = libqcow_hardware_aes_substitution_box[ value0 ];
+		}
+		else if( ( key_size == 32 )
+		      && ( ( byte_index % key_size ) == 16 ) )
+		{
+			/* 256-bit keys substitute the bytes of the word halfway the key
+			 */
+			word[ 0 ] = libqcow_hardware_aes_substitution_box[ word[ 0 ] ];
+			word[ 1 ] = libqcow_hardware_aes_substitution_box[ word[ 1 ] ];
+			word[ 2 ] = libqcow_hardware_aes_substitution_box[ word[ 2 ] ];
+			word[ 3 ] = libqcow_hardware_aes_substitution_box[ word[ 3 ] ];
+		}
+		context->encryption_round_keys[ byte_index ]     = context->encryption_round_keys[ byte_index - key_size ] ^ word[ 0 ];
+		context->encryption_round_keys[ byte_index + 1 ] = context->encryption_round_keys[ byte_index - key_size + 1 ] ^ word[ 1 ];
+		context->encryption_round_keys[ byte_index + 2 ] = context->encryption_round_keys[ byte_index - key_size + 2 ] ^ word[ 2 ];
+		context->encryption_round_keys[ byte_index + 3 ] = context->encryption_round_keys[ byte_index - key_size + 3 ] ^ word[ 3 ];
+	}
+	/* The decryption round keys are the encryption round keys in reverse order
+	 * with the inverse mix columns transformation applied to the inner round keys
+	 * as required by the equivalent inverse cipher
+	 */
+	for( round_index = 0;
+	     round_index <= number_of_rounds;
+	     round_index++ )
+	{
+		if( memory_copy(
+		     &( context->decryption_round_keys[ round_index * 16 ] ),
+		     &( context->encryption_round_keys[ ( number_of_rounds - round_index ) * 16 ] ),
+		     16 ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy round key: %d.",
+			 function,
+			 round_index );
+
+			return( -1 );
+		}
+		if( ( round_index == 0 )
+		 || ( round_index == number_of_rounds ) )
+		{
+			continue;
+		}
+		round_key = &( context->decryption_round_keys[ round_index * 16 ] );
+
+		for( byte_index = 0;
+		     byte_index < 16;
+		     byte_index += 4 )
+		{
+			value0 = round_key[ byte_index ];
+			value1 = round_key[ byte_index + 1 ];
+			value2 = round_key[ byte_index + 2 ];
+			value3 = round_key[ byte_index + 3 ];
+
+			/* Multiply the column by { 0e, 0b, 0d, 09 } in GF(2^8)
+			 */
+			word[ 0 ] = libqcow_hardware_aes_multiply_by_2( value0 );
+			word[ 1 ] = libqcow_hardware_aes_multiply_by_2( word[ 0 ] );
+			word[ 2 ] = libqcow_hardware_aes_multiply_by_2( word[ 1 ] );
+
+			round_key[ byte_index ]     = word[ 2 ] ^ word[ 1 ] ^ word[ 0 ];
+			round_key[ byte_index + 1 ] = word[ 2 ] ^ value0;
+			round_key[ byte_index + 2 ] = word[ 2 ] ^ word[ 1 ] ^ value0;
+			round_key[ byte_index + 3 ] = word[ 2 ] ^ word[ 0 ] ^ value0;
+
+			word[ 0 ] = libqcow_hardware_aes_multiply_by_2( value1 );
+			word[ 1 ] = libqcow_hardware_aes_multiply_by_2( word[ 0 ] );
+			word[ 2 ] = libqcow_hardware_aes_multiply_by_2( word[ 1 ] );
+
+			round_key[ byte_index ]     ^= word[ 2 ] ^ word[ 0 ] ^ value1;
+			round_key[ byte_index + 1 ] ^= word[ 2 ] ^ word[ 1 ] ^ word[ 0 ];
+			round_key[ byte_index + 2 ] ^= word[ 2 ] ^ value1;
+			round_key[ byte_index + 3 ] ^= word[ 2 ] ^ word[ 1 ] ^ value1;
+
+			word[ 0 ] = libqcow_hardware_aes_multiply_by_2( value2 );
+			word[ 1 ] = libqcow_hardware_aes_multiply_by_2( word[ 0 ] );
+			word[ 2 ] = libqcow_hardware_aes_multiply_by_2( word[ 1 ] );
+
+			round_key[ byte_index ]     ^= word[ 2 ] ^ word[ 1 ] ^ value2;
+			round_key[ byte_index + 1 ] ^= word[ 2 ] ^ word[ 0 ] ^ value2;
+			round_key[ byte_index + 2 ] ^= word[ 2 ] ^ word[ 1 ] ^ word[ 0 ];
+			round_key[ byte_index + 3 ] ^= word[ 2 ] ^ value2;
+
+			word[ 0 ] = libqcow_hardware_aes_multiply_by_2( value3 );
+			word[ 1 ] = libqcow_hardware_aes_multiply_by_2( word[ 0 ] );
+			word[ 2 ] = libqcow_hardware_aes_multiply_by_2( word[ 1 ] );
+
+			round_key[ byte_index ]     ^= word[ 2 ] ^ value3;
+			round_key[ byte_index + 1 ] ^= word[ 2 ] ^ word[ 1 ] ^ value3;
+			round_key[ byte_index + 2 ] ^= word[ 2 ] ^ word[ 0 ] ^ value3;
+			round_key[ byte_index + 3 ] ^= word[ 2 ] ^ word[ 1 ] ^ word[ 0 ];
+		}
+	}
+	context->number_of_rounds = number_of_rounds;
+
+	return( 1 );
+}
+
+/* De- or encrypts a block of data using AES-CBC
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hardware_aes_crypt_cbc(
+     libqcow_hardware_aes_context_t *context,
+     int mode,
+     const uint8_t *initialization_vector,
+     size_t initialization_vector_size,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hardware_aes_crypt_cbc";
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( mode != LIBCAES_CRYPT_MODE_DECRYPT )
+	 && ( mode != LIBCAES_CRYPT_MODE_ENCRYPT ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported mode.",
+		 function );
+
+		return( -1 );
+	}
+	if( initialization_vector == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid initialization vector.",
+		 function );
+
+		return( -1 );
+	}
+	if( initialization_vector_size != 16 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid initialization vector size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( input_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid input data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_data_size > (size_t) SSIZE_MAX )
+	 || ( ( input_data_size % 16 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid output data.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data_size < input_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid output data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	switch( context->backend )
+	{
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI )
+		case LIBQCOW_HARDWARE_AES_BACKEND_AES_NI:
+			if( mode == LIBCAES_CRYPT_MODE_DECRYPT )
+			{
+				libqcow_hardware_aes_ni_decrypt_cbc(
+				 context->decryption_round_keys,
+				 context->number_of_rounds,
+				 initialization_vector,
+				 input_data,
+				 output_data,
+				 input_data_size );
+			}
+			else
+			{
+				libqcow_hardware_aes_ni_encrypt_cbc(
+				 context->encryption_round_keys,
+				 context->number_of_rounds,
+				 initialization_vector,
+				 input_data,
+				 output_data,
+				 input_data_size );
+			}
+			break;
+#endif
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+		case LIBQCOW_HARDWARE_AES_BACKEND_ARMV8:
+			if( mode == LIBCAES_CRYPT_MODE_DECRYPT )
+			{
+				libqcow_hardware_aes_armv8_decrypt_cbc(
+				 context->decryption_round_keys,
+				 context->number_of_rounds,
+				 initialization_vector,
+				 input_data,
+				 output_data,
+				 input_data_size );
+			}
+			else
+			{
+				libqcow_hardware_aes_armv8_encrypt_cbc(
+				 context->encryption_round_keys,
+				 context->number_of_rounds,
+				 initialization_vector,
+				 input_data,
+				 output_data,
+				 input_data_size );
+			}
+			break;
+#endif
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported backend.",
+			 function );
+
+			return( -1 );
+	}
+	return( 1 );
+}
+
+/* De- or encrypts consecutive sectors of data using AES-XTS
+ * The tweak of a sector is its sector number encrypted with the tweak context
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hardware_aes_crypt_xts(
+     libqcow_hardware_aes_context_t *context,
+     libqcow_hardware_aes_context_t *tweak_context,
+     int mode,
+     uint64_t sector_number,
+     size_t sector_size,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hardware_aes_crypt_xts";
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( tweak_context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid tweak context.",
+		 function );
+
+		return( -1 );
+	}
+	if( tweak_context->backend != context->backend )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid tweak context - backend mismatch.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( mode != LIBCAES_CRYPT_MODE_DECRYPT )
+	 && ( mode != LIBCAES_CRYPT_MODE_ENCRYPT ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported mode.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( sector_size == 0 )
+	 || ( sector_size > (size_t) SSIZE_MAX )
+	 || ( ( sector_size % 16 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid sector size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( input_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid input data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_data_size > (size_t) SSIZE_MAX )
+	 || ( ( input_data_size % sector_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid output data.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data_size < input_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid output data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	switch( context->backend )
+	{
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_NI )
+		case LIBQCOW_HARDWARE_AES_BACKEND_AES_NI:
+			libqcow_hardware_aes_ni_crypt_xts(
+			 ( mode == LIBCAES_CRYPT_MODE_DECRYPT ) ? context->decryption_round_keys : context->encryption_round_keys,
+			 context->number_of_rounds,
+			 tweak_context->encryption_round_keys,
+			 tweak_context->number_of_rounds,
+			 mode,
+			 sector_number,
+			 sector_size,
+			 input_data,
+			 output_data,
+			 input_data_size );
+			break;
+#endif
+
+#if defined( HAVE_LIBQCOW_HARDWARE_AES_ARMV8 )
+		case LIBQCOW_HARDWARE_AES_BACKEND_ARMV8:
+			libqcow_hardware_aes_armv8_crypt_xts(
+			 ( mode == LIBCAES_CRYPT_MODE_DECRYPT ) ? context->decryption_round_keys : context->encryption_round_keys,
+			 context->number_of_rounds,
+			 tweak_context->encryption_round_keys,
+			 tweak_context->number_of_rounds,
+			 mode,
+			 sector_number,
+			 sector_size,
+			 input_data,
+			 output_data,
+			 input_data_size );
+			break;
+#endif
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported backend.",
+			 function );
+
+			return( -1 );
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,128 @@
+/*
+ * Hardware accelerated AES functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#if !defined( _LIBQCOW_HARDWARE_AES_H )
+#define _LIBQCOW_HARDWARE_AES_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcaes.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_CPUID_H ) && defined( HAVE_WMMINTRIN_H ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_LIBQCOW_HARDWARE_AES_NI		1
+
+#elif defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#define HAVE_LIBQCOW_HARDWARE_AES_NI		1
+
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_ARM_NEON_H ) && defined( __aarch64__ )
+#define HAVE_LIBQCOW_HARDWARE_AES_ARMV8		1
+#endif
+
+/* The maximum number of rounds, which is used with 256-bit keys
+ */
+#define LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS	14
+
+enum LIBQCOW_HARDWARE_AES_BACKENDS
+{
+	LIBQCOW_HARDWARE_AES_BACKEND_NONE     = 0,
+	LIBQCOW_HARDWARE_AES_BACKEND_AES_NI   = 1,
+	LIBQCOW_HARDWARE_AES_BACKEND_ARMV8    = 2
+};
+
+typedef struct libqcow_hardware_aes_context libqcow_hardware_aes_context_t;
+
+struct libqcow_hardware_aes_context
+{
+	/* The backend
+	 */
+	int backend;
+
+	/* The number of rounds, which depends on the key size
+	 */
+	int number_of_rounds;
+
+	/* The encryption round keys
+	 */
+	uint8_t encryption_round_keys[ ( LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ) * 16 ];
+
+	/* The decryption round keys
+	 */
+	uint8_t decryption_round_keys[ ( LIBQCOW_HARDWARE_AES_MAXIMUM_NUMBER_OF_ROUNDS + 1 ) * 16 ];
+};
+
+int libqcow_hardware_aes_get_backend(
+     void );
+
+const char *libqcow_hardware_aes_get_backend_name(
+             int backend );
+
+int libqcow_hardware_aes_context_initialize(
+     libqcow_hardware_aes_context_t **context,
+     libcerror_error_t **error );
+
+int libqcow_hardware_aes_context_free(
+     libqcow_hardware_aes_context_t **context,
+     libcerror_error_t **error );
+
+int libqcow_hardware_aes_context_set_key(
+     libqcow_hardware_aes_context_t *context,
+     const uint8_t *key,
+     size_t key_bit_size,
+     libcerror_error_t **error );
+
+int libqcow_hardware_aes_crypt_cbc(
+     libqcow_hardware_aes_context_t *context,
+     int mode,
+     const uint8_t *initialization_vector,
+     size_t initialization_vector_size,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error );
+
+int libqcow_hardware_aes_crypt_xts(
+     libqcow_hardware_aes_context_t *context,
+     libqcow_hardware_aes_context_t *tweak_context,
+     int mode,
+     uint64_t sector_number,
+     size_t sector_size,
+     const uint8_t *input_data,
+     size_t input_data_size,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_HARDWARE_AES_H ) */
+
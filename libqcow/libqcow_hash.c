@@ -0,0 +1,1373 @@
+/*
+ * Hash functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_hash.h"
+#include "libqcow_libcerror.h"
+
+/* The SHA-256 round constants
+ */
+static const uint32_t libqcow_hash_sha256_round_constants[ 64 ] = {
+	0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+	0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+	0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+	0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+	0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+	0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+	0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+	0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL };
+
+/* Rotates a 32-bit value to the left
+ */
+#define libqcow_hash_rotate_left( value, number_of_bits ) \
+	( ( ( value ) << ( number_of_bits ) ) | ( ( value ) >> ( 32 - ( number_of_bits ) ) ) )
+
+/* Rotates a 32-bit value to the right
+ */
+#define libqcow_hash_rotate_right( value, number_of_bits ) \
+	( ( ( value ) >> ( number_of_bits ) ) | ( ( value ) << ( 32 - ( number_of_bits ) ) ) )
+
+/* Hashes a block of data using SHA-1 as defined in FIPS 180-4
+ */
+static void libqcow_hash_sha1_transform(
+             uint32_t *hash_values,
+             const uint8_t *block_data )
+{
+	uint32_t values[ 80 ];
+
+	uint32_t value_a = 0;
+	uint32_t value_b = 0;
+	uint32_t value_c = 0;
+	uint32_t value_d = 0;
+	uint32_t value_e = 0;
+	uint32_t value_f = 0;
+	uint32_t value_k = 0;
+	uint32_t value_t = 0;
+	int value_index  = 0;
+
+	for( value_index = 0;
+	     value_index < 16;
+	     value_index++ )
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 &( block_data[ value_index * 4 ] ),
+		 values[ value_index ] );
+	}
+	for( value_index = 16;
+	     value_index < 80;
+	     value_index++ )
+	{
+		value_t = values[ value_index - 3 ]
+		        ^ values[ value_index - 8 ]
+		        ^ values[ value_index - 14 ]
+		        ^ values[ value_index - 16 ];
+
+		values[ value_index ] = libqcow_hash_rotate_left( value_t, 1 );
+	}
+	value_a = hash_values[ 0 ];
+	value_b = hash_values[ 1 ];
+	value_c = hash_values[ 2 ];
+	value_d = hash_values[ 3 ];
+	value_e = hash_values[ 4 ];
+
+	for( value_index = 0;
+	     value_index < 80;
+	     value_index++ )
+	{
+		if( value_index < 20 )
+		{
+			value_f = ( value_b & value_c ) | ( ~value_b & value_d );
+			value_k = 0x5a827999UL;
+		}
+		else if( value_index < 40 )
+		{
+			value_f = value_b ^ value_c ^ value_d;
+			value_k = 0x6ed9eba1UL;
+		}
+		else if( value_index < 60 )
+		{
+			value_f = ( value_b & value_c ) | ( value_b & value_d ) | ( value_c & value_d );
+			value_k = 0x8f1bbcdcUL;
+		}
+		else
+		{
+			value_f = value_b ^ value_c ^ value_d;
+			value_k = 0xca62c1d6UL;
+		}
+		value_t = libqcow_hash_rotate_left( value_a, 5 ) + value_f + value_e + value_k + values[ value_index ];
+		value_e = value_d;
+		value_d = value_c;
+		value_c = libqcow_hash_rotate_left( value_b, 30 );
+		value_b = value_a;
+		value_a = value_t;
+	}
+	hash_values[ 0 ] += value_a;
+	hash_values[ 1 ] += value_b;
+	hash_values[ 2 ] += value_c;
+	hash_values[ 3 ] += value_d;
+	hash_values[ 4 ] += value_e;
+}
+
+/* Hashes a block of data using SHA-256 as defined in FIPS 180-4
+ */
+static void libqcow_hash_sha256_transform(
+             uint32_t *hash_values,
+             const uint8_t *block_data )
+{
+	uint32_t values[ 64 ];
+	uint32_t state_values[ 8 ];
+
+	uint32_t sigma0   = 0;
+	uint32_t sigma1   = 0;
+	uint32_t value_t1 = 0;
+	uint32_t value_t2 = 0;
+	int value_index   = 0;
+
+	for( value_index = 0;
+	     value_index < 16;
+	     value_index++ )
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 &( block_data[ value_index * 4 ] ),
+		 values[ value_index ] );
+	}
+	for( value_index = 16;
+	     value_index < 64;
+	     value_index++ )
+	{
+		sigma0 = libqcow_hash_rotate_right( values[ value_index - 15 ], 7 )
+		       ^ libqcow_hash_rotate_right( values[ value_index - 15 ], 18 )
+		       ^ ( values[ value_index - 15 ] >> 3 );
+		sigma1 = libqcow_hash_rotate_right( values[ value_index - 2 ], 17 )
+		       ^ libqcow_hash_rotate_right( values[ value_index - 2 ], 19 )
+		       ^ ( values[ value_index - 2 ] >> 10 );
+
+		values[ value_index ] = values[ value_index - 16 ] + sigma0 + values[ value_index - 7 ] + sigma1;
+	}
+	for( value_index = 0;
+	     value_index < 8;
+	     value_index++ )
+	{
+		state_values[ value_index ] = hash_values[ value_index ];
+	}
+	for( value_index = 0;
+	     value_index < 64;
+	     value_index++ )
+	{
+		sigma1 = libqcow_hash_rotate_right( state_values[ 4 ], 6 )
+		       ^ libqcow_hash_rotate_right( state_values[ 4 ], 11 )
+		       ^ libqcow_hash_rotate_right( state_values[ 4 ], 25 );
+
+		value_t1 = state_values[ 7 ]
+		         + sigma1
+		         + ( ( state_values[ 4 ] & state_values[ 5 ] ) ^ ( ~state_values[ 4 ] & state_values[ 6 ] ) )
+		         + libqcow_hash_sha256_round_constants[ value_index ]
+		         + values[ value_index ];
+
+		sigma0 = libqcow_hash_rotate_right( state_values[ 0 ], 2 )
+		       ^ libqcow_hash_rotate_right( state_values[ 0 ], 13 )
+		       ^ libqcow_hash_rotate_right( state_values[ 0 ], 22 );
+
+		value_t2 = sigma0
+		         + ( ( state_values[ 0 ] & state_values[ 1 ] ) ^ ( state_values[ 0 ] & state_values[ 2 ] ) ^ ( state_values[ 1 ] & state_values[ 2 ] ) );
+
+		state_values[ 7 ] = state_values[ 6 ];
+		state_values[ 6 ] = state_values[ 5 ];
+		state_values[ 5 ] = state_values[ 4 ];
+		state_values[ 4 ] = state_values[ 3 ] + value_t1;
+		state_values[ 3 ] = state_values[ 2 ];
+		state_values[ 2 ] = state_values[ 1 ];
+		state_values[ 1 ] = state_values[ 0 ];
+		state_values[ 0 ] = value_t1 + value_t2;
+	}
+	for( value_index = 0;
+	     value_index < 8;
+	     value_index++ )
+	{
+		hash_values[ value_index ] += state_values[ value_index ];
+	}
+}
+
+/* Retrieves the hash type from a name, such as the LUKS hash specification
+ * Returns 1 if successful, 0 if the hash type is not supported or -1 on error
+ */
+int libqcow_hash_get_type_from_name(
+     const char *name,
+     size_t name_length,
+     int *hash_type,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hash_get_type_from_name";
+
+	if( name == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid name.",
+		 function );
+
+		return( -1 );
+	}
+	if( name_length > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid name length value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_type == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash type.",
+		 function );
+
+		return( -1 );
+	}
+	if( name_length == 4 )
+	{
+		if( narrow_string_compare_no_case(
+		     name,
+		     "sha1",
+		     4 ) == 0 )
+		{
+			*hash_type = LIBQCOW_HASH_TYPE_SHA1;
+
+			return( 1 );
+		}
+	}
+	else if( name_length == 6 )
+	{
+		if( narrow_string_compare_no_case(
+		     name,
+		     "sha256",
+		     6 ) == 0 )
+		{
+			*hash_type = LIBQCOW_HASH_TYPE_SHA256;
+
+			return( 1 );
+		}
+	}
+	return( 0 );
+}
+
+/* Retrieves the digest size of a hash type
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_get_digest_size(
+     int hash_type,
+     size_t *digest_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hash_get_digest_size";
+
+	if( digest_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest size.",
+		 function );
+
+		return( -1 );
+	}
+	switch( hash_type )
+	{
+		case LIBQCOW_HASH_TYPE_SHA1:
+			*digest_size = 20;
+			break;
+
+		case LIBQCOW_HASH_TYPE_SHA256:
+			*digest_size = 32;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported hash type.",
+			 function );
+
+			return( -1 );
+	}
+	return( 1 );
+}
+
+/* Resets a hash context to start a new hash
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_context_reset(
+     libqcow_hash_context_t *context,
+     int hash_type,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hash_context_reset";
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     context,
+	     0,
+	     sizeof( libqcow_hash_context_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear context.",
+		 function );
+
+		return( -1 );
+	}
+	switch( hash_type )
+	{
+		case LIBQCOW_HASH_TYPE_SHA1:
+			context->hash_values[ 0 ] = 0x67452301UL;
+			context->hash_values[ 1 ] = 0xefcdab89UL;
+			context->hash_values[ 2 ] = 0x98badcfeUL;
+			context->hash_values[ 3 ] = 0x10325476UL;
+			context->hash_values[ 4 ] = 0xc3d2e1f0UL;
+			break;
+
+		case LIBQCOW_HASH_TYPE_SHA256:
+			context->hash_values[ 0 ] = 0x6a09e667UL;
+			context->hash_values[ 1 ] = 0xbb67ae85UL;
+			context->hash_values[ 2 ] = 0x3c6ef372UL;
+			context->hash_values[ 3 ] = 0xa54ff53aUL;
+			context->hash_values[ 4 ] = 0x510e527fUL;
+			context->hash_values[ 5 ] = 0x9b05688cUL;
+			context->hash_values[ 6 ] = 0x1f83d9abUL;
+			context->hash_values[ 7 ] = 0x5be0cd19UL;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported hash type.",
+			 function );
+
+			return( -1 );
+	}
+	context->hash_type = hash_type;
+
+	return( 1 );
+}
+
+/* Updates a hash context with data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_context_update(
+     libqcow_hash_context_t *context,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_hash_context_update";
+	size_t data_offset    = 0;
+	size_t copy_size      = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( context->hash_type != LIBQCOW_HASH_TYPE_SHA1 )
+	 && ( context->hash_type != LIBQCOW_HASH_TYPE_SHA256 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid context - unsupported hash type.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	context->number_of_bytes_hashed += data_size;
+
+	while( data_offset < data_size )
+	{
+		copy_size = LIBQCOW_HASH_BLOCK_SIZE - context->block_data_size;
+
+		if( copy_size > ( data_size - data_offset ) )
+		{
+			copy_size = data_size - data_offset;
+		}
+		if( ( context->block_data_size == 0 )
+		 && ( copy_size == LIBQCOW_HASH_BLOCK_SIZE ) )
+		{
+			/* Hash full blocks directly from the data
+			 */
+			if( context->hash_type == LIBQCOW_HASH_TYPE_SHA1 )
+			{
+				libqcow_hash_sha1_transform(
+				 context->hash_values,
+				 &( data[ data_offset ] ) );
+			}
+			else
+			{
+				libqcow_hash_sha256_transform(
+				 context->hash_values,
+				 &( data[ data_offset ] ) );
+			}
+			data_offset += LIBQCOW_HASH_BLOCK_SIZE;
+
+			continue;
+		}
+		if( memory_copy(
+		     &( context->block_data[ context->block_data_size ] ),
+		     &( data[ data_offset ] ),
+		     copy_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy data to block data.",
+			 function );
+
+			return( -1 );
+		}
+		context->block_data_size += copy_size;
+		data_offset              += copy_size;
+
+		if( context->block_data_size == LIBQCOW_HASH_BLOCK_SIZE )
+		{
+			if( context->hash_type == LIBQCOW_HASH_TYPE_SHA1 )
+			{
+				libqcow_hash_sha1_transform(
+				 context->hash_values,
+				 context->block_data );
+			}
+			else
+			{
+				libqcow_hash_sha256_transform(
+				 context->hash_values,
+				 context->block_data );
+			}
+			context->block_data_size = 0;
+		}
+	}
+	return( 1 );
+}
+
+/* Finalizes a hash context and retrieves the digest
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_context_finalize(
+     libqcow_hash_context_t *context,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error )
+{
+	static char *function     = "libqcow_hash_context_finalize";
+	size_t hash_digest_size   = 0;
+	uint64_t number_of_bits   = 0;
+	int number_of_hash_values = 0;
+	int value_index           = 0;
+
+	if( context == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid context.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_get_digest_size(
+	     context->hash_type,
+	     &hash_digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve digest size.",
+		 function );
+
+		return( -1 );
+	}
+	if( digest == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid digest.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( digest_size < hash_digest_size )
+	 || ( digest_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid digest size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_bits = context->number_of_bytes_hashed * 8;
+
+	/* Pad the data with a 1-bit followed by 0-bits and the 64-bit number of bits
+	 */
+	context->block_data[ context->block_data_size++ ] = 0x80;
+
+	if( context->block_data_size > ( LIBQCOW_HASH_BLOCK_SIZE - 8 ) )
+	{
+		while( context->block_data_size < LIBQCOW_HASH_BLOCK_SIZE )
+		{
+			context->block_data[ context->block_data_size++ ] = 0;
+		}
+		if( context->hash_type == LIBQCOW_HASH_TYPE_SHA1 )
+		{
+			libqcow_hash_sha1_transform(
+			 context->hash_values,
+			 context->block_data );
+		}
+		else
+		{
+			libqcow_hash_sha256_transform(
+			 context->hash_values,
+			 context->block_data );
+		}
+		context->block_data_size = 0;
+	}
+	while( context->block_data_size < ( LIBQCOW_HASH_BLOCK_SIZE - 8 ) )
+	{
+		context->block_data[ context->block_data_size++ ] = 0;
+	}
+	byte_stream_copy_from_uint64_big_endian(
+	 &( context->block_data[ LIBQCOW_HASH_BLOCK_SIZE - 8 ] ),
+	 number_of_bits );
+
+	if( context->hash_type == LIBQCOW_HASH_TYPE_SHA1 )
+	{
+		libqcow_hash_sha1_transform(
+		 context->hash_values,
+		 context->block_data );
+	}
+	else
+	{
+		libqcow_hash_sha256_transform(
+		 context->hash_values,
+		 context->block_data );
+	}
+	number_of_hash_values = (int) ( hash_digest_size / 4 );
+
+	for( value_index = 0;
+	     value_index < number_of_hash_values;
+	     value_index++ )
+	{
+		byte_stream_copy_from_uint32_big_endian(
+		 &( digest[ value_index * 4 ] ),
+		 context->hash_values[ value_index ] );
+	}
+	/* Clear the context since the block data can contain key material
+	 */
+	if( memory_set(
+	     context,
+	     0,
+	     sizeof( libqcow_hash_context_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear context.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Calculates the hash of data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_calculate(
+     int hash_type,
+     const uint8_t *data,
+     size_t data_size,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error )
+{
+	libqcow_hash_context_t context;
+
+	static char *function = "libqcow_hash_calculate";
+
+	if( libqcow_hash_context_reset(
+	     &context,
+	     hash_type,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to reset context.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_context_update(
+	     &context,
+	     data,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update context.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_context_finalize(
+	     &context,
+	     digest,
+	     digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to finalize context.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Initializes the inner and outer HMAC contexts of a key as defined in RFC 2104
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_hash_initialize_hmac_contexts(
+            int hash_type,
+            const uint8_t *key,
+            size_t key_size,
+            libqcow_hash_context_t *inner_context,
+            libqcow_hash_context_t *outer_context,
+            libcerror_error_t **error )
+{
+	uint8_t key_block[ LIBQCOW_HASH_BLOCK_SIZE ];
+
+	static char *function = "libqcow_hash_initialize_hmac_contexts";
+	size_t byte_index     = 0;
+	int result            = -1;
+
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( key_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid key size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     key_block,
+	     0,
+	     LIBQCOW_HASH_BLOCK_SIZE ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear key block.",
+		 function );
+
+		return( -1 );
+	}
+	/* Keys larger than the block size are replaced by their hash
+	 */
+	if( key_size > LIBQCOW_HASH_BLOCK_SIZE )
+	{
+		if( libqcow_hash_calculate(
+		     hash_type,
+		     key,
+		     key_size,
+		     key_block,
+		     LIBQCOW_HASH_BLOCK_SIZE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate hash of key.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else if( key_size > 0 )
+	{
+		if( memory_copy(
+		     key_block,
+		     key,
+		     key_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy key.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	for( byte_index = 0;
+	     byte_index < LIBQCOW_HASH_BLOCK_SIZE;
+	     byte_index++ )
+	{
+		key_block[ byte_index ] ^= 0x36;
+	}
+	if( libqcow_hash_context_reset(
+	     inner_context,
+	     hash_type,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to reset inner context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_context_update(
+	     inner_context,
+	     key_block,
+	     LIBQCOW_HASH_BLOCK_SIZE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update inner context.",
+		 function );
+
+		goto on_error;
+	}
+	/* Changes the inner padding ( 0x36 ) into the outer padding ( 0x5c )
+	 */
+	for( byte_index = 0;
+	     byte_index < LIBQCOW_HASH_BLOCK_SIZE;
+	     byte_index++ )
+	{
+		key_block[ byte_index ] ^= 0x36 ^ 0x5c;
+	}
+	if( libqcow_hash_context_reset(
+	     outer_context,
+	     hash_type,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to reset outer context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_context_update(
+	     outer_context,
+	     key_block,
+	     LIBQCOW_HASH_BLOCK_SIZE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update outer context.",
+		 function );
+
+		goto on_error;
+	}
+	result = 1;
+
+on_error:
+	memory_set(
+	 key_block,
+	 0,
+	 LIBQCOW_HASH_BLOCK_SIZE );
+
+	return( result );
+}
+
+/* Calculates a HMAC of data using the inner and outer HMAC contexts of a key
+ * The contexts are copied so they can be reused
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_hash_calculate_hmac_with_contexts(
+            const libqcow_hash_context_t *inner_context,
+            const libqcow_hash_context_t *outer_context,
+            const uint8_t *data,
+            size_t data_size,
+            uint8_t *digest,
+            size_t digest_size,
+            libcerror_error_t **error )
+{
+	uint8_t inner_digest[ LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ];
+
+	libqcow_hash_context_t context;
+
+	static char *function    = "libqcow_hash_calculate_hmac_with_contexts";
+	size_t inner_digest_size = 0;
+
+	if( libqcow_hash_get_digest_size(
+	     inner_context->hash_type,
+	     &inner_digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve digest size.",
+		 function );
+
+		return( -1 );
+	}
+	context = *inner_context;
+
+	if( libqcow_hash_context_update(
+	     &context,
+	     data,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update inner context.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_context_finalize(
+	     &context,
+	     inner_digest,
+	     LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to finalize inner context.",
+		 function );
+
+		return( -1 );
+	}
+	context = *outer_context;
+
+	if( libqcow_hash_context_update(
+	     &context,
+	     inner_digest,
+	     inner_digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update outer context.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_context_finalize(
+	     &context,
+	     digest,
+	     digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to finalize outer context.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Calculates the HMAC of data as defined in RFC 2104
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_calculate_hmac(
+     int hash_type,
+     const uint8_t *key,
+     size_t key_size,
+     const uint8_t *data,
+     size_t data_size,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error )
+{
+	libqcow_hash_context_t inner_context;
+	libqcow_hash_context_t outer_context;
+
+	static char *function = "libqcow_hash_calculate_hmac";
+	int result            = -1;
+
+	if( libqcow_hash_initialize_hmac_contexts(
+	     hash_type,
+	     key,
+	     key_size,
+	     &inner_context,
+	     &outer_context,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize HMAC contexts.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_calculate_hmac_with_contexts(
+	     &inner_context,
+	     &outer_context,
+	     data,
+	     data_size,
+	     digest,
+	     digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate HMAC.",
+		 function );
+
+		goto on_error;
+	}
+	result = 1;
+
+on_error:
+	memory_set(
+	 &inner_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	memory_set(
+	 &outer_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	return( result );
+}
+
+/* Derives a key from a password using PBKDF2 with HMAC as defined in RFC 2898
+ * The HMAC key state of the password is determined once and reused
+ * for every iteration
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_hash_pbkdf2(
+     int hash_type,
+     const uint8_t *password,
+     size_t password_size,
+     const uint8_t *salt,
+     size_t salt_size,
+     uint32_t number_of_iterations,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error )
+{
+	uint8_t block_data[ LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ];
+	uint8_t block_index_data[ 4 ];
+	uint8_t digest[ LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ];
+
+	libqcow_hash_context_t context;
+	libqcow_hash_context_t inner_context;
+	libqcow_hash_context_t outer_context;
+
+	static char *function     = "libqcow_hash_pbkdf2";
+	size_t byte_index         = 0;
+	size_t copy_size          = 0;
+	size_t digest_size        = 0;
+	size_t output_data_offset = 0;
+	uint32_t block_index      = 0;
+	uint32_t iteration        = 0;
+	int result                = -1;
+
+	if( libqcow_hash_get_digest_size(
+	     hash_type,
+	     &digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve digest size.",
+		 function );
+
+		return( -1 );
+	}
+	if( salt == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid salt.",
+		 function );
+
+		return( -1 );
+	}
+	if( salt_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid salt size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_iterations == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of iterations value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	if( output_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid output data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( output_data_size == 0 )
+	 || ( output_data_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid output data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_initialize_hmac_contexts(
+	     hash_type,
+	     password,
+	     password_size,
+	     &inner_context,
+	     &outer_context,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize HMAC contexts.",
+		 function );
+
+		goto on_error;
+	}
+	for( block_index = 1;
+	     output_data_offset < output_data_size;
+	     block_index++ )
+	{
+		/* The first iteration is the HMAC of the salt and the big-endian block index
+		 */
+		byte_stream_copy_from_uint32_big_endian(
+		 block_index_data,
+		 block_index );
+
+		context = inner_context;
+
+		if( libqcow_hash_context_update(
+		     &context,
+		     salt,
+		     salt_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update context with salt.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_hash_context_update(
+		     &context,
+		     block_index_data,
+		     4,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update context with block index.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_hash_context_finalize(
+		     &context,
+		     digest,
+		     LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to finalize context.",
+			 function );
+
+			goto on_error;
+		}
+		context = outer_context;
+
+		if( libqcow_hash_context_update(
+		     &context,
+		     digest,
+		     digest_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update outer context.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_hash_context_finalize(
+		     &context,
+		     digest,
+		     LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to finalize outer context.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_copy(
+		     block_data,
+		     digest,
+		     digest_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy digest to block data.",
+			 function );
+
+			goto on_error;
+		}
+		for( iteration = 1;
+		     iteration < number_of_iterations;
+		     iteration++ )
+		{
+			if( libqcow_hash_calculate_hmac_with_contexts(
+			     &inner_context,
+			     &outer_context,
+			     digest,
+			     digest_size,
+			     digest,
+			     LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to calculate HMAC of iteration: %" PRIu32 ".",
+				 function,
+				 iteration );
+
+				goto on_error;
+			}
+			for( byte_index = 0;
+			     byte_index < digest_size;
+			     byte_index++ )
+			{
+				block_data[ byte_index ] ^= digest[ byte_index ];
+			}
+		}
+		copy_size = output_data_size - output_data_offset;
+
+		if( copy_size > digest_size )
+		{
+			copy_size = digest_size;
+		}
+		if( memory_copy(
+		     &( output_data[ output_data_offset ] ),
+		     block_data,
+		     copy_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy block data to output data.",
+			 function );
+
+			goto on_error;
+		}
+		output_data_offset += copy_size;
+	}
+	result = 1;
+
+on_error:
+	memory_set(
+	 block_data,
+	 0,
+	 LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE );
+
+	memory_set(
+	 digest,
+	 0,
+	 LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE );
+
+	memory_set(
+	 &inner_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	memory_set(
+	 &outer_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	return( result );
+}
+
@@ -0,0 +1,132 @@
+/*
+ * Hash functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_HASH_H )
+#define _LIBQCOW_HASH_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The block size of the supported hash types
+ */
+#define LIBQCOW_HASH_BLOCK_SIZE			64
+
+/* The maximum digest size of the supported hash types
+ */
+#define LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE	32
+
+typedef struct libqcow_hash_context libqcow_hash_context_t;
+
+/* The hash context is a fixed size structure so it can be copied,
+ * which is used to reuse the HMAC key state in PBKDF2
+ */
+struct libqcow_hash_context
+{
+	/* The hash type
+	 */
+	int hash_type;
+
+	/* The hash values
+	 */
+	uint32_t hash_values[ 8 ];
+
+	/* The number of bytes hashed
+	 */
+	uint64_t number_of_bytes_hashed;
+
+	/* The block data that has not been hashed yet
+	 */
+	uint8_t block_data[ LIBQCOW_HASH_BLOCK_SIZE ];
+
+	/* The block data size
+	 */
+	size_t block_data_size;
+};
+
+int libqcow_hash_get_type_from_name(
+     const char *name,
+     size_t name_length,
+     int *hash_type,
+     libcerror_error_t **error );
+
+int libqcow_hash_get_digest_size(
+     int hash_type,
+     size_t *digest_size,
+     libcerror_error_t **error );
+
+int libqcow_hash_context_reset(
+     libqcow_hash_context_t *context,
+     int hash_type,
+     libcerror_error_t **error );
+
+int libqcow_hash_context_update(
+     libqcow_hash_context_t *context,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_hash_context_finalize(
+     libqcow_hash_context_t *context,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error );
+
+int libqcow_hash_calculate(
+     int hash_type,
+     const uint8_t *data,
+     size_t data_size,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error );
+
+int libqcow_hash_calculate_hmac(
+     int hash_type,
+     const uint8_t *key,
+     size_t key_size,
+     const uint8_t *data,
+     size_t data_size,
+     uint8_t *digest,
+     size_t digest_size,
+     libcerror_error_t **error );
+
+int libqcow_hash_pbkdf2(
+     int hash_type,
+     const uint8_t *password,
+     size_t password_size,
+     const uint8_t *salt,
+     size_t salt_size,
+     uint32_t number_of_iterations,
+     uint8_t *output_data,
+     size_t output_data_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_HASH_H ) */
+
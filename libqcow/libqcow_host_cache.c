@@ -0,0 +1,1110 @@
+/*
+ * Host cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_block_cache.h"
+#include "libqcow_definitions.h"
+#include "libqcow_host_cache.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_unused.h"
+
+/* Frees the data of a cached block
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_host_cache_free_block_data(
+            uint8_t **block_data,
+            libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_free_block_data";
+
+	if( block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block data.",
+		 function );
+
+		return( -1 );
+	}
+	if( *block_data != NULL )
+	{
+		memory_free(
+		 *block_data );
+
+		*block_data = NULL;
+	}
+	return( 1 );
+}
+
+/* Creates a host cache
+ * Make sure the value host_cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_initialize(
+     libqcow_host_cache_t **host_cache,
+     libbfio_handle_t *file_io_handle,
+     size_t block_size,
+     int maximum_number_of_blocks,
+     int maximum_number_of_read_ahead_blocks,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_initialize";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *host_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid host cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( block_size < LIBQCOW_MINIMUM_HOST_CACHE_BLOCK_SIZE )
+	 || ( block_size > LIBQCOW_MAXIMUM_HOST_CACHE_BLOCK_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_blocks <= 0 )
+	 || ( maximum_number_of_blocks > LIBQCOW_MAXIMUM_HOST_CACHE_NUMBER_OF_BLOCKS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of blocks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_read_ahead_blocks < 0 )
+	 || ( maximum_number_of_read_ahead_blocks >= LIBQCOW_MAXIMUM_HOST_CACHE_FETCH_BLOCKS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of read-ahead blocks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*host_cache = memory_allocate_structure(
+	               libqcow_host_cache_t );
+
+	if( *host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create host cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *host_cache,
+	     0,
+	     sizeof( libqcow_host_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear host cache.",
+		 function );
+
+		memory_free(
+		 *host_cache );
+
+		*host_cache = NULL;
+
+		return( -1 );
+	}
+	if( libqcow_block_cache_initialize(
+	     &( ( *host_cache )->block_cache ),
+	     maximum_number_of_blocks,
+	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_host_cache_free_block_data,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create block cache.",
+		 function );
+
+		goto on_error;
+	}
+	( *host_cache )->file_io_handle                      = file_io_handle;
+	( *host_cache )->block_size                          = block_size;
+	( *host_cache )->maximum_number_of_blocks            = maximum_number_of_blocks;
+	( *host_cache )->maximum_number_of_read_ahead_blocks = maximum_number_of_read_ahead_blocks;
+	( *host_cache )->next_fetch_offset                   = -1;
+
+	/* Read at most half of the cache at once so that a fetch does not
+	 * evict the blocks that are still being used
+	 */
+	( *host_cache )->maximum_number_of_fetch_blocks = maximum_number_of_blocks / 2;
+
+	if( ( *host_cache )->maximum_number_of_fetch_blocks > LIBQCOW_MAXIMUM_HOST_CACHE_FETCH_BLOCKS )
+	{
+		( *host_cache )->maximum_number_of_fetch_blocks = LIBQCOW_MAXIMUM_HOST_CACHE_FETCH_BLOCKS;
+	}
+	else if( ( *host_cache )->maximum_number_of_fetch_blocks == 0 )
+	{
+		( *host_cache )->maximum_number_of_fetch_blocks = 1;
+	}
+	return( 1 );
+
+on_error:
+	if( *host_cache != NULL )
+	{
+		memory_free(
+		 *host_cache );
+
+		*host_cache = NULL;
+	}
+	return( -1 );
+}
+
+/* Creates a file IO handle that reads another file IO handle through a host cache
+ * The other file IO handle is not managed by the file IO handle and must remain valid and open
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_handle_t *file_io_handle,
+     size_t block_size,
+     int maximum_number_of_blocks,
+     int maximum_number_of_read_ahead_blocks,
+     libcerror_error_t **error )
+{
+	libqcow_host_cache_t *host_cache = NULL;
+	static char *function            = "libqcow_host_cache_initialize_handle";
+
+	if( handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_host_cache_initialize(
+	     &host_cache,
+	     file_io_handle,
+	     block_size,
+	     maximum_number_of_blocks,
+	     maximum_number_of_read_ahead_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create host cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_initialize(
+	     handle,
+	     (intptr_t *) host_cache,
+	     (int (*)(intptr_t **, libcerror_error_t **)) libqcow_host_cache_free,
+	     (int (*)(intptr_t **, intptr_t *, libcerror_error_t **)) libqcow_host_cache_clone,
+	     (int (*)(intptr_t *, int, libcerror_error_t **)) libqcow_host_cache_open,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_host_cache_close,
+	     (ssize_t (*)(intptr_t *, uint8_t *, size_t, libcerror_error_t **)) libqcow_host_cache_read,
+	     (ssize_t (*)(intptr_t *, const uint8_t *, size_t, libcerror_error_t **)) libqcow_host_cache_write,
+	     (off64_t (*)(intptr_t *, off64_t, int, libcerror_error_t **)) libqcow_host_cache_seek_offset,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_host_cache_exists,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_host_cache_is_open,
+	     (int (*)(intptr_t *, size64_t *, libcerror_error_t **)) libqcow_host_cache_get_size,
+	     LIBBFIO_FLAG_IO_HANDLE_MANAGED | LIBBFIO_FLAG_IO_HANDLE_CLONE_BY_FUNCTION,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( host_cache != NULL )
+	{
+		libqcow_host_cache_free(
+		 &host_cache,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Frees a host cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_free(
+     libqcow_host_cache_t **host_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_free";
+	int result            = 1;
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *host_cache != NULL )
+	{
+		/* The file_io_handle reference is freed elsewhere
+		 */
+		if( libqcow_block_cache_free(
+		     &( ( *host_cache )->block_cache ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free block cache.",
+			 function );
+
+			result = -1;
+		}
+		if( ( *host_cache )->fetch_buffer != NULL )
+		{
+			memory_free(
+			 ( *host_cache )->fetch_buffer );
+		}
+		memory_free(
+		 *host_cache );
+
+		*host_cache = NULL;
+	}
+	return( result );
+}
+
+/* Clones (duplicates) the host cache
+ * The clone reads the same (host) file IO handle but does not share the cached blocks
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_clone(
+     libqcow_host_cache_t **destination_host_cache,
+     libqcow_host_cache_t *source_host_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_clone";
+
+	if( destination_host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid destination host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *destination_host_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: destination host cache already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( source_host_cache == NULL )
+	{
+		*destination_host_cache = NULL;
+
+		return( 1 );
+	}
+	if( libqcow_host_cache_initialize(
+	     destination_host_cache,
+	     source_host_cache->file_io_handle,
+	     source_host_cache->block_size,
+	     source_host_cache->maximum_number_of_blocks,
+	     source_host_cache->maximum_number_of_read_ahead_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create destination host cache.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Opens the host cache
+ * The (host) file IO handle is opened if needed, but left open on close
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_open(
+     libqcow_host_cache_t *host_cache,
+     int access_flags,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_open";
+	int result            = 0;
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( access_flags & LIBBFIO_ACCESS_FLAG_WRITE ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access currently not supported.",
+		 function );
+
+		return( -1 );
+	}
+	result = libbfio_handle_is_open(
+	          host_cache->file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine if file IO handle is open.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		if( libbfio_handle_open(
+		     host_cache->file_io_handle,
+		     access_flags,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open file IO handle.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( libbfio_handle_get_size(
+	     host_cache->file_io_handle,
+	     &( host_cache->size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve size of file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	host_cache->current_offset    = 0;
+	host_cache->next_fetch_offset = -1;
+	host_cache->access_flags      = access_flags;
+
+	return( 1 );
+}
+
+/* Closes the host cache
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_host_cache_close(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_close";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	/* The cached blocks are not valid for the host file when it is reopened
+	 */
+	if( libqcow_block_cache_clear(
+	     host_cache->block_cache,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to clear block cache.",
+		 function );
+
+		return( -1 );
+	}
+	host_cache->access_flags = 0;
+
+	return( 0 );
+}
+
+/* Reads a range of blocks from the (host) file IO handle and stores them in the block cache
+ * The range starts with the block at block offset and contains the blocks up to end offset,
+ * or the blocks that are read ahead if the range follows directly on the previous range,
+ * up to the first block that is already cached. The blocks are read with a single read
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_fetch_blocks(
+     libqcow_host_cache_t *host_cache,
+     off64_t block_offset,
+     off64_t end_offset,
+     uint8_t **block_data,
+     libcerror_error_t **error )
+{
+	uint8_t *cached_block_data = NULL;
+	uint8_t *fetch_block_data  = NULL;
+	static char *function      = "libqcow_host_cache_fetch_blocks";
+	size_t fetch_size          = 0;
+	size_t fetch_block_size    = 0;
+	ssize_t read_count         = 0;
+	off64_t fetch_end_offset   = 0;
+	int block_index            = 0;
+	int number_of_blocks       = 0;
+	int result                 = 0;
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( block_offset < 0 )
+	 || ( (size64_t) block_offset >= host_cache->size )
+	 || ( ( block_offset % host_cache->block_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid block offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block data.",
+		 function );
+
+		return( -1 );
+	}
+	if( end_offset <= block_offset )
+	{
+		end_offset = block_offset + 1;
+	}
+	number_of_blocks = (int) ( ( end_offset - block_offset + host_cache->block_size - 1 ) / host_cache->block_size );
+
+	if( number_of_blocks > host_cache->maximum_number_of_fetch_blocks )
+	{
+		number_of_blocks = host_cache->maximum_number_of_fetch_blocks;
+	}
+	if( block_offset == host_cache->next_fetch_offset )
+	{
+		number_of_blocks += host_cache->maximum_number_of_read_ahead_blocks;
+
+		if( number_of_blocks > host_cache->maximum_number_of_fetch_blocks )
+		{
+			number_of_blocks = host_cache->maximum_number_of_fetch_blocks;
+		}
+	}
+	/* Do not read blocks that are already cached or beyond the end of the host file
+	 */
+	fetch_end_offset = block_offset + (off64_t) host_cache->block_size;
+
+	for( block_index = 1;
+	     block_index < number_of_blocks;
+	     block_index++ )
+	{
+		if( (size64_t) fetch_end_offset >= host_cache->size )
+		{
+			break;
+		}
+		result = libqcow_block_cache_get_value_by_offset(
+		          host_cache->block_cache,
+		          fetch_end_offset,
+		          (intptr_t **) &cached_block_data,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve block: 0x%08" PRIx64 " from cache.",
+			 function,
+			 fetch_end_offset );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			break;
+		}
+		fetch_end_offset += (off64_t) host_cache->block_size;
+	}
+	number_of_blocks = block_index;
+
+	if( (size64_t) fetch_end_offset > host_cache->size )
+	{
+		fetch_end_offset = (off64_t) host_cache->size;
+	}
+	fetch_size = (size_t) ( fetch_end_offset - block_offset );
+
+	if( host_cache->fetch_buffer == NULL )
+	{
+		host_cache->fetch_buffer = (uint8_t *) memory_allocate(
+		                                        sizeof( uint8_t ) * host_cache->block_size * host_cache->maximum_number_of_fetch_blocks );
+
+		if( host_cache->fetch_buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create fetch buffer.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: reading %d blocks at offset: 0x%08" PRIx64 " (size: %" PRIzd ").\n",
+		 function,
+		 number_of_blocks,
+		 block_offset,
+		 fetch_size );
+	}
+#endif
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              host_cache->file_io_handle,
+	              host_cache->fetch_buffer,
+	              fetch_size,
+	              block_offset,
+	              error );
+
+	if( read_count != (ssize_t) fetch_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read blocks at offset: 0x%08" PRIx64 ".",
+		 function,
+		 block_offset );
+
+		goto on_error;
+	}
+	host_cache->next_fetch_offset = fetch_end_offset;
+
+	/* The first block is stored last so that it is not replaced by the blocks read ahead
+	 */
+	for( block_index = number_of_blocks - 1;
+	     block_index >= 0;
+	     block_index-- )
+	{
+		fetch_block_size = fetch_size - ( (size_t) block_index * host_cache->block_size );
+
+		if( fetch_block_size > host_cache->block_size )
+		{
+			fetch_block_size = host_cache->block_size;
+		}
+		fetch_block_data = (uint8_t *) memory_allocate(
+		                                sizeof( uint8_t ) * host_cache->block_size );
+
+		if( fetch_block_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create block data.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_copy(
+		     fetch_block_data,
+		     &( host_cache->fetch_buffer[ (size_t) block_index * host_cache->block_size ] ),
+		     fetch_block_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy block data.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_block_cache_set_value_by_offset(
+		     host_cache->block_cache,
+		     block_offset + ( (off64_t) block_index * host_cache->block_size ),
+		     (intptr_t *) fetch_block_data,
+		     LIBQCOW_CACHE_PRIORITY_NORMAL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set block: %d in cache.",
+			 function,
+			 block_index );
+
+			goto on_error;
+		}
+		*block_data = fetch_block_data;
+
+		fetch_block_data = NULL;
+	}
+	return( 1 );
+
+on_error:
+	if( fetch_block_data != NULL )
+	{
+		memory_free(
+		 fetch_block_data );
+	}
+	*block_data = NULL;
+
+	return( -1 );
+}
+
+/* Reads a buffer from the host cache
+ * Returns the number of bytes read if successful, or -1 on error
+ */
+ssize_t libqcow_host_cache_read(
+         libqcow_host_cache_t *host_cache,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error )
+{
+	uint8_t *block_data   = NULL;
+	static char *function = "libqcow_host_cache_read";
+	size_t block_offset   = 0;
+	size_t buffer_offset  = 0;
+	size_t read_size      = 0;
+	int result            = 0;
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( host_cache->current_offset < 0 )
+	 || ( (size64_t) host_cache->current_offset >= host_cache->size ) )
+	{
+		return( 0 );
+	}
+	if( (size64_t) size > ( host_cache->size - host_cache->current_offset ) )
+	{
+		size = (size_t) ( host_cache->size - host_cache->current_offset );
+	}
+	while( buffer_offset < size )
+	{
+		block_offset = (size_t) ( host_cache->current_offset % host_cache->block_size );
+
+		result = libqcow_block_cache_get_value_by_offset(
+		          host_cache->block_cache,
+		          host_cache->current_offset - block_offset,
+		          (intptr_t **) &block_data,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve block: 0x%08" PRIx64 " from cache.",
+			 function,
+			 host_cache->current_offset - block_offset );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			if( libqcow_host_cache_fetch_blocks(
+			     host_cache,
+			     host_cache->current_offset - block_offset,
+			     host_cache->current_offset + (off64_t) ( size - buffer_offset ),
+			     &block_data,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read block: 0x%08" PRIx64 ".",
+				 function,
+				 host_cache->current_offset - block_offset );
+
+				return( -1 );
+			}
+		}
+		read_size = host_cache->block_size - block_offset;
+
+		if( read_size > ( size - buffer_offset ) )
+		{
+			read_size = size - buffer_offset;
+		}
+		if( memory_copy(
+		     &( buffer[ buffer_offset ] ),
+		     &( block_data[ block_offset ] ),
+		     read_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy block data.",
+			 function );
+
+			return( -1 );
+		}
+		buffer_offset              += read_size;
+		host_cache->current_offset += (off64_t) read_size;
+	}
+	return( (ssize_t) buffer_offset );
+}
+
+/* Writes a buffer to the host cache
+ * Returns the number of bytes written if successful, or -1 on error
+ */
+ssize_t libqcow_host_cache_write(
+         libqcow_host_cache_t *host_cache,
+         const uint8_t *buffer LIBQCOW_ATTRIBUTE_UNUSED,
+         size_t size LIBQCOW_ATTRIBUTE_UNUSED,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_write";
+
+	LIBQCOW_UNREFERENCED_PARAMETER( buffer )
+	LIBQCOW_UNREFERENCED_PARAMETER( size )
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: write access currently not supported.",
+	 function );
+
+	return( -1 );
+}
+
+/* Seeks a certain offset in the host cache
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_host_cache_seek_offset(
+         libqcow_host_cache_t *host_cache,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_seek_offset";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_SET ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
+		 function );
+
+		return( -1 );
+	}
+	if( whence == SEEK_CUR )
+	{
+		offset += host_cache->current_offset;
+	}
+	else if( whence == SEEK_END )
+	{
+		offset += (off64_t) host_cache->size;
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	host_cache->current_offset = offset;
+
+	return( offset );
+}
+
+/* Function to determine if the host file exists
+ * Returns 1 if the host file exists, 0 if not or -1 on error
+ */
+int libqcow_host_cache_exists(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_exists";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( host_cache->file_io_handle == NULL )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Check if the host cache is open
+ * Returns 1 if open, 0 if not or -1 on error
+ */
+int libqcow_host_cache_is_open(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_is_open";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( host_cache->access_flags == 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the size of the host file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_host_cache_get_size(
+     libqcow_host_cache_t *host_cache,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_host_cache_get_size";
+
+	if( host_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid host cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid size.",
+		 function );
+
+		return( -1 );
+	}
+	*size = host_cache->size;
+
+	return( 1 );
+}
+
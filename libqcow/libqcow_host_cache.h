@@ -0,0 +1,166 @@
+/*
+ * Host cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_HOST_CACHE_H )
+#define _LIBQCOW_HOST_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_block_cache.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_host_cache libqcow_host_cache_t;
+
+/* The host cache is a file IO handle that reads another (host) file IO handle
+ * in large aligned blocks, which are cached, so that the many small reads of
+ * the metadata and cluster blocks are served by a few range reads
+ */
+struct libqcow_host_cache
+{
+	/* The (host) file IO handle
+	 */
+	libbfio_handle_t *file_io_handle;
+
+	/* The block size
+	 */
+	size_t block_size;
+
+	/* The maximum number of blocks
+	 */
+	int maximum_number_of_blocks;
+
+	/* The maximum number of blocks that are read ahead
+	 */
+	int maximum_number_of_read_ahead_blocks;
+
+	/* The maximum number of blocks that are read at once
+	 */
+	int maximum_number_of_fetch_blocks;
+
+	/* The block cache
+	 */
+	libqcow_block_cache_t *block_cache;
+
+	/* The fetch buffer
+	 */
+	uint8_t *fetch_buffer;
+
+	/* The size of the host file
+	 */
+	size64_t size;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* The offset directly after the last read range, used to detect sequential reads
+	 */
+	off64_t next_fetch_offset;
+
+	/* The access flags
+	 */
+	int access_flags;
+};
+
+int libqcow_host_cache_initialize(
+     libqcow_host_cache_t **host_cache,
+     libbfio_handle_t *file_io_handle,
+     size_t block_size,
+     int maximum_number_of_blocks,
+     int maximum_number_of_read_ahead_blocks,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_handle_t *file_io_handle,
+     size_t block_size,
+     int maximum_number_of_blocks,
+     int maximum_number_of_read_ahead_blocks,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_free(
+     libqcow_host_cache_t **host_cache,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_clone(
+     libqcow_host_cache_t **destination_host_cache,
+     libqcow_host_cache_t *source_host_cache,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_open(
+     libqcow_host_cache_t *host_cache,
+     int access_flags,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_close(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_fetch_blocks(
+     libqcow_host_cache_t *host_cache,
+     off64_t block_offset,
+     off64_t end_offset,
+     uint8_t **block_data,
+     libcerror_error_t **error );
+
+ssize_t libqcow_host_cache_read(
+         libqcow_host_cache_t *host_cache,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_host_cache_write(
+         libqcow_host_cache_t *host_cache,
+         const uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+off64_t libqcow_host_cache_seek_offset(
+         libqcow_host_cache_t *host_cache,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error );
+
+int libqcow_host_cache_exists(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_is_open(
+     libqcow_host_cache_t *host_cache,
+     libcerror_error_t **error );
+
+int libqcow_host_cache_get_size(
+     libqcow_host_cache_t *host_cache,
+     size64_t *size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_HOST_CACHE_H ) */
+
@@ -24,17 +24,20 @@
 #include <memory.h>
 #include <types.h>
 
+#include "libqcow_address_split.h"
 #include "libqcow_cluster_block.h"
 #include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
 #include "libqcow_encryption.h"
 #include "libqcow_io_handle.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libcnotify.h"
-#include "libqcow_libfcache.h"
-#include "libqcow_libfdata.h"
-#include "libqcow_unused.h"
+#include "libqcow_memory_map.h"
+#include "libqcow_numa.h"
+#include "libqcow_trace.h"
 
+#include "qcow_bitmap.h"
 #include "qcow_file_header.h"
 
 const uint8_t qcow_file_signature[ 4 ] = { 0x51, 0x46, 0x49, 0xfb };
@@ -181,6 +184,16 @@ int libqcow_io_handle_clear(
 		memory_free(
 		 io_handle->backing_filename );
 	}
+	if( io_handle->data_filename != NULL )
+	{
+		memory_free(
+		 io_handle->data_filename );
+	}
+	if( io_handle->feature_name_table != NULL )
+	{
+		memory_free(
+		 io_handle->feature_name_table );
+	}
 	if( memory_set(
 	     io_handle,
 	     0,
@@ -198,6 +211,248 @@ int libqcow_io_handle_clear(
 	return( 1 );
 }
 
+/* Copies the values of a source IO handle to a destination IO handle
+ * The backing and external data filenames and the feature name table are duplicated, the values that are
+ * not managed by the IO handle are not copied
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_copy(
+     libqcow_io_handle_t *destination_io_handle,
+     const libqcow_io_handle_t *source_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_handle_copy";
+
+	if( destination_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid destination IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( source_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid source IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_handle_clear(
+	     destination_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to clear destination IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     destination_io_handle,
+	     source_io_handle,
+	     sizeof( libqcow_io_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	destination_io_handle->backing_filename         = NULL;
+	destination_io_handle->backing_filename_size    = 0;
+	destination_io_handle->data_filename            = NULL;
+	destination_io_handle->data_filename_size       = 0;
+	destination_io_handle->feature_name_table       = NULL;
+	destination_io_handle->feature_name_table_size  = 0;
+	destination_io_handle->memory_map               = NULL;
+	destination_io_handle->level2_table_pool        = NULL;
+	destination_io_handle->cluster_block_pool       = NULL;
+	destination_io_handle->numa_topology            = NULL;
+	destination_io_handle->numa_cluster_block_pools = NULL;
+	destination_io_handle->statistics               = NULL;
+
+	if( source_io_handle->backing_filename != NULL )
+	{
+		destination_io_handle->backing_filename = (uint8_t *) memory_allocate(
+		                                                       sizeof( uint8_t ) * source_io_handle->backing_filename_size );
+
+		if( destination_io_handle->backing_filename == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create backing filename.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_copy(
+		     destination_io_handle->backing_filename,
+		     source_io_handle->backing_filename,
+		     source_io_handle->backing_filename_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy backing filename.",
+			 function );
+
+			goto on_error;
+		}
+		destination_io_handle->backing_filename_size = source_io_handle->backing_filename_size;
+	}
+	if( source_io_handle->data_filename != NULL )
+	{
+		destination_io_handle->data_filename = (uint8_t *) memory_allocate(
+		                                                    sizeof( uint8_t ) * source_io_handle->data_filename_size );
+
+		if( destination_io_handle->data_filename == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create external data filename.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_copy(
+		     destination_io_handle->data_filename,
+		     source_io_handle->data_filename,
+		     source_io_handle->data_filename_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy external data filename.",
+			 function );
+
+			goto on_error;
+		}
+		destination_io_handle->data_filename_size = source_io_handle->data_filename_size;
+	}
+	if( source_io_handle->feature_name_table != NULL )
+	{
+		destination_io_handle->feature_name_table = (uint8_t *) memory_allocate(
+		                                                         sizeof( uint8_t ) * source_io_handle->feature_name_table_size );
+
+		if( destination_io_handle->feature_name_table == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create feature name table.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_copy(
+		     destination_io_handle->feature_name_table,
+		     source_io_handle->feature_name_table,
+		     source_io_handle->feature_name_table_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy feature name table.",
+			 function );
+
+			goto on_error;
+		}
+		destination_io_handle->feature_name_table_size = source_io_handle->feature_name_table_size;
+	}
+	return( 1 );
+
+on_error:
+	libqcow_io_handle_clear(
+	 destination_io_handle,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Retrieves the cluster block pool of the NUMA node of the calling thread
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_get_cluster_block_pool(
+     libqcow_io_handle_t *io_handle,
+     libqcow_cluster_block_pool_t **cluster_block_pool,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_handle_get_cluster_block_pool";
+	int node_index        = 0;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( io_handle->numa_topology != NULL )
+	 && ( io_handle->numa_cluster_block_pools != NULL ) )
+	{
+		if( libqcow_numa_topology_get_current_node(
+		     io_handle->numa_topology,
+		     &node_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve current NUMA node.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( node_index > 0 )
+	{
+		*cluster_block_pool = io_handle->numa_cluster_block_pools[ node_index ];
+	}
+	else
+	{
+		*cluster_block_pool = io_handle->cluster_block_pool;
+	}
+	return( 1 );
+}
+
 /* Reads the file header
  * Returns 1 if successful or -1 on error
  */
@@ -211,11 +466,13 @@ int libqcow_io_handle_read_file_header(
 	static char *function                      = "libqcow_io_handle_read_file_header";
 	size_t read_size                           = 512;
 	ssize_t read_count                         = 0;
+	size_t extensions_size                     = 0;
 	uint64_t backing_filename_offset           = 0;
+	uint64_t extensions_end_offset             = 0;
 	uint32_t number_of_level1_table_references = 0;
+	uint8_t compression_type                   = 0;
 
 #if defined( HAVE_DEBUG_OUTPUT )
-	uint64_t value_64bit                       = 0;
 	uint32_t value_32bit                       = 0;
 	uint16_t value_16bit                       = 0;
 #endif
@@ -473,6 +730,56 @@ int libqcow_io_handle_read_file_header(
 		 ( (qcow_file_header_v2_t *) file_header_data )->encryption_method,
 		 *encryption_method );
 
+		byte_stream_copy_to_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_offset,
+		 io_handle->reference_count_table_offset );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_clusters,
+		 io_handle->reference_count_table_clusters );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->number_of_snapshots,
+		 io_handle->number_of_snapshots );
+
+		byte_stream_copy_to_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->snapshots_offset,
+		 io_handle->snapshots_offset );
+
+		if( io_handle->format_version == 3 )
+		{
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->incompatible_feature_flags,
+			 io_handle->incompatible_feature_flags );
+
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->compatible_feature_flags,
+			 io_handle->compatible_feature_flags );
+
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->autoclear_feature_flags,
+			 io_handle->autoclear_feature_flags );
+
+			byte_stream_copy_to_uint32_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->reference_count_order,
+			 io_handle->reference_count_order );
+
+			byte_stream_copy_to_uint32_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->header_size,
+			 io_handle->header_size );
+
+			/* The compression type is only stored in the file header if the header size allows it
+			 */
+			if( io_handle->header_size > 104 )
+			{
+				compression_type = ( (qcow_file_header_v3_t *) file_header_data )->compression_type;
+			}
+		}
+		else
+		{
+			io_handle->reference_count_order = 4;
+			io_handle->header_size           = (uint32_t) sizeof( qcow_file_header_v2_t );
+		}
 #if defined( HAVE_DEBUG_OUTPUT )
 		if( libcnotify_verbose != 0 )
 		{
@@ -501,37 +808,61 @@ int libqcow_io_handle_read_file_header(
 			 function,
 			 io_handle->level1_table_offset );
 
-			byte_stream_copy_to_uint64_big_endian(
-			 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_offset,
-			 value_64bit );
 			libcnotify_printf(
 			 "%s: reference count table offset\t: 0x%08" PRIx64 "\n",
 			 function,
-			 value_64bit );
+			 io_handle->reference_count_table_offset );
 
-			byte_stream_copy_to_uint32_big_endian(
-			 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_clusters,
-			 value_32bit );
 			libcnotify_printf(
 			 "%s: reference count table clusters\t: %" PRIu32 "\n",
 			 function,
-			 value_32bit );
+			 io_handle->reference_count_table_clusters );
 
-			byte_stream_copy_to_uint32_big_endian(
-			 ( (qcow_file_header_v2_t *) file_header_data )->number_of_snapshots,
-			 value_32bit );
 			libcnotify_printf(
 			 "%s: number of snapshots\t\t\t: %" PRIu32 "\n",
 			 function,
-			 value_32bit );
+			 io_handle->number_of_snapshots );
 
-			byte_stream_copy_to_uint64_big_endian(
-			 ( (qcow_file_header_v2_t *) file_header_data )->snapshots_offset,
-			 value_64bit );
 			libcnotify_printf(
 			 "%s: snapshots offset\t\t\t: 0x%08" PRIx64 "\n",
 			 function,
-			 value_64bit );
+			 io_handle->snapshots_offset );
+
+			if( io_handle->format_version == 3 )
+			{
+				libcnotify_printf(
+				 "%s: incompatible feature flags\t: 0x%08" PRIx64 "\n",
+				 function,
+				 io_handle->incompatible_feature_flags );
+
+				libcnotify_printf(
+				 "%s: compatible feature flags\t\t: 0x%08" PRIx64 "\n",
+				 function,
+				 io_handle->compatible_feature_flags );
+
+				libcnotify_printf(
+				 "%s: auto-clear feature flags\t\t: 0x%08" PRIx64 "\n",
+				 function,
+				 io_handle->autoclear_feature_flags );
+
+				libcnotify_printf(
+				 "%s: reference count order\t\t: %" PRIu32 "\n",
+				 function,
+				 io_handle->reference_count_order );
+
+				libcnotify_printf(
+				 "%s: header size\t\t\t\t: %" PRIu32 "\n",
+				 function,
+				 io_handle->header_size );
+
+				if( io_handle->header_size > 104 )
+				{
+					libcnotify_printf(
+					 "%s: compression type\t\t\t: %" PRIu8 "\n",
+					 function,
+					 compression_type );
+				}
+			}
 		}
 #endif
 	}
@@ -547,11 +878,77 @@ int libqcow_io_handle_read_file_header(
 
 	file_header_data = NULL;
 
+	if( io_handle->format_version == 3 )
+	{
+		if( io_handle->header_size < 104 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid header size value out of bounds.",
+			 function );
+
+			goto on_error;
+		}
+		if( io_handle->reference_count_order > 6 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported reference count order: %" PRIu32 ".",
+			 function,
+			 io_handle->reference_count_order );
+
+			goto on_error;
+		}
+		/* A compression type other than deflate requires the compression type feature flag
+		 */
+		if( ( compression_type != LIBQCOW_COMPRESSION_TYPE_DEFLATE )
+		 && ( ( io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_COMPRESSION_TYPE ) == 0 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: invalid compression type: %" PRIu8 " - missing compression type feature flag.",
+			 function,
+			 compression_type );
+
+			goto on_error;
+		}
+	}
+	switch( compression_type )
+	{
+		case LIBQCOW_COMPRESSION_TYPE_DEFLATE:
+			io_handle->compression_method = LIBQCOW_COMPRESSION_METHOD_DEFLATE;
+			break;
+
+		case LIBQCOW_COMPRESSION_TYPE_ZSTD:
+			io_handle->compression_method = LIBQCOW_COMPRESSION_METHOD_ZSTD;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported compression type: %" PRIu8 ".",
+			 function,
+			 compression_type );
+
+			goto on_error;
+	}
+	io_handle->number_of_level2_table_entry_bits = 3;
+	io_handle->number_of_subcluster_bits         = io_handle->number_of_cluster_block_bits;
+
 	if( io_handle->format_version == 1 )
 	{
 		io_handle->offset_bit_mask           = 0x7fffffffffffffffULL;
 		io_handle->compression_flag_bit_mask = (uint64_t) 1 << 63;
 		io_handle->compression_bit_shift     = 63 - io_handle->number_of_cluster_block_bits;
+		io_handle->zero_flag_bit_mask        = 0;
 	}
 	else if( ( io_handle->format_version == 2 )
 	      || ( io_handle->format_version == 3 ) )
@@ -567,19 +964,71 @@ int libqcow_io_handle_read_file_header(
 
 			goto on_error;
 		}
-		io_handle->number_of_level2_table_bits = io_handle->number_of_cluster_block_bits - 3;
+		/* Extended level 2 table entries are 16 bytes in size and contain
+		 * a subcluster allocation bitmap
+		 */
+		if( ( io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTENDED_L2 ) != 0 )
+		{
+			if( io_handle->number_of_cluster_block_bits < 14 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid number of cluster block bits value out of bounds for extended level 2 table entries.",
+				 function );
+
+				goto on_error;
+			}
+			io_handle->number_of_level2_table_entry_bits = 4;
+			io_handle->number_of_subcluster_bits         = io_handle->number_of_cluster_block_bits - LIBQCOW_NUMBER_OF_SUBCLUSTER_BITS;
+		}
+		io_handle->number_of_level2_table_bits = io_handle->number_of_cluster_block_bits - io_handle->number_of_level2_table_entry_bits;
 		io_handle->offset_bit_mask             = 0x3fffffffffffffffULL;
 		io_handle->compression_flag_bit_mask   = (uint64_t) 1 << 62;
 		io_handle->compression_bit_shift       = 62 - ( io_handle->number_of_cluster_block_bits - 8 );
+
+		/* Version 3 defines bit 0 of a standard level 2 table entry as the zero flag
+		 */
+		if( io_handle->format_version == 3 )
+		{
+			io_handle->zero_flag_bit_mask = 0x0000000000000001ULL;
+		}
+		else
+		{
+			io_handle->zero_flag_bit_mask = 0;
+		}
 	}
 	io_handle->level1_index_bit_shift = io_handle->number_of_cluster_block_bits
 	                                  + io_handle->number_of_level2_table_bits;
 
-	io_handle->level2_index_bit_mask  = ~( (uint64_t) -1 << io_handle->number_of_level2_table_bits );
-	io_handle->cluster_block_bit_mask = ~( (uint64_t) -1 << io_handle->number_of_cluster_block_bits );
-	io_handle->compression_bit_mask   = ~( (uint64_t) -1 << io_handle->compression_bit_shift );
-	io_handle->level2_table_size      = (size_t) 1 << io_handle->number_of_level2_table_bits;
-	io_handle->cluster_block_size     = (size_t) 1 << io_handle->number_of_cluster_block_bits;
+	/* Large level 2 tables are read and cached in slices so that a lookup
+	 * does not depend on the cluster block size
+	 */
+	io_handle->number_of_level2_table_slice_bits = io_handle->number_of_level2_table_bits;
+
+	if( io_handle->number_of_level2_table_slice_bits > ( LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS + 3 - io_handle->number_of_level2_table_entry_bits ) )
+	{
+		io_handle->number_of_level2_table_slice_bits = LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS + 3 - io_handle->number_of_level2_table_entry_bits;
+	}
+	io_handle->level2_index_bit_mask         = ~( (uint64_t) -1 << io_handle->number_of_level2_table_bits );
+	io_handle->level2_slice_index_bit_mask   = ~( (uint64_t) -1 << io_handle->number_of_level2_table_slice_bits );
+	io_handle->cluster_block_bit_mask        = ~( (uint64_t) -1 << io_handle->number_of_cluster_block_bits );
+	io_handle->subcluster_bit_mask           = ~( (uint64_t) -1 << io_handle->number_of_subcluster_bits );
+	io_handle->compression_bit_mask          = ~( (uint64_t) -1 << io_handle->compression_bit_shift );
+	io_handle->level2_table_size             = (size_t) 1 << io_handle->number_of_level2_table_bits;
+	io_handle->level2_table_slice_size       = (size_t) 1 << io_handle->number_of_level2_table_slice_bits;
+	io_handle->number_of_level2_table_slices = (uint32_t) 1 << ( io_handle->number_of_level2_table_bits - io_handle->number_of_level2_table_slice_bits );
+	io_handle->cluster_block_size            = (size_t) 1 << io_handle->number_of_cluster_block_bits;
+	io_handle->subcluster_size               = (size_t) 1 << io_handle->number_of_subcluster_bits;
+
+	/* Common cluster block sizes use a split with constant shifts and masks
+	 */
+	io_handle->address_split_layout = libqcow_address_split_get_layout(
+	                                   io_handle->number_of_cluster_block_bits,
+	                                   io_handle->number_of_level2_table_bits,
+	                                   io_handle->number_of_level2_table_entry_bits,
+	                                   io_handle->number_of_level2_table_slice_bits );
 
 	if( io_handle->format_version == 1 )
 	{
@@ -599,8 +1048,9 @@ int libqcow_io_handle_read_file_header(
 	{
 		io_handle->level1_table_size = number_of_level1_table_references;
 	}
-	io_handle->level1_table_size *= 8;
-	io_handle->level2_table_size *= 8;
+	io_handle->level1_table_size       *= 8;
+	io_handle->level2_table_size       <<= io_handle->number_of_level2_table_entry_bits;
+	io_handle->level2_table_slice_size <<= io_handle->number_of_level2_table_entry_bits;
 
 #if UINT32_MAX > SSIZE_MAX
 	if( io_handle->level1_table_size > (uint32_t) SSIZE_MAX )
@@ -628,23 +1078,91 @@ int libqcow_io_handle_read_file_header(
 		 function,
 		 io_handle->level2_table_size );
 
+		libcnotify_printf(
+		 "%s: level 2 table slice size\t\t: %" PRIzd "\n",
+		 function,
+		 io_handle->level2_table_slice_size );
+
 		libcnotify_printf(
 		 "%s: cluster block size\t\t\t: %" PRIzd "\n",
 		 function,
 		 io_handle->cluster_block_size );
 	}
 #endif
-	if( ( backing_filename_offset > 0 )
-	 && ( io_handle->backing_filename_size > 0 ) )
+	/* The header extensions are stored after the file header in the first cluster
+	 * and before the backing filename
+	 */
+	if( ( io_handle->format_version == 2 )
+	 || ( io_handle->format_version == 3 ) )
 	{
-#if defined( HAVE_DEBUG_OUTPUT )
-		if( libcnotify_verbose != 0 )
+		if( (size_t) io_handle->header_size > io_handle->cluster_block_size )
 		{
-			libcnotify_printf(
-			 "%s: reading backing filename at offset: %" PRIu64 " (0x%08" PRIx64 ")\n",
-			 function,
-			 backing_filename_offset,
-			 backing_filename_offset );
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid header size value exceeds cluster block size.",
+			 function );
+
+			goto on_error;
+		}
+		extensions_end_offset = (uint64_t) io_handle->cluster_block_size;
+
+		if( ( backing_filename_offset > (uint64_t) io_handle->header_size )
+		 && ( backing_filename_offset < extensions_end_offset ) )
+		{
+			extensions_end_offset = backing_filename_offset;
+		}
+		if( extensions_end_offset > (uint64_t) io_handle->header_size )
+		{
+			extensions_size = (size_t) ( extensions_end_offset - io_handle->header_size );
+
+			if( libqcow_io_handle_read_header_extensions(
+			     io_handle,
+			     file_io_handle,
+			     (off64_t) io_handle->header_size,
+			     extensions_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read header extensions.",
+				 function );
+
+				goto on_error;
+			}
+		}
+	}
+	/* The feature flags are checked after the header extensions are read
+	 * so that an unsupported feature can be reported by its name, before
+	 * any of the tables are read
+	 */
+	if( libqcow_io_handle_check_feature_flags(
+	     io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported feature flags.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( backing_filename_offset > 0 )
+	 && ( io_handle->backing_filename_size > 0 ) )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: reading backing filename at offset: %" PRIu64 " (0x%08" PRIx64 ")\n",
+			 function,
+			 backing_filename_offset,
+			 backing_filename_offset );
 		}
 #endif
 		if( libbfio_handle_seek_offset(
@@ -710,6 +1228,22 @@ int libqcow_io_handle_read_file_header(
 	return( 1 );
 
 on_error:
+	if( io_handle->feature_name_table != NULL )
+	{
+		memory_free(
+		 io_handle->feature_name_table );
+
+		io_handle->feature_name_table      = NULL;
+		io_handle->feature_name_table_size = 0;
+	}
+	if( io_handle->data_filename != NULL )
+	{
+		memory_free(
+		 io_handle->data_filename );
+
+		io_handle->data_filename      = NULL;
+		io_handle->data_filename_size = 0;
+	}
 	if( io_handle->backing_filename != NULL )
 	{
 		memory_free(
@@ -726,182 +1260,1055 @@ on_error:
 	return( -1 );
 }
 
-/* Reads a level 2 table
- * Callback function for the level 2 table vector
+/* Reads the header extensions
+ * The header extensions are read up to the end of extensions marker,
+ * the end of the extensions size or the end of the file
  * Returns 1 if successful or -1 on error
  */
-int libqcow_io_handle_read_level2_table(
-     intptr_t *data_handle LIBQCOW_ATTRIBUTE_UNUSED,
+int libqcow_io_handle_read_header_extensions(
+     libqcow_io_handle_t *io_handle,
      libbfio_handle_t *file_io_handle,
-     libfdata_vector_t *vector,
-     libfcache_cache_t *cache,
-     int element_index,
-     int element_data_file_index LIBQCOW_ATTRIBUTE_UNUSED,
-     off64_t element_data_offset,
-     size64_t element_data_size,
-     uint32_t element_data_flags LIBQCOW_ATTRIBUTE_UNUSED,
-     uint8_t read_flags LIBQCOW_ATTRIBUTE_UNUSED,
+     off64_t file_offset,
+     size_t extensions_size,
      libcerror_error_t **error )
 {
-	libqcow_cluster_table_t *level2_table = NULL;
-	static char *function                 = "libqcow_io_handle_read_level2_table";
-
-	LIBQCOW_UNREFERENCED_PARAMETER( data_handle );
-	LIBQCOW_UNREFERENCED_PARAMETER( element_data_file_index );
-	LIBQCOW_UNREFERENCED_PARAMETER( element_data_flags );
-	LIBQCOW_UNREFERENCED_PARAMETER( read_flags );
+	uint8_t *extensions_data = NULL;
+	static char *function    = "libqcow_io_handle_read_header_extensions";
+	size_t data_offset       = 0;
+	ssize_t read_count       = 0;
+	uint32_t extension_size  = 0;
+	uint32_t extension_type  = 0;
 
-	if( element_data_size > (size64_t) SSIZE_MAX )
+	if( io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid element data size value exceeds maximum.",
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
 		 function );
 
 		return( -1 );
 	}
-	if( libqcow_cluster_table_initialize(
-	     &level2_table,
-	     error ) != 1 )
+	if( io_handle->data_filename != NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create level 2 table.",
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid IO handle - data filename value already set.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libqcow_cluster_table_read(
-	     level2_table,
-	     file_io_handle,
-	     element_data_offset,
-	     (size_t) element_data_size,
-	     error ) != 1 )
+	if( file_offset < 0 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read level 2 table.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfdata_vector_set_element_value_by_index(
-	     vector,
-	     (intptr_t *) file_io_handle,
-	     cache,
-	     element_index,
-	     (intptr_t *) level2_table,
-	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_table_free,
-	     LIBFDATA_VECTOR_ELEMENT_VALUE_FLAG_MANAGED,
-	     error ) != 1 )
+	if( ( extensions_size == 0 )
+	 || ( extensions_size > (size_t) SSIZE_MAX ) )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to set level 2 table as element value.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid extensions size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	extensions_data = (uint8_t *) memory_allocate(
+	                               sizeof( uint8_t ) * extensions_size );
+
+	if( extensions_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create extensions data.",
 		 function );
 
 		goto on_error;
 	}
+	/* The first cluster can be larger than the file
+	 */
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              extensions_data,
+	              extensions_size,
+	              file_offset,
+	              error );
+
+	if( read_count < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read header extensions data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		goto on_error;
+	}
+	extensions_size = (size_t) read_count;
+
+	while( ( data_offset + sizeof( qcow_header_extension_t ) ) <= extensions_size )
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_header_extension_t *) &( extensions_data[ data_offset ] ) )->type,
+		 extension_type );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_header_extension_t *) &( extensions_data[ data_offset ] ) )->data_size,
+		 extension_size );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: header extension type\t\t: 0x%08" PRIx32 "\n",
+			 function,
+			 extension_type );
+
+			libcnotify_printf(
+			 "%s: header extension data size\t: %" PRIu32 "\n",
+			 function,
+			 extension_size );
+		}
+#endif
+		if( extension_type == LIBQCOW_HEADER_EXTENSION_TYPE_END )
+		{
+			break;
+		}
+		data_offset += sizeof( qcow_header_extension_t );
+
+		if( (size_t) extension_size > ( extensions_size - data_offset ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid header extension: 0x%08" PRIx32 " data size value out of bounds.",
+			 function,
+			 extension_type );
+
+			goto on_error;
+		}
+		if( ( extension_type == LIBQCOW_HEADER_EXTENSION_TYPE_EXTERNAL_DATA_FILE )
+		 && ( extension_size > 0 )
+		 && ( io_handle->data_filename == NULL ) )
+		{
+			io_handle->data_filename = (uint8_t *) memory_allocate(
+			                                        sizeof( uint8_t ) * extension_size );
+
+			if( io_handle->data_filename == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create data filename.",
+				 function );
+
+				goto on_error;
+			}
+			if( memory_copy(
+			     io_handle->data_filename,
+			     &( extensions_data[ data_offset ] ),
+			     (size_t) extension_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy data filename.",
+				 function );
+
+				goto on_error;
+			}
+			io_handle->data_filename_size = (size_t) extension_size;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: data filename data:\n",
+				 function );
+				libcnotify_print_data(
+				 io_handle->data_filename,
+				 io_handle->data_filename_size,
+				 0 );
+			}
+#endif
+		}
+		else if( ( extension_type == LIBQCOW_HEADER_EXTENSION_TYPE_BITMAPS )
+		      && ( extension_size >= sizeof( qcow_bitmaps_extension_t ) ) )
+		{
+			byte_stream_copy_to_uint32_big_endian(
+			 ( (qcow_bitmaps_extension_t *) &( extensions_data[ data_offset ] ) )->number_of_bitmaps,
+			 io_handle->number_of_bitmaps );
+
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_bitmaps_extension_t *) &( extensions_data[ data_offset ] ) )->bitmap_directory_size,
+			 io_handle->bitmap_directory_size );
+
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_bitmaps_extension_t *) &( extensions_data[ data_offset ] ) )->bitmap_directory_offset,
+			 io_handle->bitmap_directory_offset );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: number of bitmaps\t\t: %" PRIu32 "\n",
+				 function,
+				 io_handle->number_of_bitmaps );
+
+				libcnotify_printf(
+				 "%s: bitmap directory size\t\t: %" PRIu64 "\n",
+				 function,
+				 io_handle->bitmap_directory_size );
+
+				libcnotify_printf(
+				 "%s: bitmap directory offset\t: 0x%08" PRIx64 "\n",
+				 function,
+				 io_handle->bitmap_directory_offset );
+			}
+#endif
+		}
+		else if( ( extension_type == LIBQCOW_HEADER_EXTENSION_TYPE_FEATURE_NAME_TABLE )
+		      && ( extension_size >= sizeof( qcow_feature_name_table_entry_t ) )
+		      && ( io_handle->feature_name_table == NULL ) )
+		{
+			/* A partial entry at the end of the table is ignored
+			 */
+			io_handle->feature_name_table_size = ( (size_t) extension_size / sizeof( qcow_feature_name_table_entry_t ) )
+			                                   * sizeof( qcow_feature_name_table_entry_t );
+
+			io_handle->feature_name_table = (uint8_t *) memory_allocate(
+			                                             sizeof( uint8_t ) * io_handle->feature_name_table_size );
+
+			if( io_handle->feature_name_table == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create feature name table.",
+				 function );
+
+				goto on_error;
+			}
+			if( memory_copy(
+			     io_handle->feature_name_table,
+			     &( extensions_data[ data_offset ] ),
+			     io_handle->feature_name_table_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy feature name table.",
+				 function );
+
+				goto on_error;
+			}
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: feature name table data:\n",
+				 function );
+				libcnotify_print_data(
+				 io_handle->feature_name_table,
+				 io_handle->feature_name_table_size,
+				 0 );
+			}
+#endif
+		}
+		else if( ( extension_type == LIBQCOW_HEADER_EXTENSION_TYPE_FULL_DISK_ENCRYPTION )
+		      && ( extension_size >= sizeof( qcow_full_disk_encryption_extension_t ) ) )
+		{
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_full_disk_encryption_extension_t *) &( extensions_data[ data_offset ] ) )->encryption_header_offset,
+			 io_handle->encryption_header_offset );
+
+			byte_stream_copy_to_uint64_big_endian(
+			 ( (qcow_full_disk_encryption_extension_t *) &( extensions_data[ data_offset ] ) )->encryption_header_size,
+			 io_handle->encryption_header_size );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+			if( libcnotify_verbose != 0 )
+			{
+				libcnotify_printf(
+				 "%s: encryption header offset\t: 0x%08" PRIx64 "\n",
+				 function,
+				 io_handle->encryption_header_offset );
+
+				libcnotify_printf(
+				 "%s: encryption header size\t\t: %" PRIu64 "\n",
+				 function,
+				 io_handle->encryption_header_size );
+			}
+#endif
+		}
+		/* The header extension data is padded to a multitude of 8 bytes
+		 */
+		extension_size = ( ( extension_size + 7 ) / 8 ) * 8;
+
+		if( (size_t) extension_size > ( extensions_size - data_offset ) )
+		{
+			break;
+		}
+		data_offset += (size_t) extension_size;
+	}
+	memory_free(
+	 extensions_data );
+
 	return( 1 );
 
 on_error:
-	if( level2_table != NULL )
+	if( io_handle->feature_name_table != NULL )
 	{
-		libqcow_cluster_table_free(
-		 &level2_table,
-		 NULL );
+		memory_free(
+		 io_handle->feature_name_table );
+
+		io_handle->feature_name_table      = NULL;
+		io_handle->feature_name_table_size = 0;
+	}
+	if( io_handle->data_filename != NULL )
+	{
+		memory_free(
+		 io_handle->data_filename );
+
+		io_handle->data_filename      = NULL;
+		io_handle->data_filename_size = 0;
+	}
+	if( extensions_data != NULL )
+	{
+		memory_free(
+		 extensions_data );
 	}
 	return( -1 );
 }
 
-/* Reads a cluster block
- * Callback function for the cluster block vector
- * Returns 1 if successful or -1 on error
+/* Retrieves the name of a feature from the feature name table
+ * The name is stored as a 0-byte terminated UTF-8 string
+ * The name size should include the end of string character
+ * Returns 1 if successful, 0 if the feature is not in the feature name table or -1 on error
  */
-int libqcow_io_handle_read_cluster_block(
-     intptr_t *data_handle LIBQCOW_ATTRIBUTE_UNUSED,
-     libbfio_handle_t *file_io_handle,
-     libfdata_vector_t *vector,
-     libfcache_cache_t *cache,
-     int element_index,
-     int element_data_file_index LIBQCOW_ATTRIBUTE_UNUSED,
-     off64_t element_data_offset,
-     size64_t element_data_size,
-     uint32_t element_data_flags LIBQCOW_ATTRIBUTE_UNUSED,
-     uint8_t read_flags LIBQCOW_ATTRIBUTE_UNUSED,
+int libqcow_io_handle_get_feature_name(
+     libqcow_io_handle_t *io_handle,
+     uint8_t feature_type,
+     uint8_t bit_number,
+     char *name,
+     size_t name_size,
      libcerror_error_t **error )
 {
-	libqcow_cluster_block_t *cluster_block = NULL;
-	static char *function                  = "libqcow_io_handle_read_cluster_block";
+	qcow_feature_name_table_entry_t *entry = NULL;
+	static char *function                  = "libqcow_io_handle_get_feature_name";
+	size_t entry_offset                    = 0;
+	size_t name_index                      = 0;
 
-	LIBQCOW_UNREFERENCED_PARAMETER( data_handle );
-	LIBQCOW_UNREFERENCED_PARAMETER( element_data_file_index );
-	LIBQCOW_UNREFERENCED_PARAMETER( element_data_flags );
-	LIBQCOW_UNREFERENCED_PARAMETER( read_flags );
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
 
-	if( element_data_size > (size64_t) SSIZE_MAX )
+		return( -1 );
+	}
+	if( name == NULL )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
-		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
-		 "%s: invalid element data size value exceeds maximum.",
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid name.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libqcow_cluster_block_initialize(
-	     &cluster_block,
-	     (size_t) element_data_size,
-	     error ) != 1 )
+	if( ( name_size <= sizeof( entry->name ) )
+	 || ( name_size > (size_t) SSIZE_MAX ) )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
-		 "%s: unable to create cluster block.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid name size value out of bounds.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libqcow_cluster_block_read(
-	     cluster_block,
-	     file_io_handle,
-             element_data_offset,
-	     error ) != 1 )
+	if( io_handle->feature_name_table == NULL )
+	{
+		return( 0 );
+	}
+	for( entry_offset = 0;
+	     ( entry_offset + sizeof( qcow_feature_name_table_entry_t ) ) <= io_handle->feature_name_table_size;
+	     entry_offset += sizeof( qcow_feature_name_table_entry_t ) )
+	{
+		entry = (qcow_feature_name_table_entry_t *) &( io_handle->feature_name_table[ entry_offset ] );
+
+		if( ( entry->feature_type != feature_type )
+		 || ( entry->bit_number != bit_number ) )
+		{
+			continue;
+		}
+		/* The name is padded with 0-byte values but is not necessarily terminated
+		 */
+		for( name_index = 0;
+		     name_index < sizeof( entry->name );
+		     name_index++ )
+		{
+			if( entry->name[ name_index ] == 0 )
+			{
+				break;
+			}
+			name[ name_index ] = (char) entry->name[ name_index ];
+		}
+		name[ name_index ] = 0;
+
+		return( 1 );
+	}
+	return( 0 );
+}
+
+/* Checks if the feature flags of the file header are supported
+ * A file with unsupported incompatible features is rejected up front,
+ * the compatible and auto-clear features do not affect reading the file
+ * Returns 1 if supported or -1 on error
+ */
+int libqcow_io_handle_check_feature_flags(
+     libqcow_io_handle_t *io_handle,
+     libcerror_error_t **error )
+{
+	char feature_name[ 64 ];
+
+	static char *function      = "libqcow_io_handle_check_feature_flags";
+	uint64_t unsupported_flags = 0;
+	uint8_t bit_number         = 0;
+	int result                 = 0;
+
+	if( io_handle == NULL )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read cluster block.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( libfdata_vector_set_element_value_by_index(
-	     vector,
-	     (intptr_t *) file_io_handle,
-	     cache,
-	     element_index,
-	     (intptr_t *) cluster_block,
-	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_cluster_block_free,
-	     LIBFDATA_VECTOR_ELEMENT_VALUE_FLAG_MANAGED,
-	     error ) != 1 )
+	if( io_handle->format_version != 3 )
+	{
+		return( 1 );
+	}
+	/* The metadata of a file marked as corrupt cannot be relied on
+	 */
+	if( ( io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_CORRUPT ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported file marked as corrupt.",
+		 function );
+
+		return( -1 );
+	}
+	unsupported_flags = io_handle->incompatible_feature_flags & ~( (uint64_t) LIBQCOW_SUPPORTED_INCOMPATIBLE_FEATURE_FLAGS );
+
+	if( unsupported_flags == 0 )
+	{
+		return( 1 );
+	}
+	while( ( unsupported_flags & 0x0000000000000001ULL ) == 0 )
+	{
+		unsupported_flags >>= 1;
+		bit_number++;
+	}
+	result = libqcow_io_handle_get_feature_name(
+	          io_handle,
+	          LIBQCOW_FEATURE_TYPE_INCOMPATIBLE,
+	          bit_number,
+	          feature_name,
+	          64,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve name of incompatible feature: %" PRIu8 ".",
+		 function,
+		 bit_number );
+
+		return( -1 );
+	}
+	else if( result != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported incompatible feature: %" PRIu8 " (%s).",
+		 function,
+		 bit_number,
+		 feature_name );
+	}
+	else
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-		 "%s: unable to set cluster block as element value.",
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported incompatible feature flags: 0x%08" PRIx64 ".",
+		 function,
+		 io_handle->incompatible_feature_flags );
+	}
+	return( -1 );
+}
+
+/* Reads a level 2 table slice
+ * The file offset must be the offset of the slice within the level 2 table
+ * The level 2 table references are retrieved from the level 2 table pool if available
+ * Make sure the value level2_table is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_read_level2_table(
+     libqcow_io_handle_t *io_handle,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     libqcow_cluster_table_t **level2_table,
+     libcerror_error_t **error )
+{
+	const uint8_t *level2_table_data = NULL;
+	static char *function            = "libqcow_io_handle_read_level2_table";
+	uint64_t start_timestamp         = 0;
+	int result                       = 0;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( io_handle->level2_table_slice_size == 0 )
+	 || ( io_handle->level2_table_slice_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid IO handle - level 2 table slice size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( level2_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 2 table.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_initialize(
+	     level2_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 2 table.",
+		 function );
+
+		goto on_error;
+	}
+	/* The level 2 table references are reused from the pool
+	 * so that evicting and refilling the cache does not allocate
+	 */
+	( *level2_table )->pool = io_handle->level2_table_pool;
+
+	/* The level 2 table entries are decoded on access so that a lookup
+	 * in a large level 2 table does not first decode the entire table
+	 */
+	( *level2_table )->decode_on_access = 1;
+
+	if( LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( io_handle->statistics ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	/* When the file is memory mapped the level 2 table is decoded directly from the mapped data
+	 */
+	if( io_handle->memory_map != NULL )
+	{
+		result = libqcow_memory_map_get_data(
+		          io_handle->memory_map,
+		          file_offset,
+		          io_handle->level2_table_slice_size,
+		          &level2_table_data,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 2 table data from memory map.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( result != 0 )
+	{
+		if( libqcow_cluster_table_read_data(
+		     *level2_table,
+		     level2_table_data,
+		     io_handle->level2_table_slice_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 table.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+	{
+		if( ( start_timestamp == 0 )
+		 && LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+		{
+			start_timestamp = libqcow_statistics_get_timestamp();
+		}
+		LIBQCOW_TRACE(
+		 host_read_issued,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+		 file_offset,
+		 io_handle->level2_table_slice_size,
+		 0 );
+
+		if( libqcow_cluster_table_read(
+		     *level2_table,
+		     file_io_handle,
+		     file_offset,
+		     io_handle->level2_table_slice_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 table.",
+			 function );
+
+			goto on_error;
+		}
+		if( start_timestamp != 0 )
+		{
+			LIBQCOW_TRACE(
+			 host_read_completed,
+			 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+			 file_offset,
+			 io_handle->level2_table_slice_size,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	if( io_handle->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->level2_table_cache_misses, 1 );
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->number_of_host_reads, 1 );
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->host_bytes_read, io_handle->level2_table_slice_size );
+
+		if( ( start_timestamp != 0 )
+		 && LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( io_handle->statistics ) )
+		{
+			libqcow_statistics_add_latency(
+			 io_handle->statistics,
+			 LIBQCOW_LATENCY_OPERATION_LEVEL2_TABLE_READ,
+			 libqcow_statistics_get_timestamp() - start_timestamp );
+		}
+	}
+	return( 1 );
+
+on_error:
+	if( *level2_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 level2_table,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads the data of adjacent level 2 table slices at once
+ * The data size must be a multiple of the level 2 table slice size
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_read_level2_tables_data(
+     libqcow_io_handle_t *io_handle,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_io_handle_read_level2_tables_data";
+	uint64_t start_timestamp = 0;
+	ssize_t read_count       = 0;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( io_handle->level2_table_slice_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid IO handle - level 2 table slice size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size == 0 )
+	 || ( data_size > (size_t) SSIZE_MAX )
+	 || ( ( data_size % io_handle->level2_table_slice_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( LIBQCOW_TRACE_IS_ENABLED( host_read_completed ) )
+	{
+		start_timestamp = libqcow_statistics_get_timestamp();
+	}
+	LIBQCOW_TRACE(
+	 host_read_issued,
+	 LIBQCOW_TRACE_EVENT_HOST_READ_ISSUED,
+	 file_offset,
+	 data_size,
+	 0 );
+
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              data,
+	              data_size,
+	              file_offset,
+	              error );
+
+	if( read_count != (ssize_t) data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 2 tables data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		return( -1 );
+	}
+	if( io_handle->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->number_of_host_reads, 1 );
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->host_bytes_read, data_size );
+	}
+	if( start_timestamp != 0 )
+	{
+		LIBQCOW_TRACE(
+		 host_read_completed,
+		 LIBQCOW_TRACE_EVENT_HOST_READ_COMPLETED,
+		 file_offset,
+		 read_count,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	return( 1 );
+}
+
+/* Reads a level 2 table slice from data read by libqcow_io_handle_read_level2_tables_data
+ * The level 2 table references are retrieved from the level 2 table pool if available
+ * Make sure the value level2_table is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_read_level2_table_data(
+     libqcow_io_handle_t *io_handle,
+     const uint8_t *data,
+     size_t data_size,
+     libqcow_cluster_table_t **level2_table,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_handle_read_level2_table_data";
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size != io_handle->level2_table_slice_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( level2_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 2 table.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_initialize(
+	     level2_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 2 table.",
+		 function );
+
+		goto on_error;
+	}
+	( *level2_table )->pool             = io_handle->level2_table_pool;
+	( *level2_table )->decode_on_access = 1;
+
+	if( libqcow_cluster_table_read_data(
+	     *level2_table,
+	     data,
+	     data_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 2 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( io_handle->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->level2_table_cache_misses, 1 );
+	}
+	return( 1 );
+
+on_error:
+	if( *level2_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 level2_table,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Reads a cluster block
+ * The cluster block data is retrieved from the cluster block pool if available
+ * Make sure the value cluster_block is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_handle_read_cluster_block(
+     libqcow_io_handle_t *io_handle,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size_t cluster_block_size,
+     libqcow_cluster_block_t **cluster_block,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	static char *function                            = "libqcow_io_handle_read_cluster_block";
+	ssize_t read_count                               = 0;
+
+	if( io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid cluster block size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_io_handle_get_cluster_block_pool(
+	     io_handle,
+	     &cluster_block_pool,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve cluster block pool.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_block_initialize(
+	     cluster_block,
+	     cluster_block_size,
+	     cluster_block_pool,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create cluster block.",
+		 function );
+
+		goto on_error;
+	}
+	( *cluster_block )->statistics = io_handle->statistics;
+
+	if( io_handle->statistics != NULL )
+	{
+		LIBQCOW_STATISTICS_ADD( io_handle->statistics->cluster_block_cache_misses, 1 );
+	}
+	LIBQCOW_TRACE(
+	 cluster_block_miss,
+	 LIBQCOW_TRACE_EVENT_CLUSTER_BLOCK_MISS,
+	 file_offset,
+	 cluster_block_size,
+	 0 );
+
+	/* When the file is memory mapped the cluster block is copied from the mapped data
+	 */
+	if( io_handle->memory_map != NULL )
+	{
+		read_count = libqcow_memory_map_read_buffer_at_offset(
+		              io_handle->memory_map,
+		              ( *cluster_block )->data,
+		              ( *cluster_block )->data_size,
+		              file_offset,
+		              error );
+
+		if( read_count != (ssize_t) ( *cluster_block )->data_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block from memory map.",
+			 function );
+
+			goto on_error;
+		}
+		if( io_handle->statistics != NULL )
+		{
+			LIBQCOW_STATISTICS_ADD( io_handle->statistics->number_of_host_reads, 1 );
+			LIBQCOW_STATISTICS_ADD( io_handle->statistics->host_bytes_read, read_count );
+		}
+	}
+	else if( libqcow_cluster_block_read(
+	          *cluster_block,
+	          file_io_handle,
+	          file_offset,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read cluster block.",
 		 function );
 
 		goto on_error;
@@ -909,10 +2316,10 @@ int libqcow_io_handle_read_cluster_block(
 	return( 1 );
 
 on_error:
-	if( cluster_block != NULL )
+	if( *cluster_block != NULL )
 	{
 		libqcow_cluster_block_free(
-		 &cluster_block,
+		 cluster_block,
 		 NULL );
 	}
 	return( -1 );
@@ -27,8 +27,13 @@
 
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
-#include "libqcow_libfcache.h"
-#include "libqcow_libfdata.h"
+#include "libqcow_cluster_block.h"
+#include "libqcow_cluster_block_pool.h"
+#include "libqcow_cluster_table.h"
+#include "libqcow_cluster_table_pool.h"
+#include "libqcow_memory_map.h"
+#include "libqcow_numa.h"
+#include "libqcow_statistics.h"
 
 #if defined( __cplusplus )
 extern "C" {
@@ -48,6 +53,26 @@ struct libqcow_io_handle
 	 */
 	uint32_t format_version;
 
+	/* The (version 3) incompatible feature flags
+	 */
+	uint64_t incompatible_feature_flags;
+
+	/* The (version 3) compatible feature flags
+	 */
+	uint64_t compatible_feature_flags;
+
+	/* The (version 3) auto-clear feature flags
+	 */
+	uint64_t autoclear_feature_flags;
+
+	/* The file header size
+	 */
+	uint32_t header_size;
+
+	/* The compression method
+	 */
+	uint16_t compression_method;
+
 	/* The level 1 table offset
  	 */
 	off64_t level1_table_offset;
@@ -64,6 +89,11 @@ struct libqcow_io_handle
  	 */
 	uint32_t number_of_level2_table_bits;
 
+	/* The number of level 2 table entry bits, which is 3 for standard
+	 * and 4 for extended level 2 table entries
+ 	 */
+	uint32_t number_of_level2_table_entry_bits;
+
 	/* The level 1 index bit shift
  	 */
 	uint32_t level1_index_bit_shift;
@@ -72,10 +102,30 @@ struct libqcow_io_handle
  	 */
 	uint64_t level2_index_bit_mask;
 
+	/* The number of level 2 table slice bits
+ 	 */
+	uint32_t number_of_level2_table_slice_bits;
+
+	/* The level 2 slice index bit mask
+ 	 */
+	uint64_t level2_slice_index_bit_mask;
+
+	/* The address split layout, a LIBQCOW_ADDRESS_SPLIT_LAYOUT value
+	 */
+	int address_split_layout;
+
 	/* The cluster block bit mask
  	 */
 	uint64_t cluster_block_bit_mask;
 
+	/* The number of subcluster bits
+ 	 */
+	uint32_t number_of_subcluster_bits;
+
+	/* The subcluster bit mask
+ 	 */
+	uint64_t subcluster_bit_mask;
+
 	/* The offset bit mask
  	 */
 	uint64_t offset_bit_mask;
@@ -84,6 +134,10 @@ struct libqcow_io_handle
  	 */
 	uint64_t compression_flag_bit_mask;
 
+	/* The zero flag bit mask
+ 	 */
+	uint64_t zero_flag_bit_mask;
+
 	/* The compression (offset) bit mask
  	 */
 	uint64_t compression_bit_mask;
@@ -96,10 +150,43 @@ struct libqcow_io_handle
  	 */
 	size_t level2_table_size;
 
+	/* The level 2 table slice size
+ 	 */
+	size_t level2_table_slice_size;
+
+	/* The number of slices per level 2 table
+ 	 */
+	uint32_t number_of_level2_table_slices;
+
 	/* The cluster block size
  	 */
 	size_t cluster_block_size;
 
+	/* The subcluster size, which equals the cluster block size
+	 * without extended level 2 table entries
+ 	 */
+	size_t subcluster_size;
+
+	/* The reference count table offset
+	 */
+	off64_t reference_count_table_offset;
+
+	/* The reference count table clusters
+	 */
+	uint32_t reference_count_table_clusters;
+
+	/* The reference count order
+	 */
+	uint32_t reference_count_order;
+
+	/* The number of snapshots
+	 */
+	uint32_t number_of_snapshots;
+
+	/* The snapshots offset
+	 */
+	off64_t snapshots_offset;
+
 	/* The backing filename
 	 */
 	uint8_t *backing_filename;
@@ -107,6 +194,67 @@ struct libqcow_io_handle
 	/* The backing filename size
 	 */
 	size_t backing_filename_size;
+
+	/* The external data filename
+	 */
+	uint8_t *data_filename;
+
+	/* The external data filename size
+	 */
+	size_t data_filename_size;
+
+	/* The feature name table
+	 */
+	uint8_t *feature_name_table;
+
+	/* The feature name table size
+	 */
+	size_t feature_name_table_size;
+
+	/* The number of bitmaps
+	 */
+	uint32_t number_of_bitmaps;
+
+	/* The bitmap directory offset
+	 */
+	off64_t bitmap_directory_offset;
+
+	/* The bitmap directory size
+	 */
+	uint64_t bitmap_directory_size;
+
+	/* The (full disk) encryption header offset
+	 */
+	off64_t encryption_header_offset;
+
+	/* The (full disk) encryption header size
+	 */
+	uint64_t encryption_header_size;
+
+	/* The memory map of the file, this value is not managed by the IO handle
+	 */
+	libqcow_memory_map_t *memory_map;
+
+	/* The level 2 table pool, this value is not managed by the IO handle
+	 */
+	libqcow_cluster_table_pool_t *level2_table_pool;
+
+	/* The cluster block pool, this value is not managed by the IO handle
+	 */
+	libqcow_cluster_block_pool_t *cluster_block_pool;
+
+	/* The NUMA topology, this value is not managed by the IO handle
+	 */
+	libqcow_numa_topology_t *numa_topology;
+
+	/* The cluster block pools per NUMA node, the first node uses the cluster block pool,
+	 * this value is not managed by the IO handle
+	 */
+	libqcow_cluster_block_pool_t **numa_cluster_block_pools;
+
+	/* The statistics, this value is not managed by the IO handle
+	 */
+	libqcow_statistics_t *statistics;
 };
 
 int libqcow_io_handle_initialize(
@@ -121,36 +269,69 @@ int libqcow_io_handle_clear(
      libqcow_io_handle_t *io_handle,
      libcerror_error_t **error );
 
+int libqcow_io_handle_copy(
+     libqcow_io_handle_t *destination_io_handle,
+     const libqcow_io_handle_t *source_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_io_handle_get_cluster_block_pool(
+     libqcow_io_handle_t *io_handle,
+     libqcow_cluster_block_pool_t **cluster_block_pool,
+     libcerror_error_t **error );
+
 int libqcow_io_handle_read_file_header(
      libqcow_io_handle_t *io_handle,
      libbfio_handle_t *file_io_handle,
      uint32_t *encryption_method,
      libcerror_error_t **error );
 
+int libqcow_io_handle_read_header_extensions(
+     libqcow_io_handle_t *io_handle,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size_t extensions_size,
+     libcerror_error_t **error );
+
+int libqcow_io_handle_get_feature_name(
+     libqcow_io_handle_t *io_handle,
+     uint8_t feature_type,
+     uint8_t bit_number,
+     char *name,
+     size_t name_size,
+     libcerror_error_t **error );
+
+int libqcow_io_handle_check_feature_flags(
+     libqcow_io_handle_t *io_handle,
+     libcerror_error_t **error );
+
 int libqcow_io_handle_read_level2_table(
-     intptr_t *data_handle,
+     libqcow_io_handle_t *io_handle,
      libbfio_handle_t *file_io_handle,
-     libfdata_vector_t *vector,
-     libfcache_cache_t *cache,
-     int element_index,
-     int element_data_file_index,
-     off64_t element_data_offset,
-     size64_t element_data_size,
-     uint32_t element_data_flags,
-     uint8_t read_flags,
+     off64_t file_offset,
+     libqcow_cluster_table_t **level2_table,
+     libcerror_error_t **error );
+
+int libqcow_io_handle_read_level2_tables_data(
+     libqcow_io_handle_t *io_handle,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_io_handle_read_level2_table_data(
+     libqcow_io_handle_t *io_handle,
+     const uint8_t *data,
+     size_t data_size,
+     libqcow_cluster_table_t **level2_table,
      libcerror_error_t **error );
 
 int libqcow_io_handle_read_cluster_block(
-     intptr_t *data_handle,
+     libqcow_io_handle_t *io_handle,
      libbfio_handle_t *file_io_handle,
-     libfdata_vector_t *vector,
-     libfcache_cache_t *cache,
-     int element_index,
-     int element_data_file_index,
-     off64_t element_data_offset,
-     size64_t element_data_size,
-     uint32_t element_data_flags,
-     uint8_t read_flags,
+     off64_t file_offset,
+     size_t cluster_block_size,
+     libqcow_cluster_block_t **cluster_block,
      libcerror_error_t **error );
 
 #if defined( __cplusplus )
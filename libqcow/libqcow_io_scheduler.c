@@ -0,0 +1,1029 @@
+/*
+ * IO scheduler functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( WINAPI )
+#include <windows.h>
+
+#elif defined( HAVE_NANOSLEEP )
+#include <time.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_read_request.h"
+#include "libqcow_statistics.h"
+#include "libqcow_unused.h"
+
+/* Retrieves the time in nanoseconds that an amount takes at a specific rate per second
+ * Returns the time in nanoseconds
+ */
+static uint64_t libqcow_io_scheduler_get_cost(
+                 uint64_t amount,
+                 uint64_t rate )
+{
+	/* Split the conversion to prevent the multiplication from overflowing
+	 */
+	return( ( ( amount / rate ) * 1000000000UL )
+	      + ( ( ( amount % rate ) * 1000000000UL ) / rate ) );
+}
+
+/* Retrieves the time in nanoseconds that a queue has to wait before it is within its rate limits
+ * Returns the time in nanoseconds, where 0 represents no wait
+ */
+static uint64_t libqcow_io_scheduler_queue_get_delay(
+                 libqcow_io_scheduler_queue_t *queue,
+                 uint64_t timestamp )
+{
+	uint64_t delay = 0;
+
+	/* Without a timestamp the rate limits cannot be applied
+	 */
+	if( timestamp == 0 )
+	{
+		return( 0 );
+	}
+	if( ( queue->maximum_bytes_per_second != 0 )
+	 && ( queue->bytes_timestamp > ( timestamp + LIBQCOW_IO_SCHEDULER_BURST_TIME ) ) )
+	{
+		delay = queue->bytes_timestamp - ( timestamp + LIBQCOW_IO_SCHEDULER_BURST_TIME );
+	}
+	if( ( queue->maximum_requests_per_second != 0 )
+	 && ( queue->requests_timestamp > ( timestamp + LIBQCOW_IO_SCHEDULER_BURST_TIME ) ) )
+	{
+		if( delay < ( queue->requests_timestamp - ( timestamp + LIBQCOW_IO_SCHEDULER_BURST_TIME ) ) )
+		{
+			delay = queue->requests_timestamp - ( timestamp + LIBQCOW_IO_SCHEDULER_BURST_TIME );
+		}
+	}
+	return( delay );
+}
+
+/* Charges a read to the rate limits of a queue
+ * The rate limits are applied as virtual timestamps that advance with every read,
+ * a queue can run ahead of its timestamps by at most the burst time
+ */
+static void libqcow_io_scheduler_queue_charge(
+             libqcow_io_scheduler_queue_t *queue,
+             uint64_t timestamp,
+             size_t read_size )
+{
+	if( timestamp == 0 )
+	{
+		return;
+	}
+	if( queue->maximum_bytes_per_second != 0 )
+	{
+		if( queue->bytes_timestamp < timestamp )
+		{
+			queue->bytes_timestamp = timestamp;
+		}
+		queue->bytes_timestamp += libqcow_io_scheduler_get_cost(
+		                           (uint64_t) read_size,
+		                           (uint64_t) queue->maximum_bytes_per_second );
+	}
+	if( queue->maximum_requests_per_second != 0 )
+	{
+		if( queue->requests_timestamp < timestamp )
+		{
+			queue->requests_timestamp = timestamp;
+		}
+		queue->requests_timestamp += libqcow_io_scheduler_get_cost(
+		                              1,
+		                              queue->maximum_requests_per_second );
+	}
+}
+
+/* Sleeps for a specific time in nanoseconds
+ * The time is limited to the maximum delay of the IO scheduler
+ * Returns 1 if the thread slept or 0 if not supported
+ */
+static int libqcow_io_scheduler_sleep(
+            uint64_t delay )
+{
+#if defined( WINAPI )
+	DWORD milli_seconds = 0;
+#elif defined( HAVE_NANOSLEEP )
+	struct timespec time_specification;
+#endif
+
+	if( delay > LIBQCOW_IO_SCHEDULER_MAXIMUM_DELAY )
+	{
+		delay = LIBQCOW_IO_SCHEDULER_MAXIMUM_DELAY;
+	}
+#if defined( WINAPI )
+	milli_seconds = (DWORD) ( ( delay + 999999UL ) / 1000000UL );
+
+	Sleep(
+	 milli_seconds );
+
+	return( 1 );
+
+#elif defined( HAVE_NANOSLEEP )
+	time_specification.tv_sec  = (time_t) ( delay / 1000000000UL );
+	time_specification.tv_nsec = (long) ( delay % 1000000000UL );
+
+	/* An interrupted sleep is not resumed, the caller checks again
+	 */
+	nanosleep(
+	 &time_specification,
+	 NULL );
+
+	return( 1 );
+
+#else
+	LIBQCOW_UNREFERENCED_PARAMETER( delay )
+
+	return( 0 );
+#endif
+}
+
+/* Creates an IO scheduler
+ * Make sure the value io_scheduler is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_initialize(
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_scheduler_initialize";
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( *io_scheduler != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid IO scheduler value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*io_scheduler = memory_allocate_structure(
+	                 libqcow_io_scheduler_t );
+
+	if( *io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *io_scheduler,
+	     0,
+	     sizeof( libqcow_io_scheduler_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear IO scheduler.",
+		 function );
+
+		memory_free(
+		 *io_scheduler );
+
+		*io_scheduler = NULL;
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *io_scheduler )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( *io_scheduler != NULL )
+	{
+		memory_free(
+		 *io_scheduler );
+
+		*io_scheduler = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees an IO scheduler
+ * The queued read requests are not owned by the IO scheduler
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_free(
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_scheduler_free";
+	int result            = 1;
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( *io_scheduler != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *io_scheduler )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *io_scheduler );
+
+		*io_scheduler = NULL;
+	}
+	return( result );
+}
+
+/* Retrieves the rate limits of an IO priority
+ * A value of 0 represents no limit
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_get_limits(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size64_t *maximum_bytes_per_second,
+     uint64_t *maximum_requests_per_second,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_scheduler_get_limits";
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( priority < 0 )
+	 || ( priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_bytes_per_second == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum bytes per second.",
+		 function );
+
+		return( -1 );
+	}
+	if( maximum_requests_per_second == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid maximum requests per second.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*maximum_bytes_per_second    = io_scheduler->queues[ priority ].maximum_bytes_per_second;
+	*maximum_requests_per_second = io_scheduler->queues[ priority ].maximum_requests_per_second;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Sets the rate limits of an IO priority
+ * A value of 0 represents no limit
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_set_limits(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size64_t maximum_bytes_per_second,
+     uint64_t maximum_requests_per_second,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_scheduler_set_limits";
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( priority < 0 )
+	 || ( priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	io_scheduler->queues[ priority ].maximum_bytes_per_second    = maximum_bytes_per_second;
+	io_scheduler->queues[ priority ].maximum_requests_per_second = maximum_requests_per_second;
+
+	/* The reads charged under the previous limits do not delay the reads under the new limits
+	 */
+	io_scheduler->queues[ priority ].bytes_timestamp    = 0;
+	io_scheduler->queues[ priority ].requests_timestamp = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the number of queued read requests of an IO priority
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_get_number_of_queued_requests(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     int *number_of_requests,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_scheduler_get_number_of_queued_requests";
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( priority < 0 )
+	 || ( priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_requests == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of requests.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*number_of_requests = io_scheduler->queues[ priority ].number_of_requests;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Pushes a read request onto the queue of its IO priority
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_scheduler_push_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t *request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	libqcow_io_scheduler_queue_t *queue               = NULL;
+	static char *function                             = "libqcow_io_scheduler_push_request";
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+	if( internal_request->priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid read request - unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	queue = &( io_scheduler->queues[ internal_request->priority ] );
+
+	internal_request->next_request = NULL;
+
+	if( queue->last_request == NULL )
+	{
+		queue->first_request = internal_request;
+	}
+	else
+	{
+		queue->last_request->next_request = internal_request;
+	}
+	queue->last_request = internal_request;
+
+	queue->number_of_requests += 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Removes a read request from the queue of its IO priority
+ * Returns 1 if the read request was removed, 0 if it was not queued or -1 on error
+ */
+int libqcow_io_scheduler_remove_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t *request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request  = NULL;
+	libqcow_internal_read_request_t *previous_request  = NULL;
+	libqcow_internal_read_request_t *queued_request    = NULL;
+	libqcow_io_scheduler_queue_t *queue                = NULL;
+	static char *function                              = "libqcow_io_scheduler_remove_request";
+	int result                                         = 0;
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+	if( internal_request->priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES )
+	{
+		return( 0 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	queue = &( io_scheduler->queues[ internal_request->priority ] );
+
+	queued_request = queue->first_request;
+
+	while( queued_request != NULL )
+	{
+		if( queued_request == internal_request )
+		{
+			if( previous_request == NULL )
+			{
+				queue->first_request = queued_request->next_request;
+			}
+			else
+			{
+				previous_request->next_request = queued_request->next_request;
+			}
+			if( queue->last_request == queued_request )
+			{
+				queue->last_request = previous_request;
+			}
+			queue->number_of_requests -= 1;
+
+			internal_request->next_request = NULL;
+
+			result = 1;
+
+			break;
+		}
+		previous_request = queued_request;
+		queued_request   = queued_request->next_request;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     io_scheduler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Pops the next read request to process
+ * This is the first queued read request of the highest IO priority that is within
+ * its rate limits, when all IO priorities with queued read requests exceed their
+ * rate limits this function waits until one of them is within its rate limits
+ * Returns 1 if successful, 0 if no read request was queued or -1 on error
+ */
+int libqcow_io_scheduler_pop_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	libqcow_io_scheduler_queue_t *queue               = NULL;
+	static char *function                             = "libqcow_io_scheduler_pop_request";
+	uint64_t delay                                    = 0;
+	uint64_t minimum_delay                            = 0;
+	uint64_t timestamp                                = 0;
+	int ignore_limits                                 = 0;
+	int priority                                      = 0;
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	do
+	{
+		timestamp = libqcow_statistics_get_timestamp();
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     io_scheduler->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		minimum_delay = 0;
+
+		for( priority = 0;
+		     priority < LIBQCOW_NUMBER_OF_IO_PRIORITIES;
+		     priority++ )
+		{
+			queue = &( io_scheduler->queues[ priority ] );
+
+			if( queue->first_request == NULL )
+			{
+				continue;
+			}
+			delay = 0;
+
+			if( ignore_limits == 0 )
+			{
+				delay = libqcow_io_scheduler_queue_get_delay(
+				         queue,
+				         timestamp );
+			}
+			if( delay == 0 )
+			{
+				internal_request = queue->first_request;
+
+				queue->first_request = internal_request->next_request;
+
+				if( queue->first_request == NULL )
+				{
+					queue->last_request = NULL;
+				}
+				queue->number_of_requests -= 1;
+
+				internal_request->next_request = NULL;
+
+				libqcow_io_scheduler_queue_charge(
+				 queue,
+				 timestamp,
+				 internal_request->buffer_size );
+
+				break;
+			}
+			if( ( minimum_delay == 0 )
+			 || ( delay < minimum_delay ) )
+			{
+				minimum_delay = delay;
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     io_scheduler->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		if( ( internal_request == NULL )
+		 && ( minimum_delay != 0 ) )
+		{
+			/* Without support to sleep the rate limits cannot be applied
+			 */
+			if( libqcow_io_scheduler_sleep(
+			     minimum_delay ) == 0 )
+			{
+				ignore_limits = 1;
+			}
+		}
+	}
+	while( ( internal_request == NULL )
+	    && ( minimum_delay != 0 ) );
+
+	*request = (libqcow_read_request_t *) internal_request;
+
+	if( internal_request == NULL )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Acquires the IO scheduler for a read that is not queued, such as a read-ahead
+ * This function waits while the IO priority exceeds its rate limits or while
+ * read requests of a higher IO priority are queued
+ * Returns 1 if successful, 0 if aborted or -1 on error
+ */
+int libqcow_io_scheduler_acquire(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size_t read_size,
+     int *abort,
+     libcerror_error_t **error )
+{
+	libqcow_io_scheduler_queue_t *queue = NULL;
+	static char *function               = "libqcow_io_scheduler_acquire";
+	uint64_t delay                      = 0;
+	uint64_t timestamp                  = 0;
+	int ignore_limits                   = 0;
+	int higher_priority                 = 0;
+
+	if( io_scheduler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid IO scheduler.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( priority < 0 )
+	 || ( priority >= LIBQCOW_NUMBER_OF_IO_PRIORITIES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported IO priority.",
+		 function );
+
+		return( -1 );
+	}
+	queue = &( io_scheduler->queues[ priority ] );
+
+	do
+	{
+		if( ( abort != NULL )
+		 && ( *abort != 0 ) )
+		{
+			return( 0 );
+		}
+		timestamp = libqcow_statistics_get_timestamp();
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     io_scheduler->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		delay = 0;
+
+		if( ignore_limits == 0 )
+		{
+			delay = libqcow_io_scheduler_queue_get_delay(
+			         queue,
+			         timestamp );
+
+			for( higher_priority = 0;
+			     higher_priority < priority;
+			     higher_priority++ )
+			{
+				if( ( io_scheduler->queues[ higher_priority ].number_of_requests > 0 )
+				 && ( delay < LIBQCOW_IO_SCHEDULER_YIELD_DELAY ) )
+				{
+					delay = LIBQCOW_IO_SCHEDULER_YIELD_DELAY;
+				}
+			}
+		}
+		if( delay == 0 )
+		{
+			libqcow_io_scheduler_queue_charge(
+			 queue,
+			 timestamp,
+			 read_size );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     io_scheduler->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		if( delay != 0 )
+		{
+			/* Without support to sleep the read proceeds regardless
+			 */
+			if( libqcow_io_scheduler_sleep(
+			     delay ) == 0 )
+			{
+				ignore_limits = 1;
+			}
+		}
+	}
+	while( delay != 0 );
+
+	return( 1 );
+}
+
@@ -0,0 +1,143 @@
+/*
+ * IO scheduler functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_IO_SCHEDULER_H )
+#define _LIBQCOW_IO_SCHEDULER_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_read_request.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_io_scheduler_queue libqcow_io_scheduler_queue_t;
+
+/* The read requests of an IO priority are queued in order of submission
+ */
+struct libqcow_io_scheduler_queue
+{
+	/* The first queued read request
+	 */
+	libqcow_internal_read_request_t *first_request;
+
+	/* The last queued read request
+	 */
+	libqcow_internal_read_request_t *last_request;
+
+	/* The number of queued read requests
+	 */
+	int number_of_requests;
+
+	/* The maximum number of bytes per second, where 0 represents no limit
+	 */
+	size64_t maximum_bytes_per_second;
+
+	/* The maximum number of requests per second, where 0 represents no limit
+	 */
+	uint64_t maximum_requests_per_second;
+
+	/* The timestamp up to which the rate of bytes has been used
+	 */
+	uint64_t bytes_timestamp;
+
+	/* The timestamp up to which the rate of requests has been used
+	 */
+	uint64_t requests_timestamp;
+};
+
+typedef struct libqcow_io_scheduler libqcow_io_scheduler_t;
+
+struct libqcow_io_scheduler
+{
+	/* The queues per IO priority
+	 */
+	libqcow_io_scheduler_queue_t queues[ LIBQCOW_NUMBER_OF_IO_PRIORITIES ];
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+int libqcow_io_scheduler_initialize(
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_free(
+     libqcow_io_scheduler_t **io_scheduler,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_get_limits(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size64_t *maximum_bytes_per_second,
+     uint64_t *maximum_requests_per_second,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_set_limits(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size64_t maximum_bytes_per_second,
+     uint64_t maximum_requests_per_second,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_get_number_of_queued_requests(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     int *number_of_requests,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_push_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t *request,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_remove_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t *request,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_pop_request(
+     libqcow_io_scheduler_t *io_scheduler,
+     libqcow_read_request_t **request,
+     libcerror_error_t **error );
+
+int libqcow_io_scheduler_acquire(
+     libqcow_io_scheduler_t *io_scheduler,
+     int priority,
+     size_t read_size,
+     int *abort,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_IO_SCHEDULER_H ) */
+
@@ -0,0 +1,1110 @@
+/*
+ * io_uring asynchronous IO functions
+ * On Windows the asynchronous reads use overlapped IO and an IO completion port
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_ERRNO_H )
+#include <errno.h>
+#endif
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_io_uring.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+
+/* Creates an io_uring
+ * Make sure the value io_uring is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_uring_initialize(
+     libqcow_io_uring_t **io_uring,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_initialize";
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+	if( *io_uring != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid io_uring value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*io_uring = memory_allocate_structure(
+	             libqcow_io_uring_t );
+
+	if( *io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create io_uring.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *io_uring,
+	     0,
+	     sizeof( libqcow_io_uring_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear io_uring.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	( *io_uring )->file_handle     = INVALID_HANDLE_VALUE;
+#endif
+	( *io_uring )->file_descriptor = -1;
+
+	return( 1 );
+
+on_error:
+	if( *io_uring != NULL )
+	{
+		memory_free(
+		 *io_uring );
+
+		*io_uring = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees an io_uring
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_uring_free(
+     libqcow_io_uring_t **io_uring,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_free";
+	int result            = 1;
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+	if( *io_uring != NULL )
+	{
+		if( ( *io_uring )->ring_is_initialized != 0 )
+		{
+			if( libqcow_io_uring_close(
+			     *io_uring,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close io_uring.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *io_uring );
+
+		*io_uring = NULL;
+	}
+	return( result );
+}
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+
+/* Associates an opened file handle with an IO completion port
+ * The file handle must be opened for overlapped IO and is closed on error
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_io_uring_initialize_completion_port(
+            libqcow_io_uring_t *io_uring,
+            HANDLE file_handle,
+            int queue_depth,
+            libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_initialize_completion_port";
+
+	/* A single thread waits for the completions of the reads
+	 */
+	io_uring->completion_port = CreateIoCompletionPort(
+	                             file_handle,
+	                             NULL,
+	                             0,
+	                             1 );
+
+	if( io_uring->completion_port == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create IO completion port with error: %" PRIu32 ".",
+		 function,
+		 (uint32_t) GetLastError() );
+
+		goto on_error;
+	}
+	io_uring->overlapped_reads = (libqcow_io_uring_overlapped_read_t *) memory_allocate(
+	                                                                     sizeof( libqcow_io_uring_overlapped_read_t ) * queue_depth );
+
+	if( io_uring->overlapped_reads == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create overlapped reads.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     io_uring->overlapped_reads,
+	     0,
+	     sizeof( libqcow_io_uring_overlapped_read_t ) * queue_depth ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear overlapped reads.",
+		 function );
+
+		goto on_error;
+	}
+	io_uring->ring_is_initialized = 1;
+	io_uring->file_handle         = file_handle;
+	io_uring->queue_depth         = queue_depth;
+
+	return( 1 );
+
+on_error:
+	if( io_uring->overlapped_reads != NULL )
+	{
+		memory_free(
+		 io_uring->overlapped_reads );
+
+		io_uring->overlapped_reads = NULL;
+	}
+	if( io_uring->completion_port != NULL )
+	{
+		CloseHandle(
+		 io_uring->completion_port );
+
+		io_uring->completion_port = NULL;
+	}
+	CloseHandle(
+	 file_handle );
+
+	return( -1 );
+}
+
+/* Starts an overlapped read of the remainder of a request
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_io_uring_start_overlapped_read(
+            libqcow_io_uring_t *io_uring,
+            libqcow_io_uring_overlapped_read_t *overlapped_read,
+            libqcow_io_uring_request_t *request,
+            libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_start_overlapped_read";
+	size_t read_size      = 0;
+	uint64_t file_offset  = 0;
+	DWORD last_error      = 0;
+
+	if( memory_set(
+	     &( overlapped_read->overlapped ),
+	     0,
+	     sizeof( OVERLAPPED ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear overlapped.",
+		 function );
+
+		return( -1 );
+	}
+	file_offset = (uint64_t) request->file_offset + request->read_size;
+	read_size   = request->buffer_size - request->read_size;
+
+	if( read_size > (size_t) INT32_MAX )
+	{
+		read_size = (size_t) INT32_MAX;
+	}
+	overlapped_read->overlapped.Offset     = (DWORD) ( file_offset & 0xffffffffUL );
+	overlapped_read->overlapped.OffsetHigh = (DWORD) ( file_offset >> 32 );
+	overlapped_read->request               = request;
+
+	/* A read that completes immediately also queues a completion packet
+	 */
+	if( ReadFile(
+	     io_uring->file_handle,
+	     &( request->buffer[ request->read_size ] ),
+	     (DWORD) read_size,
+	     NULL,
+	     &( overlapped_read->overlapped ) ) == 0 )
+	{
+		last_error = GetLastError();
+
+		if( last_error != ERROR_IO_PENDING )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read: %" PRIzd " bytes at offset: 0x%08" PRIx64 " with error: %" PRIu32 ".",
+			 function,
+			 read_size,
+			 file_offset,
+			 (uint32_t) last_error );
+
+			overlapped_read->request = NULL;
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) */
+
+/* Opens a file for asynchronous reading using io_uring
+ * On Windows the file is opened for overlapped IO using an IO completion port
+ * Returns 1 if successful, 0 if io_uring is not available or -1 on error
+ */
+int libqcow_io_uring_open(
+     libqcow_io_uring_t *io_uring,
+     const char *filename,
+     int queue_depth,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_open";
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	HANDLE file_handle    = INVALID_HANDLE_VALUE;
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	int file_descriptor   = -1;
+	int result            = 0;
+#endif
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+	if( io_uring->ring_is_initialized != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid io_uring - ring already initialized.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( queue_depth <= 0 )
+	 || ( queue_depth > LIBQCOW_MAXIMUM_IO_QUEUE_DEPTH ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid queue depth value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	file_handle = CreateFileA(
+	               (LPCSTR) filename,
+	               GENERIC_READ,
+	               FILE_SHARE_READ | FILE_SHARE_WRITE,
+	               NULL,
+	               OPEN_EXISTING,
+	               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+	               NULL );
+
+	if( file_handle == INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		return( -1 );
+	}
+	if( libqcow_io_uring_initialize_completion_port(
+	     io_uring,
+	     file_handle,
+	     queue_depth,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize completion port.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	file_descriptor = open(
+	                   filename,
+	                   O_RDONLY );
+
+	if( file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		return( -1 );
+	}
+	result = io_uring_queue_init(
+	          (unsigned int) queue_depth,
+	          &( io_uring->ring ),
+	          0 );
+
+	/* The kernel can lack io_uring support or have it disabled, in which case
+	 * the file is read using the file IO handle
+	 */
+	if( result != 0 )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: unable to initialize ring with error: %d\n",
+			 function,
+			 -result );
+		}
+#endif
+		close(
+		 file_descriptor );
+
+		return( 0 );
+	}
+	io_uring->ring_is_initialized = 1;
+	io_uring->file_descriptor     = file_descriptor;
+	io_uring->queue_depth         = queue_depth;
+
+	return( 1 );
+#else
+	return( 0 );
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) */
+}
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Opens a file for asynchronous reading
+ * On Windows the file is opened for overlapped IO using an IO completion port,
+ * otherwise asynchronous reading is only available for narrow filenames
+ * Returns 1 if successful, 0 if asynchronous reading is not available or -1 on error
+ */
+int libqcow_io_uring_open_wide(
+     libqcow_io_uring_t *io_uring,
+     const wchar_t *filename,
+     int queue_depth,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_open_wide";
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	HANDLE file_handle    = INVALID_HANDLE_VALUE;
+#endif
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+	if( io_uring->ring_is_initialized != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid io_uring - ring already initialized.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( queue_depth <= 0 )
+	 || ( queue_depth > LIBQCOW_MAXIMUM_IO_QUEUE_DEPTH ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid queue depth value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	file_handle = CreateFileW(
+	               (LPCWSTR) filename,
+	               GENERIC_READ,
+	               FILE_SHARE_READ | FILE_SHARE_WRITE,
+	               NULL,
+	               OPEN_EXISTING,
+	               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+	               NULL );
+
+	if( file_handle == INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %ls.",
+		 function,
+		 filename );
+
+		return( -1 );
+	}
+	if( libqcow_io_uring_initialize_completion_port(
+	     io_uring,
+	     file_handle,
+	     queue_depth,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize completion port.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+#else
+	return( 0 );
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) */
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Closes the file and releases the ring
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_io_uring_close(
+     libqcow_io_uring_t *io_uring,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_io_uring_close";
+	int result            = 0;
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	/* Closing the file handle cancels the reads that are still in flight
+	 */
+	if( io_uring->file_handle != INVALID_HANDLE_VALUE )
+	{
+		if( CloseHandle(
+		     io_uring->file_handle ) == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( io_uring->completion_port != NULL )
+	{
+		if( CloseHandle(
+		     io_uring->completion_port ) == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to close IO completion port.",
+			 function );
+
+			result = -1;
+		}
+	}
+	if( io_uring->overlapped_reads != NULL )
+	{
+		memory_free(
+		 io_uring->overlapped_reads );
+	}
+	io_uring->file_handle      = INVALID_HANDLE_VALUE;
+	io_uring->completion_port  = NULL;
+	io_uring->overlapped_reads = NULL;
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	if( io_uring->ring_is_initialized != 0 )
+	{
+		io_uring_queue_exit(
+		 &( io_uring->ring ) );
+	}
+	if( io_uring->file_descriptor != -1 )
+	{
+		if( close(
+		     io_uring->file_descriptor ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	io_uring->ring_is_initialized = 0;
+	io_uring->file_descriptor     = -1;
+	io_uring->queue_depth         = 0;
+
+	return( result );
+}
+
+/* Reads the data of multiple requests asynchronously
+ * Up to the queue depth reads are in flight at the same time,
+ * a request that is only partially read is resubmitted for the remainder
+ * If the ring can no longer be used it is closed so that subsequent reads
+ * fall back to the file IO handle
+ * On Windows the reads are overlapped reads that complete on the IO completion port
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_io_uring_read_requests(
+     libqcow_io_uring_t *io_uring,
+     libqcow_io_uring_request_t *requests,
+     int number_of_requests,
+     libcerror_error_t **error )
+{
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	libqcow_io_uring_overlapped_read_t *overlapped_read = NULL;
+	libqcow_io_uring_request_t *request                 = NULL;
+	OVERLAPPED *overlapped                              = NULL;
+	ULONG_PTR completion_key                            = 0;
+	DWORD last_error                                    = 0;
+	DWORD number_of_bytes_read                          = 0;
+	int number_of_completed_requests                    = 0;
+	int number_of_pending_reads                         = 0;
+	int overlapped_read_index                           = 0;
+	int port_failed                                     = 0;
+	int request_index                                   = 0;
+	int result                                          = 1;
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	struct io_uring_cqe *completion_queue_entry = NULL;
+	struct io_uring_sqe *submission_queue_entry = NULL;
+	libqcow_io_uring_request_t *request         = NULL;
+	size_t read_size                            = 0;
+	int number_of_completed_requests            = 0;
+	int number_of_pending_entries               = 0;
+	int number_of_queued_entries                = 0;
+	int read_result                             = 0;
+	int request_index                           = 0;
+	int ring_failed                             = 0;
+	int result                                  = 1;
+#endif
+	static char *function                       = "libqcow_io_uring_read_requests";
+
+	if( io_uring == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid io_uring.",
+		 function );
+
+		return( -1 );
+	}
+	if( io_uring->ring_is_initialized == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid io_uring - ring not initialized.",
+		 function );
+
+		return( -1 );
+	}
+	if( requests == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid requests.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_requests < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid number of requests value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) || defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	for( request_index = 0;
+	     request_index < number_of_requests;
+	     request_index++ )
+	{
+		if( ( requests[ request_index ].buffer == NULL )
+		 || ( requests[ request_index ].buffer_size == 0 )
+		 || ( requests[ request_index ].buffer_size > (size_t) SSIZE_MAX )
+		 || ( requests[ request_index ].file_offset < 0 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+			 "%s: invalid request: %d.",
+			 function,
+			 request_index );
+
+			return( -1 );
+		}
+		requests[ request_index ].read_size = 0;
+	}
+	request_index = 0;
+
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) || defined( HAVE_LIBQCOW_IO_URING_SUPPORT ) */
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	while( ( number_of_pending_reads > 0 )
+	    || ( ( result == 1 )
+	     &&  ( number_of_completed_requests < number_of_requests ) ) )
+	{
+		/* Keep the queue filled up to the queue depth, every overlapped read
+		 * that is not in flight is reused for the next request
+		 */
+		while( ( result == 1 )
+		    && ( request_index < number_of_requests )
+		    && ( number_of_pending_reads < io_uring->queue_depth ) )
+		{
+			while( io_uring->overlapped_reads[ overlapped_read_index ].request != NULL )
+			{
+				overlapped_read_index = ( overlapped_read_index + 1 ) % io_uring->queue_depth;
+			}
+			overlapped_read = &( io_uring->overlapped_reads[ overlapped_read_index ] );
+
+			if( libqcow_io_uring_start_overlapped_read(
+			     io_uring,
+			     overlapped_read,
+			     &( requests[ request_index ] ),
+			     error ) != 1 )
+			{
+				result = -1;
+
+				break;
+			}
+			request_index++;
+
+			number_of_pending_reads++;
+		}
+		if( number_of_pending_reads == 0 )
+		{
+			break;
+		}
+		overlapped = NULL;
+
+		if( GetQueuedCompletionStatus(
+		     io_uring->completion_port,
+		     &number_of_bytes_read,
+		     &completion_key,
+		     &overlapped,
+		     INFINITE ) == 0 )
+		{
+			last_error = GetLastError();
+
+			if( overlapped == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to wait for read completion with error: %" PRIu32 ".",
+				 function,
+				 (uint32_t) last_error );
+
+				port_failed = 1;
+
+				break;
+			}
+		}
+		else
+		{
+			last_error = ERROR_SUCCESS;
+		}
+		overlapped_read = (libqcow_io_uring_overlapped_read_t *) overlapped;
+		request         = overlapped_read->request;
+
+		overlapped_read->request = NULL;
+
+		number_of_pending_reads--;
+
+		if( result != 1 )
+		{
+			continue;
+		}
+		if( ( last_error != ERROR_SUCCESS )
+		 || ( number_of_bytes_read == 0 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read: %" PRIzd " bytes at offset: 0x%08" PRIx64 " with error: %" PRIu32 ".",
+			 function,
+			 request->buffer_size - request->read_size,
+			 request->file_offset + request->read_size,
+			 (uint32_t) last_error );
+
+			result = -1;
+
+			continue;
+		}
+		request->read_size += (size_t) number_of_bytes_read;
+
+		if( request->read_size >= request->buffer_size )
+		{
+			number_of_completed_requests++;
+
+			continue;
+		}
+		/* Restart the remainder of a partial read
+		 */
+		if( libqcow_io_uring_start_overlapped_read(
+		     io_uring,
+		     overlapped_read,
+		     request,
+		     error ) != 1 )
+		{
+			result = -1;
+
+			continue;
+		}
+		number_of_pending_reads++;
+	}
+	if( port_failed != 0 )
+	{
+		/* The state of the pending reads is unknown, closing the file
+		 * cancels them before the buffers are released by the caller
+		 */
+		libqcow_io_uring_close(
+		 io_uring,
+		 NULL );
+
+		return( -1 );
+	}
+	return( result );
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	while( ( number_of_pending_entries > 0 )
+	    || ( ( result == 1 )
+	     &&  ( number_of_completed_requests < number_of_requests ) ) )
+	{
+		/* Keep the queue filled up to the queue depth
+		 */
+		while( ( result == 1 )
+		    && ( request_index < number_of_requests )
+		    && ( number_of_pending_entries < io_uring->queue_depth ) )
+		{
+			submission_queue_entry = io_uring_get_sqe(
+			                          &( io_uring->ring ) );
+
+			if( submission_queue_entry == NULL )
+			{
+				break;
+			}
+			request = &( requests[ request_index++ ] );
+
+			read_size = request->buffer_size;
+
+			if( read_size > (size_t) INT32_MAX )
+			{
+				read_size = (size_t) INT32_MAX;
+			}
+			io_uring_prep_read(
+			 submission_queue_entry,
+			 io_uring->file_descriptor,
+			 request->buffer,
+			 (unsigned int) read_size,
+			 (uint64_t) request->file_offset );
+
+			io_uring_sqe_set_data(
+			 submission_queue_entry,
+			 (void *) request );
+
+			number_of_queued_entries++;
+			number_of_pending_entries++;
+		}
+		if( number_of_queued_entries > 0 )
+		{
+			read_result = io_uring_submit(
+			               &( io_uring->ring ) );
+
+			if( read_result < 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to submit reads with error: %d.",
+				 function,
+				 -read_result );
+
+				ring_failed = 1;
+
+				break;
+			}
+			number_of_queued_entries = 0;
+		}
+		read_result = io_uring_wait_cqe(
+		               &( io_uring->ring ),
+		               &completion_queue_entry );
+
+		if( read_result == -EINTR )
+		{
+			continue;
+		}
+		else if( read_result < 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to wait for read completion with error: %d.",
+			 function,
+			 -read_result );
+
+			ring_failed = 1;
+
+			break;
+		}
+		request     = (libqcow_io_uring_request_t *) io_uring_cqe_get_data( completion_queue_entry );
+		read_result = completion_queue_entry->res;
+
+		io_uring_cqe_seen(
+		 &( io_uring->ring ),
+		 completion_queue_entry );
+
+		number_of_pending_entries--;
+
+		if( result != 1 )
+		{
+			continue;
+		}
+		if( read_result <= 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read: %" PRIzd " bytes at offset: 0x%08" PRIx64 " with error: %d.",
+			 function,
+			 request->buffer_size - request->read_size,
+			 request->file_offset + request->read_size,
+			 -read_result );
+
+			result = -1;
+
+			continue;
+		}
+		request->read_size += (size_t) read_result;
+
+		if( request->read_size >= request->buffer_size )
+		{
+			number_of_completed_requests++;
+
+			continue;
+		}
+		/* Resubmit the remainder of a partial read
+		 */
+		submission_queue_entry = io_uring_get_sqe(
+		                          &( io_uring->ring ) );
+
+		if( submission_queue_entry == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve submission queue entry.",
+			 function );
+
+			result = -1;
+
+			continue;
+		}
+		read_size = request->buffer_size - request->read_size;
+
+		if( read_size > (size_t) INT32_MAX )
+		{
+			read_size = (size_t) INT32_MAX;
+		}
+		io_uring_prep_read(
+		 submission_queue_entry,
+		 io_uring->file_descriptor,
+		 &( request->buffer[ request->read_size ] ),
+		 (unsigned int) read_size,
+		 (uint64_t) request->file_offset + request->read_size );
+
+		io_uring_sqe_set_data(
+		 submission_queue_entry,
+		 (void *) request );
+
+		number_of_queued_entries++;
+		number_of_pending_entries++;
+	}
+	if( ring_failed != 0 )
+	{
+		/* The state of the pending reads is unknown, closing the ring
+		 * cancels them before the buffers are released by the caller
+		 */
+		libqcow_io_uring_close(
+		 io_uring,
+		 NULL );
+
+		return( -1 );
+	}
+	return( result );
+#else
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: io_uring support not available.",
+	 function );
+
+	return( -1 );
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) */
+}
+
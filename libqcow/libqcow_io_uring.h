@@ -0,0 +1,167 @@
+/*
+ * io_uring asynchronous IO functions
+ * On Windows the asynchronous reads use overlapped IO and an IO completion port
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_IO_URING_H )
+#define _LIBQCOW_IO_URING_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( WINAPI )
+#define HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT
+
+#elif defined( HAVE_LIBURING )
+#define HAVE_LIBQCOW_IO_URING_SUPPORT
+#endif
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+#include <windows.h>
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+#include <liburing.h>
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_io_uring_request libqcow_io_uring_request_t;
+
+struct libqcow_io_uring_request
+{
+	/* The buffer
+	 */
+	uint8_t *buffer;
+
+	/* The buffer size
+	 */
+	size_t buffer_size;
+
+	/* The file offset
+	 */
+	off64_t file_offset;
+
+	/* The number of bytes read
+	 */
+	size_t read_size;
+};
+
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+
+typedef struct libqcow_io_uring_overlapped_read libqcow_io_uring_overlapped_read_t;
+
+/* An overlapped read that is in flight
+ * The overlapped structure is the first member so that the overlapped read
+ * can be determined from the overlapped structure of a completion packet
+ */
+struct libqcow_io_uring_overlapped_read
+{
+	/* The overlapped structure
+	 */
+	OVERLAPPED overlapped;
+
+	/* The request, NULL if the overlapped read is not in flight
+	 */
+	libqcow_io_uring_request_t *request;
+};
+
+#endif /* defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT ) */
+
+typedef struct libqcow_io_uring libqcow_io_uring_t;
+
+struct libqcow_io_uring
+{
+#if defined( HAVE_LIBQCOW_IO_COMPLETION_PORT_SUPPORT )
+	/* The file handle
+	 */
+	HANDLE file_handle;
+
+	/* The IO completion port
+	 */
+	HANDLE completion_port;
+
+	/* The overlapped reads, one per queue depth
+	 */
+	libqcow_io_uring_overlapped_read_t *overlapped_reads;
+
+#elif defined( HAVE_LIBQCOW_IO_URING_SUPPORT )
+	/* The submission and completion ring
+	 */
+	struct io_uring ring;
+#endif
+
+	/* Value to indicate the ring was initialized
+	 * On Windows this indicates the completion port was initialized
+	 */
+	uint8_t ring_is_initialized;
+
+	/* The file descriptor
+	 */
+	int file_descriptor;
+
+	/* The queue depth
+	 */
+	int queue_depth;
+};
+
+int libqcow_io_uring_initialize(
+     libqcow_io_uring_t **io_uring,
+     libcerror_error_t **error );
+
+int libqcow_io_uring_free(
+     libqcow_io_uring_t **io_uring,
+     libcerror_error_t **error );
+
+int libqcow_io_uring_open(
+     libqcow_io_uring_t *io_uring,
+     const char *filename,
+     int queue_depth,
+     libcerror_error_t **error );
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+int libqcow_io_uring_open_wide(
+     libqcow_io_uring_t *io_uring,
+     const wchar_t *filename,
+     int queue_depth,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+int libqcow_io_uring_close(
+     libqcow_io_uring_t *io_uring,
+     libcerror_error_t **error );
+
+int libqcow_io_uring_read_requests(
+     libqcow_io_uring_t *io_uring,
+     libqcow_io_uring_request_t *requests,
+     int number_of_requests,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_IO_URING_H ) */
+
@@ -0,0 +1,273 @@
+/*
+ * Key cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_key_cache.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_spin_lock.h"
+
+typedef struct libqcow_key_cache_entry libqcow_key_cache_entry_t;
+
+struct libqcow_key_cache_entry
+{
+	/* The identifier
+	 */
+	uint8_t identifier[ LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE ];
+
+	/* The key
+	 */
+	uint8_t key[ LIBQCOW_KEY_CACHE_MAXIMUM_KEY_SIZE ];
+
+	/* The key size, where 0 represents an unused entry
+	 */
+	size_t key_size;
+};
+
+static libqcow_spin_lock_t libqcow_key_cache_lock = 0;
+
+static libqcow_key_cache_entry_t libqcow_key_cache_entries[ LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES ];
+
+/* The index of the entry that is replaced next when the cache is full
+ */
+static int libqcow_key_cache_next_entry_index = 0;
+
+/* Retrieves a key from the cache
+ * Returns 1 if successful, 0 if no such key or -1 on error
+ */
+int libqcow_key_cache_get_key(
+     const uint8_t *identifier,
+     size_t identifier_size,
+     uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error )
+{
+	libqcow_key_cache_entry_t *entry = NULL;
+	static char *function            = "libqcow_key_cache_get_key";
+	int entry_index                  = 0;
+	int result                       = 0;
+
+	if( identifier == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid identifier.",
+		 function );
+
+		return( -1 );
+	}
+	if( identifier_size != LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported identifier size.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( key_size == 0 )
+	 || ( key_size > LIBQCOW_KEY_CACHE_MAXIMUM_KEY_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid key size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	LIBQCOW_SPIN_LOCK_GRAB( libqcow_key_cache_lock );
+
+	for( entry_index = 0;
+	     entry_index < LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES;
+	     entry_index++ )
+	{
+		entry = &( libqcow_key_cache_entries[ entry_index ] );
+
+		if( ( entry->key_size == key_size )
+		 && ( memory_compare(
+		       entry->identifier,
+		       identifier,
+		       LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE ) == 0 ) )
+		{
+			memory_copy(
+			 key,
+			 entry->key,
+			 key_size );
+
+			result = 1;
+
+			break;
+		}
+	}
+	LIBQCOW_SPIN_LOCK_RELEASE( libqcow_key_cache_lock );
+
+	return( result );
+}
+
+/* Sets a key in the cache
+ * An existing key with the same identifier is replaced, otherwise an unused
+ * entry is used or when the cache is full the oldest entry
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_key_cache_set_key(
+     const uint8_t *identifier,
+     size_t identifier_size,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error )
+{
+	libqcow_key_cache_entry_t *entry = NULL;
+	static char *function            = "libqcow_key_cache_set_key";
+	int entry_index                  = 0;
+
+	if( identifier == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid identifier.",
+		 function );
+
+		return( -1 );
+	}
+	if( identifier_size != LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported identifier size.",
+		 function );
+
+		return( -1 );
+	}
+	if( key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid key.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( key_size == 0 )
+	 || ( key_size > LIBQCOW_KEY_CACHE_MAXIMUM_KEY_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid key size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	LIBQCOW_SPIN_LOCK_GRAB( libqcow_key_cache_lock );
+
+	entry = NULL;
+
+	for( entry_index = 0;
+	     entry_index < LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES;
+	     entry_index++ )
+	{
+		if( ( libqcow_key_cache_entries[ entry_index ].key_size != 0 )
+		 && ( memory_compare(
+		       libqcow_key_cache_entries[ entry_index ].identifier,
+		       identifier,
+		       LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE ) == 0 ) )
+		{
+			entry = &( libqcow_key_cache_entries[ entry_index ] );
+
+			break;
+		}
+		if( ( entry == NULL )
+		 && ( libqcow_key_cache_entries[ entry_index ].key_size == 0 ) )
+		{
+			entry = &( libqcow_key_cache_entries[ entry_index ] );
+		}
+	}
+	if( entry == NULL )
+	{
+		entry = &( libqcow_key_cache_entries[ libqcow_key_cache_next_entry_index ] );
+
+		libqcow_key_cache_next_entry_index = ( libqcow_key_cache_next_entry_index + 1 ) % LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES;
+	}
+	memory_set(
+	 entry->key,
+	 0,
+	 LIBQCOW_KEY_CACHE_MAXIMUM_KEY_SIZE );
+
+	memory_copy(
+	 entry->identifier,
+	 identifier,
+	 LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE );
+
+	memory_copy(
+	 entry->key,
+	 key,
+	 key_size );
+
+	entry->key_size = key_size;
+
+	LIBQCOW_SPIN_LOCK_RELEASE( libqcow_key_cache_lock );
+
+	return( 1 );
+}
+
+/* Clears the cache, which removes all keys from memory
+ */
+void libqcow_key_cache_clear(
+      void )
+{
+	LIBQCOW_SPIN_LOCK_GRAB( libqcow_key_cache_lock );
+
+	memory_set(
+	 libqcow_key_cache_entries,
+	 0,
+	 sizeof( libqcow_key_cache_entry_t ) * LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES );
+
+	libqcow_key_cache_next_entry_index = 0;
+
+	LIBQCOW_SPIN_LOCK_RELEASE( libqcow_key_cache_lock );
+}
+
@@ -0,0 +1,65 @@
+/*
+ * Key cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_KEY_CACHE_H )
+#define _LIBQCOW_KEY_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The key cache keeps the master keys that were derived from a password
+ * for the lifetime of the process, so that opening the same encrypted image
+ * again or opening multiple files of a mount does not repeat the deliberately
+ * expensive key derivation
+ */
+#define LIBQCOW_KEY_CACHE_NUMBER_OF_ENTRIES	16
+#define LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE	32
+#define LIBQCOW_KEY_CACHE_MAXIMUM_KEY_SIZE	64
+
+int libqcow_key_cache_get_key(
+     const uint8_t *identifier,
+     size_t identifier_size,
+     uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error );
+
+int libqcow_key_cache_set_key(
+     const uint8_t *identifier,
+     size_t identifier_size,
+     const uint8_t *key,
+     size_t key_size,
+     libcerror_error_t **error );
+
+void libqcow_key_cache_clear(
+      void );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_KEY_CACHE_H ) */
+
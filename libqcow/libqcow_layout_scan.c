@@ -0,0 +1,1538 @@
+/*
+ * Layout scan functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_handle.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_layout_scan.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+/* Creates a layout scan
+ * Make sure the value layout_scan is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_initialize(
+     libqcow_layout_scan_t **layout_scan,
+     libqcow_file_t *file,
+     int number_of_workers,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_layout_scan_initialize";
+	size_t workers_size   = 0;
+	int worker_index      = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	if( *layout_scan != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid layout scan value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_workers <= 0 )
+	 || ( number_of_workers > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of workers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*layout_scan = memory_allocate_structure(
+	                libqcow_layout_scan_t );
+
+	if( *layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create layout scan.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *layout_scan,
+	     0,
+	     sizeof( libqcow_layout_scan_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear layout scan.",
+		 function );
+
+		memory_free(
+		 *layout_scan );
+
+		*layout_scan = NULL;
+
+		return( -1 );
+	}
+	( *layout_scan )->file   = file;
+	( *layout_scan )->result = 1;
+
+	workers_size = sizeof( libqcow_layout_scan_worker_t ) * number_of_workers;
+
+	( *layout_scan )->workers = (libqcow_layout_scan_worker_t *) memory_allocate(
+	                                                              workers_size );
+
+	if( ( *layout_scan )->workers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create workers.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *layout_scan )->workers,
+	     0,
+	     workers_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear workers.",
+		 function );
+
+		goto on_error;
+	}
+	( *layout_scan )->number_of_workers = number_of_workers;
+
+	for( worker_index = 0;
+	     worker_index < number_of_workers;
+	     worker_index++ )
+	{
+		( *layout_scan )->workers[ worker_index ].layout_scan = *layout_scan;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *layout_scan )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( *layout_scan != NULL )
+	{
+		if( ( *layout_scan )->workers != NULL )
+		{
+			memory_free(
+			 ( *layout_scan )->workers );
+		}
+		memory_free(
+		 *layout_scan );
+
+		*layout_scan = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a layout scan
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_free(
+     libqcow_layout_scan_t **layout_scan,
+     libcerror_error_t **error )
+{
+	libqcow_layout_scan_worker_t *worker = NULL;
+	static char *function                = "libqcow_layout_scan_free";
+	int result                           = 1;
+	int worker_index                     = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	if( *layout_scan != NULL )
+	{
+		for( worker_index = 0;
+		     worker_index < ( *layout_scan )->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( ( *layout_scan )->workers[ worker_index ] );
+
+			if( ( worker->reader != NULL )
+			 && ( worker->reader != ( *layout_scan )->file ) )
+			{
+				if( libqcow_file_free(
+				     &( worker->reader ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free reader: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+			if( worker->level2_tables_data != NULL )
+			{
+				memory_free(
+				 worker->level2_tables_data );
+			}
+		}
+		memory_free(
+		 ( *layout_scan )->workers );
+
+		if( ( *layout_scan )->last_cluster_block_offsets != NULL )
+		{
+			memory_free(
+			 ( *layout_scan )->last_cluster_block_offsets );
+		}
+		if( ( *layout_scan )->first_cluster_block_offsets != NULL )
+		{
+			memory_free(
+			 ( *layout_scan )->first_cluster_block_offsets );
+		}
+		if( ( *layout_scan )->level2_table_offsets != NULL )
+		{
+			memory_free(
+			 ( *layout_scan )->level2_table_offsets );
+		}
+		if( ( *layout_scan )->worker_error != NULL )
+		{
+			libcerror_error_free(
+			 &( ( *layout_scan )->worker_error ) );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *layout_scan )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *layout_scan );
+
+		*layout_scan = NULL;
+	}
+	return( result );
+}
+
+/* Sets the number of level 1 table indexes
+ * The level 2 table and cluster block offsets are allocated and cleared
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_set_number_of_level1_table_indexes(
+     libqcow_layout_scan_t *layout_scan,
+     int number_of_level1_table_indexes,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_layout_scan_set_number_of_level1_table_indexes";
+	size_t offsets_size   = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	if( layout_scan->level2_table_offsets != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid layout scan - level 2 table offsets value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_level1_table_indexes <= 0 )
+	 || ( (size_t) number_of_level1_table_indexes > ( (size_t) SSIZE_MAX / sizeof( uint64_t ) ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of level 1 table indexes value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	offsets_size = sizeof( uint64_t ) * number_of_level1_table_indexes;
+
+	layout_scan->level2_table_offsets = (uint64_t *) memory_allocate(
+	                                                  offsets_size );
+
+	if( layout_scan->level2_table_offsets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 table offsets.",
+		 function );
+
+		goto on_error;
+	}
+	layout_scan->first_cluster_block_offsets = (uint64_t *) memory_allocate(
+	                                                         offsets_size );
+
+	if( layout_scan->first_cluster_block_offsets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create first cluster block offsets.",
+		 function );
+
+		goto on_error;
+	}
+	layout_scan->last_cluster_block_offsets = (uint64_t *) memory_allocate(
+	                                                        offsets_size );
+
+	if( layout_scan->last_cluster_block_offsets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create last cluster block offsets.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( memory_set(
+	       layout_scan->level2_table_offsets,
+	       0,
+	       offsets_size ) == NULL )
+	 || ( memory_set(
+	       layout_scan->first_cluster_block_offsets,
+	       0,
+	       offsets_size ) == NULL )
+	 || ( memory_set(
+	       layout_scan->last_cluster_block_offsets,
+	       0,
+	       offsets_size ) == NULL ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear offsets.",
+		 function );
+
+		goto on_error;
+	}
+	layout_scan->number_of_level1_table_indexes = number_of_level1_table_indexes;
+
+	return( 1 );
+
+on_error:
+	if( layout_scan->last_cluster_block_offsets != NULL )
+	{
+		memory_free(
+		 layout_scan->last_cluster_block_offsets );
+
+		layout_scan->last_cluster_block_offsets = NULL;
+	}
+	if( layout_scan->first_cluster_block_offsets != NULL )
+	{
+		memory_free(
+		 layout_scan->first_cluster_block_offsets );
+
+		layout_scan->first_cluster_block_offsets = NULL;
+	}
+	if( layout_scan->level2_table_offsets != NULL )
+	{
+		memory_free(
+		 layout_scan->level2_table_offsets );
+
+		layout_scan->level2_table_offsets = NULL;
+	}
+	return( -1 );
+}
+
+/* Reads the metadata of the file
+ * The active level 1 table is read and the offsets of the level 2 tables
+ * that cover the media are checked against the bounds of the file
+ * This function is not multi-thread safe acquire write lock and the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_read_metadata(
+     libqcow_layout_scan_t *layout_scan,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_table   = NULL;
+	libqcow_internal_file_t *internal_file  = NULL;
+	static char *function                   = "libqcow_layout_scan_read_metadata";
+	uint64_t level2_table_offset            = 0;
+	uint64_t number_of_level1_table_indexes = 0;
+	int level1_table_index                  = 0;
+	int number_of_level1_table_references   = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) layout_scan->file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid layout scan - invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	layout_scan->file_size  = internal_file->size;
+	layout_scan->media_size = internal_file->io_handle->media_size;
+
+	if( ( layout_scan->media_size == 0 )
+	 || ( internal_file->io_handle->level1_table_offset <= 0 )
+	 || ( internal_file->io_handle->level1_table_size == 0 ) )
+	{
+		return( 1 );
+	}
+	if( ( (size64_t) internal_file->io_handle->level1_table_offset >= layout_scan->file_size )
+	 || ( (size64_t) internal_file->io_handle->level1_table_size > ( layout_scan->file_size - (size64_t) internal_file->io_handle->level1_table_offset ) ) )
+	{
+		layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+		return( 1 );
+	}
+	if( libqcow_cluster_table_initialize(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_read(
+	     level1_table,
+	     file_io_handle,
+	     internal_file->io_handle->level1_table_offset,
+	     (size_t) internal_file->io_handle->level1_table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     level1_table,
+	     &number_of_level1_table_references,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of level 1 table references.",
+		 function );
+
+		goto on_error;
+	}
+	/* Only the level 1 table references that cover the media are scanned
+	 */
+	number_of_level1_table_indexes = layout_scan->media_size >> internal_file->io_handle->level1_index_bit_shift;
+
+	if( ( layout_scan->media_size & ~( (uint64_t) -1 << internal_file->io_handle->level1_index_bit_shift ) ) != 0 )
+	{
+		number_of_level1_table_indexes += 1;
+	}
+	if( number_of_level1_table_indexes > (uint64_t) number_of_level1_table_references )
+	{
+		number_of_level1_table_indexes = (uint64_t) number_of_level1_table_references;
+	}
+	if( number_of_level1_table_indexes == 0 )
+	{
+		if( libqcow_cluster_table_free(
+		     &level1_table,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level 1 table.",
+			 function );
+
+			goto on_error;
+		}
+		return( 1 );
+	}
+	if( libqcow_layout_scan_set_number_of_level1_table_indexes(
+	     layout_scan,
+	     (int) number_of_level1_table_indexes,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set number of level 1 table indexes.",
+		 function );
+
+		goto on_error;
+	}
+	for( level1_table_index = 0;
+	     level1_table_index < layout_scan->number_of_level1_table_indexes;
+	     level1_table_index++ )
+	{
+		if( libqcow_cluster_table_get_reference_by_index(
+		     level1_table,
+		     level1_table_index,
+		     &level2_table_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve level 1 table reference: %d.",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		level2_table_offset &= internal_file->io_handle->offset_bit_mask;
+
+		if( level2_table_offset == 0 )
+		{
+			continue;
+		}
+		if( ( level2_table_offset >= layout_scan->file_size )
+		 || ( (size64_t) internal_file->io_handle->level2_table_size > ( layout_scan->file_size - level2_table_offset ) )
+		 || ( ( internal_file->io_handle->format_version != 1 )
+		  && ( ( level2_table_offset & internal_file->io_handle->cluster_block_bit_mask ) != 0 ) ) )
+		{
+			layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+			continue;
+		}
+		layout_scan->level2_table_offsets[ level1_table_index ] = level2_table_offset;
+
+		layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_LEVEL2_TABLES ] += 1;
+	}
+	if( libqcow_cluster_table_free(
+	     &level1_table,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( level1_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &level1_table,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Retrieves the next run of level 2 tables to scan
+ * A run consists of the level 2 tables of consecutive level 1 table indexes
+ * that are adjacent in the file, that are read at once, of up to
+ * LIBQCOW_LAYOUT_SCAN_MAXIMUM_READ_SIZE bytes
+ * Returns 1 if successful, 0 if no level 2 tables are left or -1 on error
+ */
+int libqcow_layout_scan_get_next_level2_tables(
+     libqcow_layout_scan_t *layout_scan,
+     int *level1_table_index,
+     int *number_of_level2_tables,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_layout_scan_get_next_level2_tables";
+	size_t level2_table_size               = 0;
+	size_t read_size                       = 0;
+	int end_index                          = 0;
+	int result                             = 0;
+	int start_index                        = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	if( level1_table_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 1 table index.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_level2_tables == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file     = (libqcow_internal_file_t *) layout_scan->file;
+	level2_table_size = internal_file->io_handle->level2_table_size;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     layout_scan->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( layout_scan->abort == 0 )
+	{
+		start_index = layout_scan->next_level1_table_index;
+
+		while( ( start_index < layout_scan->number_of_level1_table_indexes )
+		    && ( layout_scan->level2_table_offsets[ start_index ] == 0 ) )
+		{
+			start_index++;
+		}
+		if( start_index < layout_scan->number_of_level1_table_indexes )
+		{
+			end_index = start_index + 1;
+			read_size = level2_table_size;
+
+			while( ( end_index < layout_scan->number_of_level1_table_indexes )
+			    && ( layout_scan->level2_table_offsets[ end_index ] == ( layout_scan->level2_table_offsets[ end_index - 1 ] + level2_table_size ) )
+			    && ( ( read_size + level2_table_size ) <= (size_t) LIBQCOW_LAYOUT_SCAN_MAXIMUM_READ_SIZE ) )
+			{
+				read_size += level2_table_size;
+
+				end_index++;
+			}
+			*level1_table_index      = start_index;
+			*number_of_level2_tables = end_index - start_index;
+
+			result = 1;
+		}
+		else
+		{
+			end_index = start_index;
+		}
+		layout_scan->next_level1_table_index = end_index;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     layout_scan->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Scans a level 2 table
+ * The entries are classified in the same order as libqcow_file_sample,
+ * compressed before zero before sparse. A host run ends at every entry that
+ * does not reference the cluster block that follows the previous one
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_scan_level2_table(
+     libqcow_layout_scan_worker_t *worker,
+     int level1_table_index,
+     const uint8_t *level2_table_data,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file   = NULL;
+	libqcow_layout_scan_t *layout_scan       = NULL;
+	static char *function                    = "libqcow_layout_scan_scan_level2_table";
+	uint64_t cluster_block_file_offset       = 0;
+	uint64_t cluster_block_reference         = 0;
+	uint64_t compressed_cluster_block_offset = 0;
+	uint64_t media_offset                    = 0;
+	uint64_t previous_cluster_block_offset   = 0;
+	uint64_t size                            = 0;
+	size_t compressed_cluster_block_size     = 0;
+	int entry_stride                         = 0;
+	int has_external_data_file               = 0;
+	int level2_table_index                   = 0;
+	int number_of_level2_table_references    = 0;
+
+	if( worker == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid worker.",
+		 function );
+
+		return( -1 );
+	}
+	if( worker->layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid worker - missing layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	layout_scan = worker->layout_scan;
+
+	if( ( level1_table_index < 0 )
+	 || ( level1_table_index >= layout_scan->number_of_level1_table_indexes ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( level2_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid level 2 table data.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) layout_scan->file;
+
+	number_of_level2_table_references = (int) ( internal_file->io_handle->level2_table_size / 8 );
+
+	/* An extended level 2 table entry is followed by its subcluster bitmap
+	 */
+	entry_stride = 1 << ( internal_file->io_handle->number_of_level2_table_entry_bits - 3 );
+
+	/* The clusters of an external data file are not part of the file
+	 */
+	if( ( internal_file->io_handle->incompatible_feature_flags & LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_EXTERNAL_DATA_FILE ) != 0 )
+	{
+		has_external_data_file = 1;
+	}
+	media_offset = (uint64_t) level1_table_index << internal_file->io_handle->level1_index_bit_shift;
+
+	for( level2_table_index = 0;
+	     level2_table_index < number_of_level2_table_references;
+	     level2_table_index += entry_stride )
+	{
+		if( media_offset >= layout_scan->media_size )
+		{
+			break;
+		}
+		size = layout_scan->media_size - media_offset;
+
+		if( size > (uint64_t) internal_file->io_handle->cluster_block_size )
+		{
+			size = (uint64_t) internal_file->io_handle->cluster_block_size;
+		}
+		media_offset += internal_file->io_handle->cluster_block_size;
+
+		byte_stream_copy_to_uint64_big_endian(
+		 &( level2_table_data[ level2_table_index * 8 ] ),
+		 cluster_block_reference );
+
+		cluster_block_file_offset = 0;
+
+		if( ( cluster_block_reference & internal_file->io_handle->compression_flag_bit_mask ) != 0 )
+		{
+			compressed_cluster_block_offset = ( cluster_block_reference & internal_file->io_handle->offset_bit_mask )
+			                                & internal_file->io_handle->compression_bit_mask;
+
+			if( compressed_cluster_block_offset >= layout_scan->file_size )
+			{
+				worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+			}
+			else
+			{
+				if( libqcow_internal_file_get_compressed_cluster_block_range(
+				     internal_file,
+				     cluster_block_reference & internal_file->io_handle->offset_bit_mask,
+				     &compressed_cluster_block_offset,
+				     &compressed_cluster_block_size,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve compressed cluster block range.",
+					 function );
+
+					return( -1 );
+				}
+				/* The compressed size of the last compressed cluster block can extend beyond the end of the file
+				 */
+				if( (size64_t) compressed_cluster_block_size > ( layout_scan->file_size - compressed_cluster_block_offset ) )
+				{
+					compressed_cluster_block_size = (size_t) ( layout_scan->file_size - compressed_cluster_block_offset );
+				}
+				worker->values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_SIZE ]      += size;
+				worker->values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_DATA_SIZE ] += (uint64_t) compressed_cluster_block_size;
+			}
+		}
+		else if( ( cluster_block_reference & internal_file->io_handle->zero_flag_bit_mask ) != 0 )
+		{
+			worker->values[ LIBQCOW_LAYOUT_VALUE_ZERO_SIZE ] += size;
+		}
+		else
+		{
+			cluster_block_file_offset = cluster_block_reference
+			                          & internal_file->io_handle->offset_bit_mask
+			                          & ~( internal_file->io_handle->cluster_block_bit_mask );
+
+			if( ( cluster_block_file_offset != 0 )
+			 && ( has_external_data_file == 0 )
+			 && ( cluster_block_file_offset >= layout_scan->file_size ) )
+			{
+				worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] += 1;
+
+				cluster_block_file_offset = 0;
+			}
+			else if( cluster_block_file_offset != 0 )
+			{
+				worker->values[ LIBQCOW_LAYOUT_VALUE_ALLOCATED_SIZE ] += size;
+
+				if( ( previous_cluster_block_offset == 0 )
+				 || ( cluster_block_file_offset != ( previous_cluster_block_offset + internal_file->io_handle->cluster_block_size ) ) )
+				{
+					worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ] += 1;
+				}
+			}
+		}
+		if( level2_table_index == 0 )
+		{
+			layout_scan->first_cluster_block_offsets[ level1_table_index ] = cluster_block_file_offset;
+		}
+		previous_cluster_block_offset = cluster_block_file_offset;
+	}
+	/* Only a level 2 table of which all entries were scanned can continue a host run in the next one
+	 */
+	if( level2_table_index >= number_of_level2_table_references )
+	{
+		layout_scan->last_cluster_block_offsets[ level1_table_index ] = previous_cluster_block_offset;
+	}
+	return( 1 );
+}
+
+/* Runs a worker of a layout scan
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_worker_run(
+     libqcow_layout_scan_t *layout_scan,
+     int worker_index,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle       = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_layout_scan_worker_t *worker   = NULL;
+	static char *function                  = "libqcow_layout_scan_worker_run";
+	size_t level2_table_size               = 0;
+	size_t read_size                       = 0;
+	ssize_t read_count                     = 0;
+	uint64_t first_level2_table_offset     = 0;
+	int index                              = 0;
+	int level1_table_index                 = 0;
+	int number_of_level2_tables            = 0;
+	int result                             = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( worker_index < 0 )
+	 || ( worker_index >= layout_scan->number_of_workers ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid worker index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	worker            = &( layout_scan->workers[ worker_index ] );
+	internal_file     = (libqcow_internal_file_t *) layout_scan->file;
+	file_io_handle    = ( (libqcow_internal_file_t *) worker->reader )->file_io_handle;
+	level2_table_size = internal_file->io_handle->level2_table_size;
+
+	if( libqcow_internal_file_get_io_scheduler(
+	     (libqcow_internal_file_t *) worker->reader,
+	     &( worker->io_scheduler ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	do
+	{
+		if( internal_file->abort != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_ABORT_REQUESTED,
+			 "%s: abort requested.",
+			 function );
+
+			goto on_error;
+		}
+		result = libqcow_layout_scan_get_next_level2_tables(
+		          layout_scan,
+		          &level1_table_index,
+		          &number_of_level2_tables,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve next level 2 tables.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		first_level2_table_offset = layout_scan->level2_table_offsets[ level1_table_index ];
+
+		read_size = level2_table_size * number_of_level2_tables;
+
+		/* The level 2 tables are background IO, they yield to queued read requests
+		 * and are subject to the IO limits of the background IO priority
+		 */
+		result = libqcow_io_scheduler_acquire(
+		          worker->io_scheduler,
+		          LIBQCOW_IO_PRIORITY_BACKGROUND,
+		          read_size,
+		          &( layout_scan->abort ),
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to acquire IO scheduler.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              worker->level2_tables_data,
+		              read_size,
+		              (off64_t) first_level2_table_offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 tables at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+			 function,
+			 first_level2_table_offset,
+			 first_level2_table_offset );
+
+			goto on_error;
+		}
+		for( index = 0;
+		     index < number_of_level2_tables;
+		     index++ )
+		{
+			if( libqcow_layout_scan_scan_level2_table(
+			     worker,
+			     level1_table_index + index,
+			     &( worker->level2_tables_data[ level2_table_size * index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to scan level 2 table: %d.",
+				 function,
+				 level1_table_index + index );
+
+				goto on_error;
+			}
+		}
+	}
+	while( result == 1 );
+
+	return( 1 );
+
+on_error:
+	libqcow_layout_scan_stop(
+	 layout_scan,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Stops the workers of a layout scan because of an error
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_stop(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_layout_scan_stop";
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     layout_scan->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	layout_scan->abort  = 1;
+	layout_scan->result = -1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     layout_scan->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Keeps the error of the first worker that failed
+ * The error is freed if the error of another worker was kept
+ */
+void libqcow_layout_scan_set_worker_error(
+      libqcow_layout_scan_t *layout_scan,
+      libcerror_error_t **worker_error )
+{
+	if( ( layout_scan == NULL )
+	 || ( worker_error == NULL )
+	 || ( *worker_error == NULL ) )
+	{
+		return;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 *worker_error );
+	}
+#endif
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     layout_scan->mutex,
+	     NULL ) != 1 )
+	{
+		libcerror_error_free(
+		 worker_error );
+
+		return;
+	}
+#endif
+	if( layout_scan->worker_error == NULL )
+	{
+		layout_scan->worker_error = *worker_error;
+		*worker_error             = NULL;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_mutex_release(
+	 layout_scan->mutex,
+	 NULL );
+#endif
+	if( *worker_error != NULL )
+	{
+		libcerror_error_free(
+		 worker_error );
+	}
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_layout_scan_worker_t *worker = NULL;
+	int result                           = 0;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	worker = (libqcow_layout_scan_worker_t *) arguments;
+
+	result = libqcow_layout_scan_worker_run(
+	          worker->layout_scan,
+	          (int) ( worker - worker->layout_scan->workers ),
+	          &error );
+
+	if( result != 1 )
+	{
+		libqcow_layout_scan_set_worker_error(
+		 worker->layout_scan,
+		 &error );
+	}
+	return( result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Runs the workers of a layout scan
+ * Every worker reads using its own reader of the file, the first worker
+ * runs in the calling thread and the other workers in their own thread
+ * The values determined by the workers are added to the values of the layout scan
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_run(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *worker_error        = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_layout_scan_worker_t *worker   = NULL;
+	static char *function                  = "libqcow_layout_scan_run";
+	size_t level2_tables_data_size         = 0;
+	int number_of_level2_tables            = 0;
+	int value_index                        = 0;
+	int worker_index                       = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int number_of_threads                  = 0;
+#endif
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_level2_tables = (int) layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_LEVEL2_TABLES ];
+
+	if( number_of_level2_tables == 0 )
+	{
+		return( 1 );
+	}
+	internal_file = (libqcow_internal_file_t *) layout_scan->file;
+
+	level2_tables_data_size = (size_t) LIBQCOW_LAYOUT_SCAN_MAXIMUM_READ_SIZE;
+
+	if( level2_tables_data_size < internal_file->io_handle->level2_table_size )
+	{
+		level2_tables_data_size = internal_file->io_handle->level2_table_size;
+	}
+	/* Every level 2 table is scanned by a single worker, there is no use
+	 * for more workers than level 2 tables
+	 */
+	if( layout_scan->number_of_workers > number_of_level2_tables )
+	{
+		layout_scan->number_of_workers = number_of_level2_tables;
+	}
+	for( worker_index = 0;
+	     worker_index < layout_scan->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( layout_scan->workers[ worker_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libqcow_file_clone_reader(
+		     layout_scan->file,
+		     &( worker->reader ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create reader: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+#else
+		worker->reader = layout_scan->file;
+#endif
+		worker->level2_tables_data = (uint8_t *) memory_allocate(
+		                                          sizeof( uint8_t ) * level2_tables_data_size );
+
+		if( worker->level2_tables_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create level 2 tables data: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( number_of_threads = 1;
+	     number_of_threads < layout_scan->number_of_workers;
+	     number_of_threads++ )
+	{
+		worker = &( layout_scan->workers[ number_of_threads ] );
+
+		if( libcthreads_thread_create(
+		     &( worker->thread ),
+		     NULL,
+		     &libqcow_layout_scan_thread_function,
+		     (void *) worker,
+		     &worker_error ) != 1 )
+		{
+			libcerror_error_set(
+			 &worker_error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread: %d.",
+			 function,
+			 number_of_threads );
+
+			libqcow_layout_scan_set_worker_error(
+			 layout_scan,
+			 &worker_error );
+
+			libqcow_layout_scan_stop(
+			 layout_scan,
+			 NULL );
+
+			break;
+		}
+	}
+#endif
+	if( libqcow_layout_scan_worker_run(
+	     layout_scan,
+	     0,
+	     &worker_error ) != 1 )
+	{
+		libqcow_layout_scan_set_worker_error(
+		 layout_scan,
+		 &worker_error );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( worker_index = 1;
+	     worker_index < number_of_threads;
+	     worker_index++ )
+	{
+		worker = &( layout_scan->workers[ worker_index ] );
+
+		if( libcthreads_thread_join(
+		     &( worker->thread ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread: %d.",
+			 function,
+			 worker_index );
+
+			layout_scan->result = -1;
+		}
+	}
+#endif
+	if( layout_scan->result == -1 )
+	{
+		/* The error of the worker that failed is passed to the caller
+		 */
+		if( ( error != NULL )
+		 && ( *error == NULL ) )
+		{
+			*error                    = layout_scan->worker_error;
+			layout_scan->worker_error = NULL;
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to scan level 2 tables.",
+		 function );
+
+		return( -1 );
+	}
+	for( worker_index = 0;
+	     worker_index < layout_scan->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( layout_scan->workers[ worker_index ] );
+
+		for( value_index = 0;
+		     value_index < LIBQCOW_NUMBER_OF_LAYOUT_VALUES;
+		     value_index++ )
+		{
+			layout_scan->values[ value_index ] += worker->values[ value_index ];
+		}
+	}
+	return( 1 );
+}
+
+/* Merges the host runs that continue from a level 2 table in the next one
+ * and determines the sparse size, which is the part of the media that is
+ * not allocated, compressed or zero
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_layout_scan_merge_host_runs(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_layout_scan_merge_host_runs";
+	uint64_t stored_size                   = 0;
+	int level1_table_index                 = 0;
+
+	if( layout_scan == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout scan.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) layout_scan->file;
+
+	for( level1_table_index = 1;
+	     level1_table_index < layout_scan->number_of_level1_table_indexes;
+	     level1_table_index++ )
+	{
+		if( ( layout_scan->last_cluster_block_offsets[ level1_table_index - 1 ] != 0 )
+		 && ( layout_scan->first_cluster_block_offsets[ level1_table_index ] == ( layout_scan->last_cluster_block_offsets[ level1_table_index - 1 ] + internal_file->io_handle->cluster_block_size ) )
+		 && ( layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ] > 0 ) )
+		{
+			layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ] -= 1;
+		}
+	}
+	stored_size = layout_scan->values[ LIBQCOW_LAYOUT_VALUE_ALLOCATED_SIZE ]
+	            + layout_scan->values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_SIZE ]
+	            + layout_scan->values[ LIBQCOW_LAYOUT_VALUE_ZERO_SIZE ];
+
+	if( stored_size < layout_scan->media_size )
+	{
+		layout_scan->values[ LIBQCOW_LAYOUT_VALUE_SPARSE_SIZE ] = layout_scan->media_size - stored_size;
+	}
+	else
+	{
+		layout_scan->values[ LIBQCOW_LAYOUT_VALUE_SPARSE_SIZE ] = 0;
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,212 @@
+/*
+ * Layout scan functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_LAYOUT_SCAN_H )
+#define _LIBQCOW_LAYOUT_SCAN_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_layout_scan libqcow_layout_scan_t;
+typedef struct libqcow_layout_scan_worker libqcow_layout_scan_worker_t;
+
+/* A worker scans level 2 tables using its own reader of the file
+ */
+struct libqcow_layout_scan_worker
+{
+	/* The layout scan
+	 */
+	libqcow_layout_scan_t *layout_scan;
+
+	/* The reader
+	 */
+	libqcow_file_t *reader;
+
+	/* The IO scheduler of the reader
+	 */
+	libqcow_io_scheduler_t *io_scheduler;
+
+	/* The data of the level 2 tables that are read at once
+	 */
+	uint8_t *level2_tables_data;
+
+	/* The values determined by the worker
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_LAYOUT_VALUES ];
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+#endif
+};
+
+/* The active level 1 table is read first, the level 2 tables it references are
+ * taken by the workers in runs of level 1 table indexes of which the level 2
+ * tables are adjacent in the file, so that the metadata is read in large
+ * sequential reads. The host runs are counted per level 2 table and the host
+ * runs that continue in the next level 2 table are merged afterwards
+ */
+struct libqcow_layout_scan
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The size of the file
+	 */
+	size64_t file_size;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The offsets of the level 2 tables by level 1 table index
+	 * 0 if the level 2 table is not allocated
+	 */
+	uint64_t *level2_table_offsets;
+
+	/* The file offset of the first cluster block of a level 2 table by level 1 table index
+	 * 0 if the first level 2 table entry does not reference an allocated cluster block
+	 */
+	uint64_t *first_cluster_block_offsets;
+
+	/* The file offset of the last cluster block of a level 2 table by level 1 table index
+	 * 0 if the last level 2 table entry does not reference an allocated cluster block
+	 */
+	uint64_t *last_cluster_block_offsets;
+
+	/* The number of level 1 table indexes
+	 */
+	int number_of_level1_table_indexes;
+
+	/* The next level 1 table index to take
+	 */
+	int next_level1_table_index;
+
+	/* The values
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_LAYOUT_VALUES ];
+
+	/* The workers
+	 */
+	libqcow_layout_scan_worker_t *workers;
+
+	/* The number of workers
+	 */
+	int number_of_workers;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+	/* The result, 1 if completed or -1 on error
+	 */
+	int result;
+
+	/* The error of the first worker that failed
+	 */
+	libcerror_error_t *worker_error;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+int libqcow_layout_scan_initialize(
+     libqcow_layout_scan_t **layout_scan,
+     libqcow_file_t *file,
+     int number_of_workers,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_free(
+     libqcow_layout_scan_t **layout_scan,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_set_number_of_level1_table_indexes(
+     libqcow_layout_scan_t *layout_scan,
+     int number_of_level1_table_indexes,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_read_metadata(
+     libqcow_layout_scan_t *layout_scan,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_get_next_level2_tables(
+     libqcow_layout_scan_t *layout_scan,
+     int *level1_table_index,
+     int *number_of_level2_tables,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_scan_level2_table(
+     libqcow_layout_scan_worker_t *worker,
+     int level1_table_index,
+     const uint8_t *level2_table_data,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_worker_run(
+     libqcow_layout_scan_t *layout_scan,
+     int worker_index,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_stop(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error );
+
+void libqcow_layout_scan_set_worker_error(
+      libqcow_layout_scan_t *layout_scan,
+      libcerror_error_t **worker_error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_layout_scan_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_layout_scan_run(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error );
+
+int libqcow_layout_scan_merge_host_runs(
+     libqcow_layout_scan_t *layout_scan,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_LAYOUT_SCAN_H ) */
+
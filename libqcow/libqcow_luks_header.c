@@ -0,0 +1,1662 @@
+/*
+ * LUKS header functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_encryption.h"
+#include "libqcow_hash.h"
+#include "libqcow_key_cache.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_luks_header.h"
+
+#include "qcow_luks_header.h"
+
+/* The LUKS header signature
+ */
+const uint8_t qcow_luks_header_signature[ 6 ] = { 'L', 'U', 'K', 'S', 0xba, 0xbe };
+
+/* Determines the length of a string stored in a fixed size field
+ * Returns the length of the string
+ */
+static size_t libqcow_luks_header_get_string_length(
+               const uint8_t *string,
+               size_t string_size )
+{
+	size_t string_length = 0;
+
+	while( ( string_length < string_size )
+	    && ( string[ string_length ] != 0 ) )
+	{
+		string_length++;
+	}
+	return( string_length );
+}
+
+/* Creates a LUKS header
+ * Make sure the value luks_header is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_luks_header_initialize(
+     libqcow_luks_header_t **luks_header,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_luks_header_initialize";
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( *luks_header != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid LUKS header value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*luks_header = memory_allocate_structure(
+	                libqcow_luks_header_t );
+
+	if( *luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create LUKS header.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *luks_header,
+	     0,
+	     sizeof( libqcow_luks_header_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear LUKS header.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( *luks_header != NULL )
+	{
+		memory_free(
+		 *luks_header );
+
+		*luks_header = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a LUKS header
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_luks_header_free(
+     libqcow_luks_header_t **luks_header,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_luks_header_free";
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( *luks_header != NULL )
+	{
+		if( ( *luks_header )->data != NULL )
+		{
+			memory_set(
+			 ( *luks_header )->data,
+			 0,
+			 ( *luks_header )->data_size );
+
+			memory_free(
+			 ( *luks_header )->data );
+		}
+		memory_free(
+		 *luks_header );
+
+		*luks_header = NULL;
+	}
+	return( 1 );
+}
+
+/* Reads a LUKS header
+ * The data contains the header followed by the key material of the key slots
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_luks_header_read_data(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	const qcow_luks_key_slot_t *key_slot_data = NULL;
+	libqcow_luks_key_slot_t *key_slot         = NULL;
+	static char *function                     = "libqcow_luks_header_read_data";
+	size_t string_length                      = 0;
+	uint64_t key_material_end_offset          = 0;
+	int key_slot_index                        = 0;
+	int result                                = 0;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( luks_header->data != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid LUKS header - data value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size < sizeof( qcow_luks_header_t ) )
+	 || ( data_size > (size_t) LIBQCOW_LUKS_MAXIMUM_HEADER_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: LUKS header data:\n",
+		 function );
+		libcnotify_print_data(
+		 data,
+		 sizeof( qcow_luks_header_t ),
+		 0 );
+	}
+#endif
+	if( memory_compare(
+	     ( (qcow_luks_header_t *) data )->signature,
+	     qcow_luks_header_signature,
+	     6 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: invalid LUKS header signature.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_to_uint16_big_endian(
+	 ( (qcow_luks_header_t *) data )->format_version,
+	 luks_header->format_version );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_luks_header_t *) data )->key_size,
+	 luks_header->key_size );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_luks_header_t *) data )->master_key_digest_number_of_iterations,
+	 luks_header->master_key_digest_number_of_iterations );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: format version\t\t\t: %" PRIu16 "\n",
+		 function,
+		 luks_header->format_version );
+
+		libcnotify_printf(
+		 "%s: key size\t\t\t\t: %" PRIu32 "\n",
+		 function,
+		 luks_header->key_size );
+
+		libcnotify_printf(
+		 "%s: master key digest iterations\t: %" PRIu32 "\n",
+		 function,
+		 luks_header->master_key_digest_number_of_iterations );
+
+		libcnotify_printf(
+		 "\n" );
+	}
+#endif
+	/* QEMU only creates LUKS version 1 headers in QCOW images
+	 */
+	if( luks_header->format_version != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported LUKS format version: %" PRIu16 ".",
+		 function,
+		 luks_header->format_version );
+
+		return( -1 );
+	}
+	string_length = libqcow_luks_header_get_string_length(
+	                 ( (qcow_luks_header_t *) data )->cipher_name,
+	                 32 );
+
+	if( ( string_length != 3 )
+	 || ( memory_compare(
+	       ( (qcow_luks_header_t *) data )->cipher_name,
+	       "aes",
+	       3 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported LUKS cipher name.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = libqcow_luks_header_get_string_length(
+	                 ( (qcow_luks_header_t *) data )->cipher_mode,
+	                 32 );
+
+	if( ( string_length != 11 )
+	 || ( memory_compare(
+	       ( (qcow_luks_header_t *) data )->cipher_mode,
+	       "xts-plain64",
+	       11 ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported LUKS cipher mode.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = libqcow_luks_header_get_string_length(
+	                 ( (qcow_luks_header_t *) data )->hash_specification,
+	                 32 );
+
+	result = libqcow_hash_get_type_from_name(
+	          (char *) ( (qcow_luks_header_t *) data )->hash_specification,
+	          string_length,
+	          &( luks_header->hash_type ),
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve hash type.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported LUKS hash specification.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( luks_header->key_size != 32 )
+	 && ( luks_header->key_size != 64 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported LUKS key size: %" PRIu32 ".",
+		 function,
+		 luks_header->key_size );
+
+		return( -1 );
+	}
+	if( luks_header->master_key_digest_number_of_iterations == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid master key digest number of iterations value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     luks_header->master_key_digest,
+	     ( (qcow_luks_header_t *) data )->master_key_digest,
+	     20 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy master key digest.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     luks_header->master_key_digest_salt,
+	     ( (qcow_luks_header_t *) data )->master_key_digest_salt,
+	     32 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy master key digest salt.",
+		 function );
+
+		return( -1 );
+	}
+	for( key_slot_index = 0;
+	     key_slot_index < LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS;
+	     key_slot_index++ )
+	{
+		key_slot_data = &( ( (qcow_luks_header_t *) data )->key_slots[ key_slot_index ] );
+		key_slot      = &( luks_header->key_slots[ key_slot_index ] );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 key_slot_data->state,
+		 key_slot->state );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 key_slot_data->number_of_iterations,
+		 key_slot->number_of_iterations );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 key_slot_data->key_material_offset,
+		 key_slot->key_material_offset );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 key_slot_data->number_of_stripes,
+		 key_slot->number_of_stripes );
+
+		if( memory_copy(
+		     key_slot->salt,
+		     key_slot_data->salt,
+		     32 ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy key slot: %d salt.",
+			 function,
+			 key_slot_index );
+
+			return( -1 );
+		}
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: key slot: %d state\t\t\t: 0x%08" PRIx32 "\n",
+			 function,
+			 key_slot_index,
+			 key_slot->state );
+
+			libcnotify_printf(
+			 "%s: key slot: %d iterations\t\t: %" PRIu32 "\n",
+			 function,
+			 key_slot_index,
+			 key_slot->number_of_iterations );
+
+			libcnotify_printf(
+			 "%s: key slot: %d key material offset\t: %" PRIu32 "\n",
+			 function,
+			 key_slot_index,
+			 key_slot->key_material_offset );
+
+			libcnotify_printf(
+			 "%s: key slot: %d number of stripes\t: %" PRIu32 "\n",
+			 function,
+			 key_slot_index,
+			 key_slot->number_of_stripes );
+
+			libcnotify_printf(
+			 "\n" );
+		}
+#endif
+		if( key_slot->state != LIBQCOW_LUKS_KEY_SLOT_STATE_ENABLED )
+		{
+			continue;
+		}
+		/* The key material of the key slot must be stored in the header data
+		 */
+		key_material_end_offset = ( (uint64_t) luks_header->key_size * key_slot->number_of_stripes + 511 ) / 512;
+		key_material_end_offset = ( key_material_end_offset + key_slot->key_material_offset ) * 512;
+
+		if( ( key_slot->number_of_iterations == 0 )
+		 || ( key_slot->number_of_stripes == 0 )
+		 || ( key_slot->key_material_offset == 0 )
+		 || ( key_material_end_offset > (uint64_t) data_size ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid key slot: %d value out of bounds.",
+			 function,
+			 key_slot_index );
+
+			return( -1 );
+		}
+	}
+	luks_header->data = (uint8_t *) memory_allocate(
+	                                 sizeof( uint8_t ) * data_size );
+
+	if( luks_header->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create data.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     luks_header->data,
+	     data,
+	     data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy data.",
+		 function );
+
+		memory_free(
+		 luks_header->data );
+
+		luks_header->data = NULL;
+
+		return( -1 );
+	}
+	luks_header->data_size = data_size;
+
+	return( 1 );
+}
+
+/* Reads a LUKS header
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_luks_header_read_file_io_handle(
+     libqcow_luks_header_t *luks_header,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size64_t header_size,
+     libcerror_error_t **error )
+{
+	uint8_t *header_data  = NULL;
+	static char *function = "libqcow_luks_header_read_file_io_handle";
+	ssize_t read_count    = 0;
+	int result            = -1;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( header_size < (size64_t) sizeof( qcow_luks_header_t ) )
+	 || ( header_size > (size64_t) LIBQCOW_LUKS_MAXIMUM_HEADER_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid header size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: reading LUKS header at offset: %" PRIi64 " (0x%08" PRIx64 ")\n",
+		 function,
+		 file_offset,
+		 file_offset );
+	}
+#endif
+	header_data = (uint8_t *) memory_allocate(
+	                           sizeof( uint8_t ) * (size_t) header_size );
+
+	if( header_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create header data.",
+		 function );
+
+		goto on_error;
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              header_data,
+	              (size_t) header_size,
+	              file_offset,
+	              error );
+
+	if( read_count != (ssize_t) header_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read LUKS header data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		goto on_error;
+	}
+	if( libqcow_luks_header_read_data(
+	     luks_header,
+	     header_data,
+	     (size_t) header_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read LUKS header.",
+		 function );
+
+		goto on_error;
+	}
+	result = 1;
+
+on_error:
+	if( header_data != NULL )
+	{
+		memory_set(
+		 header_data,
+		 0,
+		 (size_t) header_size );
+
+		memory_free(
+		 header_data );
+	}
+	return( result );
+}
+
+/* Diffuses data using the hash as defined by the LUKS anti-forensic splitter
+ * Every digest size block of the data is replaced by the hash of
+ * the big-endian block index followed by the block
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_luks_header_diffuse(
+            int hash_type,
+            uint8_t *data,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	uint8_t block_index_data[ 4 ];
+	uint8_t digest[ LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE ];
+
+	libqcow_hash_context_t hash_context;
+
+	static char *function = "libqcow_luks_header_diffuse";
+	size_t block_size     = 0;
+	size_t data_offset    = 0;
+	size_t digest_size    = 0;
+	uint32_t block_index  = 0;
+
+	if( libqcow_hash_get_digest_size(
+	     hash_type,
+	     &digest_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve digest size.",
+		 function );
+
+		return( -1 );
+	}
+	while( data_offset < data_size )
+	{
+		block_size = data_size - data_offset;
+
+		if( block_size > digest_size )
+		{
+			block_size = digest_size;
+		}
+		byte_stream_copy_from_uint32_big_endian(
+		 block_index_data,
+		 block_index );
+
+		if( libqcow_hash_context_reset(
+		     &hash_context,
+		     hash_type,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to reset hash context.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_hash_context_update(
+		     &hash_context,
+		     block_index_data,
+		     4,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update hash context with block index.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_hash_context_update(
+		     &hash_context,
+		     &( data[ data_offset ] ),
+		     block_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update hash context with block.",
+			 function );
+
+			return( -1 );
+		}
+		if( libqcow_hash_context_finalize(
+		     &hash_context,
+		     digest,
+		     LIBQCOW_HASH_MAXIMUM_DIGEST_SIZE,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to finalize hash context.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_copy(
+		     &( data[ data_offset ] ),
+		     digest,
+		     block_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy digest.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += block_size;
+		block_index += 1;
+	}
+	return( 1 );
+}
+
+/* Merges the anti-forensic stripes of the key material into the master key
+ * Returns 1 if successful or -1 on error
+ */
+static int libqcow_luks_header_merge_stripes(
+            int hash_type,
+            const uint8_t *stripes_data,
+            size_t key_size,
+            uint32_t number_of_stripes,
+            uint8_t *master_key,
+            libcerror_error_t **error )
+{
+	static char *function = "libqcow_luks_header_merge_stripes";
+	size_t byte_index     = 0;
+	size_t stripe_offset  = 0;
+	uint32_t stripe_index = 0;
+
+	if( memory_set(
+	     master_key,
+	     0,
+	     key_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear master key.",
+		 function );
+
+		return( -1 );
+	}
+	for( stripe_index = 0;
+	     stripe_index < number_of_stripes;
+	     stripe_index++ )
+	{
+		for( byte_index = 0;
+		     byte_index < key_size;
+		     byte_index++ )
+		{
+			master_key[ byte_index ] ^= stripes_data[ stripe_offset + byte_index ];
+		}
+		stripe_offset += key_size;
+
+		/* The last stripe is not diffused
+		 */
+		if( ( stripe_index + 1 ) == number_of_stripes )
+		{
+			break;
+		}
+		if( libqcow_luks_header_diffuse(
+		     hash_type,
+		     master_key,
+		     key_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to diffuse stripe: %" PRIu32 ".",
+			 function,
+			 stripe_index );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Verifies a master key using the master key digest
+ * Returns 1 if the master key matches, 0 if not or -1 on error
+ */
+int libqcow_luks_header_verify_master_key(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error )
+{
+	uint8_t master_key_digest[ 20 ];
+
+	static char *function = "libqcow_luks_header_verify_master_key";
+	int result            = 0;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid master key.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key_size != (size_t) luks_header->key_size )
+	{
+		return( 0 );
+	}
+	if( libqcow_hash_pbkdf2(
+	     luks_header->hash_type,
+	     master_key,
+	     master_key_size,
+	     luks_header->master_key_digest_salt,
+	     32,
+	     luks_header->master_key_digest_number_of_iterations,
+	     master_key_digest,
+	     20,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate master key digest.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_compare(
+	     master_key_digest,
+	     luks_header->master_key_digest,
+	     20 ) == 0 )
+	{
+		result = 1;
+	}
+	return( result );
+}
+
+/* Unlocks a key slot using a password and retrieves the master key
+ * Returns 1 if successful, 0 if the key slot is disabled or the password does not match or -1 on error
+ */
+int libqcow_luks_header_unlock_key_slot(
+     libqcow_luks_header_t *luks_header,
+     int key_slot_index,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error )
+{
+	uint8_t derived_key[ LIBQCOW_LUKS_MAXIMUM_KEY_SIZE ];
+
+	libqcow_encryption_context_t *encryption_context = NULL;
+	libqcow_luks_key_slot_t *key_slot                = NULL;
+	uint8_t *stripes_data                            = NULL;
+	static char *function                            = "libqcow_luks_header_unlock_key_slot";
+	size_t key_material_offset                       = 0;
+	size_t stripes_data_size                         = 0;
+	int result                                       = -1;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( luks_header->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid LUKS header - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( key_slot_index < 0 )
+	 || ( key_slot_index >= LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid key slot index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( password == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid password.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid master key.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key_size < (size_t) luks_header->key_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+		 "%s: invalid master key size value too small.",
+		 function );
+
+		return( -1 );
+	}
+	key_slot = &( luks_header->key_slots[ key_slot_index ] );
+
+	if( key_slot->state != LIBQCOW_LUKS_KEY_SLOT_STATE_ENABLED )
+	{
+		return( 0 );
+	}
+	/* The bounds of the key material were validated when the header was read
+	 */
+	key_material_offset = (size_t) key_slot->key_material_offset * 512;
+	stripes_data_size   = (size_t) luks_header->key_size * key_slot->number_of_stripes;
+	stripes_data_size   = ( ( stripes_data_size + 511 ) / 512 ) * 512;
+
+	stripes_data = (uint8_t *) memory_allocate(
+	                            sizeof( uint8_t ) * stripes_data_size );
+
+	if( stripes_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create stripes data.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_pbkdf2(
+	     luks_header->hash_type,
+	     password,
+	     password_size,
+	     key_slot->salt,
+	     32,
+	     key_slot->number_of_iterations,
+	     derived_key,
+	     (size_t) luks_header->key_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to derive key slot: %d key.",
+		 function,
+		 key_slot_index );
+
+		goto on_error;
+	}
+	/* The key material is encrypted with the same cipher as the data
+	 * where the sector numbers start at 0
+	 */
+	if( libqcow_encryption_initialize(
+	     &encryption_context,
+	     LIBQCOW_ENCRYPTION_METHOD_LUKS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create encryption context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_encryption_set_keys(
+	     encryption_context,
+	     derived_key,
+	     (size_t) luks_header->key_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set key in encryption context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_encryption_crypt(
+	     encryption_context,
+	     LIBQCOW_ENCYPTION_CRYPT_MODE_DECRYPT,
+	     &( luks_header->data[ key_material_offset ] ),
+	     stripes_data_size,
+	     stripes_data,
+	     stripes_data_size,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+		 LIBCERROR_ENCRYPTION_ERROR_DECRYPT_FAILED,
+		 "%s: unable to decrypt key slot: %d key material.",
+		 function,
+		 key_slot_index );
+
+		goto on_error;
+	}
+	if( libqcow_luks_header_merge_stripes(
+	     luks_header->hash_type,
+	     stripes_data,
+	     (size_t) luks_header->key_size,
+	     key_slot->number_of_stripes,
+	     master_key,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to merge key slot: %d stripes.",
+		 function,
+		 key_slot_index );
+
+		goto on_error;
+	}
+	result = libqcow_luks_header_verify_master_key(
+	          luks_header,
+	          master_key,
+	          (size_t) luks_header->key_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to verify master key.",
+		 function );
+
+		goto on_error;
+	}
+	else if( result == 0 )
+	{
+		memory_set(
+		 master_key,
+		 0,
+		 master_key_size );
+	}
+on_error:
+	if( encryption_context != NULL )
+	{
+		libqcow_encryption_free(
+		 &encryption_context,
+		 NULL );
+	}
+	if( stripes_data != NULL )
+	{
+		memory_set(
+		 stripes_data,
+		 0,
+		 stripes_data_size );
+
+		memory_free(
+		 stripes_data );
+	}
+	memory_set(
+	 derived_key,
+	 0,
+	 LIBQCOW_LUKS_MAXIMUM_KEY_SIZE );
+
+	return( result );
+}
+
+/* Determines the key cache identifier of the header and a password
+ * The identifier is a SHA-256 of the header, without the key material,
+ * followed by the password, hence it changes when a key slot is changed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_luks_header_get_key_identifier(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *identifier,
+     size_t identifier_size,
+     libcerror_error_t **error )
+{
+	libqcow_hash_context_t hash_context;
+
+	static char *function = "libqcow_luks_header_get_key_identifier";
+	int result            = -1;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( luks_header->data == NULL )
+	 || ( luks_header->data_size < sizeof( qcow_luks_header_t ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid LUKS header - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( password == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid password.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_hash_context_reset(
+	     &hash_context,
+	     LIBQCOW_HASH_TYPE_SHA256,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize hash context.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_context_update(
+	     &hash_context,
+	     luks_header->data,
+	     sizeof( qcow_luks_header_t ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to hash header.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_context_update(
+	     &hash_context,
+	     password,
+	     password_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to hash password.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_hash_context_finalize(
+	     &hash_context,
+	     identifier,
+	     identifier_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to finalize hash context.",
+		 function );
+
+		goto on_error;
+	}
+	result = 1;
+
+on_error:
+	memory_set(
+	 &hash_context,
+	 0,
+	 sizeof( libqcow_hash_context_t ) );
+
+	return( result );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The key slot unlock thread function
+ * Returns 1 if successful, 0 if the key slot is disabled or the password does not match or -1 on error
+ */
+int libqcow_luks_header_unlock_thread_function(
+     void *arguments )
+{
+	libqcow_luks_key_slot_unlock_t *key_slot_unlock = NULL;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	key_slot_unlock = (libqcow_luks_key_slot_unlock_t *) arguments;
+
+	key_slot_unlock->result = libqcow_luks_header_unlock_key_slot(
+	                           key_slot_unlock->luks_header,
+	                           key_slot_unlock->key_slot_index,
+	                           key_slot_unlock->password,
+	                           key_slot_unlock->password_size,
+	                           key_slot_unlock->master_key,
+	                           LIBQCOW_LUKS_MAXIMUM_KEY_SIZE,
+	                           &( key_slot_unlock->error ) );
+
+	return( key_slot_unlock->result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Unlocks the LUKS header using a password and retrieves the master key
+ * A master key that was derived before is retrieved from the key cache,
+ * otherwise the enabled key slots are tried in parallel, one thread per
+ * key slot, since every key slot takes a deliberately expensive PBKDF2
+ * Returns 1 if successful, 0 if no key slot matches the password or -1 on error
+ */
+int libqcow_luks_header_unlock(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error )
+{
+	uint8_t identifier[ LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE ];
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libqcow_luks_key_slot_unlock_t key_slot_unlocks[ LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS ];
+
+	libcerror_error_t *key_slot_error = NULL;
+	int number_of_key_slot_unlocks    = 0;
+	int key_slot_unlock_index         = 0;
+#endif
+	static char *function             = "libqcow_luks_header_unlock";
+	int key_slot_index                = 0;
+	int result                        = 0;
+
+	if( luks_header == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid LUKS header.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid master key.",
+		 function );
+
+		return( -1 );
+	}
+	if( master_key_size < (size_t) luks_header->key_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_SMALL,
+		 "%s: invalid master key size value too small.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_luks_header_get_key_identifier(
+	     luks_header,
+	     password,
+	     password_size,
+	     identifier,
+	     LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine key identifier.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_key_cache_get_key(
+	          identifier,
+	          LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE,
+	          master_key,
+	          (size_t) luks_header->key_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve master key from cache.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result != 0 )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( key_slot_index = 0;
+	     key_slot_index < LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS;
+	     key_slot_index++ )
+	{
+		if( luks_header->key_slots[ key_slot_index ].state == LIBQCOW_LUKS_KEY_SLOT_STATE_ENABLED )
+		{
+			key_slot_unlocks[ number_of_key_slot_unlocks ].luks_header    = luks_header;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].key_slot_index = key_slot_index;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].password       = password;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].password_size  = password_size;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].thread         = NULL;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].error          = NULL;
+			key_slot_unlocks[ number_of_key_slot_unlocks ].result         = 0;
+
+			number_of_key_slot_unlocks++;
+		}
+	}
+	if( number_of_key_slot_unlocks > 1 )
+	{
+		/* The first key slot is unlocked by the calling thread, if a thread cannot
+		 * be created its key slot is also unlocked by the calling thread
+		 */
+		for( key_slot_unlock_index = 1;
+		     key_slot_unlock_index < number_of_key_slot_unlocks;
+		     key_slot_unlock_index++ )
+		{
+			if( libcthreads_thread_create(
+			     &( key_slot_unlocks[ key_slot_unlock_index ].thread ),
+			     NULL,
+			     &libqcow_luks_header_unlock_thread_function,
+			     (void *) &( key_slot_unlocks[ key_slot_unlock_index ] ),
+			     &key_slot_error ) != 1 )
+			{
+				libcerror_error_free(
+				 &key_slot_error );
+
+				key_slot_unlocks[ key_slot_unlock_index ].thread = NULL;
+			}
+		}
+		for( key_slot_unlock_index = 0;
+		     key_slot_unlock_index < number_of_key_slot_unlocks;
+		     key_slot_unlock_index++ )
+		{
+			if( key_slot_unlocks[ key_slot_unlock_index ].thread == NULL )
+			{
+				libqcow_luks_header_unlock_thread_function(
+				 (void *) &( key_slot_unlocks[ key_slot_unlock_index ] ) );
+			}
+		}
+		for( key_slot_unlock_index = 1;
+		     key_slot_unlock_index < number_of_key_slot_unlocks;
+		     key_slot_unlock_index++ )
+		{
+			if( key_slot_unlocks[ key_slot_unlock_index ].thread != NULL )
+			{
+				if( libcthreads_thread_join(
+				     &( key_slot_unlocks[ key_slot_unlock_index ].thread ),
+				     &key_slot_error ) != 1 )
+				{
+					key_slot_unlocks[ key_slot_unlock_index ].result = -1;
+
+					if( key_slot_unlocks[ key_slot_unlock_index ].error == NULL )
+					{
+						key_slot_unlocks[ key_slot_unlock_index ].error = key_slot_error;
+						key_slot_error                                  = NULL;
+					}
+					else
+					{
+						libcerror_error_free(
+						 &key_slot_error );
+					}
+				}
+			}
+		}
+		/* A matching key slot takes precedence over a key slot that failed
+		 */
+		result = 0;
+
+		for( key_slot_unlock_index = 0;
+		     key_slot_unlock_index < number_of_key_slot_unlocks;
+		     key_slot_unlock_index++ )
+		{
+			if( key_slot_unlocks[ key_slot_unlock_index ].result == 1 )
+			{
+				if( result != 1 )
+				{
+					memory_copy(
+					 master_key,
+					 key_slot_unlocks[ key_slot_unlock_index ].master_key,
+					 (size_t) luks_header->key_size );
+
+					result = 1;
+				}
+			}
+			else if( ( key_slot_unlocks[ key_slot_unlock_index ].result == -1 )
+			      && ( result == 0 ) )
+			{
+				key_slot_index = key_slot_unlocks[ key_slot_unlock_index ].key_slot_index;
+
+				result = -1;
+			}
+		}
+		for( key_slot_unlock_index = 0;
+		     key_slot_unlock_index < number_of_key_slot_unlocks;
+		     key_slot_unlock_index++ )
+		{
+			if( key_slot_unlocks[ key_slot_unlock_index ].error != NULL )
+			{
+				/* The error of the first key slot that failed is passed to the caller
+				 */
+				if( ( result == -1 )
+				 && ( key_slot_unlocks[ key_slot_unlock_index ].key_slot_index == key_slot_index )
+				 && ( error != NULL )
+				 && ( *error == NULL ) )
+				{
+					*error = key_slot_unlocks[ key_slot_unlock_index ].error;
+				}
+				else
+				{
+					libcerror_error_free(
+					 &( key_slot_unlocks[ key_slot_unlock_index ].error ) );
+				}
+				key_slot_unlocks[ key_slot_unlock_index ].error = NULL;
+			}
+		}
+		memory_set(
+		 key_slot_unlocks,
+		 0,
+		 sizeof( libqcow_luks_key_slot_unlock_t ) * LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to unlock key slot: %d.",
+			 function,
+			 key_slot_index );
+
+			goto on_error;
+		}
+	}
+	else
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+	for( key_slot_index = 0;
+	     key_slot_index < LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS;
+	     key_slot_index++ )
+	{
+		result = libqcow_luks_header_unlock_key_slot(
+		          luks_header,
+		          key_slot_index,
+		          password,
+		          password_size,
+		          master_key,
+		          master_key_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to unlock key slot: %d.",
+			 function,
+			 key_slot_index );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			break;
+		}
+	}
+	if( result == 1 )
+	{
+		if( libqcow_key_cache_set_key(
+		     identifier,
+		     LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE,
+		     master_key,
+		     (size_t) luks_header->key_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set master key in cache.",
+			 function );
+
+			result = -1;
+		}
+	}
+on_error:
+	memory_set(
+	 identifier,
+	 0,
+	 LIBQCOW_KEY_CACHE_IDENTIFIER_SIZE );
+
+	return( result );
+}
+
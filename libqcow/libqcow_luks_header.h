@@ -0,0 +1,210 @@
+/*
+ * LUKS header functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_LUKS_HEADER_H )
+#define _LIBQCOW_LUKS_HEADER_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_luks_key_slot libqcow_luks_key_slot_t;
+
+struct libqcow_luks_key_slot
+{
+	/* The state
+	 */
+	uint32_t state;
+
+	/* The number of (PBKDF2) iterations
+	 */
+	uint32_t number_of_iterations;
+
+	/* The (PBKDF2) salt
+	 */
+	uint8_t salt[ 32 ];
+
+	/* The key material offset in 512-byte sectors
+	 */
+	uint32_t key_material_offset;
+
+	/* The number of (anti-forensic) stripes
+	 */
+	uint32_t number_of_stripes;
+};
+
+typedef struct libqcow_luks_header libqcow_luks_header_t;
+
+struct libqcow_luks_header
+{
+	/* The format version
+	 */
+	uint16_t format_version;
+
+	/* The hash type
+	 */
+	int hash_type;
+
+	/* The (master) key size
+	 */
+	uint32_t key_size;
+
+	/* The master key digest
+	 */
+	uint8_t master_key_digest[ 20 ];
+
+	/* The master key digest salt
+	 */
+	uint8_t master_key_digest_salt[ 32 ];
+
+	/* The master key digest number of iterations
+	 */
+	uint32_t master_key_digest_number_of_iterations;
+
+	/* The key slots
+	 */
+	libqcow_luks_key_slot_t key_slots[ LIBQCOW_LUKS_NUMBER_OF_KEY_SLOTS ];
+
+	/* The header data, which contains the key material of the key slots
+	 */
+	uint8_t *data;
+
+	/* The header data size
+	 */
+	size_t data_size;
+};
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+typedef struct libqcow_luks_key_slot_unlock libqcow_luks_key_slot_unlock_t;
+
+/* The values of a key slot that is unlocked by a thread
+ */
+struct libqcow_luks_key_slot_unlock
+{
+	/* The LUKS header
+	 */
+	libqcow_luks_header_t *luks_header;
+
+	/* The key slot index
+	 */
+	int key_slot_index;
+
+	/* The password
+	 */
+	const uint8_t *password;
+
+	/* The password size
+	 */
+	size_t password_size;
+
+	/* The master key
+	 */
+	uint8_t master_key[ LIBQCOW_LUKS_MAXIMUM_KEY_SIZE ];
+
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+
+	/* The result
+	 */
+	int result;
+
+	/* The error
+	 */
+	libcerror_error_t *error;
+};
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_luks_header_initialize(
+     libqcow_luks_header_t **luks_header,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_free(
+     libqcow_luks_header_t **luks_header,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_read_data(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_read_file_io_handle(
+     libqcow_luks_header_t *luks_header,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size64_t header_size,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_verify_master_key(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_unlock_key_slot(
+     libqcow_luks_header_t *luks_header,
+     int key_slot_index,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error );
+
+int libqcow_luks_header_get_key_identifier(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *identifier,
+     size_t identifier_size,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_luks_header_unlock_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_luks_header_unlock(
+     libqcow_luks_header_t *luks_header,
+     const uint8_t *password,
+     size_t password_size,
+     uint8_t *master_key,
+     size_t master_key_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_LUKS_HEADER_H ) */
+
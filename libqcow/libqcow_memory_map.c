@@ -0,0 +1,858 @@
+/*
+ * Memory map functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_SYS_MMAN_H )
+#include <sys/mman.h>
+#endif
+
+#if defined( HAVE_SYS_STAT_H )
+#include <sys/stat.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_memory_map.h"
+
+/* Creates a memory map
+ * Make sure the value memory_map is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_memory_map_initialize(
+     libqcow_memory_map_t **memory_map,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_initialize";
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( *memory_map != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid memory map value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_map = memory_allocate_structure(
+	               libqcow_memory_map_t );
+
+	if( *memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create memory map.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *memory_map,
+	     0,
+	     sizeof( libqcow_memory_map_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear memory map.",
+		 function );
+
+		goto on_error;
+	}
+	( *memory_map )->advice          = LIBQCOW_MEMORY_MAP_ADVICE_NORMAL;
+	( *memory_map )->expected_offset = -1;
+
+	return( 1 );
+
+on_error:
+	if( *memory_map != NULL )
+	{
+		memory_free(
+		 *memory_map );
+
+		*memory_map = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a memory map
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_memory_map_free(
+     libqcow_memory_map_t **memory_map,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_free";
+	int result            = 1;
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( *memory_map != NULL )
+	{
+		if( ( *memory_map )->data != NULL )
+		{
+			if( libqcow_memory_map_close(
+			     *memory_map,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close memory map.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *memory_map );
+
+		*memory_map = NULL;
+	}
+	return( result );
+}
+
+/* Maps a file into memory for reading
+ * Returns 1 if successful, 0 if the file cannot be memory mapped or -1 on error
+ */
+int libqcow_memory_map_open(
+     libqcow_memory_map_t *memory_map,
+     const char *filename,
+     libcerror_error_t **error )
+{
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT )
+	struct stat file_statistics;
+
+	void *data            = NULL;
+	int file_descriptor   = -1;
+#endif
+	static char *function = "libqcow_memory_map_open";
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->data != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid memory map - data value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT )
+	file_descriptor = open(
+	                   filename,
+	                   O_RDONLY );
+
+	if( file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( fstat(
+	     file_descriptor,
+	     &file_statistics ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file statistics.",
+		 function );
+
+		goto on_error;
+	}
+	/* Empty files and files that do not fit in the address space are read using the file IO handle
+	 */
+	if( ( file_statistics.st_size <= 0 )
+	 || ( (uint64_t) file_statistics.st_size > (uint64_t) SSIZE_MAX ) )
+	{
+		close(
+		 file_descriptor );
+
+		return( 0 );
+	}
+	data = mmap(
+	        NULL,
+	        (size_t) file_statistics.st_size,
+	        PROT_READ,
+	        MAP_SHARED,
+	        file_descriptor,
+	        0 );
+
+	if( data == MAP_FAILED )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to map file: %s.",
+		 function,
+		 filename );
+
+		data = NULL;
+
+		goto on_error;
+	}
+	/* The mapping remains valid after the file descriptor is closed
+	 */
+	if( close(
+	     file_descriptor ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close file: %s.",
+		 function,
+		 filename );
+
+		file_descriptor = -1;
+
+		goto on_error;
+	}
+	memory_map->data                       = (uint8_t *) data;
+	memory_map->data_size                  = (size_t) file_statistics.st_size;
+	memory_map->advice                     = LIBQCOW_MEMORY_MAP_ADVICE_NORMAL;
+	memory_map->expected_offset            = -1;
+	memory_map->number_of_sequential_reads = 0;
+	memory_map->number_of_random_reads     = 0;
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: mapped %" PRIzd " bytes of file: %s\n",
+		 function,
+		 memory_map->data_size,
+		 filename );
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( data != NULL )
+	{
+		munmap(
+		 data,
+		 (size_t) file_statistics.st_size );
+	}
+	if( file_descriptor != -1 )
+	{
+		close(
+		 file_descriptor );
+	}
+	return( -1 );
+#else
+	return( 0 );
+#endif /* defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT ) */
+}
+
+/* Unmaps the file
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_memory_map_close(
+     libqcow_memory_map_t *memory_map,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_close";
+	int result            = 0;
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT )
+	if( memory_map->data != NULL )
+	{
+		if( munmap(
+		     (void *) memory_map->data,
+		     memory_map->data_size ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to unmap file.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	memory_map->data                       = NULL;
+	memory_map->data_size                  = 0;
+	memory_map->advice                     = LIBQCOW_MEMORY_MAP_ADVICE_NORMAL;
+	memory_map->expected_offset            = -1;
+	memory_map->number_of_sequential_reads = 0;
+	memory_map->number_of_random_reads     = 0;
+
+	return( result );
+}
+
+/* Sets the advice about the expected access pattern of the mapped data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_memory_map_set_advice(
+     libqcow_memory_map_t *memory_map,
+     int advice,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_set_advice";
+
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT ) && defined( HAVE_MADVISE )
+	int system_advice     = 0;
+#endif
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid memory map - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( advice != LIBQCOW_MEMORY_MAP_ADVICE_NORMAL )
+	 && ( advice != LIBQCOW_MEMORY_MAP_ADVICE_SEQUENTIAL )
+	 && ( advice != LIBQCOW_MEMORY_MAP_ADVICE_RANDOM ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported advice: %d.",
+		 function,
+		 advice );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT ) && defined( HAVE_MADVISE )
+	switch( advice )
+	{
+		case LIBQCOW_MEMORY_MAP_ADVICE_SEQUENTIAL:
+			system_advice = MADV_SEQUENTIAL;
+			break;
+
+		case LIBQCOW_MEMORY_MAP_ADVICE_RANDOM:
+			system_advice = MADV_RANDOM;
+			break;
+
+		default:
+			system_advice = MADV_NORMAL;
+			break;
+	}
+	if( madvise(
+	     (void *) memory_map->data,
+	     memory_map->data_size,
+	     system_advice ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set advice.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: changed advice from: %d to: %d\n",
+		 function,
+		 memory_map->advice,
+		 advice );
+	}
+#endif
+	memory_map->advice = advice;
+
+	return( 1 );
+}
+
+/* Sets the advice about the expected use of a range of the mapped data
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_memory_map_advise_range(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_advise_range";
+
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT ) && defined( HAVE_MADVISE )
+	size_t page_offset    = 0;
+	size_t page_size      = 0;
+	int system_advice     = 0;
+#endif
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid memory map - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( advice != LIBQCOW_MEMORY_MAP_ADVICE_WILLNEED )
+	 && ( advice != LIBQCOW_MEMORY_MAP_ADVICE_DONTNEED ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported advice: %d.",
+		 function,
+		 advice );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= (size64_t) memory_map->data_size )
+	{
+		return( 1 );
+	}
+	if( size > (size64_t) ( memory_map->data_size - (size_t) offset ) )
+	{
+		size = (size64_t) ( memory_map->data_size - (size_t) offset );
+	}
+#if defined( HAVE_LIBQCOW_MEMORY_MAP_SUPPORT ) && defined( HAVE_MADVISE )
+	/* The mapped data starts at a page boundary, the range must start at one as well
+	 */
+	page_size = (size_t) sysconf(
+	                      _SC_PAGESIZE );
+
+	if( page_size == 0 )
+	{
+		page_size = 4096;
+	}
+	page_offset = (size_t) offset % page_size;
+
+	if( advice == LIBQCOW_MEMORY_MAP_ADVICE_WILLNEED )
+	{
+		system_advice = MADV_WILLNEED;
+	}
+	else
+	{
+		system_advice = MADV_DONTNEED;
+	}
+	if( madvise(
+	     (void *) &( memory_map->data[ (size_t) offset - page_offset ] ),
+	     (size_t) size + page_offset,
+	     system_advice ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set advice.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Updates the detected access pattern with a read of the mapped data
+ * The advice is changed when the threshold number of consecutive reads with a different access pattern is reached
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_memory_map_update_access_pattern(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size_t size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_update_access_pattern";
+	int advice            = 0;
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->advice_is_fixed != 0 )
+	{
+		return( 1 );
+	}
+	if( offset == memory_map->expected_offset )
+	{
+		if( memory_map->number_of_sequential_reads < LIBQCOW_MEMORY_MAP_ACCESS_PATTERN_THRESHOLD )
+		{
+			memory_map->number_of_sequential_reads += 1;
+		}
+		memory_map->number_of_random_reads = 0;
+	}
+	else
+	{
+		if( memory_map->number_of_random_reads < LIBQCOW_MEMORY_MAP_ACCESS_PATTERN_THRESHOLD )
+		{
+			memory_map->number_of_random_reads += 1;
+		}
+		memory_map->number_of_sequential_reads = 0;
+	}
+	memory_map->expected_offset = offset + (off64_t) size;
+
+	advice = memory_map->advice;
+
+	if( memory_map->number_of_sequential_reads >= LIBQCOW_MEMORY_MAP_ACCESS_PATTERN_THRESHOLD )
+	{
+		advice = LIBQCOW_MEMORY_MAP_ADVICE_SEQUENTIAL;
+	}
+	else if( memory_map->number_of_random_reads >= LIBQCOW_MEMORY_MAP_ACCESS_PATTERN_THRESHOLD )
+	{
+		advice = LIBQCOW_MEMORY_MAP_ADVICE_RANDOM;
+	}
+	if( advice != memory_map->advice )
+	{
+		if( libqcow_memory_map_set_advice(
+		     memory_map,
+		     advice,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set advice.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves a pointer to the mapped data at a specific offset
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful, 0 if the range is not within the mapped data or -1 on error
+ */
+int libqcow_memory_map_get_data(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size_t size,
+     const uint8_t **data,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_get_data";
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid memory map - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( (size64_t) offset > (size64_t) memory_map->data_size )
+	 || ( size > ( memory_map->data_size - (size_t) offset ) ) )
+	{
+		return( 0 );
+	}
+	if( libqcow_memory_map_update_access_pattern(
+	     memory_map,
+	     offset,
+	     size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update access pattern.",
+		 function );
+
+		return( -1 );
+	}
+	*data = &( memory_map->data[ offset ] );
+
+	return( 1 );
+}
+
+/* Reads mapped data at a specific offset into a buffer
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_memory_map_read_buffer_at_offset(
+         libqcow_memory_map_t *memory_map,
+         uint8_t *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_memory_map_read_buffer_at_offset";
+	size_t read_size      = 0;
+
+	if( memory_map == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory map.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_map->data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid memory map - missing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= (size64_t) memory_map->data_size )
+	{
+		return( 0 );
+	}
+	read_size = memory_map->data_size - (size_t) offset;
+
+	if( read_size > buffer_size )
+	{
+		read_size = buffer_size;
+	}
+	if( libqcow_memory_map_update_access_pattern(
+	     memory_map,
+	     offset,
+	     read_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to update access pattern.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_copy(
+	     buffer,
+	     &( memory_map->data[ offset ] ),
+	     read_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy mapped data.",
+		 function );
+
+		return( -1 );
+	}
+	return( (ssize_t) read_size );
+}
+
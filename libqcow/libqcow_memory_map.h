@@ -0,0 +1,125 @@
+/*
+ * Memory map functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_MEMORY_MAP_H )
+#define _LIBQCOW_MEMORY_MAP_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if !defined( WINAPI ) && defined( HAVE_SYS_MMAN_H ) && defined( HAVE_MMAP ) && defined( HAVE_MUNMAP )
+#define HAVE_LIBQCOW_MEMORY_MAP_SUPPORT
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_memory_map libqcow_memory_map_t;
+
+struct libqcow_memory_map
+{
+	/* The mapped data
+	 */
+	uint8_t *data;
+
+	/* The mapped data size
+	 */
+	size_t data_size;
+
+	/* The current advice
+	 */
+	int advice;
+
+	/* Value to indicate the advice was set explicitly, which disables the access pattern detection
+	 */
+	uint8_t advice_is_fixed;
+
+	/* The offset expected by the next sequential read
+	 */
+	off64_t expected_offset;
+
+	/* The number of consecutive sequential reads
+	 */
+	int number_of_sequential_reads;
+
+	/* The number of consecutive random reads
+	 */
+	int number_of_random_reads;
+};
+
+int libqcow_memory_map_initialize(
+     libqcow_memory_map_t **memory_map,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_free(
+     libqcow_memory_map_t **memory_map,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_open(
+     libqcow_memory_map_t *memory_map,
+     const char *filename,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_close(
+     libqcow_memory_map_t *memory_map,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_set_advice(
+     libqcow_memory_map_t *memory_map,
+     int advice,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_advise_range(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_update_access_pattern(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size_t size,
+     libcerror_error_t **error );
+
+int libqcow_memory_map_get_data(
+     libqcow_memory_map_t *memory_map,
+     off64_t offset,
+     size_t size,
+     const uint8_t **data,
+     libcerror_error_t **error );
+
+ssize_t libqcow_memory_map_read_buffer_at_offset(
+         libqcow_memory_map_t *memory_map,
+         uint8_t *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_MEMORY_MAP_H ) */
+
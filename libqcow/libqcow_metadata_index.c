@@ -0,0 +1,966 @@
+/*
+ * Metadata index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_byte_swap.h"
+#include "libqcow_chain_index.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_metadata_index.h"
+
+#include "qcow_metadata_index.h"
+
+/* The number of values that are read or written at once
+ */
+#define LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK		4096
+
+const uint8_t qcow_metadata_index_file_signature[ 8 ] = { 'q', 'c', 'o', 'w', 'm', 'i', 'd', 'x' };
+
+/* Creates a metadata index
+ * Make sure the value metadata_index is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_initialize(
+     libqcow_metadata_index_t **metadata_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     size_t entry_size,
+     size64_t file_size,
+     uint32_t file_header_checksum,
+     uint32_t level1_table_checksum,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_metadata_index_initialize";
+	size64_t number_of_entries = 0;
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *metadata_index != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid metadata index value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size == 0 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( entry_size != 8 )
+	 && ( entry_size != 16 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported entry size: %" PRIzd ".",
+		 function,
+		 entry_size );
+
+		return( -1 );
+	}
+	number_of_entries = media_size / cluster_block_size;
+
+	if( ( media_size % cluster_block_size ) != 0 )
+	{
+		number_of_entries += 1;
+	}
+	if( ( number_of_entries == 0 )
+	 || ( number_of_entries > (size64_t) ( SSIZE_MAX / entry_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*metadata_index = memory_allocate_structure(
+	                   libqcow_metadata_index_t );
+
+	if( *metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create metadata index.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *metadata_index,
+	     0,
+	     sizeof( libqcow_metadata_index_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear metadata index.",
+		 function );
+
+		memory_free(
+		 *metadata_index );
+
+		*metadata_index = NULL;
+
+		return( -1 );
+	}
+	( *metadata_index )->entries = (uint64_t *) memory_allocate(
+	                                             entry_size * (size_t) number_of_entries );
+
+	if( ( *metadata_index )->entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entries.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *metadata_index )->entries,
+	     0,
+	     entry_size * (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear entries.",
+		 function );
+
+		goto on_error;
+	}
+	( *metadata_index )->media_size            = media_size;
+	( *metadata_index )->cluster_block_size    = cluster_block_size;
+	( *metadata_index )->entry_size            = entry_size;
+	( *metadata_index )->file_size             = file_size;
+	( *metadata_index )->file_header_checksum  = file_header_checksum;
+	( *metadata_index )->level1_table_checksum = level1_table_checksum;
+	( *metadata_index )->number_of_entries     = (size_t) number_of_entries;
+
+	return( 1 );
+
+on_error:
+	if( *metadata_index != NULL )
+	{
+		if( ( *metadata_index )->entries != NULL )
+		{
+			memory_free(
+			 ( *metadata_index )->entries );
+		}
+		memory_free(
+		 *metadata_index );
+
+		*metadata_index = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a metadata index
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_free(
+     libqcow_metadata_index_t **metadata_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_metadata_index_free";
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( *metadata_index != NULL )
+	{
+		if( ( *metadata_index )->entries != NULL )
+		{
+			memory_free(
+			 ( *metadata_index )->entries );
+		}
+		memory_free(
+		 *metadata_index );
+
+		*metadata_index = NULL;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage of a metadata index
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_get_memory_usage(
+     libqcow_metadata_index_t *metadata_index,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_metadata_index_get_memory_usage";
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_metadata_index_t )
+	              + ( metadata_index->entry_size * metadata_index->number_of_entries );
+
+	return( 1 );
+}
+
+/* Retrieves the level 2 table entry of the cluster block at a specific offset
+ * The subcluster bitmap is set to 0 if the entry is not an extended level 2 table entry
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_get_entry_at_offset(
+     libqcow_metadata_index_t *metadata_index,
+     off64_t offset,
+     uint64_t *cluster_descriptor,
+     uint64_t *subcluster_bitmap,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_metadata_index_get_entry_at_offset";
+	size_t value_index    = 0;
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( offset < 0 )
+	 || ( (size64_t) offset >= metadata_index->media_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_descriptor == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster descriptor.",
+		 function );
+
+		return( -1 );
+	}
+	if( subcluster_bitmap == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid subcluster bitmap.",
+		 function );
+
+		return( -1 );
+	}
+	value_index = (size_t) ( (size64_t) offset / metadata_index->cluster_block_size )
+	            * ( metadata_index->entry_size / 8 );
+
+	*cluster_descriptor = metadata_index->entries[ value_index ];
+
+	if( metadata_index->entry_size == 16 )
+	{
+		*subcluster_bitmap = metadata_index->entries[ value_index + 1 ];
+	}
+	else
+	{
+		*subcluster_bitmap = 0;
+	}
+	return( 1 );
+}
+
+/* Sets the entries of a level 2 table
+ * The data contains the big-endian level 2 table entries of which the first
+ * corresponds with the entry index, entries beyond the media are ignored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_set_level2_table_data(
+     libqcow_metadata_index_t *metadata_index,
+     size_t entry_index,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function   = "libqcow_metadata_index_set_level2_table_data";
+	size_t number_of_values = 0;
+	size_t value_index      = 0;
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_index >= metadata_index->number_of_entries )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size > (size_t) SSIZE_MAX )
+	 || ( ( data_size % metadata_index->entry_size ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size / metadata_index->entry_size ) > ( metadata_index->number_of_entries - entry_index ) )
+	{
+		data_size = ( metadata_index->number_of_entries - entry_index ) * metadata_index->entry_size;
+	}
+	number_of_values = data_size / 8;
+	value_index      = entry_index * ( metadata_index->entry_size / 8 );
+
+	/* The entries are copied and converted in place
+	 */
+	if( memory_copy(
+	     &( metadata_index->entries[ value_index ] ),
+	     data,
+	     data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy level 2 table data.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_byte_swap_uint64_big_endian(
+	     &( metadata_index->entries[ value_index ] ),
+	     number_of_values,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to convert level 2 table entries.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads the metadata index from a metadata index file
+ * Returns 1 if successful, 0 if the metadata index file does not match the metadata index or -1 on error
+ */
+int libqcow_metadata_index_read_file_io_handle(
+     libqcow_metadata_index_t *metadata_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_metadata_index_file_header_t file_header;
+
+	uint8_t *values_data           = NULL;
+	static char *function          = "libqcow_metadata_index_read_file_io_handle";
+	size64_t cluster_block_size    = 0;
+	size64_t file_size             = 0;
+	size64_t media_size            = 0;
+	size64_t number_of_entries     = 0;
+	size_t data_offset             = 0;
+	size_t number_of_values        = 0;
+	size_t read_size               = 0;
+	size_t total_number_of_values  = 0;
+	size_t value_index             = 0;
+	ssize_t read_count             = 0;
+	uint32_t calculated_checksum   = 1;
+	uint32_t entry_size            = 0;
+	uint32_t file_header_checksum  = 0;
+	uint32_t format_version        = 0;
+	uint32_t level1_table_checksum = 0;
+	uint32_t stored_checksum       = 0;
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) &file_header,
+	              sizeof( qcow_metadata_index_file_header_t ),
+	              0,
+	              error );
+
+	if( read_count != (ssize_t) sizeof( qcow_metadata_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_compare(
+	     file_header.signature,
+	     qcow_metadata_index_file_signature,
+	     8 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported metadata index file signature.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.format_version,
+	 format_version );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.checksum,
+	 stored_checksum );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.file_header_checksum,
+	 file_header_checksum );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.level1_table_checksum,
+	 level1_table_checksum );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 cluster_block_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.media_size,
+	 media_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.number_of_entries,
+	 number_of_entries );
+
+	byte_stream_copy_to_uint32_little_endian(
+	 file_header.entry_size,
+	 entry_size );
+
+	byte_stream_copy_to_uint64_little_endian(
+	 file_header.file_size,
+	 file_size );
+
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_printf(
+		 "%s: format version\t\t: %" PRIu32 "\n",
+		 function,
+		 format_version );
+
+		libcnotify_printf(
+		 "%s: checksum\t\t\t: 0x%08" PRIx32 "\n",
+		 function,
+		 stored_checksum );
+
+		libcnotify_printf(
+		 "%s: file header checksum\t: 0x%08" PRIx32 "\n",
+		 function,
+		 file_header_checksum );
+
+		libcnotify_printf(
+		 "%s: level 1 table checksum\t: 0x%08" PRIx32 "\n",
+		 function,
+		 level1_table_checksum );
+
+		libcnotify_printf(
+		 "%s: cluster block size\t\t: %" PRIu64 "\n",
+		 function,
+		 cluster_block_size );
+
+		libcnotify_printf(
+		 "%s: media size\t\t\t: %" PRIu64 "\n",
+		 function,
+		 media_size );
+
+		libcnotify_printf(
+		 "%s: number of entries\t\t: %" PRIu64 "\n",
+		 function,
+		 number_of_entries );
+
+		libcnotify_printf(
+		 "%s: entry size\t\t\t: %" PRIu32 "\n",
+		 function,
+		 entry_size );
+
+		libcnotify_printf(
+		 "%s: file size\t\t\t: %" PRIu64 "\n",
+		 function,
+		 file_size );
+
+		libcnotify_printf(
+		 "\n" );
+	}
+#endif
+	if( format_version != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported metadata index file format version: %" PRIu32 ".",
+		 function,
+		 format_version );
+
+		goto on_error;
+	}
+	/* A metadata index file of another image or of a modified image cannot be used
+	 */
+	if( ( file_header_checksum != metadata_index->file_header_checksum )
+	 || ( level1_table_checksum != metadata_index->level1_table_checksum )
+	 || ( cluster_block_size != (size64_t) metadata_index->cluster_block_size )
+	 || ( media_size != metadata_index->media_size )
+	 || ( number_of_entries != (size64_t) metadata_index->number_of_entries )
+	 || ( entry_size != (uint32_t) metadata_index->entry_size )
+	 || ( file_size != metadata_index->file_size ) )
+	{
+		return( 0 );
+	}
+	values_data = (uint8_t *) memory_allocate(
+	                           sizeof( uint64_t ) * LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK );
+
+	if( values_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create values data.",
+		 function );
+
+		goto on_error;
+	}
+	total_number_of_values = metadata_index->number_of_entries * ( metadata_index->entry_size / 8 );
+
+	while( value_index < total_number_of_values )
+	{
+		number_of_values = total_number_of_values - value_index;
+
+		if( number_of_values > LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK )
+		{
+			number_of_values = LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK;
+		}
+		read_size = sizeof( uint64_t ) * number_of_values;
+
+		read_count = libbfio_handle_read_buffer(
+		              file_io_handle,
+		              values_data,
+		              read_size,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read entries.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     values_data,
+		     read_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			goto on_error;
+		}
+		for( data_offset = 0;
+		     data_offset < read_size;
+		     data_offset += 8 )
+		{
+			byte_stream_copy_to_uint64_little_endian(
+			 &( values_data[ data_offset ] ),
+			 metadata_index->entries[ value_index ] );
+
+			value_index++;
+		}
+	}
+	memory_free(
+	 values_data );
+
+	values_data = NULL;
+
+	if( stored_checksum != calculated_checksum )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_INPUT,
+		 LIBCERROR_INPUT_ERROR_CHECKSUM_MISMATCH,
+		 "%s: mismatch in checksum ( 0x%08" PRIx32 " != 0x%08" PRIx32 " ).",
+		 function,
+		 stored_checksum,
+		 calculated_checksum );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( values_data != NULL )
+	{
+		memory_free(
+		 values_data );
+	}
+	/* Do not leave a partially read metadata index behind
+	 */
+	memory_set(
+	 metadata_index->entries,
+	 0,
+	 metadata_index->entry_size * metadata_index->number_of_entries );
+
+	return( -1 );
+}
+
+/* Writes the metadata index to a metadata index file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_metadata_index_write_file_io_handle(
+     libqcow_metadata_index_t *metadata_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	qcow_metadata_index_file_header_t file_header;
+
+	uint8_t *values_data          = NULL;
+	static char *function         = "libqcow_metadata_index_write_file_io_handle";
+	size_t data_offset            = 0;
+	size_t number_of_values       = 0;
+	size_t total_number_of_values = 0;
+	size_t value_index            = 0;
+	size_t write_size             = 0;
+	ssize_t write_count           = 0;
+	uint32_t calculated_checksum  = 1;
+
+	if( metadata_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid metadata index.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_handle_seek_offset(
+	     file_io_handle,
+	     (off64_t) sizeof( qcow_metadata_index_file_header_t ),
+	     SEEK_SET,
+	     error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek entries offset.",
+		 function );
+
+		goto on_error;
+	}
+	values_data = (uint8_t *) memory_allocate(
+	                           sizeof( uint64_t ) * LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK );
+
+	if( values_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create values data.",
+		 function );
+
+		goto on_error;
+	}
+	total_number_of_values = metadata_index->number_of_entries * ( metadata_index->entry_size / 8 );
+
+	while( value_index < total_number_of_values )
+	{
+		number_of_values = total_number_of_values - value_index;
+
+		if( number_of_values > LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK )
+		{
+			number_of_values = LIBQCOW_METADATA_INDEX_VALUES_PER_BLOCK;
+		}
+		write_size = sizeof( uint64_t ) * number_of_values;
+
+		for( data_offset = 0;
+		     data_offset < write_size;
+		     data_offset += 8 )
+		{
+			byte_stream_copy_from_uint64_little_endian(
+			 &( values_data[ data_offset ] ),
+			 metadata_index->entries[ value_index ] );
+
+			value_index++;
+		}
+		if( libqcow_chain_index_calculate_checksum(
+		     &calculated_checksum,
+		     values_data,
+		     write_size,
+		     calculated_checksum,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate checksum.",
+			 function );
+
+			goto on_error;
+		}
+		write_count = libbfio_handle_write_buffer(
+		               file_io_handle,
+		               values_data,
+		               write_size,
+		               error );
+
+		if( write_count != (ssize_t) write_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write entries.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 values_data );
+
+	values_data = NULL;
+
+	/* The file header is written last so that an incomplete metadata index file
+	 * is not recognized
+	 */
+	if( memory_set(
+	     &file_header,
+	     0,
+	     sizeof( qcow_metadata_index_file_header_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear file header.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_copy(
+	     file_header.signature,
+	     qcow_metadata_index_file_signature,
+	     8 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy signature.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.format_version,
+	 1 );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.checksum,
+	 calculated_checksum );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.file_header_checksum,
+	 metadata_index->file_header_checksum );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.level1_table_checksum,
+	 metadata_index->level1_table_checksum );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.cluster_block_size,
+	 (uint64_t) metadata_index->cluster_block_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.media_size,
+	 metadata_index->media_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.number_of_entries,
+	 (uint64_t) metadata_index->number_of_entries );
+
+	byte_stream_copy_from_uint32_little_endian(
+	 file_header.entry_size,
+	 (uint32_t) metadata_index->entry_size );
+
+	byte_stream_copy_from_uint64_little_endian(
+	 file_header.file_size,
+	 metadata_index->file_size );
+
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               (uint8_t *) &file_header,
+	               sizeof( qcow_metadata_index_file_header_t ),
+	               0,
+	               error );
+
+	if( write_count != (ssize_t) sizeof( qcow_metadata_index_file_header_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( values_data != NULL )
+	{
+		memory_free(
+		 values_data );
+	}
+	return( -1 );
+}
+
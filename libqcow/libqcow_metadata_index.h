@@ -0,0 +1,125 @@
+/*
+ * Metadata index functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_METADATA_INDEX_H )
+#define _LIBQCOW_METADATA_INDEX_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_metadata_index libqcow_metadata_index_t;
+
+/* The metadata index is a decoded copy of the level 1 and level 2 tables of a file
+ * It contains per cluster block of the media the level 2 table entry, which allows
+ * to look up cluster blocks without reading the level 2 tables
+ */
+struct libqcow_metadata_index
+{
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The entry size, which is the size of a level 2 table entry
+	 */
+	size_t entry_size;
+
+	/* The file size of the image
+	 */
+	size64_t file_size;
+
+	/* The Adler-32 of the file header
+	 */
+	uint32_t file_header_checksum;
+
+	/* The Adler-32 of the level 1 table
+	 */
+	uint32_t level1_table_checksum;
+
+	/* The number of entries
+	 */
+	size_t number_of_entries;
+
+	/* The entries, for extended level 2 table entries the cluster descriptor
+	 * is followed by the subcluster bitmap
+	 */
+	uint64_t *entries;
+};
+
+int libqcow_metadata_index_initialize(
+     libqcow_metadata_index_t **metadata_index,
+     size64_t media_size,
+     size_t cluster_block_size,
+     size_t entry_size,
+     size64_t file_size,
+     uint32_t file_header_checksum,
+     uint32_t level1_table_checksum,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_free(
+     libqcow_metadata_index_t **metadata_index,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_get_memory_usage(
+     libqcow_metadata_index_t *metadata_index,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_get_entry_at_offset(
+     libqcow_metadata_index_t *metadata_index,
+     off64_t offset,
+     uint64_t *cluster_descriptor,
+     uint64_t *subcluster_bitmap,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_set_level2_table_data(
+     libqcow_metadata_index_t *metadata_index,
+     size_t entry_index,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_read_file_io_handle(
+     libqcow_metadata_index_t *metadata_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_metadata_index_write_file_io_handle(
+     libqcow_metadata_index_t *metadata_index,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_METADATA_INDEX_H ) */
+
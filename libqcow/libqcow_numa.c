@@ -0,0 +1,781 @@
+/*
+ * NUMA topology functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* cpu_set_t, sched_getcpu and sched_setaffinity are only defined by glibc
+ * when _GNU_SOURCE is defined
+ */
+#if !defined( _GNU_SOURCE )
+#define _GNU_SOURCE
+#endif
+
+#include <common.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_SCHED_H )
+#include <sched.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_numa.h"
+
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+
+/* Reads the CPU list of a NUMA node from sysfs
+ * Returns 1 if successful, 0 if the node does not exist or -1 on error
+ */
+static int libqcow_numa_topology_read_node_cpu_list(
+            int node_number,
+            char *cpu_list,
+            size_t cpu_list_size,
+            size_t *cpu_list_length,
+            libcerror_error_t **error )
+{
+	char path[ 64 ];
+
+	static char *function = "libqcow_numa_topology_read_node_cpu_list";
+	ssize_t read_count    = 0;
+	int file_descriptor   = -1;
+
+	if( narrow_string_snprintf(
+	     path,
+	     64,
+	     "/sys/devices/system/node/node%d/cpulist",
+	     node_number ) < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set path.",
+		 function );
+
+		return( -1 );
+	}
+	file_descriptor = open(
+	                   path,
+	                   O_RDONLY );
+
+	if( file_descriptor == -1 )
+	{
+		return( 0 );
+	}
+	read_count = read(
+	              file_descriptor,
+	              cpu_list,
+	              cpu_list_size - 1 );
+
+	close(
+	 file_descriptor );
+
+	if( read_count < 0 )
+	{
+		return( 0 );
+	}
+	cpu_list[ read_count ] = 0;
+
+	*cpu_list_length = (size_t) read_count;
+
+	return( 1 );
+}
+
+#endif /* defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE ) */
+
+/* Creates a NUMA topology
+ * The topology is determined from the nodes in sysfs and is restricted to
+ * the CPUs the process is allowed to run on, if not available the topology
+ * consists of a single node
+ * Make sure the value numa_topology is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_numa_topology_initialize(
+     libqcow_numa_topology_t **numa_topology,
+     libcerror_error_t **error )
+{
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+	char cpu_list[ 4096 ];
+
+	cpu_set_t allowed_cpus;
+
+	size_t cpu_list_length    = 0;
+	int number_of_allowed_cpus = 0;
+	int number_of_node_cpus    = 0;
+	int node_number            = 0;
+	int result                 = 0;
+#endif
+	static char *function     = "libqcow_numa_topology_initialize";
+	int cpu_index             = 0;
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( *numa_topology != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid NUMA topology value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*numa_topology = memory_allocate_structure(
+	                  libqcow_numa_topology_t );
+
+	if( *numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create NUMA topology.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *numa_topology,
+	     0,
+	     sizeof( libqcow_numa_topology_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear NUMA topology.",
+		 function );
+
+		memory_free(
+		 *numa_topology );
+
+		*numa_topology = NULL;
+
+		return( -1 );
+	}
+	( *numa_topology )->cpu_nodes = (int *) memory_allocate(
+	                                         sizeof( int ) * LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_CPUS );
+
+	if( ( *numa_topology )->cpu_nodes == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create CPU nodes.",
+		 function );
+
+		goto on_error;
+	}
+	for( cpu_index = 0;
+	     cpu_index < LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_CPUS;
+	     cpu_index++ )
+	{
+		( *numa_topology )->cpu_nodes[ cpu_index ] = -1;
+	}
+	( *numa_topology )->number_of_cpus = LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_CPUS;
+
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+	if( ( *numa_topology )->number_of_cpus > CPU_SETSIZE )
+	{
+		( *numa_topology )->number_of_cpus = CPU_SETSIZE;
+	}
+	CPU_ZERO(
+	 &allowed_cpus );
+
+	/* Without the affinity mask of the process the NUMA nodes cannot be
+	 * restricted to the CPUs of an existing cpuset, hence a single node is used
+	 */
+	if( sched_getaffinity(
+	     0,
+	     sizeof( cpu_set_t ),
+	     &allowed_cpus ) == 0 )
+	{
+		for( node_number = 0;
+		     node_number < LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_NODES;
+		     node_number++ )
+		{
+			result = libqcow_numa_topology_read_node_cpu_list(
+			          node_number,
+			          cpu_list,
+			          4096,
+			          &cpu_list_length,
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read CPU list of node: %d.",
+				 function,
+				 node_number );
+
+				goto on_error;
+			}
+			else if( result == 0 )
+			{
+				continue;
+			}
+			if( libqcow_numa_topology_set_cpu_list(
+			     *numa_topology,
+			     cpu_list,
+			     cpu_list_length,
+			     ( *numa_topology )->number_of_nodes,
+			     &number_of_node_cpus,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set CPU list of node: %d.",
+				 function,
+				 node_number );
+
+				goto on_error;
+			}
+			number_of_allowed_cpus = 0;
+
+			for( cpu_index = 0;
+			     cpu_index < ( *numa_topology )->number_of_cpus;
+			     cpu_index++ )
+			{
+				if( ( *numa_topology )->cpu_nodes[ cpu_index ] != ( *numa_topology )->number_of_nodes )
+				{
+					continue;
+				}
+				if( CPU_ISSET(
+				     cpu_index,
+				     &allowed_cpus ) == 0 )
+				{
+					( *numa_topology )->cpu_nodes[ cpu_index ] = -1;
+				}
+				else
+				{
+					number_of_allowed_cpus++;
+				}
+			}
+			/* Nodes without CPUs the process is allowed to run on, such as memory only nodes, are ignored
+			 */
+			if( number_of_allowed_cpus > 0 )
+			{
+				( *numa_topology )->number_of_nodes += 1;
+			}
+		}
+	}
+#endif /* defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE ) */
+
+	if( ( *numa_topology )->number_of_nodes == 0 )
+	{
+		( *numa_topology )->number_of_nodes = 1;
+	}
+	return( 1 );
+
+on_error:
+	if( *numa_topology != NULL )
+	{
+		if( ( *numa_topology )->cpu_nodes != NULL )
+		{
+			memory_free(
+			 ( *numa_topology )->cpu_nodes );
+		}
+		memory_free(
+		 *numa_topology );
+
+		*numa_topology = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a NUMA topology
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_numa_topology_free(
+     libqcow_numa_topology_t **numa_topology,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_numa_topology_free";
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( *numa_topology != NULL )
+	{
+		if( ( *numa_topology )->cpu_nodes != NULL )
+		{
+			memory_free(
+			 ( *numa_topology )->cpu_nodes );
+		}
+		memory_free(
+		 *numa_topology );
+
+		*numa_topology = NULL;
+	}
+	return( 1 );
+}
+
+/* Assigns the CPUs in a CPU list to a node
+ * The CPU list is formatted as in sysfs, such as "0-3,8-11", CPUs beyond the
+ * number of CPUs of the topology are ignored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_numa_topology_set_cpu_list(
+     libqcow_numa_topology_t *numa_topology,
+     const char *cpu_list,
+     size_t cpu_list_length,
+     int node_index,
+     int *number_of_cpus,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_numa_topology_set_cpu_list";
+	size_t cpu_list_index      = 0;
+	uint32_t first_cpu_index   = 0;
+	uint32_t last_cpu_index    = 0;
+	uint32_t cpu_index         = 0;
+	int number_of_set_cpus     = 0;
+	int range_value_index      = 0;
+	int range_value_has_digits = 0;
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( cpu_list == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid CPU list.",
+		 function );
+
+		return( -1 );
+	}
+	if( cpu_list_length > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid CPU list length value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( node_index < 0 )
+	 || ( node_index >= LIBQCOW_MAXIMUM_NUMBER_OF_NUMA_NODES ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid node index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_cpus == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of CPUs.",
+		 function );
+
+		return( -1 );
+	}
+	/* The CPU list consists of comma separated CPU indexes or ranges of CPU indexes
+	 * and is terminated by an end-of-line character, an empty list represents
+	 * a node without CPUs
+	 */
+	if( ( cpu_list_length == 0 )
+	 || ( cpu_list[ 0 ] == 0 )
+	 || ( cpu_list[ 0 ] == '\n' ) )
+	{
+		*number_of_cpus = 0;
+
+		return( 1 );
+	}
+	while( cpu_list_index <= cpu_list_length )
+	{
+		if( ( cpu_list_index == cpu_list_length )
+		 || ( cpu_list[ cpu_list_index ] == 0 )
+		 || ( cpu_list[ cpu_list_index ] == '\n' )
+		 || ( cpu_list[ cpu_list_index ] == ',' ) )
+		{
+			if( range_value_has_digits == 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+				 "%s: missing CPU index at offset: %" PRIzd ".",
+				 function,
+				 cpu_list_index );
+
+				return( -1 );
+			}
+			if( range_value_index == 0 )
+			{
+				last_cpu_index = first_cpu_index;
+			}
+			if( last_cpu_index < first_cpu_index )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+				 "%s: invalid CPU range: %" PRIu32 "-%" PRIu32 ".",
+				 function,
+				 first_cpu_index,
+				 last_cpu_index );
+
+				return( -1 );
+			}
+			for( cpu_index = first_cpu_index;
+			     ( cpu_index <= last_cpu_index )
+			     && ( cpu_index < (uint32_t) numa_topology->number_of_cpus );
+			     cpu_index++ )
+			{
+				numa_topology->cpu_nodes[ cpu_index ] = node_index;
+
+				number_of_set_cpus++;
+			}
+			if( ( cpu_list_index == cpu_list_length )
+			 || ( cpu_list[ cpu_list_index ] != ',' ) )
+			{
+				break;
+			}
+			first_cpu_index        = 0;
+			last_cpu_index         = 0;
+			range_value_index      = 0;
+			range_value_has_digits = 0;
+		}
+		else if( ( cpu_list[ cpu_list_index ] == '-' )
+		      && ( range_value_index == 0 )
+		      && ( range_value_has_digits != 0 ) )
+		{
+			range_value_index      = 1;
+			range_value_has_digits = 0;
+		}
+		else if( ( cpu_list[ cpu_list_index ] >= '0' )
+		      && ( cpu_list[ cpu_list_index ] <= '9' ) )
+		{
+			cpu_index = ( range_value_index == 0 ) ? first_cpu_index : last_cpu_index;
+
+			if( cpu_index > 0x0000ffffUL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid CPU index value out of bounds.",
+				 function );
+
+				return( -1 );
+			}
+			cpu_index = ( cpu_index * 10 ) + (uint32_t) ( cpu_list[ cpu_list_index ] - '0' );
+
+			if( range_value_index == 0 )
+			{
+				first_cpu_index = cpu_index;
+			}
+			else
+			{
+				last_cpu_index = cpu_index;
+			}
+			range_value_has_digits = 1;
+		}
+		else
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported character: 0x%02" PRIx8 " at offset: %" PRIzd ".",
+			 function,
+			 (uint8_t) cpu_list[ cpu_list_index ],
+			 cpu_list_index );
+
+			return( -1 );
+		}
+		cpu_list_index++;
+	}
+	*number_of_cpus = number_of_set_cpus;
+
+	return( 1 );
+}
+
+/* Retrieves the number of nodes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_numa_topology_get_number_of_nodes(
+     libqcow_numa_topology_t *numa_topology,
+     int *number_of_nodes,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_numa_topology_get_number_of_nodes";
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_nodes == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of nodes.",
+		 function );
+
+		return( -1 );
+	}
+	*number_of_nodes = numa_topology->number_of_nodes;
+
+	return( 1 );
+}
+
+/* Retrieves the node of a specific CPU
+ * Returns 1 if successful, 0 if the CPU is not available or -1 on error
+ */
+int libqcow_numa_topology_get_node_of_cpu(
+     libqcow_numa_topology_t *numa_topology,
+     int cpu_index,
+     int *node_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_numa_topology_get_node_of_cpu";
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( node_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid node index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cpu_index < 0 )
+	 || ( cpu_index >= numa_topology->number_of_cpus )
+	 || ( numa_topology->cpu_nodes[ cpu_index ] < 0 ) )
+	{
+		return( 0 );
+	}
+	*node_index = numa_topology->cpu_nodes[ cpu_index ];
+
+	return( 1 );
+}
+
+/* Retrieves the node of the CPU the calling thread is running on
+ * The first node is used if the CPU cannot be determined
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_numa_topology_get_current_node(
+     libqcow_numa_topology_t *numa_topology,
+     int *node_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_numa_topology_get_current_node";
+	int cpu_index         = -1;
+	int result            = 0;
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( node_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid node index.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+	if( numa_topology->number_of_nodes > 1 )
+	{
+		cpu_index = sched_getcpu();
+	}
+#endif
+	result = libqcow_numa_topology_get_node_of_cpu(
+	          numa_topology,
+	          cpu_index,
+	          node_index,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve node of CPU: %d.",
+		 function,
+		 cpu_index );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		*node_index = 0;
+	}
+	return( 1 );
+}
+
+/* Binds the calling thread to the CPUs of a specific node
+ * Returns 1 if successful, 0 if not supported or -1 on error
+ */
+int libqcow_numa_topology_bind_thread(
+     libqcow_numa_topology_t *numa_topology,
+     int node_index,
+     libcerror_error_t **error )
+{
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+	cpu_set_t node_cpus;
+
+	int cpu_index           = 0;
+	int number_of_node_cpus = 0;
+#endif
+	static char *function   = "libqcow_numa_topology_bind_thread";
+
+	if( numa_topology == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NUMA topology.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( node_index < 0 )
+	 || ( node_index >= numa_topology->number_of_nodes ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid node index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_SCHED_H ) && defined( HAVE_SCHED_GETAFFINITY ) && defined( HAVE_SCHED_GETCPU ) && defined( HAVE_SCHED_SETAFFINITY ) && defined( CPU_SETSIZE )
+	CPU_ZERO(
+	 &node_cpus );
+
+	for( cpu_index = 0;
+	     cpu_index < numa_topology->number_of_cpus;
+	     cpu_index++ )
+	{
+		if( numa_topology->cpu_nodes[ cpu_index ] == node_index )
+		{
+			CPU_SET(
+			 cpu_index,
+			 &node_cpus );
+
+			number_of_node_cpus++;
+		}
+	}
+	/* A failure to set the affinity, for example due to changes of the cpuset
+	 * of the process, is not considered an error since the thread continues
+	 * to run on its current CPUs
+	 */
+	if( ( number_of_node_cpus > 0 )
+	 && ( sched_setaffinity(
+	       0,
+	       sizeof( cpu_set_t ),
+	       &node_cpus ) == 0 ) )
+	{
+		return( 1 );
+	}
+#endif
+	return( 0 );
+}
+
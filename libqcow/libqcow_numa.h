@@ -0,0 +1,95 @@
+/*
+ * NUMA topology functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_NUMA_H )
+#define _LIBQCOW_NUMA_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_numa_topology libqcow_numa_topology_t;
+
+struct libqcow_numa_topology
+{
+	/* The number of NUMA nodes that contain CPUs the process is allowed to run on
+	 */
+	int number_of_nodes;
+
+	/* The number of CPUs
+	 */
+	int number_of_cpus;
+
+	/* The node index per CPU, where -1 represents a CPU that is not available
+	 * The node indexes are consecutive and do not necessarily match the node
+	 * numbers of the operating system
+	 */
+	int *cpu_nodes;
+};
+
+int libqcow_numa_topology_initialize(
+     libqcow_numa_topology_t **numa_topology,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_free(
+     libqcow_numa_topology_t **numa_topology,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_set_cpu_list(
+     libqcow_numa_topology_t *numa_topology,
+     const char *cpu_list,
+     size_t cpu_list_length,
+     int node_index,
+     int *number_of_cpus,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_get_number_of_nodes(
+     libqcow_numa_topology_t *numa_topology,
+     int *number_of_nodes,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_get_node_of_cpu(
+     libqcow_numa_topology_t *numa_topology,
+     int cpu_index,
+     int *node_index,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_get_current_node(
+     libqcow_numa_topology_t *numa_topology,
+     int *node_index,
+     libcerror_error_t **error );
+
+int libqcow_numa_topology_bind_thread(
+     libqcow_numa_topology_t *numa_topology,
+     int node_index,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_NUMA_H ) */
+
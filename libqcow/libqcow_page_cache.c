@@ -0,0 +1,440 @@
+/*
+ * Page cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_page_cache.h"
+
+/* Creates a page cache
+ * Make sure the value page_cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_page_cache_initialize(
+     libqcow_page_cache_t **page_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_page_cache_initialize";
+
+	if( page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *page_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid page cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*page_cache = memory_allocate_structure(
+	               libqcow_page_cache_t );
+
+	if( *page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create page cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *page_cache,
+	     0,
+	     sizeof( libqcow_page_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear page cache.",
+		 function );
+
+		goto on_error;
+	}
+	( *page_cache )->file_descriptor = -1;
+
+	return( 1 );
+
+on_error:
+	if( *page_cache != NULL )
+	{
+		memory_free(
+		 *page_cache );
+
+		*page_cache = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a page cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_page_cache_free(
+     libqcow_page_cache_t **page_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_page_cache_free";
+	int result            = 1;
+
+	if( page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *page_cache != NULL )
+	{
+		if( libqcow_page_cache_close(
+		     *page_cache,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close page cache.",
+			 function );
+
+			result = -1;
+		}
+		memory_free(
+		 *page_cache );
+
+		*page_cache = NULL;
+	}
+	return( result );
+}
+
+/* Opens the page cache of the file of a (named) file IO handle
+ * Returns 1 if successful, 0 if not supported or -1 on error
+ */
+int libqcow_page_cache_open(
+     libqcow_page_cache_t *page_cache,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_page_cache_open";
+
+#if defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT )
+	char *filename        = NULL;
+	size_t filename_size  = 0;
+#endif
+
+	if( page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( page_cache->file_descriptor != -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid page cache - file descriptor value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT )
+	if( libbfio_file_get_name_size(
+	     file_io_handle,
+	     &filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename size.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( filename_size == 0 )
+	 || ( filename_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid filename size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	filename = narrow_string_allocate(
+	            filename_size );
+
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_get_name(
+	     file_io_handle,
+	     filename,
+	     filename_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve filename.",
+		 function );
+
+		goto on_error;
+	}
+	page_cache->file_descriptor = open(
+	                               filename,
+	                               O_RDONLY );
+
+	if( page_cache->file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	memory_free(
+	 filename );
+
+	return( 1 );
+
+on_error:
+	if( filename != NULL )
+	{
+		memory_free(
+		 filename );
+	}
+	return( -1 );
+#else
+	return( 0 );
+#endif /* defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT ) */
+}
+
+/* Closes the page cache
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_page_cache_close(
+     libqcow_page_cache_t *page_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_page_cache_close";
+	int result            = 0;
+
+	if( page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page cache.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT )
+	if( page_cache->file_descriptor != -1 )
+	{
+		if( close(
+		     page_cache->file_descriptor ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file descriptor.",
+			 function );
+
+			result = -1;
+		}
+	}
+#endif
+	page_cache->file_descriptor = -1;
+
+	return( result );
+}
+
+/* Passes access advice about a range of the file to the page cache of the operating system
+ * Only LIBQCOW_ADVICE_WILLNEED and LIBQCOW_ADVICE_DONTNEED are passed, since the other
+ * advice applies to the file descriptor it is given for, which is not used for reading
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_page_cache_advise(
+     libqcow_page_cache_t *page_cache,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_page_cache_advise";
+
+#if defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT )
+	int result            = 0;
+	int system_advice     = 0;
+#endif
+
+	if( page_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid page cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( size > (size64_t) INT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( advice != LIBQCOW_ADVICE_WILLNEED )
+	 && ( advice != LIBQCOW_ADVICE_DONTNEED ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported advice: %d.",
+		 function,
+		 advice );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT )
+	if( page_cache->file_descriptor == -1 )
+	{
+		return( 1 );
+	}
+	if( advice == LIBQCOW_ADVICE_WILLNEED )
+	{
+		system_advice = POSIX_FADV_WILLNEED;
+	}
+	else
+	{
+		system_advice = POSIX_FADV_DONTNEED;
+	}
+	result = posix_fadvise(
+	          page_cache->file_descriptor,
+	          (off_t) offset,
+	          (off_t) size,
+	          system_advice );
+
+	if( result != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set advice with error: %d.",
+		 function,
+		 result );
+
+		return( -1 );
+	}
+#endif /* defined( HAVE_LIBQCOW_PAGE_CACHE_SUPPORT ) */
+
+	return( 1 );
+}
+
@@ -0,0 +1,80 @@
+/*
+ * Page cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_PAGE_CACHE_H )
+#define _LIBQCOW_PAGE_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if !defined( WINAPI ) && defined( HAVE_FCNTL_H ) && defined( HAVE_UNISTD_H ) && defined( HAVE_POSIX_FADVISE )
+#define HAVE_LIBQCOW_PAGE_CACHE_SUPPORT
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_page_cache libqcow_page_cache_t;
+
+/* The page cache passes access advice about ranges of a file to the page cache
+ * of the operating system, using a file descriptor that is not used for reading
+ */
+struct libqcow_page_cache
+{
+	/* The file descriptor
+	 */
+	int file_descriptor;
+};
+
+int libqcow_page_cache_initialize(
+     libqcow_page_cache_t **page_cache,
+     libcerror_error_t **error );
+
+int libqcow_page_cache_free(
+     libqcow_page_cache_t **page_cache,
+     libcerror_error_t **error );
+
+int libqcow_page_cache_open(
+     libqcow_page_cache_t *page_cache,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_page_cache_close(
+     libqcow_page_cache_t *page_cache,
+     libcerror_error_t **error );
+
+int libqcow_page_cache_advise(
+     libqcow_page_cache_t *page_cache,
+     off64_t offset,
+     size64_t size,
+     int advice,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_PAGE_CACHE_H ) */
+
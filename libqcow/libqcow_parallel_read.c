@@ -0,0 +1,1409 @@
+/*
+ * Parallel read functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_parallel_read.h"
+#include "libqcow_types.h"
+
+/* Creates a parallel read
+ * Make sure the value parallel_read is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_parallel_read_initialize(
+     libqcow_parallel_read_t **parallel_read,
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     size64_t partition_size,
+     int number_of_workers,
+     int flags,
+     int (*callback)(
+            off64_t chunk_offset,
+            const uint8_t *chunk_data,
+            size_t chunk_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error )
+{
+	static char *function     = "libqcow_parallel_read_initialize";
+	uint64_t number_of_chunks = 0;
+	uint64_t range_index      = 0;
+	size_t workers_size       = 0;
+	int worker_index          = 0;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	if( *parallel_read != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid parallel read value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( size == 0 )
+	 || ( size > (size64_t) ( INT64_MAX - offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( chunk_size == 0 )
+	 || ( chunk_size > (size_t) LIBQCOW_PARALLEL_READ_MAXIMUM_CHUNK_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid chunk size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_workers <= 0 )
+	 || ( number_of_workers > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of workers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( callback == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid callback function.",
+		 function );
+
+		return( -1 );
+	}
+	*parallel_read = memory_allocate_structure(
+	                  libqcow_parallel_read_t );
+
+	if( *parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create parallel read.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *parallel_read,
+	     0,
+	     sizeof( libqcow_parallel_read_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear parallel read.",
+		 function );
+
+		memory_free(
+		 *parallel_read );
+
+		*parallel_read = NULL;
+
+		return( -1 );
+	}
+	( *parallel_read )->file              = file;
+	( *parallel_read )->offset            = offset;
+	( *parallel_read )->end_offset        = offset + (off64_t) size;
+	( *parallel_read )->chunk_size        = chunk_size;
+	( *parallel_read )->first_chunk_index = (uint64_t) offset / chunk_size;
+	( *parallel_read )->end_chunk_index   = ( (uint64_t) ( *parallel_read )->end_offset + chunk_size - 1 ) / chunk_size;
+	( *parallel_read )->flags             = flags;
+	( *parallel_read )->callback          = callback;
+	( *parallel_read )->user_data         = user_data;
+	( *parallel_read )->result            = 1;
+
+	( *parallel_read )->number_of_chunks_per_partition = partition_size / chunk_size;
+
+	if( ( *parallel_read )->number_of_chunks_per_partition == 0 )
+	{
+		( *parallel_read )->number_of_chunks_per_partition = 1;
+	}
+	( *parallel_read )->next_chunk_index          = ( *parallel_read )->first_chunk_index;
+	( *parallel_read )->next_delivery_chunk_index = ( *parallel_read )->first_chunk_index;
+
+	number_of_chunks = ( *parallel_read )->end_chunk_index - ( *parallel_read )->first_chunk_index;
+
+	if( (uint64_t) number_of_workers > number_of_chunks )
+	{
+		number_of_workers = (int) number_of_chunks;
+	}
+	workers_size = sizeof( libqcow_parallel_read_worker_t ) * number_of_workers;
+
+	( *parallel_read )->workers = (libqcow_parallel_read_worker_t *) memory_allocate(
+	                                                                  workers_size );
+
+	if( ( *parallel_read )->workers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create workers.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *parallel_read )->workers,
+	     0,
+	     workers_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear workers.",
+		 function );
+
+		goto on_error;
+	}
+	( *parallel_read )->number_of_workers = number_of_workers;
+
+	/* Every worker starts with a range of consecutive chunks, the ranges start
+	 * at a partition boundary so that the workers read different level 2 tables
+	 */
+	for( worker_index = 0;
+	     worker_index < number_of_workers;
+	     worker_index++ )
+	{
+		( *parallel_read )->workers[ worker_index ].parallel_read = *parallel_read;
+
+		if( worker_index == 0 )
+		{
+			range_index = ( *parallel_read )->first_chunk_index;
+		}
+		else
+		{
+			range_index = ( *parallel_read )->first_chunk_index
+			            + ( ( number_of_chunks * (uint64_t) worker_index ) / (uint64_t) number_of_workers );
+
+			range_index = ( ( range_index + ( *parallel_read )->number_of_chunks_per_partition - 1 )
+			            / ( *parallel_read )->number_of_chunks_per_partition )
+			            * ( *parallel_read )->number_of_chunks_per_partition;
+
+			if( range_index > ( *parallel_read )->end_chunk_index )
+			{
+				range_index = ( *parallel_read )->end_chunk_index;
+			}
+			( *parallel_read )->workers[ worker_index - 1 ].range_end_index = range_index;
+		}
+		( *parallel_read )->workers[ worker_index ].range_start_index = range_index;
+	}
+	( *parallel_read )->workers[ number_of_workers - 1 ].range_end_index = ( *parallel_read )->end_chunk_index;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *parallel_read )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( ( *parallel_read )->delivery_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create delivery condition.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( *parallel_read != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( ( *parallel_read )->mutex != NULL )
+		{
+			libcthreads_mutex_free(
+			 &( ( *parallel_read )->mutex ),
+			 NULL );
+		}
+#endif
+		if( ( *parallel_read )->workers != NULL )
+		{
+			memory_free(
+			 ( *parallel_read )->workers );
+		}
+		memory_free(
+		 *parallel_read );
+
+		*parallel_read = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a parallel read
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_parallel_read_free(
+     libqcow_parallel_read_t **parallel_read,
+     libcerror_error_t **error )
+{
+	libqcow_parallel_read_worker_t *worker = NULL;
+	static char *function                  = "libqcow_parallel_read_free";
+	int result                             = 1;
+	int worker_index                       = 0;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	if( *parallel_read != NULL )
+	{
+		for( worker_index = 0;
+		     worker_index < ( *parallel_read )->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( ( *parallel_read )->workers[ worker_index ] );
+
+			if( ( worker->reader != NULL )
+			 && ( worker->reader != ( *parallel_read )->file ) )
+			{
+				if( libqcow_file_free(
+				     &( worker->reader ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free reader: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+			if( worker->chunk_data != NULL )
+			{
+				memory_free(
+				 worker->chunk_data );
+			}
+		}
+		memory_free(
+		 ( *parallel_read )->workers );
+
+		if( ( *parallel_read )->worker_error != NULL )
+		{
+			libcerror_error_free(
+			 &( ( *parallel_read )->worker_error ) );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_free(
+		     &( ( *parallel_read )->delivery_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free delivery condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_free(
+		     &( ( *parallel_read )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *parallel_read );
+
+		*parallel_read = NULL;
+	}
+	return( result );
+}
+
+/* Retrieves the index of the next chunk to read by a specific worker
+ * The chunk is taken from the range of the worker, if that range is empty
+ * the upper half of the largest range of the other workers is stolen
+ * Returns 1 if successful, 0 if no chunks are left or -1 on error
+ */
+int libqcow_parallel_read_get_next_chunk(
+     libqcow_parallel_read_t *parallel_read,
+     int worker_index,
+     uint64_t *chunk_index,
+     libcerror_error_t **error )
+{
+	libqcow_parallel_read_worker_t *victim_worker = NULL;
+	libqcow_parallel_read_worker_t *worker        = NULL;
+	static char *function                         = "libqcow_parallel_read_get_next_chunk";
+	uint64_t largest_number_of_chunks             = 0;
+	uint64_t number_of_chunks                     = 0;
+	uint64_t split_index                          = 0;
+	int result                                    = 0;
+	int victim_worker_index                       = 0;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( worker_index < 0 )
+	 || ( worker_index >= parallel_read->number_of_workers ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid worker index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chunk index.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     parallel_read->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( parallel_read->abort != 0 )
+	{
+		result = 0;
+	}
+	else if( ( parallel_read->flags & LIBQCOW_PARALLEL_READ_FLAG_ORDERED ) != 0 )
+	{
+		/* With ordered delivery the chunks are taken in order so that the chunk
+		 * that is delivered next is always read by a worker that is not waiting
+		 */
+		if( parallel_read->next_chunk_index < parallel_read->end_chunk_index )
+		{
+			*chunk_index = parallel_read->next_chunk_index;
+
+			parallel_read->next_chunk_index += 1;
+
+			result = 1;
+		}
+	}
+	else
+	{
+		worker = &( parallel_read->workers[ worker_index ] );
+
+		if( worker->range_start_index >= worker->range_end_index )
+		{
+			for( victim_worker_index = 0;
+			     victim_worker_index < parallel_read->number_of_workers;
+			     victim_worker_index++ )
+			{
+				number_of_chunks = parallel_read->workers[ victim_worker_index ].range_end_index
+				                 - parallel_read->workers[ victim_worker_index ].range_start_index;
+
+				if( number_of_chunks > largest_number_of_chunks )
+				{
+					victim_worker            = &( parallel_read->workers[ victim_worker_index ] );
+					largest_number_of_chunks = number_of_chunks;
+				}
+			}
+			if( victim_worker != NULL )
+			{
+				split_index = victim_worker->range_start_index + ( largest_number_of_chunks / 2 );
+
+				/* The stolen range starts at a partition boundary if the range contains one
+				 */
+				if( parallel_read->number_of_chunks_per_partition > 1 )
+				{
+					number_of_chunks = ( ( split_index + parallel_read->number_of_chunks_per_partition - 1 )
+					                 / parallel_read->number_of_chunks_per_partition )
+					                 * parallel_read->number_of_chunks_per_partition;
+
+					if( number_of_chunks < victim_worker->range_end_index )
+					{
+						split_index = number_of_chunks;
+					}
+				}
+				worker->range_start_index = split_index;
+				worker->range_end_index   = victim_worker->range_end_index;
+
+				victim_worker->range_end_index = split_index;
+			}
+		}
+		if( worker->range_start_index < worker->range_end_index )
+		{
+			*chunk_index = worker->range_start_index;
+
+			worker->range_start_index += 1;
+
+			result = 1;
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     parallel_read->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Determines if a chunk contains no data
+ * A chunk contains no data if it consists of sparse or zero extents, where
+ * sparse extents of a file with a backing file can contain backing file data
+ * Returns 1 if the chunk contains no data, 0 if not or -1 on error
+ */
+int libqcow_parallel_read_chunk_is_hole(
+     libqcow_parallel_read_t *parallel_read,
+     libqcow_file_t *reader,
+     off64_t chunk_offset,
+     size_t chunk_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_reader = NULL;
+	static char *function                    = "libqcow_parallel_read_chunk_is_hole";
+	size64_t extent_size                     = 0;
+	off64_t chunk_end_offset                 = 0;
+	off64_t extent_file_offset               = 0;
+	off64_t extent_offset                    = 0;
+	uint32_t extent_flags                    = 0;
+	uint32_t hole_extent_flags               = 0;
+	int result                               = 0;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	if( reader == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reader.",
+		 function );
+
+		return( -1 );
+	}
+	internal_reader = (libqcow_internal_file_t *) reader;
+
+	hole_extent_flags = LIBQCOW_EXTENT_FLAG_IS_SPARSE | LIBQCOW_EXTENT_FLAG_IS_ZERO;
+
+	if( ( internal_reader->parent_file != NULL )
+	 || ( internal_reader->io_handle->backing_filename != NULL ) )
+	{
+		hole_extent_flags = LIBQCOW_EXTENT_FLAG_IS_ZERO;
+	}
+	chunk_end_offset = chunk_offset + (off64_t) chunk_size;
+
+	while( chunk_offset < chunk_end_offset )
+	{
+		result = libqcow_file_get_extent_at_offset(
+		          reader,
+		          chunk_offset,
+		          &extent_offset,
+		          &extent_size,
+		          &extent_file_offset,
+		          &extent_flags,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 chunk_offset,
+			 chunk_offset );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		if( ( extent_flags & hole_extent_flags ) == 0 )
+		{
+			return( 0 );
+		}
+		chunk_offset = extent_offset + (off64_t) extent_size;
+	}
+	return( 1 );
+}
+
+/* Delivers a chunk to the callback function
+ * With ordered delivery the chunk is delivered after the preceding chunks
+ * A chunk without data is not passed to the callback function
+ * Returns 1 if successful, 0 if stopped or -1 on error
+ */
+int libqcow_parallel_read_deliver_chunk(
+     libqcow_parallel_read_t *parallel_read,
+     uint64_t chunk_index,
+     off64_t chunk_offset,
+     const uint8_t *chunk_data,
+     size_t chunk_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_parallel_read_deliver_chunk";
+	int is_ordered        = 0;
+	int result            = 1;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	is_ordered = (int) ( ( parallel_read->flags & LIBQCOW_PARALLEL_READ_FLAG_ORDERED ) != 0 );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( is_ordered != 0 )
+	{
+		if( libcthreads_mutex_grab(
+		     parallel_read->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+		while( ( parallel_read->abort == 0 )
+		    && ( parallel_read->next_delivery_chunk_index != chunk_index ) )
+		{
+			if( libcthreads_condition_wait(
+			     parallel_read->delivery_condition,
+			     parallel_read->mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to wait for delivery condition.",
+				 function );
+
+				libcthreads_mutex_release(
+				 parallel_read->mutex,
+				 NULL );
+
+				return( -1 );
+			}
+		}
+		if( parallel_read->abort != 0 )
+		{
+			result = 0;
+		}
+		if( libcthreads_mutex_release(
+		     parallel_read->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			return( -1 );
+		}
+		if( result == 0 )
+		{
+			return( 0 );
+		}
+	}
+#endif
+	/* With ordered delivery only one worker at a time calls the callback function
+	 */
+	if( chunk_data != NULL )
+	{
+		result = parallel_read->callback(
+		          chunk_offset,
+		          chunk_data,
+		          chunk_size,
+		          parallel_read->user_data );
+	}
+	if( is_ordered != 0 )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     parallel_read->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+		parallel_read->next_delivery_chunk_index = chunk_index + 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_broadcast(
+		     parallel_read->delivery_condition,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to broadcast delivery condition.",
+			 function );
+
+			libcthreads_mutex_release(
+			 parallel_read->mutex,
+			 NULL );
+
+			return( -1 );
+		}
+		if( libcthreads_mutex_release(
+		     parallel_read->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			return( -1 );
+		}
+#endif
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: callback function failed for chunk at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 chunk_offset,
+		 chunk_offset );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Reads and delivers chunks by a specific worker until no chunks are left
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_parallel_read_worker_run(
+     libqcow_parallel_read_t *parallel_read,
+     int worker_index,
+     libcerror_error_t **error )
+{
+	libqcow_io_scheduler_t *io_scheduler   = NULL;
+	libqcow_parallel_read_worker_t *worker = NULL;
+	const uint8_t *chunk_data              = NULL;
+	void *chunk_buffer                     = NULL;
+	static char *function                  = "libqcow_parallel_read_worker_run";
+	uint64_t chunk_index                   = 0;
+	size_t chunk_size                      = 0;
+	ssize_t read_count                     = 0;
+	off64_t chunk_end_offset               = 0;
+	off64_t chunk_offset                   = 0;
+	int is_hole                            = 0;
+	int result                             = 0;
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( worker_index < 0 )
+	 || ( worker_index >= parallel_read->number_of_workers ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid worker index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	worker = &( parallel_read->workers[ worker_index ] );
+
+	if( libqcow_internal_file_get_io_scheduler(
+	     (libqcow_internal_file_t *) worker->reader,
+	     &io_scheduler,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve IO scheduler.",
+		 function );
+
+		goto on_error;
+	}
+	do
+	{
+		result = libqcow_parallel_read_get_next_chunk(
+		          parallel_read,
+		          worker_index,
+		          &chunk_index,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve next chunk.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		chunk_offset     = (off64_t) ( chunk_index * parallel_read->chunk_size );
+		chunk_end_offset = chunk_offset + (off64_t) parallel_read->chunk_size;
+
+		if( chunk_offset < parallel_read->offset )
+		{
+			chunk_offset = parallel_read->offset;
+		}
+		if( chunk_end_offset > parallel_read->end_offset )
+		{
+			chunk_end_offset = parallel_read->end_offset;
+		}
+		chunk_size = (size_t) ( chunk_end_offset - chunk_offset );
+		is_hole    = 0;
+
+		if( ( parallel_read->flags & LIBQCOW_PARALLEL_READ_FLAG_INCLUDE_HOLES ) == 0 )
+		{
+			is_hole = libqcow_parallel_read_chunk_is_hole(
+			           parallel_read,
+			           worker->reader,
+			           chunk_offset,
+			           chunk_size,
+			           error );
+
+			if( is_hole == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to determine if chunk at offset: %" PRIi64 " (0x%08" PRIx64 ") contains data.",
+				 function,
+				 chunk_offset,
+				 chunk_offset );
+
+				goto on_error;
+			}
+		}
+		chunk_data = NULL;
+
+		if( is_hole == 0 )
+		{
+			/* The chunks are background IO, they yield to queued read requests
+			 * and are subject to the IO limits of the background IO priority
+			 */
+			result = libqcow_io_scheduler_acquire(
+			          io_scheduler,
+			          LIBQCOW_IO_PRIORITY_BACKGROUND,
+			          chunk_size,
+			          &( parallel_read->abort ),
+			          error );
+
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to acquire IO scheduler.",
+				 function );
+
+				goto on_error;
+			}
+			else if( result == 0 )
+			{
+				break;
+			}
+			if( parallel_read->read_in_file_order != 0 )
+			{
+				chunk_buffer = (void *) worker->chunk_data;
+
+				read_count = libqcow_file_read_vector(
+				              worker->reader,
+				              &chunk_buffer,
+				              &chunk_size,
+				              &chunk_offset,
+				              1,
+				              error );
+			}
+			else
+			{
+				read_count = libqcow_file_read_buffer_at_offset(
+				              worker->reader,
+				              worker->chunk_data,
+				              chunk_size,
+				              chunk_offset,
+				              error );
+			}
+
+			if( read_count != (ssize_t) chunk_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read chunk at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 chunk_offset,
+				 chunk_offset );
+
+				goto on_error;
+			}
+			chunk_data = worker->chunk_data;
+		}
+		result = libqcow_parallel_read_deliver_chunk(
+		          parallel_read,
+		          chunk_index,
+		          chunk_offset,
+		          chunk_data,
+		          chunk_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to deliver chunk at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 chunk_offset,
+			 chunk_offset );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			if( libqcow_parallel_read_stop(
+			     parallel_read,
+			     0,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to stop parallel read.",
+				 function );
+
+				goto on_error;
+			}
+		}
+	}
+	while( result == 1 );
+
+	return( 1 );
+
+on_error:
+	libqcow_parallel_read_stop(
+	 parallel_read,
+	 -1,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Stops the workers of a parallel read
+ * The result is 0 if stopped by the callback function or -1 on error
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_parallel_read_stop(
+     libqcow_parallel_read_t *parallel_read,
+     int result,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_parallel_read_stop";
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     parallel_read->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	parallel_read->abort = 1;
+
+	if( ( result == -1 )
+	 || ( parallel_read->result == 1 ) )
+	{
+		parallel_read->result = result;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* Wake up the workers that wait for their chunk to be delivered
+	 */
+	if( libcthreads_condition_broadcast(
+	     parallel_read->delivery_condition,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to broadcast delivery condition.",
+		 function );
+
+		libcthreads_mutex_release(
+		 parallel_read->mutex,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_release(
+	     parallel_read->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Keeps the error of the first worker that failed
+ * The error is freed if the error of another worker was kept
+ */
+void libqcow_parallel_read_set_worker_error(
+      libqcow_parallel_read_t *parallel_read,
+      libcerror_error_t **worker_error )
+{
+	if( ( parallel_read == NULL )
+	 || ( worker_error == NULL )
+	 || ( *worker_error == NULL ) )
+	{
+		return;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 *worker_error );
+	}
+#endif
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     parallel_read->mutex,
+	     NULL ) != 1 )
+	{
+		libcerror_error_free(
+		 worker_error );
+
+		return;
+	}
+#endif
+	if( parallel_read->worker_error == NULL )
+	{
+		parallel_read->worker_error = *worker_error;
+		*worker_error               = NULL;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_mutex_release(
+	 parallel_read->mutex,
+	 NULL );
+#endif
+	if( *worker_error != NULL )
+	{
+		libcerror_error_free(
+		 worker_error );
+	}
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_parallel_read_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error               = NULL;
+	libqcow_parallel_read_worker_t *worker = NULL;
+	int result                             = 0;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	worker = (libqcow_parallel_read_worker_t *) arguments;
+
+	result = libqcow_parallel_read_worker_run(
+	          worker->parallel_read,
+	          (int) ( worker - worker->parallel_read->workers ),
+	          &error );
+
+	if( result != 1 )
+	{
+		libqcow_parallel_read_set_worker_error(
+		 worker->parallel_read,
+		 &error );
+	}
+	return( result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Runs a parallel read
+ * Every worker reads using its own reader of the file, the first worker
+ * runs in the calling thread and the other workers in their own thread
+ * Returns 1 if successful, 0 if stopped by the callback function or -1 on error
+ */
+int libqcow_parallel_read_run(
+     libqcow_parallel_read_t *parallel_read,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *worker_error        = NULL;
+	libqcow_parallel_read_worker_t *worker = NULL;
+	static char *function                  = "libqcow_parallel_read_run";
+	int worker_index                       = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int number_of_threads                  = 0;
+#endif
+
+	if( parallel_read == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid parallel read.",
+		 function );
+
+		return( -1 );
+	}
+	for( worker_index = 0;
+	     worker_index < parallel_read->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( parallel_read->workers[ worker_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libqcow_file_clone_reader(
+		     parallel_read->file,
+		     &( worker->reader ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create reader: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+#else
+		worker->reader = parallel_read->file;
+#endif
+		worker->chunk_data = (uint8_t *) memory_allocate(
+		                                  sizeof( uint8_t ) * parallel_read->chunk_size );
+
+		if( worker->chunk_data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create chunk data: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( number_of_threads = 1;
+	     number_of_threads < parallel_read->number_of_workers;
+	     number_of_threads++ )
+	{
+		worker = &( parallel_read->workers[ number_of_threads ] );
+
+		if( libcthreads_thread_create(
+		     &( worker->thread ),
+		     NULL,
+		     &libqcow_parallel_read_thread_function,
+		     (void *) worker,
+		     &worker_error ) != 1 )
+		{
+			libcerror_error_set(
+			 &worker_error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread: %d.",
+			 function,
+			 number_of_threads );
+
+			libqcow_parallel_read_set_worker_error(
+			 parallel_read,
+			 &worker_error );
+
+			libqcow_parallel_read_stop(
+			 parallel_read,
+			 -1,
+			 NULL );
+
+			break;
+		}
+	}
+#endif
+	if( libqcow_parallel_read_worker_run(
+	     parallel_read,
+	     0,
+	     &worker_error ) != 1 )
+	{
+		libqcow_parallel_read_set_worker_error(
+		 parallel_read,
+		 &worker_error );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( worker_index = 1;
+	     worker_index < number_of_threads;
+	     worker_index++ )
+	{
+		worker = &( parallel_read->workers[ worker_index ] );
+
+		if( libcthreads_thread_join(
+		     &( worker->thread ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread: %d.",
+			 function,
+			 worker_index );
+
+			parallel_read->result = -1;
+		}
+	}
+#endif
+	if( parallel_read->result == -1 )
+	{
+		/* The error of the worker that failed is passed to the caller
+		 */
+		if( ( error != NULL )
+		 && ( *error == NULL ) )
+		{
+			*error                      = parallel_read->worker_error;
+			parallel_read->worker_error = NULL;
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read chunks.",
+		 function );
+
+		return( -1 );
+	}
+	return( parallel_read->result );
+}
+
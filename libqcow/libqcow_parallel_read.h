@@ -0,0 +1,236 @@
+/*
+ * Parallel read functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_PARALLEL_READ_H )
+#define _LIBQCOW_PARALLEL_READ_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_parallel_read libqcow_parallel_read_t;
+typedef struct libqcow_parallel_read_worker libqcow_parallel_read_worker_t;
+
+/* A worker reads chunks using its own reader of the file
+ */
+struct libqcow_parallel_read_worker
+{
+	/* The parallel read
+	 */
+	libqcow_parallel_read_t *parallel_read;
+
+	/* The reader
+	 */
+	libqcow_file_t *reader;
+
+	/* The chunk data
+	 */
+	uint8_t *chunk_data;
+
+	/* The index of the first chunk of the range of the worker that has not been taken
+	 */
+	uint64_t range_start_index;
+
+	/* The index of the chunk directly after the range of the worker
+	 */
+	uint64_t range_end_index;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+#endif
+};
+
+/* The chunks are taken from the range of the worker, a worker that has no
+ * chunks left steals the upper half of the largest range of the other workers
+ * With ordered delivery the chunks are taken in order from a shared index
+ */
+struct libqcow_parallel_read
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The (storage media) offset
+	 */
+	off64_t offset;
+
+	/* The (storage media) end offset
+	 */
+	off64_t end_offset;
+
+	/* The chunk size
+	 */
+	size_t chunk_size;
+
+	/* The index of the first chunk, chunks are aligned to the chunk size
+	 */
+	uint64_t first_chunk_index;
+
+	/* The index of the chunk directly after the last chunk
+	 */
+	uint64_t end_chunk_index;
+
+	/* The number of chunks per partition, the initial ranges of the workers
+	 * start at a partition boundary when possible
+	 */
+	uint64_t number_of_chunks_per_partition;
+
+	/* The flags
+	 */
+	int flags;
+
+	/* Value to indicate the chunks are read in order of file offset
+	 */
+	int read_in_file_order;
+
+	/* The callback function
+	 */
+	int (*callback)(
+	       off64_t chunk_offset,
+	       const uint8_t *chunk_data,
+	       size_t chunk_size,
+	       void *user_data );
+
+	/* The user data passed to the callback function
+	 */
+	void *user_data;
+
+	/* The workers
+	 */
+	libqcow_parallel_read_worker_t *workers;
+
+	/* The number of workers
+	 */
+	int number_of_workers;
+
+	/* The index of the next chunk to take with ordered delivery
+	 */
+	uint64_t next_chunk_index;
+
+	/* The index of the next chunk to deliver with ordered delivery
+	 */
+	uint64_t next_delivery_chunk_index;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+	/* The result, 1 if completed, 0 if stopped by the callback function or -1 on error
+	 */
+	int result;
+
+	/* The error of the first worker that failed
+	 */
+	libcerror_error_t *worker_error;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+
+	/* The condition that signals the delivery of a chunk
+	 */
+	libcthreads_condition_t *delivery_condition;
+#endif
+};
+
+int libqcow_parallel_read_initialize(
+     libqcow_parallel_read_t **parallel_read,
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     size64_t partition_size,
+     int number_of_workers,
+     int flags,
+     int (*callback)(
+            off64_t chunk_offset,
+            const uint8_t *chunk_data,
+            size_t chunk_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_free(
+     libqcow_parallel_read_t **parallel_read,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_get_next_chunk(
+     libqcow_parallel_read_t *parallel_read,
+     int worker_index,
+     uint64_t *chunk_index,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_chunk_is_hole(
+     libqcow_parallel_read_t *parallel_read,
+     libqcow_file_t *reader,
+     off64_t chunk_offset,
+     size_t chunk_size,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_deliver_chunk(
+     libqcow_parallel_read_t *parallel_read,
+     uint64_t chunk_index,
+     off64_t chunk_offset,
+     const uint8_t *chunk_data,
+     size_t chunk_size,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_worker_run(
+     libqcow_parallel_read_t *parallel_read,
+     int worker_index,
+     libcerror_error_t **error );
+
+int libqcow_parallel_read_stop(
+     libqcow_parallel_read_t *parallel_read,
+     int result,
+     libcerror_error_t **error );
+
+void libqcow_parallel_read_set_worker_error(
+      libqcow_parallel_read_t *parallel_read,
+      libcerror_error_t **worker_error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_parallel_read_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+int libqcow_parallel_read_run(
+     libqcow_parallel_read_t *parallel_read,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_PARALLEL_READ_H ) */
+
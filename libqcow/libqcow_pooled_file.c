@@ -0,0 +1,912 @@
+/*
+ * Pooled file functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_pooled_file.h"
+#include "libqcow_unused.h"
+
+/* Creates a pooled file
+ * Make sure the value pooled_file is referencing, is set to NULL
+ * The file IO handle is appended to the file IO pool, which manages it
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_initialize(
+     libqcow_pooled_file_t **pooled_file,
+     libbfio_pool_t *file_io_pool,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_initialize";
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *pooled_file != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid pooled file value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_pool == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO pool.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	*pooled_file = memory_allocate_structure(
+	                libqcow_pooled_file_t );
+
+	if( *pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create pooled file.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *pooled_file,
+	     0,
+	     sizeof( libqcow_pooled_file_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear pooled file.",
+		 function );
+
+		memory_free(
+		 *pooled_file );
+
+		*pooled_file = NULL;
+
+		return( -1 );
+	}
+	/* The pool opens the file IO handle on demand
+	 */
+	if( libbfio_pool_append_handle(
+	     file_io_pool,
+	     &( ( *pooled_file )->file_io_pool_entry ),
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+		 "%s: unable to append file IO handle to pool.",
+		 function );
+
+		goto on_error;
+	}
+	( *pooled_file )->file_io_pool = file_io_pool;
+
+	return( 1 );
+
+on_error:
+	if( *pooled_file != NULL )
+	{
+		memory_free(
+		 *pooled_file );
+
+		*pooled_file = NULL;
+	}
+	return( -1 );
+}
+
+/* Creates a file IO handle that reads a file IO handle through a file IO pool
+ * Make sure the value handle is referencing, is set to NULL
+ * The file IO handle is managed by the file IO pool and removed from it when the handle is freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_pool_t *file_io_pool,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *removed_file_io_handle = NULL;
+	libqcow_pooled_file_t *pooled_file       = NULL;
+	static char *function                    = "libqcow_pooled_file_initialize_handle";
+
+	if( handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_pooled_file_initialize(
+	     &pooled_file,
+	     file_io_pool,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create pooled file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_initialize(
+	     handle,
+	     (intptr_t *) pooled_file,
+	     (int (*)(intptr_t **, libcerror_error_t **)) libqcow_pooled_file_free,
+	     (int (*)(intptr_t **, intptr_t *, libcerror_error_t **)) libqcow_pooled_file_clone,
+	     (int (*)(intptr_t *, int, libcerror_error_t **)) libqcow_pooled_file_open,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_pooled_file_close,
+	     (ssize_t (*)(intptr_t *, uint8_t *, size_t, libcerror_error_t **)) libqcow_pooled_file_read,
+	     (ssize_t (*)(intptr_t *, const uint8_t *, size_t, libcerror_error_t **)) libqcow_pooled_file_write,
+	     (off64_t (*)(intptr_t *, off64_t, int, libcerror_error_t **)) libqcow_pooled_file_seek_offset,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_pooled_file_exists,
+	     (int (*)(intptr_t *, libcerror_error_t **)) libqcow_pooled_file_is_open,
+	     (int (*)(intptr_t *, size64_t *, libcerror_error_t **)) libqcow_pooled_file_get_size,
+	     LIBBFIO_FLAG_IO_HANDLE_MANAGED | LIBBFIO_FLAG_IO_HANDLE_CLONE_BY_FUNCTION,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( pooled_file != NULL )
+	{
+		/* The file IO handle remains owned by the caller on error
+		 */
+		libbfio_pool_remove_handle(
+		 pooled_file->file_io_pool,
+		 pooled_file->file_io_pool_entry,
+		 &removed_file_io_handle,
+		 NULL );
+
+		memory_free(
+		 pooled_file );
+	}
+	return( -1 );
+}
+
+/* Frees a pooled file
+ * The file IO handle is removed from the file IO pool and freed
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_free(
+     libqcow_pooled_file_t **pooled_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_pooled_file_free";
+	int result                       = 1;
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *pooled_file != NULL )
+	{
+		if( ( *pooled_file )->is_open != 0 )
+		{
+			if( libqcow_pooled_file_close(
+			     *pooled_file,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close pooled file.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( libbfio_pool_remove_handle(
+		     ( *pooled_file )->file_io_pool,
+		     ( *pooled_file )->file_io_pool_entry,
+		     &file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_REMOVE_FAILED,
+			 "%s: unable to remove file IO handle: %d from pool.",
+			 function,
+			 ( *pooled_file )->file_io_pool_entry );
+
+			result = -1;
+		}
+		if( file_io_handle != NULL )
+		{
+			if( libbfio_handle_free(
+			     &file_io_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free file IO handle.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *pooled_file );
+
+		*pooled_file = NULL;
+	}
+	return( result );
+}
+
+/* Clones (duplicates) the pooled file
+ * The clone reads a clone of the file IO handle, which is appended to the same file IO pool
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_clone(
+     libqcow_pooled_file_t **destination_pooled_file,
+     libqcow_pooled_file_t *source_pooled_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *destination_file_io_handle = NULL;
+	libbfio_handle_t *source_file_io_handle      = NULL;
+	static char *function                        = "libqcow_pooled_file_clone";
+	int result                                   = 0;
+
+	if( destination_pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid destination pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( *destination_pooled_file != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: destination pooled file already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( source_pooled_file == NULL )
+	{
+		*destination_pooled_file = NULL;
+
+		return( 1 );
+	}
+	if( libbfio_pool_get_handle(
+	     source_pooled_file->file_io_pool,
+	     source_pooled_file->file_io_pool_entry,
+	     &source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file IO handle: %d from pool.",
+		 function,
+		 source_pooled_file->file_io_pool_entry );
+
+		goto on_error;
+	}
+	if( libbfio_handle_clone(
+	     &destination_file_io_handle,
+	     source_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create destination file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	/* The clone is opened by the pool so that it counts towards the maximum number of open handles
+	 */
+	result = libbfio_handle_is_open(
+	          destination_file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine if destination file IO handle is open.",
+		 function );
+
+		goto on_error;
+	}
+	else if( result != 0 )
+	{
+		if( libbfio_handle_close(
+		     destination_file_io_handle,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close destination file IO handle.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( libqcow_pooled_file_initialize(
+	     destination_pooled_file,
+	     source_pooled_file->file_io_pool,
+	     destination_file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create destination pooled file.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( destination_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &destination_file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Opens the pooled file
+ * The file IO pool closes its least recently used handle if the maximum number of open handles is reached
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_open(
+     libqcow_pooled_file_t *pooled_file,
+     int access_flags,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_open";
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( pooled_file->is_open != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid pooled file - already open.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( access_flags & LIBBFIO_ACCESS_FLAG_WRITE ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access currently not supported.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_pool_open(
+	     pooled_file->file_io_pool,
+	     pooled_file->file_io_pool_entry,
+	     access_flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file IO handle: %d in pool.",
+		 function,
+		 pooled_file->file_io_pool_entry );
+
+		return( -1 );
+	}
+	if( libbfio_pool_get_size(
+	     pooled_file->file_io_pool,
+	     pooled_file->file_io_pool_entry,
+	     &( pooled_file->size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve size of file IO handle: %d in pool.",
+		 function,
+		 pooled_file->file_io_pool_entry );
+
+		libbfio_pool_close(
+		 pooled_file->file_io_pool,
+		 pooled_file->file_io_pool_entry,
+		 NULL );
+
+		return( -1 );
+	}
+	pooled_file->current_offset = 0;
+	pooled_file->access_flags   = access_flags;
+	pooled_file->is_open        = 1;
+
+	return( 1 );
+}
+
+/* Closes the pooled file
+ * Returns 0 if successful or -1 on error
+ */
+int libqcow_pooled_file_close(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_pooled_file_close";
+	int result                       = 0;
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_pool_get_handle(
+	     pooled_file->file_io_pool,
+	     pooled_file->file_io_pool_entry,
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file IO handle: %d from pool.",
+		 function,
+		 pooled_file->file_io_pool_entry );
+
+		result = -1;
+	}
+	/* The pool could already have closed the file IO handle
+	 */
+	else if( libbfio_handle_is_open(
+	          file_io_handle,
+	          NULL ) == 1 )
+	{
+		if( libbfio_pool_close(
+		     pooled_file->file_io_pool,
+		     pooled_file->file_io_pool_entry,
+		     error ) != 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+			 "%s: unable to close file IO handle: %d in pool.",
+			 function,
+			 pooled_file->file_io_pool_entry );
+
+			result = -1;
+		}
+	}
+	pooled_file->current_offset = 0;
+	pooled_file->access_flags   = 0;
+	pooled_file->is_open        = 0;
+
+	return( result );
+}
+
+/* Reads a buffer from the pooled file
+ * The file IO pool reopens the file IO handle if it was closed in favour of another handle
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_pooled_file_read(
+         libqcow_pooled_file_t *pooled_file,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_read";
+	ssize_t read_count    = 0;
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( pooled_file->is_open == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid pooled file - not open.",
+		 function );
+
+		return( -1 );
+	}
+	/* The offset of a reopened handle is not retained, hence the offset is set on every read
+	 */
+	if( libbfio_pool_seek_offset(
+	     pooled_file->file_io_pool,
+	     pooled_file->file_io_pool_entry,
+	     pooled_file->current_offset,
+	     SEEK_SET,
+	     error ) == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek offset: %" PRIi64 " (0x%08" PRIx64 ") in file IO handle: %d in pool.",
+		 function,
+		 pooled_file->current_offset,
+		 pooled_file->current_offset,
+		 pooled_file->file_io_pool_entry );
+
+		return( -1 );
+	}
+	read_count = libbfio_pool_read_buffer(
+	              pooled_file->file_io_pool,
+	              pooled_file->file_io_pool_entry,
+	              buffer,
+	              size,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer from file IO handle: %d in pool.",
+		 function,
+		 pooled_file->file_io_pool_entry );
+
+		return( -1 );
+	}
+	pooled_file->current_offset += (off64_t) read_count;
+
+	return( read_count );
+}
+
+/* Writes a buffer to the pooled file
+ * Returns the number of bytes written if successful, or -1 on error
+ */
+ssize_t libqcow_pooled_file_write(
+         libqcow_pooled_file_t *pooled_file,
+         const uint8_t *buffer LIBQCOW_ATTRIBUTE_UNUSED,
+         size_t size LIBQCOW_ATTRIBUTE_UNUSED,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_write";
+
+	LIBQCOW_UNREFERENCED_PARAMETER( buffer )
+	LIBQCOW_UNREFERENCED_PARAMETER( size )
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: write access currently not supported.",
+	 function );
+
+	return( -1 );
+}
+
+/* Seeks a certain offset in the pooled file
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_pooled_file_seek_offset(
+         libqcow_pooled_file_t *pooled_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_seek_offset";
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_SET ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
+		 function );
+
+		return( -1 );
+	}
+	if( whence == SEEK_CUR )
+	{
+		offset += pooled_file->current_offset;
+	}
+	else if( whence == SEEK_END )
+	{
+		offset += (off64_t) pooled_file->size;
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	pooled_file->current_offset = offset;
+
+	return( offset );
+}
+
+/* Function to determine if the pooled file exists
+ * Returns 1 if the pooled file exists, 0 if not or -1 on error
+ */
+int libqcow_pooled_file_exists(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_pooled_file_exists";
+	int result                       = 0;
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_pool_get_handle(
+	     pooled_file->file_io_pool,
+	     pooled_file->file_io_pool_entry,
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file IO handle: %d from pool.",
+		 function,
+		 pooled_file->file_io_pool_entry );
+
+		return( -1 );
+	}
+	result = libbfio_handle_exists(
+	          file_io_handle,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to determine if file IO handle exists.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Check if the pooled file is open
+ * The pooled file remains open while the file IO pool has closed its file IO handle
+ * Returns 1 if open, 0 if not or -1 on error
+ */
+int libqcow_pooled_file_is_open(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_is_open";
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( pooled_file->is_open == 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the size of the pooled file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_pooled_file_get_size(
+     libqcow_pooled_file_t *pooled_file,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_pooled_file_get_size";
+
+	if( pooled_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid pooled file.",
+		 function );
+
+		return( -1 );
+	}
+	if( size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid size.",
+		 function );
+
+		return( -1 );
+	}
+	*size = pooled_file->size;
+
+	return( 1 );
+}
+
@@ -0,0 +1,134 @@
+/*
+ * Pooled file functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_POOLED_FILE_H )
+#define _LIBQCOW_POOLED_FILE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_pooled_file libqcow_pooled_file_t;
+
+/* The pooled file is a file IO handle that reads a file IO handle in a (shared) file IO pool
+ * The pool keeps a maximum number of handles open and closes the least recently used
+ * handles, which are reopened when they are read again
+ */
+struct libqcow_pooled_file
+{
+	/* The file IO pool
+	 */
+	libbfio_pool_t *file_io_pool;
+
+	/* The file IO pool entry
+	 */
+	int file_io_pool_entry;
+
+	/* The size of the file
+	 */
+	size64_t size;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* The access flags
+	 */
+	int access_flags;
+
+	/* Value to indicate the pooled file is open
+	 */
+	uint8_t is_open;
+};
+
+int libqcow_pooled_file_initialize(
+     libqcow_pooled_file_t **pooled_file,
+     libbfio_pool_t *file_io_pool,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_initialize_handle(
+     libbfio_handle_t **handle,
+     libbfio_pool_t *file_io_pool,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_free(
+     libqcow_pooled_file_t **pooled_file,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_clone(
+     libqcow_pooled_file_t **destination_pooled_file,
+     libqcow_pooled_file_t *source_pooled_file,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_open(
+     libqcow_pooled_file_t *pooled_file,
+     int access_flags,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_close(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error );
+
+ssize_t libqcow_pooled_file_read(
+         libqcow_pooled_file_t *pooled_file,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+ssize_t libqcow_pooled_file_write(
+         libqcow_pooled_file_t *pooled_file,
+         const uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
+off64_t libqcow_pooled_file_seek_offset(
+         libqcow_pooled_file_t *pooled_file,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error );
+
+int libqcow_pooled_file_exists(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_is_open(
+     libqcow_pooled_file_t *pooled_file,
+     libcerror_error_t **error );
+
+int libqcow_pooled_file_get_size(
+     libqcow_pooled_file_t *pooled_file,
+     size64_t *size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_POOLED_FILE_H ) */
+
@@ -0,0 +1,812 @@
+/*
+ * Asynchronous read request functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_scheduler.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_read_request.h"
+#include "libqcow_types.h"
+
+/* Creates a read request
+ * Make sure the value request is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_initialize(
+     libqcow_read_request_t **request,
+     libqcow_file_t *file,
+     uint8_t *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_initialize";
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	if( *request != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid read request value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = memory_allocate_structure(
+	                    libqcow_internal_read_request_t );
+
+	if( internal_request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create read request.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_request,
+	     0,
+	     sizeof( libqcow_internal_read_request_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear read request.",
+		 function );
+
+		memory_free(
+		 internal_request );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( internal_request->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( internal_request->finished_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create finished condition.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	internal_request->file        = file;
+	internal_request->buffer      = buffer;
+	internal_request->buffer_size = buffer_size;
+	internal_request->offset      = offset;
+	internal_request->callback    = callback;
+	internal_request->user_data   = user_data;
+	internal_request->status      = LIBQCOW_READ_REQUEST_STATUS_PENDING;
+	internal_request->priority    = LIBQCOW_IO_PRIORITY_NORMAL;
+
+	*request = (libqcow_read_request_t *) internal_request;
+
+	return( 1 );
+
+on_error:
+	if( internal_request != NULL )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( internal_request->mutex != NULL )
+		{
+			libcthreads_mutex_free(
+			 &( internal_request->mutex ),
+			 NULL );
+		}
+#endif
+		memory_free(
+		 internal_request );
+	}
+	return( -1 );
+}
+
+/* Frees a read request
+ * A read request that has not finished is cancelled and waited for
+ * The read request cannot be freed from within its callback function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_free(
+     libqcow_read_request_t **request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_free";
+	int result                                        = 1;
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	if( *request != NULL )
+	{
+		internal_request = (libqcow_internal_read_request_t *) *request;
+		*request         = NULL;
+
+		if( libqcow_read_request_cancel(
+		     (libqcow_read_request_t *) internal_request,
+		     error ) == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to cancel read request.",
+			 function );
+
+			result = -1;
+		}
+		/* The buffer and the request cannot be released safely if the request has not finished
+		 */
+		if( libqcow_read_request_wait(
+		     (libqcow_read_request_t *) internal_request,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to wait for read request to finish.",
+			 function );
+
+			return( -1 );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_free(
+		     &( internal_request->finished_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free finished condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_free(
+		     &( internal_request->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 internal_request );
+	}
+	return( result );
+}
+
+/* Processes a read request
+ * Reads the data unless the request was cancelled and calls the callback function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_process(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_process";
+	ssize_t read_count                                = 0;
+	int result                                        = 1;
+	int status                                        = 0;
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( internal_request->status == LIBQCOW_READ_REQUEST_STATUS_PENDING )
+	{
+		internal_request->status = LIBQCOW_READ_REQUEST_STATUS_IN_PROGRESS;
+	}
+	status = internal_request->status;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( status == LIBQCOW_READ_REQUEST_STATUS_IN_PROGRESS )
+	{
+		read_count = libqcow_file_read_buffer_at_offset(
+		              internal_request->file,
+		              internal_request->buffer,
+		              internal_request->buffer_size,
+		              internal_request->offset,
+		              error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read buffer at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 internal_request->offset,
+			 internal_request->offset );
+
+			status = LIBQCOW_READ_REQUEST_STATUS_FAILED;
+			result = -1;
+		}
+		else
+		{
+			status = LIBQCOW_READ_REQUEST_STATUS_COMPLETED;
+		}
+		/* The status is updated before the callback is called so that
+		 * it can be retrieved from within the callback function
+		 */
+		internal_request->status     = status;
+		internal_request->read_count = read_count;
+	}
+	if( internal_request->callback != NULL )
+	{
+		internal_request->callback(
+		 request,
+		 status,
+		 read_count,
+		 internal_request->user_data );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_request->is_finished = 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_condition_broadcast(
+	     internal_request->finished_condition,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to broadcast finished condition.",
+		 function );
+
+		result = -1;
+	}
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Callback function for the read request thread pool
+ * The arguments are the IO scheduler that holds the queued read requests, in which
+ * case the pushed read request only signals that a read request was queued and
+ * the read request that is processed is the next one of the IO scheduler
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_thread_pool_callback(
+     libqcow_read_request_t *request,
+     void *arguments )
+{
+	libcerror_error_t *error                = NULL;
+	libqcow_io_scheduler_t *io_scheduler    = NULL;
+	libqcow_read_request_t *queued_request  = NULL;
+	static char *function                   = "libqcow_read_request_thread_pool_callback";
+	int result                              = 1;
+
+	if( arguments != NULL )
+	{
+		io_scheduler = (libqcow_io_scheduler_t *) arguments;
+
+		result = libqcow_io_scheduler_pop_request(
+		          io_scheduler,
+		          &queued_request,
+		          &error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to pop read request from IO scheduler.",
+			 function );
+
+			goto on_error;
+		}
+		/* The queued read request was already processed by another thread
+		 */
+		else if( result == 0 )
+		{
+			return( 1 );
+		}
+		request = queued_request;
+	}
+	if( libqcow_read_request_process(
+	     request,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to process read request.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+	}
+#endif
+	libcerror_error_free(
+	 &error );
+
+	return( -1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Cancels a read request
+ * Only a read request that has not started can be cancelled, its callback function
+ * is called with status LIBQCOW_READ_REQUEST_STATUS_CANCELLED
+ * Returns 1 if the read request was cancelled, 0 if not or -1 on error
+ */
+int libqcow_read_request_cancel(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_cancel";
+	int result                                        = 0;
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( internal_request->status == LIBQCOW_READ_REQUEST_STATUS_PENDING )
+	{
+		internal_request->status = LIBQCOW_READ_REQUEST_STATUS_CANCELLED;
+
+		result = 1;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Waits for a read request to finish
+ * The read request has finished when its callback function has returned
+ * The callback function cannot wait for its own read request
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_wait(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_wait";
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+	while( internal_request->is_finished == 0 )
+	{
+		if( libcthreads_condition_wait(
+		     internal_request->finished_condition,
+		     internal_request->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to wait for finished condition.",
+			 function );
+
+			libcthreads_mutex_release(
+			 internal_request->mutex,
+			 NULL );
+
+			return( -1 );
+		}
+	}
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the status of a read request
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_get_status(
+     libqcow_read_request_t *request,
+     int *status,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_get_status";
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+	if( status == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid status.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*status = internal_request->status;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the number of bytes read by a read request
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_read_request_get_read_count(
+     libqcow_read_request_t *request,
+     ssize_t *read_count,
+     libcerror_error_t **error )
+{
+	libqcow_internal_read_request_t *internal_request = NULL;
+	static char *function                             = "libqcow_read_request_get_read_count";
+
+	if( request == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read request.",
+		 function );
+
+		return( -1 );
+	}
+	internal_request = (libqcow_internal_read_request_t *) request;
+
+	if( read_count == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid read count.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*read_count = internal_request->read_count;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     internal_request->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
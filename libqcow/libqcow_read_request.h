@@ -0,0 +1,158 @@
+/*
+ * Asynchronous read request functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_INTERNAL_READ_REQUEST_H )
+#define _LIBQCOW_INTERNAL_READ_REQUEST_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_extern.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_internal_read_request libqcow_internal_read_request_t;
+
+struct libqcow_internal_read_request
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The buffer
+	 */
+	uint8_t *buffer;
+
+	/* The buffer size
+	 */
+	size_t buffer_size;
+
+	/* The (storage media) offset
+	 */
+	off64_t offset;
+
+	/* The callback function
+	 */
+	void (*callback)(
+	       libqcow_read_request_t *request,
+	       int status,
+	       ssize_t read_count,
+	       void *user_data );
+
+	/* The user data passed to the callback function
+	 */
+	void *user_data;
+
+	/* The status
+	 */
+	int status;
+
+	/* The number of bytes read
+	 */
+	ssize_t read_count;
+
+	/* Value to indicate the request has finished, this is set after the callback returned
+	 */
+	uint8_t is_finished;
+
+	/* The IO priority
+	 */
+	uint8_t priority;
+
+	/* The next read request in the queue of the IO scheduler
+	 */
+	libqcow_internal_read_request_t *next_request;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+
+	/* The condition that is signalled when the request has finished
+	 */
+	libcthreads_condition_t *finished_condition;
+#endif
+};
+
+int libqcow_read_request_initialize(
+     libqcow_read_request_t **request,
+     libqcow_file_t *file,
+     uint8_t *buffer,
+     size_t buffer_size,
+     off64_t offset,
+     void (*callback)(
+            libqcow_read_request_t *request,
+            int status,
+            ssize_t read_count,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_read_request_free(
+     libqcow_read_request_t **request,
+     libcerror_error_t **error );
+
+int libqcow_read_request_process(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_read_request_thread_pool_callback(
+     libqcow_read_request_t *request,
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+LIBQCOW_EXTERN \
+int libqcow_read_request_cancel(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_read_request_wait(
+     libqcow_read_request_t *request,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_read_request_get_status(
+     libqcow_read_request_t *request,
+     int *status,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_read_request_get_read_count(
+     libqcow_read_request_t *request,
+     ssize_t *read_count,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_INTERNAL_READ_REQUEST_H ) */
+
@@ -0,0 +1,629 @@
+/*
+ * Reference count table functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_reference_count_table.h"
+
+/* Creates a reference count table
+ * Make sure the value reference_count_table is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_initialize(
+     libqcow_reference_count_table_t **reference_count_table,
+     size_t cluster_block_size,
+     uint32_t reference_count_order,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_reference_count_table_initialize";
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( *reference_count_table != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid reference count table value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size < 512 )
+	 || ( cluster_block_size > (size_t) SSIZE_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count_order > 6 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported reference count order: %" PRIu32 ".",
+		 function,
+		 reference_count_order );
+
+		return( -1 );
+	}
+	*reference_count_table = memory_allocate_structure(
+	                          libqcow_reference_count_table_t );
+
+	if( *reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *reference_count_table,
+	     0,
+	     sizeof( libqcow_reference_count_table_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count table.",
+		 function );
+
+		memory_free(
+		 *reference_count_table );
+
+		*reference_count_table = NULL;
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_initialize(
+	     &( ( *reference_count_table )->block_offsets ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create block offsets table.",
+		 function );
+
+		goto on_error;
+	}
+	( *reference_count_table )->block_data = (uint8_t *) memory_allocate(
+	                                                      sizeof( uint8_t ) * cluster_block_size );
+
+	if( ( *reference_count_table )->block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create block data.",
+		 function );
+
+		goto on_error;
+	}
+	( *reference_count_table )->cluster_block_size             = cluster_block_size;
+	( *reference_count_table )->number_of_reference_count_bits = (uint8_t) ( 1 << reference_count_order );
+	( *reference_count_table )->number_of_entries_per_block    = ( (uint64_t) cluster_block_size * 8 ) >> reference_count_order;
+	( *reference_count_table )->block_data_index               = -1;
+
+	return( 1 );
+
+on_error:
+	if( *reference_count_table != NULL )
+	{
+		if( ( *reference_count_table )->block_offsets != NULL )
+		{
+			libqcow_cluster_table_free(
+			 &( ( *reference_count_table )->block_offsets ),
+			 NULL );
+		}
+		memory_free(
+		 *reference_count_table );
+
+		*reference_count_table = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a reference count table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_free(
+     libqcow_reference_count_table_t **reference_count_table,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_reference_count_table_free";
+	int result            = 1;
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( *reference_count_table != NULL )
+	{
+		if( libqcow_cluster_table_free(
+		     &( ( *reference_count_table )->block_offsets ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free block offsets table.",
+			 function );
+
+			result = -1;
+		}
+		memory_free(
+		 ( *reference_count_table )->block_data );
+
+		memory_free(
+		 *reference_count_table );
+
+		*reference_count_table = NULL;
+	}
+	return( result );
+}
+
+/* Reads the reference count table
+ * The reference count blocks themselves are read on demand
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_read_file_io_handle(
+     libqcow_reference_count_table_t *reference_count_table,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     uint32_t number_of_clusters,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_reference_count_table_read_file_io_handle";
+	uint64_t table_size   = 0;
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_offset <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	table_size = (uint64_t) number_of_clusters * reference_count_table->cluster_block_size;
+
+	if( ( table_size == 0 )
+	 || ( table_size > (uint64_t) LIBQCOW_MAXIMUM_REFERENCE_COUNT_TABLE_SIZE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of clusters value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_read(
+	     reference_count_table->block_offsets,
+	     file_io_handle,
+	     file_offset,
+	     (size_t) table_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	reference_count_table->block_data_index = -1;
+
+	return( 1 );
+}
+
+/* Retrieves the number of reference count blocks
+ * This includes the unallocated blocks
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_get_number_of_blocks(
+     libqcow_reference_count_table_t *reference_count_table,
+     int *number_of_blocks,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_reference_count_table_get_number_of_blocks";
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     reference_count_table->block_offsets,
+	     number_of_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of block offsets.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the file offset of a specific reference count block
+ * The offset is 0 if the block is not allocated
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_get_block_offset_by_index(
+     libqcow_reference_count_table_t *reference_count_table,
+     int block_index,
+     off64_t *block_offset,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_reference_count_table_get_block_offset_by_index";
+	uint64_t reference    = 0;
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( block_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_reference_by_index(
+	     reference_count_table->block_offsets,
+	     block_index,
+	     &reference,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve block offset: %d.",
+		 function,
+		 block_index );
+
+		return( -1 );
+	}
+	/* Bits 0 - 8 of a reference count table entry are reserved
+	 */
+	reference &= 0x7ffffffffffffe00ULL;
+
+	*block_offset = (off64_t) reference;
+
+	return( 1 );
+}
+
+/* Retrieves the reference count of a specific cluster block
+ * Cluster blocks that are not covered by the reference count table have a reference count of 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_get_reference_count(
+     libqcow_reference_count_table_t *reference_count_table,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_block_index,
+     uint64_t *reference_count,
+     libcerror_error_t **error )
+{
+	static char *function  = "libqcow_reference_count_table_get_reference_count";
+	ssize_t read_count     = 0;
+	off64_t block_offset   = 0;
+	uint64_t block_index   = 0;
+	uint64_t entry_index   = 0;
+	uint64_t value_64bit   = 0;
+	uint32_t value_32bit   = 0;
+	uint16_t value_16bit   = 0;
+	uint8_t bit_shift      = 0;
+	int number_of_blocks   = 0;
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_get_number_of_references(
+	     reference_count_table->block_offsets,
+	     &number_of_blocks,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of block offsets.",
+		 function );
+
+		return( -1 );
+	}
+	block_index = cluster_block_index / reference_count_table->number_of_entries_per_block;
+	entry_index = cluster_block_index % reference_count_table->number_of_entries_per_block;
+
+	if( block_index >= (uint64_t) number_of_blocks )
+	{
+		*reference_count = 0;
+
+		return( 1 );
+	}
+	if( (int) block_index != reference_count_table->block_data_index )
+	{
+		if( libqcow_reference_count_table_get_block_offset_by_index(
+		     reference_count_table,
+		     (int) block_index,
+		     &block_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve offset of block: %" PRIu64 ".",
+			 function,
+			 block_index );
+
+			return( -1 );
+		}
+		if( block_offset == 0 )
+		{
+			*reference_count = 0;
+
+			return( 1 );
+		}
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_printf(
+			 "%s: reading reference count block: %" PRIu64 " at offset: %" PRIi64 " (0x%08" PRIx64 ")\n",
+			 function,
+			 block_index,
+			 block_offset,
+			 block_offset );
+		}
+#endif
+		/* Make sure a partially read block is not reused
+		 */
+		reference_count_table->block_data_index = -1;
+
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              reference_count_table->block_data,
+		              reference_count_table->cluster_block_size,
+		              block_offset,
+		              error );
+
+		if( read_count != (ssize_t) reference_count_table->cluster_block_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read reference count block: %" PRIu64 " at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 block_index,
+			 block_offset,
+			 block_offset );
+
+			return( -1 );
+		}
+		reference_count_table->block_data_index = (int) block_index;
+	}
+	switch( reference_count_table->number_of_reference_count_bits )
+	{
+		/* Reference counts smaller than a byte are stored starting at the least significant bit
+		 */
+		case 1:
+		case 2:
+		case 4:
+			bit_shift   = (uint8_t) ( ( entry_index * reference_count_table->number_of_reference_count_bits ) % 8 );
+			entry_index = ( entry_index * reference_count_table->number_of_reference_count_bits ) / 8;
+
+			*reference_count = ( reference_count_table->block_data[ entry_index ] >> bit_shift )
+			                 & ( ( 1 << reference_count_table->number_of_reference_count_bits ) - 1 );
+			break;
+
+		case 8:
+			*reference_count = reference_count_table->block_data[ entry_index ];
+			break;
+
+		case 16:
+			byte_stream_copy_to_uint16_big_endian(
+			 &( reference_count_table->block_data[ entry_index * 2 ] ),
+			 value_16bit );
+
+			*reference_count = value_16bit;
+			break;
+
+		case 32:
+			byte_stream_copy_to_uint32_big_endian(
+			 &( reference_count_table->block_data[ entry_index * 4 ] ),
+			 value_32bit );
+
+			*reference_count = value_32bit;
+			break;
+
+		case 64:
+			byte_stream_copy_to_uint64_big_endian(
+			 &( reference_count_table->block_data[ entry_index * 8 ] ),
+			 value_64bit );
+
+			*reference_count = value_64bit;
+			break;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the reference count table, its block offsets
+ * and block data in bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_reference_count_table_get_memory_usage(
+     libqcow_reference_count_table_t *reference_count_table,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_reference_count_table_get_memory_usage";
+	size_t block_offsets_usage = 0;
+
+	if( reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_reference_count_table_t );
+
+	if( reference_count_table->block_data != NULL )
+	{
+		*memory_usage += reference_count_table->cluster_block_size;
+	}
+	if( reference_count_table->block_offsets != NULL )
+	{
+		if( libqcow_cluster_table_get_memory_usage(
+		     reference_count_table->block_offsets,
+		     &block_offsets_usage,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve memory usage of block offsets.",
+			 function );
+
+			return( -1 );
+		}
+		*memory_usage += block_offsets_usage;
+	}
+
+	return( 1 );
+}
+
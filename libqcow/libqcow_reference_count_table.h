@@ -0,0 +1,114 @@
+/*
+ * Reference count table functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_REFERENCE_COUNT_TABLE_H )
+#define _LIBQCOW_REFERENCE_COUNT_TABLE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_cluster_table.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_reference_count_table libqcow_reference_count_table_t;
+
+/* The reference count table contains the offsets of the reference count blocks
+ * Only a single reference count block is kept in memory, which is read
+ * when a reference count of a cluster block outside of it is requested
+ */
+struct libqcow_reference_count_table
+{
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The number of reference count bits
+	 */
+	uint8_t number_of_reference_count_bits;
+
+	/* The number of entries per reference count block
+	 */
+	uint64_t number_of_entries_per_block;
+
+	/* The reference count block offsets
+	 */
+	libqcow_cluster_table_t *block_offsets;
+
+	/* The reference count block data
+	 */
+	uint8_t *block_data;
+
+	/* The index of the reference count block in the block data
+	 */
+	int block_data_index;
+};
+
+int libqcow_reference_count_table_initialize(
+     libqcow_reference_count_table_t **reference_count_table,
+     size_t cluster_block_size,
+     uint32_t reference_count_order,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_free(
+     libqcow_reference_count_table_t **reference_count_table,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_read_file_io_handle(
+     libqcow_reference_count_table_t *reference_count_table,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     uint32_t number_of_clusters,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_get_number_of_blocks(
+     libqcow_reference_count_table_t *reference_count_table,
+     int *number_of_blocks,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_get_block_offset_by_index(
+     libqcow_reference_count_table_t *reference_count_table,
+     int block_index,
+     off64_t *block_offset,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_get_reference_count(
+     libqcow_reference_count_table_t *reference_count_table,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_block_index,
+     uint64_t *reference_count,
+     libcerror_error_t **error );
+
+int libqcow_reference_count_table_get_memory_usage(
+     libqcow_reference_count_table_t *reference_count_table,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_REFERENCE_COUNT_TABLE_H ) */
+
@@ -0,0 +1,1091 @@
+/*
+ * Sampler functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_handle.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_sampler.h"
+#include "libqcow_types.h"
+
+/* Creates a sampler
+ * Make sure the value sampler is referencing, is set to NULL
+ * The file must be open
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_initialize(
+     libqcow_sampler_t **sampler,
+     libqcow_file_t *file,
+     int flags,
+     double sampling_fraction,
+     int number_of_workers,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_sampler_initialize";
+	size_t workers_size                    = 0;
+	uint64_t number_of_cluster_blocks      = 0;
+	uint64_t number_of_samples             = 0;
+	int worker_index                       = 0;
+
+	if( sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid sampler.",
+		 function );
+
+		return( -1 );
+	}
+	if( *sampler != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid sampler value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle->cluster_block_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing cluster block size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( sampling_fraction <= 0.0 )
+	 || ( sampling_fraction > 1.0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid sampling fraction value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_workers <= 0 )
+	 || ( number_of_workers > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of workers value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_cluster_blocks = internal_file->io_handle->media_size >> internal_file->io_handle->number_of_cluster_block_bits;
+
+	if( ( internal_file->io_handle->media_size & internal_file->io_handle->cluster_block_bit_mask ) != 0 )
+	{
+		number_of_cluster_blocks++;
+	}
+	/* At least one cluster block is sampled of media that is not empty
+	 */
+	number_of_samples = (uint64_t) ( (double) number_of_cluster_blocks * sampling_fraction );
+
+	if( ( number_of_samples == 0 )
+	 && ( number_of_cluster_blocks > 0 ) )
+	{
+		number_of_samples = 1;
+	}
+	if( number_of_samples > number_of_cluster_blocks )
+	{
+		number_of_samples = number_of_cluster_blocks;
+	}
+	*sampler = memory_allocate_structure(
+	            libqcow_sampler_t );
+
+	if( *sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create sampler.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *sampler,
+	     0,
+	     sizeof( libqcow_sampler_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear sampler.",
+		 function );
+
+		memory_free(
+		 *sampler );
+
+		*sampler = NULL;
+
+		return( -1 );
+	}
+	( *sampler )->file                     = file;
+	( *sampler )->flags                    = flags;
+	( *sampler )->number_of_cluster_blocks = number_of_cluster_blocks;
+	( *sampler )->number_of_samples        = number_of_samples;
+	( *sampler )->result                   = 1;
+
+	workers_size = sizeof( libqcow_sampler_worker_t ) * number_of_workers;
+
+	( *sampler )->workers = (libqcow_sampler_worker_t *) memory_allocate(
+	                                                      workers_size );
+
+	if( ( *sampler )->workers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create workers.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *sampler )->workers,
+	     0,
+	     workers_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear workers.",
+		 function );
+
+		goto on_error;
+	}
+	( *sampler )->number_of_workers = number_of_workers;
+
+	for( worker_index = 0;
+	     worker_index < number_of_workers;
+	     worker_index++ )
+	{
+		( *sampler )->workers[ worker_index ].sampler = *sampler;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *sampler )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( *sampler != NULL )
+	{
+		if( ( *sampler )->workers != NULL )
+		{
+			memory_free(
+			 ( *sampler )->workers );
+		}
+		memory_free(
+		 *sampler );
+
+		*sampler = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a sampler
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_free(
+     libqcow_sampler_t **sampler,
+     libcerror_error_t **error )
+{
+	libqcow_sampler_worker_t *worker = NULL;
+	static char *function            = "libqcow_sampler_free";
+	int result                       = 1;
+	int worker_index                 = 0;
+
+	if( sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid sampler.",
+		 function );
+
+		return( -1 );
+	}
+	if( *sampler != NULL )
+	{
+		for( worker_index = 0;
+		     worker_index < ( *sampler )->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( ( *sampler )->workers[ worker_index ] );
+
+			if( ( worker->reader != NULL )
+			 && ( worker->reader != ( *sampler )->file ) )
+			{
+				if( libqcow_file_free(
+				     &( worker->reader ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free reader: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+			if( worker->cluster_block_data != NULL )
+			{
+				memory_free(
+				 worker->cluster_block_data );
+			}
+		}
+		memory_free(
+		 ( *sampler )->workers );
+
+		if( ( *sampler )->worker_error != NULL )
+		{
+			libcerror_error_free(
+			 &( ( *sampler )->worker_error ) );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_free(
+		     &( ( *sampler )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *sampler );
+
+		*sampler = NULL;
+	}
+	return( result );
+}
+
+/* Retrieves the index of the cluster block of a specific sample
+ * The sample is a pseudo-random cluster block of the stratum of the sample,
+ * the same sample index always results in the same cluster block
+ * Returns the index of the cluster block
+ */
+uint64_t libqcow_sampler_get_cluster_block_index(
+          uint64_t number_of_cluster_blocks,
+          uint64_t number_of_samples,
+          uint64_t sample_index )
+{
+	uint64_t random_value  = 0;
+	uint64_t stratum_end   = 0;
+	uint64_t stratum_start = 0;
+
+	if( ( number_of_samples == 0 )
+	 || ( sample_index >= number_of_samples ) )
+	{
+		return( 0 );
+	}
+	stratum_start = (uint64_t) ( (double) sample_index * (double) number_of_cluster_blocks / (double) number_of_samples );
+	stratum_end   = (uint64_t) ( (double) ( sample_index + 1 ) * (double) number_of_cluster_blocks / (double) number_of_samples );
+
+	if( ( stratum_end > number_of_cluster_blocks )
+	 || ( sample_index + 1 == number_of_samples ) )
+	{
+		stratum_end = number_of_cluster_blocks;
+	}
+	if( stratum_start >= stratum_end )
+	{
+		return( stratum_start < number_of_cluster_blocks ? stratum_start : number_of_cluster_blocks - 1 );
+	}
+	/* The splitmix64 finalizer of the sample index
+	 */
+	random_value = sample_index + 0x9e3779b97f4a7c15ULL;
+	random_value = ( random_value ^ ( random_value >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	random_value = ( random_value ^ ( random_value >> 27 ) ) * 0x94d049bb133111ebULL;
+	random_value = random_value ^ ( random_value >> 31 );
+
+	return( stratum_start + ( random_value % ( stratum_end - stratum_start ) ) );
+}
+
+/* Determines the base 2 logarithm of a value as a fixed point number with 16 fractional bits
+ * Returns the logarithm or 0 if the value is 0
+ */
+static uint64_t libqcow_sampler_log2(
+                 uint32_t value )
+{
+	uint64_t fraction     = 0;
+	uint64_t logarithm    = 0;
+	uint32_t integer_part = 0;
+	int bit_index         = 0;
+
+	if( value == 0 )
+	{
+		return( 0 );
+	}
+	while( ( value >> integer_part ) > 1 )
+	{
+		integer_part++;
+	}
+	/* The fraction is the value divided by its most significant bit with 31 fractional bits,
+	 * squaring the fraction doubles its logarithm, which determines the next bit
+	 */
+	fraction  = (uint64_t) value << ( 31 - integer_part );
+	logarithm = (uint64_t) integer_part << 16;
+
+	for( bit_index = 15;
+	     bit_index >= 0;
+	     bit_index-- )
+	{
+		fraction = ( fraction * fraction ) >> 31;
+
+		if( fraction >= ( (uint64_t) 2 << 31 ) )
+		{
+			fraction  >>= 1;
+			logarithm  |= (uint64_t) 1 << bit_index;
+		}
+	}
+	return( logarithm );
+}
+
+/* Determines if data has a high Shannon entropy, which is typical for compressed or encrypted data
+ * Returns 1 if high entropy, 0 if not or -1 on error
+ */
+int libqcow_sampler_is_high_entropy(
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	uint32_t byte_counts[ 256 ];
+
+	static char *function = "libqcow_sampler_is_high_entropy";
+	uint64_t entropy      = 0;
+	uint64_t sum          = 0;
+	size_t data_offset    = 0;
+	int byte_value        = 0;
+
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_size == 0 )
+	 || ( data_size > (size_t) UINT32_MAX ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     byte_counts,
+	     0,
+	     sizeof( uint32_t ) * 256 ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear byte counts.",
+		 function );
+
+		return( -1 );
+	}
+	for( data_offset = 0;
+	     data_offset < data_size;
+	     data_offset++ )
+	{
+		byte_counts[ data[ data_offset ] ] += 1;
+	}
+	/* The entropy is log2( size ) - sum( count * log2( count ) ) / size
+	 */
+	for( byte_value = 0;
+	     byte_value < 256;
+	     byte_value++ )
+	{
+		sum += (uint64_t) byte_counts[ byte_value ] * libqcow_sampler_log2(
+		                                               byte_counts[ byte_value ] );
+	}
+	entropy = libqcow_sampler_log2(
+	           (uint32_t) data_size ) - ( sum / data_size );
+
+	if( entropy >= LIBQCOW_SAMPLER_HIGH_ENTROPY_THRESHOLD )
+	{
+		return( 1 );
+	}
+	return( 0 );
+}
+
+/* Runs a worker of a sampler
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_worker_run(
+     libqcow_sampler_t *sampler,
+     int worker_index,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *reader  = NULL;
+	libqcow_sampler_worker_t *worker = NULL;
+	static char *function            = "libqcow_sampler_worker_run";
+	size64_t media_size              = 0;
+	size_t cluster_block_size        = 0;
+	size_t read_size                 = 0;
+	ssize_t read_count               = 0;
+	uint64_t cluster_block_index     = 0;
+	uint64_t cluster_block_reference = 0;
+	uint64_t offset                  = 0;
+	uint64_t sample_index            = 0;
+	int result                       = 0;
+	int value_index                  = 0;
+
+	if( sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid sampler.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( worker_index < 0 )
+	 || ( worker_index >= sampler->number_of_workers ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid worker index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	worker             = &( sampler->workers[ worker_index ] );
+	reader             = (libqcow_internal_file_t *) worker->reader;
+	media_size         = reader->io_handle->media_size;
+	cluster_block_size = reader->io_handle->cluster_block_size;
+
+	for( sample_index = (uint64_t) worker_index;
+	     sample_index < sampler->number_of_samples;
+	     sample_index += (uint64_t) sampler->number_of_workers )
+	{
+		if( sampler->abort != 0 )
+		{
+			break;
+		}
+		cluster_block_index = libqcow_sampler_get_cluster_block_index(
+		                       sampler->number_of_cluster_blocks,
+		                       sampler->number_of_samples,
+		                       sample_index );
+
+		offset = cluster_block_index << reader->io_handle->number_of_cluster_block_bits;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_read_write_lock_grab_for_read(
+		     reader->read_write_lock,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab read/write lock for reading.",
+			 function );
+
+			goto on_error;
+		}
+#endif
+		result = libqcow_internal_file_initialize_data_path_for_reading(
+		          reader,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize data path.",
+			 function );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		else if( libcthreads_mutex_grab(
+		          reader->cache_mutex,
+		          error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		else
+		{
+			/* The lookup only reads the level 2 table slices of the sampled cluster blocks
+			 */
+			result = libqcow_internal_file_get_cluster_block_reference(
+			          reader,
+			          reader->file_io_handle,
+			          (off64_t) offset,
+			          &cluster_block_reference,
+			          error );
+
+			if( result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve cluster block reference for offset: %" PRIu64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+			}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+			if( libcthreads_mutex_release(
+			     reader->cache_mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to release cache mutex.",
+				 function );
+
+				result = -1;
+			}
+#endif
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_read_write_lock_release_for_read(
+		     reader->read_write_lock,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release read/write lock for reading.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		if( result != 1 )
+		{
+			goto on_error;
+		}
+		/* The compression flag is tested first since the zero flag bit
+		 * is part of the compressed cluster block descriptor
+		 */
+		if( ( cluster_block_reference & reader->io_handle->compression_flag_bit_mask ) != 0 )
+		{
+			value_index = LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_COMPRESSED_CLUSTERS;
+		}
+		else if( ( cluster_block_reference & reader->io_handle->zero_flag_bit_mask ) != 0 )
+		{
+			value_index = LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_ZERO_CLUSTERS;
+		}
+		else if( ( cluster_block_reference & reader->io_handle->offset_bit_mask ) == 0 )
+		{
+			value_index = LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_SPARSE_CLUSTERS;
+		}
+		else
+		{
+			value_index = LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_ALLOCATED_CLUSTERS;
+		}
+		worker->values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_CLUSTERS ] += 1;
+		worker->values[ value_index ]                                     += 1;
+
+		if( ( ( sampler->flags & LIBQCOW_SAMPLE_FLAG_METADATA_ONLY ) != 0 )
+		 || ( ( value_index != LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_COMPRESSED_CLUSTERS )
+		  &&  ( value_index != LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_ALLOCATED_CLUSTERS ) ) )
+		{
+			continue;
+		}
+		read_size = cluster_block_size;
+
+		if( read_size > ( media_size - offset ) )
+		{
+			read_size = (size_t) ( media_size - offset );
+		}
+		read_count = libqcow_file_read_buffer_at_offset(
+		              worker->reader,
+		              worker->cluster_block_data,
+		              read_size,
+		              (off64_t) offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read cluster block at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			goto on_error;
+		}
+		result = libqcow_sampler_is_high_entropy(
+		          worker->cluster_block_data,
+		          read_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to determine if cluster block is high entropy.",
+			 function );
+
+			goto on_error;
+		}
+		worker->values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_DATA_CLUSTERS ] += 1;
+
+		if( result != 0 )
+		{
+			worker->values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_HIGH_ENTROPY_CLUSTERS ] += 1;
+		}
+	}
+	return( 1 );
+
+on_error:
+	libqcow_sampler_stop(
+	 sampler,
+	 NULL );
+
+	return( -1 );
+}
+
+/* Stops the workers of a sampler because of an error
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_stop(
+     libqcow_sampler_t *sampler,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_sampler_stop";
+
+	if( sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid sampler.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     sampler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	sampler->abort  = 1;
+	sampler->result = -1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     sampler->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Keeps the error of the first worker that failed
+ * The error is freed if the error of another worker was kept
+ */
+void libqcow_sampler_set_worker_error(
+      libqcow_sampler_t *sampler,
+      libcerror_error_t **worker_error )
+{
+	if( ( sampler == NULL )
+	 || ( worker_error == NULL )
+	 || ( *worker_error == NULL ) )
+	{
+		return;
+	}
+#if defined( HAVE_DEBUG_OUTPUT )
+	if( libcnotify_verbose != 0 )
+	{
+		libcnotify_print_error_backtrace(
+		 *worker_error );
+	}
+#endif
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     sampler->mutex,
+	     NULL ) != 1 )
+	{
+		libcerror_error_free(
+		 worker_error );
+
+		return;
+	}
+#endif
+	if( sampler->worker_error == NULL )
+	{
+		sampler->worker_error = *worker_error;
+		*worker_error         = NULL;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libcthreads_mutex_release(
+	 sampler->mutex,
+	 NULL );
+#endif
+	if( *worker_error != NULL )
+	{
+		libcerror_error_free(
+		 worker_error );
+	}
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error         = NULL;
+	libqcow_sampler_worker_t *worker = NULL;
+	int result                       = 0;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	worker = (libqcow_sampler_worker_t *) arguments;
+
+	result = libqcow_sampler_worker_run(
+	          worker->sampler,
+	          (int) ( worker - worker->sampler->workers ),
+	          &error );
+
+	if( result != 1 )
+	{
+		libqcow_sampler_set_worker_error(
+		 worker->sampler,
+		 &error );
+	}
+	return( result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Runs the workers of a sampler
+ * Every worker reads using its own reader of the file, the first worker
+ * runs in the calling thread and the other workers in their own thread
+ * The values determined by the workers are added to the values of the sampler
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_sampler_run(
+     libqcow_sampler_t *sampler,
+     libcerror_error_t **error )
+{
+	libcerror_error_t *worker_error        = NULL;
+	libqcow_internal_file_t *internal_file = NULL;
+	libqcow_sampler_worker_t *worker       = NULL;
+	static char *function                  = "libqcow_sampler_run";
+	int value_index                        = 0;
+	int worker_index                       = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	int number_of_threads                  = 0;
+#endif
+
+	if( sampler == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid sampler.",
+		 function );
+
+		return( -1 );
+	}
+	sampler->values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_CLUSTERS ] = sampler->number_of_cluster_blocks;
+
+	if( sampler->number_of_samples == 0 )
+	{
+		return( 1 );
+	}
+	internal_file = (libqcow_internal_file_t *) sampler->file;
+
+	/* Every sample is taken by a single worker, there is no use
+	 * for more workers than samples
+	 */
+	if( (uint64_t) sampler->number_of_workers > sampler->number_of_samples )
+	{
+		sampler->number_of_workers = (int) sampler->number_of_samples;
+	}
+	for( worker_index = 0;
+	     worker_index < sampler->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( sampler->workers[ worker_index ] );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libqcow_file_clone_reader(
+		     sampler->file,
+		     &( worker->reader ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create reader: %d.",
+			 function,
+			 worker_index );
+
+			return( -1 );
+		}
+#else
+		worker->reader = sampler->file;
+#endif
+		if( ( sampler->flags & LIBQCOW_SAMPLE_FLAG_METADATA_ONLY ) == 0 )
+		{
+			worker->cluster_block_data = (uint8_t *) memory_allocate(
+			                                          sizeof( uint8_t ) * internal_file->io_handle->cluster_block_size );
+
+			if( worker->cluster_block_data == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create cluster block data: %d.",
+				 function,
+				 worker_index );
+
+				return( -1 );
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( number_of_threads = 1;
+	     number_of_threads < sampler->number_of_workers;
+	     number_of_threads++ )
+	{
+		worker = &( sampler->workers[ number_of_threads ] );
+
+		if( libcthreads_thread_create(
+		     &( worker->thread ),
+		     NULL,
+		     &libqcow_sampler_thread_function,
+		     (void *) worker,
+		     &worker_error ) != 1 )
+		{
+			libcerror_error_set(
+			 &worker_error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread: %d.",
+			 function,
+			 number_of_threads );
+
+			libqcow_sampler_set_worker_error(
+			 sampler,
+			 &worker_error );
+
+			libqcow_sampler_stop(
+			 sampler,
+			 NULL );
+
+			break;
+		}
+	}
+#endif
+	if( libqcow_sampler_worker_run(
+	     sampler,
+	     0,
+	     &worker_error ) != 1 )
+	{
+		libqcow_sampler_set_worker_error(
+		 sampler,
+		 &worker_error );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	for( worker_index = 1;
+	     worker_index < number_of_threads;
+	     worker_index++ )
+	{
+		worker = &( sampler->workers[ worker_index ] );
+
+		if( libcthreads_thread_join(
+		     &( worker->thread ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread: %d.",
+			 function,
+			 worker_index );
+
+			sampler->result = -1;
+		}
+	}
+#endif
+	if( sampler->result == -1 )
+	{
+		/* The error of the worker that failed is passed to the caller
+		 */
+		if( ( error != NULL )
+		 && ( *error == NULL ) )
+		{
+			*error                = sampler->worker_error;
+			sampler->worker_error = NULL;
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to sample cluster blocks.",
+		 function );
+
+		return( -1 );
+	}
+	for( worker_index = 0;
+	     worker_index < sampler->number_of_workers;
+	     worker_index++ )
+	{
+		worker = &( sampler->workers[ worker_index ] );
+
+		for( value_index = 1;
+		     value_index < LIBQCOW_NUMBER_OF_SAMPLE_VALUES;
+		     value_index++ )
+		{
+			sampler->values[ value_index ] += worker->values[ value_index ];
+		}
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,172 @@
+/*
+ * Sampler functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_SAMPLER_H )
+#define _LIBQCOW_SAMPLER_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_sampler libqcow_sampler_t;
+typedef struct libqcow_sampler_worker libqcow_sampler_worker_t;
+
+/* A worker samples cluster blocks using its own reader of the file
+ */
+struct libqcow_sampler_worker
+{
+	/* The sampler
+	 */
+	libqcow_sampler_t *sampler;
+
+	/* The reader
+	 */
+	libqcow_file_t *reader;
+
+	/* The cluster block data
+	 */
+	uint8_t *cluster_block_data;
+
+	/* The values determined by the worker
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_SAMPLE_VALUES ];
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+#endif
+};
+
+/* The media is divided into as many strata of consecutive cluster blocks as
+ * there are samples and one pseudo-random cluster block is sampled per stratum.
+ * Sample N is taken by worker N modulo the number of workers, so the samples
+ * do not depend on the number of workers
+ */
+struct libqcow_sampler
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The flags
+	 */
+	int flags;
+
+	/* The number of cluster blocks of the media
+	 */
+	uint64_t number_of_cluster_blocks;
+
+	/* The number of samples
+	 */
+	uint64_t number_of_samples;
+
+	/* The values
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_SAMPLE_VALUES ];
+
+	/* The workers
+	 */
+	libqcow_sampler_worker_t *workers;
+
+	/* The number of workers
+	 */
+	int number_of_workers;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+	/* The result, 1 if completed or -1 on error
+	 */
+	int result;
+
+	/* The error of the first worker that failed
+	 */
+	libcerror_error_t *worker_error;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+#endif
+};
+
+int libqcow_sampler_initialize(
+     libqcow_sampler_t **sampler,
+     libqcow_file_t *file,
+     int flags,
+     double sampling_fraction,
+     int number_of_workers,
+     libcerror_error_t **error );
+
+int libqcow_sampler_free(
+     libqcow_sampler_t **sampler,
+     libcerror_error_t **error );
+
+uint64_t libqcow_sampler_get_cluster_block_index(
+          uint64_t number_of_cluster_blocks,
+          uint64_t number_of_samples,
+          uint64_t sample_index );
+
+int libqcow_sampler_is_high_entropy(
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_sampler_worker_run(
+     libqcow_sampler_t *sampler,
+     int worker_index,
+     libcerror_error_t **error );
+
+int libqcow_sampler_stop(
+     libqcow_sampler_t *sampler,
+     libcerror_error_t **error );
+
+void libqcow_sampler_set_worker_error(
+      libqcow_sampler_t *sampler,
+      libcerror_error_t **worker_error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_sampler_thread_function(
+     void *arguments );
+
+#endif
+
+int libqcow_sampler_run(
+     libqcow_sampler_t *sampler,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_SAMPLER_H ) */
+
@@ -0,0 +1,960 @@
+/*
+ * Scratch overlay functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_scratch_overlay.h"
+
+/* Determines the hash bucket of a block index
+ */
+#define libqcow_scratch_overlay_get_bucket_index( scratch_overlay, block_index ) \
+	(int) ( ( ( (uint64_t) ( block_index ) * LIBQCOW_BLOCK_CACHE_HASH_MULTIPLIER ) >> 32 ) & (uint64_t) ( ( scratch_overlay )->number_of_buckets - 1 ) )
+
+/* Creates a scratch overlay
+ * The scratch overlay contains the modified blocks of a file that is not written to.
+ * The block data is stored in memory or, if file_io_handle is set, in a scratch file
+ * The scratch overlay takes over management of the scratch file IO handle
+ * Make sure the value scratch_overlay is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_initialize(
+     libqcow_scratch_overlay_t **scratch_overlay,
+     size_t block_size,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	static char *function        = "libqcow_scratch_overlay_initialize";
+	size_t buckets_size          = 0;
+	uint8_t number_of_block_bits = 0;
+	int bucket_index             = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( *scratch_overlay != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid scratch overlay value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( block_size < 512 )
+	 || ( block_size > (size_t) ( 1 << 30 ) )
+	 || ( ( block_size & ( block_size - 1 ) ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	while( ( (size_t) 1 << number_of_block_bits ) < block_size )
+	{
+		number_of_block_bits++;
+	}
+	buckets_size = sizeof( int ) * LIBQCOW_SCRATCH_OVERLAY_INITIAL_NUMBER_OF_BUCKETS;
+
+	*scratch_overlay = memory_allocate_structure(
+	                    libqcow_scratch_overlay_t );
+
+	if( *scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create scratch overlay.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *scratch_overlay,
+	     0,
+	     sizeof( libqcow_scratch_overlay_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear scratch overlay.",
+		 function );
+
+		memory_free(
+		 *scratch_overlay );
+
+		*scratch_overlay = NULL;
+
+		return( -1 );
+	}
+	( *scratch_overlay )->buckets = (int *) memory_allocate(
+	                                         buckets_size );
+
+	if( ( *scratch_overlay )->buckets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buckets.",
+		 function );
+
+		goto on_error;
+	}
+	for( bucket_index = 0;
+	     bucket_index < LIBQCOW_SCRATCH_OVERLAY_INITIAL_NUMBER_OF_BUCKETS;
+	     bucket_index++ )
+	{
+		( *scratch_overlay )->buckets[ bucket_index ] = -1;
+	}
+	( *scratch_overlay )->block_size           = block_size;
+	( *scratch_overlay )->number_of_block_bits = number_of_block_bits;
+	( *scratch_overlay )->number_of_buckets    = LIBQCOW_SCRATCH_OVERLAY_INITIAL_NUMBER_OF_BUCKETS;
+	( *scratch_overlay )->file_io_handle       = file_io_handle;
+
+	return( 1 );
+
+on_error:
+	if( *scratch_overlay != NULL )
+	{
+		memory_free(
+		 *scratch_overlay );
+
+		*scratch_overlay = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a scratch overlay
+ * The modifications stored in the scratch overlay are discarded
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_free(
+     libqcow_scratch_overlay_t **scratch_overlay,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_scratch_overlay_free";
+	int entry_index       = 0;
+	int result            = 1;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( *scratch_overlay != NULL )
+	{
+		if( ( *scratch_overlay )->file_io_handle != NULL )
+		{
+			if( libbfio_handle_close(
+			     ( *scratch_overlay )->file_io_handle,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close scratch file IO handle.",
+				 function );
+
+				result = -1;
+			}
+			if( libbfio_handle_free(
+			     &( ( *scratch_overlay )->file_io_handle ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free scratch file IO handle.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( ( *scratch_overlay )->entry_data != NULL )
+		{
+			for( entry_index = 0;
+			     entry_index < ( *scratch_overlay )->number_of_entries;
+			     entry_index++ )
+			{
+				if( ( *scratch_overlay )->entry_data[ entry_index ] != NULL )
+				{
+					memory_free(
+					 ( *scratch_overlay )->entry_data[ entry_index ] );
+				}
+			}
+			memory_free(
+			 ( *scratch_overlay )->entry_data );
+		}
+		if( ( *scratch_overlay )->entry_next_indexes != NULL )
+		{
+			memory_free(
+			 ( *scratch_overlay )->entry_next_indexes );
+		}
+		if( ( *scratch_overlay )->entry_block_indexes != NULL )
+		{
+			memory_free(
+			 ( *scratch_overlay )->entry_block_indexes );
+		}
+		if( ( *scratch_overlay )->buckets != NULL )
+		{
+			memory_free(
+			 ( *scratch_overlay )->buckets );
+		}
+		memory_free(
+		 *scratch_overlay );
+
+		*scratch_overlay = NULL;
+	}
+	return( result );
+}
+
+/* Retrieves the index of the entry that contains a specific block
+ * Returns 1 if successful, 0 if the block is not in the scratch overlay or -1 on error
+ */
+int libqcow_scratch_overlay_get_entry_index(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     uint64_t block_index,
+     int *entry_index,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_scratch_overlay_get_entry_index";
+	int bucket_index      = 0;
+	int safe_entry_index  = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( entry_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid entry index.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->number_of_entries == 0 )
+	{
+		return( 0 );
+	}
+	bucket_index = libqcow_scratch_overlay_get_bucket_index(
+	                scratch_overlay,
+	                block_index );
+
+	safe_entry_index = scratch_overlay->buckets[ bucket_index ];
+
+	while( safe_entry_index != -1 )
+	{
+		if( scratch_overlay->entry_block_indexes[ safe_entry_index ] == block_index )
+		{
+			*entry_index = safe_entry_index;
+
+			return( 1 );
+		}
+		safe_entry_index = scratch_overlay->entry_next_indexes[ safe_entry_index ];
+	}
+	return( 0 );
+}
+
+/* Doubles the number of hash buckets and redistributes the entries
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_resize_buckets(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_scratch_overlay_resize_buckets";
+	int *buckets          = NULL;
+	size_t buckets_size   = 0;
+	int bucket_index      = 0;
+	int entry_index       = 0;
+	int number_of_buckets = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->number_of_buckets > ( INT_MAX / 2 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid scratch overlay - number of buckets value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_buckets = scratch_overlay->number_of_buckets * 2;
+	buckets_size      = sizeof( int ) * (size_t) number_of_buckets;
+
+	buckets = (int *) memory_allocate(
+	                   buckets_size );
+
+	if( buckets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buckets.",
+		 function );
+
+		return( -1 );
+	}
+	for( bucket_index = 0;
+	     bucket_index < number_of_buckets;
+	     bucket_index++ )
+	{
+		buckets[ bucket_index ] = -1;
+	}
+	memory_free(
+	 scratch_overlay->buckets );
+
+	scratch_overlay->buckets           = buckets;
+	scratch_overlay->number_of_buckets = number_of_buckets;
+
+	for( entry_index = 0;
+	     entry_index < scratch_overlay->number_of_entries;
+	     entry_index++ )
+	{
+		bucket_index = libqcow_scratch_overlay_get_bucket_index(
+		                scratch_overlay,
+		                scratch_overlay->entry_block_indexes[ entry_index ] );
+
+		scratch_overlay->entry_next_indexes[ entry_index ] = buckets[ bucket_index ];
+		buckets[ bucket_index ]                            = entry_index;
+	}
+	return( 1 );
+}
+
+/* Resizes the entries to hold at least one more entry
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_resize_entries(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     libcerror_error_t **error )
+{
+	static char *function         = "libqcow_scratch_overlay_resize_entries";
+	void *reallocation            = NULL;
+	int maximum_number_of_entries = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->maximum_number_of_entries == 0 )
+	{
+		maximum_number_of_entries = LIBQCOW_SCRATCH_OVERLAY_INITIAL_NUMBER_OF_BUCKETS;
+	}
+	else if( scratch_overlay->maximum_number_of_entries <= ( INT_MAX / 2 ) )
+	{
+		maximum_number_of_entries = scratch_overlay->maximum_number_of_entries * 2;
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid scratch overlay - maximum number of entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	reallocation = memory_reallocate(
+	                scratch_overlay->entry_block_indexes,
+	                sizeof( uint64_t ) * (size_t) maximum_number_of_entries );
+
+	if( reallocation == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to resize entry block indexes.",
+		 function );
+
+		return( -1 );
+	}
+	scratch_overlay->entry_block_indexes = (uint64_t *) reallocation;
+
+	reallocation = memory_reallocate(
+	                scratch_overlay->entry_next_indexes,
+	                sizeof( int ) * (size_t) maximum_number_of_entries );
+
+	if( reallocation == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to resize entry next indexes.",
+		 function );
+
+		return( -1 );
+	}
+	scratch_overlay->entry_next_indexes = (int *) reallocation;
+
+	if( scratch_overlay->file_io_handle == NULL )
+	{
+		reallocation = memory_reallocate(
+		                scratch_overlay->entry_data,
+		                sizeof( uint8_t * ) * (size_t) maximum_number_of_entries );
+
+		if( reallocation == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize entry data.",
+			 function );
+
+			return( -1 );
+		}
+		scratch_overlay->entry_data = (uint8_t **) reallocation;
+	}
+	scratch_overlay->maximum_number_of_entries = maximum_number_of_entries;
+
+	return( 1 );
+}
+
+/* Appends a block to the scratch overlay
+ * The block data must contain block size bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_append_block(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     uint64_t block_index,
+     const uint8_t *block_data,
+     libcerror_error_t **error )
+{
+	uint8_t *data         = NULL;
+	static char *function = "libqcow_scratch_overlay_append_block";
+	ssize_t write_count   = 0;
+	off64_t file_offset   = 0;
+	int bucket_index      = 0;
+	int entry_index       = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block data.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->number_of_entries >= scratch_overlay->maximum_number_of_entries )
+	{
+		if( libqcow_scratch_overlay_resize_entries(
+		     scratch_overlay,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_RESIZE_FAILED,
+			 "%s: unable to resize entries.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	entry_index = scratch_overlay->number_of_entries;
+
+	if( scratch_overlay->file_io_handle == NULL )
+	{
+		data = (uint8_t *) memory_allocate(
+		                    scratch_overlay->block_size );
+
+		if( data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create block data.",
+			 function );
+
+			return( -1 );
+		}
+		if( memory_copy(
+		     data,
+		     block_data,
+		     scratch_overlay->block_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy block data.",
+			 function );
+
+			memory_free(
+			 data );
+
+			return( -1 );
+		}
+		scratch_overlay->entry_data[ entry_index ] = data;
+	}
+	else
+	{
+		file_offset = (off64_t) entry_index << scratch_overlay->number_of_block_bits;
+
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               scratch_overlay->file_io_handle,
+		               block_data,
+		               scratch_overlay->block_size,
+		               file_offset,
+		               error );
+
+		if( write_count != (ssize_t) scratch_overlay->block_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write block data to scratch file at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 file_offset,
+			 file_offset );
+
+			return( -1 );
+		}
+	}
+	bucket_index = libqcow_scratch_overlay_get_bucket_index(
+	                scratch_overlay,
+	                block_index );
+
+	scratch_overlay->entry_block_indexes[ entry_index ] = block_index;
+	scratch_overlay->entry_next_indexes[ entry_index ]  = scratch_overlay->buckets[ bucket_index ];
+	scratch_overlay->buckets[ bucket_index ]            = entry_index;
+
+	scratch_overlay->number_of_entries += 1;
+
+	if( scratch_overlay->number_of_entries > scratch_overlay->number_of_buckets )
+	{
+		if( libqcow_scratch_overlay_resize_buckets(
+		     scratch_overlay,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_RESIZE_FAILED,
+			 "%s: unable to resize buckets.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Writes data into the block of a specific entry
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_write_entry_data(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     int entry_index,
+     size_t data_offset,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_scratch_overlay_write_entry_data";
+	ssize_t write_count   = 0;
+	off64_t file_offset   = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( entry_index < 0 )
+	 || ( entry_index >= scratch_overlay->number_of_entries ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid entry index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( data_offset > scratch_overlay->block_size )
+	 || ( data_size > ( scratch_overlay->block_size - data_offset ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid data offset or size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->file_io_handle == NULL )
+	{
+		if( memory_copy(
+		     &( ( scratch_overlay->entry_data[ entry_index ] )[ data_offset ] ),
+		     data,
+		     data_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else
+	{
+		file_offset = ( (off64_t) entry_index << scratch_overlay->number_of_block_bits ) + (off64_t) data_offset;
+
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               scratch_overlay->file_io_handle,
+		               data,
+		               data_size,
+		               file_offset,
+		               error );
+
+		if( write_count != (ssize_t) data_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write data to scratch file at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 file_offset,
+			 file_offset );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Replaces the parts of a buffer, read at a specific offset, that are in the scratch overlay
+ * The bits of the sectors that are replaced are cleared in the zero bitmap
+ * The zero bitmap is optional
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_read_buffer_at_offset(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_scratch_overlay_read_buffer_at_offset";
+	size_t buffer_offset     = 0;
+	size_t block_data_offset = 0;
+	size_t last_sector_index = 0;
+	size_t read_size         = 0;
+	size_t sector_index      = 0;
+	ssize_t read_count       = 0;
+	off64_t file_offset      = 0;
+	uint64_t block_index     = 0;
+	int entry_index          = 0;
+	int result               = 0;
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid offset value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( scratch_overlay->number_of_entries == 0 )
+	{
+		return( 1 );
+	}
+	block_index       = (uint64_t) offset >> scratch_overlay->number_of_block_bits;
+	block_data_offset = (size_t) ( (uint64_t) offset & ( scratch_overlay->block_size - 1 ) );
+
+	while( buffer_offset < buffer_size )
+	{
+		read_size = scratch_overlay->block_size - block_data_offset;
+
+		if( read_size > ( buffer_size - buffer_offset ) )
+		{
+			read_size = buffer_size - buffer_offset;
+		}
+		result = libqcow_scratch_overlay_get_entry_index(
+		          scratch_overlay,
+		          block_index,
+		          &entry_index,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve entry of block: %" PRIu64 ".",
+			 function,
+			 block_index );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			if( scratch_overlay->file_io_handle == NULL )
+			{
+				if( memory_copy(
+				     &( buffer[ buffer_offset ] ),
+				     &( ( scratch_overlay->entry_data[ entry_index ] )[ block_data_offset ] ),
+				     read_size ) == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+					 "%s: unable to copy block data.",
+					 function );
+
+					return( -1 );
+				}
+			}
+			else
+			{
+				file_offset = ( (off64_t) entry_index << scratch_overlay->number_of_block_bits ) + (off64_t) block_data_offset;
+
+				read_count = libbfio_handle_read_buffer_at_offset(
+				              scratch_overlay->file_io_handle,
+				              &( buffer[ buffer_offset ] ),
+				              read_size,
+				              file_offset,
+				              error );
+
+				if( read_count != (ssize_t) read_size )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_READ_FAILED,
+					 "%s: unable to read block data from scratch file at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+					 function,
+					 file_offset,
+					 file_offset );
+
+					return( -1 );
+				}
+			}
+			if( zero_bitmap != NULL )
+			{
+				sector_index      = buffer_offset / LIBQCOW_ZERO_BITMAP_SECTOR_SIZE;
+				last_sector_index = ( buffer_offset + read_size + LIBQCOW_ZERO_BITMAP_SECTOR_SIZE - 1 ) / LIBQCOW_ZERO_BITMAP_SECTOR_SIZE;
+
+				while( ( sector_index < last_sector_index )
+				    && ( ( sector_index / 8 ) < zero_bitmap_size ) )
+				{
+					zero_bitmap[ sector_index / 8 ] &= (uint8_t) ~( 1 << ( sector_index % 8 ) );
+
+					sector_index++;
+				}
+			}
+		}
+		buffer_offset    += read_size;
+		block_data_offset = 0;
+		block_index      += 1;
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the scratch overlay, its buckets and entries in bytes
+ * including the data of the blocks that are not stored in the scratch file
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_scratch_overlay_get_memory_usage(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_scratch_overlay_get_memory_usage";
+
+	if( scratch_overlay == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid scratch overlay.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_scratch_overlay_t )
+	              + ( sizeof( int ) * (size_t) scratch_overlay->number_of_buckets )
+	              + ( ( sizeof( uint64_t ) + sizeof( int ) ) * (size_t) scratch_overlay->maximum_number_of_entries );
+
+	if( scratch_overlay->entry_data != NULL )
+	{
+		*memory_usage += ( sizeof( uint8_t * ) * (size_t) scratch_overlay->maximum_number_of_entries )
+		               + ( scratch_overlay->block_size * (size_t) scratch_overlay->number_of_entries );
+	}
+
+	return( 1 );
+}
+
@@ -0,0 +1,140 @@
+/*
+ * Scratch overlay functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_SCRATCH_OVERLAY_H )
+#define _LIBQCOW_SCRATCH_OVERLAY_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_scratch_overlay libqcow_scratch_overlay_t;
+
+struct libqcow_scratch_overlay
+{
+	/* The block size
+	 */
+	size_t block_size;
+
+	/* The number of block bits
+	 */
+	uint8_t number_of_block_bits;
+
+	/* The hash buckets, which contain the index of the first entry
+	 * of the bucket or -1 if the bucket is empty
+	 */
+	int *buckets;
+
+	/* The number of hash buckets, which is a power of 2
+	 */
+	int number_of_buckets;
+
+	/* The block index of every entry
+	 */
+	uint64_t *entry_block_indexes;
+
+	/* The index of the next entry in the same hash bucket of every entry or -1
+	 */
+	int *entry_next_indexes;
+
+	/* The data of every entry, which is NULL if the data is stored in the scratch file
+	 */
+	uint8_t **entry_data;
+
+	/* The number of entries
+	 */
+	int number_of_entries;
+
+	/* The maximum number of entries
+	 */
+	int maximum_number_of_entries;
+
+	/* The scratch file IO handle, the data of an entry is stored
+	 * at the entry index multiplied by the block size
+	 * NULL if the data is stored in memory
+	 */
+	libbfio_handle_t *file_io_handle;
+};
+
+int libqcow_scratch_overlay_initialize(
+     libqcow_scratch_overlay_t **scratch_overlay,
+     size_t block_size,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_free(
+     libqcow_scratch_overlay_t **scratch_overlay,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_get_entry_index(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     uint64_t block_index,
+     int *entry_index,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_resize_buckets(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_resize_entries(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_append_block(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     uint64_t block_index,
+     const uint8_t *block_data,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_write_entry_data(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     int entry_index,
+     size_t data_offset,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_read_buffer_at_offset(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     off64_t offset,
+     uint8_t *buffer,
+     size_t buffer_size,
+     uint8_t *zero_bitmap,
+     size_t zero_bitmap_size,
+     libcerror_error_t **error );
+
+int libqcow_scratch_overlay_get_memory_usage(
+     libqcow_scratch_overlay_t *scratch_overlay,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_SCRATCH_OVERLAY_H ) */
+
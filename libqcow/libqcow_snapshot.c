@@ -0,0 +1,1218 @@
+/*
+ * Snapshot functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_cluster_table.h"
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_snapshot.h"
+#include "libqcow_snapshot_values.h"
+
+/* Creates a snapshot
+ * Make sure the value snapshot is referencing, is set to NULL
+ * The level 1 table of the snapshot is read using the file IO handle of the file
+ * This function is not multi-thread safe acquire the cache mutex of the file before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_snapshot_initialize(
+     libqcow_snapshot_t **snapshot,
+     libqcow_internal_file_t *internal_file,
+     libqcow_snapshot_values_t *snapshot_values,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_initialize";
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	if( *snapshot != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid snapshot value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( snapshot_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot values.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = memory_allocate_structure(
+	                     libqcow_internal_snapshot_t );
+
+	if( internal_snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create snapshot.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_snapshot,
+	     0,
+	     sizeof( libqcow_internal_snapshot_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear snapshot.",
+		 function );
+
+		memory_free(
+		 internal_snapshot );
+
+		return( -1 );
+	}
+	if( libqcow_cluster_table_initialize(
+	     &( internal_snapshot->level1_table ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_cluster_table_read_on_demand(
+	     internal_snapshot->level1_table,
+	     snapshot_values->level1_table_offset,
+	     (size_t) snapshot_values->level1_table_size,
+	     internal_file->io_handle->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set level 1 table to be read on demand.",
+		 function );
+
+		goto on_error;
+	}
+	/* The media size of a snapshot is not stored by older versions of QEMU
+	 * Since an image with snapshots cannot be shrunk the media size of the
+	 * snapshot does not exceed that of the file
+	 */
+	internal_snapshot->media_size = snapshot_values->media_size;
+
+	if( ( internal_snapshot->media_size == 0 )
+	 || ( internal_snapshot->media_size > internal_file->io_handle->media_size ) )
+	{
+		internal_snapshot->media_size = internal_file->io_handle->media_size;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_initialize(
+	     &( internal_snapshot->read_write_lock ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to intialize read/write lock.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	internal_snapshot->internal_file   = internal_file;
+	internal_snapshot->snapshot_values = snapshot_values;
+
+	*snapshot = (libqcow_snapshot_t *) internal_snapshot;
+
+	return( 1 );
+
+on_error:
+	if( internal_snapshot != NULL )
+	{
+		if( internal_snapshot->level1_table != NULL )
+		{
+			libqcow_cluster_table_free(
+			 &( internal_snapshot->level1_table ),
+			 NULL );
+		}
+		memory_free(
+		 internal_snapshot );
+	}
+	return( -1 );
+}
+
+/* Frees a snapshot
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_snapshot_free(
+     libqcow_snapshot_t **snapshot,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_free";
+	int result                                     = 1;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	if( *snapshot != NULL )
+	{
+		internal_snapshot = (libqcow_internal_snapshot_t *) *snapshot;
+		*snapshot         = NULL;
+
+		/* The internal_file and snapshot_values references are freed elsewhere
+		 */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_read_write_lock_free(
+		     &( internal_snapshot->read_write_lock ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free read/write lock.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		if( libqcow_cluster_table_free(
+		     &( internal_snapshot->level1_table ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free level 1 table.",
+			 function );
+
+			result = -1;
+		}
+		memory_free(
+		 internal_snapshot );
+	}
+	return( result );
+}
+
+/* Reads (media) data of the snapshot at a specific offset
+ * The level 2 tables and cluster blocks are read using the caches of the file
+ * so that data shared by the snapshot and the file is read only once
+ * This function does not change the current offset
+ * The read/write lock of the file is grabbed for reading
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_internal_snapshot_read_buffer_at_offset(
+         libqcow_internal_snapshot_t *internal_snapshot,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file = NULL;
+	static char *function                  = "libqcow_internal_snapshot_read_buffer_at_offset";
+	size_t buffer_offset                   = 0;
+	size_t read_size                       = 0;
+	ssize_t read_count                     = 0;
+	uint64_t cluster_block_reference       = 0;
+	int result                             = 1;
+
+	if( internal_snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_snapshot->internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid snapshot - missing file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = internal_snapshot->internal_file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid snapshot - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid buffer size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= internal_snapshot->media_size )
+	{
+		return( 0 );
+	}
+	read_size = buffer_size;
+
+	if( (size64_t) read_size > ( internal_snapshot->media_size - offset ) )
+	{
+		read_size = (size_t) ( internal_snapshot->media_size - offset );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	while( buffer_offset < read_size )
+	{
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab cache mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+#endif
+		/* The level 1 table of the snapshot refers to the level 2 tables and
+		 * cluster blocks in the file, which are cached by their file offset
+		 */
+		result = libqcow_internal_file_get_cluster_block_reference_from_level1_table(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          internal_snapshot->level1_table,
+		          offset,
+		          &cluster_block_reference,
+		          error );
+
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve cluster block reference for offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset,
+			 offset );
+
+			result = -1;
+		}
+		else
+		{
+			read_count = libqcow_internal_file_read_cluster_block_data_by_reference(
+			              internal_file,
+			              internal_file->file_io_handle,
+			              offset,
+			              cluster_block_reference,
+			              &( ( (uint8_t *) buffer )[ buffer_offset ] ),
+			              read_size - buffer_offset,
+			              error );
+
+			if( read_count <= 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read cluster block data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 offset,
+				 offset );
+
+				result = -1;
+			}
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_release(
+		     internal_file->cache_mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release cache mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		if( result != 1 )
+		{
+			break;
+		}
+		offset        += (off64_t) read_count;
+		buffer_offset += (size_t) read_count;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( result != 1 )
+	{
+		return( -1 );
+	}
+	return( (ssize_t) buffer_offset );
+}
+
+/* Reads (media) data of the snapshot from the current offset into a buffer
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_snapshot_read_buffer(
+         libqcow_snapshot_t *snapshot,
+         void *buffer,
+         size_t buffer_size,
+         libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_read_buffer";
+	ssize_t read_count                             = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	read_count = libqcow_internal_snapshot_read_buffer_at_offset(
+	              internal_snapshot,
+	              buffer,
+	              buffer_size,
+	              internal_snapshot->current_offset,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer.",
+		 function );
+	}
+	else
+	{
+		internal_snapshot->current_offset += (off64_t) read_count;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( read_count );
+}
+
+/* Reads (media) data of the snapshot at a specific offset
+ * This function does not change the current offset and can be called concurrently
+ * Returns the number of bytes read or -1 on error
+ */
+ssize_t libqcow_snapshot_read_buffer_at_offset(
+         libqcow_snapshot_t *snapshot,
+         void *buffer,
+         size_t buffer_size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_read_buffer_at_offset";
+	ssize_t read_count                             = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	read_count = libqcow_internal_snapshot_read_buffer_at_offset(
+	              internal_snapshot,
+	              buffer,
+	              buffer_size,
+	              offset,
+	              error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer.",
+		 function );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( read_count );
+}
+
+/* Seeks a certain offset of the (media) data of the snapshot
+ * Returns the offset if seek is successful or -1 on error
+ */
+off64_t libqcow_snapshot_seek_offset(
+         libqcow_snapshot_t *snapshot,
+         off64_t offset,
+         int whence,
+         libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_seek_offset";
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_SET ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_write(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	if( whence == SEEK_CUR )
+	{
+		offset += internal_snapshot->current_offset;
+	}
+	else if( whence == SEEK_END )
+	{
+		offset += (off64_t) internal_snapshot->media_size;
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		offset = -1;
+	}
+	else
+	{
+		internal_snapshot->current_offset = offset;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_write(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for writing.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( offset );
+}
+
+/* Retrieves the current offset of the (media) data of the snapshot
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_snapshot_get_offset(
+     libqcow_snapshot_t *snapshot,
+     off64_t *offset,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_offset";
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	if( offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid offset.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	*offset = internal_snapshot->current_offset;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_snapshot->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Retrieves the media size of the snapshot
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_snapshot_get_media_size(
+     libqcow_snapshot_t *snapshot,
+     size64_t *media_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_media_size";
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	if( media_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid media size.",
+		 function );
+
+		return( -1 );
+	}
+	*media_size = internal_snapshot->media_size;
+
+	return( 1 );
+}
+
+/* Retrieves the size of the UTF-8 encoded identifier
+ * The returned size includes the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_snapshot_get_utf8_identifier_size(
+     libqcow_snapshot_t *snapshot,
+     size_t *utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_utf8_identifier_size";
+	int result                                     = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	result = libqcow_snapshot_values_get_utf8_identifier_size(
+	          internal_snapshot->snapshot_values,
+	          utf8_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 identifier size.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Retrieves the UTF-8 encoded identifier
+ * The size should include the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_snapshot_get_utf8_identifier(
+     libqcow_snapshot_t *snapshot,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_utf8_identifier";
+	int result                                     = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	result = libqcow_snapshot_values_get_utf8_identifier(
+	          internal_snapshot->snapshot_values,
+	          utf8_string,
+	          utf8_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 identifier.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Retrieves the size of the UTF-8 encoded name
+ * The returned size includes the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_snapshot_get_utf8_name_size(
+     libqcow_snapshot_t *snapshot,
+     size_t *utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_utf8_name_size";
+	int result                                     = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	result = libqcow_snapshot_values_get_utf8_name_size(
+	          internal_snapshot->snapshot_values,
+	          utf8_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 name size.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Retrieves the UTF-8 encoded name
+ * The size should include the end of string character
+ * Returns 1 if successful, 0 if not available or -1 on error
+ */
+int libqcow_snapshot_get_utf8_name(
+     libqcow_snapshot_t *snapshot,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error )
+{
+	libqcow_internal_snapshot_t *internal_snapshot = NULL;
+	static char *function                          = "libqcow_snapshot_get_utf8_name";
+	int result                                     = 0;
+
+	if( snapshot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot = (libqcow_internal_snapshot_t *) snapshot;
+
+	result = libqcow_snapshot_values_get_utf8_name(
+	          internal_snapshot->snapshot_values,
+	          utf8_string,
+	          utf8_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve UTF-8 name.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Calls the callback function for every range of the media data of snapshot A
+ * that differs from snapshot B, the snapshots must be of the same file
+ * If snapshot B is NULL snapshot A is compared with the current media data of the file
+ * The ranges are determined from the level 1 and 2 tables only, the level 2 tables
+ * the snapshots share are not read, so the walk is proportional to the size of the changes
+ * The callback function returns 1 to continue, 0 to stop or -1 on error
+ * and must not call functions of the file or the snapshots
+ * Returns 1 if successful, 0 if stopped by the callback function or -1 on error
+ */
+int libqcow_snapshot_diff_extents(
+     libqcow_snapshot_t *snapshot_a,
+     libqcow_snapshot_t *snapshot_b,
+     int (*callback)(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error )
+{
+	libqcow_cluster_table_t *level1_table_b          = NULL;
+	libqcow_internal_file_t *internal_file           = NULL;
+	libqcow_internal_snapshot_t *internal_snapshot_a = NULL;
+	libqcow_internal_snapshot_t *internal_snapshot_b = NULL;
+	static char *function                            = "libqcow_snapshot_diff_extents";
+	size64_t media_size                              = 0;
+	int result                                       = 0;
+
+	if( snapshot_a == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid snapshot A.",
+		 function );
+
+		return( -1 );
+	}
+	internal_snapshot_a = (libqcow_internal_snapshot_t *) snapshot_a;
+	internal_snapshot_b = (libqcow_internal_snapshot_t *) snapshot_b;
+
+	if( internal_snapshot_a->internal_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid snapshot A - missing file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = internal_snapshot_a->internal_file;
+
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid snapshot A - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( internal_snapshot_b != NULL )
+	 && ( internal_snapshot_b->internal_file != internal_file ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported snapshot B - snapshots are of different files.",
+		 function );
+
+		return( -1 );
+	}
+	if( callback == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid callback.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_grab_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	/* The level 2 tables are cached by the file
+	 */
+	if( libqcow_internal_file_initialize_data_path_for_reading(
+	     internal_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize data path.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		if( internal_snapshot_b != NULL )
+		{
+			level1_table_b = internal_snapshot_b->level1_table;
+			media_size     = internal_snapshot_b->media_size;
+		}
+		else
+		{
+			level1_table_b = internal_file->level1_table;
+			media_size     = internal_file->io_handle->media_size;
+		}
+		if( media_size < internal_snapshot_a->media_size )
+		{
+			media_size = internal_snapshot_a->media_size;
+		}
+		result = libqcow_internal_file_diff_level1_tables(
+		          internal_file,
+		          internal_file->file_io_handle,
+		          internal_snapshot_a->level1_table,
+		          level1_table_b,
+		          media_size,
+		          callback,
+		          user_data,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to diff level 1 tables.",
+			 function );
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_read_write_lock_release_for_read(
+	     internal_file->read_write_lock,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release read/write lock for reading.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
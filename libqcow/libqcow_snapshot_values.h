@@ -0,0 +1,119 @@
+/*
+ * Snapshot values functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_SNAPSHOT_VALUES_H )
+#define _LIBQCOW_SNAPSHOT_VALUES_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_snapshot_values libqcow_snapshot_values_t;
+
+struct libqcow_snapshot_values
+{
+	/* The level 1 table offset
+	 */
+	off64_t level1_table_offset;
+
+	/* The level 1 table size
+	 */
+	uint32_t level1_table_size;
+
+	/* The creation date and time in seconds
+	 */
+	uint32_t creation_time_seconds;
+
+	/* The creation date and time nano seconds fraction
+	 */
+	uint32_t creation_time_nano_seconds;
+
+	/* The (storage) media size
+	 * Contains 0 if not stored in the snapshot
+	 */
+	size64_t media_size;
+
+	/* The identifier
+	 */
+	uint8_t *identifier;
+
+	/* The identifier size
+	 */
+	size_t identifier_size;
+
+	/* The name
+	 */
+	uint8_t *name;
+
+	/* The name size
+	 */
+	size_t name_size;
+};
+
+int libqcow_snapshot_values_initialize(
+     libqcow_snapshot_values_t **snapshot_values,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_free(
+     libqcow_snapshot_values_t **snapshot_values,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_read_file_io_handle(
+     libqcow_snapshot_values_t *snapshot_values,
+     libbfio_handle_t *file_io_handle,
+     off64_t file_offset,
+     size_t *entry_size,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_get_utf8_identifier_size(
+     libqcow_snapshot_values_t *snapshot_values,
+     size_t *utf8_string_size,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_get_utf8_identifier(
+     libqcow_snapshot_values_t *snapshot_values,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_get_utf8_name_size(
+     libqcow_snapshot_values_t *snapshot_values,
+     size_t *utf8_string_size,
+     libcerror_error_t **error );
+
+int libqcow_snapshot_values_get_utf8_name(
+     libqcow_snapshot_values_t *snapshot_values,
+     uint8_t *utf8_string,
+     size_t utf8_string_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_SNAPSHOT_VALUES_H ) */
+
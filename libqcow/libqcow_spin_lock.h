@@ -0,0 +1,74 @@
+/*
+ * Spin lock functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_SPIN_LOCK_H )
+#define _LIBQCOW_SPIN_LOCK_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( _MSC_VER )
+#include <windows.h>
+#endif
+
+#include "libqcow_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* A spin lock guards process-wide values that are only held for the duration
+ * of a copy or a reference count update, unlike a libcthreads lock it does not
+ * require initialization
+ */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+typedef int libqcow_spin_lock_t;
+
+#define LIBQCOW_SPIN_LOCK_GRAB( lock ) \
+	while( __atomic_exchange_n( &( lock ), 1, __ATOMIC_ACQUIRE ) != 0 ) { }
+
+#define LIBQCOW_SPIN_LOCK_RELEASE( lock ) \
+	__atomic_store_n( &( lock ), 0, __ATOMIC_RELEASE )
+
+#elif defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( _MSC_VER )
+typedef LONG volatile libqcow_spin_lock_t;
+
+#define LIBQCOW_SPIN_LOCK_GRAB( lock ) \
+	while( InterlockedExchange( &( lock ), 1 ) != 0 ) { }
+
+#define LIBQCOW_SPIN_LOCK_RELEASE( lock ) \
+	InterlockedExchange( &( lock ), 0 )
+
+#else
+typedef int libqcow_spin_lock_t;
+
+#define LIBQCOW_SPIN_LOCK_GRAB( lock )
+
+#define LIBQCOW_SPIN_LOCK_RELEASE( lock )
+
+#endif
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_SPIN_LOCK_H ) */
+
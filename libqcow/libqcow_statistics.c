@@ -0,0 +1,648 @@
+/*
+ * Statistics functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( WINAPI )
+#include <windows.h>
+
+#elif defined( HAVE_CLOCK_GETTIME )
+#include <time.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_statistics.h"
+
+/* Creates statistics
+ * Make sure the value statistics is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_initialize(
+     libqcow_statistics_t **statistics,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_statistics_initialize";
+
+	if( statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid statistics.",
+		 function );
+
+		return( -1 );
+	}
+	if( *statistics != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid statistics value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*statistics = memory_allocate_structure(
+	               libqcow_statistics_t );
+
+	if( *statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create statistics.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *statistics,
+	     0,
+	     sizeof( libqcow_statistics_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear statistics.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( *statistics != NULL )
+	{
+		memory_free(
+		 *statistics );
+
+		*statistics = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees statistics
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_free(
+     libqcow_statistics_t **statistics,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_statistics_free";
+
+	if( statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid statistics.",
+		 function );
+
+		return( -1 );
+	}
+	if( *statistics != NULL )
+	{
+		memory_free(
+		 *statistics );
+
+		*statistics = NULL;
+	}
+	return( 1 );
+}
+
+/* Clears statistics
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_clear(
+     libqcow_statistics_t *statistics,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_statistics_clear";
+	int bucket_index      = 0;
+	int operation         = 0;
+
+	if( statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid statistics.",
+		 function );
+
+		return( -1 );
+	}
+	LIBQCOW_STATISTICS_SET( statistics->level2_table_cache_lookups, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->level2_table_cache_misses, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->cluster_block_cache_lookups, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->cluster_block_cache_misses, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->compressed_cluster_block_cache_hits, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->compressed_cluster_block_cache_misses, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->number_of_host_reads, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->host_bytes_read, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->bytes_returned, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->sparse_bytes, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->number_of_decompressions, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->decompression_time, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->number_of_decryptions, 0 );
+	LIBQCOW_STATISTICS_SET( statistics->decryption_time, 0 );
+
+	/* The latency histograms are cleared but remain enabled
+	 */
+	for( operation = 0;
+	     operation < LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS;
+	     operation++ )
+	{
+		for( bucket_index = 0;
+		     bucket_index < LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+		     bucket_index++ )
+		{
+			LIBQCOW_STATISTICS_SET( statistics->latency_histograms[ operation ][ bucket_index ], 0 );
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves the statistic values
+ * The values are stored by statistic type, see LIBQCOW_STATISTICS, values beyond
+ * the number of supported statistic types are set to 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_get_values(
+     libqcow_statistics_t *statistics,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error )
+{
+	uint64_t safe_values[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	static char *function = "libqcow_statistics_get_values";
+	uint64_t lookups      = 0;
+	uint64_t misses       = 0;
+	int value_index       = 0;
+
+	if( statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid statistics.",
+		 function );
+
+		return( -1 );
+	}
+	if( values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid values.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_values < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid number of values value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	/* The hits are derived from the lookups since the misses are counted
+	 * where the cached values are read
+	 */
+	lookups = LIBQCOW_STATISTICS_GET( statistics->level2_table_cache_lookups );
+	misses  = LIBQCOW_STATISTICS_GET( statistics->level2_table_cache_misses );
+
+	if( misses > lookups )
+	{
+		misses = lookups;
+	}
+	safe_values[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_HITS ]   = lookups - misses;
+	safe_values[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_MISSES ] = misses;
+
+	lookups = LIBQCOW_STATISTICS_GET( statistics->cluster_block_cache_lookups );
+	misses  = LIBQCOW_STATISTICS_GET( statistics->cluster_block_cache_misses );
+
+	if( misses > lookups )
+	{
+		misses = lookups;
+	}
+	safe_values[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_HITS ]   = lookups - misses;
+	safe_values[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_MISSES ] = misses;
+
+	safe_values[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_HITS ]   = LIBQCOW_STATISTICS_GET( statistics->compressed_cluster_block_cache_hits );
+	safe_values[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_MISSES ] = LIBQCOW_STATISTICS_GET( statistics->compressed_cluster_block_cache_misses );
+	safe_values[ LIBQCOW_STATISTIC_NUMBER_OF_HOST_READS ]                  = LIBQCOW_STATISTICS_GET( statistics->number_of_host_reads );
+	safe_values[ LIBQCOW_STATISTIC_HOST_BYTES_READ ]                       = LIBQCOW_STATISTICS_GET( statistics->host_bytes_read );
+	safe_values[ LIBQCOW_STATISTIC_BYTES_RETURNED ]                        = LIBQCOW_STATISTICS_GET( statistics->bytes_returned );
+	safe_values[ LIBQCOW_STATISTIC_SPARSE_BYTES ]                          = LIBQCOW_STATISTICS_GET( statistics->sparse_bytes );
+	safe_values[ LIBQCOW_STATISTIC_NUMBER_OF_DECOMPRESSIONS ]              = LIBQCOW_STATISTICS_GET( statistics->number_of_decompressions );
+	safe_values[ LIBQCOW_STATISTIC_DECOMPRESSION_TIME ]                    = LIBQCOW_STATISTICS_GET( statistics->decompression_time );
+	safe_values[ LIBQCOW_STATISTIC_NUMBER_OF_DECRYPTIONS ]                 = LIBQCOW_STATISTICS_GET( statistics->number_of_decryptions );
+	safe_values[ LIBQCOW_STATISTIC_DECRYPTION_TIME ]                       = LIBQCOW_STATISTICS_GET( statistics->decryption_time );
+
+	for( value_index = 0;
+	     value_index < number_of_values;
+	     value_index++ )
+	{
+		if( value_index < LIBQCOW_NUMBER_OF_STATISTICS )
+		{
+			values[ value_index ] = safe_values[ value_index ];
+		}
+		else
+		{
+			values[ value_index ] = 0;
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves a monotonic timestamp in nanoseconds
+ * Returns the timestamp or 0 if not available
+ */
+uint64_t libqcow_statistics_get_timestamp(
+          void )
+{
+#if defined( WINAPI )
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	if( QueryPerformanceFrequency(
+	     &frequency ) == 0 )
+	{
+		return( 0 );
+	}
+	if( QueryPerformanceCounter(
+	     &counter ) == 0 )
+	{
+		return( 0 );
+	}
+	/* Split the conversion to prevent the multiplication from overflowing
+	 */
+	return( ( (uint64_t) ( counter.QuadPart / frequency.QuadPart ) * 1000000000UL )
+	      + ( (uint64_t) ( counter.QuadPart % frequency.QuadPart ) * 1000000000UL / (uint64_t) frequency.QuadPart ) );
+
+#elif defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec time_specification;
+
+	if( clock_gettime(
+	     CLOCK_MONOTONIC,
+	     &time_specification ) != 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) time_specification.tv_sec * 1000000000UL ) + (uint64_t) time_specification.tv_nsec );
+
+#else
+	return( 0 );
+#endif
+}
+
+/* Determines the latency histogram bucket index of a latency
+ * The latencies below 32 have a bucket each, larger latencies are divided over
+ * 16 buckets per power of 2, which bounds the relative error to 1/16
+ * Returns the bucket index
+ */
+int libqcow_statistics_get_latency_bucket_index(
+     uint64_t latency )
+{
+	int bit_index = 0;
+
+	if( latency < 32 )
+	{
+		return( (int) latency );
+	}
+#if defined( __GNUC__ )
+	bit_index = 63 - __builtin_clzll( (unsigned long long) latency );
+#else
+	for( bit_index = 63;
+	     bit_index > 5;
+	     bit_index-- )
+	{
+		if( ( latency >> bit_index ) != 0 )
+		{
+			break;
+		}
+	}
+#endif
+	/* The 4 bits below the most significant bit select the bucket within the power of 2
+	 */
+	return( ( ( bit_index - 3 ) * 16 ) + (int) ( ( latency >> ( bit_index - 4 ) ) & 0x0f ) );
+}
+
+/* Retrieves the bounds of a latency histogram bucket
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_get_latency_bucket_bounds(
+     int bucket_index,
+     uint64_t *lower_bound,
+     uint64_t *upper_bound,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_statistics_get_latency_bucket_bounds";
+	int shift             = 0;
+
+	if( ( bucket_index < 0 )
+	 || ( bucket_index >= LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid bucket index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( lower_bound == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid lower bound.",
+		 function );
+
+		return( -1 );
+	}
+	if( upper_bound == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid upper bound.",
+		 function );
+
+		return( -1 );
+	}
+	if( bucket_index < 32 )
+	{
+		*lower_bound = (uint64_t) bucket_index;
+		*upper_bound = (uint64_t) bucket_index;
+	}
+	else
+	{
+		shift = ( bucket_index / 16 ) - 1;
+
+		*lower_bound = (uint64_t) ( 16 + ( bucket_index % 16 ) ) << shift;
+		*upper_bound = *lower_bound + ( ( (uint64_t) 1 << shift ) - 1 );
+	}
+	return( 1 );
+}
+
+/* Adds a latency to the histogram of an operation
+ * This function is called on the read path hence it does not set an error
+ */
+void libqcow_statistics_add_latency(
+      libqcow_statistics_t *statistics,
+      int operation,
+      uint64_t latency )
+{
+	if( ( statistics == NULL )
+	 || ( operation < 0 )
+	 || ( operation >= LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ) )
+	{
+		return;
+	}
+	LIBQCOW_STATISTICS_ADD( statistics->latency_histograms[ operation ][ libqcow_statistics_get_latency_bucket_index( latency ) ], 1 );
+}
+
+/* Retrieves the latency histogram of an operation
+ * The counts are stored by bucket index, counts beyond
+ * LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS are set to 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_get_latency_histogram(
+     libqcow_statistics_t *statistics,
+     int operation,
+     uint64_t *counts,
+     int number_of_counts,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_statistics_get_latency_histogram";
+	int bucket_index      = 0;
+
+	if( statistics == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid statistics.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( operation < 0 )
+	 || ( operation >= LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported operation: %d.",
+		 function,
+		 operation );
+
+		return( -1 );
+	}
+	if( counts == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid counts.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_counts < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_LESS_THAN_ZERO,
+		 "%s: invalid number of counts value less than zero.",
+		 function );
+
+		return( -1 );
+	}
+	for( bucket_index = 0;
+	     bucket_index < number_of_counts;
+	     bucket_index++ )
+	{
+		if( bucket_index < LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS )
+		{
+			counts[ bucket_index ] = LIBQCOW_STATISTICS_GET( statistics->latency_histograms[ operation ][ bucket_index ] );
+		}
+		else
+		{
+			counts[ bucket_index ] = 0;
+		}
+	}
+	return( 1 );
+}
+
+/* Retrieves a latency percentile of an operation
+ * The percentile is a value between 0.0 and 100.0, the latency is the upper bound
+ * of the bucket that contains the percentile or 0 if no latencies were recorded
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_statistics_get_latency_percentile(
+     libqcow_statistics_t *statistics,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error )
+{
+	uint64_t counts[ LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ];
+
+	static char *function     = "libqcow_statistics_get_latency_percentile";
+	uint64_t lower_bound      = 0;
+	uint64_t rank             = 0;
+	uint64_t safe_latency     = 0;
+	uint64_t total_count      = 0;
+	uint64_t cumulative_count = 0;
+	int bucket_index          = 0;
+
+	if( ( percentile < 0.0 )
+	 || ( percentile > 100.0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid percentile value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of values.",
+		 function );
+
+		return( -1 );
+	}
+	if( latency == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid latency.",
+		 function );
+
+		return( -1 );
+	}
+	/* A copy of the counts is used so the percentile is consistent with the total
+	 * while other threads add latencies
+	 */
+	if( libqcow_statistics_get_latency_histogram(
+	     statistics,
+	     operation,
+	     counts,
+	     LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve latency histogram.",
+		 function );
+
+		return( -1 );
+	}
+	for( bucket_index = 0;
+	     bucket_index < LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+	     bucket_index++ )
+	{
+		total_count += counts[ bucket_index ];
+	}
+	if( total_count > 0 )
+	{
+		rank = (uint64_t) ( ( percentile * (double) total_count ) / 100.0 );
+
+		if( ( (double) rank * 100.0 ) < ( percentile * (double) total_count ) )
+		{
+			rank++;
+		}
+		if( rank == 0 )
+		{
+			rank = 1;
+		}
+		for( bucket_index = 0;
+		     bucket_index < LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+		     bucket_index++ )
+		{
+			cumulative_count += counts[ bucket_index ];
+
+			if( cumulative_count >= rank )
+			{
+				break;
+			}
+		}
+		if( libqcow_statistics_get_latency_bucket_bounds(
+		     bucket_index,
+		     &lower_bound,
+		     &safe_latency,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve bucket: %d bounds.",
+			 function,
+			 bucket_index );
+
+			return( -1 );
+		}
+	}
+	*number_of_values = total_count;
+	*latency          = safe_latency;
+
+	return( 1 );
+}
@@ -0,0 +1,204 @@
+/*
+ * Statistics functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_STATISTICS_H )
+#define _LIBQCOW_STATISTICS_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( _MSC_VER ) && defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+#include <windows.h>
+#endif
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The counters are updated from the read-ahead, worker and read request threads
+ * without holding a lock, hence atomic additions are used when available
+ */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+#define LIBQCOW_STATISTICS_ADD( counter, value ) \
+	__atomic_fetch_add( &( counter ), (uint64_t) ( value ), __ATOMIC_RELAXED )
+
+#define LIBQCOW_STATISTICS_GET( counter ) \
+	__atomic_load_n( &( counter ), __ATOMIC_RELAXED )
+
+#define LIBQCOW_STATISTICS_SET( counter, value ) \
+	__atomic_store_n( &( counter ), (uint64_t) ( value ), __ATOMIC_RELAXED )
+
+#elif defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( _MSC_VER )
+#define LIBQCOW_STATISTICS_ADD( counter, value ) \
+	InterlockedExchangeAdd64( (LONG64 volatile *) &( counter ), (LONG64) ( value ) )
+
+#define LIBQCOW_STATISTICS_GET( counter ) \
+	(uint64_t) InterlockedCompareExchange64( (LONG64 volatile *) &( counter ), 0, 0 )
+
+#define LIBQCOW_STATISTICS_SET( counter, value ) \
+	InterlockedExchange64( (LONG64 volatile *) &( counter ), (LONG64) ( value ) )
+
+#else
+#define LIBQCOW_STATISTICS_ADD( counter, value ) \
+	( counter ) += (uint64_t) ( value )
+
+#define LIBQCOW_STATISTICS_GET( counter ) \
+	( counter )
+
+#define LIBQCOW_STATISTICS_SET( counter, value ) \
+	( counter ) = (uint64_t) ( value )
+
+#endif
+
+/* The latencies are only measured when the histograms are enabled
+ * since retrieving a timestamp is not free
+ */
+#define LIBQCOW_STATISTICS_LATENCY_HISTOGRAMS_ENABLED( statistics ) \
+	( ( ( statistics ) != NULL ) && ( LIBQCOW_STATISTICS_GET( ( statistics )->latency_histograms_enabled ) != 0 ) )
+
+typedef struct libqcow_statistics libqcow_statistics_t;
+
+struct libqcow_statistics
+{
+	/* The number of level 2 table cache lookups
+	 */
+	uint64_t level2_table_cache_lookups;
+
+	/* The number of level 2 table cache misses
+	 */
+	uint64_t level2_table_cache_misses;
+
+	/* The number of cluster block cache lookups
+	 */
+	uint64_t cluster_block_cache_lookups;
+
+	/* The number of cluster block cache misses
+	 */
+	uint64_t cluster_block_cache_misses;
+
+	/* The number of compressed cluster block cache hits
+	 */
+	uint64_t compressed_cluster_block_cache_hits;
+
+	/* The number of compressed cluster block cache misses
+	 */
+	uint64_t compressed_cluster_block_cache_misses;
+
+	/* The number of reads from the host file
+	 */
+	uint64_t number_of_host_reads;
+
+	/* The number of bytes read from the host file
+	 */
+	uint64_t host_bytes_read;
+
+	/* The number of bytes returned to the caller
+	 */
+	uint64_t bytes_returned;
+
+	/* The number of bytes served from sparse and zero cluster blocks
+	 */
+	uint64_t sparse_bytes;
+
+	/* The number of decompressed cluster blocks
+	 */
+	uint64_t number_of_decompressions;
+
+	/* The time spent decompressing in nanoseconds
+	 */
+	uint64_t decompression_time;
+
+	/* The number of decrypted cluster blocks
+	 */
+	uint64_t number_of_decryptions;
+
+	/* The time spent decrypting in nanoseconds
+	 */
+	uint64_t decryption_time;
+
+	/* Value to indicate the latencies are recorded in the histograms
+	 */
+	uint64_t latency_histograms_enabled;
+
+	/* The latency histograms per operation, see LIBQCOW_LATENCY_OPERATIONS
+	 */
+	uint64_t latency_histograms[ LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ][ LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ];
+};
+
+int libqcow_statistics_initialize(
+     libqcow_statistics_t **statistics,
+     libcerror_error_t **error );
+
+int libqcow_statistics_free(
+     libqcow_statistics_t **statistics,
+     libcerror_error_t **error );
+
+int libqcow_statistics_clear(
+     libqcow_statistics_t *statistics,
+     libcerror_error_t **error );
+
+int libqcow_statistics_get_values(
+     libqcow_statistics_t *statistics,
+     uint64_t *values,
+     int number_of_values,
+     libcerror_error_t **error );
+
+uint64_t libqcow_statistics_get_timestamp(
+          void );
+
+int libqcow_statistics_get_latency_bucket_index(
+     uint64_t latency );
+
+int libqcow_statistics_get_latency_bucket_bounds(
+     int bucket_index,
+     uint64_t *lower_bound,
+     uint64_t *upper_bound,
+     libcerror_error_t **error );
+
+void libqcow_statistics_add_latency(
+      libqcow_statistics_t *statistics,
+      int operation,
+      uint64_t latency );
+
+int libqcow_statistics_get_latency_histogram(
+     libqcow_statistics_t *statistics,
+     int operation,
+     uint64_t *counts,
+     int number_of_counts,
+     libcerror_error_t **error );
+
+int libqcow_statistics_get_latency_percentile(
+     libqcow_statistics_t *statistics,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_STATISTICS_H ) */
+
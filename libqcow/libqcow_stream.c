@@ -0,0 +1,1230 @@
+/*
+ * Stream functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_file.h"
+#include "libqcow_io_handle.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcnotify.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_stream.h"
+#include "libqcow_types.h"
+
+/* Opens a stream of the (media) data of a specific range
+ * Make sure the value stream is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_stream_open(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     int number_of_threads,
+     int maximum_number_of_chunks,
+     libqcow_stream_t **stream,
+     libcerror_error_t **error )
+{
+	libqcow_internal_file_t *internal_file     = NULL;
+	libqcow_internal_stream_t *internal_stream = NULL;
+	static char *function                      = "libqcow_stream_open";
+	size64_t media_size                        = 0;
+	size_t cluster_block_size                  = 0;
+	size_t slot_data_size                      = 0;
+	uint64_t first_chunk_index                 = 0;
+	uint64_t number_of_chunks                  = 0;
+	int number_of_slots                        = 0;
+	int slot_index                             = 0;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	libqcow_stream_worker_t *worker            = NULL;
+	int number_of_workers                      = 0;
+	int worker_index                           = 0;
+#endif
+
+	if( file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file.",
+		 function );
+
+		return( -1 );
+	}
+	internal_file = (libqcow_internal_file_t *) file;
+
+	if( internal_file->io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_file->file_io_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid file - missing file IO handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( offset < 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_size > (size_t) LIBQCOW_STREAM_MAXIMUM_CHUNK_SIZE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid chunk size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_threads < 0 )
+	 || ( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of threads value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_chunks < 0 )
+	 || ( maximum_number_of_chunks > LIBQCOW_STREAM_MAXIMUM_NUMBER_OF_CHUNKS ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of chunks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+	if( *stream != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid stream value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_media_size(
+	     file,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		return( -1 );
+	}
+	if( (size64_t) offset >= media_size )
+	{
+		size = 0;
+	}
+	else if( size > ( media_size - (size64_t) offset ) )
+	{
+		size = media_size - (size64_t) offset;
+	}
+	/* Chunks consist of whole cluster blocks so that workers do not read
+	 * the same cluster block
+	 */
+	cluster_block_size = internal_file->io_handle->cluster_block_size;
+
+	if( chunk_size == 0 )
+	{
+		chunk_size = (size_t) LIBQCOW_STREAM_DEFAULT_CHUNK_SIZE;
+	}
+	if( ( cluster_block_size != 0 )
+	 && ( ( chunk_size % cluster_block_size ) != 0 ) )
+	{
+		chunk_size = ( ( chunk_size / cluster_block_size ) + 1 ) * cluster_block_size;
+	}
+	if( chunk_size > (size_t) LIBQCOW_STREAM_MAXIMUM_CHUNK_SIZE )
+	{
+		chunk_size = (size_t) LIBQCOW_STREAM_MAXIMUM_CHUNK_SIZE;
+	}
+	if( size > 0 )
+	{
+		first_chunk_index = (uint64_t) offset / chunk_size;
+		number_of_chunks  = ( ( (uint64_t) offset + size + chunk_size - 1 ) / chunk_size ) - first_chunk_index;
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_threads == 0 )
+	{
+		if( libqcow_file_get_number_of_worker_threads(
+		     file,
+		     &number_of_threads,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve number of worker threads.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( number_of_threads == 0 )
+	{
+		number_of_threads = 1;
+	}
+	else if( number_of_threads > LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS )
+	{
+		number_of_threads = LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS;
+	}
+	number_of_slots = maximum_number_of_chunks;
+
+	if( number_of_slots == 0 )
+	{
+		number_of_slots = 2 * number_of_threads;
+	}
+	if( number_of_slots > LIBQCOW_STREAM_MAXIMUM_NUMBER_OF_CHUNKS )
+	{
+		number_of_slots = LIBQCOW_STREAM_MAXIMUM_NUMBER_OF_CHUNKS;
+	}
+	if( (uint64_t) number_of_slots > number_of_chunks )
+	{
+		number_of_slots = (int) number_of_chunks;
+	}
+	/* A worker without a slot to read into would be idle
+	 */
+	number_of_workers = number_of_threads;
+
+	if( number_of_workers > number_of_slots )
+	{
+		number_of_workers = number_of_slots;
+	}
+#else
+	/* Without multi-thread support the chunks are read by libqcow_stream_next
+	 */
+	if( number_of_chunks > 0 )
+	{
+		number_of_slots = 1;
+	}
+#endif
+	internal_stream = memory_allocate_structure(
+	                   libqcow_internal_stream_t );
+
+	if( internal_stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create stream.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     internal_stream,
+	     0,
+	     sizeof( libqcow_internal_stream_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear stream.",
+		 function );
+
+		memory_free(
+		 internal_stream );
+
+		return( -1 );
+	}
+	internal_stream->file                  = file;
+	internal_stream->offset                = offset;
+	internal_stream->end_offset            = offset + (off64_t) size;
+	internal_stream->chunk_size            = chunk_size;
+	internal_stream->end_chunk_index       = first_chunk_index + number_of_chunks;
+	internal_stream->next_read_chunk_index = first_chunk_index;
+	internal_stream->next_chunk_index      = first_chunk_index;
+	internal_stream->released_chunk_index  = first_chunk_index;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( internal_stream->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( internal_stream->ready_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create ready condition.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( internal_stream->release_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create release condition.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( number_of_slots > 0 )
+	{
+		internal_stream->slots = (libqcow_stream_slot_t *) memory_allocate(
+		                                                    sizeof( libqcow_stream_slot_t ) * number_of_slots );
+
+		if( internal_stream->slots == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create slots.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     internal_stream->slots,
+		     0,
+		     sizeof( libqcow_stream_slot_t ) * number_of_slots ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear slots.",
+			 function );
+
+			memory_free(
+			 internal_stream->slots );
+
+			internal_stream->slots = NULL;
+
+			goto on_error;
+		}
+		internal_stream->number_of_slots = number_of_slots;
+
+		/* A chunk is never larger than the range
+		 */
+		slot_data_size = chunk_size;
+
+		if( (size64_t) slot_data_size > size )
+		{
+			slot_data_size = (size_t) size;
+		}
+		for( slot_index = 0;
+		     slot_index < number_of_slots;
+		     slot_index++ )
+		{
+			internal_stream->slots[ slot_index ].data = (uint8_t *) memory_allocate(
+			                                                         sizeof( uint8_t ) * slot_data_size );
+
+			if( internal_stream->slots[ slot_index ].data == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create slot: %d data.",
+				 function,
+				 slot_index );
+
+				goto on_error;
+			}
+		}
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( number_of_workers > 0 )
+	{
+		internal_stream->workers = (libqcow_stream_worker_t *) memory_allocate(
+		                                                        sizeof( libqcow_stream_worker_t ) * number_of_workers );
+
+		if( internal_stream->workers == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create workers.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     internal_stream->workers,
+		     0,
+		     sizeof( libqcow_stream_worker_t ) * number_of_workers ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear workers.",
+			 function );
+
+			memory_free(
+			 internal_stream->workers );
+
+			internal_stream->workers = NULL;
+
+			goto on_error;
+		}
+		internal_stream->number_of_workers = number_of_workers;
+
+		for( worker_index = 0;
+		     worker_index < number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( internal_stream->workers[ worker_index ] );
+
+			worker->stream = internal_stream;
+
+			if( libqcow_file_clone_reader(
+			     file,
+			     &( worker->reader ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create reader: %d.",
+				 function,
+				 worker_index );
+
+				goto on_error;
+			}
+		}
+		for( worker_index = 0;
+		     worker_index < number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( internal_stream->workers[ worker_index ] );
+
+			if( libcthreads_thread_create(
+			     &( worker->thread ),
+			     NULL,
+			     &libqcow_stream_thread_function,
+			     (void *) worker,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create thread: %d.",
+				 function,
+				 worker_index );
+
+				goto on_error;
+			}
+		}
+	}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	*stream = (libqcow_stream_t *) internal_stream;
+
+	return( 1 );
+
+on_error:
+	if( internal_stream != NULL )
+	{
+		/* Freeing the stream also stops the threads that were created
+		 */
+		libqcow_stream_free(
+		 (libqcow_stream_t **) &internal_stream,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Frees a stream
+ * The workers are stopped and the chunk data returned by the stream is no longer valid
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_stream_free(
+     libqcow_stream_t **stream,
+     libcerror_error_t **error )
+{
+	libqcow_internal_stream_t *internal_stream = NULL;
+	libqcow_stream_worker_t *worker            = NULL;
+	static char *function                      = "libqcow_stream_free";
+	int result                                 = 1;
+	int slot_index                             = 0;
+	int worker_index                           = 0;
+
+	if( stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+	if( *stream != NULL )
+	{
+		internal_stream = (libqcow_internal_stream_t *) *stream;
+		*stream         = NULL;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( internal_stream->mutex != NULL )
+		{
+			if( libqcow_internal_stream_stop(
+			     internal_stream,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to stop stream.",
+				 function );
+
+				result = -1;
+			}
+		}
+		for( worker_index = 0;
+		     worker_index < internal_stream->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( internal_stream->workers[ worker_index ] );
+
+			if( worker->thread != NULL )
+			{
+				/* The reader and slots cannot be released safely if the thread has not stopped
+				 */
+				if( libcthreads_thread_join(
+				     &( worker->thread ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to join thread: %d.",
+					 function,
+					 worker_index );
+
+					return( -1 );
+				}
+			}
+		}
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+		for( worker_index = 0;
+		     worker_index < internal_stream->number_of_workers;
+		     worker_index++ )
+		{
+			worker = &( internal_stream->workers[ worker_index ] );
+
+			if( worker->reader != NULL )
+			{
+				if( libqcow_file_free(
+				     &( worker->reader ),
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+					 "%s: unable to free reader: %d.",
+					 function,
+					 worker_index );
+
+					result = -1;
+				}
+			}
+		}
+		if( internal_stream->workers != NULL )
+		{
+			memory_free(
+			 internal_stream->workers );
+		}
+		for( slot_index = 0;
+		     slot_index < internal_stream->number_of_slots;
+		     slot_index++ )
+		{
+			if( internal_stream->slots[ slot_index ].data != NULL )
+			{
+				memory_free(
+				 internal_stream->slots[ slot_index ].data );
+			}
+			if( internal_stream->slots[ slot_index ].error != NULL )
+			{
+				libcerror_error_free(
+				 &( internal_stream->slots[ slot_index ].error ) );
+			}
+		}
+		if( internal_stream->slots != NULL )
+		{
+			memory_free(
+			 internal_stream->slots );
+		}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_free(
+		     &( internal_stream->release_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free release condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_condition_free(
+		     &( internal_stream->ready_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free ready condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_free(
+		     &( internal_stream->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 internal_stream );
+	}
+	return( result );
+}
+
+/* Stops the workers of a stream
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_stream_stop(
+     libqcow_internal_stream_t *internal_stream,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_internal_stream_stop";
+
+	if( internal_stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_stream->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	internal_stream->abort = 1;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* Wake up the workers that wait for a slot to be released
+	 */
+	if( libcthreads_condition_broadcast(
+	     internal_stream->release_condition,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to broadcast release condition.",
+		 function );
+
+		libcthreads_mutex_release(
+		 internal_stream->mutex,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libcthreads_mutex_release(
+	     internal_stream->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+}
+
+/* Reads a specific chunk into a slot
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_internal_stream_read_chunk(
+     libqcow_internal_stream_t *internal_stream,
+     libqcow_file_t *reader,
+     uint64_t chunk_index,
+     libqcow_stream_slot_t *slot,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_internal_stream_read_chunk";
+	ssize_t read_count       = 0;
+	off64_t chunk_end_offset = 0;
+	off64_t chunk_offset     = 0;
+
+	if( internal_stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+	if( slot == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid slot.",
+		 function );
+
+		return( -1 );
+	}
+	chunk_offset     = (off64_t) ( chunk_index * internal_stream->chunk_size );
+	chunk_end_offset = chunk_offset + (off64_t) internal_stream->chunk_size;
+
+	if( chunk_offset < internal_stream->offset )
+	{
+		chunk_offset = internal_stream->offset;
+	}
+	if( chunk_end_offset > internal_stream->end_offset )
+	{
+		chunk_end_offset = internal_stream->end_offset;
+	}
+	slot->chunk_offset = chunk_offset;
+	slot->chunk_size   = (size_t) ( chunk_end_offset - chunk_offset );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              reader,
+	              slot->data,
+	              slot->chunk_size,
+	              slot->chunk_offset,
+	              error );
+
+	if( read_count != (ssize_t) slot->chunk_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read chunk at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 slot->chunk_offset,
+		 slot->chunk_offset );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* The worker thread function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_stream_thread_function(
+     void *arguments )
+{
+	libcerror_error_t *error                   = NULL;
+	libqcow_internal_stream_t *internal_stream = NULL;
+	libqcow_stream_slot_t *slot                = NULL;
+	libqcow_stream_worker_t *worker            = NULL;
+	static char *function                      = "libqcow_stream_thread_function";
+	uint64_t chunk_index                       = 0;
+	int result                                 = 0;
+
+	if( arguments == NULL )
+	{
+		return( -1 );
+	}
+	worker          = (libqcow_stream_worker_t *) arguments;
+	internal_stream = worker->stream;
+
+	do
+	{
+		if( libcthreads_mutex_grab(
+		     internal_stream->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			goto on_error;
+		}
+		/* Wait until the slot of the next chunk has been released
+		 */
+		while( ( internal_stream->abort == 0 )
+		    && ( internal_stream->next_read_chunk_index < internal_stream->end_chunk_index )
+		    && ( internal_stream->next_read_chunk_index >= ( internal_stream->released_chunk_index + internal_stream->number_of_slots ) ) )
+		{
+			if( libcthreads_condition_wait(
+			     internal_stream->release_condition,
+			     internal_stream->mutex,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to wait for release condition.",
+				 function );
+
+				libcthreads_mutex_release(
+				 internal_stream->mutex,
+				 NULL );
+
+				goto on_error;
+			}
+		}
+		result = 0;
+
+		if( ( internal_stream->abort == 0 )
+		 && ( internal_stream->next_read_chunk_index < internal_stream->end_chunk_index ) )
+		{
+			chunk_index = internal_stream->next_read_chunk_index;
+
+			internal_stream->next_read_chunk_index += 1;
+
+			result = 1;
+		}
+		if( libcthreads_mutex_release(
+		     internal_stream->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			goto on_error;
+		}
+		if( result == 0 )
+		{
+			break;
+		}
+		slot = &( internal_stream->slots[ chunk_index % internal_stream->number_of_slots ] );
+
+		/* A chunk that cannot be read is reported by libqcow_stream_next
+		 */
+		result = libqcow_internal_stream_read_chunk(
+		          internal_stream,
+		          worker->reader,
+		          chunk_index,
+		          slot,
+		          &( slot->error ) );
+
+		if( libcthreads_mutex_grab(
+		     internal_stream->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			goto on_error;
+		}
+		slot->is_ready = 1;
+
+		if( libcthreads_condition_broadcast(
+		     internal_stream->ready_condition,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to broadcast ready condition.",
+			 function );
+
+			libcthreads_mutex_release(
+			 internal_stream->mutex,
+			 NULL );
+
+			goto on_error;
+		}
+		if( libcthreads_mutex_release(
+		     internal_stream->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to release mutex.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	while( result == 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+#if defined( HAVE_DEBUG_OUTPUT )
+		if( libcnotify_verbose != 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+#endif
+		libcerror_error_free(
+		 &error );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+/* Retrieves the next chunk of a stream
+ * The chunk data remains valid until the next call to libqcow_stream_next
+ * or until the stream is freed, after which its slot is reused
+ * Returns 1 if successful, 0 if no chunks are left or -1 on error
+ */
+int libqcow_stream_next(
+     libqcow_stream_t *stream,
+     const uint8_t **chunk_data,
+     size_t *chunk_size,
+     off64_t *chunk_offset,
+     libcerror_error_t **error )
+{
+	libqcow_internal_stream_t *internal_stream = NULL;
+	libqcow_stream_slot_t *slot                = NULL;
+	static char *function                      = "libqcow_stream_next";
+
+	if( stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+	internal_stream = (libqcow_internal_stream_t *) stream;
+
+	if( chunk_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chunk data.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chunk size.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid chunk offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( internal_stream->has_failed != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid stream - stream has failed.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     internal_stream->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		return( -1 );
+	}
+	/* Release the slot of the chunk that was previously returned
+	 */
+	if( internal_stream->released_chunk_index < internal_stream->next_chunk_index )
+	{
+		slot = &( internal_stream->slots[ internal_stream->released_chunk_index % internal_stream->number_of_slots ] );
+
+		slot->is_ready = 0;
+
+		internal_stream->released_chunk_index += 1;
+
+		if( libcthreads_condition_broadcast(
+		     internal_stream->release_condition,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to broadcast release condition.",
+			 function );
+
+			libcthreads_mutex_release(
+			 internal_stream->mutex,
+			 NULL );
+
+			return( -1 );
+		}
+	}
+	slot = NULL;
+
+	if( internal_stream->next_chunk_index < internal_stream->end_chunk_index )
+	{
+		slot = &( internal_stream->slots[ internal_stream->next_chunk_index % internal_stream->number_of_slots ] );
+
+		while( slot->is_ready == 0 )
+		{
+			if( libcthreads_condition_wait(
+			     internal_stream->ready_condition,
+			     internal_stream->mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to wait for ready condition.",
+				 function );
+
+				libcthreads_mutex_release(
+				 internal_stream->mutex,
+				 NULL );
+
+				return( -1 );
+			}
+		}
+	}
+	if( libcthreads_mutex_release(
+	     internal_stream->mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release mutex.",
+		 function );
+
+		return( -1 );
+	}
+	if( slot == NULL )
+	{
+		return( 0 );
+	}
+	if( slot->error != NULL )
+	{
+		internal_stream->has_failed = 1;
+
+		/* The error of the worker that failed is passed to the caller
+		 */
+		if( ( error != NULL )
+		 && ( *error == NULL ) )
+		{
+			*error      = slot->error;
+			slot->error = NULL;
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read chunk.",
+		 function );
+
+		return( -1 );
+	}
+#else
+	if( internal_stream->next_chunk_index >= internal_stream->end_chunk_index )
+	{
+		return( 0 );
+	}
+	slot = &( internal_stream->slots[ 0 ] );
+
+	if( libqcow_internal_stream_read_chunk(
+	     internal_stream,
+	     internal_stream->file,
+	     internal_stream->next_chunk_index,
+	     slot,
+	     error ) != 1 )
+	{
+		internal_stream->has_failed = 1;
+
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read chunk.",
+		 function );
+
+		return( -1 );
+	}
+	internal_stream->released_chunk_index = internal_stream->next_chunk_index;
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	internal_stream->next_chunk_index += 1;
+
+	*chunk_data   = slot->data;
+	*chunk_size   = slot->chunk_size;
+	*chunk_offset = slot->chunk_offset;
+
+	return( 1 );
+}
+
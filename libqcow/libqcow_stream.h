@@ -0,0 +1,210 @@
+/*
+ * Stream functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_INTERNAL_STREAM_H )
+#define _LIBQCOW_INTERNAL_STREAM_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_extern.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_types.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_internal_stream libqcow_internal_stream_t;
+typedef struct libqcow_stream_slot libqcow_stream_slot_t;
+typedef struct libqcow_stream_worker libqcow_stream_worker_t;
+
+/* A slot contains a chunk that was read ahead
+ */
+struct libqcow_stream_slot
+{
+	/* The chunk data
+	 */
+	uint8_t *data;
+
+	/* The (storage media) offset of the chunk
+	 */
+	off64_t chunk_offset;
+
+	/* The size of the chunk
+	 */
+	size_t chunk_size;
+
+	/* Value to indicate the chunk has been read
+	 */
+	uint8_t is_ready;
+
+	/* The error if the chunk could not be read
+	 */
+	libcerror_error_t *error;
+};
+
+/* A worker reads chunks using its own reader of the file
+ */
+struct libqcow_stream_worker
+{
+	/* The stream
+	 */
+	libqcow_internal_stream_t *stream;
+
+	/* The reader
+	 */
+	libqcow_file_t *reader;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The thread
+	 */
+	libcthreads_thread_t *thread;
+#endif
+};
+
+/* The chunks are read ahead by the workers into a ring of slots, where
+ * chunk index modulo the number of slots determines the slot. A worker only
+ * takes a chunk if its slot was released by the consumer, which bounds the
+ * memory used and blocks the workers when the consumer falls behind
+ */
+struct libqcow_internal_stream
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The (storage media) offset
+	 */
+	off64_t offset;
+
+	/* The (storage media) end offset
+	 */
+	off64_t end_offset;
+
+	/* The chunk size
+	 */
+	size_t chunk_size;
+
+	/* The index of the chunk directly after the last chunk, chunks are aligned to the chunk size
+	 */
+	uint64_t end_chunk_index;
+
+	/* The slots
+	 */
+	libqcow_stream_slot_t *slots;
+
+	/* The number of slots
+	 */
+	int number_of_slots;
+
+	/* The workers
+	 */
+	libqcow_stream_worker_t *workers;
+
+	/* The number of workers
+	 */
+	int number_of_workers;
+
+	/* The index of the next chunk to read
+	 */
+	uint64_t next_read_chunk_index;
+
+	/* The index of the next chunk to return
+	 */
+	uint64_t next_chunk_index;
+
+	/* The index of the first chunk that has not been released by the consumer
+	 */
+	uint64_t released_chunk_index;
+
+	/* Value to indicate the workers should stop
+	 */
+	int abort;
+
+	/* Value to indicate a chunk could not be read
+	 */
+	int has_failed;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+	/* The mutex
+	 */
+	libcthreads_mutex_t *mutex;
+
+	/* The condition that is signalled when a chunk has been read
+	 */
+	libcthreads_condition_t *ready_condition;
+
+	/* The condition that is signalled when a slot has been released
+	 */
+	libcthreads_condition_t *release_condition;
+#endif
+};
+
+LIBQCOW_EXTERN \
+int libqcow_stream_open(
+     libqcow_file_t *file,
+     off64_t offset,
+     size64_t size,
+     size_t chunk_size,
+     int number_of_threads,
+     int maximum_number_of_chunks,
+     libqcow_stream_t **stream,
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_stream_free(
+     libqcow_stream_t **stream,
+     libcerror_error_t **error );
+
+int libqcow_internal_stream_stop(
+     libqcow_internal_stream_t *internal_stream,
+     libcerror_error_t **error );
+
+int libqcow_internal_stream_read_chunk(
+     libqcow_internal_stream_t *internal_stream,
+     libqcow_file_t *reader,
+     uint64_t chunk_index,
+     libqcow_stream_slot_t *slot,
+     libcerror_error_t **error );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_stream_thread_function(
+     void *arguments );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+LIBQCOW_EXTERN \
+int libqcow_stream_next(
+     libqcow_stream_t *stream,
+     const uint8_t **chunk_data,
+     size_t *chunk_size,
+     off64_t *chunk_offset,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_INTERNAL_STREAM_H ) */
+
@@ -25,12 +25,18 @@
 #include <types.h>
 #include <wide_string.h>
 
+#include "libqcow_compression.h"
 #include "libqcow_definitions.h"
+#include "libqcow_digest_index.h"
+#include "libqcow_hardware_aes.h"
 #include "libqcow_io_handle.h"
+#include "libqcow_key_cache.h"
 #include "libqcow_libbfio.h"
 #include "libqcow_libcerror.h"
 #include "libqcow_libclocale.h"
+#include "libqcow_statistics.h"
 #include "libqcow_support.h"
+#include "libqcow_unused.h"
 
 #if !defined( HAVE_LOCAL_LIBQCOW )
 
@@ -66,6 +72,23 @@ int libqcow_get_access_flags_write(
 	return( (int) LIBQCOW_ACCESS_FLAG_WRITE );
 }
 
+/* Returns the name of the backend used to decrypt encrypted images
+ */
+const char *libqcow_get_encryption_backend(
+             void )
+{
+	return( libqcow_hardware_aes_get_backend_name(
+	         libqcow_hardware_aes_get_backend() ) );
+}
+
+/* Returns the name of the backend used to decompress compressed images
+ */
+const char *libqcow_get_decompression_backend(
+             void )
+{
+	return( libqcow_compression_get_inflate_backend_name() );
+}
+
 /* Retrieves the narrow system string codepage
  * A value of 0 represents no codepage, UTF-8 encoding is used instead
  * Returns 1 if successful or -1 on error
@@ -118,6 +141,49 @@ int libqcow_set_codepage(
 	return( 1 );
 }
 
+/* Clears the master keys that were derived from passwords
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_clear_key_cache(
+     libcerror_error_t **error LIBQCOW_ATTRIBUTE_UNUSED )
+{
+	LIBQCOW_UNREFERENCED_PARAMETER( error )
+
+	libqcow_key_cache_clear();
+
+	return( 1 );
+}
+
+/* Retrieves the bounds of a latency histogram bucket
+ * The bounds are in nanoseconds and inclusive
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_get_latency_histogram_bucket_bounds(
+     int bucket_index,
+     uint64_t *lower_bound,
+     uint64_t *upper_bound,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_get_latency_histogram_bucket_bounds";
+
+	if( libqcow_statistics_get_latency_bucket_bounds(
+	     bucket_index,
+	     lower_bound,
+	     upper_bound,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve bucket bounds.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
 #endif /* !defined( HAVE_LOCAL_LIBQCOW ) */
 
 /* Determines if a file contains a QCOW file signature
@@ -460,3 +526,148 @@ int libqcow_check_file_signature_file_io_handle(
 	return( 0 );
 }
 
+/* Finds the offset of the first cluster block with a specific digest in a digest index (sidecar) file
+ * The digest index file is scanned without reading the image, which allows to look up
+ * duplicate cluster blocks of images that are not available
+ * Returns 1 if successful, 0 if no such cluster block was found or -1 on error
+ */
+int libqcow_find_digest_in_digest_index(
+     const char *filename,
+     const uint8_t *digest,
+     size_t digest_size,
+     off64_t *offset,
+     libcerror_error_t **error )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	static char *function            = "libqcow_find_digest_in_digest_index";
+	size_t filename_length           = 0;
+	int result                       = 0;
+
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	filename_length = narrow_string_length(
+	                   filename );
+
+	if( filename_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     filename_length,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename in file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open digest index file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	result = libqcow_digest_index_find_digest_in_file_io_handle(
+	          file_io_handle,
+	          digest,
+	          digest_size,
+	          offset,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to find digest in digest index file.",
+		 function );
+
+		libbfio_handle_close(
+		 file_io_handle,
+		 NULL );
+
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close digest index file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	return( result );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
@@ -51,6 +51,14 @@ LIBQCOW_EXTERN \
 int libqcow_get_access_flags_write(
      void );
 
+LIBQCOW_EXTERN \
+const char *libqcow_get_encryption_backend(
+             void );
+
+LIBQCOW_EXTERN \
+const char *libqcow_get_decompression_backend(
+             void );
+
 LIBQCOW_EXTERN \
 int libqcow_get_codepage(
      int *codepage,
@@ -61,6 +69,17 @@ int libqcow_set_codepage(
      int codepage,
      libcerror_error_t **error );
 
+LIBQCOW_EXTERN \
+int libqcow_clear_key_cache(
+     libcerror_error_t **error );
+
+LIBQCOW_EXTERN \
+int libqcow_get_latency_histogram_bucket_bounds(
+     int bucket_index,
+     uint64_t *lower_bound,
+     uint64_t *upper_bound,
+     libcerror_error_t **error );
+
 #endif /* !defined( HAVE_LOCAL_LIBQCOW ) */
 
 LIBQCOW_EXTERN \
@@ -82,6 +101,14 @@ int libqcow_check_file_signature_file_io_handle(
      libbfio_handle_t *file_io_handle,
      libcerror_error_t **error );
 
+LIBQCOW_EXTERN \
+int libqcow_find_digest_in_digest_index(
+     const char *filename,
+     const uint8_t *digest,
+     size_t digest_size,
+     off64_t *offset,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
@@ -0,0 +1,252 @@
+/*
+ * Trace functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_definitions.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_statistics.h"
+#include "libqcow_trace.h"
+#include "libqcow_unused.h"
+
+#if defined( HAVE_SYS_SDT_H )
+
+/* The semaphores are placed in the .probes section where tracers expect them
+ */
+#define LIBQCOW_TRACE_SEMAPHORE( probe ) \
+	unsigned short libqcow_ ## probe ## _semaphore __attribute__(( section( ".probes" ) )) = 0
+
+LIBQCOW_TRACE_SEMAPHORE( level2_table_miss );
+LIBQCOW_TRACE_SEMAPHORE( cluster_block_miss );
+LIBQCOW_TRACE_SEMAPHORE( decompress );
+LIBQCOW_TRACE_SEMAPHORE( decrypt );
+LIBQCOW_TRACE_SEMAPHORE( host_read_issued );
+LIBQCOW_TRACE_SEMAPHORE( host_read_completed );
+LIBQCOW_TRACE_SEMAPHORE( lock_wait );
+
+#endif /* defined( HAVE_SYS_SDT_H ) */
+
+/* Value to indicate the trace callback function is set
+ */
+int libqcow_trace_callback_is_set = 0;
+
+/* The trace callback function
+ */
+static void (*libqcow_trace_callback)(
+             int event,
+             uint64_t offset,
+             uint64_t size,
+             uint64_t duration,
+             void *user_data ) = NULL;
+
+/* The trace callback user data
+ */
+static void *libqcow_trace_user_data = NULL;
+
+/* Sets the trace callback function
+ * The callback function is called for every trace event, from the thread that traced it,
+ * where NULL removes the callback function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_trace_set_callback(
+     void (*callback)(
+            int event,
+            uint64_t offset,
+            uint64_t size,
+            uint64_t duration,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error LIBQCOW_ATTRIBUTE_UNUSED )
+{
+	LIBQCOW_UNREFERENCED_PARAMETER( error )
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+	__atomic_store_n(
+	 &libqcow_trace_callback_is_set,
+	 0,
+	 __ATOMIC_RELEASE );
+
+	__atomic_store_n(
+	 &libqcow_trace_user_data,
+	 user_data,
+	 __ATOMIC_RELEASE );
+
+	__atomic_store_n(
+	 &libqcow_trace_callback,
+	 callback,
+	 __ATOMIC_RELEASE );
+
+	__atomic_store_n(
+	 &libqcow_trace_callback_is_set,
+	 (int) ( callback != NULL ),
+	 __ATOMIC_RELEASE );
+#else
+	libqcow_trace_callback_is_set = 0;
+	libqcow_trace_user_data       = user_data;
+	libqcow_trace_callback        = callback;
+	libqcow_trace_callback_is_set = (int) ( callback != NULL );
+#endif
+	return( 1 );
+}
+
+/* Calls the trace callback function, if set, for a trace event
+ */
+void libqcow_trace_event(
+      int event,
+      uint64_t offset,
+      uint64_t size,
+      uint64_t duration )
+{
+	void (*callback)(
+	       int event,
+	       uint64_t offset,
+	       uint64_t size,
+	       uint64_t duration,
+	       void *user_data ) = NULL;
+
+	void *user_data = NULL;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+	callback  = __atomic_load_n( &libqcow_trace_callback, __ATOMIC_ACQUIRE );
+	user_data = __atomic_load_n( &libqcow_trace_user_data, __ATOMIC_ACQUIRE );
+#else
+	callback  = libqcow_trace_callback;
+	user_data = libqcow_trace_user_data;
+#endif
+	if( callback != NULL )
+	{
+		callback(
+		 event,
+		 offset,
+		 size,
+		 duration,
+		 user_data );
+	}
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Grabs a read/write lock for reading and traces the time spent waiting for it
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_trace_read_write_lock_grab_for_read(
+     libcthreads_read_write_lock_t *read_write_lock,
+     libcerror_error_t **error )
+{
+	uint64_t start_timestamp = 0;
+	int result               = 0;
+
+	if( !LIBQCOW_TRACE_IS_ENABLED( lock_wait ) )
+	{
+		return( libcthreads_read_write_lock_grab_for_read(
+		         read_write_lock,
+		         error ) );
+	}
+	start_timestamp = libqcow_statistics_get_timestamp();
+
+	result = libcthreads_read_write_lock_grab_for_read(
+	          read_write_lock,
+	          error );
+
+	if( result == 1 )
+	{
+		LIBQCOW_TRACE(
+		 lock_wait,
+		 LIBQCOW_TRACE_EVENT_LOCK_WAIT,
+		 (intptr_t) read_write_lock,
+		 0,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	return( result );
+}
+
+/* Grabs a read/write lock for writing and traces the time spent waiting for it
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_trace_read_write_lock_grab_for_write(
+     libcthreads_read_write_lock_t *read_write_lock,
+     libcerror_error_t **error )
+{
+	uint64_t start_timestamp = 0;
+	int result               = 0;
+
+	if( !LIBQCOW_TRACE_IS_ENABLED( lock_wait ) )
+	{
+		return( libcthreads_read_write_lock_grab_for_write(
+		         read_write_lock,
+		         error ) );
+	}
+	start_timestamp = libqcow_statistics_get_timestamp();
+
+	result = libcthreads_read_write_lock_grab_for_write(
+	          read_write_lock,
+	          error );
+
+	if( result == 1 )
+	{
+		LIBQCOW_TRACE(
+		 lock_wait,
+		 LIBQCOW_TRACE_EVENT_LOCK_WAIT,
+		 (intptr_t) read_write_lock,
+		 0,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	return( result );
+}
+
+/* Grabs a mutex and traces the time spent waiting for it
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_trace_mutex_grab(
+     libcthreads_mutex_t *mutex,
+     libcerror_error_t **error )
+{
+	uint64_t start_timestamp = 0;
+	int result               = 0;
+
+	if( !LIBQCOW_TRACE_IS_ENABLED( lock_wait ) )
+	{
+		return( libcthreads_mutex_grab(
+		         mutex,
+		         error ) );
+	}
+	start_timestamp = libqcow_statistics_get_timestamp();
+
+	result = libcthreads_mutex_grab(
+	          mutex,
+	          error );
+
+	if( result == 1 )
+	{
+		LIBQCOW_TRACE(
+		 lock_wait,
+		 LIBQCOW_TRACE_EVENT_LOCK_WAIT,
+		 (intptr_t) mutex,
+		 0,
+		 libqcow_statistics_get_timestamp() - start_timestamp );
+	}
+	return( result );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
@@ -0,0 +1,134 @@
+/*
+ * Trace functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_TRACE_H )
+#define _LIBQCOW_TRACE_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( HAVE_SYS_SDT_H )
+#define _SDT_HAS_SEMAPHORES	1
+
+#include <sys/sdt.h>
+#endif
+
+#include "libqcow_extern.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The trace points are USDT probes of provider libqcow when sys/sdt.h is available
+ * and calls of the trace callback function when it is set. Each probe has a semaphore
+ * that a tracer increments when it attaches, so a trace point that is not traced only
+ * costs a test of the semaphore and the callback flag
+ */
+#if defined( HAVE_SYS_SDT_H )
+extern unsigned short libqcow_level2_table_miss_semaphore;
+extern unsigned short libqcow_cluster_block_miss_semaphore;
+extern unsigned short libqcow_decompress_semaphore;
+extern unsigned short libqcow_decrypt_semaphore;
+extern unsigned short libqcow_host_read_issued_semaphore;
+extern unsigned short libqcow_host_read_completed_semaphore;
+extern unsigned short libqcow_lock_wait_semaphore;
+
+#define LIBQCOW_TRACE_PROBE_IS_ENABLED( probe ) \
+	( libqcow_ ## probe ## _semaphore != 0 )
+
+#define LIBQCOW_TRACE_PROBE( probe, offset, size, duration ) \
+	DTRACE_PROBE3( libqcow, probe, offset, size, duration )
+
+#else
+#define LIBQCOW_TRACE_PROBE_IS_ENABLED( probe ) \
+	0
+
+#define LIBQCOW_TRACE_PROBE( probe, offset, size, duration )
+
+#endif /* defined( HAVE_SYS_SDT_H ) */
+
+extern int libqcow_trace_callback_is_set;
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+#define LIBQCOW_TRACE_CALLBACK_IS_SET() \
+	( __atomic_load_n( &libqcow_trace_callback_is_set, __ATOMIC_RELAXED ) != 0 )
+
+#else
+#define LIBQCOW_TRACE_CALLBACK_IS_SET() \
+	( libqcow_trace_callback_is_set != 0 )
+
+#endif
+
+#define LIBQCOW_TRACE_IS_ENABLED( probe ) \
+	( LIBQCOW_TRACE_PROBE_IS_ENABLED( probe ) || LIBQCOW_TRACE_CALLBACK_IS_SET() )
+
+#define LIBQCOW_TRACE( probe, event, offset, size, duration ) \
+	do \
+	{ \
+		if( LIBQCOW_TRACE_IS_ENABLED( probe ) ) \
+		{ \
+			LIBQCOW_TRACE_PROBE( probe, (uint64_t) ( offset ), (uint64_t) ( size ), (uint64_t) ( duration ) ); \
+			libqcow_trace_event( event, (uint64_t) ( offset ), (uint64_t) ( size ), (uint64_t) ( duration ) ); \
+		} \
+	} \
+	while( 0 )
+
+LIBQCOW_EXTERN \
+int libqcow_trace_set_callback(
+     void (*callback)(
+            int event,
+            uint64_t offset,
+            uint64_t size,
+            uint64_t duration,
+            void *user_data ),
+     void *user_data,
+     libcerror_error_t **error );
+
+void libqcow_trace_event(
+      int event,
+      uint64_t offset,
+      uint64_t size,
+      uint64_t duration );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+int libqcow_trace_read_write_lock_grab_for_read(
+     libcthreads_read_write_lock_t *read_write_lock,
+     libcerror_error_t **error );
+
+int libqcow_trace_read_write_lock_grab_for_write(
+     libcthreads_read_write_lock_t *read_write_lock,
+     libcerror_error_t **error );
+
+int libqcow_trace_mutex_grab(
+     libcthreads_mutex_t *mutex,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_TRACE_H ) */
+
@@ -0,0 +1,506 @@
+/*
+ * Translation cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( _MSC_VER )
+#include <windows.h>
+#endif
+
+#include "libqcow_libcerror.h"
+#include "libqcow_libcthreads.h"
+#include "libqcow_translation_cache.h"
+
+/* The entries are published using a sequence lock, so that the entries can be
+ * looked up without the cache mutex
+ */
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( __GNUC__ )
+#define LIBQCOW_TRANSLATION_CACHE_LOAD( value ) \
+	__atomic_load_n( &( value ), __ATOMIC_RELAXED )
+
+#define LIBQCOW_TRANSLATION_CACHE_LOAD_ACQUIRE( value ) \
+	__atomic_load_n( &( value ), __ATOMIC_ACQUIRE )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE( value, new_value ) \
+	__atomic_store_n( &( value ), (uint64_t) ( new_value ), __ATOMIC_RELAXED )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE_RELEASE( value, new_value ) \
+	__atomic_store_n( &( value ), (uint64_t) ( new_value ), __ATOMIC_RELEASE )
+
+#define LIBQCOW_TRANSLATION_CACHE_ACQUIRE_FENCE() \
+	__atomic_thread_fence( __ATOMIC_ACQUIRE )
+
+#define LIBQCOW_TRANSLATION_CACHE_RELEASE_FENCE() \
+	__atomic_thread_fence( __ATOMIC_RELEASE )
+
+#elif defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) && defined( _MSC_VER )
+#define LIBQCOW_TRANSLATION_CACHE_LOAD( value ) \
+	(uint64_t) InterlockedCompareExchange64( (LONG64 volatile *) &( value ), 0, 0 )
+
+#define LIBQCOW_TRANSLATION_CACHE_LOAD_ACQUIRE( value ) \
+	LIBQCOW_TRANSLATION_CACHE_LOAD( value )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE( value, new_value ) \
+	InterlockedExchange64( (LONG64 volatile *) &( value ), (LONG64) ( new_value ) )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE_RELEASE( value, new_value ) \
+	LIBQCOW_TRANSLATION_CACHE_STORE( value, new_value )
+
+#define LIBQCOW_TRANSLATION_CACHE_ACQUIRE_FENCE() \
+	MemoryBarrier()
+
+#define LIBQCOW_TRANSLATION_CACHE_RELEASE_FENCE() \
+	MemoryBarrier()
+
+#else
+#define LIBQCOW_TRANSLATION_CACHE_LOAD( value ) \
+	( value )
+
+#define LIBQCOW_TRANSLATION_CACHE_LOAD_ACQUIRE( value ) \
+	( value )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE( value, new_value ) \
+	( value ) = (uint64_t) ( new_value )
+
+#define LIBQCOW_TRANSLATION_CACHE_STORE_RELEASE( value, new_value ) \
+	( value ) = (uint64_t) ( new_value )
+
+#define LIBQCOW_TRANSLATION_CACHE_ACQUIRE_FENCE()
+
+#define LIBQCOW_TRANSLATION_CACHE_RELEASE_FENCE()
+
+#endif
+
+/* Creates a translation cache
+ * The translation cache maps a (cluster) index directly onto an entry, where
+ * the entry is determined by the lower bits of the index. The number of entries
+ * is rounded up to a power of 2
+ * Make sure the value translation_cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_translation_cache_initialize(
+     libqcow_translation_cache_t **translation_cache,
+     int number_of_entries,
+     libcerror_error_t **error )
+{
+	static char *function         = "libqcow_translation_cache_initialize";
+	size_t entries_size           = 0;
+	int rounded_number_of_entries = 1;
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *translation_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid translation cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_entries <= 0 )
+	 || ( number_of_entries > ( 1 << 30 ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of entries value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	while( rounded_number_of_entries < number_of_entries )
+	{
+		rounded_number_of_entries <<= 1;
+	}
+	entries_size = sizeof( libqcow_translation_cache_entry_t ) * (size_t) rounded_number_of_entries;
+
+	if( entries_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid entries size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	*translation_cache = memory_allocate_structure(
+	                      libqcow_translation_cache_t );
+
+	if( *translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create translation cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *translation_cache,
+	     0,
+	     sizeof( libqcow_translation_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear translation cache.",
+		 function );
+
+		memory_free(
+		 *translation_cache );
+
+		*translation_cache = NULL;
+
+		return( -1 );
+	}
+	( *translation_cache )->entries = (libqcow_translation_cache_entry_t *) memory_allocate(
+	                                                                         entries_size );
+
+	if( ( *translation_cache )->entries == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create entries.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *translation_cache )->entries,
+	     0,
+	     entries_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear entries.",
+		 function );
+
+		goto on_error;
+	}
+	( *translation_cache )->number_of_entries    = rounded_number_of_entries;
+	( *translation_cache )->entry_index_bit_mask = (uint64_t) rounded_number_of_entries - 1;
+
+	return( 1 );
+
+on_error:
+	if( *translation_cache != NULL )
+	{
+		if( ( *translation_cache )->entries != NULL )
+		{
+			memory_free(
+			 ( *translation_cache )->entries );
+		}
+		memory_free(
+		 *translation_cache );
+
+		*translation_cache = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a translation cache
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_translation_cache_free(
+     libqcow_translation_cache_t **translation_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_translation_cache_free";
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *translation_cache != NULL )
+	{
+		memory_free(
+		 ( *translation_cache )->entries );
+
+		memory_free(
+		 *translation_cache );
+
+		*translation_cache = NULL;
+	}
+	return( 1 );
+}
+
+/* Clears a translation cache
+ * The entries are cleared one by one, so that a concurrent lookup
+ * does not retrieve a partially cleared entry
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_translation_cache_clear(
+     libqcow_translation_cache_t *translation_cache,
+     libcerror_error_t **error )
+{
+	libqcow_translation_cache_entry_t *entry = NULL;
+	static char *function                    = "libqcow_translation_cache_clear";
+	uint64_t sequence                        = 0;
+	int entry_index                          = 0;
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	for( entry_index = 0;
+	     entry_index < translation_cache->number_of_entries;
+	     entry_index++ )
+	{
+		entry = &( translation_cache->entries[ entry_index ] );
+
+		if( LIBQCOW_TRANSLATION_CACHE_LOAD( entry->tag ) == 0 )
+		{
+			continue;
+		}
+		sequence = LIBQCOW_TRANSLATION_CACHE_LOAD( entry->sequence );
+
+		LIBQCOW_TRANSLATION_CACHE_STORE(
+		 entry->sequence,
+		 sequence + 1 );
+
+		LIBQCOW_TRANSLATION_CACHE_RELEASE_FENCE();
+
+		LIBQCOW_TRANSLATION_CACHE_STORE(
+		 entry->tag,
+		 0 );
+
+		LIBQCOW_TRANSLATION_CACHE_STORE(
+		 entry->cluster_block_reference,
+		 0 );
+
+		LIBQCOW_TRANSLATION_CACHE_STORE_RELEASE(
+		 entry->sequence,
+		 sequence + 2 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the translation cache and its entries in bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_translation_cache_get_memory_usage(
+     libqcow_translation_cache_t *translation_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_translation_cache_get_memory_usage";
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_translation_cache_t )
+	              + ( sizeof( libqcow_translation_cache_entry_t ) * (size_t) translation_cache->number_of_entries );
+
+	return( 1 );
+}
+
+/* Retrieves the cluster block reference of a specific (cluster) index
+ * This function can be called without holding a lock
+ * Returns 1 if successful, 0 if no such value or -1 on error
+ */
+int libqcow_translation_cache_get_reference(
+     libqcow_translation_cache_t *translation_cache,
+     uint64_t index,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error )
+{
+	libqcow_translation_cache_entry_t *entry = NULL;
+	static char *function                    = "libqcow_translation_cache_get_reference";
+	uint64_t reference                       = 0;
+	uint64_t sequence                        = 0;
+	uint64_t tag                             = 0;
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( index == (uint64_t) UINT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_block_reference == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster block reference.",
+		 function );
+
+		return( -1 );
+	}
+	entry = &( translation_cache->entries[ index & translation_cache->entry_index_bit_mask ] );
+
+	sequence = LIBQCOW_TRANSLATION_CACHE_LOAD_ACQUIRE( entry->sequence );
+
+	if( ( sequence & 1 ) != 0 )
+	{
+		return( 0 );
+	}
+	tag       = LIBQCOW_TRANSLATION_CACHE_LOAD( entry->tag );
+	reference = LIBQCOW_TRANSLATION_CACHE_LOAD( entry->cluster_block_reference );
+
+	LIBQCOW_TRANSLATION_CACHE_ACQUIRE_FENCE();
+
+	if( ( tag != ( index + 1 ) )
+	 || ( LIBQCOW_TRANSLATION_CACHE_LOAD( entry->sequence ) != sequence ) )
+	{
+		return( 0 );
+	}
+	*cluster_block_reference = reference;
+
+	return( 1 );
+}
+
+/* Sets the cluster block reference of a specific (cluster) index
+ * This replaces the reference of another index that maps onto the same entry
+ * This function is not multi-thread safe acquire the cache mutex before call
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_translation_cache_set_reference(
+     libqcow_translation_cache_t *translation_cache,
+     uint64_t index,
+     uint64_t cluster_block_reference,
+     libcerror_error_t **error )
+{
+	libqcow_translation_cache_entry_t *entry = NULL;
+	static char *function                    = "libqcow_translation_cache_set_reference";
+	uint64_t sequence                        = 0;
+
+	if( translation_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid translation cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( index == (uint64_t) UINT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	entry = &( translation_cache->entries[ index & translation_cache->entry_index_bit_mask ] );
+
+	sequence = LIBQCOW_TRANSLATION_CACHE_LOAD( entry->sequence );
+
+	LIBQCOW_TRANSLATION_CACHE_STORE(
+	 entry->sequence,
+	 sequence + 1 );
+
+	LIBQCOW_TRANSLATION_CACHE_RELEASE_FENCE();
+
+	LIBQCOW_TRANSLATION_CACHE_STORE(
+	 entry->tag,
+	 index + 1 );
+
+	LIBQCOW_TRANSLATION_CACHE_STORE(
+	 entry->cluster_block_reference,
+	 cluster_block_reference );
+
+	LIBQCOW_TRANSLATION_CACHE_STORE_RELEASE(
+	 entry->sequence,
+	 sequence + 2 );
+
+	return( 1 );
+}
+
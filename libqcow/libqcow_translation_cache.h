@@ -0,0 +1,107 @@
+/*
+ * Translation cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_TRANSLATION_CACHE_H )
+#define _LIBQCOW_TRANSLATION_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_translation_cache_entry libqcow_translation_cache_entry_t;
+
+struct libqcow_translation_cache_entry
+{
+	/* The sequence number, which is odd while the entry is being set
+	 */
+	uint64_t sequence;
+
+	/* The tag, which is the (cluster) index + 1 or 0 if the entry is not used
+	 */
+	uint64_t tag;
+
+	/* The cluster block reference
+	 */
+	uint64_t cluster_block_reference;
+};
+
+/* The entries can be looked up without holding a lock while they are set,
+ * a lookup that overlaps with setting the entry is treated as a miss.
+ * Setting and clearing the entries must be serialized by the caller
+ */
+typedef struct libqcow_translation_cache libqcow_translation_cache_t;
+
+struct libqcow_translation_cache
+{
+	/* The entries
+	 */
+	libqcow_translation_cache_entry_t *entries;
+
+	/* The number of entries, which is a power of 2
+	 */
+	int number_of_entries;
+
+	/* The bit mask to determine the entry of an index
+	 */
+	uint64_t entry_index_bit_mask;
+};
+
+int libqcow_translation_cache_initialize(
+     libqcow_translation_cache_t **translation_cache,
+     int number_of_entries,
+     libcerror_error_t **error );
+
+int libqcow_translation_cache_free(
+     libqcow_translation_cache_t **translation_cache,
+     libcerror_error_t **error );
+
+int libqcow_translation_cache_clear(
+     libqcow_translation_cache_t *translation_cache,
+     libcerror_error_t **error );
+
+int libqcow_translation_cache_get_memory_usage(
+     libqcow_translation_cache_t *translation_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+int libqcow_translation_cache_get_reference(
+     libqcow_translation_cache_t *translation_cache,
+     uint64_t index,
+     uint64_t *cluster_block_reference,
+     libcerror_error_t **error );
+
+int libqcow_translation_cache_set_reference(
+     libqcow_translation_cache_t *translation_cache,
+     uint64_t index,
+     uint64_t cluster_block_reference,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_TRANSLATION_CACHE_H ) */
+
@@ -34,10 +34,20 @@
 /* The following type definitions hide internal data structures
  */
 #if defined( HAVE_DEBUG_OUTPUT ) && !defined( WINAPI )
-typedef struct libqcow_file {}	libqcow_file_t;
+typedef struct libqcow_batch {}		libqcow_batch_t;
+typedef struct libqcow_cache {}		libqcow_cache_t;
+typedef struct libqcow_file {}		libqcow_file_t;
+typedef struct libqcow_read_request {}	libqcow_read_request_t;
+typedef struct libqcow_snapshot {}	libqcow_snapshot_t;
+typedef struct libqcow_stream {}	libqcow_stream_t;
 
 #else
+typedef intptr_t libqcow_batch_t;
+typedef intptr_t libqcow_cache_t;
 typedef intptr_t libqcow_file_t;
+typedef intptr_t libqcow_read_request_t;
+typedef intptr_t libqcow_snapshot_t;
+typedef intptr_t libqcow_stream_t;
 
 #endif /* defined( HAVE_DEBUG_OUTPUT ) && !defined( WINAPI ) */
 
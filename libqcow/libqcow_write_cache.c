@@ -0,0 +1,1919 @@
+/*
+ * Write cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "libqcow_byte_swap.h"
+#include "libqcow_definitions.h"
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+#include "libqcow_write_cache.h"
+
+/* Creates a write cache
+ * The write cache is a write-back cache of the level 2 tables and reference count
+ * blocks that are modified by writes. The modified blocks are written in an order
+ * that keeps the file consistent: reference count increments are stored before
+ * the level 2 tables that reference the clusters and reference count decrements
+ * after the level 2 tables that no longer reference the clusters
+ * Make sure the value write_cache is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_initialize(
+     libqcow_write_cache_t **write_cache,
+     size_t cluster_block_size,
+     uint32_t reference_count_order,
+     int maximum_number_of_blocks,
+     libcerror_error_t **error )
+{
+	static char *function                = "libqcow_write_cache_initialize";
+	size_t blocks_size                   = 0;
+	uint8_t number_of_cluster_block_bits = 0;
+	int block_index                      = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *write_cache != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid write cache value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( cluster_block_size < 512 )
+	 || ( cluster_block_size > (size_t) ( 1 << 30 ) )
+	 || ( ( cluster_block_size & ( cluster_block_size - 1 ) ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid cluster block size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count_order > 6 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported reference count order: %" PRIu32 ".",
+		 function,
+		 reference_count_order );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_blocks < 4 )
+	 || ( maximum_number_of_blocks > LIBQCOW_MAXIMUM_CACHE_ENTRIES_WRITE_CACHE ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of blocks value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	while( ( (size_t) 1 << number_of_cluster_block_bits ) < cluster_block_size )
+	{
+		number_of_cluster_block_bits++;
+	}
+	blocks_size = sizeof( libqcow_write_cache_block_t ) * (size_t) maximum_number_of_blocks;
+
+	*write_cache = memory_allocate_structure(
+	                libqcow_write_cache_t );
+
+	if( *write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create write cache.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *write_cache,
+	     0,
+	     sizeof( libqcow_write_cache_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear write cache.",
+		 function );
+
+		memory_free(
+		 *write_cache );
+
+		*write_cache = NULL;
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	( *write_cache )->barrier_file_handle = INVALID_HANDLE_VALUE;
+#else
+	( *write_cache )->barrier_file_descriptor = -1;
+#endif
+	( *write_cache )->blocks = (libqcow_write_cache_block_t *) memory_allocate(
+	                                                            blocks_size );
+
+	if( ( *write_cache )->blocks == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create blocks.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     ( *write_cache )->blocks,
+	     0,
+	     blocks_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear blocks.",
+		 function );
+
+		goto on_error;
+	}
+	for( block_index = 0;
+	     block_index < maximum_number_of_blocks;
+	     block_index++ )
+	{
+		( *write_cache )->blocks[ block_index ].file_offset = -1;
+	}
+	( *write_cache )->cluster_block_size                   = cluster_block_size;
+	( *write_cache )->number_of_cluster_block_bits         = number_of_cluster_block_bits;
+	( *write_cache )->number_of_reference_count_bits       = (uint8_t) ( 1 << reference_count_order );
+	( *write_cache )->number_of_reference_counts_per_block = ( (uint64_t) cluster_block_size * 8 ) >> reference_count_order;
+	( *write_cache )->maximum_number_of_blocks             = maximum_number_of_blocks;
+
+	if( reference_count_order == 6 )
+	{
+		( *write_cache )->maximum_reference_count = (uint64_t) -1;
+	}
+	else
+	{
+		( *write_cache )->maximum_reference_count = ( (uint64_t) 1 << ( 1 << reference_count_order ) ) - 1;
+	}
+	return( 1 );
+
+on_error:
+	if( *write_cache != NULL )
+	{
+		if( ( *write_cache )->blocks != NULL )
+		{
+			memory_free(
+			 ( *write_cache )->blocks );
+		}
+		memory_free(
+		 *write_cache );
+
+		*write_cache = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a write cache
+ * The modified blocks that were not written are discarded
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_free(
+     libqcow_write_cache_t **write_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_free";
+	int block_index       = 0;
+	int result            = 1;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( *write_cache != NULL )
+	{
+#if defined( WINAPI )
+		if( ( *write_cache )->barrier_file_handle != INVALID_HANDLE_VALUE )
+		{
+			if( CloseHandle(
+			     ( *write_cache )->barrier_file_handle ) == 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close barrier file.",
+				 function );
+
+				result = -1;
+			}
+		}
+#else
+		if( ( *write_cache )->barrier_file_descriptor != -1 )
+		{
+			if( close(
+			     ( *write_cache )->barrier_file_descriptor ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close barrier file.",
+				 function );
+
+				result = -1;
+			}
+		}
+#endif
+		for( block_index = 0;
+		     block_index < ( *write_cache )->maximum_number_of_blocks;
+		     block_index++ )
+		{
+			if( ( *write_cache )->blocks[ block_index ].data != NULL )
+			{
+				memory_free(
+				 ( *write_cache )->blocks[ block_index ].data );
+			}
+		}
+		memory_free(
+		 ( *write_cache )->blocks );
+
+		if( ( *write_cache )->reference_count_table != NULL )
+		{
+			memory_free(
+			 ( *write_cache )->reference_count_table );
+		}
+		if( ( *write_cache )->reference_count_table_dirty_flags != NULL )
+		{
+			memory_free(
+			 ( *write_cache )->reference_count_table_dirty_flags );
+		}
+		if( ( *write_cache )->released_cluster_indexes != NULL )
+		{
+			memory_free(
+			 ( *write_cache )->released_cluster_indexes );
+		}
+		memory_free(
+		 *write_cache );
+
+		*write_cache = NULL;
+	}
+	return( result );
+}
+
+/* Opens the file that is synchronized by a barrier
+ * Without a barrier file the modified blocks are written in order
+ * but it is left to the operating system when they are stored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_open_barrier_file(
+     libqcow_write_cache_t *write_cache,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_open_barrier_file";
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( write_cache->barrier_file_handle != INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid write cache - barrier file handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	/* FlushFileBuffers requires a handle with write access
+	 */
+	write_cache->barrier_file_handle = CreateFileA(
+	                                    (LPCSTR) filename,
+	                                    GENERIC_WRITE,
+	                                    FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                                    NULL,
+	                                    OPEN_EXISTING,
+	                                    FILE_ATTRIBUTE_NORMAL,
+	                                    NULL );
+
+	if( write_cache->barrier_file_handle == INVALID_HANDLE_VALUE )
+#else
+	if( write_cache->barrier_file_descriptor != -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid write cache - barrier file descriptor value already set.",
+		 function );
+
+		return( -1 );
+	}
+	/* fsync synchronizes the file regardless of the descriptor it is called with
+	 */
+	write_cache->barrier_file_descriptor = open(
+	                                        filename,
+	                                        O_RDONLY );
+
+	if( write_cache->barrier_file_descriptor == -1 )
+#endif
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open barrier file: %s.",
+		 function,
+		 filename );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Opens the file that is synchronized by a barrier
+ * On platforms other than Windows a barrier file is only available for narrow filenames
+ * Returns 1 if successful, 0 if a barrier file is not available or -1 on error
+ */
+int libqcow_write_cache_open_barrier_file_wide(
+     libqcow_write_cache_t *write_cache,
+     const wchar_t *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_open_barrier_file_wide";
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( write_cache->barrier_file_handle != INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid write cache - barrier file handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	write_cache->barrier_file_handle = CreateFileW(
+	                                    (LPCWSTR) filename,
+	                                    GENERIC_WRITE,
+	                                    FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                                    NULL,
+	                                    OPEN_EXISTING,
+	                                    FILE_ATTRIBUTE_NORMAL,
+	                                    NULL );
+
+	if( write_cache->barrier_file_handle == INVALID_HANDLE_VALUE )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open barrier file: %ls.",
+		 function,
+		 filename );
+
+		return( -1 );
+	}
+	return( 1 );
+#else
+	return( 0 );
+#endif
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Waits until the data written before the barrier is stored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_barrier(
+     libqcow_write_cache_t *write_cache,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_barrier";
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( WINAPI )
+	if( write_cache->barrier_file_handle == INVALID_HANDLE_VALUE )
+	{
+		return( 1 );
+	}
+	if( FlushFileBuffers(
+	     write_cache->barrier_file_handle ) == 0 )
+#else
+	if( write_cache->barrier_file_descriptor == -1 )
+	{
+		return( 1 );
+	}
+	if( fsync(
+	     write_cache->barrier_file_descriptor ) != 0 )
+#endif
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to synchronize barrier file.",
+		 function );
+
+		return( -1 );
+	}
+	write_cache->number_of_barriers += 1;
+
+	return( 1 );
+}
+
+/* Reads the reference count table
+ * The clusters are allocated after the end of the file and after
+ * the reference count blocks that are referenced by the table
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_read_reference_count_table(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     off64_t reference_count_table_offset,
+     uint32_t number_of_reference_count_table_clusters,
+     size64_t file_size,
+     libcerror_error_t **error )
+{
+	static char *function      = "libqcow_write_cache_read_reference_count_table";
+	size_t table_size          = 0;
+	ssize_t read_count         = 0;
+	uint64_t block_offset      = 0;
+	uint64_t end_cluster_index = 0;
+	uint64_t entry_index       = 0;
+	uint64_t number_of_entries = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( write_cache->reference_count_table != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid write cache - reference count table value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count_table_offset <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid reference count table offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( number_of_reference_count_table_clusters == 0 )
+	 || ( (uint64_t) number_of_reference_count_table_clusters > ( (uint64_t) ( SSIZE_MAX / 8 ) / write_cache->cluster_block_size ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of reference count table clusters value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	table_size        = (size_t) number_of_reference_count_table_clusters * write_cache->cluster_block_size;
+	number_of_entries = (uint64_t) ( table_size / 8 );
+
+	write_cache->reference_count_table = (uint64_t *) memory_allocate(
+	                                                   sizeof( uint64_t ) * (size_t) number_of_entries );
+
+	if( write_cache->reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	/* The reference count table is read directly into the table entries
+	 * and converted in place
+	 */
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              (uint8_t *) write_cache->reference_count_table,
+	              table_size,
+	              reference_count_table_offset,
+	              error );
+
+	if( read_count != (ssize_t) table_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read reference count table at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 reference_count_table_offset,
+		 reference_count_table_offset );
+
+		goto on_error;
+	}
+	if( libqcow_byte_swap_uint64_big_endian(
+	     write_cache->reference_count_table,
+	     (size_t) number_of_entries,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_CONVERSION,
+		 LIBCERROR_CONVERSION_ERROR_GENERIC,
+		 "%s: unable to convert reference count table entries.",
+		 function );
+
+		goto on_error;
+	}
+	write_cache->reference_count_table_dirty_flags = (uint8_t *) memory_allocate(
+	                                                              (size_t) number_of_entries );
+
+	if( write_cache->reference_count_table_dirty_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count table dirty flags.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     write_cache->reference_count_table_dirty_flags,
+	     0,
+	     (size_t) number_of_entries ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count table dirty flags.",
+		 function );
+
+		goto on_error;
+	}
+	end_cluster_index = (uint64_t) ( file_size >> write_cache->number_of_cluster_block_bits );
+
+	if( ( file_size & ( write_cache->cluster_block_size - 1 ) ) != 0 )
+	{
+		end_cluster_index += 1;
+	}
+	for( entry_index = 0;
+	     entry_index < number_of_entries;
+	     entry_index++ )
+	{
+		/* The lower bits of a reference count table entry are reserved
+		 */
+		block_offset = write_cache->reference_count_table[ entry_index ] & ~( (uint64_t) write_cache->cluster_block_size - 1 );
+
+		write_cache->reference_count_table[ entry_index ] = block_offset;
+
+		if( ( block_offset != 0 )
+		 && ( ( block_offset >> write_cache->number_of_cluster_block_bits ) >= end_cluster_index ) )
+		{
+			end_cluster_index = ( block_offset >> write_cache->number_of_cluster_block_bits ) + 1;
+		}
+	}
+	write_cache->reference_count_table_offset            = reference_count_table_offset;
+	write_cache->number_of_reference_count_table_entries = number_of_entries;
+	write_cache->next_cluster_index                      = end_cluster_index;
+	write_cache->reserved_end_cluster_index              = end_cluster_index;
+
+	return( 1 );
+
+on_error:
+	if( write_cache->reference_count_table_dirty_flags != NULL )
+	{
+		memory_free(
+		 write_cache->reference_count_table_dirty_flags );
+
+		write_cache->reference_count_table_dirty_flags = NULL;
+	}
+	if( write_cache->reference_count_table != NULL )
+	{
+		memory_free(
+		 write_cache->reference_count_table );
+
+		write_cache->reference_count_table = NULL;
+	}
+	return( -1 );
+}
+
+/* Writes a block
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_write_block(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     libqcow_write_cache_block_t *block,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_write_block";
+	ssize_t write_count   = 0;
+
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               block->data,
+	               write_cache->cluster_block_size,
+	               block->file_offset,
+	               error );
+
+	if( write_count != (ssize_t) write_cache->cluster_block_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write block at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 block->file_offset,
+		 block->file_offset );
+
+		return( -1 );
+	}
+	block->is_dirty = 0;
+
+	return( 1 );
+}
+
+/* Retrieves a block
+ * A block that is not cached replaces the least recently used block that is not modified,
+ * if all blocks are modified they are written first. The block data is read when
+ * read data is set otherwise the block data is cleared, which is used for new blocks
+ * The block remains valid until the next call to a write cache function
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_get_block(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint8_t block_type,
+     off64_t file_offset,
+     uint8_t read_data,
+     libqcow_write_cache_block_t **block,
+     libcerror_error_t **error )
+{
+	libqcow_write_cache_block_t *cached_block              = NULL;
+	libqcow_write_cache_block_t *least_recently_used_block = NULL;
+	static char *function                                  = "libqcow_write_cache_get_block";
+	ssize_t read_count                                     = 0;
+	int block_index                                        = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( block_type != LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE )
+	 && ( block_type != LIBQCOW_WRITE_CACHE_BLOCK_TYPE_REFERENCE_COUNT_BLOCK ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported block type: %" PRIu8 ".",
+		 function,
+		 block_type );
+
+		return( -1 );
+	}
+	if( ( file_offset <= 0 )
+	 || ( ( (uint64_t) file_offset & ( write_cache->cluster_block_size - 1 ) ) != 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file offset value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( block == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid block.",
+		 function );
+
+		return( -1 );
+	}
+	write_cache->access_counter += 1;
+
+	for( block_index = 0;
+	     block_index < write_cache->maximum_number_of_blocks;
+	     block_index++ )
+	{
+		cached_block = &( write_cache->blocks[ block_index ] );
+
+		if( cached_block->file_offset == file_offset )
+		{
+			if( cached_block->block_type != block_type )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+				 "%s: invalid block at offset: %" PRIi64 " (0x%08" PRIx64 ") - block type mismatch.",
+				 function,
+				 file_offset,
+				 file_offset );
+
+				return( -1 );
+			}
+			cached_block->last_access = write_cache->access_counter;
+
+			*block = cached_block;
+
+			return( 1 );
+		}
+		if( cached_block->is_dirty == 0 )
+		{
+			if( ( least_recently_used_block == NULL )
+			 || ( cached_block->last_access < least_recently_used_block->last_access ) )
+			{
+				least_recently_used_block = cached_block;
+			}
+		}
+	}
+	if( least_recently_used_block == NULL )
+	{
+		if( libqcow_write_cache_write_dirty_blocks(
+		     write_cache,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write dirty blocks.",
+			 function );
+
+			return( -1 );
+		}
+		for( block_index = 0;
+		     block_index < write_cache->maximum_number_of_blocks;
+		     block_index++ )
+		{
+			cached_block = &( write_cache->blocks[ block_index ] );
+
+			if( ( least_recently_used_block == NULL )
+			 || ( cached_block->last_access < least_recently_used_block->last_access ) )
+			{
+				least_recently_used_block = cached_block;
+			}
+		}
+	}
+	if( least_recently_used_block->data == NULL )
+	{
+		least_recently_used_block->data = (uint8_t *) memory_allocate(
+		                                               write_cache->cluster_block_size );
+
+		if( least_recently_used_block->data == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create block data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	least_recently_used_block->file_offset = -1;
+
+	if( read_data != 0 )
+	{
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              file_io_handle,
+		              least_recently_used_block->data,
+		              write_cache->cluster_block_size,
+		              file_offset,
+		              error );
+
+		if( read_count != (ssize_t) write_cache->cluster_block_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read block at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 file_offset,
+			 file_offset );
+
+			return( -1 );
+		}
+	}
+	else if( memory_set(
+	          least_recently_used_block->data,
+	          0,
+	          write_cache->cluster_block_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear block data.",
+		 function );
+
+		return( -1 );
+	}
+	least_recently_used_block->file_offset = file_offset;
+	least_recently_used_block->block_type  = block_type;
+	least_recently_used_block->is_dirty    = 0;
+	least_recently_used_block->last_access = write_cache->access_counter;
+
+	*block = least_recently_used_block;
+
+	return( 1 );
+}
+
+/* Retrieves the reference count of a specific cluster
+ * The reference count of a cluster without a reference count block is 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_get_reference_count(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_index,
+     uint64_t *reference_count,
+     libcerror_error_t **error )
+{
+	libqcow_write_cache_block_t *block = NULL;
+	uint8_t *reference_count_data      = NULL;
+	static char *function              = "libqcow_write_cache_get_reference_count";
+	uint64_t block_offset              = 0;
+	uint64_t reference_count_index     = 0;
+	uint64_t table_index               = 0;
+	uint16_t value_16bit               = 0;
+	uint32_t value_32bit               = 0;
+	uint8_t bit_index                  = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( write_cache->reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid write cache - missing reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid reference count.",
+		 function );
+
+		return( -1 );
+	}
+	table_index           = cluster_index / write_cache->number_of_reference_counts_per_block;
+	reference_count_index = cluster_index % write_cache->number_of_reference_counts_per_block;
+
+	if( table_index >= write_cache->number_of_reference_count_table_entries )
+	{
+		*reference_count = 0;
+
+		return( 1 );
+	}
+	block_offset = write_cache->reference_count_table[ table_index ];
+
+	if( block_offset == 0 )
+	{
+		*reference_count = 0;
+
+		return( 1 );
+	}
+	if( libqcow_write_cache_get_block(
+	     write_cache,
+	     file_io_handle,
+	     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_REFERENCE_COUNT_BLOCK,
+	     (off64_t) block_offset,
+	     1,
+	     &block,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve reference count block: %" PRIu64 ".",
+		 function,
+		 table_index );
+
+		return( -1 );
+	}
+	/* Reference counts of less than 8 bits are stored starting with the least significant bits
+	 */
+	if( write_cache->number_of_reference_count_bits < 8 )
+	{
+		reference_count_index *= write_cache->number_of_reference_count_bits;
+		bit_index              = (uint8_t) ( reference_count_index % 8 );
+
+		*reference_count = ( block->data[ reference_count_index / 8 ] >> bit_index )
+		                 & write_cache->maximum_reference_count;
+
+		return( 1 );
+	}
+	reference_count_data = &( block->data[ reference_count_index * ( write_cache->number_of_reference_count_bits / 8 ) ] );
+
+	switch( write_cache->number_of_reference_count_bits )
+	{
+		case 8:
+			*reference_count = reference_count_data[ 0 ];
+			break;
+
+		case 16:
+			byte_stream_copy_to_uint16_big_endian(
+			 reference_count_data,
+			 value_16bit );
+
+			*reference_count = value_16bit;
+			break;
+
+		case 32:
+			byte_stream_copy_to_uint32_big_endian(
+			 reference_count_data,
+			 value_32bit );
+
+			*reference_count = value_32bit;
+			break;
+
+		default:
+			byte_stream_copy_to_uint64_big_endian(
+			 reference_count_data,
+			 *reference_count );
+			break;
+	}
+	return( 1 );
+}
+
+/* Sets the reference count of a specific cluster
+ * The cluster must have a reference count block unless the reference count is 0
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_set_reference_count(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_index,
+     uint64_t reference_count,
+     libcerror_error_t **error )
+{
+	libqcow_write_cache_block_t *block = NULL;
+	uint8_t *reference_count_data      = NULL;
+	static char *function              = "libqcow_write_cache_set_reference_count";
+	uint64_t block_offset              = 0;
+	uint64_t reference_count_index     = 0;
+	uint64_t table_index               = 0;
+	uint8_t bit_index                  = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( write_cache->reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid write cache - missing reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( reference_count > write_cache->maximum_reference_count )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid reference count value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	table_index           = cluster_index / write_cache->number_of_reference_counts_per_block;
+	reference_count_index = cluster_index % write_cache->number_of_reference_counts_per_block;
+
+	if( table_index < write_cache->number_of_reference_count_table_entries )
+	{
+		block_offset = write_cache->reference_count_table[ table_index ];
+	}
+	if( block_offset == 0 )
+	{
+		if( reference_count == 0 )
+		{
+			return( 1 );
+		}
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: missing reference count block: %" PRIu64 ".",
+		 function,
+		 table_index );
+
+		return( -1 );
+	}
+	if( libqcow_write_cache_get_block(
+	     write_cache,
+	     file_io_handle,
+	     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_REFERENCE_COUNT_BLOCK,
+	     (off64_t) block_offset,
+	     1,
+	     &block,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve reference count block: %" PRIu64 ".",
+		 function,
+		 table_index );
+
+		return( -1 );
+	}
+	if( write_cache->number_of_reference_count_bits < 8 )
+	{
+		reference_count_index *= write_cache->number_of_reference_count_bits;
+		bit_index              = (uint8_t) ( reference_count_index % 8 );
+		reference_count_data   = &( block->data[ reference_count_index / 8 ] );
+
+		*reference_count_data &= (uint8_t) ~( write_cache->maximum_reference_count << bit_index );
+		*reference_count_data |= (uint8_t) ( reference_count << bit_index );
+	}
+	else
+	{
+		reference_count_data = &( block->data[ reference_count_index * ( write_cache->number_of_reference_count_bits / 8 ) ] );
+
+		switch( write_cache->number_of_reference_count_bits )
+		{
+			case 8:
+				reference_count_data[ 0 ] = (uint8_t) reference_count;
+				break;
+
+			case 16:
+				byte_stream_copy_from_uint16_big_endian(
+				 reference_count_data,
+				 (uint16_t) reference_count );
+				break;
+
+			case 32:
+				byte_stream_copy_from_uint32_big_endian(
+				 reference_count_data,
+				 (uint32_t) reference_count );
+				break;
+
+			default:
+				byte_stream_copy_from_uint64_big_endian(
+				 reference_count_data,
+				 reference_count );
+				break;
+		}
+	}
+	block->is_dirty = 1;
+
+	return( 1 );
+}
+
+/* Reserves clusters after the last reserved cluster
+ * The reference counts of the reserved clusters are set to 1 and stored at once,
+ * so that allocating a cluster does not require a reference count update.
+ * A reference count block that is needed is placed in the first cluster it describes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_reserve_clusters(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     int number_of_clusters,
+     libcerror_error_t **error )
+{
+	libqcow_write_cache_block_t *block = NULL;
+	static char *function              = "libqcow_write_cache_reserve_clusters";
+	uint64_t cluster_index             = 0;
+	uint64_t table_index               = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( write_cache->reference_count_table == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid write cache - missing reference count table.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_clusters <= 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid number of clusters value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	cluster_index = write_cache->reserved_end_cluster_index;
+
+	while( number_of_clusters > 0 )
+	{
+		table_index = cluster_index / write_cache->number_of_reference_counts_per_block;
+
+		if( table_index >= write_cache->number_of_reference_count_table_entries )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported reference count table - no entry available for cluster: %" PRIu64 ".",
+			 function,
+			 cluster_index );
+
+			return( -1 );
+		}
+		if( write_cache->reference_count_table[ table_index ] == 0 )
+		{
+			if( libqcow_write_cache_get_block(
+			     write_cache,
+			     file_io_handle,
+			     LIBQCOW_WRITE_CACHE_BLOCK_TYPE_REFERENCE_COUNT_BLOCK,
+			     (off64_t) ( cluster_index << write_cache->number_of_cluster_block_bits ),
+			     0,
+			     &block,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to create reference count block: %" PRIu64 ".",
+				 function,
+				 table_index );
+
+				return( -1 );
+			}
+			block->is_dirty = 1;
+
+			write_cache->reference_count_table[ table_index ]             = cluster_index << write_cache->number_of_cluster_block_bits;
+			write_cache->reference_count_table_dirty_flags[ table_index ] = 1;
+
+			write_cache->number_of_dirty_reference_count_table_entries += 1;
+		}
+		if( libqcow_write_cache_set_reference_count(
+		     write_cache,
+		     file_io_handle,
+		     cluster_index,
+		     1,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set reference count of cluster: %" PRIu64 ".",
+			 function,
+			 cluster_index );
+
+			return( -1 );
+		}
+		/* The cluster that contains the reference count block cannot be allocated
+		 */
+		if( write_cache->reference_count_table[ table_index ] != ( cluster_index << write_cache->number_of_cluster_block_bits ) )
+		{
+			number_of_clusters--;
+		}
+		cluster_index++;
+
+		write_cache->reserved_end_cluster_index = cluster_index;
+	}
+	if( libqcow_write_cache_write_dirty_blocks(
+	     write_cache,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write dirty blocks.",
+		 function );
+
+		return( -1 );
+	}
+	/* The reference counts are stored before any of the reserved clusters is referenced
+	 */
+	if( libqcow_write_cache_barrier(
+	     write_cache,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write barrier.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Allocates a cluster
+ * Clusters are reserved in batches when no reserved cluster is left
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_allocate_cluster(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     off64_t *cluster_offset,
+     libcerror_error_t **error )
+{
+	static char *function  = "libqcow_write_cache_allocate_cluster";
+	uint64_t cluster_index = 0;
+	uint64_t table_index   = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( cluster_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid cluster offset.",
+		 function );
+
+		return( -1 );
+	}
+	do
+	{
+		if( write_cache->next_cluster_index >= write_cache->reserved_end_cluster_index )
+		{
+			if( libqcow_write_cache_reserve_clusters(
+			     write_cache,
+			     file_io_handle,
+			     LIBQCOW_WRITE_CACHE_NUMBER_OF_RESERVED_CLUSTERS,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to reserve clusters.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		cluster_index = write_cache->next_cluster_index;
+		table_index   = cluster_index / write_cache->number_of_reference_counts_per_block;
+
+		write_cache->next_cluster_index += 1;
+	}
+	while( write_cache->reference_count_table[ table_index ] == ( cluster_index << write_cache->number_of_cluster_block_bits ) );
+
+	*cluster_offset = (off64_t) ( cluster_index << write_cache->number_of_cluster_block_bits );
+
+	return( 1 );
+}
+
+/* Releases a cluster
+ * The reference count is decremented by a flush after the level 2 tables are stored
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_release_cluster(
+     libqcow_write_cache_t *write_cache,
+     uint64_t cluster_index,
+     libcerror_error_t **error )
+{
+	uint64_t *released_cluster_indexes = NULL;
+	static char *function              = "libqcow_write_cache_release_cluster";
+	size_t maximum_number_of_clusters  = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( write_cache->number_of_released_clusters >= write_cache->maximum_number_of_released_clusters )
+	{
+		maximum_number_of_clusters = write_cache->maximum_number_of_released_clusters * 2;
+
+		if( maximum_number_of_clusters == 0 )
+		{
+			maximum_number_of_clusters = LIBQCOW_WRITE_CACHE_NUMBER_OF_RESERVED_CLUSTERS;
+		}
+		if( maximum_number_of_clusters > ( (size_t) SSIZE_MAX / sizeof( uint64_t ) ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid maximum number of released clusters value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		released_cluster_indexes = (uint64_t *) memory_reallocate(
+		                                         write_cache->released_cluster_indexes,
+		                                         sizeof( uint64_t ) * maximum_number_of_clusters );
+
+		if( released_cluster_indexes == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to resize released cluster indexes.",
+			 function );
+
+			return( -1 );
+		}
+		write_cache->released_cluster_indexes            = released_cluster_indexes;
+		write_cache->maximum_number_of_released_clusters = maximum_number_of_clusters;
+	}
+	write_cache->released_cluster_indexes[ write_cache->number_of_released_clusters ] = cluster_index;
+
+	write_cache->number_of_released_clusters += 1;
+
+	return( 1 );
+}
+
+/* Writes the modified blocks
+ * The reference count blocks and the reference count table entries are written first,
+ * followed by a barrier if modified level 2 tables are written after them
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_write_dirty_blocks(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error )
+{
+	uint8_t entry_data[ 8 ];
+
+	libqcow_write_cache_block_t *block         = NULL;
+	static char *function                      = "libqcow_write_cache_write_dirty_blocks";
+	ssize_t write_count                        = 0;
+	uint64_t table_index                       = 0;
+	int block_index                            = 0;
+	int number_of_dirty_level2_tables          = 0;
+	int number_of_dirty_reference_count_blocks = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	for( block_index = 0;
+	     block_index < write_cache->maximum_number_of_blocks;
+	     block_index++ )
+	{
+		block = &( write_cache->blocks[ block_index ] );
+
+		if( block->is_dirty == 0 )
+		{
+			continue;
+		}
+		if( block->block_type == LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE )
+		{
+			number_of_dirty_level2_tables++;
+
+			continue;
+		}
+		if( libqcow_write_cache_write_block(
+		     write_cache,
+		     file_io_handle,
+		     block,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write reference count block.",
+			 function );
+
+			return( -1 );
+		}
+		number_of_dirty_reference_count_blocks++;
+	}
+	/* A reference count table entry is written after the reference count block it references
+	 */
+	for( table_index = 0;
+	     ( write_cache->number_of_dirty_reference_count_table_entries > 0 )
+	     && ( table_index < write_cache->number_of_reference_count_table_entries );
+	     table_index++ )
+	{
+		if( write_cache->reference_count_table_dirty_flags[ table_index ] == 0 )
+		{
+			continue;
+		}
+		byte_stream_copy_from_uint64_big_endian(
+		 entry_data,
+		 write_cache->reference_count_table[ table_index ] );
+
+		write_count = libbfio_handle_write_buffer_at_offset(
+		               file_io_handle,
+		               entry_data,
+		               8,
+		               write_cache->reference_count_table_offset + (off64_t) ( table_index * 8 ),
+		               error );
+
+		if( write_count != (ssize_t) 8 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write reference count table entry: %" PRIu64 ".",
+			 function,
+			 table_index );
+
+			return( -1 );
+		}
+		write_cache->reference_count_table_dirty_flags[ table_index ] = 0;
+
+		write_cache->number_of_dirty_reference_count_table_entries -= 1;
+
+		number_of_dirty_reference_count_blocks++;
+	}
+	if( number_of_dirty_level2_tables == 0 )
+	{
+		return( 1 );
+	}
+	if( number_of_dirty_reference_count_blocks > 0 )
+	{
+		if( libqcow_write_cache_barrier(
+		     write_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write barrier.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	for( block_index = 0;
+	     block_index < write_cache->maximum_number_of_blocks;
+	     block_index++ )
+	{
+		block = &( write_cache->blocks[ block_index ] );
+
+		if( ( block->is_dirty == 0 )
+		 || ( block->block_type != LIBQCOW_WRITE_CACHE_BLOCK_TYPE_LEVEL2_TABLE ) )
+		{
+			continue;
+		}
+		if( libqcow_write_cache_write_block(
+		     write_cache,
+		     file_io_handle,
+		     block,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write level 2 table.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Flushes the write cache
+ * The modified blocks are written, after which the reference counts of the released
+ * clusters are decremented once the level 2 tables that referenced them are stored.
+ * When release reserved clusters is set the reserved clusters that were not allocated
+ * are released as well
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_flush(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint8_t release_reserved_clusters,
+     libcerror_error_t **error )
+{
+	static char *function    = "libqcow_write_cache_flush";
+	uint64_t cluster_index   = 0;
+	uint64_t reference_count = 0;
+	uint64_t table_index     = 0;
+	size_t released_index    = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_write_cache_write_dirty_blocks(
+	     write_cache,
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write dirty blocks.",
+		 function );
+
+		return( -1 );
+	}
+	if( release_reserved_clusters != 0 )
+	{
+		while( write_cache->next_cluster_index < write_cache->reserved_end_cluster_index )
+		{
+			cluster_index = write_cache->next_cluster_index;
+			table_index   = cluster_index / write_cache->number_of_reference_counts_per_block;
+
+			write_cache->next_cluster_index += 1;
+
+			if( write_cache->reference_count_table[ table_index ] == ( cluster_index << write_cache->number_of_cluster_block_bits ) )
+			{
+				continue;
+			}
+			if( libqcow_write_cache_release_cluster(
+			     write_cache,
+			     cluster_index,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to release reserved cluster: %" PRIu64 ".",
+				 function,
+				 cluster_index );
+
+				return( -1 );
+			}
+		}
+	}
+	if( write_cache->number_of_released_clusters > 0 )
+	{
+		/* The level 2 tables that no longer reference the released clusters
+		 * are stored before the reference counts are decremented
+		 */
+		if( libqcow_write_cache_barrier(
+		     write_cache,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write barrier.",
+			 function );
+
+			return( -1 );
+		}
+		for( released_index = 0;
+		     released_index < write_cache->number_of_released_clusters;
+		     released_index++ )
+		{
+			cluster_index = write_cache->released_cluster_indexes[ released_index ];
+
+			if( libqcow_write_cache_get_reference_count(
+			     write_cache,
+			     file_io_handle,
+			     cluster_index,
+			     &reference_count,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve reference count of cluster: %" PRIu64 ".",
+				 function,
+				 cluster_index );
+
+				return( -1 );
+			}
+			if( reference_count == 0 )
+			{
+				continue;
+			}
+			if( libqcow_write_cache_set_reference_count(
+			     write_cache,
+			     file_io_handle,
+			     cluster_index,
+			     reference_count - 1,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to set reference count of cluster: %" PRIu64 ".",
+				 function,
+				 cluster_index );
+
+				return( -1 );
+			}
+		}
+		write_cache->number_of_released_clusters = 0;
+
+		if( libqcow_write_cache_write_dirty_blocks(
+		     write_cache,
+		     file_io_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write dirty blocks.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( libqcow_write_cache_barrier(
+	     write_cache,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write barrier.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the memory usage
+ * The memory usage is the size of the write cache, its blocks, the reference count table
+ * and the released clusters in bytes
+ * Returns 1 if successful or -1 on error
+ */
+int libqcow_write_cache_get_memory_usage(
+     libqcow_write_cache_t *write_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_write_cache_get_memory_usage";
+	int block_index       = 0;
+
+	if( write_cache == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid write cache.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_usage == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid memory usage.",
+		 function );
+
+		return( -1 );
+	}
+	*memory_usage = sizeof( libqcow_write_cache_t )
+	              + ( sizeof( libqcow_write_cache_block_t ) * (size_t) write_cache->maximum_number_of_blocks )
+	              + ( sizeof( uint64_t ) * write_cache->maximum_number_of_released_clusters );
+
+	if( write_cache->reference_count_table != NULL )
+	{
+		*memory_usage += ( sizeof( uint64_t ) + sizeof( uint8_t ) ) * (size_t) write_cache->number_of_reference_count_table_entries;
+	}
+	for( block_index = 0;
+	     block_index < write_cache->maximum_number_of_blocks;
+	     block_index++ )
+	{
+		if( write_cache->blocks[ block_index ].data != NULL )
+		{
+			*memory_usage += write_cache->cluster_block_size;
+		}
+	}
+
+	return( 1 );
+}
+
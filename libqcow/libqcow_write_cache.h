@@ -0,0 +1,260 @@
+/*
+ * Write cache functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_WRITE_CACHE_H )
+#define _LIBQCOW_WRITE_CACHE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libbfio.h"
+#include "libqcow_libcerror.h"
+
+#if defined( WINAPI )
+#include <windows.h>
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct libqcow_write_cache_block libqcow_write_cache_block_t;
+
+struct libqcow_write_cache_block
+{
+	/* The file offset or -1 if the block is not used
+	 */
+	off64_t file_offset;
+
+	/* The block type
+	 */
+	uint8_t block_type;
+
+	/* The (raw) block data
+	 */
+	uint8_t *data;
+
+	/* Value to indicate the block data was modified and not yet written
+	 */
+	uint8_t is_dirty;
+
+	/* The value of the access counter when the block was last used
+	 */
+	uint64_t last_access;
+};
+
+typedef struct libqcow_write_cache libqcow_write_cache_t;
+
+struct libqcow_write_cache
+{
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The number of cluster block bits
+	 */
+	uint8_t number_of_cluster_block_bits;
+
+	/* The number of bits of a reference count
+	 */
+	uint8_t number_of_reference_count_bits;
+
+	/* The number of reference counts per reference count block
+	 */
+	uint64_t number_of_reference_counts_per_block;
+
+	/* The maximum reference count
+	 */
+	uint64_t maximum_reference_count;
+
+	/* The reference count table file offset
+	 */
+	off64_t reference_count_table_offset;
+
+	/* The reference count table entries, which are the reference count block file offsets
+	 */
+	uint64_t *reference_count_table;
+
+	/* The number of reference count table entries
+	 */
+	uint64_t number_of_reference_count_table_entries;
+
+	/* Flags per reference count table entry to indicate the entry was modified and not yet written
+	 */
+	uint8_t *reference_count_table_dirty_flags;
+
+	/* The number of modified reference count table entries
+	 */
+	uint64_t number_of_dirty_reference_count_table_entries;
+
+	/* The blocks
+	 */
+	libqcow_write_cache_block_t *blocks;
+
+	/* The maximum number of blocks
+	 */
+	int maximum_number_of_blocks;
+
+	/* The access counter
+	 */
+	uint64_t access_counter;
+
+	/* The index of the next cluster to allocate
+	 */
+	uint64_t next_cluster_index;
+
+	/* The index of the cluster after the last reserved cluster
+	 */
+	uint64_t reserved_end_cluster_index;
+
+	/* The indexes of the released clusters of which the reference counts are
+	 * decremented once the level 2 tables that no longer reference them are stored
+	 */
+	uint64_t *released_cluster_indexes;
+
+	/* The number of released clusters
+	 */
+	size_t number_of_released_clusters;
+
+	/* The maximum number of released clusters
+	 */
+	size_t maximum_number_of_released_clusters;
+
+	/* The number of barriers
+	 */
+	uint64_t number_of_barriers;
+
+#if defined( WINAPI )
+	/* The handle of the file that is flushed by a barrier
+	 */
+	HANDLE barrier_file_handle;
+#else
+	/* The descriptor of the file that is synchronized by a barrier
+	 */
+	int barrier_file_descriptor;
+#endif
+};
+
+int libqcow_write_cache_initialize(
+     libqcow_write_cache_t **write_cache,
+     size_t cluster_block_size,
+     uint32_t reference_count_order,
+     int maximum_number_of_blocks,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_free(
+     libqcow_write_cache_t **write_cache,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_open_barrier_file(
+     libqcow_write_cache_t *write_cache,
+     const char *filename,
+     libcerror_error_t **error );
+
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+int libqcow_write_cache_open_barrier_file_wide(
+     libqcow_write_cache_t *write_cache,
+     const wchar_t *filename,
+     libcerror_error_t **error );
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+int libqcow_write_cache_barrier(
+     libqcow_write_cache_t *write_cache,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_read_reference_count_table(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     off64_t reference_count_table_offset,
+     uint32_t number_of_reference_count_table_clusters,
+     size64_t file_size,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_write_block(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     libqcow_write_cache_block_t *block,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_get_block(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint8_t block_type,
+     off64_t file_offset,
+     uint8_t read_data,
+     libqcow_write_cache_block_t **block,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_get_reference_count(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_index,
+     uint64_t *reference_count,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_set_reference_count(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint64_t cluster_index,
+     uint64_t reference_count,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_reserve_clusters(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     int number_of_clusters,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_allocate_cluster(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     off64_t *cluster_offset,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_release_cluster(
+     libqcow_write_cache_t *write_cache,
+     uint64_t cluster_index,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_write_dirty_blocks(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_flush(
+     libqcow_write_cache_t *write_cache,
+     libbfio_handle_t *file_io_handle,
+     uint8_t release_reserved_clusters,
+     libcerror_error_t **error );
+
+int libqcow_write_cache_get_memory_usage(
+     libqcow_write_cache_t *write_cache,
+     size_t *memory_usage,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_WRITE_CACHE_H ) */
+
@@ -0,0 +1,402 @@
+/*
+ * Zero block detection functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+#include "libqcow_zero_block.h"
+
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 )
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <immintrin.h>
+
+#if defined( __GNUC__ ) && !defined( __SSE2__ )
+#define LIBQCOW_ZERO_BLOCK_SSE2_TARGET		__attribute__((target("sse2")))
+#else
+#define LIBQCOW_ZERO_BLOCK_SSE2_TARGET
+#endif
+
+#if defined( __GNUC__ ) && !defined( __AVX2__ )
+#define LIBQCOW_ZERO_BLOCK_AVX2_TARGET		__attribute__((target("avx2")))
+#else
+#define LIBQCOW_ZERO_BLOCK_AVX2_TARGET
+#endif
+
+#endif /* defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 ) */
+
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_NEON )
+#include <arm_neon.h>
+#endif
+
+/* The detected backend, -1 if not detected yet
+ */
+static int libqcow_zero_block_backend = -1;
+
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 )
+
+/* Determines the x86 zero block backend supported by the CPU
+ * Returns a LIBQCOW_ZERO_BLOCK_BACKEND value
+ */
+static int libqcow_zero_block_x86_get_backend(
+            void )
+{
+	unsigned int extended_features = 0;
+	unsigned int features          = 0;
+	unsigned int legacy_features   = 0;
+	uint64_t extended_state        = 0;
+
+#if defined( _MSC_VER )
+	int cpu_information[ 4 ];
+
+	__cpuid(
+	 cpu_information,
+	 0 );
+
+	if( cpu_information[ 0 ] >= 7 )
+	{
+		__cpuidex(
+		 cpu_information,
+		 7,
+		 0 );
+
+		extended_features = (unsigned int) cpu_information[ 1 ];
+	}
+	__cpuid(
+	 cpu_information,
+	 1 );
+
+	features        = (unsigned int) cpu_information[ 2 ];
+	legacy_features = (unsigned int) cpu_information[ 3 ];
+
+	/* Bit 27 of ECX indicates the operating system uses XSAVE
+	 */
+	if( ( features & ( 1 << 27 ) ) != 0 )
+	{
+		extended_state = (uint64_t) _xgetbv(
+		                             0 );
+	}
+#else
+	unsigned int eax = 0;
+	unsigned int ebx = 0;
+	unsigned int ecx = 0;
+	unsigned int edx = 0;
+
+	if( __get_cpuid(
+	     1,
+	     &eax,
+	     &ebx,
+	     &ecx,
+	     &edx ) == 0 )
+	{
+		return( LIBQCOW_ZERO_BLOCK_BACKEND_NONE );
+	}
+	features        = ecx;
+	legacy_features = edx;
+
+	if( __get_cpuid_max(
+	     0,
+	     NULL ) >= 7 )
+	{
+		__cpuid_count(
+		 7,
+		 0,
+		 eax,
+		 ebx,
+		 ecx,
+		 edx );
+
+		extended_features = ebx;
+	}
+	/* Bit 27 of ECX indicates the operating system uses XSAVE
+	 */
+	if( ( features & ( 1 << 27 ) ) != 0 )
+	{
+		__asm__ __volatile__ (
+		 "xgetbv"
+		 : "=a" ( eax ), "=d" ( edx )
+		 : "c" ( 0 ) );
+
+		extended_state = ( (uint64_t) edx << 32 ) | eax;
+	}
+#endif
+	/* Bit 5 of the extended features EBX indicates AVX2, bit 28 of ECX
+	 * indicates AVX and the operating system must save the SSE and AVX state
+	 */
+	if( ( ( extended_features & ( 1 << 5 ) ) != 0 )
+	 && ( ( features & ( 1 << 28 ) ) != 0 )
+	 && ( ( extended_state & 0x06 ) == 0x06 ) )
+	{
+		return( LIBQCOW_ZERO_BLOCK_BACKEND_AVX2 );
+	}
+	/* Bit 26 of EDX indicates SSE2
+	 */
+	if( ( legacy_features & ( 1 << 26 ) ) != 0 )
+	{
+		return( LIBQCOW_ZERO_BLOCK_BACKEND_SSE2 );
+	}
+	return( LIBQCOW_ZERO_BLOCK_BACKEND_NONE );
+}
+
+/* Determines if data contains only zero bytes using SSE2
+ * 64 bytes are checked at a time
+ * Returns the number of bytes checked that are zero
+ */
+static LIBQCOW_ZERO_BLOCK_SSE2_TARGET size_t libqcow_zero_block_sse2_get_zero_size(
+                                              const uint8_t *data,
+                                              size_t data_size )
+{
+	__m128i block;
+
+	size_t data_offset = 0;
+
+	while( ( data_offset + 64 ) <= data_size )
+	{
+		block = _mm_or_si128(
+		         _mm_or_si128(
+		          _mm_loadu_si128(
+		           (__m128i *) &( data[ data_offset ] ) ),
+		          _mm_loadu_si128(
+		           (__m128i *) &( data[ data_offset + 16 ] ) ) ),
+		         _mm_or_si128(
+		          _mm_loadu_si128(
+		           (__m128i *) &( data[ data_offset + 32 ] ) ),
+		          _mm_loadu_si128(
+		           (__m128i *) &( data[ data_offset + 48 ] ) ) ) );
+
+		if( _mm_movemask_epi8(
+		     _mm_cmpeq_epi8(
+		      block,
+		      _mm_setzero_si128() ) ) != 0xffff )
+		{
+			break;
+		}
+		data_offset += 64;
+	}
+	return( data_offset );
+}
+
+/* Determines if data contains only zero bytes using AVX2
+ * 128 bytes are checked at a time
+ * Returns the number of bytes checked that are zero
+ */
+static LIBQCOW_ZERO_BLOCK_AVX2_TARGET size_t libqcow_zero_block_avx2_get_zero_size(
+                                              const uint8_t *data,
+                                              size_t data_size )
+{
+	__m256i block;
+
+	size_t data_offset = 0;
+
+	while( ( data_offset + 128 ) <= data_size )
+	{
+		block = _mm256_or_si256(
+		         _mm256_or_si256(
+		          _mm256_loadu_si256(
+		           (__m256i *) &( data[ data_offset ] ) ),
+		          _mm256_loadu_si256(
+		           (__m256i *) &( data[ data_offset + 32 ] ) ) ),
+		         _mm256_or_si256(
+		          _mm256_loadu_si256(
+		           (__m256i *) &( data[ data_offset + 64 ] ) ),
+		          _mm256_loadu_si256(
+		           (__m256i *) &( data[ data_offset + 96 ] ) ) ) );
+
+		if( _mm256_testz_si256(
+		     block,
+		     block ) == 0 )
+		{
+			break;
+		}
+		data_offset += 128;
+	}
+	return( data_offset );
+}
+
+#endif /* defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 ) */
+
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_NEON )
+
+/* Determines if data contains only zero bytes using NEON
+ * 64 bytes are checked at a time
+ * Returns the number of bytes checked that are zero
+ */
+static size_t libqcow_zero_block_neon_get_zero_size(
+               const uint8_t *data,
+               size_t data_size )
+{
+	uint8x16_t block;
+
+	size_t data_offset = 0;
+
+	while( ( data_offset + 64 ) <= data_size )
+	{
+		block = vorrq_u8(
+		         vorrq_u8(
+		          vld1q_u8(
+		           &( data[ data_offset ] ) ),
+		          vld1q_u8(
+		           &( data[ data_offset + 16 ] ) ) ),
+		         vorrq_u8(
+		          vld1q_u8(
+		           &( data[ data_offset + 32 ] ) ),
+		          vld1q_u8(
+		           &( data[ data_offset + 48 ] ) ) ) );
+
+		if( vmaxvq_u8(
+		     block ) != 0 )
+		{
+			break;
+		}
+		data_offset += 64;
+	}
+	return( data_offset );
+}
+
+#endif /* defined( HAVE_LIBQCOW_ZERO_BLOCK_NEON ) */
+
+/* Retrieves the zero block backend supported by the CPU
+ * Returns a LIBQCOW_ZERO_BLOCK_BACKEND value
+ */
+int libqcow_zero_block_get_backend(
+     void )
+{
+	int backend = libqcow_zero_block_backend;
+
+	/* Detecting the backend more than once yields the same result
+	 * hence it does not need to be protected against concurrent access
+	 */
+	if( backend == -1 )
+	{
+		backend = LIBQCOW_ZERO_BLOCK_BACKEND_NONE;
+
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 )
+		backend = libqcow_zero_block_x86_get_backend();
+#endif
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_NEON )
+		backend = LIBQCOW_ZERO_BLOCK_BACKEND_NEON;
+#endif
+		libqcow_zero_block_backend = backend;
+	}
+	return( backend );
+}
+
+/* Determines if data contains only zero bytes
+ * Data that is not zero typically differs from zero in the first bytes,
+ * hence these are checked before the vectorized check of the remainder
+ * Returns 1 if the data is zero, 0 if not or -1 on error
+ */
+int libqcow_zero_block_is_zero(
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "libqcow_zero_block_is_zero";
+	size_t data_offset    = 0;
+	size_t zero_size      = 0;
+
+	if( data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid data.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > (size_t) SSIZE_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid data size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	while( ( data_offset < data_size )
+	    && ( data_offset < 16 ) )
+	{
+		if( data[ data_offset ] != 0 )
+		{
+			return( 0 );
+		}
+		data_offset++;
+	}
+	switch( libqcow_zero_block_get_backend() )
+	{
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_X86 )
+		case LIBQCOW_ZERO_BLOCK_BACKEND_AVX2:
+			zero_size = libqcow_zero_block_avx2_get_zero_size(
+			             &( data[ data_offset ] ),
+			             data_size - data_offset );
+			break;
+
+		case LIBQCOW_ZERO_BLOCK_BACKEND_SSE2:
+			zero_size = libqcow_zero_block_sse2_get_zero_size(
+			             &( data[ data_offset ] ),
+			             data_size - data_offset );
+			break;
+#endif
+#if defined( HAVE_LIBQCOW_ZERO_BLOCK_NEON )
+		case LIBQCOW_ZERO_BLOCK_BACKEND_NEON:
+			zero_size = libqcow_zero_block_neon_get_zero_size(
+			             &( data[ data_offset ] ),
+			             data_size - data_offset );
+			break;
+#endif
+		default:
+			break;
+	}
+	data_offset += zero_size;
+
+	/* The remaining bytes are checked 8 bytes at a time where possible
+	 */
+	while( ( data_offset + 8 ) <= data_size )
+	{
+		if( ( data[ data_offset ] | data[ data_offset + 1 ]
+		    | data[ data_offset + 2 ] | data[ data_offset + 3 ]
+		    | data[ data_offset + 4 ] | data[ data_offset + 5 ]
+		    | data[ data_offset + 6 ] | data[ data_offset + 7 ] ) != 0 )
+		{
+			return( 0 );
+		}
+		data_offset += 8;
+	}
+	while( data_offset < data_size )
+	{
+		if( data[ data_offset ] != 0 )
+		{
+			return( 0 );
+		}
+		data_offset++;
+	}
+	return( 1 );
+}
+
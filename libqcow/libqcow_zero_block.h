@@ -0,0 +1,67 @@
+/*
+ * Zero block detection functions
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _LIBQCOW_ZERO_BLOCK_H )
+#define _LIBQCOW_ZERO_BLOCK_H
+
+#include <common.h>
+#include <types.h>
+
+#include "libqcow_libcerror.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_CPUID_H ) && defined( HAVE_IMMINTRIN_H ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_LIBQCOW_ZERO_BLOCK_X86		1
+
+#elif defined( _MSC_VER ) && ( _MSC_VER >= 1700 ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#define HAVE_LIBQCOW_ZERO_BLOCK_X86		1
+
+#endif
+
+#if defined( __GNUC__ ) && defined( HAVE_ARM_NEON_H ) && defined( __aarch64__ )
+#define HAVE_LIBQCOW_ZERO_BLOCK_NEON		1
+#endif
+
+enum LIBQCOW_ZERO_BLOCK_BACKENDS
+{
+	LIBQCOW_ZERO_BLOCK_BACKEND_NONE		= 0,
+	LIBQCOW_ZERO_BLOCK_BACKEND_SSE2		= 1,
+	LIBQCOW_ZERO_BLOCK_BACKEND_AVX2		= 2,
+	LIBQCOW_ZERO_BLOCK_BACKEND_NEON		= 3
+};
+
+int libqcow_zero_block_get_backend(
+     void );
+
+int libqcow_zero_block_is_zero(
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _LIBQCOW_ZERO_BLOCK_H ) */
+
@@ -0,0 +1,106 @@
+/*
+ * The bitmap definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_BITMAP_H )
+#define _QCOW_BITMAP_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_bitmaps_extension qcow_bitmaps_extension_t;
+
+struct qcow_bitmaps_extension
+{
+	/* The number of bitmaps
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_bitmaps[ 4 ];
+
+	/* Reserved
+	 * Consists of 4 bytes
+	 */
+	uint8_t reserved[ 4 ];
+
+	/* The bitmap directory size
+	 * Consists of 8 bytes
+	 */
+	uint8_t bitmap_directory_size[ 8 ];
+
+	/* The bitmap directory offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t bitmap_directory_offset[ 8 ];
+};
+
+typedef struct qcow_bitmap_directory_entry qcow_bitmap_directory_entry_t;
+
+struct qcow_bitmap_directory_entry
+{
+	/* The bitmap table offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t bitmap_table_offset[ 8 ];
+
+	/* The number of bitmap table entries
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_bitmap_table_entries[ 4 ];
+
+	/* The flags
+	 * Consists of 4 bytes
+	 */
+	uint8_t flags[ 4 ];
+
+	/* The bitmap type
+	 * Consists of 1 byte
+	 */
+	uint8_t bitmap_type;
+
+	/* The number of granularity bits
+	 * Consists of 1 byte
+	 */
+	uint8_t number_of_granularity_bits;
+
+	/* The name size
+	 * Consists of 2 bytes
+	 */
+	uint8_t name_size[ 2 ];
+
+	/* The extra data size
+	 * Consists of 4 bytes
+	 */
+	uint8_t extra_data_size[ 4 ];
+};
+
+/* The bitmap directory entry is followed by the extra data and the name string.
+ * The bitmap directory entry is padded to a multitude of 8 bytes
+ */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_BITMAP_H ) */
+
@@ -0,0 +1,77 @@
+/*
+ * The cache state definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_CACHE_STATE_H )
+#define _QCOW_CACHE_STATE_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_cache_state_header qcow_cache_state_header_t;
+
+struct qcow_cache_state_header
+{
+	/* The signature
+	 * Consists of 8 bytes
+	 * Consists of: "qcowwarm"
+	 */
+	uint8_t signature[ 8 ];
+
+	/* The format version
+	 * Consists of 4 bytes
+	 */
+	uint8_t format_version[ 4 ];
+
+	/* The cluster block size
+	 * Consists of 4 bytes
+	 */
+	uint8_t cluster_block_size[ 4 ];
+
+	/* The media size
+	 * Consists of 8 bytes
+	 */
+	uint8_t media_size[ 8 ];
+
+	/* The number of level 2 tables
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_level2_tables[ 4 ];
+
+	/* The number of cluster blocks
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_cluster_blocks[ 4 ];
+};
+
+/* The header is followed by an 8 byte media offset per level 2 table
+ * followed by an 8 byte media offset per cluster block
+ */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_CACHE_STATE_H ) */
+
@@ -0,0 +1,79 @@
+/*
+ * The chain index file definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_CHAIN_INDEX_H )
+#define _QCOW_CHAIN_INDEX_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_chain_index_file_header qcow_chain_index_file_header_t;
+
+struct qcow_chain_index_file_header
+{
+	/* The signature
+	 * Consists of 8 bytes
+	 * Consists of: "qcowcidx"
+	 */
+	uint8_t signature[ 8 ];
+
+	/* The format version
+	 * Consists of 4 bytes
+	 */
+	uint8_t format_version[ 4 ];
+
+	/* The checksum
+	 * Consists of 4 bytes
+	 * Contains an Adler-32 of the entries data
+	 */
+	uint8_t checksum[ 4 ];
+
+	/* The cluster block size
+	 * Consists of 8 bytes
+	 */
+	uint8_t cluster_block_size[ 8 ];
+
+	/* The media size
+	 * Consists of 8 bytes
+	 */
+	uint8_t media_size[ 8 ];
+
+	/* The number of entries
+	 * Consists of 8 bytes
+	 */
+	uint8_t number_of_entries[ 8 ];
+};
+
+/* The file header is followed by the entries data, which consists of
+ * a 1 byte layer per entry followed by an 8 byte cluster block reference
+ * per entry
+ */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_CHAIN_INDEX_H ) */
+
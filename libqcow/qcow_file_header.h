@@ -161,6 +161,168 @@ struct qcow_file_header_v2
 	uint8_t snapshots_offset[ 8 ];
 };
 
+typedef struct qcow_file_header_v3 qcow_file_header_v3_t;
+
+struct qcow_file_header_v3
+{
+	/* The file signature
+	 * Consists of 4 bytes
+	 * Consists of: 0x51 0x46 0x49 0xfb
+	 */
+	uint8_t signature[ 4 ];
+
+	/* The format version
+	 * Consists of 4 bytes
+	 */
+	uint8_t format_version[ 4 ];
+
+	/* The backing filename offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t backing_filename_offset[ 8 ];
+
+	/* The backing filename size
+	 * Consists of 4 bytes
+	 */
+	uint8_t backing_filename_size[ 4 ];
+
+	/* The number of cluster block bits
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_cluster_block_bits[ 4 ];
+
+	/* The media size
+	 * Consists of 8 bytes
+	 */
+	uint8_t media_size[ 8 ];
+
+	/* The encryption method
+	 * Consists of 4 bytes
+	 */
+	uint8_t encryption_method[ 4 ];
+
+	/* The number of level 1 table references
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_level1_table_references[ 4 ];
+
+	/* The level 1 table offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t level1_table_offset[ 8 ];
+
+	/* The reference count table offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t reference_count_table_offset[ 8 ];
+
+	/* The reference count table clusters
+	 * Consists of 4 bytes
+	 */
+	uint8_t reference_count_table_clusters[ 4 ];
+
+	/* The number of snapshots
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_snapshots[ 4 ];
+
+	/* The snapshots offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t snapshots_offset[ 8 ];
+
+	/* The incompatible feature flags
+	 * Consists of 8 bytes
+	 */
+	uint8_t incompatible_feature_flags[ 8 ];
+
+	/* The compatible feature flags
+	 * Consists of 8 bytes
+	 */
+	uint8_t compatible_feature_flags[ 8 ];
+
+	/* The auto-clear feature flags
+	 * Consists of 8 bytes
+	 */
+	uint8_t autoclear_feature_flags[ 8 ];
+
+	/* The reference count order
+	 * Consists of 4 bytes
+	 */
+	uint8_t reference_count_order[ 4 ];
+
+	/* The header size
+	 * Consists of 4 bytes
+	 */
+	uint8_t header_size[ 4 ];
+
+	/* The compression type
+	 * Consists of 1 byte
+	 * Only used if the header size is 105 or more
+	 */
+	uint8_t compression_type;
+
+	/* Padding
+	 * Consists of 7 bytes
+	 */
+	uint8_t padding[ 7 ];
+};
+
+typedef struct qcow_header_extension qcow_header_extension_t;
+
+struct qcow_header_extension
+{
+	/* The type
+	 * Consists of 4 bytes
+	 */
+	uint8_t type[ 4 ];
+
+	/* The data size
+	 * Consists of 4 bytes
+	 */
+	uint8_t data_size[ 4 ];
+};
+
+/* The header extension is followed by the data
+ * which is padded to a multitude of 8 bytes
+ */
+
+typedef struct qcow_full_disk_encryption_extension qcow_full_disk_encryption_extension_t;
+
+struct qcow_full_disk_encryption_extension
+{
+	/* The encryption header offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t encryption_header_offset[ 8 ];
+
+	/* The encryption header size
+	 * Consists of 8 bytes
+	 */
+	uint8_t encryption_header_size[ 8 ];
+};
+
+typedef struct qcow_feature_name_table_entry qcow_feature_name_table_entry_t;
+
+struct qcow_feature_name_table_entry
+{
+	/* The feature type
+	 * Consists of 1 byte
+	 */
+	uint8_t feature_type;
+
+	/* The bit number
+	 * Consists of 1 byte
+	 */
+	uint8_t bit_number;
+
+	/* The name
+	 * Consists of 46 bytes
+	 * Contains an UTF-8 string padded with 0-byte values
+	 */
+	uint8_t name[ 46 ];
+};
+
 #if defined( __cplusplus )
 }
 #endif
@@ -0,0 +1,135 @@
+/*
+ * The LUKS header definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_LUKS_HEADER_H )
+#define _QCOW_LUKS_HEADER_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_luks_key_slot qcow_luks_key_slot_t;
+
+struct qcow_luks_key_slot
+{
+	/* The state
+	 * Consists of 4 bytes
+	 */
+	uint8_t state[ 4 ];
+
+	/* The number of (PBKDF2) iterations
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_iterations[ 4 ];
+
+	/* The (PBKDF2) salt
+	 * Consists of 32 bytes
+	 */
+	uint8_t salt[ 32 ];
+
+	/* The key material offset
+	 * Consists of 4 bytes
+	 * Contains a number of 512-byte sectors relative to the start of the header
+	 */
+	uint8_t key_material_offset[ 4 ];
+
+	/* The number of (anti-forensic) stripes
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_stripes[ 4 ];
+};
+
+typedef struct qcow_luks_header qcow_luks_header_t;
+
+struct qcow_luks_header
+{
+	/* The signature
+	 * Consists of 6 bytes
+	 * Contains: "LUKS\xba\xbe"
+	 */
+	uint8_t signature[ 6 ];
+
+	/* The format version
+	 * Consists of 2 bytes
+	 */
+	uint8_t format_version[ 2 ];
+
+	/* The cipher name
+	 * Consists of 32 bytes
+	 */
+	uint8_t cipher_name[ 32 ];
+
+	/* The cipher mode
+	 * Consists of 32 bytes
+	 */
+	uint8_t cipher_mode[ 32 ];
+
+	/* The hash specification
+	 * Consists of 32 bytes
+	 */
+	uint8_t hash_specification[ 32 ];
+
+	/* The payload offset
+	 * Consists of 4 bytes
+	 * Contains a number of 512-byte sectors
+	 */
+	uint8_t payload_offset[ 4 ];
+
+	/* The key size
+	 * Consists of 4 bytes
+	 */
+	uint8_t key_size[ 4 ];
+
+	/* The master key digest
+	 * Consists of 20 bytes
+	 */
+	uint8_t master_key_digest[ 20 ];
+
+	/* The master key digest salt
+	 * Consists of 32 bytes
+	 */
+	uint8_t master_key_digest_salt[ 32 ];
+
+	/* The master key digest number of iterations
+	 * Consists of 4 bytes
+	 */
+	uint8_t master_key_digest_number_of_iterations[ 4 ];
+
+	/* The identifier (UUID)
+	 * Consists of 40 bytes
+	 */
+	uint8_t identifier[ 40 ];
+
+	/* The key slots
+	 * Consists of 8 x 48 bytes
+	 */
+	qcow_luks_key_slot_t key_slots[ 8 ];
+};
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_LUKS_HEADER_H ) */
+
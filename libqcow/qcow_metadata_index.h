@@ -0,0 +1,107 @@
+/*
+ * The metadata index file definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_METADATA_INDEX_H )
+#define _QCOW_METADATA_INDEX_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_metadata_index_file_header qcow_metadata_index_file_header_t;
+
+struct qcow_metadata_index_file_header
+{
+	/* The signature
+	 * Consists of 8 bytes
+	 * Consists of: "qcowmidx"
+	 */
+	uint8_t signature[ 8 ];
+
+	/* The format version
+	 * Consists of 4 bytes
+	 */
+	uint8_t format_version[ 4 ];
+
+	/* The checksum
+	 * Consists of 4 bytes
+	 * Contains an Adler-32 of the entries data
+	 */
+	uint8_t checksum[ 4 ];
+
+	/* The file header checksum
+	 * Consists of 4 bytes
+	 * Contains an Adler-32 of the file header of the image
+	 */
+	uint8_t file_header_checksum[ 4 ];
+
+	/* The level 1 table checksum
+	 * Consists of 4 bytes
+	 * Contains an Adler-32 of the level 1 table of the image
+	 */
+	uint8_t level1_table_checksum[ 4 ];
+
+	/* The cluster block size
+	 * Consists of 8 bytes
+	 */
+	uint8_t cluster_block_size[ 8 ];
+
+	/* The media size
+	 * Consists of 8 bytes
+	 */
+	uint8_t media_size[ 8 ];
+
+	/* The number of entries
+	 * Consists of 8 bytes
+	 */
+	uint8_t number_of_entries[ 8 ];
+
+	/* The entry size
+	 * Consists of 4 bytes
+	 */
+	uint8_t entry_size[ 4 ];
+
+	/* The file size of the image
+	 * Consists of 8 bytes
+	 */
+	uint8_t file_size[ 8 ];
+
+	/* Unknown (reserved)
+	 * Consists of 4 bytes
+	 */
+	uint8_t unknown1[ 4 ];
+};
+
+/* The file header is followed by the entries data, which consists of
+ * the level 2 table entry per cluster block of the media stored as
+ * 8 byte little-endian values. An extended level 2 table entry consists
+ * of the cluster descriptor followed by the subcluster bitmap
+ */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_METADATA_INDEX_H ) */
+
@@ -0,0 +1,106 @@
+/*
+ * The snapshot definition of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _QCOW_SNAPSHOT_H )
+#define _QCOW_SNAPSHOT_H
+
+#include <common.h>
+#include <types.h>
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct qcow_snapshot_header qcow_snapshot_header_t;
+
+struct qcow_snapshot_header
+{
+	/* The level 1 table offset
+	 * Consists of 8 bytes
+	 */
+	uint8_t level1_table_offset[ 8 ];
+
+	/* The number of level 1 table references
+	 * Consists of 4 bytes
+	 */
+	uint8_t number_of_level1_table_references[ 4 ];
+
+	/* The identifier size
+	 * Consists of 2 bytes
+	 */
+	uint8_t identifier_size[ 2 ];
+
+	/* The name size
+	 * Consists of 2 bytes
+	 */
+	uint8_t name_size[ 2 ];
+
+	/* The creation date and time in seconds
+	 * Consists of 4 bytes
+	 */
+	uint8_t creation_time_seconds[ 4 ];
+
+	/* The creation date and time nano seconds fraction
+	 * Consists of 4 bytes
+	 */
+	uint8_t creation_time_nano_seconds[ 4 ];
+
+	/* The virtual machine clock time in nano seconds
+	 * Consists of 8 bytes
+	 */
+	uint8_t virtual_machine_clock_time[ 8 ];
+
+	/* The virtual machine state size
+	 * Consists of 4 bytes
+	 */
+	uint8_t virtual_machine_state_size[ 4 ];
+
+	/* The extra data size
+	 * Consists of 4 bytes
+	 */
+	uint8_t extra_data_size[ 4 ];
+};
+
+typedef struct qcow_snapshot_extra_data qcow_snapshot_extra_data_t;
+
+struct qcow_snapshot_extra_data
+{
+	/* The (64-bit) virtual machine state size
+	 * Consists of 8 bytes
+	 */
+	uint8_t virtual_machine_state_size[ 8 ];
+
+	/* The virtual disk size
+	 * Consists of 8 bytes
+	 */
+	uint8_t virtual_disk_size[ 8 ];
+};
+
+/* The snapshot header is followed by the extra data, the identifier string
+ * and the name string. The snapshot entry is padded to a multitude of 8 bytes
+ */
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _QCOW_SNAPSHOT_H ) */
+
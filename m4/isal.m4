@@ -0,0 +1,130 @@
+dnl Functions for Intel(R) Intelligent Storage Acceleration Library (ISA-L)
+dnl
+dnl Version: 20170222
+
+dnl Function to detect if isal is available
+AC_DEFUN([AX_ISAL_CHECK_LIB],
+ [dnl Check if parameters were provided
+ AS_IF(
+  [test "x$ac_cv_with_isal" != x && test "x$ac_cv_with_isal" != xno && test "x$ac_cv_with_isal" != xauto-detect],
+  [AS_IF(
+   [test -d "$ac_cv_with_isal"],
+   [CFLAGS="$CFLAGS -I${ac_cv_with_isal}/include"
+   LDFLAGS="$LDFLAGS -L${ac_cv_with_isal}/lib"],
+   [AC_MSG_WARN([no such directory: $ac_cv_with_isal])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_with_isal" = xno],
+  [ac_cv_isal=no],
+  [dnl Check for a pkg-config file
+  AS_IF(
+   [test "x$cross_compiling" != "xyes" && test "x$PKGCONFIG" != "x"],
+   [PKG_CHECK_MODULES(
+    [isal],
+    [libisal >= 2.20],
+    [ac_cv_isal=yes],
+    [ac_cv_isal=no])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_isal" = xyes],
+   [ac_cv_isal_CPPFLAGS="$pkg_cv_isal_CFLAGS"
+   ac_cv_isal_LIBADD="$pkg_cv_isal_LIBS"],
+   [dnl Check for headers
+   AC_CHECK_HEADERS([isa-l/igzip_lib.h])
+
+   AS_IF(
+    [test "x$ac_cv_header_isa_l_igzip_lib_h" = xno],
+    [ac_cv_isal=no],
+    [dnl Check for the individual functions
+    ac_cv_isal=yes
+
+    AC_CHECK_LIB(
+     isal,
+     isal_inflate_init,
+     [ac_cv_isal_dummy=yes],
+     [ac_cv_isal=no])
+    AC_CHECK_LIB(
+     isal,
+     isal_inflate_stateless,
+     [ac_cv_isal_dummy=yes],
+     [ac_cv_isal=no])
+
+    AS_IF(
+     [test "x$ac_cv_isal" = xyes],
+     [ac_cv_isal_LIBADD="-lisal"])
+    ])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_with_isal" != xauto-detect && test "x$ac_cv_isal" != xyes],
+   [AC_MSG_FAILURE(
+    [unable to find supported ISA-L in directory: $ac_cv_with_isal],
+    [1])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_isal" = xyes],
+  [AC_DEFINE(
+   [HAVE_ISAL],
+   [1],
+   [Define to 1 if you have the 'isal' library (-lisal).])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_isal" = xyes],
+  [AC_SUBST(
+   [HAVE_ISAL],
+   [1]) ],
+  [AC_SUBST(
+   [HAVE_ISAL],
+   [0])
+  ])
+ ])
+
+dnl Function to detect how to enable isal
+AC_DEFUN([AX_ISAL_CHECK_ENABLE],
+ [AX_COMMON_ARG_WITH(
+  [isal],
+  [isal],
+  [search for the ISA-L (isal) library in includedir and libdir or in the specified DIR, or no if not to use ISA-L],
+  [auto-detect],
+  [DIR])
+
+ dnl Check for a shared library version
+ AX_ISAL_CHECK_LIB
+
+ AS_IF(
+  [test "x$ac_cv_isal_CPPFLAGS" != "x"],
+  [AC_SUBST(
+   [ISAL_CPPFLAGS],
+   [$ac_cv_isal_CPPFLAGS])
+  ])
+ AS_IF(
+  [test "x$ac_cv_isal_LIBADD" != "x"],
+  [AC_SUBST(
+   [ISAL_LIBADD],
+   [$ac_cv_isal_LIBADD])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_isal" = xyes],
+  [AC_SUBST(
+   [ax_isal_pc_libs_private],
+   [-lisal])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_isal" = xyes],
+  [AC_SUBST(
+   [ax_isal_spec_requires],
+   [libisal])
+  AC_SUBST(
+   [ax_isal_spec_build_requires],
+   [libisal-devel])
+  ])
+ ])
+
@@ -0,0 +1,135 @@
+dnl Functions for liburing
+dnl
+dnl Version: 20170222
+
+dnl Function to detect if liburing is available
+AC_DEFUN([AX_LIBURING_CHECK_LIB],
+ [dnl Check if parameters were provided
+ AS_IF(
+  [test "x$ac_cv_with_liburing" != x && test "x$ac_cv_with_liburing" != xno && test "x$ac_cv_with_liburing" != xauto-detect],
+  [AS_IF(
+   [test -d "$ac_cv_with_liburing"],
+   [CFLAGS="$CFLAGS -I${ac_cv_with_liburing}/include"
+   LDFLAGS="$LDFLAGS -L${ac_cv_with_liburing}/lib"],
+   [AC_MSG_WARN([no such directory: $ac_cv_with_liburing])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_with_liburing" = xno],
+  [ac_cv_liburing=no],
+  [dnl Check for a pkg-config file
+  AS_IF(
+   [test "x$cross_compiling" != "xyes" && test "x$PKGCONFIG" != "x"],
+   [PKG_CHECK_MODULES(
+    [liburing],
+    [liburing >= 0.7],
+    [ac_cv_liburing=yes],
+    [ac_cv_liburing=no])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_liburing" = xyes],
+   [ac_cv_liburing_CPPFLAGS="$pkg_cv_liburing_CFLAGS"
+   ac_cv_liburing_LIBADD="$pkg_cv_liburing_LIBS"],
+   [dnl Check for headers
+   AC_CHECK_HEADERS([liburing.h])
+
+   AS_IF(
+    [test "x$ac_cv_header_liburing_h" = xno],
+    [ac_cv_liburing=no],
+    [dnl Check for the individual functions
+    ac_cv_liburing=yes
+
+    AC_CHECK_LIB(
+     uring,
+     io_uring_queue_init,
+     [ac_cv_liburing_dummy=yes],
+     [ac_cv_liburing=no])
+    AC_CHECK_LIB(
+     uring,
+     io_uring_queue_exit,
+     [ac_cv_liburing_dummy=yes],
+     [ac_cv_liburing=no])
+    AC_CHECK_LIB(
+     uring,
+     io_uring_submit,
+     [ac_cv_liburing_dummy=yes],
+     [ac_cv_liburing=no])
+
+    AS_IF(
+     [test "x$ac_cv_liburing" = xyes],
+     [ac_cv_liburing_LIBADD="-luring"])
+    ])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_with_liburing" != xauto-detect && test "x$ac_cv_liburing" != xyes],
+   [AC_MSG_FAILURE(
+    [unable to find supported liburing in directory: $ac_cv_with_liburing],
+    [1])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_liburing" = xyes],
+  [AC_DEFINE(
+   [HAVE_LIBURING],
+   [1],
+   [Define to 1 if you have the 'liburing' library (-luring).])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_liburing" = xyes],
+  [AC_SUBST(
+   [HAVE_LIBURING],
+   [1]) ],
+  [AC_SUBST(
+   [HAVE_LIBURING],
+   [0])
+  ])
+ ])
+
+dnl Function to detect how to enable liburing
+AC_DEFUN([AX_LIBURING_CHECK_ENABLE],
+ [AX_COMMON_ARG_WITH(
+  [liburing],
+  [liburing],
+  [search for liburing in includedir and libdir or in the specified DIR, or no if not to use liburing],
+  [auto-detect],
+  [DIR])
+
+ dnl Check for a shared library version
+ AX_LIBURING_CHECK_LIB
+
+ AS_IF(
+  [test "x$ac_cv_liburing_CPPFLAGS" != "x"],
+  [AC_SUBST(
+   [LIBURING_CPPFLAGS],
+   [$ac_cv_liburing_CPPFLAGS])
+  ])
+ AS_IF(
+  [test "x$ac_cv_liburing_LIBADD" != "x"],
+  [AC_SUBST(
+   [LIBURING_LIBADD],
+   [$ac_cv_liburing_LIBADD])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_liburing" = xyes],
+  [AC_SUBST(
+   [ax_liburing_pc_libs_private],
+   [-luring])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_liburing" = xyes],
+  [AC_SUBST(
+   [ax_liburing_spec_requires],
+   [liburing])
+  AC_SUBST(
+   [ax_liburing_spec_build_requires],
+   [liburing-devel])
+  ])
+ ])
+
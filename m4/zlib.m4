@@ -153,6 +153,39 @@ AC_DEFUN([AX_ZLIB_CHECK_COMPRESSBOUND],
   ])
  ])
 
+dnl Function to detect if the deflate functions are available
+AC_DEFUN([AX_ZLIB_CHECK_DEFLATE],
+ [AS_IF(
+  [test "x$ac_cv_zlib" = xzlib],
+  [AC_CHECK_LIB(
+   z,
+   deflate,
+   [ac_cv_deflate=zlib],
+   [ac_cv_deflate=no])
+
+  dnl Some versions of zlib provide deflateInit2_ instead of deflateInit2
+  AC_CHECK_LIB(
+   z,
+   deflateInit2_,
+   [ac_zlib_dummy=yes],
+   [ac_cv_deflate=no])
+
+  AC_CHECK_LIB(
+   z,
+   deflateEnd,
+   [ac_zlib_dummy=yes],
+   [ac_cv_deflate=no])
+
+  AS_IF(
+   [test "x$ac_cv_deflate" = xzlib],
+   [AC_DEFINE(
+    [HAVE_ZLIB_DEFLATE],
+    [1],
+    [Define to 1 if you have the `deflateInit2', `deflate', `deflateEnd' functions.])
+   ])
+  ])
+ ])
+
 dnl Function to detect if the inflate functions are available
 AC_DEFUN([AX_ZLIB_CHECK_INFLATE],
  [AS_IF(
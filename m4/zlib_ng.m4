@@ -0,0 +1,140 @@
+dnl Functions for zlib-ng
+dnl
+dnl Version: 20170222
+
+dnl Function to detect if zlib-ng is available
+AC_DEFUN([AX_ZLIB_NG_CHECK_LIB],
+ [dnl Check if parameters were provided
+ AS_IF(
+  [test "x$ac_cv_with_zlib_ng" != x && test "x$ac_cv_with_zlib_ng" != xno && test "x$ac_cv_with_zlib_ng" != xauto-detect],
+  [AS_IF(
+   [test -d "$ac_cv_with_zlib_ng"],
+   [CFLAGS="$CFLAGS -I${ac_cv_with_zlib_ng}/include"
+   LDFLAGS="$LDFLAGS -L${ac_cv_with_zlib_ng}/lib"],
+   [AC_MSG_WARN([no such directory: $ac_cv_with_zlib_ng])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_with_zlib_ng" = xno],
+  [ac_cv_zlib_ng=no],
+  [dnl Check for a pkg-config file
+  AS_IF(
+   [test "x$cross_compiling" != "xyes" && test "x$PKGCONFIG" != "x"],
+   [PKG_CHECK_MODULES(
+    [zlib_ng],
+    [zlib-ng >= 2.0],
+    [ac_cv_zlib_ng=yes],
+    [ac_cv_zlib_ng=no])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_zlib_ng" = xyes],
+   [ac_cv_zlib_ng_CPPFLAGS="$pkg_cv_zlib_ng_CFLAGS"
+   ac_cv_zlib_ng_LIBADD="$pkg_cv_zlib_ng_LIBS"],
+   [dnl Check for headers
+   AC_CHECK_HEADERS([zlib-ng.h])
+
+   AS_IF(
+    [test "x$ac_cv_header_zlib_ng_h" = xno],
+    [ac_cv_zlib_ng=no],
+    [dnl Check for the individual functions
+    ac_cv_zlib_ng=yes
+
+    AC_CHECK_LIB(
+     z-ng,
+     zng_inflateInit2,
+     [ac_cv_zlib_ng_dummy=yes],
+     [ac_cv_zlib_ng=no])
+    AC_CHECK_LIB(
+     z-ng,
+     zng_inflate,
+     [ac_cv_zlib_ng_dummy=yes],
+     [ac_cv_zlib_ng=no])
+    AC_CHECK_LIB(
+     z-ng,
+     zng_inflateReset,
+     [ac_cv_zlib_ng_dummy=yes],
+     [ac_cv_zlib_ng=no])
+    AC_CHECK_LIB(
+     z-ng,
+     zng_inflateEnd,
+     [ac_cv_zlib_ng_dummy=yes],
+     [ac_cv_zlib_ng=no])
+
+    AS_IF(
+     [test "x$ac_cv_zlib_ng" = xyes],
+     [ac_cv_zlib_ng_LIBADD="-lz-ng"])
+    ])
+   ])
+
+  AS_IF(
+   [test "x$ac_cv_with_zlib_ng" != xauto-detect && test "x$ac_cv_zlib_ng" != xyes],
+   [AC_MSG_FAILURE(
+    [unable to find supported zlib-ng in directory: $ac_cv_with_zlib_ng],
+    [1])
+   ])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_zlib_ng" = xyes],
+  [AC_DEFINE(
+   [HAVE_ZLIB_NG],
+   [1],
+   [Define to 1 if you have the 'z-ng' library (-lz-ng).])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_zlib_ng" = xyes],
+  [AC_SUBST(
+   [HAVE_ZLIB_NG],
+   [1]) ],
+  [AC_SUBST(
+   [HAVE_ZLIB_NG],
+   [0])
+  ])
+ ])
+
+dnl Function to detect how to enable zlib-ng
+AC_DEFUN([AX_ZLIB_NG_CHECK_ENABLE],
+ [AX_COMMON_ARG_WITH(
+  [zlib-ng],
+  [zlib_ng],
+  [search for zlib-ng in includedir and libdir or in the specified DIR, or no if not to use zlib-ng],
+  [auto-detect],
+  [DIR])
+
+ dnl Check for a shared library version
+ AX_ZLIB_NG_CHECK_LIB
+
+ AS_IF(
+  [test "x$ac_cv_zlib_ng_CPPFLAGS" != "x"],
+  [AC_SUBST(
+   [ZLIB_NG_CPPFLAGS],
+   [$ac_cv_zlib_ng_CPPFLAGS])
+  ])
+ AS_IF(
+  [test "x$ac_cv_zlib_ng_LIBADD" != "x"],
+  [AC_SUBST(
+   [ZLIB_NG_LIBADD],
+   [$ac_cv_zlib_ng_LIBADD])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_zlib_ng" = xyes],
+  [AC_SUBST(
+   [ax_zlib_ng_pc_libs_private],
+   [-lz-ng])
+  ])
+
+ AS_IF(
+  [test "x$ac_cv_zlib_ng" = xyes],
+  [AC_SUBST(
+   [ax_zlib_ng_spec_requires],
+   [zlib-ng])
+  AC_SUBST(
+   [ax_zlib_ng_spec_build_requires],
+   [zlib-ng-devel])
+  ])
+ ])
+
@@ -28,7 +28,10 @@
 #endif
 
 #include "pyqcow.h"
+#include "pyqcow_blocks.h"
 #include "pyqcow_encryption_types.h"
+#include "pyqcow_extent_types.h"
+#include "pyqcow_extents.h"
 #include "pyqcow_error.h"
 #include "pyqcow_file.h"
 #include "pyqcow_file_object_io_handle.h"
@@ -78,9 +81,11 @@ PyMethodDef pyqcow_module_methods[] = {
 	{ "open_file_object",
 	  (PyCFunction) pyqcow_file_new_open_file_object,
 	  METH_VARARGS | METH_KEYWORDS,
-	  "open_file_object(file_object, mode='r') -> Object\n"
+	  "open_file_object(file_object, mode='r', sequential_access=False) -> Object\n"
 	  "\n"
-	  "Opens a file using a file-like object." },
+	  "Opens a file using a file-like object.\n"
+	  "With sequential_access vectored and parallel reads are read in order of\n"
+	  "file offset, for file-like objects that are slow to seek." },
 
 	/* Sentinel */
 	{ NULL, NULL, 0, NULL }
@@ -451,7 +456,10 @@ PyMODINIT_FUNC initpyqcow(
 #endif
 {
 	PyObject *module                           = NULL;
+	PyTypeObject *blocks_type_object           = NULL;
 	PyTypeObject *encryption_types_type_object = NULL;
+	PyTypeObject *extent_types_type_object     = NULL;
+	PyTypeObject *extents_type_object          = NULL;
 	PyTypeObject *file_type_object             = NULL;
 	PyGILState_STATE gil_state                 = 0;
 
@@ -531,6 +539,68 @@ PyMODINIT_FUNC initpyqcow(
 	 "encryption_types",
 	 (PyObject *) encryption_types_type_object );
 
+	/* Setup the extent types type object
+	 */
+	pyqcow_extent_types_type_object.tp_new = PyType_GenericNew;
+
+	if( pyqcow_extent_types_init_type(
+	     &pyqcow_extent_types_type_object ) != 1 )
+	{
+		goto on_error;
+	}
+	if( PyType_Ready(
+	     &pyqcow_extent_types_type_object ) < 0 )
+	{
+		goto on_error;
+	}
+	Py_IncRef(
+	 (PyObject *) &pyqcow_extent_types_type_object );
+
+	extent_types_type_object = &pyqcow_extent_types_type_object;
+
+	PyModule_AddObject(
+	 module,
+	 "extent_types",
+	 (PyObject *) extent_types_type_object );
+
+	/* Setup the extents type object
+	 */
+	pyqcow_extents_type_object.tp_new = PyType_GenericNew;
+
+	if( PyType_Ready(
+	     &pyqcow_extents_type_object ) < 0 )
+	{
+		goto on_error;
+	}
+	Py_IncRef(
+	 (PyObject *) &pyqcow_extents_type_object );
+
+	extents_type_object = &pyqcow_extents_type_object;
+
+	PyModule_AddObject(
+	 module,
+	 "_extents",
+	 (PyObject *) extents_type_object );
+
+	/* Setup the blocks type object
+	 */
+	pyqcow_blocks_type_object.tp_new = PyType_GenericNew;
+
+	if( PyType_Ready(
+	     &pyqcow_blocks_type_object ) < 0 )
+	{
+		goto on_error;
+	}
+	Py_IncRef(
+	 (PyObject *) &pyqcow_blocks_type_object );
+
+	blocks_type_object = &pyqcow_blocks_type_object;
+
+	PyModule_AddObject(
+	 module,
+	 "_blocks",
+	 (PyObject *) blocks_type_object );
+
 	PyGILState_Release(
 	 gil_state );
 
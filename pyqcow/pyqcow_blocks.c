@@ -0,0 +1,507 @@
+/*
+ * Python object definition of the blocks iterator
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( HAVE_WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "pyqcow_blocks.h"
+#include "pyqcow_error.h"
+#include "pyqcow_file.h"
+#include "pyqcow_libcerror.h"
+#include "pyqcow_libqcow.h"
+#include "pyqcow_python.h"
+
+typedef struct pyqcow_blocks_batch pyqcow_blocks_batch_t;
+
+/* The batch that is filled by the parallel read callback function
+ */
+struct pyqcow_blocks_batch
+{
+	/* The batch data
+	 */
+	uint8_t *data;
+
+	/* The batch data size
+	 */
+	size_t data_size;
+
+	/* The batch offset
+	 */
+	off64_t offset;
+};
+
+PyTypeObject pyqcow_blocks_type_object = {
+	PyVarObject_HEAD_INIT( NULL, 0 )
+
+	/* tp_name */
+	"pyqcow.blocks",
+	/* tp_basicsize */
+	sizeof( pyqcow_blocks_t ),
+	/* tp_itemsize */
+	0,
+	/* tp_dealloc */
+	(destructor) pyqcow_blocks_free,
+	/* tp_print */
+	0,
+	/* tp_getattr */
+	0,
+	/* tp_setattr */
+	0,
+	/* tp_compare */
+	0,
+	/* tp_repr */
+	0,
+	/* tp_as_number */
+	0,
+	/* tp_as_sequence */
+	0,
+	/* tp_as_mapping */
+	0,
+	/* tp_hash */
+	0,
+	/* tp_call */
+	0,
+	/* tp_str */
+	0,
+	/* tp_getattro */
+	0,
+	/* tp_setattro */
+	0,
+	/* tp_as_buffer */
+	0,
+	/* tp_flags */
+	Py_TPFLAGS_DEFAULT,
+	/* tp_doc */
+	"pyqcow internal iterator object of the blocks of a file",
+	/* tp_traverse */
+	0,
+	/* tp_clear */
+	0,
+	/* tp_richcompare */
+	0,
+	/* tp_weaklistoffset */
+	0,
+	/* tp_iter */
+	(getiterfunc) pyqcow_blocks_iter,
+	/* tp_iternext */
+	(iternextfunc) pyqcow_blocks_iternext,
+	/* tp_methods */
+	0,
+	/* tp_members */
+	0,
+	/* tp_getset */
+	0,
+	/* tp_base */
+	0,
+	/* tp_dict */
+	0,
+	/* tp_descr_get */
+	0,
+	/* tp_descr_set */
+	0,
+	/* tp_dictoffset */
+	0,
+	/* tp_init */
+	(initproc) pyqcow_blocks_init,
+	/* tp_alloc */
+	0,
+	/* tp_new */
+	0,
+	/* tp_free */
+	0,
+	/* tp_is_gc */
+	0,
+	/* tp_bases */
+	NULL,
+	/* tp_mro */
+	NULL,
+	/* tp_cache */
+	NULL,
+	/* tp_subclasses */
+	NULL,
+	/* tp_weaklist */
+	NULL,
+	/* tp_del */
+	0
+};
+
+/* Creates a new blocks iterator object
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_blocks_new(
+           pyqcow_file_t *file_object,
+           size_t block_size,
+           size_t batch_size,
+           off64_t offset,
+           off64_t end_offset )
+{
+	pyqcow_blocks_t *pyqcow_blocks = NULL;
+	static char *function          = "pyqcow_blocks_new";
+
+	if( file_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file object.",
+		 function );
+
+		return( NULL );
+	}
+	if( ( block_size == 0 )
+	 || ( batch_size == 0 )
+	 || ( batch_size > ( (size_t) PY_SSIZE_T_MAX / block_size ) ) )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid block or batch size value out of bounds.",
+		 function );
+
+		return( NULL );
+	}
+	pyqcow_blocks = PyObject_New(
+	                 struct pyqcow_blocks,
+	                 &pyqcow_blocks_type_object );
+
+	if( pyqcow_blocks == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to initialize blocks.",
+		 function );
+
+		goto on_error;
+	}
+	if( pyqcow_blocks_init(
+	     pyqcow_blocks ) != 0 )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to initialize blocks.",
+		 function );
+
+		goto on_error;
+	}
+	/* The blocks iterator keeps a reference to the file object
+	 * so that the file is not freed while iterating
+	 */
+	pyqcow_blocks->file_object    = file_object;
+	pyqcow_blocks->block_size     = block_size;
+	pyqcow_blocks->batch_size     = batch_size;
+	pyqcow_blocks->current_offset = offset;
+	pyqcow_blocks->end_offset     = end_offset;
+
+	Py_IncRef(
+	 (PyObject *) pyqcow_blocks->file_object );
+
+	return( (PyObject *) pyqcow_blocks );
+
+on_error:
+	if( pyqcow_blocks != NULL )
+	{
+		Py_DecRef(
+		 (PyObject *) pyqcow_blocks );
+	}
+	return( NULL );
+}
+
+/* Intializes a blocks iterator object
+ * Returns 0 if successful or -1 on error
+ */
+int pyqcow_blocks_init(
+     pyqcow_blocks_t *pyqcow_blocks )
+{
+	static char *function = "pyqcow_blocks_init";
+
+	if( pyqcow_blocks == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid blocks.",
+		 function );
+
+		return( -1 );
+	}
+	/* Make sure the blocks values are initialized
+	 */
+	pyqcow_blocks->file_object    = NULL;
+	pyqcow_blocks->block_size     = 0;
+	pyqcow_blocks->batch_size     = 0;
+	pyqcow_blocks->current_offset = 0;
+	pyqcow_blocks->end_offset     = 0;
+
+	return( 0 );
+}
+
+/* Frees a blocks iterator object
+ */
+void pyqcow_blocks_free(
+      pyqcow_blocks_t *pyqcow_blocks )
+{
+	struct _typeobject *ob_type = NULL;
+	static char *function       = "pyqcow_blocks_free";
+
+	if( pyqcow_blocks == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid blocks.",
+		 function );
+
+		return;
+	}
+	ob_type = Py_TYPE(
+	           pyqcow_blocks );
+
+	if( ob_type == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: missing ob_type.",
+		 function );
+
+		return;
+	}
+	if( ob_type->tp_free == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid ob_type - missing tp_free.",
+		 function );
+
+		return;
+	}
+	if( pyqcow_blocks->file_object != NULL )
+	{
+		Py_DecRef(
+		 (PyObject *) pyqcow_blocks->file_object );
+	}
+	ob_type->tp_free(
+	 (PyObject*) pyqcow_blocks );
+}
+
+/* The blocks iter() function
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_blocks_iter(
+           pyqcow_blocks_t *pyqcow_blocks )
+{
+	static char *function = "pyqcow_blocks_iter";
+
+	if( pyqcow_blocks == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid blocks.",
+		 function );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 (PyObject *) pyqcow_blocks );
+
+	return( (PyObject *) pyqcow_blocks );
+}
+
+/* Copies a chunk read by libqcow_file_read_parallel into the batch
+ * The chunks do not overlap, hence concurrent calls write distinct parts of the batch
+ * Returns 1 to continue or -1 on error
+ */
+static int pyqcow_blocks_read_chunk_callback(
+            off64_t chunk_offset,
+            const uint8_t *chunk_data,
+            size_t chunk_size,
+            void *user_data )
+{
+	pyqcow_blocks_batch_t *batch = (pyqcow_blocks_batch_t *) user_data;
+	size_t data_offset           = 0;
+
+	if( ( batch == NULL )
+	 || ( chunk_offset < batch->offset ) )
+	{
+		return( -1 );
+	}
+	data_offset = (size_t) ( chunk_offset - batch->offset );
+
+	if( ( data_offset > batch->data_size )
+	 || ( chunk_size > ( batch->data_size - data_offset ) ) )
+	{
+		return( -1 );
+	}
+	if( memory_copy(
+	     &( batch->data[ data_offset ] ),
+	     chunk_data,
+	     chunk_size ) == NULL )
+	{
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* The blocks iternext() function
+ * The batch is read by the parallel read engine, the blocks that contain no data
+ * and the remainder of a block beyond the end of the range are zero filled
+ * The next batch is read into the cache in the background while the batch is processed
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_blocks_iternext(
+           pyqcow_blocks_t *pyqcow_blocks )
+{
+	pyqcow_blocks_batch_t batch;
+
+	libcerror_error_t *error   = NULL;
+	PyObject *bytearray_object = NULL;
+	static char *function      = "pyqcow_blocks_iternext";
+	size64_t batch_read_size   = 0;
+	size64_t next_read_size    = 0;
+	size_t batch_data_size     = 0;
+	size_t number_of_blocks    = 0;
+	off64_t next_offset        = 0;
+	int result                 = 0;
+
+	if( pyqcow_blocks == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid blocks.",
+		 function );
+
+		return( NULL );
+	}
+	if( pyqcow_blocks->file_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid blocks - missing file object.",
+		 function );
+
+		return( NULL );
+	}
+	if( pyqcow_blocks->current_offset >= pyqcow_blocks->end_offset )
+	{
+		PyErr_SetNone(
+		 PyExc_StopIteration );
+
+		return( NULL );
+	}
+	batch_read_size = (size64_t) ( pyqcow_blocks->end_offset - pyqcow_blocks->current_offset );
+	batch_data_size = pyqcow_blocks->batch_size * pyqcow_blocks->block_size;
+
+	if( batch_read_size > (size64_t) batch_data_size )
+	{
+		batch_read_size = (size64_t) batch_data_size;
+	}
+	/* The last batch contains the remaining blocks, where the last block is zero padded
+	 */
+	number_of_blocks = (size_t) ( ( batch_read_size + pyqcow_blocks->block_size - 1 ) / pyqcow_blocks->block_size );
+	batch_data_size  = number_of_blocks * pyqcow_blocks->block_size;
+
+	bytearray_object = PyByteArray_FromStringAndSize(
+	                    NULL,
+	                    (Py_ssize_t) batch_data_size );
+
+	if( bytearray_object == NULL )
+	{
+		return( NULL );
+	}
+	batch.data      = (uint8_t *) PyByteArray_AS_STRING(
+	                               bytearray_object );
+	batch.data_size = batch_data_size;
+	batch.offset    = pyqcow_blocks->current_offset;
+
+	next_offset    = pyqcow_blocks->current_offset + (off64_t) batch_read_size;
+	next_read_size = 0;
+
+	if( next_offset < pyqcow_blocks->end_offset )
+	{
+		next_read_size = (size64_t) ( pyqcow_blocks->end_offset - next_offset );
+
+		if( next_read_size > (size64_t) ( pyqcow_blocks->batch_size * pyqcow_blocks->block_size ) )
+		{
+			next_read_size = (size64_t) ( pyqcow_blocks->batch_size * pyqcow_blocks->block_size );
+		}
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	/* Chunks that contain no data are not passed to the callback function
+	 */
+	result = 1;
+
+	if( memory_set(
+	     batch.data,
+	     0,
+	     batch.data_size ) == NULL )
+	{
+		result = -1;
+	}
+	if( result == 1 )
+	{
+		result = libqcow_file_read_parallel(
+		          pyqcow_blocks->file_object->file,
+		          batch.offset,
+		          batch_read_size,
+		          0,
+		          &pyqcow_blocks_read_chunk_callback,
+		          (void *) &batch,
+		          0,
+		          0,
+		          &error );
+	}
+	/* The advice is best effort, an error does not affect the batch
+	 */
+	if( ( result == 1 )
+	 && ( next_read_size > 0 ) )
+	{
+		libqcow_file_advise(
+		 pyqcow_blocks->file_object->file,
+		 next_offset,
+		 next_read_size,
+		 LIBQCOW_ADVICE_WILLNEED,
+		 NULL );
+	}
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read batch at offset: %" PRIi64 ".",
+		 function,
+		 batch.offset );
+
+		libcerror_error_free(
+		 &error );
+
+		Py_DecRef(
+		 bytearray_object );
+
+		return( NULL );
+	}
+	pyqcow_blocks->current_offset = next_offset;
+
+	return( bytearray_object );
+}
+
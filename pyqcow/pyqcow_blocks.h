@@ -0,0 +1,92 @@
+/*
+ * Python object definition of the blocks iterator
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#if !defined( _PYQCOW_BLOCKS_H )
+#define _PYQCOW_BLOCKS_H
+
+#include <common.h>
+#include <types.h>
+
+#include "pyqcow_file.h"
+#include "pyqcow_libqcow.h"
+#include "pyqcow_python.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct pyqcow_blocks pyqcow_blocks_t;
+
+struct pyqcow_blocks
+{
+	/* Python object initialization
+	 */
+	PyObject_HEAD
+
+	/* The file object
+	 */
+	pyqcow_file_t *file_object;
+
+	/* The block size
+	 */
+	size_t block_size;
+
+	/* The batch size, which contains the number of blocks per batch
+	 */
+	size_t batch_size;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* The end offset
+	 */
+	off64_t end_offset;
+};
+
+extern PyTypeObject pyqcow_blocks_type_object;
+
+PyObject *pyqcow_blocks_new(
+           pyqcow_file_t *file_object,
+           size_t block_size,
+           size_t batch_size,
+           off64_t offset,
+           off64_t end_offset );
+
+int pyqcow_blocks_init(
+     pyqcow_blocks_t *pyqcow_blocks );
+
+void pyqcow_blocks_free(
+      pyqcow_blocks_t *pyqcow_blocks );
+
+PyObject *pyqcow_blocks_iter(
+           pyqcow_blocks_t *pyqcow_blocks );
+
+PyObject *pyqcow_blocks_iternext(
+           pyqcow_blocks_t *pyqcow_blocks );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _PYQCOW_BLOCKS_H ) */
+
@@ -0,0 +1,73 @@
+/*
+ * Python object definition of the libqcow extent types
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _PYQCOW_EXTENT_TYPES_H )
+#define _PYQCOW_EXTENT_TYPES_H
+
+#include <common.h>
+#include <types.h>
+
+#include "pyqcow_libqcow.h"
+#include "pyqcow_python.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The extent types
+ */
+enum PYQCOW_EXTENT_TYPES
+{
+	PYQCOW_EXTENT_TYPE_DATA		= 0,
+	PYQCOW_EXTENT_TYPE_HOLE		= 1,
+	PYQCOW_EXTENT_TYPE_ZERO		= 2,
+	PYQCOW_EXTENT_TYPE_COMPRESSED	= 3
+};
+
+typedef struct pyqcow_extent_types pyqcow_extent_types_t;
+
+struct pyqcow_extent_types
+{
+	/* Python object initialization
+	 */
+	PyObject_HEAD
+};
+
+extern PyTypeObject pyqcow_extent_types_type_object;
+
+int pyqcow_extent_types_init_type(
+     PyTypeObject *type_object );
+
+PyObject *pyqcow_extent_types_new(
+           void );
+
+int pyqcow_extent_types_init(
+     pyqcow_extent_types_t *pyqcow_extent_types );
+
+void pyqcow_extent_types_free(
+      pyqcow_extent_types_t *pyqcow_extent_types );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _PYQCOW_EXTENT_TYPES_H ) */
+
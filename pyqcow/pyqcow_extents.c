@@ -0,0 +1,581 @@
+/*
+ * Python object definition of the extents iterator
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( HAVE_WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "pyqcow_error.h"
+#include "pyqcow_extent_types.h"
+#include "pyqcow_extents.h"
+#include "pyqcow_file.h"
+#include "pyqcow_integer.h"
+#include "pyqcow_libcerror.h"
+#include "pyqcow_libqcow.h"
+#include "pyqcow_python.h"
+
+#if PY_VERSION_HEX >= 0x03050000
+
+PyAsyncMethods pyqcow_extents_async_methods = {
+	/* am_await */
+	0,
+	/* am_aiter */
+	(unaryfunc) pyqcow_extents_iter,
+	/* am_anext */
+	(unaryfunc) pyqcow_extents_anext,
+};
+
+#endif /* PY_VERSION_HEX >= 0x03050000 */
+
+PyTypeObject pyqcow_extents_type_object = {
+	PyVarObject_HEAD_INIT( NULL, 0 )
+
+	/* tp_name */
+	"pyqcow.extents",
+	/* tp_basicsize */
+	sizeof( pyqcow_extents_t ),
+	/* tp_itemsize */
+	0,
+	/* tp_dealloc */
+	(destructor) pyqcow_extents_free,
+	/* tp_print */
+	0,
+	/* tp_getattr */
+	0,
+	/* tp_setattr */
+	0,
+	/* tp_compare */
+#if PY_VERSION_HEX >= 0x03050000
+	&pyqcow_extents_async_methods,
+#else
+	0,
+#endif
+	/* tp_repr */
+	0,
+	/* tp_as_number */
+	0,
+	/* tp_as_sequence */
+	0,
+	/* tp_as_mapping */
+	0,
+	/* tp_hash */
+	0,
+	/* tp_call */
+	0,
+	/* tp_str */
+	0,
+	/* tp_getattro */
+	0,
+	/* tp_setattro */
+	0,
+	/* tp_as_buffer */
+	0,
+	/* tp_flags */
+	Py_TPFLAGS_DEFAULT,
+	/* tp_doc */
+	"pyqcow internal iterator object of the extents of a file",
+	/* tp_traverse */
+	0,
+	/* tp_clear */
+	0,
+	/* tp_richcompare */
+	0,
+	/* tp_weaklistoffset */
+	0,
+	/* tp_iter */
+	(getiterfunc) pyqcow_extents_iter,
+	/* tp_iternext */
+	(iternextfunc) pyqcow_extents_iternext,
+	/* tp_methods */
+	0,
+	/* tp_members */
+	0,
+	/* tp_getset */
+	0,
+	/* tp_base */
+	0,
+	/* tp_dict */
+	0,
+	/* tp_descr_get */
+	0,
+	/* tp_descr_set */
+	0,
+	/* tp_dictoffset */
+	0,
+	/* tp_init */
+	(initproc) pyqcow_extents_init,
+	/* tp_alloc */
+	0,
+	/* tp_new */
+	0,
+	/* tp_free */
+	0,
+	/* tp_is_gc */
+	0,
+	/* tp_bases */
+	NULL,
+	/* tp_mro */
+	NULL,
+	/* tp_cache */
+	NULL,
+	/* tp_subclasses */
+	NULL,
+	/* tp_weaklist */
+	NULL,
+	/* tp_del */
+	0
+};
+
+/* Creates a new extents iterator object
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_extents_new(
+           pyqcow_file_t *file_object,
+           off64_t offset,
+           off64_t end_offset )
+{
+	pyqcow_extents_t *pyqcow_extents = NULL;
+	static char *function            = "pyqcow_extents_new";
+
+	if( file_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file object.",
+		 function );
+
+		return( NULL );
+	}
+	pyqcow_extents = PyObject_New(
+	                  struct pyqcow_extents,
+	                  &pyqcow_extents_type_object );
+
+	if( pyqcow_extents == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to initialize extents.",
+		 function );
+
+		goto on_error;
+	}
+	if( pyqcow_extents_init(
+	     pyqcow_extents ) != 0 )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to initialize extents.",
+		 function );
+
+		goto on_error;
+	}
+	/* The extents iterator keeps a reference to the file object
+	 * so that the file is not freed while iterating
+	 */
+	pyqcow_extents->file_object    = file_object;
+	pyqcow_extents->current_offset = offset;
+	pyqcow_extents->end_offset     = end_offset;
+
+	Py_IncRef(
+	 (PyObject *) pyqcow_extents->file_object );
+
+	return( (PyObject *) pyqcow_extents );
+
+on_error:
+	if( pyqcow_extents != NULL )
+	{
+		Py_DecRef(
+		 (PyObject *) pyqcow_extents );
+	}
+	return( NULL );
+}
+
+/* Intializes an extents iterator object
+ * Returns 0 if successful or -1 on error
+ */
+int pyqcow_extents_init(
+     pyqcow_extents_t *pyqcow_extents )
+{
+	static char *function = "pyqcow_extents_init";
+
+	if( pyqcow_extents == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid extents.",
+		 function );
+
+		return( -1 );
+	}
+	/* Make sure the extents values are initialized
+	 */
+	pyqcow_extents->file_object    = NULL;
+	pyqcow_extents->current_offset = 0;
+	pyqcow_extents->end_offset     = 0;
+
+	return( 0 );
+}
+
+/* Frees an extents iterator object
+ */
+void pyqcow_extents_free(
+      pyqcow_extents_t *pyqcow_extents )
+{
+	struct _typeobject *ob_type = NULL;
+	static char *function       = "pyqcow_extents_free";
+
+	if( pyqcow_extents == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid extents.",
+		 function );
+
+		return;
+	}
+	ob_type = Py_TYPE(
+	           pyqcow_extents );
+
+	if( ob_type == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: missing ob_type.",
+		 function );
+
+		return;
+	}
+	if( ob_type->tp_free == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid ob_type - missing tp_free.",
+		 function );
+
+		return;
+	}
+	if( pyqcow_extents->file_object != NULL )
+	{
+		Py_DecRef(
+		 (PyObject *) pyqcow_extents->file_object );
+	}
+	ob_type->tp_free(
+	 (PyObject*) pyqcow_extents );
+}
+
+/* The extents iter() function
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_extents_iter(
+           pyqcow_extents_t *pyqcow_extents )
+{
+	static char *function = "pyqcow_extents_iter";
+
+	if( pyqcow_extents == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid extents.",
+		 function );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 (PyObject *) pyqcow_extents );
+
+	return( (PyObject *) pyqcow_extents );
+}
+
+/* The extents iternext() function
+ * The extent is retrieved from the level 1 and level 2 tables, the data is not read
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_extents_iternext(
+           pyqcow_extents_t *pyqcow_extents )
+{
+	libcerror_error_t *error    = NULL;
+	PyObject *integer_object    = NULL;
+	PyObject *tuple_object      = NULL;
+	static char *function       = "pyqcow_extents_iternext";
+	size64_t extent_size        = 0;
+	off64_t extent_end_offset   = 0;
+	off64_t extent_file_offset  = 0;
+	off64_t extent_offset       = 0;
+	uint32_t extent_flags       = 0;
+	long extent_type            = 0;
+	int result                  = 0;
+
+	if( pyqcow_extents == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid extents.",
+		 function );
+
+		return( NULL );
+	}
+	if( pyqcow_extents->file_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid extents - missing file object.",
+		 function );
+
+		return( NULL );
+	}
+	if( pyqcow_extents->current_offset >= pyqcow_extents->end_offset )
+	{
+		PyErr_SetNone(
+		 PyExc_StopIteration );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_extent_at_offset(
+	          pyqcow_extents->file_object->file,
+	          pyqcow_extents->current_offset,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result == -1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to retrieve extent at offset: %" PRIi64 ".",
+		 function,
+		 pyqcow_extents->current_offset );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	else if( result == 0 )
+	{
+		PyErr_SetNone(
+		 PyExc_StopIteration );
+
+		return( NULL );
+	}
+	extent_end_offset = extent_offset + (off64_t) extent_size;
+
+	if( extent_end_offset <= pyqcow_extents->current_offset )
+	{
+		PyErr_Format(
+		 PyExc_IOError,
+		 "%s: invalid extent at offset: %" PRIi64 " - end offset value out of bounds.",
+		 function,
+		 pyqcow_extents->current_offset );
+
+		return( NULL );
+	}
+	if( extent_end_offset > pyqcow_extents->end_offset )
+	{
+		extent_end_offset = pyqcow_extents->end_offset;
+	}
+	if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_ZERO ) != 0 )
+	{
+		extent_type = PYQCOW_EXTENT_TYPE_ZERO;
+	}
+	else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 )
+	{
+		extent_type = PYQCOW_EXTENT_TYPE_HOLE;
+	}
+	else if( ( extent_flags & LIBQCOW_EXTENT_FLAG_IS_COMPRESSED ) != 0 )
+	{
+		extent_type = PYQCOW_EXTENT_TYPE_COMPRESSED;
+	}
+	else
+	{
+		extent_type = PYQCOW_EXTENT_TYPE_DATA;
+	}
+	tuple_object = PyTuple_New(
+	                3 );
+
+	if( tuple_object == NULL )
+	{
+		goto on_error;
+	}
+	integer_object = pyqcow_integer_signed_new_from_64bit(
+	                  (int64_t) pyqcow_extents->current_offset );
+
+	if( integer_object == NULL )
+	{
+		goto on_error;
+	}
+	/* Note that PyTuple_SetItem steals the reference to the integer object
+	 */
+	if( PyTuple_SetItem(
+	     tuple_object,
+	     0,
+	     integer_object ) != 0 )
+	{
+		goto on_error;
+	}
+	integer_object = pyqcow_integer_unsigned_new_from_64bit(
+	                  (uint64_t) ( extent_end_offset - pyqcow_extents->current_offset ) );
+
+	if( integer_object == NULL )
+	{
+		goto on_error;
+	}
+	if( PyTuple_SetItem(
+	     tuple_object,
+	     1,
+	     integer_object ) != 0 )
+	{
+		goto on_error;
+	}
+#if PY_MAJOR_VERSION >= 3
+	integer_object = PyLong_FromLong(
+	                  extent_type );
+#else
+	integer_object = PyInt_FromLong(
+	                  extent_type );
+#endif
+	if( integer_object == NULL )
+	{
+		goto on_error;
+	}
+	if( PyTuple_SetItem(
+	     tuple_object,
+	     2,
+	     integer_object ) != 0 )
+	{
+		goto on_error;
+	}
+	pyqcow_extents->current_offset = extent_end_offset;
+
+	return( tuple_object );
+
+on_error:
+	if( tuple_object != NULL )
+	{
+		Py_DecRef(
+		 tuple_object );
+	}
+	return( NULL );
+}
+
+#if PY_VERSION_HEX >= 0x03050000
+
+/* The extents anext() function
+ * The extent is retrieved from the metadata, which normally is cached, hence
+ * it is retrieved directly and the returned future is already completed
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_extents_anext(
+           pyqcow_extents_t *pyqcow_extents )
+{
+	PyObject *asyncio_module = NULL;
+	PyObject *future         = NULL;
+	PyObject *loop           = NULL;
+	PyObject *method_result  = NULL;
+	PyObject *tuple_object   = NULL;
+
+	tuple_object = pyqcow_extents_iternext(
+	                pyqcow_extents );
+
+	if( tuple_object == NULL )
+	{
+		if( PyErr_ExceptionMatches(
+		     PyExc_StopIteration ) != 0 )
+		{
+			PyErr_Clear();
+
+			PyErr_SetNone(
+			 PyExc_StopAsyncIteration );
+		}
+		return( NULL );
+	}
+	asyncio_module = PyImport_ImportModule(
+	                  "asyncio" );
+
+	if( asyncio_module == NULL )
+	{
+		goto on_error;
+	}
+	loop = PyObject_CallMethod(
+	        asyncio_module,
+	        "get_running_loop",
+	        NULL );
+
+	Py_DecRef(
+	 asyncio_module );
+
+	if( loop == NULL )
+	{
+		goto on_error;
+	}
+	future = PyObject_CallMethod(
+	          loop,
+	          "create_future",
+	          NULL );
+
+	Py_DecRef(
+	 loop );
+
+	if( future == NULL )
+	{
+		goto on_error;
+	}
+	method_result = PyObject_CallMethod(
+	                 future,
+	                 "set_result",
+	                 "O",
+	                 tuple_object );
+
+	if( method_result == NULL )
+	{
+		goto on_error;
+	}
+	Py_DecRef(
+	 method_result );
+
+	Py_DecRef(
+	 tuple_object );
+
+	return( future );
+
+on_error:
+	if( future != NULL )
+	{
+		Py_DecRef(
+		 future );
+	}
+	Py_DecRef(
+	 tuple_object );
+
+	return( NULL );
+}
+
+#endif /* PY_VERSION_HEX >= 0x03050000 */
+
@@ -0,0 +1,86 @@
+/*
+ * Python object definition of the extents iterator
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _PYQCOW_EXTENTS_H )
+#define _PYQCOW_EXTENTS_H
+
+#include <common.h>
+#include <types.h>
+
+#include "pyqcow_file.h"
+#include "pyqcow_libqcow.h"
+#include "pyqcow_python.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct pyqcow_extents pyqcow_extents_t;
+
+struct pyqcow_extents
+{
+	/* Python object initialization
+	 */
+	PyObject_HEAD
+
+	/* The file object
+	 */
+	pyqcow_file_t *file_object;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* The end offset
+	 */
+	off64_t end_offset;
+};
+
+extern PyTypeObject pyqcow_extents_type_object;
+
+PyObject *pyqcow_extents_new(
+           pyqcow_file_t *file_object,
+           off64_t offset,
+           off64_t end_offset );
+
+int pyqcow_extents_init(
+     pyqcow_extents_t *pyqcow_extents );
+
+void pyqcow_extents_free(
+      pyqcow_extents_t *pyqcow_extents );
+
+PyObject *pyqcow_extents_iter(
+           pyqcow_extents_t *pyqcow_extents );
+
+PyObject *pyqcow_extents_iternext(
+           pyqcow_extents_t *pyqcow_extents );
+
+#if PY_VERSION_HEX >= 0x03050000
+PyObject *pyqcow_extents_anext(
+           pyqcow_extents_t *pyqcow_extents );
+#endif
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _PYQCOW_EXTENTS_H ) */
+
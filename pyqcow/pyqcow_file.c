@@ -20,6 +20,7 @@
  */
 
 #include <common.h>
+#include <memory.h>
 #include <narrow_string.h>
 #include <types.h>
 
@@ -27,7 +28,9 @@
 #include <stdlib.h>
 #endif
 
+#include "pyqcow_blocks.h"
 #include "pyqcow_error.h"
+#include "pyqcow_extents.h"
 #include "pyqcow_file_object_io_handle.h"
 #include "pyqcow_integer.h"
 #include "pyqcow_libbfio.h"
@@ -68,9 +71,11 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	{ "open_file_object",
 	  (PyCFunction) pyqcow_file_open_file_object,
 	  METH_VARARGS | METH_KEYWORDS,
-	  "open_file_object(file_object, mode='r') -> None\n"
+	  "open_file_object(file_object, mode='r', sequential_access=False) -> None\n"
 	  "\n"
-	  "Opens a file using a file-like object." },
+	  "Opens a file using a file-like object.\n"
+	  "With sequential_access vectored and parallel reads are read in order of\n"
+	  "file offset, for file-like objects that are slow to seek." },
 
 	{ "close",
 	  (PyCFunction) pyqcow_file_close,
@@ -86,6 +91,13 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	  "\n"
 	  "Reads a buffer of data." },
 
+	{ "read_buffer_into",
+	  (PyCFunction) pyqcow_file_read_buffer_into,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_buffer_into(buffer) -> Integer\n"
+	  "\n"
+	  "Reads data into a writable buffer object and returns the number of bytes read." },
+
 	{ "read_buffer_at_offset",
 	  (PyCFunction) pyqcow_file_read_buffer_at_offset,
 	  METH_VARARGS | METH_KEYWORDS,
@@ -93,6 +105,68 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	  "\n"
 	  "Reads a buffer of data at a specific offset." },
 
+	{ "read_buffer_at_offset_into",
+	  (PyCFunction) pyqcow_file_read_buffer_at_offset_into,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_buffer_at_offset_into(buffer, offset) -> Integer\n"
+	  "\n"
+	  "Reads data at a specific offset into a writable buffer object and returns the number of bytes read." },
+
+	{ "read_many",
+	  (PyCFunction) pyqcow_file_read_many,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_many(ranges) -> List\n"
+	  "\n"
+	  "Reads the data of a sequence of (offset, size) tuples and returns a list of buffers." },
+
+	{ "read_many_into",
+	  (PyCFunction) pyqcow_file_read_many_into,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_many_into(ranges) -> List\n"
+	  "\n"
+	  "Reads the data of a sequence of (buffer, offset) tuples into the writable buffer objects\n"
+	  "and returns a list of the number of bytes read per buffer." },
+
+	{ "read_blocks_into",
+	  (PyCFunction) pyqcow_file_read_blocks_into,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_blocks_into(array, block_indices, block_size=None) -> Integer\n"
+	  "\n"
+	  "Reads the blocks of a sequence of block indices into the rows of a writable C-contiguous\n"
+	  "buffer object of bytes, such as a NumPy array of dtype uint8 and shape (n_blocks, block_size).\n"
+	  "The block size is the size of a row, or the size passed for a 1-dimensional buffer.\n"
+	  "The blocks are read concurrently by the read request threads and the remainder of a block\n"
+	  "beyond the end of the media is zero filled. Returns the number of blocks read." },
+
+	{ "blocks",
+	  (PyCFunction) pyqcow_file_blocks,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "blocks(block_size, batch_size, offset=0, size=None) -> Iterator\n"
+	  "\n"
+	  "Retrieves an iterator of batches of consecutive blocks as bytearray objects of batch_size * block_size bytes,\n"
+	  "that can be wrapped without copying, such as by numpy.frombuffer(batch, numpy.uint8).reshape(-1, block_size).\n"
+	  "The batches are read by the parallel read engine and the next batch is read ahead while a batch is processed.\n"
+	  "The last batch can contain fewer blocks and the remainder of its last block is zero filled." },
+
+#if PY_MAJOR_VERSION >= 3
+	{ "read_buffer_at_offset_async",
+	  (PyCFunction) pyqcow_file_read_buffer_at_offset_async,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_buffer_at_offset_async(size, offset) -> Future\n"
+	  "\n"
+	  "Reads a buffer of data at a specific offset asynchronously.\n"
+	  "Must be called from a coroutine running in an asyncio event loop." },
+
+	{ "read_buffer_at_offset_into_async",
+	  (PyCFunction) pyqcow_file_read_buffer_at_offset_into_async,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_buffer_at_offset_into_async(buffer, offset) -> Future\n"
+	  "\n"
+	  "Reads data at a specific offset into a writable buffer object asynchronously.\n"
+	  "The result of the future is the number of bytes read.\n"
+	  "Must be called from a coroutine running in an asyncio event loop." },
+#endif
+
 	{ "seek_offset",
 	  (PyCFunction) pyqcow_file_seek_offset,
 	  METH_VARARGS | METH_KEYWORDS,
@@ -116,6 +190,13 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	  "\n"
 	  "Reads a buffer of data." },
 
+	{ "readinto",
+	  (PyCFunction) pyqcow_file_read_buffer_into,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "readinto(buffer) -> Integer\n"
+	  "\n"
+	  "Reads data into a writable buffer object and returns the number of bytes read." },
+
 	{ "seek",
 	  (PyCFunction) pyqcow_file_seek_offset,
 	  METH_VARARGS | METH_KEYWORDS,
@@ -139,6 +220,17 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	  "\n"
 	  "Retrieves the media size of the data." },
 
+	{ "extents",
+	  (PyCFunction) pyqcow_file_extents,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "extents(offset=0, size=None) -> Iterator\n"
+	  "\n"
+	  "Retrieves an iterator of (offset, size, type) tuples of the extents of the data.\n"
+	  "The type is one of the pyqcow.extent_types values, where HOLE indicates that\n"
+	  "the data is not stored in the file but read from the backing file, if any.\n"
+	  "The extents are determined from the level 1 and 2 tables without reading the data.\n"
+	  "The iterator also supports asynchronous iteration using async for." },
+
 	{ "set_password",
 	  (PyCFunction) pyqcow_file_set_password,
 	  METH_VARARGS | METH_KEYWORDS,
@@ -146,6 +238,96 @@ PyMethodDef pyqcow_file_object_methods[] = {
 	  "\n"
 	  "Sets the password." },
 
+	{ "set_cache_limits",
+	  (PyCFunction) pyqcow_file_set_cache_limits,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "set_cache_limits(maximum_number_of_level2_tables, maximum_number_of_cluster_blocks) -> None\n"
+	  "\n"
+	  "Sets the maximum number of level 2 tables and cluster blocks to cache.\n"
+	  "This function needs to be used before one of the open functions." },
+
+	{ "get_cache_memory_usage",
+	  (PyCFunction) pyqcow_file_get_cache_memory_usage,
+	  METH_NOARGS,
+	  "get_cache_memory_usage() -> Integer\n"
+	  "\n"
+	  "Retrieves the number of bytes used by the caches." },
+
+	{ "drop_caches",
+	  (PyCFunction) pyqcow_file_drop_caches,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "drop_caches(flags=0x07) -> None\n"
+	  "\n"
+	  "Drops the cached level 2 tables (0x01), cluster blocks (0x02) and compressed cluster blocks (0x04).\n"
+	  "This can be used to release memory when the system is under memory pressure." },
+
+	{ "get_statistics",
+	  (PyCFunction) pyqcow_file_get_statistics,
+	  METH_NOARGS,
+	  "get_statistics() -> Dictionary\n"
+	  "\n"
+	  "Retrieves the read statistics, the cache hits and misses, the number of reads and bytes read\n"
+	  "from the host file, the number of bytes returned and the time spent decompressing and decrypting in nanoseconds." },
+
+	{ "reset_statistics",
+	  (PyCFunction) pyqcow_file_reset_statistics,
+	  METH_NOARGS,
+	  "reset_statistics() -> None\n"
+	  "\n"
+	  "Resets the read statistics." },
+
+	{ "enable_latency_histograms",
+	  (PyCFunction) pyqcow_file_enable_latency_histograms,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "enable_latency_histograms(enabled=True) -> None\n"
+	  "\n"
+	  "Enables or disables recording the latencies in histograms." },
+
+	{ "get_latency_histogram",
+	  (PyCFunction) pyqcow_file_get_latency_histogram,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "get_latency_histogram(operation) -> List\n"
+	  "\n"
+	  "Retrieves the latency histogram of an operation: read_buffer, level2_table_read, cluster_block_read,\n"
+	  "decompress or decrypt, as a list of (lower bound, upper bound, count) tuples of the non-empty buckets\n"
+	  "with the bounds in nanoseconds." },
+
+	{ "get_latency_percentile",
+	  (PyCFunction) pyqcow_file_get_latency_percentile,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "get_latency_percentile(operation, percentile) -> Integer\n"
+	  "\n"
+	  "Retrieves the latency percentile of an operation in nanoseconds, where percentile is a value\n"
+	  "between 0.0 and 100.0, or 0 if no latencies were recorded." },
+
+	/* Functions to access the metadata index */
+
+	{ "read_metadata_index",
+	  (PyCFunction) pyqcow_file_read_metadata_index,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "read_metadata_index(filename) -> Boolean\n"
+	  "\n"
+	  "Reads the metadata index from a metadata index (sidecar) file.\n"
+	  "Returns False if the metadata index file does not match the file, in which case it is ignored." },
+
+	/* Functions to support pickle */
+
+	{ "__reduce__",
+	  (PyCFunction) pyqcow_file_reduce,
+	  METH_NOARGS,
+	  "__reduce__() -> Tuple\n"
+	  "\n"
+	  "Retrieves the state needed to reopen the file, such as in a multiprocessing worker.\n"
+	  "The state consists of the filename, the password and the metadata index filename.\n"
+	  "Only a file opened by filename can be pickled." },
+
+	{ "__setstate__",
+	  (PyCFunction) pyqcow_file_set_state,
+	  METH_O,
+	  "__setstate__(state) -> None\n"
+	  "\n"
+	  "Reopens the file from the state retrieved by __reduce__." },
+
 	/* Sentinel */
 	{ NULL, NULL, 0, NULL }
 };
@@ -362,8 +544,11 @@ int pyqcow_file_init(
 
 		return( -1 );
 	}
-	pyqcow_file->file           = NULL;
-	pyqcow_file->file_io_handle = NULL;
+	pyqcow_file->file                           = NULL;
+	pyqcow_file->file_io_handle                 = NULL;
+	pyqcow_file->filename_object                = NULL;
+	pyqcow_file->password_object                = NULL;
+	pyqcow_file->metadata_index_filename_object = NULL;
 
 	if( libqcow_file_initialize(
 	     &( pyqcow_file->file ),
@@ -451,6 +636,15 @@ void pyqcow_file_free(
 		libcerror_error_free(
 		 &error );
 	}
+	Py_DecRef(
+	 pyqcow_file->filename_object );
+
+	Py_DecRef(
+	 pyqcow_file->password_object );
+
+	Py_DecRef(
+	 pyqcow_file->metadata_index_filename_object );
+
 	ob_type->tp_free(
 	 (PyObject*) pyqcow_file );
 }
@@ -638,6 +832,14 @@ PyObject *pyqcow_file_open(
 
 			return( NULL );
 		}
+		Py_DecRef(
+		 pyqcow_file->filename_object );
+
+		Py_IncRef(
+		 string_object );
+
+		pyqcow_file->filename_object = string_object;
+
 		Py_IncRef(
 		 Py_None );
 
@@ -697,6 +899,14 @@ PyObject *pyqcow_file_open(
 
 			return( NULL );
 		}
+		Py_DecRef(
+		 pyqcow_file->filename_object );
+
+		Py_IncRef(
+		 string_object );
+
+		pyqcow_file->filename_object = string_object;
+
 		Py_IncRef(
 		 Py_None );
 
@@ -721,9 +931,11 @@ PyObject *pyqcow_file_open_file_object(
 	PyObject *file_object       = NULL;
 	libcerror_error_t *error    = NULL;
 	char *mode                  = NULL;
-	static char *keyword_list[] = { "file_object", "mode", NULL };
+	static char *keyword_list[] = { "file_object", "mode", "sequential_access", NULL };
 	static char *function       = "pyqcow_file_open_file_object";
+	int read_flags              = 0;
 	int result                  = 0;
+	int sequential_access       = 0;
 
 	if( pyqcow_file == NULL )
 	{
@@ -737,10 +949,11 @@ PyObject *pyqcow_file_open_file_object(
 	if( PyArg_ParseTupleAndKeywords(
 	     arguments,
 	     keywords,
-	     "O|s",
+	     "O|si",
 	     keyword_list,
 	     &file_object,
-	     &mode ) == 0 )
+	     &mode,
+	     &sequential_access ) == 0 )
 	{
 		return( NULL );
 	}
@@ -773,12 +986,34 @@ PyObject *pyqcow_file_open_file_object(
 	}
 	Py_BEGIN_ALLOW_THREADS
 
-	result = libqcow_file_open_file_io_handle(
-	          pyqcow_file->file,
-	          pyqcow_file->file_io_handle,
-	          LIBQCOW_OPEN_READ,
-	          &error );
+	result = 1;
+
+	/* A file-like object, such as a member of a compressed archive or a network
+	 * stream, can be expensive to seek, hence it is read in order of file offset
+	 */
+	if( sequential_access != 0 )
+	{
+		result = libqcow_file_get_read_flags(
+		          pyqcow_file->file,
+		          &read_flags,
+		          &error );
 
+		if( result == 1 )
+		{
+			result = libqcow_file_set_read_flags(
+			          pyqcow_file->file,
+			          read_flags | LIBQCOW_READ_FLAG_SEQUENTIAL_ACCESS,
+			          &error );
+		}
+	}
+	if( result == 1 )
+	{
+		result = libqcow_file_open_file_io_handle(
+		          pyqcow_file->file,
+		          pyqcow_file->file_io_handle,
+		          LIBQCOW_OPEN_READ,
+		          &error );
+	}
 	Py_END_ALLOW_THREADS
 
 	if( result != 1 )
@@ -876,6 +1111,16 @@ PyObject *pyqcow_file_close(
 			return( NULL );
 		}
 	}
+	Py_DecRef(
+	 pyqcow_file->filename_object );
+
+	pyqcow_file->filename_object = NULL;
+
+	Py_DecRef(
+	 pyqcow_file->metadata_index_filename_object );
+
+	pyqcow_file->metadata_index_filename_object = NULL;
+
 	Py_IncRef(
 	 Py_None );
 
@@ -1126,19 +1371,21 @@ PyObject *pyqcow_file_read_buffer_at_offset(
 	return( string_object );
 }
 
-/* Seeks a certain offset in the data
+/* Reads data at the current offset into a writable buffer object
  * Returns a Python object if successful or NULL on error
  */
-PyObject *pyqcow_file_seek_offset(
+PyObject *pyqcow_file_read_buffer_into(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments,
            PyObject *keywords )
 {
+	Py_buffer buffer_view;
+
 	libcerror_error_t *error    = NULL;
-	static char *function       = "pyqcow_file_seek_offset";
-	static char *keyword_list[] = { "offset", "whence", NULL };
-	off64_t offset              = 0;
-	int whence                  = 0;
+	PyObject *buffer_object     = NULL;
+	static char *function       = "pyqcow_file_read_buffer_into";
+	static char *keyword_list[] = { "buffer", NULL };
+	ssize_t read_count          = 0;
 
 	if( pyqcow_file == NULL )
 	{
@@ -1152,29 +1399,38 @@ PyObject *pyqcow_file_seek_offset(
 	if( PyArg_ParseTupleAndKeywords(
 	     arguments,
 	     keywords,
-	     "L|i",
+	     "O",
 	     keyword_list,
-	     &offset,
-	     &whence ) == 0 )
+	     &buffer_object ) == 0 )
+	{
+		return( NULL );
+	}
+	if( PyObject_GetBuffer(
+	     buffer_object,
+	     &buffer_view,
+	     PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
 	{
 		return( NULL );
 	}
 	Py_BEGIN_ALLOW_THREADS
 
-	offset = libqcow_file_seek_offset(
-	          pyqcow_file->file,
-	          offset,
-	          whence,
-	          &error );
+	read_count = libqcow_file_read_buffer(
+	              pyqcow_file->file,
+	              (uint8_t *) buffer_view.buf,
+	              (size_t) buffer_view.len,
+	              &error );
 
 	Py_END_ALLOW_THREADS
 
- 	if( offset == -1 )
+	PyBuffer_Release(
+	 &buffer_view );
+
+	if( read_count <= -1 )
 	{
 		pyqcow_error_raise(
 		 error,
 		 PyExc_IOError,
-		 "%s: unable to seek offset.",
+		 "%s: unable to read data.",
 		 function );
 
 		libcerror_error_free(
@@ -1182,26 +1438,26 @@ PyObject *pyqcow_file_seek_offset(
 
 		return( NULL );
 	}
-	Py_IncRef(
-	 Py_None );
-
-	return( Py_None );
+	return( pyqcow_integer_signed_new_from_64bit(
+	         (int64_t) read_count ) );
 }
 
-/* Retrieves the current offset in the data
+/* Reads data at a specific offset into a writable buffer object
  * Returns a Python object if successful or NULL on error
  */
-PyObject *pyqcow_file_get_offset(
+PyObject *pyqcow_file_read_buffer_at_offset_into(
            pyqcow_file_t *pyqcow_file,
-           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+           PyObject *arguments,
+           PyObject *keywords )
 {
-	libcerror_error_t *error = NULL;
-	PyObject *integer_object = NULL;
-	static char *function    = "pyqcow_file_get_offset";
-	off64_t current_offset   = 0;
-	int result               = 0;
+	Py_buffer buffer_view;
 
-	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+	libcerror_error_t *error    = NULL;
+	PyObject *buffer_object     = NULL;
+	static char *function       = "pyqcow_file_read_buffer_at_offset_into";
+	static char *keyword_list[] = { "buffer", "offset", NULL };
+	off64_t read_offset         = 0;
+	ssize_t read_count          = 0;
 
 	if( pyqcow_file == NULL )
 	{
@@ -1212,73 +1468,52 @@ PyObject *pyqcow_file_get_offset(
 
 		return( NULL );
 	}
-	Py_BEGIN_ALLOW_THREADS
-
-	result = libqcow_file_get_offset(
-	          pyqcow_file->file,
-	          &current_offset,
-	          &error );
-
-	Py_END_ALLOW_THREADS
-
-	if( result != 1 )
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "OL",
+	     keyword_list,
+	     &buffer_object,
+	     &read_offset ) == 0 )
 	{
-		pyqcow_error_raise(
-		 error,
-		 PyExc_IOError,
-		 "%s: unable to retrieve offset.",
-		 function );
-
-		libcerror_error_free(
-		 &error );
-
 		return( NULL );
 	}
-	integer_object = pyqcow_integer_signed_new_from_64bit(
-	                  (int64_t) current_offset );
-
-	return( integer_object );
-}
-
-/* Retrieves the media size
- * Returns a Python object if successful or NULL on error
- */
-PyObject *pyqcow_file_get_media_size(
-           pyqcow_file_t *pyqcow_file,
-           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
-{
-	libcerror_error_t *error = NULL;
-	PyObject *integer_object = NULL;
-	static char *function    = "pyqcow_file_get_media_size";
-	size64_t media_size      = 0;
-	int result               = 0;
-
-	PYQCOW_UNREFERENCED_PARAMETER( arguments )
-
-	if( pyqcow_file == NULL )
+	if( read_offset < 0 )
 	{
 		PyErr_Format(
-		 PyExc_TypeError,
-		 "%s: invalid file.",
+		 PyExc_ValueError,
+		 "%s: invalid argument read offset value less than zero.",
 		 function );
 
 		return( NULL );
 	}
+	if( PyObject_GetBuffer(
+	     buffer_object,
+	     &buffer_view,
+	     PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+	{
+		return( NULL );
+	}
 	Py_BEGIN_ALLOW_THREADS
 
-	result = libqcow_file_get_media_size(
-	          pyqcow_file->file,
-	          &media_size,
-	          &error );
+	read_count = libqcow_file_read_buffer_at_offset(
+	              pyqcow_file->file,
+	              (uint8_t *) buffer_view.buf,
+	              (size_t) buffer_view.len,
+	              (off64_t) read_offset,
+	              &error );
 
 	Py_END_ALLOW_THREADS
 
-	if( result != 1 )
+	PyBuffer_Release(
+	 &buffer_view );
+
+	if( read_count <= -1 )
 	{
 		pyqcow_error_raise(
 		 error,
 		 PyExc_IOError,
-		 "%s: failed to retrieve media size.",
+		 "%s: unable to read data.",
 		 function );
 
 		libcerror_error_free(
@@ -1286,31 +1521,42 @@ PyObject *pyqcow_file_get_media_size(
 
 		return( NULL );
 	}
-	integer_object = pyqcow_integer_unsigned_new_from_64bit(
-	                  (uint64_t) media_size );
-
-	return( integer_object );
+	return( pyqcow_integer_signed_new_from_64bit(
+	         (int64_t) read_count ) );
 }
 
-/* Sets the password
+/* Reads data at multiple offsets
+ * The ranges are read using a single vectored read without holding the GIL
  * Returns a Python object if successful or NULL on error
  */
-PyObject *pyqcow_file_set_password(
+PyObject *pyqcow_file_read_many(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments,
            PyObject *keywords )
 {
-	libcerror_error_t *error      = NULL;
-	char *password_string         = NULL;
-	static char *keyword_list[]   = { "password", NULL };
-	static char *function         = "pyqcow_file_set_password";
-	size_t password_string_length = 0;
-	int result                    = 0;
+	libcerror_error_t *error     = NULL;
+	PyObject *list_object        = NULL;
+	PyObject *range_object       = NULL;
+	PyObject *ranges_object      = NULL;
+	PyObject *sequence_object    = NULL;
+	PyObject **string_objects    = NULL;
+	static char *function        = "pyqcow_file_read_many";
+	static char *keyword_list[]  = { "ranges", NULL };
+	off64_t *read_offsets        = NULL;
+	size_t *read_sizes           = NULL;
+	void **buffers               = NULL;
+	size64_t media_size          = 0;
+	ssize_t read_count           = 0;
+	Py_ssize_t number_of_ranges  = 0;
+	Py_ssize_t range_index       = 0;
+	off64_t read_offset          = 0;
+	int read_size                = 0;
+	int result                   = 0;
 
 	if( pyqcow_file == NULL )
 	{
 		PyErr_Format(
-		 PyExc_ValueError,
+		 PyExc_TypeError,
 		 "%s: invalid file.",
 		 function );
 
@@ -1319,40 +1565,2747 @@ PyObject *pyqcow_file_set_password(
 	if( PyArg_ParseTupleAndKeywords(
 	     arguments,
 	     keywords,
-	     "s",
+	     "O",
 	     keyword_list,
-	     &password_string ) == 0 )
+	     &ranges_object ) == 0 )
 	{
 		return( NULL );
 	}
-	if( password_string == NULL )
+	sequence_object = PySequence_Fast(
+	                   ranges_object,
+	                   "ranges must be a sequence of (offset, size) tuples" );
+
+	if( sequence_object == NULL )
+	{
+		return( NULL );
+	}
+	number_of_ranges = PySequence_Fast_GET_SIZE(
+	                    sequence_object );
+
+	if( number_of_ranges > (Py_ssize_t) INT_MAX )
 	{
 		PyErr_Format(
 		 PyExc_ValueError,
-		 "%s: invalid password string.",
+		 "%s: invalid number of ranges value exceeds maximum.",
 		 function );
 
-		return( NULL );
+		goto on_error;
 	}
-	password_string_length = narrow_string_length(
-	                          password_string );
-
-	Py_BEGIN_ALLOW_THREADS
-
-	result = libqcow_file_set_utf8_password(
-	          pyqcow_file->file,
-	          (uint8_t *) password_string,
-	          password_string_length,
-	          &error );
+	if( number_of_ranges == 0 )
+	{
+		Py_DecRef(
+		 sequence_object );
 
-	Py_END_ALLOW_THREADS
+		return( PyList_New(
+		         0 ) );
+	}
+	string_objects = (PyObject **) PyMem_Malloc(
+	                                sizeof( PyObject * ) * number_of_ranges );
+	buffers        = (void **) PyMem_Malloc(
+	                            sizeof( void * ) * number_of_ranges );
+	read_sizes     = (size_t *) PyMem_Malloc(
+	                             sizeof( size_t ) * number_of_ranges );
+	read_offsets   = (off64_t *) PyMem_Malloc(
+	                              sizeof( off64_t ) * number_of_ranges );
+
+	if( ( string_objects == NULL )
+	 || ( buffers == NULL )
+	 || ( read_sizes == NULL )
+	 || ( read_offsets == NULL ) )
+	{
+		PyErr_NoMemory();
 
-	if( result != 1 )
+		goto on_error;
+	}
+	for( range_index = 0;
+	     range_index < number_of_ranges;
+	     range_index++ )
 	{
-		pyqcow_error_raise(
+		string_objects[ range_index ] = NULL;
+	}
+	for( range_index = 0;
+	     range_index < number_of_ranges;
+	     range_index++ )
+	{
+		range_object = PySequence_Fast_GET_ITEM(
+		                sequence_object,
+		                range_index );
+
+		if( PyArg_ParseTuple(
+		     range_object,
+		     "Li",
+		     &read_offset,
+		     &read_size ) == 0 )
+		{
+			goto on_error;
+		}
+		if( read_offset < 0 )
+		{
+			PyErr_Format(
+			 PyExc_ValueError,
+			 "%s: invalid range: %zd read offset value less than zero.",
+			 function,
+			 range_index );
+
+			goto on_error;
+		}
+		if( read_size < 0 )
+		{
+			PyErr_Format(
+			 PyExc_ValueError,
+			 "%s: invalid range: %zd read size value less than zero.",
+			 function,
+			 range_index );
+
+			goto on_error;
+		}
+#if PY_MAJOR_VERSION >= 3
+		string_objects[ range_index ] = PyBytes_FromStringAndSize(
+		                                 NULL,
+		                                 read_size );
+#else
+		string_objects[ range_index ] = PyString_FromStringAndSize(
+		                                 NULL,
+		                                 read_size );
+#endif
+		if( string_objects[ range_index ] == NULL )
+		{
+			goto on_error;
+		}
+#if PY_MAJOR_VERSION >= 3
+		buffers[ range_index ] = PyBytes_AsString(
+		                          string_objects[ range_index ] );
+#else
+		buffers[ range_index ] = PyString_AsString(
+		                          string_objects[ range_index ] );
+#endif
+		read_sizes[ range_index ]   = (size_t) read_size;
+		read_offsets[ range_index ] = read_offset;
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	if( result == 1 )
+	{
+		read_count = libqcow_file_read_vector(
+		              pyqcow_file->file,
+		              buffers,
+		              read_sizes,
+		              read_offsets,
+		              (int) number_of_ranges,
+		              &error );
+	}
+	Py_END_ALLOW_THREADS
+
+	if( ( result != 1 )
+	 || ( read_count <= -1 ) )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read data.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		goto on_error;
+	}
+	list_object = PyList_New(
+	               number_of_ranges );
+
+	if( list_object == NULL )
+	{
+		goto on_error;
+	}
+	/* A range is only partially read if it extends beyond the end of the media
+	 */
+	for( range_index = 0;
+	     range_index < number_of_ranges;
+	     range_index++ )
+	{
+		if( (size64_t) read_offsets[ range_index ] >= media_size )
+		{
+			read_sizes[ range_index ] = 0;
+		}
+		else if( read_sizes[ range_index ] > ( media_size - read_offsets[ range_index ] ) )
+		{
+			read_sizes[ range_index ] = (size_t) ( media_size - read_offsets[ range_index ] );
+		}
+#if PY_MAJOR_VERSION >= 3
+		if( _PyBytes_Resize(
+		     &( string_objects[ range_index ] ),
+		     (Py_ssize_t) read_sizes[ range_index ] ) != 0 )
+#else
+		if( _PyString_Resize(
+		     &( string_objects[ range_index ] ),
+		     (Py_ssize_t) read_sizes[ range_index ] ) != 0 )
+#endif
+		{
+			goto on_error;
+		}
+		/* The list takes over the reference to the string object
+		 */
+		PyList_SET_ITEM(
+		 list_object,
+		 range_index,
+		 string_objects[ range_index ] );
+
+		string_objects[ range_index ] = NULL;
+	}
+	PyMem_Free(
+	 read_offsets );
+	PyMem_Free(
+	 read_sizes );
+	PyMem_Free(
+	 buffers );
+	PyMem_Free(
+	 string_objects );
+
+	Py_DecRef(
+	 sequence_object );
+
+	return( list_object );
+
+on_error:
+	if( list_object != NULL )
+	{
+		Py_DecRef(
+		 list_object );
+	}
+	if( string_objects != NULL )
+	{
+		for( range_index = 0;
+		     range_index < number_of_ranges;
+		     range_index++ )
+		{
+			if( string_objects[ range_index ] != NULL )
+			{
+				Py_DecRef(
+				 string_objects[ range_index ] );
+			}
+		}
+	}
+	if( read_offsets != NULL )
+	{
+		PyMem_Free(
+		 read_offsets );
+	}
+	if( read_sizes != NULL )
+	{
+		PyMem_Free(
+		 read_sizes );
+	}
+	if( buffers != NULL )
+	{
+		PyMem_Free(
+		 buffers );
+	}
+	if( string_objects != NULL )
+	{
+		PyMem_Free(
+		 string_objects );
+	}
+	Py_DecRef(
+	 sequence_object );
+
+	return( NULL );
+}
+
+/* Reads data at multiple offsets into writable buffer objects
+ * The ranges are read using a single vectored read without holding the GIL
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_many_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error     = NULL;
+	PyObject *buffer_object      = NULL;
+	PyObject *integer_object     = NULL;
+	PyObject *list_object        = NULL;
+	PyObject *range_object       = NULL;
+	PyObject *ranges_object      = NULL;
+	PyObject *sequence_object    = NULL;
+	Py_buffer *buffer_views      = NULL;
+	static char *function        = "pyqcow_file_read_many_into";
+	static char *keyword_list[]  = { "ranges", NULL };
+	off64_t *read_offsets        = NULL;
+	size_t *read_sizes           = NULL;
+	void **buffers               = NULL;
+	size64_t media_size          = 0;
+	ssize_t read_count           = 0;
+	Py_ssize_t number_of_ranges  = 0;
+	Py_ssize_t number_of_views   = 0;
+	Py_ssize_t range_index       = 0;
+	off64_t read_offset          = 0;
+	int result                   = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "O",
+	     keyword_list,
+	     &ranges_object ) == 0 )
+	{
+		return( NULL );
+	}
+	sequence_object = PySequence_Fast(
+	                   ranges_object,
+	                   "ranges must be a sequence of (buffer, offset) tuples" );
+
+	if( sequence_object == NULL )
+	{
+		return( NULL );
+	}
+	number_of_ranges = PySequence_Fast_GET_SIZE(
+	                    sequence_object );
+
+	if( number_of_ranges > (Py_ssize_t) INT_MAX )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid number of ranges value exceeds maximum.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_ranges == 0 )
+	{
+		Py_DecRef(
+		 sequence_object );
+
+		return( PyList_New(
+		         0 ) );
+	}
+	buffer_views = (Py_buffer *) PyMem_Malloc(
+	                              sizeof( Py_buffer ) * number_of_ranges );
+	buffers      = (void **) PyMem_Malloc(
+	                          sizeof( void * ) * number_of_ranges );
+	read_sizes   = (size_t *) PyMem_Malloc(
+	                           sizeof( size_t ) * number_of_ranges );
+	read_offsets = (off64_t *) PyMem_Malloc(
+	                            sizeof( off64_t ) * number_of_ranges );
+
+	if( ( buffer_views == NULL )
+	 || ( buffers == NULL )
+	 || ( read_sizes == NULL )
+	 || ( read_offsets == NULL ) )
+	{
+		PyErr_NoMemory();
+
+		goto on_error;
+	}
+	for( range_index = 0;
+	     range_index < number_of_ranges;
+	     range_index++ )
+	{
+		range_object = PySequence_Fast_GET_ITEM(
+		                sequence_object,
+		                range_index );
+
+		if( PyArg_ParseTuple(
+		     range_object,
+		     "OL",
+		     &buffer_object,
+		     &read_offset ) == 0 )
+		{
+			goto on_error;
+		}
+		if( read_offset < 0 )
+		{
+			PyErr_Format(
+			 PyExc_ValueError,
+			 "%s: invalid range: %zd read offset value less than zero.",
+			 function,
+			 range_index );
+
+			goto on_error;
+		}
+		if( PyObject_GetBuffer(
+		     buffer_object,
+		     &( buffer_views[ range_index ] ),
+		     PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+		{
+			goto on_error;
+		}
+		number_of_views++;
+
+		buffers[ range_index ]      = buffer_views[ range_index ].buf;
+		read_sizes[ range_index ]   = (size_t) buffer_views[ range_index ].len;
+		read_offsets[ range_index ] = read_offset;
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	if( result == 1 )
+	{
+		read_count = libqcow_file_read_vector(
+		              pyqcow_file->file,
+		              buffers,
+		              read_sizes,
+		              read_offsets,
+		              (int) number_of_ranges,
+		              &error );
+	}
+	Py_END_ALLOW_THREADS
+
+	if( ( result != 1 )
+	 || ( read_count <= -1 ) )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read data.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		goto on_error;
+	}
+	list_object = PyList_New(
+	               number_of_ranges );
+
+	if( list_object == NULL )
+	{
+		goto on_error;
+	}
+	/* A buffer is only partially filled if it extends beyond the end of the media
+	 */
+	for( range_index = 0;
+	     range_index < number_of_ranges;
+	     range_index++ )
+	{
+		if( (size64_t) read_offsets[ range_index ] >= media_size )
+		{
+			read_sizes[ range_index ] = 0;
+		}
+		else if( read_sizes[ range_index ] > ( media_size - read_offsets[ range_index ] ) )
+		{
+			read_sizes[ range_index ] = (size_t) ( media_size - read_offsets[ range_index ] );
+		}
+		integer_object = pyqcow_integer_unsigned_new_from_64bit(
+		                  (uint64_t) read_sizes[ range_index ] );
+
+		if( integer_object == NULL )
+		{
+			goto on_error;
+		}
+		PyList_SET_ITEM(
+		 list_object,
+		 range_index,
+		 integer_object );
+	}
+	for( range_index = 0;
+	     range_index < number_of_views;
+	     range_index++ )
+	{
+		PyBuffer_Release(
+		 &( buffer_views[ range_index ] ) );
+	}
+	PyMem_Free(
+	 read_offsets );
+	PyMem_Free(
+	 read_sizes );
+	PyMem_Free(
+	 buffers );
+	PyMem_Free(
+	 buffer_views );
+
+	Py_DecRef(
+	 sequence_object );
+
+	return( list_object );
+
+on_error:
+	if( list_object != NULL )
+	{
+		Py_DecRef(
+		 list_object );
+	}
+	if( buffer_views != NULL )
+	{
+		for( range_index = 0;
+		     range_index < number_of_views;
+		     range_index++ )
+		{
+			PyBuffer_Release(
+			 &( buffer_views[ range_index ] ) );
+		}
+	}
+	if( read_offsets != NULL )
+	{
+		PyMem_Free(
+		 read_offsets );
+	}
+	if( read_sizes != NULL )
+	{
+		PyMem_Free(
+		 read_sizes );
+	}
+	if( buffers != NULL )
+	{
+		PyMem_Free(
+		 buffers );
+	}
+	if( buffer_views != NULL )
+	{
+		PyMem_Free(
+		 buffer_views );
+	}
+	Py_DecRef(
+	 sequence_object );
+
+	return( NULL );
+}
+
+/* Reads blocks into the rows of a buffer
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_blocks_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	Py_buffer buffer_view;
+
+	libcerror_error_t *error            = NULL;
+	libqcow_read_request_t **requests   = NULL;
+	PyObject *array_object              = NULL;
+	PyObject *block_index_object        = NULL;
+	PyObject *block_indices_object      = NULL;
+	PyObject *block_size_object         = NULL;
+	PyObject *sequence_object           = NULL;
+	static char *function               = "pyqcow_file_read_blocks_into";
+	static char *keyword_list[]         = { "array", "block_indices", "block_size", NULL };
+	uint8_t *block_data                 = NULL;
+	uint64_t block_index                = 0;
+	uint64_t block_size                 = 0;
+	size64_t media_size                 = 0;
+	ssize_t read_count                  = 0;
+	Py_ssize_t number_of_blocks         = 0;
+	Py_ssize_t number_of_requests       = 0;
+	Py_ssize_t maximum_number_of_blocks = 0;
+	Py_ssize_t request_index            = 0;
+	off64_t *block_offsets              = NULL;
+	int has_buffer_view                 = 0;
+	int result                          = 0;
+	int status                          = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "OO|O",
+	     keyword_list,
+	     &array_object,
+	     &block_indices_object,
+	     &block_size_object ) == 0 )
+	{
+		return( NULL );
+	}
+	if( PyObject_GetBuffer(
+	     array_object,
+	     &buffer_view,
+	     PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+	{
+		return( NULL );
+	}
+	has_buffer_view = 1;
+
+	if( buffer_view.itemsize != 1 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: unsupported array item size: %zd.",
+		 function,
+		 buffer_view.itemsize );
+
+		goto on_error;
+	}
+	if( ( block_size_object != NULL )
+	 && ( block_size_object != Py_None ) )
+	{
+		if( pyqcow_integer_unsigned_copy_to_64bit(
+		     block_size_object,
+		     &block_size,
+		     &error ) != 1 )
+		{
+			pyqcow_error_raise(
+			 error,
+			 PyExc_ValueError,
+			 "%s: unable to convert block size into 64-bit unsigned integer.",
+			 function );
+
+			libcerror_error_free(
+			 &error );
+
+			goto on_error;
+		}
+	}
+	else if( ( buffer_view.ndim == 2 )
+	      && ( buffer_view.shape != NULL ) )
+	{
+		block_size = (uint64_t) buffer_view.shape[ 1 ];
+	}
+	else
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: missing block size for array that is not 2-dimensional.",
+		 function );
+
+		goto on_error;
+	}
+	if( ( block_size == 0 )
+	 || ( block_size > (uint64_t) buffer_view.len )
+	 || ( ( buffer_view.ndim == 2 )
+	  &&  ( buffer_view.shape != NULL )
+	  &&  ( block_size != (uint64_t) buffer_view.shape[ 1 ] ) ) )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid block size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	maximum_number_of_blocks = buffer_view.len / (Py_ssize_t) block_size;
+
+	sequence_object = PySequence_Fast(
+	                   block_indices_object,
+	                   "block_indices must be a sequence of integers" );
+
+	if( sequence_object == NULL )
+	{
+		goto on_error;
+	}
+	number_of_blocks = PySequence_Fast_GET_SIZE(
+	                    sequence_object );
+
+	if( number_of_blocks > maximum_number_of_blocks )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid number of block indices value exceeds number of rows in array.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_blocks == 0 )
+	{
+		Py_DecRef(
+		 sequence_object );
+
+		PyBuffer_Release(
+		 &buffer_view );
+
+		return( pyqcow_integer_unsigned_new_from_64bit(
+		         0 ) );
+	}
+	block_offsets = (off64_t *) PyMem_Malloc(
+	                             sizeof( off64_t ) * number_of_blocks );
+	requests      = (libqcow_read_request_t **) PyMem_Malloc(
+	                                             sizeof( libqcow_read_request_t * ) * number_of_blocks );
+
+	if( ( block_offsets == NULL )
+	 || ( requests == NULL ) )
+	{
+		PyErr_NoMemory();
+
+		goto on_error;
+	}
+	for( request_index = 0;
+	     request_index < number_of_blocks;
+	     request_index++ )
+	{
+		requests[ request_index ] = NULL;
+
+		block_index_object = PySequence_Fast_GET_ITEM(
+		                      sequence_object,
+		                      request_index );
+
+		if( pyqcow_integer_unsigned_copy_to_64bit(
+		     block_index_object,
+		     &block_index,
+		     &error ) != 1 )
+		{
+			pyqcow_error_raise(
+			 error,
+			 PyExc_ValueError,
+			 "%s: unable to convert block index: %zd into 64-bit unsigned integer.",
+			 function,
+			 request_index );
+
+			libcerror_error_free(
+			 &error );
+
+			goto on_error;
+		}
+		if( block_index > ( (uint64_t) INT64_MAX / block_size ) )
+		{
+			PyErr_Format(
+			 PyExc_ValueError,
+			 "%s: invalid block index: %zd value out of bounds.",
+			 function,
+			 request_index );
+
+			goto on_error;
+		}
+		block_offsets[ request_index ] = (off64_t) ( block_index * block_size );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	/* The blocks are queued as read requests first so that they are read
+	 * concurrently by the read request threads
+	 */
+	for( request_index = 0;
+	     request_index < number_of_blocks;
+	     request_index++ )
+	{
+		if( result != 1 )
+		{
+			break;
+		}
+		block_data = &( ( (uint8_t *) buffer_view.buf )[ request_index * (Py_ssize_t) block_size ] );
+
+		if( (size64_t) block_offsets[ request_index ] >= media_size )
+		{
+			continue;
+		}
+		result = libqcow_file_read_async(
+		          pyqcow_file->file,
+		          (void *) block_data,
+		          (size_t) block_size,
+		          block_offsets[ request_index ],
+		          NULL,
+		          NULL,
+		          &( requests[ request_index ] ),
+		          &error );
+
+		if( result == 1 )
+		{
+			number_of_requests = request_index + 1;
+		}
+	}
+	/* Every queued read request is waited for, also on error, since the read
+	 * requests refer to the buffer
+	 */
+	for( request_index = 0;
+	     request_index < number_of_blocks;
+	     request_index++ )
+	{
+		block_data = &( ( (uint8_t *) buffer_view.buf )[ request_index * (Py_ssize_t) block_size ] );
+		read_count = 0;
+
+		if( ( request_index < number_of_requests )
+		 && ( requests[ request_index ] != NULL ) )
+		{
+			if( result == 1 )
+			{
+				result = libqcow_read_request_wait(
+				          requests[ request_index ],
+				          &error );
+			}
+			if( result == 1 )
+			{
+				result = libqcow_read_request_get_status(
+				          requests[ request_index ],
+				          &status,
+				          &error );
+
+				if( ( result == 1 )
+				 && ( status != LIBQCOW_READ_REQUEST_STATUS_COMPLETED ) )
+				{
+					result = -1;
+				}
+			}
+			if( result == 1 )
+			{
+				result = libqcow_read_request_get_read_count(
+				          requests[ request_index ],
+				          &read_count,
+				          &error );
+			}
+			/* Freeing a read request that has not finished waits for it
+			 */
+			if( libqcow_read_request_free(
+			     &( requests[ request_index ] ),
+			     NULL ) != 1 )
+			{
+				result = -1;
+			}
+		}
+		/* The remainder of a block beyond the end of the media is zero filled
+		 */
+		if( ( result == 1 )
+		 && ( read_count >= 0 )
+		 && ( (uint64_t) read_count < block_size ) )
+		{
+			memory_set(
+			 &( block_data[ read_count ] ),
+			 0,
+			 (size_t) ( block_size - read_count ) );
+		}
+	}
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read blocks.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		goto on_error;
+	}
+	PyMem_Free(
+	 requests );
+	PyMem_Free(
+	 block_offsets );
+
+	Py_DecRef(
+	 sequence_object );
+
+	PyBuffer_Release(
+	 &buffer_view );
+
+	return( pyqcow_integer_unsigned_new_from_64bit(
+	         (uint64_t) number_of_blocks ) );
+
+on_error:
+	if( requests != NULL )
+	{
+		PyMem_Free(
+		 requests );
+	}
+	if( block_offsets != NULL )
+	{
+		PyMem_Free(
+		 block_offsets );
+	}
+	if( sequence_object != NULL )
+	{
+		Py_DecRef(
+		 sequence_object );
+	}
+	if( has_buffer_view != 0 )
+	{
+		PyBuffer_Release(
+		 &buffer_view );
+	}
+	return( NULL );
+}
+
+/* Retrieves an iterator of batches of blocks
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_blocks(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	PyObject *size_object       = NULL;
+	static char *function       = "pyqcow_file_blocks";
+	static char *keyword_list[] = { "block_size", "batch_size", "offset", "size", NULL };
+	size64_t media_size         = 0;
+	uint64_t size               = 0;
+	off64_t end_offset          = 0;
+	off64_t offset              = 0;
+	Py_ssize_t batch_size       = 0;
+	Py_ssize_t block_size       = 0;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "nn|LO",
+	     keyword_list,
+	     &block_size,
+	     &batch_size,
+	     &offset,
+	     &size_object ) == 0 )
+	{
+		return( NULL );
+	}
+	if( block_size <= 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument block size value zero or less.",
+		 function );
+
+		return( NULL );
+	}
+	if( batch_size <= 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument batch size value zero or less.",
+		 function );
+
+		return( NULL );
+	}
+	if( offset < 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument offset value less than zero.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: failed to retrieve media size.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	end_offset = (off64_t) media_size;
+
+	if( ( size_object != NULL )
+	 && ( size_object != Py_None ) )
+	{
+		if( pyqcow_integer_unsigned_copy_to_64bit(
+		     size_object,
+		     &size,
+		     &error ) != 1 )
+		{
+			pyqcow_error_raise(
+			 error,
+			 PyExc_ValueError,
+			 "%s: unable to convert size into 64-bit unsigned integer.",
+			 function );
+
+			libcerror_error_free(
+			 &error );
+
+			return( NULL );
+		}
+		if( ( offset < end_offset )
+		 && ( size < (uint64_t) ( end_offset - offset ) ) )
+		{
+			end_offset = offset + (off64_t) size;
+		}
+	}
+	return( pyqcow_blocks_new(
+	         pyqcow_file,
+	         (size_t) block_size,
+	         (size_t) batch_size,
+	         offset,
+	         end_offset ) );
+}
+
+#if PY_MAJOR_VERSION >= 3
+
+/* Context of an asynchronous read
+ */
+typedef struct pyqcow_file_read_context pyqcow_file_read_context_t;
+
+struct pyqcow_file_read_context
+{
+	/* The event loop
+	 */
+	PyObject *loop;
+
+	/* The future
+	 */
+	PyObject *future;
+
+	/* The bytes object that receives the data
+	 */
+	PyObject *bytes_object;
+
+	/* The view of the writable buffer object that receives the data
+	 */
+	Py_buffer buffer_view;
+
+	/* Value to indicate the buffer view is set
+	 */
+	int has_buffer_view;
+
+	/* The read request
+	 */
+	libqcow_read_request_t *request;
+
+	/* The status of the read request
+	 */
+	int status;
+
+	/* The read count
+	 */
+	ssize_t read_count;
+};
+
+PyObject *pyqcow_file_read_complete(
+           PyObject *capsule,
+           PyObject *arguments );
+
+PyMethodDef pyqcow_file_read_complete_method = {
+	"read_complete",
+	(PyCFunction) pyqcow_file_read_complete,
+	METH_NOARGS,
+	"read_complete() -> None\n"
+	"\n"
+	"Completes the future of an asynchronous read." };
+
+/* Frees an asynchronous read context
+ */
+void pyqcow_file_read_context_free(
+      pyqcow_file_read_context_t *read_context )
+{
+	if( read_context == NULL )
+	{
+		return;
+	}
+	if( read_context->request != NULL )
+	{
+		Py_BEGIN_ALLOW_THREADS
+
+		libqcow_read_request_free(
+		 &( read_context->request ),
+		 NULL );
+
+		Py_END_ALLOW_THREADS
+	}
+	if( read_context->bytes_object != NULL )
+	{
+		Py_DecRef(
+		 read_context->bytes_object );
+	}
+	if( read_context->has_buffer_view != 0 )
+	{
+		PyBuffer_Release(
+		 &( read_context->buffer_view ) );
+	}
+	if( read_context->future != NULL )
+	{
+		Py_DecRef(
+		 read_context->future );
+	}
+	if( read_context->loop != NULL )
+	{
+		Py_DecRef(
+		 read_context->loop );
+	}
+	PyMem_Free(
+	 read_context );
+}
+
+/* Completes the future of an asynchronous read on the event loop thread
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_complete(
+           PyObject *capsule,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	pyqcow_file_read_context_t *read_context = NULL;
+	PyObject *integer_object                 = NULL;
+	PyObject *method_result                  = NULL;
+	int is_cancelled                         = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	read_context = (pyqcow_file_read_context_t *) PyCapsule_GetPointer(
+	                                               capsule,
+	                                               NULL );
+
+	if( read_context == NULL )
+	{
+		return( NULL );
+	}
+	method_result = PyObject_CallMethod(
+	                 read_context->future,
+	                 "cancelled",
+	                 NULL );
+
+	if( method_result != NULL )
+	{
+		is_cancelled = PyObject_IsTrue(
+		                method_result );
+
+		Py_DecRef(
+		 method_result );
+
+		method_result = NULL;
+	}
+	else
+	{
+		is_cancelled = -1;
+	}
+	if( is_cancelled == 0 )
+	{
+		if( read_context->status != LIBQCOW_READ_REQUEST_STATUS_COMPLETED )
+		{
+			method_result = PyObject_CallMethod(
+			                 read_context->future,
+			                 "set_exception",
+			                 "O",
+			                 PyExc_IOError );
+		}
+		else if( read_context->has_buffer_view != 0 )
+		{
+			integer_object = pyqcow_integer_signed_new_from_64bit(
+			                  (int64_t) read_context->read_count );
+
+			if( integer_object != NULL )
+			{
+				method_result = PyObject_CallMethod(
+				                 read_context->future,
+				                 "set_result",
+				                 "O",
+				                 integer_object );
+
+				Py_DecRef(
+				 integer_object );
+			}
+		}
+		else if( _PyBytes_Resize(
+		          &( read_context->bytes_object ),
+		          (Py_ssize_t) read_context->read_count ) == 0 )
+		{
+			method_result = PyObject_CallMethod(
+			                 read_context->future,
+			                 "set_result",
+			                 "O",
+			                 read_context->bytes_object );
+		}
+	}
+	pyqcow_file_read_context_free(
+	 read_context );
+
+	if( is_cancelled != 0 )
+	{
+		if( is_cancelled == -1 )
+		{
+			return( NULL );
+		}
+	}
+	else if( method_result == NULL )
+	{
+		return( NULL );
+	}
+	else
+	{
+		Py_DecRef(
+		 method_result );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Callback that is invoked when an asynchronous read request finished
+ * The callback can run on a worker thread, therefore completing the future
+ * is scheduled on the event loop thread
+ */
+void pyqcow_file_read_callback(
+      libqcow_read_request_t *request PYQCOW_ATTRIBUTE_UNUSED,
+      int status,
+      ssize_t read_count,
+      void *user_data )
+{
+	pyqcow_file_read_context_t *read_context = NULL;
+	PyObject *capsule                        = NULL;
+	PyObject *function_object                = NULL;
+	PyObject *method_result                  = NULL;
+	PyGILState_STATE gil_state;
+
+	PYQCOW_UNREFERENCED_PARAMETER( request )
+
+	read_context = (pyqcow_file_read_context_t *) user_data;
+
+	if( read_context == NULL )
+	{
+		return;
+	}
+	read_context->status     = status;
+	read_context->read_count = read_count;
+
+	gil_state = PyGILState_Ensure();
+
+	capsule = PyCapsule_New(
+	           (void *) read_context,
+	           NULL,
+	           NULL );
+
+	if( capsule != NULL )
+	{
+		function_object = PyCFunction_New(
+		                   &pyqcow_file_read_complete_method,
+		                   capsule );
+
+		Py_DecRef(
+		 capsule );
+	}
+	if( function_object != NULL )
+	{
+		method_result = PyObject_CallMethod(
+		                 read_context->loop,
+		                 "call_soon_threadsafe",
+		                 "O",
+		                 function_object );
+
+		Py_DecRef(
+		 function_object );
+	}
+	if( method_result == NULL )
+	{
+		/* The future cannot be completed when the event loop is no longer running
+		 */
+		PyErr_Print();
+	}
+	else
+	{
+		Py_DecRef(
+		 method_result );
+	}
+	PyGILState_Release(
+	 gil_state );
+}
+
+/* Reads data at a specific offset asynchronously
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_buffer_at_offset_async(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	pyqcow_file_read_context_t *read_context = NULL;
+	libcerror_error_t *error                 = NULL;
+	libqcow_read_request_t *request          = NULL;
+	PyObject *asyncio_module                 = NULL;
+	PyObject *future                         = NULL;
+	static char *function                    = "pyqcow_file_read_buffer_at_offset_async";
+	static char *keyword_list[]              = { "size", "offset", NULL };
+	char *buffer                             = NULL;
+	off64_t read_offset                      = 0;
+	int read_size                            = 0;
+	int result                               = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "i|L",
+	     keyword_list,
+	     &read_size,
+	     &read_offset ) == 0 )
+	{
+		return( NULL );
+	}
+	if( read_size < 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument read size value less than zero.",
+		 function );
+
+		return( NULL );
+	}
+	if( read_offset < 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument read offset value less than zero.",
+		 function );
+
+		return( NULL );
+	}
+	read_context = (pyqcow_file_read_context_t *) PyMem_Malloc(
+	                                               sizeof( pyqcow_file_read_context_t ) );
+
+	if( read_context == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to create read context.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     read_context,
+	     0,
+	     sizeof( pyqcow_file_read_context_t ) ) == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to clear read context.",
+		 function );
+
+		PyMem_Free(
+		 read_context );
+
+		return( NULL );
+	}
+	asyncio_module = PyImport_ImportModule(
+	                  "asyncio" );
+
+	if( asyncio_module == NULL )
+	{
+		goto on_error;
+	}
+	read_context->loop = PyObject_CallMethod(
+	                      asyncio_module,
+	                      "get_running_loop",
+	                      NULL );
+
+	Py_DecRef(
+	 asyncio_module );
+
+	if( read_context->loop == NULL )
+	{
+		goto on_error;
+	}
+	read_context->future = PyObject_CallMethod(
+	                        read_context->loop,
+	                        "create_future",
+	                        NULL );
+
+	if( read_context->future == NULL )
+	{
+		goto on_error;
+	}
+	read_context->bytes_object = PyBytes_FromStringAndSize(
+	                              NULL,
+	                              read_size );
+
+	if( read_context->bytes_object == NULL )
+	{
+		goto on_error;
+	}
+	buffer = PyBytes_AsString(
+	          read_context->bytes_object );
+
+	/* The context is freed by the completion function, hence keep
+	 * a reference to the future for the caller
+	 */
+	future = read_context->future;
+
+	Py_IncRef(
+	 future );
+
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_read_async(
+	          pyqcow_file->file,
+	          (uint8_t *) buffer,
+	          (size_t) read_size,
+	          (off64_t) read_offset,
+	          &pyqcow_file_read_callback,
+	          (void *) read_context,
+	          &request,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read data asynchronously.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		Py_DecRef(
+		 future );
+
+		goto on_error;
+	}
+	/* The completion function runs on the event loop thread, which is this
+	 * thread, so it cannot run before the request is stored in the context
+	 */
+	read_context->request = request;
+
+	return( future );
+
+on_error:
+	if( read_context != NULL )
+	{
+		pyqcow_file_read_context_free(
+		 read_context );
+	}
+	return( NULL );
+}
+
+/* Reads data at a specific offset into a writable buffer object asynchronously
+ * The buffer object cannot be resized until the read has finished
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_buffer_at_offset_into_async(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	pyqcow_file_read_context_t *read_context = NULL;
+	libcerror_error_t *error                 = NULL;
+	libqcow_read_request_t *request          = NULL;
+	PyObject *asyncio_module                 = NULL;
+	PyObject *buffer_object                  = NULL;
+	PyObject *future                         = NULL;
+	static char *function                    = "pyqcow_file_read_buffer_at_offset_into_async";
+	static char *keyword_list[]              = { "buffer", "offset", NULL };
+	off64_t read_offset                      = 0;
+	int result                               = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "OL",
+	     keyword_list,
+	     &buffer_object,
+	     &read_offset ) == 0 )
+	{
+		return( NULL );
+	}
+	if( read_offset < 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument read offset value less than zero.",
+		 function );
+
+		return( NULL );
+	}
+	read_context = (pyqcow_file_read_context_t *) PyMem_Malloc(
+	                                               sizeof( pyqcow_file_read_context_t ) );
+
+	if( read_context == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to create read context.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     read_context,
+	     0,
+	     sizeof( pyqcow_file_read_context_t ) ) == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to clear read context.",
+		 function );
+
+		PyMem_Free(
+		 read_context );
+
+		return( NULL );
+	}
+	if( PyObject_GetBuffer(
+	     buffer_object,
+	     &( read_context->buffer_view ),
+	     PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+	{
+		goto on_error;
+	}
+	read_context->has_buffer_view = 1;
+
+	asyncio_module = PyImport_ImportModule(
+	                  "asyncio" );
+
+	if( asyncio_module == NULL )
+	{
+		goto on_error;
+	}
+	read_context->loop = PyObject_CallMethod(
+	                      asyncio_module,
+	                      "get_running_loop",
+	                      NULL );
+
+	Py_DecRef(
+	 asyncio_module );
+
+	if( read_context->loop == NULL )
+	{
+		goto on_error;
+	}
+	read_context->future = PyObject_CallMethod(
+	                        read_context->loop,
+	                        "create_future",
+	                        NULL );
+
+	if( read_context->future == NULL )
+	{
+		goto on_error;
+	}
+	/* The context is freed by the completion function, hence keep
+	 * a reference to the future for the caller
+	 */
+	future = read_context->future;
+
+	Py_IncRef(
+	 future );
+
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_read_async(
+	          pyqcow_file->file,
+	          (uint8_t *) read_context->buffer_view.buf,
+	          (size_t) read_context->buffer_view.len,
+	          (off64_t) read_offset,
+	          &pyqcow_file_read_callback,
+	          (void *) read_context,
+	          &request,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read data asynchronously.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		Py_DecRef(
+		 future );
+
+		goto on_error;
+	}
+	/* The completion function runs on the event loop thread, which is this
+	 * thread, so it cannot run before the request is stored in the context
+	 */
+	read_context->request = request;
+
+	return( future );
+
+on_error:
+	if( read_context != NULL )
+	{
+		pyqcow_file_read_context_free(
+		 read_context );
+	}
+	return( NULL );
+}
+
+#endif /* PY_MAJOR_VERSION >= 3 */
+
+/* Seeks a certain offset in the data
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_seek_offset(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	static char *function       = "pyqcow_file_seek_offset";
+	static char *keyword_list[] = { "offset", "whence", NULL };
+	off64_t offset              = 0;
+	int whence                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "L|i",
+	     keyword_list,
+	     &offset,
+	     &whence ) == 0 )
+	{
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	offset = libqcow_file_seek_offset(
+	          pyqcow_file->file,
+	          offset,
+	          whence,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+ 	if( offset == -1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to seek offset.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Retrieves the current offset in the data
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_offset(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	PyObject *integer_object = NULL;
+	static char *function    = "pyqcow_file_get_offset";
+	off64_t current_offset   = 0;
+	int result               = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_offset(
+	          pyqcow_file->file,
+	          &current_offset,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to retrieve offset.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	integer_object = pyqcow_integer_signed_new_from_64bit(
+	                  (int64_t) current_offset );
+
+	return( integer_object );
+}
+
+/* Retrieves the media size
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_media_size(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	PyObject *integer_object = NULL;
+	static char *function    = "pyqcow_file_get_media_size";
+	size64_t media_size      = 0;
+	int result               = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: failed to retrieve media size.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	integer_object = pyqcow_integer_unsigned_new_from_64bit(
+	                  (uint64_t) media_size );
+
+	return( integer_object );
+}
+
+/* Retrieves an extents iterator
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_extents(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	PyObject *size_object       = NULL;
+	static char *function       = "pyqcow_file_extents";
+	static char *keyword_list[] = { "offset", "size", NULL };
+	size64_t media_size         = 0;
+	uint64_t size               = 0;
+	off64_t end_offset          = 0;
+	off64_t offset              = 0;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "|LO",
+	     keyword_list,
+	     &offset,
+	     &size_object ) == 0 )
+	{
+		return( NULL );
+	}
+	if( offset < 0 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid argument offset value less than zero.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_media_size(
+	          pyqcow_file->file,
+	          &media_size,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: failed to retrieve media size.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	end_offset = (off64_t) media_size;
+
+	if( ( size_object != NULL )
+	 && ( size_object != Py_None ) )
+	{
+		if( pyqcow_integer_unsigned_copy_to_64bit(
+		     size_object,
+		     &size,
+		     &error ) != 1 )
+		{
+			pyqcow_error_raise(
+			 error,
+			 PyExc_ValueError,
+			 "%s: unable to convert size into 64-bit unsigned integer.",
+			 function );
+
+			libcerror_error_free(
+			 &error );
+
+			return( NULL );
+		}
+		if( ( offset < end_offset )
+		 && ( size < (uint64_t) ( end_offset - offset ) ) )
+		{
+			end_offset = offset + (off64_t) size;
+		}
+	}
+	return( pyqcow_extents_new(
+	         pyqcow_file,
+	         offset,
+	         end_offset ) );
+}
+
+/* Sets the password
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_set_password(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error      = NULL;
+	char *password_string         = NULL;
+	static char *keyword_list[]   = { "password", NULL };
+	static char *function         = "pyqcow_file_set_password";
+	size_t password_string_length = 0;
+	int result                    = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "s",
+	     keyword_list,
+	     &password_string ) == 0 )
+	{
+		return( NULL );
+	}
+	if( password_string == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid password string.",
+		 function );
+
+		return( NULL );
+	}
+	password_string_length = narrow_string_length(
+	                          password_string );
+
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_set_utf8_password(
+	          pyqcow_file->file,
+	          (uint8_t *) password_string,
+	          password_string_length,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to set password.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	/* The password is retained to reopen the file from a pickled state
+	 */
+	Py_DecRef(
+	 pyqcow_file->password_object );
+
+	pyqcow_file->password_object = Py_BuildValue(
+	                                "s",
+	                                password_string );
+
+	if( pyqcow_file->password_object == NULL )
+	{
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Sets the cache limits
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_set_cache_limits(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error             = NULL;
+	static char *keyword_list[]          = { "maximum_number_of_level2_tables", "maximum_number_of_cluster_blocks", NULL };
+	static char *function                = "pyqcow_file_set_cache_limits";
+	int maximum_number_of_cluster_blocks = 0;
+	int maximum_number_of_level2_tables  = 0;
+	int result                           = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "ii",
+	     keyword_list,
+	     &maximum_number_of_level2_tables,
+	     &maximum_number_of_cluster_blocks ) == 0 )
+	{
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_set_cache_limits(
+	          pyqcow_file->file,
+	          maximum_number_of_level2_tables,
+	          maximum_number_of_cluster_blocks,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to set cache limits.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Retrieves the memory usage of the caches
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_cache_memory_usage(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	PyObject *integer_object = NULL;
+	static char *function    = "pyqcow_file_get_cache_memory_usage";
+	size64_t memory_usage    = 0;
+	int result               = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_cache_memory_usage(
+	          pyqcow_file->file,
+	          &memory_usage,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: failed to retrieve cache memory usage.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	integer_object = pyqcow_integer_unsigned_new_from_64bit(
+	                  (uint64_t) memory_usage );
+
+	return( integer_object );
+}
+
+/* Drops the caches
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_drop_caches(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	static char *keyword_list[] = { "flags", NULL };
+	static char *function       = "pyqcow_file_drop_caches";
+	int flags                   = LIBQCOW_CACHE_FLAG_ALL;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "|i",
+	     keyword_list,
+	     &flags ) == 0 )
+	{
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_drop_caches(
+	          pyqcow_file->file,
+	          flags,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to drop caches.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Retrieves the read statistics
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_statistics(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	uint64_t values[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	const char *value_names[ LIBQCOW_NUMBER_OF_STATISTICS ] = {
+		"level2_table_cache_hits",
+		"level2_table_cache_misses",
+		"cluster_block_cache_hits",
+		"cluster_block_cache_misses",
+		"compressed_cluster_block_cache_hits",
+		"compressed_cluster_block_cache_misses",
+		"number_of_host_reads",
+		"host_bytes_read",
+		"bytes_returned",
+		"sparse_bytes",
+		"number_of_decompressions",
+		"decompression_time",
+		"number_of_decryptions",
+		"decryption_time" };
+
+	libcerror_error_t *error    = NULL;
+	PyObject *dictionary_object = NULL;
+	PyObject *integer_object    = NULL;
+	static char *function       = "pyqcow_file_get_statistics";
+	int result                  = 0;
+	int value_index             = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_statistics(
+	          pyqcow_file->file,
+	          values,
+	          LIBQCOW_NUMBER_OF_STATISTICS,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: failed to retrieve statistics.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	dictionary_object = PyDict_New();
+
+	if( dictionary_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_MemoryError,
+		 "%s: unable to create dictionary object.",
+		 function );
+
+		return( NULL );
+	}
+	for( value_index = 0;
+	     value_index < LIBQCOW_NUMBER_OF_STATISTICS;
+	     value_index++ )
+	{
+		integer_object = pyqcow_integer_unsigned_new_from_64bit(
+		                  values[ value_index ] );
+
+		if( integer_object == NULL )
+		{
+			goto on_error;
+		}
+		if( PyDict_SetItemString(
+		     dictionary_object,
+		     value_names[ value_index ],
+		     integer_object ) != 0 )
+		{
+			PyErr_Format(
+			 PyExc_MemoryError,
+			 "%s: unable to set statistic: %s in dictionary object.",
+			 function,
+			 value_names[ value_index ] );
+
+			goto on_error;
+		}
+		/* PyDict_SetItemString does not steal the reference
+		 */
+		Py_DecRef(
+		 integer_object );
+
+		integer_object = NULL;
+	}
+	return( dictionary_object );
+
+on_error:
+	if( integer_object != NULL )
+	{
+		Py_DecRef(
+		 integer_object );
+	}
+	Py_DecRef(
+	 dictionary_object );
+
+	return( NULL );
+}
+
+/* Resets the read statistics
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_reset_statistics(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "pyqcow_file_reset_statistics";
+	int result               = 0;
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_reset_statistics(
+	          pyqcow_file->file,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to reset statistics.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Enables or disables the latency histograms
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_enable_latency_histograms(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	static char *function       = "pyqcow_file_enable_latency_histograms";
+	static char *keyword_list[] = { "enabled", NULL };
+	int enabled                 = 1;
+	int read_flags              = 0;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "|i",
+	     keyword_list,
+	     &enabled ) == 0 )
+	{
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_read_flags(
+	          pyqcow_file->file,
+	          &read_flags,
+	          &error );
+
+	if( result == 1 )
+	{
+		if( enabled != 0 )
+		{
+			read_flags |= LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS;
+		}
+		else
+		{
+			read_flags &= ~( LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS );
+		}
+		result = libqcow_file_set_read_flags(
+		          pyqcow_file->file,
+		          read_flags,
+		          &error );
+	}
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to set read flags.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	Py_IncRef(
+	 Py_None );
+
+	return( Py_None );
+}
+
+/* Determines the latency operation from its name
+ * Returns 1 if successful or 0 if the name is not supported
+ */
+int pyqcow_file_get_latency_operation(
+     const char *operation_name,
+     int *operation )
+{
+	const char *operation_names[ LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ] = {
+		"read_buffer",
+		"level2_table_read",
+		"cluster_block_read",
+		"decompress",
+		"decrypt" };
+
+	size_t operation_name_length = 0;
+	int operation_index          = 0;
+
+	if( ( operation_name == NULL )
+	 || ( operation == NULL ) )
+	{
+		return( 0 );
+	}
+	operation_name_length = narrow_string_length(
+	                         operation_name );
+
+	for( operation_index = 0;
+	     operation_index < LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS;
+	     operation_index++ )
+	{
+		if( ( operation_name_length == narrow_string_length( operation_names[ operation_index ] ) )
+		 && ( narrow_string_compare(
+		       operation_name,
+		       operation_names[ operation_index ],
+		       operation_name_length ) == 0 ) )
+		{
+			*operation = operation_index;
+
+			return( 1 );
+		}
+	}
+	return( 0 );
+}
+
+/* Retrieves the latency histogram of an operation
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_latency_histogram(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	uint64_t counts[ LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ];
+
+	libcerror_error_t *error    = NULL;
+	PyObject *integer_object    = NULL;
+	PyObject *list_object       = NULL;
+	PyObject *tuple_object      = NULL;
+	static char *function       = "pyqcow_file_get_latency_histogram";
+	static char *keyword_list[] = { "operation", NULL };
+	char *operation_name        = NULL;
+	uint64_t lower_bound        = 0;
+	uint64_t upper_bound        = 0;
+	int bucket_index            = 0;
+	int operation               = 0;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "s",
+	     keyword_list,
+	     &operation_name ) == 0 )
+	{
+		return( NULL );
+	}
+	if( pyqcow_file_get_latency_operation(
+	     operation_name,
+	     &operation ) != 1 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: unsupported operation: %s.",
+		 function,
+		 operation_name );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_latency_histogram(
+	          pyqcow_file->file,
+	          operation,
+	          counts,
+	          LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
 		 error,
 		 PyExc_IOError,
-		 "%s: unable to set password.",
+		 "%s: unable to retrieve latency histogram.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	list_object = PyList_New(
+	               0 );
+
+	if( list_object == NULL )
+	{
+		goto on_error;
+	}
+	for( bucket_index = 0;
+	     bucket_index < LIBQCOW_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+	     bucket_index++ )
+	{
+		if( counts[ bucket_index ] == 0 )
+		{
+			continue;
+		}
+		if( libqcow_get_latency_histogram_bucket_bounds(
+		     bucket_index,
+		     &lower_bound,
+		     &upper_bound,
+		     &error ) != 1 )
+		{
+			pyqcow_error_raise(
+			 error,
+			 PyExc_IOError,
+			 "%s: unable to retrieve bucket: %d bounds.",
+			 function,
+			 bucket_index );
+
+			libcerror_error_free(
+			 &error );
+
+			goto on_error;
+		}
+		tuple_object = PyTuple_New(
+		                3 );
+
+		if( tuple_object == NULL )
+		{
+			goto on_error;
+		}
+		integer_object = pyqcow_integer_unsigned_new_from_64bit(
+		                  lower_bound );
+
+		if( integer_object == NULL )
+		{
+			goto on_error;
+		}
+		/* Note that PyTuple_SetItem steals the reference to the integer object
+		 */
+		if( PyTuple_SetItem(
+		     tuple_object,
+		     0,
+		     integer_object ) != 0 )
+		{
+			goto on_error;
+		}
+		integer_object = pyqcow_integer_unsigned_new_from_64bit(
+		                  upper_bound );
+
+		if( integer_object == NULL )
+		{
+			goto on_error;
+		}
+		if( PyTuple_SetItem(
+		     tuple_object,
+		     1,
+		     integer_object ) != 0 )
+		{
+			goto on_error;
+		}
+		integer_object = pyqcow_integer_unsigned_new_from_64bit(
+		                  counts[ bucket_index ] );
+
+		if( integer_object == NULL )
+		{
+			goto on_error;
+		}
+		if( PyTuple_SetItem(
+		     tuple_object,
+		     2,
+		     integer_object ) != 0 )
+		{
+			goto on_error;
+		}
+		if( PyList_Append(
+		     list_object,
+		     tuple_object ) != 0 )
+		{
+			goto on_error;
+		}
+		/* PyList_Append does not steal the reference
+		 */
+		Py_DecRef(
+		 tuple_object );
+
+		tuple_object = NULL;
+	}
+	return( list_object );
+
+on_error:
+	if( tuple_object != NULL )
+	{
+		Py_DecRef(
+		 tuple_object );
+	}
+	if( list_object != NULL )
+	{
+		Py_DecRef(
+		 list_object );
+	}
+	return( NULL );
+}
+
+/* Retrieves a latency percentile of an operation
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_get_latency_percentile(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	static char *function       = "pyqcow_file_get_latency_percentile";
+	static char *keyword_list[] = { "operation", "percentile", NULL };
+	char *operation_name        = NULL;
+	double percentile           = 0.0;
+	uint64_t latency            = 0;
+	uint64_t number_of_values   = 0;
+	int operation               = 0;
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "sd",
+	     keyword_list,
+	     &operation_name,
+	     &percentile ) == 0 )
+	{
+		return( NULL );
+	}
+	if( pyqcow_file_get_latency_operation(
+	     operation_name,
+	     &operation ) != 1 )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: unsupported operation: %s.",
+		 function,
+		 operation_name );
+
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_get_latency_percentile(
+	          pyqcow_file->file,
+	          operation,
+	          percentile,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result != 1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to retrieve latency percentile.",
+		 function );
+
+		libcerror_error_free(
+		 &error );
+
+		return( NULL );
+	}
+	return( pyqcow_integer_unsigned_new_from_64bit(
+	         latency ) );
+}
+
+/* Reads the metadata index from a metadata index (sidecar) file
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_read_metadata_index(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords )
+{
+	libcerror_error_t *error    = NULL;
+	char *filename              = NULL;
+	static char *keyword_list[] = { "filename", NULL };
+	static char *function       = "pyqcow_file_read_metadata_index";
+	int result                  = 0;
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTupleAndKeywords(
+	     arguments,
+	     keywords,
+	     "s",
+	     keyword_list,
+	     &filename ) == 0 )
+	{
+		return( NULL );
+	}
+	Py_BEGIN_ALLOW_THREADS
+
+	result = libqcow_file_read_metadata_index(
+	          pyqcow_file->file,
+	          filename,
+	          &error );
+
+	Py_END_ALLOW_THREADS
+
+	if( result == -1 )
+	{
+		pyqcow_error_raise(
+		 error,
+		 PyExc_IOError,
+		 "%s: unable to read metadata index.",
 		 function );
 
 		libcerror_error_free(
@@ -1360,6 +4313,195 @@ PyObject *pyqcow_file_set_password(
 
 		return( NULL );
 	}
+	else if( result == 0 )
+	{
+		Py_IncRef(
+		 (PyObject *) Py_False );
+
+		return( Py_False );
+	}
+	/* The metadata index filename is retained so that a pickled state
+	 * reopens the file without reading the level 2 tables again
+	 */
+	Py_DecRef(
+	 pyqcow_file->metadata_index_filename_object );
+
+	pyqcow_file->metadata_index_filename_object = Py_BuildValue(
+	                                               "s",
+	                                               filename );
+
+	if( pyqcow_file->metadata_index_filename_object == NULL )
+	{
+		return( NULL );
+	}
+	Py_IncRef(
+	 (PyObject *) Py_True );
+
+	return( Py_True );
+}
+
+/* Retrieves the pickle state of the file
+ * The state consists of the filename, the password and the metadata index filename
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_reduce(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments PYQCOW_ATTRIBUTE_UNUSED )
+{
+	PyObject *metadata_index_filename_object = NULL;
+	PyObject *password_object                = NULL;
+	static char *function                    = "pyqcow_file_reduce";
+
+	PYQCOW_UNREFERENCED_PARAMETER( arguments )
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( pyqcow_file->filename_object == NULL )
+	{
+		PyErr_Format(
+		 PyExc_TypeError,
+		 "%s: unable to pickle file that was not opened by filename.",
+		 function );
+
+		return( NULL );
+	}
+	password_object = pyqcow_file->password_object;
+
+	if( password_object == NULL )
+	{
+		password_object = Py_None;
+	}
+	metadata_index_filename_object = pyqcow_file->metadata_index_filename_object;
+
+	if( metadata_index_filename_object == NULL )
+	{
+		metadata_index_filename_object = Py_None;
+	}
+	return( Py_BuildValue(
+	         "(O()(OOO))",
+	         (PyObject *) Py_TYPE( pyqcow_file ),
+	         pyqcow_file->filename_object,
+	         password_object,
+	         metadata_index_filename_object ) );
+}
+
+/* Reopens the file from a pickle state
+ * Returns a Python object if successful or NULL on error
+ */
+PyObject *pyqcow_file_set_state(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *state_object )
+{
+	PyObject *arguments                      = NULL;
+	PyObject *filename_object                = NULL;
+	PyObject *metadata_index_filename_object = NULL;
+	PyObject *password_object                = NULL;
+	PyObject *result_object                  = NULL;
+	static char *function                    = "pyqcow_file_set_state";
+
+	if( pyqcow_file == NULL )
+	{
+		PyErr_Format(
+		 PyExc_ValueError,
+		 "%s: invalid file.",
+		 function );
+
+		return( NULL );
+	}
+	if( PyArg_ParseTuple(
+	     state_object,
+	     "OOO",
+	     &filename_object,
+	     &password_object,
+	     &metadata_index_filename_object ) == 0 )
+	{
+		return( NULL );
+	}
+	/* The password needs to be set before the file is opened
+	 */
+	if( password_object != Py_None )
+	{
+		arguments = PyTuple_Pack(
+		             1,
+		             password_object );
+
+		if( arguments == NULL )
+		{
+			return( NULL );
+		}
+		result_object = pyqcow_file_set_password(
+		                 pyqcow_file,
+		                 arguments,
+		                 NULL );
+
+		Py_DecRef(
+		 arguments );
+
+		if( result_object == NULL )
+		{
+			return( NULL );
+		}
+		Py_DecRef(
+		 result_object );
+	}
+	arguments = PyTuple_Pack(
+	             1,
+	             filename_object );
+
+	if( arguments == NULL )
+	{
+		return( NULL );
+	}
+	result_object = pyqcow_file_open(
+	                 pyqcow_file,
+	                 arguments,
+	                 NULL );
+
+	Py_DecRef(
+	 arguments );
+
+	if( result_object == NULL )
+	{
+		return( NULL );
+	}
+	Py_DecRef(
+	 result_object );
+
+	/* A metadata index file that no longer matches the file is ignored
+	 * and the level 2 tables are read on demand instead
+	 */
+	if( metadata_index_filename_object != Py_None )
+	{
+		arguments = PyTuple_Pack(
+		             1,
+		             metadata_index_filename_object );
+
+		if( arguments == NULL )
+		{
+			return( NULL );
+		}
+		result_object = pyqcow_file_read_metadata_index(
+		                 pyqcow_file,
+		                 arguments,
+		                 NULL );
+
+		Py_DecRef(
+		 arguments );
+
+		if( result_object == NULL )
+		{
+			return( NULL );
+		}
+		Py_DecRef(
+		 result_object );
+	}
 	Py_IncRef(
 	 Py_None );
 
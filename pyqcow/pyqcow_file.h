@@ -48,6 +48,18 @@ struct pyqcow_file
 	/* The libbfio file IO handle
 	 */
 	libbfio_handle_t *file_io_handle;
+
+	/* The filename object the file was opened with
+	 */
+	PyObject *filename_object;
+
+	/* The password object
+	 */
+	PyObject *password_object;
+
+	/* The metadata index filename object
+	 */
+	PyObject *metadata_index_filename_object;
 };
 
 extern PyMethodDef pyqcow_file_object_methods[];
@@ -95,11 +107,53 @@ PyObject *pyqcow_file_read_buffer(
            PyObject *arguments,
            PyObject *keywords );
 
+PyObject *pyqcow_file_read_buffer_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
 PyObject *pyqcow_file_read_buffer_at_offset(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments,
            PyObject *keywords );
 
+PyObject *pyqcow_file_read_buffer_at_offset_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_read_many(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_read_many_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_read_blocks_into(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_blocks(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+#if PY_MAJOR_VERSION >= 3
+PyObject *pyqcow_file_read_buffer_at_offset_async(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_read_buffer_at_offset_into_async(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+#endif
+
 PyObject *pyqcow_file_seek_offset(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments,
@@ -113,11 +167,70 @@ PyObject *pyqcow_file_get_media_size(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments );
 
+PyObject *pyqcow_file_extents(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
 PyObject *pyqcow_file_set_password(
            pyqcow_file_t *pyqcow_file,
            PyObject *arguments,
            PyObject *keywords );
 
+PyObject *pyqcow_file_set_cache_limits(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_get_cache_memory_usage(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments );
+
+PyObject *pyqcow_file_drop_caches(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_get_statistics(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments );
+
+PyObject *pyqcow_file_reset_statistics(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments );
+
+PyObject *pyqcow_file_enable_latency_histograms(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+int pyqcow_file_get_latency_operation(
+     const char *operation_name,
+     int *operation );
+
+PyObject *pyqcow_file_get_latency_histogram(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_get_latency_percentile(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_read_metadata_index(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments,
+           PyObject *keywords );
+
+PyObject *pyqcow_file_reduce(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *arguments );
+
+PyObject *pyqcow_file_set_state(
+           pyqcow_file_t *pyqcow_file,
+           PyObject *state_object );
+
 #if defined( __cplusplus )
 }
 #endif
@@ -102,7 +102,8 @@ int pyqcow_file_object_io_handle_initialize(
 
 		goto on_error;
 	}
-	( *file_object_io_handle )->file_object = file_object;
+	( *file_object_io_handle )->file_object         = file_object;
+	( *file_object_io_handle )->has_readinto_method = -1;
 
 	Py_IncRef(
 	 ( *file_object_io_handle )->file_object );
@@ -232,6 +233,11 @@ int pyqcow_file_object_io_handle_free(
 		Py_DecRef(
 		 ( *file_object_io_handle )->file_object );
 
+		if( ( *file_object_io_handle )->read_ahead_buffer != NULL )
+		{
+			PyMem_Free(
+			 ( *file_object_io_handle )->read_ahead_buffer );
+		}
 		PyGILState_Release(
 		 gil_state );
 
@@ -317,7 +323,10 @@ int pyqcow_file_object_io_handle_open(
      int access_flags,
      libcerror_error_t **error )
 {
-	static char *function = "pyqcow_file_object_io_handle_open";
+	static char *function      = "pyqcow_file_object_io_handle_open";
+	PyGILState_STATE gil_state = 0;
+	off64_t current_offset     = 0;
+	int result                 = 0;
 
 	if( file_object_io_handle == NULL )
 	{
@@ -364,9 +373,34 @@ int pyqcow_file_object_io_handle_open(
 
 		return( -1 );
 	}
-	/* No need to do anything here, because the file object is already open
+	/* No need to open the file object, because it is already open
+	 * but the current offset is tracked by the file object IO handle
 	 */
-	file_object_io_handle->access_flags = access_flags;
+	gil_state = PyGILState_Ensure();
+
+	result = pyqcow_file_object_get_offset(
+	          file_object_io_handle->file_object,
+	          &current_offset,
+	          error );
+
+	PyGILState_Release(
+	 gil_state );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve current offset in file object.",
+		 function );
+
+		return( -1 );
+	}
+	file_object_io_handle->access_flags         = access_flags;
+	file_object_io_handle->current_offset       = current_offset;
+	file_object_io_handle->read_ahead_offset    = 0;
+	file_object_io_handle->read_ahead_data_size = 0;
 
 	return( 1 );
 }
@@ -404,7 +438,8 @@ int pyqcow_file_object_io_handle_close(
 	}
 	/* Do not close the file object, have Python deal with it
 	 */
-	file_object_io_handle->access_flags = 0;
+	file_object_io_handle->access_flags         = 0;
+	file_object_io_handle->read_ahead_data_size = 0;
 
 	return( 0 );
 }
@@ -613,7 +648,199 @@ on_error:
 	return( -1 );
 }
 
+/* Reads a buffer from the file object using its readinto method
+ * This function reads directly into the buffer without creating an intermediate binary string object
+ * Make sure to hold the GIL state before calling this function
+ * Returns the number of bytes read if successful, or -1 on error
+ */
+ssize_t pyqcow_file_object_read_buffer_into(
+         PyObject *file_object,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error )
+{
+	PyObject *argument_buffer = NULL;
+	PyObject *method_name     = NULL;
+	PyObject *method_result   = NULL;
+	static char *function     = "pyqcow_file_object_read_buffer_into";
+	int64_t read_count        = 0;
+
+	if( file_object == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file object.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
+
+		return( -1 );
+	}
+#if SIZEOF_SIZE_T > SIZEOF_INT
+	if( size > (size_t) INT_MAX )
+#else
+	if( size > (size_t) SSIZE_MAX )
+#endif
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( size > 0 )
+	{
+#if PY_MAJOR_VERSION >= 3
+		method_name = PyUnicode_FromString(
+			       "readinto" );
+
+		argument_buffer = PyMemoryView_FromMemory(
+		                   (char *) buffer,
+		                   (Py_ssize_t) size,
+		                   PyBUF_WRITE );
+#else
+		method_name = PyString_FromString(
+			       "readinto" );
+
+		argument_buffer = PyBuffer_FromReadWriteMemory(
+		                   (void *) buffer,
+		                   (Py_ssize_t) size );
+#endif
+		if( argument_buffer == NULL )
+		{
+			pyqcow_error_fetch(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create buffer argument.",
+			 function );
+
+			goto on_error;
+		}
+		PyErr_Clear();
+
+		method_result = PyObject_CallMethodObjArgs(
+				 file_object,
+				 method_name,
+				 argument_buffer,
+				 NULL );
+
+		if( PyErr_Occurred() )
+		{
+			pyqcow_error_fetch(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read from file object.",
+			 function );
+
+			goto on_error;
+		}
+		if( ( method_result == NULL )
+		 || ( method_result == Py_None ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: missing method result.",
+			 function );
+
+			goto on_error;
+		}
+		if( pyqcow_integer_signed_copy_to_64bit(
+		     method_result,
+		     &read_count,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to convert method result into read count.",
+			 function );
+
+			goto on_error;
+		}
+		if( ( read_count < 0 )
+		 || ( read_count > (int64_t) size ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid read count value out of bounds.",
+			 function );
+
+			goto on_error;
+		}
+#if PY_MAJOR_VERSION >= 3
+		/* Release the memory view so that the buffer cannot be accessed
+		 * by a reference to the memory view the file object might keep
+		 */
+		Py_DecRef(
+		 method_result );
+
+		method_result = PyObject_CallMethod(
+		                 argument_buffer,
+		                 "release",
+		                 NULL );
+
+		PyErr_Clear();
+
+		if( method_result != NULL )
+		{
+			Py_DecRef(
+			 method_result );
+		}
+#else
+		Py_DecRef(
+		 method_result );
+#endif
+		Py_DecRef(
+		 argument_buffer );
+
+		Py_DecRef(
+		 method_name );
+	}
+	return( (ssize_t) read_count );
+
+on_error:
+	if( method_result != NULL )
+	{
+		Py_DecRef(
+		 method_result );
+	}
+	if( argument_buffer != NULL )
+	{
+		Py_DecRef(
+		 argument_buffer );
+	}
+	if( method_name != NULL )
+	{
+		Py_DecRef(
+		 method_name );
+	}
+	return( -1 );
+}
+
 /* Reads a buffer from the file object IO handle
+ * Small reads are served from a read-ahead buffer, so that reading consecutive
+ * small ranges, such as the metadata, does not require a Python call per read
  * Returns the number of bytes read if successful, or -1 on error
  */
 ssize_t pyqcow_file_object_io_handle_read(
@@ -622,8 +849,12 @@ ssize_t pyqcow_file_object_io_handle_read(
          size_t size,
          libcerror_error_t **error )
 {
+	uint8_t *read_buffer       = NULL;
 	static char *function      = "pyqcow_file_object_io_handle_read";
 	PyGILState_STATE gil_state = 0;
+	size_t buffer_offset       = 0;
+	size_t read_ahead_index    = 0;
+	size_t read_size           = 0;
 	ssize_t read_count         = 0;
 
 	if( file_object_io_handle == NULL )
@@ -637,29 +868,162 @@ ssize_t pyqcow_file_object_io_handle_read(
 
 		return( -1 );
 	}
-	gil_state = PyGILState_Ensure();
-
-	read_count = pyqcow_file_object_read_buffer(
-	              file_object_io_handle->file_object,
-	              buffer,
-	              size,
-	              error );
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer.",
+		 function );
 
-	if( read_count == -1 )
+		return( -1 );
+	}
+	if( size > (size_t) SSIZE_MAX )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read from file object.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
 		 function );
 
-		goto on_error;
+		return( -1 );
+	}
+	gil_state = PyGILState_Ensure();
+
+	if( file_object_io_handle->has_readinto_method == -1 )
+	{
+		file_object_io_handle->has_readinto_method = PyObject_HasAttrString(
+		                                              file_object_io_handle->file_object,
+		                                              "readinto" );
+	}
+	while( buffer_offset < size )
+	{
+		if( ( file_object_io_handle->read_ahead_data_size > 0 )
+		 && ( file_object_io_handle->current_offset >= file_object_io_handle->read_ahead_offset )
+		 && ( file_object_io_handle->current_offset < ( file_object_io_handle->read_ahead_offset + (off64_t) file_object_io_handle->read_ahead_data_size ) ) )
+		{
+			read_ahead_index = (size_t) ( file_object_io_handle->current_offset - file_object_io_handle->read_ahead_offset );
+			read_size        = file_object_io_handle->read_ahead_data_size - read_ahead_index;
+
+			if( read_size > ( size - buffer_offset ) )
+			{
+				read_size = size - buffer_offset;
+			}
+			if( memory_copy(
+			     &( buffer[ buffer_offset ] ),
+			     &( file_object_io_handle->read_ahead_buffer[ read_ahead_index ] ),
+			     read_size ) == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+				 "%s: unable to copy read-ahead data to buffer.",
+				 function );
+
+				goto on_error;
+			}
+			file_object_io_handle->current_offset += (off64_t) read_size;
+			buffer_offset                         += read_size;
+
+			continue;
+		}
+		/* The file object can be shared by cloned file object IO handles
+		 * hence the offset is always set before reading from it
+		 */
+		if( pyqcow_file_object_seek_offset(
+		     file_object_io_handle->file_object,
+		     file_object_io_handle->current_offset,
+		     SEEK_SET,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_SEEK_FAILED,
+			 "%s: unable to seek in file object.",
+			 function );
+
+			goto on_error;
+		}
+		read_size = size - buffer_offset;
+
+		if( read_size >= PYQCOW_FILE_OBJECT_IO_HANDLE_READ_AHEAD_SIZE )
+		{
+			read_buffer = &( buffer[ buffer_offset ] );
+		}
+		else
+		{
+			if( file_object_io_handle->read_ahead_buffer == NULL )
+			{
+				file_object_io_handle->read_ahead_buffer = (uint8_t *) PyMem_Malloc(
+				                                                        sizeof( uint8_t ) * PYQCOW_FILE_OBJECT_IO_HANDLE_READ_AHEAD_SIZE );
+
+				if( file_object_io_handle->read_ahead_buffer == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+					 "%s: unable to create read-ahead buffer.",
+					 function );
+
+					goto on_error;
+				}
+			}
+			file_object_io_handle->read_ahead_offset    = file_object_io_handle->current_offset;
+			file_object_io_handle->read_ahead_data_size = 0;
+
+			read_buffer = file_object_io_handle->read_ahead_buffer;
+			read_size   = PYQCOW_FILE_OBJECT_IO_HANDLE_READ_AHEAD_SIZE;
+		}
+		if( file_object_io_handle->has_readinto_method != 0 )
+		{
+			read_count = pyqcow_file_object_read_buffer_into(
+			              file_object_io_handle->file_object,
+			              read_buffer,
+			              read_size,
+			              error );
+		}
+		else
+		{
+			read_count = pyqcow_file_object_read_buffer(
+			              file_object_io_handle->file_object,
+			              read_buffer,
+			              read_size,
+			              error );
+		}
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read from file object.",
+			 function );
+
+			goto on_error;
+		}
+		if( read_count == 0 )
+		{
+			break;
+		}
+		if( read_buffer == file_object_io_handle->read_ahead_buffer )
+		{
+			file_object_io_handle->read_ahead_data_size = (size_t) read_count;
+		}
+		else
+		{
+			file_object_io_handle->current_offset += (off64_t) read_count;
+			buffer_offset                         += (size_t) read_count;
+		}
 	}
 	PyGILState_Release(
 	 gil_state );
 
-	return( read_count );
+	return( (ssize_t) buffer_offset );
 
 on_error:
 	PyGILState_Release(
@@ -824,6 +1188,25 @@ ssize_t pyqcow_file_object_io_handle_write(
 	}
 	gil_state = PyGILState_Ensure();
 
+	/* The data in the read-ahead buffer is no longer valid after a write
+	 */
+	file_object_io_handle->read_ahead_data_size = 0;
+
+	if( pyqcow_file_object_seek_offset(
+	     file_object_io_handle->file_object,
+	     file_object_io_handle->current_offset,
+	     SEEK_SET,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_SEEK_FAILED,
+		 "%s: unable to seek in file object.",
+		 function );
+
+		goto on_error;
+	}
 	write_count = pyqcow_file_object_write_buffer(
 	               file_object_io_handle->file_object,
 	               buffer,
@@ -841,6 +1224,8 @@ ssize_t pyqcow_file_object_io_handle_write(
 
 		goto on_error;
 	}
+	file_object_io_handle->current_offset += (off64_t) write_count;
+
 	PyGILState_Release(
 	 gil_state );
 
@@ -1130,6 +1515,7 @@ on_error:
 }
 
 /* Seeks a certain offset within the file object IO handle
+ * The file object itself is only seeked when it is read from, except for SEEK_END
  * Returns the offset if the seek is successful or -1 on error
  */
 off64_t pyqcow_file_object_io_handle_seek_offset(
@@ -1152,39 +1538,71 @@ off64_t pyqcow_file_object_io_handle_seek_offset(
 
 		return( -1 );
 	}
-	gil_state = PyGILState_Ensure();
-
-	if( pyqcow_file_object_seek_offset(
-	     file_object_io_handle->file_object,
-	     offset,
-	     whence,
-	     error ) != 1 )
+	if( ( whence != SEEK_CUR )
+	 && ( whence != SEEK_END )
+	 && ( whence != SEEK_SET ) )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek in file object.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported whence.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	if( pyqcow_file_object_get_offset(
-	     file_object_io_handle->file_object,
-	     &offset,
-	     error ) != 1 )
+	if( whence == SEEK_END )
+	{
+		gil_state = PyGILState_Ensure();
+
+		if( pyqcow_file_object_seek_offset(
+		     file_object_io_handle->file_object,
+		     offset,
+		     whence,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_SEEK_FAILED,
+			 "%s: unable to seek in file object.",
+			 function );
+
+			goto on_error;
+		}
+		if( pyqcow_file_object_get_offset(
+		     file_object_io_handle->file_object,
+		     &offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_SEEK_FAILED,
+			 "%s: unable to retrieve current offset in file object.",
+			 function );
+
+			goto on_error;
+		}
+		PyGILState_Release(
+		 gil_state );
+	}
+	else if( whence == SEEK_CUR )
+	{
+		offset += file_object_io_handle->current_offset;
+	}
+	if( offset < 0 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to retrieve current offset in file object.",
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid offset value out of bounds.",
 		 function );
 
-		goto on_error;
+		return( -1 );
 	}
-	PyGILState_Release(
-	 gil_state );
+	file_object_io_handle->current_offset = offset;
 
 	return( offset );
 
@@ -33,6 +33,11 @@
 extern "C" {
 #endif
 
+/* The size of the read-ahead buffer, reads of at least this size
+ * are read directly into the buffer of the caller
+ */
+#define PYQCOW_FILE_OBJECT_IO_HANDLE_READ_AHEAD_SIZE	65536
+
 typedef struct pyqcow_file_object_io_handle pyqcow_file_object_io_handle_t;
 
 struct pyqcow_file_object_io_handle
@@ -44,6 +49,27 @@ struct pyqcow_file_object_io_handle
 	/* The access flags
 	 */
 	int access_flags;
+
+	/* The current offset
+	 */
+	off64_t current_offset;
+
+	/* Value to indicate the file object has a readinto method
+	 * -1 if not yet determined
+	 */
+	int has_readinto_method;
+
+	/* The read-ahead buffer
+	 */
+	uint8_t *read_ahead_buffer;
+
+	/* The offset of the data in the read-ahead buffer
+	 */
+	off64_t read_ahead_offset;
+
+	/* The size of the data in the read-ahead buffer
+	 */
+	size_t read_ahead_data_size;
 };
 
 int pyqcow_file_object_io_handle_initialize(
@@ -80,6 +106,12 @@ ssize_t pyqcow_file_object_read_buffer(
          size_t size,
          libcerror_error_t **error );
 
+ssize_t pyqcow_file_object_read_buffer_into(
+         PyObject *file_object,
+         uint8_t *buffer,
+         size_t size,
+         libcerror_error_t **error );
+
 ssize_t pyqcow_file_object_io_handle_read(
          pyqcow_file_object_io_handle_t *file_object_io_handle,
          uint8_t *buffer,
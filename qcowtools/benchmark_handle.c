@@ -0,0 +1,1223 @@
+/*
+ * Benchmark handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#if defined( WINAPI )
+#include <windows.h>
+
+#elif defined( TIME_WITH_SYS_TIME )
+#include <sys/time.h>
+#include <time.h>
+#elif defined( HAVE_SYS_TIME_H )
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include "benchmark_handle.h"
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libcthreads.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_unused.h"
+
+/* Creates a benchmark handle
+ * Make sure the value benchmark_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_initialize(
+     benchmark_handle_t **benchmark_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_initialize";
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *benchmark_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid benchmark handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	*benchmark_handle = memory_allocate_structure(
+	                     benchmark_handle_t );
+
+	if( *benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create benchmark handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *benchmark_handle,
+	     0,
+	     sizeof( benchmark_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear benchmark handle.",
+		 function );
+
+		goto on_error;
+	}
+	( *benchmark_handle )->mount_handle      = mount_handle;
+	( *benchmark_handle )->pattern           = BENCHMARK_HANDLE_PATTERN_SEQUENTIAL;
+	( *benchmark_handle )->read_size         = BENCHMARK_HANDLE_DEFAULT_READ_SIZE;
+	( *benchmark_handle )->number_of_threads = BENCHMARK_HANDLE_DEFAULT_NUMBER_OF_THREADS;
+	( *benchmark_handle )->duration          = BENCHMARK_HANDLE_DEFAULT_DURATION;
+
+	return( 1 );
+
+on_error:
+	if( *benchmark_handle != NULL )
+	{
+		memory_free(
+		 *benchmark_handle );
+
+		*benchmark_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a benchmark handle
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_free(
+     benchmark_handle_t **benchmark_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_free";
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *benchmark_handle != NULL )
+	{
+		/* The mount_handle reference is freed elsewhere
+		 */
+		if( ( *benchmark_handle )->threads != NULL )
+		{
+			memory_free(
+			 ( *benchmark_handle )->threads );
+		}
+		memory_free(
+		 *benchmark_handle );
+
+		*benchmark_handle = NULL;
+	}
+	return( 1 );
+}
+
+/* Signals the benchmark handle to abort
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_signal_abort(
+     benchmark_handle_t *benchmark_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_signal_abort";
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	benchmark_handle->abort = 1;
+
+	return( 1 );
+}
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+static int benchmark_handle_copy_decimal_from_string(
+            const system_character_t *string,
+            uint64_t maximum_value,
+            uint64_t *value_64bit,
+            libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_copy_decimal_from_string";
+	size_t string_index   = 0;
+	uint64_t safe_value   = 0;
+
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( value_64bit == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid value 64-bit.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( string[ string_index ] < (system_character_t) '0' )
+	 || ( string[ string_index ] > (system_character_t) '9' ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+		 function,
+		 string_index );
+
+		return( -1 );
+	}
+	while( ( string[ string_index ] >= (system_character_t) '0' )
+	    && ( string[ string_index ] <= (system_character_t) '9' ) )
+	{
+		safe_value *= 10;
+		safe_value += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( safe_value > maximum_value )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		string_index++;
+	}
+	if( string[ string_index ] != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - trailing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( safe_value == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid string - value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	*value_64bit = safe_value;
+
+	return( 1 );
+}
+
+/* Sets the read pattern
+ * The string is either "sequential" or "random"
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_set_pattern(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_set_pattern";
+	size_t string_length  = 0;
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = system_string_length(
+	                 string );
+
+	if( ( string_length == 10 )
+	 && ( system_string_compare(
+	       string,
+	       _SYSTEM_STRING( "sequential" ),
+	       10 ) == 0 ) )
+	{
+		benchmark_handle->pattern = BENCHMARK_HANDLE_PATTERN_SEQUENTIAL;
+	}
+	else if( ( string_length == 6 )
+	      && ( system_string_compare(
+	            string,
+	            _SYSTEM_STRING( "random" ),
+	            6 ) == 0 ) )
+	{
+		benchmark_handle->pattern = BENCHMARK_HANDLE_PATTERN_RANDOM;
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported pattern.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the size of a read
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_set_read_size(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_set_read_size";
+	uint64_t value_64bit  = 0;
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( benchmark_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) BENCHMARK_HANDLE_MAXIMUM_READ_SIZE,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy read size from string.",
+		 function );
+
+		return( -1 );
+	}
+	benchmark_handle->read_size = (size_t) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the number of threads
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_set_number_of_threads(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_set_number_of_threads";
+	uint64_t value_64bit  = 0;
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( benchmark_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) BENCHMARK_HANDLE_MAXIMUM_NUMBER_OF_THREADS,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy number of threads from string.",
+		 function );
+
+		return( -1 );
+	}
+#if !defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( value_64bit > 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: multiple threads are not supported.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	benchmark_handle->number_of_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the duration in seconds
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_set_duration(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_set_duration";
+	uint64_t value_64bit  = 0;
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( benchmark_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) BENCHMARK_HANDLE_MAXIMUM_DURATION,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy duration from string.",
+		 function );
+
+		return( -1 );
+	}
+	benchmark_handle->duration = value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the notification stream on which the results are printed
+ * Returns 1 if successful or -1 on error
+ */
+int benchmark_handle_set_notify_stream(
+     benchmark_handle_t *benchmark_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error )
+{
+	static char *function = "benchmark_handle_set_notify_stream";
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	benchmark_handle->notify_stream = notify_stream;
+
+	return( 1 );
+}
+
+/* Retrieves a monotonic timestamp in nanoseconds
+ * Returns the timestamp or 0 if not available
+ */
+static uint64_t benchmark_handle_get_timestamp(
+                 void )
+{
+#if defined( WINAPI )
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	if( QueryPerformanceFrequency(
+	     &frequency ) == 0 )
+	{
+		return( 0 );
+	}
+	if( QueryPerformanceCounter(
+	     &counter ) == 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) ( counter.QuadPart / frequency.QuadPart ) * 1000000000UL )
+	      + ( (uint64_t) ( counter.QuadPart % frequency.QuadPart ) * 1000000000UL / (uint64_t) frequency.QuadPart ) );
+
+#elif defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec time_specification;
+
+	if( clock_gettime(
+	     CLOCK_MONOTONIC,
+	     &time_specification ) != 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) time_specification.tv_sec * 1000000000UL ) + (uint64_t) time_specification.tv_nsec );
+
+#elif defined( HAVE_TIME )
+	return( (uint64_t) time( NULL ) * 1000000000UL );
+
+#else
+	return( 0 );
+#endif
+}
+
+/* Determines the offset and size of the next read of a thread
+ * Sequential reads continue in the range of the thread and wrap around at its end,
+ * random reads use an offset that is a multiple of the read size
+ */
+static void benchmark_handle_get_next_read(
+             benchmark_handle_thread_t *thread,
+             off64_t *read_offset,
+             size_t *read_size )
+{
+	benchmark_handle_t *benchmark_handle = thread->benchmark_handle;
+	uint64_t number_of_blocks            = 0;
+	off64_t range_end_offset             = 0;
+	off64_t safe_read_offset             = 0;
+
+	if( benchmark_handle->pattern == BENCHMARK_HANDLE_PATTERN_RANDOM )
+	{
+		number_of_blocks = benchmark_handle->media_size / benchmark_handle->read_size;
+
+		if( ( benchmark_handle->media_size % benchmark_handle->read_size ) != 0 )
+		{
+			number_of_blocks += 1;
+		}
+		/* The xorshift64 generator gives every thread its own reproducible
+		 * sequence of offsets without a shared state
+		 */
+		thread->random_state ^= thread->random_state << 13;
+		thread->random_state ^= thread->random_state >> 7;
+		thread->random_state ^= thread->random_state << 17;
+
+		safe_read_offset = (off64_t) ( ( thread->random_state % number_of_blocks ) * benchmark_handle->read_size );
+		range_end_offset = (off64_t) benchmark_handle->media_size;
+	}
+	else
+	{
+		range_end_offset = thread->range_offset + (off64_t) thread->range_size;
+		safe_read_offset = *read_offset + (off64_t) *read_size;
+
+		if( ( safe_read_offset < thread->range_offset )
+		 || ( safe_read_offset >= range_end_offset ) )
+		{
+			safe_read_offset = thread->range_offset;
+		}
+	}
+	*read_offset = safe_read_offset;
+	*read_size   = benchmark_handle->read_size;
+
+	if( (size64_t) *read_size > (size64_t) ( range_end_offset - safe_read_offset ) )
+	{
+		*read_size = (size_t) ( range_end_offset - safe_read_offset );
+	}
+}
+
+/* Reads the media until the duration has passed
+ * Returns 1 if successful or -1 on error
+ */
+static int benchmark_handle_read_media(
+            benchmark_handle_thread_t *thread,
+            void *arguments QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	benchmark_handle_t *benchmark_handle = NULL;
+	libcerror_error_t *error             = NULL;
+	uint8_t *buffer                      = NULL;
+	static char *function                = "benchmark_handle_read_media";
+	size_t read_size                     = 0;
+	ssize_t read_count                   = 0;
+	off64_t read_offset                  = -1;
+	int result                           = 1;
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( arguments )
+
+	if( thread == NULL )
+	{
+		return( -1 );
+	}
+	benchmark_handle = thread->benchmark_handle;
+
+	buffer = (uint8_t *) memory_allocate(
+	                      sizeof( uint8_t ) * benchmark_handle->read_size );
+
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buffer.",
+		 function );
+
+		result = -1;
+	}
+	while( ( result == 1 )
+	    && ( benchmark_handle->abort == 0 ) )
+	{
+		if( benchmark_handle_get_timestamp() >= benchmark_handle->end_timestamp )
+		{
+			break;
+		}
+		benchmark_handle_get_next_read(
+		 thread,
+		 &read_offset,
+		 &read_size );
+
+		read_count = mount_handle_read_buffer_at_offset(
+		              benchmark_handle->mount_handle,
+		              0,
+		              buffer,
+		              read_size,
+		              read_offset,
+		              &error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 read_offset,
+			 read_offset );
+
+			result = -1;
+
+			break;
+		}
+		thread->number_of_reads      += 1;
+		thread->number_of_bytes_read += (uint64_t) read_count;
+	}
+	if( result != 1 )
+	{
+		/* Stop the other threads
+		 */
+		benchmark_handle->benchmark_failed = 1;
+		benchmark_handle->abort            = 1;
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( buffer != NULL )
+	{
+		memory_free(
+		 buffer );
+	}
+	return( result );
+}
+
+/* Initializes the threads
+ * The media is divided in a range per thread for sequential reads,
+ * so that the threads do not read the same data
+ * Returns 1 if successful or -1 on error
+ */
+static int benchmark_handle_initialize_threads(
+            benchmark_handle_t *benchmark_handle,
+            libcerror_error_t **error )
+{
+	benchmark_handle_thread_t *thread = NULL;
+	static char *function             = "benchmark_handle_initialize_threads";
+	size64_t range_size               = 0;
+	int thread_index                  = 0;
+
+	if( benchmark_handle->threads != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid benchmark handle - threads value already set.",
+		 function );
+
+		return( -1 );
+	}
+	benchmark_handle->threads = (benchmark_handle_thread_t *) memory_allocate(
+	                                                           sizeof( benchmark_handle_thread_t ) * benchmark_handle->number_of_threads );
+
+	if( benchmark_handle->threads == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create threads.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     benchmark_handle->threads,
+	     0,
+	     sizeof( benchmark_handle_thread_t ) * benchmark_handle->number_of_threads ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear threads.",
+		 function );
+
+		memory_free(
+		 benchmark_handle->threads );
+
+		benchmark_handle->threads = NULL;
+
+		return( -1 );
+	}
+	/* The ranges are a multiple of the read size, the last thread
+	 * also reads the remainder of the media
+	 */
+	range_size  = benchmark_handle->media_size / benchmark_handle->number_of_threads;
+	range_size -= range_size % benchmark_handle->read_size;
+
+	for( thread_index = 0;
+	     thread_index < benchmark_handle->number_of_threads;
+	     thread_index++ )
+	{
+		thread = &( benchmark_handle->threads[ thread_index ] );
+
+		thread->benchmark_handle = benchmark_handle;
+		thread->random_state     = (uint64_t) ( thread_index + 1 ) * 0x9e3779b97f4a7c15ULL;
+
+		if( range_size == 0 )
+		{
+			thread->range_offset = 0;
+			thread->range_size   = benchmark_handle->media_size;
+		}
+		else
+		{
+			thread->range_offset = (off64_t) ( range_size * thread_index );
+			thread->range_size   = range_size;
+
+			if( thread_index == ( benchmark_handle->number_of_threads - 1 ) )
+			{
+				thread->range_size = benchmark_handle->media_size - (size64_t) thread->range_offset;
+			}
+		}
+	}
+	return( 1 );
+}
+
+/* Prints the results of the benchmark
+ * Returns 1 if successful or -1 on error
+ */
+static int benchmark_handle_results_fprint(
+            benchmark_handle_t *benchmark_handle,
+            uint64_t elapsed_time,
+            libcerror_error_t **error )
+{
+	uint64_t statistics[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	const char *operation_names[ LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ] = {
+		"Read buffer",
+		"Level 2 table read",
+		"Cluster block read",
+		"Decompress",
+		"Decrypt" };
+
+	const double percentiles[ 5 ] = {
+		50.0, 90.0, 99.0, 99.9, 100.0 };
+
+	uint64_t latencies[ 5 ];
+
+	static char *function         = "benchmark_handle_results_fprint";
+	double elapsed_seconds        = 0.0;
+	uint64_t number_of_bytes_read = 0;
+	uint64_t number_of_reads      = 0;
+	uint64_t number_of_values     = 0;
+	int operation                 = 0;
+	int percentile_index          = 0;
+	int thread_index              = 0;
+
+	if( benchmark_handle->notify_stream == NULL )
+	{
+		return( 1 );
+	}
+	for( thread_index = 0;
+	     thread_index < benchmark_handle->number_of_threads;
+	     thread_index++ )
+	{
+		number_of_reads      += benchmark_handle->threads[ thread_index ].number_of_reads;
+		number_of_bytes_read += benchmark_handle->threads[ thread_index ].number_of_bytes_read;
+	}
+	elapsed_seconds = (double) elapsed_time / 1000000000.0;
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "Benchmark:\n" );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tPattern:\t\t\t%s\n",
+	 ( benchmark_handle->pattern == BENCHMARK_HANDLE_PATTERN_RANDOM ) ? "random" : "sequential" );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tNumber of threads:\t\t%d\n",
+	 benchmark_handle->number_of_threads );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tRead size:\t\t\t%" PRIzd " bytes\n",
+	 benchmark_handle->read_size );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tElapsed time:\t\t\t%.3f seconds\n",
+	 elapsed_seconds );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tNumber of reads:\t\t%" PRIu64 "\n",
+	 number_of_reads );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tBytes read:\t\t\t%" PRIu64 "\n",
+	 number_of_bytes_read );
+
+	if( elapsed_seconds > 0.0 )
+	{
+		fprintf(
+		 benchmark_handle->notify_stream,
+		 "\tThroughput:\t\t\t%.2f MiB/s\n",
+		 ( (double) number_of_bytes_read / elapsed_seconds ) / ( 1024.0 * 1024.0 ) );
+
+		fprintf(
+		 benchmark_handle->notify_stream,
+		 "\tIOPS:\t\t\t\t%.0f\n",
+		 (double) number_of_reads / elapsed_seconds );
+	}
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\n" );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "Latencies (nanoseconds):\n" );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tOperation\t\tCount\tp50\tp90\tp99\tp99.9\tmax\n" );
+
+	for( operation = 0;
+	     operation < LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS;
+	     operation++ )
+	{
+		for( percentile_index = 0;
+		     percentile_index < 5;
+		     percentile_index++ )
+		{
+			if( mount_handle_get_latency_percentile(
+			     benchmark_handle->mount_handle,
+			     0,
+			     operation,
+			     percentiles[ percentile_index ],
+			     &number_of_values,
+			     &( latencies[ percentile_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve latency percentile.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		if( number_of_values == 0 )
+		{
+			continue;
+		}
+		fprintf(
+		 benchmark_handle->notify_stream,
+		 "\t%-20s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+		 operation_names[ operation ],
+		 number_of_values,
+		 latencies[ 0 ],
+		 latencies[ 1 ],
+		 latencies[ 2 ],
+		 latencies[ 3 ],
+		 latencies[ 4 ] );
+	}
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\n" );
+
+	if( mount_handle_get_statistics(
+	     benchmark_handle->mount_handle,
+	     0,
+	     statistics,
+	     LIBQCOW_NUMBER_OF_STATISTICS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve statistics.",
+		 function );
+
+		return( -1 );
+	}
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "Cache statistics:\n" );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tLevel 2 table cache:\t\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_MISSES ] );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tCluster block cache:\t\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_MISSES ] );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tCompressed cluster cache:\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_MISSES ] );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\tHost reads:\t\t\t%" PRIu64 " (%" PRIu64 " bytes)\n",
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_HOST_READS ],
+	 statistics[ LIBQCOW_STATISTIC_HOST_BYTES_READ ] );
+
+	fprintf(
+	 benchmark_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+}
+
+/* Runs the benchmark, which reads the media of the first input file
+ * with the read pattern by the threads until the duration has passed
+ * Returns 1 if successful, 0 if aborted or -1 on error
+ */
+int benchmark_handle_run(
+     benchmark_handle_t *benchmark_handle,
+     libcerror_error_t **error )
+{
+	static char *function                  = "benchmark_handle_run";
+	uint64_t elapsed_time                  = 0;
+	int result                             = 1;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_pool_t *thread_pool = NULL;
+	int thread_index                       = 0;
+#endif
+
+	if( benchmark_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid benchmark handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle_get_media_size(
+	     benchmark_handle->mount_handle,
+	     0,
+	     &( benchmark_handle->media_size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		return( -1 );
+	}
+	if( benchmark_handle->media_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid media size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( benchmark_handle_initialize_threads(
+	     benchmark_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize threads.",
+		 function );
+
+		return( -1 );
+	}
+	/* The statistics only cover the reads of the benchmark
+	 * not the reads of the metadata on open
+	 */
+	if( mount_handle_reset_statistics(
+	     benchmark_handle->mount_handle,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to reset statistics.",
+		 function );
+
+		goto on_error;
+	}
+	benchmark_handle->benchmark_failed = 0;
+	benchmark_handle->start_timestamp  = benchmark_handle_get_timestamp();
+
+	if( benchmark_handle->start_timestamp == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve start timestamp.",
+		 function );
+
+		goto on_error;
+	}
+	benchmark_handle->end_timestamp = benchmark_handle->start_timestamp + ( benchmark_handle->duration * 1000000000UL );
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( benchmark_handle->number_of_threads > 1 )
+	{
+		if( libcthreads_thread_pool_create(
+		     &thread_pool,
+		     NULL,
+		     benchmark_handle->number_of_threads,
+		     benchmark_handle->number_of_threads,
+		     (int (*)(intptr_t *, void *)) &benchmark_handle_read_media,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread pool.",
+			 function );
+
+			goto on_error;
+		}
+		for( thread_index = 0;
+		     thread_index < benchmark_handle->number_of_threads;
+		     thread_index++ )
+		{
+			if( libcthreads_thread_pool_push(
+			     thread_pool,
+			     (intptr_t *) &( benchmark_handle->threads[ thread_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to push read onto thread pool queue.",
+				 function );
+
+				benchmark_handle->abort = 1;
+
+				libcthreads_thread_pool_join(
+				 &thread_pool,
+				 NULL );
+
+				goto on_error;
+			}
+		}
+		if( libcthreads_thread_pool_join(
+		     &thread_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread pool.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+#endif
+	{
+		benchmark_handle_read_media(
+		 &( benchmark_handle->threads[ 0 ] ),
+		 NULL );
+	}
+	elapsed_time = benchmark_handle_get_timestamp() - benchmark_handle->start_timestamp;
+
+	if( benchmark_handle->benchmark_failed != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read media.",
+		 function );
+
+		goto on_error;
+	}
+	if( benchmark_handle->abort != 0 )
+	{
+		result = 0;
+	}
+	if( benchmark_handle_results_fprint(
+	     benchmark_handle,
+	     elapsed_time,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_PRINT_FAILED,
+		 "%s: unable to print results.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 benchmark_handle->threads );
+
+	benchmark_handle->threads = NULL;
+
+	return( result );
+
+on_error:
+	if( benchmark_handle->threads != NULL )
+	{
+		memory_free(
+		 benchmark_handle->threads );
+
+		benchmark_handle->threads = NULL;
+	}
+	return( -1 );
+}
+
@@ -0,0 +1,199 @@
+/*
+ * Benchmark handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _BENCHMARK_HANDLE_H )
+#define _BENCHMARK_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The default size of a read
+ */
+#define BENCHMARK_HANDLE_DEFAULT_READ_SIZE		( 64 * 1024 )
+
+/* The maximum size of a read
+ */
+#define BENCHMARK_HANDLE_MAXIMUM_READ_SIZE		( 32 * 1024 * 1024 )
+
+/* The default number of threads
+ */
+#define BENCHMARK_HANDLE_DEFAULT_NUMBER_OF_THREADS	1
+
+/* The maximum number of threads
+ */
+#define BENCHMARK_HANDLE_MAXIMUM_NUMBER_OF_THREADS	64
+
+/* The default duration in seconds
+ */
+#define BENCHMARK_HANDLE_DEFAULT_DURATION		10
+
+/* The maximum duration in seconds
+ */
+#define BENCHMARK_HANDLE_MAXIMUM_DURATION		86400
+
+enum BENCHMARK_HANDLE_PATTERNS
+{
+	BENCHMARK_HANDLE_PATTERN_SEQUENTIAL	= 1,
+	BENCHMARK_HANDLE_PATTERN_RANDOM		= 2
+};
+
+typedef struct benchmark_handle benchmark_handle_t;
+typedef struct benchmark_handle_thread benchmark_handle_thread_t;
+
+/* A thread reads with its own position in the media
+ */
+struct benchmark_handle_thread
+{
+	/* The benchmark handle
+	 */
+	benchmark_handle_t *benchmark_handle;
+
+	/* The offset of the range of the media that is read sequentially
+	 */
+	off64_t range_offset;
+
+	/* The size of the range of the media that is read sequentially
+	 */
+	size64_t range_size;
+
+	/* The state of the pseudo random number generator
+	 * used to determine the offsets of random reads
+	 */
+	uint64_t random_state;
+
+	/* The number of reads
+	 */
+	uint64_t number_of_reads;
+
+	/* The number of bytes read
+	 */
+	uint64_t number_of_bytes_read;
+};
+
+struct benchmark_handle
+{
+	/* The mount handle, which provides the input file
+	 * this value is not managed by the benchmark handle
+	 */
+	mount_handle_t *mount_handle;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The read pattern
+	 */
+	int pattern;
+
+	/* The size of a read
+	 */
+	size_t read_size;
+
+	/* The number of threads
+	 */
+	int number_of_threads;
+
+	/* The duration in seconds
+	 */
+	uint64_t duration;
+
+	/* The threads
+	 */
+	benchmark_handle_thread_t *threads;
+
+	/* The timestamp, in nanoseconds, at which the benchmark started
+	 */
+	uint64_t start_timestamp;
+
+	/* The timestamp, in nanoseconds, at which the benchmark ends
+	 */
+	uint64_t end_timestamp;
+
+	/* Value to indicate one of the threads failed
+	 */
+	int benchmark_failed;
+
+	/* The notification output stream
+	 */
+	FILE *notify_stream;
+
+	/* Value to indicate if abort was signalled
+	 */
+	int abort;
+};
+
+int benchmark_handle_initialize(
+     benchmark_handle_t **benchmark_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error );
+
+int benchmark_handle_free(
+     benchmark_handle_t **benchmark_handle,
+     libcerror_error_t **error );
+
+int benchmark_handle_signal_abort(
+     benchmark_handle_t *benchmark_handle,
+     libcerror_error_t **error );
+
+int benchmark_handle_set_pattern(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int benchmark_handle_set_read_size(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int benchmark_handle_set_number_of_threads(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int benchmark_handle_set_duration(
+     benchmark_handle_t *benchmark_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int benchmark_handle_set_notify_stream(
+     benchmark_handle_t *benchmark_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error );
+
+int benchmark_handle_run(
+     benchmark_handle_t *benchmark_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _BENCHMARK_HANDLE_H ) */
+
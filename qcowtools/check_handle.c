@@ -0,0 +1,496 @@
+/*
+ * Check handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#include "check_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#define CHECK_HANDLE_NOTIFY_STREAM		stdout
+
+/* Creates a check handle
+ * Make sure the value check_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_initialize(
+     check_handle_t **check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_initialize";
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *check_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid check handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*check_handle = memory_allocate_structure(
+	                 check_handle_t );
+
+	if( *check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create check handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *check_handle,
+	     0,
+	     sizeof( check_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear check handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_initialize(
+	     &( ( *check_handle )->input_file ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize input file.",
+		 function );
+
+		goto on_error;
+	}
+	( *check_handle )->notify_stream = CHECK_HANDLE_NOTIFY_STREAM;
+
+	return( 1 );
+
+on_error:
+	if( *check_handle != NULL )
+	{
+		memory_free(
+		 *check_handle );
+
+		*check_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a check handle
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_free(
+     check_handle_t **check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_free";
+	int result            = 1;
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *check_handle != NULL )
+	{
+		if( ( *check_handle )->input_file != NULL )
+		{
+			if( libqcow_file_free(
+			     &( ( *check_handle )->input_file ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free input file.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *check_handle );
+
+		*check_handle = NULL;
+	}
+	return( result );
+}
+
+/* Signals the check handle to abort
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_signal_abort(
+     check_handle_t *check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_signal_abort";
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( check_handle->input_file != NULL )
+	{
+		if( libqcow_file_signal_abort(
+		     check_handle->input_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to signal input file to abort.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Sets the number of threads
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_set_number_of_threads(
+     check_handle_t *check_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_set_number_of_threads";
+	size_t string_index   = 0;
+	uint64_t value_64bit  = 0;
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( string[ 0 ] == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - missing value.",
+		 function );
+
+		return( -1 );
+	}
+	for( string_index = 0;
+	     string[ string_index ] != 0;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+			 function,
+			 string_index );
+
+			return( -1 );
+		}
+		value_64bit *= 10;
+		value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( value_64bit > (uint64_t) CHECK_HANDLE_MAXIMUM_NUMBER_OF_THREADS )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid number of threads value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	check_handle->number_of_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Opens the check handle
+ * Only the metadata is opened, hence no password or key is needed
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_open_input(
+     check_handle_t *check_handle,
+     const system_character_t *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_open_input";
+	int result            = 0;
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          check_handle->input_file,
+	          filename,
+	          LIBQCOW_OPEN_METADATA_ONLY,
+	          error );
+#else
+	result = libqcow_file_open(
+	          check_handle->input_file,
+	          filename,
+	          LIBQCOW_OPEN_METADATA_ONLY,
+	          error );
+#endif
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Closes the check handle
+ * Returns the 0 if succesful or -1 on error
+ */
+int check_handle_close(
+     check_handle_t *check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_close";
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( check_handle->input_file == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid check handle - missing input file.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_close(
+	     check_handle->input_file,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( 0 );
+}
+
+/* Checks the consistency of the input file
+ * Returns 1 if the input file is consistent, 0 if not or -1 on error
+ */
+int check_handle_check(
+     check_handle_t *check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_check";
+	int result            = 0;
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_file_check_consistency(
+	          check_handle->input_file,
+	          check_handle->flags,
+	          check_handle->number_of_threads,
+	          check_handle->values,
+	          LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to check consistency of input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( result );
+}
+
+/* Prints the consistency check values to a stream
+ * Returns 1 if successful or -1 on error
+ */
+int check_handle_check_fprint(
+     check_handle_t *check_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "check_handle_check_fprint";
+
+	if( check_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid check handle.",
+		 function );
+
+		return( -1 );
+	}
+	fprintf(
+	 check_handle->notify_stream,
+	 "Consistency check:\n" );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tLevel 2 tables:\t\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_LEVEL2_TABLES ] );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tData clusters:\t\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_DATA_CLUSTERS ] );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tCompressed clusters:\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_COMPRESSED_CLUSTERS ] );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tInvalid references:\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_INVALID_REFERENCES ] );
+
+	if( ( check_handle->flags & LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA ) != 0 )
+	{
+		fprintf(
+		 check_handle->notify_stream,
+		 "\tCorrupt compressed clusters:\t%" PRIu64 "\n",
+		 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_CORRUPT_COMPRESSED_CLUSTERS ] );
+	}
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tReference count errors:\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_REFERENCE_COUNT_ERRORS ] );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\tLeaked clusters:\t\t%" PRIu64 "\n",
+	 check_handle->values[ LIBQCOW_CONSISTENCY_CHECK_VALUE_NUMBER_OF_LEAKED_CLUSTERS ] );
+
+	fprintf(
+	 check_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+}
+
@@ -0,0 +1,105 @@
+/*
+ * Check handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _CHECK_HANDLE_H )
+#define _CHECK_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The maximum number of threads
+ */
+#define CHECK_HANDLE_MAXIMUM_NUMBER_OF_THREADS	64
+
+typedef struct check_handle check_handle_t;
+
+struct check_handle
+{
+	/* The libqcow input file
+	 */
+	libqcow_file_t *input_file;
+
+	/* The notification output stream
+	 */
+	FILE *notify_stream;
+
+	/* The consistency check flags
+	 */
+	int flags;
+
+	/* The number of threads that check the level 2 tables
+	 * 0 represents the number of worker threads of the input file
+	 */
+	int number_of_threads;
+
+	/* The consistency check values
+	 */
+	uint64_t values[ LIBQCOW_NUMBER_OF_CONSISTENCY_CHECK_VALUES ];
+};
+
+int check_handle_initialize(
+     check_handle_t **check_handle,
+     libcerror_error_t **error );
+
+int check_handle_free(
+     check_handle_t **check_handle,
+     libcerror_error_t **error );
+
+int check_handle_signal_abort(
+     check_handle_t *check_handle,
+     libcerror_error_t **error );
+
+int check_handle_set_number_of_threads(
+     check_handle_t *check_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int check_handle_open_input(
+     check_handle_t *check_handle,
+     const system_character_t *filename,
+     libcerror_error_t **error );
+
+int check_handle_close(
+     check_handle_t *check_handle,
+     libcerror_error_t **error );
+
+int check_handle_check(
+     check_handle_t *check_handle,
+     libcerror_error_t **error );
+
+int check_handle_check_fprint(
+     check_handle_t *check_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _CHECK_HANDLE_H ) */
+
@@ -0,0 +1,299 @@
+/*
+ * Compact handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#include "compact_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#define COMPACT_HANDLE_NOTIFY_STREAM		stdout
+
+/* Creates a compact handle
+ * Make sure the value compact_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int compact_handle_initialize(
+     compact_handle_t **compact_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "compact_handle_initialize";
+
+	if( compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compact handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *compact_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid compact handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*compact_handle = memory_allocate_structure(
+	                   compact_handle_t );
+
+	if( *compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create compact handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *compact_handle,
+	     0,
+	     sizeof( compact_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear compact handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_initialize(
+	     &( ( *compact_handle )->input_file ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize input file.",
+		 function );
+
+		goto on_error;
+	}
+	( *compact_handle )->notify_stream = COMPACT_HANDLE_NOTIFY_STREAM;
+
+	return( 1 );
+
+on_error:
+	if( *compact_handle != NULL )
+	{
+		memory_free(
+		 *compact_handle );
+
+		*compact_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a compact handle
+ * Returns 1 if successful or -1 on error
+ */
+int compact_handle_free(
+     compact_handle_t **compact_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "compact_handle_free";
+	int result            = 1;
+
+	if( compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compact handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *compact_handle != NULL )
+	{
+		if( ( *compact_handle )->input_file != NULL )
+		{
+			if( libqcow_file_free(
+			     &( ( *compact_handle )->input_file ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to free input file.",
+				 function );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 *compact_handle );
+
+		*compact_handle = NULL;
+	}
+	return( result );
+}
+
+/* Opens the input of the compact handle
+ * Returns 1 if successful or -1 on error
+ */
+int compact_handle_open_input(
+     compact_handle_t *compact_handle,
+     const system_character_t *filename,
+     libcerror_error_t **error )
+{
+	static char *function = "compact_handle_open_input";
+	int result            = 0;
+
+	if( compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compact handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          compact_handle->input_file,
+	          filename,
+	          LIBQCOW_OPEN_READ,
+	          error );
+#else
+	result = libqcow_file_open(
+	          compact_handle->input_file,
+	          filename,
+	          LIBQCOW_OPEN_READ,
+	          error );
+#endif
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Closes the input of the compact handle
+ * Returns the 0 if succesful or -1 on error
+ */
+int compact_handle_close_input(
+     compact_handle_t *compact_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "compact_handle_close_input";
+
+	if( compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compact handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_close(
+	     compact_handle->input_file,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( 0 );
+}
+
+/* Compacts the input into the target file
+ * Returns 1 if successful or -1 on error
+ */
+int compact_handle_compact(
+     compact_handle_t *compact_handle,
+     const system_character_t *target_filename,
+     libcerror_error_t **error )
+{
+	static char *function = "compact_handle_compact";
+	int result            = 0;
+
+	if( compact_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid compact handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_compact_wide(
+	          compact_handle->input_file,
+	          target_filename,
+	          error );
+#else
+	result = libqcow_file_compact(
+	          compact_handle->input_file,
+	          target_filename,
+	          error );
+#endif
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to compact input file.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,76 @@
+/*
+ * Compact handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _COMPACT_HANDLE_H )
+#define _COMPACT_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+typedef struct compact_handle compact_handle_t;
+
+struct compact_handle
+{
+	/* The libqcow input file
+	 */
+	libqcow_file_t *input_file;
+
+	/* The notification output stream
+	 */
+	FILE *notify_stream;
+};
+
+int compact_handle_initialize(
+     compact_handle_t **compact_handle,
+     libcerror_error_t **error );
+
+int compact_handle_free(
+     compact_handle_t **compact_handle,
+     libcerror_error_t **error );
+
+int compact_handle_open_input(
+     compact_handle_t *compact_handle,
+     const system_character_t *filename,
+     libcerror_error_t **error );
+
+int compact_handle_close_input(
+     compact_handle_t *compact_handle,
+     libcerror_error_t **error );
+
+int compact_handle_compact(
+     compact_handle_t *compact_handle,
+     const system_character_t *target_filename,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _COMPACT_HANDLE_H ) */
+
@@ -0,0 +1,2034 @@
+/*
+ * Export handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_ERRNO_H )
+#include <errno.h>
+#endif
+
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_SYS_STAT_H )
+#include <sys/stat.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "export_handle.h"
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libcthreads.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_unused.h"
+
+#if defined( HAVE_EXPORT_HANDLE_SUPPORT )
+
+/* Creates an export handle
+ * Make sure the value export_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_initialize(
+     export_handle_t **export_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_initialize";
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *export_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid export handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	*export_handle = memory_allocate_structure(
+	                  export_handle_t );
+
+	if( *export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create export handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *export_handle,
+	     0,
+	     sizeof( export_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear export handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *export_handle )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( ( *export_handle )->slot_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize slot condition.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	( *export_handle )->mount_handle           = mount_handle;
+	( *export_handle )->output_file_descriptor = -1;
+	( *export_handle )->number_of_threads      = EXPORT_HANDLE_DEFAULT_NUMBER_OF_THREADS;
+
+	return( 1 );
+
+on_error:
+	if( *export_handle != NULL )
+	{
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( ( *export_handle )->mutex != NULL )
+		{
+			libcthreads_mutex_free(
+			 &( ( *export_handle )->mutex ),
+			 NULL );
+		}
+#endif
+		memory_free(
+		 *export_handle );
+
+		*export_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees an export handle
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_free(
+     export_handle_t **export_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_free";
+	int result            = 1;
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *export_handle != NULL )
+	{
+		/* The mount_handle reference is freed elsewhere
+		 */
+		if( ( *export_handle )->output_file_descriptor != -1 )
+		{
+			if( export_handle_close_output(
+			     *export_handle,
+			     error ) != 0 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+				 "%s: unable to close output.",
+				 function );
+
+				result = -1;
+			}
+		}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_free(
+		     &( ( *export_handle )->slot_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free slot condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_free(
+		     &( ( *export_handle )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *export_handle );
+
+		*export_handle = NULL;
+	}
+	return( result );
+}
+
+/* Signals the export handle to abort
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_signal_abort(
+     export_handle_t *export_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_signal_abort";
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	export_handle->abort = 1;
+
+	return( 1 );
+}
+
+/* Sets the number of threads
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_set_number_of_threads(
+     export_handle_t *export_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_set_number_of_threads";
+	size_t string_index   = 0;
+	uint64_t value_64bit  = 0;
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( string[ string_index ] < (system_character_t) '0' )
+	 || ( string[ string_index ] > (system_character_t) '9' ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+		 function,
+		 string_index );
+
+		return( -1 );
+	}
+	while( ( string[ string_index ] >= (system_character_t) '0' )
+	    && ( string[ string_index ] <= (system_character_t) '9' ) )
+	{
+		value_64bit *= 10;
+		value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( value_64bit > (uint64_t) EXPORT_HANDLE_MAXIMUM_NUMBER_OF_THREADS )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		string_index++;
+	}
+	if( string[ string_index ] != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - trailing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( value_64bit == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid string - value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	export_handle->number_of_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the notification stream on which the status is printed
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_set_notify_stream(
+     export_handle_t *export_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_set_notify_stream";
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	export_handle->notify_stream = notify_stream;
+
+	return( 1 );
+}
+
+/* Opens the output
+ * A regular file is truncated to the media size, which makes it a sparse file,
+ * other outputs, such as block devices, are overwritten
+ * Returns 1 if successful or -1 on error
+ */
+int export_handle_open_output(
+     export_handle_t *export_handle,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	struct stat file_statistics;
+
+	static char *function = "export_handle_open_output";
+	int file_descriptor   = -1;
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_handle->output_file_descriptor != -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid export handle - output file descriptor value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( filename == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid filename.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle_get_media_size(
+	     export_handle->mount_handle,
+	     0,
+	     &( export_handle->media_size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		goto on_error;
+	}
+	if( export_handle->media_size > (size64_t) INT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid media size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	export_handle->output_is_sparse_file = 0;
+	export_handle->output_is_stream      = 0;
+
+	/* The standard output is written in order, since it can be a pipe
+	 * or a file that was opened for appending
+	 */
+	if( ( filename[ 0 ] == '-' )
+	 && ( filename[ 1 ] == 0 ) )
+	{
+		file_descriptor = dup(
+		                   STDOUT_FILENO );
+
+		if( file_descriptor == -1 )
+		{
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to duplicate standard output.",
+			 function );
+
+			goto on_error;
+		}
+		export_handle->output_is_stream       = 1;
+		export_handle->output_file_descriptor = file_descriptor;
+
+		return( 1 );
+	}
+	file_descriptor = open(
+	                   filename,
+	                   O_WRONLY | O_CREAT,
+	                   0644 );
+
+	if( file_descriptor == -1 )
+	{
+		libcerror_system_set_error(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 (uint32_t) errno,
+		 "%s: unable to open output file: %s.",
+		 function,
+		 filename );
+
+		goto on_error;
+	}
+	if( fstat(
+	     file_descriptor,
+	     &file_statistics ) != 0 )
+	{
+		libcerror_system_set_error(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_GENERIC,
+		 (uint32_t) errno,
+		 "%s: unable to determine output file type.",
+		 function );
+
+		goto on_error;
+	}
+	if( S_ISREG( file_statistics.st_mode ) )
+	{
+		/* Truncate to 0 first so that previous data does not remain in the holes
+		 */
+		if( ( ftruncate(
+		       file_descriptor,
+		       0 ) != 0 )
+		 || ( ftruncate(
+		       file_descriptor,
+		       (off_t) export_handle->media_size ) != 0 ) )
+		{
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to truncate output file.",
+			 function );
+
+			goto on_error;
+		}
+		export_handle->output_is_sparse_file = 1;
+	}
+	else if( !S_ISBLK( file_statistics.st_mode ) )
+	{
+		/* Pipes, sockets and character devices cannot be written at an offset
+		 */
+		export_handle->output_is_stream = 1;
+	}
+	export_handle->output_file_descriptor = file_descriptor;
+
+	return( 1 );
+
+on_error:
+	if( file_descriptor != -1 )
+	{
+		close(
+		 file_descriptor );
+	}
+	return( -1 );
+}
+
+/* Closes the output
+ * Returns the 0 if succesful or -1 on error
+ */
+int export_handle_close_output(
+     export_handle_t *export_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "export_handle_close_output";
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_handle->output_file_descriptor == -1 )
+	{
+		return( 0 );
+	}
+	if( close(
+	     export_handle->output_file_descriptor ) != 0 )
+	{
+		libcerror_system_set_error(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 (uint32_t) errno,
+		 "%s: unable to close output file.",
+		 function );
+
+		export_handle->output_file_descriptor = -1;
+
+		return( -1 );
+	}
+	export_handle->output_file_descriptor = -1;
+
+	return( 0 );
+}
+
+/* Writes data to the output at a specific offset
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_write_buffer_at_offset(
+            export_handle_t *export_handle,
+            const uint8_t *buffer,
+            size_t size,
+            off64_t offset,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_write_buffer_at_offset";
+	size_t buffer_offset  = 0;
+	ssize_t write_count   = 0;
+
+	while( buffer_offset < size )
+	{
+		write_count = pwrite(
+		               export_handle->output_file_descriptor,
+		               &( buffer[ buffer_offset ] ),
+		               size - buffer_offset,
+		               (off_t) ( offset + (off64_t) buffer_offset ) );
+
+		if( write_count < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 offset + (off64_t) buffer_offset,
+			 offset + (off64_t) buffer_offset );
+
+			return( -1 );
+		}
+		else if( write_count == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ") - no space left.",
+			 function,
+			 offset + (off64_t) buffer_offset,
+			 offset + (off64_t) buffer_offset );
+
+			return( -1 );
+		}
+		buffer_offset += (size_t) write_count;
+	}
+	return( 1 );
+}
+
+/* Writes a range that reads as zero bytes to the output
+ * The range is punched out of the output if supported, otherwise zero bytes are written
+ * The buffer is used as zero bytes and must be at least size bytes in size
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_write_hole_at_offset(
+            export_handle_t *export_handle,
+            uint8_t *buffer,
+            size_t size,
+            off64_t offset,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_write_hole_at_offset";
+
+	/* The holes of a truncated regular file already read as zero bytes
+	 */
+	if( export_handle->output_is_sparse_file != 0 )
+	{
+		return( 1 );
+	}
+#if defined( HAVE_FALLOCATE ) && defined( FALLOC_FL_PUNCH_HOLE ) && defined( FALLOC_FL_KEEP_SIZE )
+	if( fallocate(
+	     export_handle->output_file_descriptor,
+	     FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+	     (off_t) offset,
+	     (off_t) size ) == 0 )
+	{
+		return( 1 );
+	}
+#endif
+	if( memory_set(
+	     buffer,
+	     0,
+	     size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear buffer.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_handle_write_buffer_at_offset(
+	     export_handle,
+	     buffer,
+	     size,
+	     offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write zero bytes.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Determines if a buffer only contains zero bytes
+ * Returns 1 if the buffer only contains zero bytes or 0 if not
+ */
+static int export_handle_buffer_is_zero(
+            const uint8_t *buffer,
+            size_t size )
+{
+	if( size == 0 )
+	{
+		return( 1 );
+	}
+	if( buffer[ 0 ] != 0 )
+	{
+		return( 0 );
+	}
+	/* Compare the buffer with itself shifted by one byte
+	 */
+	if( memory_compare(
+	     buffer,
+	     &( buffer[ 1 ] ),
+	     size - 1 ) != 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Exports a chunk of the media
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_export_chunk(
+            export_handle_t *export_handle,
+            uint8_t *buffer,
+            off64_t chunk_offset,
+            size_t chunk_size,
+            size_t *written_size,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_export_chunk";
+	size64_t range_size   = 0;
+	size_t data_offset    = 0;
+	ssize_t read_count    = 0;
+	off64_t range_offset  = 0;
+	uint8_t is_hole       = 0;
+
+	*written_size = 0;
+
+	while( data_offset < chunk_size )
+	{
+		if( export_handle->abort != 0 )
+		{
+			break;
+		}
+		range_offset = chunk_offset + (off64_t) data_offset;
+
+		if( mount_handle_get_range_at_offset(
+		     export_handle->mount_handle,
+		     0,
+		     range_offset,
+		     (size64_t) ( chunk_size - data_offset ),
+		     &range_size,
+		     &is_hole,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( range_size == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: missing range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( is_hole == 0 )
+		{
+			read_count = mount_handle_read_buffer_at_offset(
+			              export_handle->mount_handle,
+			              0,
+			              buffer,
+			              (size_t) range_size,
+			              range_offset,
+			              error );
+
+			if( read_count != (ssize_t) range_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+			/* Allocated clusters that only contain zero bytes are exported as holes as well
+			 */
+			if( ( export_handle->output_is_sparse_file != 0 )
+			 && ( export_handle_buffer_is_zero(
+			       buffer,
+			       (size_t) range_size ) != 0 ) )
+			{
+				is_hole = 1;
+			}
+		}
+		if( is_hole != 0 )
+		{
+			if( export_handle_write_hole_at_offset(
+			     export_handle,
+			     buffer,
+			     (size_t) range_size,
+			     range_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write hole at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+		}
+		else
+		{
+			if( export_handle_write_buffer_at_offset(
+			     export_handle,
+			     buffer,
+			     (size_t) range_size,
+			     range_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+			*written_size += (size_t) range_size;
+		}
+		data_offset += (size_t) range_size;
+	}
+	return( 1 );
+}
+
+/* Prints the export status
+ * The caller must hold the mutex
+ */
+static void export_handle_print_status(
+             export_handle_t *export_handle,
+             int is_final )
+{
+	size64_t bytes_per_second = 0;
+	int percentage            = 100;
+
+#if defined( HAVE_TIME )
+	time_t current_time       = 0;
+	time_t elapsed_time       = 0;
+#endif
+
+	if( export_handle->notify_stream == NULL )
+	{
+		return;
+	}
+#if defined( HAVE_TIME )
+	current_time = time(
+	                NULL );
+
+	if( ( is_final == 0 )
+	 && ( current_time == export_handle->last_status_time ) )
+	{
+		return;
+	}
+	export_handle->last_status_time = current_time;
+
+	elapsed_time = current_time - export_handle->start_time;
+
+	if( elapsed_time > 0 )
+	{
+		bytes_per_second = export_handle->exported_size / (size64_t) elapsed_time;
+	}
+#else
+	if( is_final == 0 )
+	{
+		return;
+	}
+#endif
+	if( export_handle->media_size > 0 )
+	{
+		percentage = (int) ( ( export_handle->exported_size * 100 ) / export_handle->media_size );
+	}
+	fprintf(
+	 export_handle->notify_stream,
+	 "Status: exported %" PRIu64 " of %" PRIu64 " bytes (%d%%), written %" PRIu64 " bytes of data, at %" PRIu64 " MiB/s\n",
+	 export_handle->exported_size,
+	 export_handle->media_size,
+	 percentage,
+	 export_handle->written_size,
+	 bytes_per_second / ( 1024 * 1024 ) );
+}
+
+/* Exports chunks of the media until all chunks are exported
+ * The chunks are claimed one at a time, hence multiple threads export disjoint ranges
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_export_chunks(
+            export_handle_t *export_handle,
+            void *arguments QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	uint8_t *buffer          = NULL;
+	static char *function    = "export_handle_export_chunks";
+	size_t chunk_size        = 0;
+	size_t written_size      = 0;
+	off64_t chunk_offset     = 0;
+	int result               = 1;
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( arguments )
+
+	if( export_handle == NULL )
+	{
+		return( -1 );
+	}
+	buffer = (uint8_t *) memory_allocate(
+	                      sizeof( uint8_t ) * EXPORT_HANDLE_CHUNK_SIZE );
+
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buffer.",
+		 function );
+
+		result = -1;
+	}
+	while( ( result == 1 )
+	    && ( export_handle->abort == 0 ) )
+	{
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     export_handle->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+#endif
+		chunk_offset = export_handle->next_chunk_offset;
+		chunk_size   = 0;
+
+		if( (size64_t) chunk_offset < export_handle->media_size )
+		{
+			chunk_size = EXPORT_HANDLE_CHUNK_SIZE;
+
+			if( (size64_t) chunk_size > ( export_handle->media_size - chunk_offset ) )
+			{
+				chunk_size = (size_t) ( export_handle->media_size - chunk_offset );
+			}
+			export_handle->next_chunk_offset += (off64_t) chunk_size;
+		}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+#endif
+		if( chunk_size == 0 )
+		{
+			break;
+		}
+		if( export_handle_export_chunk(
+		     export_handle,
+		     buffer,
+		     chunk_offset,
+		     chunk_size,
+		     &written_size,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to export chunk at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 chunk_offset,
+			 chunk_offset );
+
+			result = -1;
+
+			break;
+		}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     export_handle->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+#endif
+		export_handle->exported_size += chunk_size;
+		export_handle->written_size  += written_size;
+
+		export_handle_print_status(
+		 export_handle,
+		 0 );
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+#endif
+	}
+	if( result != 1 )
+	{
+		/* Stop the other threads
+		 */
+		export_handle->export_failed = 1;
+		export_handle->abort         = 1;
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( buffer != NULL )
+	{
+		memory_free(
+		 buffer );
+	}
+	return( result );
+}
+
+/* Writes data to the output in order
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_write_buffer(
+            export_handle_t *export_handle,
+            const uint8_t *buffer,
+            size_t size,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_write_buffer";
+	size_t buffer_offset  = 0;
+	ssize_t write_count   = 0;
+
+	while( buffer_offset < size )
+	{
+		write_count = write(
+		               export_handle->output_file_descriptor,
+		               &( buffer[ buffer_offset ] ),
+		               size - buffer_offset );
+
+		if( write_count < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to write data.",
+			 function );
+
+			return( -1 );
+		}
+		else if( write_count == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write data - no space left.",
+			 function );
+
+			return( -1 );
+		}
+		buffer_offset += (size_t) write_count;
+	}
+	return( 1 );
+}
+
+/* Reads a chunk of the media into a slot
+ * Ranges that read as zero bytes are not read but cleared in the buffer
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_read_chunk(
+            export_handle_t *export_handle,
+            export_handle_slot_t *slot,
+            uint64_t chunk_index,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_read_chunk";
+	size64_t range_size   = 0;
+	size_t chunk_size     = 0;
+	size_t data_offset    = 0;
+	ssize_t read_count    = 0;
+	off64_t chunk_offset  = 0;
+	off64_t range_offset  = 0;
+	uint8_t is_hole       = 0;
+
+	chunk_offset = (off64_t) ( chunk_index * EXPORT_HANDLE_CHUNK_SIZE );
+	chunk_size   = EXPORT_HANDLE_CHUNK_SIZE;
+
+	if( (size64_t) chunk_size > ( export_handle->media_size - chunk_offset ) )
+	{
+		chunk_size = (size_t) ( export_handle->media_size - chunk_offset );
+	}
+	slot->data_size = chunk_size;
+
+	while( data_offset < chunk_size )
+	{
+		if( export_handle->abort != 0 )
+		{
+			return( 1 );
+		}
+		range_offset = chunk_offset + (off64_t) data_offset;
+
+		if( mount_handle_get_range_at_offset(
+		     export_handle->mount_handle,
+		     0,
+		     range_offset,
+		     (size64_t) ( chunk_size - data_offset ),
+		     &range_size,
+		     &is_hole,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( range_size == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: missing range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( is_hole == 0 )
+		{
+			read_count = mount_handle_read_buffer_at_offset(
+			              export_handle->mount_handle,
+			              0,
+			              &( slot->buffer[ data_offset ] ),
+			              (size_t) range_size,
+			              range_offset,
+			              error );
+
+			if( read_count != (ssize_t) range_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+		}
+		else if( memory_set(
+		          &( slot->buffer[ data_offset ] ),
+		          0,
+		          (size_t) range_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear buffer.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += (size_t) range_size;
+	}
+	return( 1 );
+}
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+
+/* Reads chunks of the media into the slots until all chunks are read
+ * The chunks are claimed in order and a chunk is stored in slot: chunk index % number of slots,
+ * once the chunk that previously occupied the slot was written
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_read_chunks(
+            export_handle_t *export_handle,
+            void *arguments QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	export_handle_slot_t *slot = NULL;
+	libcerror_error_t *error   = NULL;
+	static char *function      = "export_handle_read_chunks";
+	uint64_t chunk_index       = 0;
+	int mutex_grabbed          = 0;
+	int result                 = 1;
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( arguments )
+
+	if( export_handle == NULL )
+	{
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     export_handle->mutex,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		mutex_grabbed = 1;
+	}
+	while( result == 1 )
+	{
+		if( ( export_handle->abort != 0 )
+		 || ( export_handle->export_failed != 0 )
+		 || ( export_handle->next_chunk_index >= export_handle->number_of_chunks ) )
+		{
+			break;
+		}
+		chunk_index = export_handle->next_chunk_index++;
+
+		slot = &( export_handle->slots[ chunk_index % export_handle->number_of_slots ] );
+
+		while( ( slot->state != EXPORT_HANDLE_SLOT_STATE_EMPTY )
+		    || ( slot->chunk_index != chunk_index ) )
+		{
+			if( ( export_handle->abort != 0 )
+			 || ( export_handle->export_failed != 0 ) )
+			{
+				break;
+			}
+			if( libcthreads_condition_wait(
+			     export_handle->slot_condition,
+			     export_handle->mutex,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to wait for slot condition.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+		}
+		if( ( result != 1 )
+		 || ( export_handle->abort != 0 )
+		 || ( export_handle->export_failed != 0 ) )
+		{
+			break;
+		}
+		slot->state = EXPORT_HANDLE_SLOT_STATE_BUSY;
+
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+
+		mutex_grabbed = 0;
+
+		if( export_handle_read_chunk(
+		     export_handle,
+		     slot,
+		     chunk_index,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_grab(
+		     export_handle->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+		mutex_grabbed = 1;
+
+		if( result == 1 )
+		{
+			slot->state = EXPORT_HANDLE_SLOT_STATE_READY;
+		}
+		libcthreads_condition_broadcast(
+		 export_handle->slot_condition,
+		 NULL );
+	}
+	if( result != 1 )
+	{
+		/* Stop the other threads
+		 */
+		export_handle->export_failed = 1;
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	libcthreads_condition_broadcast(
+	 export_handle->slot_condition,
+	 NULL );
+
+	if( mutex_grabbed != 0 )
+	{
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+	}
+	return( result );
+}
+
+/* Writes the chunks in the slots in order, while the threads of the thread pool read the chunks
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_write_slots(
+            export_handle_t *export_handle,
+            libcerror_error_t **error )
+{
+	export_handle_slot_t *slot = NULL;
+	static char *function      = "export_handle_write_slots";
+	uint64_t chunk_index       = 0;
+	int result                 = 1;
+
+	for( chunk_index = 0;
+	     chunk_index < export_handle->number_of_chunks;
+	     chunk_index++ )
+	{
+		slot = &( export_handle->slots[ chunk_index % export_handle->number_of_slots ] );
+
+		if( libcthreads_mutex_grab(
+		     export_handle->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+		while( ( slot->state != EXPORT_HANDLE_SLOT_STATE_READY )
+		    || ( slot->chunk_index != chunk_index ) )
+		{
+			if( ( export_handle->abort != 0 )
+			 || ( export_handle->export_failed != 0 ) )
+			{
+				break;
+			}
+			if( libcthreads_condition_wait(
+			     export_handle->slot_condition,
+			     export_handle->mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to wait for slot condition.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+		}
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+
+		if( ( result != 1 )
+		 || ( export_handle->abort != 0 )
+		 || ( export_handle->export_failed != 0 ) )
+		{
+			break;
+		}
+		/* The slot is not changed by the threads while it is ready
+		 */
+		if( export_handle_write_buffer(
+		     export_handle,
+		     slot->buffer,
+		     slot->data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			result = -1;
+
+			break;
+		}
+		if( libcthreads_mutex_grab(
+		     export_handle->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+		export_handle->exported_size += slot->data_size;
+		export_handle->written_size  += slot->data_size;
+
+		slot->state        = EXPORT_HANDLE_SLOT_STATE_EMPTY;
+		slot->chunk_index += (uint64_t) export_handle->number_of_slots;
+
+		export_handle_print_status(
+		 export_handle,
+		 0 );
+
+		libcthreads_condition_broadcast(
+		 export_handle->slot_condition,
+		 NULL );
+
+		libcthreads_mutex_release(
+		 export_handle->mutex,
+		 NULL );
+	}
+	if( result != 1 )
+	{
+		/* Stop the threads
+		 */
+		export_handle->export_failed = 1;
+	}
+	/* Wake the threads that wait for a slot after an abort or failure
+	 */
+	libcthreads_condition_broadcast(
+	 export_handle->slot_condition,
+	 NULL );
+
+	return( result );
+}
+
+#endif /* defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT ) */
+
+/* Frees the slots
+ */
+static void export_handle_free_slots(
+             export_handle_t *export_handle )
+{
+	int slot_index = 0;
+
+	if( export_handle->slots != NULL )
+	{
+		for( slot_index = 0;
+		     slot_index < export_handle->number_of_slots;
+		     slot_index++ )
+		{
+			if( export_handle->slots[ slot_index ].buffer != NULL )
+			{
+				memory_free(
+				 export_handle->slots[ slot_index ].buffer );
+			}
+		}
+		memory_free(
+		 export_handle->slots );
+
+		export_handle->slots = NULL;
+	}
+	export_handle->number_of_slots = 0;
+}
+
+/* Creates the slots
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_initialize_slots(
+            export_handle_t *export_handle,
+            int number_of_slots,
+            libcerror_error_t **error )
+{
+	static char *function = "export_handle_initialize_slots";
+	int slot_index        = 0;
+
+	export_handle->slots = (export_handle_slot_t *) memory_allocate(
+	                                                 sizeof( export_handle_slot_t ) * number_of_slots );
+
+	if( export_handle->slots == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create slots.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     export_handle->slots,
+	     0,
+	     sizeof( export_handle_slot_t ) * number_of_slots ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear slots.",
+		 function );
+
+		memory_free(
+		 export_handle->slots );
+
+		export_handle->slots = NULL;
+
+		goto on_error;
+	}
+	export_handle->number_of_slots = number_of_slots;
+
+	for( slot_index = 0;
+	     slot_index < number_of_slots;
+	     slot_index++ )
+	{
+		export_handle->slots[ slot_index ].buffer = (uint8_t *) memory_allocate(
+		                                                         sizeof( uint8_t ) * EXPORT_HANDLE_CHUNK_SIZE );
+
+		if( export_handle->slots[ slot_index ].buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create slot: %d buffer.",
+			 function,
+			 slot_index );
+
+			goto on_error;
+		}
+		export_handle->slots[ slot_index ].chunk_index = (uint64_t) slot_index;
+	}
+	return( 1 );
+
+on_error:
+	export_handle_free_slots(
+	 export_handle );
+
+	return( -1 );
+}
+
+/* Exports the media of the input file to an output stream
+ * The threads of the thread pool read the chunks ahead into a ring of slots,
+ * while the chunks are written in order, so that both the input and the output are kept busy
+ * Returns 1 if successful or -1 on error
+ */
+static int export_handle_export_stream(
+            export_handle_t *export_handle,
+            libcerror_error_t **error )
+{
+	static char *function                  = "export_handle_export_stream";
+	int number_of_slots                    = 1;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_pool_t *thread_pool = NULL;
+	int result                             = 1;
+	int thread_index                       = 0;
+#else
+	uint64_t chunk_index                   = 0;
+#endif
+
+	if( export_handle->slots != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid export handle - slots value already set.",
+		 function );
+
+		return( -1 );
+	}
+	export_handle->number_of_chunks = export_handle->media_size / EXPORT_HANDLE_CHUNK_SIZE;
+
+	if( ( export_handle->media_size % EXPORT_HANDLE_CHUNK_SIZE ) != 0 )
+	{
+		export_handle->number_of_chunks += 1;
+	}
+	export_handle->next_chunk_index = 0;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	/* Twice the number of threads allows the threads to read ahead
+	 * while the chunks are written in order, a single thread still
+	 * fills one slot while the other is written
+	 */
+	number_of_slots = 2 * export_handle->number_of_threads;
+#endif
+	if( export_handle_initialize_slots(
+	     export_handle,
+	     number_of_slots,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize slots.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_thread_pool_create(
+	     &thread_pool,
+	     NULL,
+	     export_handle->number_of_threads,
+	     export_handle->number_of_threads,
+	     (int (*)(intptr_t *, void *)) &export_handle_read_chunks,
+	     NULL,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to create thread pool.",
+		 function );
+
+		goto on_error;
+	}
+	/* Every thread reads chunks until all chunks are read
+	 */
+	for( thread_index = 0;
+	     thread_index < export_handle->number_of_threads;
+	     thread_index++ )
+	{
+		if( libcthreads_thread_pool_push(
+		     thread_pool,
+		     (intptr_t *) export_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to push read onto thread pool queue.",
+			 function );
+
+			export_handle->export_failed = 1;
+
+			libcthreads_condition_broadcast(
+			 export_handle->slot_condition,
+			 NULL );
+			libcthreads_thread_pool_join(
+			 &thread_pool,
+			 NULL );
+
+			goto on_error;
+		}
+	}
+	result = export_handle_write_slots(
+	          export_handle,
+	          error );
+
+	if( libcthreads_thread_pool_join(
+	     &thread_pool,
+	     ( result == 1 ) ? error : NULL ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to join thread pool.",
+		 function );
+
+		goto on_error;
+	}
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to write slots.",
+		 function );
+
+		goto on_error;
+	}
+#else
+	for( chunk_index = 0;
+	     chunk_index < export_handle->number_of_chunks;
+	     chunk_index++ )
+	{
+		if( export_handle->abort != 0 )
+		{
+			break;
+		}
+		if( export_handle_read_chunk(
+		     export_handle,
+		     &( export_handle->slots[ 0 ] ),
+		     chunk_index,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			goto on_error;
+		}
+		if( export_handle->abort != 0 )
+		{
+			break;
+		}
+		if( export_handle_write_buffer(
+		     export_handle,
+		     export_handle->slots[ 0 ].buffer,
+		     export_handle->slots[ 0 ].data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			goto on_error;
+		}
+		export_handle->exported_size += export_handle->slots[ 0 ].data_size;
+		export_handle->written_size  += export_handle->slots[ 0 ].data_size;
+
+		export_handle_print_status(
+		 export_handle,
+		 0 );
+	}
+#endif
+	export_handle_free_slots(
+	 export_handle );
+
+	return( 1 );
+
+on_error:
+	export_handle->export_failed = 1;
+
+	export_handle_free_slots(
+	 export_handle );
+
+	return( -1 );
+}
+
+/* Exports the media of the input file to the output
+ * Returns 1 if successful, 0 if aborted or -1 on error
+ */
+int export_handle_export(
+     export_handle_t *export_handle,
+     libcerror_error_t **error )
+{
+	static char *function                  = "export_handle_export";
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_pool_t *thread_pool = NULL;
+	int thread_index                       = 0;
+#endif
+
+	if( export_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_handle->output_file_descriptor == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid export handle - missing output file descriptor.",
+		 function );
+
+		return( -1 );
+	}
+	export_handle->next_chunk_offset = 0;
+	export_handle->exported_size     = 0;
+	export_handle->written_size      = 0;
+	export_handle->export_failed     = 0;
+
+#if defined( HAVE_TIME )
+	export_handle->start_time       = time(
+	                                   NULL );
+	export_handle->last_status_time = export_handle->start_time;
+#endif
+
+	if( export_handle->output_is_stream != 0 )
+	{
+		if( export_handle_export_stream(
+		     export_handle,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to export media to stream.",
+			 function );
+
+			return( -1 );
+		}
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	else if( export_handle->number_of_threads > 1 )
+	{
+		if( libcthreads_thread_pool_create(
+		     &thread_pool,
+		     NULL,
+		     export_handle->number_of_threads,
+		     export_handle->number_of_threads,
+		     (int (*)(intptr_t *, void *)) &export_handle_export_chunks,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread pool.",
+			 function );
+
+			return( -1 );
+		}
+		/* Every thread claims chunks until all chunks are exported
+		 */
+		for( thread_index = 0;
+		     thread_index < export_handle->number_of_threads;
+		     thread_index++ )
+		{
+			if( libcthreads_thread_pool_push(
+			     thread_pool,
+			     (intptr_t *) export_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to push export onto thread pool queue.",
+				 function );
+
+				export_handle->abort = 1;
+
+				libcthreads_thread_pool_join(
+				 &thread_pool,
+				 NULL );
+
+				return( -1 );
+			}
+		}
+		if( libcthreads_thread_pool_join(
+		     &thread_pool,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread pool.",
+			 function );
+
+			return( -1 );
+		}
+	}
+#endif
+	else
+	{
+		export_handle_export_chunks(
+		 export_handle,
+		 NULL );
+	}
+	if( export_handle->export_failed != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to export media.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_handle->abort != 0 )
+	{
+		return( 0 );
+	}
+	export_handle_print_status(
+	 export_handle,
+	 1 );
+
+	return( 1 );
+}
+
+#endif /* defined( HAVE_EXPORT_HANDLE_SUPPORT ) */
+
@@ -0,0 +1,224 @@
+/*
+ * Export handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _EXPORT_HANDLE_H )
+#define _EXPORT_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( TIME_WITH_SYS_TIME )
+#include <sys/time.h>
+#include <time.h>
+#elif defined( HAVE_SYS_TIME_H )
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if !defined( WINAPI ) && defined( HAVE_FCNTL_H ) && defined( HAVE_SYS_STAT_H ) && defined( HAVE_UNISTD_H ) && defined( HAVE_FTRUNCATE ) && defined( HAVE_PWRITE )
+#define HAVE_EXPORT_HANDLE_SUPPORT
+#endif
+
+/* The size of the chunks of the media that are exported by a single thread
+ */
+#define EXPORT_HANDLE_CHUNK_SIZE		( 8 * 1024 * 1024 )
+
+/* The default number of threads
+ */
+#define EXPORT_HANDLE_DEFAULT_NUMBER_OF_THREADS	4
+
+/* The maximum number of threads
+ */
+#define EXPORT_HANDLE_MAXIMUM_NUMBER_OF_THREADS	64
+
+enum EXPORT_HANDLE_SLOT_STATES
+{
+	EXPORT_HANDLE_SLOT_STATE_EMPTY		= 0,
+	EXPORT_HANDLE_SLOT_STATE_BUSY		= 1,
+	EXPORT_HANDLE_SLOT_STATE_READY		= 2
+};
+
+typedef struct export_handle_slot export_handle_slot_t;
+
+struct export_handle_slot
+{
+	/* The buffer that contains the data of the chunk
+	 */
+	uint8_t *buffer;
+
+	/* The index of the chunk that is or will be stored in the slot
+	 */
+	uint64_t chunk_index;
+
+	/* The size of the data of the chunk
+	 */
+	size_t data_size;
+
+	/* The state
+	 */
+	int state;
+};
+
+typedef struct export_handle export_handle_t;
+
+struct export_handle
+{
+	/* The mount handle, which provides the input file
+	 * this value is not managed by the export handle
+	 */
+	mount_handle_t *mount_handle;
+
+	/* The output file descriptor
+	 * -1 if not set
+	 */
+	int output_file_descriptor;
+
+	/* Value to indicate the output is a regular file that was truncated,
+	 * in which case ranges that read as zero bytes are not written
+	 */
+	uint8_t output_is_sparse_file;
+
+	/* Value to indicate the output is a stream, such as a pipe or a socket,
+	 * in which case the media is written in order
+	 */
+	uint8_t output_is_stream;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The number of threads
+	 */
+	int number_of_threads;
+
+	/* The offset of the next chunk to export
+	 */
+	off64_t next_chunk_offset;
+
+	/* The number of chunks, used when the output is a stream
+	 */
+	uint64_t number_of_chunks;
+
+	/* The index of the next chunk to read, used when the output is a stream
+	 */
+	uint64_t next_chunk_index;
+
+	/* The slots, which are used as a ring buffer of chunks
+	 * when the output is a stream
+	 */
+	export_handle_slot_t *slots;
+
+	/* The number of slots
+	 */
+	int number_of_slots;
+
+	/* The size of the media that was exported
+	 */
+	size64_t exported_size;
+
+	/* The size of the data that was written
+	 */
+	size64_t written_size;
+
+	/* The time the export started
+	 */
+	time_t start_time;
+
+	/* The time the last status was printed
+	 */
+	time_t last_status_time;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	/* The mutex that protects the export state
+	 */
+	libcthreads_mutex_t *mutex;
+
+	/* The condition that is signalled when the state of a slot changes
+	 */
+	libcthreads_condition_t *slot_condition;
+#endif
+
+	/* Value to indicate one of the threads failed
+	 */
+	int export_failed;
+
+	/* The notification output stream
+	 * NULL if no status is printed
+	 */
+	FILE *notify_stream;
+
+	/* Value to indicate if abort was signalled
+	 */
+	int abort;
+};
+
+int export_handle_initialize(
+     export_handle_t **export_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error );
+
+int export_handle_free(
+     export_handle_t **export_handle,
+     libcerror_error_t **error );
+
+int export_handle_signal_abort(
+     export_handle_t *export_handle,
+     libcerror_error_t **error );
+
+int export_handle_set_number_of_threads(
+     export_handle_t *export_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int export_handle_set_notify_stream(
+     export_handle_t *export_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error );
+
+int export_handle_open_output(
+     export_handle_t *export_handle,
+     const char *filename,
+     libcerror_error_t **error );
+
+int export_handle_close_output(
+     export_handle_t *export_handle,
+     libcerror_error_t **error );
+
+int export_handle_export(
+     export_handle_t *export_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _EXPORT_HANDLE_H ) */
+
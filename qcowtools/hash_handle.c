@@ -0,0 +1,1933 @@
+/*
+ * Hash handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_OPENSSL_EVP_H )
+#include <openssl/evp.h>
+#endif
+
+#include "hash_handle.h"
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libcthreads.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_unused.h"
+
+#if defined( HAVE_HASH_HANDLE_SUPPORT )
+
+/* OpenSSL 1.1 renamed the functions to create and free a message digest context
+ */
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+#define EVP_MD_CTX_new		EVP_MD_CTX_create
+#define EVP_MD_CTX_free		EVP_MD_CTX_destroy
+#endif
+
+/* The digest types in the order in which the digest hashes are stored
+ */
+static const uint8_t hash_handle_digest_types[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ] = {
+	HASH_HANDLE_DIGEST_TYPE_MD5,
+	HASH_HANDLE_DIGEST_TYPE_SHA1,
+	HASH_HANDLE_DIGEST_TYPE_SHA256 };
+
+static const size_t hash_handle_digest_hash_sizes[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ] = {
+	16,
+	20,
+	32 };
+
+static const char *hash_handle_digest_type_names[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ] = {
+	"md5",
+	"sha1",
+	"sha256" };
+
+static const char *hash_handle_digest_type_labels[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ] = {
+	"MD5",
+	"SHA1",
+	"SHA256" };
+
+/* Retrieves the message digest of a specific digest type index
+ * Returns the message digest or NULL if not available
+ */
+static const EVP_MD *hash_handle_get_message_digest(
+                      int digest_type_index )
+{
+	switch( digest_type_index )
+	{
+		case 0:
+			return( EVP_md5() );
+
+		case 1:
+			return( EVP_sha1() );
+
+		case 2:
+			return( EVP_sha256() );
+
+		default:
+			break;
+	}
+	return( NULL );
+}
+
+/* Creates a hash handle
+ * Make sure the value hash_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_initialize(
+     hash_handle_t **hash_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_initialize";
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *hash_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid hash handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	*hash_handle = memory_allocate_structure(
+	                hash_handle_t );
+
+	if( *hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create hash handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *hash_handle,
+	     0,
+	     sizeof( hash_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear hash handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *hash_handle )->mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize mutex.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcthreads_condition_initialize(
+	     &( ( *hash_handle )->slot_condition ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize slot condition.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	( *hash_handle )->mount_handle      = mount_handle;
+	( *hash_handle )->digest_types      = HASH_HANDLE_DIGEST_TYPE_MD5;
+	( *hash_handle )->mode              = HASH_HANDLE_MODE_LINEAR;
+	( *hash_handle )->chunk_size        = HASH_HANDLE_DEFAULT_CHUNK_SIZE;
+	( *hash_handle )->number_of_threads = HASH_HANDLE_DEFAULT_NUMBER_OF_THREADS;
+
+	return( 1 );
+
+on_error:
+	if( *hash_handle != NULL )
+	{
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( ( *hash_handle )->mutex != NULL )
+		{
+			libcthreads_mutex_free(
+			 &( ( *hash_handle )->mutex ),
+			 NULL );
+		}
+#endif
+		memory_free(
+		 *hash_handle );
+
+		*hash_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a hash handle
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_free(
+     hash_handle_t **hash_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_free";
+	int result            = 1;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *hash_handle != NULL )
+	{
+		/* The mount_handle reference is freed elsewhere
+		 */
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_condition_free(
+		     &( ( *hash_handle )->slot_condition ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free slot condition.",
+			 function );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_free(
+		     &( ( *hash_handle )->mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 *hash_handle );
+
+		*hash_handle = NULL;
+	}
+	return( result );
+}
+
+/* Signals the hash handle to abort
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_signal_abort(
+     hash_handle_t *hash_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_signal_abort";
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	hash_handle->abort = 1;
+
+	return( 1 );
+}
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_copy_decimal_from_string(
+            const system_character_t *string,
+            uint64_t maximum_value,
+            uint64_t *value_64bit,
+            libcerror_error_t **error )
+{
+	static char *function = "hash_handle_copy_decimal_from_string";
+	size_t string_index   = 0;
+
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( string[ string_index ] < (system_character_t) '0' )
+	 || ( string[ string_index ] > (system_character_t) '9' ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+		 function,
+		 string_index );
+
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	while( ( string[ string_index ] >= (system_character_t) '0' )
+	    && ( string[ string_index ] <= (system_character_t) '9' ) )
+	{
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( *value_64bit > maximum_value )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		string_index++;
+	}
+	if( string[ string_index ] != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - trailing data.",
+		 function );
+
+		return( -1 );
+	}
+	if( *value_64bit == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid string - value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Determines if a string segment matches a name, where the case of the segment is ignored
+ * Returns 1 if the segment matches or 0 if not
+ */
+static int hash_handle_string_segment_compare(
+            const system_character_t *string_segment,
+            size_t string_segment_length,
+            const char *name )
+{
+	system_character_t character = 0;
+	size_t string_index          = 0;
+
+	if( string_segment_length != narrow_string_length(
+	                              name ) )
+	{
+		return( 0 );
+	}
+	for( string_index = 0;
+	     string_index < string_segment_length;
+	     string_index++ )
+	{
+		character = string_segment[ string_index ];
+
+		if( ( character >= (system_character_t) 'A' )
+		 && ( character <= (system_character_t) 'Z' ) )
+		{
+			character += (system_character_t) ( 'a' - 'A' );
+		}
+		if( character != (system_character_t) name[ string_index ] )
+		{
+			return( 0 );
+		}
+	}
+	return( 1 );
+}
+
+/* Sets the digest types
+ * The string contains a comma separated list of: md5, sha1 and sha256
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_set_digest_types(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function        = "hash_handle_set_digest_types";
+	size_t string_index          = 0;
+	size_t string_segment_index  = 0;
+	size_t string_segment_length = 0;
+	uint8_t digest_types         = 0;
+	int digest_type_index        = 0;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	do
+	{
+		string_segment_index = string_index;
+
+		while( ( string[ string_index ] != 0 )
+		    && ( string[ string_index ] != (system_character_t) ',' ) )
+		{
+			string_index++;
+		}
+		string_segment_length = string_index - string_segment_index;
+
+		for( digest_type_index = 0;
+		     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+		     digest_type_index++ )
+		{
+			if( hash_handle_string_segment_compare(
+			     &( string[ string_segment_index ] ),
+			     string_segment_length,
+			     hash_handle_digest_type_names[ digest_type_index ] ) != 0 )
+			{
+				break;
+			}
+		}
+		if( digest_type_index >= HASH_HANDLE_NUMBER_OF_DIGEST_TYPES )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported digest type at index: %" PRIzd ".",
+			 function,
+			 string_segment_index );
+
+			return( -1 );
+		}
+		digest_types |= hash_handle_digest_types[ digest_type_index ];
+	}
+	while( string[ string_index++ ] != 0 );
+
+	hash_handle->digest_types = digest_types;
+
+	return( 1 );
+}
+
+/* Sets the mode
+ * The string contains either linear or chunked
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_set_mode(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_set_mode";
+	size_t string_length  = 0;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	while( string[ string_length ] != 0 )
+	{
+		string_length++;
+	}
+	if( hash_handle_string_segment_compare(
+	     string,
+	     string_length,
+	     "linear" ) != 0 )
+	{
+		hash_handle->mode = HASH_HANDLE_MODE_LINEAR;
+	}
+	else if( hash_handle_string_segment_compare(
+	          string,
+	          string_length,
+	          "chunked" ) != 0 )
+	{
+		hash_handle->mode = HASH_HANDLE_MODE_CHUNKED;
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported mode.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the chunk size
+ * The chunk size must be a multiple of 512
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_set_chunk_size(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_set_chunk_size";
+	uint64_t value_64bit  = 0;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) HASH_HANDLE_MAXIMUM_CHUNK_SIZE,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy chunk size from string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( value_64bit % 512 ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported chunk size - not a multiple of 512.",
+		 function );
+
+		return( -1 );
+	}
+	hash_handle->chunk_size = (size_t) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the number of threads
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_set_number_of_threads(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_set_number_of_threads";
+	uint64_t value_64bit  = 0;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) HASH_HANDLE_MAXIMUM_NUMBER_OF_THREADS,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy number of threads from string.",
+		 function );
+
+		return( -1 );
+	}
+	hash_handle->number_of_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the notification stream on which the status is printed
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_set_notify_stream(
+     hash_handle_t *hash_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error )
+{
+	static char *function = "hash_handle_set_notify_stream";
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	hash_handle->notify_stream = notify_stream;
+
+	return( 1 );
+}
+
+/* Calculates the digest hashes of a buffer
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_calculate_digest_hashes(
+            hash_handle_t *hash_handle,
+            const uint8_t *buffer,
+            size_t size,
+            uint8_t digest_hashes[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ][ HASH_HANDLE_MAXIMUM_DIGEST_HASH_SIZE ],
+            libcerror_error_t **error )
+{
+	static char *function    = "hash_handle_calculate_digest_hashes";
+	unsigned int digest_size = 0;
+	int digest_type_index    = 0;
+
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( ( hash_handle->digest_types & hash_handle_digest_types[ digest_type_index ] ) == 0 )
+		{
+			continue;
+		}
+		if( EVP_Digest(
+		     buffer,
+		     size,
+		     digest_hashes[ digest_type_index ],
+		     &digest_size,
+		     hash_handle_get_message_digest(
+		      digest_type_index ),
+		     NULL ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate %s digest hash.",
+			 function,
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Reads a chunk of the media into a slot
+ * Ranges that read as zero bytes are not read, a chunk that entirely reads as zero bytes
+ * is marked as a hole and its digest hashes are the precalculated zero chunk digest hashes
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_read_chunk(
+            hash_handle_t *hash_handle,
+            hash_handle_slot_t *slot,
+            uint64_t chunk_index,
+            libcerror_error_t **error )
+{
+	static char *function = "hash_handle_read_chunk";
+	size64_t range_size   = 0;
+	size_t chunk_size     = 0;
+	size_t data_offset    = 0;
+	ssize_t read_count    = 0;
+	off64_t chunk_offset  = 0;
+	off64_t range_offset  = 0;
+	uint8_t is_hole       = 0;
+
+	chunk_offset = (off64_t) ( chunk_index * hash_handle->chunk_size );
+	chunk_size   = hash_handle->chunk_size;
+
+	if( (size64_t) chunk_size > ( hash_handle->media_size - chunk_offset ) )
+	{
+		chunk_size = (size_t) ( hash_handle->media_size - chunk_offset );
+	}
+	slot->data_size = chunk_size;
+	slot->read_size = 0;
+	slot->is_hole   = 0;
+
+	while( data_offset < chunk_size )
+	{
+		if( hash_handle->abort != 0 )
+		{
+			return( 1 );
+		}
+		range_offset = chunk_offset + (off64_t) data_offset;
+
+		if( mount_handle_get_range_at_offset(
+		     hash_handle->mount_handle,
+		     0,
+		     range_offset,
+		     (size64_t) ( chunk_size - data_offset ),
+		     &range_size,
+		     &is_hole,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( range_size == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+			 "%s: missing range at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		if( is_hole == 0 )
+		{
+			read_count = mount_handle_read_buffer_at_offset(
+			              hash_handle->mount_handle,
+			              0,
+			              &( slot->buffer[ data_offset ] ),
+			              (size_t) range_size,
+			              range_offset,
+			              error );
+
+			if( read_count != (ssize_t) range_size )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+				 function,
+				 range_offset,
+				 range_offset );
+
+				return( -1 );
+			}
+			slot->read_size += (size_t) range_size;
+		}
+		else if( (size_t) range_size == chunk_size )
+		{
+			slot->is_hole = 1;
+		}
+		else if( memory_set(
+		          &( slot->buffer[ data_offset ] ),
+		          0,
+		          (size_t) range_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear buffer.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += (size_t) range_size;
+	}
+	if( hash_handle->mode != HASH_HANDLE_MODE_CHUNKED )
+	{
+		return( 1 );
+	}
+	if( ( slot->is_hole != 0 )
+	 && ( chunk_size == hash_handle->chunk_size ) )
+	{
+		if( memory_copy(
+		     slot->digest_hashes,
+		     hash_handle->zero_chunk_digest_hashes,
+		     sizeof( hash_handle->zero_chunk_digest_hashes ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy zero chunk digest hashes.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	else if( hash_handle_calculate_digest_hashes(
+	          hash_handle,
+	          ( slot->is_hole != 0 ) ? hash_handle->zero_buffer : slot->buffer,
+	          chunk_size,
+	          slot->digest_hashes,
+	          error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to calculate digest hashes of chunk: %" PRIu64 ".",
+		 function,
+		 chunk_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Updates the digest contexts with the chunk in a slot
+ * In linear mode the data of the chunk is hashed, in chunked mode the digest hashes of the chunk
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_update_digest_contexts(
+            hash_handle_t *hash_handle,
+            EVP_MD_CTX *digest_contexts[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ],
+            hash_handle_slot_t *slot,
+            libcerror_error_t **error )
+{
+	const uint8_t *data   = NULL;
+	static char *function = "hash_handle_update_digest_contexts";
+	size_t data_size      = 0;
+	int digest_type_index = 0;
+
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( digest_contexts[ digest_type_index ] == NULL )
+		{
+			continue;
+		}
+		if( hash_handle->mode == HASH_HANDLE_MODE_CHUNKED )
+		{
+			data      = slot->digest_hashes[ digest_type_index ];
+			data_size = hash_handle_digest_hash_sizes[ digest_type_index ];
+		}
+		else
+		{
+			/* A streaming digest hash needs every byte, however the zero bytes
+			 * of a hole are provided without reading or decompressing them
+			 */
+			if( slot->is_hole != 0 )
+			{
+				data = hash_handle->zero_buffer;
+			}
+			else
+			{
+				data = slot->buffer;
+			}
+			data_size = slot->data_size;
+		}
+		if( EVP_DigestUpdate(
+		     digest_contexts[ digest_type_index ],
+		     data,
+		     data_size ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update %s digest context.",
+			 function,
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Prints the hash status
+ * The caller must hold the mutex
+ */
+static void hash_handle_print_status(
+             hash_handle_t *hash_handle,
+             int is_final )
+{
+	size64_t bytes_per_second = 0;
+	int percentage            = 100;
+
+#if defined( HAVE_TIME )
+	time_t current_time       = 0;
+	time_t elapsed_time       = 0;
+#endif
+
+	if( hash_handle->notify_stream == NULL )
+	{
+		return;
+	}
+#if defined( HAVE_TIME )
+	current_time = time(
+	                NULL );
+
+	if( ( is_final == 0 )
+	 && ( current_time == hash_handle->last_status_time ) )
+	{
+		return;
+	}
+	hash_handle->last_status_time = current_time;
+
+	elapsed_time = current_time - hash_handle->start_time;
+
+	if( elapsed_time > 0 )
+	{
+		bytes_per_second = hash_handle->hashed_size / (size64_t) elapsed_time;
+	}
+#else
+	if( is_final == 0 )
+	{
+		return;
+	}
+#endif
+	if( hash_handle->media_size > 0 )
+	{
+		percentage = (int) ( ( hash_handle->hashed_size * 100 ) / hash_handle->media_size );
+	}
+	fprintf(
+	 hash_handle->notify_stream,
+	 "Status: hashed %" PRIu64 " of %" PRIu64 " bytes (%d%%), read %" PRIu64 " bytes of data, at %" PRIu64 " MiB/s\n",
+	 hash_handle->hashed_size,
+	 hash_handle->media_size,
+	 percentage,
+	 hash_handle->read_size,
+	 bytes_per_second / ( 1024 * 1024 ) );
+}
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+
+/* Reads chunks of the media into the slots until all chunks are read
+ * The chunks are claimed in order and a chunk is stored in slot: chunk index % number of slots,
+ * once the chunk that previously occupied the slot was hashed
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_read_chunks(
+            hash_handle_t *hash_handle,
+            void *arguments QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	hash_handle_slot_t *slot = NULL;
+	libcerror_error_t *error = NULL;
+	static char *function    = "hash_handle_read_chunks";
+	uint64_t chunk_index     = 0;
+	int mutex_grabbed        = 0;
+	int result               = 1;
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( arguments )
+
+	if( hash_handle == NULL )
+	{
+		return( -1 );
+	}
+	if( libcthreads_mutex_grab(
+	     hash_handle->mutex,
+	     &error ) != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab mutex.",
+		 function );
+
+		result = -1;
+	}
+	else
+	{
+		mutex_grabbed = 1;
+	}
+	while( result == 1 )
+	{
+		if( ( hash_handle->abort != 0 )
+		 || ( hash_handle->hash_failed != 0 )
+		 || ( hash_handle->next_chunk_index >= hash_handle->number_of_chunks ) )
+		{
+			break;
+		}
+		chunk_index = hash_handle->next_chunk_index++;
+
+		slot = &( hash_handle->slots[ chunk_index % hash_handle->number_of_slots ] );
+
+		while( ( slot->state != HASH_HANDLE_SLOT_STATE_EMPTY )
+		    || ( slot->chunk_index != chunk_index ) )
+		{
+			if( ( hash_handle->abort != 0 )
+			 || ( hash_handle->hash_failed != 0 ) )
+			{
+				break;
+			}
+			if( libcthreads_condition_wait(
+			     hash_handle->slot_condition,
+			     hash_handle->mutex,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to wait for slot condition.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+		}
+		if( ( result != 1 )
+		 || ( hash_handle->abort != 0 )
+		 || ( hash_handle->hash_failed != 0 ) )
+		{
+			break;
+		}
+		slot->state = HASH_HANDLE_SLOT_STATE_BUSY;
+
+		libcthreads_mutex_release(
+		 hash_handle->mutex,
+		 NULL );
+
+		mutex_grabbed = 0;
+
+		if( hash_handle_read_chunk(
+		     hash_handle,
+		     slot,
+		     chunk_index,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			result = -1;
+		}
+		if( libcthreads_mutex_grab(
+		     hash_handle->mutex,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+		mutex_grabbed = 1;
+
+		if( result == 1 )
+		{
+			slot->state = HASH_HANDLE_SLOT_STATE_READY;
+		}
+		libcthreads_condition_broadcast(
+		 hash_handle->slot_condition,
+		 NULL );
+	}
+	if( result != 1 )
+	{
+		/* Stop the other threads
+		 */
+		hash_handle->hash_failed = 1;
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	libcthreads_condition_broadcast(
+	 hash_handle->slot_condition,
+	 NULL );
+
+	if( mutex_grabbed != 0 )
+	{
+		libcthreads_mutex_release(
+		 hash_handle->mutex,
+		 NULL );
+	}
+	return( result );
+}
+
+/* Hashes the chunks in the slots in order, while the threads of the thread pool read the chunks
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_hash_slots(
+            hash_handle_t *hash_handle,
+            EVP_MD_CTX *digest_contexts[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ],
+            libcerror_error_t **error )
+{
+	hash_handle_slot_t *slot = NULL;
+	static char *function    = "hash_handle_hash_slots";
+	uint64_t chunk_index     = 0;
+	int result               = 1;
+
+	for( chunk_index = 0;
+	     chunk_index < hash_handle->number_of_chunks;
+	     chunk_index++ )
+	{
+		slot = &( hash_handle->slots[ chunk_index % hash_handle->number_of_slots ] );
+
+		if( libcthreads_mutex_grab(
+		     hash_handle->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			return( -1 );
+		}
+		while( ( slot->state != HASH_HANDLE_SLOT_STATE_READY )
+		    || ( slot->chunk_index != chunk_index ) )
+		{
+			if( ( hash_handle->abort != 0 )
+			 || ( hash_handle->hash_failed != 0 ) )
+			{
+				break;
+			}
+			if( libcthreads_condition_wait(
+			     hash_handle->slot_condition,
+			     hash_handle->mutex,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GENERIC,
+				 "%s: unable to wait for slot condition.",
+				 function );
+
+				result = -1;
+
+				break;
+			}
+		}
+		libcthreads_mutex_release(
+		 hash_handle->mutex,
+		 NULL );
+
+		if( ( result != 1 )
+		 || ( hash_handle->abort != 0 )
+		 || ( hash_handle->hash_failed != 0 ) )
+		{
+			break;
+		}
+		/* The slot is not changed by the threads while it is ready
+		 */
+		if( hash_handle_update_digest_contexts(
+		     hash_handle,
+		     digest_contexts,
+		     slot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to update digest contexts with chunk: %" PRIu64 ".",
+			 function,
+			 chunk_index );
+
+			result = -1;
+
+			break;
+		}
+		if( libcthreads_mutex_grab(
+		     hash_handle->mutex,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to grab mutex.",
+			 function );
+
+			result = -1;
+
+			break;
+		}
+		hash_handle->hashed_size += slot->data_size;
+		hash_handle->read_size   += slot->read_size;
+
+		slot->state        = HASH_HANDLE_SLOT_STATE_EMPTY;
+		slot->chunk_index += (uint64_t) hash_handle->number_of_slots;
+
+		hash_handle_print_status(
+		 hash_handle,
+		 0 );
+
+		libcthreads_condition_broadcast(
+		 hash_handle->slot_condition,
+		 NULL );
+
+		libcthreads_mutex_release(
+		 hash_handle->mutex,
+		 NULL );
+	}
+	if( result != 1 )
+	{
+		/* Stop the threads
+		 */
+		hash_handle->hash_failed = 1;
+	}
+	/* Wake the threads that wait for a slot after an abort or failure
+	 */
+	libcthreads_condition_broadcast(
+	 hash_handle->slot_condition,
+	 NULL );
+
+	return( result );
+}
+
+#endif /* defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT ) */
+
+/* Frees the slots
+ */
+static void hash_handle_free_slots(
+             hash_handle_t *hash_handle )
+{
+	int slot_index = 0;
+
+	if( hash_handle->slots != NULL )
+	{
+		for( slot_index = 0;
+		     slot_index < hash_handle->number_of_slots;
+		     slot_index++ )
+		{
+			if( hash_handle->slots[ slot_index ].buffer != NULL )
+			{
+				memory_free(
+				 hash_handle->slots[ slot_index ].buffer );
+			}
+		}
+		memory_free(
+		 hash_handle->slots );
+
+		hash_handle->slots = NULL;
+	}
+	hash_handle->number_of_slots = 0;
+
+	if( hash_handle->zero_buffer != NULL )
+	{
+		memory_free(
+		 hash_handle->zero_buffer );
+
+		hash_handle->zero_buffer = NULL;
+	}
+}
+
+/* Creates the slots
+ * Returns 1 if successful or -1 on error
+ */
+static int hash_handle_initialize_slots(
+            hash_handle_t *hash_handle,
+            int number_of_slots,
+            libcerror_error_t **error )
+{
+	static char *function = "hash_handle_initialize_slots";
+	int slot_index        = 0;
+
+	hash_handle->zero_buffer = (uint8_t *) memory_allocate(
+	                                        sizeof( uint8_t ) * hash_handle->chunk_size );
+
+	if( hash_handle->zero_buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create zero buffer.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     hash_handle->zero_buffer,
+	     0,
+	     hash_handle->chunk_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear zero buffer.",
+		 function );
+
+		goto on_error;
+	}
+	hash_handle->slots = (hash_handle_slot_t *) memory_allocate(
+	                                             sizeof( hash_handle_slot_t ) * number_of_slots );
+
+	if( hash_handle->slots == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create slots.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     hash_handle->slots,
+	     0,
+	     sizeof( hash_handle_slot_t ) * number_of_slots ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear slots.",
+		 function );
+
+		memory_free(
+		 hash_handle->slots );
+
+		hash_handle->slots = NULL;
+
+		goto on_error;
+	}
+	hash_handle->number_of_slots = number_of_slots;
+
+	for( slot_index = 0;
+	     slot_index < number_of_slots;
+	     slot_index++ )
+	{
+		hash_handle->slots[ slot_index ].buffer = (uint8_t *) memory_allocate(
+		                                                       sizeof( uint8_t ) * hash_handle->chunk_size );
+
+		if( hash_handle->slots[ slot_index ].buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create slot: %d buffer.",
+			 function,
+			 slot_index );
+
+			goto on_error;
+		}
+		hash_handle->slots[ slot_index ].chunk_index = (uint64_t) slot_index;
+	}
+	return( 1 );
+
+on_error:
+	hash_handle_free_slots(
+	 hash_handle );
+
+	return( -1 );
+}
+
+/* Calculates the digest hashes of the media of the input file
+ * Returns 1 if successful, 0 if aborted or -1 on error
+ */
+int hash_handle_hash(
+     hash_handle_t *hash_handle,
+     libcerror_error_t **error )
+{
+	EVP_MD_CTX *digest_contexts[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ];
+
+	static char *function                  = "hash_handle_hash";
+	unsigned int digest_size               = 0;
+	uint64_t chunk_index                   = 0;
+	int digest_type_index                  = 0;
+	int number_of_slots                    = 1;
+	int result                             = 1;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_pool_t *thread_pool = NULL;
+	int thread_index                       = 0;
+#endif
+
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		digest_contexts[ digest_type_index ] = NULL;
+	}
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_handle->slots != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid hash handle - slots value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( hash_handle->digest_types & ( HASH_HANDLE_DIGEST_TYPE_MD5 | HASH_HANDLE_DIGEST_TYPE_SHA1 | HASH_HANDLE_DIGEST_TYPE_SHA256 ) ) == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid hash handle - missing digest types.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle_get_media_size(
+	     hash_handle->mount_handle,
+	     0,
+	     &( hash_handle->media_size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_handle->media_size > (size64_t) INT64_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid media size value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	hash_handle->number_of_chunks = hash_handle->media_size / hash_handle->chunk_size;
+
+	if( ( hash_handle->media_size % hash_handle->chunk_size ) != 0 )
+	{
+		hash_handle->number_of_chunks += 1;
+	}
+	hash_handle->next_chunk_index         = 0;
+	hash_handle->hashed_size              = 0;
+	hash_handle->read_size                = 0;
+	hash_handle->hash_failed              = 0;
+	hash_handle->digest_hashes_calculated = 0;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( hash_handle->number_of_threads > 1 )
+	{
+		/* Twice the number of threads allows the threads to read ahead
+		 * while the chunks are hashed in order
+		 */
+		number_of_slots = 2 * hash_handle->number_of_threads;
+	}
+#endif
+	if( hash_handle_initialize_slots(
+	     hash_handle,
+	     number_of_slots,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize slots.",
+		 function );
+
+		goto on_error;
+	}
+	if( hash_handle->mode == HASH_HANDLE_MODE_CHUNKED )
+	{
+		if( hash_handle_calculate_digest_hashes(
+		     hash_handle,
+		     hash_handle->zero_buffer,
+		     hash_handle->chunk_size,
+		     hash_handle->zero_chunk_digest_hashes,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to calculate zero chunk digest hashes.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( ( hash_handle->digest_types & hash_handle_digest_types[ digest_type_index ] ) == 0 )
+		{
+			continue;
+		}
+		digest_contexts[ digest_type_index ] = EVP_MD_CTX_new();
+
+		if( digest_contexts[ digest_type_index ] == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create %s digest context.",
+			 function,
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+
+			goto on_error;
+		}
+		if( EVP_DigestInit_ex(
+		     digest_contexts[ digest_type_index ],
+		     hash_handle_get_message_digest(
+		      digest_type_index ),
+		     NULL ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize %s digest context.",
+			 function,
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_TIME )
+	hash_handle->start_time       = time(
+	                                 NULL );
+	hash_handle->last_status_time = hash_handle->start_time;
+#endif
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( hash_handle->number_of_threads > 1 )
+	{
+		if( libcthreads_thread_pool_create(
+		     &thread_pool,
+		     NULL,
+		     hash_handle->number_of_threads,
+		     hash_handle->number_of_threads,
+		     (int (*)(intptr_t *, void *)) &hash_handle_read_chunks,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create thread pool.",
+			 function );
+
+			goto on_error;
+		}
+		/* Every thread reads chunks until all chunks are read
+		 */
+		for( thread_index = 0;
+		     thread_index < hash_handle->number_of_threads;
+		     thread_index++ )
+		{
+			if( libcthreads_thread_pool_push(
+			     thread_pool,
+			     (intptr_t *) hash_handle,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to push read onto thread pool queue.",
+				 function );
+
+				hash_handle->hash_failed = 1;
+
+				libcthreads_condition_broadcast(
+				 hash_handle->slot_condition,
+				 NULL );
+				libcthreads_thread_pool_join(
+				 &thread_pool,
+				 NULL );
+
+				goto on_error;
+			}
+		}
+		result = hash_handle_hash_slots(
+		          hash_handle,
+		          digest_contexts,
+		          error );
+
+		if( libcthreads_thread_pool_join(
+		     &thread_pool,
+		     ( result == 1 ) ? error : NULL ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to join thread pool.",
+			 function );
+
+			goto on_error;
+		}
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to hash slots.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	else
+#endif
+	{
+		for( chunk_index = 0;
+		     chunk_index < hash_handle->number_of_chunks;
+		     chunk_index++ )
+		{
+			if( hash_handle->abort != 0 )
+			{
+				break;
+			}
+			if( hash_handle_read_chunk(
+			     hash_handle,
+			     &( hash_handle->slots[ 0 ] ),
+			     chunk_index,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read chunk: %" PRIu64 ".",
+				 function,
+				 chunk_index );
+
+				hash_handle->hash_failed = 1;
+
+				break;
+			}
+			if( hash_handle->abort != 0 )
+			{
+				break;
+			}
+			if( hash_handle_update_digest_contexts(
+			     hash_handle,
+			     digest_contexts,
+			     &( hash_handle->slots[ 0 ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+				 "%s: unable to update digest contexts with chunk: %" PRIu64 ".",
+				 function,
+				 chunk_index );
+
+				hash_handle->hash_failed = 1;
+
+				break;
+			}
+			hash_handle->hashed_size += hash_handle->slots[ 0 ].data_size;
+			hash_handle->read_size   += hash_handle->slots[ 0 ].read_size;
+
+			hash_handle_print_status(
+			 hash_handle,
+			 0 );
+		}
+	}
+	if( hash_handle->hash_failed != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to hash media.",
+		 function );
+
+		goto on_error;
+	}
+	if( hash_handle->abort != 0 )
+	{
+		result = 0;
+	}
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( digest_contexts[ digest_type_index ] == NULL )
+		{
+			continue;
+		}
+		if( ( result == 1 )
+		 && ( EVP_DigestFinal_ex(
+		       digest_contexts[ digest_type_index ],
+		       hash_handle->digest_hashes[ digest_type_index ],
+		       &digest_size ) != 1 ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to finalize %s digest context.",
+			 function,
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+
+			goto on_error;
+		}
+		EVP_MD_CTX_free(
+		 digest_contexts[ digest_type_index ] );
+
+		digest_contexts[ digest_type_index ] = NULL;
+	}
+	hash_handle_free_slots(
+	 hash_handle );
+
+	if( result == 1 )
+	{
+		hash_handle->digest_hashes_calculated = 1;
+
+		hash_handle_print_status(
+		 hash_handle,
+		 1 );
+	}
+	return( result );
+
+on_error:
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( digest_contexts[ digest_type_index ] != NULL )
+		{
+			EVP_MD_CTX_free(
+			 digest_contexts[ digest_type_index ] );
+		}
+	}
+	hash_handle_free_slots(
+	 hash_handle );
+
+	return( -1 );
+}
+
+/* Prints the calculated digest hashes
+ * Returns 1 if successful or -1 on error
+ */
+int hash_handle_digest_hashes_fprint(
+     hash_handle_t *hash_handle,
+     FILE *stream,
+     libcerror_error_t **error )
+{
+	static char *function    = "hash_handle_digest_hashes_fprint";
+	size_t digest_hash_index = 0;
+	int digest_type_index    = 0;
+
+	if( hash_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid hash handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( hash_handle->digest_hashes_calculated == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid hash handle - missing digest hashes.",
+		 function );
+
+		return( -1 );
+	}
+	if( stream == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid stream.",
+		 function );
+
+		return( -1 );
+	}
+	for( digest_type_index = 0;
+	     digest_type_index < HASH_HANDLE_NUMBER_OF_DIGEST_TYPES;
+	     digest_type_index++ )
+	{
+		if( ( hash_handle->digest_types & hash_handle_digest_types[ digest_type_index ] ) == 0 )
+		{
+			continue;
+		}
+		if( hash_handle->mode == HASH_HANDLE_MODE_CHUNKED )
+		{
+			fprintf(
+			 stream,
+			 "%s hash calculated over chunks of %" PRIzd " bytes:\t",
+			 hash_handle_digest_type_labels[ digest_type_index ],
+			 hash_handle->chunk_size );
+		}
+		else
+		{
+			fprintf(
+			 stream,
+			 "%s hash calculated over data:\t",
+			 hash_handle_digest_type_labels[ digest_type_index ] );
+		}
+		for( digest_hash_index = 0;
+		     digest_hash_index < hash_handle_digest_hash_sizes[ digest_type_index ];
+		     digest_hash_index++ )
+		{
+			fprintf(
+			 stream,
+			 "%02" PRIx8 "",
+			 hash_handle->digest_hashes[ digest_type_index ][ digest_hash_index ] );
+		}
+		fprintf(
+		 stream,
+		 "\n" );
+	}
+	return( 1 );
+}
+
+#endif /* defined( HAVE_HASH_HANDLE_SUPPORT ) */
+
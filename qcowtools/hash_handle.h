@@ -0,0 +1,286 @@
+/*
+ * Hash handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _HASH_HANDLE_H )
+#define _HASH_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( TIME_WITH_SYS_TIME )
+#include <sys/time.h>
+#include <time.h>
+#elif defined( HAVE_SYS_TIME_H )
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if defined( HAVE_OPENSSL_EVP_H ) && defined( HAVE_QCOWTOOLS_LIBCRYPTO_EVP_MD )
+#define HAVE_HASH_HANDLE_SUPPORT
+#endif
+
+enum HASH_HANDLE_DIGEST_TYPES
+{
+	HASH_HANDLE_DIGEST_TYPE_MD5		= 0x01,
+	HASH_HANDLE_DIGEST_TYPE_SHA1		= 0x02,
+	HASH_HANDLE_DIGEST_TYPE_SHA256		= 0x04
+};
+
+enum HASH_HANDLE_MODES
+{
+	/* The digest hashes are calculated over the data
+	 */
+	HASH_HANDLE_MODE_LINEAR			= 1,
+
+	/* The digest hashes are calculated over the digest hashes of the chunks
+	 */
+	HASH_HANDLE_MODE_CHUNKED		= 2
+};
+
+enum HASH_HANDLE_SLOT_STATES
+{
+	HASH_HANDLE_SLOT_STATE_EMPTY		= 0,
+	HASH_HANDLE_SLOT_STATE_BUSY		= 1,
+	HASH_HANDLE_SLOT_STATE_READY		= 2
+};
+
+/* The number of supported digest types
+ */
+#define HASH_HANDLE_NUMBER_OF_DIGEST_TYPES	3
+
+/* The maximum size of a digest hash
+ */
+#define HASH_HANDLE_MAXIMUM_DIGEST_HASH_SIZE	32
+
+/* The default size of the chunks of the media that are read by a single thread
+ */
+#define HASH_HANDLE_DEFAULT_CHUNK_SIZE		( 1024 * 1024 )
+
+/* The maximum size of the chunks
+ */
+#define HASH_HANDLE_MAXIMUM_CHUNK_SIZE		( 64 * 1024 * 1024 )
+
+/* The default number of threads
+ */
+#define HASH_HANDLE_DEFAULT_NUMBER_OF_THREADS	4
+
+/* The maximum number of threads
+ */
+#define HASH_HANDLE_MAXIMUM_NUMBER_OF_THREADS	64
+
+typedef struct hash_handle_slot hash_handle_slot_t;
+
+struct hash_handle_slot
+{
+	/* The buffer that contains the data of the chunk
+	 */
+	uint8_t *buffer;
+
+	/* The index of the chunk that is or will be stored in the slot
+	 */
+	uint64_t chunk_index;
+
+	/* The size of the data of the chunk
+	 */
+	size_t data_size;
+
+	/* The size of the data that was read
+	 */
+	size_t read_size;
+
+	/* Value to indicate the entire chunk reads as zero bytes
+	 * in which case the buffer is not filled
+	 */
+	uint8_t is_hole;
+
+	/* The state
+	 */
+	int state;
+
+	/* The digest hashes of the chunk, only calculated in chunked mode
+	 */
+	uint8_t digest_hashes[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ][ HASH_HANDLE_MAXIMUM_DIGEST_HASH_SIZE ];
+};
+
+typedef struct hash_handle hash_handle_t;
+
+struct hash_handle
+{
+	/* The mount handle, which provides the input file
+	 * this value is not managed by the hash handle
+	 */
+	mount_handle_t *mount_handle;
+
+	/* The digest types
+	 */
+	uint8_t digest_types;
+
+	/* The mode
+	 */
+	int mode;
+
+	/* The chunk size
+	 */
+	size_t chunk_size;
+
+	/* The number of threads
+	 */
+	int number_of_threads;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The number of chunks
+	 */
+	uint64_t number_of_chunks;
+
+	/* The index of the next chunk to read
+	 */
+	uint64_t next_chunk_index;
+
+	/* The slots, which are used as a ring buffer of chunks
+	 */
+	hash_handle_slot_t *slots;
+
+	/* The number of slots
+	 */
+	int number_of_slots;
+
+	/* A buffer of chunk size that contains zero bytes
+	 */
+	uint8_t *zero_buffer;
+
+	/* The digest hashes of a chunk that only contains zero bytes
+	 */
+	uint8_t zero_chunk_digest_hashes[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ][ HASH_HANDLE_MAXIMUM_DIGEST_HASH_SIZE ];
+
+	/* The calculated digest hashes
+	 */
+	uint8_t digest_hashes[ HASH_HANDLE_NUMBER_OF_DIGEST_TYPES ][ HASH_HANDLE_MAXIMUM_DIGEST_HASH_SIZE ];
+
+	/* Value to indicate the digest hashes were calculated
+	 */
+	uint8_t digest_hashes_calculated;
+
+	/* The size of the media that was hashed
+	 */
+	size64_t hashed_size;
+
+	/* The size of the data that was read
+	 */
+	size64_t read_size;
+
+	/* The time the hashing started
+	 */
+	time_t start_time;
+
+	/* The time the last status was printed
+	 */
+	time_t last_status_time;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	/* The mutex that protects the slots and the hash state
+	 */
+	libcthreads_mutex_t *mutex;
+
+	/* The condition that is signalled when the state of a slot changes
+	 */
+	libcthreads_condition_t *slot_condition;
+#endif
+
+	/* Value to indicate one of the threads failed
+	 */
+	int hash_failed;
+
+	/* The notification output stream
+	 * NULL if no status is printed
+	 */
+	FILE *notify_stream;
+
+	/* Value to indicate if abort was signalled
+	 */
+	int abort;
+};
+
+int hash_handle_initialize(
+     hash_handle_t **hash_handle,
+     mount_handle_t *mount_handle,
+     libcerror_error_t **error );
+
+int hash_handle_free(
+     hash_handle_t **hash_handle,
+     libcerror_error_t **error );
+
+int hash_handle_signal_abort(
+     hash_handle_t *hash_handle,
+     libcerror_error_t **error );
+
+int hash_handle_set_digest_types(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int hash_handle_set_mode(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int hash_handle_set_chunk_size(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int hash_handle_set_number_of_threads(
+     hash_handle_t *hash_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int hash_handle_set_notify_stream(
+     hash_handle_t *hash_handle,
+     FILE *notify_stream,
+     libcerror_error_t **error );
+
+int hash_handle_hash(
+     hash_handle_t *hash_handle,
+     libcerror_error_t **error );
+
+int hash_handle_digest_hashes_fprint(
+     hash_handle_t *hash_handle,
+     FILE *stream,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _HASH_HANDLE_H ) */
+
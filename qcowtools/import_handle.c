@@ -0,0 +1,458 @@
+/*
+ * Import handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#include "import_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#define IMPORT_HANDLE_NOTIFY_STREAM		stdout
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+static int import_handle_copy_decimal_from_string(
+            const system_character_t *string,
+            uint64_t maximum_value,
+            uint64_t *value_64bit,
+            libcerror_error_t **error )
+{
+	static char *function = "import_handle_copy_decimal_from_string";
+	size_t string_index   = 0;
+
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( string[ 0 ] == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - missing value.",
+		 function );
+
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string[ string_index ] != 0;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+			 function,
+			 string_index );
+
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( *value_64bit > maximum_value )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Creates an import handle
+ * Make sure the value import_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_initialize(
+     import_handle_t **import_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_initialize";
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *import_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid import handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	*import_handle = memory_allocate_structure(
+	                  import_handle_t );
+
+	if( *import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create import handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *import_handle,
+	     0,
+	     sizeof( import_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear import handle.",
+		 function );
+
+		goto on_error;
+	}
+	( *import_handle )->compression_method = LIBQCOW_COMPRESSION_METHOD_DEFLATE;
+	( *import_handle )->compression_level  = -1;
+	( *import_handle )->notify_stream      = IMPORT_HANDLE_NOTIFY_STREAM;
+
+	return( 1 );
+
+on_error:
+	if( *import_handle != NULL )
+	{
+		memory_free(
+		 *import_handle );
+
+		*import_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees an import handle
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_free(
+     import_handle_t **import_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_free";
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *import_handle != NULL )
+	{
+		memory_free(
+		 *import_handle );
+
+		*import_handle = NULL;
+	}
+	return( 1 );
+}
+
+/* Sets the cluster block size
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_set_cluster_block_size(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_set_cluster_block_size";
+	uint64_t value_64bit  = 0;
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( import_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) ( 2 * 1024 * 1024 ),
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy cluster block size from string.",
+		 function );
+
+		return( -1 );
+	}
+	import_handle->cluster_block_size = (size_t) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the compression method
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_set_compression_method(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_set_compression_method";
+	size_t string_length  = 0;
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = system_string_length(
+	                 string );
+
+	if( ( string_length == 7 )
+	 && ( system_string_compare(
+	       string,
+	       _SYSTEM_STRING( "deflate" ),
+	       7 ) == 0 ) )
+	{
+		import_handle->compression_method = LIBQCOW_COMPRESSION_METHOD_DEFLATE;
+	}
+	else if( ( string_length == 4 )
+	      && ( system_string_compare(
+	            string,
+	            _SYSTEM_STRING( "zstd" ),
+	            4 ) == 0 ) )
+	{
+		import_handle->compression_method = LIBQCOW_COMPRESSION_METHOD_ZSTD;
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported compression method.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the compression level
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_set_compression_level(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_set_compression_level";
+	uint64_t value_64bit  = 0;
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( import_handle_copy_decimal_from_string(
+	     string,
+	     22,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy compression level from string.",
+		 function );
+
+		return( -1 );
+	}
+	import_handle->compression_level = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the number of threads
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_set_number_of_threads(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_set_number_of_threads";
+	uint64_t value_64bit  = 0;
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( import_handle_copy_decimal_from_string(
+	     string,
+	     (uint64_t) IMPORT_HANDLE_MAXIMUM_NUMBER_OF_THREADS,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy number of threads from string.",
+		 function );
+
+		return( -1 );
+	}
+	import_handle->number_of_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Imports the data of a source file into a QCOW image with compressed cluster blocks
+ * Returns 1 if successful or -1 on error
+ */
+int import_handle_import(
+     import_handle_t *import_handle,
+     const system_character_t *source_filename,
+     const system_character_t *target_filename,
+     libcerror_error_t **error )
+{
+	static char *function = "import_handle_import";
+	int result            = 0;
+
+	if( import_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid import handle.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_create_compressed_image_wide(
+	          source_filename,
+	          target_filename,
+	          import_handle->cluster_block_size,
+	          import_handle->compression_method,
+	          import_handle->compression_level,
+	          import_handle->number_of_threads,
+	          error );
+#else
+	result = libqcow_create_compressed_image(
+	          source_filename,
+	          target_filename,
+	          import_handle->cluster_block_size,
+	          import_handle->compression_method,
+	          import_handle->compression_level,
+	          import_handle->number_of_threads,
+	          error );
+#endif
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to create image.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
@@ -0,0 +1,104 @@
+/*
+ * Import handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _IMPORT_HANDLE_H )
+#define _IMPORT_HANDLE_H
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libqcow.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The maximum number of threads
+ */
+#define IMPORT_HANDLE_MAXIMUM_NUMBER_OF_THREADS	256
+
+typedef struct import_handle import_handle_t;
+
+struct import_handle
+{
+	/* The cluster block size, 0 represents the default of the library
+	 */
+	size_t cluster_block_size;
+
+	/* The compression method
+	 */
+	int compression_method;
+
+	/* The compression level, -1 represents the default of the compression method
+	 */
+	int compression_level;
+
+	/* The number of threads that compress the cluster blocks
+	 */
+	int number_of_threads;
+
+	/* The notification output stream
+	 */
+	FILE *notify_stream;
+};
+
+int import_handle_initialize(
+     import_handle_t **import_handle,
+     libcerror_error_t **error );
+
+int import_handle_free(
+     import_handle_t **import_handle,
+     libcerror_error_t **error );
+
+int import_handle_set_cluster_block_size(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int import_handle_set_compression_method(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int import_handle_set_compression_level(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int import_handle_set_number_of_threads(
+     import_handle_t *import_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int import_handle_import(
+     import_handle_t *import_handle,
+     const system_character_t *source_filename,
+     const system_character_t *target_filename,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _IMPORT_HANDLE_H ) */
+
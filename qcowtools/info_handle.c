@@ -22,6 +22,7 @@
 #include <common.h>
 #include <byte_stream.h>
 #include <memory.h>
+#include <system_string.h>
 #include <types.h>
 
 #include "info_handle.h"
@@ -31,6 +32,10 @@
 
 #define INFO_HANDLE_NOTIFY_STREAM		stdout
 
+/* The size of the reads of the statistics run
+ */
+#define INFO_HANDLE_STATISTICS_READ_SIZE	( 1024 * 1024 )
+
 /* Creates an info handle
  * Make sure the value mount_handle is referencing, is set to NULL
  * Returns 1 if successful or -1 on error
@@ -205,6 +210,307 @@ int info_handle_signal_abort(
 	return( 1 );
 }
 
+/* Copies a decimal value from a string segment
+ * Returns 1 if successful or -1 on error
+ */
+static int info_handle_copy_decimal_from_string_segment(
+            const system_character_t *string_segment,
+            size_t string_segment_length,
+            uint64_t maximum_value,
+            uint64_t *value_64bit,
+            libcerror_error_t **error )
+{
+	static char *function = "info_handle_copy_decimal_from_string_segment";
+	size_t string_index   = 0;
+
+	if( string_segment == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string segment.",
+		 function );
+
+		return( -1 );
+	}
+	if( string_segment_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid string segment length value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string_index < string_segment_length;
+	     string_index++ )
+	{
+		if( ( string_segment[ string_index ] < (system_character_t) '0' )
+		 || ( string_segment[ string_index ] > (system_character_t) '9' ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported string segment - expected decimal value at index: %" PRIzd ".",
+			 function,
+			 string_index );
+
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string_segment[ string_index ] - (system_character_t) '0' );
+
+		if( *value_64bit > maximum_value )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string segment - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( *value_64bit == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+		 "%s: invalid string segment - value zero or less.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Sets the diff
+ * The string is either "backing", a (1-based) snapshot index to compare with
+ * the current media data or two snapshot indexes separated by a comma
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_set_diff(
+     info_handle_t *info_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function  = "info_handle_set_diff";
+	size_t separator_index = 0;
+	size_t string_length   = 0;
+	uint64_t value_64bit   = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = system_string_length(
+	                 string );
+
+	if( ( string_length == 7 )
+	 && ( system_string_compare(
+	       string,
+	       _SYSTEM_STRING( "backing" ),
+	       7 ) == 0 ) )
+	{
+		info_handle->diff_mode             = INFO_HANDLE_DIFF_MODE_BACKING;
+		info_handle->diff_snapshot_index_a = 0;
+		info_handle->diff_snapshot_index_b = 0;
+
+		return( 1 );
+	}
+	for( separator_index = 0;
+	     separator_index < string_length;
+	     separator_index++ )
+	{
+		if( string[ separator_index ] == (system_character_t) ',' )
+		{
+			break;
+		}
+	}
+	if( info_handle_copy_decimal_from_string_segment(
+	     string,
+	     separator_index,
+	     (uint64_t) INT_MAX,
+	     &value_64bit,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+		 "%s: unable to copy first snapshot index.",
+		 function );
+
+		return( -1 );
+	}
+	info_handle->diff_snapshot_index_a = (int) value_64bit;
+	info_handle->diff_snapshot_index_b = 0;
+
+	if( separator_index < string_length )
+	{
+		if( info_handle_copy_decimal_from_string_segment(
+		     &( string[ separator_index + 1 ] ),
+		     string_length - ( separator_index + 1 ),
+		     (uint64_t) INT_MAX,
+		     &value_64bit,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_COPY_FAILED,
+			 "%s: unable to copy second snapshot index.",
+			 function );
+
+			return( -1 );
+		}
+		info_handle->diff_snapshot_index_b = (int) value_64bit;
+	}
+	info_handle->diff_mode = INFO_HANDLE_DIFF_MODE_SNAPSHOT;
+
+	return( 1 );
+}
+
+/* Sets the profile
+ * The string is the percentage of the cluster blocks to sample, such as 1 or 0.1
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_set_profile(
+     info_handle_t *info_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function      = "info_handle_set_profile";
+	size_t separator_index     = 0;
+	size_t string_index        = 0;
+	size_t string_length       = 0;
+	double fraction_divider    = 1.0;
+	double sampling_percentage = 0.0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = system_string_length(
+	                 string );
+
+	for( separator_index = 0;
+	     separator_index < string_length;
+	     separator_index++ )
+	{
+		if( string[ separator_index ] == (system_character_t) '.' )
+		{
+			break;
+		}
+	}
+	/* The decimal digits are at most 3 integer and 6 fraction digits
+	 */
+	if( ( string_length == 0 )
+	 || ( separator_index > 3 )
+	 || ( ( string_length - separator_index ) > 7 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid string length value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	for( string_index = 0;
+	     string_index < string_length;
+	     string_index++ )
+	{
+		if( string_index == separator_index )
+		{
+			continue;
+		}
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+			 function,
+			 string_index );
+
+			return( -1 );
+		}
+		sampling_percentage *= 10.0;
+		sampling_percentage += (double) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( string_index > separator_index )
+		{
+			fraction_divider *= 10.0;
+		}
+	}
+	sampling_percentage /= fraction_divider;
+
+	if( ( sampling_percentage <= 0.0 )
+	 || ( sampling_percentage > 100.0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid sampling percentage value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	info_handle->profile_sampling_fraction = sampling_percentage / 100.0;
+
+	return( 1 );
+}
+
 /* Opens the info handle
  * Returns 1 if successful, 0 if the keys could not be read or -1 on error
  */
@@ -231,13 +537,13 @@ int info_handle_open_input(
 	result = libqcow_file_open_wide(
 	          info_handle->input_file,
 	          filename,
-	          LIBQCOW_OPEN_READ,
+	          LIBQCOW_OPEN_METADATA_ONLY,
 	          error );
 #else
 	result = libqcow_file_open(
 	          info_handle->input_file,
 	          filename,
-	          LIBQCOW_OPEN_READ,
+	          LIBQCOW_OPEN_METADATA_ONLY,
 	          error );
 #endif
 	if( result == -1 )
@@ -308,10 +614,16 @@ int info_handle_file_fprint(
      info_handle_t *info_handle,
      libcerror_error_t **error )
 {
-	static char *function      = "qcowinfo_file_info_fprint";
-	size64_t media_size        = 0;
-	uint32_t encryption_method = 0;
-	uint32_t format_version    = 0;
+	libqcow_snapshot_t *snapshot = NULL;
+	uint8_t *backing_filename    = NULL;
+	static char *function        = "qcowinfo_file_info_fprint";
+	size64_t media_size          = 0;
+	size_t backing_filename_size = 0;
+	uint32_t encryption_method   = 0;
+	uint32_t format_version      = 0;
+	int number_of_snapshots      = 0;
+	int result                   = 0;
+	int snapshot_index           = 0;
 
 	if( info_handle == NULL )
 	{
@@ -412,7 +724,1311 @@ int info_handle_file_fprint(
 	 info_handle->notify_stream,
 	 "\n" );
 
-/* TODO add more info */
+	if( encryption_method != LIBQCOW_ENCRYPTION_METHOD_NONE )
+	{
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tEncryption backend:\t%s\n",
+		 libqcow_get_encryption_backend() );
+	}
+	result = libqcow_file_get_utf8_backing_filename_size(
+	          info_handle->input_file,
+	          &backing_filename_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve backing filename size.",
+		 function );
+
+		goto on_error;
+	}
+	else if( ( result != 0 )
+	      && ( backing_filename_size > 0 ) )
+	{
+		backing_filename = (uint8_t *) memory_allocate(
+		                                sizeof( uint8_t ) * backing_filename_size );
+
+		if( backing_filename == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create backing filename.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_file_get_utf8_backing_filename(
+		     info_handle->input_file,
+		     backing_filename,
+		     backing_filename_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve backing filename.",
+			 function );
+
+			goto on_error;
+		}
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tBacking filename:\t%s\n",
+		 (char *) backing_filename );
+
+		memory_free(
+		 backing_filename );
+
+		backing_filename = NULL;
+	}
+	if( libqcow_file_get_number_of_snapshots(
+	     info_handle->input_file,
+	     &number_of_snapshots,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of snapshots.",
+		 function );
+
+		goto on_error;
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tNumber of snapshots:\t%d\n",
+	 number_of_snapshots );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	for( snapshot_index = 0;
+	     snapshot_index < number_of_snapshots;
+	     snapshot_index++ )
+	{
+		if( libqcow_file_get_snapshot_by_index(
+		     info_handle->input_file,
+		     snapshot_index,
+		     &snapshot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve snapshot: %d.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		if( info_handle_snapshot_fprint(
+		     info_handle,
+		     snapshot_index,
+		     snapshot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_PRINT_FAILED,
+			 "%s: unable to print snapshot: %d information.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		if( libqcow_snapshot_free(
+		     &snapshot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free snapshot: %d.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+	}
+	if( info_handle_layout_fprint(
+	     info_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_PRINT_FAILED,
+		 "%s: unable to print layout information.",
+		 function );
+
+		goto on_error;
+	}
+	if( info_handle_host_allocation_fprint(
+	     info_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_PRINT_FAILED,
+		 "%s: unable to print host allocation information.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( snapshot != NULL )
+	{
+		libqcow_snapshot_free(
+		 &snapshot,
+		 NULL );
+	}
+	if( backing_filename != NULL )
+	{
+		memory_free(
+		 backing_filename );
+	}
+	return( -1 );
+}
+
+/* Prints the snapshot information to a stream
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_snapshot_fprint(
+     info_handle_t *info_handle,
+     int snapshot_index,
+     libqcow_snapshot_t *snapshot,
+     libcerror_error_t **error )
+{
+	uint8_t *value_string    = NULL;
+	static char *function    = "info_handle_snapshot_fprint";
+	size64_t media_size      = 0;
+	size_t value_string_size = 0;
+	int result               = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "Snapshot: %d\n",
+	 snapshot_index + 1 );
+
+	result = libqcow_snapshot_get_utf8_identifier_size(
+	          snapshot,
+	          &value_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve identifier size.",
+		 function );
+
+		goto on_error;
+	}
+	else if( ( result != 0 )
+	      && ( value_string_size > 0 ) )
+	{
+		value_string = (uint8_t *) memory_allocate(
+		                            sizeof( uint8_t ) * value_string_size );
+
+		if( value_string == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create identifier string.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_snapshot_get_utf8_identifier(
+		     snapshot,
+		     value_string,
+		     value_string_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve identifier.",
+			 function );
+
+			goto on_error;
+		}
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tIdentifier:\t\t%s\n",
+		 (char *) value_string );
+
+		memory_free(
+		 value_string );
+
+		value_string = NULL;
+	}
+	result = libqcow_snapshot_get_utf8_name_size(
+	          snapshot,
+	          &value_string_size,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve name size.",
+		 function );
+
+		goto on_error;
+	}
+	else if( ( result != 0 )
+	      && ( value_string_size > 0 ) )
+	{
+		value_string = (uint8_t *) memory_allocate(
+		                            sizeof( uint8_t ) * value_string_size );
+
+		if( value_string == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create name string.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_snapshot_get_utf8_name(
+		     snapshot,
+		     value_string,
+		     value_string_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve name.",
+			 function );
+
+			goto on_error;
+		}
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tName:\t\t\t%s\n",
+		 (char *) value_string );
+
+		memory_free(
+		 value_string );
+
+		value_string = NULL;
+	}
+	if( libqcow_snapshot_get_media_size(
+	     snapshot,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		goto on_error;
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tMedia size:\t\t%" PRIu64 " bytes\n",
+	 media_size );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+
+on_error:
+	if( value_string != NULL )
+	{
+		memory_free(
+		 value_string );
+	}
+	return( -1 );
+}
+
+/* Prints the layout information to a stream
+ * The level 2 tables are scanned by the worker threads of the file
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_layout_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error )
+{
+	uint64_t values[ LIBQCOW_NUMBER_OF_LAYOUT_VALUES ];
+
+	libcerror_error_t *parent_error = NULL;
+	libqcow_file_t *file            = NULL;
+	libqcow_file_t *parent_file     = NULL;
+	static char *function           = "info_handle_layout_fprint";
+	int chain_depth                 = 0;
+	int number_of_snapshots         = 0;
+	int result                      = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_scan_layout(
+	     info_handle->input_file,
+	     0,
+	     values,
+	     LIBQCOW_NUMBER_OF_LAYOUT_VALUES,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to scan layout.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_number_of_snapshots(
+	     info_handle->input_file,
+	     &number_of_snapshots,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of snapshots.",
+		 function );
+
+		return( -1 );
+	}
+	/* The chain depth is the number of files in the backing chain including the file itself
+	 * A backing file that cannot be opened ends the chain
+	 */
+	file        = info_handle->input_file;
+	chain_depth = 1;
+
+	do
+	{
+		result = libqcow_file_get_parent_file(
+		          file,
+		          &parent_file,
+		          &parent_error );
+
+		if( result == -1 )
+		{
+			libcerror_error_free(
+			 &parent_error );
+
+			break;
+		}
+		else if( result == 1 )
+		{
+			file         = parent_file;
+			chain_depth += 1;
+		}
+	}
+	while( result == 1 );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "Layout:\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tAllocated:\t\t%" PRIu64 " bytes\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_ALLOCATED_SIZE ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tCompressed:\t\t%" PRIu64 " bytes\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_SIZE ] );
+
+	if( values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_DATA_SIZE ] > 0 )
+	{
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tCompression ratio:\t%.2f\n",
+		 (double) values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_SIZE ] / (double) values[ LIBQCOW_LAYOUT_VALUE_COMPRESSED_DATA_SIZE ] );
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tZero:\t\t\t%" PRIu64 " bytes\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_ZERO_SIZE ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tSparse:\t\t\t%" PRIu64 " bytes\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_SPARSE_SIZE ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tHost runs:\t\t%" PRIu64 "\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tLevel 2 tables:\t\t%" PRIu64 "\n",
+	 values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_LEVEL2_TABLES ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tSnapshots:\t\t%d\n",
+	 number_of_snapshots );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tChain depth:\t\t%d\n",
+	 chain_depth );
+
+	if( values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] > 0 )
+	{
+		fprintf(
+		 info_handle->notify_stream,
+		 "\tInvalid references:\t%" PRIu64 "\n",
+		 values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ] );
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+}
+
+/* Prints the host allocation information to a stream
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_host_allocation_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error )
+{
+	static char *function              = "info_handle_host_allocation_fprint";
+	double fragmentation_ratio         = 0.0;
+	uint64_t number_of_leaked_clusters = 0;
+	uint64_t number_of_shared_clusters = 0;
+	uint64_t number_of_used_clusters   = 0;
+	int result                         = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	result = libqcow_file_get_number_of_used_clusters(
+	          info_handle->input_file,
+	          &number_of_used_clusters,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of used clusters.",
+		 function );
+
+		return( -1 );
+	}
+	else if( result == 0 )
+	{
+		/* The host allocation statistics are not available for format version 1
+		 */
+		return( 1 );
+	}
+	if( libqcow_file_get_number_of_leaked_clusters(
+	     info_handle->input_file,
+	     &number_of_leaked_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of leaked clusters.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_number_of_shared_clusters(
+	     info_handle->input_file,
+	     &number_of_shared_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of shared clusters.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_fragmentation_ratio(
+	     info_handle->input_file,
+	     &fragmentation_ratio,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve fragmentation ratio.",
+		 function );
+
+		return( -1 );
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "Host allocation:\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tUsed clusters:\t\t%" PRIu64 "\n",
+	 number_of_used_clusters );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tLeaked clusters:\t%" PRIu64 "\n",
+	 number_of_leaked_clusters );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tShared clusters:\t%" PRIu64 "\n",
+	 number_of_shared_clusters );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tFragmentation ratio:\t%.4f\n",
+	 fragmentation_ratio );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+}
+
+/* Reads the media data and prints the read statistics and latency percentiles to a stream
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_statistics_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error )
+{
+	uint64_t statistics[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	const char *operation_names[ LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS ] = {
+		"Read buffer",
+		"Level 2 table read",
+		"Cluster block read",
+		"Decompress",
+		"Decrypt" };
+
+	const double percentiles[ 5 ] = {
+		50.0, 90.0, 99.0, 99.9, 100.0 };
+
+	uint64_t latencies[ 5 ];
+
+	uint8_t *buffer           = NULL;
+	static char *function     = "info_handle_statistics_fprint";
+	size64_t media_size       = 0;
+	size_t read_size          = 0;
+	ssize_t read_count        = 0;
+	uint64_t number_of_values = 0;
+	off64_t media_offset      = 0;
+	int operation             = 0;
+	int percentile_index      = 0;
+	int read_flags            = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_media_size(
+	     info_handle->input_file,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_get_read_flags(
+	     info_handle->input_file,
+	     &read_flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve read flags.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_set_read_flags(
+	     info_handle->input_file,
+	     read_flags | LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set read flags.",
+		 function );
+
+		goto on_error;
+	}
+	/* The statistics only cover the reads of the media data
+	 * not the reads of the metadata on open
+	 */
+	if( libqcow_file_reset_statistics(
+	     info_handle->input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to reset statistics.",
+		 function );
+
+		goto on_error;
+	}
+	buffer = (uint8_t *) memory_allocate(
+	                      sizeof( uint8_t ) * INFO_HANDLE_STATISTICS_READ_SIZE );
+
+	if( buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buffer.",
+		 function );
+
+		goto on_error;
+	}
+	while( (size64_t) media_offset < media_size )
+	{
+		read_size = INFO_HANDLE_STATISTICS_READ_SIZE;
+
+		if( (size64_t) read_size > ( media_size - media_offset ) )
+		{
+			read_size = (size_t) ( media_size - media_offset );
+		}
+		read_count = libqcow_file_read_buffer_at_offset(
+		              info_handle->input_file,
+		              buffer,
+		              read_size,
+		              media_offset,
+		              error );
+
+		if( read_count != (ssize_t) read_size )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read media data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 media_offset,
+			 media_offset );
+
+			goto on_error;
+		}
+		media_offset += (off64_t) read_count;
+	}
+	memory_free(
+	 buffer );
+
+	buffer = NULL;
+
+	if( libqcow_file_get_statistics(
+	     info_handle->input_file,
+	     statistics,
+	     LIBQCOW_NUMBER_OF_STATISTICS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve statistics.",
+		 function );
+
+		goto on_error;
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "Read statistics:\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tBytes returned:\t\t\t%" PRIu64 "\n",
+	 statistics[ LIBQCOW_STATISTIC_BYTES_RETURNED ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tSparse bytes:\t\t\t%" PRIu64 "\n",
+	 statistics[ LIBQCOW_STATISTIC_SPARSE_BYTES ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tHost reads:\t\t\t%" PRIu64 " (%" PRIu64 " bytes)\n",
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_HOST_READS ],
+	 statistics[ LIBQCOW_STATISTIC_HOST_BYTES_READ ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tLevel 2 table cache:\t\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_MISSES ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tCluster block cache:\t\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_MISSES ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tCompressed cluster cache:\t%" PRIu64 " hits, %" PRIu64 " misses\n",
+	 statistics[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_COMPRESSED_CLUSTER_BLOCK_CACHE_MISSES ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tDecompressions:\t\t\t%" PRIu64 " (%" PRIu64 " ns)\n",
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_DECOMPRESSIONS ],
+	 statistics[ LIBQCOW_STATISTIC_DECOMPRESSION_TIME ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tDecryptions:\t\t\t%" PRIu64 " (%" PRIu64 " ns)\n",
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_DECRYPTIONS ],
+	 statistics[ LIBQCOW_STATISTIC_DECRYPTION_TIME ] );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "Latencies (nanoseconds):\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tOperation\t\tCount\tp50\tp90\tp99\tp99.9\tmax\n" );
+
+	for( operation = 0;
+	     operation < LIBQCOW_NUMBER_OF_LATENCY_OPERATIONS;
+	     operation++ )
+	{
+		for( percentile_index = 0;
+		     percentile_index < 5;
+		     percentile_index++ )
+		{
+			if( libqcow_file_get_latency_percentile(
+			     info_handle->input_file,
+			     operation,
+			     percentiles[ percentile_index ],
+			     &number_of_values,
+			     &( latencies[ percentile_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve latency percentile.",
+				 function );
+
+				goto on_error;
+			}
+		}
+		/* Operations that were not used, such as decryption of an unencrypted image, are not printed
+		 */
+		if( number_of_values == 0 )
+		{
+			continue;
+		}
+		fprintf(
+		 info_handle->notify_stream,
+		 "\t%-20s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+		 operation_names[ operation ],
+		 number_of_values,
+		 latencies[ 0 ],
+		 latencies[ 1 ],
+		 latencies[ 2 ],
+		 latencies[ 3 ],
+		 latencies[ 4 ] );
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+
+on_error:
+	if( buffer != NULL )
+	{
+		memory_free(
+		 buffer );
+	}
+	return( -1 );
+}
+
+/* Prints a changed range of the diff
+ * Returns 1 if successful or -1 on error
+ */
+static int info_handle_diff_range_fprint(
+            off64_t range_offset,
+            size64_t range_size,
+            void *user_data )
+{
+	info_handle_t *info_handle = NULL;
+
+	if( user_data == NULL )
+	{
+		return( -1 );
+	}
+	info_handle = (info_handle_t *) user_data;
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\t0x%08" PRIx64 " - 0x%08" PRIx64 " (%" PRIu64 " bytes)\n",
+	 (uint64_t) range_offset,
+	 (uint64_t) range_offset + range_size,
+	 range_size );
+
+	info_handle->diff_changed_size += range_size;
+
+	return( 1 );
+}
+
+/* Prints the changed ranges of the diff
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_diff_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error )
+{
+	libqcow_snapshot_t *snapshot_a = NULL;
+	libqcow_snapshot_t *snapshot_b = NULL;
+	static char *function          = "info_handle_diff_fprint";
+	int number_of_snapshots        = 0;
+	int result                     = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( info_handle->diff_mode != INFO_HANDLE_DIFF_MODE_BACKING )
+	 && ( info_handle->diff_mode != INFO_HANDLE_DIFF_MODE_SNAPSHOT ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported diff mode.",
+		 function );
+
+		return( -1 );
+	}
+	info_handle->diff_changed_size = 0;
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "QEMU Copy-On-Write (QCOW) image file changed ranges:\n" );
+
+	if( info_handle->diff_mode == INFO_HANDLE_DIFF_MODE_BACKING )
+	{
+		result = libqcow_file_diff_extents(
+		          info_handle->input_file,
+		          NULL,
+		          &info_handle_diff_range_fprint,
+		          (void *) info_handle,
+		          error );
+	}
+	else
+	{
+		if( libqcow_file_get_number_of_snapshots(
+		     info_handle->input_file,
+		     &number_of_snapshots,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve number of snapshots.",
+			 function );
+
+			goto on_error;
+		}
+		if( ( info_handle->diff_snapshot_index_a < 1 )
+		 || ( info_handle->diff_snapshot_index_a > number_of_snapshots )
+		 || ( info_handle->diff_snapshot_index_b < 0 )
+		 || ( info_handle->diff_snapshot_index_b > number_of_snapshots ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+			 "%s: invalid snapshot index value out of bounds.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_file_get_snapshot_by_index(
+		     info_handle->input_file,
+		     info_handle->diff_snapshot_index_a - 1,
+		     &snapshot_a,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve snapshot: %d.",
+			 function,
+			 info_handle->diff_snapshot_index_a );
+
+			goto on_error;
+		}
+		if( info_handle->diff_snapshot_index_b != 0 )
+		{
+			if( libqcow_file_get_snapshot_by_index(
+			     info_handle->input_file,
+			     info_handle->diff_snapshot_index_b - 1,
+			     &snapshot_b,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve snapshot: %d.",
+				 function,
+				 info_handle->diff_snapshot_index_b );
+
+				goto on_error;
+			}
+		}
+		result = libqcow_snapshot_diff_extents(
+		          snapshot_a,
+		          snapshot_b,
+		          &info_handle_diff_range_fprint,
+		          (void *) info_handle,
+		          error );
+	}
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to diff extents.",
+		 function );
+
+		goto on_error;
+	}
+	if( snapshot_b != NULL )
+	{
+		if( libqcow_snapshot_free(
+		     &snapshot_b,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free snapshot B.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( snapshot_a != NULL )
+	{
+		if( libqcow_snapshot_free(
+		     &snapshot_a,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free snapshot A.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tTotal changed:\t%" PRIu64 " bytes\n",
+	 info_handle->diff_changed_size );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\n" );
+
+	return( 1 );
+
+on_error:
+	if( snapshot_b != NULL )
+	{
+		libqcow_snapshot_free(
+		 &snapshot_b,
+		 NULL );
+	}
+	if( snapshot_a != NULL )
+	{
+		libqcow_snapshot_free(
+		 &snapshot_a,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Determines the square root of a value using Newton's method
+ * Returns the square root or 0.0 if the value is 0.0 or less
+ */
+static double info_handle_square_root(
+               double value )
+{
+	double square_root = 0.0;
+	int iteration      = 0;
+
+	if( value <= 0.0 )
+	{
+		return( 0.0 );
+	}
+	square_root = ( value < 1.0 ) ? 1.0 : value;
+
+	for( iteration = 0;
+	     iteration < 64;
+	     iteration++ )
+	{
+		square_root = ( square_root + ( value / square_root ) ) / 2.0;
+	}
+	return( square_root );
+}
+
+/* Prints an estimated percentage of the profile
+ * The margin is the 95% confidence interval of the sampled proportion,
+ * corrected for the size of the population, where 0 represents unknown
+ */
+static void info_handle_profile_estimate_fprint(
+             info_handle_t *info_handle,
+             const char *name,
+             uint64_t number_of_matches,
+             uint64_t number_of_samples,
+             uint64_t population_size )
+{
+	double finite_population_correction = 1.0;
+	double margin                       = 0.0;
+	double proportion                   = 0.0;
+
+	if( ( info_handle == NULL )
+	 || ( name == NULL ) )
+	{
+		return;
+	}
+	if( number_of_samples == 0 )
+	{
+		fprintf(
+		 info_handle->notify_stream,
+		 "\t%-20s\tN/A\n",
+		 name );
+
+		return;
+	}
+	proportion = (double) number_of_matches / (double) number_of_samples;
+
+	if( population_size > 1 )
+	{
+		finite_population_correction = (double) ( population_size - number_of_samples ) / (double) ( population_size - 1 );
+	}
+	margin = 1.96 * info_handle_square_root(
+	                 proportion * ( 1.0 - proportion ) / (double) number_of_samples * finite_population_correction );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\t%-20s\t%6.2f%% +/- %.2f%%\n",
+	 name,
+	 proportion * 100.0,
+	 margin * 100.0 );
+}
+
+/* Samples the cluster blocks and prints the estimated composition of the media
+ * Returns 1 if successful or -1 on error
+ */
+int info_handle_profile_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error )
+{
+	uint64_t values[ LIBQCOW_NUMBER_OF_SAMPLE_VALUES ];
+
+	static char *function      = "info_handle_profile_fprint";
+	uint64_t number_of_data    = 0;
+	uint64_t number_of_sampled = 0;
+	uint64_t number_of_total   = 0;
+
+	if( info_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid info handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_sample(
+	     info_handle->input_file,
+	     0,
+	     info_handle->profile_sampling_fraction,
+	     0,
+	     values,
+	     LIBQCOW_NUMBER_OF_SAMPLE_VALUES,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to sample cluster blocks.",
+		 function );
+
+		return( -1 );
+	}
+	number_of_total   = values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_CLUSTERS ];
+	number_of_sampled = values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_CLUSTERS ];
+	number_of_data    = values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_DATA_CLUSTERS ];
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "Profile:\n" );
+
+	fprintf(
+	 info_handle->notify_stream,
+	 "\tSampled cluster blocks:\t%" PRIu64 " of %" PRIu64 "\n",
+	 number_of_sampled,
+	 number_of_total );
+
+	info_handle_profile_estimate_fprint(
+	 info_handle,
+	 "Allocated:",
+	 values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_ALLOCATED_CLUSTERS ],
+	 number_of_sampled,
+	 number_of_total );
+
+	info_handle_profile_estimate_fprint(
+	 info_handle,
+	 "Compressed:",
+	 values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_COMPRESSED_CLUSTERS ],
+	 number_of_sampled,
+	 number_of_total );
+
+	info_handle_profile_estimate_fprint(
+	 info_handle,
+	 "Zero:",
+	 values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_ZERO_CLUSTERS ],
+	 number_of_sampled,
+	 number_of_total );
+
+	info_handle_profile_estimate_fprint(
+	 info_handle,
+	 "Sparse:",
+	 values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_SPARSE_CLUSTERS ],
+	 number_of_sampled,
+	 number_of_total );
+
+	/* The high entropy estimate is relative to the allocated and compressed cluster blocks,
+	 * of which the number is not known
+	 */
+	info_handle_profile_estimate_fprint(
+	 info_handle,
+	 "High entropy data:",
+	 values[ LIBQCOW_SAMPLE_VALUE_NUMBER_OF_SAMPLED_HIGH_ENTROPY_CLUSTERS ],
+	 number_of_data,
+	 0 );
 
 	fprintf(
 	 info_handle->notify_stream,
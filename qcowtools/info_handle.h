@@ -34,6 +34,13 @@
 extern "C" {
 #endif
 
+enum INFO_HANDLE_DIFF_MODES
+{
+	INFO_HANDLE_DIFF_MODE_NONE		= 0,
+	INFO_HANDLE_DIFF_MODE_BACKING		= 1,
+	INFO_HANDLE_DIFF_MODE_SNAPSHOT		= 2
+};
+
 typedef struct info_handle info_handle_t;
 
 struct info_handle
@@ -45,6 +52,27 @@ struct info_handle
 	/* The notification output stream
 	 */
 	FILE *notify_stream;
+
+	/* The diff mode
+	 */
+	int diff_mode;
+
+	/* The (1-based) index of the first snapshot to diff
+	 */
+	int diff_snapshot_index_a;
+
+	/* The (1-based) index of the second snapshot to diff
+	 * 0 represents the current media data
+	 */
+	int diff_snapshot_index_b;
+
+	/* The number of changed bytes found by the diff
+	 */
+	size64_t diff_changed_size;
+
+	/* The fraction of the cluster blocks sampled by the profile
+	 */
+	double profile_sampling_fraction;
 };
 
 int info_handle_initialize(
@@ -59,6 +87,16 @@ int info_handle_signal_abort(
      info_handle_t *info_handle,
      libcerror_error_t **error );
 
+int info_handle_set_diff(
+     info_handle_t *info_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int info_handle_set_profile(
+     info_handle_t *info_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
 int info_handle_open_input(
      info_handle_t *info_handle,
      const system_character_t *filename,
@@ -72,6 +110,32 @@ int info_handle_file_fprint(
      info_handle_t *info_handle,
      libcerror_error_t **error );
 
+int info_handle_snapshot_fprint(
+     info_handle_t *info_handle,
+     int snapshot_index,
+     libqcow_snapshot_t *snapshot,
+     libcerror_error_t **error );
+
+int info_handle_layout_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error );
+
+int info_handle_host_allocation_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error );
+
+int info_handle_statistics_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error );
+
+int info_handle_diff_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error );
+
+int info_handle_profile_fprint(
+     info_handle_t *info_handle,
+     libcerror_error_t **error );
+
 #if defined( __cplusplus )
 }
 #endif
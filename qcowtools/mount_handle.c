@@ -26,6 +26,14 @@
 #include <types.h>
 #include <wide_string.h>
 
+#if defined( HAVE_FCNTL_H )
+#include <fcntl.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
 #include "mount_handle.h"
 #include "qcowtools_libcpath.h"
 #include "qcowtools_libcerror.h"
@@ -33,6 +41,7 @@
 #include "qcowtools_libcpath.h"
 #include "qcowtools_libqcow.h"
 #include "qcowtools_libuna.h"
+#include "qcowtools_unused.h"
 
 /* Creates a mount handle
  * Make sure the value mount_handle is referencing, is set to NULL
@@ -108,11 +117,55 @@ int mount_handle_initialize(
 
 		goto on_error;
 	}
+	if( libcdata_array_initialize(
+	     &( ( *mount_handle )->snapshots_array ),
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize snapshots array.",
+		 function );
+
+		goto on_error;
+	}
+	if( libcdata_array_initialize(
+	     &( ( *mount_handle )->backing_files_array ),
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize backing files array.",
+		 function );
+
+		goto on_error;
+	}
+	( *mount_handle )->input_file_descriptor = -1;
+
 	return( 1 );
 
 on_error:
 	if( *mount_handle != NULL )
 	{
+		if( ( *mount_handle )->snapshots_array != NULL )
+		{
+			libcdata_array_free(
+			 &( ( *mount_handle )->snapshots_array ),
+			 NULL,
+			 NULL );
+		}
+		if( ( *mount_handle )->input_files_array != NULL )
+		{
+			libcdata_array_free(
+			 &( ( *mount_handle )->input_files_array ),
+			 NULL,
+			 NULL );
+		}
 		memory_free(
 		 *mount_handle );
 
@@ -149,6 +202,43 @@ int mount_handle_free(
 			memory_free(
 			 ( *mount_handle )->basename );
 		}
+#if defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+		if( ( *mount_handle )->input_file_descriptor != -1 )
+		{
+			close(
+			 ( *mount_handle )->input_file_descriptor );
+		}
+#endif
+		/* The snapshots must be freed before the input files
+		 */
+		if( libcdata_array_free(
+		     &( ( *mount_handle )->snapshots_array ),
+		     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_snapshot_free,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free snapshots array.",
+			 function );
+
+			result = -1;
+		}
+		if( libcdata_array_free(
+		     &( ( *mount_handle )->backing_files_array ),
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free backing files array.",
+			 function );
+
+			result = -1;
+		}
 		if( libcdata_array_free(
 		     &( ( *mount_handle )->input_files_array ),
 		     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_file_free,
@@ -395,6 +485,290 @@ int mount_handle_set_password(
 	return( 1 );
 }
 
+/* Sets the cache limits
+ * The string is formatted as: level2_tables,cluster_blocks
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_set_cache_limits(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function                = "mount_handle_set_cache_limits";
+	size_t string_index                  = 0;
+	uint64_t value_64bit                 = 0;
+	int maximum_number_of_cluster_blocks = 0;
+	int maximum_number_of_level2_tables  = 0;
+	int value_index                      = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	for( value_index = 0;
+	     value_index < 2;
+	     value_index++ )
+	{
+		value_64bit = 0;
+
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+			 function,
+			 string_index );
+
+			return( -1 );
+		}
+		while( ( string[ string_index ] >= (system_character_t) '0' )
+		    && ( string[ string_index ] <= (system_character_t) '9' ) )
+		{
+			value_64bit *= 10;
+			value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+			if( value_64bit > (uint64_t) INT_MAX )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+				 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+				 "%s: invalid string - value exceeds maximum.",
+				 function );
+
+				return( -1 );
+			}
+			string_index++;
+		}
+		if( value_64bit == 0 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_ZERO_OR_LESS,
+			 "%s: invalid string - value zero or less.",
+			 function );
+
+			return( -1 );
+		}
+		if( value_index == 0 )
+		{
+			maximum_number_of_level2_tables = (int) value_64bit;
+
+			if( string[ string_index ] != (system_character_t) ',' )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+				 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+				 "%s: unsupported string - missing separator.",
+				 function );
+
+				return( -1 );
+			}
+			string_index++;
+		}
+		else
+		{
+			maximum_number_of_cluster_blocks = (int) value_64bit;
+		}
+	}
+	if( string[ string_index ] != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - trailing data.",
+		 function );
+
+		return( -1 );
+	}
+	mount_handle->maximum_number_of_level2_tables  = maximum_number_of_level2_tables;
+	mount_handle->maximum_number_of_cluster_blocks = maximum_number_of_cluster_blocks;
+
+	return( 1 );
+}
+
+/* Sets the number of worker threads
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_set_number_of_worker_threads(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "mount_handle_set_number_of_worker_threads";
+	size_t string_index   = 0;
+	uint64_t value_64bit  = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( string[ string_index ] < (system_character_t) '0' )
+	 || ( string[ string_index ] > (system_character_t) '9' ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - expected decimal value at index: %" PRIzd ".",
+		 function,
+		 string_index );
+
+		return( -1 );
+	}
+	while( ( string[ string_index ] >= (system_character_t) '0' )
+	    && ( string[ string_index ] <= (system_character_t) '9' ) )
+	{
+		value_64bit *= 10;
+		value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+
+		if( value_64bit > (uint64_t) INT_MAX )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+			 "%s: invalid string - value exceeds maximum.",
+			 function );
+
+			return( -1 );
+		}
+		string_index++;
+	}
+	if( string[ string_index ] != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - trailing data.",
+		 function );
+
+		return( -1 );
+	}
+	mount_handle->number_of_worker_threads = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Sets the scratch overlay
+ * The string is either "memory" or the filename of the scratch file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_set_scratch_overlay(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error )
+{
+	static char *function = "mount_handle_set_scratch_overlay";
+	size_t string_length  = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( string == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid string.",
+		 function );
+
+		return( -1 );
+	}
+	string_length = system_string_length(
+	                 string );
+
+	if( string_length == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported string - missing value.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( string_length == 6 )
+	 && ( system_string_compare(
+	       string,
+	       _SYSTEM_STRING( "memory" ),
+	       6 ) == 0 ) )
+	{
+		mount_handle->scratch_overlay_filename = NULL;
+	}
+	else
+	{
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: scratch files are not supported with wide system character filenames.",
+		 function );
+
+		return( -1 );
+#else
+		mount_handle->scratch_overlay_filename = string;
+#endif
+	}
+	mount_handle->scratch_overlay_is_set = 1;
+
+	return( 1 );
+}
+
 /* Opens the input of the mount handle
  * Returns 1 if successful, 0 if the keys could not be read or -1 on error
  */
@@ -409,6 +783,11 @@ int mount_handle_open_input(
 	size_t basename_length           = 0;
 	size_t filename_length           = 0;
 	int entry_index                  = 0;
+	int number_of_input_files        = 0;
+
+#if defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+	uint32_t encryption_method       = 0;
+#endif
 
 	if( mount_handle == NULL )
 	{
@@ -519,17 +898,52 @@ int mount_handle_open_input(
 			goto on_error;
 		}
 	}
-#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
-	if( libqcow_file_open_wide(
-	     input_file,
-	     filename,
-	     LIBQCOW_OPEN_READ,
-	     error ) != 1 )
-#else
-	if( libqcow_file_open(
-	     input_file,
-	     filename,
-	     LIBQCOW_OPEN_READ,
+	if( mount_handle->maximum_number_of_level2_tables != 0 )
+	{
+		if( libqcow_file_set_cache_limits(
+		     input_file,
+		     mount_handle->maximum_number_of_level2_tables,
+		     mount_handle->maximum_number_of_cluster_blocks,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set cache limits.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( mount_handle->number_of_worker_threads != 0 )
+	{
+		if( libqcow_file_set_number_of_worker_threads(
+		     input_file,
+		     mount_handle->number_of_worker_threads,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set number of worker threads.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	if( libqcow_file_open_wide(
+	     input_file,
+	     filename,
+	     LIBQCOW_OPEN_READ,
+	     error ) != 1 )
+#else
+	if( libqcow_file_open(
+	     input_file,
+	     filename,
+	     LIBQCOW_OPEN_READ,
 	     error ) != 1 )
 #endif
 	{
@@ -542,22 +956,73 @@ int mount_handle_open_input(
 
 		goto on_error;
 	}
-/* TODO
-	if( mount_handle_open_input_parent_file(
-	     mount_handle,
+#if defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+	if( libqcow_file_get_encryption_method(
 	     input_file,
-	     error ) == -1 )
+	     &encryption_method,
+	     error ) != 1 )
 	{
 		libcerror_error_set(
 		 error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_OPEN_FAILED,
-		 "%s: unable to open parent input file.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve encryption method.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	if( libcdata_array_get_number_of_entries(
+	     mount_handle->input_files_array,
+	     &number_of_input_files,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of input files.",
 		 function );
 
 		goto on_error;
 	}
-*/
+	/* Only the first input file is writable
+	 */
+	if( ( number_of_input_files == 0 )
+	 && ( mount_handle->scratch_overlay_is_set != 0 ) )
+	{
+		if( libqcow_file_set_scratch_overlay(
+		     input_file,
+		     (const char *) mount_handle->scratch_overlay_filename,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set scratch overlay.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( number_of_input_files == 0 )
+	{
+		if( mount_handle_open_input_layers(
+		     mount_handle,
+		     input_file,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 "%s: unable to open layers of input file.",
+			 function );
+
+			goto on_error;
+		}
+	}
 	if( libcdata_array_append_entry(
 	     mount_handle->input_files_array,
 	     &entry_index,
@@ -573,9 +1038,32 @@ int mount_handle_open_input(
 
 		goto on_error;
 	}
+#if defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+	/* Encrypted data is not stored as-is, if the file cannot be opened again
+	 * the data is read using the input file only. Data written to the scratch
+	 * overlay is not in the file, hence the file is not used when it is set
+	 */
+	if( ( entry_index == 0 )
+	 && ( encryption_method == LIBQCOW_ENCRYPTION_METHOD_NONE )
+	 && ( mount_handle->scratch_overlay_is_set == 0 ) )
+	{
+		mount_handle->input_file_descriptor = open(
+		                                       filename,
+		                                       O_RDONLY );
+	}
+#endif
 	return( 1 );
 
 on_error:
+	libcdata_array_empty(
+	 mount_handle->snapshots_array,
+	 (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_snapshot_free,
+	 NULL );
+	libcdata_array_empty(
+	 mount_handle->backing_files_array,
+	 NULL,
+	 NULL );
+
 	if( input_file != NULL )
 	{
 		libqcow_file_free(
@@ -590,6 +1078,155 @@ on_error:
 	return( -1 );
 }
 
+/* Opens the layers of an input file
+ * The internal snapshots and the backing files in the backing chain of the input file
+ * are the layers that are provided next to the media data of the input file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_open_input_layers(
+     mount_handle_t *mount_handle,
+     libqcow_file_t *input_file,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *backing_file  = NULL;
+	libqcow_file_t *layer_file    = NULL;
+	libqcow_snapshot_t *snapshot  = NULL;
+	static char *function         = "mount_handle_open_input_layers";
+	int entry_index               = 0;
+	int number_of_snapshots       = 0;
+	int result                    = 0;
+	int snapshot_index            = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_number_of_snapshots(
+	     input_file,
+	     &number_of_snapshots,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of snapshots.",
+		 function );
+
+		goto on_error;
+	}
+	for( snapshot_index = 0;
+	     snapshot_index < number_of_snapshots;
+	     snapshot_index++ )
+	{
+		if( libqcow_file_get_snapshot_by_index(
+		     input_file,
+		     snapshot_index,
+		     &snapshot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve snapshot: %d.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		if( libcdata_array_append_entry(
+		     mount_handle->snapshots_array,
+		     &entry_index,
+		     (intptr_t *) snapshot,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to append snapshot: %d to array.",
+			 function,
+			 snapshot_index );
+
+			goto on_error;
+		}
+		snapshot = NULL;
+	}
+	/* The backing files are opened by the library, which shares its cache
+	 * with the backing files so that clusters read through a layer can be
+	 * reused by the layers above it
+	 */
+	layer_file = input_file;
+
+	do
+	{
+		result = libqcow_file_get_parent_file(
+		          layer_file,
+		          &backing_file,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve backing file.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result != 0 )
+		{
+			if( libcdata_array_append_entry(
+			     mount_handle->backing_files_array,
+			     &entry_index,
+			     (intptr_t *) backing_file,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+				 "%s: unable to append backing file to array.",
+				 function );
+
+				goto on_error;
+			}
+			layer_file = backing_file;
+		}
+	}
+	while( result != 0 );
+
+	return( 1 );
+
+on_error:
+	if( snapshot != NULL )
+	{
+		libqcow_snapshot_free(
+		 &snapshot,
+		 NULL );
+	}
+	libcdata_array_empty(
+	 mount_handle->snapshots_array,
+	 (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_snapshot_free,
+	 NULL );
+	libcdata_array_empty(
+	 mount_handle->backing_files_array,
+	 NULL,
+	 NULL );
+
+	return( -1 );
+}
+
 /* Closes the mount handle
  * Returns the 0 if succesful or -1 on error
  */
@@ -627,6 +1264,45 @@ int mount_handle_close(
 
 		return( -1 );
 	}
+	/* The snapshots must be freed before the input files are closed
+	 */
+	if( libcdata_array_empty(
+	     mount_handle->snapshots_array,
+	     (int (*)(intptr_t **, libcerror_error_t **)) &libqcow_snapshot_free,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to empty snapshots array.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_empty(
+	     mount_handle->backing_files_array,
+	     NULL,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to empty backing files array.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+	if( mount_handle->input_file_descriptor != -1 )
+	{
+		close(
+		 mount_handle->input_file_descriptor );
+
+		mount_handle->input_file_descriptor = -1;
+	}
+#endif
 	for( input_file_index = number_of_input_files - 1;
 	     input_file_index > 0;
 	     input_file_index-- )
@@ -665,18 +1341,21 @@ int mount_handle_close(
 	return( 0 );
 }
 
-/* Read a buffer from a specific input file
+/* Reads a buffer at a specific offset from a specific input file
+ * The read does not use or change the current offset of the input file,
+ * hence it can be used by multiple threads at the same time
  * Returns the number of bytes read if successful or -1 on error
  */
-ssize_t mount_handle_read_buffer(
+ssize_t mount_handle_read_buffer_at_offset(
          mount_handle_t *mount_handle,
          int input_file_index,
          uint8_t *buffer,
          size_t size,
+         off64_t offset,
          libcerror_error_t **error )
 {
 	libqcow_file_t *input_file = NULL;
-	static char *function      = "mount_handle_read_buffer";
+	static char *function      = "mount_handle_read_buffer_at_offset";
 	ssize_t read_count         = 0;
 
 	if( mount_handle == NULL )
@@ -706,10 +1385,11 @@ ssize_t mount_handle_read_buffer(
 
 		return( -1 );
 	}
-	read_count = libqcow_file_read_buffer(
+	read_count = libqcow_file_read_buffer_at_offset(
 	              input_file,
 	              buffer,
 	              size,
+	              offset,
 	              error );
 
 	if( read_count == -1 )
@@ -718,8 +1398,10 @@ ssize_t mount_handle_read_buffer(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_IO,
 		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read buffer from input file: %d.",
+		 "%s: unable to read buffer at offset: %" PRIi64 " (0x%08" PRIx64 ") from input file: %d.",
 		 function,
+		 offset,
+		 offset,
 		 input_file_index );
 
 		return( -1 );
@@ -727,18 +1409,22 @@ ssize_t mount_handle_read_buffer(
 	return( read_count );
 }
 
-/* Seeks a specific offset in a specific input file
- * Returns the offset if successful or -1 on error
+/* Writes a buffer at a specific offset of a specific input file
+ * Only the first input file is writable and only when the scratch overlay is set,
+ * the data is written to the scratch overlay and not to the input file
+ * Returns the number of bytes written or -1 on error
  */
-off64_t mount_handle_seek_offset(
+ssize_t mount_handle_write_buffer_at_offset(
          mount_handle_t *mount_handle,
          int input_file_index,
+         const uint8_t *buffer,
+         size_t size,
          off64_t offset,
-         int whence,
          libcerror_error_t **error )
 {
 	libqcow_file_t *input_file = NULL;
-	static char *function      = "mount_handle_seek_offset";
+	static char *function      = "mount_handle_write_buffer_at_offset";
+	ssize_t write_count        = 0;
 
 	if( mount_handle == NULL )
 	{
@@ -751,6 +1437,19 @@ off64_t mount_handle_seek_offset(
 
 		return( -1 );
 	}
+	if( ( input_file_index != 0 )
+	 || ( mount_handle->scratch_overlay_is_set == 0 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported input file: %d - not writable.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
 	if( libcdata_array_get_entry_by_index(
 	     mount_handle->input_files_array,
 	     input_file_index,
@@ -767,38 +1466,49 @@ off64_t mount_handle_seek_offset(
 
 		return( -1 );
 	}
-	offset = libqcow_file_seek_offset(
-	          input_file,
-	          offset,
-	          whence,
-	          error );
-
-	if( offset == -1 )
+	write_count = libqcow_file_write_buffer_at_offset(
+	               input_file,
+	               buffer,
+	               size,
+	               offset,
+	               error );
+
+	if( write_count == -1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset in input file: %d.",
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write buffer at offset: %" PRIi64 " (0x%08" PRIx64 ") to input file: %d.",
 		 function,
+		 offset,
+		 offset,
 		 input_file_index );
 
 		return( -1 );
 	}
-	return( offset );
+	return( write_count );
 }
 
-/* Retrieves the media size of a specific input file
- * Returns 1 if successful or -1 on error
+/* Retrieves the extent at a specific offset of a specific input file
+ * Sparse extents of an input file with a backing file contain the data
+ * of the backing file, hence these are not flagged as sparse
+ * Returns 1 if successful, 0 if the offset is beyond the media size or -1 on error
  */
-int mount_handle_get_media_size(
+int mount_handle_get_extent_at_offset(
      mount_handle_t *mount_handle,
      int input_file_index,
-     size64_t *size,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     uint32_t *extent_flags,
      libcerror_error_t **error )
 {
-	libqcow_file_t *input_file = NULL;
-	static char *function      = "mount_handle_get_media_size";
+	libqcow_file_t *input_file   = NULL;
+	static char *function        = "mount_handle_get_extent_at_offset";
+	size_t backing_filename_size = 0;
+	off64_t extent_file_offset   = 0;
+	int result                   = 0;
 
 	if( mount_handle == NULL )
 	{
@@ -811,6 +1521,17 @@ int mount_handle_get_media_size(
 
 		return( -1 );
 	}
+	if( extent_flags == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid extent flags.",
+		 function );
+
+		return( -1 );
+	}
 	if( libcdata_array_get_entry_by_index(
 	     mount_handle->input_files_array,
 	     input_file_index,
@@ -827,33 +1548,742 @@ int mount_handle_get_media_size(
 
 		return( -1 );
 	}
-	if( libqcow_file_get_media_size(
-	     input_file,
-	     size,
-	     error ) != 1 )
+	result = libqcow_file_get_extent_at_offset(
+	          input_file,
+	          offset,
+	          extent_offset,
+	          extent_size,
+	          &extent_file_offset,
+	          extent_flags,
+	          error );
+
+	if( result == -1 )
 	{
 		libcerror_error_set(
 		 error,
 		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-		 "%s: unable to retrieve media size from input file: %d.",
+		 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ") from input file: %d.",
 		 function,
+		 offset,
+		 offset,
 		 input_file_index );
 
 		return( -1 );
 	}
+	else if( result == 0 )
+	{
+		return( 0 );
+	}
+	if( ( *extent_flags & LIBQCOW_EXTENT_FLAG_IS_SPARSE ) != 0 )
+	{
+		result = libqcow_file_get_utf8_backing_filename_size(
+		          input_file,
+		          &backing_filename_size,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve backing filename size of input file: %d.",
+			 function,
+			 input_file_index );
+
+			return( -1 );
+		}
+		else if( result != 0 )
+		{
+			*extent_flags &= ~( LIBQCOW_EXTENT_FLAG_IS_SPARSE );
+		}
+	}
+	/* Sparse and zero extents could have been written to the scratch overlay
+	 */
+	if( ( input_file_index == 0 )
+	 && ( mount_handle->scratch_overlay_is_set != 0 ) )
+	{
+		*extent_flags &= ~( LIBQCOW_EXTENT_FLAG_IS_SPARSE | LIBQCOW_EXTENT_FLAG_IS_ZERO );
+	}
 	return( 1 );
 }
 
-/* Retrieves the number of input files
+/* Retrieves the range, starting at a specific offset of a specific input file
+ * and up to a maximum size, of consecutive extents that either all read as zero
+ * bytes (a hole) or all contain data
+ * Sparse and zero extents read as zero bytes unless the data is in a backing file
+ * The range size is 0 if the offset is beyond the media size
  * Returns 1 if successful or -1 on error
  */
-int mount_handle_get_number_of_input_files(
+int mount_handle_get_range_at_offset(
      mount_handle_t *mount_handle,
-     int *number_of_input_files,
+     int input_file_index,
+     off64_t offset,
+     size64_t maximum_size,
+     size64_t *range_size,
+     uint8_t *is_hole,
      libcerror_error_t **error )
 {
-	static char *function = "mount_handle_get_number_of_input_files";
+	static char *function  = "mount_handle_get_range_at_offset";
+	size64_t extent_size   = 0;
+	off64_t extent_offset  = 0;
+	off64_t range_end      = 0;
+	off64_t range_offset   = 0;
+	uint32_t extent_flags  = 0;
+	uint8_t extent_is_hole = 0;
+	int result             = 0;
+
+	if( range_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid range size.",
+		 function );
+
+		return( -1 );
+	}
+	if( is_hole == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid is hole.",
+		 function );
+
+		return( -1 );
+	}
+	*range_size = 0;
+	*is_hole    = 0;
+
+	range_offset = offset;
+
+	while( *range_size < maximum_size )
+	{
+		result = mount_handle_get_extent_at_offset(
+		          mount_handle,
+		          input_file_index,
+		          range_offset,
+		          &extent_offset,
+		          &extent_size,
+		          &extent_flags,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+			 function,
+			 range_offset,
+			 range_offset );
+
+			return( -1 );
+		}
+		else if( result == 0 )
+		{
+			break;
+		}
+		extent_is_hole = (uint8_t) ( ( extent_flags & ( LIBQCOW_EXTENT_FLAG_IS_SPARSE | LIBQCOW_EXTENT_FLAG_IS_ZERO ) ) != 0 );
+
+		if( *range_size == 0 )
+		{
+			*is_hole = extent_is_hole;
+		}
+		else if( extent_is_hole != *is_hole )
+		{
+			break;
+		}
+		range_end = extent_offset + (off64_t) extent_size;
+
+		if( range_end <= range_offset )
+		{
+			break;
+		}
+		if( (size64_t) ( range_end - offset ) > maximum_size )
+		{
+			range_end = offset + (off64_t) maximum_size;
+		}
+		*range_size  = (size64_t) ( range_end - offset );
+		range_offset = range_end;
+	}
+	return( 1 );
+}
+
+/* Retrieves the file data at a specific offset of a specific input file
+ * The file data is the part of the data, starting at the offset and up to size,
+ * that is stored as-is in the image file, so it can be read from the file descriptor
+ * at the file offset instead of via the input file
+ * Returns 1 if successful, 0 if the data at the offset is not stored as-is or -1 on error
+ */
+int mount_handle_get_file_data_at_offset(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     off64_t offset,
+     size_t size,
+     int *file_descriptor,
+     off64_t *file_offset,
+     size_t *file_data_size,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_get_file_data_at_offset";
+	size64_t extent_size       = 0;
+	size64_t remaining_size    = 0;
+	off64_t extent_file_offset = 0;
+	off64_t extent_offset      = 0;
+	uint32_t extent_flags      = 0;
+	int result                 = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_descriptor == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file descriptor.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_offset == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file offset.",
+		 function );
+
+		return( -1 );
+	}
+	if( file_data_size == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file data size.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_file_index != 0 )
+	 || ( mount_handle->input_file_descriptor == -1 )
+	 || ( size == 0 ) )
+	{
+		return( 0 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	result = libqcow_file_get_extent_at_offset(
+	          input_file,
+	          offset,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve extent at offset: %" PRIi64 " (0x%08" PRIx64 ") from input file: %d.",
+		 function,
+		 offset,
+		 offset,
+		 input_file_index );
+
+		return( -1 );
+	}
+	/* Sparse, zero and compressed extents are not stored as-is
+	 */
+	if( ( result == 0 )
+	 || ( extent_flags != 0 )
+	 || ( offset < extent_offset ) )
+	{
+		return( 0 );
+	}
+	remaining_size = extent_size - (size64_t) ( offset - extent_offset );
+
+	if( remaining_size == 0 )
+	{
+		return( 0 );
+	}
+	if( (size64_t) size > remaining_size )
+	{
+		size = (size_t) remaining_size;
+	}
+	*file_descriptor = mount_handle->input_file_descriptor;
+	*file_offset     = extent_file_offset + ( offset - extent_offset );
+	*file_data_size  = size;
+
+	return( 1 );
+}
+
+/* Retrieves the media size of a specific input file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_media_size(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_get_media_size";
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_media_size(
+	     input_file,
+	     size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size from input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Resets the read statistics of a specific input file
+ * The latency histograms of the input file are enabled as well, so that
+ * the latencies of the reads that follow are recorded
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_reset_statistics(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_reset_statistics";
+	int read_flags             = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_read_flags(
+	     input_file,
+	     &read_flags,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve read flags from input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_set_read_flags(
+	     input_file,
+	     read_flags | LIBQCOW_READ_FLAG_LATENCY_HISTOGRAMS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set read flags of input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_reset_statistics(
+	     input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to reset statistics of input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves the read statistics of a specific input file
+ * The statistics are stored by LIBQCOW_STATISTIC_ value
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_statistics(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     uint64_t *statistics,
+     int number_of_statistics,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_get_statistics";
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_statistics(
+	     input_file,
+	     statistics,
+	     number_of_statistics,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve statistics from input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Retrieves a latency percentile of an operation of a specific input file
+ * The operation is a LIBQCOW_LATENCY_OPERATION_ value
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_latency_percentile(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_get_latency_percentile";
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	if( libqcow_file_get_latency_percentile(
+	     input_file,
+	     operation,
+	     percentile,
+	     number_of_values,
+	     latency,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve latency percentile from input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Writes a digest index (sidecar) file of a specific input file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_write_digest_index(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     const system_character_t *filename,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_write_digest_index";
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( filename )
+
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: digest index files are not supported with wide system character filenames.",
+	 function );
+
+	return( -1 );
+#else
+	if( libqcow_file_write_digest_index(
+	     input_file,
+	     filename,
+	     mount_handle->number_of_worker_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write digest index of input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( 1 );
+#endif
+}
+
+/* Verifies a digest index (sidecar) file of a specific input file
+ * Returns 1 if successful, 0 if the digest index file does not match the input file or -1 on error
+ */
+int mount_handle_verify_digest_index(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     const system_character_t *filename,
+     uint64_t *number_of_changed_cluster_blocks,
+     uint64_t *number_of_mismatches,
+     libcerror_error_t **error )
+{
+	libqcow_file_t *input_file = NULL;
+	static char *function      = "mount_handle_verify_digest_index";
+	int result                 = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     mount_handle->input_files_array,
+	     input_file_index,
+	     (intptr_t **) &input_file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( filename )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( number_of_changed_cluster_blocks )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( number_of_mismatches )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( result )
+
+	libcerror_error_set(
+	 error,
+	 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+	 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+	 "%s: digest index files are not supported with wide system character filenames.",
+	 function );
+
+	return( -1 );
+#else
+	result = libqcow_file_verify_digest_index(
+	          input_file,
+	          filename,
+	          mount_handle->number_of_worker_threads,
+	          number_of_changed_cluster_blocks,
+	          number_of_mismatches,
+	          error );
+
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GENERIC,
+		 "%s: unable to verify digest index of input file: %d.",
+		 function,
+		 input_file_index );
+
+		return( -1 );
+	}
+	return( result );
+#endif
+}
+
+/* Retrieves the number of input files
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_number_of_input_files(
+     mount_handle_t *mount_handle,
+     int *number_of_input_files,
+     libcerror_error_t **error )
+{
+	static char *function = "mount_handle_get_number_of_input_files";
 
 	if( mount_handle == NULL )
 	{
@@ -883,6 +2313,323 @@ int mount_handle_get_number_of_input_files(
 	return( 1 );
 }
 
+/* Retrieves the number of layers of a specific type of a specific input file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_number_of_layers(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int layer_type,
+     int *number_of_layers,
+     libcerror_error_t **error )
+{
+	libcdata_array_t *layers_array = NULL;
+	static char *function          = "mount_handle_get_number_of_layers";
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( number_of_layers == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid number of layers.",
+		 function );
+
+		return( -1 );
+	}
+	switch( layer_type )
+	{
+		case MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE:
+			*number_of_layers = 1;
+
+			return( 1 );
+
+		case MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT:
+			layers_array = mount_handle->snapshots_array;
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE:
+			layers_array = mount_handle->backing_files_array;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported layer type.",
+			 function );
+
+			return( -1 );
+	}
+	/* Only the layers of the first input file are opened
+	 */
+	if( input_file_index != 0 )
+	{
+		*number_of_layers = 0;
+
+		return( 1 );
+	}
+	if( libcdata_array_get_number_of_entries(
+	     layers_array,
+	     number_of_layers,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve number of layers.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads a buffer at a specific offset from a specific layer of a specific input file
+ * The read does not use or change the current offset of the layer,
+ * hence it can be used by multiple threads at the same time
+ * Returns the number of bytes read if successful or -1 on error
+ */
+ssize_t mount_handle_read_layer_buffer_at_offset(
+         mount_handle_t *mount_handle,
+         int input_file_index,
+         int layer_type,
+         int layer_index,
+         uint8_t *buffer,
+         size_t size,
+         off64_t offset,
+         libcerror_error_t **error )
+{
+	libcdata_array_t *layers_array = NULL;
+	intptr_t *layer                = NULL;
+	static char *function          = "mount_handle_read_layer_buffer_at_offset";
+	ssize_t read_count             = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	switch( layer_type )
+	{
+		case MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE:
+			return( mount_handle_read_buffer_at_offset(
+			         mount_handle,
+			         input_file_index,
+			         buffer,
+			         size,
+			         offset,
+			         error ) );
+
+		case MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT:
+			layers_array = mount_handle->snapshots_array;
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE:
+			layers_array = mount_handle->backing_files_array;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported layer type.",
+			 function );
+
+			return( -1 );
+	}
+	if( input_file_index != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input file index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     layers_array,
+	     layer_index,
+	     &layer,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve layer: %d.",
+		 function,
+		 layer_index );
+
+		return( -1 );
+	}
+	if( layer_type == MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT )
+	{
+		read_count = libqcow_snapshot_read_buffer_at_offset(
+		              (libqcow_snapshot_t *) layer,
+		              buffer,
+		              size,
+		              offset,
+		              error );
+	}
+	else
+	{
+		read_count = libqcow_file_read_buffer_at_offset(
+		              (libqcow_file_t *) layer,
+		              buffer,
+		              size,
+		              offset,
+		              error );
+	}
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read buffer at offset: %" PRIi64 " (0x%08" PRIx64 ") from layer: %d.",
+		 function,
+		 offset,
+		 offset,
+		 layer_index );
+
+		return( -1 );
+	}
+	return( read_count );
+}
+
+/* Retrieves the media size of a specific layer of a specific input file
+ * Returns 1 if successful or -1 on error
+ */
+int mount_handle_get_layer_media_size(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int layer_type,
+     int layer_index,
+     size64_t *size,
+     libcerror_error_t **error )
+{
+	libcdata_array_t *layers_array = NULL;
+	intptr_t *layer                = NULL;
+	static char *function          = "mount_handle_get_layer_media_size";
+	int result                     = 0;
+
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	switch( layer_type )
+	{
+		case MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE:
+			return( mount_handle_get_media_size(
+			         mount_handle,
+			         input_file_index,
+			         size,
+			         error ) );
+
+		case MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT:
+			layers_array = mount_handle->snapshots_array;
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE:
+			layers_array = mount_handle->backing_files_array;
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported layer type.",
+			 function );
+
+			return( -1 );
+	}
+	if( input_file_index != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input file index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( libcdata_array_get_entry_by_index(
+	     layers_array,
+	     layer_index,
+	     &layer,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve layer: %d.",
+		 function,
+		 layer_index );
+
+		return( -1 );
+	}
+	if( layer_type == MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT )
+	{
+		result = libqcow_snapshot_get_media_size(
+		          (libqcow_snapshot_t *) layer,
+		          size,
+		          error );
+	}
+	else
+	{
+		result = libqcow_file_get_media_size(
+		          (libqcow_file_t *) layer,
+		          size,
+		          error );
+	}
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size from layer: %d.",
+		 function,
+		 layer_index );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
 /* Sets the basename
  * Returns 1 if successful or -1 on error
  */
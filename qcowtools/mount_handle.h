@@ -35,6 +35,25 @@
 extern "C" {
 #endif
 
+#if !defined( WINAPI ) && defined( HAVE_FCNTL_H ) && defined( HAVE_UNISTD_H )
+#define HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT
+#endif
+
+enum MOUNT_HANDLE_LAYER_TYPES
+{
+	/* The media data of the input file
+	 */
+	MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE	= 0,
+
+	/* The media data of an internal snapshot of the input file
+	 */
+	MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT	= 1,
+
+	/* The media data of a backing file in the backing chain of the input file
+	 */
+	MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE	= 2
+};
+
 typedef struct mount_handle mount_handle_t;
 
 struct mount_handle
@@ -51,6 +70,15 @@ struct mount_handle
 	 */
 	libcdata_array_t *input_files_array;
 
+	/* The snapshots of the first input file
+	 */
+	libcdata_array_t *snapshots_array;
+
+	/* The backing files of the first input file, in order of the backing chain
+	 * The backing files are managed by the library
+	 */
+	libcdata_array_t *backing_files_array;
+
 	/* The key data
 	 */
 	uint8_t key_data[ 16 ];
@@ -67,6 +95,36 @@ struct mount_handle
 	 */
 	size_t password_length;
 
+	/* The maximum number of level 2 table cache entries
+	 * 0 represents the library default
+	 */
+	int maximum_number_of_level2_tables;
+
+	/* The maximum number of cluster block cache entries
+	 * 0 represents the library default
+	 */
+	int maximum_number_of_cluster_blocks;
+
+	/* The number of worker threads
+	 * 0 represents the library default
+	 */
+	int number_of_worker_threads;
+
+	/* The scratch overlay filename
+	 * NULL if the scratch overlay is stored in memory
+	 */
+	const system_character_t *scratch_overlay_filename;
+
+	/* Value to indicate the scratch overlay is set, which makes the first input file writable
+	 */
+	uint8_t scratch_overlay_is_set;
+
+	/* The file descriptor of the first input file, which is used to pass
+	 * data that is stored as-is in the file without reading it
+	 * -1 if not set
+	 */
+	int input_file_descriptor;
+
 	/* The notification output stream
 	 */
 	FILE *notify_stream;
@@ -94,40 +152,150 @@ int mount_handle_set_password(
      const system_character_t *string,
      libcerror_error_t **error );
 
+int mount_handle_set_cache_limits(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int mount_handle_set_number_of_worker_threads(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
+int mount_handle_set_scratch_overlay(
+     mount_handle_t *mount_handle,
+     const system_character_t *string,
+     libcerror_error_t **error );
+
 int mount_handle_open_input(
      mount_handle_t *mount_handle,
      const system_character_t *filename,
      libcerror_error_t **error );
 
+int mount_handle_open_input_layers(
+     mount_handle_t *mount_handle,
+     libqcow_file_t *input_file,
+     libcerror_error_t **error );
+
 int mount_handle_close(
      mount_handle_t *mount_handle,
      libcerror_error_t **error );
 
-ssize_t mount_handle_read_buffer(
+ssize_t mount_handle_read_buffer_at_offset(
          mount_handle_t *mount_handle,
          int input_file_index,
          uint8_t *buffer,
          size_t size,
+         off64_t offset,
          libcerror_error_t **error );
 
-off64_t mount_handle_seek_offset(
+ssize_t mount_handle_write_buffer_at_offset(
          mount_handle_t *mount_handle,
          int input_file_index,
+         const uint8_t *buffer,
+         size_t size,
          off64_t offset,
-         int whence,
          libcerror_error_t **error );
 
+int mount_handle_get_extent_at_offset(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     off64_t offset,
+     off64_t *extent_offset,
+     size64_t *extent_size,
+     uint32_t *extent_flags,
+     libcerror_error_t **error );
+
+int mount_handle_get_range_at_offset(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     off64_t offset,
+     size64_t maximum_size,
+     size64_t *range_size,
+     uint8_t *is_hole,
+     libcerror_error_t **error );
+
+int mount_handle_get_file_data_at_offset(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     off64_t offset,
+     size_t size,
+     int *file_descriptor,
+     off64_t *file_offset,
+     size_t *file_data_size,
+     libcerror_error_t **error );
+
 int mount_handle_get_media_size(
      mount_handle_t *mount_handle,
      int input_file_index,
      size64_t *size,
      libcerror_error_t **error );
 
+int mount_handle_reset_statistics(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     libcerror_error_t **error );
+
+int mount_handle_get_statistics(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     uint64_t *statistics,
+     int number_of_statistics,
+     libcerror_error_t **error );
+
+int mount_handle_get_latency_percentile(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int operation,
+     double percentile,
+     uint64_t *number_of_values,
+     uint64_t *latency,
+     libcerror_error_t **error );
+
+int mount_handle_write_digest_index(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     const system_character_t *filename,
+     libcerror_error_t **error );
+
+int mount_handle_verify_digest_index(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     const system_character_t *filename,
+     uint64_t *number_of_changed_cluster_blocks,
+     uint64_t *number_of_mismatches,
+     libcerror_error_t **error );
+
 int mount_handle_get_number_of_input_files(
      mount_handle_t *mount_handle,
      int *number_of_input_files,
      libcerror_error_t **error );
 
+int mount_handle_get_number_of_layers(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int layer_type,
+     int *number_of_layers,
+     libcerror_error_t **error );
+
+ssize_t mount_handle_read_layer_buffer_at_offset(
+         mount_handle_t *mount_handle,
+         int input_file_index,
+         int layer_type,
+         int layer_index,
+         uint8_t *buffer,
+         size_t size,
+         off64_t offset,
+         libcerror_error_t **error );
+
+int mount_handle_get_layer_media_size(
+     mount_handle_t *mount_handle,
+     int input_file_index,
+     int layer_type,
+     int layer_index,
+     size64_t *size,
+     libcerror_error_t **error );
+
 int mount_handle_set_basename(
      mount_handle_t *mount_handle,
      const system_character_t *basename,
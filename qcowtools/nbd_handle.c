@@ -0,0 +1,2874 @@
+/*
+ * Network block device (NBD) handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_ERRNO_H )
+#include <errno.h>
+#endif
+
+#if defined( HAVE_NETDB_H )
+#include <netdb.h>
+#endif
+
+#if defined( HAVE_NETINET_IN_H )
+#include <netinet/in.h>
+#endif
+
+#if defined( HAVE_NETINET_TCP_H )
+#include <netinet/tcp.h>
+#endif
+
+#if defined( HAVE_SYS_SOCKET_H )
+#include <sys/socket.h>
+#endif
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#include "mount_handle.h"
+#include "nbd_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libcthreads.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_unused.h"
+
+#if defined( HAVE_NBD_HANDLE_SUPPORT )
+
+/* The values of the NBD protocol, as described in the protocol specification
+ * of the NBD project (doc/proto.md)
+ */
+#define NBD_MAGIC_INIT_PASSWORD			0x4e42444d41474943ULL
+#define NBD_MAGIC_OPTION			0x49484156454f5054ULL
+#define NBD_MAGIC_OPTION_REPLY			0x0003e889045565a9ULL
+#define NBD_MAGIC_REQUEST			0x25609513UL
+#define NBD_MAGIC_SIMPLE_REPLY			0x67446698UL
+#define NBD_MAGIC_STRUCTURED_REPLY		0x668e33efUL
+
+#define NBD_FLAG_FIXED_NEWSTYLE			0x0001
+#define NBD_FLAG_NO_ZEROES			0x0002
+
+#define NBD_FLAG_C_FIXED_NEWSTYLE		0x00000001UL
+#define NBD_FLAG_C_NO_ZEROES			0x00000002UL
+
+#define NBD_FLAG_HAS_FLAGS			0x0001
+#define NBD_FLAG_READ_ONLY			0x0002
+#define NBD_FLAG_SEND_DF			0x0080
+#define NBD_FLAG_CAN_MULTI_CONN			0x0100
+
+#define NBD_OPT_EXPORT_NAME			1
+#define NBD_OPT_ABORT				2
+#define NBD_OPT_LIST				3
+#define NBD_OPT_INFO				6
+#define NBD_OPT_GO				7
+#define NBD_OPT_STRUCTURED_REPLY		8
+#define NBD_OPT_LIST_META_CONTEXT		9
+#define NBD_OPT_SET_META_CONTEXT		10
+
+#define NBD_REP_ACK				1
+#define NBD_REP_SERVER				2
+#define NBD_REP_INFO				3
+#define NBD_REP_META_CONTEXT			4
+#define NBD_REP_ERR_UNSUP			0x80000001UL
+#define NBD_REP_ERR_INVALID			0x80000003UL
+#define NBD_REP_ERR_UNKNOWN			0x80000006UL
+
+#define NBD_INFO_EXPORT				0
+#define NBD_INFO_BLOCK_SIZE			3
+
+#define NBD_CMD_READ				0
+#define NBD_CMD_WRITE				1
+#define NBD_CMD_DISC				2
+#define NBD_CMD_FLUSH				3
+#define NBD_CMD_TRIM				4
+#define NBD_CMD_WRITE_ZEROES			6
+#define NBD_CMD_BLOCK_STATUS			7
+
+#define NBD_CMD_FLAG_DF				0x0002
+#define NBD_CMD_FLAG_REQ_ONE			0x0008
+
+#define NBD_REPLY_FLAG_DONE			0x0001
+
+#define NBD_REPLY_TYPE_NONE			0
+#define NBD_REPLY_TYPE_OFFSET_DATA		1
+#define NBD_REPLY_TYPE_OFFSET_HOLE		2
+#define NBD_REPLY_TYPE_BLOCK_STATUS		5
+#define NBD_REPLY_TYPE_ERROR			0x8001
+
+#define NBD_STATE_HOLE				0x00000001UL
+#define NBD_STATE_ZERO				0x00000002UL
+
+#define NBD_EPERM				1
+#define NBD_EIO					5
+#define NBD_EINVAL				22
+
+/* The name and identifier of the allocation metadata context
+ */
+#define NBD_META_CONTEXT_BASE_ALLOCATION	"base:allocation"
+#define NBD_META_CONTEXT_BASE_ALLOCATION_ID	1
+
+#if defined( MSG_NOSIGNAL )
+#define NBD_HANDLE_SEND_FLAGS			MSG_NOSIGNAL
+#else
+#define NBD_HANDLE_SEND_FLAGS			0
+#endif
+
+typedef struct nbd_handle_connection nbd_handle_connection_t;
+
+struct nbd_handle_connection
+{
+	/* The NBD handle
+	 */
+	nbd_handle_t *nbd_handle;
+
+	/* The index of the connection in the connection sockets
+	 */
+	int connection_index;
+
+	/* The socket
+	 */
+	int socket;
+
+	/* Value to indicate the client does not expect the zero padding
+	 */
+	uint8_t no_zeroes;
+
+	/* Value to indicate structured replies were negotiated
+	 */
+	uint8_t use_structured_replies;
+
+	/* Value to indicate the allocation metadata context was negotiated
+	 */
+	uint8_t use_block_status;
+
+	/* The data buffer
+	 */
+	uint8_t *buffer;
+
+	/* The data buffer size
+	 */
+	size_t buffer_size;
+};
+
+/* Creates a NBD handle
+ * Make sure the value nbd_handle is referencing, is set to NULL
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_initialize(
+     nbd_handle_t **nbd_handle,
+     mount_handle_t *mount_handle,
+     int maximum_number_of_connections,
+     libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_initialize";
+	int connection_index  = 0;
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *nbd_handle != NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid NBD handle value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid mount handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( maximum_number_of_connections <= 0 )
+	 || ( maximum_number_of_connections > 1024 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid maximum number of connections value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	*nbd_handle = memory_allocate_structure(
+	               nbd_handle_t );
+
+	if( *nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create NBD handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     *nbd_handle,
+	     0,
+	     sizeof( nbd_handle_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear NBD handle.",
+		 function );
+
+		memory_free(
+		 *nbd_handle );
+
+		*nbd_handle = NULL;
+
+		return( -1 );
+	}
+	( *nbd_handle )->connection_sockets = (int *) memory_allocate(
+	                                               sizeof( int ) * maximum_number_of_connections );
+
+	if( ( *nbd_handle )->connection_sockets == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create connection sockets.",
+		 function );
+
+		goto on_error;
+	}
+	for( connection_index = 0;
+	     connection_index < maximum_number_of_connections;
+	     connection_index++ )
+	{
+		( *nbd_handle )->connection_sockets[ connection_index ] = -1;
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_initialize(
+	     &( ( *nbd_handle )->connection_sockets_mutex ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize connection sockets mutex.",
+		 function );
+
+		goto on_error;
+	}
+#endif
+	( *nbd_handle )->mount_handle                  = mount_handle;
+	( *nbd_handle )->listen_socket                 = -1;
+	( *nbd_handle )->maximum_number_of_connections = maximum_number_of_connections;
+
+	return( 1 );
+
+on_error:
+	if( *nbd_handle != NULL )
+	{
+		if( ( *nbd_handle )->connection_sockets != NULL )
+		{
+			memory_free(
+			 ( *nbd_handle )->connection_sockets );
+		}
+		memory_free(
+		 *nbd_handle );
+
+		*nbd_handle = NULL;
+	}
+	return( -1 );
+}
+
+/* Frees a NBD handle
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_free(
+     nbd_handle_t **nbd_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_free";
+	int result            = 1;
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( *nbd_handle != NULL )
+	{
+		/* The mount_handle reference is freed elsewhere
+		 */
+		if( ( *nbd_handle )->listen_socket != -1 )
+		{
+			close(
+			 ( *nbd_handle )->listen_socket );
+		}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( ( *nbd_handle )->connection_thread_pool != NULL )
+		{
+			if( libcthreads_thread_pool_join(
+			     &( ( *nbd_handle )->connection_thread_pool ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to join connection thread pool.",
+				 function );
+
+				result = -1;
+			}
+		}
+		if( libcthreads_mutex_free(
+		     &( ( *nbd_handle )->connection_sockets_mutex ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free connection sockets mutex.",
+			 function );
+
+			result = -1;
+		}
+#endif
+		memory_free(
+		 ( *nbd_handle )->connection_sockets );
+
+		memory_free(
+		 *nbd_handle );
+
+		*nbd_handle = NULL;
+	}
+	return( result );
+}
+
+/* Signals the NBD handle to abort
+ * The listen socket and the connection sockets are shut down, which
+ * interrupts a blocking accept, receive or send
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_signal_abort(
+     nbd_handle_t *nbd_handle,
+     libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_signal_abort";
+	int connection_index  = 0;
+	int connection_socket = 0;
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	nbd_handle->abort = 1;
+
+	/* This function is called from a signal handler, hence the connection
+	 * sockets mutex is not grabbed and the return values of shutdown are ignored
+	 */
+	if( nbd_handle->listen_socket != -1 )
+	{
+		shutdown(
+		 nbd_handle->listen_socket,
+		 SHUT_RDWR );
+	}
+	for( connection_index = 0;
+	     connection_index < nbd_handle->maximum_number_of_connections;
+	     connection_index++ )
+	{
+		connection_socket = nbd_handle->connection_sockets[ connection_index ];
+
+		if( connection_socket != -1 )
+		{
+			shutdown(
+			 connection_socket,
+			 SHUT_RDWR );
+		}
+	}
+	return( 1 );
+}
+
+/* Sets the export name
+ * The export name is not copied and must remain available while the NBD handle is used
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_set_export_name(
+     nbd_handle_t *nbd_handle,
+     const char *export_name,
+     libcerror_error_t **error )
+{
+	static char *function     = "nbd_handle_set_export_name";
+	size_t export_name_length = 0;
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( export_name == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid export name.",
+		 function );
+
+		return( -1 );
+	}
+	export_name_length = narrow_string_length(
+	                      export_name );
+
+	/* The export name is sent in the reply to the list option
+	 */
+	if( export_name_length > ( NBD_HANDLE_MAXIMUM_OPTION_DATA_SIZE - 4 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid export name length value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	nbd_handle->export_name        = export_name;
+	nbd_handle->export_name_length = export_name_length;
+
+	return( 1 );
+}
+
+/* Creates the listen socket
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_listen(
+     nbd_handle_t *nbd_handle,
+     const char *address,
+     const char *port,
+     libcerror_error_t **error )
+{
+	struct addrinfo address_hints;
+
+	struct addrinfo *address_information = NULL;
+	struct addrinfo *address_list        = NULL;
+	static char *function                = "nbd_handle_listen";
+	int listen_socket                    = -1;
+	int option_value                     = 1;
+	int result                           = 0;
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( nbd_handle->listen_socket != -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_ALREADY_SET,
+		 "%s: invalid NBD handle - listen socket value already set.",
+		 function );
+
+		return( -1 );
+	}
+	if( port == NULL )
+	{
+		port = NBD_HANDLE_DEFAULT_PORT;
+	}
+	if( memory_set(
+	     &address_hints,
+	     0,
+	     sizeof( struct addrinfo ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear address hints.",
+		 function );
+
+		return( -1 );
+	}
+	address_hints.ai_family   = AF_UNSPEC;
+	address_hints.ai_socktype = SOCK_STREAM;
+	address_hints.ai_flags    = AI_PASSIVE;
+
+	result = getaddrinfo(
+	          address,
+	          port,
+	          &address_hints,
+	          &address_list );
+
+	if( result != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to resolve address: %s port: %s with error: %s.",
+		 function,
+		 ( address != NULL ) ? address : "",
+		 port,
+		 gai_strerror( result ) );
+
+		goto on_error;
+	}
+	for( address_information = address_list;
+	     address_information != NULL;
+	     address_information = address_information->ai_next )
+	{
+		listen_socket = socket(
+		                 address_information->ai_family,
+		                 address_information->ai_socktype,
+		                 address_information->ai_protocol );
+
+		if( listen_socket == -1 )
+		{
+			continue;
+		}
+		/* Allow the port to be reused directly after a previous instance stopped
+		 */
+		setsockopt(
+		 listen_socket,
+		 SOL_SOCKET,
+		 SO_REUSEADDR,
+		 &option_value,
+		 (socklen_t) sizeof( int ) );
+
+		if( ( bind(
+		       listen_socket,
+		       address_information->ai_addr,
+		       address_information->ai_addrlen ) == 0 )
+		 && ( listen(
+		       listen_socket,
+		       SOMAXCONN ) == 0 ) )
+		{
+			break;
+		}
+		close(
+		 listen_socket );
+
+		listen_socket = -1;
+	}
+	if( listen_socket == -1 )
+	{
+		libcerror_system_set_error(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 (uint32_t) errno,
+		 "%s: unable to listen on address: %s port: %s.",
+		 function,
+		 ( address != NULL ) ? address : "",
+		 port );
+
+		goto on_error;
+	}
+	freeaddrinfo(
+	 address_list );
+
+	nbd_handle->listen_socket = listen_socket;
+
+	return( 1 );
+
+on_error:
+	if( address_list != NULL )
+	{
+		freeaddrinfo(
+		 address_list );
+	}
+	return( -1 );
+}
+
+/* Reads data from a socket
+ * Returns 1 if successful, 0 if the connection was closed or -1 on error
+ */
+static int nbd_handle_read_data(
+            int socket_descriptor,
+            uint8_t *data,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_read_data";
+	size_t data_offset    = 0;
+	ssize_t read_count    = 0;
+
+	while( data_offset < data_size )
+	{
+		read_count = recv(
+		              socket_descriptor,
+		              &( data[ data_offset ] ),
+		              data_size - data_offset,
+		              0 );
+
+		if( read_count == 0 )
+		{
+			return( 0 );
+		}
+		else if( read_count < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to receive data.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += (size_t) read_count;
+	}
+	return( 1 );
+}
+
+/* Writes data to a socket
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_write_data(
+            int socket_descriptor,
+            const uint8_t *data,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_write_data";
+	size_t data_offset    = 0;
+	ssize_t write_count   = 0;
+
+	while( data_offset < data_size )
+	{
+		write_count = send(
+		               socket_descriptor,
+		               &( data[ data_offset ] ),
+		               data_size - data_offset,
+		               NBD_HANDLE_SEND_FLAGS );
+
+		if( write_count < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to send data.",
+			 function );
+
+			return( -1 );
+		}
+		data_offset += (size_t) write_count;
+	}
+	return( 1 );
+}
+
+/* Discards data received from a socket
+ * Returns 1 if successful, 0 if the connection was closed or -1 on error
+ */
+static int nbd_handle_discard_data(
+            int socket_descriptor,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	uint8_t data[ 4096 ];
+
+	static char *function = "nbd_handle_discard_data";
+	size_t read_size      = 0;
+	int result            = 0;
+
+	while( data_size > 0 )
+	{
+		read_size = data_size;
+
+		if( read_size > sizeof( data ) )
+		{
+			read_size = sizeof( data );
+		}
+		result = nbd_handle_read_data(
+		          socket_descriptor,
+		          data,
+		          read_size,
+		          error );
+
+		if( result != 1 )
+		{
+			if( result == -1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read data.",
+				 function );
+			}
+			return( result );
+		}
+		data_size -= read_size;
+	}
+	return( 1 );
+}
+
+/* Resizes the data buffer of a connection
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_resize_buffer(
+            nbd_handle_connection_t *connection,
+            size_t buffer_size,
+            libcerror_error_t **error )
+{
+	static char *function = "nbd_handle_connection_resize_buffer";
+	void *reallocation    = NULL;
+
+	if( connection == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid connection.",
+		 function );
+
+		return( -1 );
+	}
+	if( buffer_size <= connection->buffer_size )
+	{
+		return( 1 );
+	}
+	reallocation = memory_reallocate(
+	                connection->buffer,
+	                sizeof( uint8_t ) * buffer_size );
+
+	if( reallocation == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to resize buffer.",
+		 function );
+
+		return( -1 );
+	}
+	connection->buffer      = (uint8_t *) reallocation;
+	connection->buffer_size = buffer_size;
+
+	return( 1 );
+}
+
+/* Sends an option reply
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_send_option_reply(
+            nbd_handle_connection_t *connection,
+            uint32_t option,
+            uint32_t reply_type,
+            const uint8_t *data,
+            uint32_t data_size,
+            libcerror_error_t **error )
+{
+	uint8_t reply_header[ 20 ];
+
+	static char *function = "nbd_handle_connection_send_option_reply";
+
+	byte_stream_copy_from_uint64_big_endian(
+	 &( reply_header[ 0 ] ),
+	 NBD_MAGIC_OPTION_REPLY );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 8 ] ),
+	 option );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 12 ] ),
+	 reply_type );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 16 ] ),
+	 data_size );
+
+	if( nbd_handle_write_data(
+	     connection->socket,
+	     reply_header,
+	     20,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write option reply header.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > 0 )
+	{
+		if( nbd_handle_write_data(
+		     connection->socket,
+		     data,
+		     (size_t) data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write option reply data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Determines the transmission flags of a connection
+ */
+static uint16_t nbd_handle_connection_get_transmission_flags(
+                 nbd_handle_connection_t *connection )
+{
+	uint16_t transmission_flags = NBD_FLAG_HAS_FLAGS | NBD_FLAG_READ_ONLY | NBD_FLAG_CAN_MULTI_CONN;
+
+	/* The DF command flag is only defined for structured replies
+	 */
+	if( connection->use_structured_replies != 0 )
+	{
+		transmission_flags |= NBD_FLAG_SEND_DF;
+	}
+	return( transmission_flags );
+}
+
+/* Determines if an export name matches the export
+ * An empty export name refers to the default export
+ * Returns 1 if the export name matches or 0 if not
+ */
+static int nbd_handle_connection_export_name_matches(
+            nbd_handle_connection_t *connection,
+            const uint8_t *export_name,
+            uint32_t export_name_length )
+{
+	if( export_name_length == 0 )
+	{
+		return( 1 );
+	}
+	if( connection->nbd_handle->export_name == NULL )
+	{
+		return( 0 );
+	}
+	if( (size_t) export_name_length != connection->nbd_handle->export_name_length )
+	{
+		return( 0 );
+	}
+	if( memory_compare(
+	     export_name,
+	     connection->nbd_handle->export_name,
+	     (size_t) export_name_length ) != 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Handles the info and go options
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_handle_info_option(
+            nbd_handle_connection_t *connection,
+            uint32_t option,
+            const uint8_t *option_data,
+            uint32_t option_data_size,
+            uint8_t *is_accepted,
+            libcerror_error_t **error )
+{
+	uint8_t info_data[ 14 ];
+
+	static char *function            = "nbd_handle_connection_handle_info_option";
+	uint32_t export_name_length      = 0;
+	uint32_t reply_type              = NBD_REP_ACK;
+	uint16_t information_request     = 0;
+	uint16_t number_of_info_requests = 0;
+	uint16_t request_index           = 0;
+	uint8_t send_block_size          = 0;
+
+	*is_accepted = 0;
+
+	if( option_data_size < 6 )
+	{
+		reply_type = NBD_REP_ERR_INVALID;
+	}
+	else
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 option_data,
+		 export_name_length );
+
+		if( export_name_length > ( option_data_size - 6 ) )
+		{
+			reply_type = NBD_REP_ERR_INVALID;
+		}
+		else
+		{
+			byte_stream_copy_to_uint16_big_endian(
+			 &( option_data[ 4 + export_name_length ] ),
+			 number_of_info_requests );
+
+			if( ( 6 + export_name_length + ( 2 * (uint32_t) number_of_info_requests ) ) != option_data_size )
+			{
+				reply_type = NBD_REP_ERR_INVALID;
+			}
+			else if( nbd_handle_connection_export_name_matches(
+			          connection,
+			          &( option_data[ 4 ] ),
+			          export_name_length ) == 0 )
+			{
+				reply_type = NBD_REP_ERR_UNKNOWN;
+			}
+		}
+	}
+	if( reply_type != NBD_REP_ACK )
+	{
+		if( nbd_handle_connection_send_option_reply(
+		     connection,
+		     option,
+		     reply_type,
+		     NULL,
+		     0,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write option error reply.",
+			 function );
+
+			return( -1 );
+		}
+		return( 1 );
+	}
+	for( request_index = 0;
+	     request_index < number_of_info_requests;
+	     request_index++ )
+	{
+		byte_stream_copy_to_uint16_big_endian(
+		 &( option_data[ 6 + export_name_length + ( 2 * request_index ) ] ),
+		 information_request );
+
+		if( information_request == NBD_INFO_BLOCK_SIZE )
+		{
+			send_block_size = 1;
+		}
+	}
+	byte_stream_copy_from_uint16_big_endian(
+	 &( info_data[ 0 ] ),
+	 NBD_INFO_EXPORT );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 &( info_data[ 2 ] ),
+	 connection->nbd_handle->media_size );
+
+	byte_stream_copy_from_uint16_big_endian(
+	 &( info_data[ 10 ] ),
+	 nbd_handle_connection_get_transmission_flags(
+	  connection ) );
+
+	if( nbd_handle_connection_send_option_reply(
+	     connection,
+	     option,
+	     NBD_REP_INFO,
+	     info_data,
+	     12,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write export information reply.",
+		 function );
+
+		return( -1 );
+	}
+	if( send_block_size != 0 )
+	{
+		byte_stream_copy_from_uint16_big_endian(
+		 &( info_data[ 0 ] ),
+		 NBD_INFO_BLOCK_SIZE );
+
+		/* The minimum block size
+		 */
+		byte_stream_copy_from_uint32_big_endian(
+		 &( info_data[ 2 ] ),
+		 1 );
+
+		/* The preferred block size
+		 */
+		byte_stream_copy_from_uint32_big_endian(
+		 &( info_data[ 6 ] ),
+		 4096 );
+
+		/* The maximum block size
+		 */
+		byte_stream_copy_from_uint32_big_endian(
+		 &( info_data[ 10 ] ),
+		 NBD_HANDLE_MAXIMUM_READ_SIZE );
+
+		if( nbd_handle_connection_send_option_reply(
+		     connection,
+		     option,
+		     NBD_REP_INFO,
+		     info_data,
+		     14,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write block size information reply.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( nbd_handle_connection_send_option_reply(
+	     connection,
+	     option,
+	     NBD_REP_ACK,
+	     NULL,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write acknowledge reply.",
+		 function );
+
+		return( -1 );
+	}
+	if( option == NBD_OPT_GO )
+	{
+		*is_accepted = 1;
+	}
+	return( 1 );
+}
+
+/* Handles the list and set meta context options
+ * Only the base:allocation metadata context is supported
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_handle_meta_context_option(
+            nbd_handle_connection_t *connection,
+            uint32_t option,
+            const uint8_t *option_data,
+            uint32_t option_data_size,
+            libcerror_error_t **error )
+{
+	uint8_t context_data[ 4 + sizeof( NBD_META_CONTEXT_BASE_ALLOCATION ) ];
+
+	static char *function         = "nbd_handle_connection_handle_meta_context_option";
+	size_t context_name_length    = 0;
+	uint32_t data_offset          = 0;
+	uint32_t export_name_length   = 0;
+	uint32_t number_of_queries    = 0;
+	uint32_t query_index          = 0;
+	uint32_t query_length         = 0;
+	uint32_t reply_type           = NBD_REP_ACK;
+	uint8_t is_match              = 0;
+	uint8_t send_context          = 0;
+
+	context_name_length = sizeof( NBD_META_CONTEXT_BASE_ALLOCATION ) - 1;
+
+	if( ( option == NBD_OPT_SET_META_CONTEXT )
+	 && ( connection->use_structured_replies == 0 ) )
+	{
+		reply_type = NBD_REP_ERR_INVALID;
+	}
+	else if( option_data_size < 8 )
+	{
+		reply_type = NBD_REP_ERR_INVALID;
+	}
+	else
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 option_data,
+		 export_name_length );
+
+		if( export_name_length > ( option_data_size - 8 ) )
+		{
+			reply_type = NBD_REP_ERR_INVALID;
+		}
+		else if( nbd_handle_connection_export_name_matches(
+		          connection,
+		          &( option_data[ 4 ] ),
+		          export_name_length ) == 0 )
+		{
+			reply_type = NBD_REP_ERR_UNKNOWN;
+		}
+		else
+		{
+			data_offset = 4 + export_name_length;
+
+			byte_stream_copy_to_uint32_big_endian(
+			 &( option_data[ data_offset ] ),
+			 number_of_queries );
+
+			data_offset += 4;
+
+			/* Listing without queries returns all the supported metadata contexts
+			 */
+			if( ( option == NBD_OPT_LIST_META_CONTEXT )
+			 && ( number_of_queries == 0 ) )
+			{
+				send_context = 1;
+			}
+			for( query_index = 0;
+			     query_index < number_of_queries;
+			     query_index++ )
+			{
+				if( ( option_data_size - data_offset ) < 4 )
+				{
+					reply_type = NBD_REP_ERR_INVALID;
+
+					break;
+				}
+				byte_stream_copy_to_uint32_big_endian(
+				 &( option_data[ data_offset ] ),
+				 query_length );
+
+				data_offset += 4;
+
+				if( query_length > ( option_data_size - data_offset ) )
+				{
+					reply_type = NBD_REP_ERR_INVALID;
+
+					break;
+				}
+				is_match = 0;
+
+				if( ( (size_t) query_length == context_name_length )
+				 && ( memory_compare(
+				       &( option_data[ data_offset ] ),
+				       NBD_META_CONTEXT_BASE_ALLOCATION,
+				       context_name_length ) == 0 ) )
+				{
+					is_match = 1;
+				}
+				/* Listing the "base:" namespace returns all its metadata contexts
+				 */
+				else if( ( option == NBD_OPT_LIST_META_CONTEXT )
+				      && ( query_length == 5 )
+				      && ( memory_compare(
+				            &( option_data[ data_offset ] ),
+				            "base:",
+				            5 ) == 0 ) )
+				{
+					is_match = 1;
+				}
+				if( is_match != 0 )
+				{
+					send_context = 1;
+				}
+				data_offset += query_length;
+			}
+			if( ( reply_type == NBD_REP_ACK )
+			 && ( data_offset != option_data_size ) )
+			{
+				reply_type = NBD_REP_ERR_INVALID;
+			}
+		}
+	}
+	if( reply_type != NBD_REP_ACK )
+	{
+		if( nbd_handle_connection_send_option_reply(
+		     connection,
+		     option,
+		     reply_type,
+		     NULL,
+		     0,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write option error reply.",
+			 function );
+
+			return( -1 );
+		}
+		return( 1 );
+	}
+	if( option == NBD_OPT_SET_META_CONTEXT )
+	{
+		connection->use_block_status = send_context;
+	}
+	if( send_context != 0 )
+	{
+		byte_stream_copy_from_uint32_big_endian(
+		 context_data,
+		 NBD_META_CONTEXT_BASE_ALLOCATION_ID );
+
+		if( memory_copy(
+		     &( context_data[ 4 ] ),
+		     NBD_META_CONTEXT_BASE_ALLOCATION,
+		     context_name_length ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy metadata context name.",
+			 function );
+
+			return( -1 );
+		}
+		if( nbd_handle_connection_send_option_reply(
+		     connection,
+		     option,
+		     NBD_REP_META_CONTEXT,
+		     context_data,
+		     (uint32_t) ( 4 + context_name_length ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write metadata context reply.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( nbd_handle_connection_send_option_reply(
+	     connection,
+	     option,
+	     NBD_REP_ACK,
+	     NULL,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write acknowledge reply.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Negotiates the options of a connection using the fixed newstyle handshake
+ * Returns 1 if the transmission phase was entered, 0 if the connection was closed or -1 on error
+ */
+static int nbd_handle_connection_negotiate(
+            nbd_handle_connection_t *connection,
+            libcerror_error_t **error )
+{
+	uint8_t option_header[ 16 ];
+	uint8_t export_data[ 10 + 124 ];
+
+	uint8_t *option_data      = NULL;
+	static char *function     = "nbd_handle_connection_negotiate";
+	uint64_t magic            = 0;
+	uint32_t client_flags     = 0;
+	uint32_t option           = 0;
+	uint32_t option_data_size = 0;
+	uint8_t is_accepted       = 0;
+	int result                = 0;
+
+	if( connection == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid connection.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_from_uint64_big_endian(
+	 &( option_header[ 0 ] ),
+	 NBD_MAGIC_INIT_PASSWORD );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 &( option_header[ 8 ] ),
+	 NBD_MAGIC_OPTION );
+
+	if( nbd_handle_write_data(
+	     connection->socket,
+	     option_header,
+	     16,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write handshake.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_from_uint16_big_endian(
+	 option_header,
+	 NBD_FLAG_FIXED_NEWSTYLE | NBD_FLAG_NO_ZEROES );
+
+	if( nbd_handle_write_data(
+	     connection->socket,
+	     option_header,
+	     2,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write handshake flags.",
+		 function );
+
+		goto on_error;
+	}
+	result = nbd_handle_read_data(
+	          connection->socket,
+	          option_header,
+	          4,
+	          error );
+
+	if( result != 1 )
+	{
+		goto on_read_error;
+	}
+	byte_stream_copy_to_uint32_big_endian(
+	 option_header,
+	 client_flags );
+
+	if( ( client_flags & ~( NBD_FLAG_C_FIXED_NEWSTYLE | NBD_FLAG_C_NO_ZEROES ) ) != 0 )
+	{
+		libcnotify_printf(
+		 "%s: unsupported client flags: 0x%08" PRIx32 ".\n",
+		 function,
+		 client_flags );
+
+		return( 0 );
+	}
+	if( ( client_flags & NBD_FLAG_C_NO_ZEROES ) != 0 )
+	{
+		connection->no_zeroes = 1;
+	}
+	option_data = (uint8_t *) memory_allocate(
+	                           sizeof( uint8_t ) * NBD_HANDLE_MAXIMUM_OPTION_DATA_SIZE );
+
+	if( option_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create option data.",
+		 function );
+
+		goto on_error;
+	}
+	while( connection->nbd_handle->abort == 0 )
+	{
+		result = nbd_handle_read_data(
+		          connection->socket,
+		          option_header,
+		          16,
+		          error );
+
+		if( result != 1 )
+		{
+			goto on_read_error;
+		}
+		byte_stream_copy_to_uint64_big_endian(
+		 &( option_header[ 0 ] ),
+		 magic );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 &( option_header[ 8 ] ),
+		 option );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 &( option_header[ 12 ] ),
+		 option_data_size );
+
+		if( magic != NBD_MAGIC_OPTION )
+		{
+			libcnotify_printf(
+			 "%s: invalid option magic.\n",
+			 function );
+
+			break;
+		}
+		if( option_data_size > NBD_HANDLE_MAXIMUM_OPTION_DATA_SIZE )
+		{
+			libcnotify_printf(
+			 "%s: option data size: %" PRIu32 " exceeds maximum.\n",
+			 function,
+			 option_data_size );
+
+			break;
+		}
+		if( option_data_size > 0 )
+		{
+			result = nbd_handle_read_data(
+			          connection->socket,
+			          option_data,
+			          (size_t) option_data_size,
+			          error );
+
+			if( result != 1 )
+			{
+				goto on_read_error;
+			}
+		}
+		switch( option )
+		{
+			case NBD_OPT_EXPORT_NAME:
+				/* There is no error reply for the export name option
+				 * hence the connection is closed if the name does not match
+				 */
+				if( nbd_handle_connection_export_name_matches(
+				     connection,
+				     option_data,
+				     option_data_size ) == 0 )
+				{
+					libcnotify_printf(
+					 "%s: unknown export name.\n",
+					 function );
+
+					goto on_close;
+				}
+				if( memory_set(
+				     export_data,
+				     0,
+				     10 + 124 ) == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+					 "%s: unable to clear export data.",
+					 function );
+
+					goto on_error;
+				}
+				byte_stream_copy_from_uint64_big_endian(
+				 &( export_data[ 0 ] ),
+				 connection->nbd_handle->media_size );
+
+				byte_stream_copy_from_uint16_big_endian(
+				 &( export_data[ 8 ] ),
+				 nbd_handle_connection_get_transmission_flags(
+				  connection ) );
+
+				if( nbd_handle_write_data(
+				     connection->socket,
+				     export_data,
+				     ( connection->no_zeroes != 0 ) ? 10 : 10 + 124,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_IO,
+					 LIBCERROR_IO_ERROR_WRITE_FAILED,
+					 "%s: unable to write export data.",
+					 function );
+
+					goto on_error;
+				}
+				is_accepted = 1;
+
+				break;
+
+			case NBD_OPT_ABORT:
+				/* The reply to the abort option is optional
+				 * hence errors are ignored
+				 */
+				nbd_handle_connection_send_option_reply(
+				 connection,
+				 option,
+				 NBD_REP_ACK,
+				 NULL,
+				 0,
+				 NULL );
+
+				goto on_close;
+
+			case NBD_OPT_LIST:
+				if( option_data_size != 0 )
+				{
+					result = nbd_handle_connection_send_option_reply(
+					          connection,
+					          option,
+					          NBD_REP_ERR_INVALID,
+					          NULL,
+					          0,
+					          error );
+				}
+				else
+				{
+					byte_stream_copy_from_uint32_big_endian(
+					 option_data,
+					 (uint32_t) connection->nbd_handle->export_name_length );
+
+					if( connection->nbd_handle->export_name_length > 0 )
+					{
+						if( memory_copy(
+						     &( option_data[ 4 ] ),
+						     connection->nbd_handle->export_name,
+						     connection->nbd_handle->export_name_length ) == NULL )
+						{
+							libcerror_error_set(
+							 error,
+							 LIBCERROR_ERROR_DOMAIN_MEMORY,
+							 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+							 "%s: unable to copy export name.",
+							 function );
+
+							goto on_error;
+						}
+					}
+					result = nbd_handle_connection_send_option_reply(
+					          connection,
+					          option,
+					          NBD_REP_SERVER,
+					          option_data,
+					          (uint32_t) ( 4 + connection->nbd_handle->export_name_length ),
+					          error );
+
+					if( result == 1 )
+					{
+						result = nbd_handle_connection_send_option_reply(
+						          connection,
+						          option,
+						          NBD_REP_ACK,
+						          NULL,
+						          0,
+						          error );
+					}
+				}
+				break;
+
+			case NBD_OPT_INFO:
+			case NBD_OPT_GO:
+				result = nbd_handle_connection_handle_info_option(
+				          connection,
+				          option,
+				          option_data,
+				          option_data_size,
+				          &is_accepted,
+				          error );
+				break;
+
+			case NBD_OPT_STRUCTURED_REPLY:
+				if( option_data_size != 0 )
+				{
+					result = nbd_handle_connection_send_option_reply(
+					          connection,
+					          option,
+					          NBD_REP_ERR_INVALID,
+					          NULL,
+					          0,
+					          error );
+				}
+				else
+				{
+					connection->use_structured_replies = 1;
+
+					result = nbd_handle_connection_send_option_reply(
+					          connection,
+					          option,
+					          NBD_REP_ACK,
+					          NULL,
+					          0,
+					          error );
+				}
+				break;
+
+			case NBD_OPT_LIST_META_CONTEXT:
+			case NBD_OPT_SET_META_CONTEXT:
+				result = nbd_handle_connection_handle_meta_context_option(
+				          connection,
+				          option,
+				          option_data,
+				          option_data_size,
+				          error );
+				break;
+
+			default:
+				result = nbd_handle_connection_send_option_reply(
+				          connection,
+				          option,
+				          NBD_REP_ERR_UNSUP,
+				          NULL,
+				          0,
+				          error );
+				break;
+		}
+		if( is_accepted != 0 )
+		{
+			break;
+		}
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to handle option: %" PRIu32 ".",
+			 function,
+			 option );
+
+			goto on_error;
+		}
+	}
+	memory_free(
+	 option_data );
+
+	if( is_accepted == 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+
+on_read_error:
+	if( result == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read handshake data.",
+		 function );
+
+		goto on_error;
+	}
+on_close:
+	if( option_data != NULL )
+	{
+		memory_free(
+		 option_data );
+	}
+	return( 0 );
+
+on_error:
+	if( option_data != NULL )
+	{
+		memory_free(
+		 option_data );
+	}
+	return( -1 );
+}
+
+/* Sends a simple reply
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_send_simple_reply(
+            nbd_handle_connection_t *connection,
+            uint32_t error_value,
+            uint64_t cookie,
+            const uint8_t *data,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	uint8_t reply_header[ 16 ];
+
+	static char *function = "nbd_handle_connection_send_simple_reply";
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 0 ] ),
+	 NBD_MAGIC_SIMPLE_REPLY );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 4 ] ),
+	 error_value );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 &( reply_header[ 8 ] ),
+	 cookie );
+
+	if( nbd_handle_write_data(
+	     connection->socket,
+	     reply_header,
+	     16,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reply header.",
+		 function );
+
+		return( -1 );
+	}
+	if( data_size > 0 )
+	{
+		if( nbd_handle_write_data(
+		     connection->socket,
+		     data,
+		     data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write reply data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Sends a structured reply chunk
+ * The chunk data consists of an optional header, such as the offset, and the payload
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_send_structured_reply(
+            nbd_handle_connection_t *connection,
+            uint16_t reply_flags,
+            uint16_t reply_type,
+            uint64_t cookie,
+            const uint8_t *chunk_header,
+            size_t chunk_header_size,
+            const uint8_t *data,
+            size_t data_size,
+            libcerror_error_t **error )
+{
+	uint8_t reply_header[ 20 ];
+
+	static char *function = "nbd_handle_connection_send_structured_reply";
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 0 ] ),
+	 NBD_MAGIC_STRUCTURED_REPLY );
+
+	byte_stream_copy_from_uint16_big_endian(
+	 &( reply_header[ 4 ] ),
+	 reply_flags );
+
+	byte_stream_copy_from_uint16_big_endian(
+	 &( reply_header[ 6 ] ),
+	 reply_type );
+
+	byte_stream_copy_from_uint64_big_endian(
+	 &( reply_header[ 8 ] ),
+	 cookie );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( reply_header[ 16 ] ),
+	 (uint32_t) ( chunk_header_size + data_size ) );
+
+	if( nbd_handle_write_data(
+	     connection->socket,
+	     reply_header,
+	     20,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reply header.",
+		 function );
+
+		return( -1 );
+	}
+	if( chunk_header_size > 0 )
+	{
+		if( nbd_handle_write_data(
+		     connection->socket,
+		     chunk_header,
+		     chunk_header_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write chunk header.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	if( data_size > 0 )
+	{
+		if( nbd_handle_write_data(
+		     connection->socket,
+		     data,
+		     data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write chunk data.",
+			 function );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Sends an error reply
+ * Read and block status requests use a structured error chunk if structured replies were negotiated
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_send_error_reply(
+            nbd_handle_connection_t *connection,
+            uint16_t command,
+            uint64_t cookie,
+            uint32_t error_value,
+            libcerror_error_t **error )
+{
+	uint8_t error_data[ 6 ];
+
+	static char *function = "nbd_handle_connection_send_error_reply";
+	int result            = 0;
+
+	if( ( connection->use_structured_replies != 0 )
+	 && ( ( command == NBD_CMD_READ )
+	  ||  ( command == NBD_CMD_BLOCK_STATUS ) ) )
+	{
+		byte_stream_copy_from_uint32_big_endian(
+		 &( error_data[ 0 ] ),
+		 error_value );
+
+		/* The size of the error message
+		 */
+		byte_stream_copy_from_uint16_big_endian(
+		 &( error_data[ 4 ] ),
+		 0 );
+
+		result = nbd_handle_connection_send_structured_reply(
+		          connection,
+		          NBD_REPLY_FLAG_DONE,
+		          NBD_REPLY_TYPE_ERROR,
+		          cookie,
+		          error_data,
+		          6,
+		          NULL,
+		          0,
+		          error );
+	}
+	else
+	{
+		result = nbd_handle_connection_send_simple_reply(
+		          connection,
+		          error_value,
+		          cookie,
+		          NULL,
+		          0,
+		          error );
+	}
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write error reply.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Handles a read request
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_handle_read(
+            nbd_handle_connection_t *connection,
+            uint16_t command_flags,
+            uint64_t cookie,
+            off64_t offset,
+            size_t size,
+            libcerror_error_t **error )
+{
+	uint8_t chunk_header[ 12 ];
+
+	libcerror_error_t *read_error = NULL;
+	static char *function         = "nbd_handle_connection_handle_read";
+	size64_t range_size           = 0;
+	size_t data_offset            = 0;
+	ssize_t read_count            = 0;
+	uint8_t is_hole               = 0;
+
+	if( nbd_handle_connection_resize_buffer(
+	     connection,
+	     size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_RESIZE_FAILED,
+		 "%s: unable to resize buffer.",
+		 function );
+
+		return( -1 );
+	}
+	/* Without structured replies, or if the data must not be fragmented,
+	 * the data is sent as a single reply
+	 */
+	if( ( connection->use_structured_replies == 0 )
+	 || ( ( command_flags & NBD_CMD_FLAG_DF ) != 0 ) )
+	{
+		read_count = mount_handle_read_buffer_at_offset(
+		              connection->nbd_handle->mount_handle,
+		              0,
+		              connection->buffer,
+		              size,
+		              offset,
+		              &read_error );
+
+		if( read_count != (ssize_t) size )
+		{
+			libcnotify_print_error_backtrace(
+			 read_error );
+			libcerror_error_free(
+			 &read_error );
+
+			return( nbd_handle_connection_send_error_reply(
+			         connection,
+			         NBD_CMD_READ,
+			         cookie,
+			         NBD_EIO,
+			         error ) );
+		}
+		if( connection->use_structured_replies == 0 )
+		{
+			return( nbd_handle_connection_send_simple_reply(
+			         connection,
+			         0,
+			         cookie,
+			         connection->buffer,
+			         size,
+			         error ) );
+		}
+		byte_stream_copy_from_uint64_big_endian(
+		 chunk_header,
+		 (uint64_t) offset );
+
+		return( nbd_handle_connection_send_structured_reply(
+		         connection,
+		         NBD_REPLY_FLAG_DONE,
+		         NBD_REPLY_TYPE_OFFSET_DATA,
+		         cookie,
+		         chunk_header,
+		         8,
+		         connection->buffer,
+		         size,
+		         error ) );
+	}
+	/* With structured replies holes are sent without data
+	 */
+	while( data_offset < size )
+	{
+		if( mount_handle_get_range_at_offset(
+		     connection->nbd_handle->mount_handle,
+		     0,
+		     offset + (off64_t) data_offset,
+		     (size64_t) ( size - data_offset ),
+		     &range_size,
+		     &is_hole,
+		     &read_error ) != 1 )
+		{
+			libcnotify_print_error_backtrace(
+			 read_error );
+			libcerror_error_free(
+			 &read_error );
+
+			range_size = 0;
+		}
+		if( range_size == 0 )
+		{
+			return( nbd_handle_connection_send_error_reply(
+			         connection,
+			         NBD_CMD_READ,
+			         cookie,
+			         NBD_EIO,
+			         error ) );
+		}
+		byte_stream_copy_from_uint64_big_endian(
+		 chunk_header,
+		 (uint64_t) ( offset + (off64_t) data_offset ) );
+
+		if( is_hole != 0 )
+		{
+			byte_stream_copy_from_uint32_big_endian(
+			 &( chunk_header[ 8 ] ),
+			 (uint32_t) range_size );
+
+			if( nbd_handle_connection_send_structured_reply(
+			     connection,
+			     0,
+			     NBD_REPLY_TYPE_OFFSET_HOLE,
+			     cookie,
+			     chunk_header,
+			     12,
+			     NULL,
+			     0,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write hole chunk.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		else
+		{
+			read_count = mount_handle_read_buffer_at_offset(
+			              connection->nbd_handle->mount_handle,
+			              0,
+			              connection->buffer,
+			              (size_t) range_size,
+			              offset + (off64_t) data_offset,
+			              &read_error );
+
+			if( read_count != (ssize_t) range_size )
+			{
+				libcnotify_print_error_backtrace(
+				 read_error );
+				libcerror_error_free(
+				 &read_error );
+
+				return( nbd_handle_connection_send_error_reply(
+				         connection,
+				         NBD_CMD_READ,
+				         cookie,
+				         NBD_EIO,
+				         error ) );
+			}
+			if( nbd_handle_connection_send_structured_reply(
+			     connection,
+			     0,
+			     NBD_REPLY_TYPE_OFFSET_DATA,
+			     cookie,
+			     chunk_header,
+			     8,
+			     connection->buffer,
+			     (size_t) range_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write data chunk.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		data_offset += (size_t) range_size;
+	}
+	return( nbd_handle_connection_send_structured_reply(
+	         connection,
+	         NBD_REPLY_FLAG_DONE,
+	         NBD_REPLY_TYPE_NONE,
+	         cookie,
+	         NULL,
+	         0,
+	         NULL,
+	         0,
+	         error ) );
+}
+
+/* Handles a block status request
+ * The status of the base:allocation metadata context is determined from the extents of the input file
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_handle_block_status(
+            nbd_handle_connection_t *connection,
+            uint16_t command_flags,
+            uint64_t cookie,
+            off64_t offset,
+            size_t size,
+            libcerror_error_t **error )
+{
+	libcerror_error_t *status_error   = NULL;
+	static char *function             = "nbd_handle_connection_handle_block_status";
+	size64_t range_size               = 0;
+	size_t data_offset                = 0;
+	size_t status_data_size           = 0;
+	uint32_t status_flags             = 0;
+	int maximum_number_of_descriptors = NBD_HANDLE_MAXIMUM_NUMBER_OF_DESCRIPTORS;
+	int number_of_descriptors         = 0;
+	uint8_t is_hole                   = 0;
+
+	if( connection->use_block_status == 0 )
+	{
+		return( nbd_handle_connection_send_error_reply(
+		         connection,
+		         NBD_CMD_BLOCK_STATUS,
+		         cookie,
+		         NBD_EINVAL,
+		         error ) );
+	}
+	if( ( command_flags & NBD_CMD_FLAG_REQ_ONE ) != 0 )
+	{
+		maximum_number_of_descriptors = 1;
+	}
+	if( nbd_handle_connection_resize_buffer(
+	     connection,
+	     4 + ( 8 * NBD_HANDLE_MAXIMUM_NUMBER_OF_DESCRIPTORS ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_RESIZE_FAILED,
+		 "%s: unable to resize buffer.",
+		 function );
+
+		return( -1 );
+	}
+	byte_stream_copy_from_uint32_big_endian(
+	 connection->buffer,
+	 NBD_META_CONTEXT_BASE_ALLOCATION_ID );
+
+	status_data_size = 4;
+
+	while( ( data_offset < size )
+	    && ( number_of_descriptors < maximum_number_of_descriptors ) )
+	{
+		if( mount_handle_get_range_at_offset(
+		     connection->nbd_handle->mount_handle,
+		     0,
+		     offset + (off64_t) data_offset,
+		     (size64_t) ( size - data_offset ),
+		     &range_size,
+		     &is_hole,
+		     &status_error ) != 1 )
+		{
+			libcnotify_print_error_backtrace(
+			 status_error );
+			libcerror_error_free(
+			 &status_error );
+
+			range_size = 0;
+		}
+		if( range_size == 0 )
+		{
+			break;
+		}
+		status_flags = 0;
+
+		if( is_hole != 0 )
+		{
+			status_flags = NBD_STATE_HOLE | NBD_STATE_ZERO;
+		}
+		byte_stream_copy_from_uint32_big_endian(
+		 &( connection->buffer[ status_data_size ] ),
+		 (uint32_t) range_size );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 &( connection->buffer[ status_data_size + 4 ] ),
+		 status_flags );
+
+		status_data_size += 8;
+		data_offset      += (size_t) range_size;
+
+		number_of_descriptors++;
+	}
+	if( number_of_descriptors == 0 )
+	{
+		return( nbd_handle_connection_send_error_reply(
+		         connection,
+		         NBD_CMD_BLOCK_STATUS,
+		         cookie,
+		         NBD_EIO,
+		         error ) );
+	}
+	return( nbd_handle_connection_send_structured_reply(
+	         connection,
+	         NBD_REPLY_FLAG_DONE,
+	         NBD_REPLY_TYPE_BLOCK_STATUS,
+	         cookie,
+	         NULL,
+	         0,
+	         connection->buffer,
+	         status_data_size,
+	         error ) );
+}
+
+/* Handles the requests of a connection in the transmission phase
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_transmit(
+            nbd_handle_connection_t *connection,
+            libcerror_error_t **error )
+{
+	uint8_t request_header[ 28 ];
+
+	static char *function  = "nbd_handle_connection_transmit";
+	uint64_t cookie        = 0;
+	uint64_t offset        = 0;
+	uint32_t error_value   = 0;
+	uint32_t magic         = 0;
+	uint32_t size          = 0;
+	uint16_t command       = 0;
+	uint16_t command_flags = 0;
+	int result             = 0;
+
+	while( connection->nbd_handle->abort == 0 )
+	{
+		result = nbd_handle_read_data(
+		          connection->socket,
+		          request_header,
+		          28,
+		          error );
+
+		if( result == 0 )
+		{
+			break;
+		}
+		else if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read request header.",
+			 function );
+
+			return( -1 );
+		}
+		byte_stream_copy_to_uint32_big_endian(
+		 &( request_header[ 0 ] ),
+		 magic );
+
+		byte_stream_copy_to_uint16_big_endian(
+		 &( request_header[ 4 ] ),
+		 command_flags );
+
+		byte_stream_copy_to_uint16_big_endian(
+		 &( request_header[ 6 ] ),
+		 command );
+
+		byte_stream_copy_to_uint64_big_endian(
+		 &( request_header[ 8 ] ),
+		 cookie );
+
+		byte_stream_copy_to_uint64_big_endian(
+		 &( request_header[ 16 ] ),
+		 offset );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 &( request_header[ 24 ] ),
+		 size );
+
+		if( magic != NBD_MAGIC_REQUEST )
+		{
+			libcnotify_printf(
+			 "%s: invalid request magic.\n",
+			 function );
+
+			break;
+		}
+		if( command == NBD_CMD_DISC )
+		{
+			break;
+		}
+		if( command == NBD_CMD_WRITE )
+		{
+			result = nbd_handle_discard_data(
+			          connection->socket,
+			          (size_t) size,
+			          error );
+
+			if( result == 0 )
+			{
+				break;
+			}
+			else if( result != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read write request data.",
+				 function );
+
+				return( -1 );
+			}
+		}
+		error_value = 0;
+
+		switch( command )
+		{
+			case NBD_CMD_READ:
+			case NBD_CMD_BLOCK_STATUS:
+				if( ( size == 0 )
+				 || ( offset > connection->nbd_handle->media_size )
+				 || ( (uint64_t) size > ( connection->nbd_handle->media_size - offset ) ) )
+				{
+					error_value = NBD_EINVAL;
+				}
+				else if( ( command == NBD_CMD_READ )
+				      && ( size > NBD_HANDLE_MAXIMUM_READ_SIZE ) )
+				{
+					error_value = NBD_EINVAL;
+				}
+				break;
+
+			case NBD_CMD_WRITE:
+			case NBD_CMD_TRIM:
+			case NBD_CMD_WRITE_ZEROES:
+				error_value = NBD_EPERM;
+				break;
+
+			case NBD_CMD_FLUSH:
+				break;
+
+			default:
+				error_value = NBD_EINVAL;
+				break;
+		}
+		if( error_value != 0 )
+		{
+			result = nbd_handle_connection_send_error_reply(
+			          connection,
+			          command,
+			          cookie,
+			          error_value,
+			          error );
+		}
+		else if( command == NBD_CMD_READ )
+		{
+			result = nbd_handle_connection_handle_read(
+			          connection,
+			          command_flags,
+			          cookie,
+			          (off64_t) offset,
+			          (size_t) size,
+			          error );
+		}
+		else if( command == NBD_CMD_BLOCK_STATUS )
+		{
+			result = nbd_handle_connection_handle_block_status(
+			          connection,
+			          command_flags,
+			          cookie,
+			          (off64_t) offset,
+			          (size_t) size,
+			          error );
+		}
+		else
+		{
+			result = nbd_handle_connection_send_simple_reply(
+			          connection,
+			          0,
+			          cookie,
+			          NULL,
+			          0,
+			          error );
+		}
+		if( result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GENERIC,
+			 "%s: unable to handle request: %" PRIu16 ".",
+			 function,
+			 command );
+
+			return( -1 );
+		}
+	}
+	return( 1 );
+}
+
+/* Serves a connection and frees it afterwards
+ * Returns 1 if successful or -1 on error
+ */
+static int nbd_handle_connection_serve(
+            nbd_handle_connection_t *connection,
+            void *arguments QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	nbd_handle_t *nbd_handle = NULL;
+	int result               = 0;
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( arguments )
+
+	if( connection == NULL )
+	{
+		return( -1 );
+	}
+	nbd_handle = connection->nbd_handle;
+
+	result = nbd_handle_connection_negotiate(
+	          connection,
+	          &error );
+
+	if( result == 1 )
+	{
+		result = nbd_handle_connection_transmit(
+		          connection,
+		          &error );
+	}
+	if( result == -1 )
+	{
+		if( nbd_handle->abort == 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+		libcerror_error_free(
+		 &error );
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     nbd_handle->connection_sockets_mutex,
+	     NULL ) == 1 )
+	{
+		nbd_handle->connection_sockets[ connection->connection_index ] = -1;
+
+		libcthreads_mutex_release(
+		 nbd_handle->connection_sockets_mutex,
+		 NULL );
+	}
+#else
+	nbd_handle->connection_sockets[ connection->connection_index ] = -1;
+#endif
+	close(
+	 connection->socket );
+
+	if( connection->buffer != NULL )
+	{
+		memory_free(
+		 connection->buffer );
+	}
+	memory_free(
+	 connection );
+
+	if( result == -1 )
+	{
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reserves an index in the connection sockets for a socket
+ * Returns 1 if successful, 0 if the maximum number of connections is reached or -1 on error
+ */
+static int nbd_handle_reserve_connection_index(
+            nbd_handle_t *nbd_handle,
+            int connection_socket,
+            int *connection_index,
+            libcerror_error_t **error )
+{
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	static char *function = "nbd_handle_reserve_connection_index";
+#endif
+	int result            = 0;
+	int socket_index      = 0;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_grab(
+	     nbd_handle->connection_sockets_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to grab connection sockets mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	for( socket_index = 0;
+	     socket_index < nbd_handle->maximum_number_of_connections;
+	     socket_index++ )
+	{
+		if( nbd_handle->connection_sockets[ socket_index ] == -1 )
+		{
+			nbd_handle->connection_sockets[ socket_index ] = connection_socket;
+
+			*connection_index = socket_index;
+
+			result = 1;
+
+			break;
+		}
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_mutex_release(
+	     nbd_handle->connection_sockets_mutex,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to release connection sockets mutex.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( result );
+}
+
+/* Accepts and serves connections until abort is signalled
+ * Connections are served concurrently by a thread pool if multi-threading is supported,
+ * all connections share the input file of the mount handle and its caches
+ * Returns 1 if successful or -1 on error
+ */
+int nbd_handle_serve(
+     nbd_handle_t *nbd_handle,
+     libcerror_error_t **error )
+{
+	nbd_handle_connection_t *connection = NULL;
+	static char *function               = "nbd_handle_serve";
+	int connection_index                = 0;
+	int connection_socket               = -1;
+	int result                          = 0;
+
+#if defined( HAVE_NETINET_TCP_H ) && defined( TCP_NODELAY )
+	int option_value                    = 1;
+#endif
+
+	if( nbd_handle == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid NBD handle.",
+		 function );
+
+		return( -1 );
+	}
+	if( nbd_handle->listen_socket == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_MISSING,
+		 "%s: invalid NBD handle - missing listen socket.",
+		 function );
+
+		return( -1 );
+	}
+	if( mount_handle_get_media_size(
+	     nbd_handle->mount_handle,
+	     0,
+	     &( nbd_handle->media_size ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		return( -1 );
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( nbd_handle->connection_thread_pool == NULL )
+	{
+		if( libcthreads_thread_pool_create(
+		     &( nbd_handle->connection_thread_pool ),
+		     NULL,
+		     nbd_handle->maximum_number_of_connections,
+		     nbd_handle->maximum_number_of_connections,
+		     (int (*)(intptr_t *, void *)) &nbd_handle_connection_serve,
+		     NULL,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to create connection thread pool.",
+			 function );
+
+			return( -1 );
+		}
+	}
+#endif
+	while( nbd_handle->abort == 0 )
+	{
+		connection_socket = accept(
+		                     nbd_handle->listen_socket,
+		                     NULL,
+		                     NULL );
+
+		if( connection_socket == -1 )
+		{
+			if( nbd_handle->abort != 0 )
+			{
+				break;
+			}
+			if( ( errno == EINTR )
+			 || ( errno == ECONNABORTED ) )
+			{
+				continue;
+			}
+			libcerror_system_set_error(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_OPEN_FAILED,
+			 (uint32_t) errno,
+			 "%s: unable to accept connection.",
+			 function );
+
+			goto on_error;
+		}
+#if defined( HAVE_NETINET_TCP_H ) && defined( TCP_NODELAY )
+		/* The replies consist of a header followed by the data,
+		 * which should not be delayed
+		 */
+		setsockopt(
+		 connection_socket,
+		 IPPROTO_TCP,
+		 TCP_NODELAY,
+		 &option_value,
+		 (socklen_t) sizeof( int ) );
+#endif
+		result = nbd_handle_reserve_connection_index(
+		          nbd_handle,
+		          connection_socket,
+		          &connection_index,
+		          error );
+
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to reserve connection index.",
+			 function );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			libcnotify_printf(
+			 "%s: maximum number of connections reached, closing connection.\n",
+			 function );
+
+			close(
+			 connection_socket );
+
+			continue;
+		}
+		connection = memory_allocate_structure(
+		              nbd_handle_connection_t );
+
+		if( connection == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create connection.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     connection,
+		     0,
+		     sizeof( nbd_handle_connection_t ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear connection.",
+			 function );
+
+			memory_free(
+			 connection );
+
+			connection = NULL;
+
+			goto on_error;
+		}
+		connection->nbd_handle       = nbd_handle;
+		connection->connection_index = connection_index;
+		connection->socket           = connection_socket;
+
+		/* The connection is freed by nbd_handle_connection_serve
+		 */
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_thread_pool_push(
+		     nbd_handle->connection_thread_pool,
+		     (intptr_t *) connection,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_APPEND_FAILED,
+			 "%s: unable to push connection onto thread pool queue.",
+			 function );
+
+			goto on_error;
+		}
+#else
+		nbd_handle_connection_serve(
+		 connection,
+		 NULL );
+#endif
+		connection        = NULL;
+		connection_socket = -1;
+	}
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	if( libcthreads_thread_pool_join(
+	     &( nbd_handle->connection_thread_pool ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to join connection thread pool.",
+		 function );
+
+		return( -1 );
+	}
+#endif
+	return( 1 );
+
+on_error:
+	if( connection != NULL )
+	{
+		memory_free(
+		 connection );
+	}
+	if( connection_socket != -1 )
+	{
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+		if( libcthreads_mutex_grab(
+		     nbd_handle->connection_sockets_mutex,
+		     NULL ) == 1 )
+		{
+			if( nbd_handle->connection_sockets[ connection_index ] == connection_socket )
+			{
+				nbd_handle->connection_sockets[ connection_index ] = -1;
+			}
+			libcthreads_mutex_release(
+			 nbd_handle->connection_sockets_mutex,
+			 NULL );
+		}
+#else
+		if( nbd_handle->connection_sockets[ connection_index ] == connection_socket )
+		{
+			nbd_handle->connection_sockets[ connection_index ] = -1;
+		}
+#endif
+		close(
+		 connection_socket );
+	}
+	return( -1 );
+}
+
+#endif /* defined( HAVE_NBD_HANDLE_SUPPORT ) */
+
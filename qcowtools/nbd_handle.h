@@ -0,0 +1,144 @@
+/*
+ * Network block device (NBD) handle
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined( _NBD_HANDLE_H )
+#define _NBD_HANDLE_H
+
+#include <common.h>
+#include <types.h>
+
+#include "mount_handle.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libcthreads.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+#if !defined( WINAPI ) && defined( HAVE_NETDB_H ) && defined( HAVE_NETINET_IN_H ) && defined( HAVE_SYS_SOCKET_H ) && defined( HAVE_UNISTD_H )
+#define HAVE_NBD_HANDLE_SUPPORT
+#endif
+
+/* The default TCP port of the NBD protocol
+ */
+#define NBD_HANDLE_DEFAULT_PORT			"10809"
+
+/* The default maximum number of connections that are served at the same time
+ */
+#define NBD_HANDLE_DEFAULT_MAXIMUM_NUMBER_OF_CONNECTIONS	8
+
+/* The maximum size of the data of a read request
+ */
+#define NBD_HANDLE_MAXIMUM_READ_SIZE		( 32 * 1024 * 1024 )
+
+/* The maximum size of the data of an option
+ */
+#define NBD_HANDLE_MAXIMUM_OPTION_DATA_SIZE	4096
+
+/* The maximum number of block status descriptors in a reply
+ */
+#define NBD_HANDLE_MAXIMUM_NUMBER_OF_DESCRIPTORS	1024
+
+typedef struct nbd_handle nbd_handle_t;
+
+struct nbd_handle
+{
+	/* The mount handle, which provides the input file
+	 * this value is not managed by the NBD handle
+	 */
+	mount_handle_t *mount_handle;
+
+	/* The export name
+	 */
+	const char *export_name;
+
+	/* The export name length
+	 */
+	size_t export_name_length;
+
+	/* The media size of the export
+	 */
+	size64_t media_size;
+
+	/* The socket on which connections are accepted
+	 * -1 if not set
+	 */
+	int listen_socket;
+
+	/* The maximum number of connections that are served at the same time
+	 */
+	int maximum_number_of_connections;
+
+	/* The sockets of the connections that are served
+	 * -1 if not set
+	 */
+	int *connection_sockets;
+
+#if defined( HAVE_QCOWTOOLS_MULTI_THREAD_SUPPORT )
+	/* The thread pool that serves the connections
+	 */
+	libcthreads_thread_pool_t *connection_thread_pool;
+
+	/* The mutex that protects the connection sockets
+	 */
+	libcthreads_mutex_t *connection_sockets_mutex;
+#endif
+
+	/* Value to indicate if abort was signalled
+	 */
+	int abort;
+};
+
+int nbd_handle_initialize(
+     nbd_handle_t **nbd_handle,
+     mount_handle_t *mount_handle,
+     int maximum_number_of_connections,
+     libcerror_error_t **error );
+
+int nbd_handle_free(
+     nbd_handle_t **nbd_handle,
+     libcerror_error_t **error );
+
+int nbd_handle_signal_abort(
+     nbd_handle_t *nbd_handle,
+     libcerror_error_t **error );
+
+int nbd_handle_set_export_name(
+     nbd_handle_t *nbd_handle,
+     const char *export_name,
+     libcerror_error_t **error );
+
+int nbd_handle_listen(
+     nbd_handle_t *nbd_handle,
+     const char *address,
+     const char *port,
+     libcerror_error_t **error );
+
+int nbd_handle_serve(
+     nbd_handle_t *nbd_handle,
+     libcerror_error_t **error );
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* !defined( _NBD_HANDLE_H ) */
+
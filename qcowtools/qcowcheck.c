@@ -0,0 +1,369 @@
+/*
+ * Checks the consistency of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "check_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_signal.h"
+#include "qcowtools_unused.h"
+
+check_handle_t *qcowcheck_check_handle = NULL;
+int qcowcheck_abort                    = 0;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcowcheck to check the consistency of the metadata of a QEMU\n"
+	                 "Copy-On-Write (QCOW) image file.\n\n" );
+
+	fprintf( stream, "Usage: qcowcheck [ -t threads ] [ -chvV ] source\n\n" );
+
+	fprintf( stream, "\tsource: the source file\n\n" );
+
+	fprintf( stream, "\t-c:     verifies that the compressed cluster blocks decompress\n" );
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-t:     the number of threads that check the level 2 tables,\n"
+	                 "\t        default is the number of worker threads of the library\n" );
+	fprintf( stream, "\t-v:     verbose output to stderr\n" );
+	fprintf( stream, "\t-V:     print version\n" );
+}
+
+/* Signal handler for qcowcheck
+ */
+void qcowcheck_signal_handler(
+      qcowtools_signal_t signal QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcowcheck_signal_handler";
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( signal )
+
+	qcowcheck_abort = 1;
+
+	if( qcowcheck_check_handle != NULL )
+	{
+		if( check_handle_signal_abort(
+		     qcowcheck_check_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal check handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error             = NULL;
+	system_character_t *option_threads = NULL;
+	system_character_t *source         = NULL;
+	char *program                      = "qcowcheck";
+	system_integer_t option            = 0;
+	int result                         = 0;
+	int verbose                        = 0;
+	int verify_compressed_data         = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+             "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+        if( qcowtools_output_initialize(
+             _IONBF,
+             &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	qcowoutput_version_fprint(
+	 stdout,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "cht:vV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'c':
+				verify_compressed_data = 1;
+
+				break;
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 't':
+				option_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind ];
+
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( check_handle_initialize(
+	     &qcowcheck_check_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize check handle.\n" );
+
+		goto on_error;
+	}
+	if( verify_compressed_data != 0 )
+	{
+		qcowcheck_check_handle->flags |= LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA;
+	}
+	if( option_threads != NULL )
+	{
+		if( check_handle_set_number_of_threads(
+		     qcowcheck_check_handle,
+		     option_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( check_handle_open_input(
+	     qcowcheck_check_handle,
+	     source,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open source file.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_signal_attach(
+	     qcowcheck_signal_handler,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to attach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	result = check_handle_check(
+	          qcowcheck_check_handle,
+	          &error );
+
+	if( result == -1 )
+	{
+		if( qcowcheck_abort != 0 )
+		{
+			fprintf(
+			 stdout,
+			 "Check aborted.\n" );
+		}
+		else
+		{
+			fprintf(
+			 stderr,
+			 "Unable to check source file.\n" );
+		}
+		goto on_error;
+	}
+	if( qcowtools_signal_detach(
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to detach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( check_handle_check_fprint(
+	     qcowcheck_check_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to print consistency check.\n" );
+
+		goto on_error;
+	}
+	if( result == 1 )
+	{
+		fprintf(
+		 stdout,
+		 "No errors found.\n" );
+	}
+	else
+	{
+		fprintf(
+		 stdout,
+		 "Errors found.\n" );
+	}
+	if( check_handle_close(
+	     qcowcheck_check_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close check handle.\n" );
+
+		goto on_error;
+	}
+	if( check_handle_free(
+	     &qcowcheck_check_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free check handle.\n" );
+
+		goto on_error;
+	}
+	if( result != 1 )
+	{
+		return( EXIT_FAILURE );
+	}
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		if( qcowcheck_abort == 0 )
+		{
+			libcnotify_print_error_backtrace(
+			 error );
+		}
+		libcerror_error_free(
+		 &error );
+	}
+	if( qcowcheck_check_handle != NULL )
+	{
+		check_handle_free(
+		 &qcowcheck_check_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
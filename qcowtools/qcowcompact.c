@@ -0,0 +1,252 @@
+/*
+ * Compacts a QEMU Copy-On-Write (QCOW) image file into a new image file
+ * with the cluster blocks in media order
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "compact_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_unused.h"
+
+compact_handle_t *qcowcompact_compact_handle = NULL;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcowcompact to compact a QEMU Copy-On-Write (QCOW) image\n"
+	                 "file into a new image file. The new image file contains the cluster\n"
+	                 "blocks in media order, followed by the level 2 tables stored\n"
+	                 "consecutively. Compressed cluster blocks remain compressed.\n"
+	                 "Snapshots and bitmaps are not copied.\n\n" );
+
+	fprintf( stream, "Usage: qcowcompact [ -hvV ] source target\n\n" );
+
+	fprintf( stream, "\tsource: the source QCOW image file\n" );
+	fprintf( stream, "\ttarget: the target QCOW image file, which is overwritten\n\n" );
+
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-v:     verbose output to stderr\n" );
+	fprintf( stream, "\t-V:     print version\n" );
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error        = NULL;
+	system_character_t *source    = NULL;
+	system_character_t *target    = NULL;
+	char *program                 = "qcowcompact";
+	system_integer_t option       = 0;
+	int verbose                   = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+             "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+        if( qcowtools_output_initialize(
+             _IONBF,
+             &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	qcowoutput_version_fprint(
+	 stdout,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "hvV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( ( optind + 1 ) >= argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source or target file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind ];
+	target = argv[ optind + 1 ];
+
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( compact_handle_initialize(
+	     &qcowcompact_compact_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize compact handle.\n" );
+
+		goto on_error;
+	}
+	if( compact_handle_open_input(
+	     qcowcompact_compact_handle,
+	     source,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open: %" PRIs_SYSTEM ".\n",
+		 source );
+
+		goto on_error;
+	}
+	if( compact_handle_compact(
+	     qcowcompact_compact_handle,
+	     target,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to compact source file.\n" );
+
+		goto on_error;
+	}
+	fprintf(
+	 stdout,
+	 "Compaction completed.\n" );
+
+	if( compact_handle_close_input(
+	     qcowcompact_compact_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close compact handle.\n" );
+
+		goto on_error;
+	}
+	if( compact_handle_free(
+	     &qcowcompact_compact_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free compact handle.\n" );
+
+		goto on_error;
+	}
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( qcowcompact_compact_handle != NULL )
+	{
+		compact_handle_free(
+		 &qcowcompact_compact_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,537 @@
+/*
+ * Exports a QEMU Copy-On-Write (QCOW) image file to a raw image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <system_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "export_handle.h"
+#include "mount_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_signal.h"
+#include "qcowtools_unused.h"
+
+/* The target is opened using a narrow string filename
+ */
+#if defined( HAVE_EXPORT_HANDLE_SUPPORT ) && !defined( HAVE_WIDE_SYSTEM_CHARACTER )
+#define HAVE_QCOWEXPORT_SUPPORT
+#endif
+
+mount_handle_t *qcowexport_mount_handle   = NULL;
+export_handle_t *qcowexport_export_handle = NULL;
+int qcowexport_abort                      = 0;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcowexport to export the QEMU Copy-On-Write (QCOW) image\n"
+	                 "file to a raw image file\n\n" );
+
+	fprintf( stream, "Usage: qcowexport [ -c cache_limits ] [ -k keys ] [ -p password ]\n"
+	                 "                  [ -t threads ] [ -hqvV ] qcow_file target\n\n" );
+
+	fprintf( stream, "\tqcow_file: the QCOW image file\n\n" );
+	fprintf( stream, "\ttarget:    the raw image file or device to write to, a file\n"
+	                 "\t           is created as a sparse file, in which ranges that\n"
+	                 "\t           read as zero bytes are not written, use - to write\n"
+	                 "\t           a raw stream to stdout, pipes are written in order\n\n" );
+
+	fprintf( stream, "\t-c:        the maximum number of cached level 2 tables and cluster\n"
+	                 "\t           blocks formatted as: level2_tables,cluster_blocks\n" );
+	fprintf( stream, "\t-h:        shows this help\n" );
+	fprintf( stream, "\t-k:        the key formatted in base16\n" );
+	fprintf( stream, "\t-p:        specify the password/passphrase\n" );
+	fprintf( stream, "\t-q:        quiet, do not print the status\n" );
+	fprintf( stream, "\t-t:        the number of threads that export disjoint ranges of\n"
+	                 "\t           the image file, or that read ahead when the target\n"
+	                 "\t           is a stream, default is %d\n",
+	                 EXPORT_HANDLE_DEFAULT_NUMBER_OF_THREADS );
+	fprintf( stream, "\t-v:        verbose output to stderr\n" );
+	fprintf( stream, "\t-V:        print version\n" );
+}
+
+/* Signal handler for qcowexport
+ */
+void qcowexport_signal_handler(
+      qcowtools_signal_t signal QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcowexport_signal_handler";
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( signal )
+
+	qcowexport_abort = 1;
+
+#if defined( HAVE_QCOWEXPORT_SUPPORT )
+	if( qcowexport_export_handle != NULL )
+	{
+		if( export_handle_signal_abort(
+		     qcowexport_export_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal export handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif
+	if( qcowexport_mount_handle != NULL )
+	{
+		if( mount_handle_signal_abort(
+		     qcowexport_mount_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal mount handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error                  = NULL;
+	system_character_t *option_cache_limits = NULL;
+	system_character_t *option_keys         = NULL;
+	system_character_t *option_password     = NULL;
+	system_character_t *option_threads      = NULL;
+	system_character_t *source              = NULL;
+	system_character_t *target              = NULL;
+	FILE *notify_stream                     = stdout;
+	char *program                           = "qcowexport";
+	system_integer_t option                 = 0;
+	int quiet                               = 0;
+	int result                              = 0;
+	int verbose                             = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+	     "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_output_initialize(
+	     _IONBF,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	/* When the raw stream is written to stdout the status is printed to stderr
+	 */
+	if( ( argc > 1 )
+	 && ( argv[ argc - 1 ][ 0 ] == (system_character_t) '-' )
+	 && ( argv[ argc - 1 ][ 1 ] == 0 ) )
+	{
+		notify_stream = stderr;
+	}
+	qcowoutput_version_fprint(
+	 notify_stream,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "c:hk:p:qt:vV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'c':
+				option_cache_limits = optarg;
+
+				break;
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'k':
+				option_keys = optarg;
+
+				break;
+
+			case (system_integer_t) 'p':
+				option_password = optarg;
+
+				break;
+
+			case (system_integer_t) 'q':
+				quiet = 1;
+
+				break;
+
+			case (system_integer_t) 't':
+				option_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind++ ];
+
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing target.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	target = argv[ optind ];
+
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( mount_handle_initialize(
+	     &qcowexport_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize mount handle.\n" );
+
+		goto on_error;
+	}
+	if( option_cache_limits != NULL )
+	{
+		if( mount_handle_set_cache_limits(
+		     qcowexport_mount_handle,
+		     option_cache_limits,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set cache limits.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_keys != NULL )
+	{
+		if( mount_handle_set_keys(
+		     qcowexport_mount_handle,
+		     option_keys,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set keys.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_password != NULL )
+	{
+		if( mount_handle_set_password(
+		     qcowexport_mount_handle,
+		     option_password,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set password.\n" );
+
+			goto on_error;
+		}
+	}
+	if( mount_handle_open_input(
+	     qcowexport_mount_handle,
+	     source,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open source file.\n" );
+
+		goto on_error;
+	}
+#if defined( HAVE_QCOWEXPORT_SUPPORT )
+	if( export_handle_initialize(
+	     &qcowexport_export_handle,
+	     qcowexport_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize export handle.\n" );
+
+		goto on_error;
+	}
+	if( option_threads != NULL )
+	{
+		if( export_handle_set_number_of_threads(
+		     qcowexport_export_handle,
+		     option_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( quiet == 0 )
+	{
+		if( export_handle_set_notify_stream(
+		     qcowexport_export_handle,
+		     notify_stream,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set notify stream.\n" );
+
+			goto on_error;
+		}
+	}
+	if( export_handle_open_output(
+	     qcowexport_export_handle,
+	     target,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open target.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_signal_attach(
+	     qcowexport_signal_handler,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to attach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	result = export_handle_export(
+	          qcowexport_export_handle,
+	          &error );
+
+	if( result == -1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to export source file.\n" );
+
+		goto on_error;
+	}
+	else if( result == 0 )
+	{
+		fprintf(
+		 notify_stream,
+		 "Export aborted.\n" );
+	}
+	if( qcowtools_signal_detach(
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to detach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( export_handle_close_output(
+	     qcowexport_export_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close target.\n" );
+
+		goto on_error;
+	}
+	if( export_handle_free(
+	     &qcowexport_export_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free export handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_close(
+	     qcowexport_mount_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close mount handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_free(
+	     &qcowexport_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free mount handle.\n" );
+
+		goto on_error;
+	}
+	if( result != 1 )
+	{
+		return( EXIT_FAILURE );
+	}
+	return( EXIT_SUCCESS );
+#else
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_threads )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( quiet )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( result )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( target )
+
+	fprintf(
+	 stderr,
+	 "No support to export to a raw image file.\n" );
+
+	mount_handle_free(
+	 &qcowexport_mount_handle,
+	 NULL );
+
+	return( EXIT_FAILURE );
+#endif
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+#if defined( HAVE_QCOWEXPORT_SUPPORT )
+	if( qcowexport_export_handle != NULL )
+	{
+		export_handle_free(
+		 &qcowexport_export_handle,
+		 NULL );
+	}
+#endif
+	if( qcowexport_mount_handle != NULL )
+	{
+		mount_handle_free(
+		 &qcowexport_mount_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,700 @@
+/*
+ * Calculates the digest hashes of a QEMU Copy-On-Write (QCOW) image file
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <system_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "hash_handle.h"
+#include "mount_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_signal.h"
+#include "qcowtools_unused.h"
+
+mount_handle_t *qcowhash_mount_handle = NULL;
+hash_handle_t *qcowhash_hash_handle   = NULL;
+int qcowhash_abort                    = 0;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcowhash to calculate the digest hashes of the media data\n"
+	                 "of a QEMU Copy-On-Write (QCOW) image file\n\n" );
+
+	fprintf( stream, "Usage: qcowhash [ -b chunk_size ] [ -c cache_limits ] [ -d digest_types ]\n"
+	                 "                [ -i index_file ] [ -I index_file ] [ -k keys ]\n"
+	                 "                [ -m mode ] [ -p password ] [ -t threads ]\n"
+	                 "                [ -hqvV ] qcow_file\n\n" );
+
+	fprintf( stream, "\tqcow_file: the QCOW image file\n\n" );
+
+	fprintf( stream, "\t-b:        the size of the chunks that are read by a single thread,\n"
+	                 "\t           which must be a multiple of 512, default is %d\n",
+	                 HASH_HANDLE_DEFAULT_CHUNK_SIZE );
+	fprintf( stream, "\t-c:        the maximum number of cached level 2 tables and cluster\n"
+	                 "\t           blocks formatted as: level2_tables,cluster_blocks\n" );
+	fprintf( stream, "\t-d:        the digest types formatted as a comma separated list,\n"
+	                 "\t           options: md5 (default), sha1, sha256\n" );
+	fprintf( stream, "\t-h:        shows this help\n" );
+	fprintf( stream, "\t-i:        write a digest index file that contains the SHA-256 of\n"
+	                 "\t           every cluster block instead of calculating the digest\n"
+	                 "\t           hashes of the media data\n" );
+	fprintf( stream, "\t-I:        verify a digest index file, where only the cluster\n"
+	                 "\t           blocks that were reallocated since the digest index\n"
+	                 "\t           file was written are read\n" );
+	fprintf( stream, "\t-k:        the key formatted in base16\n" );
+	fprintf( stream, "\t-m:        the mode, options: linear (default), which calculates\n"
+	                 "\t           the digest hashes over the data, or chunked, which\n"
+	                 "\t           calculates the digest hashes over the digest hashes\n"
+	                 "\t           of the chunks\n" );
+	fprintf( stream, "\t-p:        specify the password/passphrase\n" );
+	fprintf( stream, "\t-q:        quiet, do not print the status\n" );
+	fprintf( stream, "\t-t:        the number of threads that read the chunks of the image\n"
+	                 "\t           file, default is %d\n",
+	                 HASH_HANDLE_DEFAULT_NUMBER_OF_THREADS );
+	fprintf( stream, "\t-v:        verbose output to stderr\n" );
+	fprintf( stream, "\t-V:        print version\n" );
+}
+
+/* Signal handler for qcowhash
+ */
+void qcowhash_signal_handler(
+      qcowtools_signal_t signal QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcowhash_signal_handler";
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( signal )
+
+	qcowhash_abort = 1;
+
+#if defined( HAVE_HASH_HANDLE_SUPPORT )
+	if( qcowhash_hash_handle != NULL )
+	{
+		if( hash_handle_signal_abort(
+		     qcowhash_hash_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal hash handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif
+	if( qcowhash_mount_handle != NULL )
+	{
+		if( mount_handle_signal_abort(
+		     qcowhash_mount_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal mount handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error                  = NULL;
+	system_character_t *option_cache_limits = NULL;
+	system_character_t *option_chunk_size   = NULL;
+	system_character_t *option_digest_types = NULL;
+	system_character_t *option_index        = NULL;
+	system_character_t *option_keys         = NULL;
+	system_character_t *option_mode         = NULL;
+	system_character_t *option_password     = NULL;
+	system_character_t *option_threads      = NULL;
+	system_character_t *option_verify_index = NULL;
+	system_character_t *source              = NULL;
+	char *program                           = "qcowhash";
+	system_integer_t option                 = 0;
+	uint64_t number_of_changed_blocks       = 0;
+	uint64_t number_of_mismatches           = 0;
+	int quiet                               = 0;
+	int result                              = 0;
+	int verbose                             = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+	     "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_output_initialize(
+	     _IONBF,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	qcowoutput_version_fprint(
+	 stdout,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "b:c:d:hi:I:k:m:p:qt:vV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'b':
+				option_chunk_size = optarg;
+
+				break;
+
+			case (system_integer_t) 'c':
+				option_cache_limits = optarg;
+
+				break;
+
+			case (system_integer_t) 'd':
+				option_digest_types = optarg;
+
+				break;
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'i':
+				option_index = optarg;
+
+				break;
+
+			case (system_integer_t) 'I':
+				option_verify_index = optarg;
+
+				break;
+
+			case (system_integer_t) 'k':
+				option_keys = optarg;
+
+				break;
+
+			case (system_integer_t) 'm':
+				option_mode = optarg;
+
+				break;
+
+			case (system_integer_t) 'p':
+				option_password = optarg;
+
+				break;
+
+			case (system_integer_t) 'q':
+				quiet = 1;
+
+				break;
+
+			case (system_integer_t) 't':
+				option_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind ];
+
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( mount_handle_initialize(
+	     &qcowhash_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize mount handle.\n" );
+
+		goto on_error;
+	}
+	if( option_cache_limits != NULL )
+	{
+		if( mount_handle_set_cache_limits(
+		     qcowhash_mount_handle,
+		     option_cache_limits,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set cache limits.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_keys != NULL )
+	{
+		if( mount_handle_set_keys(
+		     qcowhash_mount_handle,
+		     option_keys,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set keys.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_password != NULL )
+	{
+		if( mount_handle_set_password(
+		     qcowhash_mount_handle,
+		     option_password,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set password.\n" );
+
+			goto on_error;
+		}
+	}
+	/* The digest index is calculated by the worker threads of the input file
+	 */
+	if( ( option_threads != NULL )
+	 && ( ( option_index != NULL )
+	  || ( option_verify_index != NULL ) ) )
+	{
+		if( mount_handle_set_number_of_worker_threads(
+		     qcowhash_mount_handle,
+		     option_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( mount_handle_open_input(
+	     qcowhash_mount_handle,
+	     source,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open source file.\n" );
+
+		goto on_error;
+	}
+	if( ( option_index != NULL )
+	 || ( option_verify_index != NULL ) )
+	{
+		if( option_index != NULL )
+		{
+			result = mount_handle_write_digest_index(
+			          qcowhash_mount_handle,
+			          0,
+			          option_index,
+			          &error );
+
+			if( result != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unable to write digest index file.\n" );
+
+				goto on_error;
+			}
+			fprintf(
+			 stdout,
+			 "Digest index written to: %" PRIs_SYSTEM "\n",
+			 option_index );
+		}
+		else
+		{
+			result = mount_handle_verify_digest_index(
+			          qcowhash_mount_handle,
+			          0,
+			          option_verify_index,
+			          &number_of_changed_blocks,
+			          &number_of_mismatches,
+			          &error );
+
+			if( result == -1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unable to verify digest index file.\n" );
+
+				goto on_error;
+			}
+			else if( result == 0 )
+			{
+				fprintf(
+				 stdout,
+				 "Digest index file does not match the source file.\n" );
+			}
+			else
+			{
+				fprintf(
+				 stdout,
+				 "Number of changed cluster blocks\t: %" PRIu64 "\n"
+				 "Number of mismatches\t\t\t: %" PRIu64 "\n",
+				 number_of_changed_blocks,
+				 number_of_mismatches );
+
+				if( number_of_mismatches != 0 )
+				{
+					result = 0;
+				}
+			}
+		}
+		if( mount_handle_close(
+		     qcowhash_mount_handle,
+		     &error ) != 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to close mount handle.\n" );
+
+			goto on_error;
+		}
+		if( mount_handle_free(
+		     &qcowhash_mount_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to free mount handle.\n" );
+
+			goto on_error;
+		}
+		if( result != 1 )
+		{
+			return( EXIT_FAILURE );
+		}
+		return( EXIT_SUCCESS );
+	}
+#if defined( HAVE_HASH_HANDLE_SUPPORT )
+	if( hash_handle_initialize(
+	     &qcowhash_hash_handle,
+	     qcowhash_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize hash handle.\n" );
+
+		goto on_error;
+	}
+	if( option_chunk_size != NULL )
+	{
+		if( hash_handle_set_chunk_size(
+		     qcowhash_hash_handle,
+		     option_chunk_size,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set chunk size.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_digest_types != NULL )
+	{
+		if( hash_handle_set_digest_types(
+		     qcowhash_hash_handle,
+		     option_digest_types,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set digest types.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_mode != NULL )
+	{
+		if( hash_handle_set_mode(
+		     qcowhash_hash_handle,
+		     option_mode,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set mode.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_threads != NULL )
+	{
+		if( hash_handle_set_number_of_threads(
+		     qcowhash_hash_handle,
+		     option_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( quiet == 0 )
+	{
+		if( hash_handle_set_notify_stream(
+		     qcowhash_hash_handle,
+		     stderr,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set notify stream.\n" );
+
+			goto on_error;
+		}
+	}
+	if( qcowtools_signal_attach(
+	     qcowhash_signal_handler,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to attach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	result = hash_handle_hash(
+	          qcowhash_hash_handle,
+	          &error );
+
+	if( result == -1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to hash source file.\n" );
+
+		goto on_error;
+	}
+	else if( result == 0 )
+	{
+		fprintf(
+		 stdout,
+		 "Hash aborted.\n" );
+	}
+	if( qcowtools_signal_detach(
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to detach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( result == 1 )
+	{
+		fprintf(
+		 stdout,
+		 "\n" );
+
+		if( hash_handle_digest_hashes_fprint(
+		     qcowhash_hash_handle,
+		     stdout,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to print digest hashes.\n" );
+
+			goto on_error;
+		}
+	}
+	if( hash_handle_free(
+	     &qcowhash_hash_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free hash handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_close(
+	     qcowhash_mount_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close mount handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_free(
+	     &qcowhash_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free mount handle.\n" );
+
+		goto on_error;
+	}
+	if( result != 1 )
+	{
+		return( EXIT_FAILURE );
+	}
+	return( EXIT_SUCCESS );
+#else
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_chunk_size )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_digest_types )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_mode )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_threads )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( quiet )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( result )
+
+	fprintf(
+	 stderr,
+	 "No support to calculate digest hashes.\n" );
+
+	mount_handle_free(
+	 &qcowhash_mount_handle,
+	 NULL );
+
+	return( EXIT_FAILURE );
+#endif
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+#if defined( HAVE_HASH_HANDLE_SUPPORT )
+	if( qcowhash_hash_handle != NULL )
+	{
+		hash_handle_free(
+		 &qcowhash_hash_handle,
+		 NULL );
+	}
+#endif
+	if( qcowhash_mount_handle != NULL )
+	{
+		mount_handle_free(
+		 &qcowhash_mount_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
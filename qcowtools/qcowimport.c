@@ -0,0 +1,316 @@
+/*
+ * Imports the data of a raw image into a QEMU Copy-On-Write (QCOW) image file
+ * with compressed cluster blocks
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#if defined( HAVE_UNISTD_H )
+#include <unistd.h>
+#endif
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "import_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_unused.h"
+
+import_handle_t *qcowimport_import_handle = NULL;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcowimport to import the data of a raw image into a QEMU\n"
+	                 "Copy-On-Write (QCOW) image file with compressed cluster blocks.\n\n" );
+
+	fprintf( stream, "Usage: qcowimport [ -b cluster_block_size ] [ -c method ] [ -l level ]\n"
+	                 "                  [ -t threads ] [ -hvV ] source target\n\n" );
+
+	fprintf( stream, "\tsource: the source (raw image) file\n" );
+	fprintf( stream, "\ttarget: the target QCOW image file, which is overwritten\n\n" );
+
+	fprintf( stream, "\t-b:     the cluster block size, a power of 2 between 1024 and\n"
+	                 "\t        2097152, default is 65536\n" );
+	fprintf( stream, "\t-c:     the compression method, options: deflate (default), zstd\n" );
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-l:     the compression level, default is the default level\n"
+	                 "\t        of the compression method\n" );
+	fprintf( stream, "\t-t:     the number of threads that compress the cluster blocks,\n"
+	                 "\t        default is 0, which compresses in the main thread\n" );
+	fprintf( stream, "\t-v:     verbose output to stderr\n" );
+	fprintf( stream, "\t-V:     print version\n" );
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error                        = NULL;
+	system_character_t *option_cluster_block_size = NULL;
+	system_character_t *option_compression_level  = NULL;
+	system_character_t *option_compression_method = NULL;
+	system_character_t *option_threads            = NULL;
+	system_character_t *source                    = NULL;
+	system_character_t *target                    = NULL;
+	char *program                                 = "qcowimport";
+	system_integer_t option                       = 0;
+	int verbose                                   = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+             "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+        if( qcowtools_output_initialize(
+             _IONBF,
+             &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	qcowoutput_version_fprint(
+	 stdout,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "b:c:hl:t:vV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'b':
+				option_cluster_block_size = optarg;
+
+				break;
+
+			case (system_integer_t) 'c':
+				option_compression_method = optarg;
+
+				break;
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'l':
+				option_compression_level = optarg;
+
+				break;
+
+			case (system_integer_t) 't':
+				option_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( ( optind + 1 ) >= argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source or target file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind ];
+	target = argv[ optind + 1 ];
+
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( import_handle_initialize(
+	     &qcowimport_import_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize import handle.\n" );
+
+		goto on_error;
+	}
+	if( option_cluster_block_size != NULL )
+	{
+		if( import_handle_set_cluster_block_size(
+		     qcowimport_import_handle,
+		     option_cluster_block_size,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set cluster block size.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_compression_method != NULL )
+	{
+		if( import_handle_set_compression_method(
+		     qcowimport_import_handle,
+		     option_compression_method,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set compression method.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_compression_level != NULL )
+	{
+		if( import_handle_set_compression_level(
+		     qcowimport_import_handle,
+		     option_compression_level,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set compression level.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_threads != NULL )
+	{
+		if( import_handle_set_number_of_threads(
+		     qcowimport_import_handle,
+		     option_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( import_handle_import(
+	     qcowimport_import_handle,
+	     source,
+	     target,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to import source file.\n" );
+
+		goto on_error;
+	}
+	fprintf(
+	 stdout,
+	 "Import completed.\n" );
+
+	if( import_handle_free(
+	     &qcowimport_import_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free import handle.\n" );
+
+		goto on_error;
+	}
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( qcowimport_import_handle != NULL )
+	{
+		import_handle_free(
+		 &qcowimport_import_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
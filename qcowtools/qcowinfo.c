@@ -58,11 +58,20 @@ void usage_fprint(
 	fprintf( stream, "Use qcowinfo to determine information about a QEMU Copy-On-Write (QCOW)\n"
 	                 "image file.\n\n" );
 
-	fprintf( stream, "Usage: qcowinfo [ -hvV ] source\n\n" );
+	fprintf( stream, "Usage: qcowinfo [ -d diff ] [ -p percentage ] [ -hsvV ] source\n\n" );
 
 	fprintf( stream, "\tsource: the source file\n\n" );
 
+	fprintf( stream, "\t-d:     prints the changed ranges instead of the file information\n"
+	                 "\t        options: backing (the ranges the file does not read from\n"
+	                 "\t        its backing file), N (snapshot N compared with the current\n"
+	                 "\t        media data) or N,M (snapshot N compared with snapshot M)\n" );
 	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-p:     samples the percentage of the cluster blocks, such as 1 or\n"
+	                 "\t        0.1, and prints the estimated composition of the media\n"
+	                 "\t        instead of the file information\n" );
+	fprintf( stream, "\t-s:     reads the media data and prints the read statistics and\n"
+	                 "\t        the latency percentiles of the reads\n" );
 	fprintf( stream, "\t-v:     verbose output to stderr\n" );
 	fprintf( stream, "\t-V:     print version\n" );
 }
@@ -119,11 +128,14 @@ int wmain( int argc, wchar_t * const argv[] )
 int main( int argc, char * const argv[] )
 #endif
 {
-	libqcow_error_t *error     = NULL;
-	system_character_t *source = NULL;
-	char *program              = "qcowinfo";
-	system_integer_t option    = 0;
-	int verbose                = 0;
+	libqcow_error_t *error                    = NULL;
+	system_character_t *option_diff_string    = NULL;
+	system_character_t *option_profile_string = NULL;
+	system_character_t *source                = NULL;
+	char *program                             = "qcowinfo";
+	system_integer_t option                   = 0;
+	int print_statistics                      = 0;
+	int verbose                               = 0;
 
 	libcnotify_stream_set(
 	 stderr,
@@ -158,7 +170,7 @@ int main( int argc, char * const argv[] )
 	while( ( option = qcowtools_getopt(
 	                   argc,
 	                   argv,
-	                   _SYSTEM_STRING( "hvV" ) ) ) != (system_integer_t) -1 )
+	                   _SYSTEM_STRING( "d:hp:svV" ) ) ) != (system_integer_t) -1 )
 	{
 		switch( option )
 		{
@@ -174,18 +186,38 @@ int main( int argc, char * const argv[] )
 
 				return( EXIT_FAILURE );
 
+			case (system_integer_t) 'd':
+				option_diff_string = optarg;
+
+				break;
+
 			case (system_integer_t) 'h':
 				usage_fprint(
 				 stdout );
 
 				return( EXIT_SUCCESS );
 
+			case (system_integer_t) 'p':
+				option_profile_string = optarg;
+
+				break;
+
+			case (system_integer_t) 's':
+				print_statistics = 1;
+
+				break;
+
 			case (system_integer_t) 'v':
 				verbose = 1;
 
 				break;
 
 			case (system_integer_t) 'V':
+				fprintf(
+				 stdout,
+				 "Decompression backend: %s\n\n",
+				 libqcow_get_decompression_backend() );
+
 				qcowoutput_copyright_fprint(
 				 stdout );
 
@@ -223,6 +255,34 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
+	if( option_diff_string != NULL )
+	{
+		if( info_handle_set_diff(
+		     qcowinfo_info_handle,
+		     option_diff_string,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported diff.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_profile_string != NULL )
+	{
+		if( info_handle_set_profile(
+		     qcowinfo_info_handle,
+		     option_profile_string,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported profile percentage.\n" );
+
+			goto on_error;
+		}
+	}
 	if( info_handle_open_input(
 	     qcowinfo_info_handle,
 	     source,
@@ -234,9 +294,35 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
-	if( info_handle_file_fprint(
-	     qcowinfo_info_handle,
-	     &error ) != 1 )
+	if( option_diff_string != NULL )
+	{
+		if( info_handle_diff_fprint(
+		     qcowinfo_info_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to print changed ranges.\n" );
+
+			goto on_error;
+		}
+	}
+	else if( option_profile_string != NULL )
+	{
+		if( info_handle_profile_fprint(
+		     qcowinfo_info_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to print profile.\n" );
+
+			goto on_error;
+		}
+	}
+	else if( info_handle_file_fprint(
+	          qcowinfo_info_handle,
+	          &error ) != 1 )
 	{
 		fprintf(
 		 stderr,
@@ -244,6 +330,19 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
+	if( print_statistics != 0 )
+	{
+		if( info_handle_statistics_fprint(
+		     qcowinfo_info_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to print read statistics.\n" );
+
+			goto on_error;
+		}
+	}
 	if( info_handle_close(
 	     qcowinfo_info_handle,
 	     &error ) != 0 )
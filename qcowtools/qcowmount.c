@@ -64,7 +64,14 @@
 #include <dokan.h>
 #endif
 
+#include "benchmark_handle.h"
 #include "mount_handle.h"
+
+#if defined( HAVE_LIBFUSE ) && defined( HAVE_MOUNT_HANDLE_FILE_DATA_SUPPORT )
+#if FUSE_VERSION >= 29
+#define HAVE_QCOWMOUNT_FUSE_READ_BUF
+#endif
+#endif
 #include "qcowtools_getopt.h"
 #include "qcowtools_libcerror.h"
 #include "qcowtools_libclocale.h"
@@ -74,8 +81,9 @@
 #include "qcowtools_signal.h"
 #include "qcowtools_unused.h"
 
-mount_handle_t *qcowmount_mount_handle = NULL;
-int qcowmount_abort                    = 0;
+mount_handle_t *qcowmount_mount_handle         = NULL;
+benchmark_handle_t *qcowmount_benchmark_handle = NULL;
+int qcowmount_abort                            = 0;
 
 /* Prints the executable usage information
  */
@@ -89,19 +97,58 @@ void usage_fprint(
 	fprintf( stream, "Use qcowmount to mount the QEMU Copy-On-Write (QCOW)\n"
                          "image file\n\n" );
 
-	fprintf( stream, "Usage: qcowmount [ -k keys ] [ -p password ]\n"
-	                 "                 [ -X extended_options ] [ -hvV ]\n"
+	fprintf( stream, "Usage: qcowmount [ -B pattern ] [ -c cache_limits ]\n"
+	                 "                 [ -D duration ] [ -k keys ]\n"
+	                 "                 [ -p password ] [ -P page_cache ]\n"
+	                 "                 [ -R read_size ] [ -t worker_threads ]\n"
+	                 "                 [ -T request_threads ] [ -w scratch ]\n"
+	                 "                 [ -X extended_options ] [ -hsvV ]\n"
 	                 "                 qcow_file mount_point\n\n" );
+	fprintf( stream, "       qcowmount -B pattern [ -D duration ] [ -R read_size ]\n"
+	                 "                 [ -T request_threads ] [ options ] qcow_file\n\n" );
 
 	fprintf( stream, "\tqcow_file:   the QCOW image file\n\n" );
-	fprintf( stream, "\tmount_point: the directory to serve as mount point\n\n" );
-
+	fprintf( stream, "\tmount_point: the directory to serve as mount point, which contains\n"
+	                 "\t             the media data of the image as qcow1, of its internal\n"
+	                 "\t             snapshots as qcow1.snapshot1 .. qcow1.snapshotN and of\n"
+	                 "\t             the files in its backing chain as qcow1.backing1 ..\n"
+	                 "\t             qcow1.backingN\n\n" );
+
+	fprintf( stream, "\t-B:          benchmark the reads of the media data instead of mounting,\n"
+	                 "\t             the reads use the same code path as the file system\n"
+	                 "\t             requests, options: sequential or random\n" );
+	fprintf( stream, "\t-c:          the maximum number of cached level 2 tables and cluster\n"
+	                 "\t             blocks formatted as: level2_tables,cluster_blocks\n" );
+	fprintf( stream, "\t-D:          the duration of the benchmark in seconds, default is 10\n" );
 	fprintf( stream, "\t-h:          shows this help\n" );
 	fprintf( stream, "\t-k:          the key formatted in base16\n" );
 	fprintf( stream, "\t-p:          specify the password/passphrase\n" );
+	fprintf( stream, "\t-P:          how the kernel page cache keeps the data of the mounted\n"
+	                 "\t             file, options: auto (keep the data while the modification\n"
+	                 "\t             time does not change), kernel (always keep the data),\n"
+	                 "\t             none (default, discard the data when the file is opened)\n"
+	                 "\t             (FUSE only)\n" );
+	fprintf( stream, "\t-R:          the maximum size of a read request and of the kernel\n"
+	                 "\t             read-ahead in bytes, the kernel can use a smaller size\n"
+	                 "\t             (FUSE only), or the size of a benchmark read, default\n"
+	                 "\t             is 65536\n" );
+	fprintf( stream, "\t-s:          handle the file system requests in a single thread,\n"
+	                 "\t             by default the requests are handled by multiple threads\n" );
+	fprintf( stream, "\t-t:          the number of worker threads libqcow uses to decompress\n"
+	                 "\t             and decrypt the cluster blocks of a single read, default\n"
+	                 "\t             is 0 which processes them in the requesting thread\n" );
+	fprintf( stream, "\t-T:          the number of threads that handle the file system requests,\n"
+	                 "\t             default is 0 which uses the default of the sub system\n"
+	                 "\t             (Dokan only), or the number of benchmark threads, default\n"
+	                 "\t             is 1\n" );
 	fprintf( stream, "\t-v:          verbose output to stderr\n"
 	                 "\t             qcowmount will remain running in the foreground\n" );
 	fprintf( stream, "\t-V:          print version\n" );
+	fprintf( stream, "\t-w:          makes the media data of the image writable, the data\n"
+	                 "\t             written is kept in a scratch overlay and discarded on\n"
+	                 "\t             unmount, the image file is not modified, options: memory\n"
+	                 "\t             (keep the overlay in memory) or the path of a scratch\n"
+	                 "\t             file that is created or truncated (FUSE only)\n" );
 	fprintf( stream, "\t-X:          extended options to pass to sub system\n" );
 }
 
@@ -117,6 +164,22 @@ void qcowmount_signal_handler(
 
 	qcowmount_abort = 1;
 
+	if( qcowmount_benchmark_handle != NULL )
+	{
+		if( benchmark_handle_signal_abort(
+		     qcowmount_benchmark_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal benchmark handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
 	if( qcowmount_mount_handle != NULL )
 	{
 		if( mount_handle_signal_abort(
@@ -162,6 +225,289 @@ static size_t qcowmount_fuse_path_prefix_length = 5;
 time_t qcowmount_timestamp                      = 0;
 #endif
 
+static char *qcowmount_fuse_snapshot_suffix         = ".snapshot";
+static size_t qcowmount_fuse_snapshot_suffix_length = 9;
+
+static char *qcowmount_fuse_backing_suffix          = ".backing";
+static size_t qcowmount_fuse_backing_suffix_length  = 8;
+
+/* Determines the input file and layer of a path
+ * The path is the prefix followed by the 1-based index of the input file
+ * and optionally a layer suffix followed by the 1-based index of the layer
+ * Returns 1 if successful, 0 if the path is not supported or -1 on error
+ */
+int qcowmount_fuse_get_layer_from_path(
+     const char *path,
+     size_t path_length,
+     int *input_file_index,
+     int *layer_type,
+     int *layer_index,
+     libcerror_error_t **error )
+{
+	static char *function = "qcowmount_fuse_get_layer_from_path";
+	size_t string_index   = 0;
+	int number_of_digits  = 0;
+	int value             = 0;
+
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		return( -1 );
+	}
+	if( input_file_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid input file index.",
+		 function );
+
+		return( -1 );
+	}
+	if( layer_type == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layer type.",
+		 function );
+
+		return( -1 );
+	}
+	if( layer_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layer index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( path_length <= qcowmount_fuse_path_prefix_length )
+	 || ( narrow_string_compare(
+	       path,
+	       qcowmount_fuse_path_prefix,
+	       qcowmount_fuse_path_prefix_length ) != 0 ) )
+	{
+		return( 0 );
+	}
+	string_index = qcowmount_fuse_path_prefix_length;
+
+	for( number_of_digits = 0;
+	     number_of_digits < 3;
+	     number_of_digits++ )
+	{
+		if( ( string_index >= path_length )
+		 || ( path[ string_index ] < '0' )
+		 || ( path[ string_index ] > '9' ) )
+		{
+			break;
+		}
+		value *= 10;
+		value += path[ string_index++ ] - '0';
+	}
+	if( value == 0 )
+	{
+		return( 0 );
+	}
+	*input_file_index = value - 1;
+
+	if( string_index == path_length )
+	{
+		*layer_type  = MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE;
+		*layer_index = 0;
+
+		return( 1 );
+	}
+	if( ( ( path_length - string_index ) > qcowmount_fuse_snapshot_suffix_length )
+	 && ( narrow_string_compare(
+	       &( path[ string_index ] ),
+	       qcowmount_fuse_snapshot_suffix,
+	       qcowmount_fuse_snapshot_suffix_length ) == 0 ) )
+	{
+		*layer_type   = MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT;
+		string_index += qcowmount_fuse_snapshot_suffix_length;
+	}
+	else if( ( ( path_length - string_index ) > qcowmount_fuse_backing_suffix_length )
+	      && ( narrow_string_compare(
+	            &( path[ string_index ] ),
+	            qcowmount_fuse_backing_suffix,
+	            qcowmount_fuse_backing_suffix_length ) == 0 ) )
+	{
+		*layer_type   = MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE;
+		string_index += qcowmount_fuse_backing_suffix_length;
+	}
+	else
+	{
+		return( 0 );
+	}
+	value = 0;
+
+	for( number_of_digits = 0;
+	     number_of_digits < 3;
+	     number_of_digits++ )
+	{
+		if( ( string_index >= path_length )
+		 || ( path[ string_index ] < '0' )
+		 || ( path[ string_index ] > '9' ) )
+		{
+			break;
+		}
+		value *= 10;
+		value += path[ string_index++ ] - '0';
+	}
+	if( ( value == 0 )
+	 || ( string_index != path_length ) )
+	{
+		return( 0 );
+	}
+	*layer_index = value - 1;
+
+	return( 1 );
+}
+
+/* Sets the path of a layer of an input file
+ * Returns 1 if successful or -1 on error
+ */
+int qcowmount_fuse_set_layer_path(
+     char *path,
+     size_t path_size,
+     int input_file_index,
+     int layer_type,
+     int layer_index,
+     size_t *path_length,
+     libcerror_error_t **error )
+{
+	static char *function = "qcowmount_fuse_set_layer_path";
+	int print_count       = 0;
+
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		return( -1 );
+	}
+	if( path_size > (size_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid path size value exceeds maximum.",
+		 function );
+
+		return( -1 );
+	}
+	if( path_length == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path length.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( input_file_index < 0 )
+	 || ( input_file_index >= 999 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input file index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( layer_index < 0 )
+	 || ( layer_index >= 999 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid layer index value out of bounds.",
+		 function );
+
+		return( -1 );
+	}
+	switch( layer_type )
+	{
+		case MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE:
+			print_count = narrow_string_snprintf(
+			               path,
+			               path_size,
+			               "%s%d",
+			               qcowmount_fuse_path_prefix,
+			               input_file_index + 1 );
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT:
+			print_count = narrow_string_snprintf(
+			               path,
+			               path_size,
+			               "%s%d%s%d",
+			               qcowmount_fuse_path_prefix,
+			               input_file_index + 1,
+			               qcowmount_fuse_snapshot_suffix,
+			               layer_index + 1 );
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE:
+			print_count = narrow_string_snprintf(
+			               path,
+			               path_size,
+			               "%s%d%s%d",
+			               qcowmount_fuse_path_prefix,
+			               input_file_index + 1,
+			               qcowmount_fuse_backing_suffix,
+			               layer_index + 1 );
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported layer type.",
+			 function );
+
+			return( -1 );
+	}
+	if( ( print_count < 0 )
+	 || ( (size_t) print_count >= path_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set path.",
+		 function );
+
+		return( -1 );
+	}
+	*path_length = (size_t) print_count;
+
+	return( 1 );
+}
+
 /* Opens a file or directory
  * Returns 0 if successful or a negative errno value otherwise
  */
@@ -172,6 +518,9 @@ int qcowmount_fuse_open(
 	libcerror_error_t *error = NULL;
 	static char *function    = "qcowmount_fuse_open";
 	size_t path_length       = 0;
+	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
 	int result               = 0;
 
 	if( path == NULL )
@@ -203,12 +552,15 @@ int qcowmount_fuse_open(
 	path_length = narrow_string_length(
 	               path );
 
-	if( ( path_length <= qcowmount_fuse_path_prefix_length )
-         || ( path_length > ( qcowmount_fuse_path_prefix_length + 3 ) )
-	 || ( narrow_string_compare(
-	       path,
-	       qcowmount_fuse_path_prefix,
-	       qcowmount_fuse_path_prefix_length ) != 0 ) )
+	result = qcowmount_fuse_get_layer_from_path(
+	          path,
+	          path_length,
+	          &input_file_index,
+	          &layer_type,
+	          &layer_index,
+	          &error );
+
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 &error,
@@ -222,7 +574,12 @@ int qcowmount_fuse_open(
 
 		goto on_error;
 	}
-	if( ( file_info->flags & 0x03 ) != O_RDONLY )
+	/* Only the media data of the first input file is writable when the scratch overlay is set
+	 */
+	if( ( ( file_info->flags & 0x03 ) != O_RDONLY )
+	 && ( ( qcowmount_mount_handle->scratch_overlay_is_set == 0 )
+	  || ( input_file_index != 0 )
+	  || ( layer_type != MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE ) ) )
 	{
 		libcerror_error_set(
 		 &error,
@@ -263,8 +620,9 @@ int qcowmount_fuse_read(
 	size_t path_length       = 0;
 	ssize_t read_count       = 0;
 	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
 	int result               = 0;
-	int string_index         = 0;
 
 	if( path == NULL )
 	{
@@ -308,12 +666,299 @@ int qcowmount_fuse_read(
 	path_length = narrow_string_length(
 	               path );
 
-	if( ( path_length <= qcowmount_fuse_path_prefix_length )
-         || ( path_length > ( qcowmount_fuse_path_prefix_length + 3 ) )
-	 || ( narrow_string_compare(
-	       path,
-	       qcowmount_fuse_path_prefix,
-	       qcowmount_fuse_path_prefix_length ) != 0 ) )
+	result = qcowmount_fuse_get_layer_from_path(
+	          path,
+	          path_length,
+	          &input_file_index,
+	          &layer_type,
+	          &layer_index,
+	          &error );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported path: %s.",
+		 function,
+		 path );
+
+		result = -ENOENT;
+
+		goto on_error;
+	}
+	/* The fuse loop can run multiple threads, hence the read must not
+	 * depend on the current offset of the input file
+	 */
+	read_count = mount_handle_read_layer_buffer_at_offset(
+	              qcowmount_mount_handle,
+	              input_file_index,
+	              layer_type,
+	              layer_index,
+	              (uint8_t *) buffer,
+	              size,
+	              (off64_t) offset,
+	              &error );
+
+	if( read_count == -1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read from mount handle.",
+		 function );
+
+		result = -EIO;
+
+		goto on_error;
+	}
+	return( (int) read_count );
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	return( result );
+}
+
+/* Writes a buffer of data at the specified offset
+ * The data is written to the scratch overlay of the input file
+ * Returns number of bytes written if successful or a negative errno value otherwise
+ */
+int qcowmount_fuse_write(
+     const char *path,
+     const char *buffer,
+     size_t size,
+     off_t offset,
+     struct fuse_file_info *file_info )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcowmount_fuse_write";
+	size_t path_length       = 0;
+	ssize_t write_count      = 0;
+	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
+	int result               = 0;
+
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	if( size > (size_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	if( file_info == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file info.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	path_length = narrow_string_length(
+	               path );
+
+	result = qcowmount_fuse_get_layer_from_path(
+	          path,
+	          path_length,
+	          &input_file_index,
+	          &layer_type,
+	          &layer_index,
+	          &error );
+
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported path: %s.",
+		 function,
+		 path );
+
+		result = -ENOENT;
+
+		goto on_error;
+	}
+	if( layer_type != MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: write access currently not supported.",
+		 function );
+
+		result = -EACCES;
+
+		goto on_error;
+	}
+	write_count = mount_handle_write_buffer_at_offset(
+	               qcowmount_mount_handle,
+	               input_file_index,
+	               (const uint8_t *) buffer,
+	               size,
+	               (off64_t) offset,
+	               &error );
+
+	if( write_count == -1 )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write to mount handle.",
+		 function );
+
+		result = -EIO;
+
+		goto on_error;
+	}
+	/* Writes beyond the end of the media data are not supported
+	 */
+	if( ( write_count == 0 )
+	 && ( size != 0 ) )
+	{
+		result = -ENOSPC;
+
+		goto on_error;
+	}
+	return( (int) write_count );
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	return( result );
+}
+
+#if defined( HAVE_QCOWMOUNT_FUSE_READ_BUF )
+
+/* Reads a buffer of data at the specified offset into a buffer vector
+ * Data that is stored as-is in the image file is passed as a file descriptor,
+ * which allows fuse to splice it instead of copying it
+ * Returns 0 if successful or a negative errno value otherwise
+ */
+int qcowmount_fuse_read_buf(
+     const char *path,
+     struct fuse_bufvec **buffer_vector,
+     size_t size,
+     off_t offset,
+     struct fuse_file_info *file_info )
+{
+	struct fuse_bufvec *safe_buffer_vector = NULL;
+	libcerror_error_t *error               = NULL;
+	uint8_t *buffer                        = NULL;
+	static char *function                  = "qcowmount_fuse_read_buf";
+	size_t file_data_size                  = 0;
+	size_t path_length                     = 0;
+	ssize_t read_count                     = 0;
+	off64_t file_offset                    = 0;
+	int file_descriptor                    = -1;
+	int input_file_index                   = 0;
+	int layer_index                        = 0;
+	int layer_type                         = 0;
+	int result                             = 0;
+
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	if( buffer_vector == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid buffer vector.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	if( size > (size_t) INT_MAX )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid size value exceeds maximum.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	if( file_info == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid file info.",
+		 function );
+
+		result = -EINVAL;
+
+		goto on_error;
+	}
+	path_length = narrow_string_length(
+	               path );
+
+	result = qcowmount_fuse_get_layer_from_path(
+	          path,
+	          path_length,
+	          &input_file_index,
+	          &layer_type,
+	          &layer_index,
+	          &error );
+
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 &error,
@@ -323,65 +968,119 @@ int qcowmount_fuse_read(
 		 function,
 		 path );
 
-		result = -ENOENT;
+		result = -ENOENT;
+
+		goto on_error;
+	}
+	/* Fuse frees the buffer vector and its memory buffer using free()
+	 */
+	safe_buffer_vector = (struct fuse_bufvec *) memory_allocate(
+	                                             sizeof( struct fuse_bufvec ) );
+
+	if( safe_buffer_vector == NULL )
+	{
+		libcerror_error_set(
+		 &error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create buffer vector.",
+		 function );
+
+		result = -ENOMEM;
 
 		goto on_error;
 	}
-	string_index = (int) qcowmount_fuse_path_prefix_length;
-
-	input_file_index = path[ string_index++ ] - '0';
+	*safe_buffer_vector = FUSE_BUFVEC_INIT( 0 );
 
-	if( string_index < (int) path_length )
-	{
-		input_file_index *= 10;
-		input_file_index += path[ string_index++ ] - '0';
+	/* Only the data of the input file is passed as a file descriptor
+	 */
+	if( layer_type == MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE )
+	{
+		result = mount_handle_get_file_data_at_offset(
+		          qcowmount_mount_handle,
+		          input_file_index,
+		          (off64_t) offset,
+		          size,
+		          &file_descriptor,
+		          &file_offset,
+		          &file_data_size,
+		          &error );
 	}
-	if( string_index < (int) path_length )
+	else
 	{
-		input_file_index *= 10;
-		input_file_index += path[ string_index++ ] - '0';
+		result = 0;
 	}
-	input_file_index -= 1;
-
-	if( mount_handle_seek_offset(
-	     qcowmount_mount_handle,
-	     input_file_index,
-	     (off64_t) offset,
-	     SEEK_SET,
-	     &error ) == -1 )
+	if( result == -1 )
 	{
 		libcerror_error_set(
 		 &error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset in mount handle.",
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file data from mount handle.",
 		 function );
 
 		result = -EIO;
 
 		goto on_error;
 	}
-	read_count = mount_handle_read_buffer(
-	              qcowmount_mount_handle,
-	              input_file_index,
-	              (uint8_t *) buffer,
-	              size,
-	              &error );
-
-	if( read_count == -1 )
+	/* Only pass the file descriptor if it provides all the requested data
+	 * since a short read is handled as the end of the file
+	 */
+	if( ( result != 0 )
+	 && ( file_data_size == size ) )
 	{
-		libcerror_error_set(
-		 &error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_READ_FAILED,
-		 "%s: unable to read from mount handle.",
-		 function );
+		safe_buffer_vector->buf[ 0 ].size  = size;
+		safe_buffer_vector->buf[ 0 ].flags = FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK | FUSE_BUF_FD_RETRY;
+		safe_buffer_vector->buf[ 0 ].fd    = file_descriptor;
+		safe_buffer_vector->buf[ 0 ].pos   = (off_t) file_offset;
+	}
+	else
+	{
+		buffer = (uint8_t *) memory_allocate(
+		                      sizeof( uint8_t ) * size );
 
-		result = -EIO;
+		if( buffer == NULL )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create buffer.",
+			 function );
 
-		goto on_error;
+			result = -ENOMEM;
+
+			goto on_error;
+		}
+		read_count = mount_handle_read_layer_buffer_at_offset(
+		              qcowmount_mount_handle,
+		              input_file_index,
+		              layer_type,
+		              layer_index,
+		              buffer,
+		              size,
+		              (off64_t) offset,
+		              &error );
+
+		if( read_count == -1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read from mount handle.",
+			 function );
+
+			result = -EIO;
+
+			goto on_error;
+		}
+		safe_buffer_vector->buf[ 0 ].size = (size_t) read_count;
+		safe_buffer_vector->buf[ 0 ].mem  = buffer;
 	}
-	return( (int) read_count );
+	*buffer_vector = safe_buffer_vector;
+
+	return( 0 );
 
 on_error:
 	if( error != NULL )
@@ -391,9 +1090,21 @@ on_error:
 		libcerror_error_free(
 		 &error );
 	}
+	if( buffer != NULL )
+	{
+		memory_free(
+		 buffer );
+	}
+	if( safe_buffer_vector != NULL )
+	{
+		memory_free(
+		 safe_buffer_vector );
+	}
 	return( result );
 }
 
+#endif /* defined( HAVE_QCOWMOUNT_FUSE_READ_BUF ) */
+
 /* Sets the values in a stat info structure
  * Returns 1 if successful or -1 on error
  */
@@ -482,6 +1193,8 @@ int qcowmount_fuse_filldir(
      struct stat *stat_info,
      mount_handle_t *mount_handle,
      int input_file_index,
+     int layer_type,
+     int layer_index,
      uint8_t use_mount_time,
      libcerror_error_t **error )
 {
@@ -506,9 +1219,11 @@ int qcowmount_fuse_filldir(
 	}
 	else
 	{
-		if( mount_handle_get_media_size(
+		if( mount_handle_get_layer_media_size(
 		     mount_handle,
 		     input_file_index,
+		     layer_type,
+		     layer_index,
 		     &media_size,
 		     error ) != 1 )
 		{
@@ -580,16 +1295,18 @@ int qcowmount_fuse_readdir(
      off_t offset QCOWTOOLS_ATTRIBUTE_UNUSED,
      struct fuse_file_info *file_info QCOWTOOLS_ATTRIBUTE_UNUSED )
 {
-	char qcowmount_fuse_path[ 10 ];
+	char qcowmount_fuse_path[ 32 ];
 
 	libcerror_error_t *error  = NULL;
 	struct stat *stat_info    = NULL;
 	static char *function     = "qcowmount_fuse_readdir";
 	size_t path_length        = 0;
 	int input_file_index      = 0;
+	int layer_index           = 0;
+	int layer_type            = 0;
 	int number_of_input_files = 0;
+	int number_of_layers      = 0;
 	int result                = 0;
-	int string_index          = 0;
 
 	QCOWTOOLS_UNREFERENCED_PARAMETER( offset )
 	QCOWTOOLS_UNREFERENCED_PARAMETER( file_info )
@@ -625,22 +1342,6 @@ int qcowmount_fuse_readdir(
 
 		goto on_error;
 	}
-	if( narrow_string_copy(
-	     qcowmount_fuse_path,
-	     qcowmount_fuse_path_prefix,
-	     qcowmount_fuse_path_prefix_length ) == NULL )
-	{
-		libcerror_error_set(
-		 &error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-		 "%s: unable to copy path prefix.",
-		 function );
-
-		result = -errno;
-
-		goto on_error;
-	}
 	if( mount_handle_get_number_of_input_files(
 	     qcowmount_mount_handle,
 	     &number_of_input_files,
@@ -695,6 +1396,8 @@ int qcowmount_fuse_readdir(
 	     stat_info,
 	     NULL,
 	     -1,
+	     0,
+	     0,
 	     1,
 	     &error ) != 1 )
 	{
@@ -718,6 +1421,8 @@ int qcowmount_fuse_readdir(
 	     NULL,
 	     -1,
 	     0,
+	     0,
+	     0,
 	     &error ) != 1 )
 	{
 		libcerror_error_set(
@@ -731,25 +1436,12 @@ int qcowmount_fuse_readdir(
 
 		goto on_error;
 	}
-	for( input_file_index = 1;
-	     input_file_index <= number_of_input_files;
+	for( input_file_index = 0;
+	     input_file_index < number_of_input_files;
 	     input_file_index++ )
 	{
-		string_index = qcowmount_fuse_path_prefix_length;
-
-		if( input_file_index >= 100 )
-		{
-			qcowmount_fuse_path[ string_index++ ] = '0' + (char) ( input_file_index / 100 );
-		}
-		if( input_file_index >= 10 )
-		{
-			qcowmount_fuse_path[ string_index++ ] = '0' + (char) ( input_file_index / 10 );
-		}
-		qcowmount_fuse_path[ string_index++ ] = '0' + (char) ( input_file_index % 10 );
-		qcowmount_fuse_path[ string_index++ ] = 0;
-
 /* TODO add support for multiple input files ? */
-		if( input_file_index != 1 )
+		if( input_file_index != 0 )
 		{
 			libcerror_error_set(
 			 &error,
@@ -762,27 +1454,77 @@ int qcowmount_fuse_readdir(
 
 			goto on_error;
 		}
-		if( qcowmount_fuse_filldir(
-		     buffer,
-		     filler,
-		     &( qcowmount_fuse_path[ 1 ] ),
-		     string_index - 1,
-		     stat_info,
-		     qcowmount_mount_handle,
-		     input_file_index - 1,
-		     1,
-		     &error ) != 1 )
+		for( layer_type = MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE;
+		     layer_type <= MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE;
+		     layer_type++ )
 		{
-			libcerror_error_set(
-			 &error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-			 "%s: unable to set directory entry.",
-			 function );
+			if( mount_handle_get_number_of_layers(
+			     qcowmount_mount_handle,
+			     input_file_index,
+			     layer_type,
+			     &number_of_layers,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve number of layers.",
+				 function );
 
-			result = -EIO;
+				result = -EIO;
 
-			goto on_error;
+				goto on_error;
+			}
+			for( layer_index = 0;
+			     layer_index < number_of_layers;
+			     layer_index++ )
+			{
+				if( qcowmount_fuse_set_layer_path(
+				     qcowmount_fuse_path,
+				     32,
+				     input_file_index,
+				     layer_type,
+				     layer_index,
+				     &path_length,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set layer path.",
+					 function );
+
+					result = -EIO;
+
+					goto on_error;
+				}
+				if( qcowmount_fuse_filldir(
+				     buffer,
+				     filler,
+				     &( qcowmount_fuse_path[ 1 ] ),
+				     path_length,
+				     stat_info,
+				     qcowmount_mount_handle,
+				     input_file_index,
+				     layer_type,
+				     layer_index,
+				     1,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set directory entry.",
+					 function );
+
+					result = -EIO;
+
+					goto on_error;
+				}
+			}
 		}
 	}
 	memory_free(
@@ -818,9 +1560,11 @@ int qcowmount_fuse_getattr(
 	size64_t media_size      = 0;
 	size_t path_length       = 0;
 	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
+	int number_of_layers     = 0;
 	int number_of_sub_items  = 0;
 	int result               = -ENOENT;
-	int string_index         = 0;
 	uint8_t use_mount_time   = 0;
 
 	if( path == NULL )
@@ -877,30 +1621,35 @@ int qcowmount_fuse_getattr(
 			result              = 0;
 		}
 	}
-	else if( ( path_length > qcowmount_fuse_path_prefix_length )
-	      && ( path_length <= ( qcowmount_fuse_path_prefix_length + 3 ) ) )
+	else
 	{
-		if( narrow_string_compare(
-		     path,
-		     qcowmount_fuse_path_prefix,
-		     qcowmount_fuse_path_prefix_length ) == 0 )
-		{
-			string_index = qcowmount_fuse_path_prefix_length;
+		result = qcowmount_fuse_get_layer_from_path(
+		          path,
+		          path_length,
+		          &input_file_index,
+		          &layer_type,
+		          &layer_index,
+		          &error );
 
-			input_file_index = path[ string_index++ ] - '0';
+		if( result == -1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to determine layer from path.",
+			 function );
 
-			if( string_index < (int) path_length )
-			{
-				input_file_index *= 10;
-				input_file_index += path[ string_index++ ] - '0';
-			}
-			if( string_index < (int) path_length )
-			{
-				input_file_index *= 10;
-				input_file_index += path[ string_index++ ] - '0';
-			}
-			input_file_index -= 1;
+			result = -EIO;
 
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			result = -ENOENT;
+		}
+		else
+		{
 /* TODO add support for multiple input files ? */
 			if( input_file_index != 0 )
 			{
@@ -915,104 +1664,420 @@ int qcowmount_fuse_getattr(
 
 				goto on_error;
 			}
-			if( mount_handle_get_media_size(
+			if( mount_handle_get_number_of_layers(
 			     qcowmount_mount_handle,
 			     input_file_index,
-			     &media_size,
+			     layer_type,
+			     &number_of_layers,
 			     &error ) != 1 )
 			{
 				libcerror_error_set(
 				 &error,
 				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
 				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
-				 "%s: unable to retrieve media size.",
+				 "%s: unable to retrieve number of layers.",
 				 function );
 
 				result = -EIO;
 
-				goto on_error;
-			}
-			use_mount_time = 1;
-			result         = 0;
+				goto on_error;
+			}
+			if( layer_index >= number_of_layers )
+			{
+				result = -ENOENT;
+			}
+			else
+			{
+				if( mount_handle_get_layer_media_size(
+				     qcowmount_mount_handle,
+				     input_file_index,
+				     layer_type,
+				     layer_index,
+				     &media_size,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+					 "%s: unable to retrieve media size.",
+					 function );
+
+					result = -EIO;
+
+					goto on_error;
+				}
+				use_mount_time = 1;
+				result         = 0;
+			}
+		}
+	}
+	if( result == 0 )
+	{
+		if( qcowmount_fuse_set_stat_info(
+		     stat_info,
+		     media_size,
+		     number_of_sub_items,
+		     use_mount_time,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set stat info.",
+			 function );
+
+			result = -EIO;
+
+			goto on_error;
+		}
+		if( ( path_length > 1 )
+		 && ( layer_type == MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE )
+		 && ( qcowmount_mount_handle->scratch_overlay_is_set != 0 ) )
+		{
+			stat_info->st_mode |= 0200;
+		}
+	}
+	return( result );
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	return( result );
+}
+
+/* Cleans up when fuse is done
+ */
+void qcowmount_fuse_destroy(
+      void *private_data QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcowmount_fuse_destroy";
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( private_data )
+
+	if( qcowmount_mount_handle != NULL )
+	{
+		if( mount_handle_free(
+		     &qcowmount_mount_handle,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free mount handle.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	return;
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	return;
+}
+
+#elif defined( HAVE_LIBDOKAN )
+
+static wchar_t *qcowmount_dokan_path_prefix      = L"\\QCOW";
+static size_t qcowmount_dokan_path_prefix_length = 5;
+
+static wchar_t *qcowmount_dokan_snapshot_suffix      = L".SNAPSHOT";
+static size_t qcowmount_dokan_snapshot_suffix_length = 9;
+
+static wchar_t *qcowmount_dokan_backing_suffix       = L".BACKING";
+static size_t qcowmount_dokan_backing_suffix_length  = 8;
+
+/* Determines the input file and layer of a path
+ * The path is the prefix followed by the 1-based index of the input file
+ * and optionally a layer suffix followed by the 1-based index of the layer
+ * Returns 1 if successful, 0 if the path is not supported or -1 on error
+ */
+int qcowmount_dokan_get_layer_from_path(
+     const wchar_t *path,
+     size_t path_length,
+     int *input_file_index,
+     int *layer_type,
+     int *layer_index,
+     libcerror_error_t **error )
+{
+	static char *function = "qcowmount_dokan_get_layer_from_path";
+	size_t string_index   = 0;
+	int number_of_digits  = 0;
+	int value             = 0;
+
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
+
+		return( -1 );
+	}
+	if( input_file_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid input file index.",
+		 function );
+
+		return( -1 );
+	}
+	if( layer_type == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layer type.",
+		 function );
+
+		return( -1 );
+	}
+	if( layer_index == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layer index.",
+		 function );
+
+		return( -1 );
+	}
+	if( ( path_length <= qcowmount_dokan_path_prefix_length )
+	 || ( wide_string_compare(
+	       path,
+	       qcowmount_dokan_path_prefix,
+	       qcowmount_dokan_path_prefix_length ) != 0 ) )
+	{
+		return( 0 );
+	}
+	string_index = qcowmount_dokan_path_prefix_length;
+
+	for( number_of_digits = 0;
+	     number_of_digits < 3;
+	     number_of_digits++ )
+	{
+		if( ( string_index >= path_length )
+		 || ( path[ string_index ] < (wchar_t) '0' )
+		 || ( path[ string_index ] > (wchar_t) '9' ) )
+		{
+			break;
 		}
+		value *= 10;
+		value += path[ string_index++ ] - (wchar_t) '0';
 	}
-	if( result == 0 )
+	if( value == 0 )
 	{
-		if( qcowmount_fuse_set_stat_info(
-		     stat_info,
-		     media_size,
-		     number_of_sub_items,
-		     use_mount_time,
-		     &error ) != 1 )
-		{
-			libcerror_error_set(
-			 &error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-			 "%s: unable to set stat info.",
-			 function );
+		return( 0 );
+	}
+	*input_file_index = value - 1;
 
-			result = -EIO;
+	if( string_index == path_length )
+	{
+		*layer_type  = MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE;
+		*layer_index = 0;
 
-			goto on_error;
-		}
+		return( 1 );
 	}
-	return( result );
+	if( ( ( path_length - string_index ) > qcowmount_dokan_snapshot_suffix_length )
+	 && ( wide_string_compare(
+	       &( path[ string_index ] ),
+	       qcowmount_dokan_snapshot_suffix,
+	       qcowmount_dokan_snapshot_suffix_length ) == 0 ) )
+	{
+		*layer_type   = MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT;
+		string_index += qcowmount_dokan_snapshot_suffix_length;
+	}
+	else if( ( ( path_length - string_index ) > qcowmount_dokan_backing_suffix_length )
+	      && ( wide_string_compare(
+	            &( path[ string_index ] ),
+	            qcowmount_dokan_backing_suffix,
+	            qcowmount_dokan_backing_suffix_length ) == 0 ) )
+	{
+		*layer_type   = MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE;
+		string_index += qcowmount_dokan_backing_suffix_length;
+	}
+	else
+	{
+		return( 0 );
+	}
+	value = 0;
 
-on_error:
-	if( error != NULL )
+	for( number_of_digits = 0;
+	     number_of_digits < 3;
+	     number_of_digits++ )
 	{
-		libcnotify_print_error_backtrace(
-		 error );
-		libcerror_error_free(
-		 &error );
+		if( ( string_index >= path_length )
+		 || ( path[ string_index ] < (wchar_t) '0' )
+		 || ( path[ string_index ] > (wchar_t) '9' ) )
+		{
+			break;
+		}
+		value *= 10;
+		value += path[ string_index++ ] - (wchar_t) '0';
 	}
-	return( result );
+	if( ( value == 0 )
+	 || ( string_index != path_length ) )
+	{
+		return( 0 );
+	}
+	*layer_index = value - 1;
+
+	return( 1 );
 }
 
-/* Cleans up when fuse is done
+/* Sets the path of a layer of an input file
+ * Returns 1 if successful or -1 on error
  */
-void qcowmount_fuse_destroy(
-      void *private_data QCOWTOOLS_ATTRIBUTE_UNUSED )
+int qcowmount_dokan_set_layer_path(
+     wchar_t *path,
+     size_t path_size,
+     int input_file_index,
+     int layer_type,
+     int layer_index,
+     size_t *path_length,
+     libcerror_error_t **error )
 {
-	libcerror_error_t *error = NULL;
-	static char *function    = "qcowmount_fuse_destroy";
+	static char *function = "qcowmount_dokan_set_layer_path";
+	int print_count       = 0;
 
-	QCOWTOOLS_UNREFERENCED_PARAMETER( private_data )
+	if( path == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path.",
+		 function );
 
-	if( qcowmount_mount_handle != NULL )
+		return( -1 );
+	}
+	if( path_size > (size_t) INT_MAX )
 	{
-		if( mount_handle_free(
-		     &qcowmount_mount_handle,
-		     &error ) != 1 )
-		{
-			libcerror_error_set(
-			 &error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
-			 "%s: unable to free mount handle.",
-			 function );
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_EXCEEDS_MAXIMUM,
+		 "%s: invalid path size value exceeds maximum.",
+		 function );
 
-			goto on_error;
-		}
+		return( -1 );
 	}
-	return;
+	if( path_length == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid path length.",
+		 function );
 
-on_error:
-	if( error != NULL )
+		return( -1 );
+	}
+	if( ( input_file_index < 0 )
+	 || ( input_file_index >= 999 ) )
 	{
-		libcnotify_print_error_backtrace(
-		 error );
-		libcerror_error_free(
-		 &error );
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid input file index value out of bounds.",
+		 function );
+
+		return( -1 );
 	}
-	return;
-}
+	if( ( layer_index < 0 )
+	 || ( layer_index >= 999 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid layer index value out of bounds.",
+		 function );
 
-#elif defined( HAVE_LIBDOKAN )
+		return( -1 );
+	}
+	switch( layer_type )
+	{
+		case MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE:
+			print_count = wide_string_snwprintf(
+			               path,
+			               path_size,
+			               L"%ls%d",
+			               qcowmount_dokan_path_prefix,
+			               input_file_index + 1 );
+			break;
 
-static wchar_t *qcowmount_dokan_path_prefix      = L"\\QCOW";
-static size_t qcowmount_dokan_path_prefix_length = 5;
+		case MOUNT_HANDLE_LAYER_TYPE_SNAPSHOT:
+			print_count = wide_string_snwprintf(
+			               path,
+			               path_size,
+			               L"%ls%d%ls%d",
+			               qcowmount_dokan_path_prefix,
+			               input_file_index + 1,
+			               qcowmount_dokan_snapshot_suffix,
+			               layer_index + 1 );
+			break;
+
+		case MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE:
+			print_count = wide_string_snwprintf(
+			               path,
+			               path_size,
+			               L"%ls%d%ls%d",
+			               qcowmount_dokan_path_prefix,
+			               input_file_index + 1,
+			               qcowmount_dokan_backing_suffix,
+			               layer_index + 1 );
+			break;
+
+		default:
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported layer type.",
+			 function );
+
+			return( -1 );
+	}
+	if( ( print_count < 0 )
+	 || ( (size_t) print_count >= path_size ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set path.",
+		 function );
+
+		return( -1 );
+	}
+	*path_length = (size_t) print_count;
+
+	return( 1 );
+}
 
 /* Opens a file or directory
  * Returns 0 if successful or a negative error code otherwise
@@ -1028,6 +2093,9 @@ int __stdcall qcowmount_dokan_CreateFile(
 	libcerror_error_t *error = NULL;
 	static char *function    = "qcowmount_dokan_CreateFile";
 	size_t path_length       = 0;
+	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
 	int result               = 0;
 
 	QCOWTOOLS_UNREFERENCED_PARAMETER( share_mode )
@@ -1116,12 +2184,15 @@ int __stdcall qcowmount_dokan_CreateFile(
 	}
 	else
 	{
-		if( ( path_length <= qcowmount_dokan_path_prefix_length )
-		 || ( path_length > ( qcowmount_dokan_path_prefix_length + 3 ) )
-		 || ( wide_string_compare(
-		       path,
-		       qcowmount_dokan_path_prefix,
-		       qcowmount_dokan_path_prefix_length ) != 0 ) )
+		result = qcowmount_dokan_get_layer_from_path(
+		          path,
+		          path_length,
+		          &input_file_index,
+		          &layer_type,
+		          &layer_index,
+		          &error );
+
+		if( result != 1 )
 		{
 			libcerror_error_set(
 			 &error,
@@ -1262,8 +2333,9 @@ int __stdcall qcowmount_dokan_ReadFile(
 	size_t path_length       = 0;
 	ssize_t read_count       = 0;
 	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
 	int result               = 0;
-	int string_index         = 0;
 
 	QCOWTOOLS_UNREFERENCED_PARAMETER( file_info )
 
@@ -1309,12 +2381,15 @@ int __stdcall qcowmount_dokan_ReadFile(
 	path_length = wide_string_length(
 	               path );
 
-	if( ( path_length <= qcowmount_dokan_path_prefix_length )
-         || ( path_length > ( qcowmount_dokan_path_prefix_length + 3 ) )
-	 || ( wide_string_compare(
-	       path,
-	       qcowmount_dokan_path_prefix,
-	       qcowmount_dokan_path_prefix_length ) != 0 ) )
+	result = qcowmount_dokan_get_layer_from_path(
+	          path,
+	          path_length,
+	          &input_file_index,
+	          &layer_type,
+	          &layer_index,
+	          &error );
+
+	if( result != 1 )
 	{
 		libcerror_error_set(
 		 &error,
@@ -1328,45 +2403,14 @@ int __stdcall qcowmount_dokan_ReadFile(
 
 		goto on_error;
 	}
-	string_index = (int) qcowmount_dokan_path_prefix_length;
-
-	input_file_index = path[ string_index++ ] - (wchar_t) '0';
-
-	if( string_index < (int) path_length )
-	{
-		input_file_index *= 10;
-		input_file_index += path[ string_index++ ] - (wchar_t) '0';
-	}
-	if( string_index < (int) path_length )
-	{
-		input_file_index *= 10;
-		input_file_index += path[ string_index++ ] - (wchar_t) '0';
-	}
-	input_file_index -= 1;
-
-	if( mount_handle_seek_offset(
-	     qcowmount_mount_handle,
-	     input_file_index,
-	     (off64_t) offset,
-	     SEEK_SET,
-	     &error ) == -1 )
-	{
-		libcerror_error_set(
-		 &error,
-		 LIBCERROR_ERROR_DOMAIN_IO,
-		 LIBCERROR_IO_ERROR_SEEK_FAILED,
-		 "%s: unable to seek offset in mount handle.",
-		 function );
-
-		result = -ERROR_SEEK_ON_DEVICE;
-
-		goto on_error;
-	}
-	read_count = mount_handle_read_buffer(
+	read_count = mount_handle_read_layer_buffer_at_offset(
 		      qcowmount_mount_handle,
 		      input_file_index,
+		      layer_type,
+		      layer_index,
 		      (uint8_t *) buffer,
 		      (size_t) number_of_bytes_to_read,
+		      (off64_t) offset,
 		      &error );
 
 	if( read_count == -1 )
@@ -1465,6 +2509,8 @@ int qcowmount_dokan_filldir(
      WIN32_FIND_DATAW *find_data,
      mount_handle_t *mount_handle,
      int input_file_index,
+     int layer_type,
+     int layer_index,
      uint8_t use_mount_time,
      libcerror_error_t **error )
 {
@@ -1511,9 +2557,11 @@ int qcowmount_dokan_filldir(
 	}
 	else
 	{
-		if( mount_handle_get_media_size(
+		if( mount_handle_get_layer_media_size(
 		     mount_handle,
 		     input_file_index,
+		     layer_type,
+		     layer_index,
 		     &media_size,
 		     error ) != 1 )
 		{
@@ -1614,15 +2662,17 @@ int __stdcall qcowmount_dokan_FindFiles(
 {
 	WIN32_FIND_DATAW find_data;
 
-	wchar_t qcowmount_dokan_path[ 10 ];
+	wchar_t qcowmount_dokan_path[ 32 ];
 
 	libcerror_error_t *error  = NULL;
 	static char *function     = "qcowmount_dokan_FindFiles";
 	size_t path_length        = 0;
 	int input_file_index      = 0;
+	int layer_index           = 0;
+	int layer_type            = 0;
 	int number_of_input_files = 0;
+	int number_of_layers      = 0;
 	int result                = 0;
-	int string_index          = 0;
 
 	if( path == NULL )
 	{
@@ -1655,22 +2705,6 @@ int __stdcall qcowmount_dokan_FindFiles(
 
 		goto on_error;
 	}
-	if( wide_string_copy(
-	     qcowmount_dokan_path,
-	     qcowmount_dokan_path_prefix,
-	     qcowmount_dokan_path_prefix_length ) == NULL )
-	{
-		libcerror_error_set(
-		 &error,
-		 LIBCERROR_ERROR_DOMAIN_MEMORY,
-		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
-		 "%s: unable to copy path prefix.",
-		 function );
-
-		result = -ERROR_GEN_FAILURE;
-
-		goto on_error;
-	}
 	if( mount_handle_get_number_of_input_files(
 	     qcowmount_mount_handle,
 	     &number_of_input_files,
@@ -1709,6 +2743,8 @@ int __stdcall qcowmount_dokan_FindFiles(
 	     &find_data,
 	     NULL,
 	     -1,
+	     0,
+	     0,
 	     1,
 	     &error ) != 1 )
 	{
@@ -1732,6 +2768,8 @@ int __stdcall qcowmount_dokan_FindFiles(
 	     NULL,
 	     -1,
 	     0,
+	     0,
+	     0,
 	     &error ) != 1 )
 	{
 		libcerror_error_set(
@@ -1745,25 +2783,12 @@ int __stdcall qcowmount_dokan_FindFiles(
 
 		goto on_error;
 	}
-	for( input_file_index = 1;
-	     input_file_index <= number_of_input_files;
+	for( input_file_index = 0;
+	     input_file_index < number_of_input_files;
 	     input_file_index++ )
 	{
-		string_index = (int) qcowmount_dokan_path_prefix_length;
-
-		if( input_file_index >= 100 )
-		{
-			qcowmount_dokan_path[ string_index++ ] = (wchar_t) ( '0' + ( input_file_index / 100 ) );
-		}
-		if( input_file_index >= 10 )
-		{
-			qcowmount_dokan_path[ string_index++ ] = (wchar_t) ( '0' + ( input_file_index / 10 ) );
-		}
-		qcowmount_dokan_path[ string_index++ ] = (wchar_t) ( '0' + ( input_file_index % 10 ) );
-		qcowmount_dokan_path[ string_index++ ] = 0;
-
 /* TODO add support for multiple input files ? */
-		if( input_file_index != 1 )
+		if( input_file_index != 0 )
 		{
 			libcerror_error_set(
 			 &error,
@@ -1776,27 +2801,77 @@ int __stdcall qcowmount_dokan_FindFiles(
 
 			goto on_error;
 		}
-		if( qcowmount_dokan_filldir(
-		     fill_find_data,
-		     file_info,
-		     &( qcowmount_dokan_path[ 1 ] ),
-		     string_index - 1,
-		     &find_data,
-		     qcowmount_mount_handle,
-		     input_file_index - 1,
-		     1,
-		     &error ) != 1 )
+		for( layer_type = MOUNT_HANDLE_LAYER_TYPE_INPUT_FILE;
+		     layer_type <= MOUNT_HANDLE_LAYER_TYPE_BACKING_FILE;
+		     layer_type++ )
 		{
-			libcerror_error_set(
-			 &error,
-			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
-			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
-			 "%s: unable to set find data.",
-			 function );
+			if( mount_handle_get_number_of_layers(
+			     qcowmount_mount_handle,
+			     input_file_index,
+			     layer_type,
+			     &number_of_layers,
+			     &error ) != 1 )
+			{
+				libcerror_error_set(
+				 &error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+				 "%s: unable to retrieve number of layers.",
+				 function );
 
-			result = -ERROR_GEN_FAILURE;
+				result = -ERROR_GEN_FAILURE;
 
-			goto on_error;
+				goto on_error;
+			}
+			for( layer_index = 0;
+			     layer_index < number_of_layers;
+			     layer_index++ )
+			{
+				if( qcowmount_dokan_set_layer_path(
+				     qcowmount_dokan_path,
+				     32,
+				     input_file_index,
+				     layer_type,
+				     layer_index,
+				     &path_length,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set layer path.",
+					 function );
+
+					result = -ERROR_GEN_FAILURE;
+
+					goto on_error;
+				}
+				if( qcowmount_dokan_filldir(
+				     fill_find_data,
+				     file_info,
+				     &( qcowmount_dokan_path[ 1 ] ),
+				     path_length,
+				     &find_data,
+				     qcowmount_mount_handle,
+				     input_file_index,
+				     layer_type,
+				     layer_index,
+				     1,
+				     &error ) != 1 )
+				{
+					libcerror_error_set(
+					 &error,
+					 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+					 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+					 "%s: unable to set find data.",
+					 function );
+
+					result = -ERROR_GEN_FAILURE;
+
+					goto on_error;
+				}
+			}
 		}
 	}
 	return( 0 );
@@ -1867,9 +2942,11 @@ int __stdcall qcowmount_dokan_GetFileInformation(
 	size64_t media_size      = 0;
 	size_t path_length       = 0;
 	int input_file_index     = 0;
+	int layer_index          = 0;
+	int layer_type           = 0;
+	int number_of_layers     = 0;
 	int number_of_sub_items  = 0;
 	int result               = 0;
-	int string_index         = 0;
 	uint8_t use_mount_time   = 0;
 
 	if( path == NULL )
@@ -1922,12 +2999,15 @@ int __stdcall qcowmount_dokan_GetFileInformation(
 	}
 	else
 	{
-		if( ( path_length <= qcowmount_dokan_path_prefix_length )
-		 || ( path_length > ( qcowmount_dokan_path_prefix_length + 3 ) )
-		 || ( wide_string_compare(
-		       path,
-		       qcowmount_dokan_path_prefix,
-		       qcowmount_dokan_path_prefix_length ) != 0 ) )
+		result = qcowmount_dokan_get_layer_from_path(
+		          path,
+		          path_length,
+		          &input_file_index,
+		          &layer_type,
+		          &layer_index,
+		          &error );
+
+		if( result != 1 )
 		{
 			libcerror_error_set(
 			 &error,
@@ -1941,22 +3021,6 @@ int __stdcall qcowmount_dokan_GetFileInformation(
 
 			goto on_error;
 		}
-		string_index = (int) qcowmount_dokan_path_prefix_length;
-
-		input_file_index = path[ string_index++ ] - (wchar_t) '0';
-
-		if( string_index < (int) path_length )
-		{
-			input_file_index *= 10;
-			input_file_index += path[ string_index++ ] - (wchar_t) '0';
-		}
-		if( string_index < (int) path_length )
-		{
-			input_file_index *= 10;
-			input_file_index += path[ string_index++ ] - (wchar_t) '0';
-		}
-		input_file_index -= 1;
-
 /* TODO add support for multiple input files ? */
 		if( input_file_index != 0 )
 		{
@@ -1971,9 +3035,43 @@ int __stdcall qcowmount_dokan_GetFileInformation(
 
 			goto on_error;
 		}
-		if( mount_handle_get_media_size(
+		if( mount_handle_get_number_of_layers(
+		     qcowmount_mount_handle,
+		     input_file_index,
+		     layer_type,
+		     &number_of_layers,
+		     &error ) != 1 )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+			 "%s: unable to retrieve number of layers.",
+			 function );
+
+			result = -ERROR_GEN_FAILURE;
+
+			goto on_error;
+		}
+		if( layer_index >= number_of_layers )
+		{
+			libcerror_error_set(
+			 &error,
+			 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+			 LIBCERROR_ARGUMENT_ERROR_UNSUPPORTED_VALUE,
+			 "%s: unsupported path: %ls.",
+			 function,
+			 path );
+
+			result = -ERROR_FILE_NOT_FOUND;
+
+			goto on_error;
+		}
+		if( mount_handle_get_layer_media_size(
 		     qcowmount_mount_handle,
 		     input_file_index,
+		     layer_type,
+		     layer_index,
 		     &media_size,
 		     &error ) != 1 )
 		{
@@ -2139,25 +3237,41 @@ int main( int argc, char * const argv[] )
 {
 	libqcow_error_t *error                      = NULL;
 	system_character_t *mount_point             = NULL;
+	system_character_t *option_benchmark        = NULL;
+	system_character_t *option_cache_limits     = NULL;
+	system_character_t *option_duration         = NULL;
 	system_character_t *option_extended_options = NULL;
 	system_character_t *option_keys             = NULL;
+	system_character_t *option_page_cache       = NULL;
 	system_character_t *option_password         = NULL;
+	system_character_t *option_read_size        = NULL;
+	system_character_t *option_request_threads  = NULL;
+	system_character_t *option_scratch_overlay  = NULL;
+	system_character_t *option_worker_threads   = NULL;
 	system_character_t *source                  = NULL;
 	char *program                               = "qcowmount";
 	system_integer_t option                     = 0;
 	int result                                  = 0;
+	int single_threaded                         = 0;
 	int verbose                                 = 0;
 
 #if defined( HAVE_LIBFUSE ) || defined( HAVE_LIBOSXFUSE )
 	struct fuse_operations qcowmount_fuse_operations;
 
+	char qcowmount_fuse_options[ 128 ];
+
 	struct fuse_args qcowmount_fuse_arguments   = FUSE_ARGS_INIT(0, NULL);
 	struct fuse_chan *qcowmount_fuse_channel    = NULL;
 	struct fuse *qcowmount_fuse_handle          = NULL;
+	size_t qcowmount_fuse_options_length        = 0;
+	size_t string_index                         = 0;
 
 #elif defined( HAVE_LIBDOKAN )
 	DOKAN_OPERATIONS qcowmount_dokan_operations;
 	DOKAN_OPTIONS qcowmount_dokan_options;
+
+	size_t string_index                         = 0;
+	uint64_t value_64bit                        = 0;
 #endif
 
 	libcnotify_stream_set(
@@ -2193,7 +3307,7 @@ int main( int argc, char * const argv[] )
 	while( ( option = qcowtools_getopt(
 	                   argc,
 	                   argv,
-	                   _SYSTEM_STRING( "hk:p:vVX:" ) ) ) != (system_integer_t) -1 )
+	                   _SYSTEM_STRING( "B:c:D:hk:p:P:R:st:T:vVw:X:" ) ) ) != (system_integer_t) -1 )
 	{
 		switch( option )
 		{
@@ -2209,6 +3323,21 @@ int main( int argc, char * const argv[] )
 
 				return( EXIT_FAILURE );
 
+			case (system_integer_t) 'B':
+				option_benchmark = optarg;
+
+				break;
+
+			case (system_integer_t) 'c':
+				option_cache_limits = optarg;
+
+				break;
+
+			case (system_integer_t) 'D':
+				option_duration = optarg;
+
+				break;
+
 			case (system_integer_t) 'h':
 				usage_fprint(
 				 stdout );
@@ -2225,6 +3354,31 @@ int main( int argc, char * const argv[] )
 
 				break;
 
+			case (system_integer_t) 'P':
+				option_page_cache = optarg;
+
+				break;
+
+			case (system_integer_t) 'R':
+				option_read_size = optarg;
+
+				break;
+
+			case (system_integer_t) 's':
+				single_threaded = 1;
+
+				break;
+
+			case (system_integer_t) 't':
+				option_worker_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'T':
+				option_request_threads = optarg;
+
+				break;
+
 			case (system_integer_t) 'v':
 				verbose = 1;
 
@@ -2236,6 +3390,11 @@ int main( int argc, char * const argv[] )
 
 				return( EXIT_SUCCESS );
 
+			case (system_integer_t) 'w':
+				option_scratch_overlay = optarg;
+
+				break;
+
 			case (system_integer_t) 'X':
 				option_extended_options = optarg;
 
@@ -2255,18 +3414,23 @@ int main( int argc, char * const argv[] )
 	}
 	source = argv[ optind++ ];
 
-	if( optind == argc )
+	/* A benchmark does not require a mount point
+	 */
+	if( option_benchmark == NULL )
 	{
-		fprintf(
-		 stderr,
-		 "Missing mount point.\n" );
+		if( optind == argc )
+		{
+			fprintf(
+			 stderr,
+			 "Missing mount point.\n" );
 
-		usage_fprint(
-		 stdout );
+			usage_fprint(
+			 stdout );
 
-		return( EXIT_FAILURE );
+			return( EXIT_FAILURE );
+		}
+		mount_point = argv[ optind ];
 	}
-	mount_point = argv[ optind ];
 
 	libcnotify_verbose_set(
 	 verbose );
@@ -2286,6 +3450,20 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
+	if( option_cache_limits != NULL )
+	{
+		if( mount_handle_set_cache_limits(
+		     qcowmount_mount_handle,
+		     option_cache_limits,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set cache limits.\n" );
+
+			goto on_error;
+		}
+	}
 	if( option_keys != NULL )
 	{
 		if( mount_handle_set_keys(
@@ -2314,6 +3492,34 @@ int main( int argc, char * const argv[] )
 			goto on_error;
 		}
 	}
+	if( option_worker_threads != NULL )
+	{
+		if( mount_handle_set_number_of_worker_threads(
+		     qcowmount_mount_handle,
+		     option_worker_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of worker threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_scratch_overlay != NULL )
+	{
+		if( mount_handle_set_scratch_overlay(
+		     qcowmount_mount_handle,
+		     option_scratch_overlay,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set scratch overlay.\n" );
+
+			goto on_error;
+		}
+	}
 	if( mount_handle_open_input(
 	     qcowmount_mount_handle,
 	     source,
@@ -2325,6 +3531,148 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
+	if( option_benchmark != NULL )
+	{
+		if( benchmark_handle_initialize(
+		     &qcowmount_benchmark_handle,
+		     qcowmount_mount_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to initialize benchmark handle.\n" );
+
+			goto on_error;
+		}
+		if( benchmark_handle_set_pattern(
+		     qcowmount_benchmark_handle,
+		     option_benchmark,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported benchmark pattern.\n" );
+
+			goto on_error;
+		}
+		if( option_duration != NULL )
+		{
+			if( benchmark_handle_set_duration(
+			     qcowmount_benchmark_handle,
+			     option_duration,
+			     &error ) != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unsupported benchmark duration.\n" );
+
+				goto on_error;
+			}
+		}
+		if( option_read_size != NULL )
+		{
+			if( benchmark_handle_set_read_size(
+			     qcowmount_benchmark_handle,
+			     option_read_size,
+			     &error ) != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unsupported read size.\n" );
+
+				goto on_error;
+			}
+		}
+		if( option_request_threads != NULL )
+		{
+			if( benchmark_handle_set_number_of_threads(
+			     qcowmount_benchmark_handle,
+			     option_request_threads,
+			     &error ) != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unsupported number of benchmark threads.\n" );
+
+				goto on_error;
+			}
+		}
+		if( benchmark_handle_set_notify_stream(
+		     qcowmount_benchmark_handle,
+		     stdout,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set notify stream.\n" );
+
+			goto on_error;
+		}
+		if( qcowtools_signal_attach(
+		     qcowmount_signal_handler,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to attach signal handler.\n" );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+		result = benchmark_handle_run(
+		          qcowmount_benchmark_handle,
+		          &error );
+
+		if( result == -1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to run benchmark.\n" );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			fprintf(
+			 stdout,
+			 "Benchmark aborted.\n" );
+		}
+		if( qcowtools_signal_detach(
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to detach signal handler.\n" );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+		if( benchmark_handle_free(
+		     &qcowmount_benchmark_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to free benchmark handle.\n" );
+
+			goto on_error;
+		}
+		if( mount_handle_free(
+		     &qcowmount_mount_handle,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to free mount handle.\n" );
+
+			goto on_error;
+		}
+		return( EXIT_SUCCESS );
+	}
 #if defined( HAVE_LIBFUSE ) || defined( HAVE_LIBOSXFUSE )
 	if( memory_set(
 	     &qcowmount_fuse_operations,
@@ -2337,7 +3685,99 @@ int main( int argc, char * const argv[] )
 
 		goto on_error;
 	}
-	if( option_extended_options != NULL )
+	qcowmount_fuse_options[ 0 ] = 0;
+
+	if( option_read_size != NULL )
+	{
+		for( string_index = 0;
+		     option_read_size[ string_index ] != 0;
+		     string_index++ )
+		{
+			if( ( string_index >= 10 )
+			 || ( option_read_size[ string_index ] < (system_character_t) '0' )
+			 || ( option_read_size[ string_index ] > (system_character_t) '9' ) )
+			{
+				break;
+			}
+		}
+		if( ( string_index == 0 )
+		 || ( option_read_size[ string_index ] != 0 ) )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported read size.\n" );
+
+			goto on_error;
+		}
+		if( narrow_string_snprintf(
+		     qcowmount_fuse_options,
+		     128,
+		     "max_read=%s,max_readahead=%s",
+		     option_read_size,
+		     option_read_size ) < 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set fuse options.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_page_cache != NULL )
+	{
+		qcowmount_fuse_options_length = narrow_string_length(
+		                                 qcowmount_fuse_options );
+
+		if( ( narrow_string_length(
+		       option_page_cache ) == 4 )
+		 && ( narrow_string_compare(
+		       option_page_cache,
+		       "auto",
+		       4 ) == 0 ) )
+		{
+			result = narrow_string_snprintf(
+			          &( qcowmount_fuse_options[ qcowmount_fuse_options_length ] ),
+			          128 - qcowmount_fuse_options_length,
+			          "%sauto_cache",
+			          ( qcowmount_fuse_options_length > 0 ) ? "," : "" );
+		}
+		else if( ( narrow_string_length(
+		            option_page_cache ) == 6 )
+		      && ( narrow_string_compare(
+		            option_page_cache,
+		            "kernel",
+		            6 ) == 0 ) )
+		{
+			result = narrow_string_snprintf(
+			          &( qcowmount_fuse_options[ qcowmount_fuse_options_length ] ),
+			          128 - qcowmount_fuse_options_length,
+			          "%skernel_cache",
+			          ( qcowmount_fuse_options_length > 0 ) ? "," : "" );
+		}
+		else if( ( narrow_string_length(
+		            option_page_cache ) != 4 )
+		      || ( narrow_string_compare(
+		            option_page_cache,
+		            "none",
+		            4 ) != 0 ) )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported page cache.\n" );
+
+			goto on_error;
+		}
+		if( result < 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set fuse options.\n" );
+
+			goto on_error;
+		}
+	}
+	if( ( qcowmount_fuse_options[ 0 ] != 0 )
+	 || ( option_extended_options != NULL ) )
 	{
 		/* This argument is required but ignored
 		 */
@@ -2351,6 +3791,32 @@ int main( int argc, char * const argv[] )
 
 			goto on_error;
 		}
+	}
+	if( qcowmount_fuse_options[ 0 ] != 0 )
+	{
+		if( fuse_opt_add_arg(
+		     &qcowmount_fuse_arguments,
+		     "-o" ) != 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable add fuse arguments.\n" );
+
+			goto on_error;
+		}
+		if( fuse_opt_add_arg(
+		     &qcowmount_fuse_arguments,
+		     qcowmount_fuse_options ) != 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable add fuse arguments.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_extended_options != NULL )
+	{
 		if( fuse_opt_add_arg(
 		     &qcowmount_fuse_arguments,
 		     "-o" ) != 0 )
@@ -2374,10 +3840,15 @@ int main( int argc, char * const argv[] )
 	}
 	qcowmount_fuse_operations.open    = &qcowmount_fuse_open;
 	qcowmount_fuse_operations.read    = &qcowmount_fuse_read;
+	qcowmount_fuse_operations.write   = &qcowmount_fuse_write;
 	qcowmount_fuse_operations.readdir = &qcowmount_fuse_readdir;
 	qcowmount_fuse_operations.getattr = &qcowmount_fuse_getattr;
 	qcowmount_fuse_operations.destroy = &qcowmount_fuse_destroy;
 
+#if defined( HAVE_QCOWMOUNT_FUSE_READ_BUF )
+	qcowmount_fuse_operations.read_buf = &qcowmount_fuse_read_buf;
+#endif
+
 	qcowmount_fuse_channel = fuse_mount(
 	                          mount_point,
 	                          &qcowmount_fuse_arguments );
@@ -2417,8 +3888,16 @@ int main( int argc, char * const argv[] )
 			goto on_error;
 		}
 	}
-	result = fuse_loop(
-	          qcowmount_fuse_handle );
+	if( single_threaded != 0 )
+	{
+		result = fuse_loop(
+		          qcowmount_fuse_handle );
+	}
+	else
+	{
+		result = fuse_loop_mt(
+		          qcowmount_fuse_handle );
+	}
 
 	if( result != 0 )
 	{
@@ -2463,6 +3942,41 @@ int main( int argc, char * const argv[] )
 	qcowmount_dokan_options.ThreadCount = 0;
 	qcowmount_dokan_options.MountPoint  = mount_point;
 
+	/* The reads of the mount handle do not depend on the current offset
+	 * hence the requests can be handled by multiple threads concurrently
+	 */
+	if( option_request_threads != NULL )
+	{
+		for( string_index = 0;
+		     option_request_threads[ string_index ] != 0;
+		     string_index++ )
+		{
+			if( ( string_index >= 5 )
+			 || ( option_request_threads[ string_index ] < (system_character_t) '0' )
+			 || ( option_request_threads[ string_index ] > (system_character_t) '9' ) )
+			{
+				break;
+			}
+			value_64bit *= 10;
+			value_64bit += (uint64_t) ( option_request_threads[ string_index ] - (system_character_t) '0' );
+		}
+		if( ( string_index == 0 )
+		 || ( option_request_threads[ string_index ] != 0 )
+		 || ( value_64bit > (uint64_t) UINT16_MAX ) )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported number of request threads.\n" );
+
+			goto on_error;
+		}
+		qcowmount_dokan_options.ThreadCount = (USHORT) value_64bit;
+	}
+	if( single_threaded != 0 )
+	{
+		qcowmount_dokan_options.ThreadCount = 1;
+	}
+
 	if( verbose != 0 )
 	{
 		qcowmount_dokan_options.Options |= DOKAN_OPTION_STDERR;
@@ -2579,6 +4093,12 @@ on_error:
 	fuse_opt_free_args(
 	 &qcowmount_fuse_arguments );
 #endif
+	if( qcowmount_benchmark_handle != NULL )
+	{
+		benchmark_handle_free(
+		 &qcowmount_benchmark_handle,
+		 NULL );
+	}
 	if( qcowmount_mount_handle != NULL )
 	{
 		mount_handle_free(
@@ -0,0 +1,567 @@
+/*
+ * Exports a QEMU Copy-On-Write (QCOW) image file using the network block device (NBD) protocol
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <system_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#if defined( HAVE_SIGNAL_H )
+#include <signal.h>
+#endif
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "mount_handle.h"
+#include "nbd_handle.h"
+#include "qcowtools_getopt.h"
+#include "qcowtools_libcerror.h"
+#include "qcowtools_libclocale.h"
+#include "qcowtools_libcnotify.h"
+#include "qcowtools_libqcow.h"
+#include "qcowtools_output.h"
+#include "qcowtools_signal.h"
+#include "qcowtools_unused.h"
+
+/* The address, port and export name are passed to the socket functions as narrow strings
+ */
+#if defined( HAVE_NBD_HANDLE_SUPPORT ) && !defined( HAVE_WIDE_SYSTEM_CHARACTER )
+#define HAVE_QCOWNBD_SUPPORT
+#endif
+
+mount_handle_t *qcownbd_mount_handle = NULL;
+nbd_handle_t *qcownbd_nbd_handle     = NULL;
+int qcownbd_abort                    = 0;
+
+/* Prints the executable usage information
+ */
+void usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcownbd to export the QEMU Copy-On-Write (QCOW) image\n"
+	                 "file, read-only, using the network block device (NBD) protocol\n\n" );
+
+	fprintf( stream, "Usage: qcownbd [ -a address ] [ -c cache_limits ] [ -k keys ]\n"
+	                 "               [ -m maximum_connections ] [ -n export_name ]\n"
+	                 "               [ -p password ] [ -P port ] [ -t worker_threads ]\n"
+	                 "               [ -hvV ] qcow_file\n\n" );
+
+	fprintf( stream, "\tqcow_file: the QCOW image file\n\n" );
+
+	fprintf( stream, "\t-a:        the address to listen on, default is 127.0.0.1\n" );
+	fprintf( stream, "\t-c:        the maximum number of cached level 2 tables and cluster\n"
+	                 "\t           blocks formatted as: level2_tables,cluster_blocks\n" );
+	fprintf( stream, "\t-h:        shows this help\n" );
+	fprintf( stream, "\t-k:        the key formatted in base16\n" );
+	fprintf( stream, "\t-m:        the maximum number of connections that are served at\n"
+	                 "\t           the same time, default is %d, all connections share\n"
+	                 "\t           the caches of the image file\n",
+	                 NBD_HANDLE_DEFAULT_MAXIMUM_NUMBER_OF_CONNECTIONS );
+	fprintf( stream, "\t-n:        the export name, by default only the default (empty)\n"
+	                 "\t           export name is accepted\n" );
+	fprintf( stream, "\t-p:        specify the password/passphrase\n" );
+	fprintf( stream, "\t-P:        the port to listen on, default is %s\n",
+	                 NBD_HANDLE_DEFAULT_PORT );
+	fprintf( stream, "\t-t:        the number of worker threads libqcow uses to decompress\n"
+	                 "\t           and decrypt the cluster blocks of a single read, default\n"
+	                 "\t           is 0 which processes them in the requesting thread\n" );
+	fprintf( stream, "\t-v:        verbose output to stderr\n" );
+	fprintf( stream, "\t-V:        print version\n" );
+}
+
+/* Signal handler for qcownbd
+ */
+void qcownbd_signal_handler(
+      qcowtools_signal_t signal QCOWTOOLS_ATTRIBUTE_UNUSED )
+{
+	libcerror_error_t *error = NULL;
+	static char *function    = "qcownbd_signal_handler";
+
+	QCOWTOOLS_UNREFERENCED_PARAMETER( signal )
+
+	qcownbd_abort = 1;
+
+#if defined( HAVE_QCOWNBD_SUPPORT )
+	if( qcownbd_nbd_handle != NULL )
+	{
+		if( nbd_handle_signal_abort(
+		     qcownbd_nbd_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal NBD handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif
+	if( qcownbd_mount_handle != NULL )
+	{
+		if( mount_handle_signal_abort(
+		     qcownbd_mount_handle,
+		     &error ) != 1 )
+		{
+			libcnotify_printf(
+			 "%s: unable to signal mount handle to abort.\n",
+			 function );
+
+			libcnotify_print_error_backtrace(
+			 error );
+			libcerror_error_free(
+			 &error );
+		}
+	}
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain( int argc, wchar_t * const argv[] )
+#else
+int main( int argc, char * const argv[] )
+#endif
+{
+	libqcow_error_t *error                          = NULL;
+	system_character_t *option_address              = NULL;
+	system_character_t *option_cache_limits         = NULL;
+	system_character_t *option_export_name          = NULL;
+	system_character_t *option_keys                 = NULL;
+	system_character_t *option_maximum_connections  = NULL;
+	system_character_t *option_password             = NULL;
+	system_character_t *option_port                 = NULL;
+	system_character_t *option_worker_threads       = NULL;
+	system_character_t *source                      = NULL;
+	char *program                                   = "qcownbd";
+	system_integer_t option                         = 0;
+	size_t string_index                             = 0;
+	int maximum_number_of_connections               = NBD_HANDLE_DEFAULT_MAXIMUM_NUMBER_OF_CONNECTIONS;
+	int verbose                                     = 0;
+
+	libcnotify_stream_set(
+	 stderr,
+	 NULL );
+	libcnotify_verbose_set(
+	 1 );
+
+	if( libclocale_initialize(
+	     "qcowtools",
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize locale values.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_output_initialize(
+	     _IONBF,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize output settings.\n" );
+
+		goto on_error;
+	}
+	qcowoutput_version_fprint(
+	 stdout,
+	 program );
+
+	while( ( option = qcowtools_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "a:c:hk:m:n:p:P:t:vV" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM "\n",
+				 argv[ optind - 1 ] );
+
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'a':
+				option_address = optarg;
+
+				break;
+
+			case (system_integer_t) 'c':
+				option_cache_limits = optarg;
+
+				break;
+
+			case (system_integer_t) 'h':
+				usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'k':
+				option_keys = optarg;
+
+				break;
+
+			case (system_integer_t) 'm':
+				option_maximum_connections = optarg;
+
+				break;
+
+			case (system_integer_t) 'n':
+				option_export_name = optarg;
+
+				break;
+
+			case (system_integer_t) 'p':
+				option_password = optarg;
+
+				break;
+
+			case (system_integer_t) 'P':
+				option_port = optarg;
+
+				break;
+
+			case (system_integer_t) 't':
+				option_worker_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'v':
+				verbose = 1;
+
+				break;
+
+			case (system_integer_t) 'V':
+				qcowoutput_copyright_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	source = argv[ optind ];
+
+	if( option_maximum_connections != NULL )
+	{
+		maximum_number_of_connections = 0;
+
+		for( string_index = 0;
+		     option_maximum_connections[ string_index ] != 0;
+		     string_index++ )
+		{
+			if( ( string_index >= 4 )
+			 || ( option_maximum_connections[ string_index ] < (system_character_t) '0' )
+			 || ( option_maximum_connections[ string_index ] > (system_character_t) '9' ) )
+			{
+				break;
+			}
+			maximum_number_of_connections *= 10;
+			maximum_number_of_connections += (int) ( option_maximum_connections[ string_index ] - (system_character_t) '0' );
+		}
+		if( ( option_maximum_connections[ string_index ] != 0 )
+		 || ( maximum_number_of_connections <= 0 )
+		 || ( maximum_number_of_connections > 1024 ) )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported maximum number of connections.\n" );
+
+			return( EXIT_FAILURE );
+		}
+	}
+	libcnotify_verbose_set(
+	 verbose );
+	libqcow_notify_set_stream(
+	 stderr,
+	 NULL );
+	libqcow_notify_set_verbose(
+	 verbose );
+
+	if( mount_handle_initialize(
+	     &qcownbd_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize mount handle.\n" );
+
+		goto on_error;
+	}
+	if( option_cache_limits != NULL )
+	{
+		if( mount_handle_set_cache_limits(
+		     qcownbd_mount_handle,
+		     option_cache_limits,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set cache limits.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_keys != NULL )
+	{
+		if( mount_handle_set_keys(
+		     qcownbd_mount_handle,
+		     option_keys,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set keys.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_password != NULL )
+	{
+		if( mount_handle_set_password(
+		     qcownbd_mount_handle,
+		     option_password,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set password.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_worker_threads != NULL )
+	{
+		if( mount_handle_set_number_of_worker_threads(
+		     qcownbd_mount_handle,
+		     option_worker_threads,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set number of worker threads.\n" );
+
+			goto on_error;
+		}
+	}
+	if( mount_handle_open_input(
+	     qcownbd_mount_handle,
+	     source,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to open source file.\n" );
+
+		goto on_error;
+	}
+#if defined( HAVE_QCOWNBD_SUPPORT )
+	if( nbd_handle_initialize(
+	     &qcownbd_nbd_handle,
+	     qcownbd_mount_handle,
+	     maximum_number_of_connections,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to initialize NBD handle.\n" );
+
+		goto on_error;
+	}
+	if( option_export_name != NULL )
+	{
+		if( nbd_handle_set_export_name(
+		     qcownbd_nbd_handle,
+		     option_export_name,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to set export name.\n" );
+
+			goto on_error;
+		}
+	}
+	if( option_address == NULL )
+	{
+		option_address = "127.0.0.1";
+	}
+	if( nbd_handle_listen(
+	     qcownbd_nbd_handle,
+	     option_address,
+	     option_port,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to listen for connections.\n" );
+
+		goto on_error;
+	}
+#if defined( HAVE_SIGNAL_H ) && defined( SIGPIPE )
+	/* A client that closes its connection must not terminate the server
+	 */
+	signal(
+	 SIGPIPE,
+	 SIG_IGN );
+#endif
+	if( qcowtools_signal_attach(
+	     qcownbd_signal_handler,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to attach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	fprintf(
+	 stdout,
+	 "Serving: %" PRIs_SYSTEM " on address: %s port: %s\n",
+	 source,
+	 option_address,
+	 ( option_port != NULL ) ? option_port : NBD_HANDLE_DEFAULT_PORT );
+
+	if( nbd_handle_serve(
+	     qcownbd_nbd_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to serve connections.\n" );
+
+		goto on_error;
+	}
+	if( qcowtools_signal_detach(
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to detach signal handler.\n" );
+
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+	if( nbd_handle_free(
+	     &qcownbd_nbd_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free NBD handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_close(
+	     qcownbd_mount_handle,
+	     &error ) != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to close mount handle.\n" );
+
+		goto on_error;
+	}
+	if( mount_handle_free(
+	     &qcownbd_mount_handle,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free mount handle.\n" );
+
+		goto on_error;
+	}
+	return( EXIT_SUCCESS );
+#else
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_address )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_export_name )
+	QCOWTOOLS_UNREFERENCED_PARAMETER( option_port )
+
+	fprintf(
+	 stderr,
+	 "No network block device support.\n" );
+
+	mount_handle_free(
+	 &qcownbd_mount_handle,
+	 NULL );
+
+	return( EXIT_FAILURE );
+#endif
+
+on_error:
+	if( error != NULL )
+	{
+		libcnotify_print_error_backtrace(
+		 error );
+		libcerror_error_free(
+		 &error );
+	}
+#if defined( HAVE_QCOWNBD_SUPPORT )
+	if( qcownbd_nbd_handle != NULL )
+	{
+		nbd_handle_free(
+		 &qcownbd_nbd_handle,
+		 NULL );
+	}
+#endif
+	if( qcownbd_mount_handle != NULL )
+	{
+		mount_handle_free(
+		 &qcownbd_mount_handle,
+		 NULL );
+	}
+	return( EXIT_FAILURE );
+}
+
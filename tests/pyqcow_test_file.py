@@ -21,6 +21,7 @@
 
 import argparse
 import os
+import pickle
 import sys
 import unittest
 
@@ -114,6 +115,44 @@ class FileTypeTests(unittest.TestCase):
     del file_object
     qcow_file.close()
 
+  def test_pickle(self):
+    """Tests the pickle support."""
+    if not unittest.source:
+      return
+
+    qcow_file = pyqcow.file()
+
+    with self.assertRaises(TypeError):
+      pickle.dumps(qcow_file)
+
+    qcow_file.open(unittest.source)
+
+    media_size = qcow_file.get_media_size()
+    data = qcow_file.read_buffer_at_offset(4096, 0)
+
+    pickled_data = pickle.dumps(qcow_file)
+
+    reopened_qcow_file = pickle.loads(pickled_data)
+
+    self.assertEqual(reopened_qcow_file.get_media_size(), media_size)
+    self.assertEqual(reopened_qcow_file.read_buffer_at_offset(4096, 0), data)
+
+    reopened_qcow_file.close()
+
+    qcow_file.close()
+
+    with self.assertRaises(TypeError):
+      pickle.dumps(qcow_file)
+
+    file_object = open(unittest.source, "rb")
+
+    qcow_file.open_file_object(file_object)
+
+    with self.assertRaises(TypeError):
+      pickle.dumps(qcow_file)
+
+    qcow_file.close()
+
   def test_read_buffer(self):
     """Tests the read_buffer function."""
     if not unittest.source:
@@ -212,6 +251,108 @@ class FileTypeTests(unittest.TestCase):
     with self.assertRaises(IOError):
       qcow_file.read_buffer_at_offset(4096, 0)
 
+  def test_read_blocks_into(self):
+    """Tests the read_blocks_into function."""
+    if not unittest.source:
+      return
+
+    qcow_file = pyqcow.file()
+
+    qcow_file.open(unittest.source)
+
+    media_size = qcow_file.get_media_size()
+    number_of_blocks = (media_size + 511) // 512
+
+    block_indices = [number_of_blocks - 1, 0]
+
+    # Test read into a 2-dimensional buffer.
+    array = memoryview(bytearray(2 * 512)).cast("B", (2, 512))
+
+    result = qcow_file.read_blocks_into(array, block_indices)
+    self.assertEqual(result, 2)
+
+    data = qcow_file.read_buffer_at_offset(512, 0)
+    self.assertEqual(array[1].tobytes(), data)
+
+    last_block_size = media_size - ((number_of_blocks - 1) * 512)
+    data = qcow_file.read_buffer_at_offset(
+        last_block_size, (number_of_blocks - 1) * 512)
+    self.assertEqual(
+        array[0].tobytes(), data + b"\x00" * (512 - last_block_size))
+
+    # Test read into a 1-dimensional buffer.
+    buffer_object = bytearray(2 * 512)
+
+    result = qcow_file.read_blocks_into(
+        buffer_object, block_indices, block_size=512)
+    self.assertEqual(result, 2)
+    self.assertEqual(bytes(buffer_object), array.tobytes())
+
+    with self.assertRaises(ValueError):
+      qcow_file.read_blocks_into(buffer_object, block_indices)
+
+    with self.assertRaises(ValueError):
+      qcow_file.read_blocks_into(array, [0, 1, 2])
+
+    with self.assertRaises(BufferError):
+      qcow_file.read_blocks_into(bytes(1024), block_indices, block_size=512)
+
+    qcow_file.close()
+
+  def test_read_many_sequential_access(self):
+    """Tests the read_many function with sequential access."""
+    if not unittest.source:
+      return
+
+    file_object = open(unittest.source, "rb")
+
+    qcow_file = pyqcow.file()
+
+    qcow_file.open_file_object(file_object, sequential_access=True)
+
+    media_size = qcow_file.get_media_size()
+
+    ranges = [(max(media_size - 4096, 0), 4096), (media_size // 2, 4096), (0, 4096)]
+
+    buffers = qcow_file.read_many(ranges)
+    self.assertEqual(len(buffers), 3)
+
+    for (offset, size), data in zip(ranges, buffers):
+      self.assertEqual(data, qcow_file.read_buffer_at_offset(size, offset))
+
+    qcow_file.close()
+
+  def test_blocks(self):
+    """Tests the blocks function."""
+    if not unittest.source:
+      return
+
+    qcow_file = pyqcow.file()
+
+    qcow_file.open(unittest.source)
+
+    media_size = qcow_file.get_media_size()
+    size = min(media_size, 64 * 1024)
+
+    data = qcow_file.read_buffer_at_offset(size, 0)
+
+    batches = list(qcow_file.blocks(4096, 3, size=size))
+
+    self.assertEqual(len(batches), (size + (3 * 4096) - 1) // (3 * 4096))
+
+    batches_data = b"".join(bytes(batch) for batch in batches)
+    self.assertEqual(len(batches_data) % 4096, 0)
+    self.assertEqual(batches_data[:size], data)
+    self.assertEqual(batches_data[size:], b"\x00" * (len(batches_data) - size))
+
+    with self.assertRaises(ValueError):
+      qcow_file.blocks(0, 1)
+
+    with self.assertRaises(ValueError):
+      qcow_file.blocks(4096, 0)
+
+    qcow_file.close()
+
   def test_seek_offset(self):
     """Tests the seek_offset function."""
     if not unittest.source:
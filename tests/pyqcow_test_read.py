@@ -24,6 +24,11 @@ import argparse
 import os
 import sys
 
+try:
+  import asyncio
+except ImportError:
+  asyncio = None
+
 import pyqcow
 
 
@@ -144,6 +149,260 @@ def pyqcow_test_read_buffer_at_offset(
   return result
 
 
+def pyqcow_test_read_buffer_at_offset_into(
+    qcow_file, input_offset, input_size,
+    expected_offset, expected_size):
+  """Tests reading a buffer at a specific offset into a writable buffer."""
+  description = (
+      "Testing reading buffer at offset: {0:d} and size: {1:d} into buffer"
+      "\t").format(input_offset, input_size)
+  print(description, end="")
+
+  error_string = None
+  result = True
+  try:
+    buffer_object = bytearray(4096)
+    buffer_view = memoryview(buffer_object)
+
+    result_size = 0
+    while input_size > 0:
+      read_size = 4096
+      if input_size < read_size:
+        read_size = input_size
+
+      data = qcow_file.read_buffer_at_offset(read_size, input_offset)
+
+      read_count = qcow_file.read_buffer_at_offset_into(
+          buffer_view[:read_size], input_offset)
+
+      if read_count != len(data) or buffer_object[:read_count] != data:
+        error_string = "Mismatch in data at offset: {0:d}".format(
+            input_offset)
+        result = False
+        break
+
+      input_offset += read_count
+      input_size -= read_count
+      result_size += read_count
+
+      if read_count != read_size:
+        break
+
+    if not result:
+      pass
+
+    elif input_offset != expected_offset:
+      error_string = "Unexpected offset: {0:d}".format(input_offset)
+      result = False
+
+    elif result_size != expected_size:
+      error_string = "Unexpected read count: {0:d}".format(result_size)
+      result = False
+
+  except Exception as exception:
+    error_string = str(exception)
+    if expected_offset != -1:
+      result = False
+
+  if not result:
+    print("(FAIL)")
+  else:
+    print("(PASS)")
+
+  if error_string:
+    print(error_string)
+  return result
+
+
+def pyqcow_test_read_many(qcow_file, input_offsets, input_size):
+  """Tests reading buffers at multiple offsets."""
+  description = (
+      "Testing reading {0:d} buffers of size: {1:d} at multiple offsets"
+      "\t").format(len(input_offsets), input_size)
+  print(description, end="")
+
+  error_string = None
+  result = True
+  try:
+    ranges = [(offset, input_size) for offset in input_offsets]
+    expected_data = [
+        qcow_file.read_buffer_at_offset(input_size, offset)
+        for offset in input_offsets]
+
+    data = qcow_file.read_many(ranges)
+    if data != expected_data:
+      error_string = "Mismatch in read many data"
+      result = False
+
+    if result:
+      buffers = [bytearray(input_size) for _ in input_offsets]
+      read_counts = qcow_file.read_many_into(
+          list(zip(buffers, input_offsets)))
+
+      expected_read_counts = [len(buffer) for buffer in expected_data]
+      if read_counts != expected_read_counts:
+        error_string = "Unexpected read counts"
+        result = False
+
+      elif [buffer[:read_count] for buffer, read_count in zip(
+          buffers, read_counts)] != expected_data:
+        error_string = "Mismatch in read many into data"
+        result = False
+
+  except Exception as exception:
+    error_string = str(exception)
+    result = False
+
+  if not result:
+    print("(FAIL)")
+  else:
+    print("(PASS)")
+
+  if error_string:
+    print(error_string)
+  return result
+
+
+def pyqcow_test_extents(qcow_file):
+  """Tests the extents function."""
+  description = "Testing extents:\t"
+  print(description, end="")
+
+  error_string = None
+  result = True
+  try:
+    file_size = qcow_file.media_size
+    extent_types = (
+        pyqcow.extent_types.DATA, pyqcow.extent_types.HOLE,
+        pyqcow.extent_types.ZERO, pyqcow.extent_types.COMPRESSED)
+
+    expected_offset = 0
+    for extent_offset, extent_size, extent_type in qcow_file.extents():
+      if extent_offset != expected_offset or extent_size == 0:
+        error_string = "Unexpected extent at offset: {0:d}".format(
+            extent_offset)
+        result = False
+        break
+
+      if extent_type not in extent_types:
+        error_string = "Unexpected extent type: {0:d}".format(extent_type)
+        result = False
+        break
+
+      expected_offset += extent_size
+
+    if result and expected_offset != file_size:
+      error_string = "Unexpected extents size: {0:d}".format(expected_offset)
+      result = False
+
+    if result:
+      read_offset, _ = divmod(file_size, 7)
+      read_size, _ = divmod(file_size, 2)
+
+      extents = list(qcow_file.extents(offset=read_offset, size=read_size))
+      if read_size > 0 and (
+          not extents or extents[0][0] != read_offset or
+          sum([extent[1] for extent in extents]) != read_size):
+        error_string = "Unexpected extents of range"
+        result = False
+
+  except Exception as exception:
+    error_string = str(exception)
+    result = False
+
+  if not result:
+    print("(FAIL)")
+  else:
+    print("(PASS)")
+
+  if error_string:
+    print(error_string)
+  return result
+
+
+def pyqcow_test_read_async(qcow_file, input_offset, input_size):
+  """Tests reading a buffer at a specific offset and extents asynchronously."""
+  description = (
+      "Testing asynchronous reading buffer at offset: {0:d} and size: {1:d}"
+      "\t").format(input_offset, input_size)
+  print(description, end="")
+
+  if asyncio is None or not hasattr(
+      qcow_file, "read_buffer_at_offset_async"):
+    print("(SKIP)")
+    return True
+
+  error_string = None
+  result = True
+  try:
+    expected_data = qcow_file.read_buffer_at_offset(input_size, input_offset)
+    expected_extents = list(qcow_file.extents())
+
+    loop = asyncio.new_event_loop()
+    result_future = loop.create_future()
+    results = {}
+
+    def _read_extents(extents, extent_list):
+      """Retrieves the extents one awaitable at a time."""
+      try:
+        future = extents.__anext__()
+      except StopAsyncIteration:
+        results["extents"] = extent_list
+        result_future.set_result(True)
+        return
+
+      def _extent_done(future):
+        extent_list.append(future.result())
+        _read_extents(extents, extent_list)
+
+      future.add_done_callback(_extent_done)
+
+    def _into_done(future):
+      results["read_count"] = future.result()
+      _read_extents(qcow_file.extents(), [])
+
+    def _read_done(future):
+      results["data"] = future.result()
+      future = qcow_file.read_buffer_at_offset_into_async(
+          results["buffer"], input_offset)
+      future.add_done_callback(_into_done)
+
+    def _start():
+      results["buffer"] = bytearray(input_size)
+      future = qcow_file.read_buffer_at_offset_async(input_size, input_offset)
+      future.add_done_callback(_read_done)
+
+    loop.call_soon(_start)
+    loop.run_until_complete(result_future)
+    loop.close()
+
+    if results["data"] != expected_data:
+      error_string = "Mismatch in asynchronously read data"
+      result = False
+
+    elif results["read_count"] != len(expected_data) or (
+        results["buffer"][:results["read_count"]] != expected_data):
+      error_string = "Mismatch in asynchronously read into data"
+      result = False
+
+    elif results["extents"] != expected_extents:
+      error_string = "Mismatch in asynchronously retrieved extents"
+      result = False
+
+  except Exception as exception:
+    error_string = str(exception)
+    result = False
+
+  if not result:
+    print("(FAIL)")
+  else:
+    print("(PASS)")
+
+  if error_string:
+    print(error_string)
+  return result
+
+
 def pyqcow_test_read(qcow_file):
   """Tests the read function."""
   file_size = qcow_file.media_size
@@ -231,6 +490,40 @@ def pyqcow_test_read(qcow_file):
       read_offset + read_size, read_size):
     return False
 
+  # Case 4: test buffer at offset read into a writable buffer
+
+  # Test: offset: <file_size / 7> size: <file_size / 2>
+  # Expected result: offset: < ( file_size / 7 ) + ( file_size / 2 ) > size: <file_size / 2>
+  if not pyqcow_test_read_buffer_at_offset_into(
+      qcow_file, read_offset, read_size,
+      read_offset + read_size, read_size):
+    return False
+
+  # Case 5: test buffers at multiple offsets read, including an offset
+  # beyond the media size
+
+  # Test: offsets: <file_size / 3>, 0, <file_size - 1024>, <file_size> size: 4096
+  # Expected result: data equal to the corresponding buffer at offset reads
+  read_offsets = [
+      divmod(file_size, 3)[0], 0, max(file_size - 1024, 0), file_size]
+
+  if not pyqcow_test_read_many(qcow_file, read_offsets, 4096):
+    return False
+
+  # Case 6: test the extents cover the media without reading the data
+
+  if not pyqcow_test_extents(qcow_file):
+    return False
+
+  # Case 7: test asynchronous buffer at offset read and extents
+
+  # Test: offset: <file_size / 7> size: 4096
+  # Expected result: data equal to the buffer at offset read
+  read_offset, _ = divmod(file_size, 7)
+
+  if not pyqcow_test_read_async(qcow_file, read_offset, 4096):
+    return False
+
   return True
 
 
@@ -257,6 +550,41 @@ def pyqcow_test_read_file_object(filename):
   return result
 
 
+class FileObjectWithoutReadinto(object):
+  """File-like object that only provides read, seek and tell."""
+
+  def __init__(self, file_object):
+    """Initializes the file-like object."""
+    super(FileObjectWithoutReadinto, self).__init__()
+    self._file_object = file_object
+
+  def read(self, size):
+    """Reads data."""
+    return self._file_object.read(size)
+
+  def seek(self, offset, whence=os.SEEK_SET):
+    """Seeks an offset."""
+    self._file_object.seek(offset, whence)
+
+  def tell(self):
+    """Retrieves the current offset."""
+    return self._file_object.tell()
+
+
+def pyqcow_test_read_file_object_without_readinto(filename):
+  """Tests the read function with a file-like object without readinto."""
+  file_object = open(filename, "rb")
+  qcow_file = pyqcow.file()
+
+  qcow_file.open_file_object(FileObjectWithoutReadinto(file_object), "r")
+  result = pyqcow_test_read(qcow_file)
+  qcow_file.close()
+
+  file_object.close()
+
+  return result
+
+
 def pyqcow_test_read_file_no_open(filename):
   """Tests the read function with a file without open."""
   description = "Testing read of without open:\t"
@@ -305,6 +633,9 @@ def main():
   if not pyqcow_test_read_file_object(options.source):
     return False
 
+  if not pyqcow_test_read_file_object_without_readinto(options.source):
+    return False
+
   if not pyqcow_test_read_file_no_open(options.source):
     return False
 
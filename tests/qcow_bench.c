@@ -0,0 +1,1159 @@
+/*
+ * Library read path benchmark program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <system_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#if defined( WINAPI )
+#include <windows.h>
+
+#elif defined( HAVE_CLOCK_GETTIME )
+#include <time.h>
+#endif
+
+#include "qcow_test_getopt.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libcthreads.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_unused.h"
+
+#if defined( HAVE_MULTI_THREAD_SUPPORT ) && !defined( HAVE_LOCAL_LIBQCOW )
+#define QCOW_BENCH_HAVE_MULTI_THREAD_SUPPORT
+#endif
+
+/* The default number of reads per thread
+ */
+#define QCOW_BENCH_DEFAULT_NUMBER_OF_READS	4096
+
+/* The maximum number of reads per thread
+ */
+#define QCOW_BENCH_MAXIMUM_NUMBER_OF_READS	( 1024 * 1024 )
+
+/* The maximum number of thread counts that can be benchmarked
+ */
+#define QCOW_BENCH_MAXIMUM_NUMBER_OF_RUNS	16
+
+/* The maximum number of threads
+ */
+#define QCOW_BENCH_MAXIMUM_NUMBER_OF_THREADS	64
+
+enum QCOW_BENCH_WORKLOADS
+{
+	QCOW_BENCH_WORKLOAD_SEQUENTIAL		= 0,
+	QCOW_BENCH_WORKLOAD_RANDOM_4K		= 1,
+	QCOW_BENCH_WORKLOAD_RANDOM_64K		= 2
+};
+
+#define QCOW_BENCH_NUMBER_OF_WORKLOADS		3
+
+static const char *qcow_bench_workload_names[ QCOW_BENCH_NUMBER_OF_WORKLOADS ] = {
+	"sequential",
+	"random-4k",
+	"random-64k" };
+
+static const size_t qcow_bench_workload_read_sizes[ QCOW_BENCH_NUMBER_OF_WORKLOADS ] = {
+	1024 * 1024,
+	4 * 1024,
+	64 * 1024 };
+
+typedef struct qcow_bench_thread_values qcow_bench_thread_values_t;
+
+struct qcow_bench_thread_values
+{
+	/* The file
+	 */
+	libqcow_file_t *file;
+
+	/* The workload
+	 */
+	int workload;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The offset of the range that is read sequentially
+	 */
+	off64_t range_offset;
+
+	/* The size of the range that is read sequentially
+	 */
+	size64_t range_size;
+
+	/* The state of the pseudo random number generator of random reads
+	 */
+	uint64_t random_state;
+
+	/* The number of reads
+	 */
+	int number_of_reads;
+
+	/* The read buffer
+	 */
+	uint8_t *buffer;
+
+	/* The latencies of the reads in nanoseconds
+	 */
+	uint64_t *latencies;
+
+	/* The number of bytes read
+	 */
+	uint64_t bytes_read;
+
+	/* The result
+	 */
+	int result;
+};
+
+/* Prints the executable usage information
+ */
+void qcow_bench_usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcow_bench to measure the read throughput and latencies of libqcow\n\n" );
+
+	fprintf( stream, "Usage: qcow_bench [ -n reads ] [ -p password ] [ -s seed ] [ -t threads ]\n"
+	                 "                  [ -w worker_threads ] [ -h ] source [ source ... ]\n\n" );
+
+	fprintf( stream, "\tsource: a QCOW image file, which can be uncompressed, compressed,\n"
+	                 "\t        encrypted, sparse or have a backing file\n\n" );
+
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-n:     the number of reads per thread, default is %d\n",
+	                 QCOW_BENCH_DEFAULT_NUMBER_OF_READS );
+	fprintf( stream, "\t-p:     specify the password/passphrase\n" );
+	fprintf( stream, "\t-s:     the seed of the random offsets, default is 1\n" );
+	fprintf( stream, "\t-t:     comma separated list of the number of reading threads,\n"
+	                 "\t        default is 1\n" );
+	fprintf( stream, "\t-w:     the number of library worker threads, default is 0\n\n" );
+
+	fprintf( stream, "Every workload: sequential, random-4k and random-64k, is run for every\n"
+	                 "source and number of threads. The results are printed as comma separated\n"
+	                 "values with a header line, the latencies are in nanoseconds\n" );
+}
+
+/* Retrieves a monotonic timestamp in nanoseconds
+ * Returns the timestamp or 0 if not available
+ */
+uint64_t qcow_bench_get_timestamp(
+          void )
+{
+#if defined( WINAPI )
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	if( QueryPerformanceFrequency(
+	     &frequency ) == 0 )
+	{
+		return( 0 );
+	}
+	if( QueryPerformanceCounter(
+	     &counter ) == 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) ( counter.QuadPart / frequency.QuadPart ) * 1000000000UL )
+	      + ( (uint64_t) ( counter.QuadPart % frequency.QuadPart ) * 1000000000UL / (uint64_t) frequency.QuadPart ) );
+
+#elif defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec time_specification;
+
+	if( clock_gettime(
+	     CLOCK_MONOTONIC,
+	     &time_specification ) != 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) time_specification.tv_sec * 1000000000UL ) + (uint64_t) time_specification.tv_nsec );
+
+#else
+	return( 0 );
+#endif
+}
+
+/* Retrieves the next value of a xorshift64* pseudo random number generator
+ * Returns the value
+ */
+uint64_t qcow_bench_get_random_value(
+          uint64_t *random_state )
+{
+	*random_state ^= *random_state >> 12;
+	*random_state ^= *random_state << 25;
+	*random_state ^= *random_state >> 27;
+
+	return( *random_state * 0x2545f4914f6cdd1dULL );
+}
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_bench_copy_decimal_from_string(
+     const system_character_t *string,
+     size_t string_length,
+     uint64_t *value_64bit )
+{
+	size_t string_index = 0;
+
+	if( ( string == NULL )
+	 || ( string_length == 0 ) )
+	{
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string_index < string_length;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			return( -1 );
+		}
+		if( *value_64bit > ( ( UINT64_MAX - 9 ) / 10 ) )
+		{
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+	}
+	return( 1 );
+}
+
+/* Compares two latencies
+ * Returns -1 if the first latency is smaller, 1 if larger or 0 if equal
+ */
+int qcow_bench_compare_latencies(
+     const void *first_latency,
+     const void *second_latency )
+{
+	uint64_t first_value  = *( (const uint64_t *) first_latency );
+	uint64_t second_value = *( (const uint64_t *) second_latency );
+
+	if( first_value < second_value )
+	{
+		return( -1 );
+	}
+	else if( first_value > second_value )
+	{
+		return( 1 );
+	}
+	return( 0 );
+}
+
+/* Reads the workload of a single thread
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_bench_read_thread(
+     qcow_bench_thread_values_t *thread_values )
+{
+	libcerror_error_t *error = NULL;
+	size64_t maximum_offset  = 0;
+	size64_t range_offset    = 0;
+	size_t read_size         = 0;
+	ssize_t read_count       = 0;
+	uint64_t end_timestamp   = 0;
+	uint64_t start_timestamp = 0;
+	off64_t read_offset      = 0;
+	int read_index           = 0;
+
+	read_size = qcow_bench_workload_read_sizes[ thread_values->workload ];
+
+	thread_values->bytes_read = 0;
+	thread_values->result     = 1;
+
+	for( read_index = 0;
+	     read_index < thread_values->number_of_reads;
+	     read_index++ )
+	{
+		if( thread_values->workload == QCOW_BENCH_WORKLOAD_SEQUENTIAL )
+		{
+			/* Every thread reads its own range and starts over at the end of the range
+			 */
+			range_offset = ( (size64_t) read_index * read_size ) % thread_values->range_size;
+			read_offset  = thread_values->range_offset + (off64_t) range_offset;
+		}
+		else
+		{
+			/* Random reads are aligned to the read size and spread over the entire media
+			 */
+			maximum_offset = thread_values->media_size / read_size;
+
+			if( maximum_offset == 0 )
+			{
+				maximum_offset = 1;
+			}
+			read_offset = (off64_t) ( ( qcow_bench_get_random_value(
+			                             &( thread_values->random_state ) ) % maximum_offset ) * read_size );
+		}
+		start_timestamp = qcow_bench_get_timestamp();
+
+		read_count = libqcow_file_read_buffer_at_offset(
+		              thread_values->file,
+		              thread_values->buffer,
+		              read_size,
+		              read_offset,
+		              &error );
+
+		end_timestamp = qcow_bench_get_timestamp();
+
+		if( read_count < 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to read buffer at offset: %" PRIi64 ".\n",
+			 read_offset );
+
+			libcerror_error_backtrace_fprint(
+			 error,
+			 stderr );
+			libcerror_error_free(
+			 &error );
+
+			thread_values->result = -1;
+
+			return( -1 );
+		}
+		thread_values->latencies[ read_index ] = end_timestamp - start_timestamp;
+		thread_values->bytes_read             += (uint64_t) read_count;
+	}
+	return( 1 );
+}
+
+/* Creates and opens a source file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_bench_open_source(
+     libqcow_file_t **file,
+     const system_character_t *source,
+     const system_character_t *password,
+     int number_of_worker_threads,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_bench_open_source";
+	int result            = 0;
+
+	if( libqcow_file_initialize(
+	     file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize file.",
+		 function );
+
+		goto on_error;
+	}
+	if( password != NULL )
+	{
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported password.",
+		 function );
+
+		goto on_error;
+#else
+		if( libqcow_file_set_utf8_password(
+		     *file,
+		     (uint8_t *) password,
+		     narrow_string_length(
+		      password ),
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set password.",
+			 function );
+
+			goto on_error;
+		}
+#endif
+	}
+	if( libqcow_file_set_number_of_worker_threads(
+	     *file,
+	     number_of_worker_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set number of worker threads.",
+		 function );
+
+		goto on_error;
+	}
+	/* A backing file is opened on first use since the file is opened by filename
+	 */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          *file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          error );
+#else
+	result = libqcow_file_open(
+	          *file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          error );
+#endif
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( *file != NULL )
+	{
+		libqcow_file_free(
+		 file,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* Runs a workload with a specific number of threads on a source
+ * The file is opened for every run so that the library caches start empty
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_bench_run(
+     const system_character_t *source,
+     const system_character_t *password,
+     int workload,
+     int number_of_threads,
+     int number_of_reads,
+     int number_of_worker_threads,
+     uint64_t seed,
+     libcerror_error_t **error )
+{
+	uint64_t statistics[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	qcow_bench_thread_values_t *thread_values = NULL;
+	libqcow_file_t *file                      = NULL;
+	uint64_t *latencies                       = NULL;
+	static char *function                     = "qcow_bench_run";
+	size64_t media_size                       = 0;
+	size64_t range_size                       = 0;
+	size_t backing_filename_size              = 0;
+	size_t number_of_latencies                = 0;
+	uint64_t bytes_read                       = 0;
+	uint64_t elapsed_time                     = 0;
+	uint64_t start_timestamp                  = 0;
+	uint32_t encryption_method                = 0;
+	uint32_t format_version                   = 0;
+	double mebibytes_per_second               = 0.0;
+	double reads_per_second                   = 0.0;
+	int has_backing_file                      = 0;
+	int thread_index                          = 0;
+
+#if defined( QCOW_BENCH_HAVE_MULTI_THREAD_SUPPORT )
+	libcthreads_thread_t **threads            = NULL;
+	int number_of_created_threads             = 0;
+	int result                                = 1;
+#endif
+
+	if( qcow_bench_open_source(
+	     &file,
+	     source,
+	     password,
+	     number_of_worker_threads,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open source.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_get_media_size(
+	     file,
+	     &media_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve media size.",
+		 function );
+
+		goto on_error;
+	}
+	if( media_size == 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid media size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_get_format_version(
+	     file,
+	     &format_version,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve format version.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_get_encryption_method(
+	     file,
+	     &encryption_method,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve encryption method.",
+		 function );
+
+		goto on_error;
+	}
+	has_backing_file = libqcow_file_get_utf8_backing_filename_size(
+	                    file,
+	                    &backing_filename_size,
+	                    error );
+
+	if( has_backing_file == -1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve backing filename size.",
+		 function );
+
+		goto on_error;
+	}
+	thread_values = (qcow_bench_thread_values_t *) memory_allocate(
+	                                                sizeof( qcow_bench_thread_values_t ) * number_of_threads );
+
+	if( thread_values == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create thread values.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     thread_values,
+	     0,
+	     sizeof( qcow_bench_thread_values_t ) * number_of_threads ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear thread values.",
+		 function );
+
+		memory_free(
+		 thread_values );
+
+		thread_values = NULL;
+
+		goto on_error;
+	}
+	number_of_latencies = (size_t) number_of_threads * (size_t) number_of_reads;
+
+	latencies = (uint64_t *) memory_allocate(
+	                          sizeof( uint64_t ) * number_of_latencies );
+
+	if( latencies == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create latencies.",
+		 function );
+
+		goto on_error;
+	}
+	/* Every thread reads its own part of the media sequentially
+	 */
+	range_size = media_size / (size64_t) number_of_threads;
+
+	if( range_size < qcow_bench_workload_read_sizes[ workload ] )
+	{
+		range_size = media_size;
+	}
+	for( thread_index = 0;
+	     thread_index < number_of_threads;
+	     thread_index++ )
+	{
+		thread_values[ thread_index ].file            = file;
+		thread_values[ thread_index ].workload        = workload;
+		thread_values[ thread_index ].media_size      = media_size;
+		thread_values[ thread_index ].range_size      = range_size;
+		thread_values[ thread_index ].number_of_reads = number_of_reads;
+		thread_values[ thread_index ].latencies       = &( latencies[ thread_index * number_of_reads ] );
+
+		if( range_size != media_size )
+		{
+			thread_values[ thread_index ].range_offset = (off64_t) ( thread_index * range_size );
+		}
+		/* The random state of xorshift64* must not be 0
+		 */
+		thread_values[ thread_index ].random_state = ( seed * 0x9e3779b97f4a7c15ULL ) + (uint64_t) thread_index + 1;
+
+		thread_values[ thread_index ].buffer = (uint8_t *) memory_allocate(
+		                                                    sizeof( uint8_t ) * qcow_bench_workload_read_sizes[ workload ] );
+
+		if( thread_values[ thread_index ].buffer == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create thread: %d buffer.",
+			 function,
+			 thread_index );
+
+			goto on_error;
+		}
+	}
+	start_timestamp = qcow_bench_get_timestamp();
+
+#if defined( QCOW_BENCH_HAVE_MULTI_THREAD_SUPPORT )
+	if( number_of_threads > 1 )
+	{
+		threads = (libcthreads_thread_t **) memory_allocate(
+		                                     sizeof( libcthreads_thread_t * ) * number_of_threads );
+
+		if( threads == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create threads.",
+			 function );
+
+			goto on_error;
+		}
+		for( thread_index = 0;
+		     thread_index < number_of_threads;
+		     thread_index++ )
+		{
+			threads[ thread_index ] = NULL;
+
+			if( libcthreads_thread_create(
+			     &( threads[ thread_index ] ),
+			     NULL,
+			     (int (*)(void *)) &qcow_bench_read_thread,
+			     (void *) &( thread_values[ thread_index ] ),
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+				 "%s: unable to create thread: %d.",
+				 function,
+				 thread_index );
+
+				result = -1;
+
+				break;
+			}
+		}
+		number_of_created_threads = thread_index;
+
+		for( thread_index = 0;
+		     thread_index < number_of_created_threads;
+		     thread_index++ )
+		{
+			if( libcthreads_thread_join(
+			     &( threads[ thread_index ] ),
+			     ( result == 1 ) ? error : NULL ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+				 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+				 "%s: unable to join thread: %d.",
+				 function,
+				 thread_index );
+
+				result = -1;
+			}
+		}
+		memory_free(
+		 threads );
+
+		if( result != 1 )
+		{
+			goto on_error;
+		}
+	}
+	else
+#endif
+	{
+		for( thread_index = 0;
+		     thread_index < number_of_threads;
+		     thread_index++ )
+		{
+			qcow_bench_read_thread(
+			 &( thread_values[ thread_index ] ) );
+		}
+	}
+	elapsed_time = qcow_bench_get_timestamp() - start_timestamp;
+
+	for( thread_index = 0;
+	     thread_index < number_of_threads;
+	     thread_index++ )
+	{
+		if( thread_values[ thread_index ].result != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read in thread: %d.",
+			 function,
+			 thread_index );
+
+			goto on_error;
+		}
+		bytes_read += thread_values[ thread_index ].bytes_read;
+	}
+	if( libqcow_file_get_statistics(
+	     file,
+	     statistics,
+	     LIBQCOW_NUMBER_OF_STATISTICS,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve statistics.",
+		 function );
+
+		goto on_error;
+	}
+	qsort(
+	 latencies,
+	 number_of_latencies,
+	 sizeof( uint64_t ),
+	 &qcow_bench_compare_latencies );
+
+	if( elapsed_time > 0 )
+	{
+		mebibytes_per_second = ( (double) bytes_read * 1000000000.0 ) / ( (double) elapsed_time * 1024.0 * 1024.0 );
+		reads_per_second     = ( (double) number_of_latencies * 1000000000.0 ) / (double) elapsed_time;
+	}
+	fprintf(
+	 stdout,
+	 "%" PRIs_SYSTEM ",%" PRIu32 ",%" PRIu32 ",%d,%" PRIu64 ",%s,%" PRIzd ",%d,%d,%" PRIzd ",%" PRIu64 ",%" PRIu64 ",%.2f,%.1f",
+	 source,
+	 format_version,
+	 encryption_method,
+	 has_backing_file,
+	 media_size,
+	 qcow_bench_workload_names[ workload ],
+	 qcow_bench_workload_read_sizes[ workload ],
+	 number_of_threads,
+	 number_of_worker_threads,
+	 number_of_latencies,
+	 bytes_read,
+	 elapsed_time,
+	 mebibytes_per_second,
+	 reads_per_second );
+
+	fprintf(
+	 stdout,
+	 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "",
+	 latencies[ number_of_latencies / 2 ],
+	 latencies[ ( number_of_latencies * 90 ) / 100 ],
+	 latencies[ ( number_of_latencies * 99 ) / 100 ],
+	 latencies[ ( number_of_latencies * 999 ) / 1000 ],
+	 latencies[ number_of_latencies - 1 ] );
+
+	fprintf(
+	 stdout,
+	 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_HITS ],
+	 statistics[ LIBQCOW_STATISTIC_CLUSTER_BLOCK_CACHE_MISSES ],
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_HOST_READS ],
+	 statistics[ LIBQCOW_STATISTIC_HOST_BYTES_READ ],
+	 statistics[ LIBQCOW_STATISTIC_SPARSE_BYTES ],
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_DECOMPRESSIONS ],
+	 statistics[ LIBQCOW_STATISTIC_NUMBER_OF_DECRYPTIONS ] );
+
+	for( thread_index = 0;
+	     thread_index < number_of_threads;
+	     thread_index++ )
+	{
+		memory_free(
+		 thread_values[ thread_index ].buffer );
+	}
+	memory_free(
+	 thread_values );
+	memory_free(
+	 latencies );
+
+	if( libqcow_file_close(
+	     file,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libqcow_file_free(
+	     &file,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file.",
+		 function );
+
+		goto on_error;
+	}
+	return( 1 );
+
+on_error:
+	if( thread_values != NULL )
+	{
+		for( thread_index = 0;
+		     thread_index < number_of_threads;
+		     thread_index++ )
+		{
+			if( thread_values[ thread_index ].buffer != NULL )
+			{
+				memory_free(
+				 thread_values[ thread_index ].buffer );
+			}
+		}
+		memory_free(
+		 thread_values );
+	}
+	if( latencies != NULL )
+	{
+		memory_free(
+		 latencies );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( -1 );
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc,
+     wchar_t * const argv[] )
+#else
+int main(
+     int argc,
+     char * const argv[] )
+#endif
+{
+	int thread_counts[ QCOW_BENCH_MAXIMUM_NUMBER_OF_RUNS ];
+
+	libcerror_error_t *error            = NULL;
+	system_character_t *option_password = NULL;
+	system_character_t *option_threads  = NULL;
+	system_character_t *string          = NULL;
+	uint64_t seed                       = 1;
+	uint64_t value_64bit                = 0;
+	system_integer_t option             = 0;
+	size_t string_index                 = 0;
+	size_t string_segment_index         = 0;
+	int number_of_reads                 = QCOW_BENCH_DEFAULT_NUMBER_OF_READS;
+	int number_of_runs                  = 0;
+	int number_of_worker_threads        = 0;
+	int run_index                       = 0;
+	int source_index                    = 0;
+	int workload                        = 0;
+
+	while( ( option = qcow_test_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "hn:p:s:t:w:" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM ".\n",
+				 argv[ optind - 1 ] );
+
+				qcow_bench_usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'h':
+				qcow_bench_usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'n':
+				if( ( qcow_bench_copy_decimal_from_string(
+				       optarg,
+				       system_string_length(
+				        optarg ),
+				       &value_64bit ) != 1 )
+				 || ( value_64bit == 0 )
+				 || ( value_64bit > QCOW_BENCH_MAXIMUM_NUMBER_OF_READS ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported number of reads: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				number_of_reads = (int) value_64bit;
+
+				break;
+
+			case (system_integer_t) 'p':
+				option_password = optarg;
+
+				break;
+
+			case (system_integer_t) 's':
+				if( qcow_bench_copy_decimal_from_string(
+				     optarg,
+				     system_string_length(
+				      optarg ),
+				     &seed ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported seed: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 't':
+				option_threads = optarg;
+
+				break;
+
+			case (system_integer_t) 'w':
+				if( ( qcow_bench_copy_decimal_from_string(
+				       optarg,
+				       system_string_length(
+				        optarg ),
+				       &value_64bit ) != 1 )
+				 || ( value_64bit > QCOW_BENCH_MAXIMUM_NUMBER_OF_THREADS ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported number of worker threads: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				number_of_worker_threads = (int) value_64bit;
+
+				break;
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		qcow_bench_usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	if( option_threads == NULL )
+	{
+		thread_counts[ 0 ] = 1;
+		number_of_runs     = 1;
+	}
+	else
+	{
+		string = option_threads;
+
+		do
+		{
+			string_segment_index = string_index;
+
+			while( ( string[ string_index ] != 0 )
+			    && ( string[ string_index ] != (system_character_t) ',' ) )
+			{
+				string_index++;
+			}
+			if( ( number_of_runs >= QCOW_BENCH_MAXIMUM_NUMBER_OF_RUNS )
+			 || ( qcow_bench_copy_decimal_from_string(
+			       &( string[ string_segment_index ] ),
+			       string_index - string_segment_index,
+			       &value_64bit ) != 1 )
+			 || ( value_64bit == 0 )
+			 || ( value_64bit > QCOW_BENCH_MAXIMUM_NUMBER_OF_THREADS ) )
+			{
+				fprintf(
+				 stderr,
+				 "Unsupported number of threads: %" PRIs_SYSTEM ".\n",
+				 option_threads );
+
+				return( EXIT_FAILURE );
+			}
+			thread_counts[ number_of_runs++ ] = (int) value_64bit;
+		}
+		while( string[ string_index++ ] != 0 );
+	}
+#if !defined( QCOW_BENCH_HAVE_MULTI_THREAD_SUPPORT )
+	for( run_index = 0;
+	     run_index < number_of_runs;
+	     run_index++ )
+	{
+		if( thread_counts[ run_index ] > 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Multiple threads are not supported, the reads of the threads are run one after another.\n" );
+
+			break;
+		}
+	}
+#endif
+	fprintf(
+	 stdout,
+	 "source,format_version,encryption_method,has_backing_file,media_size,workload,read_size,threads,worker_threads,reads,bytes_read,elapsed_time,mib_per_second,reads_per_second" );
+
+	fprintf(
+	 stdout,
+	 ",latency_p50,latency_p90,latency_p99,latency_p999,latency_maximum" );
+
+	fprintf(
+	 stdout,
+	 ",cluster_block_cache_hits,cluster_block_cache_misses,host_reads,host_bytes_read,sparse_bytes,decompressions,decryptions\n" );
+
+	for( source_index = optind;
+	     source_index < argc;
+	     source_index++ )
+	{
+		for( workload = 0;
+		     workload < QCOW_BENCH_NUMBER_OF_WORKLOADS;
+		     workload++ )
+		{
+			for( run_index = 0;
+			     run_index < number_of_runs;
+			     run_index++ )
+			{
+				if( qcow_bench_run(
+				     argv[ source_index ],
+				     option_password,
+				     workload,
+				     thread_counts[ run_index ],
+				     number_of_reads,
+				     number_of_worker_threads,
+				     seed,
+				     &error ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unable to benchmark source: %" PRIs_SYSTEM ".\n",
+					 argv[ source_index ] );
+
+					goto on_error;
+				}
+			}
+		}
+	}
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_backtrace_fprint(
+		 error,
+		 stderr );
+		libcerror_error_free(
+		 &error );
+	}
+	return( EXIT_FAILURE );
+}
+
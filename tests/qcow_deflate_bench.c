@@ -0,0 +1,1372 @@
+/*
+ * Deflate decoder benchmark program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <system_string.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#if defined( WINAPI )
+#include <windows.h>
+
+#elif defined( HAVE_CLOCK_GETTIME )
+#include <time.h>
+#endif
+
+#include "qcow_test_getopt.h"
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/qcow_file_header.h"
+
+/* The decoders are internal functions of the library
+ * which are only available if the internal functions are exported
+ */
+#if defined( __GNUC__ )
+#include "../libqcow/libqcow_compression.h"
+#include "../libqcow/libqcow_deflate.h"
+#define QCOW_DEFLATE_BENCH_HAVE_DECODERS
+#endif
+
+/* The default maximum number of compressed clusters in the corpus
+ */
+#define QCOW_DEFLATE_BENCH_DEFAULT_MAXIMUM_NUMBER_OF_CLUSTERS	4096
+
+/* The default number of iterations over the corpus
+ */
+#define QCOW_DEFLATE_BENCH_DEFAULT_NUMBER_OF_ITERATIONS		10
+
+/* The maximum number of iterations over the corpus
+ */
+#define QCOW_DEFLATE_BENCH_MAXIMUM_NUMBER_OF_ITERATIONS		100000
+
+/* The block types as stored in the deflate block header
+ */
+#define QCOW_DEFLATE_BENCH_NUMBER_OF_BLOCK_TYPES		3
+
+static const char *qcow_deflate_bench_block_type_names[ QCOW_DEFLATE_BENCH_NUMBER_OF_BLOCK_TYPES ] = {
+	"uncompressed",
+	"fixed-huffman",
+	"dynamic-huffman" };
+
+enum QCOW_DEFLATE_BENCH_DECODERS
+{
+	QCOW_DEFLATE_BENCH_DECODER_BUILT_IN	= 0,
+	QCOW_DEFLATE_BENCH_DECODER_BACKEND	= 1
+};
+
+#define QCOW_DEFLATE_BENCH_NUMBER_OF_DECODERS	2
+
+typedef struct qcow_deflate_bench_cluster qcow_deflate_bench_cluster_t;
+
+struct qcow_deflate_bench_cluster
+{
+	/* The compressed data
+	 */
+	uint8_t *compressed_data;
+
+	/* The compressed data size
+	 */
+	size_t compressed_data_size;
+
+	/* The uncompressed data size
+	 */
+	size_t uncompressed_data_size;
+
+	/* The type of the first deflate block
+	 */
+	uint8_t block_type;
+};
+
+typedef struct qcow_deflate_bench_corpus qcow_deflate_bench_corpus_t;
+
+struct qcow_deflate_bench_corpus
+{
+	/* The compressed clusters
+	 */
+	qcow_deflate_bench_cluster_t *clusters;
+
+	/* The number of clusters
+	 */
+	int number_of_clusters;
+
+	/* The maximum number of clusters
+	 */
+	int maximum_number_of_clusters;
+
+	/* The largest uncompressed data size
+	 */
+	size_t maximum_uncompressed_data_size;
+};
+
+/* Prints the executable usage information
+ */
+void qcow_deflate_bench_usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcow_deflate_bench to measure the throughput of the built-in deflate\n"
+	                 "decoder and of the inflate backend of libqcow\n\n" );
+
+	fprintf( stream, "Usage: qcow_deflate_bench [ -i iterations ] [ -n clusters ] [ -h ]\n"
+	                 "                          source [ source ... ]\n\n" );
+
+	fprintf( stream, "\tsource: a QCOW image file that contains compressed clusters\n\n" );
+
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-i:     the number of iterations over the corpus, default is %d\n",
+	                 QCOW_DEFLATE_BENCH_DEFAULT_NUMBER_OF_ITERATIONS );
+	fprintf( stream, "\t-n:     the maximum number of compressed clusters in the corpus,\n"
+	                 "\t        default is %d\n\n",
+	                 QCOW_DEFLATE_BENCH_DEFAULT_MAXIMUM_NUMBER_OF_CLUSTERS );
+
+	fprintf( stream, "The compressed clusters of the sources are grouped by the type of their\n"
+	                 "first deflate block: uncompressed, fixed-huffman or dynamic-huffman.\n"
+	                 "The output of both decoders is compared before the benchmark is run.\n"
+	                 "The results are printed as comma separated values with a header line\n" );
+}
+
+/* Retrieves a monotonic timestamp in nanoseconds
+ * Returns the timestamp or 0 if not available
+ */
+uint64_t qcow_deflate_bench_get_timestamp(
+          void )
+{
+#if defined( WINAPI )
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	if( QueryPerformanceFrequency(
+	     &frequency ) == 0 )
+	{
+		return( 0 );
+	}
+	if( QueryPerformanceCounter(
+	     &counter ) == 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) ( counter.QuadPart / frequency.QuadPart ) * 1000000000UL )
+	      + ( (uint64_t) ( counter.QuadPart % frequency.QuadPart ) * 1000000000UL / (uint64_t) frequency.QuadPart ) );
+
+#elif defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec time_specification;
+
+	if( clock_gettime(
+	     CLOCK_MONOTONIC,
+	     &time_specification ) != 0 )
+	{
+		return( 0 );
+	}
+	return( ( (uint64_t) time_specification.tv_sec * 1000000000UL ) + (uint64_t) time_specification.tv_nsec );
+
+#else
+	return( 0 );
+#endif
+}
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_deflate_bench_copy_decimal_from_string(
+     const system_character_t *string,
+     uint64_t *value_64bit )
+{
+	size_t string_index = 0;
+
+	if( ( string == NULL )
+	 || ( string[ 0 ] == 0 ) )
+	{
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string[ string_index ] != 0;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			return( -1 );
+		}
+		if( *value_64bit > ( ( UINT64_MAX - 9 ) / 10 ) )
+		{
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+	}
+	return( 1 );
+}
+
+/* Frees the clusters of a corpus
+ */
+void qcow_deflate_bench_corpus_free_clusters(
+      qcow_deflate_bench_corpus_t *corpus )
+{
+	int cluster_index = 0;
+
+	if( corpus == NULL )
+	{
+		return;
+	}
+	if( corpus->clusters != NULL )
+	{
+		for( cluster_index = 0;
+		     cluster_index < corpus->number_of_clusters;
+		     cluster_index++ )
+		{
+			memory_free(
+			 corpus->clusters[ cluster_index ].compressed_data );
+		}
+		memory_free(
+		 corpus->clusters );
+
+		corpus->clusters = NULL;
+	}
+	corpus->number_of_clusters = 0;
+}
+
+/* Reads data at a specific offset
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_deflate_bench_read_at_offset(
+     libbfio_handle_t *file_io_handle,
+     uint8_t *data,
+     size_t data_size,
+     off64_t file_offset,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_deflate_bench_read_at_offset";
+	ssize_t read_count    = 0;
+
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              file_io_handle,
+	              data,
+	              data_size,
+	              file_offset,
+	              error );
+
+	if( read_count != (ssize_t) data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Adds the compressed clusters of a source to the corpus
+ * The level 1 and 2 tables are read directly from the file
+ * Returns 1 if successful, 0 if the source contains no usable compressed clusters or -1 on error
+ */
+int qcow_deflate_bench_corpus_add_source(
+     qcow_deflate_bench_corpus_t *corpus,
+     const system_character_t *source,
+     libcerror_error_t **error )
+{
+	uint8_t file_header_data[ sizeof( qcow_file_header_v3_t ) ];
+
+	libbfio_handle_t *file_io_handle       = NULL;
+	qcow_deflate_bench_cluster_t *clusters = NULL;
+	uint8_t *compressed_data               = NULL;
+	uint8_t *level1_table_data             = NULL;
+	uint8_t *level2_table_data             = NULL;
+	static char *function                  = "qcow_deflate_bench_corpus_add_source";
+	size64_t file_size                     = 0;
+	size_t compressed_size                 = 0;
+	size_t level2_table_data_size          = 0;
+	uint64_t cluster_block_reference       = 0;
+	uint64_t compressed_offset             = 0;
+	uint64_t compression_bit_mask          = 0;
+	uint64_t compression_flag_bit_mask     = 0;
+	uint64_t level1_table_offset           = 0;
+	uint64_t level1_table_size             = 0;
+	uint64_t level1_table_index            = 0;
+	uint64_t level2_table_index            = 0;
+	uint64_t level2_table_offset           = 0;
+	uint64_t media_size                    = 0;
+	uint64_t offset_bit_mask               = 0;
+	uint32_t compression_bit_shift         = 0;
+	uint32_t encryption_method             = 0;
+	uint32_t format_version                = 0;
+	uint32_t header_size                   = 0;
+	uint32_t number_of_cluster_block_bits  = 0;
+	uint32_t number_of_level2_table_bits   = 0;
+	uint32_t signature                     = 0;
+	int number_of_added_clusters           = 0;
+
+	if( corpus == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid corpus.",
+		 function );
+
+		return( -1 );
+	}
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	if( libbfio_file_set_name_wide(
+	     file_io_handle,
+	     source,
+	     system_string_length(
+	      source ),
+	     error ) != 1 )
+#else
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     source,
+	     system_string_length(
+	      source ),
+	     error ) != 1 )
+#endif
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_READ,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_get_size(
+	     file_io_handle,
+	     &file_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_GET_FAILED,
+		 "%s: unable to retrieve file size.",
+		 function );
+
+		goto on_error;
+	}
+	if( file_size < (size64_t) sizeof( qcow_file_header_v3_t ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid file size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( qcow_deflate_bench_read_at_offset(
+	     file_io_handle,
+	     file_header_data,
+	     sizeof( qcow_file_header_v3_t ),
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read file header.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_file_header_v1_t *) file_header_data )->signature,
+	 signature );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 ( (qcow_file_header_v1_t *) file_header_data )->format_version,
+	 format_version );
+
+	if( signature != 0x514649fbUL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_INPUT,
+		 LIBCERROR_INPUT_ERROR_SIGNATURE_MISMATCH,
+		 "%s: invalid signature.",
+		 function );
+
+		goto on_error;
+	}
+	if( format_version == 1 )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->media_size,
+		 media_size );
+
+		number_of_cluster_block_bits = ( (qcow_file_header_v1_t *) file_header_data )->number_of_cluster_block_bits;
+		number_of_level2_table_bits  = ( (qcow_file_header_v1_t *) file_header_data )->number_of_level2_table_bits;
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->encryption_method,
+		 encryption_method );
+
+		byte_stream_copy_to_uint64_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->level1_table_offset,
+		 level1_table_offset );
+
+		offset_bit_mask           = 0x7fffffffffffffffULL;
+		compression_flag_bit_mask = (uint64_t) 1 << 63;
+	}
+	else if( ( format_version == 2 )
+	      || ( format_version == 3 ) )
+	{
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->number_of_cluster_block_bits,
+		 number_of_cluster_block_bits );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->encryption_method,
+		 encryption_method );
+
+		byte_stream_copy_to_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->number_of_level1_table_references,
+		 level1_table_size );
+
+		byte_stream_copy_to_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->level1_table_offset,
+		 level1_table_offset );
+
+		number_of_level2_table_bits = number_of_cluster_block_bits - 3;
+		offset_bit_mask             = 0x3fffffffffffffffULL;
+		compression_flag_bit_mask   = (uint64_t) 1 << 62;
+
+		if( format_version == 3 )
+		{
+			byte_stream_copy_to_uint32_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->header_size,
+			 header_size );
+
+			/* Only deflate compressed clusters are benchmarked
+			 */
+			if( ( header_size > 104 )
+			 && ( ( (qcow_file_header_v3_t *) file_header_data )->compression_type != 0 ) )
+			{
+				fprintf(
+				 stderr,
+				 "Skipping source: %" PRIs_SYSTEM " with unsupported compression type.\n",
+				 source );
+
+				goto on_skip;
+			}
+		}
+	}
+	else
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_UNSUPPORTED_VALUE,
+		 "%s: unsupported format version: %" PRIu32 ".",
+		 function,
+		 format_version );
+
+		goto on_error;
+	}
+	if( ( number_of_cluster_block_bits <= 8 )
+	 || ( number_of_cluster_block_bits > 21 )
+	 || ( number_of_level2_table_bits == 0 )
+	 || ( number_of_level2_table_bits > 21 ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of cluster block or level 2 table bits value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( encryption_method != 0 )
+	{
+		fprintf(
+		 stderr,
+		 "Skipping encrypted source: %" PRIs_SYSTEM ".\n",
+		 source );
+
+		goto on_skip;
+	}
+	if( format_version == 1 )
+	{
+		level1_table_size = (uint64_t) 1 << ( number_of_cluster_block_bits + number_of_level2_table_bits );
+		level1_table_size = ( media_size + level1_table_size - 1 ) / level1_table_size;
+
+		compression_bit_shift = 63 - number_of_cluster_block_bits;
+	}
+	else
+	{
+		compression_bit_shift = 62 - ( number_of_cluster_block_bits - 8 );
+	}
+	compression_bit_mask = ~( (uint64_t) -1 << compression_bit_shift );
+
+	if( ( level1_table_size == 0 )
+	 || ( level1_table_size > ( file_size / 8 ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	level1_table_data = (uint8_t *) memory_allocate(
+	                                 (size_t) ( level1_table_size * 8 ) );
+
+	if( level1_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 1 table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( qcow_deflate_bench_read_at_offset(
+	     file_io_handle,
+	     level1_table_data,
+	     (size_t) ( level1_table_size * 8 ),
+	     (off64_t) level1_table_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_READ_FAILED,
+		 "%s: unable to read level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	level2_table_data_size = (size_t) 8 << number_of_level2_table_bits;
+
+	level2_table_data = (uint8_t *) memory_allocate(
+	                                 level2_table_data_size );
+
+	if( level2_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 table data.",
+		 function );
+
+		goto on_error;
+	}
+	for( level1_table_index = 0;
+	     level1_table_index < level1_table_size;
+	     level1_table_index++ )
+	{
+		if( corpus->number_of_clusters >= corpus->maximum_number_of_clusters )
+		{
+			break;
+		}
+		byte_stream_copy_to_uint64_big_endian(
+		 &( level1_table_data[ level1_table_index * 8 ] ),
+		 level2_table_offset );
+
+		level2_table_offset &= offset_bit_mask;
+
+		if( ( level2_table_offset == 0 )
+		 || ( level2_table_offset > ( file_size - level2_table_data_size ) ) )
+		{
+			continue;
+		}
+		if( qcow_deflate_bench_read_at_offset(
+		     file_io_handle,
+		     level2_table_data,
+		     level2_table_data_size,
+		     (off64_t) level2_table_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_READ_FAILED,
+			 "%s: unable to read level 2 table: %" PRIu64 ".",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+		for( level2_table_index = 0;
+		     level2_table_index < ( (uint64_t) 1 << number_of_level2_table_bits );
+		     level2_table_index++ )
+		{
+			if( corpus->number_of_clusters >= corpus->maximum_number_of_clusters )
+			{
+				break;
+			}
+			byte_stream_copy_to_uint64_big_endian(
+			 &( level2_table_data[ level2_table_index * 8 ] ),
+			 cluster_block_reference );
+
+			if( ( cluster_block_reference & compression_flag_bit_mask ) == 0 )
+			{
+				continue;
+			}
+			cluster_block_reference &= offset_bit_mask;
+
+			compressed_offset = cluster_block_reference & compression_bit_mask;
+			compressed_size   = (size_t) ( cluster_block_reference >> compression_bit_shift );
+
+			/* Version 2 and 3 store the number of additional 512-byte sectors
+			 * read in the same way as the library does
+			 */
+			if( format_version != 1 )
+			{
+				compressed_size = ( compressed_size + 1 ) * 512;
+			}
+			if( ( compressed_size == 0 )
+			 || ( compressed_offset >= file_size ) )
+			{
+				continue;
+			}
+			if( compressed_size > ( file_size - compressed_offset ) )
+			{
+				compressed_size = (size_t) ( file_size - compressed_offset );
+			}
+			if( corpus->number_of_clusters >= corpus->maximum_number_of_clusters )
+			{
+				break;
+			}
+			compressed_data = (uint8_t *) memory_allocate(
+			                               compressed_size );
+
+			if( compressed_data == NULL )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_MEMORY,
+				 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+				 "%s: unable to create compressed data.",
+				 function );
+
+				goto on_error;
+			}
+			if( qcow_deflate_bench_read_at_offset(
+			     file_io_handle,
+			     compressed_data,
+			     compressed_size,
+			     (off64_t) compressed_offset,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_READ_FAILED,
+				 "%s: unable to read compressed data at offset: %" PRIu64 " (0x%08" PRIx64 ").",
+				 function,
+				 compressed_offset,
+				 compressed_offset );
+
+				goto on_error;
+			}
+			/* The block type is stored in bits 1 and 2 of the first deflate block header
+			 */
+			if( ( ( compressed_data[ 0 ] >> 1 ) & 0x03 ) >= QCOW_DEFLATE_BENCH_NUMBER_OF_BLOCK_TYPES )
+			{
+				memory_free(
+				 compressed_data );
+
+				compressed_data = NULL;
+
+				continue;
+			}
+			if( ( corpus->number_of_clusters % 256 ) == 0 )
+			{
+				clusters = (qcow_deflate_bench_cluster_t *) memory_reallocate(
+				                                             corpus->clusters,
+				                                             sizeof( qcow_deflate_bench_cluster_t ) * ( corpus->number_of_clusters + 256 ) );
+
+				if( clusters == NULL )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_MEMORY,
+					 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+					 "%s: unable to resize clusters.",
+					 function );
+
+					goto on_error;
+				}
+				corpus->clusters = clusters;
+			}
+			corpus->clusters[ corpus->number_of_clusters ].compressed_data        = compressed_data;
+			corpus->clusters[ corpus->number_of_clusters ].compressed_data_size   = compressed_size;
+			corpus->clusters[ corpus->number_of_clusters ].uncompressed_data_size = (size_t) 1 << number_of_cluster_block_bits;
+			corpus->clusters[ corpus->number_of_clusters ].block_type             = ( compressed_data[ 0 ] >> 1 ) & 0x03;
+
+			compressed_data = NULL;
+
+			corpus->number_of_clusters += 1;
+			number_of_added_clusters   += 1;
+		}
+	}
+	if( ( (size_t) 1 << number_of_cluster_block_bits ) > corpus->maximum_uncompressed_data_size )
+	{
+		corpus->maximum_uncompressed_data_size = (size_t) 1 << number_of_cluster_block_bits;
+	}
+	memory_free(
+	 level2_table_data );
+
+	level2_table_data = NULL;
+
+	memory_free(
+	 level1_table_data );
+
+	level1_table_data = NULL;
+
+on_skip:
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	if( number_of_added_clusters == 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+
+on_error:
+	if( compressed_data != NULL )
+	{
+		memory_free(
+		 compressed_data );
+	}
+	if( level2_table_data != NULL )
+	{
+		memory_free(
+		 level2_table_data );
+	}
+	if( level1_table_data != NULL )
+	{
+		memory_free(
+		 level1_table_data );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( -1 );
+}
+
+#if defined( QCOW_DEFLATE_BENCH_HAVE_DECODERS )
+
+/* Decompresses a cluster with a specific decoder
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_deflate_bench_decompress_cluster(
+     qcow_deflate_bench_cluster_t *cluster,
+     int decoder,
+     libqcow_decompression_context_t *decompression_context,
+     uint8_t *uncompressed_data,
+     size_t *uncompressed_data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_deflate_bench_decompress_cluster";
+	int result            = 0;
+
+	*uncompressed_data_size = cluster->uncompressed_data_size;
+
+	if( decoder == QCOW_DEFLATE_BENCH_DECODER_BUILT_IN )
+	{
+		result = libqcow_deflate_decompress(
+		          cluster->compressed_data,
+		          cluster->compressed_data_size,
+		          uncompressed_data,
+		          uncompressed_data_size,
+		          error );
+	}
+	else
+	{
+		result = libqcow_decompression_context_decompress_data(
+		          decompression_context,
+		          cluster->compressed_data,
+		          cluster->compressed_data_size,
+		          uncompressed_data,
+		          uncompressed_data_size,
+		          error );
+	}
+	if( result != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+		 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+		 "%s: unable to decompress cluster.",
+		 function );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Compares the output of the decoders for every cluster of the corpus
+ * Returns 1 if the output is identical, 0 if not or -1 on error
+ */
+int qcow_deflate_bench_compare_decoders(
+     qcow_deflate_bench_corpus_t *corpus,
+     libqcow_decompression_context_t *decompression_context,
+     uint8_t *built_in_data,
+     uint8_t *backend_data,
+     libcerror_error_t **error )
+{
+	static char *function     = "qcow_deflate_bench_compare_decoders";
+	size_t backend_data_size  = 0;
+	size_t built_in_data_size = 0;
+	int cluster_index         = 0;
+	int number_of_mismatches  = 0;
+
+	for( cluster_index = 0;
+	     cluster_index < corpus->number_of_clusters;
+	     cluster_index++ )
+	{
+		if( qcow_deflate_bench_decompress_cluster(
+		     &( corpus->clusters[ cluster_index ] ),
+		     QCOW_DEFLATE_BENCH_DECODER_BACKEND,
+		     decompression_context,
+		     backend_data,
+		     &backend_data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+			 "%s: unable to decompress cluster: %d with backend.",
+			 function,
+			 cluster_index );
+
+			return( -1 );
+		}
+		/* The data of the corpus is valid if the backend can decompress it
+		 * hence a failure of the built-in decoder is reported as a mismatch
+		 */
+		if( qcow_deflate_bench_decompress_cluster(
+		     &( corpus->clusters[ cluster_index ] ),
+		     QCOW_DEFLATE_BENCH_DECODER_BUILT_IN,
+		     NULL,
+		     built_in_data,
+		     &built_in_data_size,
+		     error ) != 1 )
+		{
+			libcerror_error_free(
+			 error );
+
+			built_in_data_size = 0;
+		}
+		if( ( built_in_data_size != backend_data_size )
+		 || ( memory_compare(
+		       built_in_data,
+		       backend_data,
+		       backend_data_size ) != 0 ) )
+		{
+			fprintf(
+			 stderr,
+			 "Mismatch in output of decoders for %s cluster: %d.\n",
+			 qcow_deflate_bench_block_type_names[ corpus->clusters[ cluster_index ].block_type ],
+			 cluster_index );
+
+			number_of_mismatches++;
+		}
+		corpus->clusters[ cluster_index ].uncompressed_data_size = backend_data_size;
+	}
+	if( number_of_mismatches != 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Runs a decoder over the clusters of a specific block type
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_deflate_bench_run(
+     qcow_deflate_bench_corpus_t *corpus,
+     int decoder,
+     uint8_t block_type,
+     int number_of_iterations,
+     libqcow_decompression_context_t *decompression_context,
+     uint8_t *uncompressed_data,
+     libcerror_error_t **error )
+{
+	static char *function          = "qcow_deflate_bench_run";
+	double elapsed_time            = 0.0;
+	double compressed_throughput   = 0.0;
+	double uncompressed_throughput = 0.0;
+	size_t uncompressed_data_size  = 0;
+	uint64_t compressed_bytes      = 0;
+	uint64_t end_timestamp         = 0;
+	uint64_t start_timestamp       = 0;
+	uint64_t uncompressed_bytes    = 0;
+	int cluster_index              = 0;
+	int iteration                  = 0;
+	int number_of_clusters         = 0;
+
+	start_timestamp = qcow_deflate_bench_get_timestamp();
+
+	for( iteration = 0;
+	     iteration < number_of_iterations;
+	     iteration++ )
+	{
+		for( cluster_index = 0;
+		     cluster_index < corpus->number_of_clusters;
+		     cluster_index++ )
+		{
+			if( corpus->clusters[ cluster_index ].block_type != block_type )
+			{
+				continue;
+			}
+			if( qcow_deflate_bench_decompress_cluster(
+			     &( corpus->clusters[ cluster_index ] ),
+			     decoder,
+			     decompression_context,
+			     uncompressed_data,
+			     &uncompressed_data_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+				 LIBCERROR_COMPRESSION_ERROR_DECOMPRESS_FAILED,
+				 "%s: unable to decompress cluster: %d.",
+				 function,
+				 cluster_index );
+
+				return( -1 );
+			}
+			compressed_bytes   += corpus->clusters[ cluster_index ].compressed_data_size;
+			uncompressed_bytes += uncompressed_data_size;
+
+			if( iteration == 0 )
+			{
+				number_of_clusters++;
+			}
+		}
+	}
+	end_timestamp = qcow_deflate_bench_get_timestamp();
+
+	if( number_of_clusters == 0 )
+	{
+		return( 1 );
+	}
+	elapsed_time = (double) ( end_timestamp - start_timestamp ) / 1000000000.0;
+
+	if( elapsed_time > 0.0 )
+	{
+		compressed_throughput   = (double) compressed_bytes / ( 1024.0 * 1024.0 ) / elapsed_time;
+		uncompressed_throughput = (double) uncompressed_bytes / ( 1024.0 * 1024.0 ) / elapsed_time;
+	}
+	fprintf(
+	 stdout,
+	 "%s,%s,%d,%d,%" PRIu64 ",%" PRIu64 ",%.6f,%.2f,%.2f\n",
+	 ( decoder == QCOW_DEFLATE_BENCH_DECODER_BUILT_IN ) ? "built-in" : libqcow_compression_get_inflate_backend_name(),
+	 qcow_deflate_bench_block_type_names[ block_type ],
+	 number_of_clusters,
+	 number_of_iterations,
+	 compressed_bytes,
+	 uncompressed_bytes,
+	 elapsed_time,
+	 compressed_throughput,
+	 uncompressed_throughput );
+
+	return( 1 );
+}
+
+#endif /* defined( QCOW_DEFLATE_BENCH_HAVE_DECODERS ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc,
+     wchar_t * const argv[] )
+#else
+int main(
+     int argc,
+     char * const argv[] )
+#endif
+{
+	qcow_deflate_bench_corpus_t corpus;
+
+#if defined( QCOW_DEFLATE_BENCH_HAVE_DECODERS )
+	libqcow_decompression_context_t *decompression_context = NULL;
+	uint8_t *backend_data                                  = NULL;
+	uint8_t *built_in_data                                 = NULL;
+	uint8_t block_type                                     = 0;
+	int decoder                                            = 0;
+#endif
+
+	libcerror_error_t *error = NULL;
+	uint64_t value_64bit     = 0;
+	system_integer_t option  = 0;
+	int number_of_iterations = QCOW_DEFLATE_BENCH_DEFAULT_NUMBER_OF_ITERATIONS;
+	int result               = 0;
+	int source_index         = 0;
+
+	if( memory_set(
+	     &corpus,
+	     0,
+	     sizeof( qcow_deflate_bench_corpus_t ) ) == NULL )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to clear corpus.\n" );
+
+		return( EXIT_FAILURE );
+	}
+	corpus.maximum_number_of_clusters = QCOW_DEFLATE_BENCH_DEFAULT_MAXIMUM_NUMBER_OF_CLUSTERS;
+
+	while( ( option = qcow_test_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "hi:n:" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM ".\n",
+				 argv[ optind - 1 ] );
+
+				qcow_deflate_bench_usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'h':
+				qcow_deflate_bench_usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'i':
+				if( ( qcow_deflate_bench_copy_decimal_from_string(
+				       optarg,
+				       &value_64bit ) != 1 )
+				 || ( value_64bit == 0 )
+				 || ( value_64bit > QCOW_DEFLATE_BENCH_MAXIMUM_NUMBER_OF_ITERATIONS ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported number of iterations: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				number_of_iterations = (int) value_64bit;
+
+				break;
+
+			case (system_integer_t) 'n':
+				if( ( qcow_deflate_bench_copy_decimal_from_string(
+				       optarg,
+				       &value_64bit ) != 1 )
+				 || ( value_64bit == 0 )
+				 || ( value_64bit > (uint64_t) INT32_MAX ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported number of clusters: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				corpus.maximum_number_of_clusters = (int) value_64bit;
+
+				break;
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing source file.\n" );
+
+		qcow_deflate_bench_usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+#if !defined( QCOW_DEFLATE_BENCH_HAVE_DECODERS )
+	QCOW_TEST_UNREFERENCED_PARAMETER( number_of_iterations )
+	QCOW_TEST_UNREFERENCED_PARAMETER( result )
+	QCOW_TEST_UNREFERENCED_PARAMETER( source_index )
+	QCOW_TEST_UNREFERENCED_PARAMETER( error )
+
+	fprintf(
+	 stderr,
+	 "No support for benchmarking the decoders.\n" );
+
+	return( EXIT_FAILURE );
+#else
+	for( source_index = optind;
+	     source_index < argc;
+	     source_index++ )
+	{
+		if( corpus.number_of_clusters >= corpus.maximum_number_of_clusters )
+		{
+			break;
+		}
+		result = qcow_deflate_bench_corpus_add_source(
+		          &corpus,
+		          argv[ source_index ],
+		          &error );
+
+		if( result == -1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to read compressed clusters from source: %" PRIs_SYSTEM ".\n",
+			 argv[ source_index ] );
+
+			goto on_error;
+		}
+		else if( result == 0 )
+		{
+			fprintf(
+			 stderr,
+			 "No compressed clusters in source: %" PRIs_SYSTEM ".\n",
+			 argv[ source_index ] );
+		}
+	}
+	if( corpus.number_of_clusters == 0 )
+	{
+		fprintf(
+		 stderr,
+		 "No compressed clusters found.\n" );
+
+		goto on_error;
+	}
+	built_in_data = (uint8_t *) memory_allocate(
+	                             corpus.maximum_uncompressed_data_size );
+
+	if( built_in_data == NULL )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to create built-in decoder output data.\n" );
+
+		goto on_error;
+	}
+	backend_data = (uint8_t *) memory_allocate(
+	                            corpus.maximum_uncompressed_data_size );
+
+	if( backend_data == NULL )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to create backend decoder output data.\n" );
+
+		goto on_error;
+	}
+	/* The backend context is reused for every cluster as in the read path of the library
+	 * where compression method 1 is deflate
+	 */
+	if( libqcow_decompression_context_initialize(
+	     &decompression_context,
+	     1,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to create decompression context.\n" );
+
+		goto on_error;
+	}
+	result = qcow_deflate_bench_compare_decoders(
+	          &corpus,
+	          decompression_context,
+	          built_in_data,
+	          backend_data,
+	          &error );
+
+	if( result != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to compare the output of the decoders.\n" );
+
+		goto on_error;
+	}
+	fprintf(
+	 stdout,
+	 "decoder,block_type,clusters,iterations,compressed_bytes,uncompressed_bytes,elapsed_time,compressed_mib_per_second,uncompressed_mib_per_second\n" );
+
+	for( block_type = 0;
+	     block_type < QCOW_DEFLATE_BENCH_NUMBER_OF_BLOCK_TYPES;
+	     block_type++ )
+	{
+		for( decoder = 0;
+		     decoder < QCOW_DEFLATE_BENCH_NUMBER_OF_DECODERS;
+		     decoder++ )
+		{
+			if( qcow_deflate_bench_run(
+			     &corpus,
+			     decoder,
+			     block_type,
+			     number_of_iterations,
+			     decompression_context,
+			     built_in_data,
+			     &error ) != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unable to benchmark decoder.\n" );
+
+				goto on_error;
+			}
+		}
+	}
+	if( libqcow_decompression_context_free(
+	     &decompression_context,
+	     &error ) != 1 )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to free decompression context.\n" );
+
+		goto on_error;
+	}
+	memory_free(
+	 backend_data );
+
+	memory_free(
+	 built_in_data );
+
+	qcow_deflate_bench_corpus_free_clusters(
+	 &corpus );
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_backtrace_fprint(
+		 error,
+		 stderr );
+		libcerror_error_free(
+		 &error );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	if( backend_data != NULL )
+	{
+		memory_free(
+		 backend_data );
+	}
+	if( built_in_data != NULL )
+	{
+		memory_free(
+		 built_in_data );
+	}
+	qcow_deflate_bench_corpus_free_clusters(
+	 &corpus );
+
+	return( EXIT_FAILURE );
+#endif /* !defined( QCOW_DEFLATE_BENCH_HAVE_DECODERS ) */
+}
+
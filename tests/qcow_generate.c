@@ -0,0 +1,2474 @@
+/*
+ * Synthetic QCOW image generator program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <system_string.h>
+#include <types.h>
+#include <wide_string.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#if defined( HAVE_ZLIB ) || defined( ZLIB_DLL )
+#include <zlib.h>
+#define QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT
+#endif
+
+#include "qcow_test_getopt.h"
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/qcow_file_header.h"
+
+/* The encryption functions of the library are used to encrypt the data
+ * which are only available if the internal functions are exported
+ */
+#if defined( __GNUC__ )
+#include "../libqcow/libqcow_encryption.h"
+#define QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT
+#endif
+
+/* The default media size
+ */
+#define QCOW_GENERATE_DEFAULT_MEDIA_SIZE		( (size64_t) 1024 * 1024 * 1024 )
+
+/* The default number of cluster block bits, which corresponds to 64 KiB
+ */
+#define QCOW_GENERATE_DEFAULT_CLUSTER_BLOCK_BITS	16
+
+/* The maximum number of images in the backing file chain
+ */
+#define QCOW_GENERATE_MAXIMUM_CHAIN_DEPTH		16
+
+/* The size of the buffer that is used to write the cluster blocks
+ */
+#define QCOW_GENERATE_WRITE_BUFFER_SIZE			( 4 * 1024 * 1024 )
+
+/* The size of the blocks of which the compressibility of the data is determined
+ */
+#define QCOW_GENERATE_DATA_BLOCK_SIZE			512
+
+typedef struct qcow_generate_layout qcow_generate_layout_t;
+
+struct qcow_generate_layout
+{
+	/* The format version
+	 */
+	uint32_t format_version;
+
+	/* The media size
+	 */
+	size64_t media_size;
+
+	/* The number of cluster block bits
+	 */
+	uint8_t number_of_cluster_block_bits;
+
+	/* The cluster block size
+	 */
+	size_t cluster_block_size;
+
+	/* The percentage of cluster blocks of the base image that are not allocated
+	 */
+	int sparse_percentage;
+
+	/* The percentage of cluster blocks that is allocated in an image on top of a backing file
+	 */
+	int overlay_percentage;
+
+	/* The percentage of allocated cluster blocks that is stored compressed
+	 */
+	int compressed_percentage;
+
+	/* The percentage of the data of a cluster block that consists of a repeating pattern
+	 */
+	int compressibility_percentage;
+
+	/* The percentage of allocated cluster blocks that is not stored in media order
+	 */
+	int fragmentation_percentage;
+
+	/* The seed of the pseudo random number generator
+	 */
+	uint64_t seed;
+
+	/* The encryption key
+	 */
+	uint8_t key[ 16 ];
+
+	/* Value to indicate the encryption key is set
+	 */
+	uint8_t key_is_set;
+};
+
+typedef struct qcow_generate_writer qcow_generate_writer_t;
+
+struct qcow_generate_writer
+{
+	/* The file IO handle
+	 */
+	libbfio_handle_t *file_io_handle;
+
+	/* The buffer
+	 */
+	uint8_t *buffer;
+
+	/* The size of the data in the buffer
+	 */
+	size_t buffer_data_size;
+
+	/* The file offset of the data in the buffer
+	 */
+	off64_t file_offset;
+};
+
+/* Prints the executable usage information
+ */
+void qcow_generate_usage_fprint(
+      FILE *stream )
+{
+	if( stream == NULL )
+	{
+		return;
+	}
+	fprintf( stream, "Use qcow_generate to create a synthetic QCOW image with a deterministic\n"
+	                 "layout and contents\n\n" );
+
+	fprintf( stream, "Usage: qcow_generate [ -c cluster_size ] [ -C compressed ] [ -d depth ]\n"
+	                 "                     [ -f format_version ] [ -F fragmentation ]\n"
+	                 "                     [ -o overlay ] [ -p password ] [ -r compressibility ]\n"
+	                 "                     [ -s media_size ] [ -S sparse ] [ -x seed ] [ -h ]\n"
+	                 "                     target\n\n" );
+
+	fprintf( stream, "\ttarget: the QCOW image file to create, if the depth is more than 1\n"
+	                 "\t        the backing files are created as target.0, target.1, etc.\n"
+	                 "\t        where target.0 is the bottom of the chain\n\n" );
+
+	fprintf( stream, "\t-c:     the cluster size in bytes, must be a power of 2, default is\n"
+	                 "\t        %d KiB\n",
+	                 1 << ( QCOW_GENERATE_DEFAULT_CLUSTER_BLOCK_BITS - 10 ) );
+	fprintf( stream, "\t-C:     the percentage of allocated clusters that is stored compressed,\n"
+	                 "\t        default is 0\n" );
+	fprintf( stream, "\t-d:     the number of images in the backing file chain, default is 1\n" );
+	fprintf( stream, "\t-f:     the format version: 1, 2 or 3, default is 2\n" );
+	fprintf( stream, "\t-F:     the percentage of allocated clusters that is not stored in\n"
+	                 "\t        media order, default is 0\n" );
+	fprintf( stream, "\t-h:     shows this help\n" );
+	fprintf( stream, "\t-o:     the percentage of clusters that is allocated in the images on top\n"
+	                 "\t        of a backing file, default is 10\n" );
+	fprintf( stream, "\t-p:     specify the password/passphrase, enables AES-128-CBC encryption\n" );
+	fprintf( stream, "\t-r:     the percentage of the data of a cluster that consists of\n"
+	                 "\t        a repeating pattern, default is 50\n" );
+	fprintf( stream, "\t-s:     the media size in bytes, supports the K, M, G and T suffixes,\n"
+	                 "\t        default is 1G\n" );
+	fprintf( stream, "\t-S:     the percentage of clusters of the bottom image that is not\n"
+	                 "\t        allocated, default is 0\n" );
+	fprintf( stream, "\t-x:     the seed of the layout and contents, default is 1\n\n" );
+
+	fprintf( stream, "The same options always create the same images. The contents of a cluster\n"
+	                 "only depend on the seed, the image in the chain and the cluster index\n" );
+}
+
+/* Retrieves the next value of a xorshift64* pseudo random number generator
+ * Returns the value
+ */
+uint64_t qcow_generate_get_random_value(
+          uint64_t *random_state )
+{
+	*random_state ^= *random_state >> 12;
+	*random_state ^= *random_state << 25;
+	*random_state ^= *random_state >> 27;
+
+	return( *random_state * 0x2545f4914f6cdd1dULL );
+}
+
+/* Determines the initial state of a pseudo random number generator
+ * using the splitmix64 finalizer so that nearby values result in unrelated states
+ * Returns the state, which is never 0
+ */
+uint64_t qcow_generate_get_random_state(
+          uint64_t seed,
+          uint64_t image_index,
+          uint64_t value_index )
+{
+	uint64_t random_state = seed;
+
+	random_state += ( image_index + 1 ) * 0x9e3779b97f4a7c15ULL;
+	random_state ^= value_index * 0xbf58476d1ce4e5b9ULL;
+
+	random_state = ( random_state ^ ( random_state >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	random_state = ( random_state ^ ( random_state >> 27 ) ) * 0x94d049bb133111ebULL;
+	random_state =   random_state ^ ( random_state >> 31 );
+
+	if( random_state == 0 )
+	{
+		random_state = 0x2545f4914f6cdd1dULL;
+	}
+	return( random_state );
+}
+
+/* Copies a decimal value from a string
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_copy_decimal_from_string(
+     const system_character_t *string,
+     uint64_t *value_64bit )
+{
+	size_t string_index = 0;
+
+	if( ( string == NULL )
+	 || ( string[ 0 ] == 0 ) )
+	{
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string[ string_index ] != 0;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			return( -1 );
+		}
+		if( *value_64bit > ( ( UINT64_MAX - 9 ) / 10 ) )
+		{
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+	}
+	return( 1 );
+}
+
+/* Copies a size from a string that has an optional K, M, G or T suffix
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_copy_size_from_string(
+     const system_character_t *string,
+     uint64_t *value_64bit )
+{
+	size_t string_index = 0;
+	uint8_t bit_shift   = 0;
+
+	if( ( string == NULL )
+	 || ( string[ 0 ] == 0 ) )
+	{
+		return( -1 );
+	}
+	*value_64bit = 0;
+
+	for( string_index = 0;
+	     string[ string_index ] != 0;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] < (system_character_t) '0' )
+		 || ( string[ string_index ] > (system_character_t) '9' ) )
+		{
+			break;
+		}
+		if( *value_64bit > ( ( UINT64_MAX - 9 ) / 10 ) )
+		{
+			return( -1 );
+		}
+		*value_64bit *= 10;
+		*value_64bit += (uint64_t) ( string[ string_index ] - (system_character_t) '0' );
+	}
+	if( string_index == 0 )
+	{
+		return( -1 );
+	}
+	switch( string[ string_index ] )
+	{
+		case 0:
+			return( 1 );
+
+		case (system_character_t) 'K':
+		case (system_character_t) 'k':
+			bit_shift = 10;
+			break;
+
+		case (system_character_t) 'M':
+		case (system_character_t) 'm':
+			bit_shift = 20;
+			break;
+
+		case (system_character_t) 'G':
+		case (system_character_t) 'g':
+			bit_shift = 30;
+			break;
+
+		case (system_character_t) 'T':
+		case (system_character_t) 't':
+			bit_shift = 40;
+			break;
+
+		default:
+			return( -1 );
+	}
+	if( string[ string_index + 1 ] != 0 )
+	{
+		return( -1 );
+	}
+	if( *value_64bit > ( UINT64_MAX >> bit_shift ) )
+	{
+		return( -1 );
+	}
+	*value_64bit <<= bit_shift;
+
+	return( 1 );
+}
+
+/* Copies a percentage from a string
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_copy_percentage_from_string(
+     const system_character_t *string,
+     int *percentage )
+{
+	uint64_t value_64bit = 0;
+
+	if( qcow_generate_copy_decimal_from_string(
+	     string,
+	     &value_64bit ) != 1 )
+	{
+		return( -1 );
+	}
+	if( value_64bit > 100 )
+	{
+		return( -1 );
+	}
+	*percentage = (int) value_64bit;
+
+	return( 1 );
+}
+
+/* Copies an US-ASCII string from a system string
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_copy_ascii_from_system_string(
+     uint8_t *ascii_string,
+     size_t ascii_string_size,
+     const system_character_t *string,
+     size_t string_length )
+{
+	size_t string_index = 0;
+
+	if( ( ascii_string == NULL )
+	 || ( string == NULL )
+	 || ( string_length > ascii_string_size ) )
+	{
+		return( -1 );
+	}
+	for( string_index = 0;
+	     string_index < string_length;
+	     string_index++ )
+	{
+		if( ( string[ string_index ] == 0 )
+		 || ( (uint32_t) string[ string_index ] > 0x7f ) )
+		{
+			return( -1 );
+		}
+		ascii_string[ string_index ] = (uint8_t) string[ string_index ];
+	}
+	return( 1 );
+}
+
+/* Fills the data of a cluster block
+ * The data consists of blocks that either contain a repeating pattern or random data
+ */
+void qcow_generate_fill_cluster_block(
+      uint8_t *data,
+      size_t data_size,
+      int compressibility_percentage,
+      uint64_t *random_state )
+{
+	size_t data_offset      = 0;
+	size_t block_end_offset = 0;
+	uint64_t pattern        = 0;
+	uint64_t random_value   = 0;
+
+	while( data_offset < data_size )
+	{
+		block_end_offset = data_offset + QCOW_GENERATE_DATA_BLOCK_SIZE;
+
+		random_value = qcow_generate_get_random_value(
+		                random_state );
+
+		if( (int) ( ( random_value >> 32 ) % 100 ) < compressibility_percentage )
+		{
+			pattern = qcow_generate_get_random_value(
+			           random_state );
+
+			while( data_offset < block_end_offset )
+			{
+				byte_stream_copy_from_uint64_little_endian(
+				 &( data[ data_offset ] ),
+				 pattern );
+
+				data_offset += 8;
+			}
+		}
+		else
+		{
+			while( data_offset < block_end_offset )
+			{
+				random_value = qcow_generate_get_random_value(
+				                random_state );
+
+				byte_stream_copy_from_uint64_little_endian(
+				 &( data[ data_offset ] ),
+				 random_value );
+
+				data_offset += 8;
+			}
+		}
+	}
+}
+
+/* Writes the data in the buffer of the writer to the file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_writer_flush(
+     qcow_generate_writer_t *writer,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_generate_writer_flush";
+	ssize_t write_count   = 0;
+
+	if( writer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid writer.",
+		 function );
+
+		return( -1 );
+	}
+	if( writer->buffer_data_size == 0 )
+	{
+		return( 1 );
+	}
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               writer->file_io_handle,
+	               writer->buffer,
+	               writer->buffer_data_size,
+	               writer->file_offset,
+	               error );
+
+	if( write_count != (ssize_t) writer->buffer_data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 writer->file_offset,
+		 writer->file_offset );
+
+		return( -1 );
+	}
+	writer->file_offset     += (off64_t) writer->buffer_data_size;
+	writer->buffer_data_size = 0;
+
+	return( 1 );
+}
+
+/* Appends data to the buffer of the writer
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_writer_append(
+     qcow_generate_writer_t *writer,
+     const uint8_t *data,
+     size_t data_size,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_generate_writer_append";
+	size_t copy_size      = 0;
+	size_t data_offset    = 0;
+
+	if( writer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid writer.",
+		 function );
+
+		return( -1 );
+	}
+	while( data_offset < data_size )
+	{
+		copy_size = QCOW_GENERATE_WRITE_BUFFER_SIZE - writer->buffer_data_size;
+
+		if( copy_size > ( data_size - data_offset ) )
+		{
+			copy_size = data_size - data_offset;
+		}
+		if( memory_copy(
+		     &( writer->buffer[ writer->buffer_data_size ] ),
+		     &( data[ data_offset ] ),
+		     copy_size ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+			 "%s: unable to copy data.",
+			 function );
+
+			return( -1 );
+		}
+		writer->buffer_data_size += copy_size;
+		data_offset              += copy_size;
+
+		if( writer->buffer_data_size == QCOW_GENERATE_WRITE_BUFFER_SIZE )
+		{
+			if( qcow_generate_writer_flush(
+			     writer,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to flush writer.",
+				 function );
+
+				return( -1 );
+			}
+		}
+	}
+	return( 1 );
+}
+
+/* Aligns the current offset of the writer to the cluster block size
+ * The alignment padding is not written, which leaves a sparse region in the file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_writer_align(
+     qcow_generate_writer_t *writer,
+     size_t cluster_block_size,
+     libcerror_error_t **error )
+{
+	static char *function  = "qcow_generate_writer_align";
+	off64_t current_offset = 0;
+
+	if( writer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid writer.",
+		 function );
+
+		return( -1 );
+	}
+	current_offset = writer->file_offset + (off64_t) writer->buffer_data_size;
+
+	if( ( current_offset % cluster_block_size ) == 0 )
+	{
+		return( 1 );
+	}
+	if( qcow_generate_writer_flush(
+	     writer,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to flush writer.",
+		 function );
+
+		return( -1 );
+	}
+	writer->file_offset = current_offset + (off64_t) ( cluster_block_size - ( current_offset % cluster_block_size ) );
+
+	return( 1 );
+}
+
+/* Writes data at a specific offset
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_write_at_offset(
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *data,
+     size_t data_size,
+     off64_t file_offset,
+     libcerror_error_t **error )
+{
+	static char *function = "qcow_generate_write_at_offset";
+	ssize_t write_count   = 0;
+
+	write_count = libbfio_handle_write_buffer_at_offset(
+	               file_io_handle,
+	               data,
+	               data_size,
+	               file_offset,
+	               error );
+
+	if( write_count != (ssize_t) data_size )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write data at offset: %" PRIi64 " (0x%08" PRIx64 ").",
+		 function,
+		 file_offset,
+		 file_offset );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Writes the file header and the backing filename
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_write_file_header(
+     qcow_generate_layout_t *layout,
+     libbfio_handle_t *file_io_handle,
+     const uint8_t *backing_filename,
+     size_t backing_filename_size,
+     uint32_t number_of_level1_table_references,
+     uint64_t level1_table_offset,
+     uint64_t reference_count_table_offset,
+     uint32_t reference_count_table_clusters,
+     libcerror_error_t **error )
+{
+	uint8_t *file_header_data      = NULL;
+	static char *function          = "qcow_generate_write_file_header";
+	size_t backing_filename_offset = 0;
+	uint32_t encryption_method     = 0;
+
+	if( layout == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout.",
+		 function );
+
+		return( -1 );
+	}
+	/* The backing filename is stored after the file header and for format version 2 and 3
+	 * after the header extension that marks the end of the header extensions
+	 */
+	if( layout->format_version == 1 )
+	{
+		backing_filename_offset = sizeof( qcow_file_header_v1_t );
+	}
+	else if( layout->format_version == 2 )
+	{
+		backing_filename_offset = sizeof( qcow_file_header_v2_t ) + 8;
+	}
+	else
+	{
+		backing_filename_offset = sizeof( qcow_file_header_v3_t ) + 8;
+	}
+	if( backing_filename_size > ( layout->cluster_block_size - backing_filename_offset ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_VALUE_TOO_LARGE,
+		 "%s: invalid backing filename size value too large.",
+		 function );
+
+		goto on_error;
+	}
+	file_header_data = (uint8_t *) memory_allocate(
+	                                layout->cluster_block_size );
+
+	if( file_header_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create file header data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     file_header_data,
+	     0,
+	     layout->cluster_block_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear file header data.",
+		 function );
+
+		goto on_error;
+	}
+	if( layout->key_is_set != 0 )
+	{
+		encryption_method = LIBQCOW_ENCRYPTION_METHOD_AES_128_CBC;
+	}
+	if( backing_filename_size == 0 )
+	{
+		backing_filename_offset = 0;
+	}
+	else if( memory_copy(
+	          &( file_header_data[ backing_filename_offset ] ),
+	          backing_filename,
+	          backing_filename_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_COPY_FAILED,
+		 "%s: unable to copy backing filename.",
+		 function );
+
+		goto on_error;
+	}
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v1_t *) file_header_data )->signature,
+	 0x514649fbUL );
+
+	byte_stream_copy_from_uint32_big_endian(
+	 ( (qcow_file_header_v1_t *) file_header_data )->format_version,
+	 layout->format_version );
+
+	if( layout->format_version == 1 )
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->backing_filename_offset,
+		 (uint64_t) backing_filename_offset );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->backing_filename_size,
+		 (uint32_t) backing_filename_size );
+
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->media_size,
+		 layout->media_size );
+
+		( (qcow_file_header_v1_t *) file_header_data )->number_of_cluster_block_bits = layout->number_of_cluster_block_bits;
+		( (qcow_file_header_v1_t *) file_header_data )->number_of_level2_table_bits  = layout->number_of_cluster_block_bits - 3;
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->encryption_method,
+		 encryption_method );
+
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v1_t *) file_header_data )->level1_table_offset,
+		 level1_table_offset );
+	}
+	else
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->backing_filename_offset,
+		 (uint64_t) backing_filename_offset );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->backing_filename_size,
+		 (uint32_t) backing_filename_size );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->number_of_cluster_block_bits,
+		 (uint32_t) layout->number_of_cluster_block_bits );
+
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->media_size,
+		 layout->media_size );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->encryption_method,
+		 encryption_method );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->number_of_level1_table_references,
+		 number_of_level1_table_references );
+
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->level1_table_offset,
+		 level1_table_offset );
+
+		byte_stream_copy_from_uint64_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_offset,
+		 reference_count_table_offset );
+
+		byte_stream_copy_from_uint32_big_endian(
+		 ( (qcow_file_header_v2_t *) file_header_data )->reference_count_table_clusters,
+		 reference_count_table_clusters );
+
+		if( layout->format_version == 3 )
+		{
+			/* A reference count order of 4 corresponds to 16-bit reference counts
+			 * and the header size includes the compression type, where 0 is deflate
+			 */
+			byte_stream_copy_from_uint32_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->reference_count_order,
+			 4 );
+
+			byte_stream_copy_from_uint32_big_endian(
+			 ( (qcow_file_header_v3_t *) file_header_data )->header_size,
+			 (uint32_t) sizeof( qcow_file_header_v3_t ) );
+
+			( (qcow_file_header_v3_t *) file_header_data )->compression_type = 0;
+		}
+	}
+	if( qcow_generate_write_at_offset(
+	     file_io_handle,
+	     file_header_data,
+	     layout->cluster_block_size,
+	     0,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 file_header_data );
+
+	return( 1 );
+
+on_error:
+	if( file_header_data != NULL )
+	{
+		memory_free(
+		 file_header_data );
+	}
+	return( -1 );
+}
+
+/* Writes the reference count blocks and table
+ * Every host cluster up to the end of the file has a reference count of 1
+ * except for the clusters that contain compressed data which are counted per compressed cluster block
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_write_reference_counts(
+     qcow_generate_layout_t *layout,
+     libbfio_handle_t *file_io_handle,
+     const uint16_t *data_reference_counts,
+     uint64_t data_cluster_index,
+     uint64_t number_of_clusters,
+     uint64_t *reference_count_table_offset,
+     uint32_t *reference_count_table_clusters,
+     libcerror_error_t **error )
+{
+	uint8_t *reference_count_blocks_data       = NULL;
+	uint8_t *reference_count_table_data        = NULL;
+	static char *function                      = "qcow_generate_write_reference_counts";
+	size_t reference_count_block_entries       = 0;
+	uint64_t block_index                       = 0;
+	uint64_t cluster_index                     = 0;
+	uint64_t number_of_blocks                  = 1;
+	uint64_t number_of_table_clusters          = 1;
+	uint64_t required_number_of_blocks         = 0;
+	uint64_t required_number_of_table_clusters = 0;
+	uint64_t total_number_of_clusters          = 0;
+	uint16_t reference_count                   = 0;
+
+	if( layout == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout.",
+		 function );
+
+		return( -1 );
+	}
+	reference_count_block_entries = layout->cluster_block_size / 2;
+
+	/* The reference count blocks and table are stored after the data
+	 * and need to cover themselves
+	 */
+	do
+	{
+		total_number_of_clusters = number_of_clusters + number_of_blocks + number_of_table_clusters;
+
+		required_number_of_blocks         = ( total_number_of_clusters + reference_count_block_entries - 1 ) / reference_count_block_entries;
+		required_number_of_table_clusters = ( ( required_number_of_blocks * 8 ) + layout->cluster_block_size - 1 ) / layout->cluster_block_size;
+
+		if( ( required_number_of_blocks <= number_of_blocks )
+		 && ( required_number_of_table_clusters <= number_of_table_clusters ) )
+		{
+			break;
+		}
+		number_of_blocks         = required_number_of_blocks;
+		number_of_table_clusters = required_number_of_table_clusters;
+	}
+	while( 1 );
+
+	if( number_of_table_clusters > (uint64_t) UINT32_MAX )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid number of reference count table clusters value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	reference_count_blocks_data = (uint8_t *) memory_allocate(
+	                                           (size_t) ( number_of_blocks * layout->cluster_block_size ) );
+
+	if( reference_count_blocks_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count blocks data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     reference_count_blocks_data,
+	     0,
+	     (size_t) ( number_of_blocks * layout->cluster_block_size ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count blocks data.",
+		 function );
+
+		goto on_error;
+	}
+	reference_count_table_data = (uint8_t *) memory_allocate(
+	                                          (size_t) ( number_of_table_clusters * layout->cluster_block_size ) );
+
+	if( reference_count_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create reference count table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     reference_count_table_data,
+	     0,
+	     (size_t) ( number_of_table_clusters * layout->cluster_block_size ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear reference count table data.",
+		 function );
+
+		goto on_error;
+	}
+	for( cluster_index = 0;
+	     cluster_index < total_number_of_clusters;
+	     cluster_index++ )
+	{
+		if( ( cluster_index >= data_cluster_index )
+		 && ( cluster_index < number_of_clusters ) )
+		{
+			reference_count = data_reference_counts[ cluster_index - data_cluster_index ];
+		}
+		else
+		{
+			reference_count = 1;
+		}
+		byte_stream_copy_from_uint16_big_endian(
+		 &( reference_count_blocks_data[ cluster_index * 2 ] ),
+		 reference_count );
+	}
+	for( block_index = 0;
+	     block_index < number_of_blocks;
+	     block_index++ )
+	{
+		byte_stream_copy_from_uint64_big_endian(
+		 &( reference_count_table_data[ block_index * 8 ] ),
+		 ( number_of_clusters + block_index ) << layout->number_of_cluster_block_bits );
+	}
+	if( qcow_generate_write_at_offset(
+	     file_io_handle,
+	     reference_count_blocks_data,
+	     (size_t) ( number_of_blocks * layout->cluster_block_size ),
+	     (off64_t) ( number_of_clusters << layout->number_of_cluster_block_bits ),
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reference count blocks.",
+		 function );
+
+		goto on_error;
+	}
+	*reference_count_table_offset   = ( number_of_clusters + number_of_blocks ) << layout->number_of_cluster_block_bits;
+	*reference_count_table_clusters = (uint32_t) number_of_table_clusters;
+
+	if( qcow_generate_write_at_offset(
+	     file_io_handle,
+	     reference_count_table_data,
+	     (size_t) ( number_of_table_clusters * layout->cluster_block_size ),
+	     (off64_t) *reference_count_table_offset,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write reference count table.",
+		 function );
+
+		goto on_error;
+	}
+	memory_free(
+	 reference_count_table_data );
+
+	memory_free(
+	 reference_count_blocks_data );
+
+	return( 1 );
+
+on_error:
+	if( reference_count_table_data != NULL )
+	{
+		memory_free(
+		 reference_count_table_data );
+	}
+	if( reference_count_blocks_data != NULL )
+	{
+		memory_free(
+		 reference_count_blocks_data );
+	}
+	return( -1 );
+}
+
+/* Writes an image
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_generate_write_image(
+     qcow_generate_layout_t *layout,
+     int image_index,
+     const system_character_t *filename,
+     const uint8_t *backing_filename,
+     size_t backing_filename_size,
+     libcerror_error_t **error )
+{
+	qcow_generate_writer_t writer;
+
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+	z_stream zlib_stream;
+#endif
+
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+	libqcow_encryption_context_t *encryption_context = NULL;
+#endif
+
+	libbfio_handle_t *file_io_handle               = NULL;
+	uint8_t *cluster_block_data                    = NULL;
+	uint8_t *level1_table_data                     = NULL;
+	uint8_t *level2_tables_data                    = NULL;
+	uint8_t *output_data                           = NULL;
+	uint16_t *data_reference_counts                = NULL;
+	uint64_t *cluster_block_indexes                = NULL;
+	static char *function                          = "qcow_generate_write_image";
+	size_t level1_table_data_size                  = 0;
+	size_t output_data_size                        = 0;
+	uint64_t cluster_block_file_offset             = 0;
+	uint64_t cluster_block_index                   = 0;
+	uint64_t cluster_block_reference               = 0;
+	uint64_t copied_flag                           = 0;
+	uint64_t data_cluster_index                    = 0;
+	uint64_t file_offset                           = 0;
+	uint64_t host_cluster_index                    = 0;
+	uint64_t last_host_cluster_index               = 0;
+	uint64_t level1_table_index                    = 0;
+	uint64_t level1_table_size                     = 0;
+	uint64_t level2_table_entries                  = 0;
+	uint64_t maximum_number_of_data_clusters       = 0;
+	uint64_t number_of_allocated_cluster_blocks    = 0;
+	uint64_t number_of_cluster_blocks              = 0;
+	uint64_t number_of_compressed_cluster_blocks   = 0;
+	uint64_t number_of_clusters                    = 0;
+	uint64_t number_of_sectors                     = 0;
+	uint64_t random_state                          = 0;
+	uint64_t random_value                          = 0;
+	uint64_t reference_count_table_offset          = 0;
+	uint64_t swap_index                            = 0;
+	uint64_t value_index                           = 0;
+	uint32_t reference_count_table_clusters        = 0;
+	int allocation_percentage                      = 0;
+
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+	int zlib_stream_initialized                    = 0;
+#endif
+
+	if( layout == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_ARGUMENTS,
+		 LIBCERROR_ARGUMENT_ERROR_INVALID_VALUE,
+		 "%s: invalid layout.",
+		 function );
+
+		return( -1 );
+	}
+	if( memory_set(
+	     &writer,
+	     0,
+	     sizeof( qcow_generate_writer_t ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear writer.",
+		 function );
+
+		return( -1 );
+	}
+	level2_table_entries     = (uint64_t) layout->cluster_block_size / 8;
+	number_of_cluster_blocks = ( layout->media_size + layout->cluster_block_size - 1 ) >> layout->number_of_cluster_block_bits;
+	level1_table_size        = ( number_of_cluster_blocks + level2_table_entries - 1 ) / level2_table_entries;
+
+	if( ( level1_table_size == 0 )
+	 || ( level1_table_size > (uint64_t) ( UINT32_MAX / 8 ) )
+	 || ( number_of_cluster_blocks > (uint64_t) ( SSIZE_MAX / 8 ) ) )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_VALUE_OUT_OF_BOUNDS,
+		 "%s: invalid level 1 table size value out of bounds.",
+		 function );
+
+		goto on_error;
+	}
+	if( image_index == 0 )
+	{
+		allocation_percentage = 100 - layout->sparse_percentage;
+	}
+	else
+	{
+		allocation_percentage = layout->overlay_percentage;
+	}
+	/* Version 2 and 3 flag the level 1 and 2 table references that have a reference count of 1
+	 * while in version 1 the most significant bit is the compression flag
+	 */
+	if( layout->format_version != 1 )
+	{
+		copied_flag = (uint64_t) 1 << 63;
+	}
+	/* Determine which cluster blocks are allocated
+	 */
+	cluster_block_indexes = (uint64_t *) memory_allocate(
+	                                      (size_t) ( number_of_cluster_blocks * sizeof( uint64_t ) ) );
+
+	if( cluster_block_indexes == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block indexes.",
+		 function );
+
+		goto on_error;
+	}
+	random_state = qcow_generate_get_random_state(
+	                layout->seed,
+	                (uint64_t) image_index,
+	                UINT64_MAX );
+
+	for( cluster_block_index = 0;
+	     cluster_block_index < number_of_cluster_blocks;
+	     cluster_block_index++ )
+	{
+		random_value = qcow_generate_get_random_value(
+		                &random_state );
+
+		if( (int) ( ( random_value >> 32 ) % 100 ) < allocation_percentage )
+		{
+			cluster_block_indexes[ number_of_allocated_cluster_blocks++ ] = cluster_block_index;
+		}
+	}
+	/* Fragment the layout by moving cluster blocks out of media order
+	 */
+	if( layout->fragmentation_percentage > 0 )
+	{
+		for( value_index = 0;
+		     value_index < number_of_allocated_cluster_blocks;
+		     value_index++ )
+		{
+			random_value = qcow_generate_get_random_value(
+			                &random_state );
+
+			if( (int) ( ( random_value >> 32 ) % 100 ) >= layout->fragmentation_percentage )
+			{
+				continue;
+			}
+			random_value = qcow_generate_get_random_value(
+			                &random_state );
+
+			swap_index = value_index + ( random_value % ( number_of_allocated_cluster_blocks - value_index ) );
+
+			cluster_block_index                       = cluster_block_indexes[ swap_index ];
+			cluster_block_indexes[ swap_index ]       = cluster_block_indexes[ value_index ];
+			cluster_block_indexes[ value_index ]      = cluster_block_index;
+		}
+	}
+	/* The level 2 tables are stored consecutively in memory
+	 * only the tables that contain references are written
+	 */
+	level1_table_data_size = (size_t) ( level1_table_size * 8 );
+
+	level1_table_data = (uint8_t *) memory_allocate(
+	                                 level1_table_data_size );
+
+	if( level1_table_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 1 table data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     level1_table_data,
+	     0,
+	     level1_table_data_size ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear level 1 table data.",
+		 function );
+
+		goto on_error;
+	}
+	level2_tables_data = (uint8_t *) memory_allocate(
+	                                  (size_t) ( level1_table_size * layout->cluster_block_size ) );
+
+	if( level2_tables_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create level 2 tables data.",
+		 function );
+
+		goto on_error;
+	}
+	if( memory_set(
+	     level2_tables_data,
+	     0,
+	     (size_t) ( level1_table_size * layout->cluster_block_size ) ) == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+		 "%s: unable to clear level 2 tables data.",
+		 function );
+
+		goto on_error;
+	}
+	/* The file header is stored in the first cluster followed by the level 1 table
+	 * the level 2 tables and the cluster blocks
+	 */
+	file_offset  = layout->cluster_block_size;
+	file_offset += ( level1_table_data_size + layout->cluster_block_size - 1 ) & ~( (uint64_t) layout->cluster_block_size - 1 );
+
+	for( value_index = 0;
+	     value_index < number_of_allocated_cluster_blocks;
+	     value_index++ )
+	{
+		level1_table_index = cluster_block_indexes[ value_index ] / level2_table_entries;
+
+		byte_stream_copy_to_uint64_big_endian(
+		 &( level1_table_data[ level1_table_index * 8 ] ),
+		 cluster_block_reference );
+
+		if( cluster_block_reference == 0 )
+		{
+			byte_stream_copy_from_uint64_big_endian(
+			 &( level1_table_data[ level1_table_index * 8 ] ),
+			 file_offset | copied_flag );
+
+			file_offset += layout->cluster_block_size;
+		}
+	}
+	data_cluster_index = file_offset >> layout->number_of_cluster_block_bits;
+
+	/* Every cluster block occupies at most 2 host clusters
+	 */
+	maximum_number_of_data_clusters = ( number_of_allocated_cluster_blocks * 2 ) + 1;
+
+	if( layout->format_version != 1 )
+	{
+		data_reference_counts = (uint16_t *) memory_allocate(
+		                                      (size_t) ( maximum_number_of_data_clusters * sizeof( uint16_t ) ) );
+
+		if( data_reference_counts == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+			 "%s: unable to create data reference counts.",
+			 function );
+
+			goto on_error;
+		}
+		if( memory_set(
+		     data_reference_counts,
+		     0,
+		     (size_t) ( maximum_number_of_data_clusters * sizeof( uint16_t ) ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear data reference counts.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	cluster_block_data = (uint8_t *) memory_allocate(
+	                                  layout->cluster_block_size );
+
+	if( cluster_block_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create cluster block data.",
+		 function );
+
+		goto on_error;
+	}
+	output_data = (uint8_t *) memory_allocate(
+	                           layout->cluster_block_size );
+
+	if( output_data == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create output data.",
+		 function );
+
+		goto on_error;
+	}
+	writer.buffer = (uint8_t *) memory_allocate(
+	                             QCOW_GENERATE_WRITE_BUFFER_SIZE );
+
+	if( writer.buffer == NULL )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_MEMORY,
+		 LIBCERROR_MEMORY_ERROR_INSUFFICIENT,
+		 "%s: unable to create write buffer.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+	if( layout->compressed_percentage > 0 )
+	{
+		if( memory_set(
+		     &zlib_stream,
+		     0,
+		     sizeof( z_stream ) ) == NULL )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_MEMORY,
+			 LIBCERROR_MEMORY_ERROR_SET_FAILED,
+			 "%s: unable to clear zlib stream.",
+			 function );
+
+			goto on_error;
+		}
+		/* QCOW uses a raw deflate stream with a window of 4 KiB
+		 */
+		if( deflateInit2(
+		     &zlib_stream,
+		     Z_DEFAULT_COMPRESSION,
+		     Z_DEFLATED,
+		     -12,
+		     9,
+		     Z_DEFAULT_STRATEGY ) != Z_OK )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+			 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+			 "%s: unable to initialize zlib stream.",
+			 function );
+
+			goto on_error;
+		}
+		zlib_stream_initialized = 1;
+	}
+#endif
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+	if( layout->key_is_set != 0 )
+	{
+		if( libqcow_encryption_initialize(
+		     &encryption_context,
+		     LIBQCOW_ENCRYPTION_METHOD_AES_128_CBC,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+			 "%s: unable to initialize encryption context.",
+			 function );
+
+			goto on_error;
+		}
+		if( libqcow_encryption_set_keys(
+		     encryption_context,
+		     layout->key,
+		     16,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+			 "%s: unable to set encryption keys.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#endif
+	if( libbfio_file_initialize(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_INITIALIZE_FAILED,
+		 "%s: unable to initialize file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	if( libbfio_file_set_name_wide(
+	     file_io_handle,
+	     filename,
+	     system_string_length(
+	      filename ),
+	     error ) != 1 )
+#else
+	if( libbfio_file_set_name(
+	     file_io_handle,
+	     filename,
+	     system_string_length(
+	      filename ),
+	     error ) != 1 )
+#endif
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_SET_FAILED,
+		 "%s: unable to set filename.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_open(
+	     file_io_handle,
+	     LIBBFIO_OPEN_WRITE_TRUNCATE,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_OPEN_FAILED,
+		 "%s: unable to open file.",
+		 function );
+
+		goto on_error;
+	}
+	writer.file_io_handle = file_io_handle;
+	writer.file_offset    = (off64_t) file_offset;
+
+	/* Write the cluster blocks in host order
+	 */
+	for( value_index = 0;
+	     value_index < number_of_allocated_cluster_blocks;
+	     value_index++ )
+	{
+		cluster_block_index = cluster_block_indexes[ value_index ];
+
+		random_state = qcow_generate_get_random_state(
+		                layout->seed,
+		                (uint64_t) image_index,
+		                cluster_block_index );
+
+		/* The first random value determines if the cluster block is compressed
+		 */
+		random_value = qcow_generate_get_random_value(
+		                &random_state );
+
+		qcow_generate_fill_cluster_block(
+		 cluster_block_data,
+		 layout->cluster_block_size,
+		 layout->compressibility_percentage,
+		 &random_state );
+
+		output_data_size = 0;
+
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+		if( (int) ( ( random_value >> 32 ) % 100 ) < layout->compressed_percentage )
+		{
+			if( deflateReset(
+			     &zlib_stream ) != Z_OK )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_COMPRESSION,
+				 LIBCERROR_COMPRESSION_ERROR_COMPRESS_FAILED,
+				 "%s: unable to reset zlib stream.",
+				 function );
+
+				goto on_error;
+			}
+			zlib_stream.next_in   = (Bytef *) cluster_block_data;
+			zlib_stream.avail_in  = (uInt) layout->cluster_block_size;
+			zlib_stream.next_out  = (Bytef *) output_data;
+			zlib_stream.avail_out = (uInt) ( layout->cluster_block_size - 1 );
+
+			/* Data that does not compress to less than the cluster block size is stored uncompressed
+			 */
+			if( deflate(
+			     &zlib_stream,
+			     Z_FINISH ) == Z_STREAM_END )
+			{
+				output_data_size = (size_t) zlib_stream.total_out;
+			}
+		}
+#endif
+		if( output_data_size > 0 )
+		{
+			cluster_block_file_offset = (uint64_t) writer.file_offset + writer.buffer_data_size;
+
+			if( layout->format_version == 1 )
+			{
+				cluster_block_reference = ( (uint64_t) 1 << 63 )
+				                        | ( (uint64_t) output_data_size << ( 63 - layout->number_of_cluster_block_bits ) )
+				                        | cluster_block_file_offset;
+			}
+			else
+			{
+				/* The number of additional 512-byte sectors that contain compressed data
+				 */
+				number_of_sectors = ( ( cluster_block_file_offset + output_data_size - 1 ) >> 9 )
+				                  - ( cluster_block_file_offset >> 9 );
+
+				cluster_block_reference = ( (uint64_t) 1 << 62 )
+				                        | ( number_of_sectors << ( 62 - ( layout->number_of_cluster_block_bits - 8 ) ) )
+				                        | cluster_block_file_offset;
+			}
+			number_of_compressed_cluster_blocks++;
+		}
+		else
+		{
+			if( qcow_generate_writer_align(
+			     &writer,
+			     layout->cluster_block_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to align writer.",
+				 function );
+
+				goto on_error;
+			}
+			cluster_block_file_offset = (uint64_t) writer.file_offset + writer.buffer_data_size;
+			cluster_block_reference   = cluster_block_file_offset | copied_flag;
+
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+			if( encryption_context != NULL )
+			{
+				/* The initialization vector is the index of the 512-byte sector in the media
+				 */
+				if( libqcow_encryption_crypt(
+				     encryption_context,
+				     LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT,
+				     cluster_block_data,
+				     layout->cluster_block_size,
+				     output_data,
+				     layout->cluster_block_size,
+				     ( cluster_block_index << layout->number_of_cluster_block_bits ) / 512,
+				     error ) != 1 )
+				{
+					libcerror_error_set(
+					 error,
+					 LIBCERROR_ERROR_DOMAIN_ENCRYPTION,
+					 LIBCERROR_ENCRYPTION_ERROR_ENCRYPT_FAILED,
+					 "%s: unable to encrypt cluster block: %" PRIu64 ".",
+					 function,
+					 cluster_block_index );
+
+					goto on_error;
+				}
+				output_data_size = layout->cluster_block_size;
+			}
+#endif
+		}
+		if( output_data_size > 0 )
+		{
+			if( qcow_generate_writer_append(
+			     &writer,
+			     output_data,
+			     output_data_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+
+				goto on_error;
+			}
+		}
+		else
+		{
+			output_data_size = layout->cluster_block_size;
+
+			if( qcow_generate_writer_append(
+			     &writer,
+			     cluster_block_data,
+			     output_data_size,
+			     error ) != 1 )
+			{
+				libcerror_error_set(
+				 error,
+				 LIBCERROR_ERROR_DOMAIN_IO,
+				 LIBCERROR_IO_ERROR_WRITE_FAILED,
+				 "%s: unable to write cluster block: %" PRIu64 ".",
+				 function,
+				 cluster_block_index );
+
+				goto on_error;
+			}
+		}
+		if( data_reference_counts != NULL )
+		{
+			host_cluster_index      = cluster_block_file_offset >> layout->number_of_cluster_block_bits;
+			last_host_cluster_index = ( cluster_block_file_offset + output_data_size - 1 ) >> layout->number_of_cluster_block_bits;
+
+			while( host_cluster_index <= last_host_cluster_index )
+			{
+				data_reference_counts[ host_cluster_index - data_cluster_index ] += 1;
+
+				host_cluster_index++;
+			}
+		}
+		byte_stream_copy_from_uint64_big_endian(
+		 &( level2_tables_data[ cluster_block_index * 8 ] ),
+		 cluster_block_reference );
+	}
+	if( qcow_generate_writer_align(
+	     &writer,
+	     layout->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to align writer.",
+		 function );
+
+		goto on_error;
+	}
+	if( qcow_generate_writer_flush(
+	     &writer,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to flush writer.",
+		 function );
+
+		goto on_error;
+	}
+	number_of_clusters = (uint64_t) writer.file_offset >> layout->number_of_cluster_block_bits;
+
+	/* Write the level 1 and 2 tables
+	 */
+	for( level1_table_index = 0;
+	     level1_table_index < level1_table_size;
+	     level1_table_index++ )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 &( level1_table_data[ level1_table_index * 8 ] ),
+		 file_offset );
+
+		if( file_offset == 0 )
+		{
+			continue;
+		}
+		file_offset &= ~copied_flag;
+
+		if( qcow_generate_write_at_offset(
+		     file_io_handle,
+		     &( level2_tables_data[ level1_table_index * layout->cluster_block_size ] ),
+		     layout->cluster_block_size,
+		     (off64_t) file_offset,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write level 2 table: %" PRIu64 ".",
+			 function,
+			 level1_table_index );
+
+			goto on_error;
+		}
+	}
+	if( qcow_generate_write_at_offset(
+	     file_io_handle,
+	     level1_table_data,
+	     level1_table_data_size,
+	     (off64_t) layout->cluster_block_size,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write level 1 table.",
+		 function );
+
+		goto on_error;
+	}
+	if( layout->format_version != 1 )
+	{
+		if( qcow_generate_write_reference_counts(
+		     layout,
+		     file_io_handle,
+		     data_reference_counts,
+		     data_cluster_index,
+		     number_of_clusters,
+		     &reference_count_table_offset,
+		     &reference_count_table_clusters,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_IO,
+			 LIBCERROR_IO_ERROR_WRITE_FAILED,
+			 "%s: unable to write reference counts.",
+			 function );
+
+			goto on_error;
+		}
+	}
+	if( qcow_generate_write_file_header(
+	     layout,
+	     file_io_handle,
+	     backing_filename,
+	     backing_filename_size,
+	     (uint32_t) level1_table_size,
+	     (uint64_t) layout->cluster_block_size,
+	     reference_count_table_offset,
+	     reference_count_table_clusters,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_WRITE_FAILED,
+		 "%s: unable to write file header.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_close(
+	     file_io_handle,
+	     error ) != 0 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_IO,
+		 LIBCERROR_IO_ERROR_CLOSE_FAILED,
+		 "%s: unable to close file.",
+		 function );
+
+		goto on_error;
+	}
+	if( libbfio_handle_free(
+	     &file_io_handle,
+	     error ) != 1 )
+	{
+		libcerror_error_set(
+		 error,
+		 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+		 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+		 "%s: unable to free file IO handle.",
+		 function );
+
+		goto on_error;
+	}
+	fprintf(
+	 stdout,
+	 "%" PRIs_SYSTEM ": format version: %" PRIu32 ", media size: %" PRIu64 ", cluster size: %" PRIzd ", allocated clusters: %" PRIu64 " of %" PRIu64 ", compressed clusters: %" PRIu64 "\n",
+	 filename,
+	 layout->format_version,
+	 layout->media_size,
+	 layout->cluster_block_size,
+	 number_of_allocated_cluster_blocks,
+	 number_of_cluster_blocks,
+	 number_of_compressed_cluster_blocks );
+
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+	if( encryption_context != NULL )
+	{
+		if( libqcow_encryption_free(
+		     &encryption_context,
+		     error ) != 1 )
+		{
+			libcerror_error_set(
+			 error,
+			 LIBCERROR_ERROR_DOMAIN_RUNTIME,
+			 LIBCERROR_RUNTIME_ERROR_FINALIZE_FAILED,
+			 "%s: unable to free encryption context.",
+			 function );
+
+			goto on_error;
+		}
+	}
+#endif
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+	if( zlib_stream_initialized != 0 )
+	{
+		deflateEnd(
+		 &zlib_stream );
+
+		zlib_stream_initialized = 0;
+	}
+#endif
+	memory_free(
+	 writer.buffer );
+
+	memory_free(
+	 output_data );
+
+	memory_free(
+	 cluster_block_data );
+
+	if( data_reference_counts != NULL )
+	{
+		memory_free(
+		 data_reference_counts );
+	}
+	memory_free(
+	 level2_tables_data );
+
+	memory_free(
+	 level1_table_data );
+
+	memory_free(
+	 cluster_block_indexes );
+
+	return( 1 );
+
+on_error:
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+	if( encryption_context != NULL )
+	{
+		libqcow_encryption_free(
+		 &encryption_context,
+		 NULL );
+	}
+#endif
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+	if( zlib_stream_initialized != 0 )
+	{
+		deflateEnd(
+		 &zlib_stream );
+	}
+#endif
+	if( writer.buffer != NULL )
+	{
+		memory_free(
+		 writer.buffer );
+	}
+	if( output_data != NULL )
+	{
+		memory_free(
+		 output_data );
+	}
+	if( cluster_block_data != NULL )
+	{
+		memory_free(
+		 cluster_block_data );
+	}
+	if( data_reference_counts != NULL )
+	{
+		memory_free(
+		 data_reference_counts );
+	}
+	if( level2_tables_data != NULL )
+	{
+		memory_free(
+		 level2_tables_data );
+	}
+	if( level1_table_data != NULL )
+	{
+		memory_free(
+		 level1_table_data );
+	}
+	if( cluster_block_indexes != NULL )
+	{
+		memory_free(
+		 cluster_block_indexes );
+	}
+	return( -1 );
+}
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc,
+     wchar_t * const argv[] )
+#else
+int main(
+     int argc,
+     char * const argv[] )
+#endif
+{
+	uint8_t backing_filename[ 256 ];
+
+	qcow_generate_layout_t layout;
+
+	system_character_t *filenames[ QCOW_GENERATE_MAXIMUM_CHAIN_DEPTH ];
+
+	libcerror_error_t *error            = NULL;
+	system_character_t *option_password = NULL;
+	system_character_t *target          = NULL;
+	size_t backing_filename_size        = 0;
+	size_t basename_index               = 0;
+	size_t filename_length              = 0;
+	size_t password_length              = 0;
+	size_t target_length                = 0;
+	uint64_t value_64bit                = 0;
+	system_integer_t option             = 0;
+	int chain_depth                     = 1;
+	int image_index                     = 0;
+
+	if( memory_set(
+	     &layout,
+	     0,
+	     sizeof( qcow_generate_layout_t ) ) == NULL )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to clear layout.\n" );
+
+		return( EXIT_FAILURE );
+	}
+	if( memory_set(
+	     filenames,
+	     0,
+	     sizeof( system_character_t * ) * QCOW_GENERATE_MAXIMUM_CHAIN_DEPTH ) == NULL )
+	{
+		fprintf(
+		 stderr,
+		 "Unable to clear filenames.\n" );
+
+		return( EXIT_FAILURE );
+	}
+	layout.format_version               = 2;
+	layout.media_size                   = QCOW_GENERATE_DEFAULT_MEDIA_SIZE;
+	layout.number_of_cluster_block_bits = QCOW_GENERATE_DEFAULT_CLUSTER_BLOCK_BITS;
+	layout.overlay_percentage           = 10;
+	layout.compressibility_percentage   = 50;
+	layout.seed                         = 1;
+
+	while( ( option = qcow_test_getopt(
+	                   argc,
+	                   argv,
+	                   _SYSTEM_STRING( "c:C:d:f:F:ho:p:r:s:S:x:" ) ) ) != (system_integer_t) -1 )
+	{
+		switch( option )
+		{
+			case (system_integer_t) '?':
+			default:
+				fprintf(
+				 stderr,
+				 "Invalid argument: %" PRIs_SYSTEM ".\n",
+				 argv[ optind - 1 ] );
+
+				qcow_generate_usage_fprint(
+				 stdout );
+
+				return( EXIT_FAILURE );
+
+			case (system_integer_t) 'c':
+				if( qcow_generate_copy_size_from_string(
+				     optarg,
+				     &value_64bit ) != 1 )
+				{
+					value_64bit = 0;
+				}
+				for( layout.number_of_cluster_block_bits = 9;
+				     layout.number_of_cluster_block_bits <= 21;
+				     layout.number_of_cluster_block_bits++ )
+				{
+					if( value_64bit == ( (uint64_t) 1 << layout.number_of_cluster_block_bits ) )
+					{
+						break;
+					}
+				}
+				if( layout.number_of_cluster_block_bits > 21 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported cluster size: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'C':
+				if( qcow_generate_copy_percentage_from_string(
+				     optarg,
+				     &( layout.compressed_percentage ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported compressed percentage: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'd':
+				if( ( qcow_generate_copy_decimal_from_string(
+				       optarg,
+				       &value_64bit ) != 1 )
+				 || ( value_64bit == 0 )
+				 || ( value_64bit > QCOW_GENERATE_MAXIMUM_CHAIN_DEPTH ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported depth: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				chain_depth = (int) value_64bit;
+
+				break;
+
+			case (system_integer_t) 'f':
+				if( ( qcow_generate_copy_decimal_from_string(
+				       optarg,
+				       &value_64bit ) != 1 )
+				 || ( value_64bit == 0 )
+				 || ( value_64bit > 3 ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported format version: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				layout.format_version = (uint32_t) value_64bit;
+
+				break;
+
+			case (system_integer_t) 'F':
+				if( qcow_generate_copy_percentage_from_string(
+				     optarg,
+				     &( layout.fragmentation_percentage ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported fragmentation percentage: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'h':
+				qcow_generate_usage_fprint(
+				 stdout );
+
+				return( EXIT_SUCCESS );
+
+			case (system_integer_t) 'o':
+				if( qcow_generate_copy_percentage_from_string(
+				     optarg,
+				     &( layout.overlay_percentage ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported overlay percentage: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'p':
+				option_password = optarg;
+
+				break;
+
+			case (system_integer_t) 'r':
+				if( qcow_generate_copy_percentage_from_string(
+				     optarg,
+				     &( layout.compressibility_percentage ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported compressibility percentage: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 's':
+				if( ( qcow_generate_copy_size_from_string(
+				       optarg,
+				       &( layout.media_size ) ) != 1 )
+				 || ( layout.media_size == 0 )
+				 || ( layout.media_size > (size64_t) INT64_MAX ) )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported media size: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'S':
+				if( qcow_generate_copy_percentage_from_string(
+				     optarg,
+				     &( layout.sparse_percentage ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported sparse percentage: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+
+			case (system_integer_t) 'x':
+				if( qcow_generate_copy_decimal_from_string(
+				     optarg,
+				     &( layout.seed ) ) != 1 )
+				{
+					fprintf(
+					 stderr,
+					 "Unsupported seed: %" PRIs_SYSTEM ".\n",
+					 optarg );
+
+					return( EXIT_FAILURE );
+				}
+				break;
+		}
+	}
+	if( optind == argc )
+	{
+		fprintf(
+		 stderr,
+		 "Missing target file.\n" );
+
+		qcow_generate_usage_fprint(
+		 stdout );
+
+		return( EXIT_FAILURE );
+	}
+	target = argv[ optind ];
+
+	layout.cluster_block_size = (size_t) 1 << layout.number_of_cluster_block_bits;
+
+	/* Version 1 images with a cluster size larger than 64 KiB are not created by other implementations
+	 */
+	if( ( layout.format_version == 1 )
+	 && ( layout.number_of_cluster_block_bits > 16 ) )
+	{
+		fprintf(
+		 stderr,
+		 "Unsupported cluster size for format version 1.\n" );
+
+		return( EXIT_FAILURE );
+	}
+	if( option_password != NULL )
+	{
+#if defined( QCOW_GENERATE_HAVE_ENCRYPTION_SUPPORT )
+		password_length = system_string_length(
+		                   option_password );
+
+		/* The key consists of the first 16 characters of the password padded with zero bytes
+		 */
+		if( ( password_length == 0 )
+		 || ( qcow_generate_copy_ascii_from_system_string(
+		       layout.key,
+		       16,
+		       option_password,
+		       password_length ) != 1 ) )
+		{
+			fprintf(
+			 stderr,
+			 "Unsupported password, a password consists of 1 to 16 US-ASCII characters.\n" );
+
+			return( EXIT_FAILURE );
+		}
+		layout.key_is_set = 1;
+#else
+		fprintf(
+		 stderr,
+		 "No support for encryption.\n" );
+
+		return( EXIT_FAILURE );
+#endif
+	}
+	if( layout.compressed_percentage > 0 )
+	{
+#if defined( QCOW_GENERATE_HAVE_COMPRESSION_SUPPORT )
+		if( layout.key_is_set != 0 )
+		{
+			fprintf(
+			 stderr,
+			 "Compressed clusters cannot be encrypted.\n" );
+
+			return( EXIT_FAILURE );
+		}
+#else
+		fprintf(
+		 stderr,
+		 "No support for compression.\n" );
+
+		return( EXIT_FAILURE );
+#endif
+	}
+	/* The images in the backing file chain are named target.0, target.1, etc.
+	 * with the target itself being the top of the chain
+	 */
+	target_length = system_string_length(
+	                 target );
+
+	for( image_index = 0;
+	     image_index < chain_depth;
+	     image_index++ )
+	{
+		filenames[ image_index ] = system_string_allocate(
+		                            target_length + 4 );
+
+		if( filenames[ image_index ] == NULL )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to create filename.\n" );
+
+			goto on_error;
+		}
+		if( system_string_copy(
+		     filenames[ image_index ],
+		     target,
+		     target_length ) == NULL )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to copy filename.\n" );
+
+			goto on_error;
+		}
+		filename_length = target_length;
+
+		if( image_index < ( chain_depth - 1 ) )
+		{
+			filenames[ image_index ][ filename_length++ ] = (system_character_t) '.';
+
+			if( image_index >= 10 )
+			{
+				filenames[ image_index ][ filename_length++ ] = (system_character_t) '0' + ( image_index / 10 );
+			}
+			filenames[ image_index ][ filename_length++ ] = (system_character_t) '0' + ( image_index % 10 );
+		}
+		filenames[ image_index ][ filename_length ] = 0;
+	}
+	for( image_index = 0;
+	     image_index < chain_depth;
+	     image_index++ )
+	{
+		backing_filename_size = 0;
+
+		if( image_index > 0 )
+		{
+			/* The backing filename is relative to the directory of the image
+			 */
+			filename_length = system_string_length(
+			                   filenames[ image_index - 1 ] );
+
+			for( basename_index = filename_length;
+			     basename_index > 0;
+			     basename_index-- )
+			{
+				if( ( filenames[ image_index - 1 ][ basename_index - 1 ] == (system_character_t) '/' )
+#if defined( WINAPI )
+				 || ( filenames[ image_index - 1 ][ basename_index - 1 ] == (system_character_t) '\\' )
+#endif
+				 )
+				{
+					break;
+				}
+			}
+			backing_filename_size = filename_length - basename_index;
+
+			if( qcow_generate_copy_ascii_from_system_string(
+			     backing_filename,
+			     256,
+			     &( filenames[ image_index - 1 ][ basename_index ] ),
+			     backing_filename_size ) != 1 )
+			{
+				fprintf(
+				 stderr,
+				 "Unsupported target, the filename of a backing file must consist of at most 256 US-ASCII characters.\n" );
+
+				goto on_error;
+			}
+		}
+		if( qcow_generate_write_image(
+		     &layout,
+		     image_index,
+		     filenames[ image_index ],
+		     backing_filename,
+		     backing_filename_size,
+		     &error ) != 1 )
+		{
+			fprintf(
+			 stderr,
+			 "Unable to create image: %" PRIs_SYSTEM ".\n",
+			 filenames[ image_index ] );
+
+			goto on_error;
+		}
+	}
+	for( image_index = 0;
+	     image_index < chain_depth;
+	     image_index++ )
+	{
+		memory_free(
+		 filenames[ image_index ] );
+	}
+	return( EXIT_SUCCESS );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_backtrace_fprint(
+		 error,
+		 stderr );
+		libcerror_error_free(
+		 &error );
+	}
+	for( image_index = 0;
+	     image_index < chain_depth;
+	     image_index++ )
+	{
+		if( filenames[ image_index ] != NULL )
+		{
+			memory_free(
+			 filenames[ image_index ] );
+		}
+	}
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,396 @@
+/*
+ * Library address_split functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_address_split.h"
+#include "../libqcow/libqcow_io_handle.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_address_split_get_layout function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_address_split_get_layout(
+     void )
+{
+	int layout = 0;
+
+	/* Test regular cases
+	 */
+	layout = libqcow_address_split_get_layout(
+	          16,
+	          13,
+	          3,
+	          9 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout",
+	 layout,
+	 LIBQCOW_ADDRESS_SPLIT_LAYOUT_64K );
+
+	layout = libqcow_address_split_get_layout(
+	          21,
+	          18,
+	          3,
+	          9 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout",
+	 layout,
+	 LIBQCOW_ADDRESS_SPLIT_LAYOUT_2M );
+
+	/* Test cases that use the generic split
+	 */
+	layout = libqcow_address_split_get_layout(
+	          12,
+	          9,
+	          3,
+	          9 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout",
+	 layout,
+	 LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+
+	layout = libqcow_address_split_get_layout(
+	          16,
+	          12,
+	          4,
+	          8 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout",
+	 layout,
+	 LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+
+	layout = libqcow_address_split_get_layout(
+	          16,
+	          8,
+	          3,
+	          8 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout",
+	 layout,
+	 LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC );
+
+	return( 1 );
+
+on_error:
+	return( 0 );
+}
+
+/* Compares the specialized and generic split of offsets for a specific cluster block size
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_address_split_compare_with_generic(
+     libqcow_io_handle_t *io_handle,
+     uint32_t number_of_cluster_block_bits,
+     int expected_layout )
+{
+	libqcow_address_split_t generic_address_split;
+	libqcow_address_split_t specialized_address_split;
+	uint64_t offsets[ 5 ] = {
+		0, 512, 0x0000000000123456ULL, 0x0000004000000000ULL, 0x000001ffffffffffULL };
+
+	libcerror_error_t *error = NULL;
+	int offset_index         = 0;
+	int result               = 0;
+
+	io_handle->number_of_cluster_block_bits      = number_of_cluster_block_bits;
+	io_handle->number_of_level2_table_entry_bits = 3;
+	io_handle->number_of_level2_table_bits       = number_of_cluster_block_bits - 3;
+	io_handle->number_of_level2_table_slice_bits = io_handle->number_of_level2_table_bits;
+
+	if( io_handle->number_of_level2_table_slice_bits > LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS )
+	{
+		io_handle->number_of_level2_table_slice_bits = LIBQCOW_MAXIMUM_NUMBER_OF_LEVEL2_TABLE_SLICE_BITS;
+	}
+	io_handle->address_split_layout = libqcow_address_split_get_layout(
+	                                   io_handle->number_of_cluster_block_bits,
+	                                   io_handle->number_of_level2_table_bits,
+	                                   io_handle->number_of_level2_table_entry_bits,
+	                                   io_handle->number_of_level2_table_slice_bits );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "io_handle->address_split_layout",
+	 io_handle->address_split_layout,
+	 expected_layout );
+
+	for( offset_index = 0;
+	     offset_index < 5;
+	     offset_index++ )
+	{
+		io_handle->address_split_layout = expected_layout;
+
+		result = libqcow_address_split_offset(
+		          io_handle,
+		          offsets[ offset_index ],
+		          &specialized_address_split,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		io_handle->address_split_layout = LIBQCOW_ADDRESS_SPLIT_LAYOUT_GENERIC;
+
+		result = libqcow_address_split_offset(
+		          io_handle,
+		          offsets[ offset_index ],
+		          &generic_address_split,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.level1_table_index",
+		 specialized_address_split.level1_table_index,
+		 generic_address_split.level1_table_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.level2_table_index",
+		 specialized_address_split.level2_table_index,
+		 generic_address_split.level2_table_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.level2_table_slice_index",
+		 specialized_address_split.level2_table_slice_index,
+		 generic_address_split.level2_table_slice_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.level2_table_slice_offset",
+		 specialized_address_split.level2_table_slice_offset,
+		 generic_address_split.level2_table_slice_offset );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.level2_table_slice_reference_index",
+		 specialized_address_split.level2_table_slice_reference_index,
+		 generic_address_split.level2_table_slice_reference_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.cluster_block_data_offset",
+		 specialized_address_split.cluster_block_data_offset,
+		 generic_address_split.cluster_block_data_offset );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "specialized_address_split.cluster_block_data_offset",
+		 specialized_address_split.cluster_block_data_offset,
+		 ( offsets[ offset_index ] & ~( (uint64_t) -1 << number_of_cluster_block_bits ) ) );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_address_split_offset function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_address_split_offset(
+     void )
+{
+	libqcow_address_split_t address_split;
+
+	libcerror_error_t *error        = NULL;
+	libqcow_io_handle_t *io_handle  = NULL;
+	int result                      = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_handle_initialize(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle",
+	 io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = qcow_test_address_split_compare_with_generic(
+	          io_handle,
+	          16,
+	          LIBQCOW_ADDRESS_SPLIT_LAYOUT_64K );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = qcow_test_address_split_compare_with_generic(
+	          io_handle,
+	          21,
+	          LIBQCOW_ADDRESS_SPLIT_LAYOUT_2M );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_address_split_offset(
+	          NULL,
+	          0,
+	          &address_split,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_address_split_offset(
+	          io_handle,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_io_handle_free(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "io_handle",
+	 io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( io_handle != NULL )
+	{
+		libqcow_io_handle_free(
+		 &io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_address_split_get_layout",
+	 qcow_test_address_split_get_layout );
+
+	QCOW_TEST_RUN(
+	 "libqcow_address_split_offset",
+	 qcow_test_address_split_offset );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,742 @@
+/*
+ * Library arena type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_arena.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_arena_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_arena_initialize(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	libqcow_arena_t *arena   = NULL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_arena_initialize(
+	          &arena,
+	          1000,
+	          64,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "arena",
+	 arena );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The slot size is rounded up to the alignment
+	 */
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "arena->slot_size",
+	 arena->slot_size,
+	 (size_t) 1024 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "arena->number_of_free_slots",
+	 arena->number_of_free_slots,
+	 4 );
+
+	result = libqcow_arena_free(
+	          &arena,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "arena",
+	 arena );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_arena_initialize(
+	          NULL,
+	          1000,
+	          64,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	arena = (libqcow_arena_t *) 0x12345678UL;
+
+	result = libqcow_arena_initialize(
+	          &arena,
+	          1000,
+	          64,
+	          4,
+	          &error );
+
+	arena = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_initialize(
+	          &arena,
+	          0,
+	          64,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_initialize(
+	          &arena,
+	          1000,
+	          48,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_initialize(
+	          &arena,
+	          1000,
+	          64,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	/* Test libqcow_arena_initialize with malloc failing
+	 */
+	qcow_test_malloc_attempts_before_fail = 0;
+
+	result = libqcow_arena_initialize(
+	          &arena,
+	          1000,
+	          64,
+	          4,
+	          &error );
+
+	if( qcow_test_malloc_attempts_before_fail != -1 )
+	{
+		qcow_test_malloc_attempts_before_fail = -1;
+
+		if( arena != NULL )
+		{
+			libqcow_arena_free(
+			 &arena,
+			 NULL );
+		}
+	}
+	else
+	{
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "arena",
+		 arena );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( arena != NULL )
+	{
+		libqcow_arena_free(
+		 &arena,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_arena_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_arena_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_arena_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_arena_get_slot and libqcow_arena_release_slot functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_arena_get_slot(
+     void )
+{
+	uint8_t buffer[ 64 ];
+
+	libcerror_error_t *error = NULL;
+	libqcow_arena_t *arena   = NULL;
+	uint8_t *slot1           = NULL;
+	uint8_t *slot2           = NULL;
+	uint8_t *slot3           = NULL;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_arena_initialize(
+	          &arena,
+	          4096,
+	          4096,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_arena_get_slot(
+	          arena,
+	          &slot1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "slot1",
+	 slot1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "slot1 alignment",
+	 (int) ( (intptr_t) slot1 % 4096 ),
+	 0 );
+
+	result = libqcow_arena_get_slot(
+	          arena,
+	          &slot2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "slot2 offset",
+	 (int) ( slot2 - slot1 ),
+	 4096 );
+
+	/* The slots are writable
+	 */
+	slot1[ 0 ]    = 0xaa;
+	slot2[ 4095 ] = 0x55;
+
+	/* Test with no free slot available
+	 */
+	result = libqcow_arena_get_slot(
+	          arena,
+	          &slot3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "slot3",
+	 slot3 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_arena_contains(
+	          arena,
+	          slot2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_arena_contains(
+	          arena,
+	          buffer );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_arena_release_slot(
+	          arena,
+	          slot1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test that a released slot is reused
+	 */
+	result = libqcow_arena_get_slot(
+	          arena,
+	          &slot3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "slot3",
+	 (int) ( slot3 == slot1 ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test with a slot that is not part of the arena
+	 */
+	result = libqcow_arena_release_slot(
+	          arena,
+	          buffer,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_arena_get_slot(
+	          NULL,
+	          &slot3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_get_slot(
+	          arena,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_release_slot(
+	          NULL,
+	          slot3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with a slot that is not aligned to a slot boundary
+	 */
+	result = libqcow_arena_release_slot(
+	          arena,
+	          &( slot3[ 1 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_arena_free(
+	          &arena,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( arena != NULL )
+	{
+		libqcow_arena_free(
+		 &arena,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_arena_get_page_type function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_arena_get_page_type(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	libqcow_arena_t *arena   = NULL;
+	int page_type            = 0;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_arena_initialize(
+	          &arena,
+	          512,
+	          64,
+	          8,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_arena_get_page_type(
+	          arena,
+	          &page_type,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The page type depends on the huge pages available to the system
+	 * and is either default (0), transparent huge pages (1) or huge pages (2)
+	 */
+	result = ( page_type >= 0 )
+	      && ( page_type <= 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_arena_get_page_type(
+	          NULL,
+	          &page_type,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_arena_get_page_type(
+	          arena,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_arena_free(
+	          &arena,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( arena != NULL )
+	{
+		libqcow_arena_free(
+		 &arena,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_arena_initialize",
+	 qcow_test_arena_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_arena_free",
+	 qcow_test_arena_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_arena_get_slot",
+	 qcow_test_arena_get_slot );
+
+	QCOW_TEST_RUN(
+	 "libqcow_arena_get_page_type",
+	 qcow_test_arena_get_page_type );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
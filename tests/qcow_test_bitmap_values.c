@@ -0,0 +1,994 @@
+/*
+ * Library bitmap_values type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_bitmap_values.h"
+
+#if defined( __GNUC__ )
+
+uint8_t qcow_test_bitmap_values_data1[ 32 ] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+	0x01, 0x10, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+	0x74, 0x65, 0x73, 0x74, 0x00, 0x00, 0x00, 0x00 };
+
+/* Tests the libqcow_bitmap_values_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_bitmap_values_initialize(
+     void )
+{
+	libcerror_error_t *error                   = NULL;
+	libqcow_bitmap_values_t *bitmap_values = NULL;
+	int result                                 = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests            = 1;
+	int number_of_memset_fail_tests            = 1;
+	int test_number                            = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_bitmap_values_initialize(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "bitmap_values",
+	 bitmap_values );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_free(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "bitmap_values",
+	 bitmap_values );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_bitmap_values_initialize(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	bitmap_values = (libqcow_bitmap_values_t *) 0x12345678UL;
+
+	result = libqcow_bitmap_values_initialize(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	bitmap_values = NULL;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_bitmap_values_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_bitmap_values_initialize(
+		          &bitmap_values,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( bitmap_values != NULL )
+			{
+				libqcow_bitmap_values_free(
+				 &bitmap_values,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "bitmap_values",
+			 bitmap_values );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_bitmap_values_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_bitmap_values_initialize(
+		          &bitmap_values,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( bitmap_values != NULL )
+			{
+				libqcow_bitmap_values_free(
+				 &bitmap_values,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "bitmap_values",
+			 bitmap_values );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( bitmap_values != NULL )
+	{
+		libqcow_bitmap_values_free(
+		 &bitmap_values,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_bitmap_values_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_bitmap_values_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_bitmap_values_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_bitmap_values_read_data function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_bitmap_values_read_data(
+     void )
+{
+	uint8_t utf8_string[ 16 ];
+
+	libcerror_error_t *error               = NULL;
+	libqcow_bitmap_values_t *bitmap_values = NULL;
+	size_t entry_size                      = 0;
+	size_t utf8_string_size                = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_bitmap_values_initialize(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          32,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "entry_size",
+	 entry_size,
+	 (size_t) 32 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "number_of_bitmap_table_entries",
+	 bitmap_values->number_of_bitmap_table_entries,
+	 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "bitmap_type",
+	 (int) bitmap_values->bitmap_type,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_granularity_bits",
+	 (int) bitmap_values->number_of_granularity_bits,
+	 16 );
+
+	result = libqcow_bitmap_values_get_utf8_name_size(
+	          bitmap_values,
+	          &utf8_string_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "utf8_string_size",
+	 utf8_string_size,
+	 (size_t) 5 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_get_utf8_name(
+	          bitmap_values,
+	          utf8_string,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          utf8_string,
+	          "test",
+	          5 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_bitmap_values_compare_name_with_utf8_string(
+	          bitmap_values,
+	          (uint8_t *) "test",
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_compare_name_with_utf8_string(
+	          bitmap_values,
+	          (uint8_t *) "tes",
+	          3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          32,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_bitmap_values_free(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_initialize(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_read_data(
+	          NULL,
+	          qcow_test_bitmap_values_data1,
+	          32,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          NULL,
+	          32,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          16,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* The name is beyond the end of the data
+	 */
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          26,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          32,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_bitmap_values_free(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( bitmap_values != NULL )
+	{
+		libqcow_bitmap_values_free(
+		 &bitmap_values,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_bitmap_values_get_next_dirty_range function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_bitmap_values_get_next_dirty_range(
+     void )
+{
+	uint8_t bitmap_data[ 1024 ];
+
+	libbfio_handle_t *file_io_handle       = NULL;
+	libcerror_error_t *error               = NULL;
+	libqcow_bitmap_values_t *bitmap_values = NULL;
+	size64_t media_size                    = 0;
+	size64_t range_size                    = 0;
+	size_t entry_size                      = 0;
+	off64_t range_offset                   = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 * The bitmap table at offset 256 contains 2 entries of which the first references
+	 * the bitmap cluster at offset 512 and the second marks all granules dirty
+	 * Every bitmap cluster of 512 bytes covers 4096 granules of 64 KiB
+	 */
+	memory_set(
+	 bitmap_data,
+	 0,
+	 1024 );
+
+	bitmap_data[ 262 ]  = 0x02;
+	bitmap_data[ 271 ]  = 0x01;
+	bitmap_data[ 512 ]  = 0x0c;
+	bitmap_data[ 1023 ] = 0x80;
+
+	media_size = ( (size64_t) 8192 << 16 ) - 4096;
+
+	result = libqcow_bitmap_values_initialize(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_read_data(
+	          bitmap_values,
+	          qcow_test_bitmap_values_data1,
+	          32,
+	          &entry_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          bitmap_data,
+	          1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          0,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "range_offset",
+	 (int64_t) range_offset,
+	 (int64_t) 2 << 16 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "range_size",
+	 (uint64_t) range_size,
+	 (uint64_t) 2 << 16 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The range is clamped to the offset
+	 */
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          ( 3 << 16 ) + 10,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "range_offset",
+	 (int64_t) range_offset,
+	 (int64_t) ( 3 << 16 ) + 10 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "range_size",
+	 (uint64_t) range_size,
+	 (uint64_t) ( 1 << 16 ) - 10 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The range continues into the bitmap table entry that marks all granules dirty
+	 * and is clamped to the media size
+	 */
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          4 << 16,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "range_offset",
+	 (int64_t) range_offset,
+	 (int64_t) (off64_t) 4095 << 16 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "range_size",
+	 (uint64_t) range_size,
+	 (uint64_t) media_size - ( (size64_t) 4095 << 16 ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          (off64_t) media_size,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          NULL,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          0,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          -1,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	bitmap_values->flags = 0x00000001UL;
+
+	result = libqcow_bitmap_values_get_next_dirty_range(
+	          bitmap_values,
+	          file_io_handle,
+	          512,
+	          media_size,
+	          0,
+	          &range_offset,
+	          &range_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	bitmap_values->flags = 0;
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_bitmap_values_free(
+	          &bitmap_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( bitmap_values != NULL )
+	{
+		libqcow_bitmap_values_free(
+		 &bitmap_values,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_bitmap_values_initialize",
+	 qcow_test_bitmap_values_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_bitmap_values_free",
+	 qcow_test_bitmap_values_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_bitmap_values_read_data",
+	 qcow_test_bitmap_values_read_data );
+
+	QCOW_TEST_RUN(
+	 "libqcow_bitmap_values_get_next_dirty_range",
+	 qcow_test_bitmap_values_get_next_dirty_range );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,1471 @@
+/*
+ * Library block_cache type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_block_cache.h"
+
+/* The cache priorities, which correspond to LIBQCOW_CACHE_PRIORITY_LOW
+ * and LIBQCOW_CACHE_PRIORITY_NORMAL
+ */
+#define QCOW_TEST_CACHE_PRIORITY_LOW		0
+#define QCOW_TEST_CACHE_PRIORITY_NORMAL		1
+
+#if defined( __GNUC__ )
+
+/* The number of values freed by qcow_test_block_cache_free_value
+ */
+int qcow_test_block_cache_number_of_freed_values = 0;
+
+/* Frees a test value
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_block_cache_free_value(
+     intptr_t **value,
+     libcerror_error_t **error QCOW_TEST_ATTRIBUTE_UNUSED )
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( error )
+
+	if( value == NULL )
+	{
+		return( -1 );
+	}
+	if( *value != NULL )
+	{
+		memory_free(
+		 *value );
+
+		*value = NULL;
+
+		qcow_test_block_cache_number_of_freed_values++;
+	}
+	return( 1 );
+}
+
+/* Tests the libqcow_block_cache_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_block_cache_initialize(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_block_cache_t *block_cache = NULL;
+	int result                         = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests    = 2;
+	int number_of_memset_fail_tests    = 2;
+	int test_number                    = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          20,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "block_cache->number_of_ways",
+	 block_cache->number_of_ways,
+	 8 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "block_cache->number_of_sets",
+	 block_cache->number_of_sets,
+	 3 );
+
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A cache smaller than a set uses a single set
+	 */
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          2,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "block_cache->number_of_ways",
+	 block_cache->number_of_ways,
+	 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "block_cache->number_of_sets",
+	 block_cache->number_of_sets,
+	 1 );
+
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_block_cache_initialize(
+	          NULL,
+	          20,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	block_cache = (libqcow_block_cache_t *) 0x12345678UL;
+
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          20,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	block_cache = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          0,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          20,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_block_cache_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_block_cache_initialize(
+		          &block_cache,
+		          20,
+		          &qcow_test_block_cache_free_value,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( block_cache != NULL )
+			{
+				libqcow_block_cache_free(
+				 &block_cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "block_cache",
+			 block_cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_block_cache_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_block_cache_initialize(
+		          &block_cache,
+		          20,
+		          &qcow_test_block_cache_free_value,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( block_cache != NULL )
+			{
+				libqcow_block_cache_free(
+				 &block_cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "block_cache",
+			 block_cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( block_cache != NULL )
+	{
+		libqcow_block_cache_free(
+		 &block_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_block_cache_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_block_cache_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_block_cache_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_block_cache_get_value_by_offset and libqcow_block_cache_set_value_by_offset functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_block_cache_get_value_by_offset(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_block_cache_t *block_cache = NULL;
+	intptr_t *cached_value             = NULL;
+	intptr_t *value1                   = NULL;
+	intptr_t *value2                   = NULL;
+	intptr_t *value3                   = NULL;
+	int number_of_values               = 0;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_block_cache_number_of_freed_values = 0;
+
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          2,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value1 = memory_allocate_structure(
+	          intptr_t );
+	value2 = memory_allocate_structure(
+	          intptr_t );
+	value3 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value1",
+	 value1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value2",
+	 value2 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value3",
+	 value3 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          0,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cached_value",
+	 cached_value );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          block_cache,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          block_cache,
+	          65536,
+	          value2,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_number_of_values(
+	          block_cache,
+	          &number_of_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_values",
+	 number_of_values,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Use the first value so that the second value becomes the least recently used
+	 */
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          0,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cached_value == value1",
+	 (int) ( cached_value == value1 ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          block_cache,
+	          131072,
+	          value3,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          0,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cached_value == value1",
+	 (int) ( cached_value == value1 ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          131072,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cached_value == value3",
+	 (int) ( cached_value == value3 ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_block_cache_get_value_by_offset(
+	          NULL,
+	          0,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          -1,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          NULL,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          block_cache,
+	          0,
+	          NULL,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_block_cache_clear(
+	          block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 3 );
+
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( block_cache != NULL )
+	{
+		libqcow_block_cache_free(
+		 &block_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_block_cache_set_value_by_offset function with low priority values
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_block_cache_set_value_by_offset_low_priority(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_block_cache_t *block_cache = NULL;
+	intptr_t *cached_value             = NULL;
+	intptr_t *value                    = NULL;
+	int number_of_values               = 0;
+	int result                         = 0;
+	int value_index                    = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_block_cache_number_of_freed_values = 0;
+
+	/* A cache of 8 values consists of a single set of 8 entries
+	 * of which 2 entries can be used by low priority values
+	 */
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          8,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	for( value_index = 0;
+	     value_index < 9;
+	     value_index++ )
+	{
+		value = memory_allocate_structure(
+		         intptr_t );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "value",
+		 value );
+
+		result = libqcow_block_cache_set_value_by_offset(
+		          block_cache,
+		          (off64_t) value_index * 65536,
+		          value,
+		          ( value_index < 6 ) ? QCOW_TEST_CACHE_PRIORITY_NORMAL : QCOW_TEST_CACHE_PRIORITY_LOW,
+		          &error );
+
+		value = NULL;
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* The third low priority value replaces the first low priority value
+	 * instead of the least recently used normal priority value
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_block_cache_get_number_of_values(
+	          block_cache,
+	          &number_of_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_values",
+	 number_of_values,
+	 8 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          6 * 65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( value_index = 0;
+	     value_index < 6;
+	     value_index++ )
+	{
+		result = libqcow_block_cache_get_value_by_offset(
+		          block_cache,
+		          (off64_t) value_index * 65536,
+		          &cached_value,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* A low priority value that is read becomes a normal priority value
+	 * hence the next low priority value replaces the other low priority value
+	 */
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          7 * 65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_block_cache_set_value_by_offset(
+	          block_cache,
+	          9 * 65536,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_LOW,
+	          &error );
+
+	value = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 2 );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          7 * 65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          8 * 65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 10 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( value != NULL )
+	{
+		memory_free(
+		 value );
+	}
+	if( block_cache != NULL )
+	{
+		libqcow_block_cache_free(
+		 &block_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_block_cache_get_eviction_index and libqcow_block_cache_remove_value_by_index functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_block_cache_remove_value_by_index(
+     void )
+{
+	intptr_t *values[ 3 ];
+
+	libcerror_error_t *error           = NULL;
+	libqcow_block_cache_t *block_cache = NULL;
+	intptr_t *cached_value             = NULL;
+	intptr_t *value                    = NULL;
+	int entry_index                    = 0;
+	int number_of_values               = 0;
+	int result                         = 0;
+	int value_index                    = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_block_cache_number_of_freed_values = 0;
+
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          8,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( value_index = 0;
+	     value_index < 3;
+	     value_index++ )
+	{
+		value = memory_allocate_structure(
+		         intptr_t );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "value",
+		 value );
+
+		values[ value_index ] = value;
+
+		result = libqcow_block_cache_set_value_by_offset(
+		          block_cache,
+		          (off64_t) value_index * 65536,
+		          value,
+		          ( value_index == 1 ) ? QCOW_TEST_CACHE_PRIORITY_LOW : QCOW_TEST_CACHE_PRIORITY_NORMAL,
+		          &error );
+
+		value = NULL;
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test regular cases
+	 */
+
+	/* The low priority value is evicted first
+	 */
+	result = libqcow_block_cache_get_eviction_index(
+	          block_cache,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_index(
+	          block_cache,
+	          entry_index,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cached_value",
+	 (int) ( cached_value == values[ 1 ] ),
+	 1 );
+
+	result = libqcow_block_cache_remove_value_by_index(
+	          block_cache,
+	          entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 1 );
+
+	/* The least recently used normal priority value is evicted next
+	 */
+	result = libqcow_block_cache_get_eviction_index(
+	          block_cache,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_index(
+	          block_cache,
+	          entry_index,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cached_value",
+	 (int) ( cached_value == values[ 0 ] ),
+	 1 );
+
+	result = libqcow_block_cache_remove_value_by_index(
+	          block_cache,
+	          entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_number_of_values(
+	          block_cache,
+	          &number_of_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_values",
+	 number_of_values,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_value_by_offset(
+	          block_cache,
+	          2 * 65536,
+	          &cached_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Removing an entry without a value has no effect
+	 */
+	result = libqcow_block_cache_remove_value_by_index(
+	          block_cache,
+	          entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_block_cache_number_of_freed_values",
+	 qcow_test_block_cache_number_of_freed_values,
+	 2 );
+
+	/* Test error cases
+	 */
+	result = libqcow_block_cache_get_eviction_index(
+	          NULL,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_get_eviction_index(
+	          block_cache,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_remove_value_by_index(
+	          NULL,
+	          entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_block_cache_remove_value_by_index(
+	          block_cache,
+	          8,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "block_cache",
+	 block_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* An empty cache has no value to evict
+	 */
+	result = libqcow_block_cache_initialize(
+	          &block_cache,
+	          8,
+	          &qcow_test_block_cache_free_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_get_eviction_index(
+	          block_cache,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_block_cache_free(
+	          &block_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( value != NULL )
+	{
+		memory_free(
+		 value );
+	}
+	if( block_cache != NULL )
+	{
+		libqcow_block_cache_free(
+		 &block_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_block_cache_initialize",
+	 qcow_test_block_cache_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_block_cache_free",
+	 qcow_test_block_cache_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_block_cache_get_value_by_offset",
+	 qcow_test_block_cache_get_value_by_offset );
+
+	QCOW_TEST_RUN(
+	 "libqcow_block_cache_set_value_by_offset_low_priority",
+	 qcow_test_block_cache_set_value_by_offset_low_priority );
+
+	QCOW_TEST_RUN(
+	 "libqcow_block_cache_remove_value_by_index",
+	 qcow_test_block_cache_remove_value_by_index );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,194 @@
+/*
+ * Library byte_swap functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_byte_swap.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_byte_swap_uint64_big_endian function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_byte_swap_uint64_big_endian(
+     void )
+{
+	uint64_t values[ 7 ];
+
+	libcerror_error_t *error = NULL;
+	uint8_t *value_data      = NULL;
+	uint64_t expected_value  = 0;
+	size_t number_of_values  = 0;
+	size_t value_index       = 0;
+	int byte_index           = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 * An odd number of values is used to test the values remaining after the vectorized conversion
+	 */
+	for( number_of_values = 0;
+	     number_of_values <= 7;
+	     number_of_values++ )
+	{
+		value_data = (uint8_t *) values;
+
+		for( byte_index = 0;
+		     byte_index < 7 * 8;
+		     byte_index++ )
+		{
+			value_data[ byte_index ] = (uint8_t) ( byte_index + 1 );
+		}
+		result = libqcow_byte_swap_uint64_big_endian(
+		          values,
+		          number_of_values,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		for( value_index = 0;
+		     value_index < 7;
+		     value_index++ )
+		{
+			expected_value = 0;
+
+			for( byte_index = 0;
+			     byte_index < 8;
+			     byte_index++ )
+			{
+				expected_value <<= 8;
+				expected_value  |= (uint64_t) ( ( value_index * 8 ) + byte_index + 1 );
+			}
+			if( value_index >= number_of_values )
+			{
+				/* The values after the number of values must not be changed
+				 */
+				value_data = (uint8_t *) &( values[ value_index ] );
+
+				QCOW_TEST_ASSERT_EQUAL_INT(
+				 "value_data[ 0 ]",
+				 (int) value_data[ 0 ],
+				 (int) ( ( value_index * 8 ) + 1 ) );
+			}
+			else
+			{
+				QCOW_TEST_ASSERT_EQUAL_UINT64(
+				 "values[ value_index ]",
+				 values[ value_index ],
+				 expected_value );
+			}
+		}
+	}
+	/* Test error cases
+	 */
+	result = libqcow_byte_swap_uint64_big_endian(
+	          NULL,
+	          7,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_byte_swap_uint64_big_endian(
+	          values,
+	          (size_t) SSIZE_MAX,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_byte_swap_uint64_big_endian",
+	 qcow_test_byte_swap_uint64_big_endian );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
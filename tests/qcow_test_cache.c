@@ -0,0 +1,3210 @@
+/*
+ * Library cache type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_cache.h"
+
+/* The cache priorities, which correspond to LIBQCOW_CACHE_PRIORITY_LOW,
+ * LIBQCOW_CACHE_PRIORITY_NORMAL and LIBQCOW_CACHE_PRIORITY_HIGH
+ */
+#define QCOW_TEST_CACHE_PRIORITY_LOW		0
+#define QCOW_TEST_CACHE_PRIORITY_NORMAL		1
+#define QCOW_TEST_CACHE_PRIORITY_HIGH		2
+
+#if defined( __GNUC__ )
+
+/* The number of values freed by qcow_test_cache_free_value
+ */
+int qcow_test_cache_number_of_freed_values = 0;
+
+/* Frees a test value
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_cache_free_value(
+     intptr_t **value,
+     libcerror_error_t **error QCOW_TEST_ATTRIBUTE_UNUSED )
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( error )
+
+	if( value == NULL )
+	{
+		return( -1 );
+	}
+	if( *value != NULL )
+	{
+		memory_free(
+		 *value );
+
+		*value = NULL;
+
+		qcow_test_cache_number_of_freed_values++;
+	}
+	return( 1 );
+}
+
+/* Retrieves the size of a test value
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_cache_get_value_size(
+     intptr_t *value,
+     size_t *value_size,
+     libcerror_error_t **error QCOW_TEST_ATTRIBUTE_UNUSED )
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( error )
+
+	if( ( value == NULL )
+	 || ( value_size == NULL ) )
+	{
+		return( -1 );
+	}
+	*value_size = 1024;
+
+	return( 1 );
+}
+
+/* Tests the libqcow_cache_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cache_initialize(
+     void )
+{
+	libcerror_error_t *error        = NULL;
+	libqcow_cache_t *cache          = NULL;
+	int result                      = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests = 2;
+	int number_of_memset_fail_tests = 2;
+	int test_number                 = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cache_initialize(
+	          NULL,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	cache = (libqcow_cache_t *) 0x12345678UL;
+
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	cache = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cache_initialize(
+	          &cache,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cache_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_cache_initialize(
+		          &cache,
+		          1024 * 1024,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( cache != NULL )
+			{
+				libqcow_cache_free(
+				 &cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cache",
+			 cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cache_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_cache_initialize(
+		          &cache,
+		          1024 * 1024,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( cache != NULL )
+			{
+				libqcow_cache_free(
+				 &cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cache",
+			 cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cache_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cache_free(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	int result                               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_cache_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* A cache that is attached to a file cannot be freed
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	result = libqcow_internal_cache_attach_file(
+	          internal_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_detach_file(
+	          internal_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cache_get_maximum_memory_size function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cache_get_maximum_memory_size(
+     void )
+{
+	libcerror_error_t *error     = NULL;
+	libqcow_cache_t *cache       = NULL;
+	size64_t maximum_memory_size = 0;
+	int result                   = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cache_get_maximum_memory_size(
+	          cache,
+	          &maximum_memory_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_memory_size",
+	 (uint64_t) maximum_memory_size,
+	 (uint64_t) 1024 * 1024 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cache_get_maximum_memory_size(
+	          NULL,
+	          &maximum_memory_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cache_get_maximum_memory_size(
+	          cache,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_internal_cache_get_value, libqcow_internal_cache_set_value
+ * and libqcow_internal_cache_release_value functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_internal_cache_get_value(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_cache_value_t *referenced_value  = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner1                         = (intptr_t *) 0x1000UL;
+	intptr_t *owner2                         = (intptr_t *) 0x2000UL;
+	intptr_t *value1                         = NULL;
+	intptr_t *value2                         = NULL;
+	intptr_t *value3                         = NULL;
+	intptr_t *value4                         = NULL;
+	size64_t memory_usage                    = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_cache_number_of_freed_values = 0;
+
+	/* The budget fits 3 values of 1024 bytes including their bookkeeping
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          3 * ( 1024 + sizeof( libqcow_cache_value_t ) ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	value1 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value1",
+	 value1 );
+
+	value2 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value2",
+	 value2 );
+
+	value3 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value3",
+	 value3 );
+
+	value4 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value4",
+	 value4 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache_value",
+	 cache_value );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache_value",
+	 cache_value );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value1 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The same offset of another file is a different value
+	 */
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner2,
+	          2,
+	          0,
+	          value2,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          65536,
+	          value3,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value3 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_memory_usage_by_owner(
+	          internal_cache,
+	          owner1,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) 2 * ( 1024 + sizeof( libqcow_cache_value_t ) ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Keep the first value referenced, which prevents it from being evicted
+	 */
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache_value",
+	 cache_value );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	referenced_value = cache_value;
+	cache_value      = NULL;
+
+	/* Adding a fourth value evicts the least recently used value that is not referenced
+	 */
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner2,
+	          2,
+	          131072,
+	          value4,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value4 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner2,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "referenced_value->number_of_references",
+	 referenced_value->number_of_references,
+	 1 );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &referenced_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "referenced_value",
+	 referenced_value );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_internal_cache_get_value(
+	          NULL,
+	          owner1,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_set_value(
+	          NULL,
+	          owner1,
+	          2,
+	          0,
+	          (intptr_t *) 0x12345678UL,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          NULL,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          (intptr_t *) 0x12345678UL,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          NULL,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_release_value(
+	          NULL,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 4 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	if( value4 != NULL )
+	{
+		memory_free(
+		 value4 );
+	}
+	if( value3 != NULL )
+	{
+		memory_free(
+		 value3 );
+	}
+	if( value2 != NULL )
+	{
+		memory_free(
+		 value2 );
+	}
+	if( value1 != NULL )
+	{
+		memory_free(
+		 value1 );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_internal_cache_set_value function with priorities
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_internal_cache_set_value_priority(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner                          = (intptr_t *) 0x1000UL;
+	intptr_t *value                          = NULL;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_cache_number_of_freed_values = 0;
+
+	/* The cache fits 4 values of which 1 can be a low priority value
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          4 * ( 1024 + sizeof( libqcow_cache_value_t ) ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	/* Test regular cases
+	 */
+	/* The level 2 table is the least recently used value
+	 */
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          1,
+	          0,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_HIGH,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          1,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          2,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          3,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_LOW,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 0 );
+
+	/* A second low priority value evicts the first low priority value
+	 * instead of the least recently used value
+	 */
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          4,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_LOW,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          3,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          1,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A normal priority value evicts the least recently used normal priority value
+	 * since the high priority value spends an eviction credit
+	 */
+	value = memory_allocate_structure(
+	         intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value",
+	 value );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          5,
+	          value,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 2 );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          2,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          1,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          4,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          6,
+	          (intptr_t *) 0x12345678UL,
+	          0xff,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 6 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( value != NULL )
+	{
+		memory_free(
+		 value );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_internal_cache_remove_values function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_internal_cache_remove_values(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner1                         = (intptr_t *) 0x1000UL;
+	intptr_t *owner2                         = (intptr_t *) 0x2000UL;
+	intptr_t *value1                         = NULL;
+	intptr_t *value2                         = NULL;
+	size64_t memory_usage                    = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_cache_number_of_freed_values = 0;
+
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	value1 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value1",
+	 value1 );
+
+	value2 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value2",
+	 value2 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value1 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner2,
+	          2,
+	          0,
+	          value2,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_internal_cache_remove_values(
+	          internal_cache,
+	          owner1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner1,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_get_memory_usage(
+	          cache,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) 1024 + sizeof( libqcow_cache_value_t ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_internal_cache_remove_values(
+	          NULL,
+	          owner1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cache_get_memory_usage(
+	          NULL,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cache_get_memory_usage(
+	          cache,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	if( value2 != NULL )
+	{
+		memory_free(
+		 value2 );
+	}
+	if( value1 != NULL )
+	{
+		memory_free(
+		 value1 );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_internal_cache_remove_values_by_type function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_internal_cache_remove_values_by_type(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner                          = (intptr_t *) 0x1000UL;
+	intptr_t *value1                         = NULL;
+	intptr_t *value2                         = NULL;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_cache_number_of_freed_values = 0;
+
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	value1 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value1",
+	 value1 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          1,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value1 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value2",
+	 value2 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          0,
+	          value2,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_internal_cache_remove_values_by_type(
+	          internal_cache,
+	          owner,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 1 );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          1,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          0,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_internal_cache_remove_values_by_type(
+	          NULL,
+	          owner,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	if( value2 != NULL )
+	{
+		memory_free(
+		 value2 );
+	}
+	if( value1 != NULL )
+	{
+		memory_free(
+		 value1 );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_internal_cache_get_image, libqcow_internal_cache_set_image
+ * and libqcow_internal_cache_release_image functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_internal_cache_image(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *image                          = NULL;
+	intptr_t *image1                         = (intptr_t *) 0x1000UL;
+	intptr_t *image2                         = (intptr_t *) 0x2000UL;
+	int number_of_references                 = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	/* Test regular cases
+	 */
+	result = libqcow_internal_cache_get_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_set_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          image1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test that an image with the same identifier is not set twice
+	 */
+	result = libqcow_internal_cache_set_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          image2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "image",
+	 ( image == image1 ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_image(
+	          internal_cache,
+	          image1,
+	          &number_of_references,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_references",
+	 number_of_references,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_image(
+	          internal_cache,
+	          image1,
+	          &number_of_references,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_references",
+	 number_of_references,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test that an image is removed when its last reference is released
+	 */
+	result = libqcow_internal_cache_release_image(
+	          internal_cache,
+	          image1,
+	          &number_of_references,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test that the cache frees images that were not released
+	 */
+	result = libqcow_internal_cache_set_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          image2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_internal_cache_get_image(
+	          NULL,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_get_image(
+	          internal_cache,
+	          NULL,
+	          11,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_get_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          0,
+	          &image,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_set_image(
+	          internal_cache,
+	          (uint8_t *) "base.qcow2",
+	          11,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_internal_cache_release_image(
+	          internal_cache,
+	          image2,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cache_trim function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cache_trim(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner                          = (intptr_t *) 0x1000UL;
+	intptr_t *value1                         = NULL;
+	intptr_t *value2                         = NULL;
+	intptr_t *value3                         = NULL;
+	size64_t memory_usage                    = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	qcow_test_cache_number_of_freed_values = 0;
+
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	value1 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value1",
+	 value1 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          0,
+	          value1,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value1 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value2",
+	 value2 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          1,
+	          value2,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value2 = NULL;
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value3 = memory_allocate_structure(
+	          intptr_t );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "value3",
+	 value3 );
+
+	result = libqcow_internal_cache_set_value(
+	          internal_cache,
+	          owner,
+	          2,
+	          2,
+	          value3,
+	          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+	          &qcow_test_cache_free_value,
+	          &qcow_test_cache_get_value_size,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	value3 = NULL;
+
+	/* Test regular cases
+	 */
+	/* The value that is still referenced is not evicted
+	 */
+	result = libqcow_cache_trim(
+	          cache,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_cache_number_of_freed_values",
+	 qcow_test_cache_number_of_freed_values,
+	 2 );
+
+	result = libqcow_cache_get_memory_usage(
+	          cache,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) 1024 + sizeof( libqcow_cache_value_t ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_get_maximum_memory_size(
+	          cache,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_memory_size",
+	 (uint64_t) memory_usage,
+	 (uint64_t) 1024 * 1024 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_release_value(
+	          internal_cache,
+	          &cache_value,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_trim(
+	          cache,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_get_memory_usage(
+	          cache,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cache_trim(
+	          NULL,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	if( value3 != NULL )
+	{
+		memory_free(
+		 value3 );
+	}
+	if( value2 != NULL )
+	{
+		memory_free(
+		 value2 );
+	}
+	if( value1 != NULL )
+	{
+		memory_free(
+		 value1 );
+	}
+	return( 0 );
+}
+
+/* Tests the distribution of values over the cache shards
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cache_shards(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_cache_t *cache                   = NULL;
+	libqcow_cache_value_t *cache_value       = NULL;
+	libqcow_internal_cache_t *internal_cache = NULL;
+	intptr_t *owner                          = NULL;
+	intptr_t *value                          = NULL;
+	size64_t memory_usage                    = 0;
+	size64_t owner_memory_usage              = 0;
+	int result                               = 0;
+	int value_index                          = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          64 * 1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "internal_cache->number_of_shards",
+	 internal_cache->number_of_shards,
+	 4 );
+
+	/* Test regular cases
+	 */
+	for( value_index = 0;
+	     value_index < 32;
+	     value_index++ )
+	{
+		value = memory_allocate_structure(
+		         intptr_t );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "value",
+		 value );
+
+		owner = (intptr_t *) ( 0x1000UL + ( ( value_index % 2 ) * 0x1000UL ) );
+
+		result = libqcow_internal_cache_set_value(
+		          internal_cache,
+		          owner,
+		          2,
+		          (off64_t) value_index * 65536,
+		          value,
+		          QCOW_TEST_CACHE_PRIORITY_NORMAL,
+		          &qcow_test_cache_free_value,
+		          &qcow_test_cache_get_value_size,
+		          &cache_value,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		value = NULL;
+
+		result = libqcow_internal_cache_release_value(
+		          internal_cache,
+		          &cache_value,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	for( value_index = 0;
+	     value_index < 32;
+	     value_index++ )
+	{
+		owner = (intptr_t *) ( 0x1000UL + ( ( value_index % 2 ) * 0x1000UL ) );
+
+		result = libqcow_internal_cache_get_value(
+		          internal_cache,
+		          owner,
+		          2,
+		          (off64_t) value_index * 65536,
+		          &cache_value,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "cache_value",
+		 cache_value );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_internal_cache_release_value(
+		          internal_cache,
+		          &cache_value,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	result = libqcow_internal_cache_get_memory_usage_by_owner(
+	          internal_cache,
+	          (intptr_t *) 0x1000UL,
+	          &owner_memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_internal_cache_get_memory_usage_by_owner(
+	          internal_cache,
+	          (intptr_t *) 0x2000UL,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) owner_memory_usage );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	owner_memory_usage += memory_usage;
+
+	result = libqcow_cache_get_memory_usage(
+	          cache,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "memory_usage",
+	 (uint64_t) memory_usage,
+	 (uint64_t) owner_memory_usage );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A small cache uses a single shard
+	 */
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	internal_cache = (libqcow_internal_cache_t *) cache;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "internal_cache->number_of_shards",
+	 internal_cache->number_of_shards,
+	 1 );
+
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
+	if( value != NULL )
+	{
+		memory_free(
+		 value );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_cache_initialize",
+	 qcow_test_cache_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cache_free",
+	 qcow_test_cache_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cache_get_maximum_memory_size",
+	 qcow_test_cache_get_maximum_memory_size );
+
+	QCOW_TEST_RUN(
+	 "libqcow_internal_cache_get_value",
+	 qcow_test_internal_cache_get_value );
+
+	QCOW_TEST_RUN(
+	 "libqcow_internal_cache_set_value_priority",
+	 qcow_test_internal_cache_set_value_priority );
+
+	QCOW_TEST_RUN(
+	 "libqcow_internal_cache_remove_values",
+	 qcow_test_internal_cache_remove_values );
+
+	QCOW_TEST_RUN(
+	 "libqcow_internal_cache_remove_values_by_type",
+	 qcow_test_internal_cache_remove_values_by_type );
+
+	QCOW_TEST_RUN(
+	 "libqcow_internal_cache_image",
+	 qcow_test_internal_cache_image );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cache_trim",
+	 qcow_test_cache_trim );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cache_shards",
+	 qcow_test_cache_shards );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
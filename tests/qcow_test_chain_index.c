@@ -0,0 +1,1081 @@
+/*
+ * Library chain_index type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_chain_index.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_chain_index_calculate_checksum function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_chain_index_calculate_checksum(
+     void )
+{
+	uint8_t data[ 9 ]        = { 'W', 'i', 'k', 'i', 'p', 'e', 'd', 'i', 'a' };
+	libcerror_error_t *error = NULL;
+	uint32_t checksum        = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_chain_index_calculate_checksum(
+	          &checksum,
+	          data,
+	          9,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "checksum",
+	 checksum,
+	 (uint32_t) 0x11e60398UL );
+
+	/* Test calculating the checksum in parts
+	 */
+	result = libqcow_chain_index_calculate_checksum(
+	          &checksum,
+	          data,
+	          4,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_chain_index_calculate_checksum(
+	          &checksum,
+	          &( data[ 4 ] ),
+	          5,
+	          checksum,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "checksum",
+	 checksum,
+	 (uint32_t) 0x11e60398UL );
+
+	/* Test error cases
+	 */
+	result = libqcow_chain_index_calculate_checksum(
+	          NULL,
+	          data,
+	          9,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_calculate_checksum(
+	          &checksum,
+	          NULL,
+	          9,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_calculate_checksum(
+	          &checksum,
+	          data,
+	          (size_t) SSIZE_MAX + 1,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_chain_index_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_chain_index_initialize(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_chain_index_t *chain_index = NULL;
+	int result                         = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests    = 3;
+	int number_of_memset_fail_tests    = 3;
+	int test_number                    = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "chain_index",
+	 chain_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "chain_index->number_of_entries",
+	 chain_index->number_of_entries,
+	 (size_t) 5 );
+
+	result = libqcow_chain_index_free(
+	          &chain_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "chain_index",
+	 chain_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_chain_index_initialize(
+	          NULL,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	chain_index = (libqcow_chain_index_t *) 0x12345678UL;
+
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	chain_index = NULL;
+
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          ( 4 * 65536 ) + 1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          0,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_chain_index_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_chain_index_initialize(
+		          &chain_index,
+		          ( 4 * 65536 ) + 1,
+		          65536,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( chain_index != NULL )
+			{
+				libqcow_chain_index_free(
+				 &chain_index,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "chain_index",
+			 chain_index );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_chain_index_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_chain_index_initialize(
+		          &chain_index,
+		          ( 4 * 65536 ) + 1,
+		          65536,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( chain_index != NULL )
+			{
+				libqcow_chain_index_free(
+				 &chain_index,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "chain_index",
+			 chain_index );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( chain_index != NULL )
+	{
+		libqcow_chain_index_free(
+		 &chain_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_chain_index_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_chain_index_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_chain_index_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_chain_index_get_entry_at_offset and libqcow_chain_index_set_entry_at_offset functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_chain_index_get_entry_at_offset(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_chain_index_t *chain_index = NULL;
+	uint64_t cluster_block_reference   = 0;
+	uint8_t layer                      = 0;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "chain_index",
+	 chain_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_chain_index_get_entry_at_offset(
+	          chain_index,
+	          65536,
+	          &layer,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layer",
+	 (int) layer,
+	 0 );
+
+	result = libqcow_chain_index_set_entry_at_offset(
+	          chain_index,
+	          65536 + 512,
+	          2,
+	          (uint64_t) 0x80000000000a0000ULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_get_entry_at_offset(
+	          chain_index,
+	          65536,
+	          &layer,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layer",
+	 (int) layer,
+	 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0x80000000000a0000ULL );
+
+	/* Test error cases
+	 */
+	result = libqcow_chain_index_get_entry_at_offset(
+	          NULL,
+	          65536,
+	          &layer,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_get_entry_at_offset(
+	          chain_index,
+	          ( 4 * 65536 ) + 1,
+	          &layer,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_get_entry_at_offset(
+	          chain_index,
+	          65536,
+	          NULL,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_get_entry_at_offset(
+	          chain_index,
+	          65536,
+	          &layer,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_set_entry_at_offset(
+	          NULL,
+	          65536,
+	          2,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_set_entry_at_offset(
+	          chain_index,
+	          -1,
+	          2,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_chain_index_free(
+	          &chain_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "chain_index",
+	 chain_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( chain_index != NULL )
+	{
+		libqcow_chain_index_free(
+		 &chain_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_chain_index_write_file_io_handle and libqcow_chain_index_read_file_io_handle functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_chain_index_write_and_read_file_io_handle(
+     void )
+{
+	uint8_t chain_index_file_data[ 85 ];
+
+	libbfio_handle_t *file_io_handle   = NULL;
+	libcerror_error_t *error           = NULL;
+	libqcow_chain_index_t *chain_index = NULL;
+	libqcow_chain_index_t *read_index  = NULL;
+	uint64_t cluster_block_reference   = 0;
+	uint8_t layer                      = 0;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_chain_index_initialize(
+	          &chain_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_set_entry_at_offset(
+	          chain_index,
+	          4 * 65536,
+	          3,
+	          (uint64_t) 0x00000000000b0000ULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_initialize(
+	          &read_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          chain_index_file_data,
+	          85,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ_WRITE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_chain_index_write_file_io_handle(
+	          chain_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_get_entry_at_offset(
+	          read_index,
+	          4 * 65536,
+	          &layer,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layer",
+	 (int) layer,
+	 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0x00000000000b0000ULL );
+
+	/* Test a chain index file of an image with another media size
+	 */
+	libqcow_chain_index_free(
+	 &read_index,
+	 NULL );
+
+	result = libqcow_chain_index_initialize(
+	          &read_index,
+	          4 * 65536,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_chain_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_chain_index_read_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_chain_index_write_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test reading a chain index file with a corrupted entry
+	 */
+	chain_index_file_data[ 80 ] ^= 0xff;
+
+	result = libqcow_chain_index_read_file_io_handle(
+	          chain_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_chain_index_free(
+	          &read_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_chain_index_free(
+	          &chain_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( read_index != NULL )
+	{
+		libqcow_chain_index_free(
+		 &read_index,
+		 NULL );
+	}
+	if( chain_index != NULL )
+	{
+		libqcow_chain_index_free(
+		 &chain_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_chain_index_calculate_checksum",
+	 qcow_test_chain_index_calculate_checksum );
+
+	QCOW_TEST_RUN(
+	 "libqcow_chain_index_initialize",
+	 qcow_test_chain_index_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_chain_index_free",
+	 qcow_test_chain_index_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_chain_index_get_entry_at_offset",
+	 qcow_test_chain_index_get_entry_at_offset );
+
+	QCOW_TEST_RUN(
+	 "libqcow_chain_index_write_and_read_file_io_handle",
+	 qcow_test_chain_index_write_and_read_file_io_handle );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -21,6 +21,7 @@
 
 #include <common.h>
 #include <file_stream.h>
+#include <memory.h>
 #include <types.h>
 
 #if defined( HAVE_STDLIB_H ) || defined( WINAPI )
@@ -34,6 +35,9 @@
 #include "qcow_test_unused.h"
 
 #include "../libqcow/libqcow_cluster_block.h"
+#include "../libqcow/libqcow_cluster_block_pool.h"
+#include "../libqcow/libqcow_compression.h"
+#include "../libqcow/libqcow_encryption.h"
 
 #if defined( __GNUC__ )
 
@@ -58,6 +62,7 @@ int qcow_test_cluster_block_initialize(
 	result = libqcow_cluster_block_initialize(
 	          &cluster_block,
 	          4096,
+	          NULL,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -95,6 +100,7 @@ int qcow_test_cluster_block_initialize(
 	result = libqcow_cluster_block_initialize(
 	          NULL,
 	          4096,
+	          NULL,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -114,6 +120,7 @@ int qcow_test_cluster_block_initialize(
 	result = libqcow_cluster_block_initialize(
 	          &cluster_block,
 	          4096,
+	          NULL,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -133,6 +140,7 @@ int qcow_test_cluster_block_initialize(
 	result = libqcow_cluster_block_initialize(
 	          &cluster_block,
 	          (size_t) SSIZE_MAX + 1,
+	          NULL,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -160,6 +168,7 @@ int qcow_test_cluster_block_initialize(
 		result = libqcow_cluster_block_initialize(
 		          &cluster_block,
 		          4096,
+		          NULL,
 		          &error );
 
 		if( qcow_test_malloc_attempts_before_fail != -1 )
@@ -203,6 +212,7 @@ int qcow_test_cluster_block_initialize(
 		result = libqcow_cluster_block_initialize(
 		          &cluster_block,
 		          4096,
+		          NULL,
 		          &error );
 
 		if( qcow_test_memset_attempts_before_fail != -1 )
@@ -292,6 +302,841 @@ on_error:
 	return( 0 );
 }
 
+/* Tests the libqcow_cluster_block_get_memory_usage function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_get_memory_usage(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_block_t *cluster_block           = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	size_t memory_usage                              = 0;
+	int result                                       = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          4096,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block",
+	 cluster_block );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_get_memory_usage(
+	          cluster_block,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "memory_usage",
+	 memory_usage,
+	 (size_t) ( sizeof( libqcow_cluster_block_t ) + 4096 ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_get_memory_usage(
+	          NULL,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_get_memory_usage(
+	          cluster_block,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test with a pooled data buffer, which includes the alignment padding
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          4096,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          4096,
+	          cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_get_memory_usage(
+	          cluster_block,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "memory_usage",
+	 memory_usage,
+	 (size_t) ( sizeof( libqcow_cluster_block_t ) + 4096 + 4096 + sizeof( uint8_t * ) ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_free(
+	          &cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_block != NULL )
+	{
+		libqcow_cluster_block_free(
+		 &cluster_block,
+		 NULL );
+	}
+	if( cluster_block_pool != NULL )
+	{
+		libqcow_cluster_block_pool_free(
+		 &cluster_block_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_decompress_range function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_decompress_range(
+     void )
+{
+	uint8_t compressed_data[ 50 ] = {
+		0x0b, 0xc9, 0x48, 0x55, 0x28, 0x2c, 0xcd, 0x4c, 0xce, 0x56, 0x48, 0x2a, 0xca, 0x2f, 0xcf, 0x53,
+		0x48, 0xcb, 0xaf, 0x50, 0xc8, 0x2a, 0xcd, 0x2d, 0x28, 0x56, 0xc8, 0x2f, 0x4b, 0x2d, 0x52, 0x28,
+		0x01, 0x4a, 0xe7, 0x24, 0x56, 0x55, 0x2a, 0xa4, 0xe4, 0xa7, 0xeb, 0x29, 0x84, 0x90, 0xa0, 0x98,
+		0x0b, 0x00 };
+
+	uint8_t uncompressed_data[ 128 ] =
+		"The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n";
+
+	libcerror_error_t *error                               = NULL;
+	libqcow_cluster_block_t *cluster_block                 = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	int result                                             = 0;
+
+	/* Initialize test
+	 * The uncompressed data beyond the end of the compressed data is expected to be 0
+	 */
+	uncompressed_data[ 90 ] = 0;
+
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          50,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block",
+	 cluster_block );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_copy(
+	          cluster_block->data,
+	          compressed_data,
+	          50 ) != NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_decompress_range(
+	          cluster_block,
+	          decompression_context,
+	          128,
+	          4,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "cluster_block->data_size",
+	 cluster_block->data_size,
+	 (size_t) 128 );
+
+	result = memory_compare(
+	          &( cluster_block->data[ 4 ] ),
+	          &( uncompressed_data[ 4 ] ),
+	          16 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* The decompression is resumed up to the end of the data
+	 */
+	result = libqcow_cluster_block_decompress_range(
+	          cluster_block,
+	          decompression_context,
+	          128,
+	          64,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block->decompression_state",
+	 cluster_block->decompression_state );
+
+	result = memory_compare(
+	          cluster_block->data,
+	          uncompressed_data,
+	          128 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_decompress_range(
+	          NULL,
+	          decompression_context,
+	          128,
+	          0,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with data that was already decompressed
+	 */
+	result = libqcow_cluster_block_decompress_range(
+	          cluster_block,
+	          decompression_context,
+	          128,
+	          0,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block",
+	 cluster_block );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test with a data range that is out of bounds
+	 */
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          50,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_decompress_range(
+	          cluster_block,
+	          decompression_context,
+	          128,
+	          120,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_decompression_context_free(
+	          &decompression_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_block != NULL )
+	{
+		libqcow_cluster_block_free(
+		 &cluster_block,
+		 NULL );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_decrypt_sectors function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_decrypt_sectors(
+     void )
+{
+	uint8_t key_data[ 16 ] = {
+		0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+	uint8_t data[ 1536 ];
+
+	libcerror_error_t *error                          = NULL;
+	libqcow_cluster_block_t *cluster_block            = NULL;
+	libqcow_encryption_context_t *encryption_context = NULL;
+	size_t data_offset                                = 0;
+	int result                                        = 0;
+
+	/* Initialize test
+	 */
+	for( data_offset = 0;
+	     data_offset < 1536;
+	     data_offset++ )
+	{
+		data[ data_offset ] = (uint8_t) ( data_offset % 251 );
+	}
+	result = libqcow_encryption_initialize(
+	          &encryption_context,
+	          LIBQCOW_ENCRYPTION_METHOD_AES_128_CBC,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_encryption_set_keys(
+	          encryption_context,
+	          key_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          1536,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block",
+	 cluster_block );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_encryption_crypt(
+	          encryption_context,
+	          LIBQCOW_ENCYPTION_CRYPT_MODE_ENCRYPT,
+	          data,
+	          1536,
+	          cluster_block->data,
+	          1536,
+	          8,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_decrypt_sectors(
+	          cluster_block,
+	          encryption_context,
+	          8,
+	          600,
+	          100,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "cluster_block->number_of_decrypted_sectors",
+	 cluster_block->number_of_decrypted_sectors,
+	 (size_t) 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block->decrypted_sectors_bitmap",
+	 cluster_block->decrypted_sectors_bitmap );
+
+	result = memory_compare(
+	          &( cluster_block->data[ 512 ] ),
+	          &( data[ 512 ] ),
+	          512 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Sectors that were decrypted before are not decrypted again
+	 */
+	result = libqcow_cluster_block_decrypt_sectors(
+	          cluster_block,
+	          encryption_context,
+	          8,
+	          0,
+	          1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "cluster_block->number_of_decrypted_sectors",
+	 cluster_block->number_of_decrypted_sectors,
+	 (size_t) 2 );
+
+	result = memory_compare(
+	          cluster_block->data,
+	          data,
+	          1024 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* The remaining sectors are decrypted by libqcow_cluster_block_decrypt
+	 */
+	result = libqcow_cluster_block_decrypt(
+	          cluster_block,
+	          encryption_context,
+	          8,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block->decrypted_sectors_bitmap",
+	 cluster_block->decrypted_sectors_bitmap );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block->encrypted_data",
+	 cluster_block->encrypted_data );
+
+	result = memory_compare(
+	          cluster_block->data,
+	          data,
+	          1536 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_decrypt_sectors(
+	          NULL,
+	          encryption_context,
+	          8,
+	          0,
+	          512,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* The data was already decrypted
+	 */
+	result = libqcow_cluster_block_decrypt_sectors(
+	          cluster_block,
+	          encryption_context,
+	          8,
+	          0,
+	          512,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block",
+	 cluster_block );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test a range beyond the end of the data
+	 */
+	result = libqcow_cluster_block_initialize(
+	          &cluster_block,
+	          1536,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_decrypt_sectors(
+	          cluster_block,
+	          encryption_context,
+	          8,
+	          1024,
+	          1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_free(
+	          &cluster_block,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_encryption_free(
+	          &encryption_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_block != NULL )
+	{
+		libqcow_cluster_block_free(
+		 &cluster_block,
+		 NULL );
+	}
+	if( encryption_context != NULL )
+	{
+		libqcow_encryption_free(
+		 &encryption_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
 #endif /* defined( __GNUC__ ) */
 
 /* The main program
@@ -319,8 +1164,20 @@ int main(
 	 "libqcow_cluster_block_free",
 	 qcow_test_cluster_block_free );
 
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_get_memory_usage",
+	 qcow_test_cluster_block_get_memory_usage );
+
 	/* TODO: add tests for libqcow_cluster_block_read */
 
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_decompress_range",
+	 qcow_test_cluster_block_decompress_range );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_decrypt_sectors",
+	 qcow_test_cluster_block_decrypt_sectors );
+
 #endif /* defined( __GNUC__ ) */
 
 	return( EXIT_SUCCESS );
@@ -0,0 +1,1091 @@
+/*
+ * Library cluster_block_pool type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_cluster_block_pool.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_cluster_block_pool_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_pool_initialize(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	int result                                       = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests                  = 2;
+	int number_of_memset_fail_tests                  = 2;
+	int test_number                                  = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          512,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block_pool",
+	 cluster_block_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_free(
+	          &cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block_pool",
+	 cluster_block_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          NULL,
+	          512,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	cluster_block_pool = (libqcow_cluster_block_pool_t *) 0x12345678UL;
+
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          512,
+	          4,
+	          &error );
+
+	cluster_block_pool = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          0,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          512,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cluster_block_pool_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_cluster_block_pool_initialize(
+		          &cluster_block_pool,
+		          512,
+		          4,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( cluster_block_pool != NULL )
+			{
+				libqcow_cluster_block_pool_free(
+				 &cluster_block_pool,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cluster_block_pool",
+			 cluster_block_pool );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cluster_block_pool_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_cluster_block_pool_initialize(
+		          &cluster_block_pool,
+		          512,
+		          4,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( cluster_block_pool != NULL )
+			{
+				libqcow_cluster_block_pool_free(
+				 &cluster_block_pool,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cluster_block_pool",
+			 cluster_block_pool );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_block_pool != NULL )
+	{
+		libqcow_cluster_block_pool_free(
+		 &cluster_block_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_pool_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_pool_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_pool_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_pool_get_buffer and libqcow_cluster_block_pool_release_buffer functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_pool_get_buffer(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	uint8_t *buffer1                                 = NULL;
+	uint8_t *buffer2                                 = NULL;
+	uint8_t *pooled_buffer                           = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          4096,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_block_pool",
+	 cluster_block_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "buffer1",
+	 buffer1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "buffer1 alignment",
+	 (int) ( (intptr_t) buffer1 % 4096 ),
+	 0 );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "buffer2",
+	 buffer2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	pooled_buffer = buffer1;
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "buffer1",
+	 buffer1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->number_of_buffers",
+	 cluster_block_pool->number_of_buffers,
+	 1 );
+
+	/* The pool is full hence the buffer is freed
+	 */
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "buffer2",
+	 buffer2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->number_of_buffers",
+	 cluster_block_pool->number_of_buffers,
+	 1 );
+
+	/* The pooled buffer is reused
+	 */
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "buffer1 == pooled_buffer",
+	 (int) ( buffer1 == pooled_buffer ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->number_of_buffers",
+	 cluster_block_pool->number_of_buffers,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_pool_get_buffer(
+	          NULL,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          NULL,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_free(
+	          &cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_block_pool",
+	 cluster_block_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( buffer2 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer2,
+		 NULL );
+	}
+	if( buffer1 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer1,
+		 NULL );
+	}
+	if( cluster_block_pool != NULL )
+	{
+		libqcow_cluster_block_pool_free(
+		 &cluster_block_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_pool_clear function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_pool_clear(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	uint8_t *buffer1                                 = NULL;
+	uint8_t *buffer2                                 = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          4096,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->number_of_buffers",
+	 cluster_block_pool->number_of_buffers,
+	 2 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_pool_clear(
+	          cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->number_of_buffers",
+	 cluster_block_pool->number_of_buffers,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_pool_clear(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_pool_free(
+	          &cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( buffer2 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer2,
+		 NULL );
+	}
+	if( buffer1 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer1,
+		 NULL );
+	}
+	if( cluster_block_pool != NULL )
+	{
+		libqcow_cluster_block_pool_free(
+		 &cluster_block_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_block_pool_initialize_arena function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_block_pool_initialize_arena(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_block_pool_t *cluster_block_pool = NULL;
+	uint8_t *buffer1                                 = NULL;
+	uint8_t *buffer2                                 = NULL;
+	uint8_t *buffer3                                 = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_block_pool_initialize(
+	          &cluster_block_pool,
+	          4096,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_block_pool_initialize_arena(
+	          cluster_block_pool,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The first buffers are taken from the arena and the buffer
+	 * after that is allocated since the arena is full
+	 */
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_get_buffer(
+	          cluster_block_pool,
+	          &buffer3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_arena_contains(
+	          cluster_block_pool->arena,
+	          buffer2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_arena_contains(
+	          cluster_block_pool->arena,
+	          buffer3 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* The first buffer is pooled and the second is released back into the arena
+	 */
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->arena->number_of_free_slots",
+	 cluster_block_pool->arena->number_of_free_slots,
+	 1 );
+
+	result = libqcow_cluster_block_pool_release_buffer(
+	          cluster_block_pool,
+	          &buffer3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_block_pool_clear(
+	          cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_block_pool->arena->number_of_free_slots",
+	 cluster_block_pool->arena->number_of_free_slots,
+	 2 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_block_pool_initialize_arena(
+	          NULL,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_block_pool_initialize_arena(
+	          cluster_block_pool,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_block_pool_free(
+	          &cluster_block_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( buffer3 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer3,
+		 NULL );
+	}
+	if( buffer2 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer2,
+		 NULL );
+	}
+	if( buffer1 != NULL )
+	{
+		libqcow_cluster_block_pool_release_buffer(
+		 cluster_block_pool,
+		 &buffer1,
+		 NULL );
+	}
+	if( cluster_block_pool != NULL )
+	{
+		libqcow_cluster_block_pool_free(
+		 &cluster_block_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_pool_initialize",
+	 qcow_test_cluster_block_pool_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_pool_free",
+	 qcow_test_cluster_block_pool_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_pool_get_buffer",
+	 qcow_test_cluster_block_pool_get_buffer );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_pool_clear",
+	 qcow_test_cluster_block_pool_clear );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_block_pool_initialize_arena",
+	 qcow_test_cluster_block_pool_initialize_arena );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -21,12 +21,14 @@
 
 #include <common.h>
 #include <file_stream.h>
+#include <memory.h>
 #include <types.h>
 
 #if defined( HAVE_STDLIB_H ) || defined( WINAPI )
 #include <stdlib.h>
 #endif
 
+#include "qcow_test_libbfio.h"
 #include "qcow_test_libcerror.h"
 #include "qcow_test_libqcow.h"
 #include "qcow_test_macros.h"
@@ -34,6 +36,7 @@
 #include "qcow_test_unused.h"
 
 #include "../libqcow/libqcow_cluster_table.h"
+#include "../libqcow/libqcow_cluster_table_pool.h"
 
 #if defined( __GNUC__ )
 
@@ -393,6 +396,1061 @@ on_error:
 	return( 0 );
 }
 
+/* Tests the libqcow_cluster_table_read_data function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_read_data(
+     void )
+{
+	uint8_t cluster_table_data[ 16 ] = {
+		0x80, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	libcerror_error_t *error               = NULL;
+	libqcow_cluster_table_t *cluster_table = NULL;
+	uint64_t reference                     = 0;
+	int number_of_references               = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_number_of_references(
+	          cluster_table,
+	          &number_of_references,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_references",
+	 number_of_references,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_reference_by_index(
+	          cluster_table,
+	          0,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x8000000000050000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_read_data(
+	          NULL,
+	          cluster_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          NULL,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          (size_t) SSIZE_MAX + 1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          15,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &cluster_table,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_read_data function with a pool
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_read_data_with_pool(
+     void )
+{
+	uint8_t cluster_table_data[ 16 ] = {
+		0x80, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_table_t *cluster_table           = NULL;
+	libqcow_cluster_table_pool_t *cluster_table_pool = NULL;
+	uint64_t reference                               = 0;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          16,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table_pool",
+	 cluster_table_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	cluster_table->pool = cluster_table_pool;
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_reference_by_index(
+	          cluster_table,
+	          1,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x0000000000000001UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Freeing the cluster table releases the references to the pool
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	cluster_table->pool = cluster_table_pool;
+
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          8,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_free(
+	          &cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &cluster_table,
+		 NULL );
+	}
+	if( cluster_table_pool != NULL )
+	{
+		libqcow_cluster_table_pool_free(
+		 &cluster_table_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_read_data function with references that are decoded on access
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_read_data_decode_on_access(
+     void )
+{
+	uint8_t cluster_table_data[ 16 ] = {
+		0x80, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	uint8_t expected_table_data[ 16 ] = {
+		0x80, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00 };
+
+	libcerror_error_t *error               = NULL;
+	libqcow_cluster_table_t *cluster_table = NULL;
+	uint64_t reference                     = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	cluster_table->decode_on_access = 1;
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_read_data(
+	          cluster_table,
+	          cluster_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_reference_by_index(
+	          cluster_table,
+	          0,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x8000000000050000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_set_reference_by_index(
+	          cluster_table,
+	          1,
+	          (uint64_t) 0x0000000000070000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_reference_by_index(
+	          cluster_table,
+	          1,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x0000000000070000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The references are retained in their on-disk form
+	 */
+	result = memory_compare(
+	          cluster_table->references,
+	          expected_table_data,
+	          16 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &cluster_table,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_read_reference_by_index and libqcow_cluster_table_get_cached_reference_by_index functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_read_reference_by_index(
+     void )
+{
+	uint8_t cluster_table_data[ 56 ];
+
+	libbfio_handle_t *file_io_handle       = NULL;
+	libcerror_error_t *error               = NULL;
+	libqcow_cluster_table_t *cluster_table = NULL;
+	void *memset_result                    = NULL;
+	uint64_t reference                     = 0;
+	int number_of_references               = 0;
+	int reference_index                    = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 * The cluster table of 5 references is stored at offset 16
+	 * and is read in pages of 2 references
+	 */
+	memset_result = memory_set(
+	                 cluster_table_data,
+	                 0,
+	                 sizeof( uint8_t ) * 56 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "memset_result",
+	 memset_result );
+
+	for( reference_index = 0;
+	     reference_index < 5;
+	     reference_index++ )
+	{
+		cluster_table_data[ 16 + ( reference_index * 8 ) + 6 ] = (uint8_t) ( 0x10 * ( reference_index + 1 ) );
+	}
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          cluster_table_data,
+	          56,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_read_on_demand(
+	          cluster_table,
+	          16,
+	          40,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_number_of_references(
+	          cluster_table,
+	          &number_of_references,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_references",
+	 number_of_references,
+	 5 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table->number_of_pages",
+	 cluster_table->number_of_pages,
+	 3 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_read_reference_by_index(
+	          cluster_table,
+	          file_io_handle,
+	          4,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x5000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Only the page that contains the reference should have been read
+	 */
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table->pages[ 0 ]",
+	 cluster_table->pages[ 0 ] );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table->pages[ 1 ]",
+	 cluster_table->pages[ 1 ] );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table->pages[ 2 ]",
+	 cluster_table->pages[ 2 ] );
+
+	/* A reference in a page that has not been read is not available without reading it
+	 */
+	result = libqcow_cluster_table_get_cached_reference_by_index(
+	          cluster_table,
+	          0,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_cached_reference_by_index(
+	          cluster_table,
+	          4,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x5000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( reference_index = 0;
+	     reference_index < 5;
+	     reference_index++ )
+	{
+		result = libqcow_cluster_table_read_reference_by_index(
+		          cluster_table,
+		          file_io_handle,
+		          reference_index,
+		          &reference,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "reference",
+		 reference,
+		 (uint64_t) ( 0x1000 * ( reference_index + 1 ) ) );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_read_reference_by_index(
+	          NULL,
+	          file_io_handle,
+	          0,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_reference_by_index(
+	          cluster_table,
+	          file_io_handle,
+	          5,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_reference_by_index(
+	          cluster_table,
+	          file_io_handle,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_read_on_demand(
+	          cluster_table,
+	          16,
+	          40,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table",
+	 cluster_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test reading a page beyond the end of the data
+	 */
+	result = libqcow_cluster_table_initialize(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_read_on_demand(
+	          cluster_table,
+	          48,
+	          24,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_read_reference_by_index(
+	          cluster_table,
+	          file_io_handle,
+	          2,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_free(
+	          &cluster_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &cluster_table,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
 #endif /* defined( __GNUC__ ) */
 
 /* The main program
@@ -426,8 +1484,24 @@ int main(
 
 	/* TODO: add tests for libqcow_cluster_table_get_reference_by_index */
 
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_read_data",
+	 qcow_test_cluster_table_read_data );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_read_data_with_pool",
+	 qcow_test_cluster_table_read_data_with_pool );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_read_data_decode_on_access",
+	 qcow_test_cluster_table_read_data_decode_on_access );
+
 	/* TODO: add tests for libqcow_cluster_table_read */
 
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_read_reference_by_index",
+	 qcow_test_cluster_table_read_reference_by_index );
+
 #endif /* defined( __GNUC__ ) */
 
 	return( EXIT_SUCCESS );
@@ -0,0 +1,1137 @@
+/*
+ * Library cluster_table_pool type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_cluster_table_pool.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_cluster_table_pool_allocate_references function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_allocate_references(
+     void )
+{
+	uint64_t *references = NULL;
+
+	/* Test regular cases
+	 */
+	references = libqcow_cluster_table_pool_allocate_references(
+	              65536 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "references",
+	 references );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "page alignment",
+	 (int) ( (intptr_t) references % 4096 ),
+	 0 );
+
+	/* The references are writable over their entire size
+	 */
+	references[ 0 ]    = 1;
+	references[ 8191 ] = 2;
+
+	libqcow_cluster_table_pool_free_references(
+	 references );
+
+	references = libqcow_cluster_table_pool_allocate_references(
+	              512 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "references",
+	 references );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cache line alignment",
+	 (int) ( (intptr_t) references % 64 ),
+	 0 );
+
+	libqcow_cluster_table_pool_free_references(
+	 references );
+
+	references = NULL;
+
+	/* Test error cases
+	 */
+	references = libqcow_cluster_table_pool_allocate_references(
+	              0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "references",
+	 references );
+
+	references = libqcow_cluster_table_pool_allocate_references(
+	              (size_t) SSIZE_MAX );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "references",
+	 references );
+
+	return( 1 );
+
+on_error:
+	if( references != NULL )
+	{
+		libqcow_cluster_table_pool_free_references(
+		 references );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_pool_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_initialize(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_table_pool_t *cluster_table_pool = NULL;
+	int result                                       = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests                  = 2;
+	int number_of_memset_fail_tests                  = 2;
+	int test_number                                  = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table_pool",
+	 cluster_table_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_free(
+	          &cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table_pool",
+	 cluster_table_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          NULL,
+	          512,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	cluster_table_pool = (libqcow_cluster_table_pool_t *) 0x12345678UL;
+
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          4,
+	          &error );
+
+	cluster_table_pool = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          0,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cluster_table_pool_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_cluster_table_pool_initialize(
+		          &cluster_table_pool,
+		          512,
+		          4,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( cluster_table_pool != NULL )
+			{
+				libqcow_cluster_table_pool_free(
+				 &cluster_table_pool,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cluster_table_pool",
+			 cluster_table_pool );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_cluster_table_pool_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_cluster_table_pool_initialize(
+		          &cluster_table_pool,
+		          512,
+		          4,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( cluster_table_pool != NULL )
+			{
+				libqcow_cluster_table_pool_free(
+				 &cluster_table_pool,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "cluster_table_pool",
+			 cluster_table_pool );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( cluster_table_pool != NULL )
+	{
+		libqcow_cluster_table_pool_free(
+		 &cluster_table_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_pool_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_pool_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_pool_get_references and libqcow_cluster_table_pool_release_references functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_get_references(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_table_pool_t *cluster_table_pool = NULL;
+	uint64_t *pooled_references                      = NULL;
+	uint64_t *references1                            = NULL;
+	uint64_t *references2                            = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cluster_table_pool",
+	 cluster_table_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "references1",
+	 references1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "references2",
+	 references2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	pooled_references = references1;
+
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "references1",
+	 references1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 1 );
+
+	/* The pool is full hence the references are freed
+	 */
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "references2",
+	 references2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 1 );
+
+	/* The pooled references are reused
+	 */
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "references1 == pooled_references",
+	 (int) ( references1 == pooled_references ),
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_pool_get_references(
+	          NULL,
+	          512,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          1024,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_release_references(
+	          NULL,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_free(
+	          &cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cluster_table_pool",
+	 cluster_table_pool );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( references2 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references2,
+		 NULL );
+	}
+	if( references1 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references1,
+		 NULL );
+	}
+	if( cluster_table_pool != NULL )
+	{
+		libqcow_cluster_table_pool_free(
+		 &cluster_table_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_pool_clear function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_clear(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_table_pool_t *cluster_table_pool = NULL;
+	uint64_t *references1                            = NULL;
+	uint64_t *references2                            = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 2 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_pool_clear(
+	          cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->number_of_references",
+	 cluster_table_pool->number_of_references,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_pool_clear(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_pool_free(
+	          &cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( references2 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references2,
+		 NULL );
+	}
+	if( references1 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references1,
+		 NULL );
+	}
+	if( cluster_table_pool != NULL )
+	{
+		libqcow_cluster_table_pool_free(
+		 &cluster_table_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_cluster_table_pool_initialize_arena function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_cluster_table_pool_initialize_arena(
+     void )
+{
+	libcerror_error_t *error                         = NULL;
+	libqcow_cluster_table_pool_t *cluster_table_pool = NULL;
+	uint64_t *references1                            = NULL;
+	uint64_t *references2                            = NULL;
+	int result                                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_cluster_table_pool_initialize(
+	          &cluster_table_pool,
+	          512,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_cluster_table_pool_initialize_arena(
+	          cluster_table_pool,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The first references are taken from the arena and the references
+	 * after that are allocated since the arena is full
+	 */
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_pool_get_references(
+	          cluster_table_pool,
+	          512,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_arena_contains(
+	          cluster_table_pool->arena,
+	          (uint8_t *) references1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_arena_contains(
+	          cluster_table_pool->arena,
+	          (uint8_t *) references2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The pool is full, hence the references are released back into the arena
+	 */
+	result = libqcow_cluster_table_pool_release_references(
+	          cluster_table_pool,
+	          &references1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "cluster_table_pool->arena->number_of_free_slots",
+	 cluster_table_pool->arena->number_of_free_slots,
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_cluster_table_pool_initialize_arena(
+	          NULL,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_cluster_table_pool_initialize_arena(
+	          cluster_table_pool,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_cluster_table_pool_free(
+	          &cluster_table_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( references2 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references2,
+		 NULL );
+	}
+	if( references1 != NULL )
+	{
+		libqcow_cluster_table_pool_release_references(
+		 cluster_table_pool,
+		 &references1,
+		 NULL );
+	}
+	if( cluster_table_pool != NULL )
+	{
+		libqcow_cluster_table_pool_free(
+		 &cluster_table_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_allocate_references",
+	 qcow_test_cluster_table_pool_allocate_references );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_initialize",
+	 qcow_test_cluster_table_pool_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_free",
+	 qcow_test_cluster_table_pool_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_get_references",
+	 qcow_test_cluster_table_pool_get_references );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_clear",
+	 qcow_test_cluster_table_pool_clear );
+
+	QCOW_TEST_RUN(
+	 "libqcow_cluster_table_pool_initialize_arena",
+	 qcow_test_cluster_table_pool_initialize_arena );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
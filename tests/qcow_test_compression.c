@@ -0,0 +1,1082 @@
+/*
+ * Library compression functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_compression.h"
+
+#if defined( __GNUC__ )
+
+/* Raw deflate compressed data of qcow_test_compression_uncompressed_data
+ */
+uint8_t qcow_test_compression_compressed_data[ 50 ] = {
+	0x0b, 0xc9, 0x48, 0x55, 0x28, 0x2c, 0xcd, 0x4c, 0xce, 0x56, 0x48, 0x2a, 0xca, 0x2f, 0xcf, 0x53,
+	0x48, 0xcb, 0xaf, 0x50, 0xc8, 0x2a, 0xcd, 0x2d, 0x28, 0x56, 0xc8, 0x2f, 0x4b, 0x2d, 0x52, 0x28,
+	0x01, 0x4a, 0xe7, 0x24, 0x56, 0x55, 0x2a, 0xa4, 0xe4, 0xa7, 0xeb, 0x29, 0x84, 0x90, 0xa0, 0x98,
+	0x0b, 0x00 };
+
+uint8_t qcow_test_compression_uncompressed_data[ 91 ] =
+	"The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n";
+
+/* Raw deflate compressed data of 256 x 'A', followed by 256 bytes of repeating "xyz"
+ * and 512 bytes of a repeating 20 byte pattern, which are back-references with a distance of 1, 3 and 20
+ */
+uint8_t qcow_test_compression_compressed_matches_data[ 36 ] = {
+	0x73, 0x74, 0x1c, 0xd9, 0xa0, 0xa2, 0xb2, 0x6a, 0x44, 0x23, 0x03, 0x43, 0x23, 0x63, 0x13, 0x53,
+	0x33, 0x73, 0x0b, 0x4b, 0x2b, 0x6b, 0x1b, 0x5b, 0x3b, 0x7b, 0x07, 0x47, 0x27, 0xe7, 0x51, 0xb1,
+	0x91, 0x23, 0x06, 0x00 };
+
+/* Tests the libqcow_decompression_context_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_decompression_context_initialize(
+     void )
+{
+	libcerror_error_t *error                               = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	int result                                             = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests                        = 1;
+	int number_of_memset_fail_tests                        = 1;
+	int test_number                                        = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "decompression_context",
+         decompression_context );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_decompression_context_free(
+	          &decompression_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "decompression_context",
+         decompression_context );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test error cases
+	 */
+	result = libqcow_decompression_context_initialize(
+	          NULL,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	decompression_context = (libqcow_decompression_context_t *) 0x12345678UL;
+
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	decompression_context = NULL;
+
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          0xffff,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_decompression_context_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_decompression_context_initialize(
+		          &decompression_context,
+		          1,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( decompression_context != NULL )
+			{
+				libqcow_decompression_context_free(
+				 &decompression_context,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "decompression_context",
+			 decompression_context );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_decompression_context_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_decompression_context_initialize(
+		          &decompression_context,
+		          1,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( decompression_context != NULL )
+			{
+				libqcow_decompression_context_free(
+				 &decompression_context,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "decompression_context",
+			 decompression_context );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_decompression_context_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_decompression_context_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_decompression_context_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_decompression_context_decompress_data function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_decompression_context_decompress_data(
+     void )
+{
+	uint8_t expected_matches_data[ 1024 ];
+	uint8_t uncompressed_data[ 128 ];
+	uint8_t uncompressed_matches_data[ 1024 ];
+
+	libcerror_error_t *error                               = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	size_t data_index                                      = 0;
+	size_t uncompressed_data_size                          = 0;
+	int iterator                                           = 0;
+	int result                                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "decompression_context",
+         decompression_context );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test regular cases
+	 * The decompression context is used multiple times to test it is reset correctly
+	 */
+	for( iterator = 0;
+	     iterator < 2;
+	     iterator++ )
+	{
+		uncompressed_data_size = 128;
+
+		result = libqcow_decompression_context_decompress_data(
+		          decompression_context,
+		          qcow_test_compression_compressed_data,
+		          50,
+		          uncompressed_data,
+		          &uncompressed_data_size,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_SIZE(
+		 "uncompressed_data_size",
+		 uncompressed_data_size,
+		 (size_t) 90 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          uncompressed_data,
+		          qcow_test_compression_uncompressed_data,
+		          90 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	/* Test data that consists of back-references, where the last match
+	 * ends at the end of the uncompressed data
+	 */
+	for( data_index = 0;
+	     data_index < 256;
+	     data_index++ )
+	{
+		expected_matches_data[ data_index ]       = (uint8_t) 'A';
+		expected_matches_data[ 256 + data_index ] = (uint8_t) "xyz"[ data_index % 3 ];
+	}
+	for( data_index = 0;
+	     data_index < 512;
+	     data_index++ )
+	{
+		expected_matches_data[ 512 + data_index ] = (uint8_t) ( '0' + ( data_index % 20 ) );
+	}
+	uncompressed_data_size = 1024;
+
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          qcow_test_compression_compressed_matches_data,
+	          36,
+	          uncompressed_matches_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "uncompressed_data_size",
+	 uncompressed_data_size,
+	 (size_t) 1024 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          uncompressed_matches_data,
+	          expected_matches_data,
+	          1024 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	uncompressed_data_size = 128;
+
+	result = libqcow_decompression_context_decompress_data(
+	          NULL,
+	          qcow_test_compression_compressed_data,
+	          50,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          NULL,
+	          50,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          qcow_test_compression_compressed_data,
+	          50,
+	          NULL,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_context_decompress_data(
+	          decompression_context,
+	          qcow_test_compression_compressed_data,
+	          50,
+	          uncompressed_data,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_decompression_context_free(
+	          &decompression_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "decompression_context",
+         decompression_context );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_decompression_state_decompress_data function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_decompression_state_decompress_data(
+     void )
+{
+	uint8_t expected_matches_data[ 1024 ];
+	uint8_t uncompressed_matches_data[ 1024 ];
+
+	size_t stop_data_offsets[ 4 ]                          = { 100, 600, 300, 0 };
+
+	libcerror_error_t *error                               = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	libqcow_decompression_state_t *decompression_state     = NULL;
+	size_t data_index                                      = 0;
+	int iterator                                           = 0;
+	int result                                             = 0;
+
+	/* Initialize test
+	 */
+	for( data_index = 0;
+	     data_index < 256;
+	     data_index++ )
+	{
+		expected_matches_data[ data_index ]       = (uint8_t) 'A';
+		expected_matches_data[ 256 + data_index ] = (uint8_t) "xyz"[ data_index % 3 ];
+	}
+	for( data_index = 0;
+	     data_index < 512;
+	     data_index++ )
+	{
+		expected_matches_data[ 512 + data_index ] = (uint8_t) ( '0' + ( data_index % 20 ) );
+	}
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_decompression_state_initialize(
+	          &decompression_state,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "decompression_state",
+	 decompression_state );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 * The decompression is resumed where the previous call stopped
+	 */
+	for( iterator = 0;
+	     iterator < 4;
+	     iterator++ )
+	{
+		result = libqcow_decompression_state_decompress_data(
+		          decompression_state,
+		          decompression_context,
+		          qcow_test_compression_compressed_matches_data,
+		          36,
+		          uncompressed_matches_data,
+		          1024,
+		          stop_data_offsets[ iterator ],
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		if( stop_data_offsets[ iterator ] != 0 )
+		{
+			/* At least the data up to the stop data offset is decompressed
+			 */
+			QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+			 "stop_data_offset",
+			 (uint64_t) stop_data_offsets[ iterator ],
+			 (uint64_t) decompression_state->uncompressed_data_offset + 1 );
+
+			result = memory_compare(
+			          uncompressed_matches_data,
+			          expected_matches_data,
+			          stop_data_offsets[ iterator ] );
+
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 0 );
+		}
+	}
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "decompression_state->is_complete",
+	 (int) decompression_state->is_complete,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "decompression_state->uncompressed_data_offset",
+	 decompression_state->uncompressed_data_offset,
+	 (size_t) 1024 );
+
+	result = memory_compare(
+	          uncompressed_matches_data,
+	          expected_matches_data,
+	          1024 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_decompression_state_decompress_data(
+	          NULL,
+	          decompression_context,
+	          qcow_test_compression_compressed_matches_data,
+	          36,
+	          uncompressed_matches_data,
+	          1024,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_state_decompress_data(
+	          decompression_state,
+	          decompression_context,
+	          NULL,
+	          36,
+	          uncompressed_matches_data,
+	          1024,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_state_decompress_data(
+	          decompression_state,
+	          decompression_context,
+	          qcow_test_compression_compressed_matches_data,
+	          36,
+	          NULL,
+	          1024,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_decompression_state_free(
+	          &decompression_state,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "decompression_state",
+	 decompression_state );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_decompression_context_free(
+	          &decompression_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( decompression_state != NULL )
+	{
+		libqcow_decompression_state_free(
+		 &decompression_state,
+		 NULL );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_decompression_context_get_state and libqcow_decompression_context_release_state functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_decompression_context_get_state(
+     void )
+{
+	uint8_t uncompressed_matches_data[ 1024 ];
+
+	libcerror_error_t *error                               = NULL;
+	libqcow_decompression_context_t *decompression_context = NULL;
+	libqcow_decompression_state_t *decompression_state     = NULL;
+	libqcow_decompression_state_t *spare_state             = NULL;
+	int iterator                                           = 0;
+	int result                                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_decompression_context_initialize(
+	          &decompression_context,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 * The released decompression state is handed out again after it was reset
+	 */
+	for( iterator = 0;
+	     iterator < 2;
+	     iterator++ )
+	{
+		result = libqcow_decompression_context_get_state(
+		          decompression_context,
+		          &decompression_state,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "decompression_state",
+		 decompression_state );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		if( iterator == 0 )
+		{
+			spare_state = decompression_state;
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "decompression_state == spare_state",
+			 (int) ( decompression_state == spare_state ),
+			 1 );
+		}
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "decompression_context->spare_decompression_state",
+		 decompression_context->spare_decompression_state );
+
+		QCOW_TEST_ASSERT_EQUAL_SIZE(
+		 "decompression_state->uncompressed_data_offset",
+		 decompression_state->uncompressed_data_offset,
+		 (size_t) 0 );
+
+		result = libqcow_decompression_state_decompress_data(
+		          decompression_state,
+		          decompression_context,
+		          qcow_test_compression_compressed_matches_data,
+		          36,
+		          uncompressed_matches_data,
+		          1024,
+		          0,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "decompression_state->is_complete",
+		 (int) decompression_state->is_complete,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_SIZE(
+		 "decompression_state->uncompressed_data_offset",
+		 decompression_state->uncompressed_data_offset,
+		 (size_t) 1024 );
+
+		result = libqcow_decompression_context_release_state(
+		          decompression_context,
+		          &decompression_state,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "decompression_state",
+		 decompression_state );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "decompression_context->spare_decompression_state",
+	 decompression_context->spare_decompression_state );
+
+	/* Test error cases
+	 */
+	result = libqcow_decompression_context_get_state(
+	          NULL,
+	          &decompression_state,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_context_get_state(
+	          decompression_context,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_decompression_context_release_state(
+	          NULL,
+	          &decompression_state,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 * The spare decompression state is freed with the context
+	 */
+	result = libqcow_decompression_context_free(
+	          &decompression_context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( decompression_state != NULL )
+	{
+		libqcow_decompression_state_free(
+		 &decompression_state,
+		 NULL );
+	}
+	if( decompression_context != NULL )
+	{
+		libqcow_decompression_context_free(
+		 &decompression_context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_decompression_context_initialize",
+	 qcow_test_decompression_context_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_decompression_context_free",
+	 qcow_test_decompression_context_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_decompression_context_decompress_data",
+	 qcow_test_decompression_context_decompress_data );
+
+	QCOW_TEST_RUN(
+	 "libqcow_decompression_state_decompress_data",
+	 qcow_test_decompression_state_decompress_data );
+
+	QCOW_TEST_RUN(
+	 "libqcow_decompression_context_get_state",
+	 qcow_test_decompression_context_get_state );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,601 @@
+/*
+ * Library consistency check type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_consistency_check.h"
+#include "../libqcow/libqcow_file.h"
+#include "../libqcow/libqcow_io_handle.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_consistency_check_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_consistency_check_initialize(
+     void )
+{
+	libcerror_error_t *error                       = NULL;
+	libqcow_consistency_check_t *consistency_check = NULL;
+	libqcow_file_t *file                           = NULL;
+	int result                                     = 0;
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          file,
+	          LIBQCOW_CONSISTENCY_CHECK_FLAG_VERIFY_COMPRESSED_DATA,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "consistency_check",
+	 consistency_check );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "consistency_check->number_of_workers",
+	 consistency_check->number_of_workers,
+	 4 );
+
+	result = libqcow_consistency_check_free(
+	          &consistency_check,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "consistency_check",
+	 consistency_check );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_consistency_check_initialize(
+	          NULL,
+	          file,
+	          0,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	consistency_check = (libqcow_consistency_check_t *) 0x12345678UL;
+
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          file,
+	          0,
+	          1,
+	          &error );
+
+	consistency_check = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          NULL,
+	          0,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          file,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          file,
+	          0,
+	          LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS + 1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( consistency_check != NULL )
+	{
+		libqcow_consistency_check_free(
+		 &consistency_check,
+		 NULL );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_consistency_check_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_consistency_check_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_consistency_check_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_consistency_check_get_next_level2_tables function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_consistency_check_get_next_level2_tables(
+     void )
+{
+	uint64_t level2_table_offsets[ 6 ] = {
+		0x00010000UL, 0x00010000UL, 0x00020000UL, 0x00040000UL, 0x00050000UL, 0x00070000UL };
+
+	libcerror_error_t *error                       = NULL;
+	libqcow_consistency_check_t *consistency_check = NULL;
+	libqcow_file_t *file                           = NULL;
+	int level2_table_index                         = 0;
+	int number_of_level2_tables                    = 0;
+	int offset_index                               = 0;
+	int result                                     = 0;
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	( (libqcow_internal_file_t *) file )->io_handle->level2_table_size = 0x00010000UL;
+
+	result = libqcow_consistency_check_initialize(
+	          &consistency_check,
+	          file,
+	          0,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( offset_index = 0;
+	     offset_index < 6;
+	     offset_index++ )
+	{
+		result = libqcow_consistency_check_append_level2_table_offset(
+		          consistency_check,
+		          level2_table_offsets[ offset_index ],
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "consistency_check->number_of_level2_table_offsets",
+	 consistency_check->number_of_level2_table_offsets,
+	 6 );
+
+	/* Test regular cases
+	 * The same and adjacent level 2 tables are taken as a single run
+	 */
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          &level2_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level2_table_index",
+	 level2_table_index,
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 3 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          &level2_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level2_table_index",
+	 level2_table_index,
+	 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          &level2_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level2_table_index",
+	 level2_table_index,
+	 5 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          &level2_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          NULL,
+	          &level2_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          NULL,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_consistency_check_get_next_level2_tables(
+	          consistency_check,
+	          &level2_table_index,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_consistency_check_free(
+	          &consistency_check,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( consistency_check != NULL )
+	{
+		libqcow_consistency_check_free(
+		 &consistency_check,
+		 NULL );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_consistency_check_initialize",
+	 qcow_test_consistency_check_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_consistency_check_free",
+	 qcow_test_consistency_check_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_consistency_check_get_next_level2_tables",
+	 qcow_test_consistency_check_get_next_level2_tables );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,1535 @@
+/*
+ * Library creator type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <byte_stream.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_compression.h"
+#include "../libqcow/libqcow_creator.h"
+#include "../libqcow/libqcow_definitions.h"
+#include "../libqcow/libqcow_file.h"
+
+#if defined( __GNUC__ )
+
+/* The source contains 10 cluster blocks of 4096 bytes and a partial cluster block
+ */
+#define QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE	4096
+#define QCOW_TEST_CREATOR_MEDIA_SIZE		( ( 10 * 4096 ) + 100 )
+#define QCOW_TEST_CREATOR_IMAGE_SIZE		( 32 * 4096 )
+
+/* The slices source contains 514 cluster blocks of 8192 bytes, the level 2 table of 1024 entries
+ * is read in slices of 512 entries, hence cluster blocks 511 and 512 are in different slices
+ */
+#define QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE	8192
+#define QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE		( 514 * 8192 )
+#define QCOW_TEST_CREATOR_SLICES_IMAGE_SIZE		( 2 * 1024 * 1024 )
+
+uint8_t qcow_test_creator_source_data[ QCOW_TEST_CREATOR_MEDIA_SIZE ];
+
+uint8_t qcow_test_creator_image_data[ QCOW_TEST_CREATOR_IMAGE_SIZE ];
+
+/* Fills the source data
+ * The even cluster blocks contain compressible data and the odd cluster blocks
+ * contain pseudo random data that does not compress, except for cluster block 4
+ * which contains 0-byte values
+ */
+void qcow_test_creator_fill_source_data(
+      void )
+{
+	size_t data_offset   = 0;
+	uint32_t value_32bit = 0x12345678UL;
+
+	for( data_offset = 0;
+	     data_offset < QCOW_TEST_CREATOR_MEDIA_SIZE;
+	     data_offset++ )
+	{
+		if( ( data_offset / QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ) == 4 )
+		{
+			qcow_test_creator_source_data[ data_offset ] = 0;
+		}
+		else if( ( ( data_offset / QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ) % 2 ) == 0 )
+		{
+			qcow_test_creator_source_data[ data_offset ] = (uint8_t) ( ( data_offset / 64 ) % 7 );
+		}
+		else
+		{
+			value_32bit = ( value_32bit * 1103515245UL ) + 12345UL;
+
+			qcow_test_creator_source_data[ data_offset ] = (uint8_t) ( value_32bit >> 16 );
+		}
+	}
+}
+
+/* Opens a memory range file IO handle
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_creator_open_memory_range(
+     libbfio_handle_t **file_io_handle,
+     uint8_t *data,
+     size_t data_size,
+     int access_flags )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	result = libbfio_memory_range_initialize(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_memory_range_set(
+	          *file_io_handle,
+	          data,
+	          data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_handle_open(
+	          *file_io_handle,
+	          access_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( *file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_creator_task_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_creator_task_initialize(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_creator_task_t *creator_task = NULL;
+	int result                           = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_creator_task_initialize(
+	          &creator_task,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "creator_task",
+	 creator_task );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_creator_task_free(
+	          &creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_creator_task_initialize(
+	          NULL,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_task_initialize(
+	          &creator_task,
+	          512,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "creator_task",
+	 creator_task );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( creator_task != NULL )
+	{
+		libqcow_creator_task_free(
+		 &creator_task,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_creator_task_process function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_creator_task_process(
+     void )
+{
+	uint8_t uncompressed_data[ QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ];
+
+	libcerror_error_t *error             = NULL;
+	libqcow_creator_task_t *creator_task = NULL;
+	size_t uncompressed_data_size        = 0;
+	int result                           = 0;
+
+	qcow_test_creator_fill_source_data();
+
+	result = libqcow_creator_task_initialize(
+	          &creator_task,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test compressible data
+	 */
+	memory_copy(
+	 creator_task->data,
+	 qcow_test_creator_source_data,
+	 QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE );
+
+	result = libqcow_creator_task_process(
+	          creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_GREATER_THAN_INT(
+	 "creator_task->compressed_data_size",
+	 (int) creator_task->compressed_data_size,
+	 0 );
+
+	uncompressed_data_size = QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE;
+
+	result = libqcow_decompress_data(
+	          creator_task->compressed_data,
+	          creator_task->compressed_data_size,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "uncompressed_data_size",
+	 uncompressed_data_size,
+	 (size_t) QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE );
+
+	result = memory_compare(
+	          uncompressed_data,
+	          qcow_test_creator_source_data,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test data that does not compress
+	 */
+	memory_copy(
+	 creator_task->data,
+	 &( qcow_test_creator_source_data[ QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ] ),
+	 QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE );
+
+	result = libqcow_creator_task_process(
+	          creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "creator_task->compressed_data_size",
+	 creator_task->compressed_data_size,
+	 (size_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "creator_task->is_zero",
+	 (int) creator_task->is_zero,
+	 0 );
+
+	/* Test data that contains only 0-byte values
+	 */
+	memory_copy(
+	 creator_task->data,
+	 &( qcow_test_creator_source_data[ 4 * QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ] ),
+	 QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE );
+
+	result = libqcow_creator_task_process(
+	          creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "creator_task->is_zero",
+	 (int) creator_task->is_zero,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "creator_task->compressed_data_size",
+	 creator_task->compressed_data_size,
+	 (size_t) 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_creator_task_process(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_task_free(
+	          &creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( creator_task != NULL )
+	{
+		libqcow_creator_task_free(
+		 &creator_task,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_creator_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_creator_initialize(
+     void )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	libcerror_error_t *error         = NULL;
+	libqcow_creator_t *creator       = NULL;
+	int result                       = 0;
+
+	result = qcow_test_creator_open_memory_range(
+	          &file_io_handle,
+	          qcow_test_creator_image_data,
+	          QCOW_TEST_CREATOR_IMAGE_SIZE,
+	          LIBBFIO_OPEN_READ_WRITE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_creator_initialize(
+	          &creator,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "creator",
+	 creator );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "creator->number_of_cluster_blocks",
+	 creator->number_of_cluster_blocks,
+	 (uint64_t) 11 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "creator->level1_table_size",
+	 creator->level1_table_size,
+	 (uint64_t) 1 );
+
+	result = libqcow_creator_free(
+	          &creator,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_creator_initialize(
+	          NULL,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_initialize(
+	          &creator,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          3000,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_initialize(
+	          &creator,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_NONE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( creator != NULL )
+	{
+		libqcow_creator_free(
+		 &creator,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_creator_set_backing_filename function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_creator_set_backing_filename(
+     void )
+{
+	uint8_t backing_filename[ 10 ]       = { 'b', 'a', 's', 'e', '.', 'q', 'c', 'o', 'w', '2' };
+
+	libbfio_handle_t *file_io_handle     = NULL;
+	libcerror_error_t *error             = NULL;
+	libqcow_creator_t *creator           = NULL;
+	libqcow_creator_task_t *creator_task = NULL;
+	uint64_t cluster_block_reference     = 0;
+	int result                           = 0;
+
+	result = qcow_test_creator_open_memory_range(
+	          &file_io_handle,
+	          qcow_test_creator_image_data,
+	          QCOW_TEST_CREATOR_IMAGE_SIZE,
+	          LIBBFIO_OPEN_READ_WRITE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_creator_initialize(
+	          &creator,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_creator_set_backing_filename(
+	          NULL,
+	          backing_filename,
+	          10,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_set_backing_filename(
+	          creator,
+	          backing_filename,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_creator_set_backing_filename(
+	          creator,
+	          backing_filename,
+	          10,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "creator->backing_filename_size",
+	 creator->backing_filename_size,
+	 (size_t) 10 );
+
+	/* With a backing file a cluster block of 0-byte values is marked as zero
+	 */
+	creator_task = creator->tasks[ 0 ];
+
+	creator_task->cluster_block_index = 2;
+	creator_task->is_zero             = 1;
+
+	result = libqcow_creator_write_cluster_block(
+	          creator,
+	          creator_task,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	byte_stream_copy_to_uint64_big_endian(
+	 &( creator->level2_tables_data[ 2 * 8 ] ),
+	 cluster_block_reference );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) LIBQCOW_CLUSTER_TABLE_ENTRY_FLAG_ZERO );
+
+	/* Test setting the backing filename a second time
+	 */
+	result = libqcow_creator_set_backing_filename(
+	          creator,
+	          backing_filename,
+	          10,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_creator_free(
+	          &creator,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( creator != NULL )
+	{
+		libqcow_creator_free(
+		 &creator,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests creating an image and reading back its cluster blocks
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_create_compressed_image_file_io_handle_with_threads(
+     int number_of_threads )
+{
+	uint8_t uncompressed_data[ QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ];
+
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *source_file_io_handle = NULL;
+	libcerror_error_t *error                = NULL;
+	size_t compare_size                     = 0;
+	size_t compressed_data_size             = 0;
+	size_t uncompressed_data_size           = 0;
+	uint64_t cluster_block_index            = 0;
+	uint64_t cluster_block_offset           = 0;
+	uint64_t cluster_block_reference        = 0;
+	uint64_t level1_table_offset            = 0;
+	uint64_t level2_table_offset            = 0;
+	uint64_t number_of_compressed_blocks    = 0;
+	uint64_t number_of_sectors              = 0;
+	uint32_t value_32bit                    = 0;
+	int result                              = 0;
+
+	qcow_test_creator_fill_source_data();
+
+	memory_set(
+	 qcow_test_creator_image_data,
+	 0xff,
+	 QCOW_TEST_CREATOR_IMAGE_SIZE );
+
+	result = qcow_test_creator_open_memory_range(
+	          &source_file_io_handle,
+	          qcow_test_creator_source_data,
+	          QCOW_TEST_CREATOR_MEDIA_SIZE,
+	          LIBBFIO_OPEN_READ );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = qcow_test_creator_open_memory_range(
+	          &file_io_handle,
+	          qcow_test_creator_image_data,
+	          QCOW_TEST_CREATOR_IMAGE_SIZE,
+	          LIBBFIO_OPEN_READ_WRITE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_create_compressed_image_file_io_handle(
+	          source_file_io_handle,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          number_of_threads,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 qcow_test_creator_image_data,
+	 value_32bit );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "signature",
+	 value_32bit,
+	 (uint32_t) 0x514649fbUL );
+
+	byte_stream_copy_to_uint32_big_endian(
+	 &( qcow_test_creator_image_data[ 4 ] ),
+	 value_32bit );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "format_version",
+	 value_32bit,
+	 (uint32_t) 3 );
+
+	byte_stream_copy_to_uint64_big_endian(
+	 &( qcow_test_creator_image_data[ 40 ] ),
+	 level1_table_offset );
+
+	QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+	 "level1_table_offset",
+	 level1_table_offset,
+	 (uint64_t) QCOW_TEST_CREATOR_IMAGE_SIZE );
+
+	byte_stream_copy_to_uint64_big_endian(
+	 &( qcow_test_creator_image_data[ level1_table_offset ] ),
+	 level2_table_offset );
+
+	level2_table_offset &= 0x00fffffffffffe00ULL;
+
+	QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+	 "level2_table_offset",
+	 level2_table_offset,
+	 (uint64_t) QCOW_TEST_CREATOR_IMAGE_SIZE );
+
+	for( cluster_block_index = 0;
+	     cluster_block_index < 11;
+	     cluster_block_index++ )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 &( qcow_test_creator_image_data[ level2_table_offset + ( cluster_block_index * 8 ) ] ),
+		 cluster_block_reference );
+
+		compare_size = QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE;
+
+		if( cluster_block_index == 10 )
+		{
+			compare_size = 100;
+		}
+		if( cluster_block_index == 4 )
+		{
+			/* The cluster block that contains only 0-byte values is not stored
+			 */
+			QCOW_TEST_ASSERT_EQUAL_UINT64(
+			 "cluster_block_reference",
+			 cluster_block_reference,
+			 (uint64_t) 0 );
+
+			continue;
+		}
+		if( ( cluster_block_reference & ( (uint64_t) 1 << 62 ) ) != 0 )
+		{
+			/* With 12 cluster block bits the number of additional sectors starts at bit 58
+			 */
+			cluster_block_offset = cluster_block_reference & 0x03ffffffffffffffULL;
+			number_of_sectors    = ( cluster_block_reference >> 58 ) & 0x0f;
+			compressed_data_size = (size_t) ( ( number_of_sectors + 1 ) * 512 );
+
+			QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+			 "cluster_block_offset",
+			 cluster_block_offset + compressed_data_size,
+			 (uint64_t) QCOW_TEST_CREATOR_IMAGE_SIZE );
+
+			uncompressed_data_size = QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE;
+
+			result = libqcow_decompress_data(
+			          &( qcow_test_creator_image_data[ cluster_block_offset ] ),
+			          compressed_data_size,
+			          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+			          uncompressed_data,
+			          &uncompressed_data_size,
+			          &error );
+
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 1 );
+
+			result = memory_compare(
+			          uncompressed_data,
+			          &( qcow_test_creator_source_data[ cluster_block_index * QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ] ),
+			          compare_size );
+
+			number_of_compressed_blocks++;
+		}
+		else
+		{
+			cluster_block_offset = cluster_block_reference & 0x00fffffffffffe00ULL;
+
+			QCOW_TEST_ASSERT_EQUAL_UINT64(
+			 "cluster_block_offset % cluster_block_size",
+			 cluster_block_offset % QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+			 (uint64_t) 0 );
+
+			result = memory_compare(
+			          &( qcow_test_creator_image_data[ cluster_block_offset ] ),
+			          &( qcow_test_creator_source_data[ cluster_block_index * QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE ] ),
+			          compare_size );
+		}
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	/* The even cluster blocks, except for cluster block 4, are compressed
+	 */
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "number_of_compressed_blocks",
+	 number_of_compressed_blocks,
+	 (uint64_t) 5 );
+
+	/* Test error cases
+	 */
+	result = libqcow_create_compressed_image_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          number_of_threads,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_create_compressed_image_file_io_handle(
+	          source_file_io_handle,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          23,
+	          number_of_threads,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_handle_free(
+	          &source_file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( source_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &source_file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests reading an image of which the compressed cluster blocks cross a level 2 table slice boundary
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_create_compressed_image_read_level2_table_slices(
+     void )
+{
+	uint64_t statistics[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *source_file_io_handle = NULL;
+	libcerror_error_t *error                = NULL;
+	libqcow_file_t *file                    = NULL;
+	uint8_t *data                           = NULL;
+	uint8_t *image_data                     = NULL;
+	uint8_t *source_data                    = NULL;
+	size_t data_offset                      = 0;
+	size_t read_size                        = 0;
+	ssize_t read_count                      = 0;
+	uint64_t cluster_block_index            = 0;
+	uint64_t cluster_block_reference        = 0;
+	uint64_t compression_flag               = 0;
+	uint64_t level1_table_offset            = 0;
+	uint64_t level2_table_offset            = 0;
+	off64_t offset                          = 0;
+	int result                              = 0;
+
+	/* Initialize test
+	 * Every cluster block contains compressible data that differs per cluster block
+	 */
+	source_data = (uint8_t *) memory_allocate(
+	                           sizeof( uint8_t ) * QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "source_data",
+	 source_data );
+
+	image_data = (uint8_t *) memory_allocate(
+	                          sizeof( uint8_t ) * QCOW_TEST_CREATOR_SLICES_IMAGE_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "image_data",
+	 image_data );
+
+	data = (uint8_t *) memory_allocate(
+	                    sizeof( uint8_t ) * 2 * QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "data",
+	 data );
+
+	for( data_offset = 0;
+	     data_offset < QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE;
+	     data_offset++ )
+	{
+		source_data[ data_offset ] = (uint8_t) ( ( ( data_offset / 64 ) % 7 ) + ( data_offset / QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE ) );
+	}
+	memory_set(
+	 image_data,
+	 0,
+	 QCOW_TEST_CREATOR_SLICES_IMAGE_SIZE );
+
+	result = qcow_test_creator_open_memory_range(
+	          &source_file_io_handle,
+	          source_data,
+	          QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE,
+	          LIBBFIO_OPEN_READ );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = qcow_test_creator_open_memory_range(
+	          &file_io_handle,
+	          image_data,
+	          QCOW_TEST_CREATOR_SLICES_IMAGE_SIZE,
+	          LIBBFIO_OPEN_READ_WRITE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_create_compressed_image_file_io_handle(
+	          source_file_io_handle,
+	          file_io_handle,
+	          QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE,
+	          LIBQCOW_COMPRESSION_METHOD_DEFLATE,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The cluster blocks on both sides of the level 2 table slice boundary are compressed
+	 */
+	byte_stream_copy_to_uint64_big_endian(
+	 &( image_data[ 40 ] ),
+	 level1_table_offset );
+
+	byte_stream_copy_to_uint64_big_endian(
+	 &( image_data[ level1_table_offset ] ),
+	 level2_table_offset );
+
+	level2_table_offset &= 0x00fffffffffffe00ULL;
+
+	QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+	 "level2_table_offset",
+	 level2_table_offset,
+	 (uint64_t) QCOW_TEST_CREATOR_SLICES_IMAGE_SIZE );
+
+	for( cluster_block_index = 511;
+	     cluster_block_index < 513;
+	     cluster_block_index++ )
+	{
+		byte_stream_copy_to_uint64_big_endian(
+		 &( image_data[ level2_table_offset + ( cluster_block_index * 8 ) ] ),
+		 cluster_block_reference );
+
+		compression_flag = ( cluster_block_reference >> 62 ) & 0x01;
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "compression_flag",
+		 compression_flag,
+		 (uint64_t) 1 );
+	}
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_set_read_flags(
+	          file,
+	          LIBQCOW_READ_FLAG_NO_READ_AHEAD,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_file_open_file_io_handle(
+	          file,
+	          file_io_handle,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_reset_statistics(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test regular cases
+	 * Reading the last cluster block of the first slice should not read the second slice
+	 * to bound the compressed data
+	 */
+	offset = (off64_t) 511 * QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE;
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              data,
+	              QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE,
+	              offset,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          data,
+	          &( source_data[ offset ] ),
+	          QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_file_get_statistics(
+	          file,
+	          statistics,
+	          LIBQCOW_NUMBER_OF_STATISTICS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_MISSES ]",
+	 statistics[ LIBQCOW_STATISTIC_LEVEL2_TABLE_CACHE_MISSES ],
+	 (uint64_t) 1 );
+
+	/* Scan the image in reads that start and end within cluster blocks
+	 */
+	for( offset = 0;
+	     offset < (off64_t) QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE;
+	     offset += (off64_t) read_size )
+	{
+		read_size = ( 3 * QCOW_TEST_CREATOR_SLICES_CLUSTER_BLOCK_SIZE ) / 2;
+
+		if( read_size > (size_t) ( QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE - offset ) )
+		{
+			read_size = (size_t) ( QCOW_TEST_CREATOR_SLICES_MEDIA_SIZE - offset );
+		}
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              data,
+		              read_size,
+		              offset,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) read_size );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          data,
+		          &( source_data[ offset ] ),
+		          read_size );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	/* Clean up
+	 */
+	result = libqcow_file_close(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_handle_free(
+	          &source_file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	memory_free(
+	 data );
+
+	memory_free(
+	 image_data );
+
+	memory_free(
+	 source_data );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( source_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &source_file_io_handle,
+		 NULL );
+	}
+	if( data != NULL )
+	{
+		memory_free(
+		 data );
+	}
+	if( image_data != NULL )
+	{
+		memory_free(
+		 image_data );
+	}
+	if( source_data != NULL )
+	{
+		memory_free(
+		 source_data );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_create_compressed_image_file_io_handle function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_create_compressed_image_file_io_handle(
+     void )
+{
+	return( qcow_test_create_compressed_image_file_io_handle_with_threads(
+	         0 ) );
+}
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+/* Tests the libqcow_create_compressed_image_file_io_handle function using a thread pool
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_create_compressed_image_file_io_handle_multi_threaded(
+     void )
+{
+	return( qcow_test_create_compressed_image_file_io_handle_with_threads(
+	         2 ) );
+}
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_creator_task_initialize",
+	 qcow_test_creator_task_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_creator_task_process",
+	 qcow_test_creator_task_process );
+
+	QCOW_TEST_RUN(
+	 "libqcow_creator_initialize",
+	 qcow_test_creator_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_creator_set_backing_filename",
+	 qcow_test_creator_set_backing_filename );
+
+	QCOW_TEST_RUN(
+	 "libqcow_create_compressed_image_file_io_handle",
+	 qcow_test_create_compressed_image_file_io_handle );
+
+#if defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT )
+
+	QCOW_TEST_RUN(
+	 "libqcow_create_compressed_image_file_io_handle multi-threaded",
+	 qcow_test_create_compressed_image_file_io_handle_multi_threaded );
+
+#endif /* defined( HAVE_LIBQCOW_MULTI_THREAD_SUPPORT ) */
+
+	QCOW_TEST_RUN(
+	 "libqcow_create_compressed_image_file_io_handle read level 2 table slices",
+	 qcow_test_create_compressed_image_read_level2_table_slices );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,346 @@
+/*
+ * Library deflate functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_deflate.h"
+#include "../libqcow/libqcow_deflate_fixed_huffman_tables.h"
+
+#if defined( __GNUC__ )
+
+/* Raw deflate compressed data of qcow_test_deflate_uncompressed_data, which consists of a single fixed Huffman block
+ */
+uint8_t qcow_test_deflate_compressed_data[ 50 ] = {
+	0x0b, 0xc9, 0x48, 0x55, 0x28, 0x2c, 0xcd, 0x4c, 0xce, 0x56, 0x48, 0x2a, 0xca, 0x2f, 0xcf, 0x53,
+	0x48, 0xcb, 0xaf, 0x50, 0xc8, 0x2a, 0xcd, 0x2d, 0x28, 0x56, 0xc8, 0x2f, 0x4b, 0x2d, 0x52, 0x28,
+	0x01, 0x4a, 0xe7, 0x24, 0x56, 0x55, 0x2a, 0xa4, 0xe4, 0xa7, 0xeb, 0x29, 0x84, 0x90, 0xa0, 0x98,
+	0x0b, 0x00 };
+
+uint8_t qcow_test_deflate_uncompressed_data[ 91 ] =
+	"The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.\n";
+
+/* Compares a Huffman table with a precomputed Huffman table
+ * Returns 1 if the tables are equal or 0 if not
+ */
+int qcow_test_deflate_huffman_table_compare(
+     const libqcow_deflate_huffman_table_t *table,
+     const libqcow_deflate_huffman_table_t *precomputed_table )
+{
+	if( table->maximum_number_of_bits != precomputed_table->maximum_number_of_bits )
+	{
+		return( 0 );
+	}
+	if( table->number_of_codes != precomputed_table->number_of_codes )
+	{
+		return( 0 );
+	}
+	if( memory_compare(
+	     table->codes_array,
+	     precomputed_table->codes_array,
+	     sizeof( table->codes_array ) ) != 0 )
+	{
+		return( 0 );
+	}
+	if( memory_compare(
+	     table->code_counts_array,
+	     precomputed_table->code_counts_array,
+	     sizeof( table->code_counts_array ) ) != 0 )
+	{
+		return( 0 );
+	}
+	if( memory_compare(
+	     table->lookup_table,
+	     precomputed_table->lookup_table,
+	     sizeof( table->lookup_table ) ) != 0 )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Tests the libqcow_deflate_initialize_fixed_huffman_tables function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_deflate_initialize_fixed_huffman_tables(
+     void )
+{
+	libqcow_deflate_huffman_table_t distances_table;
+	libqcow_deflate_huffman_table_t literals_table;
+
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_deflate_initialize_fixed_huffman_tables(
+	          &literals_table,
+	          &distances_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The precomputed tables must match the constructed tables
+	 */
+	result = qcow_test_deflate_huffman_table_compare(
+	          &literals_table,
+	          &libqcow_deflate_fixed_huffman_literals_table );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = qcow_test_deflate_huffman_table_compare(
+	          &distances_table,
+	          &libqcow_deflate_fixed_huffman_distances_table );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_deflate_initialize_fixed_huffman_tables(
+	          NULL,
+	          &distances_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_deflate_decompress function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_deflate_decompress(
+     void )
+{
+	uint8_t uncompressed_data[ 128 ];
+
+	libcerror_error_t *error      = NULL;
+	size_t uncompressed_data_size = 0;
+	int result                    = 0;
+
+	/* Test regular cases
+	 */
+	uncompressed_data_size = 128;
+
+	result = libqcow_deflate_decompress(
+	          qcow_test_deflate_compressed_data,
+	          50,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "uncompressed_data_size",
+	 uncompressed_data_size,
+	 (size_t) 90 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          uncompressed_data,
+	          qcow_test_deflate_uncompressed_data,
+	          90 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	uncompressed_data_size = 128;
+
+	result = libqcow_deflate_decompress(
+	          NULL,
+	          50,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_deflate_decompress(
+	          qcow_test_deflate_compressed_data,
+	          50,
+	          NULL,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_deflate_decompress(
+	          qcow_test_deflate_compressed_data,
+	          50,
+	          uncompressed_data,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with an uncompressed data buffer that is too small
+	 */
+	uncompressed_data_size = 32;
+
+	result = libqcow_deflate_decompress(
+	          qcow_test_deflate_compressed_data,
+	          50,
+	          uncompressed_data,
+	          &uncompressed_data_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_deflate_initialize_fixed_huffman_tables",
+	 qcow_test_deflate_initialize_fixed_huffman_tables );
+
+	QCOW_TEST_RUN(
+	 "libqcow_deflate_decompress",
+	 qcow_test_deflate_decompress );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,1150 @@
+/*
+ * Library digest_index type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_definitions.h"
+#include "../libqcow/libqcow_digest_index.h"
+
+#if defined( __GNUC__ )
+
+/* The data of a cluster block
+ */
+uint8_t qcow_test_digest_index_cluster_block_data[ 16 ] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+/* Tests the libqcow_digest_index_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_digest_index_initialize(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_digest_index_t *digest_index = NULL;
+	int result                           = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "digest_index",
+	 digest_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "digest_index->number_of_entries",
+	 digest_index->number_of_entries,
+	 (size_t) 5 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "digest_index->entry_size",
+	 digest_index->entry_size,
+	 (size_t) 48 );
+
+	result = libqcow_digest_index_free(
+	          &digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "digest_index",
+	 digest_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_digest_index_initialize(
+	          NULL,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          ( 4 * 65536 ) + 1,
+	          0,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          0,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_digest_index_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_digest_index_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_digest_index_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_digest_index_set_entry_values and libqcow_digest_index_get_stale_range functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_digest_index_set_entry_values(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_digest_index_t *digest_index = NULL;
+	size_t range_entry_index             = 0;
+	size_t range_number_of_entries       = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          4 * 65536,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_digest_index_get_stale_range(
+	          digest_index,
+	          0,
+	          &range_entry_index,
+	          &range_number_of_entries,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "range_entry_index",
+	 range_entry_index,
+	 (size_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "range_number_of_entries",
+	 range_number_of_entries,
+	 (size_t) 4 );
+
+	/* Test that only entries with changed level 2 table entry values become stale
+	 * when the entries were read from a digest index file
+	 */
+	digest_index->entry_flags[ 0 ] = LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED;
+	digest_index->entry_flags[ 1 ] = LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED;
+	digest_index->entry_flags[ 2 ] = LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED;
+	digest_index->entry_flags[ 3 ] = LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED;
+
+	result = libqcow_digest_index_set_entry_values(
+	          digest_index,
+	          1,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_set_entry_values(
+	          digest_index,
+	          2,
+	          0x8000000000050000ULL,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_get_stale_range(
+	          digest_index,
+	          0,
+	          &range_entry_index,
+	          &range_number_of_entries,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "range_entry_index",
+	 range_entry_index,
+	 (size_t) 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "range_number_of_entries",
+	 range_number_of_entries,
+	 (size_t) 1 );
+
+	result = libqcow_digest_index_get_stale_range(
+	          digest_index,
+	          3,
+	          &range_entry_index,
+	          &range_number_of_entries,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_digest_index_set_entry_values(
+	          NULL,
+	          0,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_set_entry_values(
+	          digest_index,
+	          4,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_get_stale_range(
+	          digest_index,
+	          0,
+	          NULL,
+	          &range_number_of_entries,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_digest_index_free(
+	          &digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_digest_index_set_digest_from_data and libqcow_digest_index_set_stale_entries_as_holes functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_digest_index_set_digest_from_data(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_digest_index_t *digest_index = NULL;
+	size_t range_entry_index             = 0;
+	size_t range_number_of_entries       = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          2 * 65536,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_digest_index_set_digest_from_data(
+	          digest_index,
+	          1,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The SHA-256 of the cluster block data starts with 0xbe 0x45
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "digest[ 0 ]",
+	 (int) digest_index->entries_data[ 48 + 16 ],
+	 0xbe );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "digest[ 1 ]",
+	 (int) digest_index->entries_data[ 48 + 17 ],
+	 0x45 );
+
+	result = libqcow_digest_index_set_stale_entries_as_holes(
+	          digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_get_stale_range(
+	          digest_index,
+	          0,
+	          &range_entry_index,
+	          &range_number_of_entries,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test that a different digest of a stored entry is counted as a mismatch
+	 */
+	digest_index->entry_flags[ 1 ] = LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED;
+
+	result = libqcow_digest_index_set_digest_from_data(
+	          digest_index,
+	          1,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "digest_index->number_of_mismatches",
+	 digest_index->number_of_mismatches,
+	 (uint64_t) 0 );
+
+	result = libqcow_digest_index_set_digest_from_data(
+	          digest_index,
+	          1,
+	          qcow_test_digest_index_cluster_block_data,
+	          15,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "digest_index->number_of_mismatches",
+	 digest_index->number_of_mismatches,
+	 (uint64_t) 1 );
+
+	/* Test the parallel read callback function
+	 */
+	result = libqcow_digest_index_read_parallel_callback(
+	          65536,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          (void *) digest_index );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "digest_index->number_of_mismatches",
+	 digest_index->number_of_mismatches,
+	 (uint64_t) 2 );
+
+	result = libqcow_digest_index_read_parallel_callback(
+	          100,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          (void *) digest_index );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_digest_index_set_digest_from_data(
+	          NULL,
+	          0,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_set_digest_from_data(
+	          digest_index,
+	          2,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_set_stale_entries_as_holes(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_digest_index_free(
+	          &digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_digest_index_write_file_io_handle, libqcow_digest_index_read_file_io_handle
+ * and libqcow_digest_index_find_digest_in_file_io_handle functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_digest_index_write_and_read_file_io_handle(
+     void )
+{
+	uint8_t digest_index_file_data[ 208 ];
+
+	libbfio_handle_t *file_io_handle     = NULL;
+	libcerror_error_t *error             = NULL;
+	libqcow_digest_index_t *digest_index = NULL;
+	libqcow_digest_index_t *read_index   = NULL;
+	off64_t offset                       = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_digest_index_initialize(
+	          &digest_index,
+	          3 * 65536,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_set_entry_values(
+	          digest_index,
+	          2,
+	          0x8000000000050000ULL,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_digest_index_set_digest_from_data(
+	          digest_index,
+	          2,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_digest_index_set_stale_entries_as_holes(
+	          digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_initialize(
+	          &read_index,
+	          3 * 65536,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          digest_index_file_data,
+	          208,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ_WRITE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_digest_index_write_file_io_handle(
+	          digest_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "read_index->entry_flags[ 2 ]",
+	 (int) read_index->entry_flags[ 2 ],
+	 (int) LIBQCOW_DIGEST_INDEX_ENTRY_FLAG_IS_STORED );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "read_index->entries_data[ 96 ]",
+	 (int) read_index->entries_data[ 96 ],
+	 (int) digest_index->entries_data[ 96 ] );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "read_index->entries_data[ 96 + 16 ]",
+	 (int) read_index->entries_data[ 96 + 16 ],
+	 0xbe );
+
+	result = libqcow_digest_index_find_digest_in_file_io_handle(
+	          file_io_handle,
+	          &( digest_index->entries_data[ 96 + 16 ] ),
+	          32,
+	          &offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 (int64_t) offset,
+	 (int64_t) ( 2 * 65536 ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_find_digest_in_file_io_handle(
+	          file_io_handle,
+	          qcow_test_digest_index_cluster_block_data,
+	          16,
+	          &offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test a digest index file of an image with another media size
+	 */
+	libqcow_digest_index_free(
+	 &read_index,
+	 NULL );
+
+	result = libqcow_digest_index_initialize(
+	          &read_index,
+	          4 * 65536,
+	          65536,
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_digest_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_digest_index_read_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_write_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_digest_index_find_digest_in_file_io_handle(
+	          file_io_handle,
+	          NULL,
+	          32,
+	          &offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test reading a digest index file with a corrupted entry
+	 */
+	digest_index_file_data[ 100 ] ^= 0xff;
+
+	result = libqcow_digest_index_read_file_io_handle(
+	          digest_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_digest_index_free(
+	          &read_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_digest_index_free(
+	          &digest_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( read_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &read_index,
+		 NULL );
+	}
+	if( digest_index != NULL )
+	{
+		libqcow_digest_index_free(
+		 &digest_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_digest_index_initialize",
+	 qcow_test_digest_index_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_digest_index_free",
+	 qcow_test_digest_index_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_digest_index_set_entry_values",
+	 qcow_test_digest_index_set_entry_values );
+
+	QCOW_TEST_RUN(
+	 "libqcow_digest_index_set_digest_from_data",
+	 qcow_test_digest_index_set_digest_from_data );
+
+	QCOW_TEST_RUN(
+	 "libqcow_digest_index_write_and_read_file_io_handle",
+	 qcow_test_digest_index_write_and_read_file_io_handle );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
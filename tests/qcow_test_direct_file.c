@@ -0,0 +1,594 @@
+/*
+ * Library direct_file type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_direct_file.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_direct_file_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_direct_file_initialize(
+     void )
+{
+	libbfio_handle_t *file_io_handle   = NULL;
+	libcerror_error_t *error           = NULL;
+	libqcow_direct_file_t *direct_file = NULL;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	result = libbfio_file_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_direct_file_initialize(
+	          &direct_file,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "direct_file",
+	 direct_file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The direct file takes over the file IO handle
+	 */
+	file_io_handle = NULL;
+
+	result = libqcow_direct_file_free(
+	          &direct_file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "direct_file",
+	 direct_file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_direct_file_initialize(
+	          NULL,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_direct_file_initialize(
+	          &direct_file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( direct_file != NULL )
+	{
+		libqcow_direct_file_free(
+		 &direct_file,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_direct_file_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_direct_file_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_direct_file_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT )
+
+/* Creates a file IO handle for a file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_direct_file_initialize_file_io_handle(
+     libbfio_handle_t **file_io_handle,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	if( libbfio_file_initialize(
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		return( -1 );
+	}
+	if( libbfio_file_set_name(
+	     *file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libbfio_handle_free(
+		 file_io_handle,
+		 NULL );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Tests reading a file through a direct file IO handle
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_direct_file_read_buffer_at_offset(
+     const char *filename )
+{
+	uint8_t expected_buffer[ 9000 ];
+	uint8_t buffer[ 8192 + 4096 ];
+
+	libbfio_handle_t *direct_file_io_handle = NULL;
+	libbfio_handle_t *file_io_handle        = NULL;
+	libbfio_handle_t *named_file_io_handle  = NULL;
+	libcerror_error_t *error                = NULL;
+	uint8_t *aligned_buffer                 = NULL;
+	size64_t expected_size                  = 0;
+	size64_t size                           = 0;
+	ssize_t expected_read_count             = 0;
+	ssize_t read_count                      = 0;
+	int result                              = 0;
+
+	/* Initialize test
+	 */
+	result = qcow_test_direct_file_initialize_file_io_handle(
+	          &file_io_handle,
+	          filename,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_get_size(
+	          file_io_handle,
+	          &expected_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = qcow_test_direct_file_initialize_file_io_handle(
+	          &named_file_io_handle,
+	          filename,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_direct_file_initialize_handle(
+	          &direct_file_io_handle,
+	          named_file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The direct file IO handle takes over the named file IO handle
+	 */
+	named_file_io_handle = NULL;
+
+	result = libbfio_handle_open(
+	          direct_file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libbfio_handle_get_size(
+	          direct_file_io_handle,
+	          &size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "size",
+	 (uint64_t) size,
+	 (uint64_t) expected_size );
+
+	/* Test an unaligned read that spans multiple blocks
+	 */
+	expected_read_count = libbfio_handle_read_buffer_at_offset(
+	                       file_io_handle,
+	                       expected_buffer,
+	                       9000,
+	                       1000,
+	                       &error );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              direct_file_io_handle,
+	              buffer,
+	              9000,
+	              1000,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 expected_read_count );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          (size_t) read_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test an aligned read into an aligned buffer
+	 */
+	aligned_buffer = (uint8_t *) ( ( (intptr_t) buffer + 4095 ) & ~( (intptr_t) 4095 ) );
+
+	expected_read_count = libbfio_handle_read_buffer_at_offset(
+	                       file_io_handle,
+	                       expected_buffer,
+	                       8192,
+	                       0,
+	                       &error );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              direct_file_io_handle,
+	              aligned_buffer,
+	              8192,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 expected_read_count );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          aligned_buffer,
+	          expected_buffer,
+	          (size_t) read_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test a read beyond the end of the file
+	 */
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              direct_file_io_handle,
+	              buffer,
+	              16,
+	              (off64_t) size,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          direct_file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &direct_file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( direct_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &direct_file_io_handle,
+		 NULL );
+	}
+	if( named_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &named_file_io_handle,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT ) */
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_direct_file_initialize",
+	 qcow_test_direct_file_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_direct_file_free",
+	 qcow_test_direct_file_free );
+
+#if defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT ) && !defined( HAVE_WIDE_SYSTEM_CHARACTER )
+
+	/* The test program itself is used as the file to read
+	 */
+	QCOW_TEST_RUN_WITH_ARGS(
+	 "libqcow_direct_file_read_buffer_at_offset",
+	 qcow_test_direct_file_read_buffer_at_offset,
+	 argv[ 0 ] );
+
+#endif /* defined( HAVE_LIBQCOW_DIRECT_FILE_SUPPORT ) && !defined( HAVE_WIDE_SYSTEM_CHARACTER ) */
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -19,8 +19,10 @@
  * along with this software.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <byte_stream.h>
 #include <common.h>
 #include <file_stream.h>
+#include <memory.h>
 #include <narrow_string.h>
 #include <system_string.h>
 #include <types.h>
@@ -37,6 +39,7 @@
 #include "qcow_test_libuna.h"
 #include "qcow_test_macros.h"
 #include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
 
 #if defined( HAVE_WIDE_SYSTEM_CHARACTER ) && SIZEOF_WCHAR_T != 2 && SIZEOF_WCHAR_T != 4
 #error Unsupported size of wchar_t
@@ -46,6 +49,27 @@
 #define QCOW_TEST_FILE_VERBOSE
  */
 
+#define QCOW_TEST_FILE_WRITE_FILENAME				"qcow_test_file_write.qcow2"
+
+#define QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE			512
+#define QCOW_TEST_FILE_WRITE_IMAGE_SIZE				4096
+#define QCOW_TEST_FILE_WRITE_MEDIA_SIZE				65536
+
+#define QCOW_TEST_FILE_WRITE_LEVEL1_TABLE_OFFSET		512
+#define QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_TABLE_OFFSET	1024
+#define QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET		1536
+#define QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_BLOCK_OFFSET	2048
+#define QCOW_TEST_FILE_WRITE_DATA_OFFSET			2560
+#define QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET		3472
+
+#define QCOW_TEST_FILE_WRITE_FLAG_COPIED			( (uint64_t) 1 << 63 )
+#define QCOW_TEST_FILE_WRITE_FLAG_COMPRESSED			( (uint64_t) 1 << 62 )
+
+/* The deflate compressed data of a cluster block of 512 x 'Z'
+ */
+uint8_t qcow_test_file_write_compressed_data[ 8 ] = {
+	0x8b, 0x8a, 0x1a, 0x05, 0x23, 0x19, 0x00, 0x00 };
+
 /* Retrieves source as a narrow string
  * Returns 1 if successful or -1 on error
  */
@@ -811,24 +835,22 @@ on_error:
 	return( 0 );
 }
 
-/* Tests the libqcow_file_open function
+/* Tests the libqcow_file_set_cache_limits and libqcow_file_get_cache_limits functions
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_open(
-     const system_character_t *source )
+int qcow_test_file_set_cache_limits(
+     void )
 {
-	char narrow_source[ 256 ];
-
-	libcerror_error_t *error = NULL;
-	libqcow_file_t *file     = NULL;
-	int result               = 0;
+	libcerror_error_t *error             = NULL;
+	libqcow_file_t *file                 = NULL;
+	int maximum_number_of_cluster_blocks = 0;
+	int maximum_number_of_level2_tables  = 0;
+	int result                           = 0;
 
 	/* Initialize test
 	 */
-	result = qcow_test_file_get_narrow_source(
-	          source,
-	          narrow_source,
-	          256,
+	result = libqcow_file_initialize(
+	          &file,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -836,12 +858,20 @@ int qcow_test_file_open(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
 
-	result = libqcow_file_initialize(
-	          &file,
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_set_cache_limits(
+	          file,
+	          8,
+	          16,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -849,20 +879,14 @@ int qcow_test_file_open(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "file",
-         file );
-
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* Test open
-	 */
-	result = libqcow_file_open(
+	result = libqcow_file_get_cache_limits(
 	          file,
-	          narrow_source,
-	          LIBQCOW_OPEN_READ,
+	          &maximum_number_of_level2_tables,
+	          &maximum_number_of_cluster_blocks,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -870,16 +894,44 @@ int qcow_test_file_open(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "maximum_number_of_level2_tables",
+	 maximum_number_of_level2_tables,
+	 8 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "maximum_number_of_cluster_blocks",
+	 maximum_number_of_cluster_blocks,
+	 16 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	/* Test error cases
 	 */
-	result = libqcow_file_open(
+	result = libqcow_file_set_cache_limits(
+	          NULL,
+	          8,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_set_cache_limits(
 	          file,
-	          narrow_source,
-	          LIBQCOW_OPEN_READ,
+	          0,
+	          16,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -887,9 +939,81 @@ int qcow_test_file_open(
 	 result,
 	 -1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_set_cache_limits(
+	          file,
+	          8,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_cache_limits(
+	          NULL,
+	          &maximum_number_of_level2_tables,
+	          &maximum_number_of_cluster_blocks,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_cache_limits(
+	          file,
+	          NULL,
+	          &maximum_number_of_cluster_blocks,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_cache_limits(
+	          file,
+	          &maximum_number_of_level2_tables,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
 
 	libcerror_error_free(
 	 &error );
@@ -905,13 +1029,13 @@ int qcow_test_file_open(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "file",
-         file );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	return( 1 );
 
@@ -930,26 +1054,22 @@ on_error:
 	return( 0 );
 }
 
-#if defined( HAVE_WIDE_CHARACTER_TYPE )
-
-/* Tests the libqcow_file_open_wide function
+/* Tests the libqcow_file_set_cache function
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_open_wide(
-     const system_character_t *source )
+int qcow_test_file_set_cache(
+     void )
 {
-	wchar_t wide_source[ 256 ];
-
 	libcerror_error_t *error = NULL;
+	libqcow_cache_t *cache   = NULL;
 	libqcow_file_t *file     = NULL;
 	int result               = 0;
 
 	/* Initialize test
 	 */
-	result = qcow_test_file_get_wide_source(
-	          source,
-	          wide_source,
-	          256,
+	result = libqcow_cache_initialize(
+	          &cache,
+	          1024 * 1024,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -957,9 +1077,13 @@ int qcow_test_file_open_wide(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	result = libqcow_file_initialize(
 	          &file,
@@ -970,20 +1094,19 @@ int qcow_test_file_open_wide(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "file",
-         file );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* Test open
+	/* Test regular cases
 	 */
-	result = libqcow_file_open_wide(
+	result = libqcow_file_set_cache(
 	          file,
-	          wide_source,
-	          LIBQCOW_OPEN_READ,
+	          cache,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -991,16 +1114,15 @@ int qcow_test_file_open_wide(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	/* Test error cases
 	 */
-	result = libqcow_file_open_wide(
-	          file,
-	          wide_source,
-	          LIBQCOW_OPEN_READ,
+	result = libqcow_file_set_cache(
+	          NULL,
+	          cache,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1008,9 +1130,27 @@ int qcow_test_file_open_wide(
 	 result,
 	 -1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* A cache that is set on a file cannot be freed
+	 */
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
 
 	libcerror_error_free(
 	 &error );
@@ -1026,13 +1166,30 @@ int qcow_test_file_open_wide(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "file",
-         file );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cache_free(
+	          &cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "cache",
+	 cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	return( 1 );
 
@@ -1048,63 +1205,64 @@ on_error:
 		 &file,
 		 NULL );
 	}
+	if( cache != NULL )
+	{
+		libqcow_cache_free(
+		 &cache,
+		 NULL );
+	}
 	return( 0 );
 }
 
-#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
-
-/* Tests the libqcow_file_close function
+/* Tests the libqcow_file_set_read_flags and libqcow_file_get_read_flags functions
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_close(
+int qcow_test_file_set_read_flags(
      void )
 {
 	libcerror_error_t *error = NULL;
+	libqcow_file_t *file     = NULL;
+	int read_flags           = 0;
 	int result               = 0;
 
-	/* Test error cases
+	/* Initialize test
 	 */
-	result = libqcow_file_close(
-	          NULL,
+	result = libqcow_file_initialize(
+	          &file,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
+	 1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
 
-	libcerror_error_free(
-	 &error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	return( 1 );
+	/* Test regular cases
+	 */
+	result = libqcow_file_set_read_flags(
+	          file,
+	          LIBQCOW_READ_FLAG_NO_CACHE,
+	          &error );
 
-on_error:
-	if( error != NULL )
-	{
-		libcerror_error_free(
-		 &error );
-	}
-	return( 0 );
-}
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-/* Tests the libqcow_file_open and libqcow_file_close functions
- * Returns 1 if successful or 0 if not
- */
-int qcow_test_file_open_close(
-     const system_character_t *source )
-{
-	libcerror_error_t *error = NULL;
-	libqcow_file_t *file     = NULL;
-	int result               = 0;
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* Initialize test
-	 */
-	result = libqcow_file_initialize(
-	          &file,
+	result = libqcow_file_get_read_flags(
+	          file,
+	          &read_flags,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1112,89 +1270,117 @@ int qcow_test_file_open_close(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "file",
-         file );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "read_flags",
+	 read_flags,
+	 LIBQCOW_READ_FLAG_NO_CACHE );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* Test open and close
-	 */
-#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
-	result = libqcow_file_open_wide(
+	result = libqcow_file_set_read_flags(
 	          file,
-	          source,
-	          LIBQCOW_OPEN_READ,
-	          &error );
-#else
-	result = libqcow_file_open(
-	          file,
-	          source,
-	          LIBQCOW_OPEN_READ,
+	          LIBQCOW_READ_FLAG_USE_CHAIN_INDEX,
 	          &error );
-#endif
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	result = libqcow_file_close(
+	result = libqcow_file_get_read_flags(
 	          file,
+	          &read_flags,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 0 );
+	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "read_flags",
+	 read_flags,
+	 LIBQCOW_READ_FLAG_USE_CHAIN_INDEX );
 
-	/* Test open and close a second time to validate clean up on close
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
 	 */
-#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
-	result = libqcow_file_open_wide(
-	          file,
-	          source,
-	          LIBQCOW_OPEN_READ,
+	result = libqcow_file_set_read_flags(
+	          NULL,
+	          LIBQCOW_READ_FLAG_NO_CACHE,
 	          &error );
-#else
-	result = libqcow_file_open(
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_set_read_flags(
 	          file,
-	          source,
-	          LIBQCOW_OPEN_READ,
+	          0x8000,
 	          &error );
-#endif
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 1 );
+	 -1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
 
-	result = libqcow_file_close(
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_read_flags(
+	          NULL,
+	          &read_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_read_flags(
 	          file,
+	          NULL,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 0 );
+	 -1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
 
 	/* Clean up
 	 */
@@ -1207,13 +1393,13 @@ int qcow_test_file_open_close(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "file",
-         file );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	return( 1 );
 
@@ -1232,19 +1418,41 @@ on_error:
 	return( 0 );
 }
 
-/* Tests the libqcow_file_signal_abort function
+/* Tests the libqcow_file_set_number_of_worker_threads and libqcow_file_get_number_of_worker_threads functions
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_signal_abort(
-     libqcow_file_t *file )
+int qcow_test_file_set_number_of_worker_threads(
+     void )
 {
 	libcerror_error_t *error = NULL;
+	libqcow_file_t *file     = NULL;
+	int number_of_threads    = 0;
 	int result               = 0;
 
+	/* Initialize test
+	 */
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
 	/* Test regular cases
 	 */
-	result = libqcow_file_signal_abort(
+	result = libqcow_file_set_number_of_worker_threads(
 	          file,
+	          0,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1252,14 +1460,34 @@ int qcow_test_file_signal_abort(
 	 result,
 	 1 );
 
-        QCOW_TEST_ASSERT_IS_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_get_number_of_worker_threads(
+	          file,
+	          &number_of_threads,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_threads",
+	 number_of_threads,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
 	/* Test error cases
 	 */
-	result = libqcow_file_signal_abort(
+	result = libqcow_file_set_number_of_worker_threads(
 	          NULL,
+	          0,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1267,124 +1495,56 @@ int qcow_test_file_signal_abort(
 	 result,
 	 -1 );
 
-        QCOW_TEST_ASSERT_IS_NOT_NULL(
-         "error",
-         error );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
 
 	libcerror_error_free(
 	 &error );
 
-	return( 1 );
+	result = libqcow_file_set_number_of_worker_threads(
+	          file,
+	          -1,
+	          &error );
 
-on_error:
-	if( error != NULL )
-	{
-		libcerror_error_free(
-		 &error );
-	}
-	return( 0 );
-}
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
-/* Tests the libqcow_file_read_buffer function
- * Returns 1 if successful or 0 if not
- */
-int qcow_test_file_read_buffer(
-     libqcow_file_t *file )
-{
-	uint8_t buffer[ 16 ];
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
 
-	libcerror_error_t *error = NULL;
-	size64_t size            = 0;
-	ssize_t read_count       = 0;
-	off64_t offset           = 0;
+	libcerror_error_free(
+	 &error );
 
-	/* Determine size
-	 */
-	offset = libqcow_file_seek_offset(
+	result = libqcow_file_set_number_of_worker_threads(
 	          file,
-	          0,
-	          SEEK_END,
+	          1024,
 	          &error );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
-
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
-
-	size = (size64_t) offset;
-
-	/* Reset offset to 0
-	 */
-	offset = libqcow_file_seek_offset(
-	          file,
-	          0,
-	          SEEK_SET,
-	          &error );
-
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) 0 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
-	QCOW_TEST_ASSERT_IS_NULL(
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
 	 error );
 
-	/* Test regular cases
-	 */
-	if( size > 16 )
-	{
-		read_count = libqcow_file_read_buffer(
-		              file,
-		              buffer,
-		              16,
-		              &error );
-
-		QCOW_TEST_ASSERT_EQUAL_SSIZE(
-		 "read_count",
-		 read_count,
-		 (ssize_t) 16 );
-
-		QCOW_TEST_ASSERT_IS_NULL(
-		 "error",
-		 error );
-	}
-/* TODO read on size boundary */
-/* TODO read beyond size boundary */
+	libcerror_error_free(
+	 &error );
 
-	/* Reset offset to 0
-	 */
-	offset = libqcow_file_seek_offset(
-	          file,
-	          0,
-	          SEEK_SET,
+	result = libqcow_file_get_number_of_worker_threads(
+	          NULL,
+	          &number_of_threads,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) 0 );
-
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
-
-	/* Test error cases
-	 */
-	read_count = libqcow_file_read_buffer(
-	              NULL,
-	              buffer,
-	              16,
-	              &error );
-
-	QCOW_TEST_ASSERT_EQUAL_SSIZE(
-	 "read_count",
-	 read_count,
-	 (ssize_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
@@ -1393,16 +1553,15 @@ int qcow_test_file_read_buffer(
 	libcerror_error_free(
 	 &error );
 
-	read_count = libqcow_file_read_buffer(
-	              file,
-	              NULL,
-	              16,
-	              &error );
+	result = libqcow_file_get_number_of_worker_threads(
+	          file,
+	          NULL,
+	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_SSIZE(
-	 "read_count",
-	 read_count,
-	 (ssize_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
@@ -1411,24 +1570,25 @@ int qcow_test_file_read_buffer(
 	libcerror_error_free(
 	 &error );
 
-	read_count = libqcow_file_read_buffer(
-	              file,
-	              buffer,
-	              (size_t) SSIZE_MAX + 1,
-	              &error );
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_SSIZE(
-	 "read_count",
-	 read_count,
-	 (ssize_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
 	 error );
 
-	libcerror_error_free(
-	 &error );
-
 	return( 1 );
 
 on_error:
@@ -1437,95 +1597,75 @@ on_error:
 		libcerror_error_free(
 		 &error );
 	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
 	return( 0 );
 }
 
-/* Tests the libqcow_file_seek_offset function
+/* Tests the libqcow_file_set_io_queue_depth and libqcow_file_get_io_queue_depth functions
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_seek_offset(
-     libqcow_file_t *file )
+int qcow_test_file_set_io_queue_depth(
+     void )
 {
 	libcerror_error_t *error = NULL;
-	size64_t size            = 0;
-	off64_t offset           = 0;
+	libqcow_file_t *file     = NULL;
+	int queue_depth          = 0;
+	int result               = 0;
 
-	/* Test regular cases
+	/* Initialize test
 	 */
-	offset = libqcow_file_seek_offset(
-	          file,
-	          0,
-	          SEEK_END,
+	result = libqcow_file_initialize(
+	          &file,
 	          &error );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
-
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
-
-	size = (size64_t) offset;
-
-	offset = libqcow_file_seek_offset(
-	          file,
-	          1024,
-	          SEEK_SET,
-	          &error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) 1024 );
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
 
 	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
 	 error );
 
-	offset = libqcow_file_seek_offset(
+	/* Test regular cases
+	 */
+	result = libqcow_file_set_io_queue_depth(
 	          file,
-	          -512,
-	          SEEK_CUR,
+	          32,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) 512 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
 	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
 	 error );
 
-	offset = libqcow_file_seek_offset(
+	result = libqcow_file_get_io_queue_depth(
 	          file,
-	          (off64_t) ( size + 512 ),
-	          SEEK_SET,
+	          &queue_depth,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) ( size + 512 ) );
-
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
-
-	/* Reset offset to 0
-	 */
-	offset = libqcow_file_seek_offset(
-	          file,
-	          0,
-	          SEEK_SET,
-	          &error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) 0 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "queue_depth",
+	 queue_depth,
+	 32 );
 
 	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
@@ -1533,16 +1673,15 @@ int qcow_test_file_seek_offset(
 
 	/* Test error cases
 	 */
-	offset = libqcow_file_seek_offset(
+	result = libqcow_file_set_io_queue_depth(
 	          NULL,
 	          0,
-	          SEEK_SET,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
@@ -1551,16 +1690,15 @@ int qcow_test_file_seek_offset(
 	libcerror_error_free(
 	 &error );
 
-	offset = libqcow_file_seek_offset(
+	result = libqcow_file_set_io_queue_depth(
 	          file,
 	          -1,
-	          SEEK_SET,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
@@ -1569,31 +1707,49 @@ int qcow_test_file_seek_offset(
 	libcerror_error_free(
 	 &error );
 
-	offset = libqcow_file_seek_offset(
+	result = libqcow_file_set_io_queue_depth(
 	          file,
-	          -1,
-	          SEEK_CUR,
+	          1025,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
 	 error );
 
-	offset = libqcow_file_seek_offset(
-	          file,
-	          (off64_t) ( -1 * ( size + 1 ) ),
-	          SEEK_END,
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_io_queue_depth(
+	          NULL,
+	          &queue_depth,
 	          &error );
 
-	QCOW_TEST_ASSERT_EQUAL_INT64(
-	 "offset",
-	 offset,
-	 (int64_t) -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_io_queue_depth(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
 
 	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
@@ -1602,6 +1758,25 @@ int qcow_test_file_seek_offset(
 	libcerror_error_free(
 	 &error );
 
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
 	return( 1 );
 
 on_error:
@@ -1610,43 +1785,84 @@ on_error:
 		libcerror_error_free(
 		 &error );
 	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
 	return( 0 );
 }
 
-/* Tests the libqcow_file_get_offset function
+/* Tests the libqcow_file_open function
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_get_offset(
-     libqcow_file_t *file )
+int qcow_test_file_open(
+     const system_character_t *source )
 {
+	char narrow_source[ 256 ];
+
 	libcerror_error_t *error = NULL;
-	off64_t offset           = 0;
-	int offset_is_set        = 0;
+	libqcow_file_t *file     = NULL;
 	int result               = 0;
 
-	/* Test regular cases
+	/* Initialize test
 	 */
-	result = libqcow_file_get_offset(
-	          file,
-	          &offset,
+	result = qcow_test_file_get_narrow_source(
+	          source,
+	          narrow_source,
+	          256,
 	          &error );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
+	 1 );
 
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
 
-	offset_is_set = result;
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test open
+	 */
+	result = libqcow_file_open(
+	          file,
+	          narrow_source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
 
 	/* Test error cases
 	 */
-	result = libqcow_file_get_offset(
-	          NULL,
-	          &offset,
+	result = libqcow_file_open(
+	          file,
+	          narrow_source,
+	          LIBQCOW_OPEN_READ,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1654,32 +1870,32 @@ int qcow_test_file_get_offset(
 	 result,
 	 -1 );
 
-	QCOW_TEST_ASSERT_IS_NOT_NULL(
-	 "error",
-	 error );
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
 
 	libcerror_error_free(
 	 &error );
 
-	if( offset_is_set != 0 )
-	{
-		result = libqcow_file_get_offset(
-		          file,
-		          NULL,
-		          &error );
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
 
-		QCOW_TEST_ASSERT_EQUAL_INT(
-		 "result",
-		 result,
-		 -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-		QCOW_TEST_ASSERT_IS_NOT_NULL(
-		 "error",
-		 error );
+        QCOW_TEST_ASSERT_IS_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
 
-		libcerror_error_free(
-		 &error );
-	}
 	return( 1 );
 
 on_error:
@@ -1688,121 +1904,5511 @@ on_error:
 		libcerror_error_free(
 		 &error );
 	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
 	return( 0 );
 }
 
-/* Tests the libqcow_file_get_media_size function
+#if defined( HAVE_WIDE_CHARACTER_TYPE )
+
+/* Tests the libqcow_file_open_wide function
  * Returns 1 if successful or 0 if not
  */
-int qcow_test_file_get_media_size(
-     libqcow_file_t *file )
+int qcow_test_file_open_wide(
+     const system_character_t *source )
 {
+	wchar_t wide_source[ 256 ];
+
 	libcerror_error_t *error = NULL;
-	size64_t media_size      = 0;
-	int media_size_is_set    = 0;
+	libqcow_file_t *file     = NULL;
 	int result               = 0;
 
-	/* Test regular cases
+	/* Initialize test
 	 */
-	result = libqcow_file_get_media_size(
+	result = qcow_test_file_get_wide_source(
+	          source,
+	          wide_source,
+	          256,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test open
+	 */
+	result = libqcow_file_open_wide(
 	          file,
-	          &media_size,
+	          wide_source,
+	          LIBQCOW_OPEN_READ,
 	          &error );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_open_wide(
+	          file,
+	          wide_source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
 	 -1 );
 
-	QCOW_TEST_ASSERT_IS_NULL(
-	 "error",
-	 error );
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
 
-	media_size_is_set = result;
+	libcerror_error_free(
+	 &error );
 
-	/* Test error cases
+	/* Clean up
 	 */
-	result = libqcow_file_get_media_size(
-	          NULL,
-	          &media_size,
+	result = libqcow_file_free(
+	          &file,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
-
-	QCOW_TEST_ASSERT_IS_NOT_NULL(
-	 "error",
-	 error );
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( HAVE_WIDE_CHARACTER_TYPE ) */
+
+/* Tests the libqcow_file_close function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_close(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_close(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_open and libqcow_file_close functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_open_close(
+     const system_character_t *source )
+{
+	libcerror_error_t *error = NULL;
+	libqcow_file_t *file     = NULL;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test open and close
+	 */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+#else
+	result = libqcow_file_open(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+#endif
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_file_close(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test open and close a second time to validate clean up on close
+	 */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+#else
+	result = libqcow_file_open(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_READ,
+	          &error );
+#endif
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_file_close(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests opening a file metadata only
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_open_metadata_only(
+     const system_character_t *source,
+     libqcow_file_t *reference_file )
+{
+	uint8_t buffer[ 16 ];
+	uint8_t reference_buffer[ 16 ];
+
+	libcerror_error_t *error = NULL;
+	libqcow_file_t *file     = NULL;
+	size64_t media_size      = 0;
+	size64_t reference_size  = 0;
+	ssize_t read_count       = 0;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test open metadata only
+	 */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+	result = libqcow_file_open_wide(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_METADATA_ONLY,
+	          &error );
+#else
+	result = libqcow_file_open(
+	          file,
+	          source,
+	          LIBQCOW_OPEN_METADATA_ONLY,
+	          &error );
+#endif
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_file_get_media_size(
+	          file,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	result = libqcow_file_get_media_size(
+	          reference_file,
+	          &reference_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "media_size",
+	 (uint64_t) media_size,
+	 (uint64_t) reference_size );
+
+	/* Test that the first read of the media data creates the data path
+	 */
+	if( media_size > 16 )
+	{
+		read_count = libqcow_file_read_buffer_at_offset(
+		              reference_file,
+		              reference_buffer,
+		              16,
+		              0,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              buffer,
+		              16,
+		              0,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          buffer,
+		          reference_buffer,
+		          16 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	result = libqcow_file_close(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "file",
+         file );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_signal_abort function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_signal_abort(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_signal_abort(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+        QCOW_TEST_ASSERT_IS_NULL(
+         "error",
+         error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_signal_abort(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+        QCOW_TEST_ASSERT_IS_NOT_NULL(
+         "error",
+         error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_read_buffer function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_buffer(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 16 ];
+
+	libcerror_error_t *error = NULL;
+	size64_t size            = 0;
+	ssize_t read_count       = 0;
+	off64_t offset           = 0;
+
+	/* Determine size
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_END,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	size = (size64_t) offset;
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	if( size > 16 )
+	{
+		read_count = libqcow_file_read_buffer(
+		              file,
+		              buffer,
+		              16,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+/* TODO read on size boundary */
+/* TODO read beyond size boundary */
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	read_count = libqcow_file_read_buffer(
+	              NULL,
+	              buffer,
+	              16,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer(
+	              file,
+	              NULL,
+	              16,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer(
+	              file,
+	              buffer,
+	              (size_t) SSIZE_MAX + 1,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_read_buffer_at_offset function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_buffer_at_offset(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 16 ];
+	uint8_t reference_buffer[ 16 ];
+
+	libcerror_error_t *error = NULL;
+	size64_t size            = 0;
+	ssize_t read_count       = 0;
+	off64_t offset           = 0;
+	int result               = 0;
+
+	/* Determine size
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_END,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	size = (size64_t) offset;
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	if( size > 16 )
+	{
+		read_count = libqcow_file_read_buffer(
+		              file,
+		              reference_buffer,
+		              16,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              buffer,
+		              16,
+		              0,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          buffer,
+		          reference_buffer,
+		          16 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		/* The current offset should not be changed by a positional read
+		 */
+		result = libqcow_file_get_offset(
+		          file,
+		          &offset,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT64(
+		 "offset",
+		 offset,
+		 (int64_t) 16 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              16,
+	              (off64_t) size,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	read_count = libqcow_file_read_buffer_at_offset(
+	              NULL,
+	              buffer,
+	              16,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              NULL,
+	              16,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              (size_t) SSIZE_MAX + 1,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              16,
+	              -1,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_read_buffer_at_offset_with_zero_bitmap function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_buffer_at_offset_with_zero_bitmap(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 4096 ];
+	uint8_t reference_buffer[ 4096 ];
+	uint8_t zero_bitmap[ 2 ];
+
+	libcerror_error_t *error = NULL;
+	size_t buffer_offset     = 0;
+	size_t sector_index      = 0;
+	size_t sector_size       = 0;
+	ssize_t read_count       = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              reference_buffer,
+	              4096,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_GREATER_THAN_INT(
+	 "read_count",
+	 (int) read_count,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = (int) read_count;
+
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              file,
+	              buffer,
+	              4096,
+	              0,
+	              zero_bitmap,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) result );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          buffer,
+	          reference_buffer,
+	          (size_t) read_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* A sector that is marked in the zero bitmap must contain zeros
+	 */
+	for( sector_index = 0;
+	     sector_index < 8;
+	     sector_index++ )
+	{
+		if( ( zero_bitmap[ sector_index / 8 ] & ( 1 << ( sector_index % 8 ) ) ) == 0 )
+		{
+			continue;
+		}
+		sector_size = (size_t) read_count - ( sector_index * LIBQCOW_ZERO_BITMAP_SECTOR_SIZE );
+
+		if( sector_size > LIBQCOW_ZERO_BITMAP_SECTOR_SIZE )
+		{
+			sector_size = LIBQCOW_ZERO_BITMAP_SECTOR_SIZE;
+		}
+		for( buffer_offset = 0;
+		     buffer_offset < sector_size;
+		     buffer_offset++ )
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "buffer[ buffer_offset ]",
+			 (int) buffer[ ( sector_index * LIBQCOW_ZERO_BITMAP_SECTOR_SIZE ) + buffer_offset ],
+			 0 );
+		}
+	}
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              file,
+	              buffer,
+	              4096,
+	              0,
+	              NULL,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_GREATER_THAN_INT(
+	 "read_count",
+	 (int) read_count,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              NULL,
+	              buffer,
+	              4096,
+	              0,
+	              zero_bitmap,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              file,
+	              NULL,
+	              4096,
+	              0,
+	              zero_bitmap,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              file,
+	              buffer,
+	              4096,
+	              0,
+	              zero_bitmap,
+	              1,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_buffer_at_offset_with_zero_bitmap(
+	              file,
+	              buffer,
+	              4096,
+	              -1,
+	              zero_bitmap,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_read_vector function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_vector(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 32 ];
+	uint8_t reference_buffer[ 32 ];
+
+	void *buffers[ 2 ];
+	size_t buffer_sizes[ 2 ];
+	off64_t offsets[ 2 ];
+
+	libcerror_error_t *error = NULL;
+	size64_t size            = 0;
+	ssize_t read_count       = 0;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_get_media_size(
+	          file,
+	          &size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Buffers are specified in reverse order of offset
+	 */
+	buffers[ 0 ]      = &( buffer[ 16 ] );
+	buffer_sizes[ 0 ] = 16;
+	offsets[ 0 ]      = 16;
+	buffers[ 1 ]      = buffer;
+	buffer_sizes[ 1 ] = 16;
+	offsets[ 1 ]      = 0;
+
+	/* Test regular cases
+	 */
+	if( size > 32 )
+	{
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              reference_buffer,
+		              32,
+		              0,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 32 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		read_count = libqcow_file_read_vector(
+		              file,
+		              buffers,
+		              buffer_sizes,
+		              offsets,
+		              2,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 32 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          buffer,
+		          reference_buffer,
+		          32 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	/* Test error cases
+	 */
+	read_count = libqcow_file_read_vector(
+	              NULL,
+	              buffers,
+	              buffer_sizes,
+	              offsets,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_vector(
+	              file,
+	              NULL,
+	              buffer_sizes,
+	              offsets,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_vector(
+	              file,
+	              buffers,
+	              NULL,
+	              offsets,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_vector(
+	              file,
+	              buffers,
+	              buffer_sizes,
+	              NULL,
+	              2,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	read_count = libqcow_file_read_vector(
+	              file,
+	              buffers,
+	              buffer_sizes,
+	              offsets,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	offsets[ 1 ] = -1;
+
+	read_count = libqcow_file_read_vector(
+	              file,
+	              buffers,
+	              buffer_sizes,
+	              offsets,
+	              2,
+	              &error );
+
+	offsets[ 1 ] = 0;
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* The read request callback values
+ */
+typedef struct qcow_test_file_read_async_values qcow_test_file_read_async_values_t;
+
+struct qcow_test_file_read_async_values
+{
+	/* The status
+	 */
+	int status;
+
+	/* The number of bytes read
+	 */
+	ssize_t read_count;
+};
+
+/* The read request callback function used by qcow_test_file_read_async
+ */
+void qcow_test_file_read_async_callback(
+     libqcow_read_request_t *request QCOW_TEST_ATTRIBUTE_UNUSED,
+     int status,
+     ssize_t read_count,
+     void *user_data )
+{
+	qcow_test_file_read_async_values_t *values = NULL;
+
+	QCOW_TEST_UNREFERENCED_PARAMETER( request )
+
+	values = (qcow_test_file_read_async_values_t *) user_data;
+
+	if( values != NULL )
+	{
+		values->status     = status;
+		values->read_count = read_count;
+	}
+}
+
+/* Tests the libqcow_file_read_async function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_async(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 32 ];
+	uint8_t reference_buffer[ 32 ];
+
+	qcow_test_file_read_async_values_t values;
+
+	libcerror_error_t *error        = NULL;
+	libqcow_read_request_t *request = NULL;
+	size64_t size                   = 0;
+	ssize_t read_count              = 0;
+	int result                      = 0;
+	int status                      = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_get_media_size(
+	          file,
+	          &size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	values.status     = -1;
+	values.read_count = 0;
+
+	/* Test regular cases
+	 */
+	if( size > 32 )
+	{
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              reference_buffer,
+		              32,
+		              0,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 32 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_file_read_async(
+		          file,
+		          buffer,
+		          32,
+		          0,
+		          &qcow_test_file_read_async_callback,
+		          (void *) &values,
+		          &request,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "request",
+		 request );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_read_request_wait(
+		          request,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_read_request_get_status(
+		          request,
+		          &status,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "status",
+		 status,
+		 LIBQCOW_READ_REQUEST_STATUS_COMPLETED );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "values.status",
+		 values.status,
+		 LIBQCOW_READ_REQUEST_STATUS_COMPLETED );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "values.read_count",
+		 values.read_count,
+		 (ssize_t) 32 );
+
+		result = memory_compare(
+		          buffer,
+		          reference_buffer,
+		          32 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		result = libqcow_read_request_free(
+		          &request,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "request",
+		 request );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_file_read_async(
+	          NULL,
+	          buffer,
+	          32,
+	          0,
+	          &qcow_test_file_read_async_callback,
+	          (void *) &values,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_async(
+	          file,
+	          NULL,
+	          32,
+	          0,
+	          &qcow_test_file_read_async_callback,
+	          (void *) &values,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_async(
+	          file,
+	          buffer,
+	          32,
+	          -1,
+	          &qcow_test_file_read_async_callback,
+	          (void *) &values,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_async(
+	          file,
+	          buffer,
+	          32,
+	          0,
+	          &qcow_test_file_read_async_callback,
+	          (void *) &values,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( request != NULL )
+	{
+		libqcow_read_request_free(
+		 &request,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_extent_at_offset function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_extent_at_offset(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error   = NULL;
+	size64_t extent_size       = 0;
+	size64_t size              = 0;
+	off64_t extent_file_offset = 0;
+	off64_t extent_offset      = 0;
+	off64_t offset             = 0;
+	uint32_t extent_flags      = 0;
+	int result                 = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_get_media_size(
+	          file,
+	          &size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	while( (size64_t) offset < size )
+	{
+		result = libqcow_file_get_extent_at_offset(
+		          file,
+		          offset,
+		          &extent_offset,
+		          &extent_size,
+		          &extent_file_offset,
+		          &extent_flags,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT64(
+		 "extent_offset",
+		 (int64_t) extent_offset,
+		 (int64_t) offset );
+
+		QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+		 "extent_size",
+		 (int64_t) extent_size,
+		 (int64_t) 0 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		offset = extent_offset + (off64_t) extent_size;
+	}
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "offset",
+	 (uint64_t) offset,
+	 (uint64_t) size );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          (off64_t) size,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_extent_at_offset(
+	          NULL,
+	          0,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          -1,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          0,
+	          NULL,
+	          &extent_size,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          0,
+	          &extent_offset,
+	          NULL,
+	          &extent_file_offset,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          0,
+	          &extent_offset,
+	          &extent_size,
+	          NULL,
+	          &extent_flags,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_extent_at_offset(
+	          file,
+	          0,
+	          &extent_offset,
+	          &extent_size,
+	          &extent_file_offset,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_advise function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_advise(
+     libqcow_file_t *file )
+{
+	int advices[ 5 ] = {
+		LIBQCOW_ADVICE_SEQUENTIAL,
+		LIBQCOW_ADVICE_RANDOM,
+		LIBQCOW_ADVICE_WILLNEED,
+		LIBQCOW_ADVICE_DONTNEED,
+		LIBQCOW_ADVICE_NORMAL };
+
+	libcerror_error_t *error = NULL;
+	size64_t size            = 0;
+	int advice_index         = 0;
+	int result               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_file_get_media_size(
+	          file,
+	          &size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	for( advice_index = 0;
+	     advice_index < 5;
+	     advice_index++ )
+	{
+		result = libqcow_file_advise(
+		          file,
+		          0,
+		          size,
+		          advices[ advice_index ],
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		/* Advice beyond the media size is ignored
+		 */
+		result = libqcow_file_advise(
+		          file,
+		          (off64_t) size,
+		          4096,
+		          advices[ advice_index ],
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_file_advise(
+	          NULL,
+	          0,
+	          size,
+	          LIBQCOW_ADVICE_WILLNEED,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_advise(
+	          file,
+	          -1,
+	          size,
+	          LIBQCOW_ADVICE_WILLNEED,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_advise(
+	          file,
+	          0,
+	          size,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_seek_offset function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_seek_offset(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	size64_t size            = 0;
+	off64_t offset           = 0;
+
+	/* Test regular cases
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_END,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	size = (size64_t) offset;
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          1024,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 1024 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          -512,
+	          SEEK_CUR,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 512 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          (off64_t) ( size + 512 ),
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) ( size + 512 ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+#if defined( SEEK_HOLE )
+	/* The end of the media data is considered a hole
+	 */
+	if( size > 0 )
+	{
+		offset = libqcow_file_seek_offset(
+		          file,
+		          0,
+		          SEEK_HOLE,
+		          &error );
+
+		QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+		 "offset",
+		 offset,
+		 (int64_t) -1 );
+
+		QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+		 "offset",
+		 (uint64_t) offset,
+		 (uint64_t) size + 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	offset = libqcow_file_seek_offset(
+	          file,
+	          (off64_t) size,
+	          SEEK_HOLE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Reset offset to 0
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+#endif /* defined( SEEK_HOLE ) */
+
+	/* Test error cases
+	 */
+	offset = libqcow_file_seek_offset(
+	          NULL,
+	          0,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          -1,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          -1,
+	          SEEK_CUR,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	offset = libqcow_file_seek_offset(
+	          file,
+	          (off64_t) ( -1 * ( size + 1 ) ),
+	          SEEK_END,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 offset,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_offset function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_offset(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	off64_t offset           = 0;
+	int offset_is_set        = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_offset(
+	          file,
+	          &offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	offset_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_offset(
+	          NULL,
+	          &offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( offset_is_set != 0 )
+	{
+		result = libqcow_file_get_offset(
+		          file,
+		          NULL,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_media_size function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_media_size(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	size64_t media_size      = 0;
+	int media_size_is_set    = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_media_size(
+	          file,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	media_size_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_media_size(
+	          NULL,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( media_size_is_set != 0 )
+	{
+		result = libqcow_file_get_media_size(
+		          file,
+		          NULL,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_format_version function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_format_version(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error  = NULL;
+	uint32_t format_version   = 0;
+	int format_version_is_set = 0;
+	int result                = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_format_version(
+	          file,
+	          &format_version,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	format_version_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_format_version(
+	          NULL,
+	          &format_version,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( format_version_is_set != 0 )
+	{
+		result = libqcow_file_get_format_version(
+		          file,
+		          NULL,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_encryption_method function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_encryption_method(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error     = NULL;
+	uint32_t encryption_method   = 0;
+	int encryption_method_is_set = 0;
+	int result                   = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_encryption_method(
+	          file,
+	          &encryption_method,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	encryption_method_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_encryption_method(
+	          NULL,
+	          &encryption_method,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( encryption_method_is_set != 0 )
+	{
+		result = libqcow_file_get_encryption_method(
+		          file,
+		          NULL,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_utf8_backing_filename_size function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_utf8_backing_filename_size(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error              = NULL;
+	size_t utf8_backing_filename_size     = 0;
+	int result                            = 0;
+	int utf8_backing_filename_size_is_set = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_utf8_backing_filename_size(
+	          file,
+	          &utf8_backing_filename_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	utf8_backing_filename_size_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_utf8_backing_filename_size(
+	          NULL,
+	          &utf8_backing_filename_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( utf8_backing_filename_size_is_set != 0 )
+	{
+		result = libqcow_file_get_utf8_backing_filename_size(
+		          file,
+		          NULL,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_utf8_backing_filename function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_utf8_backing_filename(
+     libqcow_file_t *file )
+{
+	uint8_t utf8_backing_filename[ 512 ];
+
+	libcerror_error_t *error         = NULL;
+	int result                       = 0;
+	int utf8_backing_filename_is_set = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_utf8_backing_filename(
+	          file,
+	          utf8_backing_filename,
+	          512,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	utf8_backing_filename_is_set = result;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_utf8_backing_filename(
+	          NULL,
+	          utf8_backing_filename,
+	          512,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	if( utf8_backing_filename_is_set != 0 )
+	{
+		result = libqcow_file_get_utf8_backing_filename(
+		          file,
+		          NULL,
+		          512,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+
+		result = libqcow_file_get_utf8_backing_filename(
+		          file,
+		          utf8_backing_filename,
+		          0,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_set_parent_file function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_set_parent_file(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_file_set_parent_file(
+	          NULL,
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_set_parent_file(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_set_parent_file(
+	          file,
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_parent_file function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_parent_file(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error    = NULL;
+	libqcow_file_t *parent_file = NULL;
+	int result                  = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_parent_file(
+	          file,
+	          &parent_file,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_parent_file(
+	          NULL,
+	          &parent_file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_parent_file(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_number_of_snapshots function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_number_of_snapshots(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	int number_of_snapshots  = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_number_of_snapshots(
+	          file,
+	          &number_of_snapshots,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_number_of_snapshots(
+	          NULL,
+	          &number_of_snapshots,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_number_of_snapshots(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_snapshot_by_index function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_snapshot_by_index(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 16 ];
+
+	libcerror_error_t *error     = NULL;
+	libqcow_snapshot_t *snapshot = NULL;
+	size64_t media_size          = 0;
+	ssize_t read_count           = 0;
+	int number_of_snapshots      = 0;
+	int result                   = 0;
+
+	result = libqcow_file_get_number_of_snapshots(
+	          file,
+	          &number_of_snapshots,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	if( number_of_snapshots > 0 )
+	{
+		result = libqcow_file_get_snapshot_by_index(
+		          file,
+		          0,
+		          &snapshot,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "snapshot",
+		 snapshot );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_snapshot_get_media_size(
+		          snapshot,
+		          &media_size,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		if( media_size > 16 )
+		{
+			read_count = libqcow_snapshot_read_buffer_at_offset(
+			              snapshot,
+			              buffer,
+			              16,
+			              0,
+			              &error );
+
+			QCOW_TEST_ASSERT_EQUAL_SSIZE(
+			 "read_count",
+			 read_count,
+			 (ssize_t) 16 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "error",
+			 error );
+		}
+		result = libqcow_snapshot_free(
+		          &snapshot,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "snapshot",
+		 snapshot );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_file_get_snapshot_by_index(
+	          NULL,
+	          0,
+	          &snapshot,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_snapshot_by_index(
+	          file,
+	          -1,
+	          &snapshot,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_snapshot_by_index(
+	          file,
+	          number_of_snapshots,
+	          &snapshot,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_snapshot_by_index(
+	          file,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( snapshot != NULL )
+	{
+		libqcow_snapshot_free(
+		 &snapshot,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_number_of_used_clusters function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_number_of_used_clusters(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error         = NULL;
+	uint64_t number_of_used_clusters = 0;
+	int result                       = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_number_of_used_clusters(
+	          file,
+	          &number_of_used_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_number_of_used_clusters(
+	          NULL,
+	          &number_of_used_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_number_of_used_clusters(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_number_of_leaked_clusters function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_number_of_leaked_clusters(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error           = NULL;
+	uint64_t number_of_leaked_clusters = 0;
+	int result                         = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_number_of_leaked_clusters(
+	          file,
+	          &number_of_leaked_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_number_of_leaked_clusters(
+	          NULL,
+	          &number_of_leaked_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_number_of_leaked_clusters(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_number_of_shared_clusters function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_number_of_shared_clusters(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error           = NULL;
+	uint64_t number_of_shared_clusters = 0;
+	int result                         = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_number_of_shared_clusters(
+	          file,
+	          &number_of_shared_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_number_of_shared_clusters(
+	          NULL,
+	          &number_of_shared_clusters,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_number_of_shared_clusters(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_fragmentation_ratio function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_fragmentation_ratio(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error   = NULL;
+	double fragmentation_ratio = 0.0;
+	int result                 = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_fragmentation_ratio(
+	          file,
+	          &fragmentation_ratio,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_fragmentation_ratio(
+	          NULL,
+	          &fragmentation_ratio,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_fragmentation_ratio(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_cache_memory_usage function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_cache_memory_usage(
+     libqcow_file_t *file )
+{
+	libcerror_error_t *error = NULL;
+	size64_t memory_usage    = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_get_cache_memory_usage(
+	          file,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+	 "memory_usage",
+	 (int64_t) memory_usage,
+	 (int64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_cache_memory_usage(
+	          NULL,
+	          &memory_usage,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_cache_memory_usage(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_drop_caches function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_drop_caches(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 512 ];
+
+	libcerror_error_t *error = NULL;
+	ssize_t read_count       = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_drop_caches(
+	          file,
+	          LIBQCOW_CACHE_FLAG_ALL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The caches are filled again by a subsequent read
+	 */
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              512,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) 512 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_drop_caches(
+	          file,
+	          LIBQCOW_CACHE_FLAG_CLUSTER_BLOCKS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_drop_caches(
+	          NULL,
+	          LIBQCOW_CACHE_FLAG_ALL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_drop_caches(
+	          file,
+	          0x80,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_clone_reader function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_clone_reader(
+     libqcow_file_t *file )
+{
+	uint8_t file_buffer[ 512 ];
+	uint8_t reader_buffer[ 512 ];
+
+	libcerror_error_t *error = NULL;
+	libqcow_file_t *reader   = NULL;
+	size64_t media_size      = 0;
+	ssize_t read_count       = 0;
+	off64_t offset           = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_clone_reader(
+	          file,
+	          &reader,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "reader",
+	 reader );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_get_media_size(
+	          file,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	if( media_size >= 512 )
+	{
+		offset = (off64_t) ( media_size - 512 );
+
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              file_buffer,
+		              512,
+		              offset,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 512 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		read_count = libqcow_file_read_buffer_at_offset(
+		              reader,
+		              reader_buffer,
+		              512,
+		              offset,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) 512 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          file_buffer,
+		          reader_buffer,
+		          512 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		/* The reader has its own current offset
+		 */
+		result = libqcow_file_get_offset(
+		          reader,
+		          &offset,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_INT64(
+		 "offset",
+		 (int64_t) offset,
+		 (int64_t) media_size );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	result = libqcow_file_free(
+	          &reader,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "reader",
+	 reader );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_clone_reader(
+	          NULL,
+	          &reader,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_clone_reader(
+	          file,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( reader != NULL )
+	{
+		libqcow_file_free(
+		 &reader,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* The parallel read callback values
+ */
+typedef struct qcow_test_file_read_parallel_values qcow_test_file_read_parallel_values_t;
+
+struct qcow_test_file_read_parallel_values
+{
+	/* The offset of the next chunk
+	 */
+	off64_t next_offset;
+
+	/* The number of chunks
+	 */
+	int number_of_chunks;
+
+	/* The maximum number of chunks before stopping
+	 */
+	int maximum_number_of_chunks;
+
+	/* Value to indicate the chunks were not delivered in order
+	 */
+	int out_of_order;
+};
+
+/* The parallel read callback function used by qcow_test_file_read_parallel
+ * Returns 1 to continue or 0 to stop
+ */
+int qcow_test_file_read_parallel_callback(
+     off64_t chunk_offset,
+     const uint8_t *chunk_data,
+     size_t chunk_size,
+     void *user_data )
+{
+	qcow_test_file_read_parallel_values_t *values = NULL;
+
+	values = (qcow_test_file_read_parallel_values_t *) user_data;
+
+	if( ( values == NULL )
+	 || ( chunk_data == NULL ) )
+	{
+		return( -1 );
+	}
+	if( chunk_offset != values->next_offset )
+	{
+		values->out_of_order = 1;
+	}
+	values->next_offset       = chunk_offset + (off64_t) chunk_size;
+	values->number_of_chunks += 1;
+
+	if( ( values->maximum_number_of_chunks != 0 )
+	 && ( values->number_of_chunks >= values->maximum_number_of_chunks ) )
+	{
+		return( 0 );
+	}
+	return( 1 );
+}
+
+/* Tests the libqcow_file_read_parallel function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_read_parallel(
+     libqcow_file_t *file )
+{
+	qcow_test_file_read_parallel_values_t values;
+
+	libcerror_error_t *error = NULL;
+	size64_t media_size      = 0;
+	size64_t size            = 0;
+	int result               = 0;
+
+	result = libqcow_file_get_media_size(
+	          file,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	size = media_size;
+
+	if( size > (size64_t) ( 8 * 1024 * 1024 ) )
+	{
+		size = (size64_t) ( 8 * 1024 * 1024 );
+	}
+	/* Test regular cases
+	 */
+	values.next_offset              = 0;
+	values.number_of_chunks         = 0;
+	values.maximum_number_of_chunks = 0;
+	values.out_of_order             = 0;
+
+	result = libqcow_file_read_parallel(
+	          file,
+	          0,
+	          size,
+	          64 * 1024,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          0,
+	          LIBQCOW_PARALLEL_READ_FLAG_ORDERED | LIBQCOW_PARALLEL_READ_FLAG_INCLUDE_HOLES,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "values.out_of_order",
+	 values.out_of_order,
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "values.next_offset",
+	 (int64_t) values.next_offset,
+	 (int64_t) size );
+
+	/* Test stopping by the callback function
+	 */
+	if( values.number_of_chunks > 1 )
+	{
+		values.next_offset              = 0;
+		values.number_of_chunks         = 0;
+		values.maximum_number_of_chunks = 1;
+		values.out_of_order             = 0;
+
+		result = libqcow_file_read_parallel(
+		          file,
+		          0,
+		          size,
+		          64 * 1024,
+		          &qcow_test_file_read_parallel_callback,
+		          (void *) &values,
+		          1,
+		          LIBQCOW_PARALLEL_READ_FLAG_INCLUDE_HOLES,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "values.number_of_chunks",
+		 values.number_of_chunks,
+		 1 );
+	}
+	/* Test reading beyond the media size
+	 */
+	result = libqcow_file_read_parallel(
+	          file,
+	          (off64_t) media_size,
+	          512,
+	          0,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_read_parallel(
+	          NULL,
+	          0,
+	          size,
+	          0,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_parallel(
+	          file,
+	          -1,
+	          size,
+	          0,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_parallel(
+	          file,
+	          0,
+	          size,
+	          0,
+	          NULL,
+	          (void *) &values,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_parallel(
+	          file,
+	          0,
+	          size,
+	          0,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          -1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_read_parallel(
+	          file,
+	          0,
+	          size,
+	          0,
+	          &qcow_test_file_read_parallel_callback,
+	          (void *) &values,
+	          0,
+	          0x80,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_stream_open and libqcow_stream_next functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_stream(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 512 ];
+
+	libcerror_error_t *error  = NULL;
+	libqcow_stream_t *stream  = NULL;
+	const uint8_t *chunk_data = NULL;
+	size64_t media_size       = 0;
+	size64_t size             = 0;
+	size_t chunk_size         = 0;
+	size_t compare_size       = 0;
+	ssize_t read_count        = 0;
+	off64_t chunk_offset      = 0;
+	off64_t next_offset       = 0;
+	int result                = 0;
+
+	result = libqcow_file_get_media_size(
+	          file,
+	          &media_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	size = media_size;
+
+	if( size > (size64_t) ( 8 * 1024 * 1024 ) )
+	{
+		size = (size64_t) ( 8 * 1024 * 1024 );
+	}
+	/* Test regular cases
+	 */
+	result = libqcow_stream_open(
+	          file,
+	          0,
+	          size,
+	          64 * 1024,
+	          0,
+	          4,
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "stream",
+	 stream );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The chunks are returned in order and contain the same data as a regular read
+	 */
+	do
+	{
+		result = libqcow_stream_next(
+		          stream,
+		          &chunk_data,
+		          &chunk_size,
+		          &chunk_offset,
+		          &error );
+
+		QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		if( result == 0 )
+		{
+			break;
+		}
+		QCOW_TEST_ASSERT_EQUAL_INT64(
+		 "chunk_offset",
+		 (int64_t) chunk_offset,
+		 (int64_t) next_offset );
+
+		compare_size = chunk_size;
+
+		if( compare_size > 512 )
+		{
+			compare_size = 512;
+		}
+		read_count = libqcow_file_read_buffer_at_offset(
+		              file,
+		              buffer,
+		              compare_size,
+		              chunk_offset,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 (ssize_t) compare_size );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          chunk_data,
+		          buffer,
+		          compare_size );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		next_offset = chunk_offset + (off64_t) chunk_size;
+	}
+	while( next_offset < (off64_t) size );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "next_offset",
+	 (int64_t) next_offset,
+	 (int64_t) size );
+
+	result = libqcow_stream_next(
+	          stream,
+	          &chunk_data,
+	          &chunk_size,
+	          &chunk_offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_stream_next(
+	          stream,
+	          NULL,
+	          &chunk_size,
+	          &chunk_offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_stream_free(
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "stream",
+	 stream );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A stream that is freed before all chunks were returned stops its workers
+	 */
+	result = libqcow_stream_open(
+	          file,
+	          0,
+	          size,
+	          0,
+	          0,
+	          0,
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_stream_free(
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_stream_open(
+	          file,
+	          -1,
+	          size,
+	          0,
+	          0,
+	          0,
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_stream_open(
+	          file,
+	          0,
+	          size,
+	          0,
+	          -1,
+	          0,
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_stream_open(
+	          file,
+	          0,
+	          size,
+	          0,
+	          0,
+	          -1,
+	          &stream,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_stream_open(
+	          file,
+	          0,
+	          size,
+	          0,
+	          0,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( stream != NULL )
+	{
+		libqcow_stream_free(
+		 &stream,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_file_get_statistics and libqcow_file_reset_statistics functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_get_statistics(
+     libqcow_file_t *file )
+{
+	uint8_t buffer[ 512 ];
+	uint64_t values[ LIBQCOW_NUMBER_OF_STATISTICS ];
+
+	libcerror_error_t *error = NULL;
+	ssize_t read_count       = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_file_reset_statistics(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              512,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT64(
+	 "read_count",
+	 (int64_t) read_count,
+	 (int64_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_get_statistics(
+	          file,
+	          values,
+	          LIBQCOW_NUMBER_OF_STATISTICS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "bytes_returned",
+	 values[ LIBQCOW_STATISTIC_BYTES_RETURNED ],
+	 (uint64_t) read_count );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_file_get_statistics(
+	          NULL,
+	          values,
+	          LIBQCOW_NUMBER_OF_STATISTICS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_get_statistics(
+	          file,
+	          NULL,
+	          LIBQCOW_NUMBER_OF_STATISTICS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_file_reset_statistics(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Writes the write test image
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_file_write_test_image(
+     const char *filename )
+{
+	uint8_t image_data[ QCOW_TEST_FILE_WRITE_IMAGE_SIZE ];
+
+	FILE *file_stream = NULL;
+	size_t write_size = 0;
+	int cluster_index = 0;
+
+	if( memory_set(
+	     image_data,
+	     0,
+	     QCOW_TEST_FILE_WRITE_IMAGE_SIZE ) == NULL )
+	{
+		return( -1 );
+	}
+	/* The file header
+	 */
+	image_data[ 0 ] = 'Q';
+	image_data[ 1 ] = 'F';
+	image_data[ 2 ] = 'I';
+	image_data[ 3 ] = 0xfb;
+
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 4 ] ),
+	 3 );
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 20 ] ),
+	 9 );
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ 24 ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_MEDIA_SIZE );
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 36 ] ),
+	 2 );
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ 40 ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_LEVEL1_TABLE_OFFSET );
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ 48 ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_TABLE_OFFSET );
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 56 ] ),
+	 1 );
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 96 ] ),
+	 4 );
+	byte_stream_copy_from_uint32_big_endian(
+	 &( image_data[ 100 ] ),
+	 104 );
+
+	/* The level 1 table references the level 2 table of the first 32 KiB
+	 */
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ QCOW_TEST_FILE_WRITE_LEVEL1_TABLE_OFFSET ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET | QCOW_TEST_FILE_WRITE_FLAG_COPIED );
+
+	/* The level 2 table references an uncompressed cluster at media offset 0
+	 * and a compressed cluster at media offset 1024, of which the compressed
+	 * data spans 2 sectors in the last 2 clusters of the image
+	 */
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_DATA_OFFSET | QCOW_TEST_FILE_WRITE_FLAG_COPIED );
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET + 16 ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET | QCOW_TEST_FILE_WRITE_FLAG_COMPRESSED | ( (uint64_t) 1 << 61 ) );
+
+	/* The reference count table references the reference count block
+	 */
+	byte_stream_copy_from_uint64_big_endian(
+	 &( image_data[ QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_TABLE_OFFSET ] ),
+	 (uint64_t) QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_BLOCK_OFFSET );
+
+	for( cluster_index = 0;
+	     cluster_index < 8;
+	     cluster_index++ )
+	{
+		byte_stream_copy_from_uint16_big_endian(
+		 &( image_data[ QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_BLOCK_OFFSET + ( cluster_index * 2 ) ] ),
+		 1 );
+	}
+	if( memory_set(
+	     &( image_data[ QCOW_TEST_FILE_WRITE_DATA_OFFSET ] ),
+	     'A',
+	     QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL )
+	{
+		return( -1 );
+	}
+	if( memory_copy(
+	     &( image_data[ QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET ] ),
+	     qcow_test_file_write_compressed_data,
+	     8 ) == NULL )
+	{
+		return( -1 );
+	}
+	file_stream = file_stream_open(
+	               filename,
+	               FILE_STREAM_BINARY_OPEN_WRITE );
+
+	if( file_stream == NULL )
+	{
+		return( -1 );
+	}
+	write_size = file_stream_write(
+	              file_stream,
+	              image_data,
+	              QCOW_TEST_FILE_WRITE_IMAGE_SIZE );
+
+	if( file_stream_close(
+	     file_stream ) != 0 )
+	{
+		return( -1 );
+	}
+	if( write_size != (size_t) QCOW_TEST_FILE_WRITE_IMAGE_SIZE )
+	{
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads data of the write test image
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_file_read_test_image_data(
+     const char *filename,
+     off64_t offset,
+     uint8_t *data,
+     size_t data_size )
+{
+	FILE *file_stream = NULL;
+	size_t read_size  = 0;
+
+	file_stream = file_stream_open(
+	               filename,
+	               FILE_STREAM_BINARY_OPEN_READ );
+
+	if( file_stream == NULL )
+	{
+		return( -1 );
+	}
+	if( file_stream_seek_offset(
+	     file_stream,
+	     offset,
+	     SEEK_SET ) != 0 )
+	{
+		file_stream_close(
+		 file_stream );
+
+		return( -1 );
+	}
+	read_size = file_stream_read(
+	             file_stream,
+	             data,
+	             data_size );
+
+	if( file_stream_close(
+	     file_stream ) != 0 )
+	{
+		return( -1 );
+	}
+	if( read_size != data_size )
+	{
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Reads a 64-bit big-endian value of the write test image
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_file_read_test_image_value_64bit(
+     const char *filename,
+     off64_t offset,
+     uint64_t *value_64bit )
+{
+	uint8_t value_data[ 8 ];
+
+	if( qcow_test_file_read_test_image_data(
+	     filename,
+	     offset,
+	     value_data,
+	     8 ) != 1 )
+	{
+		return( -1 );
+	}
+	byte_stream_copy_to_uint64_big_endian(
+	 value_data,
+	 *value_64bit );
+
+	return( 1 );
+}
+
+/* Reads the reference count of a cluster of the write test image
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_file_read_test_image_reference_count(
+     const char *filename,
+     off64_t cluster_block_offset,
+     uint16_t *reference_count )
+{
+	uint8_t value_data[ 2 ];
+
+	uint64_t cluster_index                = 0;
+	uint64_t reference_count_block_offset = 0;
+
+	/* A reference count block of 16-bit reference counts describes 256 clusters
+	 */
+	cluster_index = (uint64_t) cluster_block_offset / QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE;
+
+	if( qcow_test_file_read_test_image_value_64bit(
+	     filename,
+	     (off64_t) ( QCOW_TEST_FILE_WRITE_REFERENCE_COUNT_TABLE_OFFSET + ( ( cluster_index / 256 ) * 8 ) ),
+	     &reference_count_block_offset ) != 1 )
+	{
+		return( -1 );
+	}
+	if( reference_count_block_offset == 0 )
+	{
+		*reference_count = 0;
+
+		return( 1 );
+	}
+	if( qcow_test_file_read_test_image_data(
+	     filename,
+	     (off64_t) ( reference_count_block_offset + ( ( cluster_index % 256 ) * 2 ) ),
+	     value_data,
+	     2 ) != 1 )
+	{
+		return( -1 );
+	}
+	byte_stream_copy_to_uint16_big_endian(
+	 value_data,
+	 *reference_count );
+
+	return( 1 );
+}
+
+/* Tests the libqcow_file_write_buffer, libqcow_file_write_buffer_at_offset and libqcow_file_flush functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_file_write_buffer(
+     void )
+{
+	uint8_t buffer[ QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ];
+	uint8_t expected_buffer[ QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ];
+
+	libcerror_error_t *error  = NULL;
+	libqcow_file_t *file      = NULL;
+	off64_t offset            = 0;
+	ssize_t read_count        = 0;
+	ssize_t write_count       = 0;
+	uint64_t expected_value   = 0;
+	uint64_t value_64bit      = 0;
+	uint16_t reference_count  = 0;
+	int result                = 0;
+
+	/* Initialize test
+	 */
+	result = qcow_test_file_write_test_image(
+	          QCOW_TEST_FILE_WRITE_FILENAME );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_open(
+	          file,
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          LIBQCOW_OPEN_READ_WRITE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              buffer,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              1024,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_set(
+	          expected_buffer,
+	          'Z',
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test overwriting a cluster with the copied flag in place
+	 */
+	result = memory_set(
+	          buffer,
+	          'B',
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	write_count = libqcow_file_write_buffer_at_offset(
+	               file,
+	               buffer,
+	               QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	               0,
+	               &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "write_count",
+	 write_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              expected_buffer,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              0,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_data(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_DATA_OFFSET,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_value_64bit(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET,
+	          &value_64bit );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	expected_value = (uint64_t) QCOW_TEST_FILE_WRITE_DATA_OFFSET | QCOW_TEST_FILE_WRITE_FLAG_COPIED;
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_entry0",
+	 value_64bit,
+	 expected_value );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_DATA_OFFSET,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
+
+	/* Test a partial write of an unallocated cluster that is copied on write
+	 * into the cluster after the end of the file
+	 */
+	offset = libqcow_file_seek_offset(
+	          file,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE + 64,
+	          SEEK_SET,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "offset",
+	 (int64_t) offset,
+	 (int64_t) ( QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE + 64 ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_set(
+	          buffer,
+	          'C',
+	          128 ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	write_count = libqcow_file_write_buffer(
+	               file,
+	               buffer,
+	               128,
+	               &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "write_count",
+	 write_count,
+	 (ssize_t) 128 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_set(
+	          buffer,
+	          0,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = memory_set(
+	          &( buffer[ 64 ] ),
+	          'C',
+	          128 ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              expected_buffer,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_value_64bit(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET + 8,
+	          &value_64bit );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	expected_value = (uint64_t) QCOW_TEST_FILE_WRITE_IMAGE_SIZE | QCOW_TEST_FILE_WRITE_FLAG_COPIED;
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_entry1",
+	 value_64bit,
+	 expected_value );
+
+	result = qcow_test_file_read_test_image_data(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
+
+	/* Test a write that allocates a new level 2 table, which is allocated
+	 * before the cluster of the data
+	 */
+	result = memory_set(
+	          buffer,
+	          'D',
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	write_count = libqcow_file_write_buffer_at_offset(
+	               file,
+	               buffer,
+	               QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	               32768,
+	               &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "write_count",
+	 write_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              expected_buffer,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              32768,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_value_64bit(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_LEVEL1_TABLE_OFFSET + 8,
+	          &value_64bit );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	expected_value = (uint64_t) ( QCOW_TEST_FILE_WRITE_IMAGE_SIZE + QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) | QCOW_TEST_FILE_WRITE_FLAG_COPIED;
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level1_table_entry1",
+	 value_64bit,
+	 expected_value );
+
+	result = qcow_test_file_read_test_image_value_64bit(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE + QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	          &value_64bit );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	expected_value = (uint64_t) ( QCOW_TEST_FILE_WRITE_IMAGE_SIZE + ( 2 * QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) ) | QCOW_TEST_FILE_WRITE_FLAG_COPIED;
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_entry0",
+	 value_64bit,
+	 expected_value );
+
+	result = qcow_test_file_read_test_image_data(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE + ( 2 * QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ),
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE + QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE + ( 2 * QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ),
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
+
+	/* Test overwriting a compressed cluster, which releases the clusters
+	 * of the compressed data, their reference counts are decremented on flush
+	 */
+	result = memory_set(
+	          buffer,
+	          'E',
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) == NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	write_count = libqcow_file_write_buffer_at_offset(
+	               file,
+	               buffer,
+	               QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	               1024,
+	               &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "write_count",
+	 write_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = qcow_test_file_read_test_image_value_64bit(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_LEVEL2_TABLE_OFFSET + 16,
+	          &value_64bit );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	expected_value = (uint64_t) ( QCOW_TEST_FILE_WRITE_IMAGE_SIZE + ( 3 * QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ) ) | QCOW_TEST_FILE_WRITE_FLAG_COPIED;
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_entry2",
+	 value_64bit,
+	 expected_value );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
+
+	result = libqcow_file_flush(
+	          file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 0 );
+
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_COMPRESSED_DATA_OFFSET + QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	          &reference_count );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-	libcerror_error_free(
-	 &error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 0 );
 
-	if( media_size_is_set != 0 )
-	{
-		result = libqcow_file_get_media_size(
-		          file,
-		          NULL,
-		          &error );
+	result = qcow_test_file_read_test_image_reference_count(
+	          QCOW_TEST_FILE_WRITE_FILENAME,
+	          QCOW_TEST_FILE_WRITE_IMAGE_SIZE + ( 3 * QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE ),
+	          &reference_count );
 
-		QCOW_TEST_ASSERT_EQUAL_INT(
-		 "result",
-		 result,
-		 -1 );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-		QCOW_TEST_ASSERT_IS_NOT_NULL(
-		 "error",
-		 error );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "reference_count",
+	 (int) reference_count,
+	 1 );
 
-		libcerror_error_free(
-		 &error );
-	}
-	return( 1 );
+	read_count = libqcow_file_read_buffer_at_offset(
+	              file,
+	              expected_buffer,
+	              QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	              1024,
+	              &error );
 
-on_error:
-	if( error != NULL )
-	{
-		libcerror_error_free(
-		 &error );
-	}
-	return( 0 );
-}
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
 
-/* Tests the libqcow_file_get_format_version function
- * Returns 1 if successful or 0 if not
- */
-int qcow_test_file_get_format_version(
-     libqcow_file_t *file )
-{
-	libcerror_error_t *error  = NULL;
-	uint32_t format_version   = 0;
-	int format_version_is_set = 0;
-	int result                = 0;
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* Test regular cases
-	 */
-	result = libqcow_file_get_format_version(
-	          file,
-	          &format_version,
-	          &error );
+	result = memory_compare(
+	          buffer,
+	          expected_buffer,
+	          QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
+	 0 );
 
-	QCOW_TEST_ASSERT_IS_NULL(
+	/* Test error cases
+	 */
+	write_count = libqcow_file_write_buffer_at_offset(
+	               NULL,
+	               buffer,
+	               QCOW_TEST_FILE_WRITE_CLUSTER_BLOCK_SIZE,
+	               0,
+	               &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "write_count",
+	 write_count,
+	 (ssize_t) -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
 	 "error",
 	 error );
 
-	format_version_is_set = result;
+	libcerror_error_free(
+	 &error );
 
-	/* Test error cases
-	 */
-	result = libqcow_file_get_format_version(
+	result = libqcow_file_flush(
 	          NULL,
-	          &format_version,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
@@ -1817,103 +7423,41 @@ int qcow_test_file_get_format_version(
 	libcerror_error_free(
 	 &error );
 
-	if( format_version_is_set != 0 )
-	{
-		result = libqcow_file_get_format_version(
-		          file,
-		          NULL,
-		          &error );
-
-		QCOW_TEST_ASSERT_EQUAL_INT(
-		 "result",
-		 result,
-		 -1 );
-
-		QCOW_TEST_ASSERT_IS_NOT_NULL(
-		 "error",
-		 error );
-
-		libcerror_error_free(
-		 &error );
-	}
-	return( 1 );
-
-on_error:
-	if( error != NULL )
-	{
-		libcerror_error_free(
-		 &error );
-	}
-	return( 0 );
-}
-
-/* Tests the libqcow_file_get_encryption_method function
- * Returns 1 if successful or 0 if not
- */
-int qcow_test_file_get_encryption_method(
-     libqcow_file_t *file )
-{
-	libcerror_error_t *error     = NULL;
-	uint32_t encryption_method   = 0;
-	int encryption_method_is_set = 0;
-	int result                   = 0;
-
-	/* Test regular cases
+	/* Clean up
 	 */
-	result = libqcow_file_get_encryption_method(
+	result = libqcow_file_close(
 	          file,
-	          &encryption_method,
 	          &error );
 
-	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
+	 0 );
 
 	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
 	 error );
 
-	encryption_method_is_set = result;
-
-	/* Test error cases
-	 */
-	result = libqcow_file_get_encryption_method(
-	          NULL,
-	          &encryption_method,
+	result = libqcow_file_free(
+	          &file,
 	          &error );
 
 	QCOW_TEST_ASSERT_EQUAL_INT(
 	 "result",
 	 result,
-	 -1 );
+	 1 );
 
-	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
 	 "error",
 	 error );
 
-	libcerror_error_free(
-	 &error );
-
-	if( encryption_method_is_set != 0 )
-	{
-		result = libqcow_file_get_encryption_method(
-		          file,
-		          NULL,
-		          &error );
-
-		QCOW_TEST_ASSERT_EQUAL_INT(
-		 "result",
-		 result,
-		 -1 );
-
-		QCOW_TEST_ASSERT_IS_NOT_NULL(
-		 "error",
-		 error );
+	remove(
+	 QCOW_TEST_FILE_WRITE_FILENAME );
 
-		libcerror_error_free(
-		 &error );
-	}
 	return( 1 );
 
 on_error:
@@ -1922,6 +7466,15 @@ on_error:
 		libcerror_error_free(
 		 &error );
 	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	remove(
+	 QCOW_TEST_FILE_WRITE_FILENAME );
+
 	return( 0 );
 }
 
@@ -1980,6 +7533,30 @@ int main(
 	 "libqcow_file_free",
 	 qcow_test_file_free );
 
+	QCOW_TEST_RUN(
+	 "libqcow_file_set_cache_limits",
+	 qcow_test_file_set_cache_limits );
+
+	QCOW_TEST_RUN(
+	 "libqcow_file_set_cache",
+	 qcow_test_file_set_cache );
+
+	QCOW_TEST_RUN(
+	 "libqcow_file_set_read_flags",
+	 qcow_test_file_set_read_flags );
+
+	QCOW_TEST_RUN(
+	 "libqcow_file_set_number_of_worker_threads",
+	 qcow_test_file_set_number_of_worker_threads );
+
+	QCOW_TEST_RUN(
+	 "libqcow_file_set_io_queue_depth",
+	 qcow_test_file_set_io_queue_depth );
+
+	QCOW_TEST_RUN(
+	 "libqcow_file_write_buffer",
+	 qcow_test_file_write_buffer );
+
 #if !defined( __BORLANDC__ ) || ( __BORLANDC__ >= 0x0560 )
 	if( source != NULL )
 	{
@@ -2032,6 +7609,12 @@ int main(
 	         "error",
 	         error );
 
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_open_metadata_only",
+		 qcow_test_file_open_metadata_only,
+		 source,
+		 file );
+
 		QCOW_TEST_RUN_WITH_ARGS(
 		 "libqcow_file_signal_abort",
 		 qcow_test_file_signal_abort,
@@ -2042,11 +7625,35 @@ int main(
 		 qcow_test_file_read_buffer,
 		 file );
 
-		/* TODO: add tests for libqcow_file_read_buffer_at_offset */
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_read_buffer_at_offset",
+		 qcow_test_file_read_buffer_at_offset,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_read_buffer_at_offset_with_zero_bitmap",
+		 qcow_test_file_read_buffer_at_offset_with_zero_bitmap,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_read_vector",
+		 qcow_test_file_read_vector,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_read_async",
+		 qcow_test_file_read_async,
+		 file );
 
-		/* TODO: add tests for libqcow_file_write_buffer */
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_extent_at_offset",
+		 qcow_test_file_get_extent_at_offset,
+		 file );
 
-		/* TODO: add tests for libqcow_file_write_buffer_at_offset */
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_advise",
+		 qcow_test_file_advise,
+		 file );
 
 		QCOW_TEST_RUN_WITH_ARGS(
 		 "libqcow_file_seek_offset",
@@ -2079,6 +7686,86 @@ int main(
 		 qcow_test_file_get_encryption_method,
 		 file );
 
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_utf8_backing_filename_size",
+		 qcow_test_file_get_utf8_backing_filename_size,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_utf8_backing_filename",
+		 qcow_test_file_get_utf8_backing_filename,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_set_parent_file",
+		 qcow_test_file_set_parent_file,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_parent_file",
+		 qcow_test_file_get_parent_file,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_number_of_snapshots",
+		 qcow_test_file_get_number_of_snapshots,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_snapshot_by_index",
+		 qcow_test_file_get_snapshot_by_index,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_number_of_used_clusters",
+		 qcow_test_file_get_number_of_used_clusters,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_number_of_leaked_clusters",
+		 qcow_test_file_get_number_of_leaked_clusters,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_number_of_shared_clusters",
+		 qcow_test_file_get_number_of_shared_clusters,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_fragmentation_ratio",
+		 qcow_test_file_get_fragmentation_ratio,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_cache_memory_usage",
+		 qcow_test_file_get_cache_memory_usage,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_drop_caches",
+		 qcow_test_file_drop_caches,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_get_statistics",
+		 qcow_test_file_get_statistics,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_clone_reader",
+		 qcow_test_file_clone_reader,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_file_read_parallel",
+		 qcow_test_file_read_parallel,
+		 file );
+
+		QCOW_TEST_RUN_WITH_ARGS(
+		 "libqcow_stream_open",
+		 qcow_test_file_stream,
+		 file );
+
 		/* Clean up
 		 */
 		result = qcow_test_file_close_source(
@@ -0,0 +1,489 @@
+/*
+ * Library hardware_aes functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_hardware_aes.h"
+
+#if defined( __GNUC__ )
+
+/* The CBC-AES128 test vectors from NIST SP 800-38A F.2
+ */
+uint8_t qcow_test_hardware_aes_key[ 16 ] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+
+uint8_t qcow_test_hardware_aes_initialization_vector[ 16 ] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+uint8_t qcow_test_hardware_aes_plaintext[ 64 ] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10 };
+
+uint8_t qcow_test_hardware_aes_ciphertext[ 64 ] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7 };
+
+/* Tests the libqcow_hardware_aes_get_backend_name function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hardware_aes_get_backend_name(
+     void )
+{
+	const char *backend_name = NULL;
+
+	backend_name = libqcow_hardware_aes_get_backend_name(
+	                LIBQCOW_HARDWARE_AES_BACKEND_NONE );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "backend_name",
+	 backend_name );
+
+	backend_name = libqcow_hardware_aes_get_backend_name(
+	                libqcow_hardware_aes_get_backend() );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "backend_name",
+	 backend_name );
+
+	return( 1 );
+
+on_error:
+	return( 0 );
+}
+
+/* Tests the libqcow_hardware_aes_context_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hardware_aes_context_initialize(
+     void )
+{
+	libcerror_error_t *error                = NULL;
+	libqcow_hardware_aes_context_t *context = NULL;
+	int result                              = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_hardware_aes_context_initialize(
+	          &context,
+	          &error );
+
+	if( libqcow_hardware_aes_get_backend() == LIBQCOW_HARDWARE_AES_BACKEND_NONE )
+	{
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 -1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "error",
+		 error );
+
+		libcerror_error_free(
+		 &error );
+	}
+	else
+	{
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NOT_NULL(
+		 "context",
+		 context );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_hardware_aes_context_free(
+		          &context,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "context",
+		 context );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_hardware_aes_context_initialize(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hardware_aes_context_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( context != NULL )
+	{
+		libqcow_hardware_aes_context_free(
+		 &context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_hardware_aes_crypt_cbc function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hardware_aes_crypt_cbc(
+     void )
+{
+	uint8_t data[ 64 ];
+
+	libcerror_error_t *error                = NULL;
+	libqcow_hardware_aes_context_t *context = NULL;
+	int result                              = 0;
+
+	if( libqcow_hardware_aes_get_backend() == LIBQCOW_HARDWARE_AES_BACKEND_NONE )
+	{
+		return( 1 );
+	}
+	/* Initialize test
+	 */
+	result = libqcow_hardware_aes_context_initialize(
+	          &context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "context",
+	 context );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_hardware_aes_context_set_key(
+	          context,
+	          qcow_test_hardware_aes_key,
+	          128,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_hardware_aes_crypt_cbc(
+	          context,
+	          LIBCAES_CRYPT_MODE_ENCRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          qcow_test_hardware_aes_plaintext,
+	          64,
+	          data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          data,
+	          qcow_test_hardware_aes_ciphertext,
+	          64 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test decryption in place
+	 */
+	result = libqcow_hardware_aes_crypt_cbc(
+	          context,
+	          LIBCAES_CRYPT_MODE_DECRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          data,
+	          64,
+	          data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          data,
+	          qcow_test_hardware_aes_plaintext,
+	          64 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test decryption of fewer blocks than are decrypted at a time
+	 */
+	result = libqcow_hardware_aes_crypt_cbc(
+	          context,
+	          LIBCAES_CRYPT_MODE_DECRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          qcow_test_hardware_aes_ciphertext,
+	          48,
+	          data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          data,
+	          qcow_test_hardware_aes_plaintext,
+	          48 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_hardware_aes_crypt_cbc(
+	          NULL,
+	          LIBCAES_CRYPT_MODE_DECRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          qcow_test_hardware_aes_ciphertext,
+	          64,
+	          data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hardware_aes_crypt_cbc(
+	          context,
+	          LIBCAES_CRYPT_MODE_DECRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          qcow_test_hardware_aes_ciphertext,
+	          63,
+	          data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hardware_aes_crypt_cbc(
+	          context,
+	          LIBCAES_CRYPT_MODE_DECRYPT,
+	          qcow_test_hardware_aes_initialization_vector,
+	          16,
+	          qcow_test_hardware_aes_ciphertext,
+	          64,
+	          data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_hardware_aes_context_free(
+	          &context,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( context != NULL )
+	{
+		libqcow_hardware_aes_context_free(
+		 &context,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_hardware_aes_get_backend_name",
+	 qcow_test_hardware_aes_get_backend_name );
+
+	QCOW_TEST_RUN(
+	 "libqcow_hardware_aes_context_initialize",
+	 qcow_test_hardware_aes_context_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_hardware_aes_crypt_cbc",
+	 qcow_test_hardware_aes_crypt_cbc );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,454 @@
+/*
+ * Library hash functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_definitions.h"
+#include "../libqcow/libqcow_hash.h"
+
+#if defined( __GNUC__ )
+
+/* The SHA-1 and SHA-256 test vectors from FIPS 180-2 appendix A and B
+ */
+uint8_t qcow_test_hash_message[ 3 ] = {
+	0x61, 0x62, 0x63 };
+
+uint8_t qcow_test_hash_sha1_digest[ 20 ] = {
+	0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c,
+	0x9c, 0xd0, 0xd8, 0x9d };
+
+uint8_t qcow_test_hash_sha256_digest[ 32 ] = {
+	0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+	0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad };
+
+/* The PBKDF2 test vectors from RFC 6070 and RFC 7914
+ */
+uint8_t qcow_test_hash_password[ 8 ] = {
+	0x70, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x72, 0x64 };
+
+uint8_t qcow_test_hash_salt[ 4 ] = {
+	0x73, 0x61, 0x6c, 0x74 };
+
+uint8_t qcow_test_hash_pbkdf2_sha1_output[ 20 ] = {
+	0xea, 0x6c, 0x01, 0x4d, 0xc7, 0x2d, 0x6f, 0x8c, 0xcd, 0x1e, 0xd9, 0x2a, 0xce, 0x1d, 0x41, 0xf0,
+	0xd8, 0xde, 0x89, 0x57 };
+
+uint8_t qcow_test_hash_pbkdf2_sha256_output[ 32 ] = {
+	0x12, 0x0f, 0xb6, 0xcf, 0xfc, 0xf8, 0xb3, 0x2c, 0x43, 0xe7, 0x22, 0x52, 0x56, 0xc4, 0xf8, 0x37,
+	0xa8, 0x65, 0x48, 0xc9, 0x2c, 0xcc, 0x35, 0x48, 0x08, 0x05, 0x98, 0x7c, 0xb7, 0x0b, 0xe1, 0x7b };
+
+/* Tests the libqcow_hash_get_type_from_name function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hash_get_type_from_name(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int hash_type            = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_hash_get_type_from_name(
+	          "sha256",
+	          6,
+	          &hash_type,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "hash_type",
+	 hash_type,
+	 LIBQCOW_HASH_TYPE_SHA256 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_hash_get_type_from_name(
+	          "md5",
+	          3,
+	          &hash_type,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_hash_get_type_from_name(
+	          NULL,
+	          6,
+	          &hash_type,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hash_get_type_from_name(
+	          "sha256",
+	          6,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_hash_calculate function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hash_calculate(
+     void )
+{
+	uint8_t digest[ 32 ];
+
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_hash_calculate(
+	          LIBQCOW_HASH_TYPE_SHA1,
+	          qcow_test_hash_message,
+	          3,
+	          digest,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          digest,
+	          qcow_test_hash_sha1_digest,
+	          20 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_hash_calculate(
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          qcow_test_hash_message,
+	          3,
+	          digest,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          digest,
+	          qcow_test_hash_sha256_digest,
+	          32 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_hash_calculate(
+	          -1,
+	          qcow_test_hash_message,
+	          3,
+	          digest,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hash_calculate(
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          qcow_test_hash_message,
+	          3,
+	          digest,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_hash_pbkdf2 function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_hash_pbkdf2(
+     void )
+{
+	uint8_t output_data[ 32 ];
+
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_hash_pbkdf2(
+	          LIBQCOW_HASH_TYPE_SHA1,
+	          qcow_test_hash_password,
+	          8,
+	          qcow_test_hash_salt,
+	          4,
+	          2,
+	          output_data,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          output_data,
+	          qcow_test_hash_pbkdf2_sha1_output,
+	          20 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_hash_pbkdf2(
+	          LIBQCOW_HASH_TYPE_SHA256,
+	          qcow_test_hash_password,
+	          8,
+	          qcow_test_hash_salt,
+	          4,
+	          1,
+	          output_data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          output_data,
+	          qcow_test_hash_pbkdf2_sha256_output,
+	          32 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_hash_pbkdf2(
+	          LIBQCOW_HASH_TYPE_SHA1,
+	          qcow_test_hash_password,
+	          8,
+	          qcow_test_hash_salt,
+	          4,
+	          0,
+	          output_data,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_hash_pbkdf2(
+	          LIBQCOW_HASH_TYPE_SHA1,
+	          qcow_test_hash_password,
+	          8,
+	          qcow_test_hash_salt,
+	          4,
+	          2,
+	          NULL,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_hash_get_type_from_name",
+	 qcow_test_hash_get_type_from_name );
+
+	QCOW_TEST_RUN(
+	 "libqcow_hash_calculate",
+	 qcow_test_hash_calculate );
+
+	QCOW_TEST_RUN(
+	 "libqcow_hash_pbkdf2",
+	 qcow_test_hash_pbkdf2 );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
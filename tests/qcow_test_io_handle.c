@@ -21,12 +21,14 @@
 
 #include <common.h>
 #include <file_stream.h>
+#include <memory.h>
 #include <types.h>
 
 #if defined( HAVE_STDLIB_H ) || defined( WINAPI )
 #include <stdlib.h>
 #endif
 
+#include "qcow_test_libbfio.h"
 #include "qcow_test_libcerror.h"
 #include "qcow_test_libqcow.h"
 #include "qcow_test_macros.h"
@@ -35,6 +37,15 @@
 
 #include "../libqcow/libqcow_io_handle.h"
 
+uint8_t qcow_test_io_handle_file_header_data_v3[ 512 ] = {
+	0x51, 0x46, 0x49, 0xfb, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x70, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
 #if defined( __GNUC__ )
 
 /* Tests the libqcow_io_handle_initialize function
@@ -270,38 +281,1379 @@ on_error:
 	return( 0 );
 }
 
-#endif /* defined( __GNUC__ ) */
+/* Tests the libqcow_io_handle_read_file_header function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_handle_read_file_header(
+     void )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	libcerror_error_t *error         = NULL;
+	libqcow_io_handle_t *io_handle   = NULL;
+	uint32_t encryption_method       = 0;
+	int result                       = 0;
 
-/* The main program
+	/* Initialize test
+	 */
+	result = libqcow_io_handle_initialize(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle",
+	 io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file_io_handle",
+	 file_io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          qcow_test_io_handle_file_header_data_v3,
+	          512,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "io_handle->format_version",
+	 io_handle->format_version,
+	 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "io_handle->header_size",
+	 io_handle->header_size,
+	 112 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "io_handle->incompatible_feature_flags",
+	 io_handle->incompatible_feature_flags,
+	 (uint64_t) 0x00000008UL );
+
+	/* The compression method is LIBQCOW_COMPRESSION_METHOD_ZSTD
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "io_handle->compression_method",
+	 (int) io_handle->compression_method,
+	 2 );
+
+	/* The 64 KiB level 2 table is read in 16 slices of 4 KiB
+	 */
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->level2_table_size",
+	 io_handle->level2_table_size,
+	 (size_t) 65536 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->level2_table_slice_size",
+	 io_handle->level2_table_slice_size,
+	 (size_t) 4096 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "io_handle->number_of_level2_table_slices",
+	 io_handle->number_of_level2_table_slices,
+	 16 );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_handle_read_file_header(
+	          NULL,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test extended level 2 table entries
+	 */
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x18;
+
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x08;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The 64 KiB level 2 table contains 4096 entries of 16 bytes
+	 */
+	QCOW_TEST_ASSERT_EQUAL_UINT32(
+	 "io_handle->number_of_level2_table_bits",
+	 io_handle->number_of_level2_table_bits,
+	 12 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->level2_table_size",
+	 io_handle->level2_table_size,
+	 (size_t) 65536 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->level2_table_slice_size",
+	 io_handle->level2_table_slice_size,
+	 (size_t) 4096 );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->subcluster_size",
+	 io_handle->subcluster_size,
+	 (size_t) 2048 );
+
+	/* Test unsupported incompatible feature flags: bit 5
+	 */
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x28;
+
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x08;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test unsupported incompatible feature flags: corrupt
+	 */
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x0a;
+
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x08;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test compression type without the compression type feature flag
+	 */
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x00;
+
+	result = libqcow_io_handle_read_file_header(
+	          io_handle,
+	          file_io_handle,
+	          &encryption_method,
+	          &error );
+
+	qcow_test_io_handle_file_header_data_v3[ 79 ] = 0x08;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_free(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( io_handle != NULL )
+	{
+		libqcow_io_handle_free(
+		 &io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_handle_read_header_extensions function
+ * Returns 1 if successful or 0 if not
  */
-#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
-int wmain(
-     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
-     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
-#else
-int main(
-     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
-     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
-#endif
+int qcow_test_io_handle_read_header_extensions(
+     void )
 {
-	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
-	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+	uint8_t header_extensions_data[ 32 ] = {
+		0x44, 0x41, 0x54, 0x41, 0x00, 0x00, 0x00, 0x06, 0x64, 0x61, 0x74, 0x61, 0x2e, 0x69, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
 
-#if defined( __GNUC__ )
+	libbfio_handle_t *file_io_handle = NULL;
+	libcerror_error_t *error         = NULL;
+	libqcow_io_handle_t *io_handle   = NULL;
+	int result                       = 0;
 
-	QCOW_TEST_RUN(
-	 "libqcow_io_handle_initialize",
-	 qcow_test_io_handle_initialize );
+	/* Initialize test
+	 */
+	result = libqcow_io_handle_initialize(
+	          &io_handle,
+	          &error );
 
-	QCOW_TEST_RUN(
-	 "libqcow_io_handle_free",
-	 qcow_test_io_handle_free );
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
 
-	/* TODO: add tests for libqcow_io_handle_clear */
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle",
+	 io_handle );
 
-	/* TODO: add tests for libqcow_io_handle_read_file_header */
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
 
-	/* TODO: add tests for libqcow_io_handle_read_level2_table */
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file_io_handle",
+	 file_io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          header_extensions_data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 * The extensions size exceeds the size of the data and reading stops at the end marker
+	 */
+	result = libqcow_io_handle_read_header_extensions(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          4096,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle->data_filename",
+	 io_handle->data_filename );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->data_filename_size",
+	 io_handle->data_filename_size,
+	 (size_t) 6 );
+
+	result = memory_compare(
+	          io_handle->data_filename,
+	          "data.i",
+	          6 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_handle_read_header_extensions(
+	          NULL,
+	          file_io_handle,
+	          0,
+	          4096,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test data filename value already set
+	 */
+	result = libqcow_io_handle_read_header_extensions(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          4096,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_clear(
+	          io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test header extension data size value out of bounds
+	 */
+	result = libqcow_io_handle_read_header_extensions(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          12,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_header_extensions(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_free(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( io_handle != NULL )
+	{
+		libqcow_io_handle_free(
+		 &io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_handle_get_feature_name and libqcow_io_handle_check_feature_flags functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_handle_check_feature_flags(
+     void )
+{
+	uint8_t header_extensions_data[ 64 ] = {
+		0x68, 0x03, 0xf8, 0x57, 0x00, 0x00, 0x00, 0x30, 0x00, 0x05, 0x74, 0x65, 0x73, 0x74, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	char feature_name[ 64 ];
+
+	libbfio_handle_t *file_io_handle = NULL;
+	libcerror_error_t *error         = NULL;
+	libqcow_io_handle_t *io_handle   = NULL;
+	int result                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_handle_initialize(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle",
+	 io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file_io_handle",
+	 file_io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          header_extensions_data,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_read_header_extensions(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "io_handle->feature_name_table_size",
+	 io_handle->feature_name_table_size,
+	 (size_t) 48 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_handle_get_feature_name(
+	          io_handle,
+	          LIBQCOW_FEATURE_TYPE_INCOMPATIBLE,
+	          5,
+	          feature_name,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = memory_compare(
+	          feature_name,
+	          "test",
+	          5 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_io_handle_get_feature_name(
+	          io_handle,
+	          LIBQCOW_FEATURE_TYPE_COMPATIBLE,
+	          5,
+	          feature_name,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	io_handle->format_version             = 3;
+	io_handle->incompatible_feature_flags = LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_DIRTY;
+
+	result = libqcow_io_handle_check_feature_flags(
+	          io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_handle_get_feature_name(
+	          NULL,
+	          LIBQCOW_FEATURE_TYPE_INCOMPATIBLE,
+	          5,
+	          feature_name,
+	          64,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_get_feature_name(
+	          io_handle,
+	          LIBQCOW_FEATURE_TYPE_INCOMPATIBLE,
+	          5,
+	          feature_name,
+	          46,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_check_feature_flags(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test file marked as corrupt
+	 */
+	io_handle->incompatible_feature_flags = LIBQCOW_INCOMPATIBLE_FEATURE_FLAG_CORRUPT;
+
+	result = libqcow_io_handle_check_feature_flags(
+	          io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test unsupported incompatible feature in the feature name table
+	 */
+	io_handle->incompatible_feature_flags = 0x00000020UL;
+
+	result = libqcow_io_handle_check_feature_flags(
+	          io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_free(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( io_handle != NULL )
+	{
+		libqcow_io_handle_free(
+		 &io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_handle_read_level2_tables_data and libqcow_io_handle_read_level2_table_data functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_handle_read_level2_tables_data(
+     void )
+{
+	uint8_t level2_tables_data[ 32 ] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	uint8_t data[ 32 ];
+
+	libbfio_handle_t *file_io_handle      = NULL;
+	libcerror_error_t *error              = NULL;
+	libqcow_cluster_table_t *level2_table = NULL;
+	libqcow_io_handle_t *io_handle        = NULL;
+	uint64_t reference                    = 0;
+	int result                            = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_handle_initialize(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_handle",
+	 io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	io_handle->level2_table_slice_size = 16;
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file_io_handle",
+	 file_io_handle );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          level2_tables_data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_handle_read_level2_tables_data(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_read_level2_table_data(
+	          io_handle,
+	          &( data[ 16 ] ),
+	          16,
+	          &level2_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "level2_table",
+	 level2_table );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_get_reference_by_index(
+	          level2_table,
+	          0,
+	          &reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference",
+	 reference,
+	 (uint64_t) 0x30000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_cluster_table_free(
+	          &level2_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_handle_read_level2_tables_data(
+	          NULL,
+	          file_io_handle,
+	          0,
+	          data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_level2_tables_data(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          NULL,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with a data size that is not a multiple of the level 2 table slice size
+	 */
+	result = libqcow_io_handle_read_level2_tables_data(
+	          io_handle,
+	          file_io_handle,
+	          0,
+	          data,
+	          24,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test reading beyond the end of the data
+	 */
+	result = libqcow_io_handle_read_level2_tables_data(
+	          io_handle,
+	          file_io_handle,
+	          16,
+	          data,
+	          32,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_level2_table_data(
+	          NULL,
+	          data,
+	          16,
+	          &level2_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_level2_table_data(
+	          io_handle,
+	          data,
+	          32,
+	          &level2_table,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_handle_read_level2_table_data(
+	          io_handle,
+	          data,
+	          16,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_handle_free(
+	          &io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( level2_table != NULL )
+	{
+		libqcow_cluster_table_free(
+		 &level2_table,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( io_handle != NULL )
+	{
+		libqcow_io_handle_free(
+		 &io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_initialize",
+	 qcow_test_io_handle_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_free",
+	 qcow_test_io_handle_free );
+
+	/* TODO: add tests for libqcow_io_handle_clear */
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_read_file_header",
+	 qcow_test_io_handle_read_file_header );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_read_header_extensions",
+	 qcow_test_io_handle_read_header_extensions );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_check_feature_flags",
+	 qcow_test_io_handle_check_feature_flags );
+
+	/* TODO: add tests for libqcow_io_handle_read_level2_table */
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_handle_read_level2_tables_data",
+	 qcow_test_io_handle_read_level2_tables_data );
 
 	/* TODO: add tests for libqcow_io_handle_read_cluster_block */
 
@@ -0,0 +1,1084 @@
+/*
+ * Library io_scheduler type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_io_scheduler.h"
+#include "../libqcow/libqcow_read_request.h"
+
+/* The number of IO priorities, see LIBQCOW_NUMBER_OF_IO_PRIORITIES
+ */
+#define QCOW_TEST_NUMBER_OF_IO_PRIORITIES	3
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_io_scheduler_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_scheduler_initialize(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	int result                           = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests      = 1;
+	int number_of_memset_fail_tests      = 1;
+	int test_number                      = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_scheduler_initialize(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_free(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_scheduler_initialize(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	io_scheduler = (libqcow_io_scheduler_t *) 0x12345678UL;
+
+	result = libqcow_io_scheduler_initialize(
+	          &io_scheduler,
+	          &error );
+
+	io_scheduler = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_io_scheduler_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_io_scheduler_initialize(
+		          &io_scheduler,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( io_scheduler != NULL )
+			{
+				libqcow_io_scheduler_free(
+				 &io_scheduler,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "io_scheduler",
+			 io_scheduler );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_io_scheduler_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_io_scheduler_initialize(
+		          &io_scheduler,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( io_scheduler != NULL )
+			{
+				libqcow_io_scheduler_free(
+				 &io_scheduler,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "io_scheduler",
+			 io_scheduler );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( io_scheduler != NULL )
+	{
+		libqcow_io_scheduler_free(
+		 &io_scheduler,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_scheduler_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_scheduler_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_io_scheduler_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_scheduler_set_limits and libqcow_io_scheduler_get_limits functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_scheduler_limits(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	size64_t maximum_bytes_per_second    = 0;
+	uint64_t maximum_requests_per_second = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_scheduler_initialize(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          &maximum_bytes_per_second,
+	          &maximum_requests_per_second,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_bytes_per_second",
+	 (uint64_t) maximum_bytes_per_second,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_requests_per_second",
+	 maximum_requests_per_second,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_set_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          1048576,
+	          100,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          &maximum_bytes_per_second,
+	          &maximum_requests_per_second,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_bytes_per_second",
+	 (uint64_t) maximum_bytes_per_second,
+	 (uint64_t) 1048576 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_requests_per_second",
+	 maximum_requests_per_second,
+	 (uint64_t) 100 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The limits of the other IO priorities are not changed
+	 */
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_INTERACTIVE,
+	          &maximum_bytes_per_second,
+	          &maximum_requests_per_second,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "maximum_bytes_per_second",
+	 (uint64_t) maximum_bytes_per_second,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_scheduler_set_limits(
+	          NULL,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_set_limits(
+	          io_scheduler,
+	          QCOW_TEST_NUMBER_OF_IO_PRIORITIES,
+	          0,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          -1,
+	          &maximum_bytes_per_second,
+	          &maximum_requests_per_second,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          NULL,
+	          &maximum_requests_per_second,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_get_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          &maximum_bytes_per_second,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_io_scheduler_free(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( io_scheduler != NULL )
+	{
+		libqcow_io_scheduler_free(
+		 &io_scheduler,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_scheduler_push_request, libqcow_io_scheduler_remove_request and libqcow_io_scheduler_pop_request functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_scheduler_push_and_pop_request(
+     void )
+{
+	libqcow_internal_read_request_t requests[ 4 ];
+
+	libcerror_error_t *error             = NULL;
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	libqcow_read_request_t *request      = NULL;
+	int number_of_requests               = 0;
+	int request_index                    = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_scheduler_initialize(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The requests are only queued, they are not processed
+	 */
+	for( request_index = 0;
+	     request_index < 4;
+	     request_index++ )
+	{
+		memory_set(
+		 &( requests[ request_index ] ),
+		 0,
+		 sizeof( libqcow_internal_read_request_t ) );
+
+		requests[ request_index ].buffer_size = 512;
+	}
+	requests[ 0 ].priority = LIBQCOW_IO_PRIORITY_BACKGROUND;
+	requests[ 1 ].priority = LIBQCOW_IO_PRIORITY_NORMAL;
+	requests[ 2 ].priority = LIBQCOW_IO_PRIORITY_INTERACTIVE;
+	requests[ 3 ].priority = LIBQCOW_IO_PRIORITY_NORMAL;
+
+	/* Test regular cases
+	 */
+	for( request_index = 0;
+	     request_index < 4;
+	     request_index++ )
+	{
+		result = libqcow_io_scheduler_push_request(
+		          io_scheduler,
+		          (libqcow_read_request_t *) &( requests[ request_index ] ),
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	result = libqcow_io_scheduler_get_number_of_queued_requests(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_NORMAL,
+	          &number_of_requests,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_requests",
+	 number_of_requests,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The interactive request is popped first, although it was pushed after the others
+	 */
+	result = libqcow_io_scheduler_pop_request(
+	          io_scheduler,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "request",
+	 (uint64_t) (intptr_t) request,
+	 (uint64_t) (intptr_t) &( requests[ 2 ] ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Requests of the same priority are popped in order of submission
+	 */
+	result = libqcow_io_scheduler_pop_request(
+	          io_scheduler,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "request",
+	 (uint64_t) (intptr_t) request,
+	 (uint64_t) (intptr_t) &( requests[ 1 ] ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_remove_request(
+	          io_scheduler,
+	          (libqcow_read_request_t *) &( requests[ 3 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A request that is no longer queued is not removed
+	 */
+	result = libqcow_io_scheduler_remove_request(
+	          io_scheduler,
+	          (libqcow_read_request_t *) &( requests[ 3 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_pop_request(
+	          io_scheduler,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "request",
+	 (uint64_t) (intptr_t) request,
+	 (uint64_t) (intptr_t) &( requests[ 0 ] ) );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_pop_request(
+	          io_scheduler,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "request",
+	 request );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_scheduler_push_request(
+	          NULL,
+	          (libqcow_read_request_t *) &( requests[ 0 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_push_request(
+	          io_scheduler,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	requests[ 0 ].priority = QCOW_TEST_NUMBER_OF_IO_PRIORITIES;
+
+	result = libqcow_io_scheduler_push_request(
+	          io_scheduler,
+	          (libqcow_read_request_t *) &( requests[ 0 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_pop_request(
+	          NULL,
+	          &request,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_pop_request(
+	          io_scheduler,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_io_scheduler_free(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( io_scheduler != NULL )
+	{
+		libqcow_io_scheduler_free(
+		 &io_scheduler,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_io_scheduler_acquire function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_io_scheduler_acquire(
+     void )
+{
+	libcerror_error_t *error             = NULL;
+	libqcow_io_scheduler_t *io_scheduler = NULL;
+	int abort                            = 0;
+	int result                           = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_io_scheduler_initialize(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_io_scheduler_acquire(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          65536,
+	          &abort,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A read within the burst of a rate limited IO priority does not wait
+	 */
+	result = libqcow_io_scheduler_set_limits(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          1048576,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_io_scheduler_acquire(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          65536,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	abort = 1;
+
+	result = libqcow_io_scheduler_acquire(
+	          io_scheduler,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          65536,
+	          &abort,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_io_scheduler_acquire(
+	          NULL,
+	          LIBQCOW_IO_PRIORITY_BACKGROUND,
+	          65536,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_io_scheduler_acquire(
+	          io_scheduler,
+	          QCOW_TEST_NUMBER_OF_IO_PRIORITIES,
+	          65536,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_io_scheduler_free(
+	          &io_scheduler,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "io_scheduler",
+	 io_scheduler );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( io_scheduler != NULL )
+	{
+		libqcow_io_scheduler_free(
+		 &io_scheduler,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_scheduler_initialize",
+	 qcow_test_io_scheduler_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_scheduler_free",
+	 qcow_test_io_scheduler_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_scheduler_limits",
+	 qcow_test_io_scheduler_limits );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_scheduler_push_and_pop_request",
+	 qcow_test_io_scheduler_push_and_pop_request );
+
+	QCOW_TEST_RUN(
+	 "libqcow_io_scheduler_acquire",
+	 qcow_test_io_scheduler_acquire );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,904 @@
+/*
+ * Library layout scan type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_file.h"
+#include "../libqcow/libqcow_io_handle.h"
+#include "../libqcow/libqcow_layout_scan.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_layout_scan_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_layout_scan_initialize(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_layout_scan_t *layout_scan = NULL;
+	libqcow_file_t *file               = NULL;
+	int result                         = 0;
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "file",
+	 file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "layout_scan",
+	 layout_scan );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "layout_scan->number_of_workers",
+	 layout_scan->number_of_workers,
+	 4 );
+
+	result = libqcow_layout_scan_free(
+	          &layout_scan,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "layout_scan",
+	 layout_scan );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_layout_scan_initialize(
+	          NULL,
+	          file,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	layout_scan = (libqcow_layout_scan_t *) 0x12345678UL;
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          1,
+	          &error );
+
+	layout_scan = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          NULL,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          LIBQCOW_MAXIMUM_NUMBER_OF_WORKER_THREADS + 1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( layout_scan != NULL )
+	{
+		libqcow_layout_scan_free(
+		 &layout_scan,
+		 NULL );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_layout_scan_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_layout_scan_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_layout_scan_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_layout_scan_get_next_level2_tables function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_layout_scan_get_next_level2_tables(
+     void )
+{
+	uint64_t level2_table_offsets[ 6 ] = {
+		0x00010000UL, 0x00020000UL, 0, 0x00040000UL, 0x00060000UL, 0x00070000UL };
+
+	libcerror_error_t *error           = NULL;
+	libqcow_file_t *file               = NULL;
+	libqcow_layout_scan_t *layout_scan = NULL;
+	int level1_table_index             = 0;
+	int number_of_level2_tables        = 0;
+	int offset_index                   = 0;
+	int result                         = 0;
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	( (libqcow_internal_file_t *) file )->io_handle->level2_table_size = 0x00010000UL;
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_set_number_of_level1_table_indexes(
+	          layout_scan,
+	          6,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( offset_index = 0;
+	     offset_index < 6;
+	     offset_index++ )
+	{
+		layout_scan->level2_table_offsets[ offset_index ] = level2_table_offsets[ offset_index ];
+	}
+	/* Test regular cases
+	 * The level 2 tables of consecutive level 1 table indexes that are adjacent
+	 * are taken as a single run and unallocated level 2 tables are skipped
+	 */
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          &level1_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level1_table_index",
+	 level1_table_index,
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          &level1_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level1_table_index",
+	 level1_table_index,
+	 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          &level1_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "level1_table_index",
+	 level1_table_index,
+	 4 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_level2_tables",
+	 number_of_level2_tables,
+	 2 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          &level1_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          NULL,
+	          &level1_table_index,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          NULL,
+	          &number_of_level2_tables,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_get_next_level2_tables(
+	          layout_scan,
+	          &level1_table_index,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_layout_scan_free(
+	          &layout_scan,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( layout_scan != NULL )
+	{
+		libqcow_layout_scan_free(
+		 &layout_scan,
+		 NULL );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_layout_scan_scan_level2_table and libqcow_layout_scan_merge_host_runs functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_layout_scan_scan_level2_table(
+     void )
+{
+	uint8_t level2_tables_data[ 64 ] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00 };
+
+	libcerror_error_t *error             = NULL;
+	libqcow_file_t *file                 = NULL;
+	libqcow_io_handle_t *io_handle       = NULL;
+	libqcow_layout_scan_t *layout_scan   = NULL;
+	libqcow_layout_scan_worker_t *worker = NULL;
+	int result                           = 0;
+	int value_index                      = 0;
+
+	result = libqcow_file_initialize(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A level 2 table of 4 standard entries that reference 64 KiB cluster blocks
+	 */
+	io_handle = ( (libqcow_internal_file_t *) file )->io_handle;
+
+	io_handle->number_of_cluster_block_bits      = 16;
+	io_handle->number_of_level2_table_entry_bits = 3;
+	io_handle->level1_index_bit_shift            = 18;
+	io_handle->level2_table_size                 = 32;
+	io_handle->cluster_block_size                = 0x00010000UL;
+	io_handle->cluster_block_bit_mask            = 0x0000ffffUL;
+	io_handle->offset_bit_mask                   = 0x3fffffffffffffffULL;
+	io_handle->compression_flag_bit_mask         = (uint64_t) 1 << 62;
+	io_handle->zero_flag_bit_mask                = 0x0000000000000001ULL;
+
+	result = libqcow_layout_scan_initialize(
+	          &layout_scan,
+	          file,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_set_number_of_level1_table_indexes(
+	          layout_scan,
+	          2,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	layout_scan->file_size  = 0x00100000UL;
+	layout_scan->media_size = 0x00080000UL;
+
+	worker = &( layout_scan->workers[ 0 ] );
+
+	/* Test regular cases
+	 */
+	result = libqcow_layout_scan_scan_level2_table(
+	          worker,
+	          0,
+	          level2_tables_data,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_layout_scan_scan_level2_table(
+	          worker,
+	          1,
+	          &( level2_tables_data[ 32 ] ),
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "worker->values[ LIBQCOW_LAYOUT_VALUE_ALLOCATED_SIZE ]",
+	 worker->values[ LIBQCOW_LAYOUT_VALUE_ALLOCATED_SIZE ],
+	 (uint64_t) 0x00050000UL );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "worker->values[ LIBQCOW_LAYOUT_VALUE_ZERO_SIZE ]",
+	 worker->values[ LIBQCOW_LAYOUT_VALUE_ZERO_SIZE ],
+	 (uint64_t) 0x00010000UL );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ]",
+	 worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ],
+	 (uint64_t) 4 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ]",
+	 worker->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_INVALID_REFERENCES ],
+	 (uint64_t) 1 );
+
+	for( value_index = 0;
+	     value_index < LIBQCOW_NUMBER_OF_LAYOUT_VALUES;
+	     value_index++ )
+	{
+		layout_scan->values[ value_index ] = worker->values[ value_index ];
+	}
+	/* The host run that ends in the first level 2 table continues in the second one
+	 */
+	result = libqcow_layout_scan_merge_host_runs(
+	          layout_scan,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ]",
+	 layout_scan->values[ LIBQCOW_LAYOUT_VALUE_NUMBER_OF_HOST_RUNS ],
+	 (uint64_t) 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "layout_scan->values[ LIBQCOW_LAYOUT_VALUE_SPARSE_SIZE ]",
+	 layout_scan->values[ LIBQCOW_LAYOUT_VALUE_SPARSE_SIZE ],
+	 (uint64_t) 0x00020000UL );
+
+	/* Test error cases
+	 */
+	result = libqcow_layout_scan_scan_level2_table(
+	          NULL,
+	          0,
+	          level2_tables_data,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_scan_level2_table(
+	          worker,
+	          -1,
+	          level2_tables_data,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_scan_level2_table(
+	          worker,
+	          2,
+	          level2_tables_data,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_scan_level2_table(
+	          worker,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_layout_scan_merge_host_runs(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_layout_scan_free(
+	          &layout_scan,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_file_free(
+	          &file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( layout_scan != NULL )
+	{
+		libqcow_layout_scan_free(
+		 &layout_scan,
+		 NULL );
+	}
+	if( file != NULL )
+	{
+		libqcow_file_free(
+		 &file,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_layout_scan_initialize",
+	 qcow_test_layout_scan_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_layout_scan_free",
+	 qcow_test_layout_scan_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_layout_scan_get_next_level2_tables",
+	 qcow_test_layout_scan_get_next_level2_tables );
+
+	QCOW_TEST_RUN(
+	 "libqcow_layout_scan_scan_level2_table",
+	 qcow_test_layout_scan_scan_level2_table );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
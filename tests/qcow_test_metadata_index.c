@@ -0,0 +1,829 @@
+/*
+ * Library metadata_index type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_metadata_index.h"
+
+#if defined( __GNUC__ )
+
+/* Big-endian level 2 table entries of 2 cluster blocks
+ */
+uint8_t qcow_test_metadata_index_level2_table_data[ 16 ] = {
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+/* Tests the libqcow_metadata_index_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_metadata_index_initialize(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_metadata_index_t *metadata_index = NULL;
+	int result                               = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_metadata_index_initialize(
+	          &metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "metadata_index",
+	 metadata_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_SIZE(
+	 "metadata_index->number_of_entries",
+	 metadata_index->number_of_entries,
+	 (size_t) 5 );
+
+	result = libqcow_metadata_index_free(
+	          &metadata_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "metadata_index",
+	 metadata_index );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_metadata_index_initialize(
+	          NULL,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	metadata_index = (libqcow_metadata_index_t *) 0x12345678UL;
+
+	result = libqcow_metadata_index_initialize(
+	          &metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	metadata_index = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_initialize(
+	          &metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          12,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( metadata_index != NULL )
+	{
+		libqcow_metadata_index_free(
+		 &metadata_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_metadata_index_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_metadata_index_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_metadata_index_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_metadata_index_get_entry_at_offset and libqcow_metadata_index_set_level2_table_data functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_metadata_index_get_entry_at_offset(
+     void )
+{
+	libcerror_error_t *error                 = NULL;
+	libqcow_metadata_index_t *metadata_index = NULL;
+	uint64_t cluster_descriptor              = 0;
+	uint64_t subcluster_bitmap               = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_metadata_index_initialize(
+	          &metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          metadata_index,
+	          65536,
+	          &cluster_descriptor,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_descriptor",
+	 cluster_descriptor,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Entries beyond the media are ignored
+	 */
+	result = libqcow_metadata_index_set_level2_table_data(
+	          metadata_index,
+	          4,
+	          qcow_test_metadata_index_level2_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          metadata_index,
+	          4 * 65536,
+	          &cluster_descriptor,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_descriptor",
+	 cluster_descriptor,
+	 (uint64_t) 0x8000000000050000ULL );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "subcluster_bitmap",
+	 subcluster_bitmap,
+	 (uint64_t) 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          NULL,
+	          65536,
+	          &cluster_descriptor,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          &cluster_descriptor,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          metadata_index,
+	          65536,
+	          NULL,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_set_level2_table_data(
+	          metadata_index,
+	          5,
+	          qcow_test_metadata_index_level2_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_set_level2_table_data(
+	          metadata_index,
+	          0,
+	          qcow_test_metadata_index_level2_table_data,
+	          12,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_metadata_index_free(
+	          &metadata_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( metadata_index != NULL )
+	{
+		libqcow_metadata_index_free(
+		 &metadata_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_metadata_index_write_file_io_handle and libqcow_metadata_index_read_file_io_handle functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_metadata_index_write_and_read_file_io_handle(
+     void )
+{
+	uint8_t metadata_index_file_data[ 104 ];
+
+	libbfio_handle_t *file_io_handle         = NULL;
+	libcerror_error_t *error                 = NULL;
+	libqcow_metadata_index_t *metadata_index = NULL;
+	libqcow_metadata_index_t *read_index     = NULL;
+	uint64_t cluster_descriptor              = 0;
+	uint64_t subcluster_bitmap               = 0;
+	int result                               = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_metadata_index_initialize(
+	          &metadata_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_set_level2_table_data(
+	          metadata_index,
+	          2,
+	          qcow_test_metadata_index_level2_table_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_initialize(
+	          &read_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x87654321UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          metadata_index_file_data,
+	          104,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ_WRITE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_metadata_index_write_file_io_handle(
+	          metadata_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_get_entry_at_offset(
+	          read_index,
+	          3 * 65536,
+	          &cluster_descriptor,
+	          &subcluster_bitmap,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_descriptor",
+	 cluster_descriptor,
+	 (uint64_t) 0x0000000000000001ULL );
+
+	/* Test a metadata index file of an image with another level 1 table
+	 */
+	libqcow_metadata_index_free(
+	 &read_index,
+	 NULL );
+
+	result = libqcow_metadata_index_initialize(
+	          &read_index,
+	          ( 4 * 65536 ) + 1,
+	          65536,
+	          8,
+	          1048576,
+	          0x12345678UL,
+	          0x11111111UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_metadata_index_read_file_io_handle(
+	          read_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_metadata_index_read_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_metadata_index_write_file_io_handle(
+	          NULL,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test reading a metadata index file with a corrupted entry
+	 */
+	metadata_index_file_data[ 80 ] ^= 0xff;
+
+	result = libqcow_metadata_index_read_file_io_handle(
+	          metadata_index,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_metadata_index_free(
+	          &read_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_metadata_index_free(
+	          &metadata_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( read_index != NULL )
+	{
+		libqcow_metadata_index_free(
+		 &read_index,
+		 NULL );
+	}
+	if( metadata_index != NULL )
+	{
+		libqcow_metadata_index_free(
+		 &metadata_index,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_metadata_index_initialize",
+	 qcow_test_metadata_index_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_metadata_index_free",
+	 qcow_test_metadata_index_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_metadata_index_get_entry_at_offset",
+	 qcow_test_metadata_index_get_entry_at_offset );
+
+	QCOW_TEST_RUN(
+	 "libqcow_metadata_index_write_and_read_file_io_handle",
+	 qcow_test_metadata_index_write_and_read_file_io_handle );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
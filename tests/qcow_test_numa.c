@@ -0,0 +1,937 @@
+/*
+ * Library numa_topology type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_numa.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_numa_topology_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_numa_topology_initialize(
+     void )
+{
+	libcerror_error_t *error               = NULL;
+	libqcow_numa_topology_t *numa_topology = NULL;
+	int result                             = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests        = 2;
+	int number_of_memset_fail_tests        = 1;
+	int test_number                        = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_numa_topology_initialize(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_numa_topology_free(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_numa_topology_initialize(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	numa_topology = (libqcow_numa_topology_t *) 0x12345678UL;
+
+	result = libqcow_numa_topology_initialize(
+	          &numa_topology,
+	          &error );
+
+	numa_topology = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_numa_topology_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_numa_topology_initialize(
+		          &numa_topology,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( numa_topology != NULL )
+			{
+				libqcow_numa_topology_free(
+				 &numa_topology,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "numa_topology",
+			 numa_topology );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_numa_topology_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_numa_topology_initialize(
+		          &numa_topology,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( numa_topology != NULL )
+			{
+				libqcow_numa_topology_free(
+				 &numa_topology,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "numa_topology",
+			 numa_topology );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( numa_topology != NULL )
+	{
+		libqcow_numa_topology_free(
+		 &numa_topology,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_numa_topology_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_numa_topology_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_numa_topology_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_numa_topology_set_cpu_list function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_numa_topology_set_cpu_list(
+     void )
+{
+	libcerror_error_t *error               = NULL;
+	libqcow_numa_topology_t *numa_topology = NULL;
+	int node_index                         = 0;
+	int number_of_cpus                     = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_numa_topology_initialize(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0-3,8-11\n",
+	          9,
+	          5,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_cpus",
+	 number_of_cpus,
+	 8 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_numa_topology_get_node_of_cpu(
+	          numa_topology,
+	          8,
+	          &node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "node_index",
+	 node_index,
+	 5 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "6",
+	          1,
+	          4,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_cpus",
+	 number_of_cpus,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_numa_topology_get_node_of_cpu(
+	          numa_topology,
+	          6,
+	          &node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "node_index",
+	 node_index,
+	 4 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A node without CPUs has an empty CPU list
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "\n",
+	          1,
+	          3,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_cpus",
+	 number_of_cpus,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* CPUs beyond the number of CPUs of the topology are ignored
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "65535\n",
+	          6,
+	          2,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "number_of_cpus",
+	 number_of_cpus,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_numa_topology_get_node_of_cpu(
+	          numa_topology,
+	          65535,
+	          &node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          NULL,
+	          "0-3\n",
+	          4,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          NULL,
+	          4,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0-3\n",
+	          4,
+	          -1,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0-3\n",
+	          4,
+	          0,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with a range without a last CPU
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0-\n",
+	          3,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with a descending range
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "3-1\n",
+	          4,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with an unsupported character
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0;1\n",
+	          4,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Test with an empty element
+	 */
+	result = libqcow_numa_topology_set_cpu_list(
+	          numa_topology,
+	          "0,,1\n",
+	          5,
+	          0,
+	          &number_of_cpus,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_numa_topology_free(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( numa_topology != NULL )
+	{
+		libqcow_numa_topology_free(
+		 &numa_topology,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_numa_topology_get_number_of_nodes, libqcow_numa_topology_get_current_node
+ * and libqcow_numa_topology_bind_thread functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_numa_topology_get_current_node(
+     void )
+{
+	libcerror_error_t *error               = NULL;
+	libqcow_numa_topology_t *numa_topology = NULL;
+	int node_index                         = 0;
+	int number_of_nodes                    = 0;
+	int result                             = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_numa_topology_initialize(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_numa_topology_get_number_of_nodes(
+	          numa_topology,
+	          &number_of_nodes,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_GREATER_THAN_INT(
+	 "number_of_nodes",
+	 number_of_nodes,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	node_index = -1;
+
+	result = libqcow_numa_topology_get_current_node(
+	          numa_topology,
+	          &node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_GREATER_THAN_INT(
+	 "node_index",
+	 node_index,
+	 -1 );
+
+	QCOW_TEST_ASSERT_LESS_THAN_INT(
+	 "node_index",
+	 node_index,
+	 number_of_nodes );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Binding the thread is not supported on every platform
+	 */
+	result = libqcow_numa_topology_bind_thread(
+	          numa_topology,
+	          node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_numa_topology_get_number_of_nodes(
+	          NULL,
+	          &number_of_nodes,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_get_number_of_nodes(
+	          numa_topology,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_get_current_node(
+	          NULL,
+	          &node_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_get_current_node(
+	          numa_topology,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_bind_thread(
+	          NULL,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_numa_topology_bind_thread(
+	          numa_topology,
+	          number_of_nodes,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_numa_topology_free(
+	          &numa_topology,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "numa_topology",
+	 numa_topology );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( numa_topology != NULL )
+	{
+		libqcow_numa_topology_free(
+		 &numa_topology,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_numa_topology_initialize",
+	 qcow_test_numa_topology_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_numa_topology_free",
+	 qcow_test_numa_topology_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_numa_topology_set_cpu_list",
+	 qcow_test_numa_topology_set_cpu_list );
+
+	QCOW_TEST_RUN(
+	 "libqcow_numa_topology_get_current_node",
+	 qcow_test_numa_topology_get_current_node );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
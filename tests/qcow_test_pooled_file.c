@@ -0,0 +1,666 @@
+/*
+ * Library pooled_file type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <narrow_string.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_pooled_file.h"
+
+#if defined( __GNUC__ )
+
+/* Creates a file IO handle for a file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_pooled_file_initialize_file_io_handle(
+     libbfio_handle_t **file_io_handle,
+     const char *filename,
+     libcerror_error_t **error )
+{
+	if( libbfio_file_initialize(
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		return( -1 );
+	}
+	if( libbfio_file_set_name(
+	     *file_io_handle,
+	     filename,
+	     narrow_string_length(
+	      filename ) + 1,
+	     error ) != 1 )
+	{
+		libbfio_handle_free(
+		 file_io_handle,
+		 NULL );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Tests the libqcow_pooled_file_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_pooled_file_initialize(
+     void )
+{
+	libbfio_handle_t *file_io_handle   = NULL;
+	libbfio_pool_t *file_io_pool       = NULL;
+	libcerror_error_t *error           = NULL;
+	libqcow_pooled_file_t *pooled_file = NULL;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	result = libbfio_pool_initialize(
+	          &file_io_pool,
+	          0,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_file_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_pooled_file_initialize(
+	          &pooled_file,
+	          file_io_pool,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "pooled_file",
+	 pooled_file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The file IO pool takes over the file IO handle
+	 */
+	file_io_handle = NULL;
+
+	result = libqcow_pooled_file_free(
+	          &pooled_file,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "pooled_file",
+	 pooled_file );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_pooled_file_initialize(
+	          NULL,
+	          file_io_pool,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_pooled_file_initialize(
+	          &pooled_file,
+	          NULL,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_pooled_file_initialize(
+	          &pooled_file,
+	          file_io_pool,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libbfio_pool_free(
+	          &file_io_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( pooled_file != NULL )
+	{
+		libqcow_pooled_file_free(
+		 &pooled_file,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	if( file_io_pool != NULL )
+	{
+		libbfio_pool_free(
+		 &file_io_pool,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_pooled_file_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_pooled_file_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_pooled_file_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests reading a file through pooled file IO handles
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_pooled_file_read_buffer_at_offset(
+     const char *filename )
+{
+	uint8_t expected_buffer[ 4096 ];
+	uint8_t buffer[ 4096 ];
+
+	libbfio_handle_t *file_io_handle              = NULL;
+	libbfio_handle_t *pooled_file_io_handles[ 2 ] = { NULL, NULL };
+	libbfio_handle_t *safe_file_io_handle         = NULL;
+	libbfio_pool_t *file_io_pool                  = NULL;
+	libcerror_error_t *error                      = NULL;
+	size64_t expected_size                        = 0;
+	size64_t size                                 = 0;
+	ssize_t expected_read_count                   = 0;
+	ssize_t read_count                            = 0;
+	off64_t offset                                = 0;
+	int handle_index                              = 0;
+	int iterator                                  = 0;
+	int result                                    = 0;
+
+	/* Initialize test
+	 */
+	result = qcow_test_pooled_file_initialize_file_io_handle(
+	          &file_io_handle,
+	          filename,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_get_size(
+	          file_io_handle,
+	          &expected_size,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A pool that keeps at most 1 handle open forces the pooled handles
+	 * to be closed and reopened when they are read alternately
+	 */
+	result = libbfio_pool_initialize(
+	          &file_io_pool,
+	          0,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( handle_index = 0;
+	     handle_index < 2;
+	     handle_index++ )
+	{
+		result = qcow_test_pooled_file_initialize_file_io_handle(
+		          &safe_file_io_handle,
+		          filename,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libqcow_pooled_file_initialize_handle(
+		          &( pooled_file_io_handles[ handle_index ] ),
+		          file_io_pool,
+		          safe_file_io_handle,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		/* The file IO pool takes over the file IO handle
+		 */
+		safe_file_io_handle = NULL;
+
+		result = libbfio_handle_open(
+		          pooled_file_io_handles[ handle_index ],
+		          LIBBFIO_OPEN_READ,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libbfio_handle_get_size(
+		          pooled_file_io_handles[ handle_index ],
+		          &size,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "size",
+		 (uint64_t) size,
+		 (uint64_t) expected_size );
+	}
+	/* Test regular cases
+	 */
+	for( iterator = 0;
+	     iterator < 8;
+	     iterator++ )
+	{
+		handle_index = iterator % 2;
+		offset       = (off64_t) ( ( iterator * 1000 ) % ( expected_size / 2 ) );
+
+		expected_read_count = libbfio_handle_read_buffer_at_offset(
+		                       file_io_handle,
+		                       expected_buffer,
+		                       4096,
+		                       offset,
+		                       &error );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		read_count = libbfio_handle_read_buffer_at_offset(
+		              pooled_file_io_handles[ handle_index ],
+		              buffer,
+		              4096,
+		              offset,
+		              &error );
+
+		QCOW_TEST_ASSERT_EQUAL_SSIZE(
+		 "read_count",
+		 read_count,
+		 expected_read_count );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = memory_compare(
+		          buffer,
+		          expected_buffer,
+		          (size_t) read_count );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+	}
+	/* Test a read beyond the end of the file
+	 */
+	read_count = libbfio_handle_read_buffer_at_offset(
+	              pooled_file_io_handles[ 0 ],
+	              buffer,
+	              16,
+	              (off64_t) expected_size,
+	              &error );
+
+	QCOW_TEST_ASSERT_EQUAL_SSIZE(
+	 "read_count",
+	 read_count,
+	 (ssize_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Clean up
+	 */
+	for( handle_index = 0;
+	     handle_index < 2;
+	     handle_index++ )
+	{
+		result = libbfio_handle_close(
+		          pooled_file_io_handles[ handle_index ],
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 0 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		result = libbfio_handle_free(
+		          &( pooled_file_io_handles[ handle_index ] ),
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	result = libbfio_pool_free(
+	          &file_io_pool,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	for( handle_index = 0;
+	     handle_index < 2;
+	     handle_index++ )
+	{
+		if( pooled_file_io_handles[ handle_index ] != NULL )
+		{
+			libbfio_handle_free(
+			 &( pooled_file_io_handles[ handle_index ] ),
+			 NULL );
+		}
+	}
+	if( safe_file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &safe_file_io_handle,
+		 NULL );
+	}
+	if( file_io_pool != NULL )
+	{
+		libbfio_pool_free(
+		 &file_io_pool,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_pooled_file_initialize",
+	 qcow_test_pooled_file_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_pooled_file_free",
+	 qcow_test_pooled_file_free );
+
+#if !defined( HAVE_WIDE_SYSTEM_CHARACTER )
+
+	/* The test program itself is used as the file to read
+	 */
+	QCOW_TEST_RUN_WITH_ARGS(
+	 "libqcow_pooled_file_read_buffer_at_offset",
+	 qcow_test_pooled_file_read_buffer_at_offset,
+	 argv[ 0 ] );
+
+#endif /* !defined( HAVE_WIDE_SYSTEM_CHARACTER ) */
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
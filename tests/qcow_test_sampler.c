@@ -0,0 +1,296 @@
+/*
+ * Library sampler functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_sampler.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_sampler_get_cluster_block_index function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_sampler_get_cluster_block_index(
+     void )
+{
+	uint64_t cluster_block_index          = 0;
+	uint64_t previous_cluster_block_index = 0;
+	uint64_t sample_index                 = 0;
+
+	/* Test regular cases
+	 * Every cluster block is sampled when the number of samples equals the number of cluster blocks
+	 */
+	for( sample_index = 0;
+	     sample_index < 1000;
+	     sample_index++ )
+	{
+		cluster_block_index = libqcow_sampler_get_cluster_block_index(
+		                       1000,
+		                       1000,
+		                       sample_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "cluster_block_index",
+		 cluster_block_index,
+		 sample_index );
+	}
+	/* Every sample is within its stratum, so the samples are ascending
+	 */
+	for( sample_index = 0;
+	     sample_index < 97;
+	     sample_index++ )
+	{
+		cluster_block_index = libqcow_sampler_get_cluster_block_index(
+		                       1000003,
+		                       97,
+		                       sample_index );
+
+		QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+		 "cluster_block_index",
+		 cluster_block_index,
+		 (uint64_t) 1000003 );
+
+		if( sample_index > 0 )
+		{
+			QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+			 "previous_cluster_block_index",
+			 previous_cluster_block_index,
+			 cluster_block_index );
+		}
+		previous_cluster_block_index = cluster_block_index;
+
+		/* The same sample index results in the same cluster block
+		 */
+		cluster_block_index = libqcow_sampler_get_cluster_block_index(
+		                       1000003,
+		                       97,
+		                       sample_index );
+
+		QCOW_TEST_ASSERT_EQUAL_UINT64(
+		 "cluster_block_index",
+		 cluster_block_index,
+		 previous_cluster_block_index );
+	}
+	/* Test error cases
+	 */
+	cluster_block_index = libqcow_sampler_get_cluster_block_index(
+	                       1000,
+	                       0,
+	                       0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_index",
+	 cluster_block_index,
+	 (uint64_t) 0 );
+
+	cluster_block_index = libqcow_sampler_get_cluster_block_index(
+	                       1000,
+	                       10,
+	                       10 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_index",
+	 cluster_block_index,
+	 (uint64_t) 0 );
+
+	return( 1 );
+
+on_error:
+	return( 0 );
+}
+
+/* Tests the libqcow_sampler_is_high_entropy function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_sampler_is_high_entropy(
+     void )
+{
+	uint8_t data[ 65536 ];
+
+	libcerror_error_t *error = NULL;
+	size_t data_offset       = 0;
+	uint32_t random_value    = 0x12345678UL;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	for( data_offset = 0;
+	     data_offset < 65536;
+	     data_offset++ )
+	{
+		data[ data_offset ] = 0;
+	}
+	result = libqcow_sampler_is_high_entropy(
+	          data,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Text like data with a limited set of byte values is not high entropy
+	 */
+	for( data_offset = 0;
+	     data_offset < 65536;
+	     data_offset++ )
+	{
+		data[ data_offset ] = (uint8_t) ( 'a' + ( data_offset % 26 ) );
+	}
+	result = libqcow_sampler_is_high_entropy(
+	          data,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Pseudo-random data is high entropy
+	 */
+	for( data_offset = 0;
+	     data_offset < 65536;
+	     data_offset++ )
+	{
+		random_value ^= random_value << 13;
+		random_value ^= random_value >> 17;
+		random_value ^= random_value << 5;
+
+		data[ data_offset ] = (uint8_t) ( random_value >> 24 );
+	}
+	result = libqcow_sampler_is_high_entropy(
+	          data,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_sampler_is_high_entropy(
+	          NULL,
+	          65536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_sampler_is_high_entropy(
+	          data,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_sampler_get_cluster_block_index",
+	 qcow_test_sampler_get_cluster_block_index );
+
+	QCOW_TEST_RUN(
+	 "libqcow_sampler_is_high_entropy",
+	 qcow_test_sampler_is_high_entropy );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,629 @@
+/*
+ * Library scratch_overlay type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_scratch_overlay.h"
+
+#if defined( __GNUC__ )
+
+/* The number of blocks that are added, which exceeds the initial number of hash buckets
+ */
+#define QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS	600
+
+uint8_t qcow_test_scratch_overlay_file_data[ QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS * 512 ];
+
+/* Tests the libqcow_scratch_overlay_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_scratch_overlay_initialize(
+     void )
+{
+	libcerror_error_t *error                   = NULL;
+	libqcow_scratch_overlay_t *scratch_overlay = NULL;
+	int result                                 = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_scratch_overlay_initialize(
+	          &scratch_overlay,
+	          4096,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "scratch_overlay",
+	 scratch_overlay );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "scratch_overlay->number_of_block_bits",
+	 (int) scratch_overlay->number_of_block_bits,
+	 12 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "scratch_overlay->number_of_entries",
+	 scratch_overlay->number_of_entries,
+	 0 );
+
+	result = libqcow_scratch_overlay_free(
+	          &scratch_overlay,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_scratch_overlay_initialize(
+	          NULL,
+	          4096,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	scratch_overlay = (libqcow_scratch_overlay_t *) 0x12345678UL;
+
+	result = libqcow_scratch_overlay_initialize(
+	          &scratch_overlay,
+	          4096,
+	          NULL,
+	          &error );
+
+	scratch_overlay = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_scratch_overlay_initialize(
+	          &scratch_overlay,
+	          1000,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( scratch_overlay != NULL )
+	{
+		libqcow_scratch_overlay_free(
+		 &scratch_overlay,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_scratch_overlay_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_scratch_overlay_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_scratch_overlay_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests adding, writing and reading blocks of a scratch overlay
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_scratch_overlay_read_write(
+     libbfio_handle_t *file_io_handle )
+{
+	uint8_t block_data[ 512 ];
+	uint8_t buffer[ 1536 ];
+	uint8_t zero_bitmap[ 1 ];
+
+	libcerror_error_t *error                   = NULL;
+	libqcow_scratch_overlay_t *scratch_overlay = NULL;
+	uint64_t block_index                       = 0;
+	size_t buffer_offset                       = 0;
+	int entry_index                            = 0;
+	int result                                 = 0;
+
+	result = libqcow_scratch_overlay_initialize(
+	          &scratch_overlay,
+	          512,
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Add the odd blocks so that the overlay contains more blocks than hash buckets
+	 */
+	for( block_index = 0;
+	     block_index < QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS;
+	     block_index++ )
+	{
+		if( memory_set(
+		     block_data,
+		     (int) ( ( block_index * 2 ) + 1 ) & 0xff,
+		     512 ) == NULL )
+		{
+			goto on_error;
+		}
+		result = libqcow_scratch_overlay_append_block(
+		          scratch_overlay,
+		          ( block_index * 2 ) + 1,
+		          block_data,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+	}
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "scratch_overlay->number_of_entries",
+	 scratch_overlay->number_of_entries,
+	 QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS );
+
+	result = libqcow_scratch_overlay_get_entry_index(
+	          scratch_overlay,
+	          599,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "entry_index",
+	 entry_index,
+	 299 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_scratch_overlay_get_entry_index(
+	          scratch_overlay,
+	          598,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Modify part of block 3
+	 */
+	if( memory_set(
+	     block_data,
+	     0xaa,
+	     16 ) == NULL )
+	{
+		goto on_error;
+	}
+	result = libqcow_scratch_overlay_get_entry_index(
+	          scratch_overlay,
+	          3,
+	          &entry_index,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_scratch_overlay_write_entry_data(
+	          scratch_overlay,
+	          entry_index,
+	          100,
+	          block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Read blocks 2 to 4 where only block 3 is in the scratch overlay
+	 */
+	if( memory_set(
+	     buffer,
+	     0,
+	     1536 ) == NULL )
+	{
+		goto on_error;
+	}
+	zero_bitmap[ 0 ] = 0x07;
+
+	result = libqcow_scratch_overlay_read_buffer_at_offset(
+	          scratch_overlay,
+	          2 * 512,
+	          buffer,
+	          1536,
+	          zero_bitmap,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "zero_bitmap[ 0 ]",
+	 (int) zero_bitmap[ 0 ],
+	 0x05 );
+
+	for( buffer_offset = 0;
+	     buffer_offset < 1536;
+	     buffer_offset++ )
+	{
+		if( ( buffer_offset >= 612 )
+		 && ( buffer_offset < 628 ) )
+		{
+			result = (int) ( buffer[ buffer_offset ] == 0xaa );
+		}
+		else if( ( buffer_offset >= 512 )
+		      && ( buffer_offset < 1024 ) )
+		{
+			result = (int) ( buffer[ buffer_offset ] == 0x03 );
+		}
+		else
+		{
+			result = (int) ( buffer[ buffer_offset ] == 0 );
+		}
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+	}
+	/* Test error cases
+	 */
+	result = libqcow_scratch_overlay_write_entry_data(
+	          scratch_overlay,
+	          QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS,
+	          0,
+	          block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_scratch_overlay_write_entry_data(
+	          scratch_overlay,
+	          0,
+	          500,
+	          block_data,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_scratch_overlay_read_buffer_at_offset(
+	          scratch_overlay,
+	          -1,
+	          buffer,
+	          1536,
+	          NULL,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up, the scratch overlay frees the file IO handle
+	 */
+	result = libqcow_scratch_overlay_free(
+	          &scratch_overlay,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( scratch_overlay != NULL )
+	{
+		libqcow_scratch_overlay_free(
+		 &scratch_overlay,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests adding, writing and reading blocks of a scratch overlay in memory
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_scratch_overlay_read_write_memory(
+     void )
+{
+	return( qcow_test_scratch_overlay_read_write(
+	         NULL ) );
+}
+
+/* Tests adding, writing and reading blocks of a scratch overlay in a scratch file
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_scratch_overlay_read_write_file(
+     void )
+{
+	libbfio_handle_t *file_io_handle = NULL;
+	libcerror_error_t *error         = NULL;
+	int result                       = 0;
+
+	result = libbfio_memory_range_initialize(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_memory_range_set(
+	          file_io_handle,
+	          qcow_test_scratch_overlay_file_data,
+	          QCOW_TEST_SCRATCH_OVERLAY_NUMBER_OF_BLOCKS * 512,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libbfio_handle_open(
+	          file_io_handle,
+	          LIBBFIO_OPEN_READ_WRITE,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = qcow_test_scratch_overlay_read_write(
+	          file_io_handle );
+
+	file_io_handle = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_scratch_overlay_initialize",
+	 qcow_test_scratch_overlay_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_scratch_overlay_free",
+	 qcow_test_scratch_overlay_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_scratch_overlay_read_write in memory",
+	 qcow_test_scratch_overlay_read_write_memory );
+
+	QCOW_TEST_RUN(
+	 "libqcow_scratch_overlay_read_write in scratch file",
+	 qcow_test_scratch_overlay_read_write_file );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
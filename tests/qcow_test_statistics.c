@@ -0,0 +1,1142 @@
+/*
+ * Library statistics type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_statistics.h"
+
+#define QCOW_TEST_LATENCY_OPERATION_DECRYPT		4
+#define QCOW_TEST_NUMBER_OF_LATENCY_OPERATIONS		5
+#define QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS	976
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_statistics_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_statistics_initialize(
+     void )
+{
+	libcerror_error_t *error         = NULL;
+	libqcow_statistics_t *statistics = NULL;
+	int result                       = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests  = 1;
+	int number_of_memset_fail_tests  = 1;
+	int test_number                  = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_statistics_initialize(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "statistics",
+	 statistics );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_statistics_free(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "statistics",
+	 statistics );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_statistics_initialize(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	statistics = (libqcow_statistics_t *) 0x12345678UL;
+
+	result = libqcow_statistics_initialize(
+	          &statistics,
+	          &error );
+
+	statistics = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_statistics_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_statistics_initialize(
+		          &statistics,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( statistics != NULL )
+			{
+				libqcow_statistics_free(
+				 &statistics,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "statistics",
+			 statistics );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_statistics_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_statistics_initialize(
+		          &statistics,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( statistics != NULL )
+			{
+				libqcow_statistics_free(
+				 &statistics,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "statistics",
+			 statistics );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( statistics != NULL )
+	{
+		libqcow_statistics_free(
+		 &statistics,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_statistics_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_statistics_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_statistics_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_statistics_get_values and libqcow_statistics_clear functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_statistics_get_values(
+     void )
+{
+	uint64_t values[ 16 ];
+
+	libcerror_error_t *error         = NULL;
+	libqcow_statistics_t *statistics = NULL;
+	int result                       = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_statistics_initialize(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "statistics",
+	 statistics );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	LIBQCOW_STATISTICS_ADD( statistics->level2_table_cache_lookups, 5 );
+	LIBQCOW_STATISTICS_ADD( statistics->level2_table_cache_misses, 2 );
+	LIBQCOW_STATISTICS_ADD( statistics->cluster_block_cache_lookups, 3 );
+	LIBQCOW_STATISTICS_ADD( statistics->cluster_block_cache_misses, 3 );
+	LIBQCOW_STATISTICS_ADD( statistics->host_bytes_read, 65536 );
+	LIBQCOW_STATISTICS_ADD( statistics->decryption_time, 1000 );
+
+	/* Test regular cases
+	 */
+	values[ 14 ] = 0xffffffffffffffffUL;
+	values[ 15 ] = 0xffffffffffffffffUL;
+
+	result = libqcow_statistics_get_values(
+	          statistics,
+	          values,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_cache_hits",
+	 values[ 0 ],
+	 (uint64_t) 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_cache_misses",
+	 values[ 1 ],
+	 (uint64_t) 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_cache_hits",
+	 values[ 2 ],
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_cache_misses",
+	 values[ 3 ],
+	 (uint64_t) 3 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "host_bytes_read",
+	 values[ 7 ],
+	 (uint64_t) 65536 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "decryption_time",
+	 values[ 13 ],
+	 (uint64_t) 1000 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "values[ 14 ]",
+	 values[ 14 ],
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "values[ 15 ]",
+	 values[ 15 ],
+	 (uint64_t) 0 );
+
+	/* Test with fewer values than statistics
+	 */
+	values[ 1 ] = 0xffffffffffffffffUL;
+
+	result = libqcow_statistics_get_values(
+	          statistics,
+	          values,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "values[ 1 ]",
+	 values[ 1 ],
+	 (uint64_t) 0xffffffffffffffffUL );
+
+	/* Test clear
+	 */
+	result = libqcow_statistics_clear(
+	          statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_statistics_get_values(
+	          statistics,
+	          values,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "level2_table_cache_hits",
+	 values[ 0 ],
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "host_bytes_read",
+	 values[ 7 ],
+	 (uint64_t) 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_statistics_get_values(
+	          NULL,
+	          values,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_values(
+	          statistics,
+	          NULL,
+	          16,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_values(
+	          statistics,
+	          values,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_clear(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_statistics_free(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "statistics",
+	 statistics );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( statistics != NULL )
+	{
+		libqcow_statistics_free(
+		 &statistics,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_statistics_get_latency_bucket_index and libqcow_statistics_get_latency_bucket_bounds functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_statistics_get_latency_bucket_bounds(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	uint64_t latency         = 0;
+	uint64_t lower_bound     = 0;
+	uint64_t previous_bound  = 0;
+	uint64_t upper_bound     = 0;
+	int bucket_index         = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 */
+	for( bucket_index = 0;
+	     bucket_index < QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+	     bucket_index++ )
+	{
+		result = libqcow_statistics_get_latency_bucket_bounds(
+		          bucket_index,
+		          &lower_bound,
+		          &upper_bound,
+		          &error );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "result",
+		 result,
+		 1 );
+
+		QCOW_TEST_ASSERT_IS_NULL(
+		 "error",
+		 error );
+
+		/* The buckets are contiguous
+		 */
+		if( bucket_index > 0 )
+		{
+			QCOW_TEST_ASSERT_EQUAL_UINT64(
+			 "lower_bound",
+			 lower_bound,
+			 previous_bound + 1 );
+		}
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "lower_bound bucket index",
+		 libqcow_statistics_get_latency_bucket_index(
+		  lower_bound ),
+		 bucket_index );
+
+		QCOW_TEST_ASSERT_EQUAL_INT(
+		 "upper_bound bucket index",
+		 libqcow_statistics_get_latency_bucket_index(
+		  upper_bound ),
+		 bucket_index );
+
+		previous_bound = upper_bound;
+	}
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "upper_bound",
+	 upper_bound,
+	 (uint64_t) 0xffffffffffffffffUL );
+
+	/* The size of a bucket is at most 1/16 of its lower bound
+	 */
+	latency = 1000000;
+
+	bucket_index = libqcow_statistics_get_latency_bucket_index(
+	                latency );
+
+	result = libqcow_statistics_get_latency_bucket_bounds(
+	          bucket_index,
+	          &lower_bound,
+	          &upper_bound,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "lower_bound",
+	 lower_bound,
+	 (uint64_t) 983040 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "upper_bound",
+	 upper_bound,
+	 (uint64_t) 1015807 );
+
+	QCOW_TEST_ASSERT_LESS_THAN_UINT64(
+	 "bucket size",
+	 ( upper_bound - lower_bound + 1 ) * 16,
+	 lower_bound + 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_statistics_get_latency_bucket_bounds(
+	          -1,
+	          &lower_bound,
+	          &upper_bound,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_bucket_bounds(
+	          QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS,
+	          &lower_bound,
+	          &upper_bound,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_bucket_bounds(
+	          0,
+	          NULL,
+	          &upper_bound,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_bucket_bounds(
+	          0,
+	          &lower_bound,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_statistics_get_latency_percentile function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_statistics_get_latency_percentile(
+     void )
+{
+	uint64_t counts[ QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS + 1 ];
+
+	libcerror_error_t *error         = NULL;
+	libqcow_statistics_t *statistics = NULL;
+	uint64_t latency                 = 0;
+	uint64_t number_of_values        = 0;
+	uint64_t total_count             = 0;
+	int bucket_index                 = 0;
+	int result                       = 0;
+	int value_index                  = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_statistics_initialize(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "statistics",
+	 statistics );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test without recorded latencies
+	 */
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          99.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "number_of_values",
+	 number_of_values,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "latency",
+	 latency,
+	 (uint64_t) 0 );
+
+	/* Test regular cases with latencies of 1 to 100 and one outlier
+	 */
+	for( value_index = 1;
+	     value_index <= 99;
+	     value_index++ )
+	{
+		libqcow_statistics_add_latency(
+		 statistics,
+		 QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+		 (uint64_t) value_index );
+	}
+	libqcow_statistics_add_latency(
+	 statistics,
+	 QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	 1000000 );
+
+	/* Latencies of unsupported operations are ignored
+	 */
+	libqcow_statistics_add_latency(
+	 statistics,
+	 -1,
+	 10 );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          50.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "number_of_values",
+	 number_of_values,
+	 (uint64_t) 100 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "latency",
+	 latency,
+	 (uint64_t) 51 );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          100.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "latency",
+	 latency,
+	 (uint64_t) 1015807 );
+
+	result = libqcow_statistics_get_latency_histogram(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          counts,
+	          QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS + 1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	for( bucket_index = 0;
+	     bucket_index < QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS;
+	     bucket_index++ )
+	{
+		total_count += counts[ bucket_index ];
+	}
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "total_count",
+	 total_count,
+	 (uint64_t) 100 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "counts[ 0 ]",
+	 counts[ 0 ],
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "counts[ 1 ]",
+	 counts[ 1 ],
+	 (uint64_t) 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "counts[ QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ]",
+	 counts[ QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS ],
+	 (uint64_t) 0 );
+
+	/* Test clear
+	 */
+	result = libqcow_statistics_clear(
+	          statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          50.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "number_of_values",
+	 number_of_values,
+	 (uint64_t) 0 );
+
+	/* Test error cases
+	 */
+	result = libqcow_statistics_get_latency_percentile(
+	          NULL,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          50.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_NUMBER_OF_LATENCY_OPERATIONS,
+	          50.0,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          100.5,
+	          &number_of_values,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          50.0,
+	          NULL,
+	          &latency,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_percentile(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          50.0,
+	          &number_of_values,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_histogram(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          NULL,
+	          QCOW_TEST_LATENCY_HISTOGRAM_NUMBER_OF_BUCKETS,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_statistics_get_latency_histogram(
+	          statistics,
+	          QCOW_TEST_LATENCY_OPERATION_DECRYPT,
+	          counts,
+	          -1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_statistics_free(
+	          &statistics,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( statistics != NULL )
+	{
+		libqcow_statistics_free(
+		 &statistics,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_statistics_initialize",
+	 qcow_test_statistics_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_statistics_free",
+	 qcow_test_statistics_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_statistics_get_values",
+	 qcow_test_statistics_get_values );
+
+	QCOW_TEST_RUN(
+	 "libqcow_statistics_get_latency_bucket_bounds",
+	 qcow_test_statistics_get_latency_bucket_bounds );
+
+	QCOW_TEST_RUN(
+	 "libqcow_statistics_get_latency_percentile",
+	 qcow_test_statistics_get_latency_percentile );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -492,6 +492,46 @@ on_error:
 	return( 0 );
 }
 
+/* Tests the libqcow_get_encryption_backend function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_get_encryption_backend(
+     void )
+{
+	const char *backend_name = NULL;
+
+	backend_name = libqcow_get_encryption_backend();
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "backend_name",
+	 backend_name );
+
+	return( 1 );
+
+on_error:
+	return( 0 );
+}
+
+/* Tests the libqcow_get_decompression_backend function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_get_decompression_backend(
+     void )
+{
+	const char *backend_name = NULL;
+
+	backend_name = libqcow_get_decompression_backend();
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "backend_name",
+	 backend_name );
+
+	return( 1 );
+
+on_error:
+	return( 0 );
+}
+
 /* Tests the libqcow_get_codepage function
  * Returns 1 if successful or 0 if not
  */
@@ -595,6 +635,38 @@ on_error:
 	return( 0 );
 }
 
+/* Tests the libqcow_clear_key_cache function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_clear_key_cache(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	result = libqcow_clear_key_cache(
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
 /* Tests the libqcow_check_file_signature function
  * Returns 1 if successful or 0 if not
  */
@@ -1048,6 +1120,14 @@ int main(
 	 "libqcow_get_access_flags_read",
 	 qcow_test_get_access_flags_read );
 
+	QCOW_TEST_RUN(
+	 "libqcow_get_encryption_backend",
+	 qcow_test_get_encryption_backend );
+
+	QCOW_TEST_RUN(
+	 "libqcow_get_decompression_backend",
+	 qcow_test_get_decompression_backend );
+
 	QCOW_TEST_RUN(
 	 "libqcow_get_codepage",
 	 qcow_test_get_codepage );
@@ -1056,6 +1136,10 @@ int main(
 	 "libqcow_set_codepage",
 	 qcow_test_set_codepage );
 
+	QCOW_TEST_RUN(
+	 "libqcow_clear_key_cache",
+	 qcow_test_clear_key_cache );
+
 #if !defined( __BORLANDC__ ) || ( __BORLANDC__ >= 0x0560 )
 	if( source != NULL )
 	{
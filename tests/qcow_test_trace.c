@@ -0,0 +1,340 @@
+/*
+ * Library trace functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_trace.h"
+
+#define QCOW_TEST_TRACE_EVENT_DECOMPRESS	2
+#define QCOW_TEST_TRACE_EVENT_HOST_READ_ISSUED	4
+
+#if defined( __GNUC__ )
+
+/* The values of the last traced event
+ */
+typedef struct qcow_test_trace_values qcow_test_trace_values_t;
+
+struct qcow_test_trace_values
+{
+	/* The number of events
+	 */
+	int number_of_events;
+
+	/* The event
+	 */
+	int event;
+
+	/* The offset
+	 */
+	uint64_t offset;
+
+	/* The size
+	 */
+	uint64_t size;
+
+	/* The duration
+	 */
+	uint64_t duration;
+};
+
+/* Records a traced event
+ */
+void qcow_test_trace_callback(
+      int event,
+      uint64_t offset,
+      uint64_t size,
+      uint64_t duration,
+      void *user_data )
+{
+	qcow_test_trace_values_t *trace_values = (qcow_test_trace_values_t *) user_data;
+
+	if( trace_values == NULL )
+	{
+		return;
+	}
+	trace_values->number_of_events += 1;
+	trace_values->event             = event;
+	trace_values->offset            = offset;
+	trace_values->size              = size;
+	trace_values->duration          = duration;
+}
+
+/* Tests the libqcow_trace_set_callback function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_trace_set_callback(
+     void )
+{
+	qcow_test_trace_values_t trace_values;
+
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	trace_values.number_of_events = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_trace_set_callback(
+	          &qcow_test_trace_callback,
+	          &trace_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = LIBQCOW_TRACE_CALLBACK_IS_SET();
+
+	QCOW_TEST_ASSERT_NOT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_trace_set_callback(
+	          NULL,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = LIBQCOW_TRACE_CALLBACK_IS_SET();
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.number_of_events",
+	 trace_values.number_of_events,
+	 0 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	libqcow_trace_set_callback(
+	 NULL,
+	 NULL,
+	 NULL );
+
+	return( 0 );
+}
+
+/* Tests the libqcow_trace_event function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_trace_event(
+     void )
+{
+	qcow_test_trace_values_t trace_values;
+
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	trace_values.number_of_events = 0;
+
+	/* Test an event without a callback function
+	 */
+	libqcow_trace_event(
+	 QCOW_TEST_TRACE_EVENT_HOST_READ_ISSUED,
+	 4096,
+	 512,
+	 0 );
+
+	/* Test regular cases
+	 */
+	result = libqcow_trace_set_callback(
+	          &qcow_test_trace_callback,
+	          &trace_values,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	libqcow_trace_event(
+	 QCOW_TEST_TRACE_EVENT_HOST_READ_ISSUED,
+	 4096,
+	 512,
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.number_of_events",
+	 trace_values.number_of_events,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.event",
+	 trace_values.event,
+	 QCOW_TEST_TRACE_EVENT_HOST_READ_ISSUED );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "trace_values.offset",
+	 trace_values.offset,
+	 (uint64_t) 4096 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "trace_values.size",
+	 trace_values.size,
+	 (uint64_t) 512 );
+
+	/* Test a trace point
+	 */
+	LIBQCOW_TRACE(
+	 decompress,
+	 QCOW_TEST_TRACE_EVENT_DECOMPRESS,
+	 0,
+	 65536,
+	 1000 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.number_of_events",
+	 trace_values.number_of_events,
+	 2 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.event",
+	 trace_values.event,
+	 QCOW_TEST_TRACE_EVENT_DECOMPRESS );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "trace_values.size",
+	 trace_values.size,
+	 (uint64_t) 65536 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "trace_values.duration",
+	 trace_values.duration,
+	 (uint64_t) 1000 );
+
+	/* Test that no events are traced after the callback function was removed
+	 */
+	result = libqcow_trace_set_callback(
+	          NULL,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	LIBQCOW_TRACE(
+	 decompress,
+	 QCOW_TEST_TRACE_EVENT_DECOMPRESS,
+	 0,
+	 65536,
+	 1000 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "trace_values.number_of_events",
+	 trace_values.number_of_events,
+	 2 );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	libqcow_trace_set_callback(
+	 NULL,
+	 NULL,
+	 NULL );
+
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_trace_set_callback",
+	 qcow_test_trace_set_callback );
+
+	QCOW_TEST_RUN(
+	 "libqcow_trace_event",
+	 qcow_test_trace_event );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,809 @@
+/*
+ * Library translation_cache type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_translation_cache.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_translation_cache_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_translation_cache_initialize(
+     void )
+{
+	libcerror_error_t *error                       = NULL;
+	libqcow_translation_cache_t *translation_cache = NULL;
+	int result                                     = 0;
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+	int number_of_malloc_fail_tests                = 2;
+	int number_of_memset_fail_tests                = 2;
+	int test_number                                = 0;
+#endif
+
+	/* Test regular cases
+	 */
+	result = libqcow_translation_cache_initialize(
+	          &translation_cache,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The number of entries is rounded up to a power of 2
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "translation_cache->number_of_entries",
+	 translation_cache->number_of_entries,
+	 32 );
+
+	result = libqcow_translation_cache_free(
+	          &translation_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_translation_cache_initialize(
+	          NULL,
+	          20,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	translation_cache = (libqcow_translation_cache_t *) 0x12345678UL;
+
+	result = libqcow_translation_cache_initialize(
+	          &translation_cache,
+	          20,
+	          &error );
+
+	translation_cache = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_translation_cache_initialize(
+	          &translation_cache,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+#if defined( HAVE_QCOW_TEST_MEMORY )
+
+	for( test_number = 0;
+	     test_number < number_of_malloc_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_translation_cache_initialize with malloc failing
+		 */
+		qcow_test_malloc_attempts_before_fail = test_number;
+
+		result = libqcow_translation_cache_initialize(
+		          &translation_cache,
+		          20,
+		          &error );
+
+		if( qcow_test_malloc_attempts_before_fail != -1 )
+		{
+			qcow_test_malloc_attempts_before_fail = -1;
+
+			if( translation_cache != NULL )
+			{
+				libqcow_translation_cache_free(
+				 &translation_cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "translation_cache",
+			 translation_cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+	for( test_number = 0;
+	     test_number < number_of_memset_fail_tests;
+	     test_number++ )
+	{
+		/* Test libqcow_translation_cache_initialize with memset failing
+		 */
+		qcow_test_memset_attempts_before_fail = test_number;
+
+		result = libqcow_translation_cache_initialize(
+		          &translation_cache,
+		          20,
+		          &error );
+
+		if( qcow_test_memset_attempts_before_fail != -1 )
+		{
+			qcow_test_memset_attempts_before_fail = -1;
+
+			if( translation_cache != NULL )
+			{
+				libqcow_translation_cache_free(
+				 &translation_cache,
+				 NULL );
+			}
+		}
+		else
+		{
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 -1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "translation_cache",
+			 translation_cache );
+
+			QCOW_TEST_ASSERT_IS_NOT_NULL(
+			 "error",
+			 error );
+
+			libcerror_error_free(
+			 &error );
+		}
+	}
+#endif /* defined( HAVE_QCOW_TEST_MEMORY ) */
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( translation_cache != NULL )
+	{
+		libqcow_translation_cache_free(
+		 &translation_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_translation_cache_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_translation_cache_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_translation_cache_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_translation_cache_get_reference and libqcow_translation_cache_set_reference functions
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_translation_cache_get_reference(
+     void )
+{
+	libcerror_error_t *error                       = NULL;
+	libqcow_translation_cache_t *translation_cache = NULL;
+	uint64_t cluster_block_reference               = 0;
+	int result                                     = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_translation_cache_initialize(
+	          &translation_cache,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          0,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          1,
+	          0x00050000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          1,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0x00050000UL );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* A sparse cluster block is cached with a reference of 0
+	 */
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          2,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          2,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0 );
+
+	/* An index that maps onto the same entry replaces the reference
+	 */
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          5,
+	          0x00090000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          1,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          5,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0x00090000UL );
+
+	result = libqcow_translation_cache_clear(
+	          translation_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          5,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_translation_cache_get_reference(
+	          NULL,
+	          1,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          1,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_translation_cache_set_reference(
+	          NULL,
+	          1,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          (uint64_t) UINT64_MAX,
+	          0,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_translation_cache_clear(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_translation_cache_free(
+	          &translation_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( translation_cache != NULL )
+	{
+		libqcow_translation_cache_free(
+		 &translation_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_translation_cache_clear function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_translation_cache_clear(
+     void )
+{
+	libcerror_error_t *error                       = NULL;
+	libqcow_translation_cache_t *translation_cache = NULL;
+	uint64_t cluster_block_reference               = 0;
+	int result                                     = 0;
+
+	/* Initialize test
+	 */
+	result = libqcow_translation_cache_initialize(
+	          &translation_cache,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          1,
+	          0x00050000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_translation_cache_clear(
+	          translation_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          1,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* An entry can be set again after the clear
+	 */
+	result = libqcow_translation_cache_set_reference(
+	          translation_cache,
+	          1,
+	          0x00070000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	result = libqcow_translation_cache_get_reference(
+	          translation_cache,
+	          1,
+	          &cluster_block_reference,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "cluster_block_reference",
+	 cluster_block_reference,
+	 (uint64_t) 0x00070000UL );
+
+	/* Test error cases
+	 */
+	result = libqcow_translation_cache_clear(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_translation_cache_free(
+	          &translation_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "translation_cache",
+	 translation_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( translation_cache != NULL )
+	{
+		libqcow_translation_cache_free(
+		 &translation_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_translation_cache_initialize",
+	 qcow_test_translation_cache_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_translation_cache_free",
+	 qcow_test_translation_cache_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_translation_cache_get_reference",
+	 qcow_test_translation_cache_get_reference );
+
+	QCOW_TEST_RUN(
+	 "libqcow_translation_cache_clear",
+	 qcow_test_translation_cache_clear );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
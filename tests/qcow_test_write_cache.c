@@ -0,0 +1,701 @@
+/*
+ * Library write_cache type test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libbfio.h"
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_memory.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_definitions.h"
+#include "../libqcow/libqcow_write_cache.h"
+
+#if defined( __GNUC__ )
+
+/* The test file consists of 512 clusters of 512 bytes, the first 3 clusters
+ * are used and contain the header, the reference count table and a reference
+ * count block
+ */
+#define QCOW_TEST_WRITE_CACHE_FILE_SIZE	( 512 * 512 )
+
+uint8_t qcow_test_write_cache_file_data[ QCOW_TEST_WRITE_CACHE_FILE_SIZE ];
+
+/* Opens a file IO handle of the test file
+ * Returns 1 if successful or -1 on error
+ */
+int qcow_test_write_cache_open_file_io_handle(
+     libbfio_handle_t **file_io_handle,
+     libcerror_error_t **error )
+{
+	int cluster_index = 0;
+
+	if( memory_set(
+	     qcow_test_write_cache_file_data,
+	     0,
+	     sizeof( uint8_t ) * QCOW_TEST_WRITE_CACHE_FILE_SIZE ) == NULL )
+	{
+		return( -1 );
+	}
+	/* The reference count table at offset 512 references
+	 * the reference count block at offset 1024
+	 */
+	qcow_test_write_cache_file_data[ 512 + 6 ] = 0x04;
+
+	for( cluster_index = 0;
+	     cluster_index < 3;
+	     cluster_index++ )
+	{
+		qcow_test_write_cache_file_data[ 1024 + ( cluster_index * 2 ) + 1 ] = 0x01;
+	}
+	if( libbfio_memory_range_initialize(
+	     file_io_handle,
+	     error ) != 1 )
+	{
+		return( -1 );
+	}
+	if( libbfio_memory_range_set(
+	     *file_io_handle,
+	     qcow_test_write_cache_file_data,
+	     QCOW_TEST_WRITE_CACHE_FILE_SIZE,
+	     error ) != 1 )
+	{
+		libbfio_handle_free(
+		 file_io_handle,
+		 NULL );
+
+		return( -1 );
+	}
+	if( libbfio_handle_open(
+	     *file_io_handle,
+	     LIBBFIO_OPEN_READ_WRITE,
+	     error ) != 1 )
+	{
+		libbfio_handle_free(
+		 file_io_handle,
+		 NULL );
+
+		return( -1 );
+	}
+	return( 1 );
+}
+
+/* Tests the libqcow_write_cache_initialize function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_write_cache_initialize(
+     void )
+{
+	libcerror_error_t *error           = NULL;
+	libqcow_write_cache_t *write_cache = NULL;
+	int result                         = 0;
+
+	/* Test regular cases
+	 */
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          512,
+	          4,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "write_cache",
+	 write_cache );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "write_cache->number_of_reference_counts_per_block",
+	 write_cache->number_of_reference_counts_per_block,
+	 (uint64_t) 256 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "write_cache->maximum_reference_count",
+	 write_cache->maximum_reference_count,
+	 (uint64_t) 0xffffUL );
+
+	result = libqcow_write_cache_free(
+	          &write_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test error cases
+	 */
+	result = libqcow_write_cache_initialize(
+	          NULL,
+	          512,
+	          4,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	write_cache = (libqcow_write_cache_t *) 0x12345678UL;
+
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          512,
+	          4,
+	          4,
+	          &error );
+
+	write_cache = NULL;
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          500,
+	          4,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          512,
+	          7,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          512,
+	          4,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( write_cache != NULL )
+	{
+		libqcow_write_cache_free(
+		 &write_cache,
+		 NULL );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_write_cache_free function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_write_cache_free(
+     void )
+{
+	libcerror_error_t *error = NULL;
+	int result               = 0;
+
+	/* Test error cases
+	 */
+	result = libqcow_write_cache_free(
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+/* Tests the libqcow_write_cache_allocate_cluster function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_write_cache_allocate_cluster(
+     void )
+{
+	libbfio_handle_t *file_io_handle   = NULL;
+	libcerror_error_t *error           = NULL;
+	libqcow_write_cache_t *write_cache = NULL;
+	off64_t cluster_offset             = 0;
+	uint64_t reference_count           = 0;
+	int result                         = 0;
+
+	/* Initialize test
+	 */
+	result = qcow_test_write_cache_open_file_io_handle(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_initialize(
+	          &write_cache,
+	          512,
+	          4,
+	          4,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_read_reference_count_table(
+	          write_cache,
+	          file_io_handle,
+	          512,
+	          1,
+	          1536,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* Test regular cases
+	 */
+	result = libqcow_write_cache_allocate_cluster(
+	          write_cache,
+	          file_io_handle,
+	          &cluster_offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "cluster_offset",
+	 cluster_offset,
+	 (off64_t) 1536 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The reference count is stored before the cluster is allocated
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_write_cache_file_data[ 1024 + 7 ]",
+	 qcow_test_write_cache_file_data[ 1024 + 7 ],
+	 1 );
+
+	/* The second reference count block is stored in the first cluster it describes
+	 */
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_write_cache_file_data[ 512 + 8 + 5 ]",
+	 qcow_test_write_cache_file_data[ 512 + 8 + 5 ],
+	 0x02 );
+
+	result = libqcow_write_cache_allocate_cluster(
+	          write_cache,
+	          file_io_handle,
+	          &cluster_offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT64(
+	 "cluster_offset",
+	 cluster_offset,
+	 (off64_t) 2048 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_release_cluster(
+	          write_cache,
+	          3,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_flush(
+	          write_cache,
+	          file_io_handle,
+	          1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	/* The released cluster and the reserved clusters that were not allocated are freed
+	 */
+	result = libqcow_write_cache_get_reference_count(
+	          write_cache,
+	          file_io_handle,
+	          3,
+	          &reference_count,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference_count",
+	 reference_count,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_get_reference_count(
+	          write_cache,
+	          file_io_handle,
+	          4,
+	          &reference_count,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference_count",
+	 reference_count,
+	 (uint64_t) 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libqcow_write_cache_get_reference_count(
+	          write_cache,
+	          file_io_handle,
+	          5,
+	          &reference_count,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_EQUAL_UINT64(
+	 "reference_count",
+	 reference_count,
+	 (uint64_t) 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_write_cache_file_data[ 1024 + 7 ]",
+	 qcow_test_write_cache_file_data[ 1024 + 7 ],
+	 0 );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "qcow_test_write_cache_file_data[ 1024 + 9 ]",
+	 qcow_test_write_cache_file_data[ 1024 + 9 ],
+	 1 );
+
+	/* Test error cases
+	 */
+	result = libqcow_write_cache_allocate_cluster(
+	          NULL,
+	          file_io_handle,
+	          &cluster_offset,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_write_cache_allocate_cluster(
+	          write_cache,
+	          file_io_handle,
+	          NULL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_write_cache_set_reference_count(
+	          write_cache,
+	          file_io_handle,
+	          3,
+	          0x10000UL,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	/* Clean up
+	 */
+	result = libqcow_write_cache_free(
+	          &write_cache,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_close(
+	          file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 0 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	result = libbfio_handle_free(
+	          &file_io_handle,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 1 );
+
+	QCOW_TEST_ASSERT_IS_NULL(
+	 "error",
+	 error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	if( write_cache != NULL )
+	{
+		libqcow_write_cache_free(
+		 &write_cache,
+		 NULL );
+	}
+	if( file_io_handle != NULL )
+	{
+		libbfio_handle_free(
+		 &file_io_handle,
+		 NULL );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_write_cache_initialize",
+	 qcow_test_write_cache_initialize );
+
+	QCOW_TEST_RUN(
+	 "libqcow_write_cache_free",
+	 qcow_test_write_cache_free );
+
+	QCOW_TEST_RUN(
+	 "libqcow_write_cache_allocate_cluster",
+	 qcow_test_write_cache_allocate_cluster );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
@@ -0,0 +1,208 @@
+/*
+ * Library zero_block functions test program
+ *
+ * Copyright (C) 2010-2017, Joachim Metz <joachim.metz@gmail.com>
+ *
+ * Refer to AUTHORS for acknowledgements.
+ *
+ * This software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <file_stream.h>
+#include <memory.h>
+#include <types.h>
+
+#if defined( HAVE_STDLIB_H ) || defined( WINAPI )
+#include <stdlib.h>
+#endif
+
+#include "qcow_test_libcerror.h"
+#include "qcow_test_libqcow.h"
+#include "qcow_test_macros.h"
+#include "qcow_test_unused.h"
+
+#include "../libqcow/libqcow_zero_block.h"
+
+#if defined( __GNUC__ )
+
+/* Tests the libqcow_zero_block_is_zero function
+ * Returns 1 if successful or 0 if not
+ */
+int qcow_test_zero_block_is_zero(
+     void )
+{
+	uint8_t data[ 1024 + 3 ];
+
+	libcerror_error_t *error = NULL;
+	size_t data_offset       = 0;
+	size_t data_size         = 0;
+	size_t byte_offset       = 0;
+	int result               = 0;
+
+	/* Test regular cases
+	 * Sizes and offsets that are not a multiple of the vector size are used
+	 * to test the bytes remaining before and after the vectorized check
+	 */
+	for( data_offset = 0;
+	     data_offset < 3;
+	     data_offset++ )
+	{
+		for( data_size = 0;
+		     data_size <= 1024;
+		     data_size += 61 )
+		{
+			if( memory_set(
+			     data,
+			     0,
+			     1024 + 3 ) == NULL )
+			{
+				goto on_error;
+			}
+			result = libqcow_zero_block_is_zero(
+			          &( data[ data_offset ] ),
+			          data_size,
+			          &error );
+
+			QCOW_TEST_ASSERT_EQUAL_INT(
+			 "result",
+			 result,
+			 1 );
+
+			QCOW_TEST_ASSERT_IS_NULL(
+			 "error",
+			 error );
+
+			for( byte_offset = 0;
+			     byte_offset < data_size;
+			     byte_offset++ )
+			{
+				data[ data_offset + byte_offset ] = 0x80;
+
+				result = libqcow_zero_block_is_zero(
+				          &( data[ data_offset ] ),
+				          data_size,
+				          &error );
+
+				QCOW_TEST_ASSERT_EQUAL_INT(
+				 "result",
+				 result,
+				 0 );
+
+				QCOW_TEST_ASSERT_IS_NULL(
+				 "error",
+				 error );
+
+				data[ data_offset + byte_offset ] = 0;
+			}
+			/* The byte after the data must not be checked
+			 */
+			if( ( data_offset + data_size ) < ( 1024 + 3 ) )
+			{
+				data[ data_offset + data_size ] = 0x01;
+
+				result = libqcow_zero_block_is_zero(
+				          &( data[ data_offset ] ),
+				          data_size,
+				          &error );
+
+				QCOW_TEST_ASSERT_EQUAL_INT(
+				 "result",
+				 result,
+				 1 );
+
+				QCOW_TEST_ASSERT_IS_NULL(
+				 "error",
+				 error );
+			}
+		}
+	}
+	/* Test error cases
+	 */
+	result = libqcow_zero_block_is_zero(
+	          NULL,
+	          1024,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	result = libqcow_zero_block_is_zero(
+	          data,
+	          (size_t) SSIZE_MAX + 1,
+	          &error );
+
+	QCOW_TEST_ASSERT_EQUAL_INT(
+	 "result",
+	 result,
+	 -1 );
+
+	QCOW_TEST_ASSERT_IS_NOT_NULL(
+	 "error",
+	 error );
+
+	libcerror_error_free(
+	 &error );
+
+	return( 1 );
+
+on_error:
+	if( error != NULL )
+	{
+		libcerror_error_free(
+		 &error );
+	}
+	return( 0 );
+}
+
+#endif /* defined( __GNUC__ ) */
+
+/* The main program
+ */
+#if defined( HAVE_WIDE_SYSTEM_CHARACTER )
+int wmain(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     wchar_t * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#else
+int main(
+     int argc QCOW_TEST_ATTRIBUTE_UNUSED,
+     char * const argv[] QCOW_TEST_ATTRIBUTE_UNUSED )
+#endif
+{
+	QCOW_TEST_UNREFERENCED_PARAMETER( argc )
+	QCOW_TEST_UNREFERENCED_PARAMETER( argv )
+
+#if defined( __GNUC__ )
+
+	QCOW_TEST_RUN(
+	 "libqcow_zero_block_is_zero",
+	 qcow_test_zero_block_is_zero );
+
+#endif /* defined( __GNUC__ ) */
+
+	return( EXIT_SUCCESS );
+
+on_error:
+	return( EXIT_FAILURE );
+}
+
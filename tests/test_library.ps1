@@ -10,7 +10,7 @@ $TestPrefix = Split-Path -path ${Pwd}.Path -parent
 $TestPrefix = Split-Path -path ${TestPrefix} -leaf
 $TestPrefix = ${TestPrefix}.Substring(3)
 
-$LibraryTests = "cluster_block cluster_table error io_handle notify"
+$LibraryTests = "address_split arena batch bitmap_values block_cache byte_swap cache cache_state chain_index cluster_block cluster_block_pool cluster_table cluster_table_pool compression consistency_check creator deflate digest_index direct_file error hardware_aes hash host_cache io_handle io_scheduler io_uring key_cache layout_scan memory_map metadata_index notify numa page_cache pooled_file read_request reference_count_table sampler scratch_overlay snapshot_values statistics stream trace translation_cache write_cache zero_block"
 $LibraryTestsWithInput = "file support"
 
 $TestToolDirectory = "..\msvscpp\Release"